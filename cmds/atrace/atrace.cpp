@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <ctype.h>
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
@@ -22,8 +24,10 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
 #include <sys/sendfile.h>
 #include <time.h>
+#include <unistd.h>
 #include <zlib.h>
 
 #include <binder/IBinder.h>
@@ -32,8 +36,14 @@
 
 #include <cutils/properties.h>
 
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
+#include <utils/SortedVector.h>
 #include <utils/String8.h>
 #include <utils/Trace.h>
+#include <utils/TraceBuffer.h>
+#include <utils/TraceTagMap.h>
+#include <utils/Vector.h>
 
 using namespace android;
 
@@ -43,6 +53,8 @@ enum { MAX_SYS_FILES = 8 };
 
 const char* k_traceTagsProperty = "debug.atrace.tags.enableflags";
 const char* k_traceAppCmdlineProperty = "debug.atrace.app_cmdlines";
+const char* k_traceRingBufferProperty = "debug.atrace.ringbuffer";
+const char* k_traceTriggerProperty = "debug.atrace.trigger";
 
 typedef enum { OPT, REQ } requiredness  ;
 
@@ -118,15 +130,25 @@ static int g_traceDurationSeconds = 5;
 static bool g_traceOverwrite = false;
 static int g_traceBufferSizeKB = 2048;
 static bool g_compress = false;
+static bool g_userspaceRing = false;
 static bool g_nohup = false;
+static bool g_stream = false;
+static bool g_noPoke = false;
+static const char* g_snapshotDir = NULL;
+static int g_maxSnapshots = 10;
+static int g_snapshotIntervalSecs = 30;
 static int g_initialSleepSecs = 0;
 static const char* g_kernelTraceFuncs = NULL;
 static const char* g_debugAppCmdLine = "";
 
 /* Global state */
 static bool g_traceAborted = false;
+static volatile sig_atomic_t g_snapshotRequested = 0;
 static bool g_categoryEnables[NELEM(k_categories)] = {};
 
+/* Tags last set by setTagsProperty, published by notifyTraceChange. */
+static uint64_t g_tags = 0;
+
 /* Sys file paths */
 static const char* k_traceClockPath =
     "/sys/kernel/debug/tracing/trace_clock";
@@ -167,6 +189,9 @@ static const char* k_tracingOnPath =
 static const char* k_tracePath =
     "/sys/kernel/debug/tracing/trace";
 
+static const char* k_tracePipePath =
+    "/sys/kernel/debug/tracing/trace_pipe";
+
 // Check whether a file exists.
 static bool fileExists(const char* filename) {
     return access(filename, F_OK) != -1;
@@ -359,8 +384,26 @@ static bool pokeBinderServices()
     return true;
 }
 
-// Set the trace tags that userland tracing uses, and poke the running
-// processes to pick up the new value.
+// Get the running processes to re-read the trace properties.  Every process
+// using libutils notices the new generation of the shared tag map on its
+// next ATRACE_NAME or ATRACE_CALL, binder service or not.  Java's Trace
+// class only re-reads the properties when poked though, so the binder
+// services are still poked unless --no_poke was given.
+static bool notifyTraceChange()
+{
+    status_t err = TraceTagMap::publish(g_tags);
+    if (err != NO_ERROR) {
+        fprintf(stderr, "warning: could not publish the trace tags in %s: "
+                "%s (%d)\n", TraceTagMap::PATH, strerror(-err), -err);
+    }
+    if (g_noPoke) {
+        return true;
+    }
+    return pokeBinderServices();
+}
+
+// Set the trace tags that userland tracing uses.  notifyTraceChange() gets
+// the running processes to pick up the new value.
 static bool setTagsProperty(uint64_t tags)
 {
     char buf[64];
@@ -369,6 +412,7 @@ static bool setTagsProperty(uint64_t tags)
         fprintf(stderr, "error setting trace tags system property\n");
         return false;
     }
+    g_tags = tags;
     return true;
 }
 
@@ -383,6 +427,54 @@ static bool setAppCmdlineProperty(const char* cmdline)
     return true;
 }
 
+// Set the system property that makes processes record userland trace events
+// in their in-process ring buffers rather than in the kernel trace.  Turning
+// it off makes them drain their buffers to TraceBuffer::DRAIN_DIR the next
+// time they are poked.
+static bool setRingBufferProperty(bool enable)
+{
+    if (property_set(k_traceRingBufferProperty, enable ? "1" : "0") < 0) {
+        fprintf(stderr, "error setting trace ring buffer system property\n");
+        return false;
+    }
+    return true;
+}
+
+// Have every process drain its userland trace ring buffer to a file.
+static bool drainRingBuffers()
+{
+    bool ok = setRingBufferProperty(false);
+    ok &= notifyTraceChange();
+    return ok;
+}
+
+// Open the files the processes drained their ring buffers to, and unlink
+// them so they aren't picked up by the next trace.
+static void openDrainedRingBuffers(Vector<int>* fds)
+{
+    DIR* dir = opendir(TraceBuffer::DRAIN_DIR);
+    if (dir == NULL) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!strstr(entry->d_name, ".trace")) {
+            continue;
+        }
+        String8 path(TraceBuffer::DRAIN_DIR);
+        path.appendPath(entry->d_name);
+        int fd = open(path.string(), O_RDONLY);
+        if (fd == -1) {
+            fprintf(stderr, "error opening %s: %s (%d)\n", path.string(),
+                    strerror(errno), errno);
+            continue;
+        }
+        unlink(path.string());
+        fds->add(fd);
+    }
+    closedir(dir);
+}
+
 // Disable all /sys/ enable files.
 static bool disableKernelTraceEvents() {
     bool ok = true;
@@ -504,7 +596,8 @@ static bool setUpTrace()
     }
     ok &= setTagsProperty(tags);
     ok &= setAppCmdlineProperty(g_debugAppCmdLine);
-    ok &= pokeBinderServices();
+    ok &= setRingBufferProperty(g_userspaceRing);
+    ok &= notifyTraceChange();
 
     // Disable all the sysfs enables.  This is done as a separate loop from
     // the enables to allow the same enable to exist in multiple categories.
@@ -541,7 +634,8 @@ static void cleanUpTrace()
     // Reset the system properties.
     setTagsProperty(0);
     setAppCmdlineProperty("");
-    pokeBinderServices();
+    setRingBufferProperty(false);
+    notifyTraceChange();
 
     // Set the options back to their defaults.
     setTraceOverwriteEnable(true);
@@ -564,106 +658,553 @@ static void stopTrace()
     setTracingEnabled(false);
 }
 
-// Read the current kernel trace and write it to stdout.
-static void dumpTrace()
+// Write all of buf to fd.
+static bool writeFully(int fd, const uint8_t* buf, size_t len)
 {
-    int traceFD = open(k_tracePath, O_RDWR);
-    if (traceFD == -1) {
-        fprintf(stderr, "error opening %s: %s (%d)\n", k_tracePath,
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Deflates a stream into zlib format on a few threads.  The input is cut
+// into chunks that are deflated separately, each primed with the 32KB of
+// input before it so the ratio barely suffers.  A chunk ends on a byte
+// boundary (Z_SYNC_FLUSH), so the compressed chunks are simply written out
+// in order as a single zlib stream, and the adler32 checksums of the
+// chunks are combined for the trailer.
+class ParallelDeflater {
+public:
+    ParallelDeflater(int fd);
+    ~ParallelDeflater();
+
+    bool start();
+    bool write(const uint8_t* data, size_t len);
+    bool finish();
+
+private:
+    enum {
+        CHUNK_SIZE = 256*1024,
+        DICT_SIZE = 32*1024,
+        MAX_THREADS = 4,
+        NUM_CHUNKS = 2*MAX_THREADS,
+    };
+
+    enum State { FREE, FILLING, READY, DEFLATING, DONE };
+
+    struct Chunk {
+        State state;
+        bool last;
+        bool ok;
+        uint8_t* in;            // the dictionary, then the input
+        size_t dictLen;
+        size_t inLen;
+        uint8_t* out;
+        size_t outLen;
+        uLong adler;
+    };
+
+    static void* threadLoop(void* arg);
+    bool deflateChunk(Chunk* chunk);
+    bool submit(bool last);
+    bool writeChunk(Chunk* chunk);
+
+    int mFd;
+    Mutex mLock;
+    Condition mChanged;
+    Chunk mChunks[NUM_CHUNKS];
+    pthread_t mThreads[MAX_THREADS];
+    int mNumThreads;
+    bool mExiting;
+    size_t mFilling;            // the chunk being filled
+    size_t mNextDeflate;        // the next chunk for a thread
+    size_t mNextWrite;          // the next chunk to write out
+    uLong mAdler;
+    bool mOk;
+};
+
+ParallelDeflater::ParallelDeflater(int fd) :
+        mFd(fd), mNumThreads(0), mExiting(false), mFilling(0),
+        mNextDeflate(0), mNextWrite(0), mAdler(adler32(0, NULL, 0)),
+        mOk(true)
+{
+    bzero(mChunks, sizeof(mChunks));
+}
+
+ParallelDeflater::~ParallelDeflater()
+{
+    {
+        Mutex::Autolock _l(mLock);
+        mExiting = true;
+        mChanged.broadcast();
+    }
+    for (int i = 0; i < mNumThreads; i++) {
+        pthread_join(mThreads[i], NULL);
+    }
+    for (int i = 0; i < NUM_CHUNKS; i++) {
+        free(mChunks[i].in);
+        free(mChunks[i].out);
+    }
+}
+
+bool ParallelDeflater::start()
+{
+    const size_t outSize = compressBound(CHUNK_SIZE) + 16;
+    for (int i = 0; i < NUM_CHUNKS; i++) {
+        mChunks[i].in = (uint8_t*)malloc(DICT_SIZE + CHUNK_SIZE);
+        mChunks[i].out = (uint8_t*)malloc(outSize);
+        if (mChunks[i].in == NULL || mChunks[i].out == NULL) {
+            fprintf(stderr, "error allocating compression buffers\n");
+            return false;
+        }
+    }
+
+    mChunks[mFilling].state = FILLING;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int numThreads = cpus < 1 ? 1 : cpus > MAX_THREADS ? MAX_THREADS : cpus;
+    for (int i = 0; i < numThreads; i++) {
+        if (pthread_create(&mThreads[mNumThreads], NULL, threadLoop, this) == 0) {
+            mNumThreads++;
+        }
+    }
+    if (mNumThreads == 0) {
+        fprintf(stderr, "error starting compression threads\n");
+        return false;
+    }
+
+    // The zlib header, for the default compression level.
+    static const uint8_t header[2] = { 0x78, 0x9c };
+    if (!writeFully(mFd, header, sizeof(header))) {
+        fprintf(stderr, "error writing deflated trace: %s (%d)\n",
                 strerror(errno), errno);
-        return;
+        return false;
     }
+    return true;
+}
 
-    if (g_compress) {
-        z_stream zs;
-        uint8_t *in, *out;
-        int result, flush;
-
-        bzero(&zs, sizeof(zs));
-        result = deflateInit(&zs, Z_DEFAULT_COMPRESSION);
-        if (result != Z_OK) {
-            fprintf(stderr, "error initializing zlib: %d\n", result);
-            close(traceFD);
-            return;
-        }
-
-        const size_t bufSize = 64*1024;
-        in = (uint8_t*)malloc(bufSize);
-        out = (uint8_t*)malloc(bufSize);
-        flush = Z_NO_FLUSH;
-
-        zs.next_out = out;
-        zs.avail_out = bufSize;
-
-        do {
-
-            if (zs.avail_in == 0) {
-                // More input is needed.
-                result = read(traceFD, in, bufSize);
-                if (result < 0) {
-                    fprintf(stderr, "error reading trace: %s (%d)\n",
-                            strerror(errno), errno);
-                    result = Z_STREAM_END;
-                    break;
-                } else if (result == 0) {
-                    flush = Z_FINISH;
-                } else {
-                    zs.next_in = in;
-                    zs.avail_in = result;
-                }
+void* ParallelDeflater::threadLoop(void* arg)
+{
+    ParallelDeflater* self = (ParallelDeflater*)arg;
+    Mutex::Autolock _l(self->mLock);
+    for (;;) {
+        Chunk* chunk = &self->mChunks[self->mNextDeflate];
+        if (chunk->state != READY) {
+            if (self->mExiting) {
+                return NULL;
             }
+            self->mChanged.wait(self->mLock);
+            continue;
+        }
+        chunk->state = DEFLATING;
+        self->mNextDeflate = (self->mNextDeflate + 1) % NUM_CHUNKS;
 
-            if (zs.avail_out == 0) {
-                // Need to write the output.
-                result = write(STDOUT_FILENO, out, bufSize);
-                if ((size_t)result < bufSize) {
-                    fprintf(stderr, "error writing deflated trace: %s (%d)\n",
-                            strerror(errno), errno);
-                    result = Z_STREAM_END; // skip deflate error message
-                    zs.avail_out = bufSize; // skip the final write
-                    break;
-                }
-                zs.next_out = out;
-                zs.avail_out = bufSize;
-            }
+        self->mLock.unlock();
+        bool ok = self->deflateChunk(chunk);
+        self->mLock.lock();
 
-        } while ((result = deflate(&zs, flush)) == Z_OK);
+        chunk->ok = ok;
+        chunk->state = DONE;
+        self->mChanged.broadcast();
+    }
+}
 
-        if (result != Z_STREAM_END) {
-            fprintf(stderr, "error deflating trace: %s\n", zs.msg);
+bool ParallelDeflater::deflateChunk(Chunk* chunk)
+{
+    z_stream zs;
+    bzero(&zs, sizeof(zs));
+    int result = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS,
+            8, Z_DEFAULT_STRATEGY);
+    if (result != Z_OK) {
+        fprintf(stderr, "error initializing zlib: %d\n", result);
+        return false;
+    }
+    if (chunk->dictLen > 0) {
+        deflateSetDictionary(&zs, chunk->in, chunk->dictLen);
+    }
+
+    uint8_t* in = chunk->in + chunk->dictLen;
+    zs.next_in = in;
+    zs.avail_in = chunk->inLen;
+    zs.next_out = chunk->out;
+    zs.avail_out = compressBound(CHUNK_SIZE) + 16;
+    result = deflate(&zs, chunk->last ? Z_FINISH : Z_SYNC_FLUSH);
+    bool ok = chunk->last ? result == Z_STREAM_END :
+            (result == Z_OK && zs.avail_in == 0);
+    if (!ok) {
+        fprintf(stderr, "error deflating trace: %s\n", zs.msg ? zs.msg : "");
+    }
+    chunk->outLen = zs.next_out - chunk->out;
+    chunk->adler = adler32(adler32(0, NULL, 0), in, chunk->inLen);
+    deflateEnd(&zs);
+    return ok;
+}
+
+// Write out a deflated chunk, with mLock held.
+bool ParallelDeflater::writeChunk(Chunk* chunk)
+{
+    bool ok = mOk && chunk->ok;
+    if (ok) {
+        mLock.unlock();
+        ok = writeFully(mFd, chunk->out, chunk->outLen);
+        mLock.lock();
+        if (!ok) {
+            fprintf(stderr, "error writing deflated trace: %s (%d)\n",
+                    strerror(errno), errno);
         }
+        mAdler = adler32_combine(mAdler, chunk->adler, chunk->inLen);
+    }
+    mOk = ok;
+    chunk->state = FREE;
+    mNextWrite = (mNextWrite + 1) % NUM_CHUNKS;
+    return ok;
+}
 
-        if (zs.avail_out < bufSize) {
-            size_t bytes = bufSize - zs.avail_out;
-            result = write(STDOUT_FILENO, out, bytes);
-            if ((size_t)result < bytes) {
-                fprintf(stderr, "error writing deflated trace: %s (%d)\n",
-                        strerror(errno), errno);
+// Hand the chunk being filled to the threads, and start filling the next
+// one, which first has to be written out.
+bool ParallelDeflater::submit(bool last)
+{
+    Mutex::Autolock _l(mLock);
+    Chunk* chunk = &mChunks[mFilling];
+    Chunk* next = &mChunks[(mFilling + 1) % NUM_CHUNKS];
+
+    chunk->last = last;
+    chunk->state = READY;
+    mChanged.broadcast();
+    if (last) {
+        while (mOk && chunk->state != FREE) {
+            Chunk* oldest = &mChunks[mNextWrite];
+            if (oldest->state == DONE) {
+                writeChunk(oldest);
+            } else {
+                mChanged.wait(mLock);
             }
         }
+        return mOk;
+    }
 
-        result = deflateEnd(&zs);
-        if (result != Z_OK) {
-            fprintf(stderr, "error cleaning up zlib: %d\n", result);
+    while (next->state != FREE) {
+        Chunk* oldest = &mChunks[mNextWrite];
+        if (oldest->state == DONE) {
+            writeChunk(oldest);
+        } else {
+            mChanged.wait(mLock);
         }
+    }
 
-        free(in);
-        free(out);
-    } else {
+    // Prime the next chunk with the end of this one.
+    size_t dictLen = chunk->dictLen + chunk->inLen;
+    if (dictLen > DICT_SIZE) {
+        dictLen = DICT_SIZE;
+    }
+    memcpy(next->in, chunk->in + chunk->dictLen + chunk->inLen - dictLen, dictLen);
+    next->dictLen = dictLen;
+    next->inLen = 0;
+    next->state = FILLING;
+    mFilling = (mFilling + 1) % NUM_CHUNKS;
+    return mOk;
+}
+
+bool ParallelDeflater::write(const uint8_t* data, size_t len)
+{
+    while (len > 0) {
+        Chunk* chunk = &mChunks[mFilling];
+        size_t n = CHUNK_SIZE - chunk->inLen;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(chunk->in + chunk->dictLen + chunk->inLen, data, n);
+        chunk->inLen += n;
+        data += n;
+        len -= n;
+        if (chunk->inLen == CHUNK_SIZE && !submit(false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParallelDeflater::finish()
+{
+    if (!submit(true)) {
+        return false;
+    }
+    uint8_t trailer[4] = {
+        (uint8_t)(mAdler >> 24), (uint8_t)(mAdler >> 16),
+        (uint8_t)(mAdler >> 8), (uint8_t)mAdler,
+    };
+    if (!writeFully(mFd, trailer, sizeof(trailer))) {
+        fprintf(stderr, "error writing deflated trace: %s (%d)\n",
+                strerror(errno), errno);
+        return false;
+    }
+    return true;
+}
+
+// Copy what fd contains to outFd, through deflater unless it's NULL.
+// When follow is set, fd is read like a pipe until the trace is aborted,
+// then tracing is stopped and what is still buffered is read.
+static bool copyTrace(int outFd, int fd, ParallelDeflater* deflater, bool follow)
+{
+    if (deflater == NULL && !follow) {
         ssize_t sent = 0;
-        while ((sent = sendfile(STDOUT_FILENO, traceFD, NULL, 64*1024*1024)) > 0);
+        while ((sent = sendfile(outFd, fd, NULL, 64*1024*1024)) > 0);
         if (sent == -1) {
             fprintf(stderr, "error dumping trace: %s (%d)\n", strerror(errno),
                     errno);
         }
+        return true;
+    }
+
+    const size_t bufSize = 64*1024;
+    uint8_t* buf = (uint8_t*)malloc(bufSize);
+    if (buf == NULL) {
+        fprintf(stderr, "error allocating trace buffer\n");
+        return false;
+    }
+    bool ok = true;
+    for (;;) {
+        if (follow && g_traceAborted) {
+            follow = false;
+            stopTrace();
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+        }
+        ssize_t n = read(fd, buf, bufSize);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            break;
+        }
+        if (n < 0) {
+            fprintf(stderr, "error reading trace: %s (%d)\n",
+                    strerror(errno), errno);
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        if (deflater != NULL) {
+            ok = deflater->write(buf, n);
+        } else if (!writeFully(outFd, buf, n)) {
+            fprintf(stderr, "error writing trace: %s (%d)\n",
+                    strerror(errno), errno);
+            ok = false;
+        }
+        if (!ok) {
+            break;
+        }
+    }
+    free(buf);
+    return ok;
+}
+
+// Write the trace read from fds to outFd, deflated when -z was given.
+// The first fd is followed as for copyTrace().
+static bool writeTrace(int outFd, const Vector<int>& fds, bool follow)
+{
+    ParallelDeflater* deflater = NULL;
+    if (g_compress) {
+        deflater = new ParallelDeflater(outFd);
+        if (!deflater->start()) {
+            delete deflater;
+            return false;
+        }
+    }
+
+    bool ok = true;
+    for (size_t i = 0; ok && i < fds.size(); i++) {
+        ok = copyTrace(outFd, fds[i], deflater, follow && i == 0);
+        if (follow && i == 0 && g_userspaceRing) {
+            // The kernel trace is over, now the userland events.
+            drainRingBuffers();
+            Vector<int> ringFds;
+            openDrainedRingBuffers(&ringFds);
+            for (size_t j = 0; j < ringFds.size(); j++) {
+                ok = ok && copyTrace(outFd, ringFds[j], deflater, false);
+                close(ringFds[j]);
+            }
+        }
+    }
+
+    if (deflater != NULL) {
+        ok = ok && deflater->finish();
+        delete deflater;
+    }
+    return ok;
+}
+
+// Read the current kernel trace, followed by any drained userland ring
+// buffers, and write it to stdout.
+static void dumpTrace()
+{
+    int traceFD = open(k_tracePath, O_RDWR);
+    if (traceFD == -1) {
+        fprintf(stderr, "error opening %s: %s (%d)\n", k_tracePath,
+                strerror(errno), errno);
+        return;
+    }
+
+    Vector<int> fds;
+    fds.add(traceFD);
+    openDrainedRingBuffers(&fds);
+
+    writeTrace(STDOUT_FILENO, fds, false);
+
+    for (size_t i = 0; i < fds.size(); i++) {
+        close(fds[i]);
+    }
+}
+
+// Write the kernel trace to stdout as it is recorded until the trace is
+// aborted, followed by any drained userland ring buffers.  Reading
+// trace_pipe consumes the events, so the trace buffer only has to cover
+// the time between two reads rather than the whole capture.
+static void streamTrace()
+{
+    int traceFD = open(k_tracePipePath, O_RDONLY);
+    if (traceFD == -1) {
+        fprintf(stderr, "error opening %s: %s (%d)\n", k_tracePipePath,
+                strerror(errno), errno);
+        return;
     }
 
+    Vector<int> fds;
+    fds.add(traceFD);
+    writeTrace(STDOUT_FILENO, fds, true);
     close(traceFD);
 }
 
+// Delete the oldest snapshots, keeping room for one more.
+static void pruneSnapshots()
+{
+    DIR* dir = opendir(g_snapshotDir);
+    if (dir == NULL) {
+        return;
+    }
+    // The names start with the time, so they sort from oldest to newest.
+    SortedVector<String8> names;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!strncmp(entry->d_name, "trace-", 6)) {
+            names.add(String8(entry->d_name));
+        }
+    }
+    closedir(dir);
+
+    for (int i = 0; i + g_maxSnapshots <= (int)names.size(); i++) {
+        String8 path(g_snapshotDir);
+        path.appendPath(names[i]);
+        unlink(path.string());
+    }
+}
+
+// Save the kernel trace, and any userland ring buffers, to a new file in
+// the snapshot directory, then start over with an empty trace.
+static void saveSnapshot(const char* reason)
+{
+    char stamp[32];
+    time_t now = time(NULL);
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+    String8 path(g_snapshotDir);
+    path.appendPath(String8::format("trace-%s-%s.%s", stamp, reason,
+            g_compress ? "z" : "txt"));
+
+    int traceFD = open(k_tracePath, O_RDWR);
+    if (traceFD == -1) {
+        fprintf(stderr, "error opening %s: %s (%d)\n", k_tracePath,
+                strerror(errno), errno);
+        return;
+    }
+    Vector<int> fds;
+    fds.add(traceFD);
+    if (g_userspaceRing) {
+        drainRingBuffers();
+        openDrainedRingBuffers(&fds);
+        setRingBufferProperty(true);
+        notifyTraceChange();
+    }
+
+    pruneSnapshots();
+    int outFD = open(path.string(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (outFD == -1) {
+        fprintf(stderr, "error creating %s: %s (%d)\n", path.string(),
+                strerror(errno), errno);
+    } else {
+        if (writeTrace(outFD, fds, false)) {
+            printf("saved %s\n", path.string());
+            fflush(stdout);
+        }
+        close(outFD);
+    }
+
+    for (size_t i = 0; i < fds.size(); i++) {
+        close(fds[i]);
+    }
+    clearTrace();
+}
+
+// Keep tracing into the ring buffer until the trace is aborted, saving a
+// snapshot of it when SIGUSR1 is received or when another process sets
+// k_traceTriggerProperty to a new "reason:count" value.  Snapshots closer
+// together than g_snapshotIntervalSecs are dropped.
+static void runSnapshotDaemon()
+{
+    char last[PROPERTY_VALUE_MAX];
+    char value[PROPERTY_VALUE_MAX];
+    time_t lastSnapshot = 0;
+
+    property_get(k_traceTriggerProperty, last, "");
+    while (!g_traceAborted) {
+        struct timespec interval = { 0, 100*1000*1000 };
+        nanosleep(&interval, NULL);
+
+        char reason[PROPERTY_VALUE_MAX];
+        reason[0] = '\0';
+        if (g_snapshotRequested) {
+            g_snapshotRequested = 0;
+            strcpy(reason, "signal");
+        }
+        property_get(k_traceTriggerProperty, value, "");
+        if (strcmp(value, last)) {
+            strcpy(last, value);
+            if (value[0] != '\0') {
+                // Keep the reason only, and only what fits in a file name.
+                size_t len = strcspn(value, ":");
+                for (size_t i = 0; i < len; i++) {
+                    reason[i] = isalnum(value[i]) ? value[i] : '_';
+                }
+                reason[len] = '\0';
+            }
+        }
+        if (reason[0] == '\0') {
+            continue;
+        }
+
+        time_t now = time(NULL);
+        if (lastSnapshot != 0 && now - lastSnapshot < g_snapshotIntervalSecs) {
+            fprintf(stderr, "dropping snapshot for %s, the last one was %lds ago\n",
+                    reason, (long)(now - lastSnapshot));
+            continue;
+        }
+        lastSnapshot = now;
+        saveSnapshot(reason);
+    }
+}
+
 static void handleSignal(int signo)
 {
-    if (!g_nohup) {
+    if (signo == SIGUSR1) {
+        g_snapshotRequested = 1;
+    } else if (!g_nohup) {
         g_traceAborted = true;
     }
 }
@@ -678,6 +1219,7 @@ static void registerSigHandler()
     sigaction(SIGINT, &sa, NULL);
     sigaction(SIGQUIT, &sa, NULL);
     sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
 }
 
 static bool setCategoryEnable(const char* name, bool enable)
@@ -727,11 +1269,24 @@ static void showHelp(const char *cmd)
                     "  -n              ignore signals\n"
                     "  -s N            sleep for N seconds before tracing [default 0]\n"
                     "  -t N            trace for N seconds [defualt 5]\n"
+                    "  -u              record userland events in per-process ring\n"
+                    "                    buffers instead of the kernel trace\n"
                     "  -z              compress the trace dump\n"
+                    "  --stream        write the trace out as it is recorded until\n"
+                    "                    interrupted, instead of tracing for -t seconds\n"
+                    "  --daemon dir    trace into a circular buffer until interrupted,\n"
+                    "                    saving it to a new file in dir on SIGUSR1 or\n"
+                    "                    when debug.atrace.trigger changes\n"
+                    "  --max_snapshots N\n"
+                    "                  keep at most N files in the --daemon dir [default 10]\n"
+                    "  --snapshot_interval N\n"
+                    "                  save at most one file every N seconds [default 30]\n"
                     "  --async_start   start circular trace and return immediatly\n"
                     "  --async_dump    dump the current contents of circular trace buffer\n"
                     "  --async_stop    stop tracing and dump the current contents of circular\n"
                     "                    trace buffer\n"
+                    "  --no_poke       only publish the tags in the shared tag map;\n"
+                    "                    Java processes won't notice them\n"
                     "  --list_categories\n"
                     "                  list the available tracing categories\n"
             );
@@ -757,10 +1312,15 @@ int main(int argc, char **argv)
             {"async_stop",      no_argument, 0,  0 },
             {"async_dump",      no_argument, 0,  0 },
             {"list_categories", no_argument, 0,  0 },
+            {"stream",          no_argument, 0,  0 },
+            {"daemon",          required_argument, 0, 0 },
+            {"max_snapshots",   required_argument, 0, 0 },
+            {"snapshot_interval", required_argument, 0, 0 },
+            {"no_poke",         no_argument, 0,  0 },
             {           0,                0, 0,  0 }
         };
 
-        ret = getopt_long(argc, argv, "a:b:ck:ns:t:z",
+        ret = getopt_long(argc, argv, "a:b:ck:ns:t:uz",
                           long_options, &option_index);
 
         if (ret < 0) {
@@ -802,6 +1362,10 @@ int main(int argc, char **argv)
                 g_traceDurationSeconds = atoi(optarg);
             break;
 
+            case 'u':
+                g_userspaceRing = true;
+            break;
+
             case 'z':
                 g_compress = true;
             break;
@@ -822,6 +1386,20 @@ int main(int argc, char **argv)
                 } else if (!strcmp(long_options[option_index].name, "list_categories")) {
                     listSupportedCategories();
                     exit(0);
+                } else if (!strcmp(long_options[option_index].name, "stream")) {
+                    g_stream = true;
+                } else if (!strcmp(long_options[option_index].name, "daemon")) {
+                    g_snapshotDir = optarg;
+                    g_traceOverwrite = true;
+                } else if (!strcmp(long_options[option_index].name, "max_snapshots")) {
+                    g_maxSnapshots = atoi(optarg);
+                    if (g_maxSnapshots < 1) {
+                        g_maxSnapshots = 1;
+                    }
+                } else if (!strcmp(long_options[option_index].name, "snapshot_interval")) {
+                    g_snapshotIntervalSecs = atoi(optarg);
+                } else if (!strcmp(long_options[option_index].name, "no_poke")) {
+                    g_noPoke = true;
                 }
             break;
 
@@ -854,7 +1432,15 @@ int main(int argc, char **argv)
         // another.
         ok = clearTrace();
 
-        if (ok && !async) {
+        if (ok && !async && g_snapshotDir != NULL) {
+            printf(" saving snapshots to %s\n", g_snapshotDir);
+            fflush(stdout);
+            runSnapshotDaemon();
+        } else if (ok && !async && g_stream) {
+            printf(" streaming\nTRACE:\n");
+            fflush(stdout);
+            streamTrace();
+        } else if (ok && !async) {
             // Sleep to allow the trace to be captured.
             struct timespec timeLeft;
             timeLeft.tv_sec = g_traceDurationSeconds;
@@ -871,10 +1457,17 @@ int main(int argc, char **argv)
     if (traceStop)
         stopTrace();
 
-    if (ok && traceDump) {
+    const bool continuous = (g_stream || g_snapshotDir != NULL) && !async;
+    if (ok && traceDump && continuous) {
+        // Already written out.
+        clearTrace();
+    } else if (ok && traceDump) {
         if (!g_traceAborted) {
             printf(" done\nTRACE:\n");
             fflush(stdout);
+            if (g_userspaceRing) {
+                drainRingBuffers();
+            }
             dumpTrace();
         } else {
             printf("\ntrace aborted.\n");
@@ -889,5 +1482,6 @@ int main(int argc, char **argv)
     if (traceStop)
         cleanUpTrace();
 
-    return g_traceAborted ? 1 : 0;
+    // Interrupting a stream or the daemon is how they end.
+    return (g_traceAborted && !continuous) ? 1 : 0;
 }
@@ -43,17 +43,30 @@ static const char *dump_traces_path = NULL;
 
 static char screenshot_path[PATH_MAX] = "";
 
+static void dump_open_files();
+static void dump_smaps();
+static void dump_wchans();
+static void dump_system_log();
+static void dump_event_log();
+static void dump_radio_log();
+static void dump_vm_traces();
+static void dump_network();
+static void dump_system_state();
+static void dump_board();
+static void dump_dumpsys();
+static void dump_app_activities();
+static void dump_app_services();
+static void dump_app_providers();
+
 /* dumps the current system state to stdout */
 static void dumpstate() {
     time_t now = time(NULL);
     char build[PROPERTY_VALUE_MAX], fingerprint[PROPERTY_VALUE_MAX];
     char radio[PROPERTY_VALUE_MAX], bootloader[PROPERTY_VALUE_MAX];
     char network[PROPERTY_VALUE_MAX], date[80];
-    char build_type[PROPERTY_VALUE_MAX];
 
     property_get("ro.build.display.id", build, "(unknown)");
     property_get("ro.build.fingerprint", fingerprint, "(unknown)");
-    property_get("ro.build.type", build_type, "(unknown)");
     property_get("ro.baseband", radio, "(unknown)");
     property_get("ro.bootloader", bootloader, "(unknown)");
     property_get("gsm.operator.alpha", network, "(unknown)");
@@ -99,23 +112,62 @@ static void dumpstate() {
 
     do_dmesg();
 
-    run_command("LIST OF OPEN FILES", 10, SU_PATH, "root", "lsof", NULL);
-
     if (screenshot_path[0]) {
         ALOGI("taking screenshot\n");
         run_command(NULL, 10, "/system/bin/screencap", "-p", screenshot_path, NULL);
         ALOGI("wrote screenshot: %s\n", screenshot_path);
     }
 
+    /* the rest is collected in parallel, see run_section() */
+    run_section("LIST OF OPEN FILES", 20, dump_open_files);
+    run_section("SMAPS OF ALL PROCESSES", 0, dump_smaps);
+    run_section("BLOCKED PROCESS WAIT-CHANNELS", 30, dump_wchans);
+    // dump_file("EVENT LOG TAGS", "/etc/event-log-tags");
+    run_section("SYSTEM LOG", 30, dump_system_log);
+    run_section("EVENT LOG", 30, dump_event_log);
+    run_section("RADIO LOG", 30, dump_radio_log);
+    run_section("VM TRACES", 60, dump_vm_traces);
+    run_section("NETWORK", 300, dump_network);
+    run_section("SYSTEM STATE", 120, dump_system_state);
+    run_section("BOARD", 0, dump_board);
+    run_section("DUMPSYS", 70, dump_dumpsys);
+    run_section("APP ACTIVITIES", 40, dump_app_activities);
+    run_section("APP SERVICES", 40, dump_app_services);
+    run_section("APP PROVIDERS", 40, dump_app_providers);
+    end_sections();
+
+    print_section_times();
+
+    printf("========================================================\n");
+    printf("== dumpstate: done\n");
+    printf("========================================================\n");
+}
+
+static void dump_open_files() {
+    run_command("LIST OF OPEN FILES", 10, SU_PATH, "root", "lsof", NULL);
+}
+
+static void dump_smaps() {
     for_each_pid(do_showmap, "SMAPS OF ALL PROCESSES");
+}
+
+static void dump_wchans() {
     for_each_tid(show_wchan, "BLOCKED PROCESS WAIT-CHANNELS");
+}
 
-    // dump_file("EVENT LOG TAGS", "/etc/event-log-tags");
+static void dump_system_log() {
     run_command("SYSTEM LOG", 20, "logcat", "-v", "threadtime", "-d", "*:v", NULL);
+}
+
+static void dump_event_log() {
     run_command("EVENT LOG", 20, "logcat", "-b", "events", "-v", "threadtime", "-d", "*:v", NULL);
-    run_command("RADIO LOG", 20, "logcat", "-b", "radio", "-v", "threadtime", "-d", "*:v", NULL);
+}
 
+static void dump_radio_log() {
+    run_command("RADIO LOG", 20, "logcat", "-b", "radio", "-v", "threadtime", "-d", "*:v", NULL);
+}
 
+static void dump_vm_traces() {
     /* show the traces we collected in main(), if that was done */
     if (dump_traces_path != NULL) {
         dump_file("VM TRACES JUST NOW", dump_traces_path);
@@ -150,6 +202,10 @@ static void dumpstate() {
             i++;
         }
     }
+}
+
+static void dump_network() {
+    char network[PROPERTY_VALUE_MAX];
 
     dump_file("NETWORK DEV INFO", "/proc/net/dev");
     dump_file("QTAGUID NETWORK INTERFACES INFO", "/proc/net/xt_qtaguid/iface_stat_all");
@@ -210,7 +266,9 @@ static void dumpstate() {
             SU_PATH, "root", "wlutil", "counters", NULL);
 #endif
     dump_file("INTERRUPTS (2)", "/proc/interrupts");
+}
 
+static void dump_system_state() {
     print_properties();
 
     run_command("VOLD DUMP", 10, "vdc", "dump", NULL);
@@ -242,6 +300,11 @@ static void dumpstate() {
     dump_file("BINDER TRANSACTIONS", "/sys/kernel/debug/binder/transactions");
     dump_file("BINDER STATS", "/sys/kernel/debug/binder/stats");
     dump_file("BINDER STATE", "/sys/kernel/debug/binder/state");
+}
+
+static void dump_board() {
+    char build_type[PROPERTY_VALUE_MAX];
+    property_get("ro.build.type", build_type, "(unknown)");
 
 #ifdef BOARD_HAS_DUMPSTATE
     printf("========================================================\n");
@@ -267,7 +330,9 @@ static void dumpstate() {
                     SU_PATH, "root", "vril-dump", NULL);
         }
     }
+}
 
+static void dump_dumpsys() {
     printf("========================================================\n");
     printf("== Android Framework Services\n");
     printf("========================================================\n");
@@ -276,29 +341,30 @@ static void dumpstate() {
        to increase its timeout.  we really need to do the timeouts in
        dumpsys itself... */
     run_command("DUMPSYS", 60, "dumpsys", NULL);
+}
 
+static void dump_app_activities() {
     printf("========================================================\n");
     printf("== Running Application Activities\n");
     printf("========================================================\n");
 
     run_command("APP ACTIVITIES", 30, "dumpsys", "activity", "all", NULL);
+}
 
+static void dump_app_services() {
     printf("========================================================\n");
     printf("== Running Application Services\n");
     printf("========================================================\n");
 
     run_command("APP SERVICES", 30, "dumpsys", "activity", "service", "all", NULL);
+}
 
+static void dump_app_providers() {
     printf("========================================================\n");
     printf("== Running Application Providers\n");
     printf("========================================================\n");
 
     run_command("APP SERVICES", 30, "dumpsys", "activity", "provider", "all", NULL);
-
-
-    printf("========================================================\n");
-    printf("== dumpstate: done\n");
-    printf("========================================================\n");
 }
 
 static void usage() {
@@ -26,6 +26,7 @@
 
 typedef void (for_each_pid_func)(int, const char *);
 typedef void (for_each_tid_func)(int, int, const char *);
+typedef void (section_func)(void);
 
 /* prints the contents of a file */
 int dump_file(const char *title, const char* path);
@@ -33,6 +34,17 @@ int dump_file(const char *title, const char* path);
 /* forks a command and waits for it to finish -- terminate args with NULL */
 int run_command(const char *title, int timeout_seconds, const char *command, ...);
 
+/* runs func in a child process, alongside the other sections, killing it
+ * after timeout_seconds (0 for none); the output of the sections is
+ * printed in the order they were started */
+void run_section(const char *title, int timeout_seconds, section_func func);
+
+/* waits for all the sections started, printing their output */
+void end_sections();
+
+/* prints how long each section took */
+void print_section_times();
+
 /* prints all the system properties */
 void print_properties();
 
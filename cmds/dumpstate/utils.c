@@ -21,6 +21,7 @@
 #include <poll.h>
 #include <signal.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,6 +41,8 @@
 
 #include "dumpstate.h"
 
+#define NANOS_PER_SEC 1000000000ULL
+
 /* list of native processes to include in the native dumps */
 static const char* native_processes_to_dump[] = {
         "/system/bin/drmserver",
@@ -259,10 +262,16 @@ int dump_file(const char *title, const char* path) {
     return 0;
 }
 
+static uint64_t nanotime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 /* forks a command and waits for it to finish */
 int run_command(const char *title, int timeout_seconds, const char *command, ...) {
     fflush(stdout);
-    clock_t start = clock();
+    uint64_t start = nanotime();
     pid_t pid = fork();
 
     /* handle error case */
@@ -315,7 +324,7 @@ int run_command(const char *title, int timeout_seconds, const char *command, ...
     for (;;) {
         int status;
         pid_t p = waitpid(pid, &status, WNOHANG);
-        float elapsed = (float) (clock() - start) / CLOCKS_PER_SEC;
+        float elapsed = (float) (nanotime() - start) / NANOS_PER_SEC;
         if (p == pid) {
             if (WIFSIGNALED(status)) {
                 printf("*** %s: Killed by signal %d\n", command, WTERMSIG(status));
@@ -614,3 +623,188 @@ error_close_fd:
 void play_sound(const char* path) {
     run_command(NULL, 5, "/system/bin/stagefright", "-o", "-a", path, NULL);
 }
+
+/*
+ * Sections run in child processes, up to MAX_RUNNING_SECTIONS at once, with
+ * their output sent through a pipe. The output of the oldest unfinished
+ * section goes straight to stdout, the others are kept until it's their
+ * turn, so the report reads as if the sections had run one after another.
+ */
+
+#define MAX_SECTIONS            64
+#define MAX_RUNNING_SECTIONS    4
+
+typedef struct {
+    const char *title;
+    pid_t pid;
+    int fd;                     /* read end of its output, -1 once done */
+    char *buf;                  /* output kept until it's printed */
+    size_t len;
+    size_t size;
+    uint64_t start;
+    uint64_t end;
+    uint64_t timeout;           /* 0 for none */
+    bool timed_out;
+} section_t;
+
+static section_t sections[MAX_SECTIONS];
+static int num_sections = 0;
+static int num_printed = 0;     /* sections before this one are all printed */
+static int num_running = 0;
+
+static void write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        buf += n;
+        len -= n;
+    }
+}
+
+static void append_output(section_t *section, const char *buf, size_t len) {
+    if (section->len + len > section->size) {
+        size_t size = section->size ? section->size : 65536;
+        while (size < section->len + len) size *= 2;
+        char *grown = realloc(section->buf, size);
+        if (grown == NULL) return;
+        section->buf = grown;
+        section->size = size;
+    }
+    memcpy(section->buf + section->len, buf, len);
+    section->len += len;
+}
+
+/* prints what can be printed, in order */
+static void print_sections() {
+    fflush(stdout);
+    while (num_printed < num_sections) {
+        section_t *section = &sections[num_printed];
+        if (section->len > 0) {
+            write_all(STDOUT_FILENO, section->buf, section->len);
+            free(section->buf);
+            section->buf = NULL;
+            section->len = section->size = 0;
+        }
+        if (section->fd >= 0) break;
+        num_printed++;
+    }
+}
+
+static void finish_section(section_t *section) {
+    char msg[128];
+    int status;
+
+    close(section->fd);
+    section->fd = -1;
+    if (section->timed_out) {
+        kill(section->pid, SIGKILL);
+        snprintf(msg, sizeof(msg), "*** %s: Timed out after %.1fs\n\n", section->title,
+                (float) (nanotime() - section->start) / NANOS_PER_SEC);
+        append_output(section, msg, strlen(msg));
+    }
+    waitpid(section->pid, &status, 0);
+    section->end = nanotime();
+    num_running--;
+}
+
+/* reads the output of the running sections for up to 100ms */
+static void pump_sections() {
+    struct pollfd pfds[MAX_RUNNING_SECTIONS];
+    section_t *polled[MAX_RUNNING_SECTIONS];
+    char buf[32768];
+    int i, n = 0;
+    uint64_t now = nanotime();
+
+    for (i = num_printed; i < num_sections; i++) {
+        section_t *section = &sections[i];
+        if (section->fd < 0) continue;
+        if (section->timeout && now - section->start > section->timeout) {
+            section->timed_out = true;
+            finish_section(section);
+            continue;
+        }
+        pfds[n].fd = section->fd;
+        pfds[n].events = POLLIN;
+        pfds[n].revents = 0;
+        polled[n++] = section;
+    }
+    if (n > 0 && poll(pfds, n, 100) > 0) {
+        for (i = 0; i < n; i++) {
+            if (!pfds[i].revents) continue;
+            ssize_t len = read(pfds[i].fd, buf, sizeof(buf));
+            if (len > 0) {
+                append_output(polled[i], buf, len);
+            } else if (len == 0 || errno != EINTR) {
+                finish_section(polled[i]);
+            }
+        }
+    }
+    print_sections();
+}
+
+void run_section(const char *title, int timeout_seconds, section_func func) {
+    int fds[2];
+
+    if (num_sections == MAX_SECTIONS || pipe(fds)) {
+        /* run it here and now, after the ones before it */
+        end_sections();
+        func();
+        return;
+    }
+    while (num_running >= MAX_RUNNING_SECTIONS) {
+        pump_sections();
+    }
+
+    section_t *section = &sections[num_sections];
+    memset(section, 0, sizeof(*section));
+    section->title = title;
+    section->start = nanotime();
+    section->timeout = (uint64_t)timeout_seconds * NANOS_PER_SEC;
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        printf("*** fork: %s\n", strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        end_sections();
+        func();
+        return;
+    }
+    if (pid == 0) {
+        /* make sure the section dies when dumpstate dies */
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[1]);
+        func();
+        fflush(stdout);
+        _exit(0);
+    }
+    close(fds[1]);
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    section->pid = pid;
+    section->fd = fds[0];
+    num_sections++;
+    num_running++;
+}
+
+void end_sections() {
+    while (num_running > 0) {
+        pump_sections();
+    }
+    print_sections();
+}
+
+void print_section_times() {
+    int i;
+
+    printf("------ SECTION TIMES ------\n");
+    for (i = 0; i < num_sections; i++) {
+        printf("%-40s %6.1fs%s\n", sections[i].title,
+                (float) (sections[i].end - sections[i].start) / NANOS_PER_SEC,
+                sections[i].timed_out ? " (timed out)" : "");
+    }
+    printf("\n");
+}
@@ -10,9 +10,14 @@
 #include <binder/ProcessState.h>
 #include <binder/IServiceManager.h>
 #include <utils/TextOutput.h>
+#include <utils/Thread.h>
+#include <utils/Timers.h>
 #include <utils/Vector.h>
 
+#include <errno.h>
+#include <fcntl.h>
 #include <getopt.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -21,11 +26,113 @@
 
 using namespace android;
 
+// Services are dumped from this many threads at once; each of them holds
+// a binder thread of the process hosting the service, which mustn't all
+// be taken by us.
+static const size_t kMaxConcurrentDumps = 4;
+
+static const int kDefaultTimeoutSeconds = 10;
+
 static int sort_func(const String16* lhs, const String16* rhs)
 {
     return lhs->compare(*rhs);
 }
 
+static void usage() {
+    fprintf(stderr,
+        "usage: dumpsys [-t TIMEOUT] [--skip SERVICES] [SERVICE [ARGS]]\n"
+        "    -t TIMEOUT         seconds to wait for each service (default %d)\n"
+        "    --skip SERVICES    comma separated services not to dump\n"
+        "    SERVICE [ARGS]     dump only SERVICE, passing it ARGS\n",
+        kDefaultTimeoutSeconds);
+}
+
+// Dumps a service into the write end of a pipe, which it closes once done
+// so that the reader sees the end of the output. If the service doesn't
+// finish in time the reader closes its end and forgets about the thread,
+// which holds everything it needs itself.
+class DumpThread : public Thread {
+public:
+    DumpThread(const sp<IBinder>& service, const Vector<String16>& args,
+            int fd) :
+        Thread(false), mService(service), mArgs(args), mFd(fd),
+        mError(NO_ERROR) {
+    }
+
+    status_t getError() const { return mError; }
+
+private:
+    virtual bool threadLoop() {
+        mError = mService->dump(mFd, mArgs);
+        close(mFd);
+        return false;
+    }
+
+    sp<IBinder> mService;
+    Vector<String16> mArgs;
+    int mFd;
+    volatile status_t mError;
+};
+
+struct PendingDump {
+    sp<DumpThread> thread;
+    int fd;     // read end of the pipe, -1 if the service couldn't start
+};
+
+static void startDump(const sp<IBinder>& service,
+        const Vector<String16>& args, PendingDump* dump) {
+    dump->fd = -1;
+    int fds[2];
+    if (pipe(fds) < 0) {
+        ALOGE("pipe failed: %s", strerror(errno));
+        return;
+    }
+    dump->thread = new DumpThread(service, args, fds[1]);
+    if (dump->thread->run("dumpsys") != NO_ERROR) {
+        close(fds[0]);
+        close(fds[1]);
+        dump->thread.clear();
+        return;
+    }
+    dump->fd = fds[0];
+}
+
+// Copies the output of a dump to stdout until the service closes it,
+// returning false if that doesn't happen within timeout.
+static bool copyDump(int fd, nsecs_t timeout) {
+    const nsecs_t deadline = systemTime() + timeout;
+    char buffer[4096];
+    for (;;) {
+        const nsecs_t remaining = deadline - systemTime();
+        if (remaining <= 0) {
+            return false;
+        }
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        const int ret = poll(&pfd, 1, int(ns2ms(remaining)) + 1);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (ret == 0) {
+            continue;   // the deadline is checked above
+        }
+        const ssize_t n = TEMP_FAILURE_RETRY(read(fd, buffer, sizeof(buffer)));
+        if (n <= 0) {
+            return true;
+        }
+        for (ssize_t written = 0 ; written < n ; ) {
+            const ssize_t w = TEMP_FAILURE_RETRY(
+                    write(STDOUT_FILENO, buffer + written, n - written));
+            if (w < 0) {
+                return true;    // nobody's reading our output anymore
+            }
+            written += w;
+        }
+    }
+}
+
 int main(int argc, char* const argv[])
 {
     signal(SIGPIPE, SIG_IGN);
@@ -37,15 +144,58 @@ int main(int argc, char* const argv[])
         return 20;
     }
 
+    int timeoutSeconds = kDefaultTimeoutSeconds;
+    Vector<String16> skipped;
+    static const struct option longOptions[] = {
+        { "skip",   required_argument,  NULL,   's' },
+        { "help",   no_argument,        NULL,   'h' },
+        { NULL,     0,                  NULL,   0 }
+    };
+    // stop at the service name, what follows are its own arguments
+    int opt;
+    while ((opt = getopt_long(argc, argv, "+t:h", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 't':
+            timeoutSeconds = atoi(optarg);
+            if (timeoutSeconds <= 0) {
+                fprintf(stderr, "dumpsys: invalid timeout '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        case 's': {
+            char* names = strdup(optarg);
+            char* save = NULL;
+            for (char* name = strtok_r(names, ",", &save) ; name ;
+                    name = strtok_r(NULL, ",", &save)) {
+                skipped.add(String16(name));
+            }
+            free(names);
+            break;
+        }
+        default:
+            usage();
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
     Vector<String16> services;
     Vector<String16> args;
-    if (argc == 1) {
-        services = sm->listServices();
-        services.sort(sort_func);
+    if (optind == argc) {
+        Vector<String16> all = sm->listServices();
+        all.sort(sort_func);
+        for (size_t i=0; i<all.size(); i++) {
+            bool skip = false;
+            for (size_t j=0; j<skipped.size() && !skip; j++) {
+                skip = (all[i] == skipped[j]);
+            }
+            if (!skip) {
+                services.add(all[i]);
+            }
+        }
         args.add(String16("-a"));
     } else {
-        services.add(String16(argv[1]));
-        for (int i=2; i<argc; i++) {
+        services.add(String16(argv[optind]));
+        for (int i=optind+1; i<argc; i++) {
             args.add(String16(argv[i]));
         }
     }
@@ -64,23 +214,54 @@ int main(int argc, char* const argv[])
         }
     }
 
+    // Services are dumped concurrently, each into its own pipe, and their
+    // output is copied out in order. A service's timeout starts when its
+    // turn comes, as it may have been waiting for us to drain its pipe.
+    Vector<PendingDump> dumps;
+    dumps.insertAt(0, N);
+    size_t started = 0;
     for (size_t i=0; i<N; i++) {
-        sp<IBinder> service = sm->checkService(services[i]);
-        if (service != NULL) {
-            if (N > 1) {
-                aout << "------------------------------------------------------------"
-                        "-------------------" << endl;
-                aout << "DUMP OF SERVICE " << services[i] << ":" << endl;
-            }
-            int err = service->dump(STDOUT_FILENO, args);
-            if (err != 0) {
-                aerr << "Error dumping service info: (" << strerror(err)
-                        << ") " << services[i] << endl;
+        for ( ; started<N && started<i+kMaxConcurrentDumps ; started++) {
+            sp<IBinder> service = sm->checkService(services[started]);
+            if (service != NULL) {
+                startDump(service, args, &dumps.editItemAt(started));
+            } else {
+                dumps.editItemAt(started).fd = -1;
             }
-        } else {
+        }
+
+        PendingDump& dump(dumps.editItemAt(i));
+        if (dump.thread == NULL) {
             aerr << "Can't find service: " << services[i] << endl;
+            continue;
+        }
+        if (N > 1) {
+            aout << "------------------------------------------------------------"
+                    "-------------------" << endl;
+            aout << "DUMP OF SERVICE " << services[i] << ":" << endl;
+        }
+        const nsecs_t start = systemTime();
+        const bool finished = copyDump(dump.fd, seconds_to_nanoseconds(timeoutSeconds));
+        const nsecs_t duration = systemTime() - start;
+        close(dump.fd);
+        if (!finished) {
+            aout << "*** SERVICE " << services[i] << " DUMP TIMEOUT ("
+                    << timeoutSeconds << "s) EXPIRED ***" << endl;
+        } else if (dump.thread->getError() != NO_ERROR) {
+            aerr << "Error dumping service info: ("
+                    << strerror(-dump.thread->getError())
+                    << ") " << services[i] << endl;
         }
+        if (N > 1) {
+            char line[64];
+            snprintf(line, sizeof(line), "%.3f", duration / 1e9);
+            aout << "--------- " << line << "s was the duration of dumpsys "
+                    << services[i] << endl;
+        }
+        dump.thread.clear();
     }
 
-    return 0;
+    // threads of services that timed out are still blocked in them
+    fflush(stdout);
+    _exit(0);
 }
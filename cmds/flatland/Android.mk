@@ -5,6 +5,7 @@ LOCAL_SRC_FILES:=   \
     Composers.cpp   \
     GLHelper.cpp    \
     Renderers.cpp   \
+    Scenarios.cpp   \
     Main.cpp        \
 
 LOCAL_MODULE:= flatland
@@ -13,6 +14,7 @@ LOCAL_MODULE_TAGS := tests
 
 LOCAL_SHARED_LIBRARIES := \
     libEGL      \
+    libbinder   \
     libGLESv2   \
     libcutils   \
     libgui      \
@@ -123,16 +123,54 @@ public:
         return true;
     }
 
+    virtual uint32_t surfaceFlags() {
+        return 0;
+    }
+
+    virtual bool composeSurface(const sp<SurfaceControl>& sc) {
+        return true;
+    }
+
 protected:
     virtual bool setUp(GLHelper* helper) {
         return true;
     }
 
+    // Shows the whole surface in the given rectangle of the screen.
+    bool placeSurface(const sp<SurfaceControl>& sc, int32_t x, int32_t y,
+            uint32_t w, uint32_t h, float alpha) {
+        status_t err;
+
+        err = sc->setPosition(float(x), float(y));
+        if (err != NO_ERROR) {
+            fprintf(stderr, "SurfaceControl::setPosition error: %#x\n", err);
+            return false;
+        }
+
+        err = sc->setMatrix(float(w) / float(mLayerDesc.width), 0.0f,
+                0.0f, float(h) / float(mLayerDesc.height));
+        if (err != NO_ERROR) {
+            fprintf(stderr, "SurfaceControl::setMatrix error: %#x\n", err);
+            return false;
+        }
+
+        err = sc->setAlpha(alpha);
+        if (err != NO_ERROR) {
+            fprintf(stderr, "SurfaceControl::setAlpha error: %#x\n", err);
+            return false;
+        }
+
+        return true;
+    }
+
     LayerDesc mLayerDesc;
 };
 
 Composer* nocomp() {
     class NoComp : public ComposerBase {
+        virtual uint32_t surfaceFlags() {
+            return ISurfaceComposerClient::eHidden;
+        }
     };
     return new NoComp();
 }
@@ -155,6 +193,15 @@ Composer* opaque() {
             return mBlitter.blit(texName, texMatrix, x, y, w, h);
         }
 
+        virtual uint32_t surfaceFlags() {
+            return ISurfaceComposerClient::eOpaque;
+        }
+
+        virtual bool composeSurface(const sp<SurfaceControl>& sc) {
+            return placeSurface(sc, mLayerDesc.x, mLayerDesc.y,
+                    mLayerDesc.width, mLayerDesc.height, 1.0f);
+        }
+
         Blitter mBlitter;
     };
     return new OpaqueComp();
@@ -187,6 +234,27 @@ Composer* opaqueShrink() {
             return mBlitter.blit(texName, texMatrix, x, y, w, h);
         }
 
+        virtual uint32_t surfaceFlags() {
+            return ISurfaceComposerClient::eOpaque;
+        }
+
+        virtual bool composeSurface(const sp<SurfaceControl>& sc) {
+            int32_t x = mLayerDesc.x;
+            int32_t y = mLayerDesc.y;
+            int32_t w = mLayerDesc.width;
+            int32_t h = mLayerDesc.height;
+
+            mParity = !mParity;
+            if (mParity) {
+                x += w / 128;
+                y += h / 128;
+                w -= w / 64;
+                h -= h / 64;
+            }
+
+            return placeSurface(sc, x, y, w, h, 1.0f);
+        }
+
         Blitter mBlitter;
         bool mParity;
     };
@@ -226,6 +294,11 @@ Composer* blend() {
             return true;
         }
 
+        virtual bool composeSurface(const sp<SurfaceControl>& sc) {
+            return placeSurface(sc, mLayerDesc.x, mLayerDesc.y,
+                    mLayerDesc.width, mLayerDesc.height, .75f);
+        }
+
         Blitter mBlitter;
     };
     return new BlendComp();
@@ -273,6 +346,23 @@ Composer* blendShrink() {
             return true;
         }
 
+        virtual bool composeSurface(const sp<SurfaceControl>& sc) {
+            int32_t x = mLayerDesc.x;
+            int32_t y = mLayerDesc.y;
+            int32_t w = mLayerDesc.width;
+            int32_t h = mLayerDesc.height;
+
+            mParity = !mParity;
+            if (mParity) {
+                x += w / 128;
+                y += h / 128;
+                w -= w / 64;
+                h -= h / 64;
+            }
+
+            return placeSurface(sc, x, y, w, h, .75f);
+        }
+
         Blitter mBlitter;
         bool mParity;
     };
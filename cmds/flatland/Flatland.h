@@ -20,6 +20,8 @@
 #include <GLES2/gl2.h>
 
 #include <gui/GLConsumer.h>
+#include <gui/SurfaceControl.h>
+#include <utils/Vector.h>
 
 namespace android {
 
@@ -42,6 +44,26 @@ struct LayerDesc {
     uint32_t height;
 };
 
+struct BenchmarkDesc {
+    // The name of the test.
+    const char* name;
+
+    // The dimensions of the space in which window layers are specified.
+    uint32_t width;
+    uint32_t height;
+
+    // The screen heights at which to run the test.
+    uint32_t runHeights[MAX_TEST_RUNS];
+
+    // The list of window layers.
+    LayerDesc layers[MAX_NUM_LAYERS];
+};
+
+// Appends the benchmarks described in a scenario file, see README.txt for
+// the format.  Prints the first error found and returns false if the file
+// can't be used.
+bool loadBenchmarks(const char* path, Vector<BenchmarkDesc>* benchmarks);
+
 void resetColorGenerator();
 
 class Composer {
@@ -50,6 +72,12 @@ public:
     virtual bool setUp(const LayerDesc& desc, GLHelper* helper) = 0;
     virtual void tearDown() = 0;
     virtual bool compose(GLuint texName, const sp<GLConsumer>& glc) = 0;
+
+    // When SurfaceFlinger does the composition, the layer is a surface
+    // created with these ISurfaceComposerClient flags, and the state of the
+    // next frame is set on it from within an open transaction.
+    virtual uint32_t surfaceFlags() = 0;
+    virtual bool composeSurface(const sp<SurfaceControl>& sc) = 0;
 };
 
 Composer* nocomp();
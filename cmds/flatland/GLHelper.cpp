@@ -217,7 +217,24 @@ bool GLHelper::createNamedSurfaceTexture(GLuint name, uint32_t w, uint32_t h,
     return true;
 }
 
-bool GLHelper::computeWindowScale(uint32_t w, uint32_t h, float* scale) {
+bool GLHelper::setUpComposerClient() {
+    if (mSurfaceComposerClient == NULL) {
+        mSurfaceComposerClient = new SurfaceComposerClient;
+    }
+    status_t err = mSurfaceComposerClient->initCheck();
+    if (err != NO_ERROR) {
+        fprintf(stderr, "SurfaceComposerClient::initCheck error: %#x\n", err);
+        return false;
+    }
+
+    return true;
+}
+
+bool GLHelper::getDisplaySize(uint32_t* w, uint32_t* h) {
+    if (!setUpComposerClient()) {
+        return false;
+    }
+
     sp<IBinder> dpy = mSurfaceComposerClient->getBuiltInDisplay(0);
     if (dpy == NULL) {
         fprintf(stderr, "SurfaceComposer::getBuiltInDisplay failed.\n");
@@ -231,8 +248,19 @@ bool GLHelper::computeWindowScale(uint32_t w, uint32_t h, float* scale) {
         return false;
     }
 
-    float scaleX = float(info.w) / float(w);
-    float scaleY = float(info.h) / float(h);
+    *w = info.w;
+    *h = info.h;
+    return true;
+}
+
+bool GLHelper::computeWindowScale(uint32_t w, uint32_t h, float* scale) {
+    uint32_t dw, dh;
+    if (!getDisplaySize(&dw, &dh)) {
+        return false;
+    }
+
+    float scaleX = float(dw) / float(w);
+    float scaleY = float(dh) / float(h);
     *scale = scaleX < scaleY ? scaleX : scaleY;
 
     return true;
@@ -243,12 +271,7 @@ bool GLHelper::createWindowSurface(uint32_t w, uint32_t h,
     bool result;
     status_t err;
 
-    if (mSurfaceComposerClient == NULL) {
-        mSurfaceComposerClient = new SurfaceComposerClient;
-    }
-    err = mSurfaceComposerClient->initCheck();
-    if (err != NO_ERROR) {
-        fprintf(stderr, "SurfaceComposerClient::initCheck error: %#x\n", err);
+    if (!setUpComposerClient()) {
         return false;
     }
 
@@ -296,6 +319,42 @@ bool GLHelper::createWindowSurface(uint32_t w, uint32_t h,
     return true;
 }
 
+bool GLHelper::createLayerSurface(const char* name, uint32_t w, uint32_t h,
+        uint32_t flags, int32_t z, sp<SurfaceControl>* surfaceControl,
+        EGLSurface* surface) {
+    status_t err;
+
+    if (!setUpComposerClient()) {
+        return false;
+    }
+
+    sp<SurfaceControl> sc = mSurfaceComposerClient->createSurface(
+            String8(name), w, h, PIXEL_FORMAT_RGBA_8888, flags);
+    if (sc == NULL || !sc->isValid()) {
+        fprintf(stderr, "Failed to create SurfaceControl.\n");
+        return false;
+    }
+
+    SurfaceComposerClient::openGlobalTransaction();
+    err = sc->setLayer(0x7FFFFF00 + z);
+    if (err != NO_ERROR) {
+        fprintf(stderr, "SurfaceComposer::setLayer error: %#x\n", err);
+        return false;
+    }
+    SurfaceComposerClient::closeGlobalTransaction();
+
+    sp<ANativeWindow> anw = sc->getSurface();
+    EGLSurface s = eglCreateWindowSurface(mDisplay, mConfig, anw.get(), NULL);
+    if (s == EGL_NO_SURFACE) {
+        fprintf(stderr, "eglCreateWindowSurface error: %#x\n", eglGetError());
+        return false;
+    }
+
+    *surfaceControl = sc;
+    *surface = s;
+    return true;
+}
+
 static bool compileShader(GLenum shaderType, const char* src,
         GLuint* outShader) {
     GLuint shader = glCreateShader(shaderType);
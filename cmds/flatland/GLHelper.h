@@ -58,6 +58,14 @@ public:
     bool createWindowSurface(uint32_t w, uint32_t h,
             sp<SurfaceControl>* surfaceControl, EGLSurface* surface);
 
+    bool getDisplaySize(uint32_t* w, uint32_t* h);
+
+    // Creates a SurfaceFlinger layer of the given size, stacked by z above
+    // the other windows.
+    bool createLayerSurface(const char* name, uint32_t w, uint32_t h,
+            uint32_t flags, int32_t z, sp<SurfaceControl>* surfaceControl,
+            EGLSurface* surface);
+
     void destroySurface(EGLSurface* surface);
 
     bool swapBuffers(EGLSurface surface);
@@ -71,6 +79,8 @@ private:
     bool createNamedSurfaceTexture(GLuint name, uint32_t w, uint32_t h,
             sp<GLConsumer>* surfaceTexture, EGLSurface* surface);
 
+    bool setUpComposerClient();
+
     bool computeWindowScale(uint32_t w, uint32_t h, float* scale);
 
     bool setUpShaders(const ShaderDesc* shaderDescs, size_t numShaders);
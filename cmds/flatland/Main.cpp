@@ -16,8 +16,10 @@
 
 #define ATRACE_TAG ATRACE_TAG_ALWAYS
 
+#include <binder/IServiceManager.h>
 #include <gui/GraphicBufferAlloc.h>
 #include <gui/Surface.h>
+#include <gui/SurfaceComposerClient.h>
 #include <gui/SurfaceControl.h>
 #include <gui/GLConsumer.h>
 #include <gui/Surface.h>
@@ -27,8 +29,10 @@
 #include <EGL/egl.h>
 #include <GLES2/gl2.h>
 
+#include <errno.h>
 #include <math.h>
 #include <getopt.h>
+#include <limits.h>
 
 #include "Flatland.h"
 #include "GLHelper.h"
@@ -37,24 +41,12 @@ using namespace ::android;
 
 static uint32_t g_SleepBetweenSamplesMs = 0;
 static bool     g_PresentToWindow       = false;
+static bool     g_UseSurfaceFlinger     = false;
 static size_t   g_BenchmarkNameLen      = 0;
 
-struct BenchmarkDesc {
-    // The name of the test.
-    const char* name;
+static Vector<BenchmarkDesc> g_Benchmarks;
 
-    // The dimensions of the space in which window layers are specified.
-    uint32_t width;
-    uint32_t height;
-
-    // The screen heights at which to run the test.
-    uint32_t runHeights[MAX_TEST_RUNS];
-
-    // The list of window layers.
-    LayerDesc layers[MAX_NUM_LAYERS];
-};
-
-static const BenchmarkDesc benchmarks[] = {
+static const BenchmarkDesc builtinBenchmarks[] = {
     { "16:10 Single Static Window",
         2560, 1600, { 800, 1600, 2400 },
         {
@@ -206,6 +198,16 @@ static const ShaderDesc shaders[] = {
     },
 };
 
+static size_t countLayers(const BenchmarkDesc& desc) {
+    size_t i;
+    for (i = 0; i < MAX_NUM_LAYERS; i++) {
+        if (desc.layers[i].rendererFactory == NULL) {
+            break;
+        }
+    }
+    return i;
+}
+
 class Layer {
 
 public:
@@ -482,16 +484,6 @@ private:
         return true;
     }
 
-    static size_t countLayers(const BenchmarkDesc& desc) {
-        size_t i;
-        for (i = 0; i < MAX_NUM_LAYERS; i++) {
-            if (desc.layers[i].rendererFactory == NULL) {
-                break;
-            }
-        }
-        return i;
-    }
-
     const BenchmarkDesc& mDesc;
     const size_t mInstance;
     const size_t mNumLayers;
@@ -509,6 +501,239 @@ private:
     Layer mLayers[MAX_NUM_LAYERS];
 };
 
+// Reads back what SurfaceFlinger dumps for the given argument, as
+// 'dumpsys SurfaceFlinger <arg>' shows it.
+static bool dumpSurfaceFlinger(const char* arg, String8* out) {
+    sp<IBinder> sf = defaultServiceManager()->checkService(
+            String16("SurfaceFlinger"));
+    if (sf == NULL) {
+        fprintf(stderr, "SurfaceFlinger service not found.\n");
+        return false;
+    }
+
+    int fds[2];
+    if (pipe(fds) < 0) {
+        fprintf(stderr, "pipe error: %s\n", strerror(errno));
+        return false;
+    }
+
+    // The dumps used here are a few KB, they fit in the pipe.
+    Vector<String16> args;
+    args.add(String16(arg));
+    status_t err = sf->dump(fds[1], args);
+    close(fds[1]);
+
+    out->clear();
+    char buf[4096];
+    ssize_t len;
+    while ((len = read(fds[0], buf, sizeof(buf))) > 0) {
+        out->append(buf, len);
+    }
+    close(fds[0]);
+
+    if (err != NO_ERROR) {
+        fprintf(stderr, "SurfaceFlinger dump error: %#x\n", err);
+        return false;
+    }
+    return true;
+}
+
+// Runs a benchmark with SurfaceFlinger doing the composition: each layer is
+// a surface, and every frame moves them in an animation transaction.  The
+// frames are timed with the present times SurfaceFlinger's FrameTracker
+// records for animations, so whatever HWC and GLES composition cost shows
+// up as frames taking more than one refresh.
+class SurfaceFlingerRunner {
+
+public:
+
+    SurfaceFlingerRunner(const BenchmarkDesc& desc) :
+        mDesc(desc),
+        mNumLayers(countLayers(desc)),
+        mGLHelper(NULL) {
+        for (size_t i = 0; i < MAX_NUM_LAYERS; i++) {
+            mSurfaces[i] = EGL_NO_SURFACE;
+            mRenderers[i] = NULL;
+            mComposers[i] = NULL;
+        }
+    }
+
+    // Sets up the layers scaled to fit the display, and returns the size
+    // of the scene.
+    bool setUp(uint32_t* outWidth, uint32_t* outHeight) {
+        ATRACE_CALL();
+
+        bool result;
+
+        mGLHelper = new GLHelper();
+        result = mGLHelper->setUp(shaders, NELEMS(shaders));
+        if (!result) {
+            return false;
+        }
+
+        uint32_t dw, dh;
+        result = mGLHelper->getDisplaySize(&dw, &dh);
+        if (!result) {
+            return false;
+        }
+
+        float scaleX = float(dw) / float(mDesc.width);
+        float scaleY = float(dh) / float(mDesc.height);
+        float scaleFactor = scaleX < scaleY ? scaleX : scaleY;
+        *outWidth = uint32_t(scaleFactor * float(mDesc.width));
+        *outHeight = uint32_t(scaleFactor * float(mDesc.height));
+
+        resetColorGenerator();
+
+        for (size_t i = 0; i < mNumLayers; i++) {
+            LayerDesc ld = mDesc.layers[i];
+            ld.x = int32_t(scaleFactor * float(ld.x));
+            ld.y = int32_t(scaleFactor * float(ld.y));
+            ld.width = uint32_t(scaleFactor * float(ld.width));
+            ld.height = uint32_t(scaleFactor * float(ld.height));
+
+            mComposers[i] = ld.composerFactory();
+            result = mComposers[i]->setUp(ld, mGLHelper);
+            if (!result) {
+                return false;
+            }
+
+            char name[32];
+            snprintf(name, sizeof(name), "flatland-%u", uint32_t(i));
+            result = mGLHelper->createLayerSurface(name, ld.width, ld.height,
+                    mComposers[i]->surfaceFlags(), int32_t(i),
+                    &mSurfaceControls[i], &mSurfaces[i]);
+            if (!result) {
+                return false;
+            }
+
+            mRenderers[i] = ld.rendererFactory();
+            result = mRenderers[i]->setUp(mGLHelper);
+            if (!result) {
+                return false;
+            }
+        }
+
+        return doFrame();
+    }
+
+    void tearDown() {
+        ATRACE_CALL();
+
+        for (size_t i = 0; i < mNumLayers; i++) {
+            if (mComposers[i] != NULL) {
+                mComposers[i]->tearDown();
+                delete mComposers[i];
+                mComposers[i] = NULL;
+            }
+            if (mRenderers[i] != NULL) {
+                mRenderers[i]->tearDown();
+                delete mRenderers[i];
+                mRenderers[i] = NULL;
+            }
+            if (mSurfaces[i] != EGL_NO_SURFACE) {
+                mGLHelper->destroySurface(&mSurfaces[i]);
+            }
+            mSurfaceControls[i].clear();
+        }
+
+        if (mGLHelper != NULL) {
+            mGLHelper->tearDown();
+            delete mGLHelper;
+            mGLHelper = NULL;
+        }
+    }
+
+    // Animates the given number of frames, and returns the present times
+    // of those SurfaceFlinger composed, along with the refresh period.
+    bool run(uint32_t numFrames, Vector<nsecs_t>* presentTimes,
+            nsecs_t* period) {
+        ATRACE_CALL();
+
+        String8 dump;
+        bool result;
+
+        result = dumpSurfaceFlinger("--latency-clear", &dump);
+        if (!result) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < numFrames; i++) {
+            result = doFrame();
+            if (!result) {
+                return false;
+            }
+        }
+
+        // Leave time for the last frames to reach the display.
+        usleep(100 * 1000);
+
+        result = dumpSurfaceFlinger("--latency", &dump);
+        if (!result) {
+            return false;
+        }
+
+        // The refresh period, then a line per frame:
+        // desired present, actual present, frame ready.
+        const char* p = dump.string();
+        int n;
+        long long value;
+        if (sscanf(p, "%lld%n", &value, &n) != 1) {
+            fprintf(stderr, "unexpected SurfaceFlinger latency dump.\n");
+            return false;
+        }
+        *period = value;
+        p += n;
+
+        long long desired, actual, ready;
+        presentTimes->clear();
+        while (sscanf(p, "%lld %lld %lld%n", &desired, &actual, &ready,
+                &n) == 3) {
+            p += n;
+            if (actual > 0 && actual < LLONG_MAX) {
+                presentTimes->add(actual);
+            }
+        }
+
+        return true;
+    }
+
+private:
+
+    bool doFrame() {
+        bool result;
+
+        for (size_t i = 0; i < mNumLayers; i++) {
+            result = mRenderers[i]->render(mSurfaces[i]);
+            if (!result) {
+                return false;
+            }
+        }
+
+        // An animation transaction waits for the previous one to be
+        // composed, which paces the frames to the display.
+        result = true;
+        SurfaceComposerClient::openGlobalTransaction();
+        SurfaceComposerClient::setAnimationTransaction();
+        for (size_t i = 0; i < mNumLayers && result; i++) {
+            result = mComposers[i]->composeSurface(mSurfaceControls[i]);
+        }
+        SurfaceComposerClient::closeGlobalTransaction();
+
+        return result;
+    }
+
+    const BenchmarkDesc& mDesc;
+    const size_t mNumLayers;
+
+    GLHelper* mGLHelper;
+
+    EGLSurface mSurfaces[MAX_NUM_LAYERS];
+    sp<SurfaceControl> mSurfaceControls[MAX_NUM_LAYERS];
+    Renderer* mRenderers[MAX_NUM_LAYERS];
+    Composer* mComposers[MAX_NUM_LAYERS];
+};
+
 static int cmpDouble(const double* lhs, const double* rhs) {
     if (*lhs < *rhs) {
         return -1;
@@ -611,21 +836,85 @@ done:
     return success;
 }
 
+// Run a single benchmark through SurfaceFlinger and print the average time
+// between the frames presented, and how many refreshes they missed.
+static bool runSurfaceFlingerTest(const BenchmarkDesc& b) {
+    // The animation frames SurfaceFlinger keeps track of at most.
+    const uint32_t numFrames = 120;
+    const uint32_t warmUpFrames = 8;
+
+    bool success = true;
+    Vector<nsecs_t> presentTimes;
+    nsecs_t period;
+    uint32_t w, h;
+
+    printf(" %-*s | ", g_BenchmarkNameLen, b.name);
+    fflush(stdout);
+
+    SurfaceFlingerRunner r(b);
+    if (!r.setUp(&w, &h)) {
+        fprintf(stderr, "error initializing runner.\n");
+        r.tearDown();
+        return false;
+    }
+    printf("%4d x %4d | ", w, h);
+    fflush(stdout);
+
+    success = r.run(warmUpFrames, &presentTimes, &period) &&
+            r.run(numFrames, &presentTimes, &period);
+    if (!success) {
+        goto done;
+    }
+
+    if (presentTimes.size() < 2) {
+        // Nothing moves, SurfaceFlinger has nothing to compose.
+        printf("    static");
+    } else {
+        size_t n = presentTimes.size();
+        uint32_t missed = 0;
+        for (size_t i = 1; i < n && period > 0; i++) {
+            nsecs_t refreshes = (presentTimes[i] - presentTimes[i-1] +
+                    period / 2) / period;
+            if (refreshes > 1) {
+                missed += uint32_t(refreshes - 1);
+            }
+        }
+        double frameTime = double(presentTimes[n-1] - presentTimes[0]) /
+                double(n - 1);
+        printf("%10.3f | %6u", frameTime / 1e6, missed);
+    }
+
+done:
+
+    printf("\n");
+    fflush(stdout);
+    r.tearDown();
+
+    return success;
+}
+
 static void printResultsTableHeader() {
     const char* scenario = "Scenario";
     size_t len = strlen(scenario);
     size_t leftPad = (g_BenchmarkNameLen - len) / 2;
     size_t rightPad = g_BenchmarkNameLen - len - leftPad;
-    printf(" %*s%s%*s | Resolution  | Time (ms)\n", leftPad, "",
-            "Scenario", rightPad, "");
+    printf(" %*s%s%*s | Resolution  | %s\n", leftPad, "",
+            "Scenario", rightPad, "", g_UseSurfaceFlinger ?
+            "Frame (ms) | Missed" : "Time (ms)");
 }
 
 // Run ALL the benchmarks!
 static bool runTests() {
     printResultsTableHeader();
 
-    for (size_t i = 0; i < NELEMS(benchmarks); i++) {
-        const BenchmarkDesc& b = benchmarks[i];
+    for (size_t i = 0; i < g_Benchmarks.size(); i++) {
+        const BenchmarkDesc& b = g_Benchmarks[i];
+        if (g_UseSurfaceFlinger) {
+            if (!runSurfaceFlingerTest(b)) {
+                return false;
+            }
+            continue;
+        }
         for (size_t j = 0; j < MAX_TEST_RUNS && b.runHeights[j]; j++) {
             if (!runTest(b, j)) {
                 return false;
@@ -638,8 +927,8 @@ static bool runTests() {
 // Return the length longest benchmark name.
 static size_t maxBenchmarkNameLen() {
     size_t maxLen = 0;
-    for (size_t i = 0; i < NELEMS(benchmarks); i++) {
-        const BenchmarkDesc& b = benchmarks[i];
+    for (size_t i = 0; i < g_Benchmarks.size(); i++) {
+        const BenchmarkDesc& b = g_Benchmarks[i];
         size_t len = strlen(b.name);
         if (len > maxLen) {
             maxLen = len;
@@ -654,6 +943,8 @@ static void showHelp(const char *cmd) {
     fprintf(stderr, "options include:\n"
                     "  -s N            sleep for N ms between samples\n"
                     "  -d              display the test frame to a window\n"
+                    "  -f FILE         run the scenarios described in FILE\n"
+                    "  -c              compose the layers with SurfaceFlinger\n"
                     "  --help          print this helpful message and exit\n"
             );
 }
@@ -672,7 +963,7 @@ int main(int argc, char** argv) {
             {     0,               0, 0,  0 }
         };
 
-        ret = getopt_long(argc, argv, "ds:",
+        ret = getopt_long(argc, argv, "cdf:s:",
                           long_options, &option_index);
 
         if (ret < 0) {
@@ -680,10 +971,20 @@ int main(int argc, char** argv) {
         }
 
         switch(ret) {
+            case 'c':
+                g_UseSurfaceFlinger = true;
+            break;
+
             case 'd':
                 g_PresentToWindow = true;
             break;
 
+            case 'f':
+                if (!loadBenchmarks(optarg, &g_Benchmarks)) {
+                    exit(2);
+                }
+            break;
+
             case 's':
                 g_SleepBetweenSamplesMs = atoi(optarg);
             break;
@@ -701,6 +1002,11 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (g_Benchmarks.isEmpty()) {
+        g_Benchmarks.appendArray(builtinBenchmarks,
+                NELEMS(builtinBenchmarks));
+    }
+
     g_BenchmarkNameLen = maxBenchmarkNameLen();
 
     printf(" cmdline:");
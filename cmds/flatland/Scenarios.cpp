@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Flatland.h"
+
+namespace android {
+
+static const struct {
+    const char* name;
+    Renderer* (*factory)();
+} renderers[] = {
+    { "staticGradient", staticGradient },
+};
+
+static const struct {
+    const char* name;
+    Composer* (*factory)();
+} composers[] = {
+    { "nocomp",         nocomp },
+    { "opaque",         opaque },
+    { "opaqueShrink",   opaqueShrink },
+    { "blend",          blend },
+    { "blendShrink",    blendShrink },
+};
+
+static char* skipSpaces(char* p) {
+    while (isspace(*p)) {
+        p++;
+    }
+    return p;
+}
+
+// Reads the next word, or the next quoted string, and moves past it.
+static char* nextToken(char** p) {
+    char* start = skipSpaces(*p);
+    char* end;
+
+    if (*start == '\0') {
+        return NULL;
+    }
+    if (*start == '"') {
+        start++;
+        end = strchr(start, '"');
+        if (end == NULL) {
+            return NULL;
+        }
+    } else {
+        end = start;
+        while (*end != '\0' && !isspace(*end)) {
+            end++;
+        }
+    }
+    *p = *end != '\0' ? end + 1 : end;
+    *end = '\0';
+    return start;
+}
+
+static bool nextInt(char** p, int32_t* value) {
+    char* token = nextToken(p);
+    char* end;
+
+    if (token == NULL) {
+        return false;
+    }
+    *value = strtol(token, &end, 10);
+    return *end == '\0';
+}
+
+static bool nextSize(char** p, uint32_t* value) {
+    int32_t v;
+    if (!nextInt(p, &v) || v <= 0) {
+        return false;
+    }
+    *value = uint32_t(v);
+    return true;
+}
+
+static bool parseScenario(char* p, BenchmarkDesc* b) {
+    const char* name = nextToken(&p);
+    if (name == NULL || !nextSize(&p, &b->width) ||
+            !nextSize(&p, &b->height)) {
+        return false;
+    }
+    b->name = strdup(name);
+
+    size_t i = 0;
+    while (*skipSpaces(p) != '\0') {
+        if (i == MAX_TEST_RUNS || !nextSize(&p, &b->runHeights[i])) {
+            return false;
+        }
+        i++;
+    }
+    return i > 0;
+}
+
+static bool parseLayer(char* p, LayerDesc* ld) {
+    const char* renderer = nextToken(&p);
+    const char* composer = nextToken(&p);
+    if (renderer == NULL || composer == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < NELEMS(renderers); i++) {
+        if (!strcmp(renderer, renderers[i].name)) {
+            ld->rendererFactory = renderers[i].factory;
+        }
+    }
+    for (int i = 0; i < NELEMS(composers); i++) {
+        if (!strcmp(composer, composers[i].name)) {
+            ld->composerFactory = composers[i].factory;
+        }
+    }
+    if (ld->rendererFactory == NULL || ld->composerFactory == NULL) {
+        return false;
+    }
+
+    return nextInt(&p, &ld->x) && nextInt(&p, &ld->y) &&
+            nextSize(&p, &ld->width) && nextSize(&p, &ld->height) &&
+            *skipSpaces(p) == '\0';
+}
+
+bool loadBenchmarks(const char* path, Vector<BenchmarkDesc>* benchmarks) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "can't open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    BenchmarkDesc b;
+    size_t numLayers = 0;
+    bool inScenario = false;
+    bool success = true;
+    char line[1024];
+    int lineNum = 0;
+
+    while (success && fgets(line, sizeof(line), f) != NULL) {
+        lineNum++;
+
+        char* p = skipSpaces(line);
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+
+        const char* keyword = nextToken(&p);
+        if (!strcmp(keyword, "scenario")) {
+            if (inScenario) {
+                if (numLayers == 0) {
+                    success = false;
+                    break;
+                }
+                benchmarks->add(b);
+            }
+            memset(&b, 0, sizeof(b));
+            numLayers = 0;
+            inScenario = true;
+            success = parseScenario(p, &b);
+        } else if (!strcmp(keyword, "layer")) {
+            success = inScenario && numLayers < MAX_NUM_LAYERS &&
+                    parseLayer(p, &b.layers[numLayers]);
+            numLayers++;
+        } else {
+            success = false;
+        }
+    }
+    fclose(f);
+
+    if (success && inScenario) {
+        success = numLayers > 0;
+        if (success) {
+            benchmarks->add(b);
+        }
+    }
+    if (!success) {
+        fprintf(stderr, "%s:%d: bad scenario description\n", path, lineNum);
+        return false;
+    }
+    if (!inScenario) {
+        fprintf(stderr, "%s: no scenarios\n", path);
+        return false;
+    }
+    return true;
+}
+
+} // namespace android
@@ -15,7 +15,9 @@
 */
 
 #include <sys/capability.h>
+#include <pthread.h>
 #include "installd.h"
+#include <cutils/iosched_policy.h>
 #include <diskusage/dirsize.h>
 #include <selinux/android.h>
 
@@ -27,6 +29,7 @@ dir_rec_t android_app_dir;
 dir_rec_t android_app_private_dir;
 dir_rec_t android_app_lib_dir;
 dir_rec_t android_media_dir;
+dir_rec_t android_trash_dir;
 dir_rec_array_t android_system_dirs;
 
 int install(const char *pkgname, uid_t uid, gid_t gid, const char *seinfo)
@@ -117,7 +120,7 @@ int uninstall(const char *pkgname, uid_t persona)
         return -1;
 
     /* delete contents AND directory, no exceptions */
-    return delete_dir_contents(pkgdir, 1, NULL);
+    return delete_dir_async(pkgdir);
 }
 
 int renamepkg(const char *oldpkgname, const char *newpkgname)
@@ -269,7 +272,7 @@ int delete_persona(uid_t persona)
     if (create_persona_path(data_path, persona)) {
         return -1;
     }
-    if (delete_dir_contents(data_path, 1, NULL)) {
+    if (delete_dir_async(data_path)) {
         return -1;
     }
 
@@ -277,7 +280,7 @@ int delete_persona(uid_t persona)
     if (create_persona_media_path(media_path, (userid_t) persona) == -1) {
         return -1;
     }
-    if (delete_dir_contents(media_path, 1, NULL) == -1) {
+    if (delete_dir_async(media_path) == -1) {
         return -1;
     }
 
@@ -295,37 +298,51 @@ int delete_cache(const char *pkgname, uid_t persona)
     return delete_dir_contents(cachedir, 0, 0);
 }
 
-/* Try to ensure free_size bytes of storage are available.
- * Returns 0 on success.
- * This is rather simple-minded because doing a full LRU would
- * be potentially memory-intensive, and without atime it would
- * also require that apps constantly modify file metadata even
- * when just reading from the cache, which is pretty awful.
+/* The cache directories of one user, internal or external, collected on
+ * a thread of its own.
  */
-int free_cache(int64_t free_size)
+typedef struct {
+    char basepath[PATH_MAX];
+    cache_t *cache;
+    pthread_t thread;
+} cache_root_t;
+
+#define MAX_CACHE_ROOTS     64
+#define MAX_CACHE_PASSES    4
+
+static void *collect_cache_root(void *arg)
+{
+    cache_root_t *root = arg;
+    //ALOGI("adding cache files from %s\n", root->basepath);
+    add_cache_files(root->cache, root->basepath, "cache");
+    return NULL;
+}
+
+static int add_cache_root(cache_root_t *roots, int *count, const char *basepath)
+{
+    if (*count >= MAX_CACHE_ROOTS) {
+        ALOGW("Too many cache roots, skipping %s\n", basepath);
+        return -1;
+    }
+    strcpy(roots[*count].basepath, basepath);
+    (*count)++;
+    return 0;
+}
+
+static int find_cache_roots(cache_root_t *roots)
 {
-    cache_t* cache;
-    int64_t avail;
     DIR *d;
     struct dirent *de;
     char tmpdir[PATH_MAX];
     char *dirpos;
+    int count = 0;
 
-    avail = data_disk_free();
-    if (avail < 0) return -1;
-
-    ALOGI("free_cache(%" PRId64 ") avail %" PRId64 "\n", free_size, avail);
-    if (avail >= free_size) return 0;
-
-    cache = start_cache_collection();
-
-    // Collect cache files for primary user.
+    // Primary user.
     if (create_persona_path(tmpdir, 0) == 0) {
-        //ALOGI("adding cache files from %s\n", tmpdir);
-        add_cache_files(cache, tmpdir, "cache");
+        add_cache_root(roots, &count, tmpdir);
     }
 
-    // Search for other users and add any cache files from them.
+    // Search for other users.
     snprintf(tmpdir, sizeof(tmpdir), "%s%s", android_data_dir.path,
             SECONDARY_USER_PREFIX);
     dirpos = tmpdir + strlen(tmpdir);
@@ -341,8 +358,7 @@ int free_cache(int64_t free_size)
                 }
                 if ((strlen(name)+(dirpos-tmpdir)) < (sizeof(tmpdir)-1)) {
                     strcpy(dirpos, name);
-                    //ALOGI("adding cache files from %s\n", tmpdir);
-                    add_cache_files(cache, tmpdir, "cache");
+                    add_cache_root(roots, &count, tmpdir);
                 } else {
                     ALOGW("Path exceeds limit: %s%s", tmpdir, name);
                 }
@@ -351,8 +367,8 @@ int free_cache(int64_t free_size)
         closedir(d);
     }
 
-    // Collect cache files on external storage for all users (if it is mounted as part
-    // of the internal storage).
+    // External storage for all users (if it is mounted as part of the
+    // internal storage).
     strcpy(tmpdir, android_media_dir.path);
     dirpos = tmpdir + strlen(tmpdir);
     d = opendir(tmpdir);
@@ -368,8 +384,7 @@ int free_cache(int64_t free_size)
                     strcpy(dirpos, name);
                     if (lookup_media_dir(tmpdir, "Android") == 0
                             && lookup_media_dir(tmpdir, "data") == 0) {
-                        //ALOGI("adding cache files from %s\n", tmpdir);
-                        add_cache_files(cache, tmpdir, "cache");
+                        add_cache_root(roots, &count, tmpdir);
                     }
                 } else {
                     ALOGW("Path exceeds limit: %s%s", tmpdir, name);
@@ -378,11 +393,67 @@ int free_cache(int64_t free_size)
         }
         closedir(d);
     }
+    return count;
+}
+
+/* Try to ensure free_size bytes of storage are available.
+ * Returns 0 on success.
+ * This is rather simple-minded because doing a full LRU would
+ * be potentially memory-intensive, and without atime it would
+ * also require that apps constantly modify file metadata even
+ * when just reading from the cache, which is pretty awful.
+ *
+ * The users' cache directories are walked in parallel, each walk only
+ * keeping the oldest files that are enough to free what's missing. They
+ * are deleted oldest first, until there is enough space. When the files
+ * turn out to take less space than they seemed to, it starts over with
+ * what's still missing.
+ */
+int free_cache(int64_t free_size)
+{
+    cache_root_t roots[MAX_CACHE_ROOTS];
+    cache_t* caches[MAX_CACHE_ROOTS];
+    int64_t avail;
+    int i, count, pass;
+    size_t deleted;
+
+    avail = data_disk_free();
+    if (avail < 0) return -1;
+
+    ALOGI("free_cache(%" PRId64 ") avail %" PRId64 "\n", free_size, avail);
+    if (avail >= free_size) return 0;
+
+    count = find_cache_roots(roots);
+    for (pass = 0; pass < MAX_CACHE_PASSES && avail < free_size; pass++) {
+        for (i = 0; i < count; i++) {
+            roots[i].cache = start_cache_collection(free_size - avail);
+            if (roots[i].cache == NULL ||
+                    pthread_create(&roots[i].thread, NULL, collect_cache_root, &roots[i])) {
+                ALOGE("Couldn't collect cache files from %s\n", roots[i].basepath);
+                free(roots[i].cache);
+                roots[i].cache = NULL;
+            }
+        }
+        int numCaches = 0;
+        for (i = 0; i < count; i++) {
+            if (roots[i].cache != NULL) {
+                pthread_join(roots[i].thread, NULL);
+                caches[numCaches++] = roots[i].cache;
+            }
+        }
 
-    clear_cache_files(cache, free_size);
-    finish_cache_collection(cache);
+        deleted = clear_cache_files(caches, numCaches, free_size);
+        for (i = 0; i < numCaches; i++) {
+            finish_cache_collection(caches[i]);
+        }
+
+        avail = data_disk_free();
+        if (deleted == 0) {
+            break;
+        }
+    }
 
-    return data_disk_free() >= free_size ? 0 : -1;
+    return avail >= free_size ? 0 : -1;
 }
 
 int move_dex(const char *src, const char *dst)
@@ -462,12 +533,7 @@ int get_size(const char *pkgname, int persona, const char *apkpath,
 
         /* add in size of any libraries */
     if (libdirpath != NULL && libdirpath[0] != '!') {
-        d = opendir(libdirpath);
-        if (d != NULL) {
-            dfd = dirfd(d);
-            codesize += calculate_dir_size(dfd);
-            closedir(d);
-        }
+        codesize += cached_dir_size(libdirpath);
     }
 
         /* compute asec size if it is given
@@ -496,7 +562,7 @@ int get_size(const char *pkgname, int persona, const char *apkpath,
         const char *name = de->d_name;
 
         if (de->d_type == DT_DIR) {
-            int subfd;
+            char subpath[PATH_MAX];
             int64_t statsize = 0;
             int64_t dirsize = 0;
                 /* always skip "." and ".." */
@@ -507,9 +573,8 @@ int get_size(const char *pkgname, int persona, const char *apkpath,
             if (fstatat(dfd, name, &s, AT_SYMLINK_NOFOLLOW) == 0) {
                 statsize = stat_size(&s);
             }
-            subfd = openat(dfd, name, O_RDONLY | O_DIRECTORY);
-            if (subfd >= 0) {
-                dirsize = calculate_dir_size(subfd);
+            if (snprintf(subpath, PATH_MAX, "%s/%s", path, name) < PATH_MAX) {
+                dirsize = cached_dir_size(subpath);
             }
             if(!strcmp(name,"lib")) {
                 codesize += dirsize + statsize;
@@ -637,7 +702,8 @@ static int wait_dexopt(pid_t pid, const char* apk_path)
     }
 }
 
-int dexopt(const char *apk_path, uid_t uid, int is_public)
+static int dexopt_impl(const char *apk_path, uid_t uid, int is_public,
+        int background)
 {
     struct utimbuf ut;
     struct stat apk_stat, dex_stat;
@@ -672,14 +738,16 @@ int dexopt(const char *apk_path, uid_t uid, int is_public)
     memset(&apk_stat, 0, sizeof(apk_stat));
     stat(apk_path, &apk_stat);
 
-    zip_fd = open(apk_path, O_RDONLY, 0);
+    /* the fds are passed to our child only, other dexopt children may be
+     * forked at the same time */
+    zip_fd = open(apk_path, O_RDONLY | O_CLOEXEC, 0);
     if (zip_fd < 0) {
         ALOGE("dexopt cannot open '%s' for input\n", apk_path);
         return -1;
     }
 
     unlink(dex_path);
-    odex_fd = open(dex_path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    odex_fd = open(dex_path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
     if (odex_fd < 0) {
         ALOGE("dexopt cannot open '%s' for output\n", dex_path);
         goto fail;
@@ -723,6 +791,12 @@ int dexopt(const char *apk_path, uid_t uid, int is_public)
             ALOGE("flock(%s) failed: %s\n", dex_path, strerror(errno));
             exit(67);
         }
+        fcntl(zip_fd, F_SETFD, 0);
+        fcntl(odex_fd, F_SETFD, 0);
+        if (background) {
+            /* stay out of the way of the foreground's reads and writes */
+            android_set_ioprio(0, IoSchedClass_BE, 7);
+        }
 
         run_dexopt(zip_fd, odex_fd, apk_path, dexopt_flags);
         exit(68);   /* only get here on exec failure */
@@ -753,6 +827,136 @@ fail:
     return -1;
 }
 
+int dexopt(const char *apk_path, uid_t uid, int is_public)
+{
+    return dexopt_impl(apk_path, uid, is_public, 0);
+}
+
+/*
+ * Batch dexopt: the APKs are optimized by up to dalvik.vm.dexopt-threads
+ * children at once (the number of CPUs by default). When
+ * dalvik.vm.dexopt-mem-budget is set (in MB), a child only starts while the
+ * estimated memory use of the running ones leaves room for it, but there's
+ * always at least one running.
+ */
+
+#define DEXOPT_MEM_BASE    (16LL << 20)  /* estimated use of a child, plus... */
+#define DEXOPT_MEM_FACTOR  2             /* ...this many times the APK size */
+#define DEXOPT_MAX_THREADS 16
+
+struct dexopt_batch {
+    const dexopt_item_t *items;
+    int count;
+    void (*progress)(void *cookie, int index, int res);
+    void *cookie;
+
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    int next;                   /* the next item to start */
+    int running;
+    int failed;
+    int64_t budget;             /* 0 if there is none */
+    int64_t reserved;           /* the estimates of the running children */
+};
+
+static int64_t dexopt_estimate(const char *apk_path)
+{
+    struct stat s;
+
+    if (stat(apk_path, &s) < 0) {
+        return DEXOPT_MEM_BASE;
+    }
+    return DEXOPT_MEM_BASE + DEXOPT_MEM_FACTOR * (int64_t)s.st_size;
+}
+
+static void *dexopt_batch_thread(void *arg)
+{
+    struct dexopt_batch *b = arg;
+    const dexopt_item_t *item;
+    int64_t estimate;
+    int index, res;
+
+    pthread_mutex_lock(&b->lock);
+    while (b->next < b->count) {
+        index = b->next++;
+        item = &b->items[index];
+        estimate = dexopt_estimate(item->apk_path);
+        while (b->budget && b->running &&
+                b->reserved + estimate > b->budget) {
+            pthread_cond_wait(&b->changed, &b->lock);
+        }
+        b->running++;
+        b->reserved += estimate;
+        pthread_mutex_unlock(&b->lock);
+
+        res = dexopt_impl(item->apk_path, item->uid, item->is_public, 1);
+        if (b->progress) {
+            b->progress(b->cookie, index, res);
+        }
+
+        pthread_mutex_lock(&b->lock);
+        b->running--;
+        b->reserved -= estimate;
+        if (res != 0) {
+            b->failed++;
+        }
+        pthread_cond_broadcast(&b->changed);
+    }
+    pthread_mutex_unlock(&b->lock);
+    return NULL;
+}
+
+int dexopt_batch(const dexopt_item_t *items, int count,
+                 void (*progress)(void *cookie, int index, int res), void *cookie)
+{
+    char value[PROPERTY_VALUE_MAX];
+    struct dexopt_batch b;
+    pthread_t threads[DEXOPT_MAX_THREADS];
+    int i, num_threads = 0, max_threads;
+
+    property_get("dalvik.vm.dexopt-threads", value, "");
+    max_threads = atoi(value);
+    if (max_threads <= 0) {
+        max_threads = sysconf(_SC_NPROCESSORS_CONF);
+    }
+    if (max_threads > DEXOPT_MAX_THREADS) {
+        max_threads = DEXOPT_MAX_THREADS;
+    }
+    if (max_threads > count) {
+        max_threads = count;
+    }
+    property_get("dalvik.vm.dexopt-mem-budget", value, "");
+
+    b.items = items;
+    b.count = count;
+    b.progress = progress;
+    b.cookie = cookie;
+    pthread_mutex_init(&b.lock, NULL);
+    pthread_cond_init(&b.changed, NULL);
+    b.next = 0;
+    b.running = 0;
+    b.failed = 0;
+    b.budget = (int64_t)atoi(value) << 20;
+    b.reserved = 0;
+
+    /* the calling thread runs its share too */
+    for (i = 1; i < max_threads; i++) {
+        if (pthread_create(&threads[num_threads], NULL, dexopt_batch_thread, &b)) {
+            ALOGE("failed to start dexopt thread: %s\n", strerror(errno));
+            break;
+        }
+        num_threads++;
+    }
+    dexopt_batch_thread(&b);
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&b.changed);
+    pthread_mutex_destroy(&b.lock);
+    return b.failed;
+}
+
 void mkinnerdirs(char* path, int basepos, mode_t mode, int uid, int gid,
         struct stat* statbuf)
 {
@@ -774,6 +978,56 @@ void mkinnerdirs(char* path, int basepos, mode_t mode, int uid, int gid,
     }
 }
 
+static int _chowntree(int dfd, uid_t uid, gid_t gid)
+{
+    DIR *d;
+    struct dirent *de;
+    int subfd, res = 0;
+
+    d = fdopendir(dfd);
+    if (d == NULL) {
+        close(dfd);
+        return 1;
+    }
+    while ((de = readdir(d))) {
+        const char *name = de->d_name;
+            /* always skip "." and ".." */
+        if (name[0] == '.') {
+            if (name[1] == 0) continue;
+            if ((name[1] == '.') && (name[2] == 0)) continue;
+        }
+        if (fchownat(dfd, name, uid, gid, AT_SYMLINK_NOFOLLOW) < 0) {
+            ALOGE("cannot chown %s: %s\n", name, strerror(errno));
+            res = 1;
+        }
+        if (de->d_type == DT_DIR) {
+            subfd = openat(dfd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+            if (subfd < 0 || _chowntree(subfd, uid, gid) != 0) {
+                res = 1;
+            }
+        }
+    }
+    closedir(d);
+    return res;
+}
+
+/* Gives path and everything below it to uid and gid. */
+static int chowntree(const char* path, uid_t uid, gid_t gid)
+{
+    int dfd;
+
+    if (lchown(path, uid, gid) < 0) {
+        ALOGE("cannot chown %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    dfd = open(path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+    if (dfd < 0) {
+        ALOGE("cannot open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    return _chowntree(dfd, uid, gid);
+}
+
 int movefileordir(char* srcpath, char* dstpath, int dstbasepos,
         int dstuid, int dstgid, struct stat* statbuf)
 {
@@ -807,6 +1061,19 @@ int movefileordir(char* srcpath, char* dstpath, int dstbasepos,
         return 0;
     }
 
+    if (lstat(dstpath, statbuf) < 0 && errno == ENOENT) {
+        // Nothing there yet: move the whole directory at once, and only
+        // fix up the owner of what's inside.
+        mkinnerdirs(dstpath, dstbasepos, S_IRWXU|S_IRWXG|S_IXOTH,
+                dstuid, dstgid, statbuf);
+        ALOGV("Renaming dir %s to %s (uid %d)\n", srcpath, dstpath, dstuid);
+        if (rename(srcpath, dstpath) >= 0) {
+            return chowntree(dstpath, dstuid, dstgid);
+        }
+        ALOGV("Unable to rename dir %s to %s: %s, moving its entries\n",
+            srcpath, dstpath, strerror(errno));
+    }
+
     d = opendir(srcpath);
     if (d == NULL) {
         ALOGW("Unable to opendir %s: %s\n", srcpath, strerror(errno));
@@ -852,6 +1119,191 @@ int movefileordir(char* srcpath, char* dstpath, int dstbasepos,
     return res;
 }
 
+/*
+ * The update commands are read in full first, giving a migration for each
+ * package line, with the moves of the path lines below it. Migrations
+ * sharing no package run concurrently, the others in the order found.
+ */
+
+#define MIGRATION_THREADS   4
+
+typedef struct move {
+    struct move* next;
+    int dstbasepos;
+    char srcpath[PKG_PATH_MAX];
+    char dstpath[PKG_PATH_MAX];
+} move_t;
+
+typedef struct migration {
+    struct migration* next;
+    char srcpkg[PKG_NAME_MAX];
+    char dstpkg[PKG_NAME_MAX];
+    int dstuid, dstgid;
+    move_t* moves;
+    move_t** tail;
+    int running;
+} migration_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    migration_t* pending;           /* in the order found, running ones too */
+} migration_plan_t;
+
+static int64_t now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static migration_t* add_migration(migration_t*** tail, const char* srcpkg,
+        const char* dstpkg, int dstuid, int dstgid)
+{
+    migration_t* m = (migration_t*)calloc(1, sizeof(migration_t));
+    if (m == NULL) {
+        ALOGE("Failure allocating migration from %s to %s\n", srcpkg, dstpkg);
+        return NULL;
+    }
+    strcpy(m->srcpkg, srcpkg);
+    strcpy(m->dstpkg, dstpkg);
+    m->dstuid = dstuid;
+    m->dstgid = dstgid;
+    m->tail = &m->moves;
+    **tail = m;
+    *tail = &m->next;
+    return m;
+}
+
+static void add_move(migration_t* m, const char* srcpath, const char* dstpath,
+        int dstbasepos)
+{
+    move_t* move = (move_t*)malloc(sizeof(move_t));
+    if (move == NULL) {
+        ALOGE("Failure allocating move of %s\n", srcpath);
+        return;
+    }
+    move->next = NULL;
+    move->dstbasepos = dstbasepos;
+    strcpy(move->srcpath, srcpath);
+    strcpy(move->dstpath, dstpath);
+    *m->tail = move;
+    m->tail = &move->next;
+}
+
+static int migrations_conflict(const migration_t* a, const migration_t* b)
+{
+    return !strcmp(a->srcpkg, b->srcpkg) || !strcmp(a->srcpkg, b->dstpkg) ||
+            !strcmp(a->dstpkg, b->srcpkg) || !strcmp(a->dstpkg, b->dstpkg);
+}
+
+/* the first migration that may start now, called with the lock held */
+static migration_t* next_migration(migration_plan_t* plan)
+{
+    migration_t *m, *p;
+
+    for (m = plan->pending; m; m = m->next) {
+        if (m->running) {
+            continue;
+        }
+        for (p = plan->pending; p != m; p = p->next) {
+            if (migrations_conflict(p, m)) {
+                break;
+            }
+        }
+        if (p == m) {
+            return m;
+        }
+    }
+    return NULL;
+}
+
+static void run_migration(migration_t* m)
+{
+    struct stat s;
+    move_t* move;
+    int count = 0, failed = 0;
+    int64_t start = now_ms();
+
+    for (move = m->moves; move; move = move->next) {
+        if (movefileordir(move->srcpath, move->dstpath, move->dstbasepos,
+                m->dstuid, m->dstgid, &s) != 0) {
+            failed++;
+        }
+        count++;
+    }
+    ALOGI("Moved %d paths from %s to %s in %lldms, %d failed\n", count,
+            m->srcpkg, m->dstpkg,
+            (long long)(now_ms() - start),
+            failed);
+}
+
+static void* migration_thread(void* arg)
+{
+    migration_plan_t* plan = (migration_plan_t*)arg;
+    migration_t *m, **pp;
+
+    pthread_mutex_lock(&plan->lock);
+    while (plan->pending != NULL) {
+        m = next_migration(plan);
+        if (m == NULL) {
+            pthread_cond_wait(&plan->changed, &plan->lock);
+            continue;
+        }
+        m->running = 1;
+        pthread_mutex_unlock(&plan->lock);
+
+        run_migration(m);
+
+        pthread_mutex_lock(&plan->lock);
+        for (pp = &plan->pending; *pp != m; pp = &(*pp)->next)
+            ;
+        *pp = m->next;
+        pthread_cond_broadcast(&plan->changed);
+        pthread_mutex_unlock(&plan->lock);
+
+        while (m->moves) {
+            move_t* next = m->moves->next;
+            free(m->moves);
+            m->moves = next;
+        }
+        free(m);
+        pthread_mutex_lock(&plan->lock);
+    }
+    pthread_mutex_unlock(&plan->lock);
+    return NULL;
+}
+
+static void run_migrations(migration_t* migrations)
+{
+    migration_plan_t plan;
+    pthread_t threads[MIGRATION_THREADS-1];
+    int i, num_threads = 0;
+    int64_t start = now_ms();
+
+    if (migrations == NULL) {
+        return;
+    }
+    pthread_mutex_init(&plan.lock, NULL);
+    pthread_cond_init(&plan.changed, NULL);
+    plan.pending = migrations;
+
+    for (i = 0; i < MIGRATION_THREADS-1; i++) {
+        if (pthread_create(&threads[num_threads], NULL, migration_thread, &plan) == 0) {
+            num_threads++;
+        }
+    }
+    migration_thread(&plan);
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_cond_destroy(&plan.changed);
+    pthread_mutex_destroy(&plan.lock);
+
+    ALOGI("Moved files in %lldms\n",
+            (long long)(now_ms() - start));
+}
+
 int movefiles()
 {
     DIR *d;
@@ -867,6 +1319,9 @@ int movefiles()
     char dstpath[PKG_PATH_MAX];
     int dstuid=-1, dstgid=-1;
     int hasspace;
+    migration_t* migrations = NULL;
+    migration_t** tail = &migrations;
+    migration_t* migration = NULL;
 
     d = opendir(UPDATE_COMMANDS_DIR_PREFIX);
     if (d == NULL) {
@@ -894,6 +1349,7 @@ int movefiles()
             bufe = 0;
             buf[PKG_PATH_MAX] = 0;
             srcpkg[0] = dstpkg[0] = 0;
+            migration = NULL;
             while (1) {
                 bufi = bufp;
                 while (bufi < bufe && buf[bufi] != '\n') {
@@ -913,15 +1369,14 @@ int movefiles()
                         if (dstpkg[0] == 0) {
                             ALOGW("Path before package line in %s%s: %s\n",
                                     UPDATE_COMMANDS_DIR_PREFIX, name, buf+bufp);
-                        } else if (srcpkg[0] == 0) {
+                        } else if (srcpkg[0] == 0 || migration == NULL) {
                             // Skip -- source package no longer exists.
                         } else {
                             ALOGV("Move file: %s (from %s to %s)\n", buf+bufp, srcpkg, dstpkg);
                             if (!create_move_path(srcpath, srcpkg, buf+bufp, 0) &&
                                     !create_move_path(dstpath, dstpkg, buf+bufp, 0)) {
-                                movefileordir(srcpath, dstpath,
-                                        strlen(dstpath)-strlen(buf+bufp),
-                                        dstuid, dstgid, &s);
+                                add_move(migration, srcpath, dstpath,
+                                        strlen(dstpath)-strlen(buf+bufp));
                             }
                         }
                     } else {
@@ -978,6 +1433,11 @@ int movefiles()
                                 ALOGV("Transfering from %s to %s: uid=%d\n",
                                     srcpkg, dstpkg, dstuid);
                             }
+                            migration = NULL;
+                            if (srcpkg[0] != 0) {
+                                migration = add_migration(&tail, srcpkg, dstpkg,
+                                        dstuid, dstgid);
+                            }
                         }
                     }
                     bufp = bufi+1;
@@ -1009,6 +1469,7 @@ int movefiles()
         }
     }
     closedir(d);
+    run_migrations(migrations);
 done:
     return 0;
 }
@@ -16,6 +16,7 @@
 
 #include <sys/capability.h>
 #include <linux/prctl.h>
+#include <pthread.h>
 
 #include "installd.h"
 
@@ -23,6 +24,9 @@
 #define BUFFER_MAX    1024  /* input buffer for commands */
 #define TOKEN_MAX     8     /* max number of arguments in buffer */
 #define REPLY_MAX     256   /* largest reply allowed */
+#define MAX_WORKERS   4     /* threads running pipelined commands */
+#define MAX_QUEUED    64    /* pipelined commands in flight, per installd */
+#define BATCH_MAX     4096  /* commands in one batch */
 
 static int do_ping(char **arg, char reply[REPLY_MAX])
 {
@@ -122,29 +126,34 @@ static int do_linklib(char **arg, char reply[REPLY_MAX])
     return linklib(arg[0], arg[1], atoi(arg[2]));
 }
 
+/* what a pipelined command must be ordered with, see below */
+#define KEY_NONE      (-1)  /* nothing, it touches no package */
+#define KEY_ALL       (-2)  /* everything, it may touch any package */
+
 struct cmdinfo {
     const char *name;
     unsigned numargs;
     int (*func)(char **arg, char reply[REPLY_MAX]);
+    int key;    /* the argument naming the package or path, or KEY_* */
 };
 
 struct cmdinfo cmds[] = {
-    { "ping",                 0, do_ping },
-    { "install",              4, do_install },
-    { "dexopt",               3, do_dexopt },
-    { "movedex",              2, do_move_dex },
-    { "rmdex",                1, do_rm_dex },
-    { "remove",               2, do_remove },
-    { "rename",               2, do_rename },
-    { "fixuid",               3, do_fixuid },
-    { "freecache",            1, do_free_cache },
-    { "rmcache",              2, do_rm_cache },
-    { "getsize",              6, do_get_size },
-    { "rmuserdata",           2, do_rm_user_data },
-    { "movefiles",            0, do_movefiles },
-    { "linklib",              3, do_linklib },
-    { "mkuserdata",           4, do_mk_user_data },
-    { "rmuser",               1, do_rm_user },
+    { "ping",                 0, do_ping,           KEY_NONE },
+    { "install",              4, do_install,        0 },
+    { "dexopt",               3, do_dexopt,         0 },
+    { "movedex",              2, do_move_dex,       0 },
+    { "rmdex",                1, do_rm_dex,         0 },
+    { "remove",               2, do_remove,         0 },
+    { "rename",               2, do_rename,         KEY_ALL },
+    { "fixuid",               3, do_fixuid,         0 },
+    { "freecache",            1, do_free_cache,     KEY_ALL },
+    { "rmcache",              2, do_rm_cache,       0 },
+    { "getsize",              6, do_get_size,       0 },
+    { "rmuserdata",           2, do_rm_user_data,   0 },
+    { "movefiles",            0, do_movefiles,      KEY_ALL },
+    { "linklib",              3, do_linklib,        0 },
+    { "mkuserdata",           4, do_mk_user_data,   0 },
+    { "rmuser",               1, do_rm_user,        KEY_ALL },
 };
 
 static int readx(int s, void *_buf, int count)
@@ -186,25 +195,13 @@ static int writex(int s, const void *_buf, int count)
 }
 
 
-/* Tokenize the command buffer, locate a matching command,
- * ensure that the required number of arguments are provided,
- * call the function(), return the result.
+/* Tokenize the command buffer into arg[], returns the number of
+ * arguments (not counting arg[0]), or -1 if there are too many.
  */
-static int execute(int s, char cmd[BUFFER_MAX])
+static int tokenize(char *cmd, char *arg[TOKEN_MAX+1])
 {
-    char reply[REPLY_MAX];
-    char *arg[TOKEN_MAX+1];
-    unsigned i;
     unsigned n = 0;
-    unsigned short count;
-    int ret = -1;
 
-//    ALOGI("execute('%s')\n", cmd);
-
-        /* default reply is "" */
-    reply[0] = 0;
-
-        /* n is number of args (not counting arg[0]) */
     arg[0] = cmd;
     while (*cmd) {
         if (isspace(*cmd)) {
@@ -213,37 +210,505 @@ static int execute(int s, char cmd[BUFFER_MAX])
             arg[n] = cmd;
             if (n == TOKEN_MAX) {
                 ALOGE("too many arguments\n");
-                goto done;
+                return -1;
             }
         }
         cmd++;
     }
+    return n;
+}
+
+/* Locate the command matching arg[0] and ensure that the required
+ * number of arguments are provided.
+ */
+static const struct cmdinfo *find_command(char *arg[TOKEN_MAX+1], unsigned n)
+{
+    unsigned i;
 
     for (i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++) {
         if (!strcmp(cmds[i].name,arg[0])) {
             if (n != cmds[i].numargs) {
                 ALOGE("%s requires %d arguments (%d given)\n",
                      cmds[i].name, cmds[i].numargs, n);
-            } else {
-                ret = cmds[i].func(arg + 1, reply);
+                return NULL;
             }
-            goto done;
+            return &cmds[i];
         }
     }
     ALOGE("unsupported command '%s'\n", arg[0]);
+    return NULL;
+}
 
-done:
-    if (reply[0]) {
-        n = snprintf(cmd, BUFFER_MAX, "%d %s", ret, reply);
+/* Send the result, prefixed by the command's id if it has one, using
+ * buf to format it.
+ */
+static int send_reply(int s, char buf[BUFFER_MAX], const char *id,
+        int ret, const char *reply)
+{
+    unsigned n;
+    unsigned short count;
+
+    if (id) {
+        n = snprintf(buf, BUFFER_MAX, "%s %d", id, ret);
     } else {
-        n = snprintf(cmd, BUFFER_MAX, "%d", ret);
+        n = snprintf(buf, BUFFER_MAX, "%d", ret);
+    }
+    if (reply[0] && n < BUFFER_MAX) {
+        n += snprintf(buf + n, BUFFER_MAX - n, " %s", reply);
     }
     if (n > BUFFER_MAX) n = BUFFER_MAX;
     count = n;
 
-//    ALOGI("reply: '%s'\n", cmd);
+//    ALOGI("reply: '%s'\n", buf);
     if (writex(s, &count, sizeof(count))) return -1;
-    if (writex(s, cmd, count)) return -1;
+    if (writex(s, buf, count)) return -1;
+    return 0;
+}
+
+/* Tokenize the command buffer, locate a matching command,
+ * ensure that the required number of arguments are provided,
+ * call the function(), return the result.
+ */
+static int execute(int s, char cmd[BUFFER_MAX])
+{
+    char reply[REPLY_MAX];
+    char *arg[TOKEN_MAX+1];
+    const struct cmdinfo *info;
+    int n;
+    int ret = -1;
+
+//    ALOGI("execute('%s')\n", cmd);
+
+        /* default reply is "" */
+    reply[0] = 0;
+
+        /* n is number of args (not counting arg[0]) */
+    n = tokenize(cmd, arg);
+    if (n >= 0) {
+        info = find_command(arg, n);
+        if (info) {
+            ret = info->func(arg + 1, reply);
+        }
+    }
+
+    return send_reply(s, cmd, NULL, ret, reply);
+}
+
+/*
+ * Pipelined commands.
+ *
+ * Once a client has sent "pipeline", every command it sends starts with an
+ * id of its choosing, and so does the reply, e.g. "17 getsize ..." gets
+ * "17 0 1234 ...". It may send more commands without waiting for the
+ * replies, which come back as the commands complete. The commands run on a
+ * pool of workers:
+ * - those naming the same package (or path) run in the order received,
+ * - those that may touch any package (KEY_ALL) run alone, after the
+ *   commands received before them and before those received after them,
+ * - the others (KEY_NONE) run whenever a worker is free.
+ */
+
+struct connection {
+    int s;
+    int queued;                 /* commands not replied to yet */
+    pthread_mutex_t write_lock; /* held for the whole of a reply */
+};
+
+struct request {
+    struct request *next;
+    struct connection *conn;
+    const struct cmdinfo *info;
+    char *arg[TOKEN_MAX+1];     /* arg[0] is the id, arg[1] the command */
+    int running;
+    char buf[BUFFER_MAX];
+};
+
+/* the requests in the order received, the running ones included */
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_changed = PTHREAD_COND_INITIALIZER;
+static struct request *queue_head;
+static int queue_size;
+static int num_workers;
+
+static const char *request_key(const struct request *r)
+{
+    return (r->info->key >= 0) ? r->arg[2 + r->info->key] : NULL;
+}
+
+/* the first request that may start now, called with queue_lock held */
+static struct request *next_runnable()
+{
+    struct request *r, *p;
+    const char *key;
+    int barrier = 0;
+
+    for (r = queue_head; r; r = r->next) {
+        if (r->info->key == KEY_NONE) {
+            if (!r->running) {
+                return r;
+            }
+        } else if (r->info->key == KEY_ALL) {
+            /* nothing before it may still be running */
+            if (!r->running && r == queue_head) {
+                return r;
+            }
+            barrier = 1;
+        } else if (!r->running && !barrier) {
+            key = request_key(r);
+            for (p = queue_head; p != r; p = p->next) {
+                if (p->info->key >= 0 && !strcmp(request_key(p), key)) {
+                    break;
+                }
+            }
+            if (p == r) {
+                return r;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void *worker(void *unused)
+{
+    char out[BUFFER_MAX];
+    char reply[REPLY_MAX];
+    struct request *r, **pp;
+    struct connection *conn;
+    int ret;
+
+    pthread_mutex_lock(&queue_lock);
+    for (;;) {
+        while ((r = next_runnable()) == NULL) {
+            pthread_cond_wait(&queue_changed, &queue_lock);
+        }
+        r->running = 1;
+        pthread_mutex_unlock(&queue_lock);
+
+        reply[0] = 0;
+        ret = r->info->func(r->arg + 2, reply);
+
+        conn = r->conn;
+        pthread_mutex_lock(&conn->write_lock);
+        send_reply(conn->s, out, r->arg[0], ret, reply);
+        pthread_mutex_unlock(&conn->write_lock);
+
+        pthread_mutex_lock(&queue_lock);
+        for (pp = &queue_head; *pp != r; pp = &(*pp)->next)
+            ;
+        *pp = r->next;
+        queue_size--;
+        conn->queued--;
+        free(r);
+        /* this may unblock other requests, the reader, or the end of
+         * the connection */
+        pthread_cond_broadcast(&queue_changed);
+    }
+    return NULL;
+}
+
+static int start_workers()
+{
+    pthread_t thread;
+    long cpus;
+    int i;
+
+    cpus = sysconf(_SC_NPROCESSORS_CONF);
+    num_workers = (cpus < 1) ? 1 : ((cpus > MAX_WORKERS) ? MAX_WORKERS : cpus);
+    for (i = 0; i < num_workers; i++) {
+        if (pthread_create(&thread, NULL, worker, NULL)) {
+            ALOGE("failed to start worker: %s\n", strerror(errno));
+            return -1;
+        }
+        pthread_detach(thread);
+    }
+    return 0;
+}
+
+/*
+ * Batches.
+ *
+ * "<batch> <count>" is followed by <count> messages holding the arguments
+ * of one command each:
+ * - "dexoptbatch" takes those of dexopt, the APKs are optimized in
+ *   parallel, see dexopt_batch(),
+ * - "getsizes" takes those of getsize, the packages are scanned in
+ *   parallel.
+ * As each one completes, "progress <index> <res> [<reply>]" is sent (after
+ * the id, when pipelined). The reply then gives the number that failed.
+ * A batch runs alone, after any pipelined commands received before it.
+ */
+
+struct batch_entry {
+    char *arg[TOKEN_MAX+1];
+    char buf[];
+};
+
+struct batch {
+    struct connection *conn;
+    const char *id;
+    const struct cmdinfo *info;     /* the command of each entry */
+    struct batch_entry **entries;
+    int count;
+
+    /* for run_parallel() */
+    pthread_mutex_t lock;
+    int next;
+    int failed;
+};
+
+struct batchinfo {
+    const char *name;
+    const char *cmd;
+    int (*run)(struct batch *b);    /* returns the number that failed */
+};
+
+static void send_progress(struct batch *b, int index, int res, const char *reply)
+{
+    char buf[BUFFER_MAX];
+    unsigned n;
+    unsigned short count;
+
+    if (b->id) {
+        n = snprintf(buf, BUFFER_MAX, "%s progress %d %d", b->id, index, res);
+    } else {
+        n = snprintf(buf, BUFFER_MAX, "progress %d %d", index, res);
+    }
+    if (reply[0] && n < BUFFER_MAX) {
+        n += snprintf(buf + n, BUFFER_MAX - n, " %s", reply);
+    }
+    if (n > BUFFER_MAX) n = BUFFER_MAX;
+    count = n;
+
+    pthread_mutex_lock(&b->conn->write_lock);
+    if (!writex(b->conn->s, &count, sizeof(count))) {
+        writex(b->conn->s, buf, count);
+    }
+    pthread_mutex_unlock(&b->conn->write_lock);
+}
+
+static void send_dexopt_progress(void *cookie, int index, int res)
+{
+    send_progress(cookie, index, res, "");
+}
+
+static int run_dexopt(struct batch *b)
+{
+    dexopt_item_t *items;
+    int i, failed;
+
+    items = calloc(b->count, sizeof(*items));
+    if (items == NULL) {
+        ALOGE("out of memory\n");
+        return b->count;
+    }
+    for (i = 0; i < b->count; i++) {
+            /* apk_path, uid, is_public */
+        items[i].apk_path = b->entries[i]->arg[0];
+        items[i].uid = atoi(b->entries[i]->arg[1]);
+        items[i].is_public = atoi(b->entries[i]->arg[2]);
+    }
+    failed = dexopt_batch(items, b->count, send_dexopt_progress, b);
+    free(items);
+    return failed;
+}
+
+static void *run_parallel_thread(void *arg)
+{
+    struct batch *b = arg;
+    char reply[REPLY_MAX];
+    int index, res;
+
+    pthread_mutex_lock(&b->lock);
+    while (b->next < b->count) {
+        index = b->next++;
+        pthread_mutex_unlock(&b->lock);
+
+        reply[0] = 0;
+        res = b->info->func(b->entries[index]->arg, reply);
+        send_progress(b, index, res, reply);
+
+        pthread_mutex_lock(&b->lock);
+        if (res != 0) {
+            b->failed++;
+        }
+    }
+    pthread_mutex_unlock(&b->lock);
+    return NULL;
+}
+
+/* run the entries on as many threads as there are workers */
+static int run_parallel(struct batch *b)
+{
+    pthread_t threads[MAX_WORKERS];
+    int i, num_threads = 0;
+
+    pthread_mutex_init(&b->lock, NULL);
+    b->next = 0;
+    b->failed = 0;
+
+        /* the calling thread runs its share too */
+    for (i = 1; i < num_workers && i < b->count; i++) {
+        if (pthread_create(&threads[num_threads], NULL, run_parallel_thread, b)) {
+            ALOGE("failed to start batch thread: %s\n", strerror(errno));
+            break;
+        }
+        num_threads++;
+    }
+    run_parallel_thread(b);
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&b->lock);
+    return b->failed;
+}
+
+struct batchinfo batches[] = {
+    { "dexoptbatch",          "dexopt",             run_dexopt },
+    { "getsizes",             "getsize",            run_parallel },
+};
+
+static const struct batchinfo *find_batch(const char *name, size_t len)
+{
+    unsigned i;
+
+    for (i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+        if (strlen(batches[i].name) == len && !strncmp(batches[i].name, name, len)) {
+            return &batches[i];
+        }
+    }
+    return NULL;
+}
+
+static int execute_batch(struct connection *conn, const char *id,
+        const struct batchinfo *info, int count)
+{
+    char buf[BUFFER_MAX];
+    char reply[REPLY_MAX];
+    struct batch b;
+    unsigned short size;
+    int i, n, failed, ret = -1;
+
+    if ((count < 1) || (count > BATCH_MAX)) {
+        ALOGE("invalid batch size %d\n", count);
+        return -1;
+    }
+    b.conn = conn;
+    b.id = id;
+    b.info = NULL;
+    for (i = 0; i < (int)(sizeof(cmds) / sizeof(cmds[0])); i++) {
+        if (!strcmp(cmds[i].name, info->cmd)) {
+            b.info = &cmds[i];
+        }
+    }
+    b.count = count;
+    b.entries = calloc(count, sizeof(*b.entries));
+    if (b.entries == NULL) {
+        ALOGE("out of memory\n");
+        return -1;
+    }
+
+        /* read all of the batch, even when some of it isn't valid */
+    failed = 0;
+    for (i = 0; i < count; i++) {
+        if (readx(conn->s, &size, sizeof(size)) ||
+                (size < 1) || (size >= BUFFER_MAX) ||
+                readx(conn->s, buf, size)) {
+            ALOGE("failed to read batch\n");
+            goto done;
+        }
+        buf[size] = 0;
+        b.entries[i] = malloc(sizeof(struct batch_entry) + size + 1);
+        if (b.entries[i] == NULL) {
+            ALOGE("out of memory\n");
+            failed = 1;
+            continue;
+        }
+        memcpy(b.entries[i]->buf, buf, size + 1);
+        n = tokenize(b.entries[i]->buf, b.entries[i]->arg);
+        if (n + 1 != (int)b.info->numargs) {
+            ALOGE("%s requires %d arguments (%d given)\n",
+                 b.info->name, b.info->numargs, n + 1);
+            failed = 1;
+        }
+    }
+
+    if (failed) {
+        failed = count;
+    } else {
+        failed = info->run(&b);
+    }
+    snprintf(reply, REPLY_MAX, "%d", failed);
+    pthread_mutex_lock(&conn->write_lock);
+    ret = send_reply(conn->s, buf, id, failed ? -1 : 0, reply);
+    pthread_mutex_unlock(&conn->write_lock);
+
+done:
+    for (i = 0; i < count; i++) {
+        free(b.entries[i]);
+    }
+    free(b.entries);
+    return ret;
+}
+
+/* wait for the replies to the connection's pipelined commands */
+static void drain(struct connection *conn)
+{
+    pthread_mutex_lock(&queue_lock);
+    while (conn->queued) {
+        pthread_cond_wait(&queue_changed, &queue_lock);
+    }
+    pthread_mutex_unlock(&queue_lock);
+}
+
+/* Hand a pipelined command to the workers, or reply right away when it
+ * isn't valid.
+ */
+static int enqueue(struct connection *conn, char cmd[BUFFER_MAX])
+{
+    const struct batchinfo *batch;
+    char *id;
+    struct request *r, **pp;
+    int n;
+
+    r = malloc(sizeof(*r));
+    if (r == NULL) {
+        ALOGE("out of memory\n");
+        return -1;
+    }
+    memcpy(r->buf, cmd, BUFFER_MAX);
+    r->next = NULL;
+    r->conn = conn;
+    r->running = 0;
+
+        /* arg[0] is the id, n is the number of args not counting it */
+    n = tokenize(r->buf, r->arg);
+    if (n == 2 && (batch = find_batch(r->arg[1], strlen(r->arg[1])))) {
+        drain(conn);
+        n = execute_batch(conn, r->arg[0], batch, atoi(r->arg[2]));
+        free(r);
+        return n;
+    }
+    r->info = (n >= 1) ? find_command(r->arg + 1, n - 1) : NULL;
+    if (r->info == NULL) {
+        id = (n >= 0) ? r->arg[0] : "-1";
+        pthread_mutex_lock(&conn->write_lock);
+        n = send_reply(conn->s, cmd, id, -1, "");
+        pthread_mutex_unlock(&conn->write_lock);
+        free(r);
+        return n;
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    while (queue_size >= MAX_QUEUED) {
+        pthread_cond_wait(&queue_changed, &queue_lock);
+    }
+    for (pp = &queue_head; *pp; pp = &(*pp)->next)
+        ;
+    *pp = r;
+    queue_size++;
+    conn->queued++;
+    pthread_cond_broadcast(&queue_changed);
+    pthread_mutex_unlock(&queue_lock);
     return 0;
 }
 
@@ -299,6 +764,11 @@ int initialize_globals() {
         return -1;
     }
 
+    // Get the directory of what's being deleted in the background.
+    if (copy_and_append(&android_trash_dir, &android_data_dir, TRASH_SUBDIR) < 0) {
+        return -1;
+    }
+
     // Take note of the system and vendor directories.
     android_system_dirs.count = 2;
 
@@ -469,6 +939,12 @@ int initialize_directories() {
         goto fail;
     }
 
+    // The trash is optional, without it directories are deleted in the
+    // foreground.
+    if (fs_prepare_dir(android_trash_dir.path, 0700, AID_INSTALL, AID_INSTALL) == -1) {
+        ALOGW("Failed to prepare %s", android_trash_dir.path);
+    }
+
     // Persist layout version if changed
     if (version != oldVersion) {
         if (fs_write_atomic_int(version_path, version) == -1) {
@@ -530,7 +1006,10 @@ int main(const int argc, const char *argv[]) {
     char buf[BUFFER_MAX];
     struct sockaddr addr;
     socklen_t alen;
-    int lsocket, s, count;
+    int lsocket, s, count, pipelined;
+    struct connection conn;
+    const struct batchinfo *batch;
+    char *sep;
 
     ALOGI("installd firing up\n");
 
@@ -557,6 +1036,12 @@ int main(const int argc, const char *argv[]) {
     }
     fcntl(lsocket, F_SETFD, FD_CLOEXEC);
 
+    if (start_workers() < 0) {
+        exit(1);
+    }
+    start_trash_deleter();
+    pthread_mutex_init(&conn.write_lock, NULL);
+
     for (;;) {
         alen = sizeof(addr);
         s = accept(lsocket, &addr, &alen);
@@ -567,6 +1052,9 @@ int main(const int argc, const char *argv[]) {
         fcntl(s, F_SETFD, FD_CLOEXEC);
 
         ALOGI("new connection\n");
+        conn.s = s;
+        conn.queued = 0;
+        pipelined = 0;
         for (;;) {
             unsigned short count;
             if (readx(s, &count, sizeof(count))) {
@@ -582,9 +1070,20 @@ int main(const int argc, const char *argv[]) {
                 break;
             }
             buf[count] = 0;
-            if (execute(s, buf)) break;
+            if (pipelined) {
+                if (enqueue(&conn, buf)) break;
+            } else if ((sep = strchr(buf, ' ')) &&
+                    (batch = find_batch(buf, sep - buf))) {
+                if (execute_batch(&conn, NULL, batch, atoi(sep + 1))) break;
+            } else if (!strcmp(buf, "pipeline")) {
+                pipelined = 1;
+                if (send_reply(s, buf, NULL, 0, "")) break;
+            } else {
+                if (execute(s, buf)) break;
+            }
         }
         ALOGI("closing connection\n");
+        drain(&conn);
         close(s);
     }
 
@@ -68,6 +68,8 @@
 
 #define MEDIA_SUBDIR           "media/" // sub-directory under ANDROID_DATA
 
+#define TRASH_SUBDIR           "installd-trash/" // sub-directory under ANDROID_DATA
+
 /* other handy constants */
 
 #define PRIVATE_APP_SUBDIR     "app-private/" // sub-directory under ANDROID_DATA
@@ -103,6 +105,7 @@ extern dir_rec_t android_data_dir;
 extern dir_rec_t android_datadata_dir;
 extern dir_rec_t android_asec_dir;
 extern dir_rec_t android_media_dir;
+extern dir_rec_t android_trash_dir;
 extern dir_rec_array_t android_system_dirs;
 
 typedef struct cache_dir_struct {
@@ -116,6 +119,7 @@ typedef struct cache_dir_struct {
 typedef struct {
     cache_dir_t* dir;
     time_t modTime;
+    int64_t size;
     char name[];
 } cache_file_t;
 
@@ -123,9 +127,14 @@ typedef struct {
     size_t numDirs;
     size_t availDirs;
     cache_dir_t** dirs;
+    // The oldest files that add up to at least "need" bytes, in a heap with
+    // the newest one first. Only the candidates are kept, the other files
+    // are just counted in their directory.
     size_t numFiles;
     size_t availFiles;
     cache_file_t** files;
+    int64_t need;
+    int64_t candidateSize;
     size_t numCollected;
     void* memBlocks;
     int8_t* curMemBlockAvail;
@@ -164,15 +173,19 @@ int delete_dir_contents(const char *pathname,
 
 int delete_dir_contents_fd(int dfd, const char *name);
 
+int start_trash_deleter();
+
+int delete_dir_async(const char *pathname);
+
 int lookup_media_dir(char basepath[PATH_MAX], const char *dir);
 
 int64_t data_disk_free();
 
-cache_t* start_cache_collection();
+cache_t* start_cache_collection(int64_t need);
 
 void add_cache_files(cache_t* cache, const char *basepath, const char *cachedir);
 
-void clear_cache_files(cache_t* cache, int64_t free_size);
+size_t clear_cache_files(cache_t** caches, size_t count, int64_t free_size);
 
 void finish_cache_collection(cache_t* cache);
 
@@ -194,6 +207,10 @@ char *build_string3(char *s1, char *s2, char *s3);
 int ensure_dir(const char* path, mode_t mode, uid_t uid, gid_t gid);
 int ensure_media_user_dirs(userid_t userid);
 
+/* sizecache.c */
+
+int64_t cached_dir_size(const char *path);
+
 /* commands.c */
 
 int install(const char *pkgname, uid_t uid, gid_t gid, const char *seinfo);
@@ -212,5 +229,14 @@ int get_size(const char *pkgname, int persona, const char *apkpath, const char *
              int64_t *datasize, int64_t *cachesize, int64_t *asecsize);
 int free_cache(int64_t free_size);
 int dexopt(const char *apk_path, uid_t uid, int is_public);
+
+typedef struct {
+    char *apk_path;
+    uid_t uid;
+    int is_public;
+} dexopt_item_t;
+
+int dexopt_batch(const dexopt_item_t *items, int count,
+                 void (*progress)(void *cookie, int index, int res), void *cookie);
 int movefiles();
 int linklib(const char* target, const char* source, int userId);
@@ -0,0 +1,402 @@
+/*
+** Copyright 2013, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <sys/inotify.h>
+#include <pthread.h>
+
+#include "installd.h"
+#include <diskusage/dirsize.h>
+
+/*
+ * Directory sizes, kept until something changes below the directory.
+ *
+ * Summing up the size of a directory means a fstatat() per file, which
+ * takes long for packages with many files. Each directory walked gets an
+ * inotify watch, and the size is dropped as soon as one of them reports
+ * an event: a file written, created, removed, renamed, ...  The events are
+ * read whenever a size is looked up, so no thread is needed for them.
+ *
+ * An entry owns the watches of its last walk until its size is dropped.
+ * They're then removed, once no walk is going on: a walk in progress may
+ * have been handed the same descriptor by inotify_add_watch() for a
+ * directory it shares. When the watches can't be added the size isn't
+ * kept, and running out of them (ENOSPC) starts over with no watches.
+ */
+
+#define WATCH_MASK      (IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | \
+                         IN_DELETE_SELF | IN_MOVE_SELF | IN_MOVED_FROM | \
+                         IN_MOVED_TO | IN_ONLYDIR)
+#define NUM_BUCKETS     1024
+#define MAX_WD          (1 << 20)   /* start over beyond this descriptor */
+
+typedef struct size_entry {
+    struct size_entry *next;
+    int64_t size;
+    int valid;
+    unsigned generation;    /* bumped when the size is dropped */
+    int *wds;               /* the watches owned, while valid */
+    size_t num_wds;
+    char path[];
+} size_entry_t;
+
+typedef struct {
+    pthread_mutex_t lock;   /* the directories are walked on several threads */
+    int fd;                 /* the inotify fd, or -1 */
+    int *wds;
+    size_t count;
+    size_t avail;
+    int failed;             /* the errno of the first failure, or 0 */
+} size_walk_t;
+
+/* all protected by cache_lock */
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static int cache_fd = -2;               /* -2 before the first use */
+static unsigned cache_epoch;            /* bumped when starting over */
+static size_entry_t *cache_buckets[NUM_BUCKETS];
+static size_entry_t **cache_owners;     /* the entry of each watch */
+static int cache_num_owners;
+static int cache_walks;                 /* walks adding watches right now */
+static int *cache_orphans;              /* watches to remove, if unowned */
+static int cache_num_orphans;
+static int cache_avail_orphans;
+static int cache_reset_pending;         /* start over once no walk is going on */
+
+static unsigned hash_path(const char *path)
+{
+    unsigned h = 5381;
+    while (*path) {
+        h = (h << 5) + h + (unsigned char)*path++;
+    }
+    return h % NUM_BUCKETS;
+}
+
+/* queue a watch for removal */
+static void add_orphan(int wd)
+{
+    int *orphans;
+    int avail;
+
+    if (cache_num_orphans == cache_avail_orphans) {
+        avail = cache_avail_orphans ? cache_avail_orphans * 2 : 64;
+        orphans = realloc(cache_orphans, avail * sizeof(*orphans));
+        if (orphans == NULL) {
+            /* closing the inotify fd removes them all */
+            cache_reset_pending = 1;
+            return;
+        }
+        cache_orphans = orphans;
+        cache_avail_orphans = avail;
+    }
+    cache_orphans[cache_num_orphans++] = wd;
+}
+
+/* give up the watches an entry still owns */
+static void release_watches(size_entry_t *entry)
+{
+    size_t i;
+    int wd;
+
+    for (i = 0; i < entry->num_wds; i++) {
+        wd = entry->wds[i];
+        if (wd < cache_num_owners && cache_owners[wd] == entry) {
+            cache_owners[wd] = NULL;
+            add_orphan(wd);
+        }
+    }
+    free(entry->wds);
+    entry->wds = NULL;
+    entry->num_wds = 0;
+}
+
+static void invalidate(size_entry_t *entry)
+{
+    entry->valid = 0;
+    entry->generation++;
+    release_watches(entry);
+}
+
+static void invalidate_all()
+{
+    size_entry_t *entry;
+    int i;
+
+    for (i = 0; i < NUM_BUCKETS; i++) {
+        for (entry = cache_buckets[i]; entry; entry = entry->next) {
+            invalidate(entry);
+        }
+    }
+}
+
+/* start (over) with no watches */
+static void reset_cache()
+{
+    if (cache_fd >= 0) {
+        /* this removes all the watches */
+        close(cache_fd);
+    }
+    cache_fd = inotify_init();
+    if (cache_fd < 0) {
+        ALOGW("inotify_init failed, sizes won't be cached: %s\n", strerror(errno));
+    } else {
+        fcntl(cache_fd, F_SETFL, O_NONBLOCK);
+        fcntl(cache_fd, F_SETFD, FD_CLOEXEC);
+    }
+    free(cache_owners);
+    cache_owners = NULL;
+    cache_num_owners = 0;
+    free(cache_orphans);
+    cache_orphans = NULL;
+    cache_num_orphans = 0;
+    cache_avail_orphans = 0;
+    cache_reset_pending = 0;
+    cache_epoch++;
+    invalidate_all();
+}
+
+/* remove the watches nobody owns anymore, unless a walk may be using them */
+static void collect_orphans()
+{
+    int i, wd;
+
+    if (cache_walks > 0) {
+        return;
+    }
+    if (cache_reset_pending) {
+        reset_cache();
+        return;
+    }
+    for (i = 0; i < cache_num_orphans; i++) {
+        wd = cache_orphans[i];
+        /* claimed again by a later walk */
+        if (wd < cache_num_owners && cache_owners[wd] != NULL) {
+            continue;
+        }
+        inotify_rm_watch(cache_fd, wd);
+    }
+    cache_num_orphans = 0;
+}
+
+/* drop the sizes that changed since the last call */
+static void read_events()
+{
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event *event;
+    ssize_t len;
+    char *p;
+
+    if (cache_fd == -2) {
+        reset_cache();
+    }
+    if (cache_fd < 0) {
+        return;
+    }
+    while ((len = read(cache_fd, buf, sizeof(buf))) > 0) {
+        for (p = buf; p < buf + len; p += sizeof(*event) + event->len) {
+            event = (const struct inotify_event *)p;
+            if (event->mask & IN_Q_OVERFLOW) {
+                invalidate_all();
+            } else if (event->wd >= 0 && event->wd < cache_num_owners &&
+                    cache_owners[event->wd] != NULL) {
+                invalidate(cache_owners[event->wd]);
+            }
+        }
+    }
+    collect_orphans();
+}
+
+static size_entry_t *find_entry(const char *path)
+{
+    const unsigned h = hash_path(path);
+    size_entry_t *entry;
+
+    for (entry = cache_buckets[h]; entry; entry = entry->next) {
+        if (!strcmp(entry->path, path)) {
+            return entry;
+        }
+    }
+    entry = malloc(sizeof(*entry) + strlen(path) + 1);
+    if (entry == NULL) {
+        return NULL;
+    }
+    strcpy(entry->path, path);
+    entry->size = 0;
+    entry->valid = 0;
+    entry->generation = 0;
+    entry->wds = NULL;
+    entry->num_wds = 0;
+    entry->next = cache_buckets[h];
+    cache_buckets[h] = entry;
+    return entry;
+}
+
+/* make the watches of a walk point to its entry, which keeps them */
+static int claim_watches(size_entry_t *entry, size_walk_t *w)
+{
+    size_entry_t **owners, *previous;
+    size_t i;
+    int wd, count;
+
+    /* another walk of the same path may have got here first */
+    release_watches(entry);
+    entry->wds = w->wds;
+    entry->num_wds = w->count;
+    w->wds = NULL;
+
+    for (i = 0; i < entry->num_wds; i++) {
+        wd = entry->wds[i];
+        if (wd >= MAX_WD) {
+            return -1;
+        }
+        if (wd >= cache_num_owners) {
+            count = cache_num_owners ? cache_num_owners : 256;
+            while (count <= wd) {
+                count *= 2;
+            }
+            owners = realloc(cache_owners, count * sizeof(*owners));
+            if (owners == NULL) {
+                return -1;
+            }
+            memset(owners + cache_num_owners, 0,
+                    (count - cache_num_owners) * sizeof(*owners));
+            cache_owners = owners;
+            cache_num_owners = count;
+        }
+        previous = cache_owners[wd];
+        cache_owners[wd] = entry;
+        if (previous != NULL && previous != entry) {
+            /* the same directory under another path, which won't hear
+             * about its changes anymore */
+            invalidate(previous);
+        }
+    }
+    return 0;
+}
+
+/* the watches of a walk that won't be kept */
+static void orphan_watches(const size_walk_t *w)
+{
+    size_t i;
+    int wd;
+
+    for (i = 0; i < w->count; i++) {
+        wd = w->wds[i];
+        if (wd >= cache_num_owners || cache_owners[wd] == NULL) {
+            add_orphan(wd);
+        }
+    }
+}
+
+/* adds a watch on each directory walked by calculate_dir_sizes() */
+static void watch_dir(int dfd, void *cookie)
+{
+    size_walk_t *w = (size_walk_t *)cookie;
+    char proc_path[32];
+    int *wds;
+    int wd;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->fd >= 0 && !w->failed) {
+        snprintf(proc_path, sizeof(proc_path), "/proc/self/fd/%d", dfd);
+        wd = inotify_add_watch(w->fd, proc_path, WATCH_MASK);
+        if (wd < 0) {
+            w->failed = errno;
+        } else {
+            if (w->count == w->avail) {
+                w->avail = w->avail ? w->avail * 2 : 16;
+                wds = realloc(w->wds, w->avail * sizeof(*wds));
+                if (wds == NULL) {
+                    w->failed = ENOMEM;
+                } else {
+                    w->wds = wds;
+                }
+            }
+            if (!w->failed) {
+                w->wds[w->count++] = wd;
+            }
+        }
+    }
+    pthread_mutex_unlock(&w->lock);
+}
+
+int64_t cached_dir_size(const char *path)
+{
+    size_entry_t *entry;
+    size_walk_t w;
+    unsigned generation, epoch;
+    int64_t size;
+    int dfd;
+
+    pthread_mutex_lock(&cache_lock);
+    read_events();
+    entry = find_entry(path);
+    if (entry != NULL && entry->valid) {
+        size = entry->size;
+        pthread_mutex_unlock(&cache_lock);
+        return size;
+    }
+    generation = entry ? entry->generation : 0;
+    epoch = cache_epoch;
+    /* let the walks going on drain before starting over */
+    w.fd = entry && !cache_reset_pending ? cache_fd : -1;
+    if (w.fd >= 0) {
+        cache_walks++;
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    w.wds = NULL;
+    w.count = 0;
+    w.avail = 0;
+    w.failed = 0;
+    size = 0;
+    dfd = open(path, O_RDONLY | O_DIRECTORY);
+    if (dfd >= 0) {
+        pthread_mutex_init(&w.lock, NULL);
+        size = calculate_dir_sizes(dfd, 0, NULL, 0, w.fd >= 0 ? watch_dir : NULL, &w);
+        pthread_mutex_destroy(&w.lock);
+    }
+
+    if (w.fd >= 0) {
+        pthread_mutex_lock(&cache_lock);
+        cache_walks--;
+        if (epoch == cache_epoch) {
+            if (dfd < 0 || w.failed) {
+                orphan_watches(&w);
+                if (w.failed == ENOSPC) {
+                    /* out of watches, drop them all rather than never
+                     * caching a size again */
+                    ALOGW("out of inotify watches, dropping the cached sizes\n");
+                    cache_reset_pending = 1;
+                }
+            } else if (claim_watches(entry, &w) < 0) {
+                cache_reset_pending = 1;
+            } else {
+                /* anything that changed during the walk is among the
+                 * events, and bumps the generation */
+                read_events();
+                if (entry->generation == generation) {
+                    entry->size = size;
+                    entry->valid = 1;
+                } else {
+                    release_watches(entry);
+                }
+            }
+        }
+        collect_orphans();
+        pthread_mutex_unlock(&cache_lock);
+    }
+    free(w.wds);
+    return size;
+}
@@ -14,7 +14,12 @@
 ** limitations under the License.
 */
 
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <cutils/atomic.h>
+
 #include "installd.h"
+#include <diskusage/dirsize.h>
 
 #define CACHE_NOISY(x) //x
 
@@ -207,62 +212,236 @@ int is_valid_package_name(const char* pkgname) {
     return 0;
 }
 
-static int _delete_dir_contents(DIR *d, const char *ignore)
+/*
+ * Tree deletion.
+ *
+ * The directories still to be read are on a stack shared by up to
+ * DELETE_THREADS threads, started as directories are found. Each one is
+ * read with large getdents64() calls, its files are unlinked right away
+ * and its sub-directories are pushed. A directory is removed once it has
+ * been read and all of its sub-directories are gone, which may in turn
+ * complete its parent. A directory's fd stays open until then, so that
+ * its sub-directories can be opened and removed relative to it.
+ */
+
+#define DELETE_THREADS      4
+#define DELETE_BUFFER_SIZE  (64*1024)
+
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+typedef struct delete_dir {
+    struct delete_dir *parent;
+    struct delete_dir *next;    /* on the stack */
+    int fd;
+    int32_t pending;            /* sub-directories left, plus one until read */
+    char name[];
+} delete_dir_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    delete_dir_t *stack;
+    int active;                 /* threads reading a directory */
+    pthread_t threads[DELETE_THREADS-1];
+    int num_threads;
+    const char *ignore;         /* skipped in the top directory */
+    int result;
+} delete_tree_t;
+
+static void *_delete_tree_thread(void *arg);
+
+static void _delete_tree_failed(delete_tree_t *t)
 {
-    int result = 0;
-    struct dirent *de;
-    int dfd;
+    pthread_mutex_lock(&t->lock);
+    t->result = -1;
+    pthread_mutex_unlock(&t->lock);
+}
 
-    dfd = dirfd(d);
+/* Drops a reference to dir, removing it when it was the last one. */
+static void _delete_dir_release(delete_tree_t *t, delete_dir_t *dir)
+{
+    delete_dir_t *parent;
 
-    if (dfd < 0) return -1;
+    while (dir != NULL && android_atomic_dec(&dir->pending) == 1) {
+        parent = dir->parent;
+        if (parent == NULL) {
+            /* the top directory, which is the caller's */
+            break;
+        }
+        if (dir->fd >= 0) {
+            close(dir->fd);
+        }
+        if (unlinkat(parent->fd, dir->name, AT_REMOVEDIR) < 0) {
+            ALOGE("Couldn't unlinkat %s: %s\n", dir->name, strerror(errno));
+            _delete_tree_failed(t);
+        }
+        free(dir);
+        dir = parent;
+    }
+}
 
-    while ((de = readdir(d))) {
-        const char *name = de->d_name;
+static void _delete_dir_push(delete_tree_t *t, delete_dir_t *dir, const char *name)
+{
+    delete_dir_t *sub = (delete_dir_t*)malloc(sizeof(delete_dir_t)+strlen(name)+1);
+    if (sub == NULL) {
+        ALOGE("Failure allocating delete_dir_t for %s\n", name);
+        _delete_tree_failed(t);
+        return;
+    }
+    sub->parent = dir;
+    sub->fd = -1;
+    sub->pending = 1;
+    strcpy(sub->name, name);
+    android_atomic_inc(&dir->pending);
+
+    pthread_mutex_lock(&t->lock);
+    sub->next = t->stack;
+    t->stack = sub;
+    if (t->num_threads < DELETE_THREADS-1 &&
+            !pthread_create(&t->threads[t->num_threads], NULL, _delete_tree_thread, t)) {
+        t->num_threads++;
+    }
+    pthread_cond_signal(&t->changed);
+    pthread_mutex_unlock(&t->lock);
+}
 
-            /* skip the ignore name if provided */
-        if (ignore && !strcmp(name, ignore)) continue;
+/* Unlinks the files of dir, and pushes its sub-directories. */
+static void _delete_dir_entries(delete_tree_t *t, delete_dir_t *dir, char *buf)
+{
+    const char *ignore = (dir->parent == NULL) ? t->ignore : NULL;
+    struct linux_dirent64 *de;
+    struct stat s;
+    int n, pos, type;
+
+    if (dir->fd < 0) {
+        dir->fd = openat(dir->parent->fd, dir->name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+        if (dir->fd < 0) {
+            ALOGE("Couldn't openat %s: %s\n", dir->name, strerror(errno));
+            _delete_tree_failed(t);
+            return;
+        }
+    }
 
-        if (de->d_type == DT_DIR) {
-            int r, subfd;
-            DIR *subdir;
+    while ((n = syscall(__NR_getdents64, dir->fd, buf, DELETE_BUFFER_SIZE)) > 0) {
+        for (pos = 0; pos < n; pos += de->d_reclen) {
+            de = (struct linux_dirent64*)(buf + pos);
+            const char *name = de->d_name;
 
-                /* always skip "." and ".." */
-            if (name[0] == '.') {
-                if (name[1] == 0) continue;
-                if ((name[1] == '.') && (name[2] == 0)) continue;
-            }
+                /* skip the ignore name if provided */
+            if (ignore && !strcmp(name, ignore)) continue;
 
-            subfd = openat(dfd, name, O_RDONLY | O_DIRECTORY);
-            if (subfd < 0) {
-                ALOGE("Couldn't openat %s: %s\n", name, strerror(errno));
-                result = -1;
-                continue;
-            }
-            subdir = fdopendir(subfd);
-            if (subdir == NULL) {
-                ALOGE("Couldn't fdopendir %s: %s\n", name, strerror(errno));
-                close(subfd);
-                result = -1;
-                continue;
-            }
-            if (_delete_dir_contents(subdir, 0)) {
-                result = -1;
-            }
-            closedir(subdir);
-            if (unlinkat(dfd, name, AT_REMOVEDIR) < 0) {
-                ALOGE("Couldn't unlinkat %s: %s\n", name, strerror(errno));
-                result = -1;
+            type = de->d_type;
+            if (type == DT_UNKNOWN) {
+                if (fstatat(dir->fd, name, &s, AT_SYMLINK_NOFOLLOW) == 0
+                        && S_ISDIR(s.st_mode)) {
+                    type = DT_DIR;
+                }
             }
-        } else {
-            if (unlinkat(dfd, name, 0) < 0) {
+            if (type == DT_DIR) {
+                    /* always skip "." and ".." */
+                if (name[0] == '.') {
+                    if (name[1] == 0) continue;
+                    if ((name[1] == '.') && (name[2] == 0)) continue;
+                }
+                _delete_dir_push(t, dir, name);
+            } else if (unlinkat(dir->fd, name, 0) < 0) {
                 ALOGE("Couldn't unlinkat %s: %s\n", name, strerror(errno));
-                result = -1;
+                _delete_tree_failed(t);
             }
         }
     }
+    if (n < 0) {
+        ALOGE("Couldn't read %s: %s\n", dir->name, strerror(errno));
+        _delete_tree_failed(t);
+    }
+}
 
-    return result;
+static void *_delete_tree_thread(void *arg)
+{
+    delete_tree_t *t = (delete_tree_t*)arg;
+    delete_dir_t *dir;
+    char *buf;
+
+    buf = (char*)malloc(DELETE_BUFFER_SIZE);
+    if (buf == NULL) {
+        ALOGE("Failure allocating delete buffer\n");
+        _delete_tree_failed(t);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&t->lock);
+    for (;;) {
+        while (t->stack == NULL && t->active) {
+            pthread_cond_wait(&t->changed, &t->lock);
+        }
+        dir = t->stack;
+        if (dir == NULL) {
+            /* nothing left, and nobody to find more */
+            break;
+        }
+        t->stack = dir->next;
+        t->active++;
+        pthread_mutex_unlock(&t->lock);
+
+        _delete_dir_entries(t, dir, buf);
+        _delete_dir_release(t, dir);
+
+        pthread_mutex_lock(&t->lock);
+        t->active--;
+        if (t->stack == NULL && !t->active) {
+            pthread_cond_broadcast(&t->changed);
+        }
+    }
+    pthread_mutex_unlock(&t->lock);
+    free(buf);
+    return NULL;
+}
+
+/* Deletes everything in the directory dfd, which stays open. */
+static int _delete_dir_contents_parallel(int dfd, const char *ignore)
+{
+    delete_tree_t t;
+    delete_dir_t top;
+    int i;
+
+    top.parent = NULL;
+    top.next = NULL;
+    top.fd = dfd;
+    top.pending = 1;
+
+    pthread_mutex_init(&t.lock, NULL);
+    pthread_cond_init(&t.changed, NULL);
+    t.stack = &top;
+    t.active = 0;
+    t.num_threads = 0;
+    t.ignore = ignore;
+    t.result = 0;
+
+    _delete_tree_thread(&t);
+    for (i = 0; i < t.num_threads; i++) {
+        pthread_join(t.threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&t.changed);
+    pthread_mutex_destroy(&t.lock);
+    return t.result;
+}
+
+static int _delete_dir_contents(DIR *d, const char *ignore)
+{
+    int dfd;
+
+    dfd = dirfd(d);
+
+    if (dfd < 0) return -1;
+
+    return _delete_dir_contents_parallel(dfd, ignore);
 }
 
 int delete_dir_contents(const char *pathname,
@@ -309,6 +488,81 @@ int delete_dir_contents_fd(int dfd, const char *name)
     return res;
 }
 
+/*
+ * Background deletion: the directory is renamed into the trash, which a
+ * thread of its own empties, so that the command doesn't wait for it.
+ */
+
+static pthread_mutex_t trash_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t trash_cond = PTHREAD_COND_INITIALIZER;
+static int trash_started;
+static int trash_pending;
+static unsigned trash_count;
+
+static void *trash_thread(void *unused)
+{
+    pthread_mutex_lock(&trash_lock);
+    for (;;) {
+        while (!trash_pending) {
+            pthread_cond_wait(&trash_cond, &trash_lock);
+        }
+        trash_pending = 0;
+        pthread_mutex_unlock(&trash_lock);
+
+        delete_dir_contents(android_trash_dir.path, 0, NULL);
+
+        pthread_mutex_lock(&trash_lock);
+    }
+    return NULL;
+}
+
+int start_trash_deleter()
+{
+    pthread_t thread;
+
+    if (access(android_trash_dir.path, F_OK) < 0) {
+        ALOGW("No trash at %s, deleting in the foreground\n", android_trash_dir.path);
+        return -1;
+    }
+    pthread_mutex_lock(&trash_lock);
+    // whatever was left there before we restarted
+    trash_pending = 1;
+    if (pthread_create(&thread, NULL, trash_thread, NULL) == 0) {
+        pthread_detach(thread);
+        trash_started = 1;
+    }
+    pthread_mutex_unlock(&trash_lock);
+    return trash_started ? 0 : -1;
+}
+
+int delete_dir_async(const char *pathname)
+{
+    char trashpath[PATH_MAX];
+    int started;
+
+    pthread_mutex_lock(&trash_lock);
+    started = trash_started;
+    snprintf(trashpath, PATH_MAX, "%s%lx-%u", android_trash_dir.path,
+            (long)time(NULL), trash_count++);
+    pthread_mutex_unlock(&trash_lock);
+
+    if (started) {
+        if (rename(pathname, trashpath) == 0) {
+            pthread_mutex_lock(&trash_lock);
+            trash_pending = 1;
+            pthread_cond_signal(&trash_cond);
+            pthread_mutex_unlock(&trash_lock);
+            return 0;
+        }
+        if (errno == ENOENT) {
+            ALOGE("Couldn't rename %s: %s\n", pathname, strerror(errno));
+            return -errno;
+        }
+        ALOGW("Couldn't move %s to the trash: %s\n", pathname, strerror(errno));
+    }
+    return delete_dir_contents(pathname, 1, NULL);
+}
+
 int lookup_media_dir(char basepath[PATH_MAX], const char *dir)
 {
     DIR *d;
@@ -374,9 +628,12 @@ int64_t data_disk_free()
     }
 }
 
-cache_t* start_cache_collection()
+cache_t* start_cache_collection(int64_t need)
 {
     cache_t* cache = (cache_t*)calloc(1, sizeof(cache_t));
+    if (cache != NULL) {
+        cache->need = need;
+    }
     return cache;
 }
 
@@ -438,7 +695,7 @@ static void _inc_num_cache_collected(cache_t* cache)
 {
     cache->numCollected++;
     if ((cache->numCollected%20000) == 0) {
-        ALOGI("Collected cache so far: %d directories, %d files",
+        ALOGI("Collected cache so far: %d directories, %d files kept",
             cache->numDirs, cache->numFiles);
     }
 }
@@ -476,36 +733,94 @@ static cache_dir_t* _add_cache_dir_t(cache_t* cache, cache_dir_t* parent, const
     return dir;
 }
 
-static cache_file_t* _add_cache_file_t(cache_t* cache, cache_dir_t* dir, time_t modTime,
-        const char *name)
+static int _cache_file_newer(cache_t* cache, size_t i, size_t j)
+{
+    return cache->files[i]->modTime > cache->files[j]->modTime;
+}
+
+static void _cache_file_swap(cache_t* cache, size_t i, size_t j)
+{
+    cache_file_t* tmp = cache->files[i];
+    cache->files[i] = cache->files[j];
+    cache->files[j] = tmp;
+}
+
+static void _pop_newest_cache_file(cache_t* cache)
+{
+    size_t i = 0, child;
+
+    cache->candidateSize -= cache->files[0]->size;
+    free(cache->files[0]);
+    cache->numFiles--;
+    cache->files[0] = cache->files[cache->numFiles];
+    for (;;) {
+        child = 2*i + 1;
+        if (child >= cache->numFiles) {
+            break;
+        }
+        if (child+1 < cache->numFiles && _cache_file_newer(cache, child+1, child)) {
+            child++;
+        }
+        if (!_cache_file_newer(cache, child, i)) {
+            break;
+        }
+        _cache_file_swap(cache, i, child);
+        i = child;
+    }
+}
+
+static void _add_cache_file_t(cache_t* cache, cache_dir_t* dir, time_t modTime,
+        int64_t size, const char *name)
 {
     size_t nameLen = strlen(name);
-    cache_file_t* file = (cache_file_t*)_cache_malloc(cache, sizeof(cache_file_t)+nameLen+1);
-    if (file != NULL) {
-        file->dir = dir;
-        file->modTime = modTime;
-        strcpy(file->name, name);
-        if (cache->numFiles >= cache->availFiles) {
-            size_t newAvail = cache->availFiles < 1000 ? 1000 : cache->availFiles*2;
-            cache_file_t** newFiles = (cache_file_t**)_cache_realloc(cache, cache->files,
-                    cache->availFiles*sizeof(cache_file_t*), newAvail*sizeof(cache_file_t*));
-            if (newFiles == NULL) {
-                ALOGE("Failure growing cache file array for %s\n", name);
-                return NULL;
-            }
-            cache->availFiles = newAvail;
-            cache->files = newFiles;
-        }
-        CACHE_NOISY(ALOGI("Setting file %p at position %d in array %p", file,
-                cache->numFiles, cache->files));
-        cache->files[cache->numFiles] = file;
-        cache->numFiles++;
-        dir->childCount++;
-        _inc_num_cache_collected(cache);
-    } else {
+    size_t i;
+
+    dir->childCount++;
+    _inc_num_cache_collected(cache);
+
+    // Not needed when it isn't older than the candidates, which are enough.
+    if (cache->numFiles > 0 && cache->candidateSize >= cache->need
+            && modTime >= cache->files[0]->modTime) {
+        return;
+    }
+
+    // These come and go, so they don't use the cache's blocks.
+    cache_file_t* file = (cache_file_t*)malloc(sizeof(cache_file_t)+nameLen+1);
+    if (file == NULL) {
         ALOGE("Failure allocating cache_file_t for %s\n", name);
+        return;
+    }
+    file->dir = dir;
+    file->modTime = modTime;
+    file->size = size;
+    strcpy(file->name, name);
+    if (cache->numFiles >= cache->availFiles) {
+        size_t newAvail = cache->availFiles < 1000 ? 1000 : cache->availFiles*2;
+        cache_file_t** newFiles = (cache_file_t**)realloc(cache->files,
+                newAvail*sizeof(cache_file_t*));
+        if (newFiles == NULL) {
+            ALOGE("Failure growing cache file array for %s\n", name);
+            free(file);
+            return;
+        }
+        cache->availFiles = newAvail;
+        cache->files = newFiles;
+    }
+    CACHE_NOISY(ALOGI("Setting file %p at position %d in array %p", file,
+            cache->numFiles, cache->files));
+    i = cache->numFiles++;
+    cache->files[i] = file;
+    while (i > 0 && _cache_file_newer(cache, i, (i-1)/2)) {
+        _cache_file_swap(cache, i, (i-1)/2);
+        i = (i-1)/2;
+    }
+    cache->candidateSize += size;
+
+    // Drop the newest candidates as long as the others are enough.
+    while (cache->numFiles > 1
+            && cache->candidateSize - cache->files[0]->size >= cache->need) {
+        _pop_newest_cache_file(cache);
     }
-    return file;
 }
 
 static int _add_cache_files(cache_t *cache, cache_dir_t *parentDir, const char *dirName,
@@ -595,7 +910,7 @@ static int _add_cache_files(cache_t *cache, cache_dir_t *parentDir, const char *
                 if (finallen < pathAvailLen) {
                     struct stat s;
                     if (stat(pathBase, &s) >= 0) {
-                        _add_cache_file_t(cache, cacheDir, s.st_mtime, name);
+                        _add_cache_file_t(cache, cacheDir, s.st_mtime, stat_size(&s), name);
                     } else {
                         ALOGW("Unable to stat cache file %s; deleting\n", pathBase);
                         if (unlink(pathBase) < 0) {
@@ -727,47 +1042,71 @@ static int cache_modtime_sort(const void *lhsP, const void *rhsP)
     return lhs->modTime < rhs->modTime ? -1 : (lhs->modTime > rhs->modTime ? 1 : 0);
 }
 
-void clear_cache_files(cache_t* cache, int64_t free_size)
+/* Deletes the candidates of all the caches, oldest first, until there is
+ * free_size available. Returns the number of files deleted.
+ */
+size_t clear_cache_files(cache_t** caches, size_t count, int64_t free_size)
 {
-    size_t i;
+    size_t i, j, numFiles = 0, deleted = 0;
     int skip = 0;
     char path[PATH_MAX];
+    cache_file_t** files;
 
-    ALOGI("Collected cache files: %d directories, %d files",
-        cache->numDirs, cache->numFiles);
-
-    CACHE_NOISY(ALOGI("Sorting files..."));
-    qsort(cache->files, cache->numFiles, sizeof(cache_file_t*),
-            cache_modtime_sort);
+    for (i=0; i<count; i++) {
+        ALOGI("Collected cache files: %d directories, %d files",
+            caches[i]->numDirs, caches[i]->numFiles);
+        numFiles += caches[i]->numFiles;
+    }
 
     CACHE_NOISY(ALOGI("Cleaning empty directories..."));
-    for (i=cache->numDirs; i>0; i--) {
-        cache_dir_t* dir = cache->dirs[i-1];
-        if (dir->childCount <= 0 && !dir->deleted) {
-            delete_cache_dir(path, dir);
+    for (j=0; j<count; j++) {
+        cache_t* cache = caches[j];
+        for (i=cache->numDirs; i>0; i--) {
+            cache_dir_t* dir = cache->dirs[i-1];
+            if (dir->childCount <= 0 && !dir->deleted) {
+                delete_cache_dir(path, dir);
+            }
         }
     }
 
+    CACHE_NOISY(ALOGI("Sorting files..."));
+    files = (cache_file_t**)malloc(numFiles*sizeof(cache_file_t*));
+    if (files == NULL) {
+        ALOGE("Failure allocating %d cache files\n", numFiles);
+        return 0;
+    }
+    numFiles = 0;
+    for (j=0; j<count; j++) {
+        memcpy(files + numFiles, caches[j]->files,
+                caches[j]->numFiles*sizeof(cache_file_t*));
+        numFiles += caches[j]->numFiles;
+    }
+    qsort(files, numFiles, sizeof(cache_file_t*), cache_modtime_sort);
+
     CACHE_NOISY(ALOGI("Trimming files..."));
-    for (i=0; i<cache->numFiles; i++) {
+    for (i=0; i<numFiles; i++) {
         skip++;
         if (skip > 10) {
             if (data_disk_free() > free_size) {
-                return;
+                break;
             }
             skip = 0;
         }
-        cache_file_t* file = cache->files[i];
+        cache_file_t* file = files[i];
         strcpy(create_dir_path(path, file->dir), file->name);
         ALOGI("DEL (mod %d) %s\n", (int)file->modTime, path);
         if (unlink(path) < 0) {
             ALOGE("Couldn't unlink %s: %s\n", path, strerror(errno));
+        } else {
+            deleted++;
         }
         file->dir->childCount--;
         if (file->dir->childCount <= 0) {
             delete_cache_dir(path, file->dir);
         }
     }
+    free(files);
+    return deleted;
 }
 
 void finish_cache_collection(cache_t* cache)
@@ -786,6 +1125,10 @@ void finish_cache_collection(cache_t* cache)
             ALOGI("file #%d: %p %s time=%d dir=%p\n", i, file, file->name,
                     (int)file->modTime, file->dir);
         })
+    for (i=0; i<cache->numFiles; i++) {
+        free(cache->files[i]);
+    }
+    free(cache->files);
     void* block = cache->memBlocks;
     while (block != NULL) {
         void* nextBlock = *(void**)block;
@@ -5,7 +5,9 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES:= backup.cpp
 
-LOCAL_SHARED_LIBRARIES := libcutils libc
+LOCAL_SHARED_LIBRARIES := libcutils libc libz
+
+LOCAL_C_INCLUDES += external/zlib
 
 LOCAL_MODULE:= rawbu
 
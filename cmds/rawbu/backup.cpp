@@ -12,11 +12,13 @@
 #include <assert.h>
 #include <ctype.h>
 #include <utime.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <stdint.h>
 
 #include <cutils/properties.h>
+#include <zlib.h>
 
 #include <private/android_filesystem_config.h>
 
@@ -37,12 +39,22 @@ namespace android {
 static char nameBuffer[PATH_MAX];
 static struct stat statBuffer;
 
-static char copyBuffer[8192];
+// Large enough for storage to stream at full speed, and used as the
+// stdio buffer of the backup file too.
+#define COPY_BUFFER_SIZE (256*1024)
+
+static char copyBuffer[COPY_BUFFER_SIZE] __attribute__((aligned(4096)));
+static char streamBuffer[COPY_BUFFER_SIZE] __attribute__((aligned(4096)));
 static char *backupFilePath = NULL;
 
 static uint32_t inputFileVersion;
 
 static int opt_backupAll;
+static int opt_compress;
+
+// Whether file contents can be sendfile()'d straight into the backup file,
+// which isn't possible once it's compressed or if the kernel refuses to.
+static bool useSendfile;
 
 #define SPECIAL_NO_TOUCH 0
 #define SPECIAL_NO_BACKUP 1
@@ -229,6 +241,73 @@ static int copy_file(FILE* dest, FILE* src, off_t size, const char* destName,
     return 1;
 }
 
+/*
+ * Copies a file into the backup stream without bringing it into user
+ * space. Returns 1 on success, 0 on error, and -1 if sendfile() isn't
+ * supported here, in which case nothing was written.
+ */
+static int sendfile_file(FILE* dest, int srcFd, off_t size, const char* srcName)
+{
+    // what was buffered must land in the file first
+    if (fflush(dest) != 0) {
+        fprintf(stderr, "unable to write: %s\n", strerror(errno));
+        return 0;
+    }
+
+    off_t origSize = size;
+    while (size > 0) {
+        size_t amt = size > COPY_BUFFER_SIZE*16 ? COPY_BUFFER_SIZE*16 : (size_t)size;
+        ssize_t sent = sendfile(fileno(dest), srcFd, NULL, amt);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && size == origSize && (errno == EINVAL || errno == ENOSYS)) {
+            return -1;
+        }
+        if (sent <= 0) {
+            fprintf(stderr, "unable to copy source (%ld of %ld bytes) file '%s': %s\n",
+                origSize - size, origSize, srcName,
+                sent < 0 ? strerror(errno) : "unexpected EOF");
+            return 0;
+        }
+        size -= sent;
+    }
+    return 1;
+}
+
+/*
+ * Compressed backups are a gzip stream of the same content, which stdio
+ * reads and writes through these hooks so the rest of the code doesn't
+ * need to care.
+ */
+static int gz_read(void* cookie, char* buf, int size)
+{
+    return gzread((gzFile)cookie, buf, size);
+}
+
+static int gz_write(void* cookie, const char* buf, int size)
+{
+    return gzwrite((gzFile)cookie, buf, size);
+}
+
+static int gz_close(void* cookie)
+{
+    return gzclose((gzFile)cookie) == Z_OK ? 0 : -1;
+}
+
+static FILE* open_compressed(int fd, const char* mode)
+{
+    gzFile gz = gzdopen(fd, mode);
+    if (gz == NULL) {
+        return NULL;
+    }
+    gzbuffer(gz, COPY_BUFFER_SIZE);
+    if (mode[0] == 'r') {
+        return funopen(gz, gz_read, NULL, NULL, gz_close);
+    }
+    return funopen(gz, NULL, gz_write, NULL, gz_close);
+}
+
 #define TYPE_END 0
 #define TYPE_DIR 1
 #define TYPE_FILE 2
@@ -350,8 +429,19 @@ static int backup_dir(FILE* fh, const char* srcPath)
                 result = 0;
                 goto done;
             }
+            posix_fadvise(fileno(src), 0, size, POSIX_FADV_SEQUENTIAL);
             
-            int copyres = copy_file(fh, src, size, NULL, fullPath);
+            int copyres = -1;
+            if (useSendfile) {
+                copyres = sendfile_file(fh, fileno(src), size, fullPath);
+                if (copyres < 0) {
+                    useSendfile = false;
+                }
+            }
+            if (copyres < 0) {
+                setvbuf(src, NULL, _IONBF, 0);
+                copyres = copy_file(fh, src, size, NULL, fullPath);
+            }
             fclose(src);
             if (!copyres) {
                 result = 0;
@@ -374,14 +464,25 @@ static int backup_data(const char* destPath)
 {
     int res = -1;
     
-    FILE* fh = fopen(destPath, "w");
+    int fd = open(destPath, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    FILE* fh = NULL;
+    if (fd >= 0) {
+        // speed matters more than size here
+        fh = opt_compress ? open_compressed(fd, "wb1") : fdopen(fd, "w");
+        if (fh == NULL) {
+            close(fd);
+        }
+    }
     if (fh == NULL) {
         fprintf(stderr, "unable to open destination '%s': %s\n",
                 destPath, strerror(errno));
         return -1;
     }
+    setvbuf(fh, streamBuffer, _IOFBF, sizeof(streamBuffer));
+    useSendfile = !opt_compress;
     
-    printf("Backing up /data to %s...\n", destPath);
+    printf("Backing up /data to %s%s...\n", destPath,
+            opt_compress ? " (compressed)" : "");
 
     // The path that shouldn't be backed up
     backupFilePath = strdup(destPath);
@@ -400,13 +501,13 @@ done:
         res = -1;
         goto donedone;
     }
-    if (fsync(fileno(fh)) != 0) {
-        fprintf(stderr, "error syncing destination '%s': %s\n",
+    // closing finishes the gzip stream, which has to be on disk too
+    if (fclose(fh) != 0) {
+        fprintf(stderr, "error closing destination '%s': %s\n",
             destPath, strerror(errno));
         res = -1;
         goto donedone;
     }
-    fclose(fh);
     sync();
 
 donedone:    
@@ -504,12 +605,25 @@ static int restore_data(const char* srcPath)
 {
     int res = -1;
     
-    FILE* fh = fopen(srcPath, "r");
+    // compressed backups are told apart by the gzip magic
+    int fd = open(srcPath, O_RDONLY);
+    FILE* fh = NULL;
+    if (fd >= 0) {
+        unsigned char magic[2];
+        bool compressed = read(fd, magic, sizeof(magic)) == sizeof(magic)
+                && magic[0] == 0x1f && magic[1] == 0x8b;
+        lseek(fd, 0, SEEK_SET);
+        fh = compressed ? open_compressed(fd, "rb") : fdopen(fd, "r");
+        if (fh == NULL) {
+            close(fd);
+        }
+    }
     if (fh == NULL) {
         fprintf(stderr, "Unable to open source '%s': %s\n",
                 srcPath, strerror(errno));
         return -1;
     }
+    setvbuf(fh, streamBuffer, _IOFBF, sizeof(streamBuffer));
     
     inputFileVersion = read_int32(fh, 0);
     if (inputFileVersion < FILE_VERSION_1 || inputFileVersion > FILE_VERSION) {
@@ -638,7 +752,8 @@ static void show_help(const char *cmd)
                     "  restore         Perform a restore of /data.\n");
     fprintf(stderr, "options include:\n"
                     "  -h              Show this help text.\n"
-                    "  -a              Backup all files.\n");
+                    "  -a              Backup all files.\n"
+                    "  -z              Compress the backup, restore detects it.\n");
     fprintf(stderr, "\nThe %s command allows you to perform low-level\n"
                     "backup and restore of the /data partition.  This is\n"
                     "where all user data is kept, allowing for a fairly\n"
@@ -683,7 +798,7 @@ int main (int argc, char **argv)
     for (;;) {
         int ret;
 
-        ret = getopt(argc, argv, "ah");
+        ret = getopt(argc, argv, "ahz");
 
         if (ret < 0) {
             break;
@@ -694,6 +809,10 @@ int main (int argc, char **argv)
                 android::opt_backupAll = 1;
                 if (restore) fprintf(stderr, "Warning: -a option ignored on restore\n");
                 break;
+            case 'z':
+                android::opt_compress = 1;
+                if (restore) fprintf(stderr, "Warning: -z option ignored on restore\n");
+                break;
             case 'h':
                 android::show_help(argv[0]);
                 exit(0);
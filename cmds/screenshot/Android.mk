@@ -1,12 +1,18 @@
 LOCAL_PATH:= $(call my-dir)
 include $(CLEAR_VARS)
 
-LOCAL_SRC_FILES := screenshot.c
+LOCAL_SRC_FILES := screenshot.cpp
 
 LOCAL_MODULE := screenshot
 
-LOCAL_SHARED_LIBRARIES := libcutils libz liblog
-LOCAL_STATIC_LIBRARIES := libpng
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	libz \
+	liblog \
+	libutils \
+	libbinder \
+	libui \
+	libgui
 LOCAL_C_INCLUDES += external/zlib
 
 include $(BUILD_EXECUTABLE)
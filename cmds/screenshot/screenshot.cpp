@@ -0,0 +1,488 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <grp.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+
+#include <linux/fb.h>
+
+#include <zlib.h>
+
+#include "private/android_filesystem_config.h"
+
+#define LOG_TAG "screenshot"
+#include <utils/Log.h>
+
+#include <binder/ProcessState.h>
+#include <gui/ISurfaceComposer.h>
+#include <gui/SurfaceComposerClient.h>
+#include <ui/PixelConverter.h>
+
+using namespace android;
+
+#define MAX_BANDS       8
+#define MIN_BAND_ROWS   16
+
+/* the pixels to save, either mapped from SurfaceFlinger's capture or read
+ * from the framebuffer */
+typedef struct {
+    const uint8_t *pixels;
+    uint32_t width;
+    uint32_t height;
+    size_t bpr;             /* bytes from one row to the next */
+    PixelFormat format;
+} image_t;
+
+/* a range of rows compressed on its own thread, the deflate streams of
+ * the bands are concatenated into the png's IDAT */
+typedef struct {
+    const image_t *img;
+    uint32_t first_row;
+    uint32_t num_rows;
+    int level;
+    int last;
+    uint8_t *out;
+    size_t out_len;
+    uLong adler;            /* of the uncompressed band */
+    int error;
+} band_t;
+
+/* the format of the framebuffer pixels, from their layout */
+static PixelFormat fb_format(const struct fb_var_screeninfo* vinfo) {
+    switch (vinfo->bits_per_pixel) {
+        case 16:
+            return PIXEL_FORMAT_RGB_565;
+        case 32:
+            if (vinfo->red.offset == 16) {
+                return PIXEL_FORMAT_BGRA_8888;
+            }
+            return vinfo->transp.length ? PIXEL_FORMAT_RGBA_8888 :
+                    PIXEL_FORMAT_RGBX_8888;
+    }
+    return PIXEL_FORMAT_UNKNOWN;
+}
+
+static size_t format_bpp(PixelFormat format) {
+    return format == PIXEL_FORMAT_RGB_565 ? 2 : 4;
+}
+
+/* asks SurfaceFlinger for the main display, the pixels stay mapped in
+ * the CpuConsumer buffer of the ScreenshotClient */
+static int capture_screen(ScreenshotClient *sc, image_t *img) {
+    sp<IBinder> display(SurfaceComposerClient::getBuiltInDisplay(
+            ISurfaceComposer::eDisplayIdMain));
+    if (display == NULL || sc->update(display) != NO_ERROR) {
+        return -1;
+    }
+    img->pixels = (const uint8_t *)sc->getPixels();
+    img->width = sc->getWidth();
+    img->height = sc->getHeight();
+    img->format = sc->getFormat();
+    img->bpr = sc->getStride() * format_bpp(img->format);
+    if (img->pixels == NULL ||
+            !PixelConverter::isSupported(img->format, PIXEL_FORMAT_RGBA_8888)) {
+        return -1;
+    }
+    return 0;
+}
+
+/* reads the visible part of the framebuffer, the caller frees the pixels */
+static int read_framebuffer(FILE *fb_in, image_t *img) {
+    int fb;
+    struct fb_var_screeninfo vinfo;
+    unsigned int r, rowlen, bytespp, offset;
+    uint8_t *pixels;
+
+    fb = fileno(fb_in);
+    if(ioctl(fb, FBIOGET_VSCREENINFO, &vinfo) < 0) {
+        ALOGE("failed to get framebuffer info\n");
+        return -1;
+    }
+    img->format = fb_format(&vinfo);
+    if (!PixelConverter::isSupported(img->format, PIXEL_FORMAT_RGBA_8888)) {
+        ALOGE("unsupported framebuffer format (%d bpp)\n", vinfo.bits_per_pixel);
+        return -1;
+    }
+
+    bytespp = vinfo.bits_per_pixel / 8;
+    rowlen = vinfo.xres * bytespp;
+    pixels = (uint8_t *)malloc(rowlen * vinfo.yres);
+    if (pixels == NULL) {
+        ALOGE("can't allocate %u bytes\n", rowlen * vinfo.yres);
+        return -1;
+    }
+
+    offset = vinfo.xoffset * bytespp + vinfo.xres * vinfo.yoffset * bytespp;
+    fseek(fb_in, offset, SEEK_SET);
+
+    for(r=0; r<vinfo.yres; r++) {
+        int len = fread(pixels + r * rowlen, 1, rowlen, fb_in);
+        if (len <= 0) break;
+    }
+
+    img->pixels = pixels;
+    img->width = vinfo.xres;
+    img->height = r;
+    img->bpr = rowlen;
+    return 0;
+}
+
+/* returns row y of the image as RGBA, converting it into buf if needed */
+static const uint8_t *rgba_row(const image_t *img, const PixelConverter &conv,
+        uint32_t y, uint8_t *buf) {
+    const uint8_t *row = img->pixels + y * img->bpr;
+    if (img->format == PIXEL_FORMAT_RGBA_8888) {
+        return row;
+    }
+    conv.convertRow(buf, row, img->width);
+    return buf;
+}
+
+static void *encode_band(void *arg) {
+    band_t *band = (band_t *)arg;
+    const image_t *img = band->img;
+    const PixelConverter conv(img->format, PIXEL_FORMAT_RGBA_8888);
+    const size_t rowlen = img->width * 4;
+    const uint8_t *row, *prior = NULL;
+    uint8_t *bufs, *filtered;
+    z_stream zs;
+    size_t bound;
+    uint32_t y;
+    int flush;
+
+    band->error = -1;
+    band->adler = adler32(0L, Z_NULL, 0);
+
+    bufs = (uint8_t *)malloc(rowlen * 2 + 1 + rowlen);
+    if (bufs == NULL) {
+        return NULL;
+    }
+    filtered = bufs + rowlen * 2;
+
+    memset(&zs, 0, sizeof(zs));
+    /* raw deflate, the zlib header and checksum are written once for all
+     * the bands */
+    if (deflateInit2(&zs, band->level, Z_DEFLATED, -15, 8,
+            Z_DEFAULT_STRATEGY) != Z_OK) {
+        free(bufs);
+        return NULL;
+    }
+    /* the sync flush ending the band adds a few bytes to the bound */
+    bound = deflateBound(&zs, (1 + rowlen) * band->num_rows) + 16;
+    band->out = (uint8_t *)malloc(bound);
+    if (band->out == NULL) {
+        deflateEnd(&zs);
+        free(bufs);
+        return NULL;
+    }
+    zs.next_out = band->out;
+    zs.avail_out = bound;
+
+    /* the Up filter looks at the row above, even across bands */
+    if (band->first_row > 0) {
+        y = band->first_row - 1;
+        prior = rgba_row(img, conv, y, bufs + (y & 1) * rowlen);
+    }
+    for (y = band->first_row; y < band->first_row + band->num_rows; y++) {
+        size_t x;
+        row = rgba_row(img, conv, y, bufs + (y & 1) * rowlen);
+        if (prior == NULL) {
+            filtered[0] = 0;    /* None */
+            memcpy(filtered + 1, row, rowlen);
+        } else {
+            filtered[0] = 2;    /* Up */
+            for (x = 0; x < rowlen; x++) {
+                filtered[1 + x] = row[x] - prior[x];
+            }
+        }
+        prior = row;
+
+        band->adler = adler32(band->adler, filtered, 1 + rowlen);
+        zs.next_in = filtered;
+        zs.avail_in = 1 + rowlen;
+        flush = Z_NO_FLUSH;
+        if (y == band->first_row + band->num_rows - 1) {
+            /* only the last band ends the deflate stream */
+            flush = band->last ? Z_FINISH : Z_SYNC_FLUSH;
+        }
+        if (deflate(&zs, flush) == Z_STREAM_ERROR || zs.avail_in != 0) {
+            deflateEnd(&zs);
+            free(bufs);
+            return NULL;
+        }
+    }
+
+    band->out_len = bound - zs.avail_out;
+    band->error = 0;
+    deflateEnd(&zs);
+    free(bufs);
+    return NULL;
+}
+
+static void put_be32(uint8_t *p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static int write_chunk(FILE *out, const char *type,
+        const uint8_t *data, size_t len) {
+    uint8_t head[8];
+    uint8_t tail[4];
+    uLong crc;
+
+    put_be32(head, len);
+    memcpy(head + 4, type, 4);
+    crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, head + 4, 4);
+    if (len) {
+        /* zlib restarts the crc on a NULL buffer */
+        crc = crc32(crc, data, len);
+    }
+    put_be32(tail, crc);
+
+    if (fwrite(head, 1, 8, out) != 8 ||
+            (len && fwrite(data, 1, len, out) != len) ||
+            fwrite(tail, 1, 4, out) != 4) {
+        return -1;
+    }
+    return 0;
+}
+
+/* encodes the image as an 8-bit RGBA png, the rows are split in bands
+ * compressed in parallel */
+static int write_png(const image_t *img, FILE *out, int level) {
+    static const uint8_t signature[8] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'
+    };
+    /* deflate, 32K window, no dictionary; (0x78 << 8 | 0x01) % 31 == 0 */
+    static const uint8_t zlib_header[2] = { 0x78, 0x01 };
+    pthread_t threads[MAX_BANDS];
+    int threaded[MAX_BANDS];
+    band_t bands[MAX_BANDS];
+    uint8_t ihdr[13];
+    uint8_t adler[4];
+    uLong total_adler;
+    long cpus;
+    uint32_t num_bands, rows, i;
+    int err = 0;
+
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    num_bands = (cpus < 1) ? 1 : (cpus > MAX_BANDS ? MAX_BANDS : cpus);
+    if (num_bands > img->height / MIN_BAND_ROWS) {
+        num_bands = img->height / MIN_BAND_ROWS;
+    }
+    if (num_bands == 0) {
+        num_bands = 1;
+    }
+
+    rows = (img->height + num_bands - 1) / num_bands;
+    for (i = 0; i < num_bands; i++) {
+        band_t *band = &bands[i];
+        memset(band, 0, sizeof(*band));
+        band->img = img;
+        band->first_row = i * rows;
+        band->num_rows = (i == num_bands - 1) ? img->height - i * rows : rows;
+        band->level = level;
+        band->last = (i == num_bands - 1);
+        threaded[i] = (i > 0 &&
+                pthread_create(&threads[i], NULL, encode_band, band) == 0);
+        if (i > 0 && !threaded[i]) {
+            /* no thread, do it here */
+            encode_band(band);
+        }
+    }
+    encode_band(&bands[0]);
+    for (i = 1; i < num_bands; i++) {
+        if (threaded[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    put_be32(ihdr, img->width);
+    put_be32(ihdr + 4, img->height);
+    ihdr[8] = 8;        /* bit depth */
+    ihdr[9] = 6;        /* RGBA */
+    ihdr[10] = 0;       /* deflate */
+    ihdr[11] = 0;       /* adaptive filtering */
+    ihdr[12] = 0;       /* not interlaced */
+
+    if (fwrite(signature, 1, sizeof(signature), out) != sizeof(signature) ||
+            write_chunk(out, "IHDR", ihdr, sizeof(ihdr)) ||
+            write_chunk(out, "IDAT", zlib_header, sizeof(zlib_header))) {
+        err = -1;
+    }
+
+    total_adler = adler32(0L, Z_NULL, 0);
+    for (i = 0; i < num_bands; i++) {
+        band_t *band = &bands[i];
+        if (!err && band->error) {
+            ALOGE("failed to compress rows %u-%u\n", band->first_row,
+                    band->first_row + band->num_rows - 1);
+            err = -1;
+        }
+        if (!err) {
+            err = write_chunk(out, "IDAT", band->out, band->out_len);
+            total_adler = adler32_combine(total_adler, band->adler,
+                    (1 + img->width * 4) * band->num_rows);
+        }
+        free(band->out);
+    }
+
+    if (!err) {
+        put_be32(adler, total_adler);
+        if (write_chunk(out, "IDAT", adler, sizeof(adler)) ||
+                write_chunk(out, "IEND", NULL, 0)) {
+            err = -1;
+        }
+    }
+    return err;
+}
+
+/* a 12 bytes header: width, height and PixelFormat, native endian, then
+ * the rows in that format without padding */
+static int write_raw(const image_t *img, FILE *out) {
+    const uint32_t header[3] = {
+        img->width, img->height, (uint32_t)img->format
+    };
+    const size_t rowlen = img->width * format_bpp(img->format);
+    uint32_t y;
+
+    if (fwrite(header, 1, sizeof(header), out) != sizeof(header)) {
+        return -1;
+    }
+    for (y = 0; y < img->height; y++) {
+        if (fwrite(img->pixels + y * img->bpr, 1, rowlen, out) != rowlen) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void fork_sound(const char* path) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/system/bin/stagefright", "stagefright", "-o", "-a", path, NULL);
+    }
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: screenshot [-s soundfile] [-i] [-r] [-z level] filename.png\n"
+            "   -s: play a sound effect to signal success\n"
+            "   -i: autoincrement to avoid overwriting filename.png\n"
+            "   -r: write the raw pixels instead of a png: width, height and\n"
+            "       format as 32-bit words, then the rows\n"
+            "   -z: png compression level, 0 (none) to 9 (best), default 6\n"
+    );
+}
+
+int main(int argc, char**argv) {
+    FILE *out = NULL;
+    FILE *fb_in = NULL;
+    char outfile[PATH_MAX] = "";
+    ScreenshotClient screenshot;
+    image_t img;
+    uint8_t *fb_pixels = NULL;
+    const char *ext;
+
+    char * soundfile = NULL;
+    int do_increment = 0;
+    int raw = 0;
+    int level = Z_DEFAULT_COMPRESSION;
+    int err;
+
+    int c;
+    while ((c = getopt(argc, argv, "s:irz:")) != -1) {
+        switch (c) {
+            case 's': soundfile = optarg; break;
+            case 'i': do_increment = 1; break;
+            case 'r': raw = 1; break;
+            case 'z':
+                level = atoi(optarg);
+                if (level < 0 || level > 9) {
+                    usage(); exit(1);
+                }
+                break;
+            case '?':
+            case 'h':
+                usage(); exit(1);
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1) {
+        usage(); exit(1);
+    }
+
+    strlcpy(outfile, argv[0], PATH_MAX);
+    ext = raw ? "raw" : "png";
+    if (do_increment) {
+        struct stat st;
+        char base[PATH_MAX] = "";
+        int i = 0;
+        while (stat(outfile, &st) == 0) {
+            if (!base[0]) {
+                char *p = strrchr(outfile, '.');
+                if (p) *p = '\0';
+                strcpy(base, outfile);
+            }
+            snprintf(outfile, PATH_MAX, "%s-%d.%s", base, ++i, ext);
+        }
+    }
+
+    /* SurfaceFlinger hands the capture to our CpuConsumer over binder */
+    ProcessState::self()->startThreadPool();
+    if (capture_screen(&screenshot, &img) != 0) {
+        /* no SurfaceFlinger, or it can't capture: read the framebuffer */
+        fb_in = fopen("/dev/graphics/fb0", "r");
+        if (!fb_in) {
+            fprintf(stderr, "error: could not read framebuffer\n");
+            exit(1);
+        }
+        fcntl(fileno(fb_in), F_SETFD, FD_CLOEXEC);
+        err = read_framebuffer(fb_in, &img);
+        fclose(fb_in);
+        if (err) {
+            fprintf(stderr, "error: could not read framebuffer\n");
+            exit(1);
+        }
+        fb_pixels = (uint8_t *)img.pixels;
+    }
+
+    /* switch to non-root user and group */
+    gid_t groups[] = { AID_LOG, AID_SDCARD_RW };
+    setgroups(sizeof(groups)/sizeof(groups[0]), groups);
+    setuid(AID_SHELL);
+
+    out = fopen(outfile, "w");
+    if (!out) {
+        fprintf(stderr, "error: writing file %s: %s\n",
+                outfile, strerror(errno));
+        exit(1);
+    }
+
+    err = raw ? write_raw(&img, out) : write_png(&img, out, level);
+    if (fclose(out) != 0) {
+        err = -1;
+    }
+    free(fb_pixels);
+    if (err) {
+        fprintf(stderr, "error: writing file %s\n", outfile);
+        exit(1);
+    }
+
+    if (soundfile) {
+        fork_sound(soundfile);
+    }
+
+    exit(0);
+}
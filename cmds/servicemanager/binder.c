@@ -6,6 +6,8 @@
 #include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <time.h>
 #include <sys/mman.h>
 
 #include "binder.h"
@@ -84,18 +86,48 @@ const char *cmd_name(uint32_t cmd)
 #define BIO_F_IOERROR   0x04
 #define BIO_F_MALLOCED  0x08  /* needs to be free()'d */
 
+/* replies binder_loop() writes along with its next read */
+#define MAX_PENDING_REPLIES 8
+#define REPLY_DATA_SIZE 256
+
+struct binder_reply
+{
+    uint32_t cmd_free;
+    void *buffer;
+    uint32_t cmd_reply;
+    struct binder_txn txn;
+} __attribute__((packed));
+
 struct binder_state
 {
     int fd;
     void *mapped;
     unsigned mapsize;
+
+    /* the kernel copies the reply data when the replies are written, so
+     * it has to live here until then rather than on the stack */
+    struct binder_reply replies[MAX_PENDING_REPLIES];
+    unsigned rdata[MAX_PENDING_REPLIES][REPLY_DATA_SIZE/4];
+    int status[MAX_PENDING_REPLIES];
+    unsigned pending;
+
+    struct binder_stats stats;
 };
 
+static volatile sig_atomic_t stats_dump_requested;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 struct binder_state *binder_open(unsigned mapsize)
 {
     struct binder_state *bs;
 
-    bs = malloc(sizeof(*bs));
+    bs = calloc(1, sizeof(*bs));
     if (!bs) {
         errno = ENOMEM;
         return 0;
@@ -157,38 +189,65 @@ int binder_write(struct binder_state *bs, void *data, unsigned len)
     return res;
 }
 
-void binder_send_reply(struct binder_state *bs,
-                       struct binder_io *reply,
-                       void *buffer_to_free,
-                       int status)
+/* writes the pending replies right away */
+static void binder_flush_replies(struct binder_state *bs)
 {
-    struct {
-        uint32_t cmd_free;
-        void *buffer;
-        uint32_t cmd_reply;
-        struct binder_txn txn;
-    } __attribute__((packed)) data;
-
-    data.cmd_free = BC_FREE_BUFFER;
-    data.buffer = buffer_to_free;
-    data.cmd_reply = BC_REPLY;
-    data.txn.target = 0;
-    data.txn.cookie = 0;
-    data.txn.code = 0;
+    if (bs->pending) {
+        binder_write(bs, bs->replies, bs->pending * sizeof(bs->replies[0]));
+        bs->pending = 0;
+        bs->stats.early_flushes++;
+    }
+}
+
+/* queues the reply to a transaction whose data is in the
+ * bs->rdata[bs->pending] slot, along with freeing its buffer */
+static void binder_queue_reply(struct binder_state *bs,
+                               struct binder_io *reply,
+                               void *buffer_to_free,
+                               int status)
+{
+    struct binder_reply *data = &bs->replies[bs->pending];
+
+    data->cmd_free = BC_FREE_BUFFER;
+    data->buffer = buffer_to_free;
+    data->cmd_reply = BC_REPLY;
+    data->txn.target = 0;
+    data->txn.cookie = 0;
+    data->txn.code = 0;
     if (status) {
-        data.txn.flags = TF_STATUS_CODE;
-        data.txn.data_size = sizeof(int);
-        data.txn.offs_size = 0;
-        data.txn.data = &status;
-        data.txn.offs = 0;
+        bs->status[bs->pending] = status;
+        data->txn.flags = TF_STATUS_CODE;
+        data->txn.data_size = sizeof(int);
+        data->txn.offs_size = 0;
+        data->txn.data = &bs->status[bs->pending];
+        data->txn.offs = 0;
     } else {
-        data.txn.flags = 0;
-        data.txn.data_size = reply->data - reply->data0;
-        data.txn.offs_size = ((char*) reply->offs) - ((char*) reply->offs0);
-        data.txn.data = reply->data0;
-        data.txn.offs = reply->offs0;
+        data->txn.flags = 0;
+        data->txn.data_size = reply->data - reply->data0;
+        data->txn.offs_size = ((char*) reply->offs) - ((char*) reply->offs0);
+        data->txn.data = reply->data0;
+        data->txn.offs = reply->offs0;
     }
-    binder_write(bs, &data, sizeof(data));
+    bs->pending++;
+}
+
+static void binder_count_txn(struct binder_state *bs, uint32_t code,
+                             uint64_t start, uint64_t end)
+{
+    struct binder_stats *stats = &bs->stats;
+    uint64_t ns = end - start;
+
+    if (!stats->transactions)
+        stats->first_txn_ns = start;
+    stats->last_txn_ns = end;
+    stats->transactions++;
+    stats->handler_ns += ns;
+    if (ns > stats->handler_max_ns)
+        stats->handler_max_ns = ns;
+    if (code >= BINDER_STATS_CODES)
+        code = 0;
+    stats->code_count[code]++;
+    stats->code_ns[code] += ns;
 }
 
 int binder_parse(struct binder_state *bs, struct binder_io *bio,
@@ -196,6 +255,7 @@ int binder_parse(struct binder_state *bs, struct binder_io *bio,
 {
     int r = 1;
     uint32_t *end = ptr + (size / 4);
+    unsigned batch = 0;
 
     while (ptr < end) {
         uint32_t cmd = *ptr++;
@@ -224,15 +284,22 @@ int binder_parse(struct binder_state *bs, struct binder_io *bio,
             }
             binder_dump_txn(txn);
             if (func) {
-                unsigned rdata[256/4];
                 struct binder_io msg;
                 struct binder_io reply;
+                uint64_t start;
                 int res;
 
-                bio_init(&reply, rdata, sizeof(rdata), 4);
+                if (bs->pending == MAX_PENDING_REPLIES)
+                    binder_flush_replies(bs);
+                start = now_ns();
+                bio_init(&reply, bs->rdata[bs->pending],
+                         sizeof(bs->rdata[0]), 4);
                 bio_init_from_txn(&msg, txn);
                 res = func(bs, txn, &msg, &reply);
-                binder_send_reply(bs, &reply, txn->data, res);
+                binder_queue_reply(bs, &reply, txn->data, res);
+                binder_count_txn(bs, txn->code, start, now_ns());
+                if (++batch > bs->stats.max_batch)
+                    bs->stats.max_batch = batch;
             }
             ptr += sizeof(*txn) / sizeof(uint32_t);
             break;
@@ -354,11 +421,46 @@ fail:
     return -1;
 }
 
+void binder_request_stats_dump(void)
+{
+    stats_dump_requested = 1;
+}
+
+void binder_dump_stats(struct binder_state *bs)
+{
+    struct binder_stats *stats = &bs->stats;
+    uint64_t now = now_ns();
+    unsigned code;
+
+#define MS(ns) ((unsigned) ((ns) / 1000000))
+#define US(ns) ((unsigned) ((ns) / 1000))
+    ALOGI("up %u ms, %u transactions, %u ioctls, %u early flushes\n",
+          MS(now - stats->loop_start_ns), stats->transactions,
+          stats->ioctls, stats->early_flushes);
+    if (!stats->transactions)
+        return;
+    ALOGI("first transaction at %u ms, last at %u ms, "
+          "at most %u per read\n",
+          MS(stats->first_txn_ns - stats->loop_start_ns),
+          MS(stats->last_txn_ns - stats->loop_start_ns), stats->max_batch);
+    ALOGI("handler: %u us total, %u us avg, %u us max\n",
+          US(stats->handler_ns), US(stats->handler_ns / stats->transactions),
+          US(stats->handler_max_ns));
+    for (code = 0; code < BINDER_STATS_CODES; code++) {
+        if (stats->code_count[code])
+            ALOGI("  code %u: %u calls, %u us avg\n", code,
+                  stats->code_count[code],
+                  US(stats->code_ns[code] / stats->code_count[code]));
+    }
+#undef MS
+#undef US
+}
+
 void binder_loop(struct binder_state *bs, binder_handler func)
 {
     int res;
     struct binder_write_read bwr;
-    unsigned readbuf[32];
+    unsigned readbuf[256];
 
     bwr.write_size = 0;
     bwr.write_consumed = 0;
@@ -367,17 +469,35 @@ void binder_loop(struct binder_state *bs, binder_handler func)
     readbuf[0] = BC_ENTER_LOOPER;
     binder_write(bs, readbuf, sizeof(unsigned));
 
+    bs->stats.loop_start_ns = now_ns();
+
     for (;;) {
+        /* send the replies to the last transactions with the next read */
+        bwr.write_size = bs->pending * sizeof(bs->replies[0]);
+        bwr.write_consumed = 0;
+        bwr.write_buffer = (unsigned) bs->replies;
         bwr.read_size = sizeof(readbuf);
         bwr.read_consumed = 0;
         bwr.read_buffer = (unsigned) readbuf;
 
         res = ioctl(bs->fd, BINDER_WRITE_READ, &bwr);
-
+        bs->stats.ioctls++;
+
+        if (res < 0 && errno == EINTR) {
+            /* the replies are written before the read blocks */
+            if (bwr.write_consumed >= bwr.write_size)
+                bs->pending = 0;
+            if (stats_dump_requested) {
+                stats_dump_requested = 0;
+                binder_dump_stats(bs);
+            }
+            continue;
+        }
         if (res < 0) {
             ALOGE("binder_loop: ioctl failed (%s)\n", strerror(errno));
             break;
         }
+        bs->pending = 0;
 
         res = binder_parse(bs, 0, readbuf, bwr.read_consumed, func);
         if (res == 0) {
@@ -63,6 +63,24 @@ enum {
     SVC_MGR_LIST_SERVICES,
 };
 
+/* counters kept by binder_loop(), printed by binder_dump_stats() */
+#define BINDER_STATS_CODES 8
+
+struct binder_stats
+{
+    uint32_t ioctls;            /* BINDER_WRITE_READs made by the loop */
+    uint32_t transactions;
+    uint32_t max_batch;         /* most transactions handled per read */
+    uint32_t early_flushes;     /* replies written without a read */
+    uint64_t loop_start_ns;
+    uint64_t first_txn_ns;
+    uint64_t last_txn_ns;
+    uint64_t handler_ns;
+    uint64_t handler_max_ns;
+    uint32_t code_count[BINDER_STATS_CODES];    /* other codes count as 0 */
+    uint64_t code_ns[BINDER_STATS_CODES];
+};
+
 typedef int (*binder_handler)(struct binder_state *bs,
                               struct binder_txn *txn,
                               struct binder_io *msg,
@@ -94,6 +112,13 @@ void binder_link_to_death(struct binder_state *bs, void *ptr, struct binder_deat
 
 void binder_loop(struct binder_state *bs, binder_handler func);
 
+/* logs the binder_loop() counters */
+void binder_dump_stats(struct binder_state *bs);
+
+/* async-signal-safe: makes binder_loop() log its counters once the
+ * signal interrupts its read */
+void binder_request_stats_dump(void);
+
 int binder_become_context_manager(struct binder_state *bs);
 
 /* allocate a binder_io, providing a stack-allocated working
@@ -5,6 +5,8 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <string.h>
 
 #include <private/android_filesystem_config.h>
 
@@ -105,6 +107,7 @@ int svc_can_register(unsigned uid, uint16_t *name)
 struct svcinfo 
 {
     struct svcinfo *next;
+    struct svcinfo *hash_next;
     void *ptr;
     struct binder_death death;
     int allow_isolated;
@@ -112,13 +115,31 @@ struct svcinfo
     uint16_t name[0];
 };
 
+/* svclist keeps the registration order for SVC_MGR_LIST_SERVICES,
+ * lookups go through svchash.
+ */
 struct svcinfo *svclist = 0;
 
+#define SVC_HASH_SIZE 256
+
+struct svcinfo *svchash[SVC_HASH_SIZE];
+
+static unsigned svc_hash(uint16_t *s16, unsigned len)
+{
+    /* FNV-1a */
+    unsigned h = 2166136261u;
+    while (len--) {
+        h ^= *s16++;
+        h *= 16777619u;
+    }
+    return h & (SVC_HASH_SIZE - 1);
+}
+
 struct svcinfo *find_svc(uint16_t *s16, unsigned len)
 {
     struct svcinfo *si;
 
-    for (si = svclist; si; si = si->next) {
+    for (si = svchash[svc_hash(s16, len)]; si; si = si->hash_next) {
         if ((len == si->len) &&
             !memcmp(s16, si->name, len * sizeof(uint16_t))) {
             return si;
@@ -169,6 +190,7 @@ int do_add_service(struct binder_state *bs,
                    void *ptr, unsigned uid, int allow_isolated)
 {
     struct svcinfo *si;
+    unsigned hash;
     //ALOGI("add_service('%s',%p,%s) uid=%d\n", str8(s), ptr,
     //        allow_isolated ? "allow_isolated" : "!allow_isolated", uid);
 
@@ -205,6 +227,9 @@ int do_add_service(struct binder_state *bs,
         si->allow_isolated = allow_isolated;
         si->next = svclist;
         svclist = si;
+        hash = svc_hash(s, len);
+        si->hash_next = svchash[hash];
+        svchash[hash] = si;
     }
 
     binder_acquire(bs, ptr);
@@ -281,13 +306,26 @@ int svcmgr_handler(struct binder_state *bs,
     return 0;
 }
 
+static void dump_stats_handler(int sig)
+{
+    binder_request_stats_dump();
+}
+
 int main(int argc, char **argv)
 {
     struct binder_state *bs;
     void *svcmgr = BINDER_SERVICE_MANAGER;
+    struct sigaction sa;
 
     bs = binder_open(128*1024);
 
+    /* "kill -USR1" logs the binder_loop() counters; no SA_RESTART so the
+     * signal interrupts the blocking read */
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = dump_stats_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+
     if (binder_become_context_manager(bs)) {
         ALOGE("cannot become context manager (%s)\n", strerror(errno));
         return -1;
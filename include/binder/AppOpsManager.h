@@ -67,6 +67,7 @@ public:
     };
 
     AppOpsManager();
+    ~AppOpsManager();
 
     int32_t checkOp(int32_t op, int32_t uid, const String16& callingPackage);
     int32_t noteOp(int32_t op, int32_t uid, const String16& callingPackage);
@@ -77,10 +78,19 @@ public:
     void stopWatchingMode(const sp<IAppOpsCallback>& callback);
 
 private:
+    // The allowed modes seen by checkOp() and noteOp(), per op, uid and
+    // package. They are dropped when the service says the op changed for
+    // the package, and anyway after a few seconds.
+    class ModeCache;
+
     Mutex mLock;
     sp<IAppOpsService> mService;
+    sp<ModeCache> mCache;
 
     sp<IAppOpsService> getService();
+    // the mode from the cache if it has one, from the service otherwise
+    int32_t cachedOp(int32_t op, int32_t uid, const String16& callingPackage,
+            bool note);
 };
 
 
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_BLOB_POOL_H
+#define ANDROID_BLOB_POOL_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/RefBase.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+// ---------------------------------------------------------------------------
+namespace android {
+
+/*
+ * BlobPool is a set of ashmem buffers that Parcel::writeBlob() reuses for
+ * the blobs that don't fit in place, instead of creating and mapping a new
+ * region for each of them. The receiving process still maps each blob it
+ * reads, ashmem regions can't be told apart there to keep them mapped.
+ *
+ * The buffers are used in turn: a blob written from the pool stays valid
+ * until getCount() more blobs have been written from it. Receivers must be
+ * done reading a blob by then, which is the case when they only read it
+ * while handling the transaction, the buffer of a blob being reused once
+ * the call returns. Pools are meant to be used with one peer at a time
+ * since a buffer is shared with every process it's been sent to.
+ */
+class BlobPool : public RefBase
+{
+public:
+    // count buffers of capacity bytes each
+    BlobPool(size_t count, size_t capacity);
+
+    status_t initCheck() const;
+
+    size_t getCount() const;
+    size_t getCapacity() const;
+
+private:
+    friend class Parcel;
+
+    virtual ~BlobPool();
+
+    struct Buffer {
+        int fd;
+        void* data;
+    };
+
+    // returns the next buffer to write a blob to, and its index
+    const Buffer& nextBuffer(int32_t* outIndex);
+
+    // identifies the pool in the processes its buffers are sent to
+    const int64_t mId;
+    const size_t mCapacity;
+    status_t mInitCheck;
+    Vector<Buffer> mBuffers;
+
+    mutable Mutex mLock;
+    size_t mNext;
+};
+
+}; // namespace android
+// ---------------------------------------------------------------------------
+
+#endif // ANDROID_BLOB_POOL_H
@@ -37,7 +37,9 @@ public:
     // flags returned by getFlags()
     enum {
         READ_ONLY   = 0x00000001,
-        USE_ION_FD  = 0x00000008
+        USE_ION_FD  = 0x00000008,
+        // the ION heap is mapped cached: see MemoryHeapBaseIon::syncCache()
+        CACHED      = 0x00000010
     };
 
     virtual int         getHeapID() const = 0;
@@ -22,6 +22,8 @@
 #include <binder/ProcessState.h>
 #include <utils/Vector.h>
 
+#include <time.h>
+
 #ifdef HAVE_WIN32_PROC
 typedef  int  uid_t;
 #endif
@@ -29,6 +31,22 @@ typedef  int  uid_t;
 // ---------------------------------------------------------------------------
 namespace android {
 
+class BinderThreadProfile;
+class Looper;
+
+// Receives the outcome of IPCThreadState::transactAsync().
+class TransactionCallback : public virtual RefBase
+{
+public:
+    // err is the status of the transaction, reply is only valid during
+    // the call
+    virtual void        onTransactionComplete(status_t err,
+                                              const Parcel& reply) = 0;
+
+protected:
+    virtual             ~TransactionCallback() { }
+};
+
 class IPCThreadState
 {
 public:
@@ -50,10 +68,31 @@ public:
 
             int64_t             clearCallingIdentity();
             void                restoreCallingIdentity(int64_t token);
+
+            // How urgent the transactions this thread sends are. The thread
+            // serving them moves to the matching cgroup, and for
+            // LATENCY_CLASS_REALTIME to SCHED_FIFO (see
+            // ProcessState::setRealtimeTransactionPriority()), until it
+            // replies. LATENCY_CLASS_FOREGROUND and LATENCY_CLASS_REALTIME
+            // are only honoured from system uids, an app's count as
+            // LATENCY_CLASS_NONE. A server process in the background group
+            // serves every class there. LATENCY_CLASS_NONE (the default)
+            // only passes on the nice value, as the driver always does.
+            enum LatencyClass {
+                LATENCY_CLASS_NONE          = 0,
+                LATENCY_CLASS_BACKGROUND    = 1,
+                LATENCY_CLASS_FOREGROUND    = 2,
+                LATENCY_CLASS_REALTIME      = 3
+            };
+            void                setLatencyClass(LatencyClass latencyClass);
+            LatencyClass        getLatencyClass() const;
             
             void                flushCommands();
 
             void                joinThreadPool(bool isMain = true);
+            // mayRetire lets the thread leave the pool when
+            // ProcessState's adaptive sizing finds it isn't needed
+            void                joinThreadPool(bool isMain, bool mayRetire);
             
             // Stop the local process.
             void                stopProcess(bool immediate = true);
@@ -62,6 +101,32 @@ public:
                                          uint32_t code, const Parcel& data,
                                          Parcel* reply, uint32_t flags);
 
+            // Between beginOnewayBatch() and endOnewayBatch(), the one-way
+            // transactions of this thread are sent to the driver together
+            // instead of costing an ioctl each: at the end of the batch, once
+            // MAX_ONEWAY_BATCH of them are pending, or before any other
+            // transaction. Batches nest; the outermost endOnewayBatch()
+            // returns the first error of the transactions batched.
+            void                beginOnewayBatch();
+            status_t            endOnewayBatch();
+
+            enum { MAX_ASYNC_TRANSACTION_THREADS = 4 };
+
+            // Sends a two-way transaction to binder without blocking the
+            // calling thread. data is copied. callback is called with the
+            // reply from looper, or from the thread that made the call if
+            // looper is NULL. The driver needs a blocked thread per
+            // outstanding call: up to MAX_ASYNC_TRANSACTION_THREADS calls
+            // are in flight at once, others wait for a thread in the order
+            // they were submitted, and calls in flight may complete in any
+            // order.
+    static  status_t            transactAsync(const sp<IBinder>& binder,
+                                              uint32_t code,
+                                              const Parcel& data,
+                                              const sp<TransactionCallback>& callback,
+                                              const sp<Looper>& looper,
+                                              uint32_t flags = 0);
+
             void                incStrongHandle(int32_t handle);
             void                decStrongHandle(int32_t handle);
             void                incWeakHandle(int32_t handle);
@@ -83,9 +148,23 @@ public:
     static  void                disableBackgroundScheduling(bool disable);
     
 private:
+    enum { MAX_ONEWAY_BATCH = 32 };
+    // the driver passes the transaction flags through untouched, the
+    // latency class travels in bits TF_* and FLAG_ONEWAY don't use
+    enum {
+        LATENCY_CLASS_SHIFT = 24,
+        LATENCY_CLASS_MASK  = 0x3 << LATENCY_CLASS_SHIFT
+    };
+
                                 IPCThreadState();
                                 ~IPCThreadState();
 
+            status_t            batchOnewayTransaction(int32_t handle,
+                                                       uint32_t code,
+                                                       const Parcel& data,
+                                                       uint32_t flags);
+            status_t            flushOnewayBatch();
+
             status_t            sendReply(const Parcel& reply, uint32_t flags);
             status_t            waitForResponse(Parcel *reply,
                                                 status_t *acquireResult=NULL);
@@ -99,6 +178,19 @@ private:
             status_t            executeCommand(int32_t command);
             
             void                clearCaller();
+
+            // switches to the scheduling the latency class of the
+            // transaction being served asks for, returns true if
+            // restoreScheduling() must be called once it's done
+            bool                adoptLatencyClass(LatencyClass latencyClass,
+                                                  int curPrio);
+            void                restoreScheduling(int curPrio);
+
+            // a thread that may retire from the pool is woken up every
+            // idle timeout while it waits for work, to see whether the
+            // pool can do without it
+            bool                startIdleTimer(nsecs_t timeout);
+            void                stopIdleTimer();
             
     static  void                threadDestructor(void *st);
     static  void                freeBuffer(Parcel* parcel,
@@ -118,6 +210,19 @@ private:
             uid_t               mCallingUid;
             int32_t             mStrictModePolicy;
             int32_t             mLastTransactionBinderFlags;
+            // what this thread recorded for BinderProfiler, or NULL
+            BinderThreadProfile* mProfile;
+            int32_t             mOnewayBatchDepth;
+            // copies of the data of the batched transactions, which mOut
+            // points to until they are sent
+            Vector<Parcel*>     mOnewayBatch;
+            status_t            mOnewayBatchError;
+            LatencyClass        mLatencyClass;
+            bool                mIdleTimerArmed;
+            timer_t             mIdleTimer;
+            // set while joinThreadPool() waits for the next command, the
+            // only time the idle timer may interrupt the driver
+            bool                mWaitingForWork;
 };
 
 }; // namespace android
@@ -34,7 +34,19 @@ class SimpleBestFitAllocator;
 class MemoryDealer : public RefBase
 {
 public:
-    MemoryDealer(size_t size, const char* name = 0);
+    enum Policy {
+        // one best-fit search over all the blocks of the heap per
+        // allocation, freed blocks are merged right away
+        POLICY_BEST_FIT     = 0,
+        // allocations of up to 4KB are rounded up to a power of two and
+        // freed blocks of those sizes are kept on a free list per size:
+        // allocating them again is O(1). Larger allocations are best-fit,
+        // and the small free blocks are merged back when they don't fit.
+        POLICY_SIZE_CLASSES = 1
+    };
+
+    MemoryDealer(size_t size, const char* name = 0,
+            Policy policy = POLICY_BEST_FIT);
 
     virtual sp<IMemory> allocate(size_t size);
     virtual void        deallocate(size_t offset);
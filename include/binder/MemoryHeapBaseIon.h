@@ -34,16 +34,42 @@
 
 namespace android {
 
+/*
+ * ION buffers are mapped cached unless NO_CACHING is passed, in which case
+ * getFlags() has CACHED set and the CPU's view of the buffer must be kept
+ * coherent with flush() and invalidate().  Only the ranges given are
+ * maintained, so partial updates of big buffers stay cheap.
+ *
+ * IMemoryHeap has no cache maintenance of its own; a process holding a
+ * remote CACHED heap calls syncCache() with its own ION client on the
+ * heap's fd.
+ */
 class MemoryHeapBaseIon : public MemoryHeapBase
 {
 public:
     enum {
-        USE_ION_FD = IMemoryHeap::USE_ION_FD
+        USE_ION_FD = IMemoryHeap::USE_ION_FD,
+        CACHED = IMemoryHeap::CACHED
     };
     MemoryHeapBaseIon(size_t size, uint32_t flags = 0, char const* name = NULL);
     MemoryHeapBaseIon(int fd, size_t size, uint32_t flags = 0, uint32_t offset = 0);
     ~MemoryHeapBaseIon();
+
+    // flush() makes what the CPU wrote visible to devices, invalidate()
+    // makes what devices wrote visible to the CPU.  Both do nothing
+    // unless the heap is CACHED.
+    status_t flush(size_t offset, size_t size) const;
+    status_t invalidate(size_t offset, size_t size) const;
+
+    /*
+     * Flushes (forDevice) or invalidates [offset, offset+size) of the heap
+     * of heapSize bytes mapped from bufferOffset in the ION buffer fd.
+     */
+    static status_t syncCache(int ionClient, int fd, size_t heapSize,
+            uint32_t bufferOffset, size_t offset, size_t size, bool forDevice);
 private:
+    status_t syncCache(size_t offset, size_t size, bool forDevice) const;
+
     int mIonClient;
 };
 
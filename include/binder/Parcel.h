@@ -28,6 +28,7 @@
 namespace android {
 
 template <typename T> class LightFlattenable;
+class BlobPool;
 class Flattenable;
 class IBinder;
 class IPCThreadState;
@@ -107,6 +108,16 @@ public:
     template<typename T>
     status_t            write(const LightFlattenable<T>& val);
 
+    // Writes count followed by the values, copied in one go. T must be a
+    // POD type (no pointers, binders or file descriptors).
+    template<typename T>
+    status_t            writeArray(const T* values, size_t count);
+    inline status_t     writeInt32Array(size_t len, const int32_t* val)
+                            { return writeArray(val, len); }
+    inline status_t     writeInt64Array(size_t len, const int64_t* val)
+                            { return writeArray(val, len); }
+    inline status_t     writeFloatArray(size_t len, const float* val)
+                            { return writeArray(val, len); }
 
     // Place a native_handle into the parcel (the native_handle's file-
     // descriptors are dup'ed, so it is safe to delete the native_handle
@@ -129,6 +140,12 @@ public:
     // The caller should call release() on the blob after writing its contents.
     status_t            writeBlob(size_t len, WritableBlob* outBlob);
 
+    // Writes a blob using one of the buffers of pool when it doesn't fit
+    // in place, see BlobPool. Falls back to writeBlob(len, outBlob) when
+    // len is larger than the buffers of the pool.
+    status_t            writeBlob(size_t len, const sp<BlobPool>& pool,
+                                  WritableBlob* outBlob);
+
     status_t            writeObject(const flat_binder_object& val, bool nullMetaData);
 
     // Like Parcel.java's writeNoException().  Just writes a zero int32.
@@ -162,6 +179,23 @@ public:
     template<typename T>
     status_t            read(LightFlattenable<T>& val) const;
 
+    // Reads an array written by writeArray() into outValues.
+    template<typename T>
+    status_t            readArray(Vector<T>* outValues) const;
+    inline status_t     readInt32Array(Vector<int32_t>* outValues) const
+                            { return readArray(outValues); }
+    inline status_t     readInt64Array(Vector<int64_t>* outValues) const
+                            { return readArray(outValues); }
+    inline status_t     readFloatArray(Vector<float>* outValues) const
+                            { return readArray(outValues); }
+
+    // Returns the values of an array written by writeArray() where they
+    // are in the parcel, valid until the parcel is modified. Returns NULL
+    // and doesn't move the read position if the array is malformed or the
+    // values aren't aligned for T, use readArray() then.
+    template<typename T>
+    const T*            readArrayInplace(size_t* outCount) const;
+
     // Like Parcel.java's readExceptionCode().  Reads the first int32
     // off of a Parcel's header, returning 0 or the negative error
     // code on exceptions, but also deals with skipping over rich
@@ -217,6 +251,23 @@ private:
     void                freeDataNoInit();
     void                initState();
     void                scanForFds() const;
+
+    // The data and objects of small Parcels are kept in mInlineData and
+    // mInlineObjects. Larger data buffers come from a per-thread cache of
+    // the buffers of the Parcels freed on the thread before going to
+    // malloc.
+    enum {
+        INLINE_DATA_CAPACITY = 256,
+        INLINE_OBJECTS_CAPACITY = 4
+    };
+    inline uint8_t*     inlineData() {
+        return reinterpret_cast<uint8_t*>(mInlineData);
+    }
+    uint8_t*            allocData(size_t desired, size_t* outCapacity);
+    uint8_t*            reallocData(size_t desired, size_t* outCapacity);
+    void                freeDataBuffer(uint8_t* data, size_t capacity);
+    size_t*             reallocObjects(size_t desired);
+    void                freeObjects(size_t* objects);
                         
     template<class T>
     status_t            readAligned(T *pArg) const;
@@ -243,6 +294,9 @@ private:
     release_func        mOwner;
     void*               mOwnerCookie;
 
+    uint64_t            mInlineData[INLINE_DATA_CAPACITY / sizeof(uint64_t)];
+    size_t              mInlineObjects[INLINE_OBJECTS_CAPACITY];
+
     class Blob {
     public:
         Blob();
@@ -314,6 +368,74 @@ status_t Parcel::read(LightFlattenable<T>& val) const {
     return NO_ERROR;
 }
 
+template<typename T>
+status_t Parcel::writeArray(const T* values, size_t count) {
+    if (count > size_t(INT32_MAX) / sizeof(T)) {
+        return BAD_VALUE;
+    }
+    const size_t size = count * sizeof(T);
+    // grow once for the count and the padded values
+    const size_t end = dataPosition() + sizeof(int32_t) + ((size + 3) & ~3);
+    if (end > dataCapacity()) {
+        status_t err = setDataCapacity(end);
+        if (err != NO_ERROR) {
+            return err;
+        }
+    }
+    status_t err = writeInt32(int32_t(count));
+    if (err != NO_ERROR || !size) {
+        return err;
+    }
+    void* buffer = writeInplace(size);
+    if (buffer == NULL) {
+        return NO_MEMORY;
+    }
+    memcpy(buffer, values, size);
+    return NO_ERROR;
+}
+
+template<typename T>
+const T* Parcel::readArrayInplace(size_t* outCount) const {
+    const size_t pos = dataPosition();
+    int32_t count;
+    if (readInt32(&count) != NO_ERROR || count < 0 ||
+            size_t(count) > size_t(INT32_MAX) / sizeof(T)) {
+        setDataPosition(pos);
+        return NULL;
+    }
+    const void* values = data() + dataPosition();
+    if (uintptr_t(values) % __alignof__(T) ||
+            (count && readInplace(count * sizeof(T)) == NULL)) {
+        setDataPosition(pos);
+        return NULL;
+    }
+    *outCount = count;
+    return static_cast<const T*>(values);
+}
+
+template<typename T>
+status_t Parcel::readArray(Vector<T>* outValues) const {
+    int32_t count;
+    status_t err = readInt32(&count);
+    if (err != NO_ERROR) {
+        return err;
+    }
+    if (count < 0 || size_t(count) > size_t(INT32_MAX) / sizeof(T)) {
+        return BAD_VALUE;
+    }
+    outValues->clear();
+    if (count) {
+        const void* values = readInplace(count * sizeof(T));
+        if (values == NULL) {
+            return NOT_ENOUGH_DATA;
+        }
+        if (outValues->appendArray(static_cast<const T*>(values), count) < 0) {
+            return NO_MEMORY;
+        }
+    }
+    return NO_ERROR;
+}
+
 // ---------------------------------------------------------------------------
 
 inline TextOutput& operator<<(TextOutput& to, const Parcel& parcel)
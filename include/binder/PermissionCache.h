@@ -23,6 +23,7 @@
 #include <utils/String16.h>
 #include <utils/Singleton.h>
 #include <utils/SortedVector.h>
+#include <utils/Timers.h>
 
 namespace android {
 // ---------------------------------------------------------------------------
@@ -30,19 +31,24 @@ namespace android {
 /*
  * PermissionCache caches permission checks for a given uid.
  *
- * Currently the cache is not updated when there is a permission change,
- * for instance when an application is uninstalled.
+ * Nothing tells the cache about permission changes, so every entry
+ * expires: denials after a few seconds, so that a permission granted later
+ * is soon seen, grants after a minute, so that a permission revoked, for
+ * instance when an application is uninstalled, eventually is.
  *
  * IMPORTANT: for the reason stated above, only system permissions are safe
  * to cache. This restriction may be lifted at a later time.
  *
  */
 
+class String8;
+
 class PermissionCache : Singleton<PermissionCache> {
     struct Entry {
         String16    name;
         uid_t       uid;
         bool        granted;
+        nsecs_t     expires;
         inline bool operator < (const Entry& e) const {
             return (uid == e.uid) ? (name < e.name) : (uid < e.uid);
         }
@@ -53,6 +59,8 @@ class PermissionCache : Singleton<PermissionCache> {
     SortedVector< String16 > mPermissionNamesPool;
     // this is our cache per say. it stores pooled names.
     SortedVector< Entry > mCache;
+    mutable uint32_t mHits;
+    mutable uint32_t mMisses;
 
     // free the whole cache, but keep the permission name pool
     void purge();
@@ -62,9 +70,16 @@ class PermissionCache : Singleton<PermissionCache> {
 
     void cache(const String16& permission, uid_t uid, bool granted);
 
+    // removes the expired entries, or all of them if the cache is still
+    // full after that
+    void trimLocked(nsecs_t now);
+
 public:
     PermissionCache();
 
+    // the content of the cache and its hit rate
+    static void dump(String8& result);
+
     static bool checkCallingPermission(const String16& permission);
 
     static bool checkCallingPermission(const String16& permission,
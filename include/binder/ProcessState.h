@@ -23,6 +23,7 @@
 #include <utils/String16.h>
 
 #include <utils/threads.h>
+#include <utils/Timers.h>
 
 // ---------------------------------------------------------------------------
 namespace android {
@@ -73,6 +74,28 @@ public:
             status_t            setThreadPoolMaxThreadCount(size_t maxThreads);
             void                giveThreadPoolName();
 
+            // stack size of the threads spawned for the pool, 0 (the
+            // default) for the default stack size
+            void                setThreadPoolStackSize(size_t stackSize);
+
+            // Turns on adaptive sizing of the pool. Pooled threads beyond
+            // the most the process needed at once in the last idleTimeout
+            // (plus a spare one) leave the pool when they're done with
+            // their work, or after idleTimeout without any. A thread is
+            // spawned as soon as all the pooled threads are busy, up to the
+            // max thread count. 0 (the default) leaves the pool to the
+            // driver. Threads that joined the pool before it's set only
+            // leave after a command.
+            void                setThreadPoolIdleTimeout(nsecs_t idleTimeout);
+
+            void                dumpThreadPool(String8& result) const;
+
+            // SCHED_FIFO priority a thread serving a transaction tagged
+            // IPCThreadState::LATENCY_CLASS_REALTIME by a system uid runs
+            // at, 0 to ignore the tag. Defaults to 1.
+            void                setRealtimeTransactionPriority(int priority);
+            int                 getRealtimeTransactionPriority() const;
+
 private:
     friend class IPCThreadState;
     
@@ -82,20 +105,57 @@ private:
                                 ProcessState(const ProcessState& o);
             ProcessState&       operator=(const ProcessState& o);
             String8             makeBinderThreadName();
+            void                spawnPooledThread(bool isMain, bool mayRetire);
+
+            // called by IPCThreadState::joinThreadPool(), around every
+            // command a pooled thread executes. threadPoolCommandStarted()
+            // returns whether the command was counted, which must be passed
+            // on to threadPoolCommandFinished(); that returns true if the
+            // thread should leave the pool now, and so does
+            // threadPoolIdleExpired(), for a thread that waited
+            // idleTimeout for a command.
+            nsecs_t             getThreadPoolIdleTimeout() const;
+            void                threadPoolJoined();
+            bool                threadPoolCommandStarted();
+            bool                threadPoolCommandFinished(bool counted, bool mayRetire);
+            bool                threadPoolIdleExpired();
+            void                threadPoolLeft(bool retired);
+            // with mThreadPoolLock held
+            void                rollThreadPoolWindowLocked(nsecs_t now);
+            bool                retireThreadLocked();
             
+            // The entries are read without mLock by the lookups, and only
+            // changed with mLock held. They never move: the table is made
+            // of fixed-size segments, which are never freed.
             struct handle_entry {
-                IBinder* binder;
-                RefBase::weakref_type* refs;
+                IBinder* volatile binder;
+                RefBase::weakref_type* volatile refs;
+                // lookups going on without mLock, expungeHandle() waits
+                // for them before the refs can go away
+                volatile int32_t readers;
             };
-            
+
+            enum {
+                HANDLE_SEGMENT_SIZE = 256,
+                MAX_HANDLE_SEGMENTS = 1024
+            };
+
             handle_entry*       lookupHandleLocked(int32_t handle);
+            // the entry of handle if its segment was allocated, without mLock
+            handle_entry*       peekHandle(int32_t handle) const;
+            // a weak reference on the proxy of handle if there is a live
+            // one, without mLock; the caller owns the reference
+            IBinder*            attemptWeakProxy(int32_t handle);
+            // makes binder the proxy of the entry, with mLock held
+            void                publishHandleLocked(handle_entry* e,
+                                                    IBinder* binder);
 
             int                 mDriverFD;
             void*               mVMStart;
             
     mutable Mutex               mLock;  // protects everything below.
             
-            Vector<handle_entry>mHandleToObject;
+            handle_entry* volatile mHandleSegments[MAX_HANDLE_SEGMENTS];
 
             bool                mManagesContexts;
             context_check_func  mBinderContextCheckFunc;
@@ -108,6 +168,28 @@ private:
             String8             mRootDir;
             bool                mThreadPoolStarted;
     volatile int32_t            mThreadPoolSeq;
+    volatile int32_t            mRealtimeTransactionPriority;
+    // whether an idle timeout is set, readable without mThreadPoolLock
+    volatile int32_t            mThreadPoolAdaptive;
+
+    mutable Mutex               mThreadPoolLock;  // protects everything below.
+
+            size_t              mMaxThreads;
+            size_t              mThreadPoolStackSize;
+            nsecs_t             mThreadPoolIdleTimeout;
+            // threads in the pool, how many of them are executing a
+            // command, and how many threads we spawned that haven't
+            // joined yet
+            int32_t             mThreadPoolThreads;
+            int32_t             mThreadPoolBusy;
+            int32_t             mThreadPoolPending;
+            // most busy threads at once since mThreadPoolWindowStart, and
+            // in the window before it
+            int32_t             mThreadPoolPeakBusy;
+            int32_t             mThreadPoolLastPeakBusy;
+            nsecs_t             mThreadPoolWindowStart;
+            uint32_t            mThreadPoolSpawned;
+            uint32_t            mThreadPoolRetired;
 };
     
 }; // namespace android
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QUANTILE_ESTIMATOR_H
+#define _QUANTILE_ESTIMATOR_H
+
+#include <math.h>
+
+// Estimates one quantile of a stream of samples in constant space, using the
+// P-square algorithm of Jain and Chlamtac (CACM 28:10, 1985): five markers
+// track the minimum, the maximum, the quantile and halfway points on either
+// side of it, and are moved along a piecewise-parabolic fit of the
+// distribution as samples arrive.  The estimate is exact for the first five
+// samples.
+// Not multithread safe
+class QuantileEstimator {
+
+public:
+
+    // p is the quantile to estimate, in (0, 1), e.g. 0.99 for the 99th percentile
+    explicit QuantileEstimator(double p);
+
+    ~QuantileEstimator() { }
+
+    // add x to the set of samples
+    void sample(double x);
+
+    // return the estimated quantile of all samples so far, or NAN if none
+    double quantile() const;
+
+    // return the quantile this estimator was constructed for
+    double p() const { return mP; }
+
+    // return the number of samples added so far
+    unsigned n() const { return mN; }
+
+    // reset the set of samples to be empty
+    void reset();
+
+private:
+    double parabolic(int i, int d) const;
+    double linear(int i, int d) const;
+
+    double mP;
+    unsigned mN;                // number of samples so far
+    double mHeights[5];         // marker heights; the first samples until there are 5
+    double mPositions[5];       // actual marker positions, 1-based
+    double mDesired[5];         // desired marker positions
+    double mIncrements[5];      // increments of the desired positions per sample
+
+};
+
+#endif // _QUANTILE_ESTIMATOR_H
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _THREAD_CPU_PROFILER_H
+#define _THREAD_CPU_PROFILER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/KeyedVector.h>
+#include <utils/String8.h>
+#include <utils/Timers.h>
+
+#include <cpustats/CentralTendencyStatistics.h>
+#include <cpustats/QuantileEstimator.h>
+#include <cpustats/ThreadCpuUsage.h>
+
+namespace android {
+
+// Track CPU usage, wakeups and CPU frequency for several threads of the
+// current process, as read from /proc/self/task/<tid>.
+// Unlike ThreadCpuUsage, the threads are not sampled by themselves: register
+// them with addThread() or addAllThreads(), then call sample() periodically
+// from any one thread, e.g. a service's main loop.  Each call adds one
+// interval to the statistics of every registered thread:
+//  - CPU usage, as a percentage of the wall clock interval, with its mean and
+//    50th, 90th and 99th percentiles,
+//  - voluntary context switches (the thread blocked, so roughly its wakeups)
+//    and involuntary ones (it was preempted), per second,
+//  - CPU time per CPU frequency, attributed to the frequency of the CPU the
+//    thread last ran on at the time of the sample; the kernel does not keep
+//    per-thread time-in-state, so short intervals give better attribution.
+// dump() formats everything for a service's dump() implementation.
+// This class is not thread-safe; all methods must be called from one thread
+// or under a lock held by the caller.
+
+class ThreadCpuProfiler
+{
+
+public:
+    ThreadCpuProfiler();
+    ~ThreadCpuProfiler();
+
+    // Start tracking thread tid of this process under name, or the thread's
+    // own name if name is NULL.  Returns false if it is already tracked.
+    bool addThread(pid_t tid, const char* name = NULL);
+
+    // Start tracking every thread currently in this process which is not
+    // tracked yet, under their own names.
+    void addAllThreads();
+
+    // Stop tracking thread tid, forgetting its statistics.
+    void removeThread(pid_t tid);
+
+    // Read the counters of every tracked thread and add the interval since
+    // the previous sample to its statistics.  The first sample of a thread
+    // only primes its counters.  Threads which have exited are kept, with
+    // their statistics, until removed.
+    void sample();
+
+    // Forget the statistics of every thread, but keep tracking them.
+    void reset();
+
+    // Append the statistics of every thread to result, each line starting
+    // with prefix.
+    void dump(String8& result, const char* prefix = "") const;
+
+private:
+    ThreadCpuProfiler(const ThreadCpuProfiler&);
+    ThreadCpuProfiler& operator=(const ThreadCpuProfiler&);
+
+    struct ThreadStats {
+        ThreadStats();
+        void reset();
+
+        String8 name;
+        bool exited;
+        bool primed;                // the counters below were read before
+        long long lastCpuNs;
+        unsigned long long lastVoluntary;
+        unsigned long long lastInvoluntary;
+        nsecs_t lastSampleTime;
+
+        nsecs_t sampledTime;        // wall clock covered by the statistics
+        long long cpuNs;            // CPU time in that time
+        unsigned long long voluntary;
+        unsigned long long involuntary;
+        CentralTendencyStatistics cpuPercent;
+        QuantileEstimator cpuPercent50;
+        QuantileEstimator cpuPercent90;
+        QuantileEstimator cpuPercent99;
+        // CPU ns per CPU frequency in kHz, 0 for unknown
+        KeyedVector<uint32_t, long long> timeInFrequency;
+    };
+
+    struct Counters {
+        long long cpuNs;
+        unsigned long long voluntary;
+        unsigned long long involuntary;
+        int cpu;                    // CPU last run on, or -1 if unknown
+    };
+
+    static bool readCounters(pid_t tid, Counters* counters);
+    static bool readName(pid_t tid, String8* name);
+
+    KeyedVector<pid_t, ThreadStats*> mThreads;
+    ThreadCpuUsage mFrequencies;    // only used for getCpukHz()
+};
+
+}   // namespace android
+
+#endif //  _THREAD_CPU_PROFILER_H
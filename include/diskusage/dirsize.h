@@ -19,12 +19,34 @@
 #define __LIBDISKUSAGE_DIRSIZE_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <sys/cdefs.h>
 
 __BEGIN_DECLS
 
+/* flags for calculate_dir_sizes() */
+#define DIRSIZE_COUNT_LINKS_ONCE    0x1     /* count each inode only once */
+
+typedef struct {
+    const char *name;       /* an entry of the directory walked */
+    int64_t size;           /* its size, and the size of everything below it */
+} dir_part_t;
+
+/* called with each directory walked, from any of the walking threads */
+typedef void (*dir_visit_t)(int dfd, void *cookie);
+
 int64_t stat_size(struct stat *s);
+
+/* Returns the size of everything below dfd, which is closed. */
 int64_t calculate_dir_size(int dfd);
 
+/*
+ * calculate_dir_size(), also filling in the size of the given entries
+ * of dfd in the same walk.
+ */
+int64_t calculate_dir_sizes(int dfd, int flags, dir_part_t *parts,
+        size_t num_parts, dir_visit_t visit, void *cookie);
+
 __END_DECLS
 
 #endif /* __LIBDISKUSAGE_DIRSIZE_H */
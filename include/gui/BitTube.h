@@ -33,7 +33,12 @@ class BitTube : public RefBase
 {
 public:
 
+    // socket buffer size of the tubes created with the default constructor
+    enum { DEFAULT_SOCKET_BUFFER_SIZE = 4 * 1024 };
+
             BitTube();
+            // bufferSize is the socket buffer size, in bytes
+    explicit BitTube(size_t bufferSize);
             BitTube(const Parcel& data);
     virtual ~BitTube();
 
@@ -44,6 +49,12 @@ public:
 
     status_t writeToParcel(Parcel* reply) const;
 
+    // sendObjects() sends each object in its own packet, and returns how
+    // many of them were sent: fewer than count if the socket buffer filled
+    // up, the others are not sent. -EAGAIN is returned when none could be.
+    // recvObjects() returns how many objects were received, 0 if none were
+    // available. When the kernel supports it, both transfer several objects
+    // per system call.
     template <typename T>
     static ssize_t sendObjects(const sp<BitTube>& tube,
             T const* events, size_t count) {
@@ -60,6 +71,8 @@ private:
     int mSendFd;
     mutable int mReceiveFd;
 
+    void init(size_t bufferSize);
+
     static ssize_t sendObjects(const sp<BitTube>& tube,
             void const* events, size_t count, size_t objSize);
 
@@ -53,12 +53,16 @@ public:
     enum { NUM_BUFFER_SLOTS = 32 };
     enum { NO_CONNECTED_API = 0 };
     enum { INVALID_BUFFER_SLOT = -1 };
-    enum { STALE_BUFFER_SLOT = 1, NO_BUFFER_AVAILABLE };
+    enum { STALE_BUFFER_SLOT = 1, NO_BUFFER_AVAILABLE, PRESENT_LATER };
 
     // When in async mode we reserve two slots in order to guarantee that the
     // producer and consumer can run asynchronously.
     enum { MAX_MAX_ACQUIRED_BUFFERS = NUM_BUFFER_SLOTS - 2 };
 
+    // What queueBuffer does in synchronous mode once the queue holds the
+    // maximum number of buffers set with setFrameDropPolicy.
+    enum { DROP_NONE = 0, DROP_OLDEST, DROP_NEWEST };
+
     // ConsumerListener is the interface through which the BufferQueue notifies
     // the consumer of events that the consumer may wish to react to.  Because
     // the consumer will generally have a mutex that is locked during calls from
@@ -83,6 +87,14 @@ public:
         // This is called without any lock held and can be called concurrently
         // by multiple threads.
         virtual void onBuffersReleased() = 0;
+
+        // onFrameDropped is called from queueBuffer each time the frame drop
+        // policy drops a queued frame that had triggered onFrameAvailable,
+        // so consumers that count frames can forget it.
+        //
+        // This is called without any lock held and can be called concurrently
+        // by multiple threads.
+        virtual void onFrameDropped() {}
     };
 
     // ProxyConsumerListener is a ConsumerListener implementation that keeps a weak
@@ -101,6 +113,7 @@ public:
         virtual ~ProxyConsumerListener();
         virtual void onFrameAvailable();
         virtual void onBuffersReleased();
+        virtual void onFrameDropped();
 
     private:
 
@@ -258,6 +271,26 @@ public:
     // queue buffer.
     virtual status_t updateBuffersGeometry(int w, int h, int f);
 
+    // allocateBuffers allocates the buffers of the free slots that don't
+    // have one, up to the current maximum buffer count. The allocations are
+    // done without holding the lock, so producer and consumer are never
+    // blocked by them. When called through binder, the call is
+    // asynchronous and runs on a binder thread of the BufferQueue's
+    // process.
+    virtual void allocateBuffers(uint32_t w, uint32_t h,
+            uint32_t format, uint32_t usage);
+
+    // requestBuffers returns the buffers of the given free or dequeued
+    // slots, and marks them as requested like requestBuffer does.
+    virtual status_t requestBuffers(uint32_t* slotMask,
+            sp<GraphicBuffer>* buffers);
+
+    // getFrameTimestamps returns the timestamps of one of the last
+    // NUM_FRAME_HISTORY frames queued. The present time is the one given
+    // to setFramePresented, if the consumer calls it.
+    virtual status_t getFrameTimestamps(uint64_t frameNumber,
+            FrameTimestamps* outTimestamps);
+
     // public facing structure for BufferSlot
     struct BufferItem {
 
@@ -267,7 +300,8 @@ public:
            mScalingMode(NATIVE_WINDOW_SCALING_MODE_FREEZE),
            mTimestamp(0),
            mFrameNumber(0),
-           mBuf(INVALID_BUFFER_SLOT) {
+           mBuf(INVALID_BUFFER_SLOT),
+           mSkipped(0) {
              mCrop.makeInvalid();
         }
         // mGraphicBuffer points to the buffer allocated for this slot, or is NULL
@@ -296,6 +330,10 @@ public:
 
         // mFence is a fence that will signal when the buffer is idle.
         sp<Fence> mFence;
+
+        // mSkipped is the number of older queued buffers acquireBuffer
+        // dropped because this one was due by the given present time.
+        uint32_t mSkipped;
     };
 
     // The following public functions are the consumer-facing interface
@@ -309,6 +347,16 @@ public:
     // buffer.
     status_t acquireBuffer(BufferItem *buffer);
 
+    // This version of acquireBuffer schedules the buffers by their
+    // timestamp. presentWhen is the time the acquired buffer is expected to
+    // be presented at, e.g. the next vsync. Queued buffers are dropped as
+    // long as the one after them is due by then, and if the oldest buffer
+    // left is due later, nothing is acquired and PRESENT_LATER is returned.
+    // Timestamps more than a second away from presentWhen are not trusted:
+    // they neither defer a buffer nor get the one before it dropped. A
+    // presentWhen of 0 disables the scheduling.
+    status_t acquireBuffer(BufferItem *buffer, nsecs_t presentWhen);
+
     // releaseBuffer releases a buffer slot from the consumer back to the
     // BufferQueue.  This may be done while the buffer's contents are still
     // being accessed.  The fence will signal when the buffer is no longer
@@ -358,6 +406,15 @@ public:
     // The count must be between 2 and NUM_BUFFER_SLOTS, inclusive.
     status_t setDefaultMaxBufferCount(int bufferCount);
 
+    // setAdaptiveBufferCount lets the BufferQueue pick its own max buffer
+    // count between minBufferCount and maxBufferCount, in place of the
+    // default max buffer count. It starts at maxBufferCount, gives up a
+    // buffer once the producer has kept well ahead of the consumer for
+    // ADAPTIVE_WINDOW frames, and takes it back as soon as the producer
+    // falls behind. A buffer count set by the producer still wins. Passing
+    // 0 for both counts turns it off.
+    status_t setAdaptiveBufferCount(int minBufferCount, int maxBufferCount);
+
     // setMaxAcquiredBufferCount sets the maximum number of buffers that can
     // be acquired by the consumer at one time (default 1).  This call will
     // fail if a producer is connected to the BufferQueue.
@@ -386,7 +443,64 @@ public:
     // NATIVE_WINDOW_TRANSFORM_ROT_90.  The default is 0 (no transform).
     status_t setTransformHint(uint32_t hint);
 
+    // setFrameDropPolicy bounds the latency of a slow consumer in
+    // synchronous mode. Once maxQueuedBuffers buffers are queued,
+    // queueBuffer drops the oldest queued buffer (DROP_OLDEST) or the one
+    // being queued (DROP_NEWEST) instead of letting the queue grow; with
+    // DROP_NONE (the default) or a maxQueuedBuffers of 0 the producer blocks
+    // in dequeueBuffer as usual. If maxFrameAge is non-zero, acquireBuffer
+    // also skips the queued buffers whose timestamp is more than maxFrameAge
+    // nanoseconds old, as long as a newer buffer is queued.
+    status_t setFrameDropPolicy(int mode, int maxQueuedBuffers,
+            nsecs_t maxFrameAge);
+
+    // getFramesDropped returns how many queued buffers were dropped
+    // without being acquired. The consumer hears about each of them that
+    // triggered onFrameAvailable:
+    //  - DROP_OLDEST drops are reported with onFrameDropped,
+    //  - acquireBuffer drops, of frames that are too old or that a later
+    //    one replaces before they are presented, are reported in
+    //    BufferItem::mSkipped.
+    // DROP_NEWEST drops and the buffers replaced in asynchronous mode never
+    // triggered onFrameAvailable, so they are only counted here.
+    uint32_t getFramesDropped() const;
+
+    // setFramePresented tells the producer when the frame with the given
+    // frame number was presented, see getFrameTimestamps. The time is taken
+    // from presentFence once it signals if it's valid, presentTime is
+    // used otherwise.
+    void setFramePresented(uint64_t frameNumber,
+            const sp<Fence>& presentFence, nsecs_t presentTime);
+
+    // discardFreeBuffers frees the buffers of the slots that are neither
+    // dequeued, queued nor acquired, so that an idle queue only keeps the
+    // buffer its consumer holds. The slots get a new buffer the next time
+    // they are dequeued. The consumer is told through onBuffersReleased.
+    // Returns how many bytes of buffers were freed.
+    size_t discardFreeBuffers();
+
 private:
+    // FrameHistory is the entry of a queued frame in mFrameHistory.
+    // presentFence is the fence given to setFramePresented, until the
+    // present time is read from it.
+    struct FrameHistory {
+        FrameHistory() { memset(&timestamps, 0, sizeof(timestamps)); }
+        FrameTimestamps timestamps;
+        sp<Fence> presentFence;
+    };
+
+    // findFrameHistoryLocked returns the entry of the given frame, or NULL
+    // if it isn't one of the last NUM_FRAME_HISTORY frames queued
+    FrameHistory* findFrameHistoryLocked(uint64_t frameNumber);
+
+    // dropBufferLocked frees the slot of a buffer that won't be acquired and
+    // counts it as a dropped frame. The caller removes it from mQueue.
+    void dropBufferLocked(int buf);
+
+    // updateAdaptiveBufferCountLocked revisits mAdaptiveBufferCount once
+    // the given slot has been queued.
+    void updateAdaptiveBufferCountLocked(int buf, nsecs_t now);
+
     // freeBufferLocked frees the GraphicBuffer and sync resources for the
     // given slot.
     void freeBufferLocked(int index);
@@ -437,6 +551,17 @@ private:
     // connected, mDequeueCondition must be broadcast.
     int getMaxBufferCountLocked() const;
 
+    // waitDequeueConditionLocked waits on mDequeueCondition, and
+    // broadcastDequeueConditionLocked wakes up the threads waiting on it.
+    // The broadcast is skipped when nobody waits, so that the producer
+    // isn't woken up only to block on mMutex, still held by the consumer.
+    void waitDequeueConditionLocked();
+    void broadcastDequeueConditionLocked();
+
+    // Lock locks mMutex like Mutex::Autolock, and counts how often another
+    // thread was holding it.
+    class Lock;
+
     struct BufferSlot {
 
         BufferSlot()
@@ -447,9 +572,12 @@ private:
           mScalingMode(NATIVE_WINDOW_SCALING_MODE_FREEZE),
           mTimestamp(0),
           mFrameNumber(0),
+          mDequeueWait(0),
+          mDequeueTime(0),
           mEglFence(EGL_NO_SYNC_KHR),
           mAcquireCalled(false),
-          mNeedsCleanupOnRelease(false) {
+          mNeedsCleanupOnRelease(false),
+          mNeedsReallocation(false) {
             mCrop.makeInvalid();
         }
 
@@ -529,6 +657,13 @@ private:
         // may be released before their release fence is signaled).
         uint64_t mFrameNumber;
 
+        // mDequeueWait is how long the last dequeueBuffer of this slot
+        // waited for a free buffer.
+        nsecs_t mDequeueWait;
+
+        // mDequeueTime is when the last dequeueBuffer of this slot returned.
+        nsecs_t mDequeueTime;
+
         // mEglFence is the EGL sync object that must signal before the buffer
         // associated with this buffer slot may be dequeued. It is initialized
         // to EGL_NO_SYNC_KHR when the buffer is created and may be set to a
@@ -554,6 +689,12 @@ private:
         // consumer.  This is set when a buffer in ACQUIRED state is freed.
         // It causes releaseBuffer to return STALE_BUFFER_SLOT.
         bool mNeedsCleanupOnRelease;
+
+        // Indicates whether the next dequeueBuffer of this slot must return
+        // BUFFER_NEEDS_REALLOCATION although the buffer is already allocated.
+        // This is set when allocateBuffers fills the slot, the producer may
+        // then hold a stale reference to the buffer the slot had before.
+        bool mNeedsReallocation;
     };
 
     // mSlots is the array of buffer slots that must be mirrored on the
@@ -594,6 +735,22 @@ private:
     // mDefaultMaxBufferCount is used as the limit.
     int mOverrideMaxBufferCount;
 
+    // mAdaptiveMinBufferCount and mAdaptiveMaxBufferCount are the bounds
+    // given to setAdaptiveBufferCount, 0 when it is off. mAdaptiveBufferCount
+    // is the current pick, used in place of mDefaultMaxBufferCount.
+    // mAcquireInterval and mProducerWorkTime are running averages of the
+    // time between two acquires and of the time the producer keeps a buffer
+    // dequeued. mAdaptiveFrames counts the frames since the producer last
+    // looked like it needed more than a buffer in flight.
+    enum { ADAPTIVE_WINDOW = 120 };
+    int mAdaptiveMinBufferCount;
+    int mAdaptiveMaxBufferCount;
+    int mAdaptiveBufferCount;
+    nsecs_t mLastAcquireTime;
+    nsecs_t mAcquireInterval;
+    nsecs_t mProducerWorkTime;
+    uint32_t mAdaptiveFrames;
+
     // mGraphicBufferAlloc is the connection to SurfaceFlinger that is used to
     // allocate new GraphicBuffer objects.
     sp<IGraphicBufferAlloc> mGraphicBufferAlloc;
@@ -618,10 +775,21 @@ private:
     // mDequeueCondition condition used for dequeueBuffer in synchronous mode
     mutable Condition mDequeueCondition;
 
+    // mDequeueWaiters is the number of threads waiting on mDequeueCondition
+    int mDequeueWaiters;
+
     // mQueue is a FIFO of queued buffers used in synchronous mode
     typedef Vector<int> Fifo;
     Fifo mQueue;
 
+    // mDropMode, mMaxQueuedBuffers and mMaxFrameAge are the frame drop
+    // policy set by setFrameDropPolicy, mFramesDropped is the number of
+    // buffers dropped so far.
+    int mDropMode;
+    int mMaxQueuedBuffers;
+    nsecs_t mMaxFrameAge;
+    uint32_t mFramesDropped;
+
     // mAbandoned indicates that the BufferQueue will no longer be used to
     // consume image buffers pushed to it using the IGraphicBufferProducer
     // interface.  It is initialized to false, and set to true in the
@@ -639,10 +807,22 @@ private:
     // member variables are accessed.
     mutable Mutex mMutex;
 
+    // mLockCount is the number of times mMutex was locked by the producer
+    // and consumer buffer operations, and mLockContentionCount how many of
+    // these had to wait for another thread. Both are reported by dump().
+    uint32_t mLockCount;
+    uint32_t mLockContentionCount;
+
     // mFrameCounter is the free running counter, incremented on every
     // successful queueBuffer call.
     uint64_t mFrameCounter;
 
+    // mFrameHistory holds the timestamps of the last NUM_FRAME_HISTORY
+    // frames queued, in the entry of their frame number modulo
+    // NUM_FRAME_HISTORY.
+    enum { NUM_FRAME_HISTORY = 8 };
+    FrameHistory mFrameHistory[NUM_FRAME_HISTORY];
+
     // mBufferHasBeenQueued is true once a buffer has been queued.  It is
     // reset when something causes all buffers to be freed (e.g. changing the
     // buffer count).
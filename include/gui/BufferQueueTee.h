@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_BUFFERQUEUETEE_H
+#define ANDROID_GUI_BUFFERQUEUETEE_H
+
+#include <gui/ConsumerBase.h>
+
+#include <ui/GraphicBuffer.h>
+
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+/**
+ * BufferQueueTee is a BufferQueue consumer endpoint that hands every queued
+ * buffer to several consumers, its outputs, without copying it. Each output
+ * acquires and releases the buffers like a BufferItemConsumer, at its own
+ * pace, and a buffer only returns to the producer once all of the outputs
+ * have released it, with their release fences merged.
+ *
+ * An output that falls behind has its oldest pending buffers dropped once
+ * it has more than its maxPendingBuffers waiting, so a slow consumer (e.g.
+ * analytics) doesn't hold up the others (e.g. the preview).
+ */
+class BufferQueueTee: public ConsumerBase
+{
+  public:
+    typedef ConsumerBase::FrameAvailableListener FrameAvailableListener;
+
+    typedef BufferQueue::BufferItem BufferItem;
+
+    enum { NO_BUFFER_AVAILABLE = BufferQueue::NO_BUFFER_AVAILABLE };
+
+    class Output;
+
+    // Create a new tee. The consumerUsage parameter determines the consumer
+    // usage flags passed to the graphics allocator, and must cover the needs
+    // of all of the outputs. The maxAcquiredBuffers parameter specifies how
+    // many buffers the outputs can hold altogether, pending or acquired.
+    BufferQueueTee(uint32_t consumerUsage, int maxAcquiredBuffers,
+            bool synchronousMode = true);
+
+    virtual ~BufferQueueTee();
+
+    // set the name of the BufferQueueTee that will be used to identify it in
+    // log messages.
+    void setName(const String8& name);
+
+    // Adds an output, which gets every buffer queued from now on. It can
+    // acquire up to maxAcquiredBuffers of them at a time, and when it has more
+    // than maxPendingBuffers waiting to be acquired the oldest is dropped; 0
+    // never drops any, holding up the producer instead.
+    sp<Output> addOutput(const String8& name, int maxAcquiredBuffers,
+            int maxPendingBuffers);
+
+    // Removes an output, releasing all of the buffers it holds: it must not
+    // access the buffers it acquired anymore.
+    void removeOutput(const sp<Output>& output);
+
+    sp<IGraphicBufferProducer> getProducerInterface() const { return getBufferQueue(); }
+
+    // setDefaultBufferSize is used to set the size of buffers returned by
+    // requestBuffers when a with and height of zero is requested.
+    status_t setDefaultBufferSize(uint32_t w, uint32_t h);
+
+    // setDefaultBufferFormat allows the BufferQueue to create
+    // GraphicBuffers of a defaultFormat if no format is specified
+    // in dequeueBuffer
+    status_t setDefaultBufferFormat(uint32_t defaultFormat);
+
+  protected:
+    // onFrameAvailable acquires the queued buffers and hands them to the
+    // outputs, rather than notifying a listener of the tee itself.
+    virtual void onFrameAvailable();
+
+    virtual void abandonLocked();
+
+    virtual void dumpLocked(String8& result, const char* prefix, char* buffer,
+            size_t size) const;
+
+  private:
+    friend class Output;
+
+    // dispatchLocked acquires as many queued buffers as allowed and adds
+    // them to the outputs, collecting the listeners of the ones that got a
+    // buffer, to be notified once mMutex is released.
+    void dispatchLocked(Vector< sp<FrameAvailableListener> >* listeners);
+
+    // unrefLocked drops an output's reference to an acquired buffer,
+    // returning it to the BufferQueue with the merged fences once no output
+    // references it anymore.
+    void unrefLocked(const BufferItem& item, const sp<Fence>& releaseFence);
+
+    static void notify(const Vector< sp<FrameAvailableListener> >& listeners);
+
+    // A buffer acquired from the BufferQueue, referenced by some outputs.
+    struct Held {
+        int slot;
+        uint64_t frameNumber;
+        sp<GraphicBuffer> buffer;
+        int refs;
+        // set once the slot is acquired again, which means the BufferQueue
+        // freed it, and took this buffer back, while outputs referenced it
+        bool stale;
+    };
+
+    // mOutputs are the outputs, in the order they were added.
+    Vector< sp<Output> > mOutputs;
+
+    // mHeld has an entry per acquisition still referenced by an output.
+    // There can be more than one for a slot, all of them stale but the
+    // last one.
+    Vector<Held> mHeld;
+
+    // mHeldBuffers is the number of entries of mHeld that aren't stale,
+    // i.e. that the BufferQueue counts as acquired.
+    int mHeldBuffers;
+
+    // mMaxAcquiredBuffers is the maxAcquiredBuffers passed to the constructor.
+    const int mMaxAcquiredBuffers;
+};
+
+/**
+ * Output is one consumer of the buffers of a BufferQueueTee. All of its
+ * state is protected by the tee's mutex.
+ */
+class BufferQueueTee::Output : public virtual RefBase
+{
+  public:
+    // Gets the next buffer for this output, filling out the passed-in
+    // BufferItem structure. Returns NO_BUFFER_AVAILABLE if none is pending,
+    // INVALID_OPERATION if maxAcquiredBuffers are acquired already, and
+    // NO_INIT if the output was removed or the tee abandoned.
+    //
+    // If waitForFence is true, and the acquired BufferItem has a valid fence
+    // object, acquireBuffer will wait on the fence with no timeout before
+    // returning.
+    status_t acquireBuffer(BufferItem* item, bool waitForFence = true);
+
+    // Releases this output's reference to an acquired buffer. releaseFence is
+    // merged with those of the other outputs.
+    status_t releaseBuffer(const BufferItem& item,
+            const sp<Fence>& releaseFence = Fence::NO_FENCE);
+
+    // setFrameAvailableListener sets the listener called when a buffer is
+    // added to this output.
+    void setFrameAvailableListener(const wp<FrameAvailableListener>& listener);
+
+    const String8& getName() const { return mName; }
+
+  private:
+    friend class BufferQueueTee;
+
+    Output(const wp<BufferQueueTee>& tee, const String8& name,
+            int maxAcquiredBuffers, int maxPendingBuffers);
+
+    const wp<BufferQueueTee> mTee;
+    const String8 mName;
+    const int mMaxAcquiredBuffers;
+    const int mMaxPendingBuffers;
+
+    // mPending are the buffers not acquired yet, oldest first.
+    Vector<BufferItem> mPending;
+
+    // mAcquired are the buffers this output acquired.
+    Vector<BufferItem> mAcquired;
+
+    // mDroppedBuffers counts the buffers dropped for falling behind.
+    uint32_t mDroppedBuffers;
+
+    // mRemoved is set once the output isn't part of its tee anymore.
+    bool mRemoved;
+
+    wp<FrameAvailableListener> mListener;
+};
+
+} // namespace android
+
+#endif // ANDROID_GUI_BUFFERQUEUETEE_H
@@ -46,6 +46,14 @@ public:
         // This is called without any lock held and can be called concurrently
         // by multiple threads.
         virtual void onFrameAvailable() = 0;
+
+        // onFrameDropped() is called each time a frame that triggered
+        // onFrameAvailable() is dropped by the frame drop policy before it
+        // could be acquired, see BufferQueue::setFrameDropPolicy.
+        //
+        // This is called without any lock held and can be called concurrently
+        // by multiple threads.
+        virtual void onFrameDropped() {}
     };
 
     virtual ~ConsumerBase();
@@ -79,6 +87,15 @@ public:
     // when a new frame becomes available.
     void setFrameAvailableListener(const wp<FrameAvailableListener>& listener);
 
+    // setFrameDropPolicy sets how the BufferQueue drops frames when this
+    // consumer falls behind, see BufferQueue::setFrameDropPolicy.
+    status_t setFrameDropPolicy(int mode, int maxQueuedBuffers,
+            nsecs_t maxFrameAge);
+
+    // getFramesDropped returns the number of frames the BufferQueue dropped
+    // without this consumer acquiring them.
+    uint32_t getFramesDropped() const;
+
 private:
     ConsumerBase(const ConsumerBase&);
     void operator=(const ConsumerBase&);
@@ -108,6 +125,7 @@ protected:
     // must be called from the derived class.
     virtual void onFrameAvailable();
     virtual void onBuffersReleased();
+    virtual void onFrameDropped();
 
     // freeBufferLocked frees up the given buffer slot.  If the slot has been
     // initialized this will release the reference to the GraphicBuffer in that
@@ -147,13 +165,15 @@ protected:
             size_t size) const;
 
     // acquireBufferLocked fetches the next buffer from the BufferQueue and
-    // updates the buffer slot for the buffer returned.
+    // updates the buffer slot for the buffer returned. presentWhen is passed
+    // to BufferQueue::acquireBuffer, 0 acquires the oldest queued buffer.
     //
     // Derived classes should override this method to perform any
     // initialization that must take place the first time a buffer is assigned
     // to a slot.  If it is overridden the derived class's implementation must
     // call ConsumerBase::acquireBufferLocked.
-    virtual status_t acquireBufferLocked(BufferQueue::BufferItem *item);
+    virtual status_t acquireBufferLocked(BufferQueue::BufferItem *item,
+            nsecs_t presentWhen);
 
     // releaseBufferLocked relinquishes control over a buffer, returning that
     // control to the BufferQueue.
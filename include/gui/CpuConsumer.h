@@ -53,10 +53,13 @@ class CpuConsumer : public ConsumerBase
         uint32_t    scalingMode;
         int64_t     timestamp;
         uint64_t    frameNumber;
-        // Values below are only valid when using
-        // HAL_PIXEL_FORMAT_YCbCr_420_888, in which case LockedBuffer::data
-        // contains the Y channel, and stride is the Y channel stride. For other
-        // formats, these will all be 0.
+        // Values below describe the chroma planes of YUV buffers, in which
+        // case LockedBuffer::data contains the Y channel, and stride is the Y
+        // channel stride. They are valid for HAL_PIXEL_FORMAT_YCbCr_420_888
+        // and HAL_PIXEL_FORMAT_YV12, and for the semi-planar formats when
+        // gralloc can describe their layout. chromaStride is the row stride
+        // and chromaStep the distance between two samples of the Cb and Cr
+        // planes, in bytes. Otherwise these will all be 0.
         uint8_t    *dataCb;
         uint8_t    *dataCr;
         uint32_t    chromaStride;
@@ -82,8 +85,19 @@ class CpuConsumer : public ConsumerBase
     // construction-time maxLockedBuffers parameter. If INVALID_OPERATION is
     // returned by lockNextBuffer, then old buffers must be returned to the queue
     // by calling unlockBuffer before more buffers can be acquired.
+    //
+    // Buffers are waited for and mapped without holding the consumer mutex,
+    // so several threads can lock and unlock buffers at the same time, and
+    // buffers can be unlocked in any order.
     status_t lockNextBuffer(LockedBuffer *nativeBuffer);
 
+    // Locks as many queued buffers as possible, up to *count, into the
+    // nativeBuffers array and sets *count to the number locked. Returns OK
+    // if at least one buffer was locked, and what lockNextBuffer returned
+    // otherwise. The buffers can then be handed to different threads, which
+    // unlock them with unlockBuffer.
+    status_t lockNextBuffers(LockedBuffer *nativeBuffers, size_t *count);
+
     // Returns a locked buffer to the queue, allowing it to be reused. Since
     // only a fixed number of buffers may be locked at a time, old buffers must
     // be released by calling unlockBuffer to ensure new buffers can be acquired by
@@ -96,6 +110,13 @@ class CpuConsumer : public ConsumerBase
     // Maximum number of buffers that can be locked at a time
     uint32_t mMaxLockedBuffers;
 
+    // waits for the fence of an acquired buffer and maps it for reading
+    status_t lockForCpu(const sp<GraphicBuffer>& graphicBuffer,
+            const BufferQueue::BufferItem& item, void **bufferPointer,
+            android_ycbcr *ycbcr);
+
+    // releases an acquired buffer, which must not be mapped anymore, back
+    // to the BufferQueue
     status_t releaseAcquiredBufferLocked(int lockedIdx);
 
     virtual void freeBufferLocked(int slotIndex);
@@ -104,7 +125,8 @@ class CpuConsumer : public ConsumerBase
     struct AcquiredBuffer {
         // Need to track the original mSlot index and the buffer itself because
         // the mSlot entry may be freed/reused before the acquired buffer is
-        // released.
+        // released. mBufferPointer is NULL while the buffer is being locked
+        // or unlocked.
         int mSlot;
         sp<GraphicBuffer> mGraphicBuffer;
         void *mBufferPointer;
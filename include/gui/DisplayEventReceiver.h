@@ -34,6 +34,7 @@ namespace android {
 
 class BitTube;
 class IDisplayEventConnection;
+class SharedVSync;
 
 // ----------------------------------------------------------------------------
 
@@ -126,9 +127,32 @@ public:
      */
     status_t requestNextVsync();
 
+    /*
+     * setVsyncSchedule() asks for an Event::VSync every period ns, phase
+     * ns after the vsync, e.g. 30 Hz at +4 ms for a live wallpaper.
+     * SurfaceFlinger only wakes up for this client when it's due, instead
+     * of on every vsync as with setVsyncRate(2). period is rounded to a
+     * multiple of the refresh period, phase must be less than period.
+     * A period of 0 cancels the schedule, so does setVsyncRate().
+     */
+    status_t setVsyncSchedule(nsecs_t period, nsecs_t phase);
+
+    /*
+     * waitForVsync() blocks until the next Event::VSync, read from a page
+     * shared with SurfaceFlinger and all the other clients. Returns
+     * TIMED_OUT if none comes within timeout, a negative timeout waits
+     * forever. Only the vsyncs setVsyncRate() and requestNextVsync() ask
+     * for are returned, like through getEvents().
+     * After the first call, Event::VSync isn't delivered through getFd()
+     * and getEvents() anymore, the other events still are.
+     */
+    status_t waitForVsync(Event* event, nsecs_t timeout);
+
 private:
     sp<IDisplayEventConnection> mEventConnection;
     sp<BitTube> mDataChannel;
+    sp<SharedVSync> mSharedVSync;
+    uint32_t mVsyncDelivered;
 };
 
 // ----------------------------------------------------------------------------
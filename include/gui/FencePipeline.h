@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_FENCE_PIPELINE_H
+#define ANDROID_GUI_FENCE_PIPELINE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <EGL/egl.h>
+
+#include <ui/Fence.h>
+
+#include <utils/Errors.h>
+#include <utils/String8.h>
+#include <utils/StrongPointer.h>
+
+namespace android {
+// ----------------------------------------------------------------------------
+
+/*
+ * FencePipeline keeps track of the native fences an OpenGL ES context inserts
+ * into its command stream, so that CPU work which has to wait for the GPU can
+ * be retired later instead of blocking the thread the context is current on.
+ *
+ * Each insertFence() closes a stage of the pipeline and gives it a serial
+ * number. Work that waits for the GPU is tagged with getLastSerial() and done
+ * once isRetired() says so; isRetired() only polls the fences and never
+ * blocks. The fences of one context signal in order, so only the last
+ * MAX_IN_FLIGHT of them are kept: when the ring is full a new fence replaces
+ * the newest one, which just retires the replaced stage a little later.
+ *
+ * The static helpers work with any fence and are what GLConsumer uses.
+ *
+ * A FencePipeline isn't thread safe; it belongs to its context's thread.
+ */
+class FencePipeline {
+public:
+    enum { MAX_IN_FLIGHT = 4 };
+
+    FencePipeline(const String8& name);
+    ~FencePipeline();
+
+    // insertFence adds a native fence after the commands issued so far in
+    // the current context, flushes them and starts tracking the fence.
+    // outFence, if not NULL, is set to the fence. Fails with INVALID_OPERATION
+    // if EGL_ANDROID_native_fence_sync isn't used.
+    status_t insertFence(EGLDisplay dpy, sp<Fence>* outFence);
+
+    // getLastSerial returns the serial number of the last fence inserted, or
+    // 0 if none has been.
+    uint32_t getLastSerial() const { return mLastSerial; }
+
+    // isRetired returns whether the commands issued before the fence with the
+    // given serial number was inserted have completed.
+    bool isRetired(uint32_t serial);
+
+    // getInFlightCount returns the number of fences that haven't signalled.
+    size_t getInFlightCount();
+
+    // createNativeFence adds a native fence after the commands issued so far
+    // in the current context and flushes them.
+    static status_t createNativeFence(EGLDisplay dpy, sp<Fence>* outFence);
+
+    // waitOnGpu makes the current context wait for fence before executing
+    // any further commands. Without EGL_KHR_wait_sync the calling thread
+    // waits for the fence instead. logname identifies the caller in the log.
+    static status_t waitOnGpu(EGLDisplay dpy, const sp<Fence>& fence,
+            const char* logname);
+
+    // hasSignalled returns whether fence has signalled, without blocking.
+    // Invalid fences count as signalled.
+    static bool hasSignalled(const sp<Fence>& fence);
+
+private:
+    FencePipeline(const FencePipeline&);
+    FencePipeline& operator = (const FencePipeline&);
+
+    struct Stage {
+        uint32_t serial;
+        sp<Fence> fence;
+    };
+
+    // pops the stages whose fence has signalled
+    void retire();
+
+    const String8 mName;
+    Stage mStages[MAX_IN_FLIGHT];
+    size_t mHead;
+    size_t mCount;
+    uint32_t mLastSerial;
+    uint32_t mRetiredSerial;
+};
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+
+#endif // ANDROID_GUI_FENCE_PIPELINE_H
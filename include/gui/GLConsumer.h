@@ -138,6 +138,11 @@ public:
     // documented by the source.
     int64_t getTimestamp();
 
+    // getFrameNumber retrieves the frame number the producer's queueBuffer
+    // gave to the texture image set by the most recent call to
+    // updateTexImage.
+    uint64_t getFrameNumber();
+
     // setDefaultBufferSize is used to set the size of buffers returned by
     // requestBuffers when a with and height of zero is requested.
     // A call to setDefaultBufferSize() may trigger requestBuffers() to
@@ -168,6 +173,11 @@ public:
     // getCurrentScalingMode returns the scaling mode of the current buffer.
     uint32_t getCurrentScalingMode() const;
 
+    // hasGeometryChanged returns whether the crop, transform, scaling mode,
+    // size or format of the current buffer differ from those of the
+    // previous one. It is true until the first buffer is latched.
+    bool hasGeometryChanged() const;
+
     // getCurrentFence returns the fence indicating when the current buffer is
     // ready to be read from.
     sp<Fence> getCurrentFence() const;
@@ -238,7 +248,8 @@ protected:
 
     // acquireBufferLocked overrides the ConsumerBase method to update the
     // mEglSlots array in addition to the ConsumerBase behavior.
-    virtual status_t acquireBufferLocked(BufferQueue::BufferItem *item);
+    virtual status_t acquireBufferLocked(BufferQueue::BufferItem *item,
+            nsecs_t presentWhen);
 
     // releaseBufferLocked overrides the ConsumerBase method to update the
     // mEglSlots array in addition to the ConsumerBase.
@@ -267,10 +278,11 @@ protected:
     // values.
     status_t checkAndUpdateEglStateLocked();
 
-private:
-    // createImage creates a new EGLImage from a GraphicBuffer.
-    EGLImageKHR createImage(EGLDisplay dpy,
-            const sp<GraphicBuffer>& graphicBuffer);
+    // createImageLocked creates the EGLImage of the buffer in the given slot
+    // if it doesn't have one yet, so that releaseAndUpdateLocked() won't
+    // have to. This doesn't need a current EGL context, but the EGLDisplay
+    // must be known already (NO_INIT otherwise).
+    status_t createImageLocked(int slot);
 
     // freeBufferLocked frees up the given buffer slot.  If the slot has been
     // initialized this will release the reference to the GraphicBuffer in that
@@ -279,6 +291,11 @@ private:
     // This method must be called with mMutex locked.
     virtual void freeBufferLocked(int slotIndex);
 
+private:
+    // createImage creates a new EGLImage from a GraphicBuffer.
+    EGLImageKHR createImage(EGLDisplay dpy,
+            const sp<GraphicBuffer>& graphicBuffer);
+
     // computeCurrentTransformMatrixLocked computes the transform matrix for the
     // current texture.  It uses mCurrentTransform and the current GraphicBuffer
     // to compute this matrix and stores it in mCurrentTransformMatrix.
@@ -338,6 +355,10 @@ private:
     // gets set each time updateTexImage is called.
     int64_t mCurrentTimestamp;
 
+    // mCurrentFrameNumber is the frame number of the current texture. It
+    // gets set each time updateTexImage is called.
+    uint64_t mCurrentFrameNumber;
+
     uint32_t mDefaultWidth, mDefaultHeight;
 
     // mFilteringEnabled indicates whether the transform matrix is computed for
@@ -345,6 +366,17 @@ private:
     // setFilteringEnabled().
     bool mFilteringEnabled;
 
+    // mMatrixCache holds the transform matrices computed for the current
+    // geometry, indexed by mFilteringEnabled, so that they are computed
+    // again only when the geometry changes. mMatrixCacheValid tells which
+    // ones are up to date.
+    float mMatrixCache[2][16];
+    bool mMatrixCacheValid[2];
+
+    // mGeometryChanged is the value of hasGeometryChanged(), updated by
+    // updateAndReleaseLocked().
+    bool mGeometryChanged;
+
     // mTexName is the name of the OpenGL texture to which streamed images will
     // be bound when updateTexImage is called. It is set at construction time
     // and can be changed with a call to attachToContext.
@@ -22,6 +22,7 @@
 
 #include <utils/Errors.h>
 #include <utils/RefBase.h>
+#include <utils/Timers.h>
 
 #include <binder/IInterface.h>
 
@@ -29,6 +30,7 @@ namespace android {
 // ----------------------------------------------------------------------------
 
 class BitTube;
+class SharedVSync;
 
 class IDisplayEventConnection : public IInterface
 {
@@ -41,6 +43,14 @@ public:
      */
     virtual sp<BitTube> getDataChannel() const = 0;
 
+    /*
+     * getSharedVSync() returns the page, and the connection's slot in it,
+     * where to read the vsync events from. Once it has been called, vsync
+     * events aren't sent to the data channel anymore, only the other
+     * events are.
+     */
+    virtual sp<SharedVSync> getSharedVSync() = 0;
+
     /*
      * setVsyncRate() sets the vsync event delivery rate. A value of
      * 1 returns every vsync events. A value of 2 returns every other events,
@@ -54,6 +64,15 @@ public:
      * if the vsync rate is > 0.
      */
     virtual void requestNextVsync() = 0;    // asynchronous
+
+    /*
+     * setVsyncSchedule() asks for a vsync event every period ns, phase ns
+     * after the vsync, for clients that don't need every vsync. The events
+     * stay aligned on vsync, so period is rounded to a multiple of the
+     * refresh period. A period of 0 cancels the schedule, so does
+     * setVsyncRate().
+     */
+    virtual status_t setVsyncSchedule(nsecs_t period, nsecs_t phase) = 0;
 };
 
 // ----------------------------------------------------------------------------
@@ -151,12 +151,20 @@ public:
             height = inHeight;
             transformHint = inTransformHint;
             numPendingBuffers = inNumPendingBuffers;
+            frameNumber = 0;
+        }
+        // the frame number queueBuffer gave to the buffer, 0 if the buffer
+        // was dropped right away or for connect
+        inline uint64_t getFrameNumber() const { return frameNumber; }
+        inline void setFrameNumber(uint64_t inFrameNumber) {
+            frameNumber = inFrameNumber;
         }
     private:
         uint32_t width;
         uint32_t height;
         uint32_t transformHint;
         uint32_t numPendingBuffers;
+        uint64_t frameNumber;
     };
 
     virtual status_t queueBuffer(int slot,
@@ -211,6 +219,44 @@ public:
     // update buffer width, height and format information from the client
     // which will take effect in the next queue buffer.
     virtual status_t updateBuffersGeometry(int w, int h, int f) = 0;
+
+    // allocateBuffers allocates a buffer for every free slot that doesn't
+    // have one yet, so that the first calls to dequeueBuffer don't have to
+    // wait for the allocations. w, h, format and usage are interpreted as
+    // they are by dequeueBuffer. The call returns immediately, the buffers
+    // are allocated asynchronously by the IGraphicBufferProducer
+    // implementation.
+    virtual void allocateBuffers(uint32_t w, uint32_t h,
+            uint32_t format, uint32_t usage) = 0;
+
+    // requestBuffers is requestBuffer for several slots at once: for each
+    // slot set in *slotMask that has a buffer and isn't owned by the
+    // consumer, the buffer is stored in buffers[slot] (which must have room
+    // for 32 entries) and the slot is left set in *slotMask, the other
+    // slots are cleared from it. This lets the client mirror the buffers
+    // allocated by allocateBuffers in a single call.
+    virtual status_t requestBuffers(uint32_t* slotMask,
+            sp<GraphicBuffer>* buffers) = 0;
+
+    // FrameTimestamps describes how a queued frame went through the
+    // IGraphicBufferProducer. Times are SYSTEM_TIME_MONOTONIC, a time is 0
+    // when the frame didn't get that far (yet).
+    struct FrameTimestamps {
+        uint64_t frameNumber;
+        // how long dequeueBuffer waited for the buffer of the frame
+        nsecs_t dequeueWait;
+        nsecs_t queueTime;
+        // when the consumer acquired the frame
+        nsecs_t acquireTime;
+        // when the frame showed up on the display
+        nsecs_t presentTime;
+    };
+
+    // getFrameTimestamps returns the timestamps of one of the last frames
+    // queued, frameNumber being the one returned in QueueBufferOutput.
+    // NAME_NOT_FOUND is returned once the frame is too old.
+    virtual status_t getFrameTimestamps(uint64_t frameNumber,
+            FrameTimestamps* outTimestamps) = 0;
 };
 
 // ----------------------------------------------------------------------------
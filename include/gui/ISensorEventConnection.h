@@ -29,6 +29,7 @@ namespace android {
 // ----------------------------------------------------------------------------
 
 class BitTube;
+class SensorDirectChannel;
 
 class ISensorEventConnection : public IInterface
 {
@@ -38,6 +39,12 @@ public:
     virtual sp<BitTube> getSensorChannel() const = 0;
     virtual status_t enableDisable(int handle, bool enabled) = 0;
     virtual status_t setEventRate(int handle, nsecs_t ns) = 0;
+    // how long the events of this sensor can be held back before they're
+    // reported, 0 reports them as soon as they happen
+    virtual status_t setMaxReportLatency(int handle, nsecs_t ns) = 0;
+    // switches the connection to a shared memory ring of about capacity
+    // events, after which the BitTube only carries wake-ups
+    virtual sp<SensorDirectChannel> createDirectChannel(size_t capacity) = 0;
 };
 
 // ----------------------------------------------------------------------------
@@ -22,6 +22,7 @@
 
 #include <utils/Errors.h>
 #include <utils/RefBase.h>
+#include <utils/Vector.h>
 
 #include <binder/IInterface.h>
 
@@ -30,6 +31,7 @@ namespace android {
 
 class Sensor;
 class ISensorEventConnection;
+class IMemoryHeap;
 
 class ISensorServer : public IInterface
 {
@@ -38,6 +40,29 @@ public:
 
     virtual Vector<Sensor> getSensorList() = 0;
     virtual sp<ISensorEventConnection> createSensorEventConnection() = 0;
+
+    // The same list as getSensorList(), in a read-only heap written by
+    // writeSensorList(). NULL if the server doesn't publish one.
+    virtual sp<IMemoryHeap> getSensorListMemory() = 0;
+
+    // The heap starts with a sensor_list_header_t, followed by each sensor
+    // flattened as in a Parcel: its size, then the Sensor padded to 4 bytes.
+    struct sensor_list_header_t {
+        uint32_t magic;
+        uint32_t version;   // of this layout
+        uint32_t count;
+        uint32_t size;      // of what follows the header
+    };
+
+    enum {
+        SENSOR_LIST_MAGIC   = 0x534c5354,   // 'SLST'
+        SENSOR_LIST_VERSION = 1
+    };
+
+    static sp<IMemoryHeap> writeSensorList(const Vector<Sensor>& list);
+    // BAD_VALUE if the heap doesn't hold a list this code understands
+    static status_t readSensorList(const sp<IMemoryHeap>& heap,
+            Vector<Sensor>* list);
 };
 
 // ----------------------------------------------------------------------------
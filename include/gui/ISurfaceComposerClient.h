@@ -22,6 +22,8 @@
 
 #include <utils/Errors.h>
 #include <utils/RefBase.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
 
 #include <binder/IInterface.h>
 
@@ -65,6 +67,39 @@ public:
      * Requires ACCESS_SURFACE_FLINGER permission
      */
     virtual status_t destroySurface(const sp<IBinder>& handle) = 0;
+
+    // the parameters of one surface in a createSurfaces() batch
+    struct SurfaceSpec {
+        String8 name;
+        uint32_t w;
+        uint32_t h;
+        PixelFormat format;
+        uint32_t flags;
+    };
+
+    // what createSurface() returned for one surface of the batch
+    struct CreatedSurface {
+        sp<IBinder> handle;
+        sp<IGraphicBufferProducer> gbp;
+        status_t result;
+    };
+
+    /*
+     * Creates all the surfaces in a single round trip to SurfaceFlinger's
+     * main thread. surfaces gets one entry per spec, in the same order, the
+     * surfaces that could be created are kept even if some fail.
+     *
+     * Requires ACCESS_SURFACE_FLINGER permission
+     */
+    virtual status_t createSurfaces(const Vector<SurfaceSpec>& specs,
+            Vector<CreatedSurface>* surfaces) = 0;
+
+    /*
+     * Destroys all the surfaces with a single call, returns the first error
+     *
+     * Requires ACCESS_SURFACE_FLINGER permission
+     */
+    virtual status_t destroySurfaces(const Vector< sp<IBinder> >& handles) = 0;
 };
 
 // ----------------------------------------------------------------------------
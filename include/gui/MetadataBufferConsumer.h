@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_METADATABUFFERCONSUMER_H
+#define ANDROID_GUI_METADATABUFFERCONSUMER_H
+
+#include <gui/ConsumerBase.h>
+
+#include <ui/GraphicBuffer.h>
+
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+/**
+ * MetadataBufferConsumer is a BufferQueue consumer endpoint that hands the
+ * queued buffers to a video encoder as kMetadataBufferTypeGrallocSource
+ * metadata buffers: the encoder reads the pixels straight from the buffer the
+ * producer rendered into, with no copy.
+ *
+ * Each acquired buffer stays acquired until the encoder is done with it and
+ * releaseMetadataBuffer is called with its metadata. The handle in the
+ * metadata is only valid in this process, so the encoder must run in it.
+ */
+class MetadataBufferConsumer: public ConsumerBase
+{
+  public:
+    typedef ConsumerBase::FrameAvailableListener FrameAvailableListener;
+
+    enum { NO_BUFFER_AVAILABLE = BufferQueue::NO_BUFFER_AVAILABLE };
+
+    // Create a new metadata buffer consumer. The bufferCount parameter
+    // specifies how many buffers the encoder can hold at the same time.
+    // Buffers are allocated with the video encoder usage.
+    MetadataBufferConsumer(int bufferCount = BufferQueue::MIN_UNDEQUEUED_BUFFERS,
+            bool synchronousMode = true);
+
+    virtual ~MetadataBufferConsumer();
+
+    // set the name of the MetadataBufferConsumer that will be used to identify
+    // it in log messages.
+    void setName(const String8& name);
+
+    // Returns the size of the metadata acquireMetadataBuffer writes: the
+    // buffer type followed by the buffer_handle_t.
+    static size_t getMetadataSize();
+
+    // Acquires the next queued buffer and writes its metadata to data, which
+    // must have room for getMetadataSize() bytes. Returns NO_BUFFER_AVAILABLE
+    // if the queue is empty, and INVALID_OPERATION if bufferCount buffers are
+    // already acquired.
+    //
+    // If outFence is non-NULL it receives the buffer's acquire fence, which
+    // the encoder must wait on before reading the buffer; typically it is
+    // handed to the hardware. Otherwise the fence is waited on here.
+    // outTimestamp, if non-NULL, receives the timestamp the producer set.
+    status_t acquireMetadataBuffer(void* data, size_t size,
+            sp<Fence>* outFence = NULL, int64_t* outTimestamp = NULL);
+
+    // Returns the buffer described by the metadata to the queue once the
+    // encoder is done reading it. releaseFence, if valid, signals when the
+    // encoder's reads complete.
+    status_t releaseMetadataBuffer(const void* data, size_t size,
+            const sp<Fence>& releaseFence = Fence::NO_FENCE);
+
+    sp<IGraphicBufferProducer> getProducerInterface() const { return getBufferQueue(); }
+
+    // setDefaultBufferSize is used to set the size of buffers returned by
+    // requestBuffers when a with and height of zero is requested.
+    status_t setDefaultBufferSize(uint32_t w, uint32_t h);
+
+    // setDefaultBufferFormat allows the BufferQueue to create
+    // GraphicBuffers of a defaultFormat if no format is specified
+    // in dequeueBuffer
+    status_t setDefaultBufferFormat(uint32_t defaultFormat);
+
+  protected:
+    virtual void dumpLocked(String8& result, const char* prefix, char* buffer,
+            size_t size) const;
+
+  private:
+    // A buffer handed to the encoder. Holding it keeps its handle valid
+    // even if the slot is freed and reused meanwhile.
+    struct Acquisition {
+        int slot;
+        uint64_t frameNumber;
+        sp<GraphicBuffer> buffer;
+        // set once the slot is acquired again, which means the queue freed
+        // it, and took this buffer back, while the encoder held it
+        bool stale;
+    };
+
+    // mAcquired holds one entry per buffer the encoder holds. There can be
+    // more than one for a slot, all of them stale but the last one.
+    Vector<Acquisition> mAcquired;
+};
+
+} // namespace android
+
+#endif // ANDROID_GUI_METADATABUFFERCONSUMER_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_SENSOR_DIRECT_CHANNEL_H
+#define ANDROID_GUI_SENSOR_DIRECT_CHANNEL_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/RefBase.h>
+#include <utils/threads.h>
+
+// ----------------------------------------------------------------------------
+
+struct ASensorEvent;
+
+namespace android {
+// ----------------------------------------------------------------------------
+class Parcel;
+
+/*
+ * A ring buffer of sensor events in shared memory, written by the sensor
+ * service and read by a single client, which saves a socket write and
+ * read per event. The writer only needs to wake the reader up (through the
+ * connection's BitTube) when the reader has drained the ring since the
+ * last wake-up; see write() and rearm().
+ *
+ * When the writer laps the reader, the oldest events are lost.
+ */
+class SensorDirectChannel : public RefBase
+{
+public:
+    // creates the ring, for the writer; capacity is rounded up to a
+    // power of two
+            SensorDirectChannel(size_t capacity);
+    // maps the ring the writer sent over binder, for the reader
+            SensorDirectChannel(const Parcel& data);
+    virtual ~SensorDirectChannel();
+
+    status_t initCheck() const;
+    size_t getCapacity() const;
+
+    status_t writeToParcel(Parcel* reply) const;
+
+    // Appends count events to the ring. Returns true when the reader must
+    // be woken up.
+    bool write(ASensorEvent const* events, size_t count);
+
+    // Reads up to count events, oldest first, and returns how many.
+    ssize_t read(ASensorEvent* events, size_t count);
+
+    // The reader calls this once it has drained the ring, before reading
+    // it one last time, to ask for a wake-up on the next write().
+    void rearm();
+
+private:
+    struct Header {
+        // bumped to the write count a write() will reach, before the
+        // events are copied
+        volatile int32_t writeBegin;
+        // number of events written so far
+        volatile int32_t writeEnd;
+        // set by the writer when it asks for a wake-up, cleared by rearm()
+        volatile int32_t wakeup;
+        int32_t reserved;
+    };
+
+    ASensorEvent* events() const;
+
+    Mutex mWriteLock;
+    int mFd;
+    void* mBase;
+    size_t mSize;
+    size_t mCapacity;
+    // the writer keeps its own count, so that the reader can't mess it up
+    uint32_t mWriteCount;
+    uint32_t mReadCount;
+};
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+
+#endif // ANDROID_GUI_SENSOR_DIRECT_CHANNEL_H
@@ -25,6 +25,7 @@
 #include <utils/Timers.h>
 
 #include <gui/BitTube.h>
+#include <gui/SensorDirectChannel.h>
 
 // ----------------------------------------------------------------------------
 
@@ -49,6 +50,11 @@ class Looper;
 class SensorEventQueue : public ASensorEventQueue, public RefBase
 {
 public:
+    // events go through the socket this many at a time, and read() gets
+    // them from the socket this many at a time
+    enum { MAX_EVENTS_PER_PACKET = 16 };
+    enum { MAX_RECEIVE_BUFFER_EVENT_COUNT = 256 };
+
             SensorEventQueue(const sp<ISensorEventConnection>& connection);
     virtual ~SensorEventQueue();
     virtual void onFirstRef();
@@ -58,14 +64,27 @@ public:
     static ssize_t write(const sp<BitTube>& tube,
             ASensorEvent const* events, size_t numEvents);
 
+    // Returns the events read from the socket earlier first, and drains the
+    // socket into a buffer when there are none left.
     ssize_t read(ASensorEvent* events, size_t numEvents);
 
+    // Whether read() has events left from draining the socket, which the
+    // socket no longer signals.
+    bool hasBufferedEvents() const;
+
     status_t waitForEvent() const;
     status_t wake() const;
 
     status_t enableSensor(Sensor const* sensor) const;
     status_t disableSensor(Sensor const* sensor) const;
     status_t setEventRate(Sensor const* sensor, nsecs_t ns) const;
+    status_t setMaxReportLatency(Sensor const* sensor, nsecs_t ns) const;
+
+    // Receive the events through a shared memory ring of about capacity
+    // events instead of the socket, which then only wakes us up. This must
+    // be called before enabling any sensor, and read() must be called until
+    // it returns 0 after each wake-up.
+    status_t enableDirectChannel(size_t capacity);
 
     // these are here only to support SensorManager.java
     status_t enableSensor(int32_t handle, int32_t us) const;
@@ -73,8 +92,13 @@ public:
 
 private:
     sp<Looper> getLooper() const;
+    ssize_t fillReceiveBuffer();
     sp<ISensorEventConnection> mSensorEventConnection;
     sp<BitTube> mSensorChannel;
+    sp<SensorDirectChannel> mDirectChannel;
+    ASensorEvent* mRecBuffer;
+    size_t mAvailable;
+    size_t mConsumed;
     mutable Mutex mLock;
     mutable sp<Looper> mLooper;
 };
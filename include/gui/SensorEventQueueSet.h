@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_EVENT_QUEUE_SET_H
+#define ANDROID_SENSOR_EVENT_QUEUE_SET_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/KeyedVector.h>
+#include <utils/RefBase.h>
+#include <utils/threads.h>
+
+// ----------------------------------------------------------------------------
+namespace android {
+// ----------------------------------------------------------------------------
+
+class SensorEventQueue;
+
+/*
+ * Lets one thread wait on many SensorEventQueues with a single epoll
+ * instead of a Looper per queue.
+ */
+class SensorEventQueueSet : public RefBase
+{
+public:
+            SensorEventQueueSet();
+    virtual ~SensorEventQueueSet();
+
+    status_t initCheck() const;
+
+    status_t add(const sp<SensorEventQueue>& queue);
+    status_t remove(const sp<SensorEventQueue>& queue);
+
+    // Waits for some queues to have events, for up to timeoutMillis (-1
+    // waits forever, 0 doesn't wait), and returns up to count of them in
+    // ready. Returns 0 on timeout. The ready queues must then be read
+    // until they return 0, they're not reported again until more events
+    // arrive.
+    ssize_t wait(sp<SensorEventQueue>* ready, size_t count, int timeoutMillis);
+
+private:
+    int mEpollFd;
+    mutable Mutex mLock;
+    KeyedVector< int, sp<SensorEventQueue> > mQueues; // by fd
+};
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+
+#endif // ANDROID_SENSOR_EVENT_QUEUE_SET_H
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_SHARED_VSYNC_H
+#define ANDROID_GUI_SHARED_VSYNC_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/Mutex.h>
+#include <utils/RefBase.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+#include <gui/DisplayEventReceiver.h>
+
+// ----------------------------------------------------------------------------
+namespace android {
+// ----------------------------------------------------------------------------
+class Parcel;
+
+/*
+ * A page of shared memory holding the vsync events, written by
+ * SurfaceFlinger's EventThread and mapped read-only by any number of
+ * clients. Publishing a vsync costs one futex wake-up for all the clients
+ * blocked in wait(), instead of one socket write per client.
+ *
+ * Each client has its own slot in the page, and a vsync is only stored in
+ * the slots of the clients it is meant for, so that a client's vsync rate
+ * or one-shot requests aren't overridden by the other clients'. The
+ * clients blocked on the page all wake up on a publish() and go back to
+ * sleep if their slot didn't change.
+ *
+ * The page only carries vsync events; hotplug events still go through the
+ * connection's BitTube.
+ */
+class SharedVSync : public RefBase
+{
+public:
+    // creates the page, for the writer
+            SharedVSync();
+    // maps the page the writer sent over binder, read-only, for the readers
+            SharedVSync(const Parcel& data);
+    virtual ~SharedVSync();
+
+    status_t initCheck() const;
+
+    // Returns a handle on a free slot of the writer's page, to send to a
+    // client. The slot is freed when the handle goes away. Returns NULL
+    // when all the slots are taken.
+    sp<SharedVSync> acquireSlot();
+
+    int32_t getSlot() const;
+
+    // for a handle returned by acquireSlot()
+    status_t writeToParcel(Parcel* reply) const;
+
+    // Stores a vsync event in the given slots and wakes up all the readers.
+    void publish(const DisplayEventReceiver::Event& event,
+            const Vector<int32_t>& slots);
+
+    // Reads the last vsync event stored in this reader's slot, and the
+    // number of vsync events stored there so far. Returns NOT_ENOUGH_DATA
+    // when nothing was stored yet.
+    status_t read(DisplayEventReceiver::Event* event,
+            uint32_t* delivered) const;
+
+    // Waits until more than *delivered vsync events are stored in this
+    // reader's slot, reads the last one and updates *delivered. Returns
+    // TIMED_OUT if that doesn't happen within timeout, a negative timeout
+    // waits forever.
+    status_t wait(DisplayEventReceiver::Event* event, uint32_t* delivered,
+            nsecs_t timeout) const;
+
+private:
+    enum { NUM_SLOTS = 128 };
+
+    struct Slot {
+        int64_t timestamp;
+        uint32_t count;
+        uint32_t id;
+        // number of events stored in the slot since it was acquired
+        uint32_t delivered;
+    };
+
+    struct Page {
+        // odd while publish() is changing the slots
+        volatile int32_t sequence;
+        // bumped after each publish(), the readers sleep on it
+        volatile int32_t futex;
+        Slot slots[NUM_SLOTS];
+    };
+
+    SharedVSync(const sp<SharedVSync>& writer, int32_t slot);
+    void map(int fd, int prot);
+    void releaseSlot(int32_t slot);
+
+    int mFd;
+    void* mBase;
+    int32_t mSlot;
+    // the writer, for the handles returned by acquireSlot()
+    sp<SharedVSync> mWriter;
+
+    // the writer's free slots
+    mutable Mutex mSlotLock;
+    bool mSlotUsed[NUM_SLOTS];
+};
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+
+#endif // ANDROID_GUI_SHARED_VSYNC_H
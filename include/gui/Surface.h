@@ -44,6 +44,11 @@ namespace android {
  * Surface.  Surface then forwards the buffers through Binder IPC
  * to the BufferQueue's producer interface, providing the new frame to a
  * consumer such as GLConsumer.
+ *
+ * Each dequeueBuffer() and queueBuffer() is one transaction: both carry a
+ * fence fd, which only binder can pass between processes, and the slot
+ * states live under the BufferQueue's lock. The queries that don't change
+ * over the life of the Surface are answered locally after the first one.
  */
 class Surface
     : public ANativeObjectBase<ANativeWindow, Surface, RefBase>
@@ -76,6 +81,30 @@ public:
         return surface != NULL && surface->getIGraphicBufferProducer() != NULL;
     }
 
+    /* allocateBuffers() has the buffers of all the free slots allocated
+     * ahead of the first dequeueBuffer() calls, with the currently
+     * requested size, format and usage. This avoids stalling on the
+     * allocations when the first frames are produced. It returns
+     * immediately when the IGraphicBufferProducer is remote.
+     */
+    void allocateBuffers();
+
+    /* getLastQueuedFrameNumber() returns the frame number of the last
+     * buffer queued, 0 if none was queued (or it was dropped right away).
+     */
+    uint64_t getLastQueuedFrameNumber() const;
+
+    /* getFrameTimestamps() returns how one of the last frames queued went
+     * through the consumer: how long dequeueBuffer() waited for its buffer,
+     * and when it was queued, acquired and presented. frameNumber is the
+     * one returned by getLastQueuedFrameNumber() after the frame was
+     * queued. The timestamps of a frame may still be 0 when it has not
+     * gotten that far yet, and NAME_NOT_FOUND is returned once the frame
+     * is too old.
+     */
+    status_t getFrameTimestamps(uint64_t frameNumber,
+            IGraphicBufferProducer::FrameTimestamps* outTimestamps) const;
+
 protected:
     virtual ~Surface();
 
@@ -160,6 +189,9 @@ private:
 
     struct BufferSlot {
         sp<GraphicBuffer> buffer;
+        // the area of the buffer that differs from the last posted frame,
+        // which lock() copies back from it. The whole buffer when its
+        // content is unknown.
         Region dirtyRegion;
     };
 
@@ -177,6 +209,11 @@ private:
     // of the buffer allocated to a slot.
     BufferSlot mSlots[NUM_BUFFER_SLOTS];
 
+    // mDequeuedSlots has a bit set for each slot dequeued by dequeueBuffer
+    // and not queued or canceled yet, so that getSlotFromBufferLocked()
+    // doesn't have to search all of mSlots.
+    uint32_t mDequeuedSlots;
+
     // mReqWidth is the buffer width that will be requested at the next dequeue
     // operation. It is initialized to 1.
     uint32_t mReqWidth;
@@ -240,6 +277,15 @@ private:
     // one buffer behind the producer.
     mutable bool mConsumerRunningBehind;
 
+    // mQueuesToWindowComposer caches whether SurfaceFlinger consumes the
+    // buffers of mGraphicBufferProducer, which can't change, so that
+    // NATIVE_WINDOW_QUEUES_TO_WINDOW_COMPOSER only costs a binder call to
+    // SurfaceFlinger the first time. -1 until known.
+    mutable int mQueuesToWindowComposer;
+
+    // mLastQueuedFrameNumber is the frame number of the last buffer queued.
+    uint64_t mLastQueuedFrameNumber;
+
     // mMutex is the mutex used to prevent concurrent access to the member
     // variables of Surface objects. It must be locked whenever the
     // member variables are accessed.
@@ -250,9 +296,6 @@ private:
     sp<GraphicBuffer>           mPostedBuffer;
     bool                        mConnectedToCpu;
 
-    // must be accessed from lock/unlock thread only
-    Region mDirtyRegion;
-
 #ifdef SURFACE_SKIP_FIRST_DEQUEUE
     bool                        mDequeuedOnce;
 #endif
@@ -99,6 +99,16 @@ public:
             uint32_t flags = 0  // usage flags
     );
 
+    //! Create several surfaces with a single call to SurfaceFlinger,
+    //! surfaces gets one entry per spec, NULL if that one failed
+    status_t createSurfaces(
+            const Vector<ISurfaceComposerClient::SurfaceSpec>& specs,
+            Vector< sp<SurfaceControl> >* surfaces);
+
+    //! Destroy several surfaces of this client with a single call, they
+    //! become invalid like after SurfaceControl::clear()
+    status_t destroySurfaces(const Vector< sp<SurfaceControl> >& surfaces);
+
     //! Create a display
     static sp<IBinder> createDisplay(const String8& displayName, bool secure);
 
@@ -124,6 +134,11 @@ public:
     //! Flag the currently open transaction as an animation transaction.
     static void setAnimationTransaction();
 
+    //! When enabled, asynchronous transactions are not sent when closed but
+    //! at the next vsync, together with all the others closed in the same
+    //! frame. Synchronous and animation transactions are sent right away.
+    static void setFrameAlignedTransactions(bool enabled);
+
     status_t    hide(const sp<IBinder>& id);
     status_t    show(const sp<IBinder>& id);
     status_t    setFlags(const sp<IBinder>& id, uint32_t flags, uint32_t mask);
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef I420_CONVERTER_H
+
+#define I420_CONVERTER_H
+
+#include <stdint.h>
+#include <android/rect.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Conversions between I420 (Y, then Cb and Cr planes, all tightly packed)
+ * and the other 4:2:0 layouts, and from I420 to RGB. They are what the
+ * reference II420ColorConverter is made of, and can be used to write one.
+ *
+ * The row kernels use NEON on ARM and SSE2 on x86 when the compiler
+ * targets them, and frames of 1080p and up are converted in bands of rows
+ * on several threads.
+ */
+
+/*
+ * The layouts, the chroma planes follow the Y plane in the same buffer:
+ * NV12 and NV21 have a single plane of interleaved Cb,Cr (resp. Cr,Cb)
+ * samples with the stride of the Y plane, YV12 has a Cr then a Cb plane
+ * with half the stride of the Y plane.
+ */
+enum {
+    I420_LAYOUT_NV12 = 1,
+    I420_LAYOUT_NV21 = 2,
+    I420_LAYOUT_YV12 = 3,
+};
+
+/*
+ * I420Converter_toI420
+ * @Desc     Extracts the crop rectangle of a frame into an I420 buffer
+ * @param    layout    (IN) The layout of the source frame
+ * @param    src       (IN) The source frame
+ * @param    stride    (IN) The stride of the source Y plane, in bytes
+ * @param    height    (IN) The number of rows of the source Y plane
+ * @param    crop      (IN) The rectangle to convert
+ * @param    dst      (OUT) The I420 frame, of the size of the crop rectangle
+ * @return   -1 Any error
+ * @return   0  No Error
+ */
+int I420Converter_toI420(int layout, const void* src, int stride, int height,
+        ARect crop, void* dst);
+
+/*
+ * I420Converter_fromI420
+ * @Desc     Converts an I420 frame into the top-left corner of a frame
+ * @param    layout    (IN) The layout of the destination frame
+ * @param    src       (IN) The I420 frame
+ * @param    width     (IN) The width of the I420 frame
+ * @param    height    (IN) The height of the I420 frame
+ * @param    dst      (OUT) The destination frame
+ * @param    dstStride (IN) The stride of the destination Y plane, in bytes
+ * @param    dstHeight (IN) The number of rows of the destination Y plane
+ * @return   -1 Any error
+ * @return   0  No Error
+ */
+int I420Converter_fromI420(int layout, const void* src, int width, int height,
+        void* dst, int dstStride, int dstHeight);
+
+/*
+ * I420Converter_toRGBA8888, I420Converter_toRGB565
+ * @Desc     Converts an I420 frame (BT.601, video range) to RGB
+ * @param    src       (IN) The I420 frame
+ * @param    width     (IN) The width of the I420 frame
+ * @param    height    (IN) The height of the I420 frame
+ * @param    dst      (OUT) The RGB image
+ * @param    dstStride (IN) The stride of the RGB image, in pixels
+ * @return   -1 Any error
+ * @return   0  No Error
+ */
+int I420Converter_toRGBA8888(const void* src, int width, int height,
+        void* dst, int dstStride);
+int I420Converter_toRGB565(const void* src, int width, int height,
+        void* dst, int dstStride);
+
+/*
+ * I420Converter_setMaxThreads
+ * Limits the number of threads converting a frame, 0 (the default) uses
+ * one per CPU, up to 4.
+ */
+void I420Converter_setMaxThreads(int maxThreads);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // I420_CONVERTER_H
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_BINDER_PROFILER_H
+#define ANDROID_BINDER_PROFILER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Timers.h>
+
+namespace android {
+
+class BinderThreadProfile;
+class Parcel;
+class String8;
+
+/*
+ * BinderProfiler counts the binder transactions of the process per
+ * interface descriptor and transaction code: how many were sent and
+ * served, the size of their Parcels, the round-trip time seen by the
+ * client and the time the server spent executing them.
+ *
+ * It's off unless the debug.binder.profile property is set when the
+ * process starts, or it's started with
+ * "dumpsys <service> --binder-profile start", which also dumps it.
+ *
+ * Each thread records into its own BinderThreadProfile, owned by its
+ * IPCThreadState. Its lock is only contended while dump() runs.
+ */
+class BinderProfiler {
+public:
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    // forgets everything recorded so far
+    static void reset();
+
+    // records a transaction sent by the calling thread, or served by it
+    // if server is true. *profile is the thread's BinderThreadProfile,
+    // created on first use.
+    static void record(BinderThreadProfile** profile, bool server,
+            uint32_t code, const Parcel& data, size_t replySize,
+            nsecs_t duration);
+
+    // called when the thread owning profile exits, what it recorded is
+    // kept for dump()
+    static void retire(BinderThreadProfile* profile);
+
+    static void dump(String8& result);
+};
+
+}; // namespace android
+
+#endif // ANDROID_BINDER_PROFILER_H
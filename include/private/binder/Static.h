@@ -18,6 +18,7 @@
 // destruction order in the library.
 
 #include <utils/threads.h>
+#include <utils/Vector.h>
 
 #include <binder/IBinder.h>
 #include <binder/IMemory.h>
@@ -36,4 +37,19 @@ extern Mutex gDefaultServiceManagerLock;
 extern sp<IServiceManager> gDefaultServiceManager;
 extern sp<IPermissionController> gPermissionController;
 
+// For BinderProfiler.cpp
+class BinderThreadProfile;
+extern Mutex gBinderProfilerLock;
+extern volatile int32_t gBinderProfilerEnabled;
+extern Vector<BinderThreadProfile*> gBinderThreadProfiles;
+extern BinderThreadProfile* gRetiredBinderProfile;
+
+// For AsyncTransaction.cpp
+class AsyncTransaction;
+extern Mutex gAsyncTransactionLock;
+extern Condition gAsyncTransactionCondition;
+extern Vector<AsyncTransaction*> gAsyncTransactions;
+extern size_t gAsyncTransactionThreads;
+extern size_t gAsyncTransactionIdleThreads;
+
 }   // namespace android
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_EGL_IMAGE_CACHE_H
+#define ANDROID_GUI_EGL_IMAGE_CACHE_H
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <utils/RefBase.h>
+#include <utils/Singleton.h>
+#include <utils/String8.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+namespace android {
+// ----------------------------------------------------------------------------
+
+class GraphicBuffer;
+
+/*
+ * EGLImageCache keeps the EGLImages of GraphicBuffers around, per
+ * EGLDisplay, so that GLConsumers which see the same buffer again (after a
+ * detachFromContext()/attachToContext() cycle, a slot being freed, or in
+ * another GLConsumer of the process) don't have to create a new one.
+ *
+ * Images are reference counted: acquire() returns an image that stays
+ * valid until the matching release(). Images nobody holds are kept in LRU
+ * order and the oldest ones are destroyed beyond MAX_IDLE_IMAGES, since
+ * they keep their buffer's memory alive. The consumers evict() the
+ * buffers they free, so that their images don't keep them alive either.
+ */
+class EGLImageCache : public Singleton<EGLImageCache> {
+    friend class Singleton<EGLImageCache>;
+    EGLImageCache();
+
+public:
+    enum { MAX_IDLE_IMAGES = 16 };
+
+    // returns an image of buffer on dpy, or EGL_NO_IMAGE_KHR if it can't
+    // be created
+    EGLImageKHR acquire(EGLDisplay dpy, const sp<GraphicBuffer>& buffer);
+
+    // gives back an image returned by acquire()
+    void release(EGLDisplay dpy, EGLImageKHR image);
+
+    // destroys the images of buffer on all the displays, the ones still
+    // acquired are destroyed when they are released
+    void evict(const sp<GraphicBuffer>& buffer);
+
+    // whether there is an image of buffer on any display
+    bool contains(const sp<GraphicBuffer>& buffer) const;
+
+    // with deferred trimming, release() leaves the idle images beyond
+    // MAX_IDLE_IMAGES to the next trim(), so that a process can destroy
+    // them in one go where it suits it
+    void setDeferredTrim(bool deferred);
+    void trim();
+
+    void dump(String8& result) const;
+
+private:
+    struct Entry {
+        EGLDisplay dpy;
+        // the buffer is only used as a key, the weak reference tells if
+        // another buffer has been allocated at the same address since
+        const GraphicBuffer* key;
+        wp<GraphicBuffer> buffer;
+        EGLImageKHR image;
+        uint32_t refs;
+        uint32_t lastUse;
+        // the buffer was freed, destroy the image on the last release()
+        bool evicted;
+    };
+
+    void destroyLocked(size_t index);
+    void trimLocked();
+
+    mutable Mutex mLock;
+    Vector<Entry> mEntries;
+    bool mDeferredTrim;
+    size_t mIdleCount;
+    uint32_t mUseCounter;
+    uint32_t mHits;
+    uint32_t mMisses;
+    uint32_t mEvictions;
+};
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+
+#endif // ANDROID_GUI_EGL_IMAGE_CACHE_H
@@ -90,9 +90,17 @@ public:
     // getSignalTime returns the system monotonic clock time at which the
     // fence transitioned to the signaled state.  If the fence is not signaled
     // then INT64_MAX is returned.  If the fence is invalid or if an error
-    // occurs then -1 is returned.
+    // occurs then -1 is returned.  The fence is polled first, the sync driver
+    // is only asked for the time once the fence has signaled, and the time
+    // is kept from then on.
     nsecs_t getSignalTime() const;
 
+    // getSignalTimes does what getSignalTime does for count fences at once,
+    // polling all the fences that may not have signaled together.  NULL
+    // entries are treated as invalid fences.
+    static void getSignalTimes(const Fence* const* fences, size_t count,
+            nsecs_t* outTimes);
+
     // Flattenable interface
     size_t getFlattenedSize() const;
     size_t getFdCount() const;
@@ -111,7 +119,16 @@ private:
     Fence& operator = (const Fence& rhs);
     const Fence& operator = (const Fence& rhs) const;
 
+    // readSignalTime gets the signal time from the sync driver, and keeps
+    // it if the fence has signaled.
+    nsecs_t readSignalTime() const;
+
     int mFenceFd;
+
+    // mSignalTime is valid once mSignaled is set, which is done with
+    // release semantics.
+    mutable nsecs_t mSignalTime;
+    mutable volatile int32_t mSignaled;
 };
 
 }; // namespace android
@@ -94,6 +94,7 @@ public:
     uint32_t getUsage() const           { return usage; }
     PixelFormat getPixelFormat() const  { return format; }
     Rect getBounds() const              { return Rect(width, height); }
+    uint64_t getId() const              { return mId; }
 
     status_t reallocate(uint32_t w, uint32_t h, PixelFormat f, uint32_t usage);
 
@@ -148,6 +149,19 @@ private:
 
     void free_handle();
 
+    // imported buffers are tracked by id, so that unflattening a buffer
+    // this process already holds shares its registered handle; the
+    // received fds must be the same files as that import's
+    static uint64_t getUniqueId();
+    static sp<GraphicBuffer> findImport(uint64_t id, int const* buf,
+            int const* fds, size_t numFds, size_t numInts);
+    void trackImport();
+    void untrackImport();
+
+    // keeps buffers only the CPU accesses locked in gralloc, see
+    // GraphicBufferMapper::setPersistentMapping()
+    void initPersistentMapping();
+
     // Flattenable interface
     size_t getFlattenedSize() const;
     size_t getFdCount() const;
@@ -161,6 +175,10 @@ private:
     ssize_t mInitCheck;
     int mIndex;
 
+    // mId identifies the buffer across processes: it's assigned when the
+    // buffer is allocated and carried in its flattened form.
+    uint64_t mId;
+
     // If we're wrapping another buffer then this reference will make sure it
     // doesn't get freed.
     sp<ANativeWindowBuffer> mWrappedBuffer;
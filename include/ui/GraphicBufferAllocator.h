@@ -19,6 +19,7 @@
 #define ANDROID_BUFFER_ALLOCATOR_H
 
 #include <stdint.h>
+#include <sys/types.h>
 
 #include <cutils/native_handle.h>
 
@@ -26,6 +27,8 @@
 #include <utils/KeyedVector.h>
 #include <utils/threads.h>
 #include <utils/Singleton.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
 
 #include <ui/PixelFormat.h>
 
@@ -73,6 +76,18 @@ public:
 
     status_t free(buffer_handle_t handle);
 
+    // Freed buffers can be kept in a pool, so that allocating a buffer of
+    // the same size, format and usage again doesn't go to gralloc. The pool
+    // is disabled until it's given a size, in bytes. Pooled buffers keep
+    // their old content, so they are only handed back to the process they
+    // were allocated for. Buffers that can be read with the CPU, and
+    // protected buffers, are never pooled.
+    void setPoolLimit(size_t bytes);
+
+    // frees the pooled buffers that have been idle for longer than maxAge,
+    // all of them if maxAge is 0
+    void trimPool(nsecs_t maxAge);
+
     void dump(String8& res) const;
     static void dumpToSystemLog();
 
@@ -84,10 +99,36 @@ private:
         PixelFormat format;
         uint32_t usage;
         size_t size;
+        pid_t owner;
     };
     
+    struct pool_rec_t {
+        buffer_handle_t handle;
+        alloc_rec_t rec;
+        nsecs_t freeTime;
+    };
+
+    // returns whether the buffer can be given to alloc() again
+    static bool isPoolable(const alloc_rec_t& rec);
+    static bool isPoolable(uint32_t usage);
+
+    // removes the buffers that don't fit in the pool anymore, or are older
+    // than maxAge if it is not 0, and returns them in evicted
+    void trimPoolLocked(size_t limit, nsecs_t maxAge,
+            Vector<buffer_handle_t>* evicted);
+
+    // gives buffers removed from the pool back to gralloc, without sLock
+    void freeEvicted(const Vector<buffer_handle_t>& evicted);
+
     static Mutex sLock;
     static KeyedVector<buffer_handle_t, alloc_rec_t> sAllocList;
+
+    // freed buffers kept for reuse, the least recently freed first
+    static Vector<pool_rec_t> sPool;
+    static size_t sPoolSize;
+    size_t mPoolLimit;
+    uint32_t mPoolHits;
+    uint32_t mPoolMisses;
     
     friend class Singleton<GraphicBufferAllocator>;
     GraphicBufferAllocator();
@@ -20,7 +20,12 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <utils/KeyedVector.h>
 #include <utils/Singleton.h>
+#include <utils/threads.h>
+#include <utils/Timers.h>
+
+#include <ui/Rect.h>
 
 #include <hardware/gralloc.h>
 
@@ -31,7 +36,7 @@ namespace android {
 
 // ---------------------------------------------------------------------------
 
-class Rect;
+class String8;
 
 class GraphicBufferMapper : public Singleton<GraphicBufferMapper>
 {
@@ -57,13 +62,50 @@ public:
     status_t getphys(buffer_handle_t handle, void** paddr);
 #endif
 
+    // Keeps the buffer locked in gralloc across unlock() calls, so that
+    // locking it again with compatible usage and bounds returns the same
+    // address without going to gralloc, and without the mapping and cache
+    // maintenance that comes with it. This is only safe for buffers that
+    // no hardware accesses, since their caches are not flushed between
+    // the CPU locks anymore. Disabling it releases the gralloc lock.
+    status_t setPersistentMapping(buffer_handle_t handle, bool enable);
+
+    // drops the persistent lock and the statistics of a buffer that is
+    // about to be freed
+    void purge(buffer_handle_t handle);
+
     // dumps information about the mapping of this handle
     void dump(buffer_handle_t handle);
 
+    // dumps the lock statistics of the buffers this process locked
+    void dump(String8& result) const;
+
 private:
+    struct lock_rec_t {
+        lock_rec_t();
+        bool persistent;
+        bool locked;            // between lock() and unlock()
+        bool held;              // locked in gralloc
+        int heldUsage;
+        Rect heldBounds;
+        void* vaddr;
+        uint32_t locks;
+        uint32_t cachedLocks;   // locks that didn't go to gralloc
+        uint64_t pixels;        // total area locked
+        nsecs_t grallocTime;    // spent in gralloc lock and unlock
+    };
+
     friend class Singleton<GraphicBufferMapper>;
     GraphicBufferMapper();
+
+    lock_rec_t& editRecLocked(buffer_handle_t handle);
+
+    // gralloc unlock of a held persistent lock, called without mLock
+    status_t releaseHeld(buffer_handle_t handle);
+
     gralloc_module_t const *mAllocMod;
+    mutable Mutex mLock;
+    KeyedVector<buffer_handle_t, lock_rec_t> mLockRecs;
 };
 
 // ---------------------------------------------------------------------------
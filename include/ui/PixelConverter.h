@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UI_PIXEL_CONVERTER_H
+#define UI_PIXEL_CONVERTER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+
+#include <ui/PixelFormat.h>
+
+namespace android {
+
+/*
+ * Converts images from one pixel format to another, a row at a time. The
+ * row kernels use NEON on ARM and SSE2 on x86 when the compiler targets
+ * them.
+ *
+ * Any pair of RGBA_8888, RGBX_8888, BGRA_8888 and RGB_565 is supported,
+ * as well as YV12 and YCrCb_420_SP (NV21) to any of these. Converting to
+ * RGBX_8888 leaves the X byte undefined, converting from a format without
+ * alpha yields opaque pixels. Color components are truncated, not
+ * dithered, when going to RGB_565.
+ */
+class PixelConverter {
+public:
+    PixelConverter(PixelFormat srcFormat, PixelFormat dstFormat);
+
+    // NO_ERROR if the conversion is supported, BAD_VALUE otherwise
+    status_t initCheck() const;
+
+    static bool isSupported(PixelFormat srcFormat, PixelFormat dstFormat);
+
+    // Converts width pixels. The source can't be a YUV format.
+    void convertRow(void* dst, const void* src, size_t width) const;
+
+    // Converts a width x height image, strides are in pixels. For the YUV
+    // formats, srcStride is the stride of the Y plane and the chroma
+    // planes follow it as laid out by gralloc.
+    status_t convert(void* dst, size_t dstStride,
+            const void* src, size_t srcStride,
+            size_t width, size_t height) const;
+
+private:
+    typedef void (*RowFunction)(void* dst, const void* src, size_t width);
+
+    PixelFormat mSrcFormat;
+    PixelFormat mDstFormat;
+    // src to dst, or RGBA_8888 to dst after a YUV source
+    RowFunction mRow;
+};
+
+}; // namespace android
+
+#endif // UI_PIXEL_CONVERTER_H
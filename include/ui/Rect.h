@@ -116,6 +116,12 @@ public:
         return !operator == (rhs);
     }
 
+    // true if rhs is entirely inside this rectangle
+    inline bool contains(const Rect& rhs) const {
+        return (left <= rhs.left) && (top <= rhs.top) &&
+               (right >= rhs.right) && (bottom >= rhs.bottom);
+    }
+
     // operator < defines an order which allows to use rectangles in sorted
     // vectors.
     bool operator < (const Rect& rhs) const;
@@ -87,6 +87,11 @@ public:
             Region&     andSelf(const Region& rhs, int dx, int dy);
             Region&     subtractSelf(const Region& rhs, int dx, int dy);
 
+            // these mirror the region: x becomes dx - x when flipH is set
+            // and x + dx otherwise, and likewise for y with flipV and dy
+            Region&     flipSelf(bool flipH, bool flipV, int dx, int dy);
+    const   Region      flip(bool flipH, bool flipV, int dx, int dy) const;
+
             // these translate rhs first
     const   Region      translate(int dx, int dy) const;
     const   Region      merge(const Region& rhs, int dx, int dy) const;
@@ -108,7 +113,8 @@ public:
     inline  Region&     operator += (const Point& pt);
 
     
-    // returns true if the regions share the same underlying storage
+    // returns true if the regions share the same underlying storage, or
+    // if both are small enough to be compared in place and are identical
     bool isTriviallyEqual(const Region& region) const;
 
 
@@ -146,6 +152,48 @@ public:
 private:
     class rasterizer;
     friend class rasterizer;
+
+    // Storage is the subset of Vector<Rect> Region needs. Up to
+    // INLINE_CAPACITY Rects (a region of 4 rects and its bounds) are kept
+    // inside the Region itself so that most temporary regions don't
+    // allocate. Larger regions use a SharedBuffer shared between copies,
+    // like Vector<Rect> does.
+    class Storage {
+    public:
+        enum { INLINE_CAPACITY = 5 };
+
+        inline Storage() : mCount(0), mRects(mInline) { }
+        Storage(const Storage& rhs);
+        ~Storage();
+        Storage& operator = (const Storage& rhs);
+
+        inline size_t size() const { return mCount; }
+        inline bool isInline() const { return mRects == mInline; }
+        inline Rect const* array() const { return mRects; }
+        inline const Rect& operator [] (size_t index) const { return mRects[index]; }
+        inline const Rect& itemAt(size_t index) const { return mRects[index]; }
+        inline const Rect& top() const { return mRects[mCount - 1]; }
+
+        Rect* editArray();
+        void clear();
+        void add(const Rect& rect);
+        void insertAt(const Rect& rect, size_t index);
+        void removeItemsAt(size_t index, size_t count);
+        // the content of new items is undefined
+        status_t resize(size_t count);
+
+        // moves the rects to a SharedBuffer if they're inline, this
+        // doesn't change the region
+        SharedBuffer const* getSharedBuffer() const;
+
+    private:
+        Rect* editArray(size_t count);
+        void releaseBuffer();
+
+        size_t mCount;
+        Rect* mRects;
+        Rect mInline[INLINE_CAPACITY];
+    };
     
     Region& operationSelf(const Rect& r, int op);
     Region& operationSelf(const Region& r, int op);
@@ -164,8 +212,16 @@ private:
     static void boolean_operation(int op, Region& dst,
             const Region& lhs, const Rect& rhs);
 
+    // handles the cases that don't need the rasterizer, rhs is NULL when
+    // the right operand is just rhsBounds
+    static bool quick_operation(int op, Region& dst,
+            const Region& lhs, const Region* rhs, const Rect& rhsBounds,
+            int dx, int dy);
+    static void subtract_rect(Region& dst, const Rect& lhs, const Rect& rhs);
+
     static void translate(Region& reg, int dx, int dy);
     static void translate(Region& dst, const Region& reg, int dx, int dy);
+    static void flip(Region& reg, bool flipH, bool flipV, int dx, int dy);
 
     static bool validate(const Region& reg,
             const char* name, bool silent = false);
@@ -174,7 +230,7 @@ private:
     // with an extra Rect as the last element which is set to the
     // bounds of the region. However, if the region is
     // a simple Rect then mStorage contains only that rect.
-    Vector<Rect> mStorage;
+    Storage mStorage;
 };
 
 
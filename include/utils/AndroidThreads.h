@@ -86,6 +86,14 @@ extern int androidSetThreadPriority(pid_t tid, int prio);
 // Get the current priority of a particular thread. Returns one of the
 // ANDROID_PRIORITY constants or a negative result in case of error.
 extern int androidGetThreadPriority(pid_t tid);
+
+// Apply the CPU affinity, real-time policy and scheduling group in sched to
+// a particular thread; fields left at their defaults are not touched.  The
+// affinity is set first and the real-time policy last, so the thread never
+// runs real-time on a CPU it should stay off.  Returns 0, or -errno for the
+// first setting that failed; the others are still attempted.  Thread ID zero
+// means current thread.
+extern int androidSetThreadScheduling(pid_t tid, const android_thread_sched_t* sched);
 #endif
 
 #ifdef __cplusplus
@@ -45,11 +45,10 @@ protected:
         // a 30 bit hash code.
         uint32_t cookie;
 
-        // Storage for the entry begins here.
-        char entry[0];
+        // Storage for the entry follows, at mEntryOffset from the start of the bucket.
     };
 
-    BasicHashtableImpl(size_t entrySize, bool hasTrivialDestructor,
+    BasicHashtableImpl(size_t entrySize, size_t entryAlignment, bool hasTrivialDestructor,
             size_t minimumInitialCapacity, float loadFactor);
     BasicHashtableImpl(const BasicHashtableImpl& other);
 
@@ -69,8 +68,15 @@ protected:
     size_t add(hash_t hash, const void* __restrict__ entry);
     void removeAt(size_t index);
     void rehash(size_t minimumCapacity, float loadFactor);
+    void setIncrementalRehash(bool enabled);
 
-    const size_t mBucketSize; // number of bytes per bucket including the entry
+    // Number of old buckets moved to the new array by each add() while an
+    // incremental rehash is in progress.  The new array has room for twice
+    // the entries, so the migration ends well before it fills up.
+    static const size_t MIGRATION_STEP = 8;
+
+    const size_t mEntryOffset; // offset of the entry in a bucket, aligned for the entry type
+    const size_t mBucketSize; // number of bytes per bucket including the entry and padding
     const bool mHasTrivialDestructor; // true if the entry type does not require destruction
     size_t mCapacity;         // number of buckets that can be filled before exceeding load factor
     float mLoadFactor;        // load factor
@@ -78,6 +84,12 @@ protected:
     size_t mFilledBuckets;    // number of buckets for which collision or present is true
     size_t mBucketCount;      // number of slots in the mBuckets array
     void* mBuckets;           // array of buckets, as a SharedBuffer
+    bool mIncrementalRehash;  // whether add() grows the table incrementally
+    // While an incremental rehash is in progress, the array being emptied
+    // into mBuckets.  Its buckets are indexed after those of mBuckets.
+    size_t mOldBucketCount;   // number of slots in the mOldBuckets array
+    size_t mMigratedBuckets;  // number of old buckets already moved
+    void* mOldBuckets;        // array of buckets, as a SharedBuffer, or NULL
 
     inline const Bucket& bucketAt(const void* __restrict__ buckets, size_t index) const {
         return *reinterpret_cast<const Bucket*>(
@@ -88,6 +100,26 @@ protected:
         return *reinterpret_cast<Bucket*>(static_cast<uint8_t*>(buckets) + index * mBucketSize);
     }
 
+    inline const void* entryIn(const Bucket& bucket) const {
+        return reinterpret_cast<const uint8_t*>(&bucket) + mEntryOffset;
+    }
+
+    inline void* entryIn(Bucket& bucket) const {
+        return reinterpret_cast<uint8_t*>(&bucket) + mEntryOffset;
+    }
+
+    // Returns the bucket at an index of the whole table, which may be in
+    // the old array during an incremental rehash.
+    inline const Bucket& bucketFor(size_t index) const {
+        return index < mBucketCount ? bucketAt(mBuckets, index) :
+                bucketAt(mOldBuckets, index - mBucketCount);
+    }
+
+    inline Bucket& bucketFor(size_t index) {
+        return index < mBucketCount ? bucketAt(mBuckets, index) :
+                bucketAt(mOldBuckets, index - mBucketCount);
+    }
+
     virtual bool compareBucketKey(const Bucket& bucket, const void* __restrict__ key) const = 0;
     virtual void initializeBucketEntry(Bucket& bucket, const void* __restrict__ entry) const = 0;
     virtual void destroyBucketEntry(Bucket& bucket) const = 0;
@@ -95,6 +127,23 @@ protected:
 private:
     void clone();
 
+    // Finds the key in one of the bucket arrays, continuing the chain from
+    // index unless it's -1.
+    ssize_t findIn(const void* __restrict__ buckets, size_t count, ssize_t index,
+            hash_t hash, const void* __restrict__ key) const;
+
+    // Returns the bucket an entry with the (trimmed) hash goes to in an
+    // array, marking the collisions on the way.
+    Bucket& insertionBucket(void* __restrict__ buckets, size_t count, hash_t hash) const;
+
+    // Replaces the bucket array by a new one with newBucketCount buckets,
+    // which the entries are moved into a few at a time by add().
+    void startIncrementalRehash(size_t newBucketCount, size_t newCapacity);
+
+    // Moves up to count buckets of the old array to the new one, releasing
+    // the old one once it's empty.
+    void migrateBuckets(size_t count);
+
     // Allocates a bucket array as a SharedBuffer.
     void* allocateBuckets(size_t count) const;
 
@@ -212,7 +261,8 @@ public:
     }
 
     /* Returns the number of buckets that the hashtable has, which is the size of its
-     * underlying array.
+     * underlying array.  While an incremental rehash is in progress, indices go
+     * beyond it into the array being emptied.
      */
     inline size_t bucketCount() const {
         return mBucketCount;
@@ -229,7 +279,7 @@ public:
      *          the bounds of the hashtable.
      */
     inline const TEntry& entryAt(size_t index) const {
-        return entryFor(bucketAt(mBuckets, index));
+        return entryFor(bucketFor(index));
     }
 
     /* Returns a non-const reference to the entry at the specified index.
@@ -239,7 +289,7 @@ public:
      */
     inline TEntry& editEntryAt(size_t index) {
         edit();
-        return entryFor(bucketAt(mBuckets, index));
+        return entryFor(bucketFor(index));
     }
 
     /* Clears the hashtable.
@@ -328,6 +378,34 @@ public:
         BasicHashtableImpl::rehash(minimumCapacity, loadFactor);
     }
 
+    /* Grows the hashtable so that at least minimumCapacity entries can be
+     * added to it without rehashing.  Never shrinks it.
+     *
+     * Presizing a hashtable whose final size is known avoids the rehashes
+     * add() would otherwise do while it grows.
+     *
+     * minimumCapacity: The desired minimum capacity.
+     */
+    inline void reserve(size_t minimumCapacity) {
+        if (minimumCapacity > mCapacity) {
+            BasicHashtableImpl::rehash(minimumCapacity, mLoadFactor);
+        }
+    }
+
+    /* Sets whether add() grows the hashtable incrementally.
+     *
+     * By default, the add() that finds the hashtable full rehashes all of its
+     * entries at once, taking time proportional to its size.  Incrementally, that
+     * add() only allocates the new array, and it and the following add()s each
+     * move a few of the old entries to it, bounding the time any of them takes.
+     * Until all are moved, lookups may search both arrays.
+     *
+     * Explicit rehash() and reserve() calls always complete at once.
+     */
+    inline void setIncrementalRehash(bool enabled) {
+        BasicHashtableImpl::setIncrementalRehash(enabled);
+    }
+
     /* Determines whether there is room to add another entry without rehashing.
      * When this returns true, a subsequent add() operation is guaranteed to
      * complete without performing a rehash.
@@ -337,12 +415,12 @@ public:
     }
 
 protected:
-    static inline const TEntry& entryFor(const Bucket& bucket) {
-        return reinterpret_cast<const TEntry&>(bucket.entry);
+    inline const TEntry& entryFor(const Bucket& bucket) const {
+        return *static_cast<const TEntry*>(entryIn(bucket));
     }
 
-    static inline TEntry& entryFor(Bucket& bucket) {
-        return reinterpret_cast<TEntry&>(bucket.entry);
+    inline TEntry& entryFor(Bucket& bucket) const {
+        return *static_cast<TEntry*>(entryIn(bucket));
     }
 
     virtual bool compareBucketKey(const Bucket& bucket, const void* __restrict__ key) const;
@@ -353,13 +431,13 @@ private:
     // For dumping the raw contents of a hashtable during testing.
     friend class BasicHashtableTest;
     inline uint32_t cookieAt(size_t index) const {
-        return bucketAt(mBuckets, index).cookie;
+        return bucketFor(index).cookie;
     }
 };
 
 template <typename TKey, typename TEntry>
 BasicHashtable<TKey, TEntry>::BasicHashtable(size_t minimumInitialCapacity, float loadFactor) :
-        BasicHashtableImpl(sizeof(TEntry), traits<TEntry>::has_trivial_dtor,
+        BasicHashtableImpl(sizeof(TEntry), __alignof__(TEntry), traits<TEntry>::has_trivial_dtor,
                 minimumInitialCapacity, loadFactor) {
 }
 
@@ -19,20 +19,29 @@
 
 #include <stddef.h>
 
+#include <utils/BasicHashtable.h>
 #include <utils/Flattenable.h>
 #include <utils/RefBase.h>
-#include <utils/SortedVector.h>
+#include <utils/Vector.h>
 #include <utils/threads.h>
 
 namespace android {
 
+class FileMap;
+
 // A BlobCache is an in-memory cache for binary key/value pairs.  A BlobCache
-// does NOT provide any thread-safety guarantees.
+// may be used from several threads at once: the entries are spread over a
+// fixed number of shards by the hash of their key, and each shard has its own
+// lock, so that lookups and insertions of unrelated keys don't contend.  When
+// the cache is full the least recently used entries are evicted first.
 //
 // The cache contents can be serialized to an in-memory buffer or mmap'd file
-// and then reloaded in a subsequent execution of the program.  This
-// serialization is non-portable and the data should only be used by the device
-// that generated it.
+// and then reloaded in a subsequent execution of the program, either by copying
+// them back with unflatten or by attaching the cache to the mmap'd file, in
+// which case the entries are read from the file as they are looked up and
+// later saves only need to append the new ones.  This serialization is
+// non-portable and the data should only be used by the device that generated
+// it.
 class BlobCache : public RefBase, public Flattenable {
 public:
 
@@ -109,38 +118,127 @@ public:
     virtual status_t unflatten(void const* buffer, size_t size, int fds[],
             size_t count);
 
+    // attach merges into the cache the serialized cache contents found at
+    // 'offset' in the memory mapped by 'map' without copying them: only the
+    // index at the end of the serialized contents is read, and the keys and
+    // values are read from the mapping when they are looked up.  Each entry
+    // is checked against its checksum the first time get finds it, and
+    // evicted if it doesn't match.
+    //
+    // An entry already in the cache is replaced by the serialized entry with
+    // the same key if their contents are the same, and kept otherwise, so
+    // that entries set while the contents were being saved aren't lost.
+    // Serialized entries that don't fit in the cache are skipped.
+    //
+    // attach takes over the caller's reference to 'map', which is released
+    // once no entry points into it anymore, even if an error occurs.  If the
+    // serialized contents are invalid then BAD_VALUE is returned and the cache
+    // is left unchanged.  As with unflatten, contents of another version are
+    // ignored.
+    status_t attach(FileMap* map, size_t offset);
+
+    // getAppendOffset returns the offset, from the start of the serialized
+    // contents the cache was last attached to, at which the data produced by
+    // flattenAppend goes.  It returns 0 if the cache isn't attached to any
+    // serialized contents, in which case it can only be saved with flatten.
+    size_t getAppendOffset() const;
+
+    // getAppendSize returns the number of bytes needed by flattenAppend.
+    size_t getAppendSize() const;
+
+    // flattenAppend serializes the entries that are not in the contents the
+    // cache was last attached to, followed by a new index of all the entries.
+    // Writing that data at getAppendOffset() over the attached contents, and
+    // truncating them after it, gives the serialized contents of the whole
+    // cache without rewriting the entries that were already there.
+    //
+    // Preconditions:
+    //   getAppendOffset() != 0
+    //   size >= this.getAppendSize()
+    status_t flattenAppend(void* buffer, size_t size) const;
+
+    // getHitCount returns the number of calls to get that found their key in
+    // the cache.
+    uint32_t getHitCount() const;
+
+    // getMissCount returns the number of calls to get that did not find their
+    // key in the cache.
+    uint32_t getMissCount() const;
+
+    // getEvictionCount returns the number of entries that were evicted from
+    // the cache to make room for new ones.
+    uint32_t getEvictionCount() const;
+
 private:
     // Copying is disallowed.
     BlobCache(const BlobCache&);
     void operator=(const BlobCache&);
 
-    // A random function helper to get around MinGW not having nrand48()
-    long int blob_random();
+    // The number of shards is a power of two so that a shard can be picked
+    // from the top bits of the key hash.
+    enum {
+        SHARD_BITS = 3,
+        NUM_SHARDS = 1 << SHARD_BITS,
+    };
+
+    // reserve atomically adds delta to mTotalSize, unless that would make it
+    // exceed mMaxTotalSize, in which case it returns false and leaves
+    // mTotalSize unchanged.
+    bool reserve(ssize_t delta);
 
-    // clean evicts a randomly chosen set of entries from the cache such that
-    // the total size of all remaining entries is less than mMaxTotalSize/2.
-    void clean();
+    // clean evicts the least recently used entries from the cache until the
+    // total size of all remaining entries is less than mMaxTotalSize/2.  It
+    // returns false, without evicting anything, if the cache isn't full enough
+    // for cleaning to have some effect.  It must be called without holding
+    // any shard lock.
+    bool clean();
 
-    // isCleanable returns true if the cache is full enough for the clean method
-    // to have some effect, and false otherwise.
-    bool isCleanable() const;
+    // clear evicts all the entries from the cache.
+    void clear();
+
+    // lockShards and unlockShards acquire and release the locks of all the
+    // shards, always in the same order.
+    void lockShards() const;
+    void unlockShards() const;
+
+    // A Mapping owns the FileMap that attached entries point into.
+    class Mapping : public RefBase {
+    public:
+        Mapping(FileMap* map);
+        ~Mapping();
+
+        const uint8_t* getData() const;
+        size_t getSize() const;
+
+    private:
+        // Copying is not allowed.
+        Mapping(const Mapping&);
+        void operator=(const Mapping&);
+
+        FileMap* mMap;
+    };
 
     // A Blob is an immutable sized unstructured data blob.
     class Blob : public RefBase {
     public:
         Blob(const void* data, size_t size, bool copyData);
+        Blob(const void* data, size_t size, const sp<Mapping>& mapping);
         ~Blob();
 
-        bool operator<(const Blob& rhs) const;
+        bool operator==(const Blob& rhs) const;
 
         const void* getData() const;
         size_t getSize() const;
+        const sp<Mapping>& getMapping() const;
 
     private:
         // Copying is not allowed.
         Blob(const Blob&);
         void operator=(const Blob&);
 
+        // mMapping, if not NULL, is the mapping that mData points into.
+        sp<Mapping> mMapping;
+
         // mData points to the buffer containing the blob data.
         const void* mData;
 
@@ -156,16 +254,29 @@ private:
     class CacheEntry {
     public:
         CacheEntry();
-        CacheEntry(const sp<Blob>& key, const sp<Blob>& value);
+        CacheEntry(const sp<Blob>& key, const sp<Blob>& value, hash_t hash,
+                uint32_t lastUse);
+        CacheEntry(const sp<Blob>& key, const sp<Blob>& value, hash_t hash,
+                uint32_t lastUse, size_t offset, uint32_t checksum);
         CacheEntry(const CacheEntry& ce);
 
-        bool operator<(const CacheEntry& rhs) const;
         const CacheEntry& operator=(const CacheEntry&);
 
-        sp<Blob> getKey() const;
+        // getKey returns the key blob by reference, as needed by
+        // BasicHashtable.
+        const Blob& getKey() const;
         sp<Blob> getValue() const;
-
+        hash_t getHash() const;
+        uint32_t getLastUse() const;
+        size_t getOffset() const;
+        uint32_t getChecksum() const;
+        bool isVerified() const;
+
+        // setValue replaces the value, which makes the entry a pure
+        // in-memory one.
         void setValue(const sp<Blob>& value);
+        void setLastUse(uint32_t lastUse);
+        void setVerified();
 
     private:
 
@@ -174,8 +285,78 @@ private:
 
         // mValue is the cached data associated with the key.
         sp<Blob> mValue;
+
+        // mHash is the hash code of the key.
+        hash_t mHash;
+
+        // mLastUse is the value of mUseCounter when the entry was last set or
+        // retrieved.  Entries with the smallest mLastUse are evicted first.
+        uint32_t mLastUse;
+
+        // mOffset is the offset of the entry in the serialized contents its
+        // value was attached from, or 0 if the entry was set in memory.
+        size_t mOffset;
+
+        // mChecksum is the checksum of the key and value of an attached entry.
+        uint32_t mChecksum;
+
+        // mVerified indicates whether the key and value have been checked
+        // against mChecksum.  Entries set in memory are always verified.
+        bool mVerified;
     };
 
+    // A Shard holds the cache entries whose key hash falls into it.
+    struct Shard {
+        // mLock protects mEntries.
+        mutable Mutex mLock;
+
+        // mEntries maps key blobs to their cache entry.
+        BasicHashtable<Blob, CacheEntry> mEntries;
+    };
+
+    // An EntryRef refers to a cache entry, to sort the entries by last use.
+    struct EntryRef {
+        uint32_t mLastUse;
+        uint32_t mShard;
+        size_t mIndex;
+    };
+    static int compareEntryRefs(const EntryRef* lhs, const EntryRef* rhs);
+
+    // getEntriesByLastUse returns references to all the cache entries, from
+    // the least to the most recently used.  The shards must be locked.
+    void getEntriesByLastUse(Vector<EntryRef>* entries) const;
+
+    // entryAt returns the cache entry an EntryRef refers to.
+    const CacheEntry& entryAt(const EntryRef& ref) const;
+
+    // isAttached returns whether an entry is part of the serialized contents
+    // the cache was last attached to.  The shards must be locked.
+    bool isAttached(const CacheEntry& entry) const;
+
+    // getFlattenedSizeLocked and flattenLocked implement getFlattenedSize and
+    // flatten when start is 0, and getAppendSize and flattenAppend when it is
+    // mAppendOffset.  The shards must be locked.
+    size_t getFlattenedSizeLocked(size_t start) const;
+    status_t flattenLocked(void* buffer, size_t size, size_t start) const;
+
+    // verify checks an attached entry against its checksum.
+    static bool verify(const CacheEntry& entry);
+
+    // hashKey returns the hash code of a key blob.
+    static hash_t hashKey(const void* key, size_t keySize);
+
+    // checksum returns the checksum of a serialized entry.
+    static uint32_t checksum(const void* key, size_t keySize, const void* value,
+            size_t valueSize);
+
+    // shardFor returns the shard holding the keys with the given hash code.
+    Shard& shardFor(hash_t hash);
+
+    // The serialized cache contents are a Header, the entries, each made of
+    // an EntryHeader followed by the key and value data, an index made of an
+    // IndexEntry per entry and finally a Trailer.  Keeping the index at the
+    // end lets new entries be appended by only rewriting the index.
+
     // A Header is the header for the entire BlobCache serialization format. No
     // need to make this portable, so we simply write the struct out.
     struct Header {
@@ -189,10 +370,40 @@ private:
         // mDeviceVersion is the device-specific version of the cache.  This can
         // be used to invalidate the cache.
         uint32_t mDeviceVersion;
+    };
 
-        // mNumEntries is number of cache entries following the header in the
-        // data.
+    // A Trailer ends the serialized cache contents and locates the index.
+    struct Trailer {
+        // mNumEntries is number of cache entries in the index.
         size_t mNumEntries;
+
+        // mIndexOffset is the offset of the index from the start of the
+        // serialized contents.
+        size_t mIndexOffset;
+
+        // mIndexChecksum is the checksum of the index.
+        uint32_t mIndexChecksum;
+
+        // mMagicNumber is the same as the header's, and tells a truncated
+        // buffer apart.
+        uint32_t mMagicNumber;
+    };
+
+    // An IndexEntry locates a serialized cache entry, so that it can be
+    // attached without reading it.
+    struct IndexEntry {
+        // mHash is the hash code of the key.
+        hash_t mHash;
+
+        // mChecksum is the checksum of the key and value data.
+        uint32_t mChecksum;
+
+        // mOffset is the offset of the entry's EntryHeader from the start of
+        // the serialized contents.
+        size_t mOffset;
+
+        size_t mKeySize;
+        size_t mValueSize;
     };
 
     // An EntryHeader is the header for a serialized cache entry.  No need to
@@ -216,6 +427,17 @@ private:
         uint8_t mData[];
     };
 
+    // readTrailer checks the serialized cache contents in 'buffer' and copies
+    // their trailer into 'trailer'.  It returns NAME_NOT_FOUND if the contents
+    // are of another version, and BAD_VALUE if they are invalid.
+    static status_t readTrailer(const uint8_t* buffer, size_t size,
+            Trailer* trailer);
+
+    // findEntry returns the serialized entry an IndexEntry refers to, or NULL
+    // if it lies outside of the entries of the serialized contents.
+    static const EntryHeader* findEntry(const uint8_t* buffer,
+            const Trailer& trailer, const IndexEntry& indexEntry);
+
     // mMaxKeySize is the maximum key size that will be cached. Calls to
     // BlobCache::set with a keySize parameter larger than mMaxKeySize will
     // simply not add the key/value pair to the cache.
@@ -234,16 +456,29 @@ private:
     const size_t mMaxTotalSize;
 
     // mTotalSize is the total combined size of all keys and values currently in
-    // the cache.
-    size_t mTotalSize;
-
-    // mRandState is the pseudo-random number generator state. It is passed to
-    // nrand48 to generate random numbers when needed.
-    unsigned short mRandState[3];
-
-    // mCacheEntries stores all the cache entries that are resident in memory.
-    // Cache entries are added to it by the 'set' method.
-    SortedVector<CacheEntry> mCacheEntries;
+    // the cache.  It is updated atomically, before an entry is added or after
+    // it is removed, so that it never exceeds mMaxTotalSize.
+    volatile int32_t mTotalSize;
+
+    // mUseCounter is incremented atomically each time an entry is set or
+    // retrieved, and gives the entries their mLastUse stamp.
+    volatile int32_t mUseCounter;
+
+    // mHits, mMisses and mEvictions are the counters returned by
+    // getHitCount, getMissCount and getEvictionCount.
+    volatile int32_t mHits;
+    volatile int32_t mMisses;
+    volatile int32_t mEvictions;
+
+    // mShards stores all the cache entries that are resident in memory.
+    // Cache entries are added to them by the 'set' and 'attach' methods.
+    Shard mShards[NUM_SHARDS];
+
+    // mAttached is the mapping the cache was last attached to, and
+    // mAppendOffset the offset of the index in it.  They are protected by
+    // the locks of all the shards.
+    sp<Mapping> mAttached;
+    size_t mAppendOffset;
 };
 
 }
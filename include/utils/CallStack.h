@@ -55,6 +55,13 @@ public:
 
     void update(int32_t ignoreDepth=1, int32_t maxDepth=MAX_DEPTH);
 
+    // Same as update(), but only records the return addresses, walking the
+    // stack with the compiler's unwind tables.  This neither allocates nor
+    // reads /proc/self/maps, so it is cheap enough to sample call stacks on
+    // hot paths; the stack contents of the frames are not recorded.  The
+    // addresses are symbolized when the stack is dumped.
+    void updateFast(int32_t ignoreDepth=1, int32_t maxDepth=MAX_DEPTH);
+
     // Dump a stack trace to the log using the supplied logtag
     void dump(const char* logtag, const char* prefix = 0) const;
 
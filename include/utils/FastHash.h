@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Hashing of byte strings for in-memory tables, and CRC32 for data
+ * integrity. Unlike JenkinsHash these consume 8 bytes at a time (32 per
+ * round for the hash), so they're much faster on anything but short keys.
+ * Hashes aren't stable across releases: don't persist them.
+ **/
+
+#ifndef ANDROID_FAST_HASH_H
+#define ANDROID_FAST_HASH_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/TypeHelpers.h>
+
+namespace android {
+
+/* 64 bit hash of size bytes (the xxHash64 algorithm), any alignment. */
+uint64_t FastHash64(const void* data, size_t size, uint64_t seed = 0);
+
+/* FastHash64 folded to a hash_t, for the hashed containers. */
+inline hash_t FastHash(const void* data, size_t size) {
+    uint64_t hash = FastHash64(data, size);
+    return hash_t(hash ^ (hash >> 32));
+}
+
+/* Updates the zip/zlib CRC32 crc with size bytes, same result as zlib's
+ * crc32(). Uses the CPU's CRC32 instructions when built for a CPU that has
+ * them (ARMv8), otherwise zlib. */
+uint32_t FastCrc32(uint32_t crc, const void* data, size_t size);
+
+}
+
+#endif // ANDROID_FAST_HASH_H
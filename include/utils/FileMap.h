@@ -54,6 +54,9 @@ public:
      * Closing the file descriptor does not unmap the pages, so we don't
      * claim ownership of the fd.
      *
+     * The offset is 64 bits wide on every platform; where the system can't
+     * map beyond 2GB, asking to fails instead of mapping the wrong bytes.
+     *
      * Returns "false" on failure.
      */
     bool create(const char* origFileName, int fd,
@@ -107,6 +110,37 @@ public:
      */
     int advise(MapAdvice advice);
 
+    /*
+     * Apply an madvise() call to "length" bytes from "offset" into the
+     * requested data, widened to whole pages.  The range must lie within
+     * the data.
+     *
+     * Returns 0 on success, -1 on failure.
+     */
+    int advise(MapAdvice advice, size_t offset, size_t length);
+
+    /*
+     * Start reading a range of the data into memory in the background, so
+     * that touching it later doesn't fault in one page at a time.  Does not
+     * wait for the reads to complete.
+     *
+     * Returns 0 on success, -1 on failure.
+     */
+    int prefetch(size_t offset, size_t length) {
+        return advise(WILLNEED, offset, length);
+    }
+
+    /*
+     * Tell the system a range of the data won't be needed again soon, so
+     * its pages can be reclaimed first.  A read-only map can still read the
+     * range afterwards; the pages are read from the file again.
+     *
+     * Returns 0 on success, -1 on failure.
+     */
+    int discard(size_t offset, size_t length) {
+        return advise(DONTNEED, offset, length);
+    }
+
 protected:
     // don't delete objects; call release()
     ~FileMap(void);
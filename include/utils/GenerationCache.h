@@ -17,38 +17,16 @@
 #ifndef ANDROID_UTILS_GENERATION_CACHE_H
 #define ANDROID_UTILS_GENERATION_CACHE_H
 
-#include <utils/KeyedVector.h>
-#include <utils/RefBase.h>
+#include <utils/LruCache.h>
 
 namespace android {
 
-/**
- * GenerationCache callback used when an item is removed
- */
-template<typename EntryKey, typename EntryValue>
-class OnEntryRemoved {
-public:
-    virtual ~OnEntryRemoved() { };
-    virtual void operator()(EntryKey& key, EntryValue& value) = 0;
-}; // class OnEntryRemoved
-
-template<typename EntryKey, typename EntryValue>
-struct Entry: public LightRefBase<Entry<EntryKey, EntryValue> > {
-    Entry(const Entry<EntryKey, EntryValue>& e) :
-            key(e.key), value(e.value),
-            parent(e.parent), child(e.child) { }
-    Entry(const EntryKey& key, const EntryValue& value) :
-            key(key), value(value) { }
-
-    EntryKey key;
-    EntryValue value;
-
-    sp<Entry<EntryKey, EntryValue> > parent; // next older entry
-    sp<Entry<EntryKey, EntryValue> > child;  // next younger entry
-}; // struct Entry
-
 /**
  * A LRU type cache
+ *
+ * This is a LruCache with its historical interface, where entries can also be
+ * looked up and removed by index. The indices run from 0 to size() - 1 in no
+ * particular order, and are only valid until the next put() or removal.
  */
 template<typename K, typename V>
 class GenerationCache {
@@ -78,23 +56,11 @@ public:
     bool removeOldest();
 
 private:
-    KeyedVector<K, sp<Entry<K, V> > > mCache;
-    uint32_t mMaxCapacity;
-
-    OnEntryRemoved<K, V>* mListener;
-
-    sp<Entry<K, V> > mOldest;
-    sp<Entry<K, V> > mYoungest;
-
-    void attachToCache(const sp<Entry<K, V> >& entry);
-    void detachFromCache(const sp<Entry<K, V> >& entry);
-
-    const V mNullValue;
+    LruCache<K, V> mCache;
 }; // class GenerationCache
 
 template<typename K, typename V>
-GenerationCache<K, V>::GenerationCache(uint32_t maxCapacity): mMaxCapacity(maxCapacity),
-    mListener(NULL), mNullValue(NULL) {
+GenerationCache<K, V>::GenerationCache(uint32_t maxCapacity): mCache(maxCapacity) {
 };
 
 template<typename K, typename V>
@@ -103,7 +69,7 @@ GenerationCache<K, V>::~GenerationCache() {
 };
 
 template<typename K, typename V>
-uint32_t GenerationCache<K, V>::size() const {
+size_t GenerationCache<K, V>::size() const {
     return mCache.size();
 }
 
@@ -113,22 +79,12 @@ uint32_t GenerationCache<K, V>::size() const {
  */
 template<typename K, typename V>
 void GenerationCache<K, V>::setOnEntryRemovedListener(OnEntryRemoved<K, V>* listener) {
-    mListener = listener;
+    mCache.setOnEntryRemovedListener(listener);
 }
 
 template<typename K, typename V>
 void GenerationCache<K, V>::clear() {
-    if (mListener) {
-        for (uint32_t i = 0; i < mCache.size(); i++) {
-            sp<Entry<K, V> > entry = mCache.valueAt(i);
-            if (mListener) {
-                (*mListener)(entry->key, entry->value);
-            }
-        }
-    }
     mCache.clear();
-    mYoungest.clear();
-    mOldest.clear();
 }
 
 template<typename K, typename V>
@@ -143,103 +99,32 @@ const K& GenerationCache<K, V>::getKeyAt(size_t index) const {
 
 template<typename K, typename V>
 const V& GenerationCache<K, V>::getValueAt(size_t index) const {
-    return mCache.valueAt(index)->value;
+    return mCache.valueAt(index);
 }
 
 template<typename K, typename V>
 const V& GenerationCache<K, V>::get(const K& key) {
-    ssize_t index = mCache.indexOfKey(key);
-    if (index >= 0) {
-        const sp<Entry<K, V> >& entry = mCache.valueAt(index);
-        detachFromCache(entry);
-        attachToCache(entry);
-        return entry->value;
-    }
-
-    return mNullValue;
+    return mCache.get(key);
 }
 
 template<typename K, typename V>
 bool GenerationCache<K, V>::put(const K& key, const V& value) {
-    if (mMaxCapacity != kUnlimitedCapacity && mCache.size() >= mMaxCapacity) {
-        removeOldest();
-    }
-
-    ssize_t index = mCache.indexOfKey(key);
-    if (index < 0) {
-        sp<Entry<K, V> > entry = new Entry<K, V>(key, value);
-        mCache.add(key, entry);
-        attachToCache(entry);
-        return true;
-    }
-
-    return false;
+    return mCache.put(key, value);
 }
 
 template<typename K, typename V>
 bool GenerationCache<K, V>::remove(const K& key) {
-    ssize_t index = mCache.indexOfKey(key);
-    if (index >= 0) {
-        removeAt(index);
-        return true;
-    }
-
-    return false;
+    return mCache.remove(key);
 }
 
 template<typename K, typename V>
 void GenerationCache<K, V>::removeAt(ssize_t index) {
-    sp<Entry<K, V> > entry = mCache.valueAt(index);
-    if (mListener) {
-        (*mListener)(entry->key, entry->value);
-    }
-    mCache.removeItemsAt(index, 1);
-    detachFromCache(entry);
+    mCache.removeAt(index);
 }
 
 template<typename K, typename V>
 bool GenerationCache<K, V>::removeOldest() {
-    if (mOldest.get()) {
-        ssize_t index = mCache.indexOfKey(mOldest->key);
-        if (index >= 0) {
-            removeAt(index);
-            return true;
-        }
-        ALOGE("GenerationCache: removeOldest failed to find the item in the cache "
-                "with the given key, but we know it must be in there.  "
-                "Is the key comparator kaput?");
-    }
-
-    return false;
-}
-
-template<typename K, typename V>
-void GenerationCache<K, V>::attachToCache(const sp<Entry<K, V> >& entry) {
-    if (!mYoungest.get()) {
-        mYoungest = mOldest = entry;
-    } else {
-        entry->parent = mYoungest;
-        mYoungest->child = entry;
-        mYoungest = entry;
-    }
-}
-
-template<typename K, typename V>
-void GenerationCache<K, V>::detachFromCache(const sp<Entry<K, V> >& entry) {
-    if (entry->parent.get()) {
-        entry->parent->child = entry->child;
-    } else {
-        mOldest = entry->child;
-    }
-
-    if (entry->child.get()) {
-        entry->child->parent = entry->parent;
-    } else {
-        mYoungest = entry->parent;
-    }
-
-    entry->parent.clear();
-    entry->child.clear();
+    return mCache.removeOldest();
 }
 
 }; // namespace android
@@ -26,8 +26,11 @@
 #ifndef ANDROID_LINEARALLOCATOR_H
 #define ANDROID_LINEARALLOCATOR_H
 
+#include <new>
 #include <stddef.h>
 
+#include <utils/TypeHelpers.h>
+
 namespace android {
 
 /**
@@ -51,12 +54,48 @@ public:
      */
     void* alloc(size_t size);
 
+    /**
+     * Allocates and default-constructs an object of type T. Unless T has a trivial destructor,
+     * the object is destroyed when the allocator is reset() or destroyed.
+     */
+    template<class T>
+    T* create() {
+        T* obj = new (alloc(sizeof(T))) T();
+        registerDestructor<T>(obj);
+        return obj;
+    }
+
+    /**
+     * Allocates an object of type T copy-constructed from 'other', destroyed like create()'s.
+     */
+    template<class T>
+    T* create(const T& other) {
+        T* obj = new (alloc(sizeof(T))) T(other);
+        registerDestructor<T>(obj);
+        return obj;
+    }
+
     /**
      * Attempt to deallocate the given buffer, with the LinearAllocator attempting to rewind its
      * state if possible. No destructors are called.
      */
     void rewindIfLastAlloc(void* ptr, size_t allocSize);
 
+    /**
+     * Destroys the objects made with create(), most recent first, and forgets every allocation.
+     * The pages are kept and filled again by later allocations, so an allocator reset once per
+     * frame stops calling malloc once it has grown to the frame's needs. Pages dedicated to a
+     * single large allocation are freed.
+     */
+    void reset();
+
+    /**
+     * Returns the calling thread's own allocator, creating it on first use. It is destroyed when
+     * the thread exits. Each thread only ever sees its own, so no locking is needed; callers
+     * typically reset() it at the end of each unit of work (e.g. a frame).
+     */
+    static LinearAllocator& getForThread();
+
     /**
      * Dump memory usage statistics to the log (allocated and wasted space)
      */
@@ -72,6 +111,21 @@ private:
     LinearAllocator(const LinearAllocator& other);
 
     class Page;
+    struct DestructorNode;
+
+    template<class T>
+    static void destroy(void* obj) { static_cast<T*>(obj)->~T(); }
+
+    template<class T>
+    void registerDestructor(T* obj) {
+        if (!traits<T>::has_trivial_dtor) {
+            addDestructor(obj, &destroy<T>);
+        }
+    }
+
+    void addDestructor(void* obj, void (*dtor)(void*));
+    void runDestructors();
+    static void freePages(Page* p);
 
     Page* newPage(size_t pageSize);
     bool fitsInCurrentPage(size_t size);
@@ -83,7 +137,12 @@ private:
     size_t mMaxAllocSize;
     void* mNext;
     Page* mCurrentPage;
+    // Pages bump-allocated from, in the order they are used.
     Page* mPages;
+    // Pages each holding a single allocation too large for the regular pages.
+    Page* mDedicatedPages;
+    // Objects to destroy on reset(), most recently created first.
+    DestructorNode* mDestructors;
 
     // Memory usage tracking
     size_t mTotalAllocated;
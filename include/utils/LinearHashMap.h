@@ -0,0 +1,401 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_LINEAR_HASH_MAP_H
+#define ANDROID_LINEAR_HASH_MAP_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/TypeHelpers.h>
+
+namespace android {
+
+/*
+ * A LinearHashMap maps unique keys to values, like a DefaultKeyedVector,
+ * but finds, adds and removes entries in constant time.
+ *
+ * It is an open addressing hashtable using linear probing with Robin Hood
+ * ordering: the entries of a run of buckets are kept sorted by the bucket
+ * their hash code maps to, so that a lookup can stop as soon as it meets an
+ * entry further from its bucket than the key would be, and removals shift
+ * the following entries back instead of leaving tombstones. The hash codes,
+ * the keys and the values are stored in three separate arrays, so probing
+ * only touches the hash codes and the keys of the run.
+ *
+ * Indices returned by indexOfKey(), add() and next() are only valid until
+ * the next add() or removeItem().
+ *
+ * TKey must support the following contract:
+ *     bool operator==(const TKey& other) const;  // return true if equal
+ *     hash_t hash_type(const TKey& key);         // see TypeHelpers.h
+ *
+ * Unlike BasicHashtable, the storage is not shared between copies.
+ */
+template <typename TKey, typename TValue>
+class LinearHashMap {
+public:
+    /* Creates an empty map. valueFor() returns defValue for missing keys.
+     * The buckets are allocated when the first entry is added.
+     */
+    LinearHashMap(const TValue& defValue = TValue());
+    LinearHashMap(const LinearHashMap<TKey, TValue>& other);
+    ~LinearHashMap();
+
+    LinearHashMap<TKey, TValue>& operator =(const LinearHashMap<TKey, TValue>& other);
+
+    /* Returns the number of entries in the map. */
+    inline size_t size() const { return mSize; }
+    inline bool isEmpty() const { return mSize == 0; }
+
+    /* Returns the number of entries that can be added without rehashing. */
+    inline size_t capacity() const { return (mBucketCount * 3) / 4; }
+
+    /* Makes room for at least the specified number of entries.
+     * Returns NO_ERROR, or NO_MEMORY if the buckets can't be allocated.
+     */
+    status_t setCapacity(size_t capacity);
+
+    /* Returns the index of the entry with the specified key, or
+     * NAME_NOT_FOUND.
+     */
+    ssize_t indexOfKey(const TKey& key) const;
+
+    /* Returns the value of the specified key, or the default value. */
+    const TValue& valueFor(const TKey& key) const;
+
+    /* Access to the entry at the specified index, which must be valid. */
+    inline const TKey& keyAt(size_t index) const { return mKeys[index]; }
+    inline const TValue& valueAt(size_t index) const { return mValues[index]; }
+    inline TValue& editValueAt(size_t index) { return mValues[index]; }
+
+    /* Returns the index of the first entry after the specified index, or -1.
+     * Iteration begins with index -1 and visits the entries in no
+     * particular order.
+     */
+    ssize_t next(ssize_t index) const;
+
+    /* Sets the value of the specified key, adding an entry if needed.
+     * Returns the index of the entry, or NO_MEMORY.
+     */
+    ssize_t add(const TKey& key, const TValue& value);
+
+    /* Removes the entry with the specified key.
+     * Returns NO_ERROR, or NAME_NOT_FOUND if there is none.
+     */
+    ssize_t removeItem(const TKey& key);
+
+    /* Removes all the entries, keeping the buckets. */
+    void clear();
+
+private:
+    enum { MIN_BUCKET_COUNT = 8 };
+
+    // The hash code of an entry, mixed so that keys whose hash codes only
+    // differ in either their low or their high bits spread over all the
+    // buckets. The top bits select the bucket, the lowest bit is always set
+    // so that 0 marks the empty buckets.
+    static inline uint32_t cookieFor(const TKey& key) {
+        return (uint32_t(hash_type(key)) * 0x9E3779B9U) | 1;
+    }
+
+    inline size_t bucketFor(uint32_t cookie) const {
+        return cookie >> mShift;
+    }
+
+    // how far the entry in the specified bucket is from its own bucket
+    inline size_t distanceAt(size_t index) const {
+        return (index - bucketFor(mCookies[index])) & (mBucketCount - 1);
+    }
+
+    // Returns the free bucket that an entry with the specified cookie goes
+    // into, after moving the entries that are closer to their own bucket
+    // one bucket further. There must be an empty bucket.
+    size_t makeRoom(uint32_t cookie);
+
+    // Moves the entries from the specified bucket to the end of the run
+    // one bucket further, leaving the specified bucket free.
+    void shiftRun(size_t index);
+
+    status_t rehash(size_t bucketCount);
+    void copyFrom(const LinearHashMap<TKey, TValue>& other);
+    void release();
+
+    uint32_t* mCookies;     // 0 for the empty buckets
+    TKey* mKeys;
+    TValue* mValues;
+    size_t mSize;
+    size_t mBucketCount;    // a power of 2, or 0
+    uint32_t mShift;        // 32 - log2(mBucketCount)
+    TValue mDefault;
+};
+
+// ---------------------------------------------------------------------------
+// No user serviceable parts from here...
+// ---------------------------------------------------------------------------
+
+template <typename TKey, typename TValue>
+LinearHashMap<TKey, TValue>::LinearHashMap(const TValue& defValue) :
+        mCookies(0), mKeys(0), mValues(0), mSize(0), mBucketCount(0), mShift(32),
+        mDefault(defValue) {
+}
+
+template <typename TKey, typename TValue>
+LinearHashMap<TKey, TValue>::LinearHashMap(const LinearHashMap<TKey, TValue>& other) :
+        mCookies(0), mKeys(0), mValues(0), mSize(0), mBucketCount(0), mShift(32),
+        mDefault(other.mDefault) {
+    copyFrom(other);
+}
+
+template <typename TKey, typename TValue>
+LinearHashMap<TKey, TValue>::~LinearHashMap() {
+    release();
+}
+
+template <typename TKey, typename TValue>
+LinearHashMap<TKey, TValue>& LinearHashMap<TKey, TValue>::operator =(
+        const LinearHashMap<TKey, TValue>& other) {
+    if (this != &other) {
+        release();
+        mDefault = other.mDefault;
+        copyFrom(other);
+    }
+    return *this;
+}
+
+template <typename TKey, typename TValue>
+status_t LinearHashMap<TKey, TValue>::setCapacity(size_t capacity) {
+    size_t bucketCount = MIN_BUCKET_COUNT;
+    while ((bucketCount * 3) / 4 < capacity) {
+        bucketCount *= 2;
+    }
+    return bucketCount > mBucketCount ? rehash(bucketCount) : status_t(NO_ERROR);
+}
+
+template <typename TKey, typename TValue>
+ssize_t LinearHashMap<TKey, TValue>::indexOfKey(const TKey& key) const {
+    if (mSize == 0) {
+        return NAME_NOT_FOUND;
+    }
+    const uint32_t cookie = cookieFor(key);
+    const size_t mask = mBucketCount - 1;
+    size_t index = bucketFor(cookie);
+    for (size_t distance = 0; ; distance++) {
+        const uint32_t c = mCookies[index];
+        if (c == 0 || distanceAt(index) < distance) {
+            // the key would have been stored before this entry
+            return NAME_NOT_FOUND;
+        }
+        if (c == cookie && mKeys[index] == key) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+template <typename TKey, typename TValue>
+const TValue& LinearHashMap<TKey, TValue>::valueFor(const TKey& key) const {
+    ssize_t index = indexOfKey(key);
+    return index >= 0 ? mValues[index] : mDefault;
+}
+
+template <typename TKey, typename TValue>
+ssize_t LinearHashMap<TKey, TValue>::next(ssize_t index) const {
+    for (size_t i = index + 1; i < mBucketCount; i++) {
+        if (mCookies[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+template <typename TKey, typename TValue>
+ssize_t LinearHashMap<TKey, TValue>::add(const TKey& key, const TValue& value) {
+    if (mSize >= capacity()) {
+        ssize_t index = indexOfKey(key);
+        if (index >= 0) {
+            mValues[index] = value;
+            return index;
+        }
+        status_t err = rehash(mBucketCount ? mBucketCount * 2 : size_t(MIN_BUCKET_COUNT));
+        if (err != NO_ERROR) {
+            return err;
+        }
+    }
+
+    // look for the key in the same buckets as indexOfKey(), the new entry
+    // goes where that search ends
+    const uint32_t cookie = cookieFor(key);
+    const size_t mask = mBucketCount - 1;
+    size_t index = bucketFor(cookie);
+    for (size_t distance = 0; mCookies[index] && distanceAt(index) >= distance; distance++) {
+        if (mCookies[index] == cookie && mKeys[index] == key) {
+            mValues[index] = value;
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+    shiftRun(index);
+    new (&mKeys[index]) TKey(key);
+    new (&mValues[index]) TValue(value);
+    mCookies[index] = cookie;
+    mSize++;
+    return index;
+}
+
+template <typename TKey, typename TValue>
+ssize_t LinearHashMap<TKey, TValue>::removeItem(const TKey& key) {
+    ssize_t index = indexOfKey(key);
+    if (index < 0) {
+        return NAME_NOT_FOUND;
+    }
+    destroy_type(&mKeys[index], 1);
+    destroy_type(&mValues[index], 1);
+
+    // move the following entries of the run back, until one that is in its
+    // own bucket already
+    const size_t mask = mBucketCount - 1;
+    size_t hole = index;
+    size_t next = (hole + 1) & mask;
+    while (mCookies[next] && distanceAt(next) != 0) {
+        move_backward_type(&mKeys[hole], &mKeys[next], 1);
+        move_backward_type(&mValues[hole], &mValues[next], 1);
+        mCookies[hole] = mCookies[next];
+        hole = next;
+        next = (next + 1) & mask;
+    }
+    mCookies[hole] = 0;
+    mSize--;
+    return NO_ERROR;
+}
+
+template <typename TKey, typename TValue>
+void LinearHashMap<TKey, TValue>::clear() {
+    for (size_t i = 0; i < mBucketCount; i++) {
+        if (mCookies[i]) {
+            destroy_type(&mKeys[i], 1);
+            destroy_type(&mValues[i], 1);
+            mCookies[i] = 0;
+        }
+    }
+    mSize = 0;
+}
+
+template <typename TKey, typename TValue>
+size_t LinearHashMap<TKey, TValue>::makeRoom(uint32_t cookie) {
+    const size_t mask = mBucketCount - 1;
+    size_t index = bucketFor(cookie);
+    for (size_t distance = 0; mCookies[index] && distanceAt(index) >= distance; distance++) {
+        index = (index + 1) & mask;
+    }
+    shiftRun(index);
+    return index;
+}
+
+template <typename TKey, typename TValue>
+void LinearHashMap<TKey, TValue>::shiftRun(size_t index) {
+    const size_t mask = mBucketCount - 1;
+    size_t end = index;
+    while (mCookies[end]) {
+        end = (end + 1) & mask;
+    }
+    while (end != index) {
+        const size_t prev = (end - 1) & mask;
+        move_forward_type(&mKeys[end], &mKeys[prev], 1);
+        move_forward_type(&mValues[end], &mValues[prev], 1);
+        mCookies[end] = mCookies[prev];
+        end = prev;
+    }
+    mCookies[index] = 0;
+}
+
+template <typename TKey, typename TValue>
+status_t LinearHashMap<TKey, TValue>::rehash(size_t bucketCount) {
+    uint32_t* cookies = static_cast<uint32_t*>(calloc(bucketCount, sizeof(uint32_t)));
+    TKey* keys = static_cast<TKey*>(malloc(bucketCount * sizeof(TKey)));
+    TValue* values = static_cast<TValue*>(malloc(bucketCount * sizeof(TValue)));
+    if (!cookies || !keys || !values) {
+        free(cookies);
+        free(keys);
+        free(values);
+        return NO_MEMORY;
+    }
+
+    uint32_t* const oldCookies = mCookies;
+    TKey* const oldKeys = mKeys;
+    TValue* const oldValues = mValues;
+    const size_t oldBucketCount = mBucketCount;
+
+    mCookies = cookies;
+    mKeys = keys;
+    mValues = values;
+    mBucketCount = bucketCount;
+    mShift = 32;
+    while (bucketCount > 1) {
+        bucketCount >>= 1;
+        mShift--;
+    }
+
+    // the entries are moved, not copied, into the new buckets
+    for (size_t i = 0; i < oldBucketCount; i++) {
+        const uint32_t cookie = oldCookies[i];
+        if (cookie) {
+            const size_t index = makeRoom(cookie);
+            move_forward_type(&mKeys[index], &oldKeys[i], 1);
+            move_forward_type(&mValues[index], &oldValues[i], 1);
+            mCookies[index] = cookie;
+        }
+    }
+    free(oldCookies);
+    free(oldKeys);
+    free(oldValues);
+    return NO_ERROR;
+}
+
+template <typename TKey, typename TValue>
+void LinearHashMap<TKey, TValue>::copyFrom(const LinearHashMap<TKey, TValue>& other) {
+    if (other.mSize == 0 || rehash(other.mBucketCount) != NO_ERROR) {
+        return;
+    }
+    for (size_t i = 0; i < mBucketCount; i++) {
+        if (other.mCookies[i]) {
+            new (&mKeys[i]) TKey(other.mKeys[i]);
+            new (&mValues[i]) TValue(other.mValues[i]);
+            mCookies[i] = other.mCookies[i];
+        }
+    }
+    mSize = other.mSize;
+}
+
+template <typename TKey, typename TValue>
+void LinearHashMap<TKey, TValue>::release() {
+    clear();
+    free(mCookies);
+    free(mKeys);
+    free(mValues);
+    mCookies = 0;
+    mKeys = 0;
+    mValues = 0;
+    mBucketCount = 0;
+    mShift = 32;
+}
+
+}; // namespace android
+
+#endif // ANDROID_LINEAR_HASH_MAP_H
@@ -145,6 +145,15 @@ public:
      */
     bool getAllowNonCallbacks() const;
 
+    /**
+     * Sets how many file descriptor events a single poll can collect from epoll.
+     * Loopers monitoring many busy file descriptors wake up less often with a
+     * larger batch.  The default is 16.
+     *
+     * This method can be called on any thread.  It takes effect on the next poll.
+     */
+    void setEventBatchSize(int size);
+
     /**
      * Waits for events to be available, with optional timeout in milliseconds.
      * Invokes callbacks for all file descriptors on which an event occurred.
@@ -194,6 +203,16 @@ public:
      */
     void wake();
 
+    enum {
+        /**
+         * May be or'ed into the "events" of addFd() to report the file descriptor
+         * edge-triggered: an event is only reported again once new data arrives, even if
+         * the callback left some unread.  Callers must drain the file descriptor (until
+         * EAGAIN) on each event, otherwise they can stall.
+         */
+        EVENT_EDGE_TRIGGERED = 1 << 16,
+    };
+
     /**
      * Adds a new file descriptor to be polled by the looper.
      * If the same file descriptor was previously added, it is replaced.
@@ -201,7 +220,8 @@ public:
      * "fd" is the file descriptor to be added.
      * "ident" is an identifier for this event, which is returned from pollOnce().
      * The identifier must be >= 0, or ALOOPER_POLL_CALLBACK if providing a non-NULL callback.
-     * "events" are the poll events to wake up on.  Typically this is ALOOPER_EVENT_INPUT.
+     * "events" are the poll events to wake up on.  Typically this is ALOOPER_EVENT_INPUT,
+     * optionally with EVENT_EDGE_TRIGGERED.
      * "callback" is the function to call when there is an event on the file descriptor.
      * "data" is a private data pointer to supply to the callback.
      *
@@ -321,7 +341,9 @@ public:
 
 private:
     struct Request {
-        int fd;
+        Request() : fd(-1), ident(0), data(NULL) { }
+
+        int fd; // -1 for the unused entries of mRequests
         int ident;
         sp<LooperCallback> callback;
         void* data;
@@ -333,39 +355,63 @@ private:
     };
 
     struct MessageEnvelope {
-        MessageEnvelope() : uptime(0) { }
+        MessageEnvelope(nsecs_t uptime, uint64_t seq, const sp<MessageHandler> handler,
+                const Message& message) : uptime(uptime), seq(seq), handler(handler),
+                message(message), heapIndex(0), prevForHandler(NULL), nextForHandler(NULL) {
+        }
 
-        MessageEnvelope(nsecs_t uptime, const sp<MessageHandler> handler,
-                const Message& message) : uptime(uptime), handler(handler), message(message) {
+        inline bool isBefore(const MessageEnvelope* other) const {
+            return uptime < other->uptime || (uptime == other->uptime && seq < other->seq);
         }
 
         nsecs_t uptime;
+        uint64_t seq; // orders the messages sent for the same uptime
         sp<MessageHandler> handler;
         Message message;
+
+        size_t heapIndex;
+        // the other messages of the same handler
+        MessageEnvelope* prevForHandler;
+        MessageEnvelope* nextForHandler;
     };
 
     const bool mAllowNonCallbacks; // immutable
 
+    // The same eventfd when available, otherwise the two ends of a pipe.
     int mWakeReadPipeFd;  // immutable
     int mWakeWritePipeFd; // immutable
     Mutex mLock;
 
-    Vector<MessageEnvelope> mMessageEnvelopes; // guarded by mLock
+    // Pending messages, in a binary min-heap on (uptime, seq). They are also
+    // linked per handler so that removeMessages() only visits those of its
+    // handler.
+    Vector<MessageEnvelope*> mMessageEnvelopes; // guarded by mLock
+    KeyedVector<MessageHandler*, MessageEnvelope*> mMessagesByHandler; // guarded by mLock
+    uint64_t mNextMessageSeq; // guarded by mLock
     bool mSendingMessage; // guarded by mLock
 
     int mEpollFd; // immutable
 
-    // Locked list of file descriptor monitoring requests.
-    KeyedVector<int, Request> mRequests;  // guarded by mLock
+    // Locked table of file descriptor monitoring requests, indexed by fd.
+    Vector<Request> mRequests;  // guarded by mLock
+    int mEventBatchSize; // guarded by mLock
 
     // This state is only used privately by pollOnce and does not require a lock since
     // it runs on a single thread.
+    // The responses are overwritten in place by each poll, only the first
+    // mResponseCount are valid.
     Vector<Response> mResponses;
+    size_t mResponseCount;
     size_t mResponseIndex;
+    Vector<struct epoll_event> mEventItems;
     nsecs_t mNextMessageUptime; // set to LLONG_MAX when none
 
     int pollInner(int timeoutMillis);
     void awoken();
+    void pushMessageLocked(MessageEnvelope* envelope);
+    void removeMessageLocked(MessageEnvelope* envelope);
+    void siftUpLocked(size_t index);
+    void siftDownLocked(size_t index);
     void pushResponse(int events, const Request& request);
 
     static void initTLSKey();
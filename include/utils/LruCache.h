@@ -17,18 +17,44 @@
 #ifndef ANDROID_UTILS_LRU_CACHE_H
 #define ANDROID_UTILS_LRU_CACHE_H
 
-#include <utils/BasicHashtable.h>
-#include <utils/GenerationCache.h>
-#include <utils/UniquePtr.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <utils/TypeHelpers.h>
 
 namespace android {
 
-// OnEntryRemoved is defined in GenerationCache.h, but maybe should move here.
+/**
+ * LruCache callback used when an item is removed
+ */
+template<typename EntryKey, typename EntryValue>
+class OnEntryRemoved {
+public:
+    virtual ~OnEntryRemoved() { };
+    virtual void operator()(EntryKey& key, EntryValue& value) = 0;
+}; // class OnEntryRemoved
 
+/*
+ * A cache of up to a maximum number of entries, which removes the least
+ * recently used entry to make room for a new one.
+ *
+ * The entries live in a slab of slots [0, size()): the keys, the values and
+ * the bookkeeping (hash chain and recency list links, as slot indices) each
+ * in an array of their own. Removing an entry moves the last one into its
+ * slot, so the slots stay contiguous. A cache with a maximum capacity
+ * allocates all its slots when it is constructed and put() never allocates;
+ * an unlimited cache doubles its slab as needed.
+ *
+ * References returned by get(), and slot indices, are only valid until the
+ * next put() or removal.
+ */
 template <typename TKey, typename TValue>
 class LruCache {
 public:
     explicit LruCache(uint32_t maxCapacity);
+    ~LruCache();
 
     enum Capacity {
         kUnlimitedCapacity,
@@ -42,14 +68,26 @@ public:
     bool removeOldest();
     void clear();
 
+    /* Returns the slot of the specified key, or -1, without making it the
+     * most recently used.
+     */
+    ssize_t indexOfKey(const TKey& key) const;
+
+    /* Access to the entry in the specified slot, in [0, size()). */
+    const TKey& keyAt(size_t index) const { return mKeys[index]; }
+    const TValue& valueAt(size_t index) const { return mValues[index]; }
+
+    /* Removes the entry in the specified slot, in [0, size()). */
+    void removeAt(size_t index);
+
     class Iterator {
     public:
         Iterator(const LruCache<TKey, TValue>& cache): mCache(cache), mIndex(-1) {
         }
 
         bool next() {
-            mIndex = mCache.mTable->next(mIndex);
-            return mIndex != -1;
+            mIndex++;
+            return size_t(mIndex) < mCache.size();
         }
 
         size_t index() const {
@@ -57,50 +95,71 @@ public:
         }
 
         const TValue& value() const {
-            return mCache.mTable->entryAt(mIndex).value;
+            return mCache.mValues[mIndex];
         }
 
         const TKey& key() const {
-            return mCache.mTable->entryAt(mIndex).key;
+            return mCache.mKeys[mIndex];
         }
     private:
         const LruCache<TKey, TValue>& mCache;
-        size_t mIndex;
+        ssize_t mIndex;
     };
 
 private:
     LruCache(const LruCache& that);  // disallow copy constructor
 
-    struct Entry {
-        TKey key;
-        TValue value;
-        Entry* parent;
-        Entry* child;
+    enum { MIN_CAPACITY = 8 };
 
-        Entry(TKey key_, TValue value_) : key(key_), value(value_), parent(NULL), child(NULL) {
-        }
-        const TKey& getKey() const { return key; }
+    // The bookkeeping of a slot. All links are slot indices, -1 for none.
+    struct Slot {
+        hash_t hash;
+        int32_t chainNext;  // next slot in the same bucket
+        int32_t older;      // next less recently used slot
+        int32_t younger;    // next more recently used slot
     };
 
-    void attachToCache(Entry& entry);
-    void detachFromCache(Entry& entry);
-    void rehash(size_t newCapacity);
+    inline size_t bucketFor(hash_t hash) const {
+        return (uint32_t(hash) * 0x9E3779B9U) >> mShift;
+    }
 
-    UniquePtr<BasicHashtable<TKey, Entry> > mTable;
-    OnEntryRemoved<TKey, TValue>* mListener;
-    Entry* mOldest;
-    Entry* mYoungest;
+    ssize_t find(const TKey& key, hash_t hash) const;
+    void attachToCache(int32_t index);
+    void detachFromCache(int32_t index);
+    // Points whatever links to slot 'from' at slot 'to' instead.
+    void relink(int32_t from, int32_t to);
+    bool grow(size_t newCapacity);
+    void release();
+
+    TKey* mKeys;
+    TValue* mValues;
+    Slot* mSlots;
+    int32_t* mBuckets;      // first slot of each bucket's chain, or -1
+    size_t mSize;
+    size_t mCapacity;       // number of slots, and of buckets
+    uint32_t mShift;        // 32 - log2(mCapacity)
+    int32_t mOldest;
+    int32_t mYoungest;
     uint32_t mMaxCapacity;
+    OnEntryRemoved<TKey, TValue>* mListener;
     TValue mNullValue;
 };
 
 // Implementation is here, because it's fully templated
 template <typename TKey, typename TValue>
-LruCache<TKey, TValue>::LruCache(uint32_t maxCapacity): mMaxCapacity(maxCapacity),
-    mNullValue(NULL), mTable(new BasicHashtable<TKey, Entry>), mYoungest(NULL), mOldest(NULL),
-    mListener(NULL) {
+LruCache<TKey, TValue>::LruCache(uint32_t maxCapacity): mKeys(NULL), mValues(NULL),
+    mSlots(NULL), mBuckets(NULL), mSize(0), mCapacity(0), mShift(32), mOldest(-1),
+    mYoungest(-1), mMaxCapacity(maxCapacity), mListener(NULL), mNullValue(NULL) {
+    if (mMaxCapacity != kUnlimitedCapacity) {
+        grow(mMaxCapacity);
+    }
 };
 
+template <typename TKey, typename TValue>
+LruCache<TKey, TValue>::~LruCache() {
+    release();
+}
+
 template<typename K, typename V>
 void LruCache<K, V>::setOnEntryRemovedListener(OnEntryRemoved<K, V>* listener) {
     mListener = listener;
@@ -108,20 +167,38 @@ void LruCache<K, V>::setOnEntryRemovedListener(OnEntryRemoved<K, V>* listener) {
 
 template <typename TKey, typename TValue>
 size_t LruCache<TKey, TValue>::size() const {
-    return mTable->size();
+    return mSize;
+}
+
+template <typename TKey, typename TValue>
+ssize_t LruCache<TKey, TValue>::find(const TKey& key, hash_t hash) const {
+    if (mSize == 0) {
+        return -1;
+    }
+    for (int32_t i = mBuckets[bucketFor(hash)]; i >= 0; i = mSlots[i].chainNext) {
+        if (mSlots[i].hash == hash && mKeys[i] == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+template <typename TKey, typename TValue>
+ssize_t LruCache<TKey, TValue>::indexOfKey(const TKey& key) const {
+    return find(key, hash_type(key));
 }
 
 template <typename TKey, typename TValue>
 const TValue& LruCache<TKey, TValue>::get(const TKey& key) {
-    hash_t hash = hash_type(key);
-    ssize_t index = mTable->find(-1, hash, key);
-    if (index == -1) {
+    ssize_t index = find(key, hash_type(key));
+    if (index < 0) {
         return mNullValue;
     }
-    Entry& entry = mTable->editEntryAt(index);
-    detachFromCache(entry);
-    attachToCache(entry);
-    return entry.value;
+    if (index != mYoungest) {
+        detachFromCache(index);
+        attachToCache(index);
+    }
+    return mValues[index];
 }
 
 template <typename TKey, typename TValue>
@@ -131,43 +208,66 @@ bool LruCache<TKey, TValue>::put(const TKey& key, const TValue& value) {
     }
 
     hash_t hash = hash_type(key);
-    ssize_t index = mTable->find(-1, hash, key);
-    if (index >= 0) {
+    if (find(key, hash) >= 0) {
         return false;
     }
-    if (!mTable->hasMoreRoom()) {
-        rehash(mTable->capacity() * 2);
+    if (mSize == mCapacity && !grow(mCapacity ? mCapacity * 2 : size_t(MIN_CAPACITY))) {
+        return false;
     }
 
-    // Would it be better to initialize a blank entry and assign key, value?
-    Entry initEntry(key, value);
-    index = mTable->add(hash, initEntry);
-    Entry& entry = mTable->editEntryAt(index);
-    attachToCache(entry);
+    const int32_t index = mSize++;
+    new (&mKeys[index]) TKey(key);
+    new (&mValues[index]) TValue(value);
+    Slot& slot = mSlots[index];
+    slot.hash = hash;
+    int32_t& bucket = mBuckets[bucketFor(hash)];
+    slot.chainNext = bucket;
+    bucket = index;
+    attachToCache(index);
     return true;
 }
 
 template <typename TKey, typename TValue>
 bool LruCache<TKey, TValue>::remove(const TKey& key) {
-    hash_t hash = hash_type(key);
-    ssize_t index = mTable->find(-1, hash, key);
+    ssize_t index = find(key, hash_type(key));
     if (index < 0) {
         return false;
     }
-    Entry& entry = mTable->editEntryAt(index);
+    removeAt(index);
+    return true;
+}
+
+template <typename TKey, typename TValue>
+void LruCache<TKey, TValue>::removeAt(size_t index) {
     if (mListener) {
-        (*mListener)(entry.key, entry.value);
+        (*mListener)(mKeys[index], mValues[index]);
+    }
+
+    // unlink the slot from its hash chain and from the recency list
+    int32_t* link = &mBuckets[bucketFor(mSlots[index].hash)];
+    while (*link != int32_t(index)) {
+        link = &mSlots[*link].chainNext;
+    }
+    *link = mSlots[index].chainNext;
+    detachFromCache(index);
+    destroy_type(&mKeys[index], 1);
+    destroy_type(&mValues[index], 1);
+
+    // fill the hole with the last slot
+    const int32_t last = --mSize;
+    if (int32_t(index) != last) {
+        relink(last, index);
+        move_backward_type(&mKeys[index], &mKeys[last], 1);
+        move_backward_type(&mValues[index], &mValues[last], 1);
+        mSlots[index] = mSlots[last];
     }
-    detachFromCache(entry);
-    mTable->removeAt(index);
-    return true;
 }
 
 template <typename TKey, typename TValue>
 bool LruCache<TKey, TValue>::removeOldest() {
-    if (mOldest != NULL) {
-        return remove(mOldest->key);
-        // TODO: should probably abort if false
+    if (mOldest >= 0) {
+        removeAt(mOldest);
+        return true;
     }
     return false;
 }
@@ -175,54 +275,123 @@ bool LruCache<TKey, TValue>::removeOldest() {
 template <typename TKey, typename TValue>
 void LruCache<TKey, TValue>::clear() {
     if (mListener) {
-        for (Entry* p = mOldest; p != NULL; p = p->child) {
-            (*mListener)(p->key, p->value);
+        for (int32_t i = mOldest; i >= 0; i = mSlots[i].younger) {
+            (*mListener)(mKeys[i], mValues[i]);
         }
     }
-    mYoungest = NULL;
-    mOldest = NULL;
-    mTable->clear();
+    destroy_type(mKeys, mSize);
+    destroy_type(mValues, mSize);
+    if (mBuckets) {
+        memset(mBuckets, 0xff, mCapacity * sizeof(int32_t));
+    }
+    mSize = 0;
+    mOldest = -1;
+    mYoungest = -1;
 }
 
 template <typename TKey, typename TValue>
-void LruCache<TKey, TValue>::attachToCache(Entry& entry) {
-    if (mYoungest == NULL) {
-        mYoungest = mOldest = &entry;
+void LruCache<TKey, TValue>::attachToCache(int32_t index) {
+    Slot& slot = mSlots[index];
+    slot.older = mYoungest;
+    slot.younger = -1;
+    if (mYoungest < 0) {
+        mOldest = index;
     } else {
-        entry.parent = mYoungest;
-        mYoungest->child = &entry;
-        mYoungest = &entry;
+        mSlots[mYoungest].younger = index;
     }
+    mYoungest = index;
 }
 
 template <typename TKey, typename TValue>
-void LruCache<TKey, TValue>::detachFromCache(Entry& entry) {
-    if (entry.parent != NULL) {
-        entry.parent->child = entry.child;
+void LruCache<TKey, TValue>::detachFromCache(int32_t index) {
+    const Slot& slot = mSlots[index];
+    if (slot.older >= 0) {
+        mSlots[slot.older].younger = slot.younger;
     } else {
-        mOldest = entry.child;
+        mOldest = slot.younger;
     }
-    if (entry.child != NULL) {
-        entry.child->parent = entry.parent;
+    if (slot.younger >= 0) {
+        mSlots[slot.younger].older = slot.older;
     } else {
-        mYoungest = entry.parent;
+        mYoungest = slot.older;
     }
+}
 
-    entry.parent = NULL;
-    entry.child = NULL;
+template <typename TKey, typename TValue>
+void LruCache<TKey, TValue>::relink(int32_t from, int32_t to) {
+    const Slot& slot = mSlots[from];
+    int32_t* link = &mBuckets[bucketFor(slot.hash)];
+    while (*link != from) {
+        link = &mSlots[*link].chainNext;
+    }
+    *link = to;
+    if (slot.older >= 0) {
+        mSlots[slot.older].younger = to;
+    } else {
+        mOldest = to;
+    }
+    if (slot.younger >= 0) {
+        mSlots[slot.younger].older = to;
+    } else {
+        mYoungest = to;
+    }
 }
 
 template <typename TKey, typename TValue>
-void LruCache<TKey, TValue>::rehash(size_t newCapacity) {
-    UniquePtr<BasicHashtable<TKey, Entry> > oldTable(mTable.release());
-    Entry* oldest = mOldest;
+bool LruCache<TKey, TValue>::grow(size_t newCapacity) {
+    size_t capacity = MIN_CAPACITY;
+    uint32_t shift = 32 - 3;
+    while (capacity < newCapacity) {
+        capacity *= 2;
+        shift--;
+    }
+    TKey* keys = static_cast<TKey*>(malloc(capacity * sizeof(TKey)));
+    TValue* values = static_cast<TValue*>(malloc(capacity * sizeof(TValue)));
+    Slot* slots = static_cast<Slot*>(malloc(capacity * sizeof(Slot)));
+    int32_t* buckets = static_cast<int32_t*>(malloc(capacity * sizeof(int32_t)));
+    if (!keys || !values || !slots || !buckets) {
+        free(keys);
+        free(values);
+        free(slots);
+        free(buckets);
+        return false;
+    }
 
-    mOldest = NULL;
-    mYoungest = NULL;
-    mTable.reset(new BasicHashtable<TKey, Entry>(newCapacity));
-    for (Entry* p = oldest; p != NULL; p = p->child) {
-        put(p->key, p->value);
+    // the entries keep their slots, only the hash chains are rebuilt; the
+    // arrays are still NULL on the first grow
+    if (mSize) {
+        move_forward_type(keys, mKeys, mSize);
+        move_forward_type(values, mValues, mSize);
+        memcpy(slots, mSlots, mSize * sizeof(Slot));
     }
+    free(mKeys);
+    free(mValues);
+    free(mSlots);
+    free(mBuckets);
+    mKeys = keys;
+    mValues = values;
+    mSlots = slots;
+    mBuckets = buckets;
+    mCapacity = capacity;
+    mShift = shift;
+
+    memset(mBuckets, 0xff, mCapacity * sizeof(int32_t));
+    for (size_t i = 0; i < mSize; i++) {
+        int32_t& bucket = mBuckets[bucketFor(mSlots[i].hash)];
+        mSlots[i].chainNext = bucket;
+        bucket = i;
+    }
+    return true;
+}
+
+template <typename TKey, typename TValue>
+void LruCache<TKey, TValue>::release() {
+    destroy_type(mKeys, mSize);
+    destroy_type(mValues, mSize);
+    free(mKeys);
+    free(mValues);
+    free(mSlots);
+    free(mBuckets);
 }
 
 }
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PROFILER_H
+#define ANDROID_PROFILER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <cutils/compiler.h>
+#include <utils/String8.h>
+
+// ---------------------------------------------------------------------------
+
+/*
+ * Profiles the enclosing scope, under the scopes enclosing it on the same
+ * thread.  name must outlive the process, a string literal typically: scopes
+ * are told apart by the address of their name.
+ */
+#define PROFILE_SCOPE(name) \
+    ::android::ScopedProfile PROFILE_VARIABLE(__LINE__)(name)
+
+#define PROFILE_VARIABLE(line) PROFILE_VARIABLE_(line)
+#define PROFILE_VARIABLE_(line) ___profile##line
+
+// Profiles the enclosing function
+#define PROFILE_CALL() PROFILE_SCOPE(__FUNCTION__)
+
+namespace android {
+
+/*
+ * A hierarchical profiler, for finding where the time goes in a service in
+ * the field, without a trace capture.
+ *
+ * Each thread aggregates the PROFILE_SCOPE()s it runs through into a tree:
+ * a scope entered from two different parents gets a node under each.  Every
+ * node counts the runs of its scope and their total, self (not spent in
+ * child scopes), min and max times, as measured by profilingTime().
+ *
+ * Profiling is off until setEnabled(true), and then costs a load per scope.
+ * dump() formats the trees of all the live threads that profiled anything,
+ * for inclusion in a service's dump().  A thread's tree is freed when it
+ * exits.
+ */
+class Profiler {
+public:
+    static inline bool isEnabled() {
+        return sEnabled;
+    }
+
+    static void setEnabled(bool enabled);
+
+    /* Appends the trees of all the threads to result, one line per node. */
+    static void dump(String8& result, const char* prefix = "");
+
+    /* Zeroes all the counts, keeping the trees. */
+    static void reset();
+
+    /* Called by ScopedProfile. */
+    static void enter(const char* name);
+    static void exit();
+
+private:
+    static volatile bool sEnabled;
+};
+
+class ScopedProfile {
+public:
+    inline ScopedProfile(const char* name)
+        : mEntered(Profiler::isEnabled()) {
+        if (CC_UNLIKELY(mEntered)) {
+            Profiler::enter(name);
+        }
+    }
+
+    inline ~ScopedProfile() {
+        // whether profiling was enabled meanwhile or not
+        if (CC_UNLIKELY(mEntered)) {
+            Profiler::exit();
+        }
+    }
+
+private:
+    const bool mEntered;
+};
+
+}; // namespace android
+
+// ---------------------------------------------------------------------------
+
+#endif // ANDROID_PROFILER_H
@@ -17,7 +17,7 @@
 #ifndef _UTILS_PROPERTY_MAP_H
 #define _UTILS_PROPERTY_MAP_H
 
-#include <utils/KeyedVector.h>
+#include <utils/LinearHashMap.h>
 #include <utils/String8.h>
 #include <utils/Errors.h>
 #include <utils/Tokenizer.h>
@@ -43,6 +43,9 @@ namespace android {
  *
  * The file must not contain duplicate keys.
  *
+ * The properties are kept in a hash map, so looking one up costs the same
+ * however many there are.
+ *
  * TODO Support escape sequences and quoted values when needed.
  */
 class PropertyMap {
@@ -75,7 +78,7 @@ public:
     void addAll(const PropertyMap* map);
 
     /* Gets the underlying property map. */
-    inline const KeyedVector<String8, String8>& getProperties() const { return mProperties; }
+    inline const LinearHashMap<String8, String8>& getProperties() const { return mProperties; }
 
     /* Loads a property map from a file. */
     static status_t load(const String8& filename, PropertyMap** outMap);
@@ -98,7 +101,7 @@ private:
         status_t parseCharacterLiteral(char16_t* outCharacter);
     };
 
-    KeyedVector<String8, String8> mProperties;
+    LinearHashMap<String8, String8> mProperties;
 };
 
 } // namespace android
@@ -102,7 +102,8 @@ public:
         // for proper use.
         bool                attemptIncWeak(const void* id);
 
-        //! DEBUGGING ONLY: Get current weak ref count.
+        //! DEBUGGING ONLY: Get current weak ref count. All the strong
+        //! references together count as a single weak reference.
         int32_t             getWeakCount() const;
 
         //! DEBUGGING ONLY: Print references held on object.
@@ -212,6 +213,15 @@ private:
     mutable volatile int32_t mCount;
 };
 
+// LightRefBase for class hierarchies: the count lives in the object and
+// only the strong count is updated, but the object is deleted through its
+// virtual destructor, so that sp<> of any subclass can be used. Such objects
+// can't be referenced by a wp<>.
+class VirtualLightRefBase : public LightRefBase<VirtualLightRefBase> {
+public:
+    virtual ~VirtualLightRefBase() { }
+};
+
 // ---------------------------------------------------------------------------
 
 template <typename T>
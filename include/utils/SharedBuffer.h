@@ -87,6 +87,31 @@ public:
     //! returns wether or not we're the only owner
     inline          bool                    onlyOwner() const;
     
+    /*! heap traffic of all SharedBuffers, counted when libutils is built
+     * with SHARED_BUFFER_POOL, which also recycles buffers of up to
+     * MAX_POOLED_SIZE bytes in per-thread caches instead of freeing them.
+     */
+    enum {
+        MAX_POOLED_SIZE = 256
+    };
+
+    struct Stats {
+        uint32_t    allocs;         // alloc() and copies made by edits
+        uint32_t    pooledAllocs;   // ... of which reused a cached buffer
+        uint32_t    resizes;        // editResize() of an owned buffer
+        uint32_t    pooledResizes;  // ... of which fit in its size class
+        uint32_t    frees;
+        uint32_t    pooledFrees;    // ... of which went to a cache
+        // calls to malloc(), realloc() and free(): what the pool saves
+        inline uint32_t heapCalls() const {
+            return (allocs - pooledAllocs) + (resizes - pooledResizes) +
+                    (frees - pooledFrees);
+        }
+    };
+
+    //! returns false, and zeroes stats, without SHARED_BUFFER_POOL
+    static          bool                    getStats(Stats* stats);
+
 
 private:
         inline SharedBuffer() { }
@@ -94,7 +119,15 @@ private:
         SharedBuffer(const SharedBuffer&);
         SharedBuffer& operator = (const SharedBuffer&);
  
+        // where buffers come from and go back to: the heap, or the
+        // caches of SHARED_BUFFER_POOL
+        static  SharedBuffer*   allocStorage(size_t size);
+        static  SharedBuffer*   resizeStorage(SharedBuffer* sb, size_t size);
+        static  void            freeStorage(const SharedBuffer* sb);
+
         // 16 bytes. must be sized to preserve correct alignment.
+        // with SHARED_BUFFER_POOL, mReserved[0] is the size class + 1 of
+        // pooled buffers, 0 for the others.
         mutable int32_t        mRefs;
                 size_t         mSize;
                 uint32_t       mReserved[2];
@@ -22,6 +22,8 @@
 #include <utils/Unicode.h>
 #include <utils/TypeHelpers.h>
 
+#include <string.h>
+
 // ---------------------------------------------------------------------------
 
 extern "C" {
@@ -183,12 +185,19 @@ inline bool String16::operator<=(const String16& other) const
 
 inline bool String16::operator==(const String16& other) const
 {
-    return strzcmp16(mString, size(), other.mString, other.size()) == 0;
+    // Copies of a string share its buffer, so comparing an interface
+    // descriptor with itself or a copy of it doesn't look at the characters.
+    if (mString == other.mString) {
+        return true;
+    }
+    const size_t len = size();
+    return len == other.size()
+            && memcmp(mString, other.mString, len * sizeof(char16_t)) == 0;
 }
 
 inline bool String16::operator!=(const String16& other) const
 {
-    return strzcmp16(mString, size(), other.mString, other.size()) != 0;
+    return !operator==(other);
 }
 
 inline bool String16::operator>=(const String16& other) const
@@ -18,6 +18,7 @@
 #define ANDROID_STRING8_H
 
 #include <utils/Errors.h>
+#include <utils/FastHash.h>
 #include <utils/SharedBuffer.h>
 #include <utils/Unicode.h>
 #include <utils/TypeHelpers.h>
@@ -214,6 +215,9 @@ public:
     String8& convertToResPath();
 
 private:
+    // String8Builder::release() hands its buffer over to a String8
+    friend class String8Builder;
+
             status_t            real_append(const char* other, size_t numChars);
             char*               find_extension(void) const;
 
@@ -224,6 +228,11 @@ private:
 // require any change to the underlying SharedBuffer contents or reference count.
 ANDROID_TRIVIAL_MOVE_TRAIT(String8)
 
+// String8 can be the key of the hashed containers, e.g. LinearHashMap.
+template <> inline hash_t hash_type(const String8& value) {
+    return FastHash(value.string(), value.length());
+}
+
 TextOutput& operator<<(TextOutput& to, const String16& val);
 
 // ---------------------------------------------------------------------------
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_STRING8_BUILDER_H
+#define ANDROID_STRING8_BUILDER_H
+
+#include <stdarg.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/String8.h>
+
+namespace android {
+
+class SharedBuffer;
+
+/*
+ * Assembles a string out of many appends, such as a dump() report.
+ *
+ * A String8 is exactly as large as its contents, so every append
+ * reallocates it and appendFormat() has to size the output first.  A
+ * builder keeps spare capacity instead, grown geometrically, and formats
+ * straight into it: vsnprintf() only runs twice when the output doesn't fit.
+ *
+ * The builder can start in caller-provided storage, typically on the
+ * stack (see StackString8Builder), and only moves to the heap when that
+ * storage is full.  The heap storage is a SharedBuffer, which release()
+ * hands over to a String8 without copying it.
+ */
+class String8Builder {
+public:
+    String8Builder();
+    /* Builds in the size bytes at storage until they are full. */
+    String8Builder(char* storage, size_t size);
+    ~String8Builder();
+
+    /* Makes room for a string of capacity bytes, not counting the NUL. */
+    status_t reserve(size_t capacity);
+
+    status_t append(const char* other);
+    status_t append(const char* other, size_t numChars);
+    status_t append(const String8& other);
+    status_t append(char c);
+
+    status_t appendFormat(const char* fmt, ...)
+            __attribute__((format (printf, 2, 3)));
+    status_t appendFormatV(const char* fmt, va_list args);
+
+    /* Empties the string, keeping the capacity. */
+    void clear();
+
+    /* Always NUL-terminated. */
+    inline const char* string() const { return mData; }
+    inline size_t size() const { return mLength; }
+    inline size_t length() const { return mLength; }
+    inline bool isEmpty() const { return mLength == 0; }
+    inline size_t capacity() const { return mCapacity; }
+
+    /* Returns a copy of the string. */
+    String8 toString8() const;
+
+    /*
+     * Returns the string, without copying it if it is on the heap, and
+     * leaves the builder empty.
+     */
+    String8 release();
+
+private:
+    String8Builder(const String8Builder&);
+    String8Builder& operator=(const String8Builder&);
+
+    // makes room for extra more bytes past mLength
+    status_t grow(size_t extra);
+
+    char* mData;
+    size_t mLength;
+    // bytes mData can hold, not counting the NUL
+    size_t mCapacity;
+    // the heap storage mData points in, or NULL when it is the caller's
+    SharedBuffer* mBuffer;
+    char* const mStorage;
+    const size_t mStorageSize;
+};
+
+/* A String8Builder starting with N bytes of storage of its own. */
+template <size_t N>
+class StackString8Builder : public String8Builder {
+public:
+    StackString8Builder() : String8Builder(mStackStorage, N) { }
+
+private:
+    char mStackStorage[N];
+};
+
+}; // namespace android
+
+#endif // ANDROID_STRING8_BUILDER_H
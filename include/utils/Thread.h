@@ -48,6 +48,14 @@ public:
     virtual status_t    run(    const char* name = 0,
                                 int32_t priority = PRIORITY_DEFAULT,
                                 size_t stack = 0);
+
+    // Same as above, also applying the CPU affinity, real-time policy and
+    // scheduling group in sched to the new thread before readyToRun().
+    // Not supported on the host, where sched is ignored.
+            status_t    run(    const char* name,
+                                int32_t priority,
+                                size_t stack,
+                                const android_thread_sched_t& sched);
     
     // Ask this object's thread to exit. This function is asynchronous, when the
     // function returns the thread might still be running. Of course, this
@@ -91,6 +99,8 @@ private:
 private:
     Thread& operator=(const Thread&);
     static  int             _threadLoop(void* user);
+            status_t        startThread(const char* name, int32_t priority,
+                                        size_t stack, const android_thread_sched_t* sched);
     const   bool            mCanCallJava;
     // always hold mLock when reading or writing
             thread_id_t     mThread;
@@ -101,6 +111,9 @@ private:
     volatile bool           mExitPending;
     volatile bool           mRunning;
             sp<Thread>      mHoldSelf;
+    // set by run() before the thread is created, read by the new thread
+            bool            mHasSched;
+            android_thread_sched_t mSched;
 #ifdef HAVE_ANDROID_OS
     // legacy for debugging, not used by getTid() as it is set by the child thread
     // and so is not initialized until the child reaches that point
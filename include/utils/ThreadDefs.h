@@ -79,6 +79,24 @@ enum {
     ANDROID_PRIORITY_LESS_FAVORABLE = +1,
 };
 
+/*
+ * Scheduling settings applied to a thread on top of its nice priority.
+ * Each field left at its default leaves that setting as inherited from
+ * the creating thread.
+ */
+typedef struct {
+    /* CPUs the thread may run on, one bit per CPU; 0 for any. */
+    uint32_t cpuMask;
+    /* SCHED_FIFO or SCHED_RR with rtPriority; SCHED_OTHER (0) for none. */
+    int policy;
+    int rtPriority;
+    /* A SchedPolicy from cutils/sched_policy.h selecting the thread's
+     * cgroup, or -1 (SP_DEFAULT) for none. */
+    int schedGroup;
+} android_thread_sched_t;
+
+#define ANDROID_THREAD_SCHED_INITIALIZER { 0, 0, 0, -1 }
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -79,7 +79,8 @@ enum {
     SYSTEM_TIME_MONOTONIC = 1, // monotonic time since unspecified starting point
     SYSTEM_TIME_PROCESS = 2,   // high-resolution per-process clock
     SYSTEM_TIME_THREAD = 3,    // high-resolution per-thread clock
-    SYSTEM_TIME_BOOTTIME = 4   // same as SYSTEM_TIME_MONOTONIC, but including CPU suspend time
+    SYSTEM_TIME_BOOTTIME = 4,  // same as SYSTEM_TIME_MONOTONIC, but including CPU suspend time
+    SYSTEM_TIME_MONOTONIC_COARSE = 5 // SYSTEM_TIME_MONOTONIC at tick resolution, for timeouts
 };
 
 // return the system-time according to the specified clock
@@ -89,6 +90,17 @@ nsecs_t systemTime(int clock = SYSTEM_TIME_MONOTONIC);
 nsecs_t systemTime(int clock);
 #endif // def __cplusplus
 
+/**
+ * Returns a monotonic time in nanoseconds read from the CPU's cycle counter,
+ * converted with a rate calibrated against SYSTEM_TIME_MONOTONIC on the first
+ * call.  It doesn't enter the kernel, which makes it the cheapest clock to
+ * time short sections of code with, but it drifts from SYSTEM_TIME_MONOTONIC
+ * and may not be synchronized across CPUs: use it for profiling only.
+ * Falls back to systemTime(SYSTEM_TIME_MONOTONIC) where the counter can't
+ * be read from user space.
+ */
+nsecs_t profilingTime(void);
+
 /**
  * Returns the number of milliseconds to wait between the reference time and the timeout time.
  * If the timeout is in the past relative to the reference time, returns 0.
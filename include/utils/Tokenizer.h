@@ -103,6 +103,14 @@ public:
      */
     String8 nextToken(const char* delimiters);
 
+    /**
+     * Same as nextToken() but returns the token in place instead of copying it:
+     * sets outLength to its length and returns a pointer to its first character
+     * in the tokenizer's buffer.  The token is not null-terminated and remains
+     * valid until the tokenizer is deleted.
+     */
+    const char* nextTokenInPlace(const char* delimiters, size_t* outLength);
+
     /**
      * Advances to the next line.
      * Does nothing if already at the end of the file.
@@ -27,6 +27,8 @@
 
 #include <cutils/compiler.h>
 #include <utils/threads.h>
+#include <utils/TraceBuffer.h>
+#include <utils/TraceTagMap.h>
 #include <cutils/trace.h>
 
 // See <cutils/trace.h> for more ATRACE_* macros.
@@ -37,22 +39,37 @@
 #define ATRACE_NAME(name) android::ScopedTrace ___tracer(ATRACE_TAG, name)
 // ATRACE_CALL is an ATRACE_NAME that uses the current function name.
 #define ATRACE_CALL() ATRACE_NAME(__FUNCTION__)
+//
+// While the in-process TraceBuffer is enabled, both record into it rather
+// than writing to the kernel's trace_marker; see <utils/TraceBuffer.h>.
+// Both also pick up tags atrace has just published; see <utils/TraceTagMap.h>.
 
 namespace android {
 
 class ScopedTrace {
 public:
 inline ScopedTrace(uint64_t tag, const char* name)
-    : mTag(tag) {
-    atrace_begin(mTag,name);
+    : mTag(tag), mBuffered(false) {
+    TraceTagMap::sync();
+    if (TraceBuffer::isEnabled() && atrace_is_tag_enabled(mTag)) {
+        mBuffered = true;
+        TraceBuffer::begin(name);
+    } else {
+        atrace_begin(mTag,name);
+    }
 }
 
 inline ~ScopedTrace() {
-    atrace_end(mTag);
+    if (mBuffered) {
+        TraceBuffer::end();
+    } else {
+        atrace_end(mTag);
+    }
 }
 
 private:
     uint64_t mTag;
+    bool mBuffered;
 };
 
 }; // namespace android
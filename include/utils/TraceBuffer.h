@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_TRACE_BUFFER_H
+#define ANDROID_TRACE_BUFFER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <cutils/compiler.h>
+#include <utils/Errors.h>
+#include <utils/Timers.h>
+
+namespace android {
+
+/*
+ * An in-process alternative to writing trace events to the kernel's
+ * trace_marker.
+ *
+ * While enabled, ScopedTrace (and so ATRACE_NAME and ATRACE_CALL) records its
+ * begin and end events here instead of making a write() system call for each
+ * of them.  Every thread appends to a ring of its own, so recording takes no
+ * lock; once a ring is full the oldest events are overwritten.
+ *
+ * drain() writes the recorded events as ftrace "tracing_mark_write" lines
+ * stamped with the monotonic clock, which atrace appends to the kernel trace
+ * so they show up on the same timeline.
+ *
+ * Recording is turned on by setting the debug.atrace.ringbuffer property
+ * while tracing is enabled (atrace -u does this).  When it is turned off
+ * again each process drains its rings to a file in DRAIN_DIR.
+ */
+class TraceBuffer {
+public:
+    enum {
+        /* Events kept per thread before the oldest are overwritten. */
+        RING_CAPACITY = 2048,
+        /* Longest event name kept, including the terminating NUL. */
+        MAX_NAME_LENGTH = 48,
+    };
+
+    /* Directory processes drain their rings to, one file per process. */
+    static const char* const DRAIN_DIR;
+
+    static inline bool isEnabled() {
+        return CC_UNLIKELY(sEnabled != 0);
+    }
+
+    /* Starts or stops recording events for all threads of the process. */
+    static void setEnabled(bool enabled);
+
+    /* Records the beginning of a slice on the calling thread. */
+    static void begin(const char* name);
+
+    /* Records the end of the calling thread's innermost slice. */
+    static void end();
+
+    /*
+     * Writes every recorded event to fd, then forgets them.
+     * Events recorded while this runs may or may not be written.
+     */
+    static status_t drain(int fd);
+
+    /* Drains to the process's file in DRAIN_DIR. */
+    static status_t drainToFile();
+
+    /*
+     * Re-reads debug.atrace.ringbuffer, turning recording on or off, and
+     * draining to a file when it is turned off.
+     */
+    static void updateFromProperty();
+
+private:
+    static volatile int32_t sEnabled;
+};
+
+}; // namespace android
+
+#endif // ANDROID_TRACE_BUFFER_H
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_TRACE_TAG_MAP_H
+#define ANDROID_TRACE_TAG_MAP_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <cutils/compiler.h>
+#include <utils/Errors.h>
+
+namespace android {
+
+/*
+ * The enabled trace tags, published by atrace in a small shared file that
+ * every process maps read-only.
+ *
+ * Processes otherwise only re-read debug.atrace.tags.enableflags when atrace
+ * pokes them with a SYSPROPS_TRANSACTION, which misses processes that
+ * aren't binder services.  Each publish() bumps a generation count, and
+ * sync(), which ScopedTrace calls, compares it with the one this process last
+ * saw: a single load when nothing changed.  When it did change, the callback
+ * set with setChangeCallback() re-reads the trace properties.
+ *
+ * Processes started before atrace first created the file attach to it the
+ * next time they are poked.
+ */
+class TraceTagMap {
+public:
+    /* The file atrace publishes the tags in. */
+    static const char* const PATH;
+
+    /* Maps the file at path, if atrace has created it. */
+    static status_t attach(const char* path = PATH);
+
+    /* Stops following the file; sync() does nothing until attach(). */
+    static void detach();
+
+    static inline bool isAttached() {
+        return sMap != NULL;
+    }
+
+    /* Sets the function sync() calls when new tags have been published. */
+    static void setChangeCallback(void (*callback)());
+
+    /* Calls the change callback if tags were published since the last call. */
+    static inline void sync() {
+        const Header* map = sMap;
+        if (CC_UNLIKELY(map != NULL && map->generation != sGeneration)) {
+            refresh();
+        }
+    }
+
+    /*
+     * Returns the tags last published, or 0 if no file is attached.  If a
+     * publish() doesn't complete, its publisher died say, returns the tags
+     * read before it.
+     */
+    static uint64_t getTags();
+
+    /*
+     * Writes tags to the file at path, creating it readable by everyone if
+     * needed, and bumps the generation so every attached process notices.
+     */
+    static status_t publish(uint64_t tags, const char* path = PATH);
+
+private:
+    struct Header {
+        uint32_t magic;
+        volatile int32_t generation;
+        // 64-bit stores aren't single-copy atomic everywhere, so getTags()
+        // re-reads them until the generation is stable.
+        volatile uint32_t tagsLow;
+        volatile uint32_t tagsHigh;
+    };
+
+    static void refresh();
+
+    static const Header* volatile sMap;
+    static volatile int32_t sGeneration;
+};
+
+}; // namespace android
+
+#endif // ANDROID_TRACE_TAG_MAP_H
@@ -114,6 +114,12 @@ public:
             TYPE&           editItemAt(size_t index);
     //! grants right access to the top of the stack (last element)
             TYPE&           editTop();
+    //! inserts an item initialized with its default constructor at a given
+    //! index and grants write access to it, so it can be filled in place
+    //! instead of being copied from a temporary
+            TYPE&           emplaceAt(size_t index);
+    //! same as emplaceAt(size())
+            TYPE&           emplace();
 
             /*! 
              * append/insert another vector
@@ -220,7 +226,8 @@ Vector<TYPE>::Vector()
     : VectorImpl(sizeof(TYPE),
                 ((traits<TYPE>::has_trivial_ctor   ? HAS_TRIVIAL_CTOR   : 0)
                 |(traits<TYPE>::has_trivial_dtor   ? HAS_TRIVIAL_DTOR   : 0)
-                |(traits<TYPE>::has_trivial_copy   ? HAS_TRIVIAL_COPY   : 0))
+                |(traits<TYPE>::has_trivial_copy   ? HAS_TRIVIAL_COPY   : 0)
+                |(traits<TYPE>::has_trivial_move   ? HAS_TRIVIAL_MOVE   : 0))
                 )
 {
 }
@@ -303,6 +310,16 @@ TYPE& Vector<TYPE>::editTop() {
     return *( static_cast<TYPE *>(editItemLocation(size()-1)) );
 }
 
+template<class TYPE> inline
+TYPE& Vector<TYPE>::emplaceAt(size_t index) {
+    return *( static_cast<TYPE *>(editItemLocation(VectorImpl::insertAt(index, 1))) );
+}
+
+template<class TYPE> inline
+TYPE& Vector<TYPE>::emplace() {
+    return emplaceAt(size());
+}
+
 template<class TYPE> inline
 ssize_t Vector<TYPE>::insertVectorAt(const Vector<TYPE>& vector, size_t index) {
     return VectorImpl::insertVectorAt(reinterpret_cast<const VectorImpl&>(vector), index);
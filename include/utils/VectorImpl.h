@@ -44,6 +44,7 @@ public:
         HAS_TRIVIAL_CTOR    = 0x00000001,
         HAS_TRIVIAL_DTOR    = 0x00000002,
         HAS_TRIVIAL_COPY    = 0x00000004,
+        HAS_TRIVIAL_MOVE    = 0x00000008,
     };
 
                             VectorImpl(size_t itemSize, uint32_t flags);
@@ -120,6 +121,13 @@ private:
         void* _grow(size_t where, size_t amount);
         void  _shrink(size_t where, size_t amount);
 
+        // When no other vector shares the storage, growing and shrinking
+        // relocate the items into the new buffer instead of copying them
+        // and destroying the originals.
+        bool  _can_relocate() const;
+        void  _do_transfer(void* dest, const void* from, size_t num, bool relocate) const;
+        void  _release_storage(bool relocated);
+
         inline void _do_construct(void* storage, size_t num) const;
         inline void _do_destroy(void* storage, size_t num) const;
         inline void _do_copy(void* dest, const void* from, size_t num) const;
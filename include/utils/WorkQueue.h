@@ -18,6 +18,7 @@
 #define _LIBS_UTILS_WORK_QUEUE_H
 
 #include <utils/Errors.h>
+#include <utils/Timers.h>
 #include <utils/Vector.h>
 #include <utils/threads.h>
 
@@ -30,6 +31,14 @@ namespace android {
  * units in parallel, using up to the specified number of threads.
  * To use it, write a loop to post work units to the work queue, then synchronize
  * on the queue at the end.
+ *
+ * Each work thread has its own queue of pending work units, so the threads
+ * don't all contend for one lock.  Work units posted from outside the work
+ * queue are spread across the threads' queues; a work unit posting more work
+ * puts it at the front of its own thread's queue.  A thread with nothing left
+ * to do steals the oldest work unit from another thread's queue.  Work units
+ * of a higher priority run before any of a lower priority, wherever they
+ * were queued.
  */
 class WorkQueue {
 public:
@@ -46,6 +55,27 @@ public:
         virtual bool run() = 0;
     };
 
+    /* Priorities of work units, from the most to the least urgent. */
+    enum WorkPriority {
+        WORK_PRIORITY_HIGH = 0,
+        WORK_PRIORITY_NORMAL,
+        WORK_PRIORITY_LOW,
+
+        NUM_WORK_PRIORITIES
+    };
+
+    /* How much one work thread has been used. */
+    struct ThreadStats {
+        /* Work units run by the thread. */
+        size_t workUnitsRun;
+        /* Of those, how many were taken from other threads' queues. */
+        size_t workUnitsStolen;
+        /* Time spent running work units. */
+        nsecs_t busyTime;
+        /* Time since the thread started, or that it ran for once it exited. */
+        nsecs_t lifetime;
+    };
+
     /* Creates a work queue with the specified maximum number of work threads. */
     WorkQueue(size_t maxThreads, bool canCallJava = true);
 
@@ -67,7 +97,15 @@ public:
      *
      * If 'backlog' is 0, then no throttle is applied.
      */
-    status_t schedule(WorkUnit* workUnit, size_t backlog = 2);
+    status_t schedule(WorkUnit* workUnit, size_t backlog = 2,
+            WorkPriority priority = WORK_PRIORITY_NORMAL);
+
+    /* Posts a work unit to run later, like schedule(), but returns WOULD_BLOCK
+     * instead of blocking when the backlog is exceeded.  The caller keeps
+     * ownership of the work unit in that case.
+     */
+    status_t trySchedule(WorkUnit* workUnit, size_t backlog = 2,
+            WorkPriority priority = WORK_PRIORITY_NORMAL);
 
     /* Cancels all pending work.
      * If the work queue is already finished, returns INVALID_OPERATION.
@@ -85,33 +123,86 @@ public:
      */
     status_t finish();
 
+    /* Gets the stats of each work thread started so far, in the order they
+     * were started, including the threads that have exited.
+     */
+    void getThreadStats(Vector<ThreadStats>* outStats) const;
+
 private:
     class WorkThread : public Thread {
     public:
-        WorkThread(WorkQueue* workQueue, bool canCallJava);
+        WorkThread(WorkQueue* workQueue, size_t index, bool canCallJava);
         virtual ~WorkThread();
 
     private:
+        virtual status_t readyToRun();
         virtual bool threadLoop();
 
         WorkQueue* const mWorkQueue;
+        const size_t mIndex;
+    };
+
+    /* The pending work units of one work thread, and its stats.  Its own
+     * thread takes work units from the front; other threads steal them from
+     * the back.
+     */
+    struct WorkDeque {
+        WorkDeque() : size(0), threadId(0), startTime(0), endTime(0) {
+            stats.workUnitsRun = 0;
+            stats.workUnitsStolen = 0;
+            stats.busyTime = 0;
+            stats.lifetime = 0;
+        }
+
+        Mutex lock;
+        /* number of work units in the lists, read without the lock to skip
+         * empty queues */
+        volatile int32_t size;
+        Vector<WorkUnit*> workUnits[NUM_WORK_PRIORITIES];
+
+        /* set by the thread as it starts and exits, under the work queue's
+         * lock */
+        thread_id_t threadId;
+        nsecs_t startTime;
+        nsecs_t endTime;
+
+        /* updated by the thread under the lock above */
+        ThreadStats stats;
     };
 
+    status_t schedule(WorkUnit* workUnit, size_t backlog, WorkPriority priority,
+            bool canBlock);
     status_t cancelLocked();
-    bool threadLoop(); // called from each work thread
+    void threadStarted(size_t index); // called from each work thread as it starts
+    void threadExiting(size_t index); // and as it exits
+    bool threadLoop(size_t index); // called from each work thread
+    WorkUnit* takeWorkUnit(size_t index, bool* outStolen);
 
     const size_t mMaxThreads;
     const bool mCanCallJava;
 
-    Mutex mLock;
+    mutable Mutex mLock;
     Condition mWorkChangedCondition;
     Condition mWorkDequeuedCondition;
 
-    bool mCanceled;
+    /* written under mLock, but checked by the work threads without it */
+    volatile int32_t mCanceled;
     bool mFinished;
-    size_t mIdleThreads;
     Vector<sp<WorkThread> > mWorkThreads;
-    Vector<WorkUnit*> mWorkUnits;
+    size_t mNextDeque;
+
+    /* one per possible work thread */
+    const size_t mNumWorkDeques;
+    WorkDeque* const mWorkDeques;
+
+    /* work threads not running a work unit */
+    volatile int32_t mIdleThreads;
+
+    /* work units scheduled and not yet taken by a work thread; it is only
+     * increased under mLock */
+    volatile int32_t mPendingWorkUnits;
+    /* producers waiting in schedule() for the backlog to go down */
+    volatile int32_t mWaitingProducers;
 };
 
 }; // namespace android
@@ -34,6 +34,7 @@
 #include <utils/Errors.h>
 #include <utils/FileMap.h>
 #include <utils/threads.h>
+#include <utils/ZipUtils.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -156,6 +157,31 @@ public:
      */
     bool uncompressEntry(ZipEntryRO entry, int fd) const;
 
+    /*
+     * Uncompress the data a chunk at a time, handing each to "callback",
+     * so that a large entry (e.g. a native library being extracted) is
+     * never held uncompressed in full.
+     */
+    bool uncompressEntry(ZipEntryRO entry, ZipUtils::InflateCallback callback,
+        void* cookie) const;
+
+    /*
+     * Uncompress "count" entries, each into the matching buffer, using up
+     * to "numThreads" threads (including the calling one) to inflate
+     * different entries at the same time.
+     *
+     * Returns "true" if every entry was uncompressed.
+     */
+    bool uncompressEntries(const ZipEntryRO* entries, void* const* buffers,
+        size_t count, int numThreads) const;
+
+    /*
+     * Uncompress "count" entries, each to the matching open file descriptor,
+     * using up to "numThreads" threads.  The fds must be distinct.
+     */
+    bool uncompressEntries(const ZipEntryRO* entries, const int* fds,
+        size_t count, int numThreads) const;
+
     /* Zip compression methods we support */
     enum {
         kCompressStored     = 0,        // no compression
@@ -219,13 +245,21 @@ private:
     /* convert a ZipEntryRO back to a hash table index */
     int entryToIndex(const ZipEntryRO entry) const;
 
+    /* map part of the archive */
+    FileMap* createFileMap(off64_t offset, size_t length) const;
+
+    /* uncompress entries into either buffers or fds */
+    bool uncompressEntries(const ZipEntryRO* entries, void* const* buffers,
+        const int* fds, size_t count, int numThreads) const;
+
     /*
-     * One entry in the hash table.
+     * One entry in the hash table.  The hash is kept so that lookups
+     * only compare names whose hash matches.
      */
     typedef struct HashEntry {
         const char*     name;
         unsigned short  nameLen;
-        //unsigned int    hash;
+        unsigned int    hash;
     } HashEntry;
 
     /* open Zip archive */
@@ -21,6 +21,7 @@
 #define __LIBS_ZIPUTILS_H
 
 #include <stdio.h>
+#include <sys/types.h>
 
 namespace android {
 
@@ -29,15 +30,43 @@ namespace android {
  */
 class ZipUtils {
 public:
+    /*
+     * Called with each chunk of uncompressed data, in order, by the
+     * streaming functions.  Return "false" to stop, which makes them fail.
+     */
+    typedef bool (*InflateCallback)(const void* data, size_t size,
+        void* cookie);
+
     /*
      * General utility function for uncompressing "deflate" data from a file
      * to a buffer.
+     *
+     * The compressed data is mapped and inflated in place when the file
+     * can be mapped, and read in chunks otherwise.  Either way the file is
+     * left positioned just past it.
      */
     static bool inflateToBuffer(int fd, void* buf, long uncompressedLen,
         long compressedLen);
     static bool inflateToBuffer(FILE* fp, void* buf, long uncompressedLen,
         long compressedLen);
 
+    /*
+     * Uncompress "deflate" data that is in memory (e.g. mapped), buffer to
+     * buffer.  This uses libdeflate when libutils is built with it
+     * (HAVE_LIBDEFLATE), which inflates whole buffers faster than zlib.
+     */
+    static bool inflateMemory(void* outBuf, size_t uncompressedLen,
+        const void* inBuf, size_t compressedLen);
+
+    /*
+     * Uncompress "deflate" data that is in memory, handing it to "callback"
+     * in chunks of up to "chunkSize" bytes (0 for the default), so that
+     * large data never needs to be held uncompressed in full.
+     */
+    static bool inflateToCallback(const void* inBuf, size_t compressedLen,
+        size_t uncompressedLen, InflateCallback callback, void* cookie,
+        size_t chunkSize = 0);
+
     /*
      * Someday we might want to make this generic and handle bzip2 ".bz2"
      * files too.
@@ -15,7 +15,10 @@
 # we have the common sources, plus some device-specific stuff
 sources := \
     AppOpsManager.cpp \
+    AsyncTransaction.cpp \
     Binder.cpp \
+    BinderProfiler.cpp \
+    BlobPool.cpp \
     BpBinder.cpp \
     IAppOpsCallback.cpp \
     IAppOpsService.cpp \
@@ -62,3 +65,9 @@ LOCAL_MODULE := libbinder
 LOCAL_SRC_FILES := $(sources)
 
 include $(BUILD_STATIC_LIBRARY)
+
+# If we're building with ONE_SHOT_MAKEFILE (mm, mmm), then what the framework
+# team really wants is to build the stuff defined by this makefile.
+ifeq (,$(ONE_SHOT_MAKEFILE))
+include $(call first-makefiles-under,$(LOCAL_PATH))
+endif
@@ -15,18 +15,121 @@
  */
 
 #include <binder/AppOpsManager.h>
+#include <binder/IAppOpsCallback.h>
 #include <binder/IServiceManager.h>
+#include <binder/Parcel.h>
 
+#include <utils/KeyedVector.h>
+#include <utils/SortedVector.h>
 #include <utils/SystemClock.h>
+#include <utils/Timers.h>
 
 namespace android {
 
 static String16 _appops("appops");
 
+// a cached mode is asked again after that long, in case a change was missed
+static const nsecs_t MODE_TTL = s2ns(10);
+
+// notes of a cached op are sent at most that often, the service only keeps
+// the time of the last one
+static const nsecs_t NOTE_INTERVAL = s2ns(1);
+
+class AppOpsManager::ModeCache : public BnAppOpsCallback
+{
+public:
+    struct op_key_t {
+        int32_t op;
+        int32_t uid;
+        String16 package;
+        inline bool operator < (const op_key_t& rhs) const {
+            if (op != rhs.op) return op < rhs.op;
+            if (uid != rhs.uid) return uid < rhs.uid;
+            return package < rhs.package;
+        }
+    };
+
+    // returns whether the op is cached, and if so whether a note is due
+    bool lookup(const op_key_t& key, int32_t* mode, bool note, bool* sendNote) {
+        Mutex::Autolock _l(mLock);
+        ssize_t i = mModes.indexOfKey(key);
+        if (i < 0) {
+            return false;
+        }
+        const nsecs_t now = systemTime();
+        entry_t& e(mModes.editValueAt(i));
+        if (now >= e.expires) {
+            mModes.removeItemsAt(i);
+            return false;
+        }
+        *mode = e.mode;
+        *sendNote = note && (now - e.lastNote >= NOTE_INTERVAL);
+        if (*sendNote) {
+            e.lastNote = now;
+        }
+        return true;
+    }
+
+    // returns whether the package needs to be watched for this op
+    bool add(const op_key_t& key, int32_t mode, bool noted) {
+        Mutex::Autolock _l(mLock);
+        const nsecs_t now = systemTime();
+        entry_t e;
+        e.mode = mode;
+        e.expires = now + MODE_TTL;
+        e.lastNote = noted ? now : 0;
+        mModes.add(key, e);
+        op_key_t watch(key);
+        watch.uid = 0;
+        if (mWatched.indexOf(watch) >= 0) {
+            return false;
+        }
+        mWatched.add(watch);
+        return true;
+    }
+
+    void clear() {
+        Mutex::Autolock _l(mLock);
+        mModes.clear();
+        mWatched.clear();
+    }
+
+    virtual void opChanged(int32_t op, const String16& packageName) {
+        Mutex::Autolock _l(mLock);
+        for (size_t i=mModes.size() ; i>0 ; i--) {
+            const op_key_t& key(mModes.keyAt(i-1));
+            if (key.op == op && key.package == packageName) {
+                mModes.removeItemsAt(i-1);
+            }
+        }
+    }
+
+private:
+    struct entry_t {
+        int32_t mode;
+        nsecs_t expires;
+        nsecs_t lastNote;
+    };
+
+    Mutex mLock;
+    KeyedVector<op_key_t, entry_t> mModes;
+    // the op and package pairs we asked the service to tell us about
+    SortedVector<op_key_t> mWatched;
+};
+
 AppOpsManager::AppOpsManager()
+    : mCache(new ModeCache())
 {
 }
 
+AppOpsManager::~AppOpsManager()
+{
+    Mutex::Autolock _l(mLock);
+    if (mService != NULL) {
+        mService->stopWatchingMode(mCache);
+    }
+}
+
 sp<IAppOpsService> AppOpsManager::getService()
 {
     int64_t startTime = 0;
@@ -47,21 +150,60 @@ sp<IAppOpsService> AppOpsManager::getService()
         } else {
             service = interface_cast<IAppOpsService>(binder);
             mService = service;
+            // a new service doesn't know what we were watching
+            mCache->clear();
         }
     }
     mLock.unlock();
     return service;
 }
 
-int32_t AppOpsManager::checkOp(int32_t op, int32_t uid, const String16& callingPackage)
+int32_t AppOpsManager::cachedOp(int32_t op, int32_t uid,
+        const String16& callingPackage, bool note)
 {
     sp<IAppOpsService> service = getService();
-    return service != NULL ? service->checkOperation(op, uid, callingPackage) : MODE_IGNORED;
+    if (service == NULL) {
+        return MODE_IGNORED;
+    }
+
+    ModeCache::op_key_t key;
+    key.op = op;
+    key.uid = uid;
+    key.package = callingPackage;
+    int32_t mode;
+    bool sendNote = false;
+    if (mCache->lookup(key, &mode, note, &sendNote)) {
+        if (sendNote) {
+            // what BpAppOpsService::noteOperation() sends, but one-way:
+            // the mode is known, only the service's record needs it
+            Parcel data;
+            data.writeInterfaceToken(IAppOpsService::getInterfaceDescriptor());
+            data.writeInt32(op);
+            data.writeInt32(uid);
+            data.writeString16(callingPackage);
+            service->asBinder()->transact(
+                    IAppOpsService::NOTE_OPERATION_TRANSACTION, data, NULL,
+                    IBinder::FLAG_ONEWAY);
+        }
+        return mode;
+    }
+
+    mode = note ? service->noteOperation(op, uid, callingPackage) :
+            service->checkOperation(op, uid, callingPackage);
+    // only the common case is cached, so that every refusal is recorded
+    if (mode == MODE_ALLOWED && mCache->add(key, mode, note)) {
+        service->startWatchingMode(op, callingPackage, mCache);
+    }
+    return mode;
+}
+
+int32_t AppOpsManager::checkOp(int32_t op, int32_t uid, const String16& callingPackage)
+{
+    return cachedOp(op, uid, callingPackage, false);
 }
 
 int32_t AppOpsManager::noteOp(int32_t op, int32_t uid, const String16& callingPackage) {
-    sp<IAppOpsService> service = getService();
-    return service != NULL ? service->noteOperation(op, uid, callingPackage) : MODE_IGNORED;
+    return cachedOp(op, uid, callingPackage, true);
 }
 
 int32_t AppOpsManager::startOp(int32_t op, int32_t uid, const String16& callingPackage) {
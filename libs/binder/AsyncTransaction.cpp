@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "AsyncTransaction"
+
+#include <binder/IPCThreadState.h>
+#include <binder/IBinder.h>
+#include <binder/Parcel.h>
+#include <utils/Log.h>
+#include <utils/Looper.h>
+#include <utils/threads.h>
+
+#include <private/binder/Static.h>
+
+#include <string.h>
+
+namespace android {
+
+// ---------------------------------------------------------------------------
+
+// idle threads exit after this long without a transaction to make
+static const nsecs_t ASYNC_TRANSACTION_THREAD_TIMEOUT = s2ns(10);
+
+class AsyncTransaction {
+public:
+    sp<IBinder> binder;
+    uint32_t code;
+    uint32_t flags;
+    Parcel data;
+    Parcel reply;
+    status_t err;
+    sp<TransactionCallback> callback;
+    sp<Looper> looper;
+};
+
+// delivers the reply of an AsyncTransaction on its Looper
+class AsyncTransactionReply : public MessageHandler {
+public:
+    AsyncTransactionReply(AsyncTransaction* transaction)
+        : mTransaction(transaction) {
+    }
+
+    virtual void handleMessage(const Message&) {
+        mTransaction->callback->onTransactionComplete(
+                mTransaction->err, mTransaction->reply);
+    }
+
+protected:
+    virtual ~AsyncTransactionReply() {
+        delete mTransaction;
+    }
+
+private:
+    AsyncTransaction* const mTransaction;
+};
+
+class AsyncTransactionThread : public Thread {
+public:
+    AsyncTransactionThread() : Thread(false) {
+    }
+
+private:
+    virtual bool threadLoop() {
+        AsyncTransaction* t;
+        {
+            Mutex::Autolock _l(gAsyncTransactionLock);
+            while (gAsyncTransactions.isEmpty()) {
+                gAsyncTransactionIdleThreads++;
+                status_t err = gAsyncTransactionCondition.waitRelative(
+                        gAsyncTransactionLock, ASYNC_TRANSACTION_THREAD_TIMEOUT);
+                gAsyncTransactionIdleThreads--;
+                if (err == TIMED_OUT && gAsyncTransactions.isEmpty()) {
+                    gAsyncTransactionThreads--;
+                    return false;
+                }
+            }
+            t = gAsyncTransactions[0];
+            gAsyncTransactions.removeAt(0);
+        }
+
+        Parcel reply;
+        t->err = t->binder->transact(t->code, t->data, &reply, t->flags);
+        // don't keep the binder alive until the Looper gets to the reply
+        t->binder.clear();
+        if (t->looper == NULL) {
+            t->callback->onTransactionComplete(t->err, reply);
+            delete t;
+            return true;
+        }
+
+        // The reply lives in the driver's buffer, and freeing it queues
+        // BC_FREE_BUFFER on the freeing thread, which the Looper's thread
+        // may never send. Hand the Looper a copy and free the buffer here.
+        if (reply.dataSize()) {
+            status_t err = t->reply.appendFrom(&reply, 0, reply.dataSize());
+            if (err != NO_ERROR && t->err == NO_ERROR) {
+                t->err = err;
+            }
+            t->reply.setDataPosition(0);
+        }
+        reply.freeData();
+        IPCThreadState::self()->flushCommands();
+
+        t->looper->sendMessage(new AsyncTransactionReply(t), Message());
+        return true;
+    }
+};
+
+// ---------------------------------------------------------------------------
+
+status_t IPCThreadState::transactAsync(const sp<IBinder>& binder,
+        uint32_t code, const Parcel& data,
+        const sp<TransactionCallback>& callback, const sp<Looper>& looper,
+        uint32_t flags)
+{
+    if (binder == NULL || callback == NULL) {
+        return BAD_VALUE;
+    }
+
+    AsyncTransaction* t = new AsyncTransaction;
+    status_t err = t->data.appendFrom(&data, 0, data.dataSize());
+    if (err != NO_ERROR) {
+        delete t;
+        return err;
+    }
+    t->binder = binder;
+    t->code = code;
+    t->flags = flags & ~IBinder::FLAG_ONEWAY;
+    t->err = NO_ERROR;
+    t->callback = callback;
+    t->looper = looper;
+
+    Mutex::Autolock _l(gAsyncTransactionLock);
+    gAsyncTransactions.add(t);
+    if (gAsyncTransactionIdleThreads >= gAsyncTransactions.size() ||
+            gAsyncTransactionThreads >= MAX_ASYNC_TRANSACTION_THREADS) {
+        gAsyncTransactionCondition.signal();
+        return NO_ERROR;
+    }
+
+    sp<Thread> thread(new AsyncTransactionThread());
+    err = thread->run("Binder async transaction");
+    if (err != NO_ERROR) {
+        ALOGE("can't start an async transaction thread: %s (%d)",
+                strerror(-err), err);
+        // the running threads will get to it
+        if (gAsyncTransactionThreads == 0) {
+            gAsyncTransactions.removeAt(gAsyncTransactions.size() - 1);
+            delete t;
+            return err;
+        }
+        return NO_ERROR;
+    }
+    gAsyncTransactionThreads++;
+    return NO_ERROR;
+}
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
@@ -20,9 +20,14 @@
 #include <utils/misc.h>
 #include <binder/BpBinder.h>
 #include <binder/IInterface.h>
+#include <binder/IServiceManager.h>
 #include <binder/Parcel.h>
+#include <binder/ProcessState.h>
+#include <private/binder/BinderProfiler.h>
+#include <utils/String8.h>
 
 #include <stdio.h>
+#include <unistd.h>
 
 namespace android {
 
@@ -183,6 +188,32 @@ BBinder::~BBinder()
 }
 
 
+// "dumpsys <service> --binder-profile [start|stop|reset]" controls and
+// dumps the BinderProfiler of the process hosting the service, whatever
+// the service's own dump() does.
+static status_t dumpBinderProfile(int fd, const Vector<String16>& args)
+{
+    String8 result;
+    if (!checkCallingPermission(String16("android.permission.DUMP"))) {
+        result.appendFormat("Permission Denial: can't dump the binder "
+                "profile of pid=%d\n", getpid());
+    } else {
+        if (args.size() > 1) {
+            if (args[1] == String16("start")) {
+                BinderProfiler::setEnabled(true);
+            } else if (args[1] == String16("stop")) {
+                BinderProfiler::setEnabled(false);
+            } else if (args[1] == String16("reset")) {
+                BinderProfiler::reset();
+            }
+        }
+        BinderProfiler::dump(result);
+        ProcessState::self()->dumpThreadPool(result);
+    }
+    write(fd, result.string(), result.size());
+    return NO_ERROR;
+}
+
 status_t BBinder::onTransact(
     uint32_t code, const Parcel& data, Parcel* reply, uint32_t flags)
 {
@@ -198,6 +229,9 @@ status_t BBinder::onTransact(
             for (int i = 0; i < argc && data.dataAvail() > 0; i++) {
                args.add(data.readString16());
             }
+            if (args.size() && args[0] == String16("--binder-profile")) {
+                return dumpBinderProfile(fd, args);
+            }
             return dump(fd, args);
         }
 
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "BinderProfiler"
+
+#include <private/binder/BinderProfiler.h>
+#include <private/binder/Static.h>
+
+#include <binder/IBinder.h>
+#include <binder/Parcel.h>
+#include <cutils/properties.h>
+#include <utils/Log.h>
+#include <utils/String8.h>
+#include <utils/String16.h>
+#include <utils/Vector.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace android {
+
+// ---------------------------------------------------------------------------
+
+struct BinderProfileEntry {
+    String16 descriptor;
+    uint32_t code;
+    bool server;
+    uint32_t count;
+    uint64_t dataBytes;
+    uint64_t replyBytes;
+    nsecs_t totalTime;
+    nsecs_t maxTime;
+};
+
+class BinderThreadProfile {
+public:
+    // the entry of the given transaction, added if there is none yet
+    BinderProfileEntry& editEntry(const char16_t* descriptor, size_t len,
+            uint32_t code, bool server);
+
+    void merge(const BinderThreadProfile& other);
+
+    mutable Mutex lock;
+    Vector<BinderProfileEntry> entries;
+};
+
+BinderProfileEntry& BinderThreadProfile::editEntry(const char16_t* descriptor,
+        size_t len, uint32_t code, bool server) {
+    const size_t n = entries.size();
+    for (size_t i=0 ; i<n ; i++) {
+        BinderProfileEntry& e(entries.editItemAt(i));
+        if (e.code == code && e.server == server && e.descriptor.size() == len &&
+                !memcmp(e.descriptor.string(), descriptor,
+                        len * sizeof(char16_t))) {
+            return e;
+        }
+    }
+    // only new transactions allocate the descriptor
+    BinderProfileEntry e;
+    e.descriptor.setTo(descriptor, len);
+    e.code = code;
+    e.server = server;
+    e.count = 0;
+    e.dataBytes = 0;
+    e.replyBytes = 0;
+    e.totalTime = 0;
+    e.maxTime = 0;
+    return entries.editItemAt(entries.add(e));
+}
+
+void BinderThreadProfile::merge(const BinderThreadProfile& other) {
+    for (size_t i=0 ; i<other.entries.size() ; i++) {
+        const BinderProfileEntry& o(other.entries[i]);
+        BinderProfileEntry& e(editEntry(o.descriptor.string(),
+                o.descriptor.size(), o.code, o.server));
+        e.count += o.count;
+        e.dataBytes += o.dataBytes;
+        e.replyBytes += o.replyBytes;
+        e.totalTime += o.totalTime;
+        if (o.maxTime > e.maxTime) {
+            e.maxTime = o.maxTime;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+// returns the interface token written by writeInterfaceToken(), if the
+// transaction has one
+static const char16_t* getInterfaceToken(uint32_t code, const Parcel& data,
+        size_t* outLen) {
+    *outLen = 0;
+    if (code < IBinder::FIRST_CALL_TRANSACTION ||
+            code > IBinder::LAST_CALL_TRANSACTION) {
+        return NULL;
+    }
+    const size_t pos = data.dataPosition();
+    data.setDataPosition(0);
+    data.readInt32(); // strict mode policy
+    const char16_t* descriptor = data.readString16Inplace(outLen);
+    data.setDataPosition(pos);
+    if (descriptor == NULL) {
+        *outLen = 0;
+    }
+    return descriptor;
+}
+
+bool BinderProfiler::isEnabled() {
+    int32_t enabled = gBinderProfilerEnabled;
+    if (enabled < 0) {
+        char value[PROPERTY_VALUE_MAX];
+        property_get("debug.binder.profile", value, "0");
+        enabled = atoi(value) ? 1 : 0;
+        gBinderProfilerEnabled = enabled;
+    }
+    return enabled;
+}
+
+void BinderProfiler::setEnabled(bool enabled) {
+    gBinderProfilerEnabled = enabled ? 1 : 0;
+}
+
+void BinderProfiler::reset() {
+    Mutex::Autolock _l(gBinderProfilerLock);
+    for (size_t i=0 ; i<gBinderThreadProfiles.size() ; i++) {
+        BinderThreadProfile* profile = gBinderThreadProfiles[i];
+        Mutex::Autolock _pl(profile->lock);
+        profile->entries.clear();
+    }
+    delete gRetiredBinderProfile;
+    gRetiredBinderProfile = NULL;
+}
+
+void BinderProfiler::record(BinderThreadProfile** profile, bool server,
+        uint32_t code, const Parcel& data, size_t replySize,
+        nsecs_t duration) {
+    BinderThreadProfile* p = *profile;
+    if (p == NULL) {
+        p = new BinderThreadProfile();
+        Mutex::Autolock _l(gBinderProfilerLock);
+        gBinderThreadProfiles.add(p);
+        *profile = p;
+    }
+
+    size_t len;
+    const char16_t* descriptor = getInterfaceToken(code, data, &len);
+
+    Mutex::Autolock _l(p->lock);
+    BinderProfileEntry& e(p->editEntry(descriptor, len, code, server));
+    e.count++;
+    e.dataBytes += data.dataSize();
+    e.replyBytes += replySize;
+    e.totalTime += duration;
+    if (duration > e.maxTime) {
+        e.maxTime = duration;
+    }
+}
+
+void BinderProfiler::retire(BinderThreadProfile* profile) {
+    if (profile == NULL) {
+        return;
+    }
+    Mutex::Autolock _l(gBinderProfilerLock);
+    for (size_t i=0 ; i<gBinderThreadProfiles.size() ; i++) {
+        if (gBinderThreadProfiles[i] == profile) {
+            gBinderThreadProfiles.removeAt(i);
+            break;
+        }
+    }
+    if (gRetiredBinderProfile == NULL) {
+        gRetiredBinderProfile = new BinderThreadProfile();
+    }
+    gRetiredBinderProfile->merge(*profile);
+    delete profile;
+}
+
+static int compareTotalTime(const BinderProfileEntry* lhs,
+        const BinderProfileEntry* rhs) {
+    if (lhs->totalTime == rhs->totalTime) {
+        return 0;
+    }
+    return lhs->totalTime > rhs->totalTime ? -1 : 1;
+}
+
+void BinderProfiler::dump(String8& result) {
+    BinderThreadProfile all;
+    {
+        Mutex::Autolock _l(gBinderProfilerLock);
+        if (gRetiredBinderProfile != NULL) {
+            all.merge(*gRetiredBinderProfile);
+        }
+        for (size_t i=0 ; i<gBinderThreadProfiles.size() ; i++) {
+            const BinderThreadProfile* profile = gBinderThreadProfiles[i];
+            Mutex::Autolock _pl(profile->lock);
+            all.merge(*profile);
+        }
+    }
+    all.entries.sort(compareTotalTime);
+
+    result.appendFormat("Binder profile of pid %d (%s), by total time:\n",
+            getpid(), isEnabled() ? "enabled" : "disabled");
+    for (size_t i=0 ; i<all.entries.size() ; i++) {
+        const BinderProfileEntry& e(all.entries[i]);
+        result.appendFormat("  %s %s code %u: count=%u, "
+                "avg data=%llu bytes, avg reply=%llu bytes, "
+                "avg %.3f ms, max %.3f ms, total %.3f ms\n",
+                e.server ? "served" : "sent  ",
+                e.descriptor.size() ? String8(e.descriptor).string() : "?",
+                e.code, e.count,
+                e.dataBytes / e.count, e.replyBytes / e.count,
+                ns2us(e.totalTime / e.count) / 1000.0,
+                ns2us(e.maxTime) / 1000.0, ns2us(e.totalTime) / 1000.0);
+    }
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
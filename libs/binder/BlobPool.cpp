@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "BlobPool"
+
+#include <binder/BlobPool.h>
+
+#include <cutils/ashmem.h>
+#include <utils/Log.h>
+#include <utils/Timers.h>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace android {
+
+// ---------------------------------------------------------------------------
+
+static int64_t makePoolId()
+{
+    // the creation time tells apart pools of processes that had the same
+    // pid, the pid pools created at the same time
+    return (int64_t(getpid()) << 40) ^ systemTime(SYSTEM_TIME_MONOTONIC);
+}
+
+BlobPool::BlobPool(size_t count, size_t capacity)
+    : mId(makePoolId()), mCapacity(capacity), mInitCheck(NO_ERROR), mNext(0)
+{
+    const size_t pagesize = getpagesize();
+    const size_t size = ((capacity + pagesize-1) & ~(pagesize-1));
+    for (size_t i=0 ; i<count ; i++) {
+        Buffer buffer;
+        buffer.fd = ashmem_create_region("Parcel BlobPool", size);
+        if (buffer.fd < 0) {
+            ALOGE("couldn't create a %u bytes region (%s)",
+                    uint32_t(size), strerror(errno));
+            mInitCheck = NO_MEMORY;
+            break;
+        }
+        buffer.data = ::mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED, buffer.fd, 0);
+        // receivers only get to read it
+        if (buffer.data == MAP_FAILED ||
+                ashmem_set_prot_region(buffer.fd, PROT_READ) < 0) {
+            ALOGE("couldn't map a %u bytes region (%s)",
+                    uint32_t(size), strerror(errno));
+            if (buffer.data != MAP_FAILED) {
+                ::munmap(buffer.data, size);
+            }
+            ::close(buffer.fd);
+            mInitCheck = NO_MEMORY;
+            break;
+        }
+        mBuffers.add(buffer);
+    }
+    if (count == 0 || capacity == 0) {
+        mInitCheck = BAD_VALUE;
+    }
+}
+
+BlobPool::~BlobPool()
+{
+    const size_t pagesize = getpagesize();
+    const size_t size = ((mCapacity + pagesize-1) & ~(pagesize-1));
+    for (size_t i=0 ; i<mBuffers.size() ; i++) {
+        ::munmap(mBuffers[i].data, size);
+        ::close(mBuffers[i].fd);
+    }
+}
+
+status_t BlobPool::initCheck() const {
+    return mInitCheck;
+}
+
+size_t BlobPool::getCount() const {
+    return mBuffers.size();
+}
+
+size_t BlobPool::getCapacity() const {
+    return mCapacity;
+}
+
+const BlobPool::Buffer& BlobPool::nextBuffer(int32_t* outIndex)
+{
+    Mutex::Autolock _l(mLock);
+    const size_t index = mNext;
+    mNext = (mNext + 1) % mBuffers.size();
+    *outIndex = int32_t(index);
+    return mBuffers[index];
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
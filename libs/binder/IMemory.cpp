@@ -63,8 +63,20 @@ private:
 
     void free_heap(const wp<IBinder>& binder);
 
-    Mutex mHeapCacheLock;
-    KeyedVector< wp<IBinder>, heap_info_t > mHeapCache;
+    // The heaps are spread over shards by binder address, so that threads
+    // resolving different heaps don't wait for each other.
+    enum { SHARD_COUNT = 16 };
+    struct shard_t {
+        Mutex lock;
+        KeyedVector< wp<IBinder>, heap_info_t > heaps;
+    };
+
+    shard_t& shardFor(const void* binder) {
+        // binders are at least 8-byte aligned
+        return mShards[(uintptr_t(binder) >> 3) % SHARD_COUNT];
+    }
+
+    shard_t mShards[SHARD_COUNT];
 };
 
 static sp<HeapCache> gHeapCache = new HeapCache();
@@ -274,6 +286,7 @@ void BpMemoryHeap::assertMapped() const
             if (mHeapId == -1) {
                 mBase   = heap->mBase;
                 mSize   = heap->mSize;
+                mFlags  = heap->mFlags;
                 mOffset = heap->mOffset;
                 android_atomic_write( dup( heap->mHeapId ), &mHeapId );
             }
@@ -424,10 +437,11 @@ void HeapCache::binderDied(const wp<IBinder>& binder)
 
 sp<IMemoryHeap> HeapCache::find_heap(const sp<IBinder>& binder)
 {
-    Mutex::Autolock _l(mHeapCacheLock);
-    ssize_t i = mHeapCache.indexOfKey(binder);
+    shard_t& shard(shardFor(binder.get()));
+    Mutex::Autolock _l(shard.lock);
+    ssize_t i = shard.heaps.indexOfKey(binder);
     if (i>=0) {
-        heap_info_t& info = mHeapCache.editValueAt(i);
+        heap_info_t& info = shard.heaps.editValueAt(i);
         ALOGD_IF(VERBOSE,
                 "found binder=%p, heap=%p, size=%d, fd=%d, count=%d",
                 binder.get(), info.heap.get(),
@@ -442,7 +456,7 @@ sp<IMemoryHeap> HeapCache::find_heap(const sp<IBinder>& binder)
         info.count = 1;
         //ALOGD("adding binder=%p, heap=%p, count=%d",
         //      binder.get(), info.heap.get(), info.count);
-        mHeapCache.add(binder, info);
+        shard.heaps.add(binder, info);
         return info.heap;
     }
 }
@@ -455,10 +469,11 @@ void HeapCache::free_heap(const wp<IBinder>& binder)
 {
     sp<IMemoryHeap> rel;
     {
-        Mutex::Autolock _l(mHeapCacheLock);
-        ssize_t i = mHeapCache.indexOfKey(binder);
+        shard_t& shard(shardFor(binder.unsafe_get()));
+        Mutex::Autolock _l(shard.lock);
+        ssize_t i = shard.heaps.indexOfKey(binder);
         if (i>=0) {
-            heap_info_t& info(mHeapCache.editValueAt(i));
+            heap_info_t& info(shard.heaps.editValueAt(i));
             int32_t c = android_atomic_dec(&info.count);
             if (c == 1) {
                 ALOGD_IF(VERBOSE,
@@ -467,8 +482,8 @@ void HeapCache::free_heap(const wp<IBinder>& binder)
                         static_cast<BpMemoryHeap*>(info.heap.get())->mSize,
                         static_cast<BpMemoryHeap*>(info.heap.get())->mHeapId,
                         info.count);
-                rel = mHeapCache.valueAt(i).heap;
-                mHeapCache.removeItemsAt(i);
+                rel = shard.heaps.valueAt(i).heap;
+                shard.heaps.removeItemsAt(i);
             }
         } else {
             ALOGE("free_heap binder=%p not found!!!", binder.unsafe_get());
@@ -479,24 +494,28 @@ void HeapCache::free_heap(const wp<IBinder>& binder)
 sp<IMemoryHeap> HeapCache::get_heap(const sp<IBinder>& binder)
 {
     sp<IMemoryHeap> realHeap;
-    Mutex::Autolock _l(mHeapCacheLock);
-    ssize_t i = mHeapCache.indexOfKey(binder);
-    if (i>=0)   realHeap = mHeapCache.valueAt(i).heap;
+    shard_t& shard(shardFor(binder.get()));
+    Mutex::Autolock _l(shard.lock);
+    ssize_t i = shard.heaps.indexOfKey(binder);
+    if (i>=0)   realHeap = shard.heaps.valueAt(i).heap;
     else        realHeap = interface_cast<IMemoryHeap>(binder);
     return realHeap;
 }
 
 void HeapCache::dump_heaps()
 {
-    Mutex::Autolock _l(mHeapCacheLock);
-    int c = mHeapCache.size();
-    for (int i=0 ; i<c ; i++) {
-        const heap_info_t& info = mHeapCache.valueAt(i);
-        BpMemoryHeap const* h(static_cast<BpMemoryHeap const *>(info.heap.get()));
-        ALOGD("hey=%p, heap=%p, count=%d, (fd=%d, base=%p, size=%d)",
-                mHeapCache.keyAt(i).unsafe_get(),
-                info.heap.get(), info.count,
-                h->mHeapId, h->mBase, h->mSize);
+    for (int s=0 ; s<SHARD_COUNT ; s++) {
+        shard_t& shard(mShards[s]);
+        Mutex::Autolock _l(shard.lock);
+        int c = shard.heaps.size();
+        for (int i=0 ; i<c ; i++) {
+            const heap_info_t& info = shard.heaps.valueAt(i);
+            BpMemoryHeap const* h(static_cast<BpMemoryHeap const *>(info.heap.get()));
+            ALOGD("hey=%p, heap=%p, count=%d, (fd=%d, base=%p, size=%d)",
+                    shard.heaps.keyAt(i).unsafe_get(),
+                    info.heap.get(), info.count,
+                    h->mHeapId, h->mBase, h->mSize);
+        }
     }
 }
 
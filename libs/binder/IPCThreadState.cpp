@@ -26,13 +26,17 @@
 #include <utils/TextOutput.h>
 #include <utils/threads.h>
 
+#include <private/android_filesystem_config.h>
 #include <private/binder/binder_module.h>
+#include <private/binder/BinderProfiler.h>
 #include <private/binder/Static.h>
 
 #include <sys/ioctl.h>
 #include <signal.h>
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #ifdef HAVE_PTHREADS
@@ -295,6 +299,28 @@ static pthread_key_t gTLS = 0;
 static bool gShutdown = false;
 static bool gDisableBackgroundScheduling = false;
 
+// interrupts the driver wait of idle pool threads, see startIdleTimer()
+static int idleSignal()
+{
+    return SIGRTMIN + 6;
+}
+
+static void idleSignalHandler(int)
+{
+    // nothing to do, the signal only has to interrupt the ioctl
+}
+
+static pthread_once_t gIdleSignalOnce = PTHREAD_ONCE_INIT;
+
+static void installIdleSignalHandler()
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = idleSignalHandler;
+    // no SA_RESTART, the ioctl must return EINTR
+    sigaction(idleSignal(), &sa, NULL);
+}
+
 IPCThreadState* IPCThreadState::self()
 {
     if (gHaveTLS) {
@@ -404,6 +430,16 @@ void IPCThreadState::restoreCallingIdentity(int64_t token)
     mCallingPid = (int)token;
 }
 
+void IPCThreadState::setLatencyClass(LatencyClass latencyClass)
+{
+    mLatencyClass = latencyClass;
+}
+
+IPCThreadState::LatencyClass IPCThreadState::getLatencyClass() const
+{
+    return mLatencyClass;
+}
+
 void IPCThreadState::clearCaller()
 {
     mCallingPid = getpid();
@@ -418,6 +454,11 @@ void IPCThreadState::flushCommands()
 }
 
 void IPCThreadState::joinThreadPool(bool isMain)
+{
+    joinThreadPool(isMain, false);
+}
+
+void IPCThreadState::joinThreadPool(bool isMain, bool mayRetire)
 {
     LOG_THREADPOOL("**** THREAD %p (PID %d) IS JOINING THE THREAD POOL\n", (void*)pthread_self(), getpid());
 
@@ -427,8 +468,12 @@ void IPCThreadState::joinThreadPool(bool isMain)
     // scheduling group, so first we will make sure it is in the foreground
     // one to avoid performing an initial transaction in the background.
     set_sched_policy(mMyThreadId, SP_FOREGROUND);
+    mProcess->threadPoolJoined();
+    const nsecs_t idleTimeout = mayRetire ? mProcess->getThreadPoolIdleTimeout() : 0;
+    const bool idleTimer = idleTimeout > 0 && startIdleTimer(idleTimeout);
         
     status_t result;
+    bool retired = false;
     do {
         int32_t cmd;
         
@@ -453,8 +498,16 @@ void IPCThreadState::joinThreadPool(bool isMain)
             }
         }
 
+        if (retired) {
+            LOG_THREADPOOL("**** THREAD %p (PID %d) IS NOT NEEDED ANYMORE\n",
+                (void*)pthread_self(), getpid());
+            break;
+        }
+
         // now get the next command to be processed, waiting if necessary
+        mWaitingForWork = idleTimer;
         result = talkWithDriver();
+        mWaitingForWork = false;
         if (result >= NO_ERROR) {
             size_t IN = mIn.dataAvail();
             if (IN < sizeof(int32_t)) continue;
@@ -465,7 +518,14 @@ void IPCThreadState::joinThreadPool(bool isMain)
             }
 
 
+            const bool counted = mProcess->threadPoolCommandStarted();
             result = executeCommand(cmd);
+            // don't leave with commands left to execute
+            retired = mProcess->threadPoolCommandFinished(counted,
+                    mayRetire && mIn.dataPosition() >= mIn.dataSize());
+        } else if (result == -EINTR) {
+            // the idle timer went off and the pool has threads to spare
+            retired = true;
         } else if (result != TIMED_OUT && result != -ECONNREFUSED && result != -EBADF) {
             ALOGE("talkWithDriver(fd=%d) returned unexpected error %d, aborting",
                   mProcess->mDriverFD, result);
@@ -491,10 +551,61 @@ void IPCThreadState::joinThreadPool(bool isMain)
     LOG_THREADPOOL("**** THREAD %p (PID %d) IS LEAVING THE THREAD POOL err=%p\n",
         (void*)pthread_self(), getpid(), (void*)result);
     
+    if (idleTimer) {
+        stopIdleTimer();
+    }
+    mProcess->threadPoolLeft(retired);
     mOut.writeInt32(BC_EXIT_LOOPER);
     talkWithDriver(false);
 }
 
+bool IPCThreadState::startIdleTimer(nsecs_t timeout)
+{
+    pthread_once(&gIdleSignalOnce, installIdleSignalHandler);
+
+    // only talkWithDriver() lets the signal in, anywhere else it could
+    // interrupt the work of the thread
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, idleSignal());
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = idleSignal();
+    sev.sigev_notify_thread_id = mMyThreadId;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &mIdleTimer) != 0) {
+        ALOGW("Can't create the idle timer of binder thread %d: %s",
+                mMyThreadId, strerror(errno));
+        pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+        return false;
+    }
+
+    struct itimerspec its;
+    its.it_value.tv_sec = timeout / 1000000000;
+    its.it_value.tv_nsec = timeout % 1000000000;
+    its.it_interval = its.it_value;
+    timer_settime(mIdleTimer, 0, &its, NULL);
+    mIdleTimerArmed = true;
+    return true;
+}
+
+void IPCThreadState::stopIdleTimer()
+{
+    if (!mIdleTimerArmed) {
+        return;
+    }
+    timer_delete(mIdleTimer);
+    mIdleTimerArmed = false;
+
+    // a signal still pending just runs the empty handler
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, idleSignal());
+    pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+}
+
 void IPCThreadState::stopProcess(bool immediate)
 {
     //ALOGI("**** STOPPING PROCESS");
@@ -512,6 +623,11 @@ status_t IPCThreadState::transact(int32_t handle,
     status_t err = data.errorCheck();
 
     flags |= TF_ACCEPT_FDS;
+    flags = (flags & ~LATENCY_CLASS_MASK) |
+            (uint32_t(mLatencyClass) << LATENCY_CLASS_SHIFT);
+
+    const bool profile = BinderProfiler::isEnabled();
+    const nsecs_t start = profile ? systemTime(SYSTEM_TIME_MONOTONIC) : 0;
 
     IF_LOG_TRANSACTIONS() {
         TextOutput::Bundle _b(alog);
@@ -521,6 +637,20 @@ status_t IPCThreadState::transact(int32_t handle,
     }
     
     if (err == NO_ERROR) {
+        if ((flags & TF_ONE_WAY) && mOnewayBatchDepth > 0) {
+            LOG_ONEWAY(">>>> BATCH from pid %d uid %d", getpid(), getuid());
+            err = batchOnewayTransaction(handle, code, data, flags);
+            if (profile) {
+                BinderProfiler::record(&mProfile, false, code, data, 0,
+                        systemTime(SYSTEM_TIME_MONOTONIC) - start);
+            }
+            return err;
+        }
+        if (!mOnewayBatch.isEmpty()) {
+            // keep the order of the transactions, and the replies of
+            // the batched ones out of the way
+            flushOnewayBatch();
+        }
         LOG_ONEWAY(">>>> SEND from pid %d uid %d %s", getpid(), getuid(),
             (flags & TF_ONE_WAY) == 0 ? "READ REPLY" : "ONE WAY");
         err = writeTransactionData(BC_TRANSACTION, flags, handle, code, data, NULL);
@@ -563,10 +693,95 @@ status_t IPCThreadState::transact(int32_t handle,
     } else {
         err = waitForResponse(NULL, NULL);
     }
+
+    if (profile) {
+        BinderProfiler::record(&mProfile, false, code, data,
+                reply ? reply->dataSize() : 0,
+                systemTime(SYSTEM_TIME_MONOTONIC) - start);
+    }
     
     return err;
 }
 
+void IPCThreadState::beginOnewayBatch()
+{
+    mOnewayBatchDepth++;
+}
+
+status_t IPCThreadState::endOnewayBatch()
+{
+    ALOG_ASSERT(mOnewayBatchDepth > 0, "endOnewayBatch() without a batch");
+    if (mOnewayBatchDepth <= 0 || --mOnewayBatchDepth > 0) {
+        return NO_ERROR;
+    }
+    if (!mOnewayBatch.isEmpty()) {
+        flushOnewayBatch();
+    }
+    const status_t err = mOnewayBatchError;
+    mOnewayBatchError = NO_ERROR;
+    return err;
+}
+
+status_t IPCThreadState::batchOnewayTransaction(int32_t handle,
+    uint32_t code, const Parcel& data, uint32_t flags)
+{
+    // the caller's Parcel is usually gone by the time the batch is sent
+    Parcel* copy = new Parcel();
+    status_t err = copy->appendFrom(&data, 0, data.dataSize());
+    if (err == NO_ERROR) {
+        err = writeTransactionData(BC_TRANSACTION, flags, handle, code,
+                *copy, NULL);
+    }
+    if (err != NO_ERROR) {
+        delete copy;
+        return (mLastError = err);
+    }
+    mOnewayBatch.add(copy);
+    if (mOnewayBatch.size() >= MAX_ONEWAY_BATCH) {
+        flushOnewayBatch();
+    }
+    return NO_ERROR;
+}
+
+status_t IPCThreadState::flushOnewayBatch()
+{
+    // a transaction made while we wait doesn't see this batch anymore
+    Vector<Parcel*> batch(mOnewayBatch);
+    mOnewayBatch.clear();
+
+    // the first waitForResponse() writes the whole batch in a single
+    // BINDER_WRITE_READ, then there is one BR_TRANSACTION_COMPLETE (or
+    // error) per transaction to read back
+    status_t err = NO_ERROR;
+    bool unsent = false;
+    for (size_t i=0 ; i<batch.size() ; i++) {
+        const status_t result = waitForResponse(NULL, NULL);
+        if (err == NO_ERROR) {
+            err = result;
+        }
+        // dead and failed replies are about a transaction the driver
+        // took, anything else may have left the batch in mOut
+        if (result != NO_ERROR && result != DEAD_OBJECT &&
+                result != FAILED_TRANSACTION) {
+            unsent = true;
+        }
+    }
+    if (unsent) {
+        // mOut points into the parcels freed below, it must never be
+        // written to the driver now
+        ALOGE("oneway batch of %d transactions not sent", int(batch.size()));
+        mOut.setDataSize(0);
+    }
+    for (size_t i=0 ; i<batch.size() ; i++) {
+        delete batch[i];
+    }
+
+    if (mOnewayBatchError == NO_ERROR) {
+        mOnewayBatchError = err;
+    }
+    return err;
+}
+
 void IPCThreadState::incStrongHandle(int32_t handle)
 {
     LOG_REMOTEREFS("IPCThreadState::incStrongHandle(%d)\n", handle);
@@ -641,7 +856,13 @@ IPCThreadState::IPCThreadState()
     : mProcess(ProcessState::self()),
       mMyThreadId(androidGetTid()),
       mStrictModePolicy(0),
-      mLastTransactionBinderFlags(0)
+      mLastTransactionBinderFlags(0),
+      mProfile(NULL),
+      mOnewayBatchDepth(0),
+      mOnewayBatchError(NO_ERROR),
+      mLatencyClass(LATENCY_CLASS_NONE),
+      mIdleTimerArmed(false),
+      mWaitingForWork(false)
 {
     pthread_setspecific(gTLS, this);
     clearCaller();
@@ -651,6 +872,10 @@ IPCThreadState::IPCThreadState()
 
 IPCThreadState::~IPCThreadState()
 {
+    if (!mOnewayBatch.isEmpty()) {
+        flushOnewayBatch();
+    }
+    BinderProfiler::retire(mProfile);
 }
 
 status_t IPCThreadState::sendReply(const Parcel& reply, uint32_t flags)
@@ -801,16 +1026,25 @@ status_t IPCThreadState::talkWithDriver(bool doReceive)
 
     bwr.write_consumed = 0;
     bwr.read_consumed = 0;
+    sigset_t idleSignals;
+    sigemptyset(&idleSignals);
+    sigaddset(&idleSignals, idleSignal());
     status_t err;
     do {
         IF_LOG_COMMANDS() {
             alog << "About to read/write, write size = " << mOut.dataSize() << endl;
         }
 #if defined(HAVE_ANDROID_OS)
+        if (mWaitingForWork) {
+            pthread_sigmask(SIG_UNBLOCK, &idleSignals, NULL);
+        }
         if (ioctl(mProcess->mDriverFD, BINDER_WRITE_READ, &bwr) >= 0)
             err = NO_ERROR;
         else
             err = -errno;
+        if (mWaitingForWork) {
+            pthread_sigmask(SIG_BLOCK, &idleSignals, NULL);
+        }
 #else
         err = INVALID_OPERATION;
 #endif
@@ -820,7 +1054,10 @@ status_t IPCThreadState::talkWithDriver(bool doReceive)
         IF_LOG_COMMANDS() {
             alog << "Finished read/write, write size = " << mOut.dataSize() << endl;
         }
-    } while (err == -EINTR);
+        // the idle timer interrupts the wait of a pool thread to see
+        // whether it's still needed
+    } while (err == -EINTR &&
+            !(mWaitingForWork && mProcess->threadPoolIdleExpired()));
 
     IF_LOG_COMMANDS() {
         alog << "Our err: " << (void*)err << ", write consumed: "
@@ -828,13 +1065,17 @@ status_t IPCThreadState::talkWithDriver(bool doReceive)
 			<< "), read consumed: " << bwr.read_consumed << endl;
     }
 
-    if (err >= NO_ERROR) {
+    if (err >= NO_ERROR || err == -EINTR) {
         if (bwr.write_consumed > 0) {
             if (bwr.write_consumed < (ssize_t)mOut.dataSize())
                 mOut.remove(0, bwr.write_consumed);
             else
                 mOut.setDataSize(0);
         }
+        if (err == -EINTR) {
+            // retired while waiting, nothing was read
+            return err;
+        }
         if (bwr.read_consumed > 0) {
             mIn.setDataSize(bwr.read_consumed);
             mIn.setDataPosition(0);
@@ -997,6 +1238,15 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
             mCallingPid = tr.sender_pid;
             mCallingUid = tr.sender_euid;
             
+            LatencyClass latencyClass = LatencyClass(
+                    (tr.flags & LATENCY_CLASS_MASK) >> LATENCY_CLASS_SHIFT);
+            if ((latencyClass == LATENCY_CLASS_FOREGROUND ||
+                    latencyClass == LATENCY_CLASS_REALTIME) &&
+                    (mCallingUid % AID_USER) >= AID_APP) {
+                // apps can't keep our threads out of the background group,
+                // nor boost them, their tag counts for nothing
+                latencyClass = LATENCY_CLASS_NONE;
+            }
             int curPrio = getpriority(PRIO_PROCESS, mMyThreadId);
             if (gDisableBackgroundScheduling) {
                 if (curPrio > ANDROID_PRIORITY_NORMAL) {
@@ -1006,7 +1256,7 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                     // it back to the default before invoking the transaction.
                     setpriority(PRIO_PROCESS, mMyThreadId, ANDROID_PRIORITY_NORMAL);
                 }
-            } else {
+            } else if (latencyClass == LATENCY_CLASS_NONE) {
                 if (curPrio >= ANDROID_PRIORITY_BACKGROUND) {
                     // We want to use the inherited priority from the caller.
                     // Ensure this thread is in the background scheduling class,
@@ -1016,6 +1266,7 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                     set_sched_policy(mMyThreadId, SP_BACKGROUND);
                 }
             }
+            const bool restore = adoptLatencyClass(latencyClass, curPrio);
 
             //ALOGI(">>>> TRANSACT from pid %d uid %d\n", mCallingPid, mCallingUid);
             
@@ -1031,6 +1282,8 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                     << ", offsets addr="
                     << reinterpret_cast<const size_t*>(tr.data.ptr.offsets) << endl;
             }
+            const bool profile = BinderProfiler::isEnabled();
+            const nsecs_t start = profile ? systemTime(SYSTEM_TIME_MONOTONIC) : 0;
             if (tr.target.ptr) {
                 sp<BBinder> b((BBinder*)tr.cookie);
                 const status_t error = b->transact(tr.code, buffer, &reply, tr.flags);
@@ -1040,6 +1293,16 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 const status_t error = the_context_object->transact(tr.code, buffer, &reply, tr.flags);
                 if (error < NO_ERROR) reply.setError(error);
             }
+            if (profile) {
+                BinderProfiler::record(&mProfile, true, tr.code, buffer,
+                        reply.dataSize(),
+                        systemTime(SYSTEM_TIME_MONOTONIC) - start);
+            }
+            if (restore) {
+                // before the reply, the driver then restores our nice
+                // value as it always does
+                restoreScheduling(curPrio);
+            }
             
             //ALOGI("<<<< TRANSACT from pid %d restore pid %d uid %d\n",
             //     mCallingPid, origPid, origUid);
@@ -1101,6 +1364,62 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
     return result;
 }
 
+bool IPCThreadState::adoptLatencyClass(LatencyClass latencyClass, int curPrio)
+{
+    if (latencyClass == LATENCY_CLASS_FOREGROUND ||
+            latencyClass == LATENCY_CLASS_REALTIME) {
+        // the caller's tag can't lift the thread out of the group the
+        // process was put in, serve it like the rest of the process
+        SchedPolicy processPolicy;
+        if (!gDisableBackgroundScheduling &&
+                get_sched_policy(getpid(), &processPolicy) == 0 &&
+                processPolicy == SP_BACKGROUND) {
+            set_sched_policy(mMyThreadId, SP_BACKGROUND);
+            return false;
+        }
+    }
+
+    switch (latencyClass) {
+    case LATENCY_CLASS_BACKGROUND:
+        if (!gDisableBackgroundScheduling) {
+            set_sched_policy(mMyThreadId, SP_BACKGROUND);
+        }
+        return false;
+
+    case LATENCY_CLASS_REALTIME: {
+        const int priority = mProcess->getRealtimeTransactionPriority();
+        if (priority <= 0 || sched_getscheduler(mMyThreadId) != SCHED_OTHER) {
+            return false;
+        }
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = priority;
+        if (sched_setscheduler(mMyThreadId, SCHED_FIFO, &param) == 0) {
+            return true;
+        }
+        // without CAP_SYS_NICE, get as close as RLIMIT_NICE lets us
+        if (curPrio > ANDROID_PRIORITY_URGENT_DISPLAY) {
+            setpriority(PRIO_PROCESS, mMyThreadId,
+                    ANDROID_PRIORITY_URGENT_DISPLAY);
+            return true;
+        }
+        return false;
+    }
+
+    default:
+        // the pool threads are in the foreground group already
+        return false;
+    }
+}
+
+void IPCThreadState::restoreScheduling(int curPrio)
+{
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    sched_setscheduler(mMyThreadId, SCHED_OTHER, &param);
+    setpriority(PRIO_PROCESS, mMyThreadId, curPrio);
+}
+
 void IPCThreadState::threadDestructor(void *st)
 {
 	IPCThreadState* const self = static_cast<IPCThreadState*>(st);
@@ -22,6 +22,7 @@
 #include <utils/Log.h>
 #include <binder/IPCThreadState.h>
 #include <binder/Parcel.h>
+#include <utils/KeyedVector.h>
 #include <utils/String8.h>
 #include <utils/SystemClock.h>
 
@@ -122,7 +123,8 @@ bool checkPermission(const String16& permission, pid_t pid, uid_t uid)
 
 // ----------------------------------------------------------------------
 
-class BpServiceManager : public BpInterface<IServiceManager>
+class BpServiceManager : public BpInterface<IServiceManager>,
+                         public IBinder::DeathRecipient
 {
 public:
     BpServiceManager(const sp<IBinder>& impl)
@@ -132,6 +134,9 @@ public:
 
     virtual sp<IBinder> getService(const String16& name) const
     {
+        sp<IBinder> svc = getCachedService(name);
+        if (svc != NULL) return svc;
+
         unsigned n;
         for (n = 0; n < 5; n++){
             sp<IBinder> svc = checkService(name);
@@ -144,11 +149,18 @@ public:
 
     virtual sp<IBinder> checkService( const String16& name) const
     {
+        sp<IBinder> svc = getCachedService(name);
+        if (svc != NULL) return svc;
+
         Parcel data, reply;
         data.writeInterfaceToken(IServiceManager::getInterfaceDescriptor());
         data.writeString16(name);
         remote()->transact(CHECK_SERVICE_TRANSACTION, data, &reply);
-        return reply.readStrongBinder();
+        svc = reply.readStrongBinder();
+        if (svc != NULL) {
+            svc = cacheService(name, svc);
+        }
+        return svc;
     }
 
     virtual status_t addService(const String16& name, const sp<IBinder>& service,
@@ -179,6 +191,61 @@ public:
         }
         return res;
     }
+
+    // A dead service is forgotten, the next lookup asks the service
+    // manager again and picks up whatever registered in its place.
+    virtual void binderDied(const wp<IBinder>& who)
+    {
+        AutoMutex _l(mCacheLock);
+        for (size_t i = mCache.size(); i > 0; i--) {
+            if (mCache.valueAt(i-1).get() == who.unsafe_get()) {
+                mCache.removeItemsAt(i-1);
+            }
+        }
+    }
+
+private:
+    sp<IBinder> getCachedService(const String16& name) const
+    {
+        AutoMutex _l(mCacheLock);
+        ssize_t index = mCache.indexOfKey(name);
+        if (index < 0) return NULL;
+        const sp<IBinder>& svc(mCache.valueAt(index));
+        if (!svc->isBinderAlive()) {
+            mCache.removeItemsAt(index);
+            return NULL;
+        }
+        return svc;
+    }
+
+    // Returns what is cached for name once svc is offered, which is what
+    // another thread cached first if it looked the service up at the same
+    // time. Only the thread that adds an entry links to the service, so
+    // that it gets a single death notification.
+    sp<IBinder> cacheService(const String16& name, const sp<IBinder>& svc) const
+    {
+        // only remote services can tell us when they are gone
+        if (svc->remoteBinder() == NULL) return svc;
+        AutoMutex _l(mCacheLock);
+        ssize_t index = mCache.indexOfKey(name);
+        if (index >= 0) {
+            const sp<IBinder>& cached(mCache.valueAt(index));
+            if (cached->isBinderAlive()) {
+                return cached;
+            }
+            mCache.removeItemsAt(index);
+        }
+        // linkToDeath() doesn't wait for binderDied(), holding the lock
+        // is fine, it only delays the notification of a dead service
+        BpServiceManager* self = const_cast<BpServiceManager*>(this);
+        if (svc->linkToDeath(self) == NO_ERROR) {
+            mCache.add(name, svc);
+        }
+        return svc;
+    }
+
+    mutable Mutex mCacheLock;
+    mutable KeyedVector<String16, sp<IBinder> > mCache;
 };
 
 IMPLEMENT_META_INTERFACE(ServiceManager, "android.os.IServiceManager");
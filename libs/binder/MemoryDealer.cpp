@@ -20,6 +20,7 @@
 #include <binder/IPCThreadState.h>
 #include <binder/MemoryBase.h>
 
+#include <utils/KeyedVector.h>
 #include <utils/Log.h>
 #include <utils/SortedVector.h>
 #include <utils/String8.h>
@@ -126,7 +127,7 @@ class SimpleBestFitAllocator
         PAGE_ALIGNED = 0x00000001
     };
 public:
-    SimpleBestFitAllocator(size_t size);
+    SimpleBestFitAllocator(size_t size, bool sizeClasses = false);
     ~SimpleBestFitAllocator();
 
     size_t      allocate(size_t size, uint32_t flags = 0);
@@ -137,9 +138,19 @@ public:
 
 private:
 
+    enum {
+        CHUNK_ALLOCATED = 0,
+        CHUNK_FREE      = 1,
+        // free, but kept on the free list of its size class
+        CHUNK_CACHED    = 2
+    };
+
+    // size classes go from 1 to 1 << (NUM_SIZE_CLASSES-1) kMemoryAlign units
+    enum { NUM_SIZE_CLASSES = 8 };
+
     struct chunk_t {
         chunk_t(size_t start, size_t size)
-        : start(start), size(size), free(1), prev(0), next(0) {
+        : start(start), size(size), free(CHUNK_FREE), prev(0), next(0) {
         }
         size_t              start;
         size_t              size : 28;
@@ -149,7 +160,10 @@ private:
     };
 
     ssize_t  alloc(size_t size, uint32_t flags);
+    chunk_t* bestFit(size_t size, uint32_t flags);
     chunk_t* dealloc(size_t start);
+    chunk_t* merge(chunk_t* cur);
+    bool     uncacheAll_l();
     void     dump_l(const char* what) const;
     void     dump_l(String8& res, const char* what) const;
 
@@ -157,6 +171,12 @@ private:
     mutable Mutex       mLock;
     LinkedList<chunk_t> mList;
     size_t              mHeapSize;
+
+    // POLICY_SIZE_CLASSES only: the allocated chunks by start, and the
+    // cached chunks of each size class
+    const bool          mSizeClasses;
+    KeyedVector<size_t, chunk_t*> mAllocated;
+    Vector<chunk_t*>    mCached[NUM_SIZE_CLASSES];
 };
 
 // ----------------------------------------------------------------------------
@@ -225,9 +245,10 @@ Allocation::~Allocation()
 
 // ----------------------------------------------------------------------------
 
-MemoryDealer::MemoryDealer(size_t size, const char* name)
+MemoryDealer::MemoryDealer(size_t size, const char* name, Policy policy)
     : mHeap(new MemoryHeapBase(size, 0, name)),
-    mAllocator(new SimpleBestFitAllocator(size))
+    mAllocator(new SimpleBestFitAllocator(size,
+            policy == POLICY_SIZE_CLASSES))
 {    
 }
 
@@ -269,7 +290,8 @@ SimpleBestFitAllocator* MemoryDealer::allocator() const {
 // align all the memory blocks on a cache-line boundary
 const int SimpleBestFitAllocator::kMemoryAlign = 32;
 
-SimpleBestFitAllocator::SimpleBestFitAllocator(size_t size)
+SimpleBestFitAllocator::SimpleBestFitAllocator(size_t size, bool sizeClasses)
+    : mSizeClasses(sizeClasses)
 {
     size_t pagesize = getpagesize();
     mHeapSize = ((size + pagesize-1) & ~(pagesize-1));
@@ -307,12 +329,57 @@ status_t SimpleBestFitAllocator::deallocate(size_t offset)
     return NAME_NOT_FOUND;
 }
 
+// the size class of an allocation of units kMemoryAlign units, or -1 if it
+// is too large for one
+static inline int sizeClass(size_t units, int numClasses)
+{
+    int c = 0;
+    while ((size_t(1) << c) < units) {
+        if (++c >= numClasses) {
+            return -1;
+        }
+    }
+    return c;
+}
+
 ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
 {
     if (size == 0) {
         return 0;
     }
     size = (size + kMemoryAlign-1) / kMemoryAlign;
+    if (!mSizeClasses) {
+        chunk_t* chunk = bestFit(size, flags);
+        return chunk ? ssize_t(chunk->start*kMemoryAlign) : ssize_t(NO_MEMORY);
+    }
+
+    const int c = (flags & PAGE_ALIGNED) ? -1 :
+            sizeClass(size, NUM_SIZE_CLASSES);
+    chunk_t* chunk = NULL;
+    if (c >= 0) {
+        size = size_t(1) << c;
+        if (!mCached[c].isEmpty()) {
+            chunk = mCached[c].top();
+            mCached[c].pop();
+            chunk->free = CHUNK_ALLOCATED;
+        }
+    }
+    if (!chunk) {
+        chunk = bestFit(size, flags);
+        if (!chunk && uncacheAll_l()) {
+            chunk = bestFit(size, flags);
+        }
+        if (!chunk) {
+            return NO_MEMORY;
+        }
+    }
+    mAllocated.add(chunk->start, chunk);
+    return chunk->start*kMemoryAlign;
+}
+
+SimpleBestFitAllocator::chunk_t* SimpleBestFitAllocator::bestFit(
+        size_t size, uint32_t flags)
+{
     chunk_t* free_chunk = 0;
     chunk_t* cur = mList.head();
 
@@ -323,7 +390,7 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
             extra = ( -cur->start & ((pagesize/kMemoryAlign)-1) ) ;
 
         // best fit
-        if (cur->free && (cur->size >= (size+extra))) {
+        if (cur->free == CHUNK_FREE && (cur->size >= (size+extra))) {
             if ((!free_chunk) || (cur->size < free_chunk->size)) {
                 free_chunk = cur;
             }
@@ -336,7 +403,7 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
 
     if (free_chunk) {
         const size_t free_size = free_chunk->size;
-        free_chunk->free = 0;
+        free_chunk->free = CHUNK_ALLOCATED;
         free_chunk->size = size;
         if (free_size > size) {
             int extra = 0;
@@ -359,52 +426,86 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
                 mList.insertAfter(free_chunk, split);
             }
         }
-        return (free_chunk->start)*kMemoryAlign;
+        return free_chunk;
     }
-    return NO_MEMORY;
+    return 0;
 }
 
 SimpleBestFitAllocator::chunk_t* SimpleBestFitAllocator::dealloc(size_t start)
 {
     start = start / kMemoryAlign;
+    if (mSizeClasses) {
+        const ssize_t index = mAllocated.indexOfKey(start);
+        if (index < 0) {
+            return 0;
+        }
+        chunk_t* const cur = mAllocated.valueAt(index);
+        mAllocated.removeItemsAt(index);
+        const int c = sizeClass(cur->size, NUM_SIZE_CLASSES);
+        if (c >= 0 && (size_t(1) << c) == cur->size) {
+            cur->free = CHUNK_CACHED;
+            mCached[c].push(cur);
+            return cur;
+        }
+        return merge(cur);
+    }
+
     chunk_t* cur = mList.head();
     while (cur) {
         if (cur->start == start) {
             LOG_FATAL_IF(cur->free,
                 "block at offset 0x%08lX of size 0x%08lX already freed",
                 cur->start*kMemoryAlign, cur->size*kMemoryAlign);
-
-            // merge freed blocks together
-            chunk_t* freed = cur;
-            cur->free = 1;
-            do {
-                chunk_t* const p = cur->prev;
-                chunk_t* const n = cur->next;
-                if (p && (p->free || !cur->size)) {
-                    freed = p;
-                    p->size += cur->size;
-                    mList.remove(cur);
-                    delete cur;
-                }
-                cur = n;
-            } while (cur && cur->free);
-
-            #ifndef NDEBUG
-                if (!freed->free) {
-                    dump_l("dealloc (!freed->free)");
-                }
-            #endif
-            LOG_FATAL_IF(!freed->free,
-                "freed block at offset 0x%08lX of size 0x%08lX is not free!",
-                freed->start * kMemoryAlign, freed->size * kMemoryAlign);
-
-            return freed;
+            return merge(cur);
         }
         cur = cur->next;
     }
     return 0;
 }
 
+SimpleBestFitAllocator::chunk_t* SimpleBestFitAllocator::merge(chunk_t* cur)
+{
+    // merge freed blocks together
+    chunk_t* freed = cur;
+    cur->free = CHUNK_FREE;
+    do {
+        chunk_t* const p = cur->prev;
+        chunk_t* const n = cur->next;
+        if (p && (p->free == CHUNK_FREE || !cur->size)) {
+            freed = p;
+            p->size += cur->size;
+            mList.remove(cur);
+            delete cur;
+        }
+        cur = n;
+    } while (cur && cur->free == CHUNK_FREE);
+
+    #ifndef NDEBUG
+        if (freed->free != CHUNK_FREE) {
+            dump_l("dealloc (!freed->free)");
+        }
+    #endif
+    LOG_FATAL_IF(freed->free != CHUNK_FREE,
+        "freed block at offset 0x%08lX of size 0x%08lX is not free!",
+        freed->start * kMemoryAlign, freed->size * kMemoryAlign);
+
+    return freed;
+}
+
+bool SimpleBestFitAllocator::uncacheAll_l()
+{
+    bool uncached = false;
+    for (int c=0 ; c<NUM_SIZE_CLASSES ; c++) {
+        // the chunks still cached aren't free, merge() leaves them alone
+        for (size_t i=0 ; i<mCached[c].size() ; i++) {
+            merge(mCached[c][i]);
+            uncached = true;
+        }
+        mCached[c].clear();
+    }
+    return uncached;
+}
+
 void SimpleBestFitAllocator::dump(const char* what) const
 {
     Mutex::Autolock _l(mLock);
@@ -429,6 +530,9 @@ void SimpleBestFitAllocator::dump_l(String8& result,
         const char* what) const
 {
     size_t size = 0;
+    size_t freeSize = 0;
+    size_t freeBlocks = 0;
+    size_t largestFree = 0;
     int32_t i = 0;
     chunk_t const* cur = mList.head();
     
@@ -448,13 +552,20 @@ void SimpleBestFitAllocator::dump_l(String8& result,
         snprintf(buffer, SIZE, "  %3u: %08x | 0x%08X | 0x%08X | %s %s\n",
             i, int(cur), int(cur->start*kMemoryAlign),
             int(cur->size*kMemoryAlign),
-                    int(cur->free) ? "F" : "A",
+                    cur->free == CHUNK_FREE ? "F" :
+                            (cur->free == CHUNK_CACHED ? "C" : "A"),
                     errs[np|pn]);
         
         result.append(buffer);
 
-        if (!cur->free)
+        if (cur->free == CHUNK_ALLOCATED) {
             size += cur->size*kMemoryAlign;
+        } else if (cur->free == CHUNK_FREE) {
+            freeSize += cur->size*kMemoryAlign;
+            freeBlocks++;
+            if (cur->size*kMemoryAlign > largestFree)
+                largestFree = cur->size*kMemoryAlign;
+        }
 
         i++;
         cur = cur->next;
@@ -462,6 +573,20 @@ void SimpleBestFitAllocator::dump_l(String8& result,
     snprintf(buffer, SIZE,
             "  size allocated: %u (%u KB)\n", int(size), int(size/1024));
     result.append(buffer);
+
+    // how much of the free space can't be had as one block
+    result.appendFormat("  free: %u bytes in %u blocks, largest %u bytes "
+            "(%u%% fragmented)\n",
+            unsigned(freeSize), unsigned(freeBlocks), unsigned(largestFree),
+            freeSize ? unsigned(100 - (largestFree * 100) / freeSize) : 0);
+    if (mSizeClasses) {
+        result.append("  cached:");
+        for (int c=0 ; c<NUM_SIZE_CLASSES ; c++) {
+            result.appendFormat(" %u x %u", unsigned(mCached[c].size()),
+                    unsigned((size_t(1) << c) * kMemoryAlign));
+        }
+        result.append("\n");
+    }
 }
 
 
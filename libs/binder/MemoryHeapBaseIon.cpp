@@ -49,12 +49,21 @@ MemoryHeapBaseIon::MemoryHeapBaseIon(size_t size, uint32_t flags, char const *na
         ALOGE("MemoryHeapBaseIon : ION client creation failed");
     }
     void* base = NULL;
-    int fd = ion_alloc(mIonClient, size, 0, ION_HEAP_EXYNOS_MASK);
+    unsigned int ionFlags = ION_HEAP_EXYNOS_MASK;
+#ifdef ION_EXYNOS_NONCACHE_MASK
+    if (flags & NO_CACHING) {
+        ionFlags |= ION_EXYNOS_NONCACHE_MASK;
+    }
+#endif
+    int fd = ion_alloc(mIonClient, size, 0, ionFlags);
 
     if (fd < 0) {
         ALOGE("MemoryHeapBaseIon : ION memory allocation failed");
     } else {
         flags |= USE_ION_FD;
+        if (!(flags & NO_CACHING)) {
+            flags |= CACHED;
+        }
         base = ion_map(fd, size, 0);
         if (base != MAP_FAILED)
             init(fd, base, size, flags, NULL);
@@ -75,6 +84,10 @@ MemoryHeapBaseIon::MemoryHeapBaseIon(int fd, size_t size, uint32_t flags, uint32
     if (fd >= 0) {
         int dup_fd = dup(fd);
         flags |= USE_ION_FD;
+        // the buffer was allocated elsewhere: the caller says how
+        if (!(flags & NO_CACHING)) {
+            flags |= CACHED;
+        }
         base = ion_map(dup_fd, size, 0);
         if (base != MAP_FAILED)
             init(dup_fd, base, size, flags, NULL);
@@ -93,4 +106,49 @@ MemoryHeapBaseIon::~MemoryHeapBaseIon()
     }
 }
 
+status_t MemoryHeapBaseIon::flush(size_t offset, size_t size) const
+{
+    return syncCache(offset, size, true);
+}
+
+status_t MemoryHeapBaseIon::invalidate(size_t offset, size_t size) const
+{
+    return syncCache(offset, size, false);
+}
+
+status_t MemoryHeapBaseIon::syncCache(size_t offset, size_t size,
+        bool forDevice) const
+{
+    if (!(getFlags() & CACHED)) {
+        return NO_ERROR;
+    }
+    if (mIonClient < 0) {
+        return NO_INIT;
+    }
+    return syncCache(mIonClient, getHeapID(), getSize(), getOffset(),
+            offset, size, forDevice);
+}
+
+status_t MemoryHeapBaseIon::syncCache(int ionClient, int fd, size_t heapSize,
+        uint32_t bufferOffset, size_t offset, size_t size, bool forDevice)
+{
+    if (offset > heapSize || size > heapSize - offset) {
+        return BAD_VALUE;
+    }
+    if (size == 0) {
+        return NO_ERROR;
+    }
+    // flush: the CPU wrote, the device will read.
+    // invalidate: the device wrote, the CPU will read.
+    const ION_MSYNC_FLAGS flags = static_cast<ION_MSYNC_FLAGS>(forDevice ?
+            (IMSYNC_DEV_TO_READ | IMSYNC_SYNC_FOR_DEV) :
+            (IMSYNC_DEV_TO_WRITE | IMSYNC_SYNC_FOR_CPU));
+    if (ion_msync(ionClient, fd, flags, size, bufferOffset + offset) < 0) {
+        ALOGE("MemoryHeapBaseIon : cache %s of %zu bytes at %zu failed",
+                forDevice ? "flush" : "invalidate", size, offset);
+        return UNKNOWN_ERROR;
+    }
+    return NO_ERROR;
+}
+
 };
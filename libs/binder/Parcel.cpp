@@ -19,6 +19,7 @@
 
 #include <binder/Parcel.h>
 
+#include <binder/BlobPool.h>
 #include <binder/IPCThreadState.h>
 #include <binder/Binder.h>
 #include <binder/BpBinder.h>
@@ -33,12 +34,17 @@
 #include <cutils/ashmem.h>
 
 #include <private/binder/binder_module.h>
+#include <private/binder/Static.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <sys/mman.h>
 
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
 #ifndef INT32_MAX
 #define INT32_MAX ((int32_t)(2147483647))
 #endif
@@ -59,6 +65,58 @@
 // Maximum size of a blob to transfer in-place.
 static const size_t IN_PLACE_BLOB_LIMIT = 40 * 1024;
 
+// How a blob is transferred, see writeBlob()
+enum {
+    BLOB_INPLACE = 0,
+    BLOB_ASHMEM = 1,
+    BLOB_POOLED = 2,
+};
+
+#ifdef HAVE_PTHREADS
+// Up to MAX_ARENA_BUFFERS data buffers of at most MAX_ARENA_BUFFER_SIZE
+// bytes are kept per thread for the next Parcels that outgrow their
+// inline buffer. A transaction and its reply typically need two.
+static const size_t MAX_ARENA_BUFFERS = 4;
+static const size_t MAX_ARENA_BUFFER_SIZE = 4096;
+
+struct parcel_arena {
+    size_t count;
+    uint8_t* data[MAX_ARENA_BUFFERS];
+    size_t capacity[MAX_ARENA_BUFFERS];
+};
+
+static pthread_once_t gParcelArenaOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t gParcelArenaKey;
+
+static void freeParcelArena(void* p)
+{
+    parcel_arena* arena = static_cast<parcel_arena*>(p);
+    for (size_t i=0 ; i<arena->count ; i++) {
+        free(arena->data[i]);
+    }
+    free(arena);
+}
+
+static void initParcelArenaKey()
+{
+    pthread_key_create(&gParcelArenaKey, freeParcelArena);
+}
+
+static parcel_arena* getParcelArena()
+{
+    pthread_once(&gParcelArenaOnce, initParcelArenaKey);
+    parcel_arena* arena =
+            static_cast<parcel_arena*>(pthread_getspecific(gParcelArenaKey));
+    if (arena == NULL) {
+        arena = static_cast<parcel_arena*>(calloc(1, sizeof(parcel_arena)));
+        if (arena) {
+            pthread_setspecific(gParcelArenaKey, arena);
+        }
+    }
+    return arena;
+}
+#endif
+
 // XXX This can be made public if we want to provide
 // support for typed data.
 struct small_flat_data
@@ -410,8 +468,7 @@ status_t Parcel::appendFrom(const Parcel *parcel, size_t offset, size_t len)
         // grow objects
         if (mObjectsCapacity < mObjectsSize + numObjects) {
             int newSize = ((mObjectsSize + numObjects)*3)/2;
-            size_t *objects =
-                (size_t*)realloc(mObjects, newSize*sizeof(size_t));
+            size_t *objects = reallocObjects(newSize);
             if (objects == (size_t*)0) {
                 return NO_MEMORY;
             }
@@ -500,12 +557,17 @@ bool Parcel::enforceInterface(const String16& interface,
     } else {
       threadState->setStrictModePolicy(strictPolicy);
     }
-    const String16 str(readString16());
-    if (str == interface) {
+    // Compare the token where it is in the parcel, rather than copying it
+    // into a String16 first; this runs for every incoming transaction.
+    size_t len;
+    const char16_t* str = readString16Inplace(&len);
+    if (str != NULL && len == interface.size()
+            && memcmp(str, interface.string(), len * sizeof(char16_t)) == 0) {
         return true;
     } else {
         ALOGW("**** enforceInterface() expected '%s' but read '%s'\n",
-                String8(interface).string(), String8(str).string());
+                String8(interface).string(),
+                str != NULL ? String8(str, len).string() : "");
         return false;
     }
 }
@@ -755,7 +817,7 @@ status_t Parcel::writeBlob(size_t len, WritableBlob* outBlob)
 
     if (!mAllowFds || len <= IN_PLACE_BLOB_LIMIT) {
         ALOGV("writeBlob: write in place");
-        status = writeInt32(0);
+        status = writeInt32(BLOB_INPLACE);
         if (status) return status;
 
         void* ptr = writeInplace(len);
@@ -781,7 +843,7 @@ status_t Parcel::writeBlob(size_t len, WritableBlob* outBlob)
             if (result < 0) {
                 status = result;
             } else {
-                status = writeInt32(1);
+                status = writeInt32(BLOB_ASHMEM);
                 if (!status) {
                     status = writeFileDescriptor(fd, true /*takeOwnership*/);
                     if (!status) {
@@ -797,6 +859,30 @@ status_t Parcel::writeBlob(size_t len, WritableBlob* outBlob)
     return status;
 }
 
+status_t Parcel::writeBlob(size_t len, const sp<BlobPool>& pool,
+        WritableBlob* outBlob)
+{
+    if (!mAllowFds || len <= IN_PLACE_BLOB_LIMIT || pool == NULL ||
+            pool->initCheck() != NO_ERROR || len > pool->getCapacity()) {
+        return writeBlob(len, outBlob);
+    }
+
+    ALOGV("writeBlob: write to pool %llx", pool->mId);
+    int32_t index;
+    const BlobPool::Buffer& buffer(pool->nextBuffer(&index));
+    status_t status = writeInt32(BLOB_POOLED);
+    if (!status) status = writeInt64(pool->mId);
+    if (!status) status = writeInt32(index);
+    if (!status) status = writeInt32(pool->getCapacity());
+    // the receiver only maps the buffer the first time it gets it, but
+    // sending it each time spares us from tracking who has it
+    if (!status) status = writeDupFileDescriptor(buffer.fd);
+    if (status) return status;
+
+    outBlob->init(false /*mapped*/, buffer.data, len);
+    return NO_ERROR;
+}
+
 status_t Parcel::write(const Flattenable& val)
 {
     status_t err;
@@ -865,7 +951,7 @@ restart_write:
     }
     if (!enoughObjects) {
         size_t newSize = ((mObjectsSize+2)*3)/2;
-        size_t* objects = (size_t*)realloc(mObjects, newSize*sizeof(size_t));
+        size_t* objects = reallocObjects(newSize);
         if (objects == NULL) return NO_MEMORY;
         mObjects = objects;
         mObjectsCapacity = newSize;
@@ -1153,7 +1239,23 @@ status_t Parcel::readBlob(size_t len, ReadableBlob* outBlob) const
     status_t status = readInt32(&useAshmem);
     if (status) return status;
 
-    if (!useAshmem) {
+    if (useAshmem == BLOB_POOLED) {
+        ALOGV("readBlob: read from pool");
+        // the pool and buffer the sender says these are: only informative
+        readInt64();
+        readInt32();
+        size_t capacity = size_t(readInt32());
+        int fd = readFileDescriptor();
+        if (fd == int(BAD_TYPE) || len > capacity) return BAD_VALUE;
+
+        void* ptr = ::mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED) return NO_MEMORY;
+
+        outBlob->init(true /*mapped*/, ptr, len);
+        return NO_ERROR;
+    }
+
+    if (useAshmem == BLOB_INPLACE) {
         ALOGV("readBlob: read in place");
         const void* ptr = readInplace(len);
         if (!ptr) return BAD_VALUE;
@@ -1167,7 +1269,7 @@ status_t Parcel::readBlob(size_t len, ReadableBlob* outBlob) const
     if (fd == int(BAD_TYPE)) return BAD_VALUE;
 
     void* ptr = ::mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
-    if (!ptr) return NO_MEMORY;
+    if (ptr == MAP_FAILED) return NO_MEMORY;
 
     outBlob->init(true /*mapped*/, ptr, len);
     return NO_ERROR;
@@ -1388,8 +1490,8 @@ void Parcel::freeDataNoInit()
         mOwner(this, mData, mDataSize, mObjects, mObjectsSize, mOwnerCookie);
     } else {
         releaseObjects();
-        if (mData) free(mData);
-        if (mObjects) free(mObjects);
+        if (mData) freeDataBuffer(mData, mDataCapacity);
+        if (mObjects) freeObjects(mObjects);
     }
 }
 
@@ -1408,7 +1510,8 @@ status_t Parcel::restartWrite(size_t desired)
         return continueWrite(desired);
     }
     
-    uint8_t* data = (uint8_t*)realloc(mData, desired);
+    size_t capacity;
+    uint8_t* data = reallocData(desired, &capacity);
     if (!data && desired > mDataCapacity) {
         mError = NO_MEMORY;
         return NO_MEMORY;
@@ -1418,14 +1521,14 @@ status_t Parcel::restartWrite(size_t desired)
     
     if (data) {
         mData = data;
-        mDataCapacity = desired;
+        mDataCapacity = capacity;
     }
     
     mDataSize = mDataPos = 0;
     ALOGV("restartWrite Setting data size of %p to %d\n", this, mDataSize);
     ALOGV("restartWrite Setting data pos of %p to %d\n", this, mDataPos);
         
-    free(mObjects);
+    freeObjects(mObjects);
     mObjects = NULL;
     mObjectsSize = mObjectsCapacity = 0;
     mNextObjectHint = 0;
@@ -1462,7 +1565,8 @@ status_t Parcel::continueWrite(size_t desired)
 
         // If there is a different owner, we need to take
         // posession.
-        uint8_t* data = (uint8_t*)malloc(desired);
+        size_t capacity;
+        uint8_t* data = allocData(desired, &capacity);
         if (!data) {
             mError = NO_MEMORY;
             return NO_MEMORY;
@@ -1470,9 +1574,10 @@ status_t Parcel::continueWrite(size_t desired)
         size_t* objects = NULL;
         
         if (objectsSize) {
-            objects = (size_t*)malloc(objectsSize*sizeof(size_t));
+            objects = objectsSize <= INLINE_OBJECTS_CAPACITY ? mInlineObjects
+                    : (size_t*)malloc(objectsSize*sizeof(size_t));
             if (!objects) {
-                free(data);
+                freeDataBuffer(data, capacity);
 
                 mError = NO_MEMORY;
                 return NO_MEMORY;
@@ -1500,7 +1605,7 @@ status_t Parcel::continueWrite(size_t desired)
         mObjects = objects;
         mDataSize = (mDataSize < desired) ? mDataSize : desired;
         ALOGV("continueWrite Setting data size of %p to %d\n", this, mDataSize);
-        mDataCapacity = desired;
+        mDataCapacity = capacity;
         mObjectsSize = mObjectsCapacity = objectsSize;
         mNextObjectHint = 0;
 
@@ -1517,8 +1622,7 @@ status_t Parcel::continueWrite(size_t desired)
                 }
                 release_object(proc, *flat, this);
             }
-            size_t* objects =
-                (size_t*)realloc(mObjects, objectsSize*sizeof(size_t));
+            size_t* objects = reallocObjects(objectsSize);
             if (objects) {
                 mObjects = objects;
             }
@@ -1528,10 +1632,11 @@ status_t Parcel::continueWrite(size_t desired)
 
         // We own the data, so we can just do a realloc().
         if (desired > mDataCapacity) {
-            uint8_t* data = (uint8_t*)realloc(mData, desired);
+            size_t capacity;
+            uint8_t* data = reallocData(desired, &capacity);
             if (data) {
                 mData = data;
-                mDataCapacity = desired;
+                mDataCapacity = capacity;
             } else if (desired > mDataCapacity) {
                 mError = NO_MEMORY;
                 return NO_MEMORY;
@@ -1549,7 +1654,8 @@ status_t Parcel::continueWrite(size_t desired)
         
     } else {
         // This is the first data.  Easy!
-        uint8_t* data = (uint8_t*)malloc(desired);
+        size_t capacity;
+        uint8_t* data = allocData(desired, &capacity);
         if (!data) {
             mError = NO_MEMORY;
             return NO_MEMORY;
@@ -1564,12 +1670,97 @@ status_t Parcel::continueWrite(size_t desired)
         mDataSize = mDataPos = 0;
         ALOGV("continueWrite Setting data size of %p to %d\n", this, mDataSize);
         ALOGV("continueWrite Setting data pos of %p to %d\n", this, mDataPos);
-        mDataCapacity = desired;
+        mDataCapacity = capacity;
     }
 
     return NO_ERROR;
 }
 
+uint8_t* Parcel::allocData(size_t desired, size_t* outCapacity)
+{
+    if (desired <= INLINE_DATA_CAPACITY) {
+        *outCapacity = INLINE_DATA_CAPACITY;
+        return inlineData();
+    }
+    *outCapacity = desired;
+#ifdef HAVE_PTHREADS
+    parcel_arena* arena = getParcelArena();
+    if (arena) {
+        // the smallest of the cached buffers that is large enough
+        ssize_t best = -1;
+        for (size_t i=0 ; i<arena->count ; i++) {
+            if (arena->capacity[i] >= desired &&
+                    (best < 0 || arena->capacity[i] < arena->capacity[best])) {
+                best = i;
+            }
+        }
+        if (best >= 0) {
+            uint8_t* data = arena->data[best];
+            *outCapacity = arena->capacity[best];
+            arena->count--;
+            arena->data[best] = arena->data[arena->count];
+            arena->capacity[best] = arena->capacity[arena->count];
+            return data;
+        }
+    }
+#endif
+    return (uint8_t*)malloc(desired);
+}
+
+uint8_t* Parcel::reallocData(size_t desired, size_t* outCapacity)
+{
+    if (mData == NULL || mData == inlineData()) {
+        uint8_t* data = allocData(desired, outCapacity);
+        if (data && mData && data != mData) {
+            memcpy(data, mData, mDataCapacity < desired ? mDataCapacity : desired);
+        }
+        return data;
+    }
+    *outCapacity = desired;
+    return (uint8_t*)realloc(mData, desired);
+}
+
+void Parcel::freeDataBuffer(uint8_t* data, size_t capacity)
+{
+    if (data == inlineData()) {
+        return;
+    }
+#ifdef HAVE_PTHREADS
+    if (capacity <= MAX_ARENA_BUFFER_SIZE) {
+        parcel_arena* arena = getParcelArena();
+        if (arena && arena->count < MAX_ARENA_BUFFERS) {
+            arena->data[arena->count] = data;
+            arena->capacity[arena->count] = capacity;
+            arena->count++;
+            return;
+        }
+    }
+#endif
+    free(data);
+}
+
+size_t* Parcel::reallocObjects(size_t desired)
+{
+    if (mObjects == NULL || mObjects == mInlineObjects) {
+        if (desired <= INLINE_OBJECTS_CAPACITY) {
+            return mInlineObjects;
+        }
+        size_t* objects = (size_t*)malloc(desired*sizeof(size_t));
+        if (objects && mObjects) {
+            memcpy(objects, mObjects, mObjectsSize*sizeof(size_t));
+        }
+        return objects;
+    }
+    return (size_t*)realloc(mObjects, desired*sizeof(size_t));
+}
+
+void Parcel::freeObjects(size_t* objects)
+{
+    if (objects != mInlineObjects) {
+        free(objects);
+    }
+}
+
 void Parcel::initState()
 {
     mError = NO_ERROR;
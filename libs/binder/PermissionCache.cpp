@@ -29,9 +29,19 @@ namespace android {
 
 ANDROID_SINGLETON_STATIC_INSTANCE(PermissionCache) ;
 
+// a denial is checked again after that long
+static const nsecs_t DENIAL_TTL = s2ns(5);
+
+// and a grant after that long, grants are by far the most common
+static const nsecs_t GRANT_TTL = s2ns(60);
+
+// the cache is trimmed when it gets that big
+static const size_t MAX_ENTRIES = 256;
+
 // ----------------------------------------------------------------------------
 
-PermissionCache::PermissionCache() {
+PermissionCache::PermissionCache()
+    : mHits(0), mMisses(0) {
 }
 
 status_t PermissionCache::check(bool* granted,
@@ -42,18 +52,24 @@ status_t PermissionCache::check(bool* granted,
     e.uid  = uid;
     ssize_t index = mCache.indexOf(e);
     if (index >= 0) {
-        *granted = mCache.itemAt(index).granted;
-        return NO_ERROR;
+        const Entry& entry(mCache.itemAt(index));
+        if (entry.expires > systemTime()) {
+            *granted = entry.granted;
+            mHits++;
+            return NO_ERROR;
+        }
     }
+    mMisses++;
     return NAME_NOT_FOUND;
 }
 
 void PermissionCache::cache(const String16& permission,
         uid_t uid, bool granted) {
     Mutex::Autolock _l(mLock);
+    const nsecs_t now = systemTime();
     Entry e;
     ssize_t index = mPermissionNamesPool.indexOf(permission);
-    if (index > 0) {
+    if (index >= 0) {
         e.name = mPermissionNamesPool.itemAt(index);
     } else {
         mPermissionNamesPool.add(permission);
@@ -63,9 +79,28 @@ void PermissionCache::cache(const String16& permission,
     // permission checks
     e.uid  = uid;
     e.granted = granted;
+    e.expires = now + (granted ? GRANT_TTL : DENIAL_TTL);
     index = mCache.indexOf(e);
-    if (index < 0) {
-        mCache.add(e);
+    if (index >= 0) {
+        // an expired entry, checked again
+        mCache.editItemAt(index) = e;
+        return;
+    }
+    if (mCache.size() >= MAX_ENTRIES) {
+        trimLocked(now);
+    }
+    mCache.add(e);
+}
+
+void PermissionCache::trimLocked(nsecs_t now) {
+    for (size_t i=mCache.size() ; i>0 ; i--) {
+        const Entry& e(mCache.itemAt(i-1));
+        if (e.expires <= now) {
+            mCache.removeAt(i-1);
+        }
+    }
+    if (mCache.size() >= MAX_ENTRIES) {
+        mCache.clear();
     }
 }
 
@@ -74,6 +109,28 @@ void PermissionCache::purge() {
     mCache.clear();
 }
 
+void PermissionCache::dump(String8& result) {
+    PermissionCache& pc(PermissionCache::getInstance());
+    Mutex::Autolock _l(pc.mLock);
+    const nsecs_t now = systemTime();
+    const uint32_t lookups = pc.mHits + pc.mMisses;
+    result.appendFormat("Permission cache: %u entries, hits=%u, misses=%u "
+            "(%u%% hit rate)\n", uint32_t(pc.mCache.size()),
+            pc.mHits, pc.mMisses, lookups ? (pc.mHits * 100) / lookups : 0);
+    for (size_t i=0 ; i<pc.mCache.size() ; i++) {
+        const Entry& e(pc.mCache.itemAt(i));
+        result.appendFormat("  uid=%d %s: %s", e.uid,
+                String8(e.name).string(), e.granted ? "granted" : "denied");
+        if (e.expires > now) {
+            result.appendFormat(" (expires in %lld ms)",
+                    (long long)ns2ms(e.expires - now));
+        } else {
+            result.append(" (expired)");
+        }
+        result.append("\n");
+    }
+}
+
 bool PermissionCache::checkCallingPermission(const String16& permission) {
     return PermissionCache::checkCallingPermission(permission, NULL, NULL);
 }
@@ -16,6 +16,7 @@
 
 #define LOG_TAG "ProcessState"
 
+#include <cutils/atomic-inline.h>
 #include <cutils/process_name.h>
 
 #include <binder/ProcessState.h>
@@ -34,14 +35,17 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 
 #define BINDER_VM_SIZE ((1*1024*1024) - (4096 *2))
+#define DEFAULT_MAX_BINDER_THREADS 15
 
 
 // ---------------------------------------------------------------------------
@@ -56,19 +60,20 @@ int                 mArgLen;
 class PoolThread : public Thread
 {
 public:
-    PoolThread(bool isMain)
-        : mIsMain(isMain)
+    PoolThread(bool isMain, bool mayRetire)
+        : mIsMain(isMain), mMayRetire(mayRetire)
     {
     }
     
 protected:
     virtual bool threadLoop()
     {
-        IPCThreadState::self()->joinThreadPool(mIsMain);
+        IPCThreadState::self()->joinThreadPool(mIsMain, mMayRetire);
         return false;
     }
     
     const bool mIsMain;
+    const bool mMayRetire;
 };
 
 sp<ProcessState> ProcessState::self()
@@ -169,21 +174,70 @@ bool ProcessState::becomeContextManager(context_check_func checkFunc, void* user
 
 ProcessState::handle_entry* ProcessState::lookupHandleLocked(int32_t handle)
 {
-    const size_t N=mHandleToObject.size();
-    if (N <= (size_t)handle) {
-        handle_entry e;
-        e.binder = NULL;
-        e.refs = NULL;
-        status_t err = mHandleToObject.insertAt(e, N, handle+1-N);
-        if (err < NO_ERROR) return NULL;
+    if (handle < 0 || handle >= HANDLE_SEGMENT_SIZE * MAX_HANDLE_SEGMENTS) {
+        ALOGE("handle %d doesn't fit in the handle table", handle);
+        return NULL;
+    }
+    handle_entry*& segment(const_cast<handle_entry*&>(
+            mHandleSegments[handle / HANDLE_SEGMENT_SIZE]));
+    if (segment == NULL) {
+        handle_entry* entries = new handle_entry[HANDLE_SEGMENT_SIZE];
+        memset(entries, 0, sizeof(handle_entry) * HANDLE_SEGMENT_SIZE);
+        // the entries must be seen cleared before the segment
+        android_memory_barrier();
+        segment = entries;
+    }
+    return &segment[handle % HANDLE_SEGMENT_SIZE];
+}
+
+ProcessState::handle_entry* ProcessState::peekHandle(int32_t handle) const
+{
+    if (handle < 0 || handle >= HANDLE_SEGMENT_SIZE * MAX_HANDLE_SEGMENTS) {
+        return NULL;
     }
-    return &mHandleToObject.editItemAt(handle);
+    handle_entry* segment = mHandleSegments[handle / HANDLE_SEGMENT_SIZE];
+    android_memory_barrier();
+    return segment ? &segment[handle % HANDLE_SEGMENT_SIZE] : NULL;
+}
+
+IBinder* ProcessState::attemptWeakProxy(int32_t handle)
+{
+    handle_entry* e = peekHandle(handle);
+    if (e == NULL) {
+        return NULL;
+    }
+
+    // Once we're counted, expungeHandle() can't return, and the refs of the
+    // binder we read can't be freed, until we're done with them.
+    android_atomic_inc(&e->readers);
+    IBinder* b = e->binder;
+    android_memory_barrier();
+    RefBase::weakref_type* refs = e->refs;
+    android_memory_barrier();
+    if (b != NULL && b == e->binder && refs->attemptIncWeak(this)) {
+        // the binder didn't change while we read its refs
+    } else {
+        b = NULL;
+    }
+    android_atomic_dec(&e->readers);
+    return b;
 }
 
 sp<IBinder> ProcessState::getStrongProxyForHandle(int32_t handle)
 {
     sp<IBinder> result;
 
+    // most of the time the proxy exists, and that doesn't need mLock
+    IBinder* proxy = attemptWeakProxy(handle);
+    if (proxy != NULL) {
+        // This little bit of nastyness is to allow us to add a primary
+        // reference to the remote proxy when this team doesn't have one
+        // but another team is sending the handle to us.
+        result.force_set(proxy);
+        proxy->getWeakRefs()->decWeak(this);
+        return result;
+    }
+
     AutoMutex _l(mLock);
 
     handle_entry* e = lookupHandleLocked(handle);
@@ -195,13 +249,9 @@ sp<IBinder> ProcessState::getStrongProxyForHandle(int32_t handle)
         IBinder* b = e->binder;
         if (b == NULL || !e->refs->attemptIncWeak(this)) {
             b = new BpBinder(handle); 
-            e->binder = b;
-            if (b) e->refs = b->getWeakRefs();
+            publishHandleLocked(e, b);
             result = b;
         } else {
-            // This little bit of nastyness is to allow us to add a primary
-            // reference to the remote proxy when this team doesn't have one
-            // but another team is sending the handle to us.
             result.force_set(b);
             e->refs->decWeak(this);
         }
@@ -214,6 +264,13 @@ wp<IBinder> ProcessState::getWeakProxyForHandle(int32_t handle)
 {
     wp<IBinder> result;
 
+    IBinder* proxy = attemptWeakProxy(handle);
+    if (proxy != NULL) {
+        result = proxy;
+        proxy->getWeakRefs()->decWeak(this);
+        return result;
+    }
+
     AutoMutex _l(mLock);
 
     handle_entry* e = lookupHandleLocked(handle);
@@ -230,8 +287,7 @@ wp<IBinder> ProcessState::getWeakProxyForHandle(int32_t handle)
         if (b == NULL || !e->refs->attemptIncWeak(this)) {
             b = new BpBinder(handle);
             result = b;
-            e->binder = b;
-            if (b) e->refs = b->getWeakRefs();
+            publishHandleLocked(e, b);
         } else {
             result = b;
             e->refs->decWeak(this);
@@ -241,6 +297,17 @@ wp<IBinder> ProcessState::getWeakProxyForHandle(int32_t handle)
     return result;
 }
 
+void ProcessState::publishHandleLocked(handle_entry* e, IBinder* binder)
+{
+    // attemptWeakProxy() reads binder, refs, then binder again: clearing
+    // the binder first means it never pairs it with the wrong refs
+    e->binder = NULL;
+    android_memory_barrier();
+    e->refs = binder->getWeakRefs();
+    android_memory_barrier();
+    e->binder = binder;
+}
+
 void ProcessState::expungeHandle(int32_t handle, IBinder* binder)
 {
     AutoMutex _l(mLock);
@@ -251,6 +318,16 @@ void ProcessState::expungeHandle(int32_t handle, IBinder* binder)
     // (if someone failed the AttemptIncWeak() above); we don't want
     // to overwrite it.
     if (e && e->binder == binder) e->binder = NULL;
+
+    // A lookup without mLock may still be trying the refs of the binder
+    // being destroyed, they are freed when we return. Lookups that start
+    // now can't see them anymore, so this doesn't wait for long.
+    if (e) {
+        android_memory_barrier();
+        while (android_atomic_acquire_load(&e->readers) != 0) {
+            sched_yield();
+        }
+    }
 }
 
 void ProcessState::setArgs(int argc, const char* const argv[])
@@ -291,12 +368,24 @@ String8 ProcessState::makeBinderThreadName() {
 }
 
 void ProcessState::spawnPooledThread(bool isMain)
+{
+    // the threads the driver asks for can leave the pool, not its main one
+    spawnPooledThread(isMain, !isMain);
+}
+
+void ProcessState::spawnPooledThread(bool isMain, bool mayRetire)
 {
     if (mThreadPoolStarted) {
         String8 name = makeBinderThreadName();
         ALOGV("Spawning new pooled thread, name=%s\n", name.string());
-        sp<Thread> t = new PoolThread(isMain);
-        t->run(name.string());
+        size_t stackSize;
+        {
+            Mutex::Autolock _l(mThreadPoolLock);
+            stackSize = mThreadPoolStackSize;
+            mThreadPoolSpawned++;
+        }
+        sp<Thread> t = new PoolThread(isMain, mayRetire);
+        t->run(name.string(), PRIORITY_DEFAULT, stackSize);
     }
 }
 
@@ -305,10 +394,137 @@ status_t ProcessState::setThreadPoolMaxThreadCount(size_t maxThreads) {
     if (ioctl(mDriverFD, BINDER_SET_MAX_THREADS, &maxThreads) == -1) {
         result = -errno;
         ALOGE("Binder ioctl to set max threads failed: %s", strerror(-result));
+    } else {
+        Mutex::Autolock _l(mThreadPoolLock);
+        mMaxThreads = maxThreads;
     }
     return result;
 }
 
+void ProcessState::setThreadPoolStackSize(size_t stackSize) {
+    Mutex::Autolock _l(mThreadPoolLock);
+    mThreadPoolStackSize = stackSize;
+}
+
+void ProcessState::setThreadPoolIdleTimeout(nsecs_t idleTimeout) {
+    Mutex::Autolock _l(mThreadPoolLock);
+    mThreadPoolIdleTimeout = idleTimeout;
+    android_atomic_release_store(idleTimeout != 0, &mThreadPoolAdaptive);
+}
+
+void ProcessState::setRealtimeTransactionPriority(int priority) {
+    android_atomic_release_store(priority, &mRealtimeTransactionPriority);
+}
+
+int ProcessState::getRealtimeTransactionPriority() const {
+    return android_atomic_acquire_load(&mRealtimeTransactionPriority);
+}
+
+nsecs_t ProcessState::getThreadPoolIdleTimeout() const {
+    Mutex::Autolock _l(mThreadPoolLock);
+    return mThreadPoolIdleTimeout;
+}
+
+void ProcessState::threadPoolJoined() {
+    Mutex::Autolock _l(mThreadPoolLock);
+    mThreadPoolThreads++;
+    if (mThreadPoolPending > 0) {
+        mThreadPoolPending--;
+    }
+}
+
+bool ProcessState::threadPoolCommandStarted() {
+    // without an idle timeout there's nothing to account for, don't take
+    // the lock around every command
+    if (!android_atomic_acquire_load(&mThreadPoolAdaptive)) {
+        return false;
+    }
+    bool spawn = false;
+    {
+        Mutex::Autolock _l(mThreadPoolLock);
+        mThreadPoolBusy++;
+        if (mThreadPoolBusy > mThreadPoolPeakBusy) {
+            mThreadPoolPeakBusy = mThreadPoolBusy;
+        }
+        // the next transaction would have to wait for one of the busy
+        // threads, the driver won't ask for threads it already had
+        if (mThreadPoolIdleTimeout && mThreadPoolPending == 0 &&
+                mThreadPoolBusy >= mThreadPoolThreads &&
+                size_t(mThreadPoolThreads) < mMaxThreads) {
+            mThreadPoolPending++;
+            spawn = true;
+        }
+    }
+    if (spawn) {
+        // announced with BC_ENTER_LOOPER, the driver didn't request it
+        spawnPooledThread(true, true);
+    }
+    return true;
+}
+
+bool ProcessState::threadPoolCommandFinished(bool counted, bool mayRetire) {
+    if (!counted) {
+        return false;
+    }
+    Mutex::Autolock _l(mThreadPoolLock);
+    mThreadPoolBusy--;
+    if (!mThreadPoolIdleTimeout) {
+        return false;
+    }
+    rollThreadPoolWindowLocked(systemTime(SYSTEM_TIME_MONOTONIC));
+    if (!mayRetire) {
+        return false;
+    }
+    return retireThreadLocked();
+}
+
+bool ProcessState::threadPoolIdleExpired() {
+    Mutex::Autolock _l(mThreadPoolLock);
+    if (!mThreadPoolIdleTimeout) {
+        return false;
+    }
+    rollThreadPoolWindowLocked(systemTime(SYSTEM_TIME_MONOTONIC));
+    return retireThreadLocked();
+}
+
+void ProcessState::rollThreadPoolWindowLocked(nsecs_t now) {
+    if (now - mThreadPoolWindowStart > mThreadPoolIdleTimeout) {
+        mThreadPoolLastPeakBusy = mThreadPoolPeakBusy;
+        mThreadPoolPeakBusy = mThreadPoolBusy;
+        mThreadPoolWindowStart = now;
+    }
+}
+
+bool ProcessState::retireThreadLocked() {
+    int32_t needed = mThreadPoolPeakBusy > mThreadPoolLastPeakBusy ?
+            mThreadPoolPeakBusy : mThreadPoolLastPeakBusy;
+    if (mThreadPoolThreads > needed + 1) {
+        mThreadPoolThreads--;
+        mThreadPoolRetired++;
+        return true;
+    }
+    return false;
+}
+
+void ProcessState::threadPoolLeft(bool retired) {
+    if (!retired) {
+        Mutex::Autolock _l(mThreadPoolLock);
+        mThreadPoolThreads--;
+    }
+}
+
+void ProcessState::dumpThreadPool(String8& result) const {
+    Mutex::Autolock _l(mThreadPoolLock);
+    result.appendFormat("Binder thread pool: %d threads, %d busy "
+            "(peak %d, previously %d), max %u, stack size %u, "
+            "idle timeout %lld ms, %u spawned, %u retired\n",
+            mThreadPoolThreads, mThreadPoolBusy,
+            mThreadPoolPeakBusy, mThreadPoolLastPeakBusy,
+            uint32_t(mMaxThreads), uint32_t(mThreadPoolStackSize),
+            ns2ms(mThreadPoolIdleTimeout),
+            mThreadPoolSpawned, mThreadPoolRetired);
+}
+
 void ProcessState::giveThreadPoolName() {
     androidSetThreadName( makeBinderThreadName().string() );
 }
@@ -330,7 +546,7 @@ static int open_driver()
             close(fd);
             fd = -1;
         }
-        size_t maxThreads = 15;
+        size_t maxThreads = DEFAULT_MAX_BINDER_THREADS;
         result = ioctl(fd, BINDER_SET_MAX_THREADS, &maxThreads);
         if (result == -1) {
             ALOGE("Binder ioctl to set max threads failed: %s", strerror(errno));
@@ -349,7 +565,22 @@ ProcessState::ProcessState()
     , mBinderContextUserData(NULL)
     , mThreadPoolStarted(false)
     , mThreadPoolSeq(1)
+    , mRealtimeTransactionPriority(1)
+    , mThreadPoolAdaptive(0)
+    , mMaxThreads(DEFAULT_MAX_BINDER_THREADS)
+    , mThreadPoolStackSize(0)
+    , mThreadPoolIdleTimeout(0)
+    , mThreadPoolThreads(0)
+    , mThreadPoolBusy(0)
+    , mThreadPoolPending(0)
+    , mThreadPoolPeakBusy(0)
+    , mThreadPoolLastPeakBusy(0)
+    , mThreadPoolWindowStart(0)
+    , mThreadPoolSpawned(0)
+    , mThreadPoolRetired(0)
 {
+    memset(const_cast<handle_entry**>(mHandleSegments), 0,
+            sizeof(mHandleSegments));
     if (mDriverFD >= 0) {
         // XXX Ideally, there should be a specific define for whether we
         // have mmap (or whether we could possibly have the kernel module
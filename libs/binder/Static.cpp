@@ -50,4 +50,20 @@ Mutex gDefaultServiceManagerLock;
 sp<IServiceManager> gDefaultServiceManager;
 sp<IPermissionController> gPermissionController;
 
+// ------------ BinderProfiler.cpp
+
+Mutex gBinderProfilerLock;
+// -1 until debug.binder.profile is read
+volatile int32_t gBinderProfilerEnabled = -1;
+Vector<BinderThreadProfile*> gBinderThreadProfiles;
+BinderThreadProfile* gRetiredBinderProfile = NULL;
+
+// ------------ AsyncTransaction.cpp
+
+Mutex gAsyncTransactionLock;
+Condition gAsyncTransactionCondition;
+Vector<AsyncTransaction*> gAsyncTransactions;
+size_t gAsyncTransactionThreads = 0;
+size_t gAsyncTransactionIdleThreads = 0;
+
 }   // namespace android
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "AsyncTransaction_test"
+
+#include <binder/IBinder.h>
+#include <binder/IPCThreadState.h>
+#include <binder/IServiceManager.h>
+#include <binder/Parcel.h>
+#include <binder/ProcessState.h>
+#include <utils/Looper.h>
+#include <utils/String16.h>
+
+#include <gtest/gtest.h>
+
+namespace android {
+
+class CountingCallback : public TransactionCallback {
+public:
+    CountingCallback() : mReplies(0), mErrors(0) {
+    }
+
+    virtual void onTransactionComplete(status_t err, const Parcel& reply) {
+        mReplies++;
+        if (err != NO_ERROR || reply.readString16() != mDescriptor) {
+            mErrors++;
+        }
+    }
+
+    String16 mDescriptor;
+    int mReplies;
+    int mErrors;
+};
+
+class AsyncTransactionTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        ProcessState::self()->startThreadPool();
+        mBinder = defaultServiceManager()->asBinder();
+        ASSERT_TRUE(mBinder != NULL);
+        mLooper = new Looper(false);
+        mCallback = new CountingCallback();
+        mCallback->mDescriptor = mBinder->getInterfaceDescriptor();
+    }
+
+    sp<IBinder> mBinder;
+    sp<Looper> mLooper;
+    sp<CountingCallback> mCallback;
+};
+
+TEST_F(AsyncTransactionTest, RepliesOnLooper_DontExhaustBinderBuffer) {
+    // The replies are freed after being delivered on this thread, which
+    // makes no binder call of its own. Far more of them than the binder
+    // buffer of the process can hold at once must all get through.
+    const int CALLS = 20000;
+    const int BATCH = 100;
+    Parcel data;
+    for (int sent = 0 ; sent < CALLS ; sent += BATCH) {
+        for (int i = 0 ; i < BATCH ; i++) {
+            ASSERT_EQ(NO_ERROR, IPCThreadState::transactAsync(mBinder,
+                    IBinder::INTERFACE_TRANSACTION, data, mCallback, mLooper));
+        }
+        while (mCallback->mReplies < sent + BATCH) {
+            ASSERT_NE(ALOOPER_POLL_TIMEOUT, mLooper->pollOnce(5000));
+        }
+        ASSERT_EQ(0, mCallback->mErrors) << "after " << sent + BATCH
+                << " calls";
+    }
+}
+
+} // namespace android
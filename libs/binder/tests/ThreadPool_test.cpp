@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "ThreadPool_test"
+
+#include <binder/Binder.h>
+#include <binder/IServiceManager.h>
+#include <binder/Parcel.h>
+#include <binder/ProcessState.h>
+#include <utils/String16.h>
+#include <utils/String8.h>
+#include <utils/Thread.h>
+#include <utils/Vector.h>
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace android {
+
+static const char* const kServiceName = "binder.test.threadpool";
+
+enum {
+    CALLERS = 6
+};
+
+// keeps every call busy long enough for the calls to pile up
+class SlowService : public BBinder {
+    virtual status_t onTransact(uint32_t code, const Parcel& data,
+            Parcel* reply, uint32_t flags) {
+        if (code == FIRST_CALL_TRANSACTION) {
+            usleep(200000);
+            return NO_ERROR;
+        }
+        return BBinder::onTransact(code, data, reply, flags);
+    }
+};
+
+class Caller : public Thread {
+public:
+    Caller(const sp<IBinder>& service) : Thread(false), mService(service) {
+    }
+
+private:
+    virtual bool threadLoop() {
+        Parcel data, reply;
+        mService->transact(IBinder::FIRST_CALL_TRANSACTION, data, &reply);
+        return false;
+    }
+
+    sp<IBinder> mService;
+};
+
+// runs in the child, makes CALLERS calls at once to the service
+static void callService() {
+    sp<IBinder> service;
+    for (int i = 0; i < 50 && service == NULL; i++) {
+        service = defaultServiceManager()->checkService(String16(kServiceName));
+        if (service == NULL) {
+            usleep(100000);
+        }
+    }
+    if (service == NULL) {
+        _exit(1);
+    }
+    Vector< sp<Thread> > callers;
+    for (int i = 0; i < CALLERS; i++) {
+        sp<Thread> caller = new Caller(service);
+        caller->run("Caller");
+        callers.add(caller);
+    }
+    for (size_t i = 0; i < callers.size(); i++) {
+        callers[i]->join();
+    }
+    _exit(0);
+}
+
+static int threadPoolSize() {
+    String8 dump;
+    ProcessState::self()->dumpThreadPool(dump);
+    int threads = -1;
+    sscanf(dump.string(), "Binder thread pool: %d threads", &threads);
+    return threads;
+}
+
+TEST(ThreadPoolTest, IdleThreadsLeaveThePool) {
+    // the child opens the driver on its own, fork before we do
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        callService();
+    }
+
+    sp<ProcessState> proc(ProcessState::self());
+    proc->setThreadPoolIdleTimeout(ms2ns(300));
+    proc->setThreadPoolMaxThreadCount(CALLERS);
+    ASSERT_EQ(NO_ERROR, defaultServiceManager()->addService(
+            String16(kServiceName), new SlowService()));
+    proc->startThreadPool();
+
+    int status;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+    EXPECT_GT(threadPoolSize(), 2);
+
+    // no calls anymore, a few idle timeouts later only the main thread and
+    // a spare one are left
+    sleep(3);
+    EXPECT_LE(threadPoolSize(), 2);
+}
+
+} // namespace android
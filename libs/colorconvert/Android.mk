@@ -0,0 +1,55 @@
+# Copyright (C) 2013 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH:= $(call my-dir)
+
+# The conversion kernels, see include/media/editor/I420Converter.h
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	I420Converter.cpp
+
+LOCAL_MODULE:= libi420converter
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_STATIC_LIBRARY)
+
+# The reference II420ColorConverter the video editor loads, unless the
+# device provides its own libI420colorconvert.
+ifneq ($(BOARD_HAS_VENDOR_I420_COLOR_CONVERTER),true)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	I420ColorConverter.cpp
+
+LOCAL_C_INCLUDES := \
+	$(TOP)/frameworks/native/include/media/openmax
+
+LOCAL_STATIC_LIBRARIES := \
+	libi420converter
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils
+
+LOCAL_MODULE:= libI420colorconvert
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_SHARED_LIBRARY)
+
+endif
+
+include $(call first-makefiles-under,$(LOCAL_PATH))
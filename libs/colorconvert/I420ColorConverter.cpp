@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The reference II420ColorConverter, used by the video editor on devices
+// without a converter of their own: the decoder output and the encoder
+// input are both NV12 (OMX_COLOR_FormatYUV420SemiPlanar).
+
+#include <OMX_IVCommon.h>
+
+#include <media/editor/I420Converter.h>
+#include <media/editor/II420ColorConverter.h>
+
+static int getDecoderOutputFormat() {
+    return OMX_COLOR_FormatYUV420SemiPlanar;
+}
+
+static int convertDecoderOutputToI420(
+    void* decoderBits, int decoderWidth, int decoderHeight,
+    ARect decoderRect, void* dstBits) {
+    return I420Converter_toI420(I420_LAYOUT_NV12, decoderBits,
+            decoderWidth, decoderHeight, decoderRect, dstBits);
+}
+
+static int getEncoderInputFormat() {
+    return OMX_COLOR_FormatYUV420SemiPlanar;
+}
+
+static int convertI420ToEncoderInput(
+    void* srcBits, int srcWidth, int srcHeight,
+    int encoderWidth, int encoderHeight, ARect encoderRect,
+    void* encoderBits) {
+    // getEncoderInputBufferInfo() puts the frame at the top-left corner
+    if (encoderRect.left != 0 || encoderRect.top != 0) {
+        return -1;
+    }
+    return I420Converter_fromI420(I420_LAYOUT_NV12, srcBits,
+            srcWidth, srcHeight, encoderBits, encoderWidth, encoderHeight);
+}
+
+static int getEncoderInputBufferInfo(
+    int srcWidth, int srcHeight,
+    int* encoderWidth, int* encoderHeight,
+    ARect* encoderRect, int* encoderBufferSize) {
+    if (srcWidth <= 0 || srcHeight <= 0) {
+        return -1;
+    }
+    // the interleaved chroma rows need an even width
+    *encoderWidth = (srcWidth + 1) & ~1;
+    *encoderHeight = srcHeight;
+    encoderRect->left = 0;
+    encoderRect->top = 0;
+    encoderRect->right = srcWidth;
+    encoderRect->bottom = srcHeight;
+    *encoderBufferSize = *encoderWidth * (srcHeight + (srcHeight + 1) / 2);
+    return 0;
+}
+
+extern "C" void getI420ColorConverter(II420ColorConverter *converter) {
+    converter->getDecoderOutputFormat = getDecoderOutputFormat;
+    converter->convertDecoderOutputToI420 = convertDecoderOutputToI420;
+    converter->getEncoderInputFormat = getEncoderInputFormat;
+    converter->convertI420ToEncoderInput = convertI420ToEncoderInput;
+    converter->getEncoderInputBufferInfo = getEncoderInputBufferInfo;
+}
@@ -0,0 +1,522 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "I420Converter"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cutils/atomic.h>
+
+#include <media/editor/I420Converter.h>
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CC_USE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CC_USE_SSE2 1
+#endif
+
+// ----------------------------------------------------------------------------
+namespace android {
+// ----------------------------------------------------------------------------
+
+static inline uint8_t clamp255(int32_t v) {
+    return uint8_t(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static inline uint16_t pack565(uint32_t r, uint32_t g, uint32_t b) {
+    return uint16_t(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+// BT.601, video range. The coefficients have 6 fractional bits so that the
+// SIMD kernels compute the very same values with 16-bit lanes.
+static inline void yuvToRGB(int32_t y, int32_t u, int32_t v,
+        uint32_t* r, uint32_t* g, uint32_t* b) {
+    const int32_t c = 74 * (y - 16) + 32;
+    const int32_t d = u - 128;
+    const int32_t e = v - 128;
+    *r = clamp255((c + 102*e) >> 6);
+    *g = clamp255((c - 25*d - 52*e) >> 6);
+    *b = clamp255((c + 129*d) >> 6);
+}
+
+// ----------------------------------------------------------------------------
+// row kernels, each does what it can with SIMD and finishes the row with
+// plain C
+
+// interleaved chroma -> two planes, n samples
+static void splitUV(uint8_t* u, uint8_t* v, const uint8_t* uv, size_t n) {
+    size_t i = 0;
+#if defined(CC_USE_NEON)
+    for ( ; i+16 <= n ; i += 16) {
+        const uint8x16x2_t p = vld2q_u8(uv + 2*i);
+        vst1q_u8(u + i, p.val[0]);
+        vst1q_u8(v + i, p.val[1]);
+    }
+#elif defined(CC_USE_SSE2)
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    for ( ; i+16 <= n ; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + 2*i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + 2*i + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(u + i),
+                _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i),
+                _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8)));
+    }
+#endif
+    for ( ; i<n ; i++) {
+        u[i] = uv[2*i];
+        v[i] = uv[2*i + 1];
+    }
+}
+
+// two chroma planes -> interleaved, n samples
+static void mergeUV(uint8_t* uv, const uint8_t* u, const uint8_t* v, size_t n) {
+    size_t i = 0;
+#if defined(CC_USE_NEON)
+    for ( ; i+16 <= n ; i += 16) {
+        uint8x16x2_t p;
+        p.val[0] = vld1q_u8(u + i);
+        p.val[1] = vld1q_u8(v + i);
+        vst2q_u8(uv + 2*i, p);
+    }
+#elif defined(CC_USE_SSE2)
+    for ( ; i+16 <= n ; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + 2*i),
+                _mm_unpacklo_epi8(a, b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + 2*i + 16),
+                _mm_unpackhi_epi8(a, b));
+    }
+#endif
+    for ( ; i<n ; i++) {
+        uv[2*i] = u[i];
+        uv[2*i + 1] = v[i];
+    }
+}
+
+// 16 pixels, from 16 luma and 8 of each chroma samples. The sums saturate
+// only where the result is way above 255 anyway.
+#if defined(CC_USE_NEON)
+static inline uint8x16x3_t yuvToRGBx16(const uint8_t* y,
+        const uint8_t* u, const uint8_t* v) {
+    const uint8x16_t y8 = vld1q_u8(y);
+    const int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(u), vdup_n_u8(128)));
+    const int16x8_t e = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(v), vdup_n_u8(128)));
+    const int16x8x2_t rc = vzipq_s16(vmulq_n_s16(e, 102), vmulq_n_s16(e, 102));
+    const int16x8_t gc1 = vmlaq_n_s16(vmulq_n_s16(d, 25), e, 52);
+    const int16x8x2_t gc = vzipq_s16(gc1, gc1);
+    const int16x8x2_t bc = vzipq_s16(vmulq_n_s16(d, 129), vmulq_n_s16(d, 129));
+    const int16x8_t l0 = vmulq_n_s16(vreinterpretq_s16_u16(
+            vsubl_u8(vget_low_u8(y8), vdup_n_u8(16))), 74);
+    const int16x8_t l1 = vmulq_n_s16(vreinterpretq_s16_u16(
+            vsubl_u8(vget_high_u8(y8), vdup_n_u8(16))), 74);
+    uint8x16x3_t rgb;
+    rgb.val[0] = vcombine_u8(vqrshrun_n_s16(vqaddq_s16(l0, rc.val[0]), 6),
+                             vqrshrun_n_s16(vqaddq_s16(l1, rc.val[1]), 6));
+    rgb.val[1] = vcombine_u8(vqrshrun_n_s16(vqsubq_s16(l0, gc.val[0]), 6),
+                             vqrshrun_n_s16(vqsubq_s16(l1, gc.val[1]), 6));
+    rgb.val[2] = vcombine_u8(vqrshrun_n_s16(vqaddq_s16(l0, bc.val[0]), 6),
+                             vqrshrun_n_s16(vqaddq_s16(l1, bc.val[1]), 6));
+    return rgb;
+}
+#elif defined(CC_USE_SSE2)
+static inline void yuvToRGBx16(const uint8_t* y, const uint8_t* u,
+        const uint8_t* v, __m128i* r, __m128i* g, __m128i* b) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y));
+    const __m128i d = _mm_sub_epi16(_mm_unpacklo_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u)), zero), bias);
+    const __m128i e = _mm_sub_epi16(_mm_unpacklo_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v)), zero), bias);
+    const __m128i rc = _mm_mullo_epi16(e, _mm_set1_epi16(102));
+    const __m128i gc = _mm_add_epi16(_mm_mullo_epi16(d, _mm_set1_epi16(25)),
+            _mm_mullo_epi16(e, _mm_set1_epi16(52)));
+    const __m128i bc = _mm_mullo_epi16(d, _mm_set1_epi16(129));
+    const __m128i offset = _mm_set1_epi16(16);
+    const __m128i scale = _mm_set1_epi16(74);
+    const __m128i round = _mm_set1_epi16(32);
+    const __m128i l0 = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(
+            _mm_unpacklo_epi8(y8, zero), offset), scale), round);
+    const __m128i l1 = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(
+            _mm_unpackhi_epi8(y8, zero), offset), scale), round);
+    *r = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_adds_epi16(l0, _mm_unpacklo_epi16(rc, rc)), 6),
+            _mm_srai_epi16(_mm_adds_epi16(l1, _mm_unpackhi_epi16(rc, rc)), 6));
+    *g = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_subs_epi16(l0, _mm_unpacklo_epi16(gc, gc)), 6),
+            _mm_srai_epi16(_mm_subs_epi16(l1, _mm_unpackhi_epi16(gc, gc)), 6));
+    *b = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_adds_epi16(l0, _mm_unpacklo_epi16(bc, bc)), 6),
+            _mm_srai_epi16(_mm_adds_epi16(l1, _mm_unpackhi_epi16(bc, bc)), 6));
+}
+
+// 8 pixels with a component in each 16-bit lane
+static inline __m128i pack565x8(__m128i r, __m128i g, __m128i b) {
+    return _mm_or_si128(_mm_or_si128(
+            _mm_slli_epi16(_mm_and_si128(r, _mm_set1_epi16(0xF8)), 8),
+            _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xFC)), 3)),
+            _mm_srli_epi16(b, 3));
+}
+#endif
+
+static void yuvToRGBA(uint32_t* d, const uint8_t* y,
+        const uint8_t* u, const uint8_t* v, size_t width) {
+    size_t i = 0;
+#if defined(CC_USE_NEON)
+    for ( ; i+16 <= width ; i += 16) {
+        const uint8x16x3_t rgb = yuvToRGBx16(y + i, u + i/2, v + i/2);
+        uint8x16x4_t px;
+        px.val[0] = rgb.val[0];
+        px.val[1] = rgb.val[1];
+        px.val[2] = rgb.val[2];
+        px.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(reinterpret_cast<uint8_t*>(d + i), px);
+    }
+#elif defined(CC_USE_SSE2)
+    const __m128i alpha = _mm_set1_epi8(char(0xFF));
+    for ( ; i+16 <= width ; i += 16) {
+        __m128i r, g, b;
+        yuvToRGBx16(y + i, u + i/2, v + i/2, &r, &g, &b);
+        const __m128i rg0 = _mm_unpacklo_epi8(r, g);
+        const __m128i rg1 = _mm_unpackhi_epi8(r, g);
+        const __m128i ba0 = _mm_unpacklo_epi8(b, alpha);
+        const __m128i ba1 = _mm_unpackhi_epi8(b, alpha);
+        __m128i* p = reinterpret_cast<__m128i*>(d + i);
+        _mm_storeu_si128(p,     _mm_unpacklo_epi16(rg0, ba0));
+        _mm_storeu_si128(p + 1, _mm_unpackhi_epi16(rg0, ba0));
+        _mm_storeu_si128(p + 2, _mm_unpacklo_epi16(rg1, ba1));
+        _mm_storeu_si128(p + 3, _mm_unpackhi_epi16(rg1, ba1));
+    }
+#endif
+    for ( ; i<width ; i++) {
+        uint32_t r, g, b;
+        yuvToRGB(y[i], u[i >> 1], v[i >> 1], &r, &g, &b);
+        d[i] = 0xFF000000 | (b << 16) | (g << 8) | r;
+    }
+}
+
+static void yuvToRGB565(uint16_t* d, const uint8_t* y,
+        const uint8_t* u, const uint8_t* v, size_t width) {
+    size_t i = 0;
+#if defined(CC_USE_NEON)
+    for ( ; i+16 <= width ; i += 16) {
+        const uint8x16x3_t rgb = yuvToRGBx16(y + i, u + i/2, v + i/2);
+        uint16x8_t p0 = vshll_n_u8(vget_low_u8(rgb.val[0]), 8);
+        p0 = vsriq_n_u16(p0, vshll_n_u8(vget_low_u8(rgb.val[1]), 8), 5);
+        p0 = vsriq_n_u16(p0, vshll_n_u8(vget_low_u8(rgb.val[2]), 8), 11);
+        uint16x8_t p1 = vshll_n_u8(vget_high_u8(rgb.val[0]), 8);
+        p1 = vsriq_n_u16(p1, vshll_n_u8(vget_high_u8(rgb.val[1]), 8), 5);
+        p1 = vsriq_n_u16(p1, vshll_n_u8(vget_high_u8(rgb.val[2]), 8), 11);
+        vst1q_u16(d + i, p0);
+        vst1q_u16(d + i + 8, p1);
+    }
+#elif defined(CC_USE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; i+16 <= width ; i += 16) {
+        __m128i r, g, b;
+        yuvToRGBx16(y + i, u + i/2, v + i/2, &r, &g, &b);
+        __m128i* p = reinterpret_cast<__m128i*>(d + i);
+        _mm_storeu_si128(p, pack565x8(_mm_unpacklo_epi8(r, zero),
+                _mm_unpacklo_epi8(g, zero), _mm_unpacklo_epi8(b, zero)));
+        _mm_storeu_si128(p + 1, pack565x8(_mm_unpackhi_epi8(r, zero),
+                _mm_unpackhi_epi8(g, zero), _mm_unpackhi_epi8(b, zero)));
+    }
+#endif
+    for ( ; i<width ; i++) {
+        uint32_t r, g, b;
+        yuvToRGB(y[i], u[i >> 1], v[i >> 1], &r, &g, &b);
+        d[i] = pack565(r, g, b);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// frames are converted in bands of rows, on several threads for the large
+// ones
+
+typedef void (*RowsFunction)(const void* job, size_t top, size_t bottom);
+
+enum {
+    MAX_THREADS = 4,
+    // 1080p and up
+    THREADED_PIXELS = 1920 * 1080,
+};
+
+static volatile int32_t sMaxThreads = 0;
+
+struct Band {
+    RowsFunction rows;
+    const void* job;
+    size_t top;
+    size_t bottom;
+};
+
+static void* bandThread(void* arg) {
+    const Band* band = static_cast<const Band*>(arg);
+    band->rows(band->job, band->top, band->bottom);
+    return NULL;
+}
+
+static size_t getThreadCount(size_t width, size_t height) {
+    if (width * height < THREADED_PIXELS) {
+        return 1;
+    }
+    long threads = android_atomic_acquire_load(&sMaxThreads);
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    return threads < 1 ? 1 : (threads > MAX_THREADS ? long(MAX_THREADS) : threads);
+}
+
+static void runBands(RowsFunction rows, const void* job,
+        size_t width, size_t height) {
+    const size_t threads = getThreadCount(width, height);
+    // the bands start on even rows, so that they share no chroma row
+    const size_t bandHeight = ((height + threads - 1) / threads + 1) & ~1;
+
+    Band bands[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+    bool started[MAX_THREADS];
+    for (size_t i=1 ; i<threads ; i++) {
+        bands[i].rows = rows;
+        bands[i].job = job;
+        bands[i].top = i * bandHeight;
+        bands[i].bottom = (i + 1) * bandHeight;
+        if (bands[i].bottom > height) {
+            bands[i].bottom = height;
+        }
+        started[i] = bands[i].top < height &&
+                pthread_create(&tids[i], NULL, bandThread, &bands[i]) == 0;
+    }
+    rows(job, 0, bandHeight < height ? bandHeight : height);
+    for (size_t i=1 ; i<threads ; i++) {
+        if (started[i]) {
+            pthread_join(tids[i], NULL);
+        } else if (bands[i].top < height) {
+            rows(job, bands[i].top, bands[i].bottom);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// a 4:2:0 frame in any of the layouts, the chroma pointers point at the
+// first Cb and Cr samples, step bytes apart for the interleaved layouts
+struct Frame {
+    uint8_t* y;
+    uint8_t* u;
+    uint8_t* v;
+    size_t stride;
+    size_t chromaStride;
+    bool interleaved;
+};
+
+struct CopyJob {
+    Frame src;
+    Frame dst;
+    size_t width;
+    size_t chromaWidth;
+};
+
+static void copyRows(const void* job, size_t top, size_t bottom) {
+    const CopyJob& j(*static_cast<const CopyJob*>(job));
+    for (size_t row=top ; row<bottom ; row++) {
+        memcpy(j.dst.y + row * j.dst.stride, j.src.y + row * j.src.stride,
+                j.width);
+        if (row & 1) {
+            continue;
+        }
+        const size_t c = row / 2;
+        uint8_t* du = j.dst.u + c * j.dst.chromaStride;
+        uint8_t* dv = j.dst.v + c * j.dst.chromaStride;
+        const uint8_t* su = j.src.u + c * j.src.chromaStride;
+        const uint8_t* sv = j.src.v + c * j.src.chromaStride;
+        if (j.src.interleaved == j.dst.interleaved) {
+            // only planar to planar happens
+            memcpy(du, su, j.chromaWidth);
+            memcpy(dv, sv, j.chromaWidth);
+        } else if (j.src.interleaved) {
+            // NV21 is handled by swapping the chroma pointers
+            if (su < sv) {
+                splitUV(du, dv, su, j.chromaWidth);
+            } else {
+                splitUV(dv, du, sv, j.chromaWidth);
+            }
+        } else {
+            if (du < dv) {
+                mergeUV(du, su, sv, j.chromaWidth);
+            } else {
+                mergeUV(dv, sv, su, j.chromaWidth);
+            }
+        }
+    }
+}
+
+// sets up a frame of the given layout, with its Y plane of height rows
+static bool getFrame(int layout, const void* bits, size_t stride,
+        size_t height, Frame* frame) {
+    uint8_t* y = static_cast<uint8_t*>(const_cast<void*>(bits));
+    uint8_t* chroma = y + stride * height;
+    frame->y = y;
+    frame->stride = stride;
+    switch (layout) {
+        case I420_LAYOUT_NV12:
+            frame->u = chroma;
+            frame->v = chroma + 1;
+            frame->chromaStride = stride;
+            frame->interleaved = true;
+            return true;
+        case I420_LAYOUT_NV21:
+            frame->v = chroma;
+            frame->u = chroma + 1;
+            frame->chromaStride = stride;
+            frame->interleaved = true;
+            return true;
+        case I420_LAYOUT_YV12:
+            frame->chromaStride = (stride + 1) / 2;
+            frame->v = chroma;
+            frame->u = chroma + frame->chromaStride * ((height + 1) / 2);
+            frame->interleaved = false;
+            return true;
+    }
+    return false;
+}
+
+static void getI420Frame(const void* bits, size_t width, size_t height,
+        Frame* frame) {
+    uint8_t* y = static_cast<uint8_t*>(const_cast<void*>(bits));
+    frame->y = y;
+    frame->stride = width;
+    frame->chromaStride = (width + 1) / 2;
+    frame->u = y + width * height;
+    frame->v = frame->u + frame->chromaStride * ((height + 1) / 2);
+    frame->interleaved = false;
+}
+
+struct RGBJob {
+    Frame src;
+    uint8_t* dst;
+    size_t dstBpr;
+    size_t width;
+};
+
+template <bool rgb565>
+static void rgbRows(const void* job, size_t top, size_t bottom) {
+    const RGBJob& j(*static_cast<const RGBJob*>(job));
+    for (size_t row=top ; row<bottom ; row++) {
+        const uint8_t* y = j.src.y + row * j.src.stride;
+        const uint8_t* u = j.src.u + (row / 2) * j.src.chromaStride;
+        const uint8_t* v = j.src.v + (row / 2) * j.src.chromaStride;
+        uint8_t* d = j.dst + row * j.dstBpr;
+        if (rgb565) {
+            yuvToRGB565(reinterpret_cast<uint16_t*>(d), y, u, v, j.width);
+        } else {
+            yuvToRGBA(reinterpret_cast<uint32_t*>(d), y, u, v, j.width);
+        }
+    }
+}
+
+template <bool rgb565>
+static int toRGB(const void* src, int width, int height, void* dst,
+        int dstStride) {
+    if (!src || !dst || width <= 0 || height <= 0 || dstStride < width) {
+        return -1;
+    }
+    RGBJob job;
+    getI420Frame(src, width, height, &job.src);
+    job.dst = static_cast<uint8_t*>(dst);
+    job.dstBpr = size_t(dstStride) * (rgb565 ? 2 : 4);
+    job.width = width;
+    runBands(rgbRows<rgb565>, &job, width, height);
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+// ----------------------------------------------------------------------------
+
+using namespace android;
+
+int I420Converter_toI420(int layout, const void* src, int stride, int height,
+        ARect crop, void* dst) {
+    if (!src || !dst || crop.left < 0 || crop.top < 0 ||
+            crop.right > stride || crop.bottom > height ||
+            crop.left >= crop.right || crop.top >= crop.bottom) {
+        return -1;
+    }
+    CopyJob job;
+    if (!getFrame(layout, src, stride, height, &job.src)) {
+        return -1;
+    }
+    const size_t width = crop.right - crop.left;
+    const size_t rows = crop.bottom - crop.top;
+    const size_t chromaOffset = (crop.top / 2) * job.src.chromaStride +
+            (job.src.interleaved ? (crop.left / 2) * 2 : crop.left / 2);
+    job.src.y += crop.top * stride + crop.left;
+    job.src.u += chromaOffset;
+    job.src.v += chromaOffset;
+    getI420Frame(dst, width, rows, &job.dst);
+    job.width = width;
+    job.chromaWidth = (width + 1) / 2;
+    if (job.src.interleaved && crop.right == stride && (crop.left & 1) == 0 &&
+            (width & 1)) {
+        // the last sample pair would straddle the end of the row
+        return -1;
+    }
+    runBands(copyRows, &job, width, rows);
+    return 0;
+}
+
+int I420Converter_fromI420(int layout, const void* src, int width, int height,
+        void* dst, int dstStride, int dstHeight) {
+    if (!src || !dst || width <= 0 || height <= 0 || dstStride < width ||
+            dstHeight < height) {
+        return -1;
+    }
+    CopyJob job;
+    if (!getFrame(layout, dst, dstStride, dstHeight, &job.dst)) {
+        return -1;
+    }
+    if (job.dst.interleaved && dstStride < ((width + 1) & ~1)) {
+        return -1;
+    }
+    getI420Frame(src, width, height, &job.src);
+    job.width = width;
+    job.chromaWidth = (width + 1) / 2;
+    runBands(copyRows, &job, width, height);
+    return 0;
+}
+
+int I420Converter_toRGBA8888(const void* src, int width, int height,
+        void* dst, int dstStride) {
+    return toRGB<false>(src, width, height, dst, dstStride);
+}
+
+int I420Converter_toRGB565(const void* src, int width, int height,
+        void* dst, int dstStride) {
+    return toRGB<true>(src, width, height, dst, dstStride);
+}
+
+void I420Converter_setMaxThreads(int maxThreads) {
+    android_atomic_release_store(maxThreads, &sMaxThreads);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "I420ConverterBenchmark"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <utils/Timers.h>
+#include <media/editor/I420Converter.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+// Not a correctness test: these convert 1080p frames and print how many
+// frames per second each conversion runs at, on one thread and on the
+// default number of threads.
+class I420ConverterBenchmark : public testing::Test {
+protected:
+    enum { WIDTH = 1920, HEIGHT = 1080, FRAMES = 60 };
+
+    virtual void SetUp() {
+        mSrc = new uint8_t[WIDTH * HEIGHT * 3 / 2];
+        mDst = new uint8_t[WIDTH * HEIGHT * 4];
+        for (size_t i = 0; i < WIDTH * HEIGHT * 3 / 2; i++) {
+            mSrc[i] = uint8_t(i * 7);
+        }
+    }
+
+    virtual void TearDown() {
+        I420Converter_setMaxThreads(0);
+        delete[] mSrc;
+        delete[] mDst;
+    }
+
+    template <typename F>
+    void run(const char* name, F convert) {
+        static const int threads[] = { 1, 0 };
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            I420Converter_setMaxThreads(threads[t]);
+            const nsecs_t start = systemTime();
+            for (int i = 0; i < FRAMES; i++) {
+                ASSERT_EQ(0, convert(mSrc, mDst));
+            }
+            const double seconds = (systemTime() - start) / 1e9;
+            printf("%-20s %-8s %8.1f frames/s\n", name,
+                    threads[t] == 1 ? "1 thread" : "threaded",
+                    seconds > 0 ? FRAMES / seconds : 0.0);
+        }
+    }
+
+    static int nv12ToI420(uint8_t* src, uint8_t* dst) {
+        ARect crop = { 0, 0, WIDTH, HEIGHT };
+        return I420Converter_toI420(I420_LAYOUT_NV12, src, WIDTH, HEIGHT,
+                crop, dst);
+    }
+    static int nv21ToI420(uint8_t* src, uint8_t* dst) {
+        ARect crop = { 0, 0, WIDTH, HEIGHT };
+        return I420Converter_toI420(I420_LAYOUT_NV21, src, WIDTH, HEIGHT,
+                crop, dst);
+    }
+    static int yv12ToI420(uint8_t* src, uint8_t* dst) {
+        ARect crop = { 0, 0, WIDTH, HEIGHT };
+        return I420Converter_toI420(I420_LAYOUT_YV12, src, WIDTH, HEIGHT,
+                crop, dst);
+    }
+    static int i420ToNV12(uint8_t* src, uint8_t* dst) {
+        return I420Converter_fromI420(I420_LAYOUT_NV12, src, WIDTH, HEIGHT,
+                dst, WIDTH, HEIGHT);
+    }
+    static int i420ToRGBA(uint8_t* src, uint8_t* dst) {
+        return I420Converter_toRGBA8888(src, WIDTH, HEIGHT, dst, WIDTH);
+    }
+    static int i420ToRGB565(uint8_t* src, uint8_t* dst) {
+        return I420Converter_toRGB565(src, WIDTH, HEIGHT, dst, WIDTH);
+    }
+
+    uint8_t* mSrc;
+    uint8_t* mDst;
+};
+
+TEST_F(I420ConverterBenchmark, ToI420) {
+    run("NV12 -> I420", nv12ToI420);
+    run("NV21 -> I420", nv21ToI420);
+    run("YV12 -> I420", yv12ToI420);
+}
+
+TEST_F(I420ConverterBenchmark, FromI420) {
+    run("I420 -> NV12", i420ToNV12);
+}
+
+TEST_F(I420ConverterBenchmark, ToRGB) {
+    run("I420 -> RGBA_8888", i420ToRGBA);
+    run("I420 -> RGB_565", i420ToRGB565);
+}
+
+}; // namespace android
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "I420ConverterTest"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <media/editor/I420Converter.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+class I420ConverterTest : public testing::Test {
+protected:
+    virtual void TearDown() {
+        I420Converter_setMaxThreads(0);
+    }
+
+    static size_t i420Size(int width, int height) {
+        return width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2);
+    }
+
+    static uint8_t* randomBytes(size_t size, unsigned seed) {
+        uint8_t* bytes = new uint8_t[size];
+        srand(seed);
+        for (size_t i = 0; i < size; i++) {
+            bytes[i] = uint8_t(rand());
+        }
+        return bytes;
+    }
+
+    static uint8_t clamp(int v) {
+        return uint8_t(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+    // the reference conversion of one pixel, as 0xAABBGGRR
+    static uint32_t toRGBA(int y, int u, int v) {
+        const int c = 74 * (y - 16) + 32;
+        const int r = clamp((c + 102 * (v - 128)) >> 6);
+        const int g = clamp((c - 25 * (u - 128) - 52 * (v - 128)) >> 6);
+        const int b = clamp((c + 129 * (u - 128)) >> 6);
+        return 0xFF000000 | (b << 16) | (g << 8) | r;
+    }
+
+    static uint16_t to565(uint32_t rgba) {
+        const uint32_t r = rgba & 0xFF;
+        const uint32_t g = (rgba >> 8) & 0xFF;
+        const uint32_t b = (rgba >> 16) & 0xFF;
+        return uint16_t(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+    }
+};
+
+TEST_F(I420ConverterTest, NV12RoundTrip) {
+    const int w = 70, h = 33;
+    const size_t size = w * h + w * ((h + 1) / 2);
+    uint8_t* nv12 = randomBytes(size, 1);
+    uint8_t* i420 = new uint8_t[i420Size(w, h)];
+    uint8_t* out = new uint8_t[size];
+    memset(out, 0, size);
+
+    ARect crop = { 0, 0, w, h };
+    ASSERT_EQ(0, I420Converter_toI420(I420_LAYOUT_NV12, nv12, w, h, crop, i420));
+    const uint8_t* u = i420 + w * h;
+    const uint8_t* v = u + (w / 2) * ((h + 1) / 2);
+    EXPECT_EQ(nv12[w * h], u[0]);
+    EXPECT_EQ(nv12[w * h + 1], v[0]);
+    EXPECT_EQ(nv12[w * h + w * 3 + 8], u[(w / 2) * 3 + 4]);
+    EXPECT_EQ(nv12[w * h + w * 3 + 9], v[(w / 2) * 3 + 4]);
+
+    ASSERT_EQ(0, I420Converter_fromI420(I420_LAYOUT_NV12, i420, w, h, out, w, h));
+    EXPECT_EQ(0, memcmp(nv12, out, size));
+
+    delete[] nv12;
+    delete[] i420;
+    delete[] out;
+}
+
+TEST_F(I420ConverterTest, NV21AndYV12Layouts) {
+    const int w = 36, h = 20;
+    const int cw = w / 2, ch = h / 2;
+    uint8_t* i420 = randomBytes(i420Size(w, h), 2);
+    const uint8_t* u = i420 + w * h;
+    const uint8_t* v = u + cw * ch;
+    uint8_t* out = new uint8_t[w * h * 2];
+
+    ASSERT_EQ(0, I420Converter_fromI420(I420_LAYOUT_NV21, i420, w, h, out, w, h));
+    EXPECT_EQ(0, memcmp(i420, out, w * h));
+    for (int i = 0; i < cw * ch; i++) {
+        EXPECT_EQ(v[i], out[w * h + (i / cw) * w + (i % cw) * 2]);
+        EXPECT_EQ(u[i], out[w * h + (i / cw) * w + (i % cw) * 2 + 1]);
+    }
+
+    ASSERT_EQ(0, I420Converter_fromI420(I420_LAYOUT_YV12, i420, w, h, out, w, h));
+    EXPECT_EQ(0, memcmp(i420, out, w * h));
+    EXPECT_EQ(0, memcmp(v, out + w * h, cw * ch));
+    EXPECT_EQ(0, memcmp(u, out + w * h + cw * ch, cw * ch));
+
+    uint8_t* back = new uint8_t[i420Size(w, h)];
+    ARect crop = { 0, 0, w, h };
+    ASSERT_EQ(0, I420Converter_toI420(I420_LAYOUT_YV12, out, w, h, crop, back));
+    EXPECT_EQ(0, memcmp(i420, back, i420Size(w, h)));
+
+    delete[] i420;
+    delete[] out;
+    delete[] back;
+}
+
+TEST_F(I420ConverterTest, Crop) {
+    const int stride = 64, rows = 48;
+    uint8_t* nv12 = randomBytes(stride * rows * 3 / 2, 3);
+    ARect crop = { 4, 6, 36, 30 };
+    const int w = crop.right - crop.left, h = crop.bottom - crop.top;
+    uint8_t* i420 = new uint8_t[i420Size(w, h)];
+    ASSERT_EQ(0, I420Converter_toI420(I420_LAYOUT_NV12, nv12, stride, rows,
+            crop, i420));
+
+    for (int y = 0; y < h; y++) {
+        EXPECT_EQ(0, memcmp(nv12 + (crop.top + y) * stride + crop.left,
+                i420 + y * w, w));
+    }
+    const uint8_t* chroma = nv12 + stride * rows;
+    const uint8_t* u = i420 + w * h;
+    const uint8_t* v = u + (w / 2) * (h / 2);
+    for (int y = 0; y < h / 2; y++) {
+        for (int x = 0; x < w / 2; x++) {
+            const uint8_t* uv = chroma + (crop.top / 2 + y) * stride +
+                    crop.left + 2 * x;
+            EXPECT_EQ(uv[0], u[y * (w / 2) + x]);
+            EXPECT_EQ(uv[1], v[y * (w / 2) + x]);
+        }
+    }
+
+    ARect outside = { 0, 0, stride + 2, rows };
+    EXPECT_EQ(-1, I420Converter_toI420(I420_LAYOUT_NV12, nv12, stride, rows,
+            outside, i420));
+    EXPECT_EQ(-1, I420Converter_toI420(0, nv12, stride, rows, crop, i420));
+
+    delete[] nv12;
+    delete[] i420;
+}
+
+// every width up to a few SIMD blocks, so that the SIMD kernels and the
+// tail of the rows are both checked against the reference
+TEST_F(I420ConverterTest, RGBMatchesReference) {
+    for (int w = 1; w <= 40; w++) {
+        const int h = 3;
+        uint8_t* i420 = randomBytes(i420Size(w, h), w);
+        // the extremes saturate the 16-bit SIMD lanes
+        i420[0] = 0;
+        i420[w - 1] = 255;
+        const int cw = (w + 1) / 2;
+        const uint8_t* y = i420;
+        const uint8_t* u = i420 + w * h;
+        const uint8_t* v = u + cw * ((h + 1) / 2);
+
+        uint32_t* rgba = new uint32_t[w * h];
+        uint16_t* rgb565 = new uint16_t[w * h];
+        ASSERT_EQ(0, I420Converter_toRGBA8888(i420, w, h, rgba, w));
+        ASSERT_EQ(0, I420Converter_toRGB565(i420, w, h, rgb565, w));
+        for (int j = 0; j < h; j++) {
+            for (int i = 0; i < w; i++) {
+                const uint32_t expected = toRGBA(y[j * w + i],
+                        u[(j / 2) * cw + i / 2], v[(j / 2) * cw + i / 2]);
+                ASSERT_EQ(expected, rgba[j * w + i]) << "w=" << w << " x=" << i;
+                ASSERT_EQ(to565(expected), rgb565[j * w + i]) << "w=" << w;
+            }
+        }
+        delete[] i420;
+        delete[] rgba;
+        delete[] rgb565;
+    }
+}
+
+TEST_F(I420ConverterTest, SaturatedComponents) {
+    const int w = 32, h = 2;
+    uint8_t i420[w * h + w];
+    const int values[] = { 0, 16, 128, 235, 255 };
+    uint32_t rgba[w * h];
+    for (int a = 0; a < 5; a++) {
+        for (int b = 0; b < 5; b++) {
+            for (int c = 0; c < 5; c++) {
+                memset(i420, values[a], w * h);
+                memset(i420 + w * h, values[b], w / 2);
+                memset(i420 + w * h + w / 2, values[c], w / 2);
+                ASSERT_EQ(0, I420Converter_toRGBA8888(i420, w, h, rgba, w));
+                EXPECT_EQ(toRGBA(values[a], values[b], values[c]), rgba[0]);
+                EXPECT_EQ(toRGBA(values[a], values[b], values[c]), rgba[w - 1]);
+            }
+        }
+    }
+}
+
+TEST_F(I420ConverterTest, ThreadedConversionMatches) {
+    const int w = 1920, h = 1080;
+    uint8_t* i420 = randomBytes(i420Size(w, h), 4);
+    uint32_t* single = new uint32_t[w * h];
+    uint32_t* threaded = new uint32_t[w * h];
+    uint8_t* nv12Single = new uint8_t[w * h * 3 / 2];
+    uint8_t* nv12Threaded = new uint8_t[w * h * 3 / 2];
+
+    I420Converter_setMaxThreads(1);
+    ASSERT_EQ(0, I420Converter_toRGBA8888(i420, w, h, single, w));
+    ASSERT_EQ(0, I420Converter_fromI420(I420_LAYOUT_NV12, i420, w, h,
+            nv12Single, w, h));
+    I420Converter_setMaxThreads(4);
+    ASSERT_EQ(0, I420Converter_toRGBA8888(i420, w, h, threaded, w));
+    ASSERT_EQ(0, I420Converter_fromI420(I420_LAYOUT_NV12, i420, w, h,
+            nv12Threaded, w, h));
+
+    EXPECT_EQ(0, memcmp(single, threaded, w * h * 4));
+    EXPECT_EQ(0, memcmp(nv12Single, nv12Threaded, w * h * 3 / 2));
+
+    delete[] i420;
+    delete[] single;
+    delete[] threaded;
+    delete[] nv12Single;
+    delete[] nv12Threaded;
+}
+
+}; // namespace android
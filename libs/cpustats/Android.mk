@@ -4,6 +4,8 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES :=     \
         CentralTendencyStatistics.cpp \
+        QuantileEstimator.cpp \
+        ThreadCpuProfiler.cpp \
         ThreadCpuUsage.cpp
 
 LOCAL_MODULE := libcpustats
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include <cpustats/QuantileEstimator.h>
+
+static void insertionSort(double *a, unsigned n)
+{
+    for (unsigned i = 1; i < n; ++i) {
+        double x = a[i];
+        unsigned j = i;
+        for (; j > 0 && a[j - 1] > x; --j) {
+            a[j] = a[j - 1];
+        }
+        a[j] = x;
+    }
+}
+
+QuantileEstimator::QuantileEstimator(double p) : mP(p)
+{
+    reset();
+}
+
+void QuantileEstimator::reset()
+{
+    mN = 0;
+    for (int i = 0; i < 5; ++i) {
+        mHeights[i] = 0;
+        mPositions[i] = i + 1;
+    }
+    mDesired[0] = 1;
+    mDesired[1] = 1 + 2 * mP;
+    mDesired[2] = 1 + 4 * mP;
+    mDesired[3] = 3 + 2 * mP;
+    mDesired[4] = 5;
+    mIncrements[0] = 0;
+    mIncrements[1] = mP / 2;
+    mIncrements[2] = mP;
+    mIncrements[3] = (1 + mP) / 2;
+    mIncrements[4] = 1;
+}
+
+void QuantileEstimator::sample(double x)
+{
+    if (mN < 5) {
+        mHeights[mN++] = x;
+        if (mN == 5) {
+            insertionSort(mHeights, 5);
+        }
+        return;
+    }
+    ++mN;
+
+    // find the cell k such that mHeights[k] <= x < mHeights[k + 1],
+    // stretching the extreme markers if x is a new minimum or maximum
+    int k;
+    if (x < mHeights[0]) {
+        mHeights[0] = x;
+        k = 0;
+    } else if (x >= mHeights[4]) {
+        mHeights[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (x >= mHeights[k + 1]) {
+            ++k;
+        }
+    }
+
+    for (int i = k + 1; i < 5; ++i) {
+        mPositions[i] += 1;
+    }
+    for (int i = 0; i < 5; ++i) {
+        mDesired[i] += mIncrements[i];
+    }
+
+    // move the middle markers by one position if they are off by one or more
+    for (int i = 1; i <= 3; ++i) {
+        double delta = mDesired[i] - mPositions[i];
+        if ((delta >= 1 && mPositions[i + 1] - mPositions[i] > 1) ||
+                (delta <= -1 && mPositions[i - 1] - mPositions[i] < -1)) {
+            int d = delta > 0 ? 1 : -1;
+            double height = parabolic(i, d);
+            if (!(mHeights[i - 1] < height && height < mHeights[i + 1])) {
+                height = linear(i, d);
+            }
+            mHeights[i] = height;
+            mPositions[i] += d;
+        }
+    }
+}
+
+double QuantileEstimator::parabolic(int i, int d) const
+{
+    const double *q = mHeights;
+    const double *n = mPositions;
+    return q[i] + d / (n[i + 1] - n[i - 1]) *
+            ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+             (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+double QuantileEstimator::linear(int i, int d) const
+{
+    return mHeights[i] + d * (mHeights[i + d] - mHeights[i]) /
+            (mPositions[i + d] - mPositions[i]);
+}
+
+double QuantileEstimator::quantile() const
+{
+    if (mN >= 5) {
+        return mHeights[2];
+    }
+    if (mN == 0) {
+        return NAN;
+    }
+    // too few samples for the markers, so pick the nearest rank
+    double sorted[5];
+    for (unsigned i = 0; i < mN; ++i) {
+        sorted[i] = mHeights[i];
+    }
+    insertionSort(sorted, mN);
+    unsigned rank = (unsigned) (mP * (mN - 1) + 0.5);
+    return sorted[rank];
+}
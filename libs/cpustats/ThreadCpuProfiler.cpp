@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "ThreadCpuProfiler"
+//#define LOG_NDEBUG 0
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <utils/Log.h>
+
+#include <cpustats/ThreadCpuProfiler.h>
+
+namespace android {
+
+// Read /proc/self/task/<tid>/<file> into buf, NUL-terminated.
+static bool readTaskFile(pid_t tid, const char* file, char* buf, size_t size)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/%s", tid, file);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    size_t length = 0;
+    while (length < size - 1) {
+        ssize_t actual = read(fd, buf + length, size - 1 - length);
+        if (actual < 0 && errno == EINTR) {
+            continue;
+        }
+        if (actual <= 0) {
+            break;
+        }
+        length += actual;
+    }
+    (void) close(fd);
+    buf[length] = '\0';
+    return length > 0;
+}
+
+static unsigned long long findCount(const char* buf, const char* key)
+{
+    const char* p = strstr(buf, key);
+    return p ? strtoull(p + strlen(key), NULL, 10) : 0;
+}
+
+ThreadCpuProfiler::ThreadStats::ThreadStats() :
+        exited(false),
+        primed(false),
+        lastCpuNs(0),
+        lastVoluntary(0),
+        lastInvoluntary(0),
+        lastSampleTime(0),
+        sampledTime(0),
+        cpuNs(0),
+        voluntary(0),
+        involuntary(0),
+        cpuPercent50(0.50),
+        cpuPercent90(0.90),
+        cpuPercent99(0.99)
+{
+}
+
+void ThreadCpuProfiler::ThreadStats::reset()
+{
+    sampledTime = 0;
+    cpuNs = 0;
+    voluntary = 0;
+    involuntary = 0;
+    cpuPercent.reset();
+    cpuPercent50.reset();
+    cpuPercent90.reset();
+    cpuPercent99.reset();
+    timeInFrequency.clear();
+}
+
+ThreadCpuProfiler::ThreadCpuProfiler()
+{
+}
+
+ThreadCpuProfiler::~ThreadCpuProfiler()
+{
+    for (size_t i = 0; i < mThreads.size(); ++i) {
+        delete mThreads.valueAt(i);
+    }
+}
+
+/*static*/
+bool ThreadCpuProfiler::readName(pid_t tid, String8* name)
+{
+    char comm[32];
+    if (!readTaskFile(tid, "comm", comm, sizeof(comm))) {
+        return false;
+    }
+    char* newline = strchr(comm, '\n');
+    if (newline) {
+        *newline = '\0';
+    }
+    name->setTo(comm);
+    return true;
+}
+
+/*static*/
+bool ThreadCpuProfiler::readCounters(pid_t tid, Counters* counters)
+{
+    char buf[2048];
+
+    // fields 14 and 15 are utime and stime in clock ticks, field 39 is the
+    // CPU last run on; the comm in field 2 may contain spaces and parentheses
+    if (!readTaskFile(tid, "stat", buf, sizeof(buf))) {
+        return false;
+    }
+    const char* p = strrchr(buf, ')');
+    if (p == NULL) {
+        return false;
+    }
+    unsigned long long ticks = 0;
+    counters->cpu = -1;
+    p += 2;
+    for (int field = 3; *p && field <= 39; ++field) {
+        if (field == 14 || field == 15) {
+            ticks += strtoull(p, NULL, 10);
+        } else if (field == 39) {
+            counters->cpu = atoi(p);
+        }
+        p = strchr(p, ' ');
+        if (p == NULL) {
+            break;
+        }
+        ++p;
+    }
+
+    // schedstat has the CPU time in ns, when the kernel keeps it
+    if (readTaskFile(tid, "schedstat", buf, sizeof(buf))) {
+        counters->cpuNs = strtoll(buf, NULL, 10);
+    } else {
+        static const long long nsPerTick = 1000000000LL / sysconf(_SC_CLK_TCK);
+        counters->cpuNs = ticks * nsPerTick;
+    }
+
+    if (!readTaskFile(tid, "status", buf, sizeof(buf))) {
+        return false;
+    }
+    counters->voluntary = findCount(buf, "\nvoluntary_ctxt_switches:");
+    counters->involuntary = findCount(buf, "\nnonvoluntary_ctxt_switches:");
+    return true;
+}
+
+bool ThreadCpuProfiler::addThread(pid_t tid, const char* name)
+{
+    if (mThreads.indexOfKey(tid) >= 0) {
+        return false;
+    }
+    ThreadStats* stats = new ThreadStats();
+    if (name != NULL) {
+        stats->name.setTo(name);
+    } else if (!readName(tid, &stats->name)) {
+        stats->name.setTo("?");
+    }
+    mThreads.add(tid, stats);
+    return true;
+}
+
+void ThreadCpuProfiler::addAllThreads()
+{
+    DIR* dir = opendir("/proc/self/task");
+    if (dir == NULL) {
+        ALOGE("opendir(/proc/self/task) errno=%d", errno);
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        pid_t tid = atoi(entry->d_name);
+        if (tid > 0) {
+            addThread(tid);
+        }
+    }
+    closedir(dir);
+}
+
+void ThreadCpuProfiler::removeThread(pid_t tid)
+{
+    ssize_t index = mThreads.indexOfKey(tid);
+    if (index >= 0) {
+        delete mThreads.valueAt(index);
+        mThreads.removeItemsAt(index);
+    }
+}
+
+void ThreadCpuProfiler::sample()
+{
+    for (size_t i = 0; i < mThreads.size(); ++i) {
+        ThreadStats& stats = *mThreads.editValueAt(i);
+        if (stats.exited) {
+            continue;
+        }
+        Counters counters;
+        if (!readCounters(mThreads.keyAt(i), &counters)) {
+            ALOGV("thread %d (%s) exited", mThreads.keyAt(i), stats.name.string());
+            stats.exited = true;
+            continue;
+        }
+        const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+
+        if (stats.primed && now > stats.lastSampleTime) {
+            const nsecs_t interval = now - stats.lastSampleTime;
+            const long long cpuNs = counters.cpuNs - stats.lastCpuNs;
+            const double percent = 100.0 * cpuNs / interval;
+            stats.sampledTime += interval;
+            stats.cpuNs += cpuNs;
+            stats.voluntary += counters.voluntary - stats.lastVoluntary;
+            stats.involuntary += counters.involuntary - stats.lastInvoluntary;
+            stats.cpuPercent.sample(percent);
+            stats.cpuPercent50.sample(percent);
+            stats.cpuPercent90.sample(percent);
+            stats.cpuPercent99.sample(percent);
+            if (cpuNs > 0) {
+                uint32_t kHz = counters.cpu >= 0 ? mFrequencies.getCpukHz(counters.cpu) : 0;
+                ssize_t index = stats.timeInFrequency.indexOfKey(kHz);
+                if (index >= 0) {
+                    stats.timeInFrequency.editValueAt(index) += cpuNs;
+                } else {
+                    stats.timeInFrequency.add(kHz, cpuNs);
+                }
+            }
+        }
+
+        stats.primed = true;
+        stats.lastCpuNs = counters.cpuNs;
+        stats.lastVoluntary = counters.voluntary;
+        stats.lastInvoluntary = counters.involuntary;
+        stats.lastSampleTime = now;
+    }
+}
+
+void ThreadCpuProfiler::reset()
+{
+    for (size_t i = 0; i < mThreads.size(); ++i) {
+        mThreads.editValueAt(i)->reset();
+    }
+}
+
+void ThreadCpuProfiler::dump(String8& result, const char* prefix) const
+{
+    result.appendFormat("%s  tid name             samples  cpu%% mean    p50    p90    p99    max"
+            "  wakeups/s preempts/s\n", prefix);
+    for (size_t i = 0; i < mThreads.size(); ++i) {
+        const ThreadStats& stats = *mThreads.valueAt(i);
+        const double seconds = stats.sampledTime / 1e9;
+        result.appendFormat("%s%5d %-16.16s %7u %10.1f %6.1f %6.1f %6.1f %6.1f %10.1f %10.1f%s\n",
+                prefix, mThreads.keyAt(i), stats.name.string(), stats.cpuPercent.n(),
+                stats.cpuPercent.mean(), stats.cpuPercent50.quantile(),
+                stats.cpuPercent90.quantile(), stats.cpuPercent99.quantile(),
+                stats.cpuPercent.maximum(),
+                seconds > 0 ? stats.voluntary / seconds : 0.0,
+                seconds > 0 ? stats.involuntary / seconds : 0.0,
+                stats.exited ? " (exited)" : "");
+        if (stats.cpuNs > 0 && !stats.timeInFrequency.isEmpty()) {
+            result.appendFormat("%s      time in frequency:", prefix);
+            for (size_t j = 0; j < stats.timeInFrequency.size(); ++j) {
+                const uint32_t kHz = stats.timeInFrequency.keyAt(j);
+                const double percent = 100.0 * stats.timeInFrequency.valueAt(j) / stats.cpuNs;
+                if (kHz) {
+                    result.appendFormat(" %uMHz %.1f%%", kHz / 1000, percent);
+                } else {
+                    result.appendFormat(" unknown %.1f%%", percent);
+                }
+            }
+            result.append("\n");
+        }
+    }
+}
+
+}   // namespace android
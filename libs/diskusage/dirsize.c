@@ -17,7 +17,12 @@
 
 #include <dirent.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 
 #include <diskusage/dirsize.h>
 
@@ -35,41 +40,337 @@ int64_t stat_size(struct stat *s)
     return size;
 }
 
-int64_t calculate_dir_size(int dfd)
+/*
+ * The directories still to be read are on a stack shared by up to
+ * DIRSIZE_THREADS threads, started as directories are found. Each one is
+ * read with large getdents64() calls. Once DIRSIZE_MAX_STACKED directories
+ * are waiting, a thread walks the ones it finds itself, so that a wide
+ * tree doesn't run out of fds.
+ *
+ * Like it always did, the size of a directory includes "." and "..".
+ */
+
+#define DIRSIZE_THREADS         4
+#define DIRSIZE_BUFFER_SIZE     (64*1024)
+#define DIRSIZE_MAX_STACKED     256
+
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+typedef struct size_dir {
+    struct size_dir *next;
+    int fd;
+    int part;                   /* index in parts, or -1 */
+} size_dir_t;
+
+typedef struct {
+    dev_t dev;
+    ino_t ino;
+} size_inode_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    size_dir_t *stack;
+    int num_stacked;
+    int active;                 /* threads reading a directory */
+    pthread_t threads[DIRSIZE_THREADS-1];
+    int num_threads;
+    int max_threads;
+    int64_t size;
+    int flags;
+    dir_part_t *parts;
+    size_t num_parts;
+    dir_visit_t visit;
+    void *cookie;
+    size_inode_t *inodes;       /* open addressing, ino 0 is a free slot */
+    size_t num_inodes;
+    size_t avail_inodes;
+} size_tree_t;
+
+static void *_size_tree_thread(void *arg);
+static int64_t _size_dir_entries(size_tree_t *t, int dfd, int part, int top,
+        char *buf);
+
+/* Whether this is the first time the inode is seen, with t->lock held. */
+static int _size_inode_first(size_tree_t *t, dev_t dev, ino_t ino)
 {
-    int64_t size = 0;
-    struct stat s;
-    DIR *d;
-    struct dirent *de;
+    size_inode_t *inodes;
+    size_t i, avail;
 
-    d = fdopendir(dfd);
-    if (d == NULL) {
-        close(dfd);
-        return 0;
+    if (ino == 0) {
+        return 1;
     }
-
-    while ((de = readdir(d))) {
-        const char *name = de->d_name;
-        if (fstatat(dfd, name, &s, AT_SYMLINK_NOFOLLOW) == 0) {
-            size += stat_size(&s);
+    if (t->num_inodes * 2 >= t->avail_inodes) {
+        avail = t->avail_inodes ? t->avail_inodes * 2 : 256;
+        inodes = (size_inode_t*)calloc(avail, sizeof(size_inode_t));
+        if (inodes == NULL) {
+            return 1;
         }
-        if (de->d_type == DT_DIR) {
-            int subfd;
-
-            /* always skip "." and ".." */
-            if (name[0] == '.') {
-                if (name[1] == 0)
-                    continue;
-                if ((name[1] == '.') && (name[2] == 0))
-                    continue;
+        for (i = 0; i < t->avail_inodes; i++) {
+            if (t->inodes[i].ino != 0) {
+                size_t j = (size_t)(t->inodes[i].ino ^ t->inodes[i].dev) % avail;
+                while (inodes[j].ino != 0) {
+                    j = (j + 1) % avail;
+                }
+                inodes[j] = t->inodes[i];
             }
+        }
+        free(t->inodes);
+        t->inodes = inodes;
+        t->avail_inodes = avail;
+    }
+    i = (size_t)(ino ^ dev) % t->avail_inodes;
+    while (t->inodes[i].ino != 0) {
+        if (t->inodes[i].ino == ino && t->inodes[i].dev == dev) {
+            return 0;
+        }
+        i = (i + 1) % t->avail_inodes;
+    }
+    t->inodes[i].dev = dev;
+    t->inodes[i].ino = ino;
+    t->num_inodes++;
+    return 1;
+}
+
+static int64_t _size_entry(size_tree_t *t, struct stat *s)
+{
+    int first;
+
+    if ((t->flags & DIRSIZE_COUNT_LINKS_ONCE) && !S_ISDIR(s->st_mode) &&
+            s->st_nlink > 1) {
+        pthread_mutex_lock(&t->lock);
+        first = _size_inode_first(t, s->st_dev, s->st_ino);
+        pthread_mutex_unlock(&t->lock);
+        if (!first) {
+            return 0;
+        }
+    }
+    return stat_size(s);
+}
+
+static int _size_find_part(size_tree_t *t, const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < t->num_parts; i++) {
+        if (!strcmp(t->parts[i].name, name)) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-            subfd = openat(dfd, name, O_RDONLY | O_DIRECTORY);
-            if (subfd >= 0) {
-                size += calculate_dir_size(subfd);
+/* Stacks the directory, or walks it right away when the stack is full. */
+static int64_t _size_dir_push(size_tree_t *t, int fd, int part)
+{
+    size_dir_t *dir = NULL;
+    int64_t size;
+    char *buf;
+
+    pthread_mutex_lock(&t->lock);
+    if (t->num_stacked < DIRSIZE_MAX_STACKED) {
+        dir = (size_dir_t*)malloc(sizeof(size_dir_t));
+    }
+    if (dir != NULL) {
+        dir->fd = fd;
+        dir->part = part;
+        dir->next = t->stack;
+        t->stack = dir;
+        t->num_stacked++;
+        if (t->num_threads < t->max_threads &&
+                !pthread_create(&t->threads[t->num_threads], NULL, _size_tree_thread, t)) {
+            t->num_threads++;
+        }
+        pthread_cond_signal(&t->changed);
+        pthread_mutex_unlock(&t->lock);
+        return 0;
+    }
+    pthread_mutex_unlock(&t->lock);
+
+    buf = (char*)malloc(DIRSIZE_BUFFER_SIZE);
+    if (buf == NULL) {
+        close(fd);
+        return 0;
+    }
+    size = _size_dir_entries(t, fd, part, 0, buf);
+    free(buf);
+    return size;
+}
+
+/*
+ * Adds up the entries of dfd, which is closed, and stacks its
+ * sub-directories. Returns the size not yet added to t and parts.
+ */
+static int64_t _size_dir_entries(size_tree_t *t, int dfd, int part, int top,
+        char *buf)
+{
+    struct linux_dirent64 *de;
+    struct stat s;
+    int64_t size = 0, entry_size;
+    int n, pos, entry_part, type, subfd;
+
+    if (t->visit != NULL) {
+        t->visit(dfd, t->cookie);
+    }
+    while ((n = syscall(__NR_getdents64, dfd, buf, DIRSIZE_BUFFER_SIZE)) > 0) {
+        for (pos = 0; pos < n; pos += de->d_reclen) {
+            de = (struct linux_dirent64*)(buf + pos);
+            const char *name = de->d_name;
+
+            entry_part = top ? _size_find_part(t, name) : part;
+            entry_size = 0;
+            type = de->d_type;
+            if (fstatat(dfd, name, &s, AT_SYMLINK_NOFOLLOW) == 0) {
+                entry_size = _size_entry(t, &s);
+                if (type == DT_UNKNOWN && S_ISDIR(s.st_mode)) {
+                    type = DT_DIR;
+                }
+            }
+            if (type == DT_DIR) {
+                    /* always skip "." and ".." */
+                if (name[0] == '.') {
+                    if (name[1] == 0) goto add;
+                    if ((name[1] == '.') && (name[2] == 0)) goto add;
+                }
+                subfd = openat(dfd, name, O_RDONLY | O_DIRECTORY);
+                if (subfd >= 0) {
+                    entry_size += _size_dir_push(t, subfd, entry_part);
+                }
+            }
+add:
+            if (entry_part == part) {
+                size += entry_size;
+            } else {
+                /* the top directory, which isn't in a part */
+                pthread_mutex_lock(&t->lock);
+                t->parts[entry_part].size += entry_size;
+                t->size += entry_size;
+                pthread_mutex_unlock(&t->lock);
             }
         }
     }
-    closedir(d);
+    close(dfd);
     return size;
 }
+
+static void *_size_tree_thread(void *arg)
+{
+    size_tree_t *t = (size_tree_t*)arg;
+    size_dir_t *dir;
+    int64_t size;
+    char *buf;
+
+    buf = (char*)malloc(DIRSIZE_BUFFER_SIZE);
+
+    pthread_mutex_lock(&t->lock);
+    for (;;) {
+        while (t->stack == NULL && t->active) {
+            pthread_cond_wait(&t->changed, &t->lock);
+        }
+        dir = t->stack;
+        if (dir == NULL) {
+            /* nothing left, and nobody to find more */
+            break;
+        }
+        if (buf == NULL) {
+            /* leave the rest to the threads that could allocate one */
+            if (t->active) {
+                pthread_cond_wait(&t->changed, &t->lock);
+                continue;
+            }
+            buf = (char*)malloc(DIRSIZE_BUFFER_SIZE);
+            if (buf == NULL) {
+                break;
+            }
+        }
+        t->stack = dir->next;
+        t->num_stacked--;
+        t->active++;
+        pthread_mutex_unlock(&t->lock);
+
+        size = _size_dir_entries(t, dir->fd, dir->part, 0, buf);
+
+        pthread_mutex_lock(&t->lock);
+        t->size += size;
+        if (dir->part >= 0) {
+            t->parts[dir->part].size += size;
+        }
+        free(dir);
+        t->active--;
+        if (t->stack == NULL && !t->active) {
+            pthread_cond_broadcast(&t->changed);
+        }
+    }
+    pthread_mutex_unlock(&t->lock);
+    free(buf);
+    return NULL;
+}
+
+int64_t calculate_dir_sizes(int dfd, int flags, dir_part_t *parts,
+        size_t num_parts, dir_visit_t visit, void *cookie)
+{
+    size_tree_t t;
+    int64_t size = 0;
+    size_t i;
+    long cpus;
+    char *buf;
+
+    for (i = 0; i < num_parts; i++) {
+        parts[i].size = 0;
+    }
+
+    pthread_mutex_init(&t.lock, NULL);
+    pthread_cond_init(&t.changed, NULL);
+    t.stack = NULL;
+    t.num_stacked = 0;
+    t.active = 1;
+    t.num_threads = 0;
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    t.max_threads = (cpus > DIRSIZE_THREADS) ? DIRSIZE_THREADS-1 :
+            (cpus > 1) ? (int)cpus-1 : 0;
+    t.size = 0;
+    t.flags = flags;
+    t.parts = parts;
+    t.num_parts = num_parts;
+    t.visit = visit;
+    t.cookie = cookie;
+    t.inodes = NULL;
+    t.num_inodes = 0;
+    t.avail_inodes = 0;
+
+    /* the top directory is the only one whose entries may be in a part */
+    buf = (char*)malloc(DIRSIZE_BUFFER_SIZE);
+    if (buf != NULL) {
+        size = _size_dir_entries(&t, dfd, -1, 1, buf);
+        free(buf);
+    } else {
+        close(dfd);
+    }
+
+    pthread_mutex_lock(&t.lock);
+    t.size += size;
+    t.active--;
+    pthread_cond_broadcast(&t.changed);
+    pthread_mutex_unlock(&t.lock);
+
+    _size_tree_thread(&t);
+    for (i = 0; i < (size_t)t.num_threads; i++) {
+        pthread_join(t.threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&t.changed);
+    pthread_mutex_destroy(&t.lock);
+    free(t.inodes);
+    return t.size;
+}
+
+int64_t calculate_dir_size(int dfd)
+{
+    return calculate_dir_sizes(dfd, 0, NULL, 0, NULL, NULL);
+}
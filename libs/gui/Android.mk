@@ -5,10 +5,13 @@ LOCAL_SRC_FILES:= \
 	BitTube.cpp \
 	BufferItemConsumer.cpp \
 	BufferQueue.cpp \
+	BufferQueueTee.cpp \
 	ConsumerBase.cpp \
 	CpuConsumer.cpp \
 	DisplayEventReceiver.cpp \
 	DummyConsumer.cpp \
+	EGLImageCache.cpp \
+	FencePipeline.cpp \
 	GLConsumer.cpp \
 	GraphicBufferAlloc.cpp \
 	GuiConfig.cpp \
@@ -20,9 +23,13 @@ LOCAL_SRC_FILES:= \
 	ISurfaceComposer.cpp \
 	ISurfaceComposerClient.cpp \
 	LayerState.cpp \
+	MetadataBufferConsumer.cpp \
 	Sensor.cpp \
+	SensorDirectChannel.cpp \
 	SensorEventQueue.cpp \
+	SensorEventQueueSet.cpp \
 	SensorManager.cpp \
+	SharedVSync.cpp \
 	Surface.cpp \
 	SurfaceControl.cpp \
 	SurfaceComposerClient.cpp \
@@ -15,8 +15,11 @@
  */
 
 #include <stdint.h>
+#include <string.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <fcntl.h>
 #include <unistd.h>
@@ -32,15 +35,26 @@ namespace android {
 
 // Socket buffer size.  The default is typically about 128KB, which is much larger than
 // we really need.  So we make it smaller.
-static const size_t SOCKET_BUFFER_SIZE = 4 * 1024;
+static const size_t SOCKET_BUFFER_SIZE = BitTube::DEFAULT_SOCKET_BUFFER_SIZE;
 
 
 BitTube::BitTube()
     : mSendFd(-1), mReceiveFd(-1)
+{
+    init(SOCKET_BUFFER_SIZE);
+}
+
+BitTube::BitTube(size_t bufferSize)
+    : mSendFd(-1), mReceiveFd(-1)
+{
+    init(bufferSize);
+}
+
+void BitTube::init(size_t bufferSize)
 {
     int sockets[2];
     if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) == 0) {
-        int size = SOCKET_BUFFER_SIZE;
+        int size = bufferSize;
         setsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
         setsockopt(sockets[0], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
         setsockopt(sockets[1], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
@@ -131,16 +145,80 @@ status_t BitTube::writeToParcel(Parcel* reply) const
 }
 
 
+#if defined(__NR_sendmmsg) && defined(__NR_recvmmsg)
+
+// sendmmsg() and recvmmsg() move a packet per struct mmsghdr, up to
+// MAX_BATCH of them per call. The C library may not have wrappers for them.
+struct tube_mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+
+static const size_t MAX_BATCH = 32;
+
+// cleared the first time the kernel turns out not to have the calls
+static volatile bool sHasMmsg = true;
+
+// Returns how many objects were transferred, or a negative errno.
+static ssize_t transferObjects(int fd, bool send, char* objects,
+        size_t count, size_t objSize)
+{
+    if (count > MAX_BATCH) {
+        count = MAX_BATCH;
+    }
+    struct iovec iov[MAX_BATCH];
+    struct tube_mmsghdr msgs[MAX_BATCH];
+    memset(msgs, 0, count * sizeof(msgs[0]));
+    for (size_t i=0 ; i<count ; i++) {
+        iov[i].iov_base = objects + objSize * i;
+        iov[i].iov_len = objSize;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    long n;
+    do {
+        n = send ?
+                syscall(__NR_sendmmsg, fd, msgs, count, MSG_DONTWAIT | MSG_NOSIGNAL) :
+                syscall(__NR_recvmmsg, fd, msgs, count, MSG_DONTWAIT, NULL);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        if (errno == ENOSYS) {
+            sHasMmsg = false;
+        }
+        return errno == EWOULDBLOCK ? -EAGAIN : -errno;
+    }
+    return n;
+}
+
+#endif
+
 ssize_t BitTube::sendObjects(const sp<BitTube>& tube,
         void const* events, size_t count, size_t objSize)
 {
-    ssize_t numObjects = 0;
-    for (size_t i=0 ; i<count ; i++) {
-        const char* vaddr = reinterpret_cast<const char*>(events) + objSize * i;
-        ssize_t size = tube->write(vaddr, objSize);
+    char* vaddr = const_cast<char*>(reinterpret_cast<const char*>(events));
+    size_t numObjects = 0;
+#if defined(__NR_sendmmsg) && defined(__NR_recvmmsg)
+    while (sHasMmsg && numObjects < count) {
+        ssize_t n = transferObjects(tube->mSendFd, true,
+                vaddr + objSize * numObjects, count - numObjects, objSize);
+        if (n == -ENOSYS) {
+            break;
+        } else if (n < 0) {
+            return numObjects ? ssize_t(numObjects) : n;
+        } else if (n == 0) {
+            break;
+        }
+        numObjects += n;
+    }
+    if (sHasMmsg) {
+        return numObjects;
+    }
+#endif
+    for (size_t i=numObjects ; i<count ; i++) {
+        ssize_t size = tube->write(vaddr + objSize * i, objSize);
         if (size < 0) {
-            // error occurred
-            return size;
+            // what was sent so far made it, whatever the error
+            return numObjects ? ssize_t(numObjects) : size;
         } else if (size == 0) {
             // no more space
             break;
@@ -154,7 +232,31 @@ ssize_t BitTube::recvObjects(const sp<BitTube>& tube,
         void* events, size_t count, size_t objSize)
 {
     ssize_t numObjects = 0;
-    for (size_t i=0 ; i<count ; i++) {
+#if defined(__NR_sendmmsg) && defined(__NR_recvmmsg)
+    char* base = reinterpret_cast<char*>(events);
+    while (sHasMmsg && size_t(numObjects) < count) {
+        const size_t wanted = count - numObjects;
+        ssize_t n = transferObjects(tube->mReceiveFd, false,
+                base + objSize * numObjects, wanted, objSize);
+        if (n == -ENOSYS) {
+            break;
+        } else if (n == -EAGAIN) {
+            // no more messages, nothing the client should care about
+            return numObjects;
+        } else if (n < 0) {
+            return numObjects ? numObjects : n;
+        }
+        numObjects += n;
+        if (size_t(n) < wanted && size_t(n) < MAX_BATCH) {
+            // no more messages
+            return numObjects;
+        }
+    }
+    if (sHasMmsg) {
+        return numObjects;
+    }
+#endif
+    for (size_t i=numObjects ; i<count ; i++) {
         char* vaddr = reinterpret_cast<char*>(events) + objSize * i;
         ssize_t size = tube->read(vaddr, objSize);
         if (size < 0) {
@@ -54,7 +54,7 @@ status_t BufferItemConsumer::acquireBuffer(BufferItem *item, bool waitForFence)
 
     Mutex::Autolock _l(mMutex);
 
-    err = acquireBufferLocked(item);
+    err = acquireBufferLocked(item, 0);
     if (err != OK) {
         if (err != NO_BUFFER_AVAILABLE) {
             BI_LOGE("Error acquiring buffer: %s (%d)", strerror(err), err);
@@ -125,6 +125,22 @@ static bool isBufferGeometryUpdateRequired(sp<GraphicBuffer> buffer,
     return true;
 }
 
+class BufferQueue::Lock {
+public:
+    Lock(BufferQueue& queue) : mQueue(queue) {
+        if (mQueue.mMutex.tryLock() != NO_ERROR) {
+            mQueue.mMutex.lock();
+            mQueue.mLockContentionCount++;
+        }
+        mQueue.mLockCount++;
+    }
+    ~Lock() {
+        mQueue.mMutex.unlock();
+    }
+private:
+    BufferQueue& mQueue;
+};
+
 BufferQueue::BufferQueue(bool allowSynchronousMode,
         const sp<IGraphicBufferAlloc>& allocator) :
     mDefaultWidth(1),
@@ -132,10 +148,24 @@ BufferQueue::BufferQueue(bool allowSynchronousMode,
     mMaxAcquiredBufferCount(1),
     mDefaultMaxBufferCount(2),
     mOverrideMaxBufferCount(0),
+    mAdaptiveMinBufferCount(0),
+    mAdaptiveMaxBufferCount(0),
+    mAdaptiveBufferCount(0),
+    mLastAcquireTime(0),
+    mAcquireInterval(0),
+    mProducerWorkTime(0),
+    mAdaptiveFrames(0),
     mSynchronousMode(false),
     mAllowSynchronousMode(allowSynchronousMode),
     mConnectedApi(NO_CONNECTED_API),
+    mDequeueWaiters(0),
+    mDropMode(DROP_NONE),
+    mMaxQueuedBuffers(0),
+    mMaxFrameAge(0),
+    mFramesDropped(0),
     mAbandoned(false),
+    mLockCount(0),
+    mLockContentionCount(0),
     mFrameCounter(0),
     mBufferHasBeenQueued(false),
     mDefaultBufferFormat(PIXEL_FORMAT_RGBA_8888),
@@ -167,7 +197,7 @@ status_t BufferQueue::setDefaultMaxBufferCountLocked(int count) {
         return BAD_VALUE;
 
     mDefaultMaxBufferCount = count;
-    mDequeueCondition.broadcast();
+    broadcastDequeueConditionLocked();
 
     return NO_ERROR;
 }
@@ -230,7 +260,7 @@ status_t BufferQueue::setBufferCount(int bufferCount) {
         const int minBufferSlots = getMinMaxBufferCountLocked();
         if (bufferCount == 0) {
             mOverrideMaxBufferCount = 0;
-            mDequeueCondition.broadcast();
+            broadcastDequeueConditionLocked();
             return NO_ERROR;
         }
 
@@ -247,7 +277,7 @@ status_t BufferQueue::setBufferCount(int bufferCount) {
         freeAllBuffersLocked();
         mOverrideMaxBufferCount = bufferCount;
         mBufferHasBeenQueued = false;
-        mDequeueCondition.broadcast();
+        broadcastDequeueConditionLocked();
         listener = mConsumerListener;
     } // scope for lock
 
@@ -336,11 +366,15 @@ status_t BufferQueue::dequeueBuffer(int *outBuf, sp<Fence>* outFence,
     }
 
     status_t returnFlags(OK);
+    bool allocate = false;
     EGLDisplay dpy = EGL_NO_DISPLAY;
     EGLSyncKHR eglFence = EGL_NO_SYNC_KHR;
+    // a buffer that is reallocated is only destroyed once mMutex is
+    // released, freeing it can take a while
+    sp<GraphicBuffer> oldBuffer;
 
     { // Scope for the lock
-        Mutex::Autolock lock(mMutex);
+        Lock lock(*this);
 
         if (format == 0) {
             format = mDefaultBufferFormat;
@@ -351,6 +385,7 @@ status_t BufferQueue::dequeueBuffer(int *outBuf, sp<Fence>* outFence,
         int found = -1;
         int dequeuedCount = 0;
         bool tryAgain = true;
+        nsecs_t waitStart = 0;
         while (tryAgain) {
             if (mAbandoned) {
                 ST_LOGE("dequeueBuffer: BufferQueue has been abandoned!");
@@ -360,9 +395,15 @@ status_t BufferQueue::dequeueBuffer(int *outBuf, sp<Fence>* outFence,
             const int maxBufferCount = getMaxBufferCountLocked();
 
             // Free up any buffers that are in slots beyond the max buffer
-            // count.
+            // count. Only free slots can go: a slot the producer or the
+            // consumer still owns is freed by a later dequeueBuffer, once
+            // it has been released. Queued and dequeued slots normally keep
+            // the max buffer count up (see getMaxBufferCountLocked), but a
+            // lower adaptive buffer count can leave an acquired one here.
             for (int i = maxBufferCount; i < NUM_BUFFER_SLOTS; i++) {
-                assert(mSlots[i].mBufferState == BufferSlot::FREE);
+                if (mSlots[i].mBufferState != BufferSlot::FREE) {
+                    continue;
+                }
                 if (mSlots[i].mGraphicBuffer != NULL) {
                     freeBufferLocked(i);
                     returnFlags |= IGraphicBufferProducer::RELEASE_ALL_BUFFERS;
@@ -420,7 +461,10 @@ status_t BufferQueue::dequeueBuffer(int *outBuf, sp<Fence>* outFence,
             // the max buffer count to change.
             tryAgain = found == INVALID_BUFFER_SLOT;
             if (tryAgain) {
-                mDequeueCondition.wait(mMutex);
+                if (!waitStart) {
+                    waitStart = systemTime(SYSTEM_TIME_MONOTONIC);
+                }
+                waitDequeueConditionLocked();
             }
         }
 
@@ -444,6 +488,9 @@ status_t BufferQueue::dequeueBuffer(int *outBuf, sp<Fence>* outFence,
         }
 
         mSlots[buf].mBufferState = BufferSlot::DEQUEUED;
+        mSlots[buf].mDequeueTime = systemTime(SYSTEM_TIME_MONOTONIC);
+        mSlots[buf].mDequeueWait = waitStart ?
+                mSlots[buf].mDequeueTime - waitStart : 0;
 
         const sp<GraphicBuffer>& buffer(mSlots[buf].mGraphicBuffer);
         BufGeometry currentGeometry;
@@ -464,13 +511,21 @@ status_t BufferQueue::dequeueBuffer(int *outBuf, sp<Fence>* outFence,
             ((uint32_t(buffer->usage) & usage) != usage))
         {
             mSlots[buf].mAcquireCalled = false;
+            oldBuffer = mSlots[buf].mGraphicBuffer;
             mSlots[buf].mGraphicBuffer = NULL;
             mSlots[buf].mRequestBufferCalled = false;
             mSlots[buf].mEglFence = EGL_NO_SYNC_KHR;
             mSlots[buf].mFence = Fence::NO_FENCE;
             mSlots[buf].mEglDisplay = EGL_NO_DISPLAY;
+            mSlots[buf].mNeedsReallocation = false;
 
             returnFlags |= IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION;
+            allocate = true;
+        } else if (mSlots[buf].mNeedsReallocation) {
+            // allocateBuffers() installed this buffer, the producer may
+            // still have the one the slot held before
+            mSlots[buf].mNeedsReallocation = false;
+            returnFlags |= IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION;
         }
 
         dpy = mSlots[buf].mEglDisplay;
@@ -480,7 +535,7 @@ status_t BufferQueue::dequeueBuffer(int *outBuf, sp<Fence>* outFence,
         mSlots[buf].mFence = Fence::NO_FENCE;
     }  // end lock scope
 
-    if (returnFlags & IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) {
+    if (allocate) {
         status_t error;
         sp<GraphicBuffer> graphicBuffer(
                 mGraphicBufferAlloc->createGraphicBuffer(
@@ -522,6 +577,98 @@ status_t BufferQueue::dequeueBuffer(int *outBuf, sp<Fence>* outFence,
     return returnFlags;
 }
 
+void BufferQueue::allocateBuffers(uint32_t w, uint32_t h,
+        uint32_t format, uint32_t usage) {
+    ATRACE_CALL();
+    ST_LOGV("allocateBuffers: w=%d h=%d fmt=%#x usage=%#x", w, h, format, usage);
+
+    if ((w && !h) || (!w && h)) {
+        ST_LOGE("allocateBuffers: invalid size: w=%u, h=%u", w, h);
+        return;
+    }
+
+    Vector<int> slots;
+    { // Scope for the lock
+        Mutex::Autolock lock(mMutex);
+        if (mAbandoned) {
+            ST_LOGE("allocateBuffers: BufferQueue has been abandoned!");
+            return;
+        }
+        if (!w && !h) {
+            w = mDefaultWidth;
+            h = mDefaultHeight;
+        }
+        if (format == 0) {
+            format = mDefaultBufferFormat;
+        }
+        usage |= mConsumerUsageBits;
+
+        const int maxBufferCount = getMaxBufferCountLocked();
+        for (int i = 0; i < maxBufferCount; i++) {
+            if (mSlots[i].mBufferState == BufferSlot::FREE &&
+                    mSlots[i].mGraphicBuffer == NULL) {
+                slots.add(i);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < slots.size(); i++) {
+        status_t error;
+        sp<GraphicBuffer> graphicBuffer(
+                mGraphicBufferAlloc->createGraphicBuffer(
+                        w, h, format, usage, &error));
+        if (graphicBuffer == 0) {
+            ST_LOGE("allocateBuffers: SurfaceComposer::createGraphicBuffer "
+                    "failed");
+            return;
+        }
+
+        Mutex::Autolock lock(mMutex);
+        if (mAbandoned) {
+            return;
+        }
+        // the slot may have been dequeued or given a buffer meanwhile
+        BufferSlot& slot(mSlots[slots[i]]);
+        if (slots[i] < getMaxBufferCountLocked() &&
+                slot.mBufferState == BufferSlot::FREE &&
+                slot.mGraphicBuffer == NULL) {
+            slot.mGraphicBuffer = graphicBuffer;
+            slot.mAcquireCalled = false;
+            slot.mRequestBufferCalled = false;
+            slot.mNeedsReallocation = true;
+            slot.mFrameNumber = 0;
+        }
+    }
+}
+
+status_t BufferQueue::requestBuffers(uint32_t* slotMask,
+        sp<GraphicBuffer>* buffers) {
+    ATRACE_CALL();
+    ST_LOGV("requestBuffers: mask=%#x", *slotMask);
+    Mutex::Autolock lock(mMutex);
+    if (mAbandoned) {
+        ST_LOGE("requestBuffers: BufferQueue has been abandoned!");
+        *slotMask = 0;
+        return NO_INIT;
+    }
+    uint32_t mask = 0;
+    const int maxBufferCount = getMaxBufferCountLocked();
+    for (int i = 0; i < maxBufferCount; i++) {
+        BufferSlot& slot(mSlots[i]);
+        if ((*slotMask & (1u << i)) && slot.mGraphicBuffer != NULL &&
+                (slot.mBufferState == BufferSlot::FREE ||
+                 slot.mBufferState == BufferSlot::DEQUEUED)) {
+            slot.mRequestBufferCalled = true;
+            // the producer has this buffer now
+            slot.mNeedsReallocation = false;
+            buffers[i] = slot.mGraphicBuffer;
+            mask |= 1u << i;
+        }
+    }
+    *slotMask = mask;
+    return NO_ERROR;
+}
+
 status_t BufferQueue::setSynchronousMode(bool enabled) {
     ATRACE_CALL();
     ST_LOGV("setSynchronousMode: enabled=%d", enabled);
@@ -549,7 +696,7 @@ status_t BufferQueue::setSynchronousMode(bool enabled) {
         // - if the client set the number of buffers, we're guaranteed that
         // we have at least 3 (because we don't allow less)
         mSynchronousMode = enabled;
-        mDequeueCondition.broadcast();
+        broadcastDequeueConditionLocked();
     }
     return err;
 }
@@ -578,9 +725,10 @@ status_t BufferQueue::queueBuffer(int buf,
             transform, scalingModeName(scalingMode));
 
     sp<ConsumerListener> listener;
+    uint32_t dropped = 0;
 
     { // scope for the lock
-        Mutex::Autolock lock(mMutex);
+        Lock lock(*this);
         if (mAbandoned) {
             ST_LOGE("queueBuffer: BufferQueue has been abandoned!");
             return NO_INIT;
@@ -632,6 +780,26 @@ status_t BufferQueue::queueBuffer(int buf,
         }
 
         if (mSynchronousMode) {
+            if (mDropMode != DROP_NONE && mMaxQueuedBuffers > 0) {
+                if (mDropMode == DROP_NEWEST &&
+                        int(mQueue.size()) >= mMaxQueuedBuffers) {
+                    // the buffer goes back to the producer, which must
+                    // wait for its own rendering before reusing it
+                    mSlots[buf].mFence = fence;
+                    dropBufferLocked(buf);
+                    broadcastDequeueConditionLocked();
+                    output->inflate(mDefaultWidth, mDefaultHeight,
+                            mTransformHint, mQueue.size());
+                    return NO_ERROR;
+                }
+                while (int(mQueue.size()) >= mMaxQueuedBuffers) {
+                    Fifo::iterator front(mQueue.begin());
+                    dropBufferLocked(*front);
+                    mQueue.erase(front);
+                    dropped++;
+                }
+            }
+
             // In synchronous mode we queue all buffers in a FIFO.
             mQueue.push_back(buf);
 
@@ -650,9 +818,7 @@ status_t BufferQueue::queueBuffer(int buf,
             } else {
                 Fifo::iterator front(mQueue.begin());
                 // buffer currently queued is freed
-                mSlots[*front].mBufferState = BufferSlot::FREE;
-                // reset the frame number of the freed buffer
-                mSlots[*front].mFrameNumber = 0;
+                dropBufferLocked(*front);
                 // and we record the new buffer index in the queued list
                 *front = buf;
             }
@@ -679,17 +845,31 @@ status_t BufferQueue::queueBuffer(int buf,
         mFrameCounter++;
         mSlots[buf].mFrameNumber = mFrameCounter;
 
+        FrameHistory& history(mFrameHistory[mFrameCounter % NUM_FRAME_HISTORY]);
+        history.timestamps.frameNumber = mFrameCounter;
+        history.timestamps.dequeueWait = mSlots[buf].mDequeueWait;
+        history.timestamps.queueTime = systemTime(SYSTEM_TIME_MONOTONIC);
+        history.timestamps.acquireTime = 0;
+        history.timestamps.presentTime = 0;
+        history.presentFence = NULL;
+
+        updateAdaptiveBufferCountLocked(buf, history.timestamps.queueTime);
+
         mBufferHasBeenQueued = true;
-        mDequeueCondition.broadcast();
+        broadcastDequeueConditionLocked();
 
         output->inflate(mDefaultWidth, mDefaultHeight, mTransformHint,
                 mQueue.size());
+        output->setFrameNumber(mFrameCounter);
 
         ATRACE_INT(mConsumerName.string(), mQueue.size());
     } // scope for the lock
 
     // call back without lock held
     if (listener != 0) {
+        while (dropped--) {
+            listener->onFrameDropped();
+        }
         listener->onFrameAvailable();
     }
     return NO_ERROR;
@@ -698,7 +878,7 @@ status_t BufferQueue::queueBuffer(int buf,
 void BufferQueue::cancelBuffer(int buf, const sp<Fence>& fence) {
     ATRACE_CALL();
     ST_LOGV("cancelBuffer: slot=%d", buf);
-    Mutex::Autolock lock(mMutex);
+    Lock lock(*this);
 
     if (mAbandoned) {
         ST_LOGW("cancelBuffer: BufferQueue has been abandoned!");
@@ -721,7 +901,7 @@ void BufferQueue::cancelBuffer(int buf, const sp<Fence>& fence) {
     mSlots[buf].mBufferState = BufferSlot::FREE;
     mSlots[buf].mFrameNumber = 0;
     mSlots[buf].mFence = fence;
-    mDequeueCondition.broadcast();
+    broadcastDequeueConditionLocked();
 }
 
 status_t BufferQueue::connect(int api, QueueBufferOutput* output) {
@@ -790,7 +970,7 @@ status_t BufferQueue::disconnect(int api) {
                     drainQueueAndFreeBuffersLocked();
                     mNextBufferInfo.set(0, 0, 0);
                     mConnectedApi = NO_CONNECTED_API;
-                    mDequeueCondition.broadcast();
+                    broadcastDequeueConditionLocked();
                     listener = mConsumerListener;
                 } else {
                     ST_LOGE("disconnect: connected to another api (cur=%d, req=%d)",
@@ -842,6 +1022,24 @@ void BufferQueue::dump(String8& result, const char* prefix,
             fifoSize, fifo.string());
     result.append(buffer);
 
+    snprintf(buffer, SIZE, "%s-lock contention: %u of %u buffer operations "
+            "waited for the lock\n", prefix, mLockContentionCount, mLockCount);
+    result.append(buffer);
+
+    snprintf(buffer, SIZE, "%s-frames dropped: %u (drop-mode=%d, "
+            "max-queued=%d, max-age=%lldns)\n", prefix, mFramesDropped,
+            mDropMode, mMaxQueuedBuffers, mMaxFrameAge);
+    result.append(buffer);
+
+    if (mAdaptiveMaxBufferCount) {
+        snprintf(buffer, SIZE, "%s-adaptive buffer count: %d in [%d, %d], "
+                "producer %.2f ms per frame, consumer period %.2f ms\n",
+                prefix, mAdaptiveBufferCount, mAdaptiveMinBufferCount,
+                mAdaptiveMaxBufferCount, mProducerWorkTime / 1e6,
+                mAcquireInterval / 1e6);
+        result.append(buffer);
+    }
+
 
     struct {
         const char * operator()(int state) const {
@@ -897,6 +1095,7 @@ void BufferQueue::freeBufferLocked(int slot) {
     mSlots[slot].mBufferState = BufferSlot::FREE;
     mSlots[slot].mFrameNumber = 0;
     mSlots[slot].mAcquireCalled = false;
+    mSlots[slot].mNeedsReallocation = false;
 
     // destroy fence as BufferQueue now takes ownership
     if (mSlots[slot].mEglFence != EGL_NO_SYNC_KHR) {
@@ -917,8 +1116,12 @@ void BufferQueue::freeAllBuffersLocked() {
 }
 
 status_t BufferQueue::acquireBuffer(BufferItem *buffer) {
+    return acquireBuffer(buffer, 0);
+}
+
+status_t BufferQueue::acquireBuffer(BufferItem *buffer, nsecs_t presentWhen) {
     ATRACE_CALL();
-    Mutex::Autolock _l(mMutex);
+    Lock _l(*this);
 
     // Check that the consumer doesn't currently have the maximum number of
     // buffers acquired.  We allow the max buffer count to be exceeded by one
@@ -936,6 +1139,65 @@ status_t BufferQueue::acquireBuffer(BufferItem *buffer) {
         return INVALID_OPERATION;
     }
 
+    // timestamps this far from the expected present time are considered
+    // bogus: a buffer due that much later is presented right away, and one
+    // due that much earlier doesn't replace the buffer before it. The
+    // latter are typically timestamps of 0, relative ones or from another
+    // clock, which would otherwise make every queued buffer but the last
+    // one dropped.
+    const nsecs_t MAX_REASONABLE_NSEC = 1000000000LL; // 1 second
+
+    uint32_t skipped = 0;
+
+    // skip the buffers that are too old to be worth showing, but always
+    // keep the most recent one
+    if (mMaxFrameAge > 0) {
+        const nsecs_t deadline =
+                systemTime(SYSTEM_TIME_MONOTONIC) - mMaxFrameAge;
+        while (mQueue.size() > 1 &&
+                mSlots[*mQueue.begin()].mTimestamp < deadline) {
+            Fifo::iterator front(mQueue.begin());
+            ST_LOGV("acquireBuffer: skipping slot %d, too old", *front);
+            dropBufferLocked(*front);
+            mQueue.erase(front);
+            skipped++;
+        }
+        if (skipped) {
+            broadcastDequeueConditionLocked();
+        }
+    }
+
+    if (presentWhen != 0) {
+        // drop the buffers that would be replaced before being presented
+        while (mQueue.size() > 1) {
+            const nsecs_t desiredPresent = mSlots[mQueue[1]].mTimestamp;
+            if (desiredPresent < presentWhen - MAX_REASONABLE_NSEC ||
+                    desiredPresent > presentWhen) {
+                break;
+            }
+            Fifo::iterator front(mQueue.begin());
+            ST_LOGV("acquireBuffer: skipping slot %d, slot %d is due by %lld",
+                    *front, mQueue[1], presentWhen);
+            dropBufferLocked(*front);
+            mQueue.erase(front);
+            skipped++;
+        }
+        if (skipped) {
+            broadcastDequeueConditionLocked();
+        }
+
+        if (!mQueue.empty()) {
+            const nsecs_t desiredPresent = mSlots[*mQueue.begin()].mTimestamp;
+            if (desiredPresent > presentWhen &&
+                    desiredPresent < presentWhen + MAX_REASONABLE_NSEC) {
+                ST_LOGV("acquireBuffer: defer slot %d, desired=%lld "
+                        "expected=%lld", *mQueue.begin(), desiredPresent,
+                        presentWhen);
+                return PRESENT_LATER;
+            }
+        }
+    }
+
     // check if queue is empty
     // In asynchronous mode the list is guaranteed to be one buffer
     // deep, while in synchronous mode we use the oldest buffer.
@@ -957,6 +1219,22 @@ status_t BufferQueue::acquireBuffer(BufferItem *buffer) {
         buffer->mTimestamp = mSlots[buf].mTimestamp;
         buffer->mBuf = buf;
         buffer->mFence = mSlots[buf].mFence;
+        buffer->mSkipped = skipped;
+
+        const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+        FrameHistory* history = findFrameHistoryLocked(mSlots[buf].mFrameNumber);
+        if (history) {
+            history->timestamps.acquireTime = now;
+        }
+        if (mAdaptiveMaxBufferCount) {
+            // a pause in the stream isn't the consumer's cadence
+            const nsecs_t interval = now - mLastAcquireTime;
+            if (mLastAcquireTime && interval < s2ns(1)) {
+                mAcquireInterval = mAcquireInterval ?
+                        (mAcquireInterval*7 + interval) / 8 : interval;
+            }
+            mLastAcquireTime = now;
+        }
 
         mSlots[buf].mAcquireCalled = true;
         mSlots[buf].mNeedsCleanupOnRelease = false;
@@ -964,7 +1242,7 @@ status_t BufferQueue::acquireBuffer(BufferItem *buffer) {
         mSlots[buf].mFence = Fence::NO_FENCE;
 
         mQueue.erase(front);
-        mDequeueCondition.broadcast();
+        broadcastDequeueConditionLocked();
 
         ATRACE_INT(mConsumerName.string(), mQueue.size());
     } else {
@@ -979,7 +1257,7 @@ status_t BufferQueue::releaseBuffer(int buf, EGLDisplay display,
     ATRACE_CALL();
     ATRACE_BUFFER_INDEX(buf);
 
-    Mutex::Autolock _l(mMutex);
+    Lock _l(*this);
 
     if (buf == INVALID_BUFFER_SLOT || fence == NULL) {
         return BAD_VALUE;
@@ -1001,7 +1279,7 @@ status_t BufferQueue::releaseBuffer(int buf, EGLDisplay display,
         return -EINVAL;
     }
 
-    mDequeueCondition.broadcast();
+    broadcastDequeueConditionLocked();
     return NO_ERROR;
 }
 
@@ -1036,7 +1314,7 @@ status_t BufferQueue::consumerDisconnect() {
     mConsumerListener = NULL;
     mQueue.clear();
     freeAllBuffersLocked();
-    mDequeueCondition.broadcast();
+    broadcastDequeueConditionLocked();
     return NO_ERROR;
 }
 
@@ -1082,6 +1360,70 @@ status_t BufferQueue::setDefaultMaxBufferCount(int bufferCount) {
     return setDefaultMaxBufferCountLocked(bufferCount);
 }
 
+status_t BufferQueue::setAdaptiveBufferCount(int minBufferCount,
+        int maxBufferCount) {
+    ATRACE_CALL();
+    Mutex::Autolock lock(mMutex);
+    if (minBufferCount || maxBufferCount) {
+        if (minBufferCount < 2 || maxBufferCount < minBufferCount ||
+                maxBufferCount > NUM_BUFFER_SLOTS) {
+            ST_LOGE("setAdaptiveBufferCount: invalid range [%d, %d]",
+                    minBufferCount, maxBufferCount);
+            return BAD_VALUE;
+        }
+    }
+    mAdaptiveMinBufferCount = minBufferCount;
+    mAdaptiveMaxBufferCount = maxBufferCount;
+    mAdaptiveBufferCount = maxBufferCount;
+    mLastAcquireTime = 0;
+    mAcquireInterval = 0;
+    mProducerWorkTime = 0;
+    mAdaptiveFrames = 0;
+    broadcastDequeueConditionLocked();
+    return NO_ERROR;
+}
+
+void BufferQueue::updateAdaptiveBufferCountLocked(int buf, nsecs_t now) {
+    if (!mAdaptiveMaxBufferCount || mOverrideMaxBufferCount) {
+        return;
+    }
+    const nsecs_t work = now - mSlots[buf].mDequeueTime;
+    mProducerWorkTime = mProducerWorkTime ?
+            (mProducerWorkTime*7 + work) / 8 : work;
+    const nsecs_t interval = mAcquireInterval;
+    if (!interval) {
+        return;
+    }
+
+    // The producer needs a buffer in flight while it draws the next one
+    // when its frames take more than half the consumer's period, or when it
+    // waited more than a period and a half for a buffer, i.e. it missed the
+    // consumer at least once.
+    if (mProducerWorkTime*2 > interval ||
+            mSlots[buf].mDequeueWait*2 > interval*3) {
+        mAdaptiveFrames = 0;
+        if (mAdaptiveBufferCount < mAdaptiveMaxBufferCount) {
+            mAdaptiveBufferCount++;
+            ST_LOGV("adaptive buffer count up to %d", mAdaptiveBufferCount);
+            broadcastDequeueConditionLocked();
+        }
+    } else if (mProducerWorkTime*4 < interval) {
+        int minBufferCount = getMinMaxBufferCountLocked();
+        if (minBufferCount < mAdaptiveMinBufferCount) {
+            minBufferCount = mAdaptiveMinBufferCount;
+        }
+        if (++mAdaptiveFrames >= ADAPTIVE_WINDOW &&
+                mAdaptiveBufferCount > minBufferCount) {
+            // the slot beyond the new count is freed by dequeueBuffer
+            mAdaptiveBufferCount--;
+            mAdaptiveFrames = 0;
+            ST_LOGV("adaptive buffer count down to %d", mAdaptiveBufferCount);
+        }
+    } else {
+        mAdaptiveFrames = 0;
+    }
+}
+
 status_t BufferQueue::setMaxAcquiredBufferCount(int maxAcquiredBuffers) {
     ATRACE_CALL();
     Mutex::Autolock lock(mMutex);
@@ -1097,6 +1439,108 @@ status_t BufferQueue::setMaxAcquiredBufferCount(int maxAcquiredBuffers) {
     return NO_ERROR;
 }
 
+status_t BufferQueue::setFrameDropPolicy(int mode, int maxQueuedBuffers,
+        nsecs_t maxFrameAge) {
+    ATRACE_CALL();
+    Mutex::Autolock lock(mMutex);
+    if (mode < DROP_NONE || mode > DROP_NEWEST || maxQueuedBuffers < 0 ||
+            maxQueuedBuffers > NUM_BUFFER_SLOTS || maxFrameAge < 0) {
+        ST_LOGE("setFrameDropPolicy: invalid policy: mode=%d, "
+                "maxQueuedBuffers=%d, maxFrameAge=%lld",
+                mode, maxQueuedBuffers, maxFrameAge);
+        return BAD_VALUE;
+    }
+    mDropMode = mode;
+    mMaxQueuedBuffers = maxQueuedBuffers;
+    mMaxFrameAge = maxFrameAge;
+    return NO_ERROR;
+}
+
+uint32_t BufferQueue::getFramesDropped() const {
+    Mutex::Autolock lock(mMutex);
+    return mFramesDropped;
+}
+
+void BufferQueue::setFramePresented(uint64_t frameNumber,
+        const sp<Fence>& presentFence, nsecs_t presentTime) {
+    Mutex::Autolock lock(mMutex);
+    FrameHistory* history = findFrameHistoryLocked(frameNumber);
+    if (history) {
+        // the fence is only resolved when someone asks for the timestamps
+        if (presentFence != NULL && presentFence->isValid()) {
+            history->presentFence = presentFence;
+        } else {
+            history->timestamps.presentTime = presentTime;
+        }
+    }
+}
+
+size_t BufferQueue::discardFreeBuffers() {
+    ATRACE_CALL();
+    sp<ConsumerListener> listener;
+    size_t size = 0;
+    { // scope for lock
+        Mutex::Autolock lock(mMutex);
+        if (mAbandoned) {
+            return 0;
+        }
+        for (int i = 0; i < NUM_BUFFER_SLOTS; i++) {
+            const sp<GraphicBuffer>& buffer(mSlots[i].mGraphicBuffer);
+            if (mSlots[i].mBufferState != BufferSlot::FREE || buffer == NULL) {
+                continue;
+            }
+            const ssize_t bpp = bytesPerPixel(buffer->getPixelFormat());
+            if (bpp > 0) {
+                size += size_t(buffer->getStride()) * buffer->getHeight() * bpp;
+            }
+            freeBufferLocked(i);
+            listener = mConsumerListener;
+        }
+        ST_LOGV("discardFreeBuffers: freed %u bytes", uint32_t(size));
+    }
+
+    if (listener != NULL) {
+        listener->onBuffersReleased();
+    }
+    return size;
+}
+
+status_t BufferQueue::getFrameTimestamps(uint64_t frameNumber,
+        FrameTimestamps* outTimestamps) {
+    ATRACE_CALL();
+    Mutex::Autolock lock(mMutex);
+    FrameHistory* history = findFrameHistoryLocked(frameNumber);
+    if (!history) {
+        return NAME_NOT_FOUND;
+    }
+    if (history->presentFence != NULL) {
+        const nsecs_t signalTime = history->presentFence->getSignalTime();
+        if (signalTime != INT64_MAX) {
+            // -1 if the fence is in an error state
+            history->timestamps.presentTime = signalTime > 0 ? signalTime : 0;
+            history->presentFence = NULL;
+        }
+    }
+    *outTimestamps = history->timestamps;
+    return NO_ERROR;
+}
+
+BufferQueue::FrameHistory* BufferQueue::findFrameHistoryLocked(
+        uint64_t frameNumber) {
+    FrameHistory& history(mFrameHistory[frameNumber % NUM_FRAME_HISTORY]);
+    if (frameNumber == 0 || history.timestamps.frameNumber != frameNumber) {
+        return NULL;
+    }
+    return &history;
+}
+
+void BufferQueue::dropBufferLocked(int buf) {
+    mSlots[buf].mBufferState = BufferSlot::FREE;
+    // reset the frame number of the freed buffer
+    mSlots[buf].mFrameNumber = 0;
+    mFramesDropped++;
+}
+
 void BufferQueue::freeAllBuffersExceptHeadLocked() {
     int head = -1;
     if (!mQueue.empty()) {
@@ -1111,9 +1555,21 @@ void BufferQueue::freeAllBuffersExceptHeadLocked() {
     }
 }
 
+void BufferQueue::waitDequeueConditionLocked() {
+    mDequeueWaiters++;
+    mDequeueCondition.wait(mMutex);
+    mDequeueWaiters--;
+}
+
+void BufferQueue::broadcastDequeueConditionLocked() {
+    if (mDequeueWaiters) {
+        mDequeueCondition.broadcast();
+    }
+}
+
 status_t BufferQueue::drainQueueLocked() {
     while (mSynchronousMode && mQueue.size() > 1) {
-        mDequeueCondition.wait(mMutex);
+        waitDequeueConditionLocked();
         if (mAbandoned) {
             ST_LOGE("drainQueueLocked: BufferQueue has been abandoned!");
             return NO_INIT;
@@ -1150,7 +1606,8 @@ int BufferQueue::getMinUndequeuedBufferCountLocked() const {
 int BufferQueue::getMaxBufferCountLocked() const {
     int minMaxBufferCount = getMinMaxBufferCountLocked();
 
-    int maxBufferCount = mDefaultMaxBufferCount;
+    int maxBufferCount = mAdaptiveBufferCount ? mAdaptiveBufferCount :
+            mDefaultMaxBufferCount;
     if (maxBufferCount < minMaxBufferCount) {
         maxBufferCount = minMaxBufferCount;
     }
@@ -1193,4 +1650,11 @@ void BufferQueue::ProxyConsumerListener::onBuffersReleased() {
     }
 }
 
+void BufferQueue::ProxyConsumerListener::onFrameDropped() {
+    sp<BufferQueue::ConsumerListener> listener(mConsumerListener.promote());
+    if (listener != NULL) {
+        listener->onFrameDropped();
+    }
+}
+
 }; // namespace android
@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "BufferQueueTee"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include <gui/BufferQueueTee.h>
+
+#define BT_LOGV(x, ...) ALOGV("[%s] "x, mName.string(), ##__VA_ARGS__)
+#define BT_LOGE(x, ...) ALOGE("[%s] "x, mName.string(), ##__VA_ARGS__)
+
+namespace android {
+
+BufferQueueTee::BufferQueueTee(uint32_t consumerUsage, int maxAcquiredBuffers,
+        bool synchronousMode) :
+    ConsumerBase(new BufferQueue(true) ),
+    mHeldBuffers(0),
+    mMaxAcquiredBuffers(maxAcquiredBuffers)
+{
+    mBufferQueue->setConsumerUsageBits(consumerUsage);
+    mBufferQueue->setSynchronousMode(synchronousMode);
+    mBufferQueue->setMaxAcquiredBufferCount(maxAcquiredBuffers);
+}
+
+BufferQueueTee::~BufferQueueTee() {
+}
+
+void BufferQueueTee::setName(const String8& name) {
+    Mutex::Autolock _l(mMutex);
+    mName = name;
+    mBufferQueue->setConsumerName(name);
+}
+
+sp<BufferQueueTee::Output> BufferQueueTee::addOutput(const String8& name,
+        int maxAcquiredBuffers, int maxPendingBuffers) {
+    sp<Output> output(new Output(this, name, maxAcquiredBuffers,
+            maxPendingBuffers));
+    Mutex::Autolock _l(mMutex);
+    mOutputs.add(output);
+    return output;
+}
+
+void BufferQueueTee::removeOutput(const sp<Output>& output) {
+    Vector< sp<FrameAvailableListener> > listeners;
+    {
+        Mutex::Autolock _l(mMutex);
+        for (size_t i = 0; i < mOutputs.size(); i++) {
+            if (mOutputs[i] == output) {
+                mOutputs.removeAt(i);
+                break;
+            }
+        }
+        if (output->mRemoved) {
+            return;
+        }
+        output->mRemoved = true;
+        for (size_t i = 0; i < output->mPending.size(); i++) {
+            unrefLocked(output->mPending[i], Fence::NO_FENCE);
+        }
+        output->mPending.clear();
+        for (size_t i = 0; i < output->mAcquired.size(); i++) {
+            unrefLocked(output->mAcquired[i], Fence::NO_FENCE);
+        }
+        output->mAcquired.clear();
+        dispatchLocked(&listeners);
+    }
+    notify(listeners);
+}
+
+void BufferQueueTee::onFrameAvailable() {
+    ATRACE_CALL();
+    Vector< sp<FrameAvailableListener> > listeners;
+    {
+        Mutex::Autolock _l(mMutex);
+        dispatchLocked(&listeners);
+    }
+    notify(listeners);
+}
+
+void BufferQueueTee::dispatchLocked(
+        Vector< sp<FrameAvailableListener> >* listeners) {
+    // The queue lets one more buffer than its max be acquired.
+    while (!mAbandoned && mHeldBuffers <= mMaxAcquiredBuffers) {
+        BufferItem item;
+        status_t err = acquireBufferLocked(&item, 0);
+        if (err != OK) {
+            if (err != NO_BUFFER_AVAILABLE) {
+                BT_LOGE("Error acquiring buffer: %s (%d)", strerror(-err), err);
+            }
+            return;
+        }
+        item.mGraphicBuffer = mSlots[item.mBuf].mGraphicBuffer;
+
+        if (mOutputs.isEmpty()) {
+            releaseBufferLocked(item.mBuf, EGL_NO_DISPLAY, EGL_NO_SYNC_KHR);
+            continue;
+        }
+
+        for (size_t i = 0; i < mHeld.size(); i++) {
+            Held& held(mHeld.editItemAt(i));
+            if (held.slot == item.mBuf && !held.stale) {
+                held.stale = true;
+                mHeldBuffers--;
+            }
+        }
+        Held held;
+        held.slot = item.mBuf;
+        held.frameNumber = item.mFrameNumber;
+        held.buffer = item.mGraphicBuffer;
+        held.refs = mOutputs.size();
+        held.stale = false;
+        mHeld.add(held);
+        mHeldBuffers++;
+        for (size_t i = 0; i < mOutputs.size(); i++) {
+            Output* output(mOutputs[i].get());
+            output->mPending.add(item);
+            if (output->mMaxPendingBuffers > 0 &&
+                    int(output->mPending.size()) > output->mMaxPendingBuffers) {
+                // this output is behind, it skips its oldest buffer
+                const BufferItem dropped(output->mPending[0]);
+                output->mPending.removeAt(0);
+                output->mDroppedBuffers++;
+                unrefLocked(dropped, Fence::NO_FENCE);
+            }
+            sp<FrameAvailableListener> listener(output->mListener.promote());
+            if (listener != NULL) {
+                listeners->add(listener);
+            }
+        }
+    }
+}
+
+void BufferQueueTee::unrefLocked(const BufferItem& item,
+        const sp<Fence>& releaseFence) {
+    ssize_t index = -1;
+    for (size_t i = 0; i < mHeld.size(); i++) {
+        const Held& held(mHeld[i]);
+        if (held.slot == item.mBuf && held.frameNumber == item.mFrameNumber &&
+                held.buffer == item.mGraphicBuffer) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        BT_LOGE("unrefLocked: slot %d frame %llu isn't held", item.mBuf,
+                item.mFrameNumber);
+        return;
+    }
+    Held& held(mHeld.editItemAt(index));
+    const int slot = held.slot;
+    // the slot's fence belongs to whatever it holds now once it's stale
+    const bool current = !held.stale &&
+            mSlots[slot].mGraphicBuffer == held.buffer;
+    if (current && releaseFence != NULL && releaseFence->isValid()) {
+        addReleaseFenceLocked(slot, releaseFence);
+    }
+    if (--held.refs > 0) {
+        return;
+    }
+    const bool stale = held.stale;
+    mHeld.removeAt(index);
+    if (stale) {
+        BT_LOGV("unrefLocked: slot %d was freed since frame %llu", slot,
+                item.mFrameNumber);
+        return;
+    }
+    BT_LOGV("unrefLocked: releasing slot %d", slot);
+    mHeldBuffers--;
+    if (!current) {
+        // freed by the BufferQueue, and not acquired again yet
+        return;
+    }
+    status_t err = releaseBufferLocked(slot, EGL_NO_DISPLAY, EGL_NO_SYNC_KHR);
+    if (err != OK && err != BufferQueue::STALE_BUFFER_SLOT) {
+        BT_LOGE("Failed to release buffer: %s (%d)", strerror(-err), err);
+    }
+}
+
+void BufferQueueTee::notify(const Vector< sp<FrameAvailableListener> >& listeners) {
+    for (size_t i = 0; i < listeners.size(); i++) {
+        listeners[i]->onFrameAvailable();
+    }
+}
+
+void BufferQueueTee::abandonLocked() {
+    for (size_t i = 0; i < mOutputs.size(); i++) {
+        Output* output(mOutputs[i].get());
+        output->mPending.clear();
+        output->mRemoved = true;
+    }
+    mOutputs.clear();
+    ConsumerBase::abandonLocked();
+}
+
+status_t BufferQueueTee::setDefaultBufferSize(uint32_t w, uint32_t h) {
+    Mutex::Autolock _l(mMutex);
+    return mBufferQueue->setDefaultBufferSize(w, h);
+}
+
+status_t BufferQueueTee::setDefaultBufferFormat(uint32_t defaultFormat) {
+    Mutex::Autolock _l(mMutex);
+    return mBufferQueue->setDefaultBufferFormat(defaultFormat);
+}
+
+void BufferQueueTee::dumpLocked(String8& result, const char* prefix,
+        char* buffer, size_t size) const {
+    result.appendFormat("%s%d buffers held (max %d)\n", prefix, mHeldBuffers,
+            mMaxAcquiredBuffers);
+    for (size_t i = 0; i < mOutputs.size(); i++) {
+        const Output* output(mOutputs[i].get());
+        result.appendFormat("%s  output '%s': %d pending, %d acquired, "
+                "%u dropped\n", prefix, output->mName.string(),
+                int(output->mPending.size()),
+                int(output->mAcquired.size()),
+                output->mDroppedBuffers);
+    }
+    ConsumerBase::dumpLocked(result, prefix, buffer, size);
+}
+
+// ---------------------------------------------------------------------------
+
+BufferQueueTee::Output::Output(const wp<BufferQueueTee>& tee,
+        const String8& name, int maxAcquiredBuffers, int maxPendingBuffers) :
+    mTee(tee),
+    mName(name),
+    mMaxAcquiredBuffers(maxAcquiredBuffers),
+    mMaxPendingBuffers(maxPendingBuffers),
+    mDroppedBuffers(0),
+    mRemoved(false)
+{
+}
+
+status_t BufferQueueTee::Output::acquireBuffer(BufferItem* item,
+        bool waitForFence) {
+    if (!item) return BAD_VALUE;
+
+    sp<BufferQueueTee> tee(mTee.promote());
+    if (tee == NULL) {
+        return NO_INIT;
+    }
+    {
+        Mutex::Autolock _l(tee->mMutex);
+        if (mRemoved) {
+            return NO_INIT;
+        }
+        if (mPending.isEmpty()) {
+            return NO_BUFFER_AVAILABLE;
+        }
+        if (int(mAcquired.size()) >= mMaxAcquiredBuffers) {
+            return INVALID_OPERATION;
+        }
+        *item = mPending[0];
+        mPending.removeAt(0);
+        mAcquired.add(*item);
+    }
+
+    if (waitForFence) {
+        status_t err = item->mFence->waitForever("BufferQueueTee::Output::acquireBuffer");
+        if (err != OK) {
+            ALOGE("[%s] Failed to wait for fence of acquired buffer: %s (%d)",
+                    mName.string(), strerror(-err), err);
+            return err;
+        }
+    }
+    return OK;
+}
+
+status_t BufferQueueTee::Output::releaseBuffer(const BufferItem& item,
+        const sp<Fence>& releaseFence) {
+    sp<BufferQueueTee> tee(mTee.promote());
+    if (tee == NULL) {
+        return NO_INIT;
+    }
+    Vector< sp<FrameAvailableListener> > listeners;
+    {
+        Mutex::Autolock _l(tee->mMutex);
+        if (mRemoved) {
+            return NO_INIT;
+        }
+        ssize_t index = -1;
+        for (size_t i = 0; i < mAcquired.size(); i++) {
+            const BufferItem& acquired(mAcquired[i]);
+            if (acquired.mBuf == item.mBuf &&
+                    acquired.mFrameNumber == item.mFrameNumber &&
+                    acquired.mGraphicBuffer == item.mGraphicBuffer) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            ALOGE("[%s] releaseBuffer: slot %d frame %llu isn't acquired",
+                    mName.string(), item.mBuf, item.mFrameNumber);
+            return BAD_VALUE;
+        }
+        const BufferItem acquired(mAcquired[index]);
+        mAcquired.removeAt(index);
+        tee->unrefLocked(acquired, releaseFence);
+        // the released slot may let more queued buffers in
+        tee->dispatchLocked(&listeners);
+    }
+    notify(listeners);
+    return OK;
+}
+
+void BufferQueueTee::Output::setFrameAvailableListener(
+        const wp<FrameAvailableListener>& listener) {
+    sp<BufferQueueTee> tee(mTee.promote());
+    if (tee == NULL) {
+        return;
+    }
+    Mutex::Autolock _l(tee->mMutex);
+    mListener = listener;
+}
+
+} // namespace android
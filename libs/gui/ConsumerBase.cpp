@@ -118,6 +118,20 @@ void ConsumerBase::onFrameAvailable() {
     }
 }
 
+void ConsumerBase::onFrameDropped() {
+    CB_LOGV("onFrameDropped");
+
+    sp<FrameAvailableListener> listener;
+    { // scope for the lock
+        Mutex::Autolock lock(mMutex);
+        listener = mFrameAvailableListener.promote();
+    }
+
+    if (listener != NULL) {
+        listener->onFrameDropped();
+    }
+}
+
 void ConsumerBase::onBuffersReleased() {
     Mutex::Autolock lock(mMutex);
 
@@ -164,6 +178,26 @@ void ConsumerBase::setFrameAvailableListener(
     mFrameAvailableListener = listener;
 }
 
+status_t ConsumerBase::setFrameDropPolicy(int mode, int maxQueuedBuffers,
+        nsecs_t maxFrameAge) {
+    CB_LOGV("setFrameDropPolicy");
+    Mutex::Autolock lock(mMutex);
+    if (mAbandoned) {
+        CB_LOGE("setFrameDropPolicy: ConsumerBase is abandoned!");
+        return NO_INIT;
+    }
+    return mBufferQueue->setFrameDropPolicy(mode, maxQueuedBuffers,
+            maxFrameAge);
+}
+
+uint32_t ConsumerBase::getFramesDropped() const {
+    Mutex::Autolock lock(mMutex);
+    if (mAbandoned) {
+        return 0;
+    }
+    return mBufferQueue->getFramesDropped();
+}
+
 void ConsumerBase::dump(String8& result) const {
     char buffer[1024];
     dump(result, "", buffer, 1024);
@@ -185,8 +219,9 @@ void ConsumerBase::dumpLocked(String8& result, const char* prefix,
     }
 }
 
-status_t ConsumerBase::acquireBufferLocked(BufferQueue::BufferItem *item) {
-    status_t err = mBufferQueue->acquireBuffer(item);
+status_t ConsumerBase::acquireBufferLocked(BufferQueue::BufferItem *item,
+        nsecs_t presentWhen) {
+    status_t err = mBufferQueue->acquireBuffer(item, presentWhen);
     if (err != NO_ERROR) {
         return err;
     }
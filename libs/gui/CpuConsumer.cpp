@@ -30,6 +30,19 @@
 
 namespace android {
 
+// returns whether gralloc may be able to describe the planes of a buffer of
+// this format with lockYCbCr()
+static bool isPlanarYuvFormat(PixelFormat format) {
+    switch (format) {
+        case HAL_PIXEL_FORMAT_YCbCr_420_888:
+        case HAL_PIXEL_FORMAT_YV12:
+        case HAL_PIXEL_FORMAT_YCrCb_420_SP:
+        case HAL_PIXEL_FORMAT_YCbCr_422_SP:
+            return true;
+    }
+    return false;
+}
+
 CpuConsumer::CpuConsumer(uint32_t maxLockedBuffers, bool synchronousMode) :
     ConsumerBase(new BufferQueue(true) ),
     mMaxLockedBuffers(maxLockedBuffers),
@@ -59,86 +72,68 @@ status_t CpuConsumer::lockNextBuffer(LockedBuffer *nativeBuffer) {
     status_t err;
 
     if (!nativeBuffer) return BAD_VALUE;
-    if (mCurrentLockedBuffers == mMaxLockedBuffers) {
-        return INVALID_OPERATION;
-    }
 
     BufferQueue::BufferItem b;
+    size_t lockedIdx = 0;
+    sp<GraphicBuffer> graphicBuffer;
 
-    Mutex::Autolock _l(mMutex);
+    {
+        Mutex::Autolock _l(mMutex);
 
-    err = acquireBufferLocked(&b);
-    if (err != OK) {
-        if (err == BufferQueue::NO_BUFFER_AVAILABLE) {
-            return BAD_VALUE;
-        } else {
-            CC_LOGE("Error acquiring buffer: %s (%d)", strerror(err), err);
-            return err;
+        if (mCurrentLockedBuffers == mMaxLockedBuffers) {
+            return INVALID_OPERATION;
         }
-    }
-
-    int buf = b.mBuf;
 
-    if (b.mFence.get()) {
-        err = b.mFence->waitForever("CpuConsumer::lockNextBuffer");
+        err = acquireBufferLocked(&b, 0);
         if (err != OK) {
-            CC_LOGE("Failed to wait for fence of acquired buffer: %s (%d)",
-                    strerror(-err), err);
-            return err;
+            if (err == BufferQueue::NO_BUFFER_AVAILABLE) {
+                return BAD_VALUE;
+            } else {
+                CC_LOGE("Error acquiring buffer: %s (%d)", strerror(err), err);
+                return err;
+            }
+        }
+
+        for (; lockedIdx < mMaxLockedBuffers; lockedIdx++) {
+            if (mAcquiredBuffers[lockedIdx].mSlot ==
+                    BufferQueue::INVALID_BUFFER_SLOT) {
+                break;
+            }
         }
+        assert(lockedIdx < mMaxLockedBuffers);
+
+        // The entry is reserved while the buffer is waited for and mapped
+        // without mMutex, so that other threads can lock and unlock their
+        // buffers in the meantime.
+        AcquiredBuffer &ab = mAcquiredBuffers.editItemAt(lockedIdx);
+        ab.mSlot = b.mBuf;
+        ab.mBufferPointer = NULL;
+        ab.mGraphicBuffer = mSlots[b.mBuf].mGraphicBuffer;
+        graphicBuffer = ab.mGraphicBuffer;
+        mCurrentLockedBuffers++;
     }
 
     void *bufferPointer = NULL;
     android_ycbcr ycbcr = android_ycbcr();
+    err = lockForCpu(graphicBuffer, b, &bufferPointer, &ycbcr);
 
-    if (mSlots[buf].mGraphicBuffer->getPixelFormat() ==
-            HAL_PIXEL_FORMAT_YCbCr_420_888) {
-        err = mSlots[buf].mGraphicBuffer->lockYCbCr(
-            GraphicBuffer::USAGE_SW_READ_OFTEN,
-            b.mCrop,
-            &ycbcr);
-
-        if (err != OK) {
-            CC_LOGE("Unable to lock YCbCr buffer for CPU reading: %s (%d)",
-                    strerror(-err), err);
-            return err;
-        }
-        bufferPointer = ycbcr.y;
-    } else {
-        err = mSlots[buf].mGraphicBuffer->lock(
-            GraphicBuffer::USAGE_SW_READ_OFTEN,
-            b.mCrop,
-            &bufferPointer);
-
+    {
+        Mutex::Autolock _l(mMutex);
         if (err != OK) {
-            CC_LOGE("Unable to lock buffer for CPU reading: %s (%d)",
-                    strerror(-err), err);
+            releaseAcquiredBufferLocked(lockedIdx);
             return err;
         }
+        mAcquiredBuffers.editItemAt(lockedIdx).mBufferPointer = bufferPointer;
     }
 
-    size_t lockedIdx = 0;
-    for (; lockedIdx < mMaxLockedBuffers; lockedIdx++) {
-        if (mAcquiredBuffers[lockedIdx].mSlot ==
-                BufferQueue::INVALID_BUFFER_SLOT) {
-            break;
-        }
-    }
-    assert(lockedIdx < mMaxLockedBuffers);
-
-    AcquiredBuffer &ab = mAcquiredBuffers.editItemAt(lockedIdx);
-    ab.mSlot = buf;
-    ab.mBufferPointer = bufferPointer;
-    ab.mGraphicBuffer = mSlots[buf].mGraphicBuffer;
-
     nativeBuffer->data   =
             reinterpret_cast<uint8_t*>(bufferPointer);
-    nativeBuffer->width  = mSlots[buf].mGraphicBuffer->getWidth();
-    nativeBuffer->height = mSlots[buf].mGraphicBuffer->getHeight();
-    nativeBuffer->format = mSlots[buf].mGraphicBuffer->getPixelFormat();
+    nativeBuffer->width  = graphicBuffer->getWidth();
+    nativeBuffer->height = graphicBuffer->getHeight();
+    nativeBuffer->format = graphicBuffer->getPixelFormat();
     nativeBuffer->stride = (ycbcr.y != NULL) ?
             ycbcr.ystride :
-            mSlots[buf].mGraphicBuffer->getStride();
+            graphicBuffer->getStride();
 
     nativeBuffer->crop        = b.mCrop;
     nativeBuffer->transform   = b.mTransform;
@@ -151,37 +146,134 @@ status_t CpuConsumer::lockNextBuffer(LockedBuffer *nativeBuffer) {
     nativeBuffer->chromaStride = ycbcr.cstride;
     nativeBuffer->chromaStep   = ycbcr.chroma_step;
 
-    mCurrentLockedBuffers++;
+    return OK;
+}
+
+status_t CpuConsumer::lockNextBuffers(LockedBuffer *nativeBuffers,
+        size_t *count) {
+    if (!nativeBuffers || !count) return BAD_VALUE;
+
+    size_t locked = 0;
+    status_t err = OK;
+    while (locked < *count) {
+        err = lockNextBuffer(&nativeBuffers[locked]);
+        if (err != OK) {
+            break;
+        }
+        locked++;
+    }
+    *count = locked;
+
+    // running out of queued buffers or of lockable buffers ends the batch,
+    // an error only matters if nothing could be locked
+    return locked ? OK : err;
+}
+
+status_t CpuConsumer::lockForCpu(const sp<GraphicBuffer>& graphicBuffer,
+        const BufferQueue::BufferItem& b, void **bufferPointer,
+        android_ycbcr *ycbcr) {
+    status_t err;
+
+    if (b.mFence.get()) {
+        err = b.mFence->waitForever("CpuConsumer::lockNextBuffer");
+        if (err != OK) {
+            CC_LOGE("Failed to wait for fence of acquired buffer: %s (%d)",
+                    strerror(-err), err);
+            return err;
+        }
+    }
+
+    const PixelFormat format = graphicBuffer->getPixelFormat();
+
+    if (isPlanarYuvFormat(format)) {
+        err = graphicBuffer->lockYCbCr(
+            GraphicBuffer::USAGE_SW_READ_OFTEN,
+            b.mCrop,
+            ycbcr);
+
+        if (err == OK) {
+            *bufferPointer = ycbcr->y;
+            return OK;
+        } else if (format == HAL_PIXEL_FORMAT_YCbCr_420_888) {
+            // there is no way to tell where the planes are
+            CC_LOGE("Unable to lock YCbCr buffer for CPU reading: %s (%d)",
+                    strerror(-err), err);
+            return err;
+        }
+        // the layout is still known for YV12, see below
+        *ycbcr = android_ycbcr();
+    }
+
+    err = graphicBuffer->lock(
+        GraphicBuffer::USAGE_SW_READ_OFTEN,
+        b.mCrop,
+        bufferPointer);
 
+    if (err != OK) {
+        CC_LOGE("Unable to lock buffer for CPU reading: %s (%d)",
+                strerror(-err), err);
+        return err;
+    }
+
+    if (format == HAL_PIXEL_FORMAT_YV12) {
+        // YV12 is laid out as described in system/graphics.h: a Y plane
+        // followed by the Cr and Cb planes, each half the height, with
+        // 16-byte aligned strides.
+        const size_t ystride = graphicBuffer->getStride();
+        const size_t cstride = (ystride / 2 + 15) & ~15;
+        const size_t height = graphicBuffer->getHeight();
+        uint8_t* const y = reinterpret_cast<uint8_t*>(*bufferPointer);
+        ycbcr->y = y;
+        ycbcr->cr = y + ystride * height;
+        ycbcr->cb = y + ystride * height + cstride * (height / 2);
+        ycbcr->ystride = ystride;
+        ycbcr->cstride = cstride;
+        ycbcr->chroma_step = 1;
+    }
     return OK;
 }
 
 status_t CpuConsumer::unlockBuffer(const LockedBuffer &nativeBuffer) {
-    Mutex::Autolock _l(mMutex);
     size_t lockedIdx = 0;
-    status_t err;
+    sp<GraphicBuffer> graphicBuffer;
 
     void *bufPtr = reinterpret_cast<void *>(nativeBuffer.data);
-    for (; lockedIdx < mMaxLockedBuffers; lockedIdx++) {
-        if (bufPtr == mAcquiredBuffers[lockedIdx].mBufferPointer) break;
-    }
-    if (lockedIdx == mMaxLockedBuffers) {
-        CC_LOGE("%s: Can't find buffer to free", __FUNCTION__);
+    if (bufPtr == NULL) {
         return BAD_VALUE;
     }
 
-    return releaseAcquiredBufferLocked(lockedIdx);
-}
+    {
+        Mutex::Autolock _l(mMutex);
+        for (; lockedIdx < mMaxLockedBuffers; lockedIdx++) {
+            if (bufPtr == mAcquiredBuffers[lockedIdx].mBufferPointer) break;
+        }
+        if (lockedIdx == mMaxLockedBuffers) {
+            CC_LOGE("%s: Can't find buffer to free", __FUNCTION__);
+            return BAD_VALUE;
+        }
 
-status_t CpuConsumer::releaseAcquiredBufferLocked(int lockedIdx) {
-    status_t err;
+        // the entry stays reserved until the buffer is released below
+        AcquiredBuffer &ab = mAcquiredBuffers.editItemAt(lockedIdx);
+        ab.mBufferPointer = NULL;
+        graphicBuffer = ab.mGraphicBuffer;
+    }
+
+    // buffers can be unmapped by several threads at once, in any order
+    status_t err = graphicBuffer->unlock();
 
-    err = mAcquiredBuffers[lockedIdx].mGraphicBuffer->unlock();
+    Mutex::Autolock _l(mMutex);
     if (err != OK) {
         CC_LOGE("%s: Unable to unlock graphic buffer %d", __FUNCTION__,
                 lockedIdx);
+        // still locked, the caller can try again
+        mAcquiredBuffers.editItemAt(lockedIdx).mBufferPointer = bufPtr;
         return err;
     }
+
+    return releaseAcquiredBufferLocked(lockedIdx);
+}
+
+status_t CpuConsumer::releaseAcquiredBufferLocked(int lockedIdx) {
     int buf = mAcquiredBuffers[lockedIdx].mSlot;
 
     // release the buffer if it hasn't already been freed by the BufferQueue.
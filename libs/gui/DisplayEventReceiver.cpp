@@ -22,6 +22,7 @@
 #include <gui/DisplayEventReceiver.h>
 #include <gui/IDisplayEventConnection.h>
 #include <gui/ISurfaceComposer.h>
+#include <gui/SharedVSync.h>
 
 #include <private/gui/ComposerService.h>
 
@@ -31,7 +32,8 @@ namespace android {
 
 // ---------------------------------------------------------------------------
 
-DisplayEventReceiver::DisplayEventReceiver() {
+DisplayEventReceiver::DisplayEventReceiver()
+    : mVsyncDelivered(0) {
     sp<ISurfaceComposer> sf(ComposerService::getComposerService());
     if (sf != NULL) {
         mEventConnection = sf->createDisplayEventConnection();
@@ -76,6 +78,31 @@ status_t DisplayEventReceiver::requestNextVsync() {
     return NO_INIT;
 }
 
+status_t DisplayEventReceiver::setVsyncSchedule(nsecs_t period, nsecs_t phase) {
+    if (period < 0 || (period && (phase < 0 || phase >= period)))
+        return BAD_VALUE;
+
+    if (mEventConnection != NULL) {
+        return mEventConnection->setVsyncSchedule(period, phase);
+    }
+    return NO_INIT;
+}
+
+status_t DisplayEventReceiver::waitForVsync(Event* event, nsecs_t timeout) {
+    if (mSharedVSync == NULL) {
+        if (mEventConnection == NULL)
+            return NO_INIT;
+        mSharedVSync = mEventConnection->getSharedVSync();
+        if (mSharedVSync == NULL)
+            return NO_INIT;
+        // only wait for the vsyncs to come
+        Event last;
+        mSharedVSync->read(&last, &mVsyncDelivered);
+    }
+
+    return mSharedVSync->wait(event, &mVsyncDelivered, timeout);
+}
+
 
 ssize_t DisplayEventReceiver::getEvents(DisplayEventReceiver::Event* events,
         size_t count) {
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "EGLImageCache"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#define EGL_EGLEXT_PROTOTYPES
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <ui/GraphicBuffer.h>
+
+#include <utils/Log.h>
+#include <utils/Singleton.h>
+#include <utils/String8.h>
+#include <utils/Trace.h>
+
+#include <private/gui/EGLImageCache.h>
+
+namespace android {
+
+ANDROID_SINGLETON_STATIC_INSTANCE(EGLImageCache);
+
+EGLImageCache::EGLImageCache() : Singleton<EGLImageCache>(),
+        mDeferredTrim(false),
+        mIdleCount(0),
+        mUseCounter(0),
+        mHits(0),
+        mMisses(0),
+        mEvictions(0) {
+}
+
+EGLImageKHR EGLImageCache::acquire(EGLDisplay dpy,
+        const sp<GraphicBuffer>& buffer) {
+    Mutex::Autolock _l(mLock);
+
+    for (size_t i=0 ; i<mEntries.size() ; i++) {
+        Entry& e(mEntries.editItemAt(i));
+        if (e.dpy != dpy || e.key != buffer.get()) {
+            continue;
+        }
+        if (e.buffer.promote() != buffer) {
+            // the old buffer is gone, this one only has the same address
+            if (e.refs == 0) {
+                destroyLocked(i);
+            }
+            break;
+        }
+        if (e.refs++ == 0) {
+            mIdleCount--;
+        }
+        e.lastUse = ++mUseCounter;
+        mHits++;
+        return e.image;
+    }
+
+    ATRACE_NAME("eglCreateImageKHR");
+    mMisses++;
+    EGLClientBuffer cbuf = (EGLClientBuffer)buffer->getNativeBuffer();
+    EGLint attrs[] = {
+        EGL_IMAGE_PRESERVED_KHR,    EGL_TRUE,
+        EGL_NONE,
+    };
+    EGLImageKHR image = eglCreateImageKHR(dpy, EGL_NO_CONTEXT,
+            EGL_NATIVE_BUFFER_ANDROID, cbuf, attrs);
+    if (image == EGL_NO_IMAGE_KHR) {
+        EGLint error = eglGetError();
+        ALOGE("error creating EGLImage: %#x", error);
+        return image;
+    }
+
+    Entry e;
+    e.dpy = dpy;
+    e.key = buffer.get();
+    e.buffer = buffer;
+    e.image = image;
+    e.refs = 1;
+    e.lastUse = ++mUseCounter;
+    e.evicted = false;
+    mEntries.add(e);
+    return image;
+}
+
+void EGLImageCache::release(EGLDisplay dpy, EGLImageKHR image) {
+    Mutex::Autolock _l(mLock);
+
+    for (size_t i=0 ; i<mEntries.size() ; i++) {
+        Entry& e(mEntries.editItemAt(i));
+        if (e.dpy == dpy && e.image == image) {
+            ALOGE_IF(e.refs == 0, "releasing idle EGLImage %p", image);
+            if (e.refs && --e.refs == 0) {
+                mIdleCount++;
+                if (e.evicted) {
+                    destroyLocked(i);
+                } else if (!mDeferredTrim) {
+                    trimLocked();
+                }
+            }
+            return;
+        }
+    }
+
+    // not one of ours, don't leak it
+    ALOGW("releasing unknown EGLImage %p", image);
+    eglDestroyImageKHR(dpy, image);
+}
+
+void EGLImageCache::evict(const sp<GraphicBuffer>& buffer) {
+    Mutex::Autolock _l(mLock);
+
+    for (size_t i=0 ; i<mEntries.size() ; ) {
+        Entry& e(mEntries.editItemAt(i));
+        if (e.key != buffer.get()) {
+            i++;
+        } else if (e.refs) {
+            // another GLConsumer still uses it
+            e.evicted = true;
+            i++;
+        } else {
+            destroyLocked(i);
+            mEvictions++;
+        }
+    }
+}
+
+bool EGLImageCache::contains(const sp<GraphicBuffer>& buffer) const {
+    Mutex::Autolock _l(mLock);
+
+    for (size_t i=0 ; i<mEntries.size() ; i++) {
+        if (mEntries[i].key == buffer.get()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EGLImageCache::setDeferredTrim(bool deferred) {
+    Mutex::Autolock _l(mLock);
+    mDeferredTrim = deferred;
+    if (!deferred) {
+        trimLocked();
+    }
+}
+
+void EGLImageCache::trim() {
+    Mutex::Autolock _l(mLock);
+    if (mIdleCount > MAX_IDLE_IMAGES) {
+        ATRACE_NAME("EGLImageCache::trim");
+        trimLocked();
+    }
+}
+
+void EGLImageCache::destroyLocked(size_t index) {
+    const Entry& e(mEntries[index]);
+    if (!eglDestroyImageKHR(e.dpy, e.image)) {
+        ALOGW("eglDestroyImageKHR failed for image %p", e.image);
+    }
+    if (e.refs == 0) {
+        mIdleCount--;
+    }
+    mEntries.removeAt(index);
+}
+
+void EGLImageCache::trimLocked() {
+    while (mIdleCount > MAX_IDLE_IMAGES) {
+        // evict the least recently used idle image
+        size_t oldest = 0;
+        uint32_t oldestAge = 0;
+        for (size_t i=0 ; i<mEntries.size() ; i++) {
+            const Entry& e(mEntries[i]);
+            const uint32_t age = mUseCounter - e.lastUse;
+            if (e.refs == 0 && age >= oldestAge) {
+                oldest = i;
+                oldestAge = age;
+            }
+        }
+        destroyLocked(oldest);
+        mEvictions++;
+    }
+}
+
+void EGLImageCache::dump(String8& result) const {
+    Mutex::Autolock _l(mLock);
+    const uint32_t lookups = mHits + mMisses;
+    result.appendFormat("EGLImage cache: %u images (%u idle, max %u), "
+            "hits=%u, misses=%u (%u%% hit rate), evictions=%u\n",
+            uint32_t(mEntries.size()), uint32_t(mIdleCount),
+            uint32_t(MAX_IDLE_IMAGES),
+            mHits, mMisses, lookups ? (mHits * 100) / lookups : 0,
+            mEvictions);
+}
+
+// ----------------------------------------------------------------------------
+}; // namespace android
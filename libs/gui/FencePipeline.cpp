@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "FencePipeline"
+
+#define GL_GLEXT_PROTOTYPES
+#define EGL_EGLEXT_PROTOTYPES
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES2/gl2.h>
+
+#include <gui/FencePipeline.h>
+
+#include <private/gui/SyncFeatures.h>
+
+#include <utils/Log.h>
+
+namespace android {
+
+FencePipeline::FencePipeline(const String8& name) :
+    mName(name),
+    mHead(0),
+    mCount(0),
+    mLastSerial(0),
+    mRetiredSerial(0) {
+}
+
+FencePipeline::~FencePipeline() {
+}
+
+status_t FencePipeline::insertFence(EGLDisplay dpy, sp<Fence>* outFence) {
+    sp<Fence> fence;
+    status_t err = createNativeFence(dpy, &fence);
+    if (err != NO_ERROR) {
+        ALOGE("[%s] insertFence: %s (%d)", mName.string(), strerror(-err), err);
+        return err;
+    }
+
+    retire();
+    mLastSerial++;
+    if (mCount < MAX_IN_FLIGHT) {
+        mCount++;
+    }
+    Stage& stage = mStages[(mHead + mCount - 1) % MAX_IN_FLIGHT];
+    stage.serial = mLastSerial;
+    stage.fence = fence;
+
+    if (outFence) {
+        *outFence = fence;
+    }
+    return NO_ERROR;
+}
+
+bool FencePipeline::isRetired(uint32_t serial) {
+    if (int32_t(serial - mRetiredSerial) > 0) {
+        retire();
+    }
+    return int32_t(serial - mRetiredSerial) <= 0;
+}
+
+size_t FencePipeline::getInFlightCount() {
+    retire();
+    return mCount;
+}
+
+void FencePipeline::retire() {
+    while (mCount > 0) {
+        Stage& stage = mStages[mHead];
+        if (!hasSignalled(stage.fence)) {
+            break;
+        }
+        mRetiredSerial = stage.serial;
+        stage.fence.clear();
+        mHead = (mHead + 1) % MAX_IN_FLIGHT;
+        mCount--;
+    }
+}
+
+status_t FencePipeline::createNativeFence(EGLDisplay dpy, sp<Fence>* outFence) {
+    if (!SyncFeatures::getInstance().useNativeFenceSync()) {
+        return INVALID_OPERATION;
+    }
+    EGLSyncKHR sync = eglCreateSyncKHR(dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, NULL);
+    if (sync == EGL_NO_SYNC_KHR) {
+        ALOGE("createNativeFence: error creating EGL fence: %#x", eglGetError());
+        return UNKNOWN_ERROR;
+    }
+    glFlush();
+    int fenceFd = eglDupNativeFenceFDANDROID(dpy, sync);
+    eglDestroySyncKHR(dpy, sync);
+    if (fenceFd == EGL_NO_NATIVE_FENCE_FD_ANDROID) {
+        ALOGE("createNativeFence: error dup'ing native fence fd: %#x",
+                eglGetError());
+        return UNKNOWN_ERROR;
+    }
+    *outFence = new Fence(fenceFd);
+    return NO_ERROR;
+}
+
+status_t FencePipeline::waitOnGpu(EGLDisplay dpy, const sp<Fence>& fence,
+        const char* logname) {
+    if (!fence->isValid() || hasSignalled(fence)) {
+        return NO_ERROR;
+    }
+
+    if (!SyncFeatures::getInstance().useWaitSync()) {
+        status_t err = fence->waitForever(logname);
+        if (err != NO_ERROR) {
+            ALOGE("%s: error waiting for fence: %d", logname, err);
+        }
+        return err;
+    }
+
+    // Create an EGLSyncKHR from the fence.
+    int fenceFd = fence->dup();
+    if (fenceFd == -1) {
+        ALOGE("%s: error dup'ing fence fd: %d", logname, errno);
+        return -errno;
+    }
+    EGLint attribs[] = {
+        EGL_SYNC_NATIVE_FENCE_FD_ANDROID, fenceFd,
+        EGL_NONE
+    };
+    EGLSyncKHR sync = eglCreateSyncKHR(dpy,
+            EGL_SYNC_NATIVE_FENCE_ANDROID, attribs);
+    if (sync == EGL_NO_SYNC_KHR) {
+        close(fenceFd);
+        ALOGE("%s: error creating EGL fence: %#x", logname, eglGetError());
+        return UNKNOWN_ERROR;
+    }
+
+    // XXX: The spec draft is inconsistent as to whether this should
+    // return an EGLint or void.  Ignore the return value for now, as
+    // it's not strictly needed.
+    eglWaitSyncKHR(dpy, sync, 0);
+    EGLint eglErr = eglGetError();
+    eglDestroySyncKHR(dpy, sync);
+    if (eglErr != EGL_SUCCESS) {
+        ALOGE("%s: error waiting for EGL fence: %#x", logname, eglErr);
+        return UNKNOWN_ERROR;
+    }
+    return NO_ERROR;
+}
+
+bool FencePipeline::hasSignalled(const sp<Fence>& fence) {
+    if (fence == NULL) {
+        return true;
+    }
+    // A zero timeout makes sync_wait() a poll(). A fence in an error state
+    // will never signal, so it doesn't hold anything back either.
+    return fence->wait(0) != -ETIME;
+}
+
+}; // namespace android
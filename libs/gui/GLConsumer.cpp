@@ -28,12 +28,14 @@
 
 #include <hardware/hardware.h>
 
+#include <gui/FencePipeline.h>
 #include <gui/GLConsumer.h>
 #include <gui/IGraphicBufferAlloc.h>
 #include <gui/ISurfaceComposer.h>
 #include <gui/SurfaceComposerClient.h>
 
 #include <private/gui/ComposerService.h>
+#include <private/gui/EGLImageCache.h>
 #include <private/gui/SyncFeatures.h>
 
 #include <utils/Log.h>
@@ -85,9 +87,11 @@ GLConsumer::GLConsumer(GLuint tex, bool allowSynchronousMode,
     mCurrentScalingMode(NATIVE_WINDOW_SCALING_MODE_FREEZE),
     mCurrentFence(Fence::NO_FENCE),
     mCurrentTimestamp(0),
+    mCurrentFrameNumber(0),
     mDefaultWidth(1),
     mDefaultHeight(1),
     mFilteringEnabled(true),
+    mGeometryChanged(true),
     mTexName(tex),
     mUseFenceSync(useFenceSync),
     mTexTarget(texTarget),
@@ -100,6 +104,8 @@ GLConsumer::GLConsumer(GLuint tex, bool allowSynchronousMode,
 
     memcpy(mCurrentTransformMatrix, mtxIdentity,
             sizeof(mCurrentTransformMatrix));
+    mMatrixCacheValid[0] = false;
+    mMatrixCacheValid[1] = false;
 
     mBufferQueue->setConsumerUsageBits(DEFAULT_USAGE_FLAGS);
 }
@@ -139,7 +145,7 @@ status_t GLConsumer::updateTexImage() {
     // Acquire the next buffer.
     // In asynchronous mode the list is guaranteed to be one buffer
     // deep, while in synchronous mode we use the oldest buffer.
-    err = acquireBufferLocked(&item);
+    err = acquireBufferLocked(&item, 0);
     if (err != NO_ERROR) {
         if (err == BufferQueue::NO_BUFFER_AVAILABLE) {
             // We always bind the texture even if we don't update its contents.
@@ -165,8 +171,9 @@ status_t GLConsumer::updateTexImage() {
     return bindTextureImageLocked();
 }
 
-status_t GLConsumer::acquireBufferLocked(BufferQueue::BufferItem *item) {
-    status_t err = ConsumerBase::acquireBufferLocked(item);
+status_t GLConsumer::acquireBufferLocked(BufferQueue::BufferItem *item,
+        nsecs_t presentWhen) {
+    status_t err = ConsumerBase::acquireBufferLocked(item, presentWhen);
     if (err != NO_ERROR) {
         return err;
     }
@@ -176,11 +183,8 @@ status_t GLConsumer::acquireBufferLocked(BufferQueue::BufferItem *item) {
         // This buffer has not been acquired before, so we must assume
         // that any EGLImage in mEglSlots is stale.
         if (mEglSlots[slot].mEglImage != EGL_NO_IMAGE_KHR) {
-            if (!eglDestroyImageKHR(mEglDisplay, mEglSlots[slot].mEglImage)) {
-                ST_LOGW("acquireBufferLocked: eglDestroyImageKHR failed for slot=%d",
-                      slot);
-                // keep going
-            }
+            EGLImageCache::getInstance().release(mEglDisplay,
+                    mEglSlots[slot].mEglImage);
             mEglSlots[slot].mEglImage = EGL_NO_IMAGE_KHR;
         }
     }
@@ -258,13 +262,30 @@ status_t GLConsumer::releaseAndUpdateLocked(const BufferQueue::BufferItem& item)
         }
     }
 
+    // Most frames have the same geometry as the previous one, and so the
+    // same transform matrix
+    const sp<GraphicBuffer>& nextBuf(mSlots[buf].mGraphicBuffer);
+    const sp<GraphicBuffer>& prevBuf(mCurrentTextureBuf);
+    mGeometryChanged = prevBuf == NULL ||
+            item.mCrop != mCurrentCrop ||
+            item.mTransform != mCurrentTransform ||
+            item.mScalingMode != mCurrentScalingMode ||
+            nextBuf->getWidth() != prevBuf->getWidth() ||
+            nextBuf->getHeight() != prevBuf->getHeight() ||
+            nextBuf->getPixelFormat() != prevBuf->getPixelFormat();
+    if (mGeometryChanged) {
+        mMatrixCacheValid[0] = false;
+        mMatrixCacheValid[1] = false;
+    }
+
     // Update the GLConsumer state.
     mCurrentTexture = buf;
-    mCurrentTextureBuf = mSlots[buf].mGraphicBuffer;
+    mCurrentTextureBuf = nextBuf;
     mCurrentCrop = item.mCrop;
     mCurrentTransform = item.mTransform;
     mCurrentScalingMode = item.mScalingMode;
     mCurrentTimestamp = item.mTimestamp;
+    mCurrentFrameNumber = item.mFrameNumber;
     mCurrentFence = item.mFence;
 
     computeCurrentTransformMatrixLocked();
@@ -272,6 +293,26 @@ status_t GLConsumer::releaseAndUpdateLocked(const BufferQueue::BufferItem& item)
     return err;
 }
 
+status_t GLConsumer::createImageLocked(int slot) {
+    if (mEglDisplay == EGL_NO_DISPLAY) {
+        return NO_INIT;
+    }
+    if (mEglSlots[slot].mEglImage != EGL_NO_IMAGE_KHR) {
+        return NO_ERROR;
+    }
+    if (mSlots[slot].mGraphicBuffer == NULL) {
+        return BAD_VALUE;
+    }
+    EGLImageKHR image = createImage(mEglDisplay, mSlots[slot].mGraphicBuffer);
+    if (image == EGL_NO_IMAGE_KHR) {
+        ST_LOGW("createImageLocked: unable to createImage on display=%p slot=%d",
+              mEglDisplay, slot);
+        return UNKNOWN_ERROR;
+    }
+    mEglSlots[slot].mEglImage = image;
+    return NO_ERROR;
+}
+
 status_t GLConsumer::bindTextureImageLocked() {
     if (mEglDisplay == EGL_NO_DISPLAY) {
         ALOGE("bindTextureImage: invalid display");
@@ -383,11 +424,11 @@ status_t GLConsumer::detachFromContext() {
     // Because we're giving up the EGLDisplay we need to free all the EGLImages
     // that are associated with it.  They'll be recreated when the
     // GLConsumer gets attached to a new OpenGL ES context (and thus gets a
-    // new EGLDisplay).
+    // new EGLDisplay), or found in the EGLImageCache if it's the same one.
     for (int i =0; i < BufferQueue::NUM_BUFFER_SLOTS; i++) {
         EGLImageKHR img = mEglSlots[i].mEglImage;
         if (img != EGL_NO_IMAGE_KHR) {
-            eglDestroyImageKHR(mEglDisplay, img);
+            EGLImageCache::getInstance().release(mEglDisplay, img);
             mEglSlots[i].mEglImage = EGL_NO_IMAGE_KHR;
         }
     }
@@ -476,7 +517,7 @@ status_t GLConsumer::bindUnslottedBufferLocked(EGLDisplay dpy) {
     // nowhere to to store it.  If the buffer is still associated with a
     // slot then another EGLImageKHR will be created next time that buffer
     // gets acquired in updateTexImage.
-    eglDestroyImageKHR(dpy, image);
+    EGLImageCache::getInstance().release(dpy, image);
 
     return err;
 }
@@ -487,23 +528,14 @@ status_t GLConsumer::syncForReleaseLocked(EGLDisplay dpy) {
 
     if (mCurrentTexture != BufferQueue::INVALID_BUFFER_SLOT) {
         if (SyncFeatures::getInstance().useNativeFenceSync()) {
-            EGLSyncKHR sync = eglCreateSyncKHR(dpy,
-                    EGL_SYNC_NATIVE_FENCE_ANDROID, NULL);
-            if (sync == EGL_NO_SYNC_KHR) {
-                ST_LOGE("syncForReleaseLocked: error creating EGL fence: %#x",
-                        eglGetError());
-                return UNKNOWN_ERROR;
-            }
-            glFlush();
-            int fenceFd = eglDupNativeFenceFDANDROID(dpy, sync);
-            eglDestroySyncKHR(dpy, sync);
-            if (fenceFd == EGL_NO_NATIVE_FENCE_FD_ANDROID) {
-                ST_LOGE("syncForReleaseLocked: error dup'ing native fence "
-                        "fd: %#x", eglGetError());
-                return UNKNOWN_ERROR;
+            sp<Fence> fence;
+            status_t err = FencePipeline::createNativeFence(dpy, &fence);
+            if (err != OK) {
+                ST_LOGE("syncForReleaseLocked: error creating release fence: "
+                        "%s (%d)", strerror(-err), err);
+                return err;
             }
-            sp<Fence> fence(new Fence(fenceFd));
-            status_t err = addReleaseFenceLocked(mCurrentTexture, fence);
+            err = addReleaseFenceLocked(mCurrentTexture, fence);
             if (err != OK) {
                 ST_LOGE("syncForReleaseLocked: error adding release fence: "
                         "%s (%d)", strerror(-err), err);
@@ -594,6 +626,13 @@ void GLConsumer::setFilteringEnabled(bool enabled) {
 void GLConsumer::computeCurrentTransformMatrixLocked() {
     ST_LOGV("computeCurrentTransformMatrixLocked");
 
+    const int filtering = mFilteringEnabled ? 1 : 0;
+    if (mMatrixCacheValid[filtering]) {
+        memcpy(mCurrentTransformMatrix, mMatrixCache[filtering],
+                sizeof(mCurrentTransformMatrix));
+        return;
+    }
+
     float xform[16];
     for (int i = 0; i < 16; i++) {
         xform[i] = mtxIdentity[i];
@@ -688,6 +727,10 @@ void GLConsumer::computeCurrentTransformMatrixLocked() {
     // want to expose this to applications, however, so we must add an
     // additional vertical flip to the transform after all the other transforms.
     mtxMul(mCurrentTransformMatrix, mtxFlipV, mtxBeforeFlipV);
+
+    memcpy(mMatrixCache[filtering], mCurrentTransformMatrix,
+            sizeof(mCurrentTransformMatrix));
+    mMatrixCacheValid[filtering] = true;
 }
 
 nsecs_t GLConsumer::getTimestamp() {
@@ -696,18 +739,18 @@ nsecs_t GLConsumer::getTimestamp() {
     return mCurrentTimestamp;
 }
 
+uint64_t GLConsumer::getFrameNumber() {
+    ST_LOGV("getFrameNumber");
+    Mutex::Autolock lock(mMutex);
+    return mCurrentFrameNumber;
+}
+
 EGLImageKHR GLConsumer::createImage(EGLDisplay dpy,
         const sp<GraphicBuffer>& graphicBuffer) {
-    EGLClientBuffer cbuf = (EGLClientBuffer)graphicBuffer->getNativeBuffer();
-    EGLint attrs[] = {
-        EGL_IMAGE_PRESERVED_KHR,    EGL_TRUE,
-        EGL_NONE,
-    };
-    EGLImageKHR image = eglCreateImageKHR(dpy, EGL_NO_CONTEXT,
-            EGL_NATIVE_BUFFER_ANDROID, cbuf, attrs);
+    // the image must be given back to the EGLImageCache, not destroyed
+    EGLImageKHR image = EGLImageCache::getInstance().acquire(dpy, graphicBuffer);
     if (image == EGL_NO_IMAGE_KHR) {
-        EGLint error = eglGetError();
-        ST_LOGE("error creating EGLImage: %#x", error);
+        ST_LOGE("error creating EGLImage");
     }
     return image;
 }
@@ -758,6 +801,11 @@ uint32_t GLConsumer::getCurrentTransform() const {
     return mCurrentTransform;
 }
 
+bool GLConsumer::hasGeometryChanged() const {
+    Mutex::Autolock lock(mMutex);
+    return mGeometryChanged;
+}
+
 uint32_t GLConsumer::getCurrentScalingMode() const {
     Mutex::Autolock lock(mMutex);
     return mCurrentScalingMode;
@@ -788,49 +836,10 @@ status_t GLConsumer::doGLFenceWaitLocked() const {
         return INVALID_OPERATION;
     }
 
-    if (mCurrentFence->isValid()) {
-        if (SyncFeatures::getInstance().useWaitSync()) {
-            // Create an EGLSyncKHR from the current fence.
-            int fenceFd = mCurrentFence->dup();
-            if (fenceFd == -1) {
-                ST_LOGE("doGLFenceWait: error dup'ing fence fd: %d", errno);
-                return -errno;
-            }
-            EGLint attribs[] = {
-                EGL_SYNC_NATIVE_FENCE_FD_ANDROID, fenceFd,
-                EGL_NONE
-            };
-            EGLSyncKHR sync = eglCreateSyncKHR(dpy,
-                    EGL_SYNC_NATIVE_FENCE_ANDROID, attribs);
-            if (sync == EGL_NO_SYNC_KHR) {
-                close(fenceFd);
-                ST_LOGE("doGLFenceWait: error creating EGL fence: %#x",
-                        eglGetError());
-                return UNKNOWN_ERROR;
-            }
-
-            // XXX: The spec draft is inconsistent as to whether this should
-            // return an EGLint or void.  Ignore the return value for now, as
-            // it's not strictly needed.
-            eglWaitSyncKHR(dpy, sync, 0);
-            EGLint eglErr = eglGetError();
-            eglDestroySyncKHR(dpy, sync);
-            if (eglErr != EGL_SUCCESS) {
-                ST_LOGE("doGLFenceWait: error waiting for EGL fence: %#x",
-                        eglErr);
-                return UNKNOWN_ERROR;
-            }
-        } else {
-            status_t err = mCurrentFence->waitForever(
-                    "GLConsumer::doGLFenceWaitLocked");
-            if (err != NO_ERROR) {
-                ST_LOGE("doGLFenceWait: error waiting for fence: %d", err);
-                return err;
-            }
-        }
-    }
-
-    return NO_ERROR;
+    // Makes the GPU wait for the producer rather than this thread, when the
+    // driver supports it.
+    return FencePipeline::waitOnGpu(dpy, mCurrentFence,
+            "GLConsumer::doGLFenceWaitLocked");
 }
 
 bool GLConsumer::isSynchronousMode() const {
@@ -845,10 +854,14 @@ void GLConsumer::freeBufferLocked(int slotIndex) {
     }
     EGLImageKHR img = mEglSlots[slotIndex].mEglImage;
     if (img != EGL_NO_IMAGE_KHR) {
-        ST_LOGV("destroying EGLImage dpy=%p img=%p", mEglDisplay, img);
-        eglDestroyImageKHR(mEglDisplay, img);
+        ST_LOGV("releasing EGLImage dpy=%p img=%p", mEglDisplay, img);
+        EGLImageCache::getInstance().release(mEglDisplay, img);
     }
     mEglSlots[slotIndex].mEglImage = EGL_NO_IMAGE_KHR;
+    // the idle images in the cache would keep the buffer alive
+    if (mSlots[slotIndex].mGraphicBuffer != NULL) {
+        EGLImageCache::getInstance().evict(mSlots[slotIndex].mGraphicBuffer);
+    }
     ConsumerBase::freeBufferLocked(slotIndex);
 }
 
@@ -26,6 +26,7 @@
 
 #include <gui/IDisplayEventConnection.h>
 #include <gui/BitTube.h>
+#include <gui/SharedVSync.h>
 
 namespace android {
 // ----------------------------------------------------------------------------
@@ -33,7 +34,9 @@ namespace android {
 enum {
     GET_DATA_CHANNEL = IBinder::FIRST_CALL_TRANSACTION,
     SET_VSYNC_RATE,
-    REQUEST_NEXT_VSYNC
+    REQUEST_NEXT_VSYNC,
+    GET_SHARED_VSYNC,
+    SET_VSYNC_SCHEDULE
 };
 
 class BpDisplayEventConnection : public BpInterface<IDisplayEventConnection>
@@ -52,6 +55,21 @@ public:
         return new BitTube(reply);
     }
 
+    virtual sp<SharedVSync> getSharedVSync()
+    {
+        Parcel data, reply;
+        data.writeInterfaceToken(IDisplayEventConnection::getInterfaceDescriptor());
+        remote()->transact(GET_SHARED_VSYNC, data, &reply);
+        if (reply.readInt32() != NO_ERROR) {
+            return NULL;
+        }
+        sp<SharedVSync> page(new SharedVSync(reply));
+        if (page->initCheck() != NO_ERROR) {
+            return NULL;
+        }
+        return page;
+    }
+
     virtual void setVsyncRate(uint32_t count) {
         Parcel data, reply;
         data.writeInterfaceToken(IDisplayEventConnection::getInterfaceDescriptor());
@@ -64,6 +82,18 @@ public:
         data.writeInterfaceToken(IDisplayEventConnection::getInterfaceDescriptor());
         remote()->transact(REQUEST_NEXT_VSYNC, data, &reply, IBinder::FLAG_ONEWAY);
     }
+
+    virtual status_t setVsyncSchedule(nsecs_t period, nsecs_t phase) {
+        Parcel data, reply;
+        data.writeInterfaceToken(IDisplayEventConnection::getInterfaceDescriptor());
+        data.writeInt64(period);
+        data.writeInt64(phase);
+        status_t result = remote()->transact(SET_VSYNC_SCHEDULE, data, &reply);
+        if (result != NO_ERROR) {
+            return result;
+        }
+        return reply.readInt32();
+    }
 };
 
 IMPLEMENT_META_INTERFACE(DisplayEventConnection, "android.gui.DisplayEventConnection");
@@ -90,6 +120,24 @@ status_t BnDisplayEventConnection::onTransact(
             requestNextVsync();
             return NO_ERROR;
         } break;
+        case SET_VSYNC_SCHEDULE: {
+            CHECK_INTERFACE(IDisplayEventConnection, data, reply);
+            nsecs_t period = data.readInt64();
+            nsecs_t phase = data.readInt64();
+            reply->writeInt32(setVsyncSchedule(period, phase));
+            return NO_ERROR;
+        } break;
+        case GET_SHARED_VSYNC: {
+            CHECK_INTERFACE(IDisplayEventConnection, data, reply);
+            sp<SharedVSync> page(getSharedVSync());
+            if (page == 0) {
+                reply->writeInt32(NO_INIT);
+                return NO_ERROR;
+            }
+            reply->writeInt32(NO_ERROR);
+            page->writeToParcel(reply);
+            return NO_ERROR;
+        } break;
     }
     return BBinder::onTransact(code, data, reply, flags);
 }
@@ -42,6 +42,9 @@ enum {
     CONNECT,
     DISCONNECT,
     UPDATE_BUFFERS_GEOMETRY,
+    ALLOCATE_BUFFERS,
+    REQUEST_BUFFERS,
+    GET_FRAME_TIMESTAMPS,
 };
 
 
@@ -208,6 +211,54 @@ public:
         return result;
     }
 
+    virtual void allocateBuffers(uint32_t w, uint32_t h,
+            uint32_t format, uint32_t usage) {
+        Parcel data, reply;
+        data.writeInterfaceToken(IGraphicBufferProducer::getInterfaceDescriptor());
+        data.writeInt32(w);
+        data.writeInt32(h);
+        data.writeInt32(format);
+        data.writeInt32(usage);
+        remote()->transact(ALLOCATE_BUFFERS, data, &reply,
+                IBinder::FLAG_ONEWAY);
+    }
+
+    virtual status_t requestBuffers(uint32_t* slotMask,
+            sp<GraphicBuffer>* buffers) {
+        Parcel data, reply;
+        data.writeInterfaceToken(IGraphicBufferProducer::getInterfaceDescriptor());
+        data.writeInt32(*slotMask);
+        status_t result = remote()->transact(REQUEST_BUFFERS, data, &reply);
+        if (result != NO_ERROR) {
+            return result;
+        }
+        const uint32_t mask = reply.readInt32();
+        for (uint32_t i = 0; i < 32; i++) {
+            if (mask & (1u << i)) {
+                buffers[i] = new GraphicBuffer();
+                reply.read(*buffers[i]);
+            }
+        }
+        *slotMask = mask;
+        result = reply.readInt32();
+        return result;
+    }
+
+    virtual status_t getFrameTimestamps(uint64_t frameNumber,
+            FrameTimestamps* outTimestamps) {
+        Parcel data, reply;
+        data.writeInterfaceToken(IGraphicBufferProducer::getInterfaceDescriptor());
+        data.writeInt64(frameNumber);
+        status_t result = remote()->transact(GET_FRAME_TIMESTAMPS,
+                data, &reply);
+        if (result != NO_ERROR) {
+            return result;
+        }
+        reply.read(outTimestamps, sizeof(FrameTimestamps));
+        result = reply.readInt32();
+        return result;
+    }
+
 };
 
 IMPLEMENT_META_INTERFACE(GraphicBufferProducer, "android.gui.IGraphicBufferProducer");
@@ -322,6 +373,40 @@ status_t BnGraphicBufferProducer::onTransact(
             reply->writeInt32(res);
             return NO_ERROR;
         } break;
+        case ALLOCATE_BUFFERS: {
+            CHECK_INTERFACE(IGraphicBufferProducer, data, reply);
+            uint32_t w      = data.readInt32();
+            uint32_t h      = data.readInt32();
+            uint32_t format = data.readInt32();
+            uint32_t usage  = data.readInt32();
+            allocateBuffers(w, h, format, usage);
+            return NO_ERROR;
+        } break;
+        case REQUEST_BUFFERS: {
+            CHECK_INTERFACE(IGraphicBufferProducer, data, reply);
+            uint32_t mask = data.readInt32();
+            sp<GraphicBuffer> buffers[32];
+            status_t res = requestBuffers(&mask, buffers);
+            reply->writeInt32(mask);
+            for (uint32_t i = 0; i < 32; i++) {
+                if (mask & (1u << i)) {
+                    reply->write(*buffers[i]);
+                }
+            }
+            reply->writeInt32(res);
+            return NO_ERROR;
+        } break;
+        case GET_FRAME_TIMESTAMPS: {
+            CHECK_INTERFACE(IGraphicBufferProducer, data, reply);
+            uint64_t frameNumber = data.readInt64();
+            FrameTimestamps* const timestamps =
+                    reinterpret_cast<FrameTimestamps *>(
+                            reply->writeInplace(sizeof(FrameTimestamps)));
+            memset(timestamps, 0, sizeof(FrameTimestamps));
+            status_t res = getFrameTimestamps(frameNumber, timestamps);
+            reply->writeInt32(res);
+            return NO_ERROR;
+        } break;
     }
     return BBinder::onTransact(code, data, reply, flags);
 }
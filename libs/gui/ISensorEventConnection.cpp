@@ -26,6 +26,7 @@
 
 #include <gui/ISensorEventConnection.h>
 #include <gui/BitTube.h>
+#include <gui/SensorDirectChannel.h>
 
 namespace android {
 // ----------------------------------------------------------------------------
@@ -33,7 +34,9 @@ namespace android {
 enum {
     GET_SENSOR_CHANNEL = IBinder::FIRST_CALL_TRANSACTION,
     ENABLE_DISABLE,
-    SET_EVENT_RATE
+    SET_EVENT_RATE,
+    SET_MAX_REPORT_LATENCY,
+    CREATE_DIRECT_CHANNEL
 };
 
 class BpSensorEventConnection : public BpInterface<ISensorEventConnection>
@@ -71,6 +74,32 @@ public:
         remote()->transact(SET_EVENT_RATE, data, &reply);
         return reply.readInt32();
     }
+
+    virtual status_t setMaxReportLatency(int handle, nsecs_t ns)
+    {
+        Parcel data, reply;
+        data.writeInterfaceToken(ISensorEventConnection::getInterfaceDescriptor());
+        data.writeInt32(handle);
+        data.writeInt64(ns);
+        remote()->transact(SET_MAX_REPORT_LATENCY, data, &reply);
+        return reply.readInt32();
+    }
+
+    virtual sp<SensorDirectChannel> createDirectChannel(size_t capacity)
+    {
+        Parcel data, reply;
+        data.writeInterfaceToken(ISensorEventConnection::getInterfaceDescriptor());
+        data.writeInt32(capacity);
+        remote()->transact(CREATE_DIRECT_CHANNEL, data, &reply);
+        if (reply.readInt32() != NO_ERROR) {
+            return NULL;
+        }
+        sp<SensorDirectChannel> channel(new SensorDirectChannel(reply));
+        if (channel->initCheck() != NO_ERROR) {
+            return NULL;
+        }
+        return channel;
+    }
 };
 
 IMPLEMENT_META_INTERFACE(SensorEventConnection, "android.gui.SensorEventConnection");
@@ -103,6 +132,26 @@ status_t BnSensorEventConnection::onTransact(
             reply->writeInt32(result);
             return NO_ERROR;
         } break;
+        case SET_MAX_REPORT_LATENCY: {
+            CHECK_INTERFACE(ISensorEventConnection, data, reply);
+            int handle = data.readInt32();
+            nsecs_t ns = data.readInt64();
+            status_t result = setMaxReportLatency(handle, ns);
+            reply->writeInt32(result);
+            return NO_ERROR;
+        } break;
+        case CREATE_DIRECT_CHANNEL: {
+            CHECK_INTERFACE(ISensorEventConnection, data, reply);
+            size_t capacity = data.readInt32();
+            sp<SensorDirectChannel> channel(createDirectChannel(capacity));
+            if (channel == 0) {
+                reply->writeInt32(NO_INIT);
+                return NO_ERROR;
+            }
+            reply->writeInt32(NO_ERROR);
+            channel->writeToParcel(reply);
+            return NO_ERROR;
+        } break;
     }
     return BBinder::onTransact(code, data, reply, flags);
 }
@@ -15,6 +15,8 @@
  */
 
 #include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 
 #include <utils/Errors.h>
@@ -24,6 +26,8 @@
 
 #include <binder/Parcel.h>
 #include <binder/IInterface.h>
+#include <binder/IMemory.h>
+#include <binder/MemoryHeapBase.h>
 
 #include <gui/Sensor.h>
 #include <gui/ISensorServer.h>
@@ -35,6 +39,7 @@ namespace android {
 enum {
     GET_SENSOR_LIST = IBinder::FIRST_CALL_TRANSACTION,
     CREATE_SENSOR_EVENT_CONNECTION,
+    GET_SENSOR_LIST_MEMORY,
 };
 
 class BpSensorServer : public BpInterface<ISensorServer>
@@ -68,12 +73,102 @@ public:
         remote()->transact(CREATE_SENSOR_EVENT_CONNECTION, data, &reply);
         return interface_cast<ISensorEventConnection>(reply.readStrongBinder());
     }
+
+    virtual sp<IMemoryHeap> getSensorListMemory()
+    {
+        Parcel data, reply;
+        data.writeInterfaceToken(ISensorServer::getInterfaceDescriptor());
+        status_t err = remote()->transact(GET_SENSOR_LIST_MEMORY, data, &reply);
+        if (err != NO_ERROR) {
+            return NULL;
+        }
+        return interface_cast<IMemoryHeap>(reply.readStrongBinder());
+    }
 };
 
 IMPLEMENT_META_INTERFACE(SensorServer, "android.gui.SensorServer");
 
 // ----------------------------------------------------------------------
 
+sp<IMemoryHeap> ISensorServer::writeSensorList(const Vector<Sensor>& list)
+{
+    const size_t n = list.size();
+    size_t size = 0;
+    for (size_t i=0 ; i<n ; i++) {
+        size += sizeof(int32_t) + ((list[i].getSize() + 3) & ~3);
+    }
+
+    sp<MemoryHeapBase> heap(new MemoryHeapBase(
+            sizeof(sensor_list_header_t) + size,
+            MemoryHeapBase::READ_ONLY, "SensorList"));
+    uint8_t* base = static_cast<uint8_t*>(heap->getBase());
+    if (heap->getHeapID() < 0 || base == MAP_FAILED) {
+        return NULL;
+    }
+
+    sensor_list_header_t* header = reinterpret_cast<sensor_list_header_t*>(base);
+    header->magic = SENSOR_LIST_MAGIC;
+    header->version = SENSOR_LIST_VERSION;
+    header->count = n;
+    header->size = size;
+    uint8_t* p = base + sizeof(sensor_list_header_t);
+    for (size_t i=0 ; i<n ; i++) {
+        const size_t len = list[i].getSize();
+        *reinterpret_cast<int32_t*>(p) = len;
+        list[i].flatten(p + sizeof(int32_t));
+        memset(p + sizeof(int32_t) + len, 0, ((len + 3) & ~3) - len);
+        p += sizeof(int32_t) + ((len + 3) & ~3);
+    }
+    return heap;
+}
+
+status_t ISensorServer::readSensorList(const sp<IMemoryHeap>& heap,
+        Vector<Sensor>* list)
+{
+    if (heap == NULL || heap->getHeapID() < 0) {
+        return BAD_VALUE;
+    }
+    const uint8_t* base = static_cast<const uint8_t*>(heap->getBase());
+    const size_t heapSize = heap->getSize();
+    if (base == MAP_FAILED || heapSize < sizeof(sensor_list_header_t)) {
+        return BAD_VALUE;
+    }
+
+    const sensor_list_header_t* header =
+            reinterpret_cast<const sensor_list_header_t*>(base);
+    if (header->magic != SENSOR_LIST_MAGIC ||
+            header->version != SENSOR_LIST_VERSION ||
+            header->size > heapSize - sizeof(sensor_list_header_t)) {
+        return BAD_VALUE;
+    }
+
+    const uint8_t* p = base + sizeof(sensor_list_header_t);
+    const uint8_t* const end = p + header->size;
+    Vector<Sensor> v;
+    v.setCapacity(header->count);
+    Sensor s;
+    for (uint32_t i=0 ; i<header->count ; i++) {
+        if (size_t(end - p) < sizeof(int32_t)) {
+            return BAD_VALUE;
+        }
+        const size_t len = *reinterpret_cast<const uint32_t*>(p);
+        p += sizeof(int32_t);
+        if (len > size_t(end - p)) {
+            return BAD_VALUE;
+        }
+        status_t err = s.unflatten(p, len);
+        if (err != NO_ERROR) {
+            return err;
+        }
+        v.add(s);
+        p += (len + 3) & ~3;
+    }
+    *list = v;
+    return NO_ERROR;
+}
+
+// ----------------------------------------------------------------------
+
 status_t BnSensorServer::onTransact(
     uint32_t code, const Parcel& data, Parcel* reply, uint32_t flags)
 {
@@ -82,6 +177,12 @@ status_t BnSensorServer::onTransact(
             CHECK_INTERFACE(ISensorServer, data, reply);
             Vector<Sensor> v(getSensorList());
             size_t n = v.size();
+            // grow the reply once for the whole list
+            size_t size = sizeof(int32_t);
+            for (size_t i=0 ; i<n ; i++) {
+                size += sizeof(int32_t) + ((v[i].getSize() + 3) & ~3);
+            }
+            reply->setDataCapacity(reply->dataSize() + size);
             reply->writeInt32(n);
             for (size_t i=0 ; i<n ; i++) {
                 reply->write(v[i]);
@@ -94,6 +195,16 @@ status_t BnSensorServer::onTransact(
             reply->writeStrongBinder(connection->asBinder());
             return NO_ERROR;
         } break;
+        case GET_SENSOR_LIST_MEMORY: {
+            CHECK_INTERFACE(ISensorServer, data, reply);
+            sp<IMemoryHeap> heap(getSensorListMemory());
+            sp<IBinder> binder;
+            if (heap != NULL) {
+                binder = heap->asBinder();
+            }
+            reply->writeStrongBinder(binder);
+            return NO_ERROR;
+        } break;
     }
     return BBinder::onTransact(code, data, reply, flags);
 }
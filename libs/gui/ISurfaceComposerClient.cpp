@@ -39,7 +39,9 @@ namespace android {
 
 enum {
     CREATE_SURFACE = IBinder::FIRST_CALL_TRANSACTION,
-    DESTROY_SURFACE
+    DESTROY_SURFACE,
+    CREATE_SURFACES,
+    DESTROY_SURFACES
 };
 
 class BpSurfaceComposerClient : public BpInterface<ISurfaceComposerClient>
@@ -73,6 +75,54 @@ public:
         remote()->transact(DESTROY_SURFACE, data, &reply);
         return reply.readInt32();
     }
+
+    virtual status_t createSurfaces(const Vector<SurfaceSpec>& specs,
+            Vector<CreatedSurface>* surfaces) {
+        Parcel data, reply;
+        data.writeInterfaceToken(ISurfaceComposerClient::getInterfaceDescriptor());
+        data.writeInt32(specs.size());
+        for (size_t i=0 ; i<specs.size() ; i++) {
+            const SurfaceSpec& spec(specs[i]);
+            data.writeString8(spec.name);
+            data.writeInt32(spec.w);
+            data.writeInt32(spec.h);
+            data.writeInt32(spec.format);
+            data.writeInt32(spec.flags);
+        }
+        status_t err = remote()->transact(CREATE_SURFACES, data, &reply);
+        if (err != NO_ERROR) {
+            return err;
+        }
+        err = reply.readInt32();
+        if (err != NO_ERROR) {
+            return err;
+        }
+        const size_t count = reply.readInt32();
+        surfaces->clear();
+        surfaces->setCapacity(count);
+        for (size_t i=0 ; i<count ; i++) {
+            CreatedSurface s;
+            s.handle = reply.readStrongBinder();
+            s.gbp = interface_cast<IGraphicBufferProducer>(reply.readStrongBinder());
+            s.result = reply.readInt32();
+            surfaces->add(s);
+        }
+        return NO_ERROR;
+    }
+
+    virtual status_t destroySurfaces(const Vector< sp<IBinder> >& handles) {
+        Parcel data, reply;
+        data.writeInterfaceToken(ISurfaceComposerClient::getInterfaceDescriptor());
+        data.writeInt32(handles.size());
+        for (size_t i=0 ; i<handles.size() ; i++) {
+            data.writeStrongBinder(handles[i]);
+        }
+        status_t err = remote()->transact(DESTROY_SURFACES, data, &reply);
+        if (err != NO_ERROR) {
+            return err;
+        }
+        return reply.readInt32();
+    }
 };
 
 IMPLEMENT_META_INTERFACE(SurfaceComposerClient, "android.ui.ISurfaceComposerClient");
@@ -104,6 +154,52 @@ status_t BnSurfaceComposerClient::onTransact(
             reply->writeInt32( destroySurface( data.readStrongBinder() ) );
             return NO_ERROR;
         } break;
+        case CREATE_SURFACES: {
+            CHECK_INTERFACE(ISurfaceComposerClient, data, reply);
+            const size_t count = data.readInt32();
+            // a spec takes at least 24 bytes, don't trust the count further
+            if (count > data.dataAvail() / 24) {
+                return BAD_VALUE;
+            }
+            Vector<SurfaceSpec> specs;
+            specs.setCapacity(count);
+            for (size_t i=0 ; i<count ; i++) {
+                SurfaceSpec spec;
+                spec.name = data.readString8();
+                spec.w = data.readInt32();
+                spec.h = data.readInt32();
+                spec.format = data.readInt32();
+                spec.flags = data.readInt32();
+                specs.add(spec);
+            }
+            Vector<CreatedSurface> surfaces;
+            status_t result = createSurfaces(specs, &surfaces);
+            reply->writeInt32(result);
+            if (result == NO_ERROR) {
+                reply->writeInt32(surfaces.size());
+                for (size_t i=0 ; i<surfaces.size() ; i++) {
+                    const CreatedSurface& s(surfaces[i]);
+                    reply->writeStrongBinder(s.handle);
+                    reply->writeStrongBinder(s.gbp != NULL ? s.gbp->asBinder() : NULL);
+                    reply->writeInt32(s.result);
+                }
+            }
+            return NO_ERROR;
+        } break;
+        case DESTROY_SURFACES: {
+            CHECK_INTERFACE(ISurfaceComposerClient, data, reply);
+            const size_t count = data.readInt32();
+            if (count > data.dataAvail() / 4) {
+                return BAD_VALUE;
+            }
+            Vector< sp<IBinder> > handles;
+            handles.setCapacity(count);
+            for (size_t i=0 ; i<count ; i++) {
+                handles.add(data.readStrongBinder());
+            }
+            reply->writeInt32( destroySurfaces(handles) );
+            return NO_ERROR;
+        } break;
         default:
             return BBinder::onTransact(code, data, reply, flags);
     }
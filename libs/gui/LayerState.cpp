@@ -22,23 +22,44 @@
 
 namespace android {
 
+// Only the fields flagged in "what" are flattened, the others keep their
+// default value on the other side. Transactions usually change one or two
+// fields of each layer, so this keeps the parcels small.
 status_t layer_state_t::write(Parcel& output) const
 {
     output.writeStrongBinder(surface);
     output.writeInt32(what);
-    output.writeFloat(x);
-    output.writeFloat(y);
-    output.writeInt32(z);
-    output.writeInt32(w);
-    output.writeInt32(h);
-    output.writeInt32(layerStack);
-    output.writeFloat(alpha);
-    output.writeInt32(flags);
-    output.writeInt32(mask);
-    *reinterpret_cast<layer_state_t::matrix22_t *>(
-            output.writeInplace(sizeof(layer_state_t::matrix22_t))) = matrix;
-    output.write(crop);
-    output.write(transparentRegion);
+    if (what & ePositionChanged) {
+        output.writeFloat(x);
+        output.writeFloat(y);
+    }
+    if (what & eLayerChanged) {
+        output.writeInt32(z);
+    }
+    if (what & eSizeChanged) {
+        output.writeInt32(w);
+        output.writeInt32(h);
+    }
+    if (what & eLayerStackChanged) {
+        output.writeInt32(layerStack);
+    }
+    if (what & eAlphaChanged) {
+        output.writeFloat(alpha);
+    }
+    if (what & eVisibilityChanged) {
+        output.writeInt32(flags);
+        output.writeInt32(mask);
+    }
+    if (what & eMatrixChanged) {
+        *reinterpret_cast<layer_state_t::matrix22_t *>(
+                output.writeInplace(sizeof(layer_state_t::matrix22_t))) = matrix;
+    }
+    if (what & eCropChanged) {
+        output.write(crop);
+    }
+    if (what & eTransparentRegionChanged) {
+        output.write(transparentRegion);
+    }
     return NO_ERROR;
 }
 
@@ -46,19 +67,42 @@ status_t layer_state_t::read(const Parcel& input)
 {
     surface = input.readStrongBinder();
     what = input.readInt32();
-    x = input.readFloat();
-    y = input.readFloat();
-    z = input.readInt32();
-    w = input.readInt32();
-    h = input.readInt32();
-    layerStack = input.readInt32();
-    alpha = input.readFloat();
-    flags = input.readInt32();
-    mask = input.readInt32();
-    matrix = *reinterpret_cast<layer_state_t::matrix22_t const *>(
-            input.readInplace(sizeof(layer_state_t::matrix22_t)));
-    input.read(crop);
-    input.read(transparentRegion);
+    if (what & ePositionChanged) {
+        x = input.readFloat();
+        y = input.readFloat();
+    }
+    if (what & eLayerChanged) {
+        z = input.readInt32();
+    }
+    if (what & eSizeChanged) {
+        w = input.readInt32();
+        h = input.readInt32();
+    }
+    if (what & eLayerStackChanged) {
+        layerStack = input.readInt32();
+    }
+    if (what & eAlphaChanged) {
+        alpha = input.readFloat();
+    }
+    if (what & eVisibilityChanged) {
+        flags = input.readInt32();
+        mask = input.readInt32();
+    }
+    if (what & eMatrixChanged) {
+        const layer_state_t::matrix22_t* m =
+                reinterpret_cast<layer_state_t::matrix22_t const *>(
+                        input.readInplace(sizeof(layer_state_t::matrix22_t)));
+        if (m == NULL) {
+            return BAD_VALUE;
+        }
+        matrix = *m;
+    }
+    if (what & eCropChanged) {
+        input.read(crop);
+    }
+    if (what & eTransparentRegionChanged) {
+        input.read(transparentRegion);
+    }
     return NO_ERROR;
 }
 
@@ -73,25 +117,38 @@ status_t ComposerState::read(const Parcel& input) {
 }
 
 
+// Like layer_state_t, only what changed is flattened.
 status_t DisplayState::write(Parcel& output) const {
     output.writeStrongBinder(token);
-    output.writeStrongBinder(surface->asBinder());
     output.writeInt32(what);
-    output.writeInt32(layerStack);
-    output.writeInt32(orientation);
-    output.write(viewport);
-    output.write(frame);
+    if (what & eSurfaceChanged) {
+        output.writeStrongBinder(surface != NULL ? surface->asBinder() : NULL);
+    }
+    if (what & eLayerStackChanged) {
+        output.writeInt32(layerStack);
+    }
+    if (what & eDisplayProjectionChanged) {
+        output.writeInt32(orientation);
+        output.write(viewport);
+        output.write(frame);
+    }
     return NO_ERROR;
 }
 
 status_t DisplayState::read(const Parcel& input) {
     token = input.readStrongBinder();
-    surface = interface_cast<IGraphicBufferProducer>(input.readStrongBinder());
     what = input.readInt32();
-    layerStack = input.readInt32();
-    orientation = input.readInt32();
-    input.read(viewport);
-    input.read(frame);
+    if (what & eSurfaceChanged) {
+        surface = interface_cast<IGraphicBufferProducer>(input.readStrongBinder());
+    }
+    if (what & eLayerStackChanged) {
+        layerStack = input.readInt32();
+    }
+    if (what & eDisplayProjectionChanged) {
+        orientation = input.readInt32();
+        input.read(viewport);
+        input.read(frame);
+    }
     return NO_ERROR;
 }
 
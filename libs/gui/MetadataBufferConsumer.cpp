@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "MetadataBufferConsumer"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include <gui/MetadataBufferConsumer.h>
+#include <media/hardware/MetadataBufferType.h>
+
+#define MB_LOGV(x, ...) ALOGV("[%s] "x, mName.string(), ##__VA_ARGS__)
+#define MB_LOGE(x, ...) ALOGE("[%s] "x, mName.string(), ##__VA_ARGS__)
+
+namespace android {
+
+MetadataBufferConsumer::MetadataBufferConsumer(int bufferCount,
+        bool synchronousMode) :
+    ConsumerBase(new BufferQueue(true) )
+{
+    mBufferQueue->setConsumerUsageBits(GRALLOC_USAGE_HW_VIDEO_ENCODER);
+    mBufferQueue->setSynchronousMode(synchronousMode);
+    mBufferQueue->setMaxAcquiredBufferCount(bufferCount);
+}
+
+MetadataBufferConsumer::~MetadataBufferConsumer() {
+}
+
+void MetadataBufferConsumer::setName(const String8& name) {
+    Mutex::Autolock _l(mMutex);
+    mName = name;
+    mBufferQueue->setConsumerName(name);
+}
+
+size_t MetadataBufferConsumer::getMetadataSize() {
+    return sizeof(uint32_t) + sizeof(buffer_handle_t);
+}
+
+status_t MetadataBufferConsumer::acquireMetadataBuffer(void* data, size_t size,
+        sp<Fence>* outFence, int64_t* outTimestamp) {
+    ATRACE_CALL();
+    if (!data || size < getMetadataSize()) return BAD_VALUE;
+
+    Mutex::Autolock _l(mMutex);
+
+    BufferQueue::BufferItem item;
+    status_t err = acquireBufferLocked(&item, 0);
+    if (err != OK) {
+        if (err != NO_BUFFER_AVAILABLE) {
+            MB_LOGE("Error acquiring buffer: %s (%d)", strerror(-err), err);
+        }
+        return err;
+    }
+
+    if (outFence) {
+        *outFence = item.mFence;
+    } else {
+        err = item.mFence->waitForever("MetadataBufferConsumer::acquireMetadataBuffer");
+        if (err != OK) {
+            MB_LOGE("Failed to wait for fence of acquired buffer: %s (%d)",
+                    strerror(-err), err);
+            releaseBufferLocked(item.mBuf, EGL_NO_DISPLAY, EGL_NO_SYNC_KHR);
+            return err;
+        }
+    }
+    if (outTimestamp) {
+        *outTimestamp = item.mTimestamp;
+    }
+
+    for (size_t i = 0; i < mAcquired.size(); i++) {
+        if (mAcquired[i].slot == item.mBuf) {
+            mAcquired.editItemAt(i).stale = true;
+        }
+    }
+    const sp<GraphicBuffer>& buffer(mSlots[item.mBuf].mGraphicBuffer);
+    Acquisition acquisition;
+    acquisition.slot = item.mBuf;
+    acquisition.frameNumber = item.mFrameNumber;
+    acquisition.buffer = buffer;
+    acquisition.stale = false;
+    mAcquired.add(acquisition);
+
+    // see MetadataBufferType.h for the layout
+    const uint32_t type = kMetadataBufferTypeGrallocSource;
+    const buffer_handle_t handle = buffer->handle;
+    memcpy(data, &type, sizeof(type));
+    memcpy(static_cast<uint8_t*>(data) + sizeof(type), &handle, sizeof(handle));
+
+    MB_LOGV("acquireMetadataBuffer: slot=%d handle=%p", item.mBuf, handle);
+    return OK;
+}
+
+status_t MetadataBufferConsumer::releaseMetadataBuffer(const void* data,
+        size_t size, const sp<Fence>& releaseFence) {
+    ATRACE_CALL();
+    if (!data || size < getMetadataSize()) return BAD_VALUE;
+
+    uint32_t type;
+    buffer_handle_t handle;
+    memcpy(&type, data, sizeof(type));
+    memcpy(&handle, static_cast<const uint8_t*>(data) + sizeof(type), sizeof(handle));
+    if (type != kMetadataBufferTypeGrallocSource) {
+        return BAD_VALUE;
+    }
+
+    Mutex::Autolock _l(mMutex);
+
+    ssize_t index = -1;
+    for (size_t i = 0; i < mAcquired.size(); i++) {
+        if (mAcquired[i].buffer->handle == handle) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        MB_LOGE("releaseMetadataBuffer: handle %p isn't acquired", handle);
+        return BAD_VALUE;
+    }
+
+    const Acquisition acquisition(mAcquired[index]);
+    mAcquired.removeAt(index);
+    const int slot = acquisition.slot;
+    if (acquisition.stale || mSlots[slot].mGraphicBuffer != acquisition.buffer) {
+        // The slot was freed while the encoder read the buffer, the queue
+        // has taken it back already.
+        MB_LOGV("releaseMetadataBuffer: slot %d was freed since frame %llu",
+                slot, acquisition.frameNumber);
+        return OK;
+    }
+
+    addReleaseFenceLocked(slot, releaseFence);
+    status_t err = releaseBufferLocked(slot, EGL_NO_DISPLAY, EGL_NO_SYNC_KHR);
+    if (err != OK) {
+        MB_LOGE("Failed to release buffer: %s (%d)", strerror(-err), err);
+    }
+    return err;
+}
+
+status_t MetadataBufferConsumer::setDefaultBufferSize(uint32_t w, uint32_t h) {
+    Mutex::Autolock _l(mMutex);
+    return mBufferQueue->setDefaultBufferSize(w, h);
+}
+
+status_t MetadataBufferConsumer::setDefaultBufferFormat(uint32_t defaultFormat) {
+    Mutex::Autolock _l(mMutex);
+    return mBufferQueue->setDefaultBufferFormat(defaultFormat);
+}
+
+void MetadataBufferConsumer::dumpLocked(String8& result, const char* prefix,
+        char* buffer, size_t size) const {
+    result.appendFormat("%sbuffers held by the encoder: %d\n", prefix,
+            int(mAcquired.size()));
+    ConsumerBase::dumpLocked(result, prefix, buffer, size);
+}
+
+} // namespace android
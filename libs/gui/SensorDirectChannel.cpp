@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "Sensors"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cutils/ashmem.h>
+#include <cutils/atomic.h>
+#include <cutils/log.h>
+
+#include <utils/Errors.h>
+
+#include <binder/Parcel.h>
+
+#include <gui/SensorDirectChannel.h>
+
+#include <android/sensor.h>
+
+namespace android {
+// ----------------------------------------------------------------------------
+
+static const size_t MIN_CAPACITY = 16;
+static const size_t MAX_CAPACITY = 4096;
+
+SensorDirectChannel::SensorDirectChannel(size_t capacity)
+    : mFd(-1), mBase(MAP_FAILED), mSize(0), mCapacity(MIN_CAPACITY),
+      mWriteCount(0), mReadCount(0)
+{
+    while (mCapacity < capacity && mCapacity < MAX_CAPACITY) {
+        mCapacity <<= 1;
+    }
+    mSize = sizeof(Header) + mCapacity * sizeof(ASensorEvent);
+    mFd = ashmem_create_region("SensorDirectChannel", mSize);
+    if (mFd < 0) {
+        ALOGE("SensorDirectChannel: ashmem_create_region failed (%s)",
+                strerror(errno));
+        return;
+    }
+    mBase = mmap(0, mSize, PROT_READ|PROT_WRITE, MAP_SHARED, mFd, 0);
+    if (mBase == MAP_FAILED) {
+        ALOGE("SensorDirectChannel: mmap failed (%s)", strerror(errno));
+        return;
+    }
+    memset(mBase, 0, sizeof(Header));
+}
+
+SensorDirectChannel::SensorDirectChannel(const Parcel& data)
+    : mFd(-1), mBase(MAP_FAILED), mSize(0), mCapacity(0),
+      mWriteCount(0), mReadCount(0)
+{
+    mFd = dup(data.readFileDescriptor());
+    mCapacity = data.readInt32();
+    if (mFd < 0) {
+        ALOGE("SensorDirectChannel(Parcel): can't dup filedescriptor (%s)",
+                strerror(errno));
+        return;
+    }
+    if (mCapacity < MIN_CAPACITY || mCapacity > MAX_CAPACITY ||
+            (mCapacity & (mCapacity-1))) {
+        ALOGE("SensorDirectChannel(Parcel): invalid capacity %u", mCapacity);
+        return;
+    }
+    mSize = sizeof(Header) + mCapacity * sizeof(ASensorEvent);
+    mBase = mmap(0, mSize, PROT_READ|PROT_WRITE, MAP_SHARED, mFd, 0);
+    if (mBase == MAP_FAILED) {
+        ALOGE("SensorDirectChannel(Parcel): mmap failed (%s)", strerror(errno));
+        return;
+    }
+    // start with whatever is in the ring now
+    Header* const header = static_cast<Header*>(mBase);
+    mReadCount = uint32_t(android_atomic_acquire_load(&header->writeEnd));
+}
+
+SensorDirectChannel::~SensorDirectChannel()
+{
+    if (mBase != MAP_FAILED)
+        munmap(mBase, mSize);
+
+    if (mFd >= 0)
+        close(mFd);
+}
+
+status_t SensorDirectChannel::initCheck() const
+{
+    return (mBase != MAP_FAILED) ? NO_ERROR : NO_INIT;
+}
+
+size_t SensorDirectChannel::getCapacity() const
+{
+    return mCapacity;
+}
+
+ASensorEvent* SensorDirectChannel::events() const
+{
+    return reinterpret_cast<ASensorEvent*>(static_cast<Header*>(mBase) + 1);
+}
+
+status_t SensorDirectChannel::writeToParcel(Parcel* reply) const
+{
+    if (mBase == MAP_FAILED)
+        return NO_INIT;
+
+    status_t result = reply->writeDupFileDescriptor(mFd);
+    if (result == NO_ERROR) {
+        result = reply->writeInt32(mCapacity);
+    }
+    return result;
+}
+
+bool SensorDirectChannel::write(ASensorEvent const* events, size_t count)
+{
+    if (mBase == MAP_FAILED || count == 0)
+        return false;
+
+    Mutex::Autolock _l(mWriteLock);
+    Header* const header = static_cast<Header*>(mBase);
+    ASensorEvent* const ring = this->events();
+    const uint32_t mask = mCapacity - 1;
+
+    // only the last mCapacity events would survive anyway
+    if (count > mCapacity) {
+        events += count - mCapacity;
+        count = mCapacity;
+    }
+
+    // tell the reader which slots are about to change before changing them
+    const uint32_t end = mWriteCount + count;
+    android_atomic_release_store(int32_t(end), &header->writeBegin);
+    android_memory_barrier();
+
+    uint32_t index = mWriteCount;
+    while (count) {
+        const size_t slot = index & mask;
+        const size_t n = (mCapacity - slot < count) ? mCapacity - slot : count;
+        memcpy(&ring[slot], events, n * sizeof(ASensorEvent));
+        events += n;
+        index += n;
+        count -= n;
+    }
+
+    mWriteCount = end;
+    android_atomic_release_store(int32_t(end), &header->writeEnd);
+    return android_atomic_cmpxchg(0, 1, &header->wakeup) == 0;
+}
+
+ssize_t SensorDirectChannel::read(ASensorEvent* events, size_t count)
+{
+    if (mBase == MAP_FAILED)
+        return NO_INIT;
+
+    Header* const header = static_cast<Header*>(mBase);
+    ASensorEvent const* const ring = this->events();
+    const uint32_t mask = mCapacity - 1;
+
+    const uint32_t end = uint32_t(android_atomic_acquire_load(&header->writeEnd));
+    uint32_t start = mReadCount;
+    if (end - start > mCapacity) {
+        // we've been lapped, skip to the oldest event still in the ring
+        start = end - mCapacity;
+    }
+    size_t n = end - start;
+    if (n > count) {
+        n = count;
+    }
+
+    uint32_t index = start;
+    size_t copied = 0;
+    while (copied < n) {
+        const size_t slot = index & mask;
+        const size_t len = (mCapacity - slot < n - copied) ?
+                mCapacity - slot : n - copied;
+        memcpy(&events[copied], &ring[slot], len * sizeof(ASensorEvent));
+        copied += len;
+        index += len;
+    }
+
+    // the events a write() started on while we were copying may be torn,
+    // drop them.
+    android_memory_barrier();
+    const uint32_t begin = uint32_t(android_atomic_acquire_load(&header->writeBegin));
+    size_t torn = 0;
+    if (begin - start > mCapacity) {
+        torn = begin - start - mCapacity;
+        if (torn > n) {
+            torn = n;
+        }
+        memmove(events, events + torn, (n - torn) * sizeof(ASensorEvent));
+        n -= torn;
+    }
+
+    mReadCount = start + torn + n;
+    return n;
+}
+
+void SensorDirectChannel::rearm()
+{
+    Header* const header = static_cast<Header*>(mBase);
+    if (mBase != MAP_FAILED) {
+        android_atomic_release_store(0, &header->wakeup);
+        android_memory_barrier();
+    }
+}
+
+// ----------------------------------------------------------------------------
+}; // namespace android
@@ -17,6 +17,7 @@
 #define LOG_TAG "Sensors"
 
 #include <stdint.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include <utils/Errors.h>
@@ -35,12 +36,14 @@ namespace android {
 // ----------------------------------------------------------------------------
 
 SensorEventQueue::SensorEventQueue(const sp<ISensorEventConnection>& connection)
-    : mSensorEventConnection(connection)
+    : mSensorEventConnection(connection), mRecBuffer(NULL),
+      mAvailable(0), mConsumed(0)
 {
 }
 
 SensorEventQueue::~SensorEventQueue()
 {
+    delete [] mRecBuffer;
 }
 
 void SensorEventQueue::onFirstRef()
@@ -56,12 +59,88 @@ int SensorEventQueue::getFd() const
 
 ssize_t SensorEventQueue::write(const sp<BitTube>& tube,
         ASensorEvent const* events, size_t numEvents) {
-    return BitTube::sendObjects(tube, events, numEvents);
+    // several events per packet, so the reader needs fewer calls to get
+    // them. The packets are never larger than what the reader asks for.
+    size_t sent = 0;
+    while (sent < numEvents) {
+        size_t count = numEvents - sent;
+        if (count > MAX_EVENTS_PER_PACKET) {
+            count = MAX_EVENTS_PER_PACKET;
+        }
+        ssize_t size = tube->write(events + sent, count * sizeof(ASensorEvent));
+        if (size < 0) {
+            return sent ? ssize_t(sent) : size;
+        } else if (size == 0) {
+            // no more space
+            break;
+        }
+        sent += count;
+    }
+    return sent;
+}
+
+ssize_t SensorEventQueue::fillReceiveBuffer()
+{
+    if (mRecBuffer == NULL) {
+        mRecBuffer = new ASensorEvent[MAX_RECEIVE_BUFFER_EVENT_COUNT];
+    }
+    mAvailable = 0;
+    mConsumed = 0;
+    // each read gets one packet, and must have room for a full one
+    while (MAX_RECEIVE_BUFFER_EVENT_COUNT - mAvailable >= MAX_EVENTS_PER_PACKET) {
+        ssize_t size = mSensorChannel->read(mRecBuffer + mAvailable,
+                MAX_EVENTS_PER_PACKET * sizeof(ASensorEvent));
+        if (size < 0) {
+            if (mAvailable) {
+                break;
+            }
+            return size;
+        } else if (size == 0) {
+            // no more messages
+            break;
+        }
+        mAvailable += size / sizeof(ASensorEvent);
+    }
+    return mAvailable;
+}
+
+bool SensorEventQueue::hasBufferedEvents() const
+{
+    return mConsumed < mAvailable;
 }
 
 ssize_t SensorEventQueue::read(ASensorEvent* events, size_t numEvents)
 {
-    return BitTube::recvObjects(mSensorChannel, events, numEvents);
+    if (mDirectChannel == 0) {
+        if (mConsumed == mAvailable) {
+            ssize_t err = fillReceiveBuffer();
+            if (err <= 0) {
+                return err;
+            }
+        }
+        size_t count = mAvailable - mConsumed;
+        if (count > numEvents) {
+            count = numEvents;
+        }
+        memcpy(events, mRecBuffer + mConsumed, count * sizeof(ASensorEvent));
+        mConsumed += count;
+        return count;
+    }
+
+    ssize_t count = mDirectChannel->read(events, numEvents);
+    if (count >= 0 && size_t(count) < numEvents) {
+        // the ring is empty: swallow the wake-up and ask for the next
+        // one, then pick up what was written in the meantime.
+        char wakeups[16];
+        while (mSensorChannel->read(wakeups, sizeof(wakeups)) > 0) {
+        }
+        mDirectChannel->rearm();
+        ssize_t more = mDirectChannel->read(events + count, numEvents - count);
+        if (more > 0) {
+            count += more;
+        }
+    }
+    return count;
 }
 
 sp<Looper> SensorEventQueue::getLooper() const
@@ -130,6 +209,20 @@ status_t SensorEventQueue::setEventRate(Sensor const* sensor, nsecs_t ns) const
     return mSensorEventConnection->setEventRate(sensor->getHandle(), ns);
 }
 
+status_t SensorEventQueue::setMaxReportLatency(Sensor const* sensor, nsecs_t ns) const {
+    return mSensorEventConnection->setMaxReportLatency(sensor->getHandle(), ns);
+}
+
+status_t SensorEventQueue::enableDirectChannel(size_t capacity) {
+    sp<SensorDirectChannel> channel(
+            mSensorEventConnection->createDirectChannel(capacity));
+    if (channel == 0) {
+        return NO_INIT;
+    }
+    mDirectChannel = channel;
+    return NO_ERROR;
+}
+
 // ----------------------------------------------------------------------------
 }; // namespace android
 
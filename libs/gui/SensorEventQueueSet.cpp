@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "Sensors"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include <gui/SensorEventQueue.h>
+#include <gui/SensorEventQueueSet.h>
+
+// ----------------------------------------------------------------------------
+namespace android {
+// ----------------------------------------------------------------------------
+
+// how many queues one epoll_wait() reports at most
+static const int MAX_EPOLL_EVENTS = 16;
+
+SensorEventQueueSet::SensorEventQueueSet()
+{
+    mEpollFd = epoll_create(MAX_EPOLL_EVENTS);
+    ALOGE_IF(mEpollFd < 0, "SensorEventQueueSet: epoll_create failed (%s)",
+            strerror(errno));
+}
+
+SensorEventQueueSet::~SensorEventQueueSet()
+{
+    if (mEpollFd >= 0)
+        close(mEpollFd);
+}
+
+status_t SensorEventQueueSet::initCheck() const
+{
+    return mEpollFd >= 0 ? NO_ERROR : NO_INIT;
+}
+
+status_t SensorEventQueueSet::add(const sp<SensorEventQueue>& queue)
+{
+    const int fd = queue->getFd();
+    Mutex::Autolock _l(mLock);
+    if (mQueues.indexOfKey(fd) >= 0)
+        return ALREADY_EXISTS;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        return -errno;
+    }
+    mQueues.add(fd, queue);
+    return NO_ERROR;
+}
+
+status_t SensorEventQueueSet::remove(const sp<SensorEventQueue>& queue)
+{
+    const int fd = queue->getFd();
+    Mutex::Autolock _l(mLock);
+    if (mQueues.removeItem(fd) < 0)
+        return NAME_NOT_FOUND;
+
+    epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, NULL);
+    return NO_ERROR;
+}
+
+ssize_t SensorEventQueueSet::wait(sp<SensorEventQueue>* ready, size_t count,
+        int timeoutMillis)
+{
+    if (mEpollFd < 0)
+        return NO_INIT;
+
+    // the queues that still have events from an earlier read don't need
+    // to wait, and neither do we if there are some.
+    size_t n = 0;
+    {
+        Mutex::Autolock _l(mLock);
+        for (size_t i=0 ; i<mQueues.size() && n<count ; i++) {
+            if (mQueues.valueAt(i)->hasBufferedEvents()) {
+                ready[n++] = mQueues.valueAt(i);
+            }
+        }
+    }
+    if (n == count)
+        return n;
+
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int numEvents;
+    do {
+        numEvents = epoll_wait(mEpollFd, events, MAX_EPOLL_EVENTS,
+                n ? 0 : timeoutMillis);
+    } while (numEvents < 0 && errno == EINTR);
+    if (numEvents < 0) {
+        return n ? ssize_t(n) : ssize_t(-errno);
+    }
+
+    Mutex::Autolock _l(mLock);
+    const size_t buffered = n;
+    for (int i=0 ; i<numEvents && n<count ; i++) {
+        ssize_t index = mQueues.indexOfKey(events[i].data.fd);
+        if (index < 0) {
+            // removed while we were waiting
+            continue;
+        }
+        const sp<SensorEventQueue>& queue(mQueues.valueAt(index));
+        bool listed = false;
+        for (size_t j=0 ; j<buffered ; j++) {
+            if (ready[j] == queue) {
+                listed = true;
+                break;
+            }
+        }
+        if (!listed) {
+            ready[n++] = queue;
+        }
+    }
+    return n;
+}
+
+// ----------------------------------------------------------------------------
+}; // namespace android
@@ -24,6 +24,7 @@
 #include <utils/Singleton.h>
 
 #include <binder/IBinder.h>
+#include <binder/IMemory.h>
 #include <binder/IServiceManager.h>
 
 #include <gui/ISensorServer.h>
@@ -88,7 +89,12 @@ status_t SensorManager::assertStateLocked() const {
         mDeathObserver = new DeathObserver(*const_cast<SensorManager *>(this));
         mSensorServer->asBinder()->linkToDeath(mDeathObserver);
 
-        mSensors = mSensorServer->getSensorList();
+        // read the list straight from the server's mapping when it has one,
+        // rather than having it copied in a Parcel
+        if (ISensorServer::readSensorList(mSensorServer->getSensorListMemory(),
+                &mSensors) != NO_ERROR) {
+            mSensors = mSensorServer->getSensorList();
+        }
         size_t count = mSensors.size();
         mSensorList = (Sensor const**)malloc(count * sizeof(Sensor*));
         for (size_t i=0 ; i<count ; i++) {
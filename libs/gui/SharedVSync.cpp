@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SharedVSync"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/futex.h>
+
+#include <cutils/ashmem.h>
+#include <cutils/atomic.h>
+#include <cutils/atomic-inline.h>
+#include <cutils/log.h>
+
+#include <binder/Parcel.h>
+
+#include <gui/SharedVSync.h>
+
+namespace android {
+// ----------------------------------------------------------------------------
+
+// The page is mapped in several processes, so these can't be the
+// FUTEX_PRIVATE_FLAG variants.
+static int futexWait(volatile int32_t* addr, int32_t value,
+        const struct timespec* timeout) {
+    return syscall(__NR_futex, addr, FUTEX_WAIT, value, timeout, NULL, 0);
+}
+
+static int futexWakeAll(volatile int32_t* addr) {
+    return syscall(__NR_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+SharedVSync::SharedVSync()
+    : mFd(-1), mBase(MAP_FAILED), mSlot(-1)
+{
+    memset(mSlotUsed, 0, sizeof(mSlotUsed));
+    mFd = ashmem_create_region("SharedVSync", sizeof(Page));
+    if (mFd < 0) {
+        ALOGE("SharedVSync: ashmem_create_region failed (%s)", strerror(errno));
+        return;
+    }
+    mBase = mmap(0, sizeof(Page), PROT_READ|PROT_WRITE, MAP_SHARED, mFd, 0);
+    if (mBase == MAP_FAILED) {
+        ALOGE("SharedVSync: mmap failed (%s)", strerror(errno));
+        return;
+    }
+    memset(mBase, 0, sizeof(Page));
+    // from now on the page can only be mapped read-only, so that a client
+    // can't mess up the other clients' vsync
+    ashmem_set_prot_region(mFd, PROT_READ);
+}
+
+SharedVSync::SharedVSync(const Parcel& data)
+    : mFd(-1), mBase(MAP_FAILED), mSlot(-1)
+{
+    memset(mSlotUsed, 0, sizeof(mSlotUsed));
+    map(data.readFileDescriptor(), PROT_READ);
+    int32_t slot = data.readInt32();
+    if (slot < 0 || slot >= NUM_SLOTS) {
+        ALOGE("SharedVSync(Parcel): invalid slot %d", slot);
+        return;
+    }
+    mSlot = slot;
+}
+
+SharedVSync::SharedVSync(const sp<SharedVSync>& writer, int32_t slot)
+    : mFd(-1), mBase(MAP_FAILED), mSlot(slot), mWriter(writer)
+{
+    memset(mSlotUsed, 0, sizeof(mSlotUsed));
+    map(writer->mFd, PROT_READ);
+}
+
+SharedVSync::~SharedVSync()
+{
+    if (mWriter != NULL)
+        mWriter->releaseSlot(mSlot);
+
+    if (mBase != MAP_FAILED)
+        munmap(mBase, sizeof(Page));
+
+    if (mFd >= 0)
+        close(mFd);
+}
+
+void SharedVSync::map(int fd, int prot)
+{
+    mFd = dup(fd);
+    if (mFd < 0) {
+        ALOGE("SharedVSync: can't dup filedescriptor (%s)", strerror(errno));
+        return;
+    }
+    mBase = mmap(0, sizeof(Page), prot, MAP_SHARED, mFd, 0);
+    if (mBase == MAP_FAILED) {
+        ALOGE("SharedVSync: mmap failed (%s)", strerror(errno));
+        return;
+    }
+}
+
+status_t SharedVSync::initCheck() const
+{
+    return (mBase != MAP_FAILED) ? NO_ERROR : NO_INIT;
+}
+
+sp<SharedVSync> SharedVSync::acquireSlot()
+{
+    if (mBase == MAP_FAILED)
+        return NULL;
+
+    Mutex::Autolock _l(mSlotLock);
+    for (int32_t i=0 ; i<NUM_SLOTS ; i++) {
+        if (!mSlotUsed[i]) {
+            sp<SharedVSync> handle(new SharedVSync(this, i));
+            if (handle->initCheck() != NO_ERROR) {
+                // the handle's destructor releases the slot
+                handle->mWriter.clear();
+                return NULL;
+            }
+            mSlotUsed[i] = true;
+            // nobody publishes to a free slot, start it over for its new
+            // reader
+            Page* const page = static_cast<Page*>(mBase);
+            memset(&page->slots[i], 0, sizeof(Slot));
+            return handle;
+        }
+    }
+    ALOGW("SharedVSync: all %d slots are taken", NUM_SLOTS);
+    return NULL;
+}
+
+void SharedVSync::releaseSlot(int32_t slot)
+{
+    Mutex::Autolock _l(mSlotLock);
+    mSlotUsed[slot] = false;
+}
+
+int32_t SharedVSync::getSlot() const
+{
+    return mSlot;
+}
+
+status_t SharedVSync::writeToParcel(Parcel* reply) const
+{
+    if (mBase == MAP_FAILED || mSlot < 0)
+        return NO_INIT;
+
+    status_t err = reply->writeDupFileDescriptor(mFd);
+    if (err != NO_ERROR)
+        return err;
+    return reply->writeInt32(mSlot);
+}
+
+void SharedVSync::publish(const DisplayEventReceiver::Event& event,
+        const Vector<int32_t>& slots)
+{
+    if (mBase == MAP_FAILED || slots.isEmpty())
+        return;
+
+    // there is a single writer, the EventThread
+    Page* const page = static_cast<Page*>(mBase);
+    const int32_t sequence = page->sequence;
+    android_atomic_release_store(sequence + 1, &page->sequence);
+    android_memory_barrier();
+    for (size_t i=0 ; i<slots.size() ; i++) {
+        Slot& slot(page->slots[slots[i]]);
+        slot.timestamp = event.header.timestamp;
+        slot.count = event.vsync.count;
+        slot.id = event.header.id;
+        slot.delivered++;
+    }
+    android_atomic_release_store(sequence + 2, &page->sequence);
+
+    android_atomic_inc(&page->futex);
+    futexWakeAll(&page->futex);
+}
+
+status_t SharedVSync::read(DisplayEventReceiver::Event* event,
+        uint32_t* delivered) const
+{
+    if (mBase == MAP_FAILED || mSlot < 0)
+        return NO_INIT;
+
+    Page const* const page = static_cast<Page const*>(mBase);
+    Slot const& slot(page->slots[mSlot]);
+    int32_t before, after;
+    do {
+        before = android_atomic_acquire_load(&page->sequence);
+        event->header.timestamp = slot.timestamp;
+        event->vsync.count = slot.count;
+        event->header.id = slot.id;
+        *delivered = slot.delivered;
+        android_memory_barrier();
+        after = android_atomic_acquire_load(&page->sequence);
+    } while ((before & 1) || before != after);
+
+    if (*delivered == 0) {
+        return NOT_ENOUGH_DATA;
+    }
+    event->header.type = DisplayEventReceiver::DISPLAY_EVENT_VSYNC;
+    return NO_ERROR;
+}
+
+status_t SharedVSync::wait(DisplayEventReceiver::Event* event,
+        uint32_t* delivered, nsecs_t timeout) const
+{
+    if (mBase == MAP_FAILED || mSlot < 0)
+        return NO_INIT;
+
+    Page* const page = static_cast<Page*>(mBase);
+    const nsecs_t deadline = systemTime(SYSTEM_TIME_MONOTONIC) + timeout;
+    while (true) {
+        // read the futex before the slot, a publish() in between makes
+        // the futexWait() below return right away
+        const int32_t value = android_atomic_acquire_load(&page->futex);
+        uint32_t current;
+        status_t err = read(event, &current);
+        if (err == NO_ERROR && current != *delivered) {
+            *delivered = current;
+            return NO_ERROR;
+        }
+
+        struct timespec ts;
+        struct timespec* tsp = NULL;
+        if (timeout >= 0) {
+            const nsecs_t remaining = deadline - systemTime(SYSTEM_TIME_MONOTONIC);
+            if (remaining <= 0) {
+                return TIMED_OUT;
+            }
+            ts.tv_sec = remaining / 1000000000;
+            ts.tv_nsec = remaining % 1000000000;
+            tsp = &ts;
+        }
+        if (futexWait(&page->futex, value, tsp) < 0 &&
+                errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) {
+            return -errno;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+}; // namespace android
@@ -75,6 +75,9 @@ Surface::Surface(
     mUserHeight = 0;
     mTransformHint = 0;
     mConsumerRunningBehind = false;
+    mQueuesToWindowComposer = -1;
+    mLastQueuedFrameNumber = 0;
+    mDequeuedSlots = 0;
     mConnectedToCpu = false;
 #ifdef SURFACE_SKIP_FIRST_DEQUEUE
     mDequeuedOnce = false;
@@ -184,35 +187,95 @@ int Surface::setSwapInterval(int interval) {
     return res;
 }
 
+void Surface::allocateBuffers() {
+    uint32_t reqW, reqH, reqFormat, reqUsage;
+    {
+        Mutex::Autolock lock(mMutex);
+        reqW = mReqWidth ? mReqWidth : mUserWidth;
+        reqH = mReqHeight ? mReqHeight : mUserHeight;
+        reqFormat = mReqFormat;
+        reqUsage = mReqUsage;
+    }
+    mGraphicBufferProducer->allocateBuffers(reqW, reqH, reqFormat, reqUsage);
+}
+
+uint64_t Surface::getLastQueuedFrameNumber() const {
+    Mutex::Autolock lock(mMutex);
+    return mLastQueuedFrameNumber;
+}
+
+status_t Surface::getFrameTimestamps(uint64_t frameNumber,
+        IGraphicBufferProducer::FrameTimestamps* outTimestamps) const {
+    ATRACE_CALL();
+    return mGraphicBufferProducer->getFrameTimestamps(frameNumber,
+            outTimestamps);
+}
+
 int Surface::dequeueBuffer(android_native_buffer_t** buffer,
         int* fenceFd) {
     ATRACE_CALL();
     ALOGV("Surface::dequeueBuffer");
-    Mutex::Autolock lock(mMutex);
+    int reqW, reqH;
+    uint32_t reqFormat, reqUsage;
+    {
+        Mutex::Autolock lock(mMutex);
+        reqW = mReqWidth ? mReqWidth : mUserWidth;
+        reqH = mReqHeight ? mReqHeight : mUserHeight;
+        reqFormat = mReqFormat;
+        reqUsage = mReqUsage;
+    }
+
+    // this blocks until a buffer is free, don't hold up the other
+    // threads using this Surface in the meantime
     int buf = -1;
-    int reqW = mReqWidth ? mReqWidth : mUserWidth;
-    int reqH = mReqHeight ? mReqHeight : mUserHeight;
     sp<Fence> fence;
     status_t result = mGraphicBufferProducer->dequeueBuffer(&buf, &fence,
-            reqW, reqH, mReqFormat, mReqUsage);
+            reqW, reqH, reqFormat, reqUsage);
     if (result < 0) {
         ALOGV("dequeueBuffer: IGraphicBufferProducer::dequeueBuffer(%d, %d, %d, %d)"
-             "failed: %d", mReqWidth, mReqHeight, mReqFormat, mReqUsage,
-             result);
+             "failed: %d", reqW, reqH, reqFormat, reqUsage, result);
         return result;
     }
+
+    Mutex::Autolock lock(mMutex);
     sp<GraphicBuffer>& gbuf(mSlots[buf].buffer);
     if (result & IGraphicBufferProducer::RELEASE_ALL_BUFFERS) {
         freeAllBuffers();
     }
 
-    if ((result & IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) || gbuf == 0) {
+    bool fetched = false;
+    if (gbuf == 0) {
+        // the buffer may have been allocated ahead of time (see
+        // allocateBuffers()), get the ones of the other slots we don't know
+        // yet along with it
+        uint32_t mask = 0;
+        for (int i = 0; i < NUM_BUFFER_SLOTS; i++) {
+            if (mSlots[i].buffer == 0) {
+                mask |= 1u << i;
+            }
+        }
+        sp<GraphicBuffer> buffers[NUM_BUFFER_SLOTS];
+        if (mGraphicBufferProducer->requestBuffers(&mask, buffers) == NO_ERROR) {
+            for (int i = 0; i < NUM_BUFFER_SLOTS; i++) {
+                if (mask & (1u << i)) {
+                    mSlots[i].buffer = buffers[i];
+                    mSlots[i].dirtyRegion.set(
+                            Rect(buffers[i]->width, buffers[i]->height));
+                }
+            }
+            fetched = gbuf != 0;
+        }
+    }
+
+    if (((result & IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) &&
+            !fetched) || gbuf == 0) {
         result = mGraphicBufferProducer->requestBuffer(buf, &gbuf);
         if (result != NO_ERROR) {
             ALOGE("dequeueBuffer: IGraphicBufferProducer::requestBuffer failed: %d",
                     result);
             return result;
         }
+        mSlots[buf].dirtyRegion.set(Rect(gbuf->width, gbuf->height));
     }
 
     if ((fence != NULL) && fence->isValid()) {
@@ -227,6 +290,7 @@ int Surface::dequeueBuffer(android_native_buffer_t** buffer,
         *fenceFd = -1;
     }
 
+    mDequeuedSlots |= 1u << buf;
     *buffer = gbuf.get();
 #ifdef SURFACE_SKIP_FIRST_DEQUEUE
     if (!mDequeuedOnce) mDequeuedOnce = true;
@@ -243,6 +307,7 @@ int Surface::cancelBuffer(android_native_buffer_t* buffer,
     if (i < 0) {
         return i;
     }
+    mDequeuedSlots &= ~(1u << i);
     sp<Fence> fence(fenceFd >= 0 ? new Fence(fenceFd) : Fence::NO_FENCE);
     mGraphicBufferProducer->cancelBuffer(i, fence);
     return OK;
@@ -250,7 +315,14 @@ int Surface::cancelBuffer(android_native_buffer_t* buffer,
 
 int Surface::getSlotFromBufferLocked(
         android_native_buffer_t* buffer) const {
-    bool dumpedState = false;
+    // queued and canceled buffers were dequeued through us, and only a
+    // few are at a time: check those by address first
+    for (uint32_t mask = mDequeuedSlots; mask; mask &= mask - 1) {
+        const int i = __builtin_ctz(mask);
+        if (mSlots[i].buffer.get() == buffer) {
+            return i;
+        }
+    }
     for (int i = 0; i < NUM_BUFFER_SLOTS; i++) {
         if (mSlots[i].buffer != NULL &&
                 mSlots[i].buffer->handle == buffer->handle) {
@@ -283,7 +355,7 @@ int Surface::queueBuffer(android_native_buffer_t* buffer, int fenceFd) {
     if (i < 0) {
         return i;
     }
-
+    mDequeuedSlots &= ~(1u << i);
 
     // Make sure the crop rectangle is entirely inside the buffer.
     Rect crop;
@@ -302,6 +374,7 @@ int Surface::queueBuffer(android_native_buffer_t* buffer, int fenceFd) {
             &numPendingBuffers);
 
     mConsumerRunningBehind = (numPendingBuffers >= 2);
+    mLastQueuedFrameNumber = (err == OK) ? output.getFrameNumber() : 0;
 
     return err;
 }
@@ -325,13 +398,14 @@ int Surface::query(int what, int* value) const {
                 } else
 #endif
                 {
-                    sp<ISurfaceComposer> composer(
-                            ComposerService::getComposerService());
-                    if (composer->authenticateSurfaceTexture(mGraphicBufferProducer)) {
-                        *value = 1;
-                    } else {
-                        *value = 0;
+                    if (mQueuesToWindowComposer < 0) {
+                        sp<ISurfaceComposer> composer(
+                                ComposerService::getComposerService());
+                        mQueuesToWindowComposer = composer->
+                                authenticateSurfaceTexture(mGraphicBufferProducer)
+                                ? 1 : 0;
                     }
+                    *value = mQueuesToWindowComposer;
                 }
                 return NO_ERROR;
             }
@@ -722,6 +796,7 @@ void Surface::freeAllBuffers() {
     for (int i = 0; i < NUM_BUFFER_SLOTS; i++) {
         mSlots[i].buffer = 0;
     }
+    mDequeuedSlots = 0;
 }
 
 // ----------------------------------------------------------------------
@@ -837,34 +912,36 @@ status_t Surface::lock(
                 backBuffer->height == frontBuffer->height &&
                 backBuffer->format == frontBuffer->format);
 
-        if (canCopyBack) {
-            // copy the area that is invalid and not repainted this round
-            const Region copyback(mDirtyRegion.subtract(newDirtyRegion));
-            if (!copyback.isEmpty())
-                copyBlt(backBuffer, frontBuffer, copyback);
-        } else {
-            // if we can't copy-back anything, modify the user's dirty
-            // region to make sure they redraw the whole buffer
-            newDirtyRegion.set(bounds);
-            mDirtyRegion.clear();
-            Mutex::Autolock lock(mMutex);
-            for (size_t i=0 ; i<NUM_BUFFER_SLOTS ; i++) {
-                mSlots[i].dirtyRegion.clear();
-            }
-        }
-
-
+        Region copyback;
         { // scope for the lock
             Mutex::Autolock lock(mMutex);
             int backBufferSlot(getSlotFromBufferLocked(backBuffer.get()));
-            if (backBufferSlot >= 0) {
-                Region& dirtyRegion(mSlots[backBufferSlot].dirtyRegion);
-                mDirtyRegion.subtract(dirtyRegion);
-                dirtyRegion = newDirtyRegion;
+            if (!canCopyBack || backBufferSlot < 0) {
+                // if we can't copy-back anything, modify the user's dirty
+                // region to make sure they redraw the whole buffer
+                newDirtyRegion.set(bounds);
+            } else {
+                // only what changed since this buffer was last posted is
+                // out of date, copy what isn't repainted this round
+                copyback = mSlots[backBufferSlot].dirtyRegion.subtract(
+                        newDirtyRegion);
             }
+
+            // this frame becomes the reference, what's painted now is out
+            // of date in all the other buffers
+            for (int i=0 ; i<NUM_BUFFER_SLOTS ; i++) {
+                if (i == backBufferSlot) {
+                    mSlots[i].dirtyRegion.clear();
+                } else if (mSlots[i].buffer != 0) {
+                    mSlots[i].dirtyRegion.orSelf(newDirtyRegion);
+                }
+            }
+        }
+
+        if (!copyback.isEmpty()) {
+            copyBlt(backBuffer, frontBuffer, copyback);
         }
 
-        mDirtyRegion.orSelf(newDirtyRegion);
         if (inOutDirtyBounds) {
             *inOutDirtyBounds = newDirtyRegion.getBounds();
         }
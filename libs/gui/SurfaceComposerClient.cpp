@@ -16,6 +16,8 @@
 
 #define LOG_TAG "SurfaceComposerClient"
 
+#include <errno.h>
+#include <poll.h>
 #include <stdint.h>
 #include <sys/types.h>
 
@@ -27,11 +29,13 @@
 #include <utils/threads.h>
 
 #include <binder/IMemory.h>
+#include <binder/IPCThreadState.h>
 #include <binder/IServiceManager.h>
 
 #include <ui/DisplayInfo.h>
 
 #include <gui/CpuConsumer.h>
+#include <gui/DisplayEventReceiver.h>
 #include <gui/IGraphicBufferProducer.h>
 #include <gui/ISurfaceComposer.h>
 #include <gui/ISurfaceComposerClient.h>
@@ -108,9 +112,21 @@ int compare_type(const DisplayState& lhs, const DisplayState& rhs) {
     return compare_type(lhs.token, rhs.token);
 }
 
+// Sends the frame-aligned transactions when the next vsync comes.
+class TransactionFlusher : public Thread
+{
+    DisplayEventReceiver mReceiver;
+    virtual bool threadLoop();
+public:
+    TransactionFlusher() : Thread(false) { }
+    status_t start();
+    void requestFlush() { mReceiver.requestNextVsync(); }
+};
+
 class Composer : public Singleton<Composer>
 {
     friend class Singleton<Composer>;
+    friend class TransactionFlusher;
 
     mutable Mutex               mLock;
     SortedVector<ComposerState> mComposerStates;
@@ -118,15 +134,20 @@ class Composer : public Singleton<Composer>
     uint32_t                    mForceSynchronous;
     uint32_t                    mTransactionNestCount;
     bool                        mAnimation;
+    bool                        mFrameAligned;
+    bool                        mFlushPending;
+    sp<TransactionFlusher>      mFlusher;
 
     Composer() : Singleton<Composer>(),
         mForceSynchronous(0), mTransactionNestCount(0),
-        mAnimation(false)
+        mAnimation(false), mFrameAligned(false), mFlushPending(false)
     { }
 
     void openGlobalTransactionImpl();
     void closeGlobalTransactionImpl(bool synchronous);
     void setAnimationTransactionImpl();
+    void setFrameAlignedTransactionsImpl(bool enabled);
+    void flushFrameAlignedTransactionImpl();
 
     layer_state_t* getLayerStateLocked(
             const sp<SurfaceComposerClient>& client, const sp<IBinder>& id);
@@ -177,6 +198,10 @@ public:
     static void closeGlobalTransaction(bool synchronous) {
         Composer::getInstance().closeGlobalTransactionImpl(synchronous);
     }
+
+    static void setFrameAlignedTransactions(bool enabled) {
+        Composer::getInstance().setFrameAlignedTransactionsImpl(enabled);
+    }
 };
 
 ANDROID_SINGLETON_STATIC_INSTANCE(Composer);
@@ -216,6 +241,17 @@ void Composer::closeGlobalTransactionImpl(bool synchronous) {
             return;
         }
 
+        if (mFrameAligned && !mForceSynchronous && !mAnimation) {
+            // nobody waits for this transaction, send it with whatever
+            // else gets closed before the next vsync
+            if (!mFlushPending) {
+                mFlushPending = true;
+                mFlusher->requestFlush();
+            }
+            return;
+        }
+        mFlushPending = false;
+
         transaction = mComposerStates;
         mComposerStates.clear();
 
@@ -241,6 +277,95 @@ void Composer::setAnimationTransactionImpl() {
     mAnimation = true;
 }
 
+void Composer::setFrameAlignedTransactionsImpl(bool enabled) {
+    { // scope for the lock
+        Mutex::Autolock _l(mLock);
+        if (enabled && mFlusher == 0) {
+            sp<TransactionFlusher> flusher(new TransactionFlusher());
+            if (flusher->start() != NO_ERROR) {
+                ALOGE("frame-aligned transactions not available");
+                return;
+            }
+            mFlusher = flusher;
+        }
+        mFrameAligned = enabled;
+        if (enabled || !mFlushPending) {
+            return;
+        }
+    }
+
+    // send what was waiting for the next vsync right away
+    flushFrameAlignedTransactionImpl();
+}
+
+void Composer::flushFrameAlignedTransactionImpl() {
+    sp<ISurfaceComposer> sm(ComposerService::getComposerService());
+
+    Vector<ComposerState> transaction;
+    Vector<DisplayState> displayTransaction;
+
+    { // scope for the lock
+        Mutex::Autolock _l(mLock);
+        if (!mFlushPending) {
+            // already sent with a synchronous or animation transaction
+            return;
+        }
+        mFlushPending = false;
+        if (mTransactionNestCount) {
+            // a transaction is open, everything will be sent (or a new
+            // flush requested) when it's closed
+            return;
+        }
+
+        transaction = mComposerStates;
+        mComposerStates.clear();
+
+        displayTransaction = mDisplayStates;
+        mDisplayStates.clear();
+    }
+
+    sm->setTransactionState(transaction, displayTransaction, 0);
+}
+
+// ---------------------------------------------------------------------------
+
+status_t TransactionFlusher::start() {
+    status_t err = mReceiver.initCheck();
+    if (err != NO_ERROR) {
+        return err;
+    }
+    return run("TransactionFlusher", PRIORITY_URGENT_DISPLAY);
+}
+
+bool TransactionFlusher::threadLoop() {
+    struct pollfd fds;
+    fds.fd = mReceiver.getFd();
+    fds.events = POLLIN;
+    fds.revents = 0;
+    if (poll(&fds, 1, -1) < 0) {
+        if (errno == EINTR) {
+            return true;
+        }
+        ALOGE("TransactionFlusher: poll failed (%s)", strerror(errno));
+        return false;
+    }
+
+    bool vsync = false;
+    ssize_t n;
+    DisplayEventReceiver::Event buffer[8];
+    while ((n = mReceiver.getEvents(buffer, 8)) > 0) {
+        for (ssize_t i=0 ; i<n ; i++) {
+            if (buffer[i].header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC) {
+                vsync = true;
+            }
+        }
+    }
+    if (vsync) {
+        Composer::getInstance().flushFrameAlignedTransactionImpl();
+    }
+    return true;
+}
+
 layer_state_t* Composer::getLayerStateLocked(
         const sp<SurfaceComposerClient>& client, const sp<IBinder>& id) {
 
@@ -518,6 +643,29 @@ sp<SurfaceControl> SurfaceComposerClient::createSurface(
     return sur;
 }
 
+status_t SurfaceComposerClient::createSurfaces(
+        const Vector<ISurfaceComposerClient::SurfaceSpec>& specs,
+        Vector< sp<SurfaceControl> >* surfaces)
+{
+    surfaces->clear();
+    if (mStatus != NO_ERROR)
+        return mStatus;
+    Vector<ISurfaceComposerClient::CreatedSurface> created;
+    status_t err = mClient->createSurfaces(specs, &created);
+    ALOGE_IF(err, "SurfaceComposerClient::createSurfaces error %s", strerror(-err));
+    if (err == NO_ERROR) {
+        surfaces->setCapacity(created.size());
+        for (size_t i=0 ; i<created.size() ; i++) {
+            const ISurfaceComposerClient::CreatedSurface& c(created[i]);
+            ALOGE_IF(c.result, "SurfaceComposerClient::createSurfaces error %s "
+                    "for %s", strerror(-c.result), specs[i].name.string());
+            surfaces->add(c.result == NO_ERROR ?
+                    new SurfaceControl(this, c.handle, c.gbp) : NULL);
+        }
+    }
+    return err;
+}
+
 sp<IBinder> SurfaceComposerClient::createDisplay(const String8& displayName,
         bool secure) {
     return Composer::getInstance().createDisplay(displayName, secure);
@@ -534,6 +682,33 @@ status_t SurfaceComposerClient::destroySurface(const sp<IBinder>& sid) {
     return err;
 }
 
+status_t SurfaceComposerClient::destroySurfaces(
+        const Vector< sp<SurfaceControl> >& surfaces) {
+    if (mStatus != NO_ERROR)
+        return mStatus;
+    Vector< sp<IBinder> > handles;
+    handles.setCapacity(surfaces.size());
+    for (size_t i=0 ; i<surfaces.size() ; i++) {
+        const sp<SurfaceControl>& control(surfaces[i]);
+        if (control != NULL && control->isValid() && control->mClient == this) {
+            handles.add(control->mHandle);
+        }
+    }
+    status_t err = handles.isEmpty() ? status_t(NO_ERROR) :
+            mClient->destroySurfaces(handles);
+    for (size_t i=0 ; i<surfaces.size() ; i++) {
+        const sp<SurfaceControl>& control(surfaces[i]);
+        if (control != NULL && control->mClient == this) {
+            // what SurfaceControl::destroy() does, without its IPCs
+            control->mClient.clear();
+            control->mHandle.clear();
+            control->mGraphicBufferProducer.clear();
+        }
+    }
+    IPCThreadState::self()->flushCommands();
+    return err;
+}
+
 inline Composer& SurfaceComposerClient::getComposer() {
     return mComposer;
 }
@@ -552,6 +727,10 @@ void SurfaceComposerClient::setAnimationTransaction() {
     Composer::setAnimationTransaction();
 }
 
+void SurfaceComposerClient::setFrameAlignedTransactions(bool enabled) {
+    Composer::setFrameAlignedTransactions(enabled);
+}
+
 // ----------------------------------------------------------------------------
 
 status_t SurfaceComposerClient::setCrop(const sp<IBinder>& id, const Rect& crop) {
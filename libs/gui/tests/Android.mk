@@ -7,8 +7,14 @@ LOCAL_MODULE := libgui_test
 LOCAL_MODULE_TAGS := tests
 
 LOCAL_SRC_FILES := \
+    BitTube_test.cpp \
+    BufferQueueTee_test.cpp \
     BufferQueue_test.cpp \
     CpuConsumer_test.cpp \
+    MetadataBufferConsumer_test.cpp \
+    SensorDirectChannel_test.cpp \
+    SensorEventQueue_test.cpp \
+    SharedVSync_test.cpp \
     SurfaceTextureClient_test.cpp \
     SurfaceTexture_test.cpp \
     Surface_test.cpp \
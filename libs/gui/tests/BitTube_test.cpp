@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "BitTube_test"
+
+#include <gtest/gtest.h>
+
+#include <gui/BitTube.h>
+
+namespace android {
+
+struct Object {
+    uint32_t value;
+    uint8_t padding[60];
+};
+
+static void fill(Object* objects, size_t count, uint32_t first) {
+    for (size_t i=0 ; i<count ; i++) {
+        memset(&objects[i], 0, sizeof(Object));
+        objects[i].value = first + i;
+    }
+}
+
+TEST(BitTubeTest, SendsAndReceivesObjectsInOrder) {
+    // each packet costs far more than its size, the default only fits a few
+    sp<BitTube> tube(new BitTube(16 * BitTube::DEFAULT_SOCKET_BUFFER_SIZE));
+    ASSERT_EQ(NO_ERROR, tube->initCheck());
+
+    Object sent[50];
+    fill(sent, 50, 1000);
+    ASSERT_EQ(10, BitTube::sendObjects(tube, sent, 10));
+    ASSERT_EQ(20, BitTube::sendObjects(tube, sent + 10, 20));
+
+    // more than a batch of the kernel calls, and more than was sent
+    Object received[50];
+    ASSERT_EQ(30, BitTube::recvObjects(tube, received, 50));
+    for (size_t i=0 ; i<30 ; i++) {
+        EXPECT_EQ(1000 + i, received[i].value);
+    }
+    EXPECT_EQ(0, BitTube::recvObjects(tube, received, 50));
+}
+
+TEST(BitTubeTest, ReceivesNoMoreThanAskedFor) {
+    sp<BitTube> tube(new BitTube());
+    Object sent[8];
+    fill(sent, 8, 0);
+    ASSERT_EQ(8, BitTube::sendObjects(tube, sent, 8));
+
+    Object received[8];
+    ASSERT_EQ(3, BitTube::recvObjects(tube, received, 3));
+    ASSERT_EQ(5, BitTube::recvObjects(tube, received + 3, 8));
+    for (size_t i=0 ; i<8 ; i++) {
+        EXPECT_EQ(i, received[i].value);
+    }
+}
+
+TEST(BitTubeTest, ReportsHowManyObjectsFitWhenFull) {
+    sp<BitTube> small(new BitTube());
+    sp<BitTube> large(new BitTube(16 * BitTube::DEFAULT_SOCKET_BUFFER_SIZE));
+
+    Object sent[1000];
+    fill(sent, 1000, 0);
+    ssize_t smallSent = BitTube::sendObjects(small, sent, 1000);
+    ssize_t largeSent = BitTube::sendObjects(large, sent, 1000);
+    ASSERT_GT(smallSent, 0);
+    ASSERT_LT(smallSent, 1000);
+    EXPECT_GT(largeSent, smallSent);
+
+    // nothing more fits, and what was counted as sent arrives
+    EXPECT_EQ(-EAGAIN, BitTube::sendObjects(small, sent, 1));
+    Object received[1000];
+    EXPECT_EQ(smallSent, BitTube::recvObjects(small, received, 1000));
+    EXPECT_EQ(smallSent - 1, ssize_t(received[smallSent - 1].value));
+}
+
+}; // namespace android
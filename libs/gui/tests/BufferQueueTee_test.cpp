@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "BufferQueueTee_test"
+//#define LOG_NDEBUG 0
+
+#include <gtest/gtest.h>
+
+#include <gui/BufferQueueTee.h>
+#include <ui/GraphicBuffer.h>
+
+namespace android {
+
+class BufferQueueTeeTest : public ::testing::Test {
+protected:
+
+    virtual void SetUp() {
+        const ::testing::TestInfo* const testInfo =
+            ::testing::UnitTest::GetInstance()->current_test_info();
+        ALOGV("Begin test: %s.%s", testInfo->test_case_name(),
+                testInfo->name());
+
+        mTee = new BufferQueueTee(GRALLOC_USAGE_SW_READ_OFTEN, 3);
+        mTee->setName(String8("BufferQueueTeeTest"));
+        mProducer = mTee->getProducerInterface();
+        IGraphicBufferProducer::QueueBufferOutput qbo;
+        ASSERT_EQ(OK, mProducer->connect(NATIVE_WINDOW_API_CPU, &qbo));
+        ASSERT_EQ(OK, mProducer->setBufferCount(6));
+    }
+
+    virtual void TearDown() {
+        mProducer.clear();
+        mTee.clear();
+
+        const ::testing::TestInfo* const testInfo =
+            ::testing::UnitTest::GetInstance()->current_test_info();
+        ALOGV("End test:   %s.%s", testInfo->test_case_name(),
+                testInfo->name());
+    }
+
+    // Queues a buffer, returning its slot.
+    int queueBuffer(int64_t timestamp) {
+        int slot;
+        sp<Fence> fence;
+        status_t err = mProducer->dequeueBuffer(&slot, &fence, 16, 16,
+                HAL_PIXEL_FORMAT_RGBA_8888, 0);
+        EXPECT_LE(0, err);
+        sp<GraphicBuffer> buffer;
+        EXPECT_EQ(OK, mProducer->requestBuffer(slot, &buffer));
+        IGraphicBufferProducer::QueueBufferInput qbi(timestamp, Rect(0, 0, 16, 16),
+                NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+        IGraphicBufferProducer::QueueBufferOutput qbo;
+        EXPECT_EQ(OK, mProducer->queueBuffer(slot, qbi, &qbo));
+        return slot;
+    }
+
+    sp<BufferQueueTee> mTee;
+    sp<IGraphicBufferProducer> mProducer;
+};
+
+struct CountingListener : public BufferQueueTee::FrameAvailableListener {
+    CountingListener() : count(0) {}
+    virtual void onFrameAvailable() { count++; }
+    int count;
+};
+
+TEST_F(BufferQueueTeeTest, EveryOutputGetsTheSameBuffer) {
+    sp<BufferQueueTee::Output> a(mTee->addOutput(String8("a"), 1, 0));
+    sp<BufferQueueTee::Output> b(mTee->addOutput(String8("b"), 1, 0));
+    sp<CountingListener> listener(new CountingListener);
+    b->setFrameAvailableListener(listener);
+
+    queueBuffer(1234);
+    EXPECT_EQ(1, listener->count);
+
+    BufferQueueTee::BufferItem itemA, itemB;
+    ASSERT_EQ(OK, a->acquireBuffer(&itemA));
+    ASSERT_EQ(OK, b->acquireBuffer(&itemB));
+    EXPECT_EQ(itemA.mBuf, itemB.mBuf);
+    EXPECT_EQ(1234, itemA.mTimestamp);
+    ASSERT_TRUE(itemA.mGraphicBuffer != NULL);
+    EXPECT_EQ(itemA.mGraphicBuffer->handle, itemB.mGraphicBuffer->handle);
+
+    EXPECT_EQ(int(BufferQueueTee::NO_BUFFER_AVAILABLE), a->acquireBuffer(&itemA));
+    EXPECT_EQ(OK, a->releaseBuffer(itemA));
+    EXPECT_EQ(BAD_VALUE, a->releaseBuffer(itemA));
+    EXPECT_EQ(OK, b->releaseBuffer(itemB));
+}
+
+TEST_F(BufferQueueTeeTest, SlotIsFreedOnlyOnceAllOutputsRelease) {
+    sp<BufferQueueTee::Output> a(mTee->addOutput(String8("a"), 1, 0));
+    sp<BufferQueueTee::Output> b(mTee->addOutput(String8("b"), 1, 0));
+
+    int slot = queueBuffer(1);
+    BufferQueueTee::BufferItem itemA, itemB;
+    ASSERT_EQ(OK, a->acquireBuffer(&itemA));
+    ASSERT_EQ(OK, b->acquireBuffer(&itemB));
+    ASSERT_EQ(OK, a->releaseBuffer(itemA));
+
+    // b still holds the buffer, so the producer can't get it back
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NE(slot, queueBuffer(2 + i));
+        ASSERT_EQ(OK, a->acquireBuffer(&itemA));
+        ASSERT_EQ(OK, a->releaseBuffer(itemA));
+    }
+
+    ASSERT_EQ(OK, b->releaseBuffer(itemB));
+    // b's pending buffers go away with it
+    mTee->removeOutput(b);
+    EXPECT_EQ(NO_INIT, b->acquireBuffer(&itemB));
+
+    bool reused = false;
+    for (int i = 0; i < 6 && !reused; i++) {
+        reused = queueBuffer(10 + i) == slot;
+        ASSERT_EQ(OK, a->acquireBuffer(&itemA));
+        ASSERT_EQ(OK, a->releaseBuffer(itemA));
+    }
+    EXPECT_TRUE(reused);
+}
+
+TEST_F(BufferQueueTeeTest, SlowOutputDropsItsOldestBuffers) {
+    sp<BufferQueueTee::Output> fast(mTee->addOutput(String8("fast"), 1, 0));
+    sp<BufferQueueTee::Output> slow(mTee->addOutput(String8("slow"), 1, 1));
+
+    BufferQueueTee::BufferItem item;
+    for (int i = 0; i < 3; i++) {
+        queueBuffer(100 + i);
+        ASSERT_EQ(OK, fast->acquireBuffer(&item));
+        EXPECT_EQ(100 + i, item.mTimestamp);
+        ASSERT_EQ(OK, fast->releaseBuffer(item));
+    }
+
+    // only the latest buffer is left for the slow output
+    ASSERT_EQ(OK, slow->acquireBuffer(&item));
+    EXPECT_EQ(102, item.mTimestamp);
+    EXPECT_EQ(int(BufferQueueTee::NO_BUFFER_AVAILABLE), slow->acquireBuffer(&item));
+    ASSERT_EQ(OK, slow->releaseBuffer(item));
+}
+
+TEST_F(BufferQueueTeeTest, OutputCannotAcquirePastItsMax) {
+    sp<BufferQueueTee::Output> a(mTee->addOutput(String8("a"), 1, 0));
+
+    queueBuffer(1);
+    queueBuffer(2);
+    BufferQueueTee::BufferItem first, second;
+    ASSERT_EQ(OK, a->acquireBuffer(&first));
+    EXPECT_EQ(INVALID_OPERATION, a->acquireBuffer(&second));
+    ASSERT_EQ(OK, a->releaseBuffer(first));
+    ASSERT_EQ(OK, a->acquireBuffer(&second));
+    EXPECT_EQ(2, second.mTimestamp);
+    ASSERT_EQ(OK, a->releaseBuffer(second));
+}
+
+TEST_F(BufferQueueTeeTest, ReleaseAfterTheSlotWasReused) {
+    sp<BufferQueueTee::Output> a(mTee->addOutput(String8("a"), 2, 0));
+
+    queueBuffer(1);
+    BufferQueueTee::BufferItem first, second;
+    ASSERT_EQ(OK, a->acquireBuffer(&first));
+
+    // frees every slot, the acquired one included, while the output still
+    // holds its buffer
+    ASSERT_EQ(OK, mProducer->setBufferCount(6));
+    queueBuffer(2);
+    ASSERT_EQ(OK, a->acquireBuffer(&second));
+    EXPECT_EQ(2, second.mTimestamp);
+
+    // releasing the old buffer leaves the new one acquired
+    ASSERT_EQ(OK, a->releaseBuffer(first));
+    EXPECT_EQ(BAD_VALUE, a->releaseBuffer(first));
+    ASSERT_EQ(OK, a->releaseBuffer(second));
+
+    for (int i = 0; i < 6; i++) {
+        queueBuffer(10 + i);
+        ASSERT_EQ(OK, a->acquireBuffer(&first));
+        EXPECT_EQ(10 + i, first.mTimestamp);
+        ASSERT_EQ(OK, a->releaseBuffer(first));
+    }
+}
+
+} // namespace android
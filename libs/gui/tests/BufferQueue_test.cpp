@@ -60,6 +60,32 @@ struct DummyConsumer : public BufferQueue::ConsumerListener {
     virtual void onBuffersReleased() {}
 };
 
+struct CountingConsumer : public BufferQueue::ConsumerListener {
+    CountingConsumer() : mFramesAvailable(0), mFramesDropped(0) {}
+    virtual void onFrameAvailable() { mFramesAvailable++; }
+    virtual void onBuffersReleased() {}
+    virtual void onFrameDropped() { mFramesDropped++; }
+    int mFramesAvailable;
+    int mFramesDropped;
+};
+
+// queues a 1x1 buffer with the given timestamp in synchronous mode
+static void queueFrame(const sp<BufferQueue>& bq, int64_t timestamp) {
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> buf;
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    IGraphicBufferProducer::QueueBufferInput qbi(timestamp, Rect(0, 0, 1, 1),
+            NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+    status_t result = bq->dequeueBuffer(&slot, &fence, 1, 1, 0,
+            GRALLOC_USAGE_SW_READ_OFTEN);
+    ASSERT_LE(0, result);
+    if (result & IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) {
+        ASSERT_EQ(OK, bq->requestBuffer(slot, &buf));
+    }
+    ASSERT_EQ(OK, bq->queueBuffer(slot, qbi, &qbo));
+}
+
 TEST_F(BufferQueueTest, AcquireBuffer_ExceedsMaxAcquireCount_Fails) {
     sp<DummyConsumer> dc(new DummyConsumer);
     mBQ->consumerConnect(dc);
@@ -114,4 +140,279 @@ TEST_F(BufferQueueTest, SetMaxAcquiredBufferCountWithLegalValues_Succeeds) {
             BufferQueue::MAX_MAX_ACQUIRED_BUFFERS));
 }
 
+TEST_F(BufferQueueTest, AcquireBuffer_WithPresentTime_SchedulesBuffers) {
+    sp<DummyConsumer> dc(new DummyConsumer);
+    mBQ->consumerConnect(dc);
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    mBQ->connect(NATIVE_WINDOW_API_CPU, &qbo);
+    mBQ->setBufferCount(5);
+    ASSERT_EQ(OK, mBQ->setSynchronousMode(true));
+
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> buf;
+    BufferQueue::BufferItem item;
+
+    for (int i = 1; i <= 3; i++) {
+        IGraphicBufferProducer::QueueBufferInput qbi(i * 1000, Rect(0, 0, 1, 1),
+                NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+        ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+                mBQ->dequeueBuffer(&slot, &fence, 1, 1, 0,
+                    GRALLOC_USAGE_SW_READ_OFTEN));
+        ASSERT_EQ(OK, mBQ->requestBuffer(slot, &buf));
+        ASSERT_EQ(OK, mBQ->queueBuffer(slot, qbi, &qbo));
+    }
+
+    // the oldest buffer is for later
+    ASSERT_EQ(BufferQueue::PRESENT_LATER, mBQ->acquireBuffer(&item, 500));
+
+    // the first buffer would be replaced before it is presented
+    ASSERT_EQ(OK, mBQ->acquireBuffer(&item, 2500));
+    EXPECT_EQ(2000, item.mTimestamp);
+    EXPECT_EQ(1U, item.mSkipped);
+    EXPECT_EQ(1U, mBQ->getFramesDropped());
+}
+
+TEST_F(BufferQueueTest, AcquireBuffer_WithBogusTimestamps_DropsNothing) {
+    sp<DummyConsumer> dc(new DummyConsumer);
+    mBQ->consumerConnect(dc);
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    mBQ->connect(NATIVE_WINDOW_API_CPU, &qbo);
+    mBQ->setBufferCount(5);
+    ASSERT_EQ(OK, mBQ->setSynchronousMode(true));
+
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> buf;
+    BufferQueue::BufferItem item;
+
+    // producers that don't set timestamps queue them as 0
+    IGraphicBufferProducer::QueueBufferInput qbi(0, Rect(0, 0, 1, 1),
+            NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+                mBQ->dequeueBuffer(&slot, &fence, 1, 1, 0,
+                    GRALLOC_USAGE_SW_READ_OFTEN));
+        ASSERT_EQ(OK, mBQ->requestBuffer(slot, &buf));
+        ASSERT_EQ(OK, mBQ->queueBuffer(slot, qbi, &qbo));
+    }
+
+    const nsecs_t presentWhen = 5000000000LL;
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(OK, mBQ->acquireBuffer(&item, presentWhen));
+        EXPECT_EQ(0U, item.mSkipped);
+        ASSERT_EQ(OK, mBQ->releaseBuffer(item.mBuf, EGL_NO_DISPLAY,
+                EGL_NO_SYNC_KHR, Fence::NO_FENCE));
+    }
+    EXPECT_EQ(0U, mBQ->getFramesDropped());
+}
+
+TEST_F(BufferQueueTest, DequeueBuffer_AfterAllocateBuffers_NeedsReallocation) {
+    sp<DummyConsumer> dc(new DummyConsumer);
+    mBQ->consumerConnect(dc);
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    mBQ->connect(NATIVE_WINDOW_API_CPU, &qbo);
+    mBQ->setBufferCount(2);
+
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> first;
+    ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+            mBQ->dequeueBuffer(&slot, &fence, 1, 1, 0,
+                GRALLOC_USAGE_SW_READ_OFTEN));
+    ASSERT_EQ(OK, mBQ->requestBuffer(slot, &first));
+    mBQ->cancelBuffer(slot, Fence::NO_FENCE);
+
+    // the producer still holds first when the slot gets a new buffer
+    mBQ->discardFreeBuffers();
+    mBQ->allocateBuffers(1, 1, 0, GRALLOC_USAGE_SW_READ_OFTEN);
+
+    int again;
+    ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+            mBQ->dequeueBuffer(&again, &fence, 1, 1, 0,
+                GRALLOC_USAGE_SW_READ_OFTEN));
+    sp<GraphicBuffer> second;
+    ASSERT_EQ(OK, mBQ->requestBuffer(again, &second));
+    EXPECT_NE(first, second);
+    mBQ->cancelBuffer(again, Fence::NO_FENCE);
+}
+
+TEST_F(BufferQueueTest, GetFrameTimestamps_FollowsFrame) {
+    sp<DummyConsumer> dc(new DummyConsumer);
+    mBQ->consumerConnect(dc);
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    mBQ->connect(NATIVE_WINDOW_API_CPU, &qbo);
+    mBQ->setBufferCount(4);
+
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> buf;
+    IGraphicBufferProducer::QueueBufferInput qbi(0, Rect(0, 0, 1, 1),
+            NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+    ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+            mBQ->dequeueBuffer(&slot, &fence, 1, 1, 0,
+                GRALLOC_USAGE_SW_READ_OFTEN));
+    ASSERT_EQ(OK, mBQ->requestBuffer(slot, &buf));
+    ASSERT_EQ(OK, mBQ->queueBuffer(slot, qbi, &qbo));
+    const uint64_t frameNumber = qbo.getFrameNumber();
+    ASSERT_NE(0U, frameNumber);
+
+    IGraphicBufferProducer::FrameTimestamps timestamps;
+    ASSERT_EQ(OK, mBQ->getFrameTimestamps(frameNumber, &timestamps));
+    EXPECT_EQ(frameNumber, timestamps.frameNumber);
+    EXPECT_NE(0, timestamps.queueTime);
+    EXPECT_EQ(0, timestamps.acquireTime);
+    EXPECT_EQ(0, timestamps.presentTime);
+
+    BufferQueue::BufferItem item;
+    ASSERT_EQ(OK, mBQ->acquireBuffer(&item));
+    EXPECT_EQ(frameNumber, item.mFrameNumber);
+    mBQ->setFramePresented(frameNumber, Fence::NO_FENCE, 1234);
+
+    ASSERT_EQ(OK, mBQ->getFrameTimestamps(frameNumber, &timestamps));
+    EXPECT_LE(timestamps.queueTime, timestamps.acquireTime);
+    EXPECT_EQ(1234, timestamps.presentTime);
+
+    EXPECT_EQ(NAME_NOT_FOUND, mBQ->getFrameTimestamps(frameNumber + 1,
+            &timestamps));
+}
+
+TEST_F(BufferQueueTest, SetAdaptiveBufferCountWithIllegalValues_ReturnsError) {
+    ASSERT_EQ(BAD_VALUE, mBQ->setAdaptiveBufferCount(1, 3));
+    ASSERT_EQ(BAD_VALUE, mBQ->setAdaptiveBufferCount(3, 2));
+    ASSERT_EQ(BAD_VALUE, mBQ->setAdaptiveBufferCount(2,
+            BufferQueue::NUM_BUFFER_SLOTS + 1));
+    ASSERT_EQ(OK, mBQ->setAdaptiveBufferCount(2, 3));
+    ASSERT_EQ(OK, mBQ->setAdaptiveBufferCount(0, 0));
+}
+
+TEST_F(BufferQueueTest, AdaptiveBufferCount_FastProducer_UsesTwoBuffers) {
+    sp<DummyConsumer> dc(new DummyConsumer);
+    mBQ->consumerConnect(dc);
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    mBQ->connect(NATIVE_WINDOW_API_CPU, &qbo);
+    mBQ->setSynchronousMode(true);
+    ASSERT_EQ(OK, mBQ->setAdaptiveBufferCount(2, 3));
+
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> buf;
+    IGraphicBufferProducer::QueueBufferInput qbi(0, Rect(0, 0, 1, 1),
+            NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+    BufferQueue::BufferItem item;
+
+    // the producer takes a fraction of the consumer's period, so the third
+    // buffer goes after a while
+    for (int i = 0; i < 300; i++) {
+        status_t result = mBQ->dequeueBuffer(&slot, &fence, 1, 1, 0,
+                GRALLOC_USAGE_SW_READ_OFTEN);
+        ASSERT_LE(0, result);
+        if (result & IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) {
+            ASSERT_EQ(OK, mBQ->requestBuffer(slot, &buf));
+        }
+        if (i >= 280) {
+            EXPECT_GT(2, slot);
+        }
+        ASSERT_EQ(OK, mBQ->queueBuffer(slot, qbi, &qbo));
+        usleep(2000);
+        ASSERT_EQ(OK, mBQ->acquireBuffer(&item));
+        ASSERT_EQ(OK, mBQ->releaseBuffer(item.mBuf, EGL_NO_DISPLAY,
+                EGL_NO_SYNC_KHR, Fence::NO_FENCE));
+    }
+}
+
+TEST_F(BufferQueueTest, SetFrameDropPolicyWithIllegalValues_ReturnsError) {
+    ASSERT_EQ(BAD_VALUE, mBQ->setFrameDropPolicy(-1, 2, 0));
+    ASSERT_EQ(BAD_VALUE, mBQ->setFrameDropPolicy(
+            BufferQueue::DROP_NEWEST + 1, 2, 0));
+    ASSERT_EQ(BAD_VALUE, mBQ->setFrameDropPolicy(
+            BufferQueue::DROP_OLDEST, -1, 0));
+    ASSERT_EQ(BAD_VALUE, mBQ->setFrameDropPolicy(BufferQueue::DROP_OLDEST,
+            BufferQueue::NUM_BUFFER_SLOTS + 1, 0));
+    ASSERT_EQ(BAD_VALUE, mBQ->setFrameDropPolicy(
+            BufferQueue::DROP_NONE, 0, -1));
+    ASSERT_EQ(OK, mBQ->setFrameDropPolicy(BufferQueue::DROP_OLDEST, 2, 0));
+}
+
+TEST_F(BufferQueueTest, FrameDropPolicy_DropOldest_TellsConsumer) {
+    sp<CountingConsumer> cc(new CountingConsumer);
+    mBQ->consumerConnect(cc);
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    mBQ->connect(NATIVE_WINDOW_API_CPU, &qbo);
+    mBQ->setBufferCount(5);
+    ASSERT_EQ(OK, mBQ->setSynchronousMode(true));
+    ASSERT_EQ(OK, mBQ->setFrameDropPolicy(BufferQueue::DROP_OLDEST, 2, 0));
+
+    for (int i = 1; i <= 3; i++) {
+        queueFrame(mBQ, i * 1000);
+    }
+
+    // the first frame made room for the third one
+    EXPECT_EQ(3, cc->mFramesAvailable);
+    EXPECT_EQ(1, cc->mFramesDropped);
+    EXPECT_EQ(1U, mBQ->getFramesDropped());
+
+    BufferQueue::BufferItem item;
+    for (int i = 2; i <= 3; i++) {
+        ASSERT_EQ(OK, mBQ->acquireBuffer(&item));
+        EXPECT_EQ(i * 1000, item.mTimestamp);
+        EXPECT_EQ(0U, item.mSkipped);
+        ASSERT_EQ(OK, mBQ->releaseBuffer(item.mBuf, EGL_NO_DISPLAY,
+                EGL_NO_SYNC_KHR, Fence::NO_FENCE));
+    }
+    ASSERT_EQ(BufferQueue::NO_BUFFER_AVAILABLE, mBQ->acquireBuffer(&item));
+}
+
+TEST_F(BufferQueueTest, FrameDropPolicy_DropNewest_KeepsQueuedFrames) {
+    sp<CountingConsumer> cc(new CountingConsumer);
+    mBQ->consumerConnect(cc);
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    mBQ->connect(NATIVE_WINDOW_API_CPU, &qbo);
+    mBQ->setBufferCount(5);
+    ASSERT_EQ(OK, mBQ->setSynchronousMode(true));
+    ASSERT_EQ(OK, mBQ->setFrameDropPolicy(BufferQueue::DROP_NEWEST, 2, 0));
+
+    for (int i = 1; i <= 3; i++) {
+        queueFrame(mBQ, i * 1000);
+    }
+
+    // the third frame was never announced, so there is nothing to forget
+    EXPECT_EQ(2, cc->mFramesAvailable);
+    EXPECT_EQ(0, cc->mFramesDropped);
+    EXPECT_EQ(1U, mBQ->getFramesDropped());
+
+    BufferQueue::BufferItem item;
+    for (int i = 1; i <= 2; i++) {
+        ASSERT_EQ(OK, mBQ->acquireBuffer(&item));
+        EXPECT_EQ(i * 1000, item.mTimestamp);
+        ASSERT_EQ(OK, mBQ->releaseBuffer(item.mBuf, EGL_NO_DISPLAY,
+                EGL_NO_SYNC_KHR, Fence::NO_FENCE));
+    }
+    ASSERT_EQ(BufferQueue::NO_BUFFER_AVAILABLE, mBQ->acquireBuffer(&item));
+}
+
+TEST_F(BufferQueueTest, FrameDropPolicy_MaxFrameAge_SkipsOldFrames) {
+    sp<CountingConsumer> cc(new CountingConsumer);
+    mBQ->consumerConnect(cc);
+    IGraphicBufferProducer::QueueBufferOutput qbo;
+    mBQ->connect(NATIVE_WINDOW_API_CPU, &qbo);
+    mBQ->setBufferCount(5);
+    ASSERT_EQ(OK, mBQ->setSynchronousMode(true));
+    ASSERT_EQ(OK, mBQ->setFrameDropPolicy(BufferQueue::DROP_NONE, 0,
+            ms2ns(100)));
+
+    const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    queueFrame(mBQ, now - s2ns(2));
+    queueFrame(mBQ, now - s2ns(1));
+    queueFrame(mBQ, now);
+
+    // the stale frames are reported with the one that is acquired
+    BufferQueue::BufferItem item;
+    ASSERT_EQ(OK, mBQ->acquireBuffer(&item));
+    EXPECT_EQ(now, item.mTimestamp);
+    EXPECT_EQ(2U, item.mSkipped);
+    EXPECT_EQ(2U, mBQ->getFramesDropped());
+    EXPECT_EQ(0, cc->mFramesDropped);
+}
+
 } // namespace android
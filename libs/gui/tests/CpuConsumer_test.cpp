@@ -39,6 +39,7 @@
 #define CPU_CONSUMER_TEST_FORMAT_Y8 0
 #define CPU_CONSUMER_TEST_FORMAT_Y16 0
 #define CPU_CONSUMER_TEST_FORMAT_RGBA_8888 1
+#define CPU_CONSUMER_TEST_FORMAT_YV12 1
 
 namespace android {
 
@@ -184,7 +185,8 @@ void checkPixel(const CpuConsumer::LockedBuffer &buf,
             }
             break;
         }
-        // ignores g,b
+        // ignores g,b, only checks the Y plane
+        case HAL_PIXEL_FORMAT_YV12:
         case HAL_PIXEL_FORMAT_Y8: {
             uint8_t *bPtr = (uint8_t*)buf.data;
             bPtr += y * buf.stride + x;
@@ -342,6 +344,18 @@ void checkGreyscaleBuffer(const CpuConsumer::LockedBuffer &buf) {
     checkPixel(buf, w-1, h-1, pixelValue);
 }
 
+void checkYV12Buffer(const CpuConsumer::LockedBuffer &buf) {
+    checkGreyscaleBuffer<uint8_t>(buf);
+
+    // see fillYV12Buffer()
+    const uint32_t cstride = (buf.stride / 2 + 0xf) & ~0xf;
+    EXPECT_EQ(buf.data + buf.stride * buf.height, buf.dataCr);
+    EXPECT_EQ(buf.dataCr + cstride * (buf.height / 2), buf.dataCb);
+    EXPECT_EQ(cstride, buf.chromaStride);
+    EXPECT_EQ(1U, buf.chromaStep);
+    EXPECT_EQ(191, buf.dataCb[0]);
+}
+
 void checkRgba8888Buffer(const CpuConsumer::LockedBuffer &buf) {
     uint32_t w = buf.width;
     uint32_t h = buf.height;
@@ -434,6 +448,9 @@ void checkAnyBuffer(const CpuConsumer::LockedBuffer &buf, int format) {
         case HAL_PIXEL_FORMAT_Y8:
             checkGreyscaleBuffer<uint8_t>(buf);
             break;
+        case HAL_PIXEL_FORMAT_YV12:
+            checkYV12Buffer(buf);
+            break;
         case HAL_PIXEL_FORMAT_Y16:
             checkGreyscaleBuffer<uint16_t>(buf);
             break;
@@ -726,6 +743,15 @@ CpuConsumerTestParams rgba8888TestSets[] = {
     { 100,   100, 3, HAL_PIXEL_FORMAT_RGBA_8888},
 };
 
+CpuConsumerTestParams yv12TestSets[] = {
+    { 512,   512, 1, HAL_PIXEL_FORMAT_YV12},
+    { 512,   512, 3, HAL_PIXEL_FORMAT_YV12},
+    { 2608, 1960, 1, HAL_PIXEL_FORMAT_YV12},
+    { 2608, 1960, 3, HAL_PIXEL_FORMAT_YV12},
+    { 100,   100, 1, HAL_PIXEL_FORMAT_YV12},
+    { 100,   100, 3, HAL_PIXEL_FORMAT_YV12},
+};
+
 #if CPU_CONSUMER_TEST_FORMAT_Y8
 INSTANTIATE_TEST_CASE_P(Y8Tests,
         CpuConsumerTest,
@@ -750,6 +776,12 @@ INSTANTIATE_TEST_CASE_P(Rgba8888Tests,
         ::testing::ValuesIn(rgba8888TestSets));
 #endif
 
+#if CPU_CONSUMER_TEST_FORMAT_YV12
+INSTANTIATE_TEST_CASE_P(YV12Tests,
+        CpuConsumerTest,
+        ::testing::ValuesIn(yv12TestSets));
+#endif
+
 
 
 } // namespace android
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "MetadataBufferConsumer_test"
+//#define LOG_NDEBUG 0
+
+#include <gtest/gtest.h>
+
+#include <gui/MetadataBufferConsumer.h>
+#include <media/hardware/MetadataBufferType.h>
+#include <ui/GraphicBuffer.h>
+
+namespace android {
+
+class MetadataBufferConsumerTest : public ::testing::Test {
+protected:
+
+    virtual void SetUp() {
+        const ::testing::TestInfo* const testInfo =
+            ::testing::UnitTest::GetInstance()->current_test_info();
+        ALOGV("Begin test: %s.%s", testInfo->test_case_name(),
+                testInfo->name());
+
+        mConsumer = new MetadataBufferConsumer(1);
+        mConsumer->setName(String8("MetadataBufferConsumerTest"));
+        mProducer = mConsumer->getProducerInterface();
+        IGraphicBufferProducer::QueueBufferOutput qbo;
+        ASSERT_EQ(OK, mProducer->connect(NATIVE_WINDOW_API_CPU, &qbo));
+        ASSERT_EQ(OK, mProducer->setBufferCount(4));
+    }
+
+    virtual void TearDown() {
+        mProducer.clear();
+        mConsumer.clear();
+
+        const ::testing::TestInfo* const testInfo =
+            ::testing::UnitTest::GetInstance()->current_test_info();
+        ALOGV("End test:   %s.%s", testInfo->test_case_name(),
+                testInfo->name());
+    }
+
+    // Queues a buffer, returning its handle.
+    buffer_handle_t queueBuffer(int64_t timestamp) {
+        int slot;
+        sp<Fence> fence;
+        status_t err = mProducer->dequeueBuffer(&slot, &fence, 16, 16,
+                HAL_PIXEL_FORMAT_RGBA_8888, 0);
+        EXPECT_LE(0, err);
+        sp<GraphicBuffer> buffer;
+        EXPECT_EQ(OK, mProducer->requestBuffer(slot, &buffer));
+        IGraphicBufferProducer::QueueBufferInput qbi(timestamp, Rect(0, 0, 16, 16),
+                NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+        IGraphicBufferProducer::QueueBufferOutput qbo;
+        EXPECT_EQ(OK, mProducer->queueBuffer(slot, qbi, &qbo));
+        return buffer != NULL ? buffer->handle : NULL;
+    }
+
+    sp<MetadataBufferConsumer> mConsumer;
+    sp<IGraphicBufferProducer> mProducer;
+};
+
+TEST_F(MetadataBufferConsumerTest, MetadataDescribesTheQueuedBuffer) {
+    buffer_handle_t handle = queueBuffer(1234);
+
+    uint8_t data[64];
+    const size_t size = MetadataBufferConsumer::getMetadataSize();
+    sp<Fence> fence;
+    int64_t timestamp = 0;
+    ASSERT_EQ(OK, mConsumer->acquireMetadataBuffer(data, size, &fence, &timestamp));
+    EXPECT_EQ(1234, timestamp);
+    EXPECT_TRUE(fence != NULL);
+
+    uint32_t type;
+    buffer_handle_t metadataHandle;
+    memcpy(&type, data, sizeof(type));
+    memcpy(&metadataHandle, data + sizeof(type), sizeof(metadataHandle));
+    EXPECT_EQ(uint32_t(kMetadataBufferTypeGrallocSource), type);
+    EXPECT_EQ(handle, metadataHandle);
+
+    EXPECT_EQ(OK, mConsumer->releaseMetadataBuffer(data, size));
+    // it's not acquired anymore
+    EXPECT_EQ(BAD_VALUE, mConsumer->releaseMetadataBuffer(data, size));
+}
+
+TEST_F(MetadataBufferConsumerTest, BuffersStayAcquiredUntilReleased) {
+    uint8_t data[3][64];
+    const size_t size = MetadataBufferConsumer::getMetadataSize();
+    queueBuffer(1);
+    queueBuffer(2);
+    ASSERT_EQ(OK, mConsumer->acquireMetadataBuffer(data[0], size));
+    ASSERT_EQ(OK, mConsumer->acquireMetadataBuffer(data[1], size));
+    EXPECT_NE(0, memcmp(data[0], data[1], size));
+
+    // the queue allows one more than the max acquired count
+    queueBuffer(3);
+    EXPECT_EQ(INVALID_OPERATION, mConsumer->acquireMetadataBuffer(data[2], size));
+
+    EXPECT_EQ(OK, mConsumer->releaseMetadataBuffer(data[0], size));
+    EXPECT_EQ(OK, mConsumer->acquireMetadataBuffer(data[2], size));
+    EXPECT_EQ(OK, mConsumer->releaseMetadataBuffer(data[1], size));
+    EXPECT_EQ(OK, mConsumer->releaseMetadataBuffer(data[2], size));
+}
+
+TEST_F(MetadataBufferConsumerTest, ReleaseAfterTheSlotWasReused) {
+    uint8_t data[2][64];
+    const size_t size = MetadataBufferConsumer::getMetadataSize();
+    queueBuffer(1);
+    ASSERT_EQ(OK, mConsumer->acquireMetadataBuffer(data[0], size));
+
+    // frees every slot, the acquired one included, while the encoder
+    // still holds its buffer
+    ASSERT_EQ(OK, mProducer->setBufferCount(4));
+    queueBuffer(2);
+    ASSERT_EQ(OK, mConsumer->acquireMetadataBuffer(data[1], size));
+    EXPECT_NE(0, memcmp(data[0], data[1], size));
+
+    EXPECT_EQ(OK, mConsumer->releaseMetadataBuffer(data[0], size));
+    EXPECT_EQ(OK, mConsumer->releaseMetadataBuffer(data[1], size));
+    EXPECT_EQ(BAD_VALUE, mConsumer->releaseMetadataBuffer(data[0], size));
+
+    // the second buffer went back to the queue
+    queueBuffer(3);
+    EXPECT_EQ(OK, mConsumer->acquireMetadataBuffer(data[1], size));
+    EXPECT_EQ(OK, mConsumer->releaseMetadataBuffer(data[1], size));
+}
+
+TEST_F(MetadataBufferConsumerTest, TooSmallMetadataFails) {
+    uint8_t data[64];
+    queueBuffer(1);
+    EXPECT_EQ(BAD_VALUE, mConsumer->acquireMetadataBuffer(data,
+            MetadataBufferConsumer::getMetadataSize() - 1));
+}
+
+} // namespace android
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SensorDirectChannel_test"
+
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+#include <binder/Parcel.h>
+#include <gui/SensorDirectChannel.h>
+
+#include <android/sensor.h>
+
+namespace android {
+
+class SensorDirectChannelTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        mWriter = new SensorDirectChannel(64);
+        ASSERT_EQ(NO_ERROR, mWriter->initCheck());
+        Parcel parcel;
+        ASSERT_EQ(NO_ERROR, mWriter->writeToParcel(&parcel));
+        parcel.setDataPosition(0);
+        mReader = new SensorDirectChannel(parcel);
+        ASSERT_EQ(NO_ERROR, mReader->initCheck());
+    }
+
+    void fill(ASensorEvent* events, size_t count, int64_t first) {
+        for (size_t i=0 ; i<count ; i++) {
+            memset(&events[i], 0, sizeof(ASensorEvent));
+            events[i].timestamp = first + i;
+        }
+    }
+
+    sp<SensorDirectChannel> mWriter;
+    sp<SensorDirectChannel> mReader;
+};
+
+TEST_F(SensorDirectChannelTest, CapacityIsRoundedUp) {
+    sp<SensorDirectChannel> channel(new SensorDirectChannel(100));
+    ASSERT_EQ(NO_ERROR, channel->initCheck());
+    EXPECT_EQ(128U, channel->getCapacity());
+    EXPECT_EQ(64U, mReader->getCapacity());
+}
+
+TEST_F(SensorDirectChannelTest, ReadsWhatWasWritten) {
+    ASensorEvent in[10], out[20];
+    fill(in, 10, 1000);
+    mWriter->write(in, 10);
+    ASSERT_EQ(4, mReader->read(out, 4));
+    ASSERT_EQ(6, mReader->read(out + 4, 16));
+    for (int i=0 ; i<10 ; i++) {
+        EXPECT_EQ(1000 + i, out[i].timestamp);
+    }
+    EXPECT_EQ(0, mReader->read(out, 20));
+}
+
+TEST_F(SensorDirectChannelTest, WrapsAround) {
+    ASensorEvent in[50], out[50];
+    for (int pass=0 ; pass<5 ; pass++) {
+        fill(in, 50, pass * 50);
+        mWriter->write(in, 50);
+        ASSERT_EQ(50, mReader->read(out, 50));
+        for (int i=0 ; i<50 ; i++) {
+            EXPECT_EQ(pass * 50 + i, out[i].timestamp);
+        }
+    }
+}
+
+TEST_F(SensorDirectChannelTest, LappedReaderGetsNewestEvents) {
+    ASensorEvent in[100], out[100];
+    fill(in, 100, 0);
+    mWriter->write(in, 100);
+    ASSERT_EQ(64, mReader->read(out, 100));
+    EXPECT_EQ(36, out[0].timestamp);
+    EXPECT_EQ(99, out[63].timestamp);
+}
+
+TEST_F(SensorDirectChannelTest, WakesUpOncePerRearm) {
+    ASensorEvent in[4], out[4];
+    fill(in, 4, 0);
+    EXPECT_TRUE(mWriter->write(in, 1));
+    EXPECT_FALSE(mWriter->write(in + 1, 1));
+    ASSERT_EQ(2, mReader->read(out, 4));
+    mReader->rearm();
+    EXPECT_TRUE(mWriter->write(in + 2, 2));
+}
+
+} // namespace android
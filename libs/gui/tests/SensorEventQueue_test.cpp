@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SensorEventQueue_test"
+
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+#include <gui/BitTube.h>
+#include <gui/ISensorEventConnection.h>
+#include <gui/SensorEventQueue.h>
+#include <gui/SensorEventQueueSet.h>
+
+#include <android/sensor.h>
+
+namespace android {
+
+// a connection that only hands out its tube, the test plays the service
+class FakeSensorEventConnection : public BnSensorEventConnection {
+    sp<BitTube> mChannel;
+public:
+    FakeSensorEventConnection() : mChannel(new BitTube()) { }
+    virtual sp<BitTube> getSensorChannel() const { return mChannel; }
+    virtual status_t enableDisable(int, bool) { return NO_ERROR; }
+    virtual status_t setEventRate(int, nsecs_t) { return NO_ERROR; }
+    virtual status_t setMaxReportLatency(int, nsecs_t) { return NO_ERROR; }
+    virtual sp<SensorDirectChannel> createDirectChannel(size_t) { return NULL; }
+};
+
+class SensorEventQueueTest : public ::testing::Test {
+protected:
+    sp<SensorEventQueue> createQueue(sp<BitTube>* tube) {
+        sp<ISensorEventConnection> connection(new FakeSensorEventConnection());
+        *tube = connection->getSensorChannel();
+        return new SensorEventQueue(connection);
+    }
+
+    void fill(ASensorEvent* events, size_t count, int64_t first) {
+        for (size_t i=0 ; i<count ; i++) {
+            memset(&events[i], 0, sizeof(ASensorEvent));
+            events[i].timestamp = first + i;
+        }
+    }
+};
+
+TEST_F(SensorEventQueueTest, ReadsEventsInOrderAcrossPackets) {
+    sp<BitTube> tube;
+    sp<SensorEventQueue> queue(createQueue(&tube));
+    ASensorEvent in[30], out[30];
+    fill(in, 30, 100);
+    ASSERT_EQ(30, SensorEventQueue::write(tube, in, 30));
+
+    // smaller reads than the packets don't lose anything
+    size_t total = 0;
+    ssize_t n;
+    while ((n = queue->read(out + total, 7)) > 0) {
+        total += n;
+    }
+    ASSERT_EQ(30U, total);
+    for (int i=0 ; i<30 ; i++) {
+        EXPECT_EQ(100 + i, out[i].timestamp);
+    }
+    EXPECT_FALSE(queue->hasBufferedEvents());
+}
+
+TEST_F(SensorEventQueueTest, KeepsWhatTheCallerDidntTake) {
+    sp<BitTube> tube;
+    sp<SensorEventQueue> queue(createQueue(&tube));
+    ASensorEvent in[4], out[4];
+    fill(in, 4, 0);
+    ASSERT_EQ(4, SensorEventQueue::write(tube, in, 4));
+    ASSERT_EQ(1, queue->read(out, 1));
+    EXPECT_TRUE(queue->hasBufferedEvents());
+    ASSERT_EQ(3, queue->read(out + 1, 4));
+    EXPECT_EQ(3, out[3].timestamp);
+    EXPECT_EQ(0, queue->read(out, 4));
+}
+
+TEST_F(SensorEventQueueTest, SetReportsReadyQueues) {
+    sp<SensorEventQueueSet> set(new SensorEventQueueSet());
+    ASSERT_EQ(NO_ERROR, set->initCheck());
+
+    sp<BitTube> tube0, tube1;
+    sp<SensorEventQueue> queue0(createQueue(&tube0));
+    sp<SensorEventQueue> queue1(createQueue(&tube1));
+    ASSERT_EQ(NO_ERROR, set->add(queue0));
+    ASSERT_EQ(NO_ERROR, set->add(queue1));
+    EXPECT_EQ(ALREADY_EXISTS, set->add(queue1));
+
+    sp<SensorEventQueue> ready[2];
+    EXPECT_EQ(0, set->wait(ready, 2, 0));
+
+    ASensorEvent events[2];
+    fill(events, 2, 0);
+    ASSERT_EQ(2, SensorEventQueue::write(tube1, events, 2));
+    ASSERT_EQ(1, set->wait(ready, 2, 100));
+    EXPECT_EQ(queue1, ready[0]);
+
+    // a partly read queue is still ready, though its socket is empty
+    ASSERT_EQ(1, queue1->read(events, 1));
+    ASSERT_EQ(1, set->wait(ready, 2, 0));
+    EXPECT_EQ(queue1, ready[0]);
+    ASSERT_EQ(1, queue1->read(events, 1));
+    EXPECT_EQ(0, set->wait(ready, 2, 0));
+
+    EXPECT_EQ(NO_ERROR, set->remove(queue1));
+    EXPECT_EQ(NAME_NOT_FOUND, set->remove(queue1));
+}
+
+} // namespace android
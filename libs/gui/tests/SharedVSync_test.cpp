@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SharedVSync_test"
+
+#include <gtest/gtest.h>
+
+#include <gui/SharedVSync.h>
+
+namespace android {
+
+static DisplayEventReceiver::Event vsync(uint32_t count) {
+    DisplayEventReceiver::Event event;
+    memset(&event, 0, sizeof(event));
+    event.header.type = DisplayEventReceiver::DISPLAY_EVENT_VSYNC;
+    event.header.timestamp = 1000 * count;
+    event.vsync.count = count;
+    return event;
+}
+
+TEST(SharedVSyncTest, ReadersOnlySeeTheirOwnVsyncs) {
+    sp<SharedVSync> page(new SharedVSync());
+    ASSERT_EQ(NO_ERROR, page->initCheck());
+    sp<SharedVSync> everyVsync(page->acquireSlot());
+    sp<SharedVSync> everyOtherVsync(page->acquireSlot());
+    ASSERT_TRUE(everyVsync != NULL);
+    ASSERT_TRUE(everyOtherVsync != NULL);
+    ASSERT_NE(everyVsync->getSlot(), everyOtherVsync->getSlot());
+
+    Vector<int32_t> both;
+    both.add(everyVsync->getSlot());
+    both.add(everyOtherVsync->getSlot());
+    Vector<int32_t> one;
+    one.add(everyVsync->getSlot());
+
+    page->publish(vsync(1), one);
+    page->publish(vsync(2), both);
+    page->publish(vsync(3), one);
+
+    DisplayEventReceiver::Event event;
+    uint32_t delivered = 0;
+    ASSERT_EQ(NO_ERROR, everyVsync->wait(&event, &delivered, 0));
+    EXPECT_EQ(3u, delivered);
+    EXPECT_EQ(3u, event.vsync.count);
+
+    delivered = 0;
+    ASSERT_EQ(NO_ERROR, everyOtherVsync->wait(&event, &delivered, 0));
+    EXPECT_EQ(1u, delivered);
+    EXPECT_EQ(2u, event.vsync.count);
+    EXPECT_EQ(2000, event.header.timestamp);
+
+    // the vsyncs for the other reader don't wake this one up
+    page->publish(vsync(4), one);
+    EXPECT_EQ(TIMED_OUT, everyOtherVsync->wait(&event, &delivered, ms2ns(10)));
+}
+
+TEST(SharedVSyncTest, ReusedSlotsStartOver) {
+    sp<SharedVSync> page(new SharedVSync());
+    ASSERT_EQ(NO_ERROR, page->initCheck());
+    sp<SharedVSync> reader(page->acquireSlot());
+    ASSERT_TRUE(reader != NULL);
+    const int32_t slot = reader->getSlot();
+
+    Vector<int32_t> slots;
+    slots.add(slot);
+    page->publish(vsync(1), slots);
+    reader.clear();
+
+    reader = page->acquireSlot();
+    ASSERT_TRUE(reader != NULL);
+    EXPECT_EQ(slot, reader->getSlot());
+    DisplayEventReceiver::Event event;
+    uint32_t delivered;
+    EXPECT_EQ(NOT_ENOUGH_DATA, reader->read(&event, &delivered));
+    EXPECT_EQ(0u, delivered);
+}
+
+}; // namespace android
@@ -472,6 +472,22 @@ TEST_F(SurfaceTextureClientTest, SurfaceTextureSyncModeMinUndequeued) {
     ASSERT_EQ(OK, mANW->cancelBuffer(mANW.get(), buf[2], -1));
 }
 
+TEST_F(SurfaceTextureClientTest, QueueBufferTwiceFails) {
+    android_native_buffer_t* buf[2];
+    ASSERT_EQ(OK, mST->setSynchronousMode(true));
+    ASSERT_EQ(OK, native_window_set_buffer_count(mANW.get(), 3));
+
+    ASSERT_EQ(OK, native_window_dequeue_buffer_and_wait(mANW.get(), &buf[0]));
+    ASSERT_EQ(OK, native_window_dequeue_buffer_and_wait(mANW.get(), &buf[1]));
+    ASSERT_EQ(OK, mANW->queueBuffer(mANW.get(), buf[1], -1));
+    ASSERT_EQ(OK, mANW->queueBuffer(mANW.get(), buf[0], -1));
+
+    // no longer dequeued, but still known to the Surface
+    EXPECT_NE(OK, mANW->queueBuffer(mANW.get(), buf[0], -1));
+    EXPECT_EQ(OK, mST->updateTexImage());
+    EXPECT_EQ(mST->getCurrentBuffer().get(), buf[1]);
+}
+
 TEST_F(SurfaceTextureClientTest, SetCropCropsCrop) {
     android_native_rect_t rect = {-2, -13, 40, 18};
     native_window_set_crop(mANW.get(), &rect);
@@ -650,6 +666,57 @@ TEST_F(SurfaceTextureClientTest, GetTransformMatrixSucceedsAfterFreeingBuffersWi
     EXPECT_EQ(1.f, mtx[15]);
 }
 
+TEST_F(SurfaceTextureClientTest, TransformMatrixFollowsGeometryAndFiltering) {
+    android_native_buffer_t* buf;
+    float mtx[16] = {};
+    android_native_rect_t crop;
+    crop.left = 0;
+    crop.top = 0;
+    crop.right = 5;
+    crop.bottom = 5;
+
+    ASSERT_EQ(OK, native_window_set_buffer_count(mANW.get(), 4));
+    ASSERT_EQ(OK, native_window_set_buffers_geometry(mANW.get(), 8, 8, 0));
+    ASSERT_EQ(OK, native_window_set_crop(mANW.get(), &crop));
+    ASSERT_EQ(OK, native_window_dequeue_buffer_and_wait(mANW.get(), &buf));
+    ASSERT_EQ(OK, mANW->queueBuffer(mANW.get(), buf, -1));
+    ASSERT_EQ(OK, mST->updateTexImage());
+    EXPECT_TRUE(mST->hasGeometryChanged());
+    mST->getTransformMatrix(mtx);
+    EXPECT_EQ(0.5, mtx[0]);
+
+    // same geometry
+    ASSERT_EQ(OK, native_window_dequeue_buffer_and_wait(mANW.get(), &buf));
+    ASSERT_EQ(OK, mANW->queueBuffer(mANW.get(), buf, -1));
+    ASSERT_EQ(OK, mST->updateTexImage());
+    EXPECT_FALSE(mST->hasGeometryChanged());
+    mST->getTransformMatrix(mtx);
+    EXPECT_EQ(0.5, mtx[0]);
+    EXPECT_EQ(0.0625f, mtx[12]);
+
+    // no half texel shrink without filtering, and back
+    mST->setFilteringEnabled(false);
+    mST->getTransformMatrix(mtx);
+    EXPECT_EQ(0.625f, mtx[0]);
+    EXPECT_EQ(0.f, mtx[12]);
+    mST->setFilteringEnabled(true);
+    mST->getTransformMatrix(mtx);
+    EXPECT_EQ(0.5, mtx[0]);
+    EXPECT_EQ(0.0625f, mtx[12]);
+
+    // new crop
+    crop.right = 8;
+    crop.bottom = 8;
+    ASSERT_EQ(OK, native_window_set_crop(mANW.get(), &crop));
+    ASSERT_EQ(OK, native_window_dequeue_buffer_and_wait(mANW.get(), &buf));
+    ASSERT_EQ(OK, mANW->queueBuffer(mANW.get(), buf, -1));
+    ASSERT_EQ(OK, mST->updateTexImage());
+    EXPECT_TRUE(mST->hasGeometryChanged());
+    mST->getTransformMatrix(mtx);
+    EXPECT_EQ(1.f, mtx[0]);
+    EXPECT_EQ(0.f, mtx[12]);
+}
+
 // This test verifies that the buffer format can be queried immediately after
 // it is set.
 TEST_F(SurfaceTextureClientTest, QueryFormatAfterSettingWorks) {
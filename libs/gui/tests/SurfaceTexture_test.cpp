@@ -26,6 +26,7 @@
 #include <gui/ISurfaceComposer.h>
 #include <gui/Surface.h>
 #include <gui/SurfaceComposerClient.h>
+#include <private/gui/EGLImageCache.h>
 
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
@@ -1269,6 +1270,25 @@ TEST_F(SurfaceTextureGLTest, DisconnectClearsCurrentTexture) {
             NATIVE_WINDOW_API_EGL));
 }
 
+TEST_F(SurfaceTextureGLTest, FreedBuffersLeaveTheEGLImageCache) {
+    ASSERT_EQ(OK, native_window_api_connect(mANW.get(),
+            NATIVE_WINDOW_API_EGL));
+
+    ANativeWindowBuffer *anb;
+    EXPECT_EQ(OK, native_window_dequeue_buffer_and_wait(mANW.get(), &anb));
+    EXPECT_EQ(OK, mANW->queueBuffer(mANW.get(), anb, -1));
+    EXPECT_EQ(OK, mST->updateTexImage());
+
+    sp<GraphicBuffer> buf(mST->getCurrentBuffer());
+    ASSERT_TRUE(buf != NULL);
+    EXPECT_TRUE(EGLImageCache::getInstance().contains(buf));
+
+    // disconnecting frees all the buffers
+    ASSERT_EQ(OK, native_window_api_disconnect(mANW.get(),
+            NATIVE_WINDOW_API_EGL));
+    EXPECT_FALSE(EGLImageCache::getInstance().contains(buf));
+}
+
 TEST_F(SurfaceTextureGLTest, ScaleToWindowMode) {
     ASSERT_EQ(OK, mST->setSynchronousMode(true));
 
@@ -21,6 +21,8 @@
  // This is needed for stdint.h to define INT64_MAX in C++
  #define __STDC_LIMIT_MACROS
 
+#include <cutils/atomic.h>
+#include <poll.h>
 #include <sync/sync.h>
 #include <ui/Fence.h>
 #include <unistd.h>
@@ -32,11 +34,15 @@ namespace android {
 const sp<Fence> Fence::NO_FENCE = sp<Fence>(new Fence);
 
 Fence::Fence() :
-    mFenceFd(-1) {
+    mFenceFd(-1),
+    mSignalTime(0),
+    mSignaled(0) {
 }
 
 Fence::Fence(int fenceFd) :
-    mFenceFd(fenceFd) {
+    mFenceFd(fenceFd),
+    mSignalTime(0),
+    mSignaled(0) {
 }
 
 Fence::~Fence() {
@@ -103,7 +109,64 @@ nsecs_t Fence::getSignalTime() const {
     if (mFenceFd == -1) {
         return -1;
     }
+    if (android_atomic_acquire_load(&mSignaled)) {
+        return mSignalTime;
+    }
+
+    // sync_fence_info allocates and fills in the state of every sync point,
+    // a poll tells cheaply whether there's any point in asking for it.  A
+    // zero timeout sync_wait isn't used as some drivers log the timeout.
+    struct pollfd pfd;
+    pfd.fd = mFenceFd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 0) == 0) {
+        return INT64_MAX;
+    }
+    return readSignalTime();
+}
+
+void Fence::getSignalTimes(const Fence* const* fences, size_t count,
+        nsecs_t* outTimes) {
+    enum { MAX_POLL_FDS = 32 };
+    struct pollfd pfds[MAX_POLL_FDS];
+    size_t indices[MAX_POLL_FDS];
+
+    size_t i = 0;
+    while (i < count) {
+        size_t numFds = 0;
+        for (; i < count && numFds < MAX_POLL_FDS; i++) {
+            const Fence* fence = fences[i];
+            if (fence == NULL || fence->mFenceFd == -1) {
+                outTimes[i] = -1;
+            } else if (android_atomic_acquire_load(&fence->mSignaled)) {
+                outTimes[i] = fence->mSignalTime;
+            } else {
+                pfds[numFds].fd = fence->mFenceFd;
+                pfds[numFds].events = POLLIN;
+                pfds[numFds].revents = 0;
+                indices[numFds] = i;
+                numFds++;
+            }
+        }
+        if (numFds == 0) {
+            continue;
+        }
+
+        // If the poll fails, each fence is asked for its time instead.
+        int result = poll(pfds, numFds, 0);
+        for (size_t j = 0; j < numFds; j++) {
+            const size_t index = indices[j];
+            if (result >= 0 && pfds[j].revents == 0) {
+                outTimes[index] = INT64_MAX;
+            } else {
+                outTimes[index] = fences[index]->readSignalTime();
+            }
+        }
+    }
+}
 
+nsecs_t Fence::readSignalTime() const {
     struct sync_fence_info_data* finfo = sync_fence_info(mFenceFd);
     if (finfo == NULL) {
         ALOGE("sync_fence_info returned NULL for fd %d", mFenceFd);
@@ -123,6 +186,8 @@ nsecs_t Fence::getSignalTime() const {
     }
     sync_fence_info_free(finfo);
 
+    mSignalTime = nsecs_t(timestamp);
+    android_atomic_release_store(1, &mSignaled);
     return nsecs_t(timestamp);
 }
 
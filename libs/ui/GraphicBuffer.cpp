@@ -18,10 +18,16 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+#include <cutils/atomic.h>
 
 #include <utils/Errors.h>
+#include <utils/KeyedVector.h>
 #include <utils/Log.h>
+#include <utils/Mutex.h>
 
 #include <ui/GraphicBuffer.h>
 #include <ui/GraphicBufferAllocator.h>
@@ -30,13 +36,35 @@
 
 namespace android {
 
+// Buffers imported into this process, by id. Importing a buffer is
+// expensive with some gralloc implementations, and the same buffer is
+// often received again (e.g. after Surface::requestBuffer), so a buffer
+// still alive shares its registered handle instead. The id comes from the
+// sender and only locates a candidate: it is shared only if the kernel
+// says the received fds are the very files it was imported from.
+static Mutex sImportLock;
+static KeyedVector<uint64_t, wp<GraphicBuffer> > sImports;
+
+// whether fd1 and fd2 of this process refer to the same open file, which
+// binder preserves when it passes fds; false when the kernel can't tell
+static bool isSameFile(int fd1, int fd2)
+{
+#ifdef __NR_kcmp
+    const int KCMP_FILE = 0;
+    const pid_t pid = getpid();
+    return syscall(__NR_kcmp, pid, pid, KCMP_FILE, fd1, fd2) == 0;
+#else
+    return false;
+#endif
+}
+
 // ===========================================================================
 // Buffer and implementation of ANativeWindowBuffer
 // ===========================================================================
 
 GraphicBuffer::GraphicBuffer()
     : BASE(), mOwner(ownData), mBufferMapper(GraphicBufferMapper::get()),
-      mInitCheck(NO_ERROR), mIndex(-1)
+      mInitCheck(NO_ERROR), mIndex(-1), mId(getUniqueId())
 {
     width  =
     height =
@@ -49,7 +77,7 @@ GraphicBuffer::GraphicBuffer()
 GraphicBuffer::GraphicBuffer(uint32_t w, uint32_t h,
         PixelFormat reqFormat, uint32_t reqUsage)
     : BASE(), mOwner(ownData), mBufferMapper(GraphicBufferMapper::get()),
-      mInitCheck(NO_ERROR), mIndex(-1)
+      mInitCheck(NO_ERROR), mIndex(-1), mId(getUniqueId())
 {
     width  =
     height =
@@ -63,7 +91,7 @@ GraphicBuffer::GraphicBuffer(uint32_t w, uint32_t h,
 GraphicBuffer::GraphicBuffer(uint32_t w, uint32_t h,
         PixelFormat reqFormat, uint32_t reqUsage, uint32_t bufferSize)
     : BASE(), mOwner(ownData), mBufferMapper(GraphicBufferMapper::get()),
-      mInitCheck(NO_ERROR), mIndex(-1)
+      mInitCheck(NO_ERROR), mIndex(-1), mId(getUniqueId())
 {
     width  =
     height =
@@ -79,7 +107,7 @@ GraphicBuffer::GraphicBuffer(uint32_t w, uint32_t h,
         uint32_t inStride, native_handle_t* inHandle, bool keepOwnership)
     : BASE(), mOwner(keepOwnership ? ownHandle : ownNone),
       mBufferMapper(GraphicBufferMapper::get()),
-      mInitCheck(NO_ERROR), mIndex(-1)
+      mInitCheck(NO_ERROR), mIndex(-1), mId(getUniqueId())
 {
     width  = w;
     height = h;
@@ -92,7 +120,8 @@ GraphicBuffer::GraphicBuffer(uint32_t w, uint32_t h,
 GraphicBuffer::GraphicBuffer(ANativeWindowBuffer* buffer, bool keepOwnership)
     : BASE(), mOwner(keepOwnership ? ownHandle : ownNone),
       mBufferMapper(GraphicBufferMapper::get()),
-      mInitCheck(NO_ERROR), mIndex(-1), mWrappedBuffer(buffer)
+      mInitCheck(NO_ERROR), mIndex(-1), mId(getUniqueId()),
+      mWrappedBuffer(buffer)
 {
     width  = buffer->width;
     height = buffer->height;
@@ -112,6 +141,7 @@ GraphicBuffer::~GraphicBuffer()
 void GraphicBuffer::free_handle()
 {
     if (mOwner == ownHandle) {
+        untrackImport();
         mBufferMapper.unregisterBuffer(handle);
         native_handle_close(handle);
         native_handle_delete(const_cast<native_handle*>(handle));
@@ -151,6 +181,7 @@ status_t GraphicBuffer::reallocate(uint32_t w, uint32_t h, PixelFormat f,
         allocator.free(handle);
         handle = 0;
     }
+    mId = getUniqueId();
     return initSize(w, h, f, reqUsage);
 }
 
@@ -164,6 +195,7 @@ status_t GraphicBuffer::initSize(uint32_t w, uint32_t h, PixelFormat format,
         this->height = h;
         this->format = format;
         this->usage  = reqUsage;
+        initPersistentMapping();
     }
     return err;
 }
@@ -179,10 +211,19 @@ status_t GraphicBuffer::initSize(uint32_t w, uint32_t h, PixelFormat format,
         this->height = h;
         this->format = format;
         this->usage  = reqUsage;
+        initPersistentMapping();
     }
     return err;
 }
 
+void GraphicBuffer::initPersistentMapping()
+{
+    if ((usage & USAGE_SOFTWARE_MASK) &&
+            !(usage & (USAGE_HW_MASK | USAGE_PROTECTED))) {
+        mBufferMapper.setPersistentMapping(handle, true);
+    }
+}
+
 status_t GraphicBuffer::lock(uint32_t usage, void** vaddr)
 {
     const Rect lockBounds(width, height);
@@ -242,8 +283,63 @@ status_t GraphicBuffer::perform(buffer_handle_t hnd, int operation,
 #endif
 }
 
+uint64_t GraphicBuffer::getUniqueId()
+{
+    static volatile int32_t sNextId = 0;
+    uint64_t id = static_cast<uint64_t>(getpid()) << 32;
+    return id | static_cast<uint32_t>(android_atomic_inc(&sNextId));
+}
+
+sp<GraphicBuffer> GraphicBuffer::findImport(uint64_t id, int const* buf,
+        int const* fds, size_t numFds, size_t numInts)
+{
+    if (!numFds) {
+        // nothing the kernel can vouch for
+        return 0;
+    }
+    Mutex::Autolock _l(sImportLock);
+    ssize_t index = sImports.indexOfKey(id);
+    if (index < 0) {
+        return 0;
+    }
+    sp<GraphicBuffer> buffer(sImports.valueAt(index).promote());
+    if (buffer == 0) {
+        // being destroyed, it will untrack itself
+        return 0;
+    }
+    // the id is whatever the sender wrote, check it's the same buffer
+    native_handle_t const* h = buffer->handle;
+    if (buffer->width != buf[1] || buffer->height != buf[2] ||
+            buffer->stride != buf[3] || buffer->format != buf[4] ||
+            buffer->usage != buf[5] ||
+            size_t(h->numFds) != numFds || size_t(h->numInts) != numInts) {
+        return 0;
+    }
+    for (size_t i = 0; i < numFds; i++) {
+        if (!isSameFile(h->data[i], fds[i])) {
+            return 0;
+        }
+    }
+    return buffer;
+}
+
+void GraphicBuffer::trackImport()
+{
+    Mutex::Autolock _l(sImportLock);
+    sImports.replaceValueFor(mId, this);
+}
+
+void GraphicBuffer::untrackImport()
+{
+    Mutex::Autolock _l(sImportLock);
+    ssize_t index = sImports.indexOfKey(mId);
+    if (index >= 0 && sImports.valueAt(index).unsafe_get() == this) {
+        sImports.removeItemsAt(index);
+    }
+}
+
 size_t GraphicBuffer::getFlattenedSize() const {
-    return (8 + (handle ? handle->numInts : 0))*sizeof(int);
+    return (10 + (handle ? handle->numInts : 0))*sizeof(int);
 }
 
 size_t GraphicBuffer::getFdCount() const {
@@ -266,15 +362,17 @@ status_t GraphicBuffer::flatten(void* buffer, size_t size,
     buf[3] = stride;
     buf[4] = format;
     buf[5] = usage;
-    buf[6] = 0;
-    buf[7] = 0;
+    buf[6] = static_cast<int>(mId >> 32);
+    buf[7] = static_cast<int>(mId & 0xFFFFFFFFull);
+    buf[8] = 0;
+    buf[9] = 0;
 
     if (handle) {
-        buf[6] = handle->numFds;
-        buf[7] = handle->numInts;
+        buf[8] = handle->numFds;
+        buf[9] = handle->numInts;
         native_handle_t const* const h = handle;
-        memcpy(fds,     h->data,             h->numFds*sizeof(int));
-        memcpy(&buf[8], h->data + h->numFds, h->numInts*sizeof(int));
+        memcpy(fds,      h->data,             h->numFds*sizeof(int));
+        memcpy(&buf[10], h->data + h->numFds, h->numInts*sizeof(int));
     }
 
     return NO_ERROR;
@@ -283,15 +381,15 @@ status_t GraphicBuffer::flatten(void* buffer, size_t size,
 status_t GraphicBuffer::unflatten(void const* buffer, size_t size,
         int fds[], size_t count)
 {
-    if (size < 8*sizeof(int)) return NO_MEMORY;
+    if (size < 10*sizeof(int)) return NO_MEMORY;
 
     int const* buf = static_cast<int const*>(buffer);
     if (buf[0] != 'GBFR') return BAD_TYPE;
 
-    const size_t numFds  = buf[6];
-    const size_t numInts = buf[7];
+    const size_t numFds  = buf[8];
+    const size_t numInts = buf[9];
 
-    const size_t sizeNeeded = (8 + numInts) * sizeof(int);
+    const size_t sizeNeeded = (10 + numInts) * sizeof(int);
     if (size < sizeNeeded) return NO_MEMORY;
 
     size_t fdCountNeeded = 0;
@@ -302,15 +400,32 @@ status_t GraphicBuffer::unflatten(void const* buffer, size_t size,
         free_handle();
     }
 
+    mId = (static_cast<uint64_t>(static_cast<uint32_t>(buf[6])) << 32) |
+            static_cast<uint32_t>(buf[7]);
+
     if (numFds || numInts) {
         width  = buf[1];
         height = buf[2];
         stride = buf[3];
         format = buf[4];
         usage  = buf[5];
+
+        sp<GraphicBuffer> imported(findImport(mId, buf, fds, numFds, numInts));
+        if (imported != 0) {
+            // already imported, wrap it rather than registering the
+            // handle again; the fds we were given aren't needed
+            for (size_t i = 0; i < numFds; i++) {
+                close(fds[i]);
+            }
+            handle = imported->handle;
+            mOwner = ownNone;
+            mWrappedBuffer = imported;
+            return NO_ERROR;
+        }
+
         native_handle* h = native_handle_create(numFds, numInts);
-        memcpy(h->data,          fds,     numFds*sizeof(int));
-        memcpy(h->data + numFds, &buf[8], numInts*sizeof(int));
+        memcpy(h->data,          fds,      numFds*sizeof(int));
+        memcpy(h->data + numFds, &buf[10], numInts*sizeof(int));
         handle = h;
     } else {
         width = height = stride = format = usage = 0;
@@ -326,6 +441,8 @@ status_t GraphicBuffer::unflatten(void const* buffer, size_t size,
                     strerror(-err), err);
             return err;
         }
+        initPersistentMapping();
+        trackImport();
     }
 
     return NO_ERROR;
@@ -18,13 +18,18 @@
 #define LOG_TAG "GraphicBufferAllocator"
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <unistd.h>
+
 #include <cutils/log.h>
 
+#include <binder/IPCThreadState.h>
+
 #include <utils/Singleton.h>
 #include <utils/String8.h>
 #include <utils/Trace.h>
 
 #include <ui/GraphicBufferAllocator.h>
+#include <ui/GraphicBufferMapper.h>
 
 namespace android {
 // ---------------------------------------------------------------------------
@@ -34,9 +39,22 @@ ANDROID_SINGLETON_STATIC_INSTANCE( GraphicBufferAllocator )
 Mutex GraphicBufferAllocator::sLock;
 KeyedVector<buffer_handle_t,
     GraphicBufferAllocator::alloc_rec_t> GraphicBufferAllocator::sAllocList;
+Vector<GraphicBufferAllocator::pool_rec_t> GraphicBufferAllocator::sPool;
+size_t GraphicBufferAllocator::sPoolSize = 0;
+
+// pooled buffers nobody asked for in that long are freed
+static const nsecs_t MAX_POOL_AGE = s2ns(5);
+
+// the process the buffer is allocated for: the binder caller when the
+// allocation comes from another process, us otherwise
+static pid_t getOwner()
+{
+    IPCThreadState* ipc = IPCThreadState::selfOrNull();
+    return ipc ? pid_t(ipc->getCallingPid()) : getpid();
+}
 
 GraphicBufferAllocator::GraphicBufferAllocator()
-    : mAllocDev(0)
+    : mAllocDev(0), mPoolLimit(0), mPoolHits(0), mPoolMisses(0)
 {
     hw_module_t const* module;
     int err = hw_get_module(GRALLOC_HARDWARE_MODULE_ID, &module);
@@ -77,6 +95,16 @@ void GraphicBufferAllocator::dump(String8& result) const
     }
     snprintf(buffer, SIZE, "Total allocated (estimate): %.2f KB\n", total/1024.0f);
     result.append(buffer);
+    if (mPoolLimit) {
+        const uint32_t lookups = mPoolHits + mPoolMisses;
+        snprintf(buffer, SIZE, "Buffer pool: %u buffers, %.2f of %.2f KB, "
+                "hits=%u, misses=%u (%u%% hit rate)\n",
+                uint32_t(sPool.size()), sPoolSize/1024.0f, mPoolLimit/1024.0f,
+                mPoolHits, mPoolMisses,
+                lookups ? (mPoolHits * 100) / lookups : 0);
+        result.append(buffer);
+    }
+    GraphicBufferMapper::get().dump(result);
     if (mAllocDev->common.version >= 1 && mAllocDev->dump) {
         mAllocDev->dump(mAllocDev, buffer, SIZE);
         result.append(buffer);
@@ -108,6 +136,41 @@ status_t GraphicBufferAllocator::alloc(uint32_t w, uint32_t h,
     if (!w || !h)
         w = h = 1;
 
+    const pid_t owner = getOwner();
+    if (mPoolLimit && !bufferSize && isPoolable(uint32_t(usage))) {
+        Vector<buffer_handle_t> evicted;
+        bool found = false;
+        {
+            Mutex::Autolock _l(sLock);
+            for (size_t i=sPool.size() ; i>0 ; i--) {
+                // the buffers aren't cleared, only their last owner may
+                // get them back
+                const pool_rec_t& p(sPool[i-1]);
+                if (p.rec.w == w && p.rec.h == h && p.rec.format == format &&
+                        p.rec.usage == uint32_t(usage) &&
+                        p.rec.owner == owner) {
+                    *handle = p.handle;
+                    *stride = p.rec.s;
+                    sAllocList.add(p.handle, p.rec);
+                    sPoolSize -= p.rec.size;
+                    sPool.removeAt(i-1);
+                    found = true;
+                    break;
+                }
+            }
+            if (found) {
+                mPoolHits++;
+            } else {
+                mPoolMisses++;
+            }
+            trimPoolLocked(mPoolLimit, MAX_POOL_AGE, &evicted);
+        }
+        freeEvicted(evicted);
+        if (found) {
+            return NO_ERROR;
+        }
+    }
+
     // we have a h/w allocator and h/w buffer is requested
     status_t err;
 #ifdef QCOM_BSP
@@ -151,6 +214,7 @@ status_t GraphicBufferAllocator::alloc(uint32_t w, uint32_t h,
         rec.format = format;
         rec.usage = usage;
         rec.size = h * stride[0] * bpp;
+        rec.owner = owner;
         list.add(*handle, rec);
     }
 
@@ -162,6 +226,35 @@ status_t GraphicBufferAllocator::free(buffer_handle_t handle)
     ATRACE_CALL();
     status_t err;
 
+    GraphicBufferMapper::get().purge(handle);
+
+    if (mPoolLimit) {
+        Vector<buffer_handle_t> evicted;
+        bool pooled = false;
+        {
+            Mutex::Autolock _l(sLock);
+            ssize_t index = sAllocList.indexOfKey(handle);
+            if (index >= 0) {
+                const alloc_rec_t& rec(sAllocList.valueAt(index));
+                if (isPoolable(rec) && rec.size <= mPoolLimit) {
+                    pool_rec_t p;
+                    p.handle = handle;
+                    p.rec = rec;
+                    p.freeTime = systemTime();
+                    sPool.add(p);
+                    sPoolSize += rec.size;
+                    sAllocList.removeItemsAt(index);
+                    pooled = true;
+                }
+            }
+            trimPoolLocked(mPoolLimit, MAX_POOL_AGE, &evicted);
+        }
+        freeEvicted(evicted);
+        if (pooled) {
+            return NO_ERROR;
+        }
+    }
+
     err = mAllocDev->free(mAllocDev, handle);
 
     ALOGW_IF(err, "free(...) failed %d (%s)", err, strerror(-err));
@@ -174,5 +267,60 @@ status_t GraphicBufferAllocator::free(buffer_handle_t handle)
     return err;
 }
 
+bool GraphicBufferAllocator::isPoolable(const alloc_rec_t& rec)
+{
+    // buffers of unknown size can't be accounted for
+    return rec.size && isPoolable(rec.usage);
+}
+
+bool GraphicBufferAllocator::isPoolable(uint32_t usage)
+{
+    return !(usage & (USAGE_SOFTWARE_MASK | GRALLOC_USAGE_PROTECTED));
+}
+
+void GraphicBufferAllocator::setPoolLimit(size_t bytes)
+{
+    Vector<buffer_handle_t> evicted;
+    {
+        Mutex::Autolock _l(sLock);
+        mPoolLimit = bytes;
+        trimPoolLocked(bytes, 0, &evicted);
+    }
+    freeEvicted(evicted);
+}
+
+void GraphicBufferAllocator::trimPool(nsecs_t maxAge)
+{
+    Vector<buffer_handle_t> evicted;
+    {
+        Mutex::Autolock _l(sLock);
+        trimPoolLocked(maxAge ? mPoolLimit : 0, maxAge, &evicted);
+    }
+    freeEvicted(evicted);
+}
+
+void GraphicBufferAllocator::trimPoolLocked(size_t limit, nsecs_t maxAge,
+        Vector<buffer_handle_t>* evicted)
+{
+    const nsecs_t now = systemTime();
+    while (!sPool.isEmpty()) {
+        const pool_rec_t& p(sPool[0]);
+        if (sPoolSize <= limit && (!maxAge || now - p.freeTime <= maxAge)) {
+            break;
+        }
+        evicted->add(p.handle);
+        sPoolSize -= p.rec.size;
+        sPool.removeAt(0);
+    }
+}
+
+void GraphicBufferAllocator::freeEvicted(const Vector<buffer_handle_t>& evicted)
+{
+    for (size_t i=0 ; i<evicted.size() ; i++) {
+        status_t err = mAllocDev->free(mAllocDev, evicted[i]);
+        ALOGW_IF(err, "free(...) failed %d (%s)", err, strerror(-err));
+    }
+}
+
 // ---------------------------------------------------------------------------
 }; // namespace android
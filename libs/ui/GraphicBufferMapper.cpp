@@ -22,6 +22,7 @@
 
 #include <utils/Errors.h>
 #include <utils/Log.h>
+#include <utils/String8.h>
 #include <utils/Trace.h>
 
 #include <ui/GraphicBufferMapper.h>
@@ -35,6 +36,12 @@ namespace android {
 
 ANDROID_SINGLETON_STATIC_INSTANCE( GraphicBufferMapper )
 
+GraphicBufferMapper::lock_rec_t::lock_rec_t()
+    : persistent(false), locked(false), held(false), heldUsage(0),
+      vaddr(0), locks(0), cachedLocks(0), pixels(0), grallocTime(0)
+{
+}
+
 GraphicBufferMapper::GraphicBufferMapper()
     : mAllocMod(0)
 {
@@ -63,6 +70,7 @@ status_t GraphicBufferMapper::unregisterBuffer(buffer_handle_t handle)
     ATRACE_CALL();
     status_t err;
 
+    purge(handle);
     err = mAllocMod->unregisterBuffer(mAllocMod, handle);
 
     ALOGW_IF(err, "unregisterBuffer(%p) failed %d (%s)",
@@ -75,12 +83,67 @@ status_t GraphicBufferMapper::lock(buffer_handle_t handle,
 {
     ATRACE_CALL();
     status_t err;
+    bool release = false;
+    int lockUsage = usage;
+    Rect lockBounds(bounds);
 
-    err = mAllocMod->lock(mAllocMod, handle, usage,
-            bounds.left, bounds.top, bounds.width(), bounds.height(),
+    { // scope for the lock
+        Mutex::Autolock _l(mLock);
+        lock_rec_t& rec(editRecLocked(handle));
+        rec.locks++;
+        rec.pixels += uint64_t(bounds.width()) * bounds.height();
+        if (rec.held) {
+            if ((rec.heldUsage & usage) == usage &&
+                    rec.heldBounds.contains(bounds)) {
+                rec.cachedLocks++;
+                rec.locked = true;
+                *vaddr = rec.vaddr;
+                return NO_ERROR;
+            }
+            // lock again with both usages, over both rectangles, so that
+            // the next lock is more likely to be satisfied
+            release = true;
+            rec.held = false;
+            lockUsage |= rec.heldUsage;
+            const Rect& held(rec.heldBounds);
+            if (held.left < lockBounds.left) lockBounds.left = held.left;
+            if (held.top < lockBounds.top) lockBounds.top = held.top;
+            if (held.right > lockBounds.right) lockBounds.right = held.right;
+            if (held.bottom > lockBounds.bottom) lockBounds.bottom = held.bottom;
+        }
+        if (!rec.persistent) {
+            lockUsage = usage;
+            lockBounds = bounds;
+        }
+    }
+
+    const nsecs_t start = systemTime();
+    if (release) {
+        releaseHeld(handle);
+    }
+    err = mAllocMod->lock(mAllocMod, handle, lockUsage,
+            lockBounds.left, lockBounds.top,
+            lockBounds.width(), lockBounds.height(),
             vaddr);
+    const nsecs_t duration = systemTime() - start;
 
     ALOGW_IF(err, "lock(...) failed %d (%s)", err, strerror(-err));
+
+    Mutex::Autolock _l(mLock);
+    ssize_t index = mLockRecs.indexOfKey(handle);
+    if (index >= 0) {
+        lock_rec_t& rec(mLockRecs.editValueAt(index));
+        rec.grallocTime += duration;
+        if (err == NO_ERROR) {
+            rec.locked = true;
+            if (rec.persistent) {
+                rec.held = true;
+                rec.heldUsage = lockUsage;
+                rec.heldBounds = lockBounds;
+                rec.vaddr = *vaddr;
+            }
+        }
+    }
     return err;
 }
 
@@ -90,6 +153,26 @@ status_t GraphicBufferMapper::lockYCbCr(buffer_handle_t handle,
     ATRACE_CALL();
     status_t err;
 
+    if (mAllocMod->common.module_api_version < GRALLOC_MODULE_API_VERSION_0_2 ||
+            mAllocMod->lock_ycbcr == NULL) {
+        // this gralloc can't describe the planes of a buffer
+        return -EINVAL;
+    }
+
+    // the planes are not cached, the whole lock goes to gralloc
+    bool release = false;
+    {
+        Mutex::Autolock _l(mLock);
+        ssize_t index = mLockRecs.indexOfKey(handle);
+        if (index >= 0 && mLockRecs.valueAt(index).held) {
+            mLockRecs.editValueAt(index).held = false;
+            release = true;
+        }
+    }
+    if (release) {
+        releaseHeld(handle);
+    }
+
     err = mAllocMod->lock_ycbcr(mAllocMod, handle, usage,
             bounds.left, bounds.top, bounds.width(), bounds.height(),
             ycbcr);
@@ -103,12 +186,109 @@ status_t GraphicBufferMapper::unlock(buffer_handle_t handle)
     ATRACE_CALL();
     status_t err;
 
+    {
+        Mutex::Autolock _l(mLock);
+        ssize_t index = mLockRecs.indexOfKey(handle);
+        if (index >= 0) {
+            lock_rec_t& rec(mLockRecs.editValueAt(index));
+            rec.locked = false;
+            if (rec.held) {
+                // stays locked in gralloc until the next incompatible lock
+                return NO_ERROR;
+            }
+        }
+    }
+
+    const nsecs_t start = systemTime();
     err = mAllocMod->unlock(mAllocMod, handle);
+    const nsecs_t duration = systemTime() - start;
 
     ALOGW_IF(err, "unlock(...) failed %d (%s)", err, strerror(-err));
+
+    Mutex::Autolock _l(mLock);
+    ssize_t index = mLockRecs.indexOfKey(handle);
+    if (index >= 0) {
+        mLockRecs.editValueAt(index).grallocTime += duration;
+    }
     return err;
 }
 
+GraphicBufferMapper::lock_rec_t& GraphicBufferMapper::editRecLocked(
+        buffer_handle_t handle)
+{
+    ssize_t index = mLockRecs.indexOfKey(handle);
+    if (index < 0) {
+        index = mLockRecs.add(handle, lock_rec_t());
+    }
+    return mLockRecs.editValueAt(index);
+}
+
+status_t GraphicBufferMapper::releaseHeld(buffer_handle_t handle)
+{
+    status_t err = mAllocMod->unlock(mAllocMod, handle);
+    ALOGW_IF(err, "unlock(...) of a persistent mapping failed %d (%s)",
+            err, strerror(-err));
+    return err;
+}
+
+status_t GraphicBufferMapper::setPersistentMapping(buffer_handle_t handle,
+        bool enable)
+{
+    bool release = false;
+    {
+        Mutex::Autolock _l(mLock);
+        lock_rec_t& rec(editRecLocked(handle));
+        rec.persistent = enable;
+        if (!enable && rec.held) {
+            rec.held = false;
+            // a buffer locked by its user stays locked, its unlock() will
+            // go to gralloc now that it isn't held anymore
+            release = !rec.locked;
+        }
+    }
+    return release ? releaseHeld(handle) : status_t(NO_ERROR);
+}
+
+void GraphicBufferMapper::purge(buffer_handle_t handle)
+{
+    bool release = false;
+    {
+        Mutex::Autolock _l(mLock);
+        ssize_t index = mLockRecs.indexOfKey(handle);
+        if (index < 0) {
+            return;
+        }
+        const lock_rec_t& rec(mLockRecs.valueAt(index));
+        release = rec.held && !rec.locked;
+        mLockRecs.removeItemsAt(index);
+    }
+    if (release) {
+        releaseHeld(handle);
+    }
+}
+
+void GraphicBufferMapper::dump(String8& result) const
+{
+    Mutex::Autolock _l(mLock);
+    const size_t SIZE = 256;
+    char buffer[SIZE];
+    snprintf(buffer, SIZE, "Locked buffers:\n");
+    result.append(buffer);
+    for (size_t i=0 ; i<mLockRecs.size() ; i++) {
+        const lock_rec_t& rec(mLockRecs.valueAt(i));
+        if (!rec.locks) {
+            continue;
+        }
+        snprintf(buffer, SIZE, "%10p: %6u locks (%6u cached) | %8.2f Mpix | "
+                "%8.2f ms in gralloc%s%s\n",
+                mLockRecs.keyAt(i), rec.locks, rec.cachedLocks,
+                rec.pixels / 1000000.0, rec.grallocTime / 1000000.0,
+                rec.persistent ? " | persistent" : "",
+                rec.locked ? " | locked" : "");
+        result.append(buffer);
+    }
+}
+
 status_t GraphicBufferMapper::perform(buffer_handle_t handle, int operation,
                            uint32_t w, uint32_t h, uint32_t format)
 {
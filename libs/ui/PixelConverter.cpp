@@ -0,0 +1,403 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <hardware/hardware.h>
+
+#include <ui/PixelConverter.h>
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PC_USE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PC_USE_SSE2 1
+#endif
+
+// ----------------------------------------------------------------------------
+namespace android {
+// ----------------------------------------------------------------------------
+
+// The 32-bit formats are read and written as words: RGBA_8888 (R,G,B,A in
+// memory) is 0xAABBGGRR and BGRA_8888 is 0xAARRGGBB on little-endian CPUs.
+
+typedef void (*RowFunction)(void* dst, const void* src, size_t width);
+
+static inline uint32_t swapRB(uint32_t p) {
+    return (p & 0xFF00FF00) | ((p >> 16) & 0xFF) | ((p & 0xFF) << 16);
+}
+
+static inline uint16_t pack565(uint32_t r, uint32_t g, uint32_t b) {
+    return uint16_t(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+// the components are widened by replicating their high bits, so that
+// white stays white
+static inline uint32_t unpack565(uint16_t p, bool bgra) {
+    uint32_t r = p >> 11;
+    uint32_t g = (p >> 5) & 0x3F;
+    uint32_t b = p & 0x1F;
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+    return bgra ? (0xFF000000 | (r << 16) | (g << 8) | b) :
+                  (0xFF000000 | (b << 16) | (g << 8) | r);
+}
+
+static inline uint8_t clamp255(int32_t v) {
+    return uint8_t(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// ----------------------------------------------------------------------------
+// row kernels, each does what it can with SIMD and finishes the row with
+// plain C
+
+static void copy32(void* dst, const void* src, size_t width) {
+    memcpy(dst, src, width * 4);
+}
+
+static void copy16(void* dst, const void* src, size_t width) {
+    memcpy(dst, src, width * 2);
+}
+
+// RGBA <-> BGRA, and to or from RGBX
+template <bool opaque>
+static void swapRB32(void* dst, const void* src, size_t width) {
+    uint32_t* d = reinterpret_cast<uint32_t*>(dst);
+    const uint32_t* s = reinterpret_cast<const uint32_t*>(src);
+    size_t i = 0;
+#if defined(PC_USE_NEON)
+    for ( ; i+16 <= width ; i += 16) {
+        uint8x16x4_t px = vld4q_u8(reinterpret_cast<const uint8_t*>(s + i));
+        const uint8x16_t t = px.val[0];
+        px.val[0] = px.val[2];
+        px.val[2] = t;
+        if (opaque) {
+            px.val[3] = vdupq_n_u8(0xFF);
+        }
+        vst4q_u8(reinterpret_cast<uint8_t*>(d + i), px);
+    }
+#elif defined(PC_USE_SSE2)
+    const __m128i rbMask = _mm_set1_epi32(0x00FF00FF);
+    const __m128i alpha = _mm_set1_epi32(opaque ? 0xFF000000 : 0);
+    for ( ; i+4 <= width ; i += 4) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i rb = _mm_and_si128(p, rbMask);
+        __m128i ga = _mm_or_si128(_mm_andnot_si128(rbMask, p), alpha);
+        rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                _mm_or_si128(ga, rb));
+    }
+#endif
+    for ( ; i<width ; i++) {
+        d[i] = swapRB(s[i]) | (opaque ? 0xFF000000 : 0);
+    }
+}
+
+// RGBX -> RGBA
+static void setAlpha32(void* dst, const void* src, size_t width) {
+    uint32_t* d = reinterpret_cast<uint32_t*>(dst);
+    const uint32_t* s = reinterpret_cast<const uint32_t*>(src);
+    size_t i = 0;
+#if defined(PC_USE_NEON)
+    const uint32x4_t alpha = vdupq_n_u32(0xFF000000);
+    for ( ; i+4 <= width ; i += 4) {
+        vst1q_u32(d + i, vorrq_u32(vld1q_u32(s + i), alpha));
+    }
+#elif defined(PC_USE_SSE2)
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    for ( ; i+4 <= width ; i += 4) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                _mm_or_si128(p, alpha));
+    }
+#endif
+    for ( ; i<width ; i++) {
+        d[i] = s[i] | 0xFF000000;
+    }
+}
+
+#if defined(PC_USE_SSE2)
+// packs 4 pixels to 565 in the low half of each 32-bit lane, sign-extended
+// so that _mm_packs_epi32() doesn't saturate them
+template <bool bgra>
+static inline __m128i to565x4(__m128i p) {
+    const __m128i r = bgra ?
+            _mm_and_si128(_mm_srli_epi32(p, 8), _mm_set1_epi32(0xF800)) :
+            _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF8)), 8);
+    const __m128i g = _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x07E0));
+    const __m128i b = bgra ?
+            _mm_and_si128(_mm_srli_epi32(p, 3), _mm_set1_epi32(0x1F)) :
+            _mm_and_si128(_mm_srli_epi32(p, 19), _mm_set1_epi32(0x1F));
+    const __m128i v = _mm_or_si128(_mm_or_si128(r, g), b);
+    return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+}
+
+template <bool bgra>
+static inline __m128i from565x4(__m128i p) {
+    const __m128i r5 = _mm_srli_epi32(p, 11);
+    const __m128i g6 = _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x3F));
+    const __m128i b5 = _mm_and_si128(p, _mm_set1_epi32(0x1F));
+    const __m128i r = _mm_or_si128(_mm_slli_epi32(r5, 3), _mm_srli_epi32(r5, 2));
+    const __m128i g = _mm_or_si128(_mm_slli_epi32(g6, 2), _mm_srli_epi32(g6, 4));
+    const __m128i b = _mm_or_si128(_mm_slli_epi32(b5, 3), _mm_srli_epi32(b5, 2));
+    const __m128i rb = bgra ?
+            _mm_or_si128(_mm_slli_epi32(r, 16), b) :
+            _mm_or_si128(_mm_slli_epi32(b, 16), r);
+    return _mm_or_si128(_mm_or_si128(rb, _mm_slli_epi32(g, 8)),
+            _mm_set1_epi32(0xFF000000));
+}
+#endif
+
+// RGBA, RGBX or BGRA -> RGB_565
+template <bool bgra>
+static void to565(void* dst, const void* src, size_t width) {
+    uint16_t* d = reinterpret_cast<uint16_t*>(dst);
+    const uint32_t* s = reinterpret_cast<const uint32_t*>(src);
+    size_t i = 0;
+#if defined(PC_USE_NEON)
+    for ( ; i+8 <= width ; i += 8) {
+        uint8x8x4_t px = vld4_u8(reinterpret_cast<const uint8_t*>(s + i));
+        uint16x8_t p = vshll_n_u8(px.val[bgra ? 2 : 0], 8);
+        p = vsriq_n_u16(p, vshll_n_u8(px.val[1], 8), 5);
+        p = vsriq_n_u16(p, vshll_n_u8(px.val[bgra ? 0 : 2], 8), 11);
+        vst1q_u16(d + i, p);
+    }
+#elif defined(PC_USE_SSE2)
+    for ( ; i+8 <= width ; i += 8) {
+        __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                _mm_packs_epi32(to565x4<bgra>(p0), to565x4<bgra>(p1)));
+    }
+#endif
+    for ( ; i<width ; i++) {
+        const uint32_t p = s[i];
+        d[i] = bgra ? pack565((p >> 16) & 0xFF, (p >> 8) & 0xFF, p & 0xFF) :
+                      pack565(p & 0xFF, (p >> 8) & 0xFF, (p >> 16) & 0xFF);
+    }
+}
+
+// RGB_565 -> RGBA, RGBX or BGRA
+template <bool bgra>
+static void from565(void* dst, const void* src, size_t width) {
+    uint32_t* d = reinterpret_cast<uint32_t*>(dst);
+    const uint16_t* s = reinterpret_cast<const uint16_t*>(src);
+    size_t i = 0;
+#if defined(PC_USE_NEON)
+    for ( ; i+8 <= width ; i += 8) {
+        const uint16x8_t p = vld1q_u16(s + i);
+        // each component in the high bits, its high bits repeated below
+        uint8x8_t r = vshrn_n_u16(p, 8);
+        r = vsri_n_u8(r, r, 5);
+        uint8x8_t g = vshrn_n_u16(p, 3);
+        g = vsri_n_u8(g, g, 6);
+        uint8x8_t b = vmovn_u16(vshlq_n_u16(p, 3));
+        b = vsri_n_u8(b, b, 5);
+        uint8x8x4_t px;
+        px.val[bgra ? 2 : 0] = r;
+        px.val[1] = g;
+        px.val[bgra ? 0 : 2] = b;
+        px.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(reinterpret_cast<uint8_t*>(d + i), px);
+    }
+#elif defined(PC_USE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; i+8 <= width ; i += 8) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                from565x4<bgra>(_mm_unpacklo_epi16(p, zero)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i + 4),
+                from565x4<bgra>(_mm_unpackhi_epi16(p, zero)));
+    }
+#endif
+    for ( ; i<width ; i++) {
+        d[i] = unpack565(s[i], bgra);
+    }
+}
+
+// 4:2:0 YCbCr (BT.601, video range) -> RGBA, u and v are the chroma row
+// with step bytes between two samples
+static void yuvToRGBA(uint32_t* d, const uint8_t* y,
+        const uint8_t* u, const uint8_t* v, size_t step, size_t width) {
+    for (size_t i=0 ; i<width ; i++) {
+        const int32_t c = 298 * (int32_t(y[i]) - 16) + 128;
+        const int32_t cb = int32_t(u[(i >> 1) * step]) - 128;
+        const int32_t cr = int32_t(v[(i >> 1) * step]) - 128;
+        const uint32_t r = clamp255((c + 409*cr) >> 8);
+        const uint32_t g = clamp255((c - 100*cb - 208*cr) >> 8);
+        const uint32_t b = clamp255((c + 516*cb) >> 8);
+        d[i] = 0xFF000000 | (b << 16) | (g << 8) | r;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static bool isRGB(PixelFormat format) {
+    switch (format) {
+        case PIXEL_FORMAT_RGBA_8888:
+        case PIXEL_FORMAT_RGBX_8888:
+        case PIXEL_FORMAT_BGRA_8888:
+        case PIXEL_FORMAT_RGB_565:
+            return true;
+    }
+    return false;
+}
+
+static bool isYUV(PixelFormat format) {
+    return format == HAL_PIXEL_FORMAT_YV12 ||
+            format == HAL_PIXEL_FORMAT_YCrCb_420_SP;
+}
+
+static RowFunction findRowFunction(PixelFormat src, PixelFormat dst) {
+    if (src == dst) {
+        return (src == PIXEL_FORMAT_RGB_565) ? copy16 : copy32;
+    }
+    switch (src) {
+        case PIXEL_FORMAT_RGBA_8888:
+            switch (dst) {
+                case PIXEL_FORMAT_RGBX_8888:    return copy32;
+                case PIXEL_FORMAT_BGRA_8888:    return swapRB32<false>;
+                case PIXEL_FORMAT_RGB_565:      return to565<false>;
+            }
+            break;
+        case PIXEL_FORMAT_RGBX_8888:
+            switch (dst) {
+                case PIXEL_FORMAT_RGBA_8888:    return setAlpha32;
+                case PIXEL_FORMAT_BGRA_8888:    return swapRB32<true>;
+                case PIXEL_FORMAT_RGB_565:      return to565<false>;
+            }
+            break;
+        case PIXEL_FORMAT_BGRA_8888:
+            switch (dst) {
+                case PIXEL_FORMAT_RGBA_8888:    return swapRB32<false>;
+                case PIXEL_FORMAT_RGBX_8888:    return swapRB32<false>;
+                case PIXEL_FORMAT_RGB_565:      return to565<true>;
+            }
+            break;
+        case PIXEL_FORMAT_RGB_565:
+            switch (dst) {
+                case PIXEL_FORMAT_RGBA_8888:    return from565<false>;
+                case PIXEL_FORMAT_RGBX_8888:    return from565<false>;
+                case PIXEL_FORMAT_BGRA_8888:    return from565<true>;
+            }
+            break;
+    }
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+
+PixelConverter::PixelConverter(PixelFormat srcFormat, PixelFormat dstFormat)
+    : mSrcFormat(srcFormat), mDstFormat(dstFormat), mRow(NULL)
+{
+    if (isYUV(srcFormat)) {
+        // YUV is always converted to RGBA first
+        if (isRGB(dstFormat) && dstFormat != PIXEL_FORMAT_RGBA_8888) {
+            mRow = findRowFunction(PIXEL_FORMAT_RGBA_8888, dstFormat);
+        }
+    } else {
+        mRow = findRowFunction(srcFormat, dstFormat);
+    }
+}
+
+bool PixelConverter::isSupported(PixelFormat srcFormat, PixelFormat dstFormat) {
+    return isRGB(dstFormat) && (isRGB(srcFormat) || isYUV(srcFormat));
+}
+
+status_t PixelConverter::initCheck() const {
+    return isSupported(mSrcFormat, mDstFormat) ? NO_ERROR : BAD_VALUE;
+}
+
+void PixelConverter::convertRow(void* dst, const void* src, size_t width) const {
+    if (!isYUV(mSrcFormat) && mRow) {
+        mRow(dst, src, width);
+    }
+}
+
+status_t PixelConverter::convert(void* dst, size_t dstStride,
+        const void* src, size_t srcStride,
+        size_t width, size_t height) const
+{
+    if (initCheck() != NO_ERROR) {
+        return BAD_VALUE;
+    }
+
+    const size_t dstBpp = (mDstFormat == PIXEL_FORMAT_RGB_565) ? 2 : 4;
+    const size_t dstBpr = dstStride * dstBpp;
+    uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+
+    if (!isYUV(mSrcFormat)) {
+        const size_t srcBpr = srcStride * (mSrcFormat == PIXEL_FORMAT_RGB_565 ? 2 : 4);
+        const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+        for (size_t y=0 ; y<height ; y++) {
+            mRow(d, s, width);
+            d += dstBpr;
+            s += srcBpr;
+        }
+        return NO_ERROR;
+    }
+
+    // the chroma planes, with the same layouts as in gralloc:
+    // YV12 is Y, then Cr and Cb with a 16-aligned stride of half the Y's,
+    // NV21 is Y, then interleaved Cr,Cb with the same stride as Y
+    const uint8_t* yPlane = reinterpret_cast<const uint8_t*>(src);
+    const uint8_t* uPlane;
+    const uint8_t* vPlane;
+    size_t chromaStride;
+    size_t step;
+    if (mSrcFormat == HAL_PIXEL_FORMAT_YV12) {
+        chromaStride = ((srcStride / 2) + 15) & ~15;
+        vPlane = yPlane + srcStride * height;
+        uPlane = vPlane + chromaStride * (height / 2);
+        step = 1;
+    } else {
+        chromaStride = srcStride;
+        vPlane = yPlane + srcStride * height;
+        uPlane = vPlane + 1;
+        step = 2;
+    }
+
+    // without a direct kernel, go through RGBA a chunk of a row at a time
+    const size_t kChunk = 256;
+    uint32_t rgba[kChunk];
+    for (size_t y=0 ; y<height ; y++) {
+        const uint8_t* yRow = yPlane + y * srcStride;
+        const uint8_t* uRow = uPlane + (y / 2) * chromaStride;
+        const uint8_t* vRow = vPlane + (y / 2) * chromaStride;
+        if (mRow == NULL) {
+            yuvToRGBA(reinterpret_cast<uint32_t*>(d), yRow, uRow, vRow,
+                    step, width);
+        } else {
+            for (size_t x=0 ; x<width ; x += kChunk) {
+                const size_t n = (width - x < kChunk) ? width - x : kChunk;
+                // chunks start on even pixels, they share no chroma sample
+                yuvToRGBA(rgba, yRow + x, uRow + (x / 2) * step,
+                        vRow + (x / 2) * step, step, n);
+                mRow(d + x * dstBpp, rgba, n);
+            }
+        }
+        d += dstBpr;
+    }
+    return NO_ERROR;
+}
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+// ----------------------------------------------------------------------------
@@ -19,6 +19,7 @@
 #include <limits.h>
 
 #include <utils/Log.h>
+#include <utils/SharedBuffer.h>
 #include <utils/String8.h>
 #include <utils/CallStack.h>
 
@@ -54,6 +55,125 @@ enum {
 
 // ----------------------------------------------------------------------------
 
+Region::Storage::Storage(const Storage& rhs)
+    : mCount(rhs.mCount), mRects(mInline)
+{
+    if (rhs.isInline()) {
+        memcpy(mInline, rhs.mInline, mCount * sizeof(Rect));
+    } else {
+        SharedBuffer::bufferFromData(rhs.mRects)->acquire();
+        mRects = rhs.mRects;
+    }
+}
+
+Region::Storage::~Storage() {
+    releaseBuffer();
+}
+
+Region::Storage& Region::Storage::operator = (const Storage& rhs) {
+    if (this != &rhs) {
+        if (rhs.isInline()) {
+            releaseBuffer();
+            memcpy(mInline, rhs.mInline, rhs.mCount * sizeof(Rect));
+        } else if (mRects != rhs.mRects) {
+            SharedBuffer::bufferFromData(rhs.mRects)->acquire();
+            releaseBuffer();
+            mRects = rhs.mRects;
+        }
+        mCount = rhs.mCount;
+    }
+    return *this;
+}
+
+void Region::Storage::releaseBuffer() {
+    if (!isInline()) {
+        SharedBuffer::bufferFromData(mRects)->release();
+        mRects = mInline;
+    }
+}
+
+Rect* Region::Storage::editArray(size_t count) {
+    // returns a writable array with room for count rects, the current
+    // ones are preserved
+    if (isInline()) {
+        if (count <= INLINE_CAPACITY) {
+            return mInline;
+        }
+        SharedBuffer* sb = SharedBuffer::alloc(count * 2 * sizeof(Rect));
+        if (sb == NULL) {
+            return NULL;
+        }
+        memcpy(sb->data(), mInline, mCount * sizeof(Rect));
+        mRects = static_cast<Rect*>(sb->data());
+        return mRects;
+    }
+    SharedBuffer const* sb = SharedBuffer::bufferFromData(mRects);
+    size_t capacity = sb->size() / sizeof(Rect);
+    if (count > capacity) {
+        capacity = count * 2;
+    } else if (sb->onlyOwner()) {
+        return mRects;
+    }
+    SharedBuffer* editable = sb->editResize(capacity * sizeof(Rect));
+    if (editable == NULL) {
+        return NULL;
+    }
+    mRects = static_cast<Rect*>(editable->data());
+    return mRects;
+}
+
+Rect* Region::Storage::editArray() {
+    return editArray(mCount);
+}
+
+void Region::Storage::clear() {
+    // keep a buffer nobody else uses, it's about to be filled again
+    if (!isInline() && !SharedBuffer::bufferFromData(mRects)->onlyOwner()) {
+        releaseBuffer();
+    }
+    mCount = 0;
+}
+
+void Region::Storage::add(const Rect& rect) {
+    insertAt(rect, mCount);
+}
+
+void Region::Storage::insertAt(const Rect& rect, size_t index) {
+    Rect* const rects = editArray(mCount + 1);
+    LOG_ALWAYS_FATAL_IF(rects == NULL, "Region: out of memory");
+    memmove(rects + index + 1, rects + index, (mCount - index) * sizeof(Rect));
+    rects[index] = rect;
+    mCount++;
+}
+
+void Region::Storage::removeItemsAt(size_t index, size_t count) {
+    Rect* const rects = editArray(mCount);
+    LOG_ALWAYS_FATAL_IF(rects == NULL, "Region: out of memory");
+    memmove(rects + index, rects + index + count,
+            (mCount - index - count) * sizeof(Rect));
+    mCount -= count;
+}
+
+status_t Region::Storage::resize(size_t count) {
+    if (editArray(count) == NULL) {
+        return NO_MEMORY;
+    }
+    mCount = count;
+    return NO_ERROR;
+}
+
+SharedBuffer const* Region::Storage::getSharedBuffer() const {
+    if (isInline()) {
+        SharedBuffer* sb = SharedBuffer::alloc(mCount * sizeof(Rect));
+        LOG_ALWAYS_FATAL_IF(sb == NULL, "Region: out of memory");
+        memcpy(sb->data(), mInline, mCount * sizeof(Rect));
+        const_cast<Storage*>(this)->mRects = static_cast<Rect*>(sb->data());
+    }
+    return SharedBuffer::bufferFromData(mRects);
+}
+
+// ----------------------------------------------------------------------------
+
 Region::Region() {
     mStorage.add(Rect(0,0));
 }
@@ -88,8 +208,9 @@ Region::~Region()
  * final, correctly ordered region buffer. Each rectangle will be compared with the span directly
  * above it, and subdivided to resolve any remaining T-junctions.
  */
+template<typename VECTOR>
 static void reverseRectsResolvingJunctions(const Rect* begin, const Rect* end,
-        Vector<Rect>& dst, int spanDirection) {
+        VECTOR& dst, int spanDirection) {
     dst.clear();
 
     const Rect* current = end - 1;
@@ -240,7 +361,15 @@ void Region::set(uint32_t w, uint32_t h)
 }
 
 bool Region::isTriviallyEqual(const Region& region) const {
-    return begin() == region.begin();
+    if (begin() == region.begin()) {
+        return true;
+    }
+    // inline regions are never shared, but they're small
+    const size_t count = mStorage.size();
+    return mStorage.isInline() && region.mStorage.isInline() &&
+            count == region.mStorage.size() &&
+            !memcmp(mStorage.array(), region.mStorage.array(),
+                    count * sizeof(Rect));
 }
 
 // ----------------------------------------------------------------------------
@@ -249,7 +378,7 @@ void Region::addRectUnchecked(int l, int t, int r, int b)
 {
     Rect rect(l,t,r,b);
     size_t where = mStorage.size() - 1;
-    mStorage.insertAt(rect, where, 1);
+    mStorage.insertAt(rect, where);
 }
 
 // ----------------------------------------------------------------------------
@@ -288,7 +417,8 @@ Region& Region::subtractSelf(const Region& rhs) {
 }
 Region& Region::operationSelf(const Region& rhs, int op) {
     Region lhs(*this);
-    boolean_operation(op, *this, lhs, rhs);
+    // the rects of an inline region would be overwritten by the result
+    boolean_operation(op, *this, lhs, &rhs == this ? lhs : rhs);
     return *this;
 }
 
@@ -297,6 +427,11 @@ Region& Region::translateSelf(int x, int y) {
     return *this;
 }
 
+Region& Region::flipSelf(bool flipH, bool flipV, int dx, int dy) {
+    flip(*this, flipH, flipV, dx, dy);
+    return *this;
+}
+
 // ----------------------------------------------------------------------------
 
 const Region Region::merge(const Rect& rhs) const {
@@ -343,6 +478,12 @@ const Region Region::translate(int x, int y) const {
     return result;
 }
 
+const Region Region::flip(bool flipH, bool flipV, int dx, int dy) const {
+    Region result(*this);
+    flip(result, flipH, flipV, dx, dy);
+    return result;
+}
+
 // ----------------------------------------------------------------------------
 
 Region& Region::orSelf(const Region& rhs, int dx, int dy) {
@@ -359,7 +500,7 @@ Region& Region::subtractSelf(const Region& rhs, int dx, int dy) {
 }
 Region& Region::operationSelf(const Region& rhs, int dx, int dy, int op) {
     Region lhs(*this);
-    boolean_operation(op, *this, lhs, rhs, dx, dy);
+    boolean_operation(op, *this, lhs, &rhs == this ? lhs : rhs, dx, dy);
     return *this;
 }
 
@@ -387,13 +528,16 @@ const Region Region::operation(const Region& rhs, int dx, int dy, int op) const
 
 // This is our region rasterizer, which merges rects and spans together
 // to obtain an optimal region.
+// Spans are written straight into the region's storage: the previous span
+// is [head, tail) and the current one [tail, size). When the current span
+// can be merged with the previous one it's simply dropped, so no temporary
+// span is allocated or copied.
 class Region::rasterizer : public region_operator<Rect>::region_rasterizer 
 {
     Rect bounds;
-    Vector<Rect>& storage;
-    Rect* head;
-    Rect* tail;
-    Vector<Rect> span;
+    Storage& storage;
+    size_t head;
+    size_t tail;
     Rect* cur;
 public:
     rasterizer(Region& reg) 
@@ -402,7 +546,7 @@ public:
     }
 
     ~rasterizer() {
-        if (span.size()) {
+        if (storage.size() > tail) {
             flushSpan();
         }
         if (storage.size()) {
@@ -421,7 +565,7 @@ public:
     virtual void operator()(const Rect& rect) {
         //ALOGD(">>> %3d, %3d, %3d, %3d",
         //        rect.left, rect.top, rect.right, rect.bottom);
-        if (span.size()) {
+        if (storage.size() > tail) {
             if (cur->top != rect.top) {
                 flushSpan();
             } else if (cur->right == rect.left) {
@@ -429,45 +573,50 @@ public:
                 return;
             }
         }
-        span.add(rect);
-        cur = span.editArray() + (span.size() - 1);
+        storage.add(rect);
+        cur = storage.editArray() + (storage.size() - 1);
     }
 private:
     template<typename T> 
     static inline T min(T rhs, T lhs) { return rhs < lhs ? rhs : lhs; }
     template<typename T> 
     static inline T max(T rhs, T lhs) { return rhs > lhs ? rhs : lhs; }
+
+    // spans of the same size match if all their rects have the same
+    // horizontal extent. Two rects are compared per iteration, long spans
+    // (large windows lists) are the common case here.
+    static bool spansMatch(Rect const* p, Rect const* q, size_t count) {
+        while (count >= 2) {
+            if (((p[0].left ^ q[0].left) | (p[0].right ^ q[0].right) |
+                 (p[1].left ^ q[1].left) | (p[1].right ^ q[1].right)) != 0) {
+                return false;
+            }
+            p += 2, q += 2, count -= 2;
+        }
+        return !count || (p->left == q->left && p->right == q->right);
+    }
+
     void flushSpan() {
+        const size_t count = storage.size() - tail;
+        Rect* const span = storage.editArray() + tail;
+        Rect* const prev = span - (tail - head);
         bool merge = false;
-        if (tail-head == ssize_t(span.size())) {
-            Rect const* p = span.editArray();
-            Rect const* q = head;
-            if (p->top == q->bottom) {
-                merge = true;
-                while (q != tail) {
-                    if ((p->left != q->left) || (p->right != q->right)) {
-                        merge = false;
-                        break;
-                    }
-                    p++, q++;
-                }
-            }
+        if (tail-head == count) {
+            merge = (span->top == prev->bottom) &&
+                    spansMatch(span, prev, count);
         }
         if (merge) {
-            const int bottom = span[0].bottom;
-            Rect* r = head;
-            while (r != tail) {
-                r->bottom = bottom;
-                r++;
+            const int bottom = span->bottom;
+            for (size_t i=0 ; i<count ; i++) {
+                prev[i].bottom = bottom;
             }
+            storage.removeItemsAt(tail, count);
         } else {
-            bounds.left = min(span.itemAt(0).left, bounds.left);
-            bounds.right = max(span.top().right, bounds.right);
-            storage.appendVector(span);
-            tail = storage.editArray() + storage.size();
-            head = tail - span.size();
+            bounds.left = min(span->left, bounds.left);
+            bounds.right = max(span[count-1].right, bounds.right);
+            head = tail;
+            tail = storage.size();
         }
-        span.clear();
     }
 };
 
@@ -549,6 +698,15 @@ void Region::boolean_operation(int op, Region& dst,
     validate(dst, "boolean_operation (before): dst");
 #endif
 
+    Rect rhs_bounds(rhs.getBounds());
+    rhs_bounds.offsetBy(dx, dy);
+    if (quick_operation(op, dst, lhs, &rhs, rhs_bounds, dx, dy)) {
+#if VALIDATE_REGIONS
+        validate(dst, "boolean_operation (quick): dst");
+#endif
+        return;
+    }
+
     size_t lhs_count;
     Rect const * const lhs_rects = lhs.getArray(&lhs_count);
 
@@ -659,6 +817,12 @@ void Region::boolean_operation(int op, Region& dst,
         return;
     }
 
+    Rect rhs_bounds(rhs);
+    rhs_bounds.offsetBy(dx, dy);
+    if (quick_operation(op, dst, lhs, NULL, rhs_bounds, dx, dy)) {
+        return;
+    }
+
 #if VALIDATE_WITH_CORECG || VALIDATE_REGIONS
     boolean_operation(op, dst, lhs, Region(rhs), dx, dy);
 #else
@@ -688,6 +852,119 @@ void Region::boolean_operation(int op, Region& dst,
     boolean_operation(op, dst, lhs, rhs, 0, 0);
 }
 
+bool Region::quick_operation(int op, Region& dst,
+        const Region& lhs, const Region* rhs, const Rect& rhsBounds,
+        int dx, int dy)
+{
+    // dst is never one of the operands (see operationSelf())
+    const Rect lhsBounds(lhs.getBounds());
+    const bool lhsEmpty = lhsBounds.isEmpty();
+    const bool rhsEmpty = rhsBounds.isEmpty();
+    const bool lhsRect = lhs.isRect();
+    const bool rhsRect = !rhs || rhs->isRect();
+    Rect both;
+    const bool overlap = !lhsEmpty && !rhsEmpty &&
+            lhsBounds.intersect(rhsBounds, &both);
+
+    enum { NONE, LHS, RHS, EMPTY, RECT, SUBTRACT } result = NONE;
+    switch (op) {
+        case op_or:
+            if (rhsEmpty || (lhsRect && lhsBounds.contains(rhsBounds))) {
+                result = LHS;
+            } else if (lhsEmpty || (rhsRect && rhsBounds.contains(lhsBounds))) {
+                result = RHS;
+            }
+            break;
+        case op_and:
+            if (!overlap) {
+                result = EMPTY;
+            } else if (lhsRect && rhsRect) {
+                result = RECT;
+            } else if (lhsRect && lhsBounds.contains(rhsBounds)) {
+                result = RHS;
+            } else if (rhsRect && rhsBounds.contains(lhsBounds)) {
+                result = LHS;
+            }
+            break;
+        case op_nand:
+            if (lhsEmpty) {
+                result = EMPTY;
+            } else if (!overlap) {
+                result = LHS;
+            } else if (rhsRect && rhsBounds.contains(lhsBounds)) {
+                result = EMPTY;
+            } else if (lhsRect && rhsRect) {
+                result = SUBTRACT;
+            }
+            break;
+        case op_xor:
+            if (rhsEmpty) {
+                result = LHS;
+            } else if (lhsEmpty) {
+                result = RHS;
+            }
+            break;
+    }
+
+    switch (result) {
+        case NONE:
+            return false;
+        case LHS:
+            dst = lhs;
+            break;
+        case RHS:
+            if (rhs) {
+                translate(dst, *rhs, dx, dy);
+            } else {
+                dst.set(rhsBounds);
+            }
+            break;
+        case EMPTY:
+            dst.clear();
+            break;
+        case RECT:
+            dst.set(both);
+            break;
+        case SUBTRACT:
+            subtract_rect(dst, lhsBounds, both);
+            break;
+    }
+    return true;
+}
+
+void Region::subtract_rect(Region& dst, const Rect& lhs, const Rect& rhs)
+{
+    // rhs is strictly inside lhs (but not covering it), the result is at
+    // most a top band, a left and a right part, and a bottom band.
+    Storage& storage(dst.mStorage);
+    storage.clear();
+    if (rhs.top > lhs.top) {
+        storage.add(Rect(lhs.left, lhs.top, lhs.right, rhs.top));
+    }
+    if (rhs.left > lhs.left) {
+        storage.add(Rect(lhs.left, rhs.top, rhs.left, rhs.bottom));
+    }
+    if (rhs.right < lhs.right) {
+        storage.add(Rect(rhs.right, rhs.top, lhs.right, rhs.bottom));
+    }
+    if (rhs.bottom < lhs.bottom) {
+        storage.add(Rect(lhs.left, rhs.bottom, lhs.right, lhs.bottom));
+    }
+    if (storage.size() > 1) {
+        const bool fullWidth = rhs.top > lhs.top || rhs.bottom < lhs.bottom;
+        Rect bounds(storage.itemAt(0).left, storage.itemAt(0).top,
+                storage.top().right, storage.top().bottom);
+        if (fullWidth) {
+            bounds.left = lhs.left;
+            bounds.right = lhs.right;
+        }
+        storage.add(bounds);
+    }
+#if VALIDATE_REGIONS
+    validate(dst, "subtract_rect");
+#endif
+}
+
 void Region::translate(Region& reg, int dx, int dy)
 {
     if ((dx || dy) && !reg.isEmpty()) {
@@ -713,6 +990,76 @@ void Region::translate(Region& dst, const Region& reg, int dx, int dy)
     translate(dst, dx, dy);
 }
 
+static void reverseRects(Rect* first, Rect* last)
+{
+    while (first < --last) {
+        Rect t(*first);
+        *first++ = *last;
+        *last = t;
+    }
+}
+
+void Region::flip(Region& reg, bool flipH, bool flipV, int dx, int dy)
+{
+    if (!flipH && !flipV) {
+        translate(reg, dx, dy);
+        return;
+    }
+    if (reg.isEmpty()) {
+        return;
+    }
+#if VALIDATE_REGIONS
+    validate(reg, "flip (before)");
+#endif
+
+    // the bounds are mirrored along with the rects
+    const size_t count = reg.mStorage.size();
+    Rect* const rects = reg.mStorage.editArray();
+    for (size_t i = 0; i < count; i++) {
+        Rect& r(rects[i]);
+        if (flipH) {
+            const int left = dx - r.right;
+            r.right = dx - r.left;
+            r.left = left;
+        } else {
+            r.left += dx;
+            r.right += dx;
+        }
+        if (flipV) {
+            const int top = dy - r.bottom;
+            r.bottom = dy - r.top;
+            r.top = top;
+        } else {
+            r.top += dy;
+            r.bottom += dy;
+        }
+    }
+
+    if (!reg.isRect()) {
+        // flipping vertically reverses the order of the bands, and flipping
+        // horizontally the order of the rects within each band
+        Rect* const end = rects + count - 1;
+        if (flipV) {
+            reverseRects(rects, end);
+        }
+        if (flipH != flipV) {
+            Rect* band = rects;
+            while (band != end) {
+                Rect* next = band + 1;
+                while (next != end && next->top == band->top) {
+                    next++;
+                }
+                reverseRects(band, next);
+                band = next;
+            }
+        }
+    }
+
+#if VALIDATE_REGIONS
+    validate(reg, "flip (after)");
+#endif
+}
+
 // ----------------------------------------------------------------------------
 
 size_t Region::getSize() const {
@@ -734,10 +1081,9 @@ status_t Region::unflatten(void const* buffer, size_t size) {
         Rect const* rects = reinterpret_cast<Rect const*>(buffer);
         size_t count = size / sizeof(Rect);
         if (count > 0) {
-            result.mStorage.clear();
-            ssize_t err = result.mStorage.insertAt(0, count);
-            if (err < 0) {
-                return status_t(err);
+            status_t err = result.mStorage.resize(count);
+            if (err != NO_ERROR) {
+                return err;
             }
             memcpy(result.mStorage.editArray(), rects, count*sizeof(Rect));
         }
@@ -773,9 +1119,9 @@ Rect const* Region::getArray(size_t* count) const {
 }
 
 SharedBuffer const* Region::getSharedBuffer(size_t* count) const {
-    // We can get to the SharedBuffer of a Vector<Rect> because Rect has
-    // a trivial destructor.
-    SharedBuffer const* sb = SharedBuffer::bufferFromData(mStorage.array());
+    // Rect has a trivial destructor, so the SharedBuffer can be released
+    // like the one of a Vector<Rect>.
+    SharedBuffer const* sb = mStorage.getSharedBuffer();
     if (count) {
         size_t numRects = isRect() ? 1 : mStorage.size() - 1;
         count[0] = numRects;
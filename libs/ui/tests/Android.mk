@@ -4,9 +4,13 @@ include $(CLEAR_VARS)
 
 # Build the unit tests.
 test_src_files := \
-    Region_test.cpp
+    GraphicBuffer_test.cpp \
+    PixelConverter_test.cpp \
+    Region_test.cpp \
+    Region_benchmark.cpp
 
 shared_libraries := \
+    libutils \
     libui
 
 static_libraries := \
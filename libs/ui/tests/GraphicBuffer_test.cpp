@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "GraphicBufferTest"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ui/GraphicBuffer.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+class GraphicBufferTest : public testing::Test {
+protected:
+    enum { MAX_FDS = 16 };
+
+    virtual void SetUp() {
+        mBuffer = new GraphicBuffer(16, 16, HAL_PIXEL_FORMAT_RGBA_8888,
+                GraphicBuffer::USAGE_SW_READ_OFTEN);
+        ASSERT_EQ(NO_ERROR, mBuffer->initCheck());
+
+        Flattenable& flattenable(*mBuffer);
+        mSize = flattenable.getFlattenedSize();
+        mFdCount = flattenable.getFdCount();
+        ASSERT_GE(sizeof(mData), mSize);
+        ASSERT_GE(size_t(MAX_FDS), mFdCount);
+        ASSERT_EQ(NO_ERROR, flattenable.flatten(mData, mSize, mFds, mFdCount));
+    }
+
+    // Unflattens mBuffer as if received from another process, or the
+    // given flattened buffer.
+    sp<GraphicBuffer> import(int const* fromData = NULL,
+            int const* fromFds = NULL) {
+        int fds[MAX_FDS];
+        for (size_t i = 0; i < mFdCount; i++) {
+            fds[i] = dup(fromFds ? fromFds[i] : mFds[i]);
+        }
+        sp<GraphicBuffer> buffer(new GraphicBuffer());
+        Flattenable& flattenable(*buffer);
+        EXPECT_EQ(NO_ERROR, flattenable.unflatten(fromData ? fromData : mData,
+                mSize, fds, mFdCount));
+        return buffer;
+    }
+
+    // imports are only shared when the kernel can compare open files
+    static bool canShareImports() {
+#ifdef __NR_kcmp
+        int fd = dup(0);
+        const pid_t pid = getpid();
+        bool supported = syscall(__NR_kcmp, pid, pid, 0, 0, fd) == 0;
+        close(fd);
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+    sp<GraphicBuffer> mBuffer;
+    int mData[64];
+    int mFds[MAX_FDS];
+    size_t mSize;
+    size_t mFdCount;
+};
+
+TEST_F(GraphicBufferTest, IdIsCarriedInFlattenedForm) {
+    sp<GraphicBuffer> imported(import());
+    EXPECT_EQ(mBuffer->getId(), imported->getId());
+    EXPECT_EQ(mBuffer->getWidth(), imported->getWidth());
+    EXPECT_EQ(mBuffer->getHeight(), imported->getHeight());
+    EXPECT_EQ(mBuffer->getStride(), imported->getStride());
+}
+
+TEST_F(GraphicBufferTest, IdsAreUnique) {
+    sp<GraphicBuffer> other(new GraphicBuffer(16, 16,
+            HAL_PIXEL_FORMAT_RGBA_8888, GraphicBuffer::USAGE_SW_READ_OFTEN));
+    EXPECT_NE(mBuffer->getId(), other->getId());
+
+    uint64_t id = mBuffer->getId();
+    ASSERT_EQ(NO_ERROR, mBuffer->reallocate(32, 32,
+            HAL_PIXEL_FORMAT_RGBA_8888, GraphicBuffer::USAGE_SW_READ_OFTEN));
+    EXPECT_NE(id, mBuffer->getId());
+}
+
+TEST_F(GraphicBufferTest, SecondImportSharesTheHandle) {
+    if (!canShareImports()) {
+        return;
+    }
+    sp<GraphicBuffer> first(import());
+    sp<GraphicBuffer> second(import());
+    ASSERT_TRUE(first->handle != NULL);
+    EXPECT_NE(mBuffer->handle, first->handle);
+    EXPECT_EQ(first->handle, second->handle);
+
+    // the shared handle outlives the first import
+    buffer_handle_t handle = first->handle;
+    first.clear();
+    void* vaddr;
+    ASSERT_EQ(NO_ERROR, second->lock(GraphicBuffer::USAGE_SW_READ_OFTEN, &vaddr));
+    EXPECT_EQ(NO_ERROR, second->unlock());
+    EXPECT_EQ(handle, second->handle);
+}
+
+TEST_F(GraphicBufferTest, ImportWithForgedIdIsNotShared) {
+    sp<GraphicBuffer> first(import());
+    ASSERT_TRUE(first->handle != NULL);
+
+    // another buffer with the same geometry, claiming mBuffer's id
+    sp<GraphicBuffer> other(new GraphicBuffer(16, 16,
+            HAL_PIXEL_FORMAT_RGBA_8888, GraphicBuffer::USAGE_SW_READ_OFTEN));
+    ASSERT_EQ(NO_ERROR, other->initCheck());
+    int data[64];
+    int otherFds[MAX_FDS];
+    Flattenable& flattenable(*other);
+    ASSERT_EQ(mFdCount, flattenable.getFdCount());
+    ASSERT_EQ(mSize, flattenable.getFlattenedSize());
+    ASSERT_EQ(NO_ERROR, flattenable.flatten(data, sizeof(data), otherFds,
+            mFdCount));
+    data[6] = mData[6];
+    data[7] = mData[7];
+
+    sp<GraphicBuffer> forged(import(data, otherFds));
+    ASSERT_TRUE(forged->handle != NULL);
+    EXPECT_EQ(first->getId(), forged->getId());
+    EXPECT_NE(first->handle, forged->handle);
+}
+
+TEST_F(GraphicBufferTest, ImportAfterReleaseRegistersAgain) {
+    sp<GraphicBuffer> first(import());
+    first.clear();
+    sp<GraphicBuffer> second(import());
+    ASSERT_TRUE(second->handle != NULL);
+    EXPECT_EQ(mBuffer->getId(), second->getId());
+}
+
+}; // namespace android
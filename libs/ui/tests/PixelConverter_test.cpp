@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PixelConverterTest"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ui/PixelConverter.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+static const PixelFormat kRGBFormats[] = {
+    PIXEL_FORMAT_RGBA_8888,
+    PIXEL_FORMAT_RGBX_8888,
+    PIXEL_FORMAT_BGRA_8888,
+    PIXEL_FORMAT_RGB_565,
+};
+
+class PixelConverterTest : public testing::Test {
+protected:
+    struct Color {
+        uint32_t r, g, b, a;
+    };
+
+    static size_t bpp(PixelFormat format) {
+        return format == PIXEL_FORMAT_RGB_565 ? 2 : 4;
+    }
+
+    static Color decode(PixelFormat format, const uint8_t* p, size_t i) {
+        Color c;
+        if (format == PIXEL_FORMAT_RGB_565) {
+            const uint16_t v = reinterpret_cast<const uint16_t*>(p)[i];
+            const uint32_t r = v >> 11, g = (v >> 5) & 0x3F, b = v & 0x1F;
+            c.r = (r << 3) | (r >> 2);
+            c.g = (g << 2) | (g >> 4);
+            c.b = (b << 3) | (b >> 2);
+            c.a = 0xFF;
+            return c;
+        }
+        const uint8_t* q = p + 4*i;
+        const bool bgra = (format == PIXEL_FORMAT_BGRA_8888);
+        c.r = bgra ? q[2] : q[0];
+        c.g = q[1];
+        c.b = bgra ? q[0] : q[2];
+        c.a = (format == PIXEL_FORMAT_RGBX_8888) ? 0xFF : q[3];
+        return c;
+    }
+
+    // what a component becomes once stored in a 565 pixel
+    static uint32_t quantize(uint32_t v, int bits) {
+        const uint32_t t = v >> (8 - bits);
+        return (t << (8 - bits)) | (t >> (2*bits - 8));
+    }
+};
+
+// every pair, with widths that exercise both the SIMD loops and the tails
+TEST_F(PixelConverterTest, RGBPairs_MatchReference) {
+    uint8_t src[4*80];
+    uint8_t dst[4*80];
+    for (size_t i=0 ; i<sizeof(kRGBFormats)/sizeof(*kRGBFormats) ; i++) {
+        for (size_t j=0 ; j<sizeof(kRGBFormats)/sizeof(*kRGBFormats) ; j++) {
+            const PixelFormat sf = kRGBFormats[i];
+            const PixelFormat df = kRGBFormats[j];
+            PixelConverter converter(sf, df);
+            ASSERT_EQ(NO_ERROR, converter.initCheck());
+            for (size_t w=1 ; w<70 ; w++) {
+                for (size_t k=0 ; k<sizeof(src) ; k++) {
+                    src[k] = rand();
+                }
+                memset(dst, 0, sizeof(dst));
+                ASSERT_EQ(NO_ERROR, converter.convert(dst, w, src, w, w, 1));
+                for (size_t x=0 ; x<w ; x++) {
+                    const Color s = decode(sf, src, x);
+                    const Color d = decode(df, dst, x);
+                    const bool is565 = (df == PIXEL_FORMAT_RGB_565);
+                    EXPECT_EQ(is565 ? quantize(s.r, 5) : s.r, d.r);
+                    EXPECT_EQ(is565 ? quantize(s.g, 6) : s.g, d.g);
+                    EXPECT_EQ(is565 ? quantize(s.b, 5) : s.b, d.b);
+                    if (!is565 && df != PIXEL_FORMAT_RGBX_8888) {
+                        EXPECT_EQ(s.a, d.a);
+                    }
+                }
+                // nothing written past the row
+                EXPECT_EQ(0, dst[w * bpp(df)]);
+            }
+        }
+    }
+}
+
+TEST_F(PixelConverterTest, Strides_AreInPixels) {
+    uint32_t src[4*8];
+    uint16_t dst[3*6];
+    for (size_t i=0 ; i<4*8 ; i++) {
+        src[i] = 0xFF0000FF;    // opaque red
+    }
+    memset(dst, 0, sizeof(dst));
+    PixelConverter converter(PIXEL_FORMAT_RGBA_8888, PIXEL_FORMAT_RGB_565);
+    ASSERT_EQ(NO_ERROR, converter.convert(dst, 6, src, 8, 5, 3));
+    for (size_t y=0 ; y<3 ; y++) {
+        for (size_t x=0 ; x<6 ; x++) {
+            EXPECT_EQ(x < 5 ? 0xF800 : 0, dst[y*6 + x]);
+        }
+    }
+}
+
+TEST_F(PixelConverterTest, YUV_ToRGB) {
+    // 4x2 image, Y stride 16: red on the left half, blue on the right
+    const size_t stride = 16;
+    uint8_t yv12[16*2 + 16*1 + 16*1];
+    uint8_t nv21[16*2 + 16*1];
+    memset(yv12, 0, sizeof(yv12));
+    memset(nv21, 0, sizeof(nv21));
+    const uint8_t y[2] = { 81, 41 };
+    const uint8_t cb[2] = { 90, 240 };
+    const uint8_t cr[2] = { 240, 110 };
+    for (size_t row=0 ; row<2 ; row++) {
+        for (size_t x=0 ; x<4 ; x++) {
+            yv12[row*stride + x] = nv21[row*stride + x] = y[x/2];
+        }
+    }
+    for (size_t i=0 ; i<2 ; i++) {
+        yv12[2*stride + i] = cr[i];         // Cr plane, stride 16
+        yv12[2*stride + 16 + i] = cb[i];    // Cb plane
+        nv21[2*stride + 2*i] = cr[i];
+        nv21[2*stride + 2*i + 1] = cb[i];
+    }
+
+    const PixelFormat formats[2] = {
+        HAL_PIXEL_FORMAT_YV12, HAL_PIXEL_FORMAT_YCrCb_420_SP
+    };
+    const uint8_t* const images[2] = { yv12, nv21 };
+    for (size_t f=0 ; f<2 ; f++) {
+        for (size_t j=0 ; j<sizeof(kRGBFormats)/sizeof(*kRGBFormats) ; j++) {
+            const PixelFormat df = kRGBFormats[j];
+            uint8_t dst[4*4*2];
+            PixelConverter converter(formats[f], df);
+            ASSERT_EQ(NO_ERROR, converter.initCheck());
+            ASSERT_EQ(NO_ERROR, converter.convert(dst, 4, images[f], stride, 4, 2));
+            for (size_t i=0 ; i<8 ; i++) {
+                const Color c = decode(df, dst, i);
+                const bool red = (i % 4) < 2;
+                EXPECT_GE(c.r, red ? 0xF0u : 0u);
+                EXPECT_LE(c.r, red ? 0xFFu : 0x10u);
+                EXPECT_LE(c.g, 0x10u);
+                EXPECT_GE(c.b, red ? 0u : 0xF0u);
+                EXPECT_LE(c.b, red ? 0x10u : 0xFFu);
+            }
+        }
+    }
+}
+
+TEST_F(PixelConverterTest, Unsupported) {
+    EXPECT_EQ(BAD_VALUE,
+            PixelConverter(PIXEL_FORMAT_RGBA_8888, PIXEL_FORMAT_A_8).initCheck());
+    EXPECT_EQ(BAD_VALUE,
+            PixelConverter(PIXEL_FORMAT_RGBA_8888, HAL_PIXEL_FORMAT_YV12).initCheck());
+    EXPECT_FALSE(PixelConverter::isSupported(PIXEL_FORMAT_RGB_888,
+            PIXEL_FORMAT_RGBA_8888));
+}
+
+}; // namespace android
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RegionBenchmark"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+#include <ui/Region.h>
+#include <ui/Rect.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+// Not a correctness test: these measure the Region operations SurfaceFlinger
+// does every frame and print how many of them run per second.
+class RegionBenchmark : public testing::Test {
+protected:
+    enum { ITERATIONS = 20000 };
+
+    static void report(const char* name, size_t ops, nsecs_t duration) {
+        const double seconds = duration / 1e9;
+        printf("%-32s %10.0f ops/s\n", name,
+                seconds > 0 ? ops / seconds : 0.0);
+    }
+
+    // a status bar, a wallpaper, an app with a dialog on top, and a
+    // navigation bar on a 720x1280 display
+    void getLayers(Vector<Rect>& layers, Vector<bool>& opaque) {
+        layers.add(Rect(0, 0, 720, 50));        opaque.add(false);
+        layers.add(Rect(80, 400, 640, 880));    opaque.add(false);
+        layers.add(Rect(0, 50, 720, 1184));     opaque.add(true);
+        layers.add(Rect(0, 1184, 720, 1280));   opaque.add(true);
+        layers.add(Rect(-360, 0, 1080, 1280));  opaque.add(true);
+    }
+};
+
+// see SurfaceFlinger::computeVisibleRegions()
+TEST_F(RegionBenchmark, VisibleRegions) {
+    Vector<Rect> layers;
+    Vector<bool> opaque;
+    getLayers(layers, opaque);
+    const Rect screen(0, 0, 720, 1280);
+
+    size_t ops = 0;
+    Region dirty;
+    const nsecs_t start = systemTime();
+    for (int i = 0; i < ITERATIONS; i++) {
+        Region aboveOpaqueLayers;
+        Region aboveCoveredLayers;
+        for (size_t j = 0; j < layers.size(); j++) {
+            Region visibleRegion(Region(layers[j]).intersect(screen));
+            Region coveredRegion(aboveCoveredLayers.intersect(visibleRegion));
+            aboveCoveredLayers.orSelf(visibleRegion);
+            visibleRegion.subtractSelf(aboveOpaqueLayers);
+            dirty.orSelf(visibleRegion.subtract(coveredRegion));
+            if (opaque[j]) {
+                aboveOpaqueLayers.orSelf(visibleRegion);
+            }
+            ops += 6;
+        }
+        dirty.andSelf(screen);
+        ops++;
+    }
+    report("visible regions", ops, systemTime() - start);
+    EXPECT_FALSE(dirty.isEmpty());
+}
+
+TEST_F(RegionBenchmark, RectOperations) {
+    const Rect a(0, 0, 720, 1280);
+    const Rect b(100, 200, 300, 400);
+
+    size_t ops = 0;
+    Region result;
+    const nsecs_t start = systemTime();
+    for (int i = 0; i < ITERATIONS; i++) {
+        result = Region(a).intersect(b);
+        result = Region(a).subtract(b);
+        result = Region(b).merge(a);
+        result = Region(b).subtract(Rect(800, 0, 900, 100));
+        ops += 4;
+    }
+    report("rect operations", ops, systemTime() - start);
+    EXPECT_EQ(b, result.getBounds());
+}
+
+// many rects per span, the spans stack on top of each other (e.g. the
+// dirty region of a text view)
+TEST_F(RegionBenchmark, LongSpans) {
+    Region stripes;
+    for (int i = 0; i < 64; i++) {
+        stripes.orSelf(Rect(i * 10, 0, i * 10 + 8, 8));
+    }
+    Region rows;
+    for (int j = 0; j < 32; j++) {
+        rows.orSelf(stripes, 0, j * 8);
+    }
+
+    size_t ops = 0;
+    Region result;
+    const nsecs_t start = systemTime();
+    for (int i = 0; i < ITERATIONS / 100; i++) {
+        result = rows.merge(stripes, 2, 4);
+        result.subtractSelf(Rect(0, 0, 320, 128));
+        result.andSelf(rows);
+        ops += 3;
+    }
+    report("long spans", ops, systemTime() - start);
+    EXPECT_FALSE(result.isEmpty());
+}
+
+}; // namespace android
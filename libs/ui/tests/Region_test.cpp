@@ -17,6 +17,7 @@
 #define LOG_TAG "RegionTest"
 
 #include <stdlib.h>
+#include <utils/SharedBuffer.h>
 #include <ui/Region.h>
 #include <ui/Rect.h>
 #include <gtest/gtest.h>
@@ -131,6 +132,172 @@ TEST_F(RegionTest, Bigger_TJunction) {
     checkTJunctionFreeFromRegion(r, 16);
 }
 
+static void expectSameRects(const Region& lhs, const Region& rhs) {
+    size_t lhsCount, rhsCount;
+    const Rect* l = lhs.getArray(&lhsCount);
+    const Rect* r = rhs.getArray(&rhsCount);
+    ASSERT_EQ(rhsCount, lhsCount);
+    for (size_t i = 0; i < lhsCount; i++) {
+        EXPECT_EQ(r[i], l[i]);
+    }
+    EXPECT_EQ(rhs.getBounds(), lhs.getBounds());
+}
+
+TEST_F(RegionTest, QuickOperation_RectMinusRect) {
+    const Rect outer(0, 0, 6, 6);
+    Region expected;
+
+     // |xxx|
+     // |x x|
+     // |xxx|
+    expected.clear();
+    expected.orSelf(Rect(0, 0, 6, 2));
+    expected.orSelf(Rect(0, 2, 2, 4));
+    expected.orSelf(Rect(4, 2, 6, 4));
+    expected.orSelf(Rect(0, 4, 6, 6));
+    expectSameRects(Region(outer).subtract(Rect(2, 2, 4, 4)), expected);
+
+     // |x x|
+     // |x x|
+    expected.clear();
+    expected.orSelf(Rect(0, 0, 2, 6));
+    expected.orSelf(Rect(4, 0, 6, 6));
+    expectSameRects(Region(outer).subtract(Rect(2, -1, 4, 7)), expected);
+
+     // |   |
+     // |xxx|
+    expectSameRects(Region(outer).subtract(Rect(-1, -1, 7, 3)),
+            Region(Rect(0, 3, 6, 6)));
+
+    EXPECT_TRUE(Region(outer).subtract(Rect(-1, -1, 7, 7)).isEmpty());
+    expectSameRects(Region(outer).subtract(Rect(6, 0, 8, 6)), Region(outer));
+}
+
+TEST_F(RegionTest, QuickOperation_TrivialCases) {
+    Region r;
+    r.orSelf(Rect(0, 0, 4, 2));
+    r.orSelf(Rect(0, 2, 2, 4));
+
+    const Region empty;
+    expectSameRects(r.merge(empty), r);
+    expectSameRects(empty.merge(r), r);
+    expectSameRects(r.mergeExclusive(empty), r);
+    expectSameRects(empty.mergeExclusive(r), r);
+    expectSameRects(r.merge(Rect(1, 1, 2, 2)), r);
+    expectSameRects(r.merge(Rect(-1, -1, 5, 5)), Region(Rect(-1, -1, 5, 5)));
+
+    EXPECT_TRUE(r.intersect(Rect(4, 0, 8, 4)).isEmpty());
+    EXPECT_TRUE(r.intersect(empty).isEmpty());
+    expectSameRects(r.intersect(Rect(-1, -1, 5, 5)), r);
+    expectSameRects(Region(Rect(0, 0, 4, 4)).intersect(Rect(2, 2, 6, 6)),
+            Region(Rect(2, 2, 4, 4)));
+
+    expectSameRects(r.subtract(Rect(4, 0, 8, 4)), r);
+    EXPECT_TRUE(r.subtract(Rect(0, 0, 4, 4)).isEmpty());
+    EXPECT_TRUE(empty.subtract(r).isEmpty());
+
+    // translated operands
+    Region expected(r);
+    expected.translateSelf(10, 10);
+    expectSameRects(empty.merge(r, 10, 10), expected);
+    expectSameRects(Region(Rect(10, 10, 14, 14)).intersect(r, 10, 10), expected);
+    EXPECT_TRUE(r.intersect(r, 10, 10).isEmpty());
+
+    // the operand is also the destination
+    Region self(r);
+    self.orSelf(self);
+    expectSameRects(self, r);
+    self.andSelf(self);
+    expectSameRects(self, r);
+    self.subtractSelf(self);
+    EXPECT_TRUE(self.isEmpty());
+}
+
+TEST_F(RegionTest, Rasterizer_MergesSpans) {
+    // identical spans stacked on top of each other collapse into one
+    Region r;
+    for (int j = 0; j < 8; j++) {
+        for (int i = 0; i < 8; i++) {
+            r.orSelf(Rect(i * 4, j, i * 4 + 2, j + 1));
+        }
+    }
+    EXPECT_EQ(8, r.end() - r.begin());
+    EXPECT_EQ(Rect(0, 0, 30, 8), r.getBounds());
+    for (const Rect* cur = r.begin(); cur != r.end(); cur++) {
+        EXPECT_EQ(0, cur->top);
+        EXPECT_EQ(8, cur->bottom);
+    }
+}
+
+TEST_F(RegionTest, Storage_InlineAndShared) {
+    // grows past the inline storage one rect at a time, copies taken
+    // along the way must not change
+    Region r;
+    Vector<Region> copies;
+    for (int i = 0; i < 16; i++) {
+        r.orSelf(Rect(i * 2, 0, i * 2 + 1, 1));
+        copies.add(r);
+    }
+    for (size_t i = 0; i < copies.size(); i++) {
+        EXPECT_EQ(ssize_t(i + 1), copies[i].end() - copies[i].begin());
+    }
+
+    Region small(Rect(0, 0, 4, 4));
+    small.orSelf(Rect(8, 0, 12, 4));
+    EXPECT_TRUE(small.isTriviallyEqual(Region(small)));
+    EXPECT_FALSE(small.isTriviallyEqual(Region(Rect(0, 0, 4, 4))));
+
+    // the shared buffer outlives the region and holds a copy of its rects
+    size_t count;
+    SharedBuffer const* sb;
+    {
+        Region copy(small);
+        sb = copy.getSharedBuffer(&count);
+        expectSameRects(copy, small);
+        EXPECT_TRUE(copy.isTriviallyEqual(Region(copy)));
+    }
+    ASSERT_EQ(size_t(2), count);
+    const Rect* rects = static_cast<const Rect*>(sb->data());
+    EXPECT_EQ(Rect(0, 0, 4, 4), rects[0]);
+    EXPECT_EQ(Rect(8, 0, 12, 4), rects[1]);
+    sb->release();
+}
+
+TEST_F(RegionTest, Flip_MatchesRectByRect) {
+    srandom(4321);
+
+    for (int iter = 0; iter < 100; iter++) {
+        Region r;
+        for (int i = 0; i < 8; i++) {
+            int l = random() % 32, t = random() % 32;
+            r.orSelf(Rect(l, t, l + 1 + random() % 16, t + 1 + random() % 16));
+        }
+
+        for (int flips = 0; flips < 4; flips++) {
+            const bool flipH = flips & 1;
+            const bool flipV = flips & 2;
+            Region expected;
+            for (const Rect* it = r.begin(); it != r.end(); it++) {
+                Rect m(*it);
+                if (flipH) {
+                    m.left = 40 - it->right;
+                    m.right = 40 - it->left;
+                } else {
+                    m.offsetBy(40, 0);
+                }
+                if (flipV) {
+                    m.top = -8 - it->bottom;
+                    m.bottom = -8 - it->top;
+                } else {
+                    m.offsetBy(0, -8);
+                }
+                expected.orSelf(m);
+            }
+            expectSameRects(r.flip(flipH, flipV, 40, -8), expected);
+        }
+    }
+}
+
 #define ITER_MAX 1000
 #define X_MAX 8
 #define Y_MAX 8
@@ -23,18 +23,21 @@ commonSources:= \
 	BufferedTextOutput.cpp \
 	CallStack.cpp \
 	Debug.cpp \
+	FastHash.cpp \
 	FileMap.cpp \
 	Flattenable.cpp \
 	JenkinsHash.cpp \
 	LinearAllocator.cpp \
 	LinearTransform.cpp \
 	Log.cpp \
+	Profiler.cpp \
 	PropertyMap.cpp \
 	RefBase.cpp \
 	SharedBuffer.cpp \
 	Static.cpp \
 	StopWatch.cpp \
 	String8.cpp \
+	String8Builder.cpp \
 	String16.cpp \
 	StringArray.cpp \
 	SystemClock.cpp \
@@ -42,6 +45,8 @@ commonSources:= \
 	Threads.cpp \
 	Timers.cpp \
 	Tokenizer.cpp \
+	TraceBuffer.cpp \
+	TraceTagMap.cpp \
 	Unicode.cpp \
 	VectorImpl.cpp \
 	WorkQueue.cpp \
@@ -65,6 +70,17 @@ ifeq ($(TARGET_OS),linux)
 host_commonLdlibs += -lrt -ldl
 endif
 
+# ZipUtils inflates whole buffers with libdeflate when the tree has it,
+# it's faster than zlib at that
+zip_cflags :=
+zip_includes :=
+zip_static_libraries :=
+ifneq ($(wildcard external/libdeflate/libdeflate.h),)
+zip_cflags := -DHAVE_LIBDEFLATE
+zip_includes := external/libdeflate
+zip_static_libraries := libdeflate
+endif
+
 
 # For the host
 # =====================================================
@@ -74,10 +90,10 @@ ifeq ($(HOST_OS), linux)
 LOCAL_SRC_FILES += Looper.cpp
 endif
 LOCAL_MODULE:= libutils
-LOCAL_STATIC_LIBRARIES := libz
+LOCAL_STATIC_LIBRARIES := libz $(zip_static_libraries)
 LOCAL_C_INCLUDES := \
-	external/zlib
-LOCAL_CFLAGS += $(host_commonCflags)
+	external/zlib $(zip_includes)
+LOCAL_CFLAGS += $(host_commonCflags) $(zip_cflags)
 LOCAL_LDLIBS += $(host_commonLdlibs)
 include $(BUILD_HOST_STATIC_LIBRARY)
 
@@ -90,10 +106,10 @@ ifeq ($(HOST_OS), linux)
 LOCAL_SRC_FILES += Looper.cpp
 endif
 LOCAL_MODULE:= lib64utils
-LOCAL_STATIC_LIBRARIES := libz
+LOCAL_STATIC_LIBRARIES := libz $(zip_static_libraries)
 LOCAL_C_INCLUDES := \
-	external/zlib
-LOCAL_CFLAGS += $(host_commonCflags) -m64
+	external/zlib $(zip_includes)
+LOCAL_CFLAGS += $(host_commonCflags) $(zip_cflags) -m64
 LOCAL_LDLIBS += $(host_commonLdlibs)
 include $(BUILD_HOST_STATIC_LIBRARY)
 
@@ -117,9 +133,18 @@ ifeq ($(TARGET_ARCH),mips)
 LOCAL_CFLAGS += -DALIGN_DOUBLE
 endif
 
+# recycle small SharedBuffers in per-thread caches, and count heap calls
+ifeq ($(TARGET_USES_SHARED_BUFFER_POOL),true)
+LOCAL_CFLAGS += -DSHARED_BUFFER_POOL
+endif
+
 LOCAL_C_INCLUDES += \
 		bionic/libc/private \
-		external/zlib
+		external/zlib \
+		$(zip_includes)
+
+LOCAL_CFLAGS += $(zip_cflags)
+LOCAL_STATIC_LIBRARIES := $(zip_static_libraries)
 
 LOCAL_LDLIBS += -lpthread
 
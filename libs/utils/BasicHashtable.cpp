@@ -24,28 +24,47 @@
 
 namespace android {
 
-BasicHashtableImpl::BasicHashtableImpl(size_t entrySize, bool hasTrivialDestructor,
-        size_t minimumInitialCapacity, float loadFactor) :
-        mBucketSize(entrySize + sizeof(Bucket)), mHasTrivialDestructor(hasTrivialDestructor),
+// Rounds size up to a multiple of alignment, which must be a power of two.
+static inline size_t alignTo(size_t size, size_t alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+BasicHashtableImpl::BasicHashtableImpl(size_t entrySize, size_t entryAlignment,
+        bool hasTrivialDestructor, size_t minimumInitialCapacity, float loadFactor) :
+        mEntryOffset(alignTo(sizeof(Bucket), entryAlignment)),
+        mBucketSize(alignTo(mEntryOffset + entrySize,
+                entryAlignment > __alignof__(Bucket) ? entryAlignment : __alignof__(Bucket))),
+        mHasTrivialDestructor(hasTrivialDestructor),
         mLoadFactor(loadFactor), mSize(0),
-        mFilledBuckets(0), mBuckets(NULL) {
+        mFilledBuckets(0), mBuckets(NULL), mIncrementalRehash(false),
+        mOldBucketCount(0), mMigratedBuckets(0), mOldBuckets(NULL) {
     determineCapacity(minimumInitialCapacity, mLoadFactor, &mBucketCount, &mCapacity);
 }
 
 BasicHashtableImpl::BasicHashtableImpl(const BasicHashtableImpl& other) :
-        mBucketSize(other.mBucketSize), mHasTrivialDestructor(other.mHasTrivialDestructor),
+        mEntryOffset(other.mEntryOffset), mBucketSize(other.mBucketSize),
+        mHasTrivialDestructor(other.mHasTrivialDestructor),
         mCapacity(other.mCapacity), mLoadFactor(other.mLoadFactor),
         mSize(other.mSize), mFilledBuckets(other.mFilledBuckets),
-        mBucketCount(other.mBucketCount), mBuckets(other.mBuckets) {
+        mBucketCount(other.mBucketCount), mBuckets(other.mBuckets),
+        mIncrementalRehash(other.mIncrementalRehash),
+        mOldBucketCount(other.mOldBucketCount),
+        mMigratedBuckets(other.mMigratedBuckets), mOldBuckets(other.mOldBuckets) {
     if (mBuckets) {
         SharedBuffer::bufferFromData(mBuckets)->acquire();
     }
+    if (mOldBuckets) {
+        SharedBuffer::bufferFromData(mOldBuckets)->acquire();
+    }
 }
 
 void BasicHashtableImpl::dispose() {
     if (mBuckets) {
         releaseBuckets(mBuckets, mBucketCount);
     }
+    if (mOldBuckets) {
+        releaseBuckets(mOldBuckets, mOldBucketCount);
+    }
 }
 
 void BasicHashtableImpl::clone() {
@@ -55,12 +74,21 @@ void BasicHashtableImpl::clone() {
         releaseBuckets(mBuckets, mBucketCount);
         mBuckets = newBuckets;
     }
+    if (mOldBuckets) {
+        void* newBuckets = allocateBuckets(mOldBucketCount);
+        copyBuckets(mOldBuckets, newBuckets, mOldBucketCount);
+        releaseBuckets(mOldBuckets, mOldBucketCount);
+        mOldBuckets = newBuckets;
+    }
 }
 
 void BasicHashtableImpl::setTo(const BasicHashtableImpl& other) {
     if (mBuckets) {
         releaseBuckets(mBuckets, mBucketCount);
     }
+    if (mOldBuckets) {
+        releaseBuckets(mOldBuckets, mOldBucketCount);
+    }
 
     mCapacity = other.mCapacity;
     mLoadFactor = other.mLoadFactor;
@@ -68,13 +96,26 @@ void BasicHashtableImpl::setTo(const BasicHashtableImpl& other) {
     mFilledBuckets = other.mFilledBuckets;
     mBucketCount = other.mBucketCount;
     mBuckets = other.mBuckets;
+    mIncrementalRehash = other.mIncrementalRehash;
+    mOldBucketCount = other.mOldBucketCount;
+    mMigratedBuckets = other.mMigratedBuckets;
+    mOldBuckets = other.mOldBuckets;
 
     if (mBuckets) {
         SharedBuffer::bufferFromData(mBuckets)->acquire();
     }
+    if (mOldBuckets) {
+        SharedBuffer::bufferFromData(mOldBuckets)->acquire();
+    }
 }
 
 void BasicHashtableImpl::clear() {
+    if (mOldBuckets) {
+        releaseBuckets(mOldBuckets, mOldBucketCount);
+        mOldBuckets = NULL;
+        mOldBucketCount = 0;
+        mMigratedBuckets = 0;
+    }
     if (mBuckets) {
         if (mFilledBuckets) {
             SharedBuffer* sb = SharedBuffer::bufferFromData(mBuckets);
@@ -96,8 +137,9 @@ void BasicHashtableImpl::clear() {
 
 ssize_t BasicHashtableImpl::next(ssize_t index) const {
     if (mSize) {
-        while (size_t(++index) < mBucketCount) {
-            const Bucket& bucket = bucketAt(mBuckets, index);
+        const size_t count = mBucketCount + mOldBucketCount;
+        while (size_t(++index) < count) {
+            const Bucket& bucket = bucketFor(index);
             if (bucket.cookie & Bucket::PRESENT) {
                 return index;
             }
@@ -113,12 +155,29 @@ ssize_t BasicHashtableImpl::find(ssize_t index, hash_t hash,
     }
 
     hash = trimHash(hash);
+    if (index < 0 || size_t(index) < mBucketCount) {
+        index = findIn(mBuckets, mBucketCount, index, hash, key);
+        if (index >= 0 || !mOldBuckets) {
+            return index;
+        }
+    } else {
+        index -= mBucketCount;
+    }
+
+    // the entries not migrated yet
+    index = findIn(mOldBuckets, mOldBucketCount, index, hash, key);
+    return index < 0 ? -1 : index + mBucketCount;
+}
+
+ssize_t BasicHashtableImpl::findIn(const void* __restrict__ buckets, size_t count,
+        ssize_t index, hash_t hash, const void* __restrict__ key) const {
     if (index < 0) {
-        index = chainStart(hash, mBucketCount);
+        index = chainStart(hash, count);
 
-        const Bucket& bucket = bucketAt(mBuckets, size_t(index));
+        const Bucket& bucket = bucketAt(buckets, size_t(index));
         if (bucket.cookie & Bucket::PRESENT) {
-            if (compareBucketKey(bucket, key)) {
+            if ((bucket.cookie & Bucket::HASH_MASK) == hash
+                    && compareBucketKey(bucket, key)) {
                 return index;
             }
         } else {
@@ -128,11 +187,11 @@ ssize_t BasicHashtableImpl::find(ssize_t index, hash_t hash,
         }
     }
 
-    size_t inc = chainIncrement(hash, mBucketCount);
+    size_t inc = chainIncrement(hash, count);
     for (;;) {
-        index = chainSeek(index, inc, mBucketCount);
+        index = chainSeek(index, inc, count);
 
-        const Bucket& bucket = bucketAt(mBuckets, size_t(index));
+        const Bucket& bucket = bucketAt(buckets, size_t(index));
         if (bucket.cookie & Bucket::PRESENT) {
             if ((bucket.cookie & Bucket::HASH_MASK) == hash
                     && compareBucketKey(bucket, key)) {
@@ -151,6 +210,9 @@ size_t BasicHashtableImpl::add(hash_t hash, const void* entry) {
     } else {
         edit();
     }
+    if (mOldBuckets) {
+        migrateBuckets(MIGRATION_STEP);
+    }
 
     hash = trimHash(hash);
     for (;;) {
@@ -168,7 +230,19 @@ size_t BasicHashtableImpl::add(hash_t hash, const void* entry) {
         uint32_t collision = bucket->cookie & Bucket::COLLISION;
         if (!collision) {
             if (mFilledBuckets >= mCapacity) {
+                if (mIncrementalRehash && mSize && !mOldBuckets) {
+                    size_t newBucketCount, newCapacity;
+                    determineCapacity(mCapacity * 2, mLoadFactor,
+                            &newBucketCount, &newCapacity);
+                    startIncrementalRehash(newBucketCount, newCapacity);
+                    continue;
+                }
                 rehash(mCapacity * 2, mLoadFactor);
+                // rehashing a table whose remaining buckets are only
+                // collision markers frees them all
+                if (!mBuckets) {
+                    mBuckets = allocateBuckets(mBucketCount);
+                }
                 continue;
             }
             mFilledBuckets += 1;
@@ -184,9 +258,10 @@ size_t BasicHashtableImpl::add(hash_t hash, const void* entry) {
 void BasicHashtableImpl::removeAt(size_t index) {
     edit();
 
-    Bucket& bucket = bucketAt(mBuckets, index);
+    Bucket& bucket = bucketFor(index);
     bucket.cookie &= ~Bucket::PRESENT;
-    if (!(bucket.cookie & Bucket::COLLISION)) {
+    // the old array's buckets don't count towards the capacity
+    if (!(bucket.cookie & Bucket::COLLISION) && index < mBucketCount) {
         mFilledBuckets -= 1;
     }
     mSize -= 1;
@@ -196,6 +271,10 @@ void BasicHashtableImpl::removeAt(size_t index) {
 }
 
 void BasicHashtableImpl::rehash(size_t minimumCapacity, float loadFactor) {
+    if (mOldBuckets) {
+        edit();
+        migrateBuckets(mOldBucketCount);
+    }
     if (minimumCapacity < mSize) {
         minimumCapacity = mSize;
     }
@@ -211,18 +290,9 @@ void BasicHashtableImpl::rehash(size_t minimumCapacity, float loadFactor) {
                     const Bucket& fromBucket = bucketAt(mBuckets, i);
                     if (fromBucket.cookie & Bucket::PRESENT) {
                         hash_t hash = fromBucket.cookie & Bucket::HASH_MASK;
-                        size_t index = chainStart(hash, newBucketCount);
-                        Bucket* toBucket = &bucketAt(newBuckets, size_t(index));
-                        if (toBucket->cookie & Bucket::PRESENT) {
-                            size_t inc = chainIncrement(hash, newBucketCount);
-                            do {
-                                toBucket->cookie |= Bucket::COLLISION;
-                                index = chainSeek(index, inc, newBucketCount);
-                                toBucket = &bucketAt(newBuckets, size_t(index));
-                            } while (toBucket->cookie & Bucket::PRESENT);
-                        }
-                        toBucket->cookie = Bucket::PRESENT | hash;
-                        initializeBucketEntry(*toBucket, fromBucket.entry);
+                        Bucket& toBucket = insertionBucket(newBuckets, newBucketCount, hash);
+                        toBucket.cookie = Bucket::PRESENT | hash;
+                        initializeBucketEntry(toBucket, entryIn(fromBucket));
                     }
                 }
             } else {
@@ -238,6 +308,72 @@ void BasicHashtableImpl::rehash(size_t minimumCapacity, float loadFactor) {
     mLoadFactor = loadFactor;
 }
 
+void BasicHashtableImpl::setIncrementalRehash(bool enabled) {
+    if (!enabled && mOldBuckets) {
+        edit();
+        migrateBuckets(mOldBucketCount);
+    }
+    mIncrementalRehash = enabled;
+}
+
+BasicHashtableImpl::Bucket& BasicHashtableImpl::insertionBucket(
+        void* __restrict__ buckets, size_t count, hash_t hash) const {
+    size_t index = chainStart(hash, count);
+    Bucket* bucket = &bucketAt(buckets, index);
+    if (bucket->cookie & Bucket::PRESENT) {
+        size_t inc = chainIncrement(hash, count);
+        do {
+            bucket->cookie |= Bucket::COLLISION;
+            index = chainSeek(index, inc, count);
+            bucket = &bucketAt(buckets, index);
+        } while (bucket->cookie & Bucket::PRESENT);
+    }
+    return *bucket;
+}
+
+void BasicHashtableImpl::startIncrementalRehash(size_t newBucketCount, size_t newCapacity) {
+    // the entries are moved out of the old array, so it must be ours
+    edit();
+    mOldBuckets = mBuckets;
+    mOldBucketCount = mBucketCount;
+    mMigratedBuckets = 0;
+    mBuckets = allocateBuckets(newBucketCount);
+    mBucketCount = newBucketCount;
+    mCapacity = newCapacity;
+    mFilledBuckets = 0;
+}
+
+void BasicHashtableImpl::migrateBuckets(size_t count) {
+    size_t end = mMigratedBuckets + count;
+    if (end > mOldBucketCount) {
+        end = mOldBucketCount;
+    }
+    for (; mMigratedBuckets < end; mMigratedBuckets++) {
+        Bucket& fromBucket = bucketAt(mOldBuckets, mMigratedBuckets);
+        if (fromBucket.cookie & Bucket::PRESENT) {
+            hash_t hash = fromBucket.cookie & Bucket::HASH_MASK;
+            Bucket& toBucket = insertionBucket(mBuckets, mBucketCount, hash);
+            if (!(toBucket.cookie & Bucket::COLLISION)) {
+                mFilledBuckets += 1;
+            }
+            toBucket.cookie = (toBucket.cookie & Bucket::COLLISION) | Bucket::PRESENT | hash;
+            initializeBucketEntry(toBucket, entryIn(fromBucket));
+            if (!mHasTrivialDestructor) {
+                destroyBucketEntry(fromBucket);
+            }
+            // keep the collision flag: chains through this bucket must
+            // still be followed to the entries not moved yet
+            fromBucket.cookie &= ~Bucket::PRESENT;
+        }
+    }
+    if (mMigratedBuckets == mOldBucketCount) {
+        releaseBuckets(mOldBuckets, mOldBucketCount);
+        mOldBuckets = NULL;
+        mOldBucketCount = 0;
+        mMigratedBuckets = 0;
+    }
+}
+
 void* BasicHashtableImpl::allocateBuckets(size_t count) const {
     size_t bytes = count * mBucketSize;
     SharedBuffer* sb = SharedBuffer::alloc(bytes);
@@ -277,7 +413,7 @@ void BasicHashtableImpl::copyBuckets(const void* __restrict__ fromBuckets,
         Bucket& toBucket = bucketAt(toBuckets, i);
         toBucket.cookie = fromBucket.cookie;
         if (fromBucket.cookie & Bucket::PRESENT) {
-            initializeBucketEntry(toBucket, fromBucket.entry);
+            initializeBucketEntry(toBucket, entryIn(fromBucket));
         }
     }
 }
@@ -20,17 +20,22 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <cutils/atomic.h>
+
 #include <utils/BlobCache.h>
 #include <utils/Errors.h>
+#include <utils/FileMap.h>
+#include <utils/FastHash.h>
+#include <utils/JenkinsHash.h>
 #include <utils/Log.h>
 
 namespace android {
 
-// BlobCache::Header::mMagicNumber value
+// BlobCache::Header::mMagicNumber and BlobCache::Trailer::mMagicNumber value
 static const uint32_t blobCacheMagic = '_Bb$';
 
 // BlobCache::Header::mBlobCacheVersion value
-static const uint32_t blobCacheVersion = 1;
+static const uint32_t blobCacheVersion = 3;
 
 // BlobCache::Header::mDeviceVersion value
 static const uint32_t blobCacheDeviceVersion = 1;
@@ -39,16 +44,17 @@ BlobCache::BlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize
         mMaxKeySize(maxKeySize),
         mMaxValueSize(maxValueSize),
         mMaxTotalSize(maxTotalSize),
-        mTotalSize(0) {
-    nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
-#ifdef _WIN32
-    srand(now);
-#else
-    mRandState[0] = (now >> 0) & 0xFFFF;
-    mRandState[1] = (now >> 16) & 0xFFFF;
-    mRandState[2] = (now >> 32) & 0xFFFF;
-#endif
-    ALOGV("initializing random seed using %lld", now);
+        mTotalSize(0),
+        mUseCounter(0),
+        mHits(0),
+        mMisses(0),
+        mEvictions(0),
+        mAppendOffset(0) {
+    // set() may run on a frame's critical path, it mustn't pay for
+    // rehashing a whole shard
+    for (size_t s = 0; s < NUM_SHARDS; s++) {
+        mShards[s].mEntries.setIncrementalRehash(true);
+    }
 }
 
 void BlobCache::set(const void* key, size_t keySize, const void* value,
@@ -77,56 +83,49 @@ void BlobCache::set(const void* key, size_t keySize, const void* value,
         return;
     }
 
-    sp<Blob> dummyKey(new Blob(key, keySize, false));
-    CacheEntry dummyEntry(dummyKey, NULL);
+    const hash_t hash = hashKey(key, keySize);
+    Shard& shard(shardFor(hash));
+    Blob dummyKey(key, keySize, false);
+
+    // Copy the value before taking the shard lock.
+    sp<Blob> valueBlob(new Blob(value, valueSize, true));
 
     while (true) {
-        ssize_t index = mCacheEntries.indexOf(dummyEntry);
-        if (index < 0) {
-            // Create a new cache entry.
-            sp<Blob> keyBlob(new Blob(key, keySize, true));
-            sp<Blob> valueBlob(new Blob(value, valueSize, true));
-            size_t newTotalSize = mTotalSize + keySize + valueSize;
-            if (mMaxTotalSize < newTotalSize) {
-                if (isCleanable()) {
-                    // Clean the cache and try again.
-                    clean();
-                    continue;
-                } else {
-                    ALOGV("set: not caching new key/value pair because the "
-                            "total cache size limit would be exceeded: %d "
-                            "(limit: %d)",
-                            keySize + valueSize, mMaxTotalSize);
-                    break;
+        {
+            Mutex::Autolock _l(shard.mLock);
+            ssize_t index = shard.mEntries.find(-1, hash, dummyKey);
+            if (index < 0) {
+                // Create a new cache entry.
+                if (reserve(keySize + valueSize)) {
+                    sp<Blob> keyBlob(new Blob(key, keySize, true));
+                    shard.mEntries.add(hash, CacheEntry(keyBlob, valueBlob, hash,
+                            android_atomic_inc(&mUseCounter)));
+                    ALOGV("set: created new cache entry with %d byte key and %d "
+                            "byte value", keySize, valueSize);
+                    return;
                 }
-            }
-            mCacheEntries.add(CacheEntry(keyBlob, valueBlob));
-            mTotalSize = newTotalSize;
-            ALOGV("set: created new cache entry with %d byte key and %d byte value",
-                    keySize, valueSize);
-        } else {
-            // Update the existing cache entry.
-            sp<Blob> valueBlob(new Blob(value, valueSize, true));
-            sp<Blob> oldValueBlob(mCacheEntries[index].getValue());
-            size_t newTotalSize = mTotalSize + valueSize - oldValueBlob->getSize();
-            if (mMaxTotalSize < newTotalSize) {
-                if (isCleanable()) {
-                    // Clean the cache and try again.
-                    clean();
-                    continue;
-                } else {
-                    ALOGV("set: not caching new value because the total cache "
-                            "size limit would be exceeded: %d (limit: %d)",
-                            keySize + valueSize, mMaxTotalSize);
-                    break;
+            } else {
+                // Update the existing cache entry.
+                CacheEntry& entry(shard.mEntries.editEntryAt(index));
+                size_t oldValueSize = entry.getValue()->getSize();
+                if (reserve(ssize_t(valueSize) - ssize_t(oldValueSize))) {
+                    entry.setValue(valueBlob);
+                    entry.setLastUse(android_atomic_inc(&mUseCounter));
+                    ALOGV("set: updated existing cache entry with %d byte key and "
+                            "%d byte value", keySize, valueSize);
+                    return;
                 }
             }
-            mCacheEntries.editItemAt(index).setValue(valueBlob);
-            mTotalSize = newTotalSize;
-            ALOGV("set: updated existing cache entry with %d byte key and %d byte "
-                    "value", keySize, valueSize);
         }
-        break;
+
+        // The entry doesn't fit.  Clean the cache and try again; clean takes
+        // all the shard locks, so ours must have been released.
+        if (!clean()) {
+            ALOGV("set: not caching new key/value pair because the total cache "
+                    "size limit would be exceeded: %d (limit: %d)",
+                    keySize + valueSize, mMaxTotalSize);
+            return;
+        }
     }
 }
 
@@ -135,19 +134,38 @@ size_t BlobCache::get(const void* key, size_t keySize, void* value,
     if (mMaxKeySize < keySize) {
         ALOGV("get: not searching because the key is too large: %d (limit %d)",
                 keySize, mMaxKeySize);
+        android_atomic_inc(&mMisses);
         return 0;
     }
-    sp<Blob> dummyKey(new Blob(key, keySize, false));
-    CacheEntry dummyEntry(dummyKey, NULL);
-    ssize_t index = mCacheEntries.indexOf(dummyEntry);
+    const hash_t hash = hashKey(key, keySize);
+    Shard& shard(shardFor(hash));
+    Blob dummyKey(key, keySize, false);
+
+    Mutex::Autolock _l(shard.mLock);
+    ssize_t index = shard.mEntries.find(-1, hash, dummyKey);
     if (index < 0) {
         ALOGV("get: no cache entry found for key of size %d", keySize);
+        android_atomic_inc(&mMisses);
         return 0;
     }
+    CacheEntry& entry(shard.mEntries.editEntryAt(index));
+    if (!entry.isVerified()) {
+        if (!verify(entry)) {
+            ALOGE("get: evicting corrupted cache entry");
+            size_t entrySize = keySize + entry.getValue()->getSize();
+            shard.mEntries.removeAt(index);
+            reserve(-ssize_t(entrySize));
+            android_atomic_inc(&mMisses);
+            return 0;
+        }
+        entry.setVerified();
+    }
+    android_atomic_inc(&mHits);
 
     // The key was found. Return the value if the caller's buffer is large
     // enough.
-    sp<Blob> valueBlob(mCacheEntries[index].getValue());
+    entry.setLastUse(android_atomic_inc(&mUseCounter));
+    sp<Blob> valueBlob(entry.getValue());
     size_t valueBlobSize = valueBlob->getSize();
     if (valueBlobSize <= valueSize) {
         ALOGV("get: copying %d bytes to caller's buffer", valueBlobSize);
@@ -159,20 +177,26 @@ size_t BlobCache::get(const void* key, size_t keySize, void* value,
     return valueBlobSize;
 }
 
+uint32_t BlobCache::getHitCount() const {
+    return uint32_t(android_atomic_acquire_load(&mHits));
+}
+
+uint32_t BlobCache::getMissCount() const {
+    return uint32_t(android_atomic_acquire_load(&mMisses));
+}
+
+uint32_t BlobCache::getEvictionCount() const {
+    return uint32_t(android_atomic_acquire_load(&mEvictions));
+}
+
 static inline size_t align4(size_t size) {
     return (size + 3) & ~3;
 }
 
 size_t BlobCache::getFlattenedSize() const {
-    size_t size = sizeof(Header);
-    for (size_t i = 0; i < mCacheEntries.size(); i++) {
-        const CacheEntry& e(mCacheEntries[i]);
-        sp<Blob> keyBlob = e.getKey();
-        sp<Blob> valueBlob = e.getValue();
-        size = align4(size);
-        size += sizeof(EntryHeader) + keyBlob->getSize() +
-                valueBlob->getSize();
-    }
+    lockShards();
+    size_t size = getFlattenedSizeLocked(0);
+    unlockShards();
     return size;
 }
 
@@ -187,57 +211,268 @@ status_t BlobCache::flatten(void* buffer, size_t size, int fds[], size_t count)
         return BAD_VALUE;
     }
 
-    // Write the cache header
-    if (size < sizeof(Header)) {
-        ALOGE("flatten: not enough room for cache header");
+    lockShards();
+    status_t err = flattenLocked(buffer, size, 0);
+    unlockShards();
+    return err;
+}
+
+status_t BlobCache::unflatten(void const* buffer, size_t size, int fds[],
+        size_t count) {
+    // All errors should result in the BlobCache being in an empty state.
+    clear();
+
+    if (count != 0) {
+        ALOGE("unflatten: nonzero fd count: %zu", count);
+        return BAD_VALUE;
+    }
+
+    const uint8_t* byteBuffer = reinterpret_cast<const uint8_t*>(buffer);
+    Trailer trailer;
+    status_t err = readTrailer(byteBuffer, size, &trailer);
+    if (err == NAME_NOT_FOUND) {
+        // We treat version mismatches as an empty cache.
+        return OK;
+    } else if (err != OK) {
+        return err;
+    }
+
+    // Read cache entries, in the order of the index
+    const IndexEntry* index = reinterpret_cast<const IndexEntry*>(
+            &byteBuffer[trailer.mIndexOffset]);
+    for (size_t i = 0; i < trailer.mNumEntries; i++) {
+        const EntryHeader* eheader = findEntry(byteBuffer, trailer, index[i]);
+        if (eheader == NULL) {
+            clear();
+            ALOGE("unflatten: cache entry out of bounds");
+            return BAD_VALUE;
+        }
+
+        size_t keySize = index[i].mKeySize;
+        size_t valueSize = index[i].mValueSize;
+        const uint8_t* data = eheader->mData;
+        if (eheader->mKeySize != keySize || eheader->mValueSize != valueSize ||
+                checksum(data, keySize, data + keySize, valueSize) !=
+                index[i].mChecksum) {
+            clear();
+            ALOGE("unflatten: corrupted cache entry");
+            return BAD_VALUE;
+        }
+        set(data, keySize, data + keySize, valueSize);
+    }
+
+    return OK;
+}
+
+status_t BlobCache::attach(FileMap* map, size_t offset) {
+    // The mapping releases the map when the last entry using it goes away.
+    sp<Mapping> mapping(new Mapping(map));
+    if (offset > mapping->getSize()) {
+        ALOGE("attach: offset beyond the end of the map");
         return BAD_VALUE;
     }
-    Header* header = reinterpret_cast<Header*>(buffer);
-    header->mMagicNumber = blobCacheMagic;
-    header->mBlobCacheVersion = blobCacheVersion;
-    header->mDeviceVersion = blobCacheDeviceVersion;
-    header->mNumEntries = mCacheEntries.size();
 
-    // Write cache entries
+    const uint8_t* byteBuffer = mapping->getData() + offset;
+    Trailer trailer;
+    status_t err = readTrailer(byteBuffer, mapping->getSize() - offset,
+            &trailer);
+    if (err == NAME_NOT_FOUND) {
+        return OK;
+    } else if (err != OK) {
+        return err;
+    }
+
+    // Only the index is read here; the entries are left untouched until they
+    // are looked up.
+    size_t attached = 0;
+    const IndexEntry* index = reinterpret_cast<const IndexEntry*>(
+            &byteBuffer[trailer.mIndexOffset]);
+    lockShards();
+    // Grow the shards for all of the entries at once; the hashes spread
+    // them evenly.
+    for (size_t s = 0; s < NUM_SHARDS; s++) {
+        BasicHashtable<Blob, CacheEntry>& entries(mShards[s].mEntries);
+        entries.reserve(entries.size() + trailer.mNumEntries / NUM_SHARDS);
+    }
+    for (size_t i = 0; i < trailer.mNumEntries; i++) {
+        const IndexEntry& ie(index[i]);
+        const EntryHeader* eheader = findEntry(byteBuffer, trailer, ie);
+        if (eheader == NULL || ie.mKeySize == 0 || ie.mKeySize > mMaxKeySize ||
+                ie.mValueSize == 0 || ie.mValueSize > mMaxValueSize) {
+            ALOGE("attach: skipping invalid cache entry");
+            continue;
+        }
+
+        const uint8_t* data = eheader->mData;
+        sp<Blob> keyBlob(new Blob(data, ie.mKeySize, mapping));
+        sp<Blob> valueBlob(new Blob(data + ie.mKeySize, ie.mValueSize, mapping));
+        Shard& shard(shardFor(ie.mHash));
+        ssize_t found = shard.mEntries.find(-1, ie.mHash, *keyBlob);
+        if (found >= 0) {
+            // Only drop the entry we have if the serialized one is the same.
+            CacheEntry& entry(shard.mEntries.editEntryAt(found));
+            sp<Blob> oldValue(entry.getValue());
+            if (oldValue->getSize() != ie.mValueSize) {
+                continue;
+            }
+            uint32_t oldChecksum = entry.getOffset() ? entry.getChecksum() :
+                    checksum(entry.getKey().getData(), ie.mKeySize,
+                            oldValue->getData(), ie.mValueSize);
+            if (oldChecksum != ie.mChecksum) {
+                continue;
+            }
+            entry = CacheEntry(keyBlob, valueBlob, ie.mHash, entry.getLastUse(),
+                    ie.mOffset, ie.mChecksum);
+        } else {
+            if (!reserve(ie.mKeySize + ie.mValueSize)) {
+                continue;
+            }
+            shard.mEntries.add(ie.mHash, CacheEntry(keyBlob, valueBlob,
+                    ie.mHash, android_atomic_inc(&mUseCounter), ie.mOffset,
+                    ie.mChecksum));
+        }
+        attached++;
+    }
+    mAttached = mapping;
+    mAppendOffset = trailer.mIndexOffset;
+    unlockShards();
+
+    ALOGV("attach: attached %d of %d cache entries", attached,
+            trailer.mNumEntries);
+    return OK;
+}
+
+size_t BlobCache::getAppendOffset() const {
+    lockShards();
+    size_t offset = mAppendOffset;
+    unlockShards();
+    return offset;
+}
+
+size_t BlobCache::getAppendSize() const {
+    lockShards();
+    size_t size = mAppendOffset ? getFlattenedSizeLocked(mAppendOffset) : 0;
+    unlockShards();
+    return size;
+}
+
+status_t BlobCache::flattenAppend(void* buffer, size_t size) const {
+    status_t err = INVALID_OPERATION;
+    lockShards();
+    if (mAppendOffset) {
+        err = flattenLocked(buffer, size, mAppendOffset);
+    } else {
+        ALOGE("flattenAppend: the cache isn't attached");
+    }
+    unlockShards();
+    return err;
+}
+
+size_t BlobCache::getFlattenedSizeLocked(size_t start) const {
+    size_t size = start ? 0 : align4(sizeof(Header));
+    size_t numEntries = 0;
+    for (size_t s = 0; s < NUM_SHARDS; s++) {
+        const BasicHashtable<Blob, CacheEntry>& entries(mShards[s].mEntries);
+        for (ssize_t i = entries.next(-1); i >= 0; i = entries.next(i)) {
+            const CacheEntry& e(entries.entryAt(i));
+            if (!start || !isAttached(e)) {
+                size += align4(sizeof(EntryHeader) + e.getKey().getSize() +
+                        e.getValue()->getSize());
+            }
+            numEntries++;
+        }
+    }
+    return size + numEntries * sizeof(IndexEntry) + sizeof(Trailer);
+}
+
+status_t BlobCache::flattenLocked(void* buffer, size_t size, size_t start)
+        const {
+    // byteBuffer starts at offset 'start' of the serialized contents.
     uint8_t* byteBuffer = reinterpret_cast<uint8_t*>(buffer);
-    off_t byteOffset = align4(sizeof(Header));
-    for (size_t i = 0; i < mCacheEntries.size(); i++) {
-        const CacheEntry& e(mCacheEntries[i]);
-        sp<Blob> keyBlob = e.getKey();
+    size_t byteOffset = start;
+    if (start == 0) {
+        // Write the cache header
+        if (size < sizeof(Header)) {
+            ALOGE("flatten: not enough room for cache header");
+            return BAD_VALUE;
+        }
+        Header* header = reinterpret_cast<Header*>(buffer);
+        header->mMagicNumber = blobCacheMagic;
+        header->mBlobCacheVersion = blobCacheVersion;
+        header->mDeviceVersion = blobCacheDeviceVersion;
+        byteOffset = align4(sizeof(Header));
+    }
+
+    // Write the cache entries from the least to the most recently used, so
+    // that unflatten, which sets them in that order, keeps their recency.
+    Vector<EntryRef> order;
+    getEntriesByLastUse(&order);
+    Vector<IndexEntry> index;
+    index.setCapacity(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        const CacheEntry& e(entryAt(order[i]));
+        const Blob& keyBlob(e.getKey());
         sp<Blob> valueBlob = e.getValue();
-        size_t keySize = keyBlob->getSize();
+        size_t keySize = keyBlob.getSize();
         size_t valueSize = valueBlob->getSize();
 
+        IndexEntry ie;
+        ie.mHash = e.getHash();
+        ie.mKeySize = keySize;
+        ie.mValueSize = valueSize;
+        if (start && isAttached(e)) {
+            // The entry is already there.
+            ie.mOffset = e.getOffset();
+            ie.mChecksum = e.getChecksum();
+            index.add(ie);
+            continue;
+        }
+
         size_t entrySize = sizeof(EntryHeader) + keySize + valueSize;
-        if (byteOffset + entrySize > size) {
+        if (byteOffset - start + entrySize > size) {
             ALOGE("flatten: not enough room for cache entries");
             return BAD_VALUE;
         }
 
         EntryHeader* eheader = reinterpret_cast<EntryHeader*>(
-            &byteBuffer[byteOffset]);
+            &byteBuffer[byteOffset - start]);
         eheader->mKeySize = keySize;
         eheader->mValueSize = valueSize;
 
-        memcpy(eheader->mData, keyBlob->getData(), keySize);
+        memcpy(eheader->mData, keyBlob.getData(), keySize);
         memcpy(eheader->mData + keySize, valueBlob->getData(), valueSize);
 
-        byteOffset += align4(entrySize);
-    }
+        ie.mOffset = byteOffset;
+        ie.mChecksum = e.getOffset() ? e.getChecksum() :
+                checksum(keyBlob.getData(), keySize, valueBlob->getData(),
+                        valueSize);
+        index.add(ie);
 
-    return OK;
-}
-
-status_t BlobCache::unflatten(void const* buffer, size_t size, int fds[],
-        size_t count) {
-    // All errors should result in the BlobCache being in an empty state.
-    mCacheEntries.clear();
+        byteOffset = align4(byteOffset + entrySize);
+    }
 
-    if (count != 0) {
-        ALOGE("unflatten: nonzero fd count: %zu", count);
+    // Write the index and the trailer
+    size_t indexSize = index.size() * sizeof(IndexEntry);
+    if (byteOffset - start + indexSize + sizeof(Trailer) > size) {
+        ALOGE("flatten: not enough room for cache index");
         return BAD_VALUE;
     }
+    memcpy(&byteBuffer[byteOffset - start], index.array(), indexSize);
+
+    Trailer trailer;
+    trailer.mNumEntries = index.size();
+    trailer.mIndexOffset = byteOffset;
+    trailer.mIndexChecksum = JenkinsHashWhiten(JenkinsHashMixBytes(0,
+            reinterpret_cast<const uint8_t*>(index.array()), indexSize));
+    trailer.mMagicNumber = blobCacheMagic;
+    memcpy(&byteBuffer[byteOffset - start + indexSize], &trailer,
+            sizeof(Trailer));
+
+    return OK;
+}
 
+status_t BlobCache::readTrailer(const uint8_t* buffer, size_t size,
+        Trailer* trailer) {
     // Read the cache header
     if (size < sizeof(Header)) {
         ALOGE("unflatten: not enough room for cache header");
@@ -250,63 +485,197 @@ status_t BlobCache::unflatten(void const* buffer, size_t size, int fds[],
     }
     if (header->mBlobCacheVersion != blobCacheVersion ||
             header->mDeviceVersion != blobCacheDeviceVersion) {
-        // We treat version mismatches as an empty cache.
-        return OK;
+        return NAME_NOT_FOUND;
     }
 
-    // Read cache entries
-    const uint8_t* byteBuffer = reinterpret_cast<const uint8_t*>(buffer);
-    off_t byteOffset = align4(sizeof(Header));
-    size_t numEntries = header->mNumEntries;
-    for (size_t i = 0; i < numEntries; i++) {
-        if (byteOffset + sizeof(EntryHeader) > size) {
-            mCacheEntries.clear();
-            ALOGE("unflatten: not enough room for cache entry headers");
-            return BAD_VALUE;
-        }
+    // Read the trailer, which a truncated buffer won't end with
+    if (size < align4(sizeof(Header)) + sizeof(Trailer)) {
+        ALOGE("unflatten: not enough room for cache trailer");
+        return BAD_VALUE;
+    }
+    memcpy(trailer, buffer + size - sizeof(Trailer), sizeof(Trailer));
+    size_t indexEnd = size - sizeof(Trailer);
+    if (trailer->mMagicNumber != blobCacheMagic ||
+            trailer->mIndexOffset < align4(sizeof(Header)) ||
+            trailer->mIndexOffset > indexEnd ||
+            (trailer->mIndexOffset & 3) != 0 ||
+            (indexEnd - trailer->mIndexOffset) / sizeof(IndexEntry) !=
+                    trailer->mNumEntries ||
+            (indexEnd - trailer->mIndexOffset) % sizeof(IndexEntry) != 0) {
+        ALOGE("unflatten: bad cache trailer");
+        return BAD_VALUE;
+    }
 
-        const EntryHeader* eheader = reinterpret_cast<const EntryHeader*>(
-                &byteBuffer[byteOffset]);
-        size_t keySize = eheader->mKeySize;
-        size_t valueSize = eheader->mValueSize;
-        size_t entrySize = sizeof(EntryHeader) + keySize + valueSize;
+    // Check the index
+    uint32_t indexChecksum = JenkinsHashWhiten(JenkinsHashMixBytes(0,
+            buffer + trailer->mIndexOffset, indexEnd - trailer->mIndexOffset));
+    if (indexChecksum != trailer->mIndexChecksum) {
+        ALOGE("unflatten: corrupted cache index");
+        return BAD_VALUE;
+    }
+    return OK;
+}
 
-        if (byteOffset + entrySize > size) {
-            mCacheEntries.clear();
-            ALOGE("unflatten: not enough room for cache entry headers");
-            return BAD_VALUE;
+const BlobCache::EntryHeader* BlobCache::findEntry(const uint8_t* buffer,
+        const Trailer& trailer, const IndexEntry& indexEntry) {
+    size_t entriesEnd = trailer.mIndexOffset;
+    size_t offset = indexEntry.mOffset;
+    if (offset < align4(sizeof(Header)) || (offset & 3) != 0 ||
+            offset > entriesEnd ||
+            entriesEnd - offset < sizeof(EntryHeader) ||
+            indexEntry.mKeySize > entriesEnd ||
+            indexEntry.mValueSize > entriesEnd ||
+            entriesEnd - offset - sizeof(EntryHeader) <
+                    indexEntry.mKeySize + indexEntry.mValueSize) {
+        return NULL;
+    }
+    return reinterpret_cast<const EntryHeader*>(buffer + offset);
+}
+
+bool BlobCache::verify(const CacheEntry& entry) {
+    const Blob& keyBlob(entry.getKey());
+    sp<Blob> valueBlob(entry.getValue());
+    const EntryHeader* eheader = reinterpret_cast<const EntryHeader*>(
+            reinterpret_cast<const uint8_t*>(keyBlob.getData()) -
+            sizeof(EntryHeader));
+    return eheader->mKeySize == keyBlob.getSize() &&
+            eheader->mValueSize == valueBlob->getSize() &&
+            checksum(keyBlob.getData(), keyBlob.getSize(), valueBlob->getData(),
+                    valueBlob->getSize()) == entry.getChecksum();
+}
+
+bool BlobCache::isAttached(const CacheEntry& entry) const {
+    return entry.getOffset() && entry.getValue()->getMapping() == mAttached;
+}
+
+void BlobCache::getEntriesByLastUse(Vector<EntryRef>* entries) const {
+    for (size_t s = 0; s < NUM_SHARDS; s++) {
+        const BasicHashtable<Blob, CacheEntry>& shardEntries(mShards[s].mEntries);
+        entries->setCapacity(entries->size() + shardEntries.size());
+        for (ssize_t i = shardEntries.next(-1); i >= 0;
+                i = shardEntries.next(i)) {
+            EntryRef ref;
+            ref.mLastUse = shardEntries.entryAt(i).getLastUse();
+            ref.mShard = s;
+            ref.mIndex = i;
+            entries->add(ref);
         }
+    }
+    entries->sort(compareEntryRefs);
+}
 
-        const uint8_t* data = eheader->mData;
-        set(data, keySize, data + keySize, valueSize);
+const BlobCache::CacheEntry& BlobCache::entryAt(const EntryRef& ref) const {
+    return mShards[ref.mShard].mEntries.entryAt(ref.mIndex);
+}
 
-        byteOffset += align4(entrySize);
+void BlobCache::clear() {
+    lockShards();
+    for (size_t s = 0; s < NUM_SHARDS; s++) {
+        mShards[s].mEntries.clear();
     }
+    android_atomic_release_store(0, &mTotalSize);
+    mAttached.clear();
+    mAppendOffset = 0;
+    unlockShards();
+}
 
-    return OK;
+bool BlobCache::reserve(ssize_t delta) {
+    if (delta <= 0) {
+        android_atomic_add(delta, &mTotalSize);
+        return true;
+    }
+    int32_t totalSize;
+    do {
+        totalSize = android_atomic_acquire_load(&mTotalSize);
+        if (mMaxTotalSize < size_t(totalSize) + delta) {
+            return false;
+        }
+    } while (android_atomic_cmpxchg(totalSize, totalSize + delta, &mTotalSize));
+    return true;
 }
 
-long int BlobCache::blob_random() {
-#ifdef _WIN32
-    return rand();
-#else
-    return nrand48(mRandState);
-#endif
+bool BlobCache::clean() {
+    bool cleaned = false;
+    lockShards();
+    // Another thread may have cleaned the cache while we were waiting for the
+    // locks, in which case there is nothing left to do but retry.
+    if (size_t(mTotalSize) > mMaxTotalSize / 2) {
+        Vector<EntryRef> victims;
+        getEntriesByLastUse(&victims);
+
+        // Remove the least recently used entries until the total cache size
+        // gets below half the maximum total cache size.  Removing entries
+        // doesn't move the others, so the indices stay valid.
+        size_t evicted = 0;
+        size_t totalSize = size_t(mTotalSize);
+        while (totalSize > mMaxTotalSize / 2 && evicted < victims.size()) {
+            const EntryRef& v(victims[evicted]);
+            BasicHashtable<Blob, CacheEntry>& entries(mShards[v.mShard].mEntries);
+            const CacheEntry& entry(entries.entryAt(v.mIndex));
+            size_t entrySize = entry.getKey().getSize() +
+                    entry.getValue()->getSize();
+            totalSize -= entrySize;
+            entries.removeAt(v.mIndex);
+            android_atomic_add(-int32_t(entrySize), &mTotalSize);
+            evicted++;
+        }
+        android_atomic_add(evicted, &mEvictions);
+        cleaned = true;
+    }
+    unlockShards();
+    return cleaned;
 }
 
-void BlobCache::clean() {
-    // Remove a random cache entry until the total cache size gets below half
-    // the maximum total cache size.
-    while (mTotalSize > mMaxTotalSize / 2) {
-        size_t i = size_t(blob_random() % (mCacheEntries.size()));
-        const CacheEntry& entry(mCacheEntries[i]);
-        mTotalSize -= entry.getKey()->getSize() + entry.getValue()->getSize();
-        mCacheEntries.removeAt(i);
+void BlobCache::lockShards() const {
+    for (size_t s = 0; s < NUM_SHARDS; s++) {
+        mShards[s].mLock.lock();
     }
 }
 
-bool BlobCache::isCleanable() const {
-    return mTotalSize > mMaxTotalSize / 2;
+void BlobCache::unlockShards() const {
+    for (size_t s = NUM_SHARDS; s > 0; s--) {
+        mShards[s - 1].mLock.unlock();
+    }
+}
+
+int BlobCache::compareEntryRefs(const EntryRef* lhs, const EntryRef* rhs) {
+    // The use counter may wrap around, so compare the difference.
+    int32_t d = int32_t(lhs->mLastUse - rhs->mLastUse);
+    return d < 0 ? -1 : (d > 0 ? 1 : 0);
+}
+
+hash_t BlobCache::hashKey(const void* key, size_t keySize) {
+    // Keys are shader sources and binaries, often kilobytes long. The
+    // checksums stay Jenkins as they're part of the file format.
+    return FastHash(key, keySize);
+}
+
+uint32_t BlobCache::checksum(const void* key, size_t keySize,
+        const void* value, size_t valueSize) {
+    uint32_t hash = JenkinsHashMixBytes(0,
+            reinterpret_cast<const uint8_t*>(key), keySize);
+    return JenkinsHashWhiten(JenkinsHashMixBytes(hash,
+            reinterpret_cast<const uint8_t*>(value), valueSize));
+}
+
+BlobCache::Shard& BlobCache::shardFor(hash_t hash) {
+    return mShards[uint32_t(hash) >> (32 - SHARD_BITS)];
+}
+
+BlobCache::Mapping::Mapping(FileMap* map):
+        mMap(map) {
+}
+
+BlobCache::Mapping::~Mapping() {
+    mMap->release();
+}
+
+const uint8_t* BlobCache::Mapping::getData() const {
+    return reinterpret_cast<const uint8_t*>(mMap->getDataPtr());
+}
+
+size_t BlobCache::Mapping::getSize() const {
+    return mMap->getDataLength();
 }
 
 BlobCache::Blob::Blob(const void* data, size_t size, bool copyData):
@@ -318,18 +687,22 @@ BlobCache::Blob::Blob(const void* data, size_t size, bool copyData):
     }
 }
 
+BlobCache::Blob::Blob(const void* data, size_t size,
+        const sp<Mapping>& mapping):
+        mMapping(mapping),
+        mData(data),
+        mSize(size),
+        mOwnsData(false) {
+}
+
 BlobCache::Blob::~Blob() {
     if (mOwnsData) {
         free(const_cast<void*>(mData));
     }
 }
 
-bool BlobCache::Blob::operator<(const Blob& rhs) const {
-    if (mSize == rhs.mSize) {
-        return memcmp(mData, rhs.mData, mSize) < 0;
-    } else {
-        return mSize < rhs.mSize;
-    }
+bool BlobCache::Blob::operator==(const Blob& rhs) const {
+    return mSize == rhs.mSize && memcmp(mData, rhs.mData, mSize) == 0;
 }
 
 const void* BlobCache::Blob::getData() const {
@@ -340,39 +713,102 @@ size_t BlobCache::Blob::getSize() const {
     return mSize;
 }
 
-BlobCache::CacheEntry::CacheEntry() {
+const sp<BlobCache::Mapping>& BlobCache::Blob::getMapping() const {
+    return mMapping;
 }
 
-BlobCache::CacheEntry::CacheEntry(const sp<Blob>& key, const sp<Blob>& value):
+BlobCache::CacheEntry::CacheEntry():
+        mHash(0),
+        mLastUse(0),
+        mOffset(0),
+        mChecksum(0),
+        mVerified(true) {
+}
+
+BlobCache::CacheEntry::CacheEntry(const sp<Blob>& key, const sp<Blob>& value,
+        hash_t hash, uint32_t lastUse):
         mKey(key),
-        mValue(value) {
+        mValue(value),
+        mHash(hash),
+        mLastUse(lastUse),
+        mOffset(0),
+        mChecksum(0),
+        mVerified(true) {
 }
 
-BlobCache::CacheEntry::CacheEntry(const CacheEntry& ce):
-        mKey(ce.mKey),
-        mValue(ce.mValue) {
+BlobCache::CacheEntry::CacheEntry(const sp<Blob>& key, const sp<Blob>& value,
+        hash_t hash, uint32_t lastUse, size_t offset, uint32_t checksum):
+        mKey(key),
+        mValue(value),
+        mHash(hash),
+        mLastUse(lastUse),
+        mOffset(offset),
+        mChecksum(checksum),
+        mVerified(false) {
 }
 
-bool BlobCache::CacheEntry::operator<(const CacheEntry& rhs) const {
-    return *mKey < *rhs.mKey;
+BlobCache::CacheEntry::CacheEntry(const CacheEntry& ce):
+        mKey(ce.mKey),
+        mValue(ce.mValue),
+        mHash(ce.mHash),
+        mLastUse(ce.mLastUse),
+        mOffset(ce.mOffset),
+        mChecksum(ce.mChecksum),
+        mVerified(ce.mVerified) {
 }
 
 const BlobCache::CacheEntry& BlobCache::CacheEntry::operator=(const CacheEntry& rhs) {
     mKey = rhs.mKey;
     mValue = rhs.mValue;
+    mHash = rhs.mHash;
+    mLastUse = rhs.mLastUse;
+    mOffset = rhs.mOffset;
+    mChecksum = rhs.mChecksum;
+    mVerified = rhs.mVerified;
     return *this;
 }
 
-sp<BlobCache::Blob> BlobCache::CacheEntry::getKey() const {
-    return mKey;
+const BlobCache::Blob& BlobCache::CacheEntry::getKey() const {
+    return *mKey;
 }
 
 sp<BlobCache::Blob> BlobCache::CacheEntry::getValue() const {
     return mValue;
 }
 
+hash_t BlobCache::CacheEntry::getHash() const {
+    return mHash;
+}
+
+uint32_t BlobCache::CacheEntry::getLastUse() const {
+    return mLastUse;
+}
+
+size_t BlobCache::CacheEntry::getOffset() const {
+    return mOffset;
+}
+
+uint32_t BlobCache::CacheEntry::getChecksum() const {
+    return mChecksum;
+}
+
+bool BlobCache::CacheEntry::isVerified() const {
+    return mVerified;
+}
+
 void BlobCache::CacheEntry::setValue(const sp<Blob>& value) {
     mValue = value;
+    mOffset = 0;
+    mChecksum = 0;
+    mVerified = true;
+}
+
+void BlobCache::CacheEntry::setLastUse(uint32_t lastUse) {
+    mLastUse = lastUse;
+}
+
+void BlobCache::CacheEntry::setVerified() {
+    mVerified = true;
 }
 
 } // namespace android
@@ -17,15 +17,136 @@
 #define LOG_TAG "CallStack"
 
 #include <string.h>
+#include <unwind.h>
 
 #include <utils/Log.h>
 #include <utils/Errors.h>
 #include <utils/CallStack.h>
+#include <utils/LinearHashMap.h>
+#include <utils/Mutex.h>
 #include <corkscrew/backtrace.h>
 
 /*****************************************************************************/
 namespace android {
 
+// The symbol of an address, as returned by get_backtrace_symbols().
+struct CachedSymbol {
+    CachedSymbol() : relativePc(0), relativeSymbolAddr(0),
+            hasSymbolName(false), hasDemangledName(false) {
+    }
+
+    explicit CachedSymbol(const backtrace_symbol_t& symbol) :
+            relativePc(symbol.relative_pc),
+            relativeSymbolAddr(symbol.relative_symbol_addr),
+            mapName(symbol.map_name ? symbol.map_name : ""),
+            symbolName(symbol.symbol_name ? symbol.symbol_name : ""),
+            demangledName(symbol.demangled_name ? symbol.demangled_name : ""),
+            hasSymbolName(symbol.symbol_name != NULL),
+            hasDemangledName(symbol.demangled_name != NULL) {
+    }
+
+    // Fills symbol with pointers into this entry.
+    void get(backtrace_symbol_t* symbol) const {
+        symbol->relative_pc = relativePc;
+        symbol->relative_symbol_addr = relativeSymbolAddr;
+        symbol->map_name = const_cast<char*>(mapName.string());
+        symbol->symbol_name = hasSymbolName ? const_cast<char*>(symbolName.string()) : NULL;
+        symbol->demangled_name =
+                hasDemangledName ? const_cast<char*>(demangledName.string()) : NULL;
+    }
+
+    uintptr_t relativePc;
+    uintptr_t relativeSymbolAddr;
+    String8 mapName;
+    String8 symbolName;
+    String8 demangledName;
+    bool hasSymbolName;
+    bool hasDemangledName;
+};
+
+// Symbolizing reads /proc/self/maps and the libraries' symbol tables, so the
+// symbols of the addresses seen so far are kept.  Libraries are rarely
+// unloaded; the cache is simply dropped once it grows this large.
+static const size_t MAX_CACHED_SYMBOLS = 4096;
+
+static Mutex gSymbolCacheLock;
+static LinearHashMap<uintptr_t, CachedSymbol>* gSymbolCache = NULL;
+
+// Formats the frames like format_backtrace_line(), passing each line to emit.
+static void formatFrames(const backtrace_frame_t* frames, size_t count,
+        void (*emit)(void* cookie, const char* line), void* cookie) {
+    Mutex::Autolock _l(gSymbolCacheLock);
+    if (gSymbolCache == NULL) {
+        gSymbolCache = new LinearHashMap<uintptr_t, CachedSymbol>();
+    }
+
+    // symbolize the addresses not seen before all at once
+    backtrace_frame_t misses[CallStack::MAX_DEPTH];
+    size_t missCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uintptr_t pc = frames[i].absolute_pc;
+        if (gSymbolCache->indexOfKey(pc) >= 0) {
+            continue;
+        }
+        bool duplicate = false;
+        for (size_t j = 0; j < missCount && !duplicate; j++) {
+            duplicate = misses[j].absolute_pc == pc;
+        }
+        if (!duplicate) {
+            misses[missCount++] = frames[i];
+        }
+    }
+    if (missCount) {
+        if (gSymbolCache->size() + missCount > MAX_CACHED_SYMBOLS) {
+            gSymbolCache->clear();
+        }
+        backtrace_symbol_t symbols[missCount];
+        get_backtrace_symbols(misses, missCount, symbols);
+        for (size_t j = 0; j < missCount; j++) {
+            gSymbolCache->add(misses[j].absolute_pc, CachedSymbol(symbols[j]));
+        }
+        free_backtrace_symbols(symbols, missCount);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        backtrace_symbol_t symbol;
+        CachedSymbol missing;
+        ssize_t index = gSymbolCache->indexOfKey(frames[i].absolute_pc);
+        (index >= 0 ? gSymbolCache->valueAt(index) : missing).get(&symbol);
+        char line[MAX_BACKTRACE_LINE_LENGTH];
+        format_backtrace_line(i, &frames[i], &symbol, line, MAX_BACKTRACE_LINE_LENGTH);
+        emit(cookie, line);
+    }
+}
+
+struct FastUnwindState {
+    backtrace_frame_t* frames;
+    int32_t ignoreDepth;
+    int32_t maxDepth;
+    int32_t count;
+};
+
+static _Unwind_Reason_Code fastUnwindCallback(struct _Unwind_Context* context, void* arg) {
+    FastUnwindState* state = static_cast<FastUnwindState*>(arg);
+    uintptr_t pc = _Unwind_GetIP(context);
+    if (!pc) {
+        return _URC_END_OF_STACK;
+    }
+    if (state->ignoreDepth > 0) {
+        state->ignoreDepth--;
+        return _URC_NO_REASON;
+    }
+#if defined(__arm__)
+    // drop the thumb bit
+    pc &= ~uintptr_t(1);
+#endif
+    backtrace_frame_t& frame = state->frames[state->count++];
+    frame.absolute_pc = pc;
+    frame.stack_top = 0;
+    frame.stack_size = 0;
+    return state->count < state->maxDepth ? _URC_NO_REASON : _URC_END_OF_STACK;
+}
+
 CallStack::CallStack() :
         mCount(0) {
 }
@@ -101,37 +222,45 @@ void CallStack::update(int32_t ignoreDepth, int32_t maxDepth) {
     mCount = count > 0 ? count : 0;
 }
 
-void CallStack::dump(const char* logtag, const char* prefix) const {
-    backtrace_symbol_t symbols[mCount];
+void CallStack::updateFast(int32_t ignoreDepth, int32_t maxDepth) {
+    if (maxDepth > MAX_DEPTH) {
+        maxDepth = MAX_DEPTH;
+    }
+    mCount = 0;
+    if (maxDepth <= 0) {
+        return;
+    }
+    // the first frame is our own
+    FastUnwindState state = { mStack, ignoreDepth, maxDepth, 0 };
+    _Unwind_Backtrace(fastUnwindCallback, &state);
+    mCount = state.count;
+}
 
-    get_backtrace_symbols(mStack, mCount, symbols);
-    for (size_t i = 0; i < mCount; i++) {
-        char line[MAX_BACKTRACE_LINE_LENGTH];
-        format_backtrace_line(i, &mStack[i], &symbols[i],
-                line, MAX_BACKTRACE_LINE_LENGTH);
-        ALOG(LOG_DEBUG, logtag, "%s%s",
-                prefix ? prefix : "",
-                line);
+static void logLine(void* cookie, const char* line) {
+    const char* const* args = static_cast<const char* const*>(cookie);
+    ALOG(LOG_DEBUG, args[0], "%s%s", args[1], line);
+}
+
+static void appendLine(void* cookie, const char* line) {
+    const void* const* args = static_cast<const void* const*>(cookie);
+    String8* str = static_cast<String8*>(const_cast<void*>(args[0]));
+    const char* prefix = static_cast<const char*>(args[1]);
+    if (prefix) {
+        str->append(prefix);
     }
-    free_backtrace_symbols(symbols, mCount);
+    str->append(line);
+    str->append("\n");
+}
+
+void CallStack::dump(const char* logtag, const char* prefix) const {
+    const char* args[] = { logtag, prefix ? prefix : "" };
+    formatFrames(mStack, mCount, logLine, args);
 }
 
 String8 CallStack::toString(const char* prefix) const {
     String8 str;
-    backtrace_symbol_t symbols[mCount];
-
-    get_backtrace_symbols(mStack, mCount, symbols);
-    for (size_t i = 0; i < mCount; i++) {
-        char line[MAX_BACKTRACE_LINE_LENGTH];
-        format_backtrace_line(i, &mStack[i], &symbols[i],
-                line, MAX_BACKTRACE_LINE_LENGTH);
-        if (prefix) {
-            str.append(prefix);
-        }
-        str.append(line);
-        str.append("\n");
-    }
-    free_backtrace_symbols(symbols, mCount);
+    const void* args[] = { &str, prefix };
+    formatFrames(mStack, mCount, appendLine, args);
     return str;
 }
 
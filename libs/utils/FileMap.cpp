@@ -39,6 +39,26 @@ using namespace android;
 
 /*static*/ long FileMap::mPageSize = -1;
 
+#ifdef HAVE_POSIX_FILEMAP
+/*
+ * mmap() at a 64-bit offset.  Where off_t is 32 bits and there is no
+ * mmap64(), offsets past 2GB fail with EOVERFLOW rather than being
+ * truncated.
+ */
+static void* mmapAt(size_t length, int prot, int flags, int fd, off64_t offset)
+{
+#if defined(__GLIBC__)
+    return mmap64(NULL, length, prot, flags, fd, offset);
+#else
+    if ((off64_t) (off_t) offset != offset) {
+        errno = EOVERFLOW;
+        return MAP_FAILED;
+    }
+    return mmap(NULL, length, prot, flags, fd, (off_t) offset);
+#endif
+}
+#endif
+
 
 /*
  * Constructor.  Create an empty object.
@@ -119,12 +139,12 @@ bool FileMap::create(const char* origFileName, int fd, off64_t offset, size_t le
     
     mBasePtr = MapViewOfFile( mFileMapping, 
                               readOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS,
-                              0,
+                              (DWORD)(((uint64_t) adjOffset) >> 32),
                               (DWORD)(adjOffset),
                               adjLength );
     if (mBasePtr == NULL) {
-        ALOGE("MapViewOfFile(%ld, %ld) failed with error %ld\n",
-              adjOffset, adjLength, GetLastError() );
+        ALOGE("MapViewOfFile(%lld, %ld) failed with error %ld\n",
+              (long long) adjOffset, (long) adjLength, GetLastError() );
         CloseHandle(mFileMapping);
         mFileMapping = INVALID_HANDLE_VALUE;
         return false;
@@ -166,7 +186,7 @@ try_again:
     if (!readOnly)
         prot |= PROT_WRITE;
 
-    ptr = mmap(NULL, adjLength, prot, flags, fd, adjOffset);
+    ptr = mmapAt(adjLength, prot, flags, fd, adjOffset);
     if (ptr == MAP_FAILED) {
     	// Cygwin does not seem to like file mapping files from an offset.
     	// So if we fail, try again with offset zero
@@ -175,8 +195,8 @@ try_again:
     		goto try_again;
     	}
     
-        ALOGE("mmap(%ld,%ld) failed: %s\n",
-            (long) adjOffset, (long) adjLength, strerror(errno));
+        ALOGE("mmap(%lld,%ld) failed: %s\n",
+            (long long) adjOffset, (long) adjLength, strerror(errno));
         return false;
     }
     mBasePtr = ptr;
@@ -223,3 +243,44 @@ int FileMap::advise(MapAdvice advice)
 	return -1;
 #endif // HAVE_MADVISE
 }
+
+/*
+ * Provide guidance to the system about part of the data.
+ */
+int FileMap::advise(MapAdvice advice, size_t offset, size_t length)
+{
+    if (offset > mDataLength || length > mDataLength - offset) {
+        ALOGW("advise range %ld+%ld is outside the map (%ld bytes)\n",
+            (long) offset, (long) length, (long) mDataLength);
+        return -1;
+    }
+    if (length == 0) {
+        return 0;
+    }
+#if HAVE_MADVISE
+    int sysAdvice;
+
+    switch (advice) {
+        case NORMAL:        sysAdvice = MADV_NORMAL;        break;
+        case RANDOM:        sysAdvice = MADV_RANDOM;        break;
+        case SEQUENTIAL:    sysAdvice = MADV_SEQUENTIAL;    break;
+        case WILLNEED:      sysAdvice = MADV_WILLNEED;      break;
+        case DONTNEED:      sysAdvice = MADV_DONTNEED;      break;
+        default:
+                            assert(false);
+                            return -1;
+    }
+
+    /* madvise() wants a page-aligned start; mBasePtr is page-aligned */
+    size_t start = ((char*) mDataPtr - (char*) mBasePtr) + offset;
+    size_t end = start + length;
+    start -= start % mPageSize;
+
+    int cc = madvise((char*) mBasePtr + start, end - start, sysAdvice);
+    if (cc != 0)
+        ALOGW("madvise(%d) failed: %s\n", sysAdvice, strerror(errno));
+    return cc;
+#else
+    return -1;
+#endif // HAVE_MADVISE
+}
@@ -26,6 +26,7 @@
 #define LOG_TAG "LinearAllocator"
 #define LOG_NDEBUG 1
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <utils/LinearAllocator.h>
 #include <utils/Log.h>
@@ -87,9 +88,11 @@ class LinearAllocator::Page {
 public:
     Page* next() { return mNextPage; }
     void setNext(Page* next) { mNextPage = next; }
+    size_t size() const { return mSize; }
 
-    Page()
+    Page(size_t size)
         : mNextPage(0)
+        , mSize(size)
     {}
 
     void* operator new(size_t size, void* buf) { return buf; }
@@ -105,36 +108,63 @@ public:
 private:
     Page(const Page& other) {}
     Page* mNextPage;
+    // Size of the whole page, header included
+    size_t mSize;
 };
 
+struct LinearAllocator::DestructorNode {
+    void (*dtor)(void*);
+    void* obj;
+    DestructorNode* next;
+};
+
+static pthread_once_t gTLSOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t gTLSKey = 0;
+
+static void threadDestructor(void* st) {
+    delete static_cast<LinearAllocator*>(st);
+}
+
+static void initTLSKey() {
+    int result = pthread_key_create(&gTLSKey, threadDestructor);
+    LOG_ALWAYS_FATAL_IF(result != 0, "Could not allocate TLS key.");
+}
+
 LinearAllocator::LinearAllocator()
     : mPageSize(INITIAL_PAGE_SIZE)
     , mMaxAllocSize(MAX_WASTE_SIZE)
     , mNext(0)
     , mCurrentPage(0)
     , mPages(0)
+    , mDedicatedPages(0)
+    , mDestructors(0)
     , mTotalAllocated(0)
     , mWastedSpace(0)
     , mPageCount(0)
     , mDedicatedPageCount(0) {}
 
 LinearAllocator::~LinearAllocator(void) {
-    Page* p = mPages;
+    runDestructors();
+    freePages(mPages);
+    freePages(mDedicatedPages);
+}
+
+void LinearAllocator::freePages(Page* p) {
     while (p) {
         Page* next = p->next();
+        RM_ALLOCATION(p->size());
         p->~Page();
         free(p);
-        RM_ALLOCATION(mPageSize);
         p = next;
     }
 }
 
 void* LinearAllocator::start(Page* p) {
-    return ALIGN_PTR(((size_t*)p) + sizeof(Page));
+    return ALIGN_PTR(((char*)p) + sizeof(Page));
 }
 
 void* LinearAllocator::end(Page* p) {
-    return ((char*)p) + mPageSize;
+    return ((char*)p) + p->size();
 }
 
 bool LinearAllocator::fitsInCurrentPage(size_t size) {
@@ -144,6 +174,15 @@ bool LinearAllocator::fitsInCurrentPage(size_t size) {
 void LinearAllocator::ensureNext(size_t size) {
     if (fitsInCurrentPage(size)) return;
 
+    if (mNext && mCurrentPage->next()) {
+        // Move on to a page kept by reset(). It was created with a size of
+        // at least INITIAL_PAGE_SIZE, so it fits anything not given a
+        // dedicated page.
+        mCurrentPage = mCurrentPage->next();
+        mNext = start(mCurrentPage);
+        return;
+    }
+
     if (mCurrentPage && mPageSize < MAX_PAGE_SIZE) {
         mPageSize = min(MAX_PAGE_SIZE, mPageSize * 2);
         mPageSize = ALIGN(mPageSize);
@@ -167,10 +206,8 @@ void* LinearAllocator::alloc(size_t size) {
         // Allocation is too large, create a dedicated page for the allocation
         Page* page = newPage(size);
         mDedicatedPageCount++;
-        page->setNext(mPages);
-        mPages = page;
-        if (!mCurrentPage)
-            mCurrentPage = mPages;
+        page->setNext(mDedicatedPages);
+        mDedicatedPages = page;
         return start(page);
     }
     ensureNext(size);
@@ -183,7 +220,7 @@ void* LinearAllocator::alloc(size_t size) {
 void LinearAllocator::rewindIfLastAlloc(void* ptr, size_t allocSize) {
     // Don't bother rewinding across pages
     allocSize = ALIGN(allocSize);
-    if (ptr >= start(mCurrentPage) && ptr < end(mCurrentPage)
+    if (mCurrentPage && ptr >= start(mCurrentPage) && ptr < end(mCurrentPage)
             && ptr == ((char*)mNext - allocSize)) {
         mTotalAllocated -= allocSize;
         mWastedSpace += allocSize;
@@ -191,13 +228,67 @@ void LinearAllocator::rewindIfLastAlloc(void* ptr, size_t allocSize) {
     }
 }
 
+void LinearAllocator::addDestructor(void* obj, void (*dtor)(void*)) {
+    // alloc() only aligns to ALIGN_SZ, which is narrower than a pointer on LP64,
+    // so leave room to round the node up to its own alignment.
+    const size_t align = __alignof__(DestructorNode);
+    size_t mem = (size_t) alloc(sizeof(DestructorNode) + align - 1);
+    DestructorNode* node = (DestructorNode*) ((mem + align - 1) & ~(align - 1));
+    node->dtor = dtor;
+    node->obj = obj;
+    node->next = mDestructors;
+    mDestructors = node;
+}
+
+void LinearAllocator::runDestructors() {
+    // Take the list first, in case a destructor allocates from us.
+    DestructorNode* node = mDestructors;
+    mDestructors = 0;
+    while (node) {
+        node->dtor(node->obj);
+        node = node->next;
+    }
+}
+
+void LinearAllocator::reset() {
+    runDestructors();
+
+    for (Page* p = mDedicatedPages; p; p = p->next()) {
+        mTotalAllocated -= p->size();
+        mPageCount--;
+    }
+    freePages(mDedicatedPages);
+    mDedicatedPages = 0;
+    mDedicatedPageCount = 0;
+
+    // Every byte of the kept pages is unused again.
+    mWastedSpace = 0;
+    for (Page* p = mPages; p; p = p->next()) {
+        mWastedSpace += p->size() - ALIGN(sizeof(Page));
+    }
+    mCurrentPage = mPages;
+    mNext = mPages ? start(mPages) : 0;
+}
+
+LinearAllocator& LinearAllocator::getForThread() {
+    int result = pthread_once(&gTLSOnce, initTLSKey);
+    LOG_ALWAYS_FATAL_IF(result != 0, "pthread_once failed");
+
+    LinearAllocator* allocator = static_cast<LinearAllocator*>(pthread_getspecific(gTLSKey));
+    if (!allocator) {
+        allocator = new LinearAllocator();
+        pthread_setspecific(gTLSKey, allocator);
+    }
+    return *allocator;
+}
+
 LinearAllocator::Page* LinearAllocator::newPage(size_t pageSize) {
     pageSize = ALIGN(pageSize + sizeof(LinearAllocator::Page));
     ADD_ALLOCATION(pageSize);
     mTotalAllocated += pageSize;
     mPageCount++;
     void* buf = malloc(pageSize);
-    return new (buf) Page();
+    return new (buf) Page(pageSize);
 }
 
 static const char* toSize(size_t value, float& result) {
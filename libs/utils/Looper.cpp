@@ -19,6 +19,7 @@
 
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/eventfd.h>
 #include <limits.h>
 
 
@@ -61,28 +62,38 @@ int SimpleLooperCallback::handleEvent(int fd, int events, void* data) {
 static const int EPOLL_SIZE_HINT = 8;
 
 // Maximum number of file descriptors for which to retrieve poll events each iteration.
+// Default number of epoll events collected per poll, see setEventBatchSize().
 static const int EPOLL_MAX_EVENTS = 16;
 
 static pthread_once_t gTLSOnce = PTHREAD_ONCE_INIT;
 static pthread_key_t gTLSKey = 0;
 
 Looper::Looper(bool allowNonCallbacks) :
-        mAllowNonCallbacks(allowNonCallbacks), mSendingMessage(false),
-        mResponseIndex(0), mNextMessageUptime(LLONG_MAX) {
-    int wakeFds[2];
-    int result = pipe(wakeFds);
-    LOG_ALWAYS_FATAL_IF(result != 0, "Could not create wake pipe.  errno=%d", errno);
+        mAllowNonCallbacks(allowNonCallbacks), mNextMessageSeq(0), mSendingMessage(false),
+        mEventBatchSize(EPOLL_MAX_EVENTS), mResponseCount(0), mResponseIndex(0),
+        mNextMessageUptime(LLONG_MAX) {
+    // An eventfd coalesces any number of wakes into a single counter that one read()
+    // resets.  Fall back to a pipe on kernels without eventfd.
+    int result;
+    mWakeReadPipeFd = eventfd(0, EFD_NONBLOCK);
+    if (mWakeReadPipeFd >= 0) {
+        mWakeWritePipeFd = mWakeReadPipeFd;
+    } else {
+        int wakeFds[2];
+        result = pipe(wakeFds);
+        LOG_ALWAYS_FATAL_IF(result != 0, "Could not create wake pipe.  errno=%d", errno);
 
-    mWakeReadPipeFd = wakeFds[0];
-    mWakeWritePipeFd = wakeFds[1];
+        mWakeReadPipeFd = wakeFds[0];
+        mWakeWritePipeFd = wakeFds[1];
 
-    result = fcntl(mWakeReadPipeFd, F_SETFL, O_NONBLOCK);
-    LOG_ALWAYS_FATAL_IF(result != 0, "Could not make wake read pipe non-blocking.  errno=%d",
-            errno);
+        result = fcntl(mWakeReadPipeFd, F_SETFL, O_NONBLOCK);
+        LOG_ALWAYS_FATAL_IF(result != 0, "Could not make wake read pipe non-blocking.  errno=%d",
+                errno);
 
-    result = fcntl(mWakeWritePipeFd, F_SETFL, O_NONBLOCK);
-    LOG_ALWAYS_FATAL_IF(result != 0, "Could not make wake write pipe non-blocking.  errno=%d",
-            errno);
+        result = fcntl(mWakeWritePipeFd, F_SETFL, O_NONBLOCK);
+        LOG_ALWAYS_FATAL_IF(result != 0, "Could not make wake write pipe non-blocking.  errno=%d",
+                errno);
+    }
 
     // Allocate the epoll instance and register the wake pipe.
     mEpollFd = epoll_create(EPOLL_SIZE_HINT);
@@ -99,8 +110,13 @@ Looper::Looper(bool allowNonCallbacks) :
 
 Looper::~Looper() {
     close(mWakeReadPipeFd);
-    close(mWakeWritePipeFd);
+    if (mWakeWritePipeFd != mWakeReadPipeFd) {
+        close(mWakeWritePipeFd);
+    }
     close(mEpollFd);
+    for (size_t i = 0; i < mMessageEnvelopes.size(); i++) {
+        delete mMessageEnvelopes.itemAt(i);
+    }
 }
 
 void Looper::initTLSKey() {
@@ -154,10 +170,15 @@ bool Looper::getAllowNonCallbacks() const {
     return mAllowNonCallbacks;
 }
 
+void Looper::setEventBatchSize(int size) {
+    AutoMutex _l(mLock);
+    mEventBatchSize = size > 0 ? size : EPOLL_MAX_EVENTS;
+}
+
 int Looper::pollOnce(int timeoutMillis, int* outFd, int* outEvents, void** outData) {
     int result = 0;
     for (;;) {
-        while (mResponseIndex < mResponses.size()) {
+        while (mResponseIndex < mResponseCount) {
             const Response& response = mResponses.itemAt(mResponseIndex++);
             int ident = response.request.ident;
             if (ident >= 0) {
@@ -211,11 +232,17 @@ int Looper::pollInner(int timeoutMillis) {
 
     // Poll.
     int result = ALOOPER_POLL_WAKE;
-    mResponses.clear();
+    mResponseCount = 0;
     mResponseIndex = 0;
 
-    struct epoll_event eventItems[EPOLL_MAX_EVENTS];
-    int eventCount = epoll_wait(mEpollFd, eventItems, EPOLL_MAX_EVENTS, timeoutMillis);
+    mLock.lock();
+    const size_t eventBatchSize = mEventBatchSize;
+    mLock.unlock();
+    if (mEventItems.size() != eventBatchSize) {
+        mEventItems.resize(eventBatchSize);
+    }
+    struct epoll_event* eventItems = mEventItems.editArray();
+    int eventCount = epoll_wait(mEpollFd, eventItems, eventBatchSize, timeoutMillis);
 
     // Acquire lock.
     mLock.lock();
@@ -254,14 +281,13 @@ int Looper::pollInner(int timeoutMillis) {
                 ALOGW("Ignoring unexpected epoll events 0x%x on wake read pipe.", epollEvents);
             }
         } else {
-            ssize_t requestIndex = mRequests.indexOfKey(fd);
-            if (requestIndex >= 0) {
+            if (size_t(fd) < mRequests.size() && mRequests.itemAt(fd).fd >= 0) {
                 int events = 0;
                 if (epollEvents & EPOLLIN) events |= ALOOPER_EVENT_INPUT;
                 if (epollEvents & EPOLLOUT) events |= ALOOPER_EVENT_OUTPUT;
                 if (epollEvents & EPOLLERR) events |= ALOOPER_EVENT_ERROR;
                 if (epollEvents & EPOLLHUP) events |= ALOOPER_EVENT_HANGUP;
-                pushResponse(events, mRequests.valueAt(requestIndex));
+                pushResponse(events, mRequests.itemAt(fd));
             } else {
                 ALOGW("Ignoring unexpected epoll events 0x%x on fd %d that is "
                         "no longer registered.", epollEvents, fd);
@@ -274,16 +300,16 @@ Done: ;
     mNextMessageUptime = LLONG_MAX;
     while (mMessageEnvelopes.size() != 0) {
         nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
-        const MessageEnvelope& messageEnvelope = mMessageEnvelopes.itemAt(0);
-        if (messageEnvelope.uptime <= now) {
+        MessageEnvelope* const messageEnvelope = mMessageEnvelopes.itemAt(0);
+        if (messageEnvelope->uptime <= now) {
             // Remove the envelope from the list.
             // We keep a strong reference to the handler until the call to handleMessage
             // finishes.  Then we drop it so that the handler can be deleted *before*
             // we reacquire our lock.
             { // obtain handler
-                sp<MessageHandler> handler = messageEnvelope.handler;
-                Message message = messageEnvelope.message;
-                mMessageEnvelopes.removeAt(0);
+                sp<MessageHandler> handler = messageEnvelope->handler;
+                Message message = messageEnvelope->message;
+                removeMessageLocked(messageEnvelope);
                 mSendingMessage = true;
                 mLock.unlock();
 
@@ -299,7 +325,7 @@ Done: ;
             result = ALOOPER_POLL_CALLBACK;
         } else {
             // The last message left at the head of the queue determines the next wakeup time.
-            mNextMessageUptime = messageEnvelope.uptime;
+            mNextMessageUptime = messageEnvelope->uptime;
             break;
         }
     }
@@ -308,7 +334,7 @@ Done: ;
     mLock.unlock();
 
     // Invoke all response callbacks.
-    for (size_t i = 0; i < mResponses.size(); i++) {
+    for (size_t i = 0; i < mResponseCount; i++) {
         Response& response = mResponses.editItemAt(i);
         if (response.request.ident == ALOOPER_POLL_CALLBACK) {
             int fd = response.request.fd;
@@ -363,11 +389,21 @@ void Looper::wake() {
 #endif
 
     ssize_t nWrite;
-    do {
-        nWrite = write(mWakeWritePipeFd, "W", 1);
-    } while (nWrite == -1 && errno == EINTR);
+    size_t size;
+    if (mWakeWritePipeFd == mWakeReadPipeFd) {
+        uint64_t inc = 1;
+        size = sizeof(inc);
+        do {
+            nWrite = write(mWakeWritePipeFd, &inc, size);
+        } while (nWrite == -1 && errno == EINTR);
+    } else {
+        size = 1;
+        do {
+            nWrite = write(mWakeWritePipeFd, "W", size);
+        } while (nWrite == -1 && errno == EINTR);
+    }
 
-    if (nWrite != 1) {
+    if (nWrite != ssize_t(size)) {
         if (errno != EAGAIN) {
             ALOGW("Could not write wake signal, errno=%d", errno);
         }
@@ -379,18 +415,33 @@ void Looper::awoken() {
     ALOGD("%p ~ awoken", this);
 #endif
 
-    char buffer[16];
     ssize_t nRead;
+    if (mWakeWritePipeFd == mWakeReadPipeFd) {
+        uint64_t counter;
+        do {
+            nRead = read(mWakeReadPipeFd, &counter, sizeof(counter));
+        } while (nRead == -1 && errno == EINTR);
+        return;
+    }
+
+    char buffer[16];
     do {
         nRead = read(mWakeReadPipeFd, buffer, sizeof(buffer));
     } while ((nRead == -1 && errno == EINTR) || nRead == sizeof(buffer));
 }
 
 void Looper::pushResponse(int events, const Request& request) {
-    Response response;
-    response.events = events;
-    response.request = request;
-    mResponses.push(response);
+    if (mResponseCount < mResponses.size()) {
+        Response& response = mResponses.editItemAt(mResponseCount);
+        response.events = events;
+        response.request = request;
+    } else {
+        Response response;
+        response.events = events;
+        response.request = request;
+        mResponses.push(response);
+    }
+    mResponseCount++;
 }
 
 int Looper::addFd(int fd, int ident, int events, ALooper_callbackFunc callback, void* data) {
@@ -420,6 +471,7 @@ int Looper::addFd(int fd, int ident, int events, const sp<LooperCallback>& callb
     int epollEvents = 0;
     if (events & ALOOPER_EVENT_INPUT) epollEvents |= EPOLLIN;
     if (events & ALOOPER_EVENT_OUTPUT) epollEvents |= EPOLLOUT;
+    if (events & EVENT_EDGE_TRIGGERED) epollEvents |= EPOLLET;
 
     { // acquire lock
         AutoMutex _l(mLock);
@@ -435,22 +487,27 @@ int Looper::addFd(int fd, int ident, int events, const sp<LooperCallback>& callb
         eventItem.events = epollEvents;
         eventItem.data.fd = fd;
 
-        ssize_t requestIndex = mRequests.indexOfKey(fd);
-        if (requestIndex < 0) {
+        if (fd < 0) {
+            ALOGE("Invalid attempt to add fd %d.", fd);
+            return -1;
+        }
+        if (size_t(fd) >= mRequests.size() || mRequests.itemAt(fd).fd < 0) {
             int epollResult = epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, & eventItem);
             if (epollResult < 0) {
                 ALOGE("Error adding epoll events for fd %d, errno=%d", fd, errno);
                 return -1;
             }
-            mRequests.add(fd, request);
+            if (size_t(fd) >= mRequests.size()) {
+                mRequests.insertAt(Request(), mRequests.size(), fd + 1 - mRequests.size());
+            }
         } else {
             int epollResult = epoll_ctl(mEpollFd, EPOLL_CTL_MOD, fd, & eventItem);
             if (epollResult < 0) {
                 ALOGE("Error modifying epoll events for fd %d, errno=%d", fd, errno);
                 return -1;
             }
-            mRequests.replaceValueAt(requestIndex, request);
         }
+        mRequests.editItemAt(fd) = request;
     } // release lock
     return 1;
 }
@@ -462,8 +519,7 @@ int Looper::removeFd(int fd) {
 
     { // acquire lock
         AutoMutex _l(mLock);
-        ssize_t requestIndex = mRequests.indexOfKey(fd);
-        if (requestIndex < 0) {
+        if (fd < 0 || size_t(fd) >= mRequests.size() || mRequests.itemAt(fd).fd < 0) {
             return 0;
         }
 
@@ -473,7 +529,7 @@ int Looper::removeFd(int fd) {
             return -1;
         }
 
-        mRequests.removeItemsAt(requestIndex);
+        mRequests.editItemAt(fd) = Request();
     } // release lock
     return 1;
 }
@@ -500,13 +556,10 @@ void Looper::sendMessageAtTime(nsecs_t uptime, const sp<MessageHandler>& handler
     { // acquire lock
         AutoMutex _l(mLock);
 
-        size_t messageCount = mMessageEnvelopes.size();
-        while (i < messageCount && uptime >= mMessageEnvelopes.itemAt(i).uptime) {
-            i += 1;
-        }
-
-        MessageEnvelope messageEnvelope(uptime, handler, message);
-        mMessageEnvelopes.insertAt(messageEnvelope, i, 1);
+        MessageEnvelope* messageEnvelope = new MessageEnvelope(uptime, mNextMessageSeq++,
+                handler, message);
+        pushMessageLocked(messageEnvelope);
+        i = messageEnvelope->heapIndex;
 
         // Optimization: If the Looper is currently sending a message, then we can skip
         // the call to wake() because the next thing the Looper will do after processing
@@ -531,10 +584,17 @@ void Looper::removeMessages(const sp<MessageHandler>& handler) {
     { // acquire lock
         AutoMutex _l(mLock);
 
-        for (size_t i = mMessageEnvelopes.size(); i != 0; ) {
-            const MessageEnvelope& messageEnvelope = mMessageEnvelopes.itemAt(--i);
-            if (messageEnvelope.handler == handler) {
-                mMessageEnvelopes.removeAt(i);
+        ssize_t index = mMessagesByHandler.indexOfKey(handler.get());
+        if (index >= 0) {
+            MessageEnvelope* messageEnvelope = mMessagesByHandler.valueAt(index);
+            mMessagesByHandler.removeItemsAt(index);
+            while (messageEnvelope != NULL) {
+                MessageEnvelope* next = messageEnvelope->nextForHandler;
+                // already unlinked from mMessagesByHandler
+                messageEnvelope->prevForHandler = NULL;
+                messageEnvelope->nextForHandler = NULL;
+                removeMessageLocked(messageEnvelope);
+                messageEnvelope = next;
             }
         }
     } // release lock
@@ -548,14 +608,107 @@ void Looper::removeMessages(const sp<MessageHandler>& handler, int what) {
     { // acquire lock
         AutoMutex _l(mLock);
 
-        for (size_t i = mMessageEnvelopes.size(); i != 0; ) {
-            const MessageEnvelope& messageEnvelope = mMessageEnvelopes.itemAt(--i);
-            if (messageEnvelope.handler == handler
-                    && messageEnvelope.message.what == what) {
-                mMessageEnvelopes.removeAt(i);
+        ssize_t index = mMessagesByHandler.indexOfKey(handler.get());
+        MessageEnvelope* messageEnvelope = index >= 0 ? mMessagesByHandler.valueAt(index) : NULL;
+        while (messageEnvelope != NULL) {
+            MessageEnvelope* next = messageEnvelope->nextForHandler;
+            if (messageEnvelope->message.what == what) {
+                removeMessageLocked(messageEnvelope);
             }
+            messageEnvelope = next;
         }
     } // release lock
 }
 
+void Looper::pushMessageLocked(MessageEnvelope* envelope) {
+    envelope->heapIndex = mMessageEnvelopes.add(envelope);
+    siftUpLocked(envelope->heapIndex);
+
+    ssize_t index = mMessagesByHandler.indexOfKey(envelope->handler.get());
+    if (index >= 0) {
+        MessageEnvelope* head = mMessagesByHandler.valueAt(index);
+        envelope->nextForHandler = head;
+        head->prevForHandler = envelope;
+        mMessagesByHandler.replaceValueAt(index, envelope);
+    } else {
+        mMessagesByHandler.add(envelope->handler.get(), envelope);
+    }
+}
+
+void Looper::removeMessageLocked(MessageEnvelope* envelope) {
+    const size_t last = mMessageEnvelopes.size() - 1;
+    const size_t index = envelope->heapIndex;
+    if (index != last) {
+        MessageEnvelope* moved = mMessageEnvelopes.itemAt(last);
+        mMessageEnvelopes.editItemAt(index) = moved;
+        moved->heapIndex = index;
+        mMessageEnvelopes.removeAt(last);
+        if (index > 0 && moved->isBefore(mMessageEnvelopes.itemAt((index - 1) / 2))) {
+            siftUpLocked(index);
+        } else {
+            siftDownLocked(index);
+        }
+    } else {
+        mMessageEnvelopes.removeAt(last);
+    }
+
+    if (envelope->prevForHandler != NULL) {
+        envelope->prevForHandler->nextForHandler = envelope->nextForHandler;
+        if (envelope->nextForHandler != NULL) {
+            envelope->nextForHandler->prevForHandler = envelope->prevForHandler;
+        }
+    } else {
+        ssize_t handlerIndex = mMessagesByHandler.indexOfKey(envelope->handler.get());
+        if (handlerIndex >= 0 && mMessagesByHandler.valueAt(handlerIndex) == envelope) {
+            if (envelope->nextForHandler != NULL) {
+                envelope->nextForHandler->prevForHandler = NULL;
+                mMessagesByHandler.replaceValueAt(handlerIndex, envelope->nextForHandler);
+            } else {
+                mMessagesByHandler.removeItemsAt(handlerIndex);
+            }
+        }
+    }
+    delete envelope;
+}
+
+void Looper::siftUpLocked(size_t index) {
+    MessageEnvelope* const envelope = mMessageEnvelopes.itemAt(index);
+    while (index > 0) {
+        const size_t parent = (index - 1) / 2;
+        MessageEnvelope* const p = mMessageEnvelopes.itemAt(parent);
+        if (!envelope->isBefore(p)) {
+            break;
+        }
+        mMessageEnvelopes.editItemAt(index) = p;
+        p->heapIndex = index;
+        index = parent;
+    }
+    mMessageEnvelopes.editItemAt(index) = envelope;
+    envelope->heapIndex = index;
+}
+
+void Looper::siftDownLocked(size_t index) {
+    const size_t count = mMessageEnvelopes.size();
+    MessageEnvelope* const envelope = mMessageEnvelopes.itemAt(index);
+    for (;;) {
+        size_t child = index * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && mMessageEnvelopes.itemAt(child + 1)->isBefore(
+                mMessageEnvelopes.itemAt(child))) {
+            child++;
+        }
+        MessageEnvelope* const c = mMessageEnvelopes.itemAt(child);
+        if (!c->isBefore(envelope)) {
+            break;
+        }
+        mMessageEnvelopes.editItemAt(index) = c;
+        c->heapIndex = index;
+        index = child;
+    }
+    mMessageEnvelopes.editItemAt(index) = envelope;
+    envelope->heapIndex = index;
+}
+
 } // namespace android
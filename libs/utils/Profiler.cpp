@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "Profiler"
+
+#include <string.h>
+
+#if defined(HAVE_PTHREADS)
+#include <pthread.h>
+#endif
+#if defined(HAVE_PRCTL)
+#include <sys/prctl.h>
+#endif
+
+#include <utils/AndroidThreads.h>
+#include <utils/Mutex.h>
+#include <utils/Profiler.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+// ---------------------------------------------------------------------------
+
+volatile bool Profiler::sEnabled = false;
+
+#if defined(HAVE_PTHREADS)
+
+namespace {
+
+struct Node {
+    const char* name;
+    // node 0 is the root of the tree, and has no parent
+    ssize_t parent;
+    uint32_t count;
+    nsecs_t total;
+    // spent in child scopes
+    nsecs_t children;
+    nsecs_t min;
+    nsecs_t max;
+};
+
+struct Frame {
+    size_t node;
+    nsecs_t start;
+};
+
+/*
+ * The tree of one thread.  Only that thread changes it, but dump() and
+ * reset() read it from others, hence the lock, which is never contended
+ * otherwise.
+ */
+struct ThreadProfile {
+    Mutex lock;
+    pid_t tid;
+    char name[16];
+    Vector<Node> nodes;
+    Vector<Frame> stack;
+    ThreadProfile* next;
+};
+
+} // namespace
+
+static pthread_once_t gProfileKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t gProfileKey;
+// the profiles of the live threads that profiled something
+static Mutex gProfilesLock;
+static ThreadProfile* gProfiles = NULL;
+
+// called when a thread that profiled something exits
+static void freeThreadProfile(void* p) {
+    ThreadProfile* const profile = static_cast<ThreadProfile*>(p);
+    {
+        Mutex::Autolock _l(gProfilesLock);
+        for (ThreadProfile** link = &gProfiles ; *link ;
+                link = &(*link)->next) {
+            if (*link == profile) {
+                *link = profile->next;
+                break;
+            }
+        }
+    }
+    delete profile;
+}
+
+static void createProfileKey() {
+    pthread_key_create(&gProfileKey, freeThreadProfile);
+}
+
+static ThreadProfile* getThreadProfile(bool create) {
+    pthread_once(&gProfileKeyOnce, createProfileKey);
+    ThreadProfile* profile =
+            static_cast<ThreadProfile*>(pthread_getspecific(gProfileKey));
+    if (profile != NULL || !create) {
+        return profile;
+    }
+    profile = new ThreadProfile;
+    profile->tid = androidGetTid();
+    profile->name[0] = 0;
+#if defined(HAVE_PRCTL)
+    prctl(PR_GET_NAME, profile->name, 0, 0, 0);
+    profile->name[sizeof(profile->name) - 1] = 0;
+#endif
+    Node root;
+    memset(&root, 0, sizeof(root));
+    root.parent = -1;
+    profile->nodes.add(root);
+    pthread_setspecific(gProfileKey, profile);
+
+    Mutex::Autolock _l(gProfilesLock);
+    profile->next = gProfiles;
+    gProfiles = profile;
+    return profile;
+}
+
+void Profiler::enter(const char* name) {
+    ThreadProfile* profile = getThreadProfile(true);
+    Mutex::Autolock _l(profile->lock);
+    const size_t parent = profile->stack.isEmpty() ? 0 :
+            profile->stack.top().node;
+    // scopes have few children, and reuse the ones they have
+    const size_t count = profile->nodes.size();
+    size_t node = count;
+    for (size_t i=parent+1 ; i<count ; i++) {
+        const Node& n(profile->nodes[i]);
+        if (n.name == name && n.parent == ssize_t(parent)) {
+            node = i;
+            break;
+        }
+    }
+    if (node == count) {
+        Node n;
+        memset(&n, 0, sizeof(n));
+        n.name = name;
+        n.parent = parent;
+        profile->nodes.add(n);
+    }
+    Frame frame;
+    frame.node = node;
+    frame.start = profilingTime();
+    profile->stack.push(frame);
+}
+
+void Profiler::exit() {
+    const nsecs_t now = profilingTime();
+    ThreadProfile* profile = getThreadProfile(false);
+    if (profile == NULL) {
+        return;
+    }
+    Mutex::Autolock _l(profile->lock);
+    if (profile->stack.isEmpty()) {
+        return;
+    }
+    const Frame frame(profile->stack.top());
+    profile->stack.pop();
+    const nsecs_t duration = now - frame.start;
+    Node& node(profile->nodes.editItemAt(frame.node));
+    if (node.count == 0 || duration < node.min) {
+        node.min = duration;
+    }
+    if (duration > node.max) {
+        node.max = duration;
+    }
+    node.count++;
+    node.total += duration;
+    profile->nodes.editItemAt(node.parent).children += duration;
+}
+
+static void dumpNodes(String8& result, const char* prefix,
+        const Vector<Node>& nodes, size_t parent, int depth) {
+    for (size_t i=parent+1 ; i<nodes.size() ; i++) {
+        const Node& n(nodes[i]);
+        if (n.parent != ssize_t(parent)) {
+            continue;
+        }
+        // a scope that never returned, a thread loop say, counts 0
+        result.appendFormat("%s  %*s%-*s %8u %10.3f %10.3f %9.1f %9.1f %9.1f\n",
+                prefix, depth * 2, "", 40 - depth * 2, n.name, n.count,
+                n.total / 1000000.0, (n.total - n.children) / 1000000.0,
+                n.count ? n.total / 1000.0 / n.count : 0.0,
+                n.min / 1000.0, n.max / 1000.0);
+        dumpNodes(result, prefix, nodes, i, depth + 1);
+    }
+}
+
+void Profiler::dump(String8& result, const char* prefix) {
+    result.appendFormat("%sProfiler (%s):\n", prefix,
+            sEnabled ? "enabled" : "disabled");
+    Mutex::Autolock _l(gProfilesLock);
+    for (ThreadProfile* profile = gProfiles ; profile ;
+            profile = profile->next) {
+        // a copy, the thread goes on meanwhile
+        Vector<Node> nodes;
+        {
+            Mutex::Autolock _p(profile->lock);
+            nodes = profile->nodes;
+        }
+        result.appendFormat("%s thread %d (%s)\n", prefix, profile->tid,
+                profile->name);
+        result.appendFormat("%s  %-40s %8s %10s %10s %9s %9s %9s\n", prefix,
+                "scope", "count", "total ms", "self ms", "avg us", "min us",
+                "max us");
+        dumpNodes(result, prefix, nodes, 0, 0);
+    }
+}
+
+void Profiler::reset() {
+    Mutex::Autolock _l(gProfilesLock);
+    for (ThreadProfile* profile = gProfiles ; profile ;
+            profile = profile->next) {
+        Mutex::Autolock _p(profile->lock);
+        const size_t count = profile->nodes.size();
+        for (size_t i=0 ; i<count ; i++) {
+            Node& n(profile->nodes.editItemAt(i));
+            n.count = 0;
+            n.total = n.children = n.min = n.max = 0;
+        }
+    }
+}
+
+#else
+
+void Profiler::enter(const char* name) {
+}
+
+void Profiler::exit() {
+}
+
+void Profiler::dump(String8& result, const char* prefix) {
+}
+
+void Profiler::reset() {
+}
+
+#endif // HAVE_PTHREADS
+
+void Profiler::setEnabled(bool enabled) {
+    sEnabled = enabled;
+}
+
+// ---------------------------------------------------------------------------
+
+}; // namespace android
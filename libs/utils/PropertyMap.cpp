@@ -76,11 +76,12 @@ bool PropertyMap::tryGetProperty(const String8& key, bool& outValue) const {
 }
 
 bool PropertyMap::tryGetProperty(const String8& key, int32_t& outValue) const {
-    String8 stringValue;
-    if (! tryGetProperty(key, stringValue) || stringValue.length() == 0) {
+    ssize_t index = mProperties.indexOfKey(key);
+    if (index < 0 || mProperties.valueAt(index).isEmpty()) {
         return false;
     }
 
+    const String8& stringValue = mProperties.valueAt(index);
     char* end;
     int value = strtol(stringValue.string(), & end, 10);
     if (*end != '\0') {
@@ -93,11 +94,12 @@ bool PropertyMap::tryGetProperty(const String8& key, int32_t& outValue) const {
 }
 
 bool PropertyMap::tryGetProperty(const String8& key, float& outValue) const {
-    String8 stringValue;
-    if (! tryGetProperty(key, stringValue) || stringValue.length() == 0) {
+    ssize_t index = mProperties.indexOfKey(key);
+    if (index < 0 || mProperties.valueAt(index).isEmpty()) {
         return false;
     }
 
+    const String8& stringValue = mProperties.valueAt(index);
     char* end;
     float value = strtof(stringValue.string(), & end);
     if (*end != '\0') {
@@ -110,8 +112,10 @@ bool PropertyMap::tryGetProperty(const String8& key, float& outValue) const {
 }
 
 void PropertyMap::addAll(const PropertyMap* map) {
-    for (size_t i = 0; i < map->mProperties.size(); i++) {
-        mProperties.add(map->mProperties.keyAt(i), map->mProperties.valueAt(i));
+    const LinearHashMap<String8, String8>& properties = map->mProperties;
+    mProperties.setCapacity(mProperties.size() + properties.size());
+    for (ssize_t i = properties.next(-1); i >= 0; i = properties.next(i)) {
+        mProperties.add(properties.keyAt(i), properties.valueAt(i));
     }
 }
 
@@ -170,8 +174,11 @@ status_t PropertyMap::Parser::parse() {
         mTokenizer->skipDelimiters(WHITESPACE);
 
         if (!mTokenizer->isEol() && mTokenizer->peekChar() != '#') {
-            String8 keyToken = mTokenizer->nextToken(WHITESPACE_OR_PROPERTY_DELIMITER);
-            if (keyToken.isEmpty()) {
+            // the tokens are only copied once the line is known to be valid
+            size_t keyLength;
+            const char* key = mTokenizer->nextTokenInPlace(WHITESPACE_OR_PROPERTY_DELIMITER,
+                    &keyLength);
+            if (keyLength == 0) {
                 ALOGE("%s: Expected non-empty property key.", mTokenizer->getLocation().string());
                 return BAD_VALUE;
             }
@@ -186,8 +193,9 @@ status_t PropertyMap::Parser::parse() {
 
             mTokenizer->skipDelimiters(WHITESPACE);
 
-            String8 valueToken = mTokenizer->nextToken(WHITESPACE);
-            if (valueToken.find("\\", 0) >= 0 || valueToken.find("\"", 0) >= 0) {
+            size_t valueLength;
+            const char* value = mTokenizer->nextTokenInPlace(WHITESPACE, &valueLength);
+            if (memchr(value, '\\', valueLength) || memchr(value, '"', valueLength)) {
                 ALOGE("%s: Found reserved character '\\' or '\"' in property value.",
                         mTokenizer->getLocation().string());
                 return BAD_VALUE;
@@ -201,13 +209,14 @@ status_t PropertyMap::Parser::parse() {
                 return BAD_VALUE;
             }
 
+            String8 keyToken(key, keyLength);
             if (mMap->hasProperty(keyToken)) {
                 ALOGE("%s: Duplicate property value for key '%s'.",
                         mTokenizer->getLocation().string(), keyToken.string());
                 return BAD_VALUE;
             }
 
-            mMap->addProperty(keyToken, valueToken);
+            mMap->addProperty(keyToken, String8(value, valueLength));
         }
 
         mTokenizer->nextLine();
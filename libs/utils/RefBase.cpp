@@ -232,7 +232,7 @@ private:
             ref->ref = mRef;
             ref->id = id;
 #if DEBUG_REFS_CALLSTACK_ENABLED
-            ref->stack.update(2);
+            ref->stack.updateFast(2);
 #endif
             ref->next = *refs;
             *refs = ref;
@@ -316,23 +316,31 @@ private:
 
 // ---------------------------------------------------------------------------
 
+// The strong references collectively hold a single weak reference, taken by
+// the first strong reference and released by the last one, so that copying
+// an sp<> only touches mStrong. The weak reference is tracked under the
+// object's address rather than the id of whichever strong reference took it.
+
 void RefBase::incStrong(const void* id) const
 {
     weakref_impl* const refs = mRefs;
-    refs->incWeak(id);
-    
     refs->addStrongRef(id);
     const int32_t c = android_atomic_inc(&refs->mStrong);
     ALOG_ASSERT(c > 0, "incStrong() called on %p after last strong ref", refs);
 #if PRINT_REFS
     ALOGD("incStrong of %p from %p: cnt=%d\n", this, id, c);
 #endif
-    if (c != INITIAL_STRONG_VALUE)  {
+    if (c > 0 && c != INITIAL_STRONG_VALUE)  {
         return;
     }
 
-    android_atomic_add(-INITIAL_STRONG_VALUE, &refs->mStrong);
-    refs->mBase->onFirstRef();
+    // This is the first strong reference (or the object has an extended
+    // lifetime and is being revived while the caller holds a weak reference).
+    refs->incWeak(this);
+    if (c == INITIAL_STRONG_VALUE) {
+        android_atomic_add(-INITIAL_STRONG_VALUE, &refs->mStrong);
+        refs->mBase->onFirstRef();
+    }
 }
 
 void RefBase::decStrong(const void* id) const
@@ -349,15 +357,13 @@ void RefBase::decStrong(const void* id) const
         if ((refs->mFlags&OBJECT_LIFETIME_MASK) == OBJECT_LIFETIME_STRONG) {
             delete this;
         }
+        refs->decWeak(this);
     }
-    refs->decWeak(id);
 }
 
 void RefBase::forceIncStrong(const void* id) const
 {
     weakref_impl* const refs = mRefs;
-    refs->incWeak(id);
-    
     refs->addStrongRef(id);
     const int32_t c = android_atomic_inc(&refs->mStrong);
     ALOG_ASSERT(c >= 0, "forceIncStrong called on %p after ref count underflow",
@@ -371,6 +377,7 @@ void RefBase::forceIncStrong(const void* id) const
         android_atomic_add(-INITIAL_STRONG_VALUE, &refs->mStrong);
         // fall through...
     case 0:
+        refs->incWeak(this);
         refs->mBase->onFirstRef();
     }
 }
@@ -432,6 +439,7 @@ bool RefBase::weakref_type::attemptIncStrong(const void* id)
     
     weakref_impl* const impl = static_cast<weakref_impl*>(this);
     int32_t curCount = impl->mStrong;
+    bool first = false;
 
     ALOG_ASSERT(curCount >= 0,
             "attemptIncStrong called on %p after underflow", this);
@@ -467,6 +475,7 @@ bool RefBase::weakref_type::attemptIncStrong(const void* id)
             while (curCount > 0) {
                 if (android_atomic_cmpxchg(curCount, curCount + 1,
                         &impl->mStrong) == 0) {
+                    first = (curCount == INITIAL_STRONG_VALUE);
                     break;
                 }
                 // the strong count has changed on us, we need to re-assert our
@@ -492,6 +501,7 @@ bool RefBase::weakref_type::attemptIncStrong(const void* id)
             // grab a strong-reference, which is always safe due to the
             // extended life-time.
             curCount = android_atomic_inc(&impl->mStrong);
+            first = (curCount == 0 || curCount == INITIAL_STRONG_VALUE);
         }
 
         // If the strong reference count has already been incremented by
@@ -506,6 +516,14 @@ bool RefBase::weakref_type::attemptIncStrong(const void* id)
     
     impl->addStrongRef(id);
 
+    // the weak reference taken above becomes the one held by the strong
+    // references if ours is the first, otherwise it isn't needed anymore
+    if (first) {
+        impl->renameWeakRefId(id, impl->mBase);
+    } else {
+        decWeak(id);
+    }
+
 #if PRINT_REFS
     ALOGD("attemptIncStrong of %p from %p: cnt=%d\n", this, id, curCount);
 #endif
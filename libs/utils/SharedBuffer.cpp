@@ -17,6 +17,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef SHARED_BUFFER_POOL
+#include <pthread.h>
+#include <cutils/compiler.h>
+#endif
+
 #include <utils/SharedBuffer.h>
 #include <utils/Atomic.h>
 
@@ -24,9 +29,232 @@
 
 namespace android {
 
+#ifdef SHARED_BUFFER_POOL
+
+/*
+ * Most SharedBuffers are small and short-lived: the String8s and Vectors
+ * of a transaction or a composition.  Buffers of up to MAX_POOLED_SIZE
+ * bytes are rounded up to a size class, and released ones go to a cache
+ * of the releasing thread rather than back to the heap, where the next
+ * alloc() of that class on the thread picks them up.
+ *
+ * The caches are strictly per-thread, so no locking is needed: a buffer
+ * allocated on one thread and released on another simply moves to the
+ * releasing thread's cache.  Each cache holds at most kMaxCached buffers
+ * per class, and is freed when its thread exits.
+ */
+
+// the data sizes of the classes, up to MAX_POOLED_SIZE
+static const size_t kClassSizes[] = { 16, 32, 64, 128, 256 };
+static const size_t kNumClasses = sizeof(kClassSizes) / sizeof(kClassSizes[0]);
+static const uint32_t kMaxCached = 32;
+
+struct ThreadCache {
+    // cached buffers, linked through their data
+    SharedBuffer* buffers[kNumClasses];
+    uint32_t count[kNumClasses];
+    // only written by the thread, read unlocked by getStats()
+    SharedBuffer::Stats stats;
+    ThreadCache* next;
+    ThreadCache* prev;
+};
+
+static pthread_once_t gCacheKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t gCacheKey;
+// protects the list of caches and the counts of exited threads
+static pthread_mutex_t gCachesLock = PTHREAD_MUTEX_INITIALIZER;
+static ThreadCache* gCaches = NULL;
+static SharedBuffer::Stats gExitedStats;
+
+static inline SharedBuffer*& nextCached(SharedBuffer* sb) {
+    return *static_cast<SharedBuffer**>(sb->data());
+}
+
+static void addStats(SharedBuffer::Stats* to, const SharedBuffer::Stats& from) {
+    to->allocs += from.allocs;
+    to->pooledAllocs += from.pooledAllocs;
+    to->resizes += from.resizes;
+    to->pooledResizes += from.pooledResizes;
+    to->frees += from.frees;
+    to->pooledFrees += from.pooledFrees;
+}
+
+static void destroyThreadCache(void* arg) {
+    ThreadCache* cache = static_cast<ThreadCache*>(arg);
+    for (size_t i=0 ; i<kNumClasses ; i++) {
+        SharedBuffer* sb = cache->buffers[i];
+        while (sb) {
+            SharedBuffer* next = nextCached(sb);
+            free(sb);
+            sb = next;
+        }
+    }
+    pthread_mutex_lock(&gCachesLock);
+    if (cache->prev) {
+        cache->prev->next = cache->next;
+    } else {
+        gCaches = cache->next;
+    }
+    if (cache->next) {
+        cache->next->prev = cache->prev;
+    }
+    addStats(&gExitedStats, cache->stats);
+    pthread_mutex_unlock(&gCachesLock);
+    free(cache);
+}
+
+static void createCacheKey() {
+    pthread_key_create(&gCacheKey, destroyThreadCache);
+}
+
+// NULL if the cache can't be allocated: buffers then bypass the pool
+static ThreadCache* getThreadCache() {
+    pthread_once(&gCacheKeyOnce, createCacheKey);
+    ThreadCache* cache = static_cast<ThreadCache*>(pthread_getspecific(gCacheKey));
+    if (CC_LIKELY(cache != NULL)) {
+        return cache;
+    }
+    cache = static_cast<ThreadCache*>(calloc(1, sizeof(ThreadCache)));
+    if (cache == NULL) {
+        return NULL;
+    }
+    pthread_setspecific(gCacheKey, cache);
+    pthread_mutex_lock(&gCachesLock);
+    cache->next = gCaches;
+    if (gCaches) {
+        gCaches->prev = cache;
+    }
+    gCaches = cache;
+    pthread_mutex_unlock(&gCachesLock);
+    return cache;
+}
+
+// the index of the smallest class size fits in, or -1
+static inline ssize_t sizeClass(size_t size) {
+    for (size_t i=0 ; i<kNumClasses ; i++) {
+        if (size <= kClassSizes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+SharedBuffer* SharedBuffer::allocStorage(size_t size)
+{
+    ThreadCache* cache = getThreadCache();
+    if (cache) {
+        cache->stats.allocs++;
+    }
+    const ssize_t cls = sizeClass(size);
+    if (cls < 0) {
+        SharedBuffer* sb = static_cast<SharedBuffer *>(malloc(sizeof(SharedBuffer) + size));
+        if (sb) {
+            sb->mReserved[0] = 0;
+        }
+        return sb;
+    }
+    if (cache && cache->buffers[cls]) {
+        SharedBuffer* sb = cache->buffers[cls];
+        cache->buffers[cls] = nextCached(sb);
+        cache->count[cls]--;
+        cache->stats.pooledAllocs++;
+        return sb;
+    }
+    SharedBuffer* sb = static_cast<SharedBuffer *>(
+            malloc(sizeof(SharedBuffer) + kClassSizes[cls]));
+    if (sb) {
+        sb->mReserved[0] = cls + 1;
+    }
+    return sb;
+}
+
+SharedBuffer* SharedBuffer::resizeStorage(SharedBuffer* sb, size_t size)
+{
+    ThreadCache* cache = getThreadCache();
+    if (cache) {
+        cache->stats.resizes++;
+    }
+    const uint32_t cls = sb->mReserved[0];
+    if (cls == 0) {
+        return static_cast<SharedBuffer *>(realloc(sb, sizeof(SharedBuffer) + size));
+    }
+    // a pooled buffer is never realloc()ed, it either still fits its class
+    // or moves to another buffer, which alloc and free account for
+    if (cache) {
+        cache->stats.pooledResizes++;
+    }
+    if (sizeClass(size) + 1 == ssize_t(cls)) {
+        return sb;
+    }
+    SharedBuffer* moved = allocStorage(size);
+    if (moved) {
+        moved->mRefs = 1;
+        memcpy(moved->data(), sb->data(), size < sb->mSize ? size : sb->mSize);
+        freeStorage(sb);
+    }
+    return moved;
+}
+
+void SharedBuffer::freeStorage(const SharedBuffer* sb)
+{
+    ThreadCache* cache = getThreadCache();
+    if (cache) {
+        cache->stats.frees++;
+        const uint32_t cls = sb->mReserved[0];
+        if (cls && cache->count[cls - 1] < kMaxCached) {
+            SharedBuffer* cached = const_cast<SharedBuffer*>(sb);
+            nextCached(cached) = cache->buffers[cls - 1];
+            cache->buffers[cls - 1] = cached;
+            cache->count[cls - 1]++;
+            cache->stats.pooledFrees++;
+            return;
+        }
+    }
+    free(const_cast<SharedBuffer*>(sb));
+}
+
+bool SharedBuffer::getStats(Stats* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    pthread_mutex_lock(&gCachesLock);
+    addStats(stats, gExitedStats);
+    for (const ThreadCache* cache = gCaches ; cache ; cache = cache->next) {
+        addStats(stats, cache->stats);
+    }
+    pthread_mutex_unlock(&gCachesLock);
+    return true;
+}
+
+#else
+
+SharedBuffer* SharedBuffer::allocStorage(size_t size)
+{
+    return static_cast<SharedBuffer *>(malloc(sizeof(SharedBuffer) + size));
+}
+
+SharedBuffer* SharedBuffer::resizeStorage(SharedBuffer* sb, size_t size)
+{
+    return static_cast<SharedBuffer *>(realloc(sb, sizeof(SharedBuffer) + size));
+}
+
+void SharedBuffer::freeStorage(const SharedBuffer* sb)
+{
+    free(const_cast<SharedBuffer*>(sb));
+}
+
+bool SharedBuffer::getStats(Stats* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    return false;
+}
+
+#endif // SHARED_BUFFER_POOL
+
+// ---------------------------------------------------------------------------
+
 SharedBuffer* SharedBuffer::alloc(size_t size)
 {
-    SharedBuffer* sb = static_cast<SharedBuffer *>(malloc(sizeof(SharedBuffer) + size));
+    SharedBuffer* sb = allocStorage(size);
     if (sb) {
         sb->mRefs = 1;
         sb->mSize = size;
@@ -38,7 +266,7 @@ SharedBuffer* SharedBuffer::alloc(size_t size)
 ssize_t SharedBuffer::dealloc(const SharedBuffer* released)
 {
     if (released->mRefs != 0) return -1; // XXX: invalid operation
-    free(const_cast<SharedBuffer*>(released));
+    freeStorage(released);
     return 0;
 }
 
@@ -60,7 +288,7 @@ SharedBuffer* SharedBuffer::editResize(size_t newSize) const
     if (onlyOwner()) {
         SharedBuffer* buf = const_cast<SharedBuffer*>(this);
         if (buf->mSize == newSize) return buf;
-        buf = (SharedBuffer*)realloc(buf, sizeof(SharedBuffer) + newSize);
+        buf = resizeStorage(buf, newSize);
         if (buf != NULL) {
             buf->mSize = newSize;
             return buf;
@@ -103,7 +331,7 @@ int32_t SharedBuffer::release(uint32_t flags) const
     if (onlyOwner() || ((prev = android_atomic_dec(&mRefs)) == 1)) {
         mRefs = 0;
         if ((flags & eKeepStorage) == 0) {
-            free(const_cast<SharedBuffer*>(this));
+            freeStorage(this);
         }
     }
     return prev;
@@ -26,6 +26,7 @@
 #include <private/utils/Static.h>
 
 #include <ctype.h>
+#include <stdio.h>
 
 /*
  * Functions outside android is below the namespace android, since they use
@@ -311,17 +312,29 @@ status_t String8::appendFormat(const char* fmt, ...)
 
 status_t String8::appendFormatV(const char* fmt, va_list args)
 {
+    // Most formatted appends are short: format them on the stack in a
+    // single pass, and only size the output first when they don't fit.
+    char stackBuf[256];
+    va_list retry;
+    va_copy(retry, args);
     int result = NO_ERROR;
-    int n = vsnprintf(NULL, 0, fmt, args);
-    if (n != 0) {
+    int n = vsnprintf(stackBuf, sizeof(stackBuf), fmt, args);
+    if (n < 0) {
+        result = BAD_VALUE;
+    } else if (size_t(n) < sizeof(stackBuf)) {
+        if (n != 0) {
+            result = real_append(stackBuf, n);
+        }
+    } else {
         size_t oldLength = length();
         char* buf = lockBuffer(oldLength + n);
         if (buf) {
-            vsnprintf(buf + oldLength, n + 1, fmt, args);
+            vsnprintf(buf + oldLength, n + 1, fmt, retry);
         } else {
             result = NO_MEMORY;
         }
     }
+    va_end(retry);
     return result;
 }
 
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <utils/SharedBuffer.h>
+#include <utils/String8Builder.h>
+
+namespace android {
+
+// the first heap allocation, not counting the NUL
+static const size_t kMinCapacity = 64;
+
+// what mData points to until there is storage; never written to
+static char gEmptyBuilderString[1] = { 0 };
+
+String8Builder::String8Builder()
+    : mData(gEmptyBuilderString), mLength(0), mCapacity(0), mBuffer(NULL),
+      mStorage(NULL), mStorageSize(0) {
+}
+
+String8Builder::String8Builder(char* storage, size_t size)
+    : mData(gEmptyBuilderString), mLength(0), mCapacity(0), mBuffer(NULL),
+      mStorage(size ? storage : NULL), mStorageSize(size) {
+    if (mStorage) {
+        mData = mStorage;
+        mData[0] = 0;
+        mCapacity = size - 1;
+    }
+}
+
+String8Builder::~String8Builder() {
+    if (mBuffer) {
+        mBuffer->release();
+    }
+}
+
+status_t String8Builder::grow(size_t extra) {
+    if (extra > size_t(-1) - 1 - mLength) {
+        return NO_MEMORY;
+    }
+    const size_t needed = mLength + extra;
+    if (needed <= mCapacity) {
+        return NO_ERROR;
+    }
+    size_t capacity = mCapacity < kMinCapacity ? kMinCapacity : mCapacity;
+    while (capacity < needed) {
+        capacity = capacity * 2 > capacity ? capacity * 2 : needed;
+    }
+    SharedBuffer* buf;
+    if (mBuffer) {
+        buf = mBuffer->editResize(capacity + 1);
+    } else {
+        // moving off the caller's storage, if any
+        buf = SharedBuffer::alloc(capacity + 1);
+        if (buf) {
+            memcpy(buf->data(), mData, mLength + 1);
+        }
+    }
+    if (!buf) {
+        return NO_MEMORY;
+    }
+    mBuffer = buf;
+    mData = static_cast<char*>(buf->data());
+    mCapacity = capacity;
+    return NO_ERROR;
+}
+
+status_t String8Builder::reserve(size_t capacity) {
+    return capacity > mLength ? grow(capacity - mLength) : NO_ERROR;
+}
+
+status_t String8Builder::append(const char* other) {
+    return append(other, strlen(other));
+}
+
+status_t String8Builder::append(const char* other, size_t numChars) {
+    if (numChars == 0) {
+        return NO_ERROR;
+    }
+    status_t err = grow(numChars);
+    if (err != NO_ERROR) {
+        return err;
+    }
+    memcpy(mData + mLength, other, numChars);
+    mLength += numChars;
+    mData[mLength] = 0;
+    return NO_ERROR;
+}
+
+status_t String8Builder::append(const String8& other) {
+    return append(other.string(), other.length());
+}
+
+status_t String8Builder::append(char c) {
+    return append(&c, 1);
+}
+
+status_t String8Builder::appendFormat(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    status_t result = appendFormatV(fmt, args);
+    va_end(args);
+    return result;
+}
+
+status_t String8Builder::appendFormatV(const char* fmt, va_list args) {
+    // format into the spare capacity, and only again if it was too small
+    va_list retry;
+    va_copy(retry, args);
+    const size_t spare = mCapacity - mLength;
+    char* const end = mCapacity ? mData + mLength : NULL;
+    int n = vsnprintf(end, end ? spare + 1 : 0, fmt, args);
+    status_t result = NO_ERROR;
+    if (n < 0) {
+        result = BAD_VALUE;
+    } else if (size_t(n) <= spare) {
+        mLength += n;
+    } else {
+        result = grow(n);
+        if (result == NO_ERROR) {
+            vsnprintf(mData + mLength, n + 1, fmt, retry);
+            mLength += n;
+        } else if (end) {
+            // drop the truncated output
+            mData[mLength] = 0;
+        }
+    }
+    va_end(retry);
+    return result;
+}
+
+void String8Builder::clear() {
+    mLength = 0;
+    if (mCapacity) {
+        mData[0] = 0;
+    }
+}
+
+String8 String8Builder::toString8() const {
+    return String8(mData, mLength);
+}
+
+String8 String8Builder::release() {
+    String8 result;
+    if (mBuffer && mLength) {
+        // hand the buffer over, trimmed to the string
+        SharedBuffer* buf = mBuffer->editResize(mLength + 1);
+        if (buf) {
+            SharedBuffer::bufferFromData(result.mString)->release();
+            result.mString = static_cast<const char*>(buf->data());
+            mBuffer = NULL;
+            mData = mStorage ? mStorage : gEmptyBuilderString;
+            mCapacity = mStorage ? mStorageSize - 1 : 0;
+            clear();
+            return result;
+        }
+    }
+    if (mLength) {
+        result.setTo(mData, mLength);
+    }
+    clear();
+    return result;
+}
+
+}; // namespace android
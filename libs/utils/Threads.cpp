@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <unistd.h>
@@ -375,6 +376,47 @@ int androidGetThreadPriority(pid_t tid) {
 #endif
 }
 
+int androidSetThreadScheduling(pid_t tid, const android_thread_sched_t* sched)
+{
+    int rc = 0;
+
+#if defined(HAVE_PTHREADS)
+    if (tid == 0) {
+        tid = androidGetTid();
+    }
+
+    if (sched->cpuMask != 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu = 0; cpu < 32; cpu++) {
+            if (sched->cpuMask & (1U << cpu)) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if (sched_setaffinity(tid, sizeof(cpus), &cpus) != 0) {
+            rc = -errno;
+        }
+    }
+
+    if (sched->schedGroup != SP_DEFAULT) {
+        if (set_sched_policy(tid, SchedPolicy(sched->schedGroup)) != 0 && rc == 0) {
+            rc = -errno;
+        }
+    }
+
+    if (sched->policy != SCHED_OTHER) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = sched->rtPriority;
+        if (sched_setscheduler(tid, sched->policy, &param) != 0 && rc == 0) {
+            rc = -errno;
+        }
+    }
+#endif
+
+    return rc;
+}
+
 #endif
 
 namespace android {
@@ -698,7 +740,8 @@ Thread::Thread(bool canCallJava)
         mThread(thread_id_t(-1)),
         mLock("Thread::mLock"),
         mStatus(NO_ERROR),
-        mExitPending(false), mRunning(false)
+        mExitPending(false), mRunning(false),
+        mHasSched(false)
 #ifdef HAVE_ANDROID_OS
         , mTid(-1)
 #endif
@@ -715,6 +758,18 @@ status_t Thread::readyToRun()
 }
 
 status_t Thread::run(const char* name, int32_t priority, size_t stack)
+{
+    return startThread(name, priority, stack, NULL);
+}
+
+status_t Thread::run(const char* name, int32_t priority, size_t stack,
+        const android_thread_sched_t& sched)
+{
+    return startThread(name, priority, stack, &sched);
+}
+
+status_t Thread::startThread(const char* name, int32_t priority, size_t stack,
+        const android_thread_sched_t* sched)
 {
     Mutex::Autolock _l(mLock);
 
@@ -728,6 +783,10 @@ status_t Thread::run(const char* name, int32_t priority, size_t stack)
     mStatus = NO_ERROR;
     mExitPending = false;
     mThread = thread_id_t(-1);
+    mHasSched = sched != NULL;
+    if (sched) {
+        mSched = *sched;
+    }
     
     // hold a strong reference on ourself
     mHoldSelf = this;
@@ -772,6 +831,16 @@ int Thread::_threadLoop(void* user)
 #ifdef HAVE_ANDROID_OS
     // this is very useful for debugging with gdb
     self->mTid = gettid();
+
+    // applied before readyToRun(), so none of the subclass's code runs
+    // with the inherited settings
+    if (self->mHasSched) {
+        int err = androidSetThreadScheduling(0, &self->mSched);
+        if (err != 0) {
+            ALOGW("could not apply scheduling settings to thread %d: %s",
+                    self->mTid, strerror(-err));
+        }
+    }
 #endif
 
     bool first = true;
@@ -32,6 +32,158 @@
 #include <windows.h>
 #endif
 
+#if defined(HAVE_POSIX_CLOCKS) && defined(__linux__)
+#include <elf.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#define HAVE_VDSO_CLOCK 1
+#endif
+
+#if defined(HAVE_POSIX_CLOCKS) && !defined(CLOCK_MONOTONIC_COARSE)
+#define CLOCK_MONOTONIC_COARSE 6
+#endif
+
+#if defined(HAVE_VDSO_CLOCK)
+
+/*
+ * The kernel maps a vDSO in every process, whose clock_gettime() reads the
+ * clocks it can from shared memory instead of making a system call.  Not
+ * every libc uses it, so look it up ourselves, once, and fall back to
+ * clock_gettime() when the kernel doesn't export one.
+ */
+
+#if defined(__LP64__)
+typedef Elf64_Ehdr vdso_ehdr_t;
+typedef Elf64_Phdr vdso_phdr_t;
+typedef Elf64_Dyn vdso_dyn_t;
+typedef Elf64_Sym vdso_sym_t;
+typedef Elf64_Word vdso_word_t;
+typedef uint64_t vdso_auxv_t;
+#else
+typedef Elf32_Ehdr vdso_ehdr_t;
+typedef Elf32_Phdr vdso_phdr_t;
+typedef Elf32_Dyn vdso_dyn_t;
+typedef Elf32_Sym vdso_sym_t;
+typedef Elf32_Word vdso_word_t;
+typedef uint32_t vdso_auxv_t;
+#endif
+
+#ifndef AT_SYSINFO_EHDR
+#define AT_SYSINFO_EHDR 33
+#endif
+
+#if defined(__aarch64__)
+static const char kVdsoClockGettime[] = "__kernel_clock_gettime";
+#else
+static const char kVdsoClockGettime[] = "__vdso_clock_gettime";
+#endif
+
+typedef int (*clock_gettime_t)(clockid_t, struct timespec*);
+
+static pthread_once_t gVdsoOnce = PTHREAD_ONCE_INIT;
+static clock_gettime_t gClockGettime = clock_gettime;
+
+static const vdso_ehdr_t* findVdso()
+{
+    int fd = open("/proc/self/auxv", O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    const vdso_ehdr_t* vdso = NULL;
+    vdso_auxv_t entry[2];
+    while (read(fd, entry, sizeof(entry)) == sizeof(entry) && entry[0]) {
+        if (entry[0] == AT_SYSINFO_EHDR) {
+            vdso = reinterpret_cast<const vdso_ehdr_t*>(uintptr_t(entry[1]));
+            break;
+        }
+    }
+    close(fd);
+    return vdso;
+}
+
+static void* findVdsoSymbol(const vdso_ehdr_t* ehdr, const char* name)
+{
+    if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG)) {
+        return NULL;
+    }
+    const char* base = reinterpret_cast<const char*>(ehdr);
+    const vdso_phdr_t* phdr =
+            reinterpret_cast<const vdso_phdr_t*>(base + ehdr->e_phoff);
+    // symbol values are relative to where the vDSO was linked to load
+    uintptr_t load = 0;
+    bool loaded = false;
+    const vdso_dyn_t* dyn = NULL;
+    for (int i=0 ; i<ehdr->e_phnum ; i++) {
+        if (phdr[i].p_type == PT_LOAD && !loaded) {
+            load = uintptr_t(base) + phdr[i].p_offset - phdr[i].p_vaddr;
+            loaded = true;
+        } else if (phdr[i].p_type == PT_DYNAMIC) {
+            dyn = reinterpret_cast<const vdso_dyn_t*>(base + phdr[i].p_offset);
+        }
+    }
+    if (!loaded || dyn == NULL) {
+        return NULL;
+    }
+    const char* strtab = NULL;
+    const vdso_sym_t* symtab = NULL;
+    const vdso_word_t* hash = NULL;
+    for ( ; dyn->d_tag != DT_NULL ; dyn++) {
+        const char* ptr = reinterpret_cast<const char*>(load + dyn->d_un.d_ptr);
+        switch (dyn->d_tag) {
+            case DT_STRTAB:
+                strtab = ptr;
+                break;
+            case DT_SYMTAB:
+                symtab = reinterpret_cast<const vdso_sym_t*>(ptr);
+                break;
+            case DT_HASH:
+                hash = reinterpret_cast<const vdso_word_t*>(ptr);
+                break;
+        }
+    }
+    if (strtab == NULL || symtab == NULL || hash == NULL) {
+        return NULL;
+    }
+    // the second word of the SysV hash table is the number of symbols
+    const vdso_word_t count = hash[1];
+    for (vdso_word_t i=0 ; i<count ; i++) {
+        const vdso_sym_t& sym(symtab[i]);
+        if ((sym.st_info & 0xf) == STT_FUNC &&
+                sym.st_shndx != SHN_UNDEF &&
+                !strcmp(strtab + sym.st_name, name)) {
+            return reinterpret_cast<void*>(load + sym.st_value);
+        }
+    }
+    return NULL;
+}
+
+static void initVdso()
+{
+    const vdso_ehdr_t* vdso = findVdso();
+    if (vdso != NULL) {
+        void* fn = findVdsoSymbol(vdso, kVdsoClockGettime);
+        if (fn != NULL) {
+            gClockGettime = reinterpret_cast<clock_gettime_t>(fn);
+        }
+    }
+}
+
+static inline int readClock(clockid_t clock, struct timespec* t)
+{
+    pthread_once(&gVdsoOnce, initVdso);
+    return gClockGettime(clock, t);
+}
+
+#elif defined(HAVE_POSIX_CLOCKS)
+
+static inline int readClock(clockid_t clock, struct timespec* t)
+{
+    return clock_gettime(clock, t);
+}
+
+#endif // HAVE_VDSO_CLOCK
+
 nsecs_t systemTime(int clock)
 {
 #if defined(HAVE_POSIX_CLOCKS)
@@ -40,11 +192,16 @@ nsecs_t systemTime(int clock)
             CLOCK_MONOTONIC,
             CLOCK_PROCESS_CPUTIME_ID,
             CLOCK_THREAD_CPUTIME_ID,
-            CLOCK_BOOTTIME
+            CLOCK_BOOTTIME,
+            CLOCK_MONOTONIC_COARSE
     };
     struct timespec t;
     t.tv_sec = t.tv_nsec = 0;
-    clock_gettime(clocks[clock], &t);
+    if (readClock(clocks[clock], &t) != 0 &&
+            clock == SYSTEM_TIME_MONOTONIC_COARSE) {
+        // kernels before 2.6.32 don't have the coarse clocks
+        readClock(CLOCK_MONOTONIC, &t);
+    }
     return nsecs_t(t.tv_sec)*1000000000LL + t.tv_nsec;
 #else
     // we don't support the clocks here.
@@ -55,6 +212,73 @@ nsecs_t systemTime(int clock)
 #endif
 }
 
+#if defined(HAVE_PTHREADS) && (defined(__i386__) || defined(__x86_64__) || \
+        defined(__aarch64__))
+#define HAVE_CYCLE_COUNTER 1
+
+static inline uint64_t readCycleCounter()
+{
+#if defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r" (ticks));
+    return ticks;
+#else
+    uint32_t lo, hi;
+    asm volatile("rdtsc" : "=a" (lo), "=d" (hi));
+    return (uint64_t(hi) << 32) | lo;
+#endif
+}
+
+static pthread_once_t gCycleCounterOnce = PTHREAD_ONCE_INIT;
+// 0 when the counter is unusable
+static double gNsPerTick = 0;
+static uint64_t gBaseTicks;
+static nsecs_t gBaseTime;
+
+static void calibrateCycleCounter()
+{
+#if defined(__aarch64__)
+    // the generic timer tells its frequency
+    uint64_t frequency;
+    asm volatile("mrs %0, cntfrq_el0" : "=r" (frequency));
+    gBaseTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    gBaseTicks = readCycleCounter();
+    if (frequency) {
+        gNsPerTick = 1e9 / double(frequency);
+    }
+#else
+    // measure the TSC against the monotonic clock for a couple of ms
+    const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    const uint64_t startTicks = readCycleCounter();
+    nsecs_t now;
+    uint64_t ticks;
+    do {
+        now = systemTime(SYSTEM_TIME_MONOTONIC);
+        ticks = readCycleCounter();
+    } while (now - start < 2000000LL);
+    gBaseTime = start;
+    gBaseTicks = startTicks;
+    if (ticks > startTicks) {
+        gNsPerTick = double(now - start) / double(ticks - startTicks);
+    }
+#endif
+}
+
+#endif // HAVE_CYCLE_COUNTER
+
+nsecs_t profilingTime(void)
+{
+#if defined(HAVE_CYCLE_COUNTER)
+    pthread_once(&gCycleCounterOnce, calibrateCycleCounter);
+    if (gNsPerTick) {
+        // signed, another CPU's counter may be slightly behind
+        const int64_t ticks = int64_t(readCycleCounter() - gBaseTicks);
+        return gBaseTime + nsecs_t(double(ticks) * gNsPerTick);
+    }
+#endif
+    return systemTime(SYSTEM_TIME_MONOTONIC);
+}
+
 int toMillisecondTimeoutDelay(nsecs_t referenceTime, nsecs_t timeoutTime)
 {
     int timeoutDelayMillis;
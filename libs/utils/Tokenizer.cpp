@@ -71,7 +71,8 @@ status_t Tokenizer::open(const String8& filename, Tokenizer** outTokenizer) {
             bool ownBuffer = false;
             char* buffer;
             if (fileMap->create(NULL, fd, 0, length, true)) {
-                fileMap->advise(FileMap::SEQUENTIAL);
+                // the whole file is parsed right away
+                fileMap->advise(FileMap::WILLNEED);
                 buffer = static_cast<char*>(fileMap->getDataPtr());
             } else {
                 fileMap->release();
@@ -129,6 +130,12 @@ String8 Tokenizer::peekRemainderOfLine() const {
 }
 
 String8 Tokenizer::nextToken(const char* delimiters) {
+    size_t length;
+    const char* token = nextTokenInPlace(delimiters, &length);
+    return String8(token, length);
+}
+
+const char* Tokenizer::nextTokenInPlace(const char* delimiters, size_t* outLength) {
 #if DEBUG_TOKENIZER
     ALOGD("nextToken");
 #endif
@@ -141,7 +148,8 @@ String8 Tokenizer::nextToken(const char* delimiters) {
         }
         mCurrent += 1;
     }
-    return String8(tokenStart, mCurrent - tokenStart);
+    *outLength = mCurrent - tokenStart;
+    return tokenStart;
 }
 
 void Tokenizer::nextLine() {
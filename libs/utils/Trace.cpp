@@ -16,10 +16,30 @@
 
 #include <utils/misc.h>
 #include <utils/Trace.h>
+#include <utils/TraceBuffer.h>
+#include <utils/TraceTagMap.h>
 
 static void traceInit() __attribute__((constructor));
 
+static void traceUpdate()
+{
+    atrace_update_tags();
+    ::android::TraceBuffer::updateFromProperty();
+}
+
+static void traceSysPropChanged()
+{
+    // atrace may have created the tag map since we last looked
+    if (!::android::TraceTagMap::isAttached()) {
+        ::android::TraceTagMap::attach();
+    }
+    traceUpdate();
+}
+
 static void traceInit()
 {
-    ::android::add_sysprop_change_callback(atrace_update_tags, 0);
+    ::android::TraceBuffer::updateFromProperty();
+    ::android::TraceTagMap::setChangeCallback(traceUpdate);
+    ::android::TraceTagMap::attach();
+    ::android::add_sysprop_change_callback(traceSysPropChanged, 0);
 }
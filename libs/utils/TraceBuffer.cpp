@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TraceBuffer"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(HAVE_PRCTL)
+#include <sys/prctl.h>
+#endif
+
+#include <cutils/atomic.h>
+#include <cutils/properties.h>
+#include <utils/AndroidThreads.h>
+#include <utils/Log.h>
+#include <utils/Mutex.h>
+#include <utils/String8.h>
+#include <utils/TraceBuffer.h>
+
+namespace android {
+
+static const char* const kRingBufferProperty = "debug.atrace.ringbuffer";
+
+const char* const TraceBuffer::DRAIN_DIR = "/data/misc/atrace";
+
+volatile int32_t TraceBuffer::sEnabled = 0;
+
+// One begin or end event.  End events have an empty name.
+struct TraceRecord {
+    nsecs_t when;
+    char name[TraceBuffer::MAX_NAME_LENGTH];
+};
+
+// The events of one thread.  Only the owning thread writes records and
+// advances mHead; mDrained is only touched with gRingsLock held.  Rings are
+// never freed: once their thread has exited and they have been drained they
+// are handed to the next new thread.
+struct TraceRing {
+    TraceRing* mNext;
+    pid_t mTid;
+    char mComm[16];
+    volatile int32_t mHead;     // events ever written, modulo 2^32
+    uint32_t mDrained;          // value of mHead at the last drain
+    volatile int32_t mOrphaned; // the owning thread has exited
+    TraceRecord mRecords[TraceBuffer::RING_CAPACITY];
+};
+
+static pthread_once_t gTLSOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t gTLSKey = 0;
+
+static Mutex gRingsLock;
+static TraceRing* gRings = NULL;
+
+static void threadDestructor(void* st) {
+    TraceRing* const ring = static_cast<TraceRing*>(st);
+    android_atomic_release_store(1, &ring->mOrphaned);
+}
+
+static void initTLSKey() {
+    int result = pthread_key_create(&gTLSKey, threadDestructor);
+    LOG_ALWAYS_FATAL_IF(result != 0, "Could not allocate TLS key.");
+}
+
+static TraceRing* getRingForThread() {
+    int result = pthread_once(&gTLSOnce, initTLSKey);
+    LOG_ALWAYS_FATAL_IF(result != 0, "pthread_once failed");
+
+    TraceRing* ring = static_cast<TraceRing*>(pthread_getspecific(gTLSKey));
+    if (CC_LIKELY(ring != NULL)) {
+        return ring;
+    }
+
+    {
+        Mutex::Autolock _l(gRingsLock);
+        for (TraceRing* r = gRings; r != NULL; r = r->mNext) {
+            if (android_atomic_acquire_load(&r->mOrphaned)
+                    && r->mDrained == uint32_t(r->mHead)) {
+                ring = r;
+                break;
+            }
+        }
+        if (ring == NULL) {
+            ring = static_cast<TraceRing*>(calloc(1, sizeof(TraceRing)));
+            if (ring == NULL) {
+                return NULL;
+            }
+            ring->mNext = gRings;
+            gRings = ring;
+        }
+        ring->mTid = androidGetTid();
+        strcpy(ring->mComm, "<...>");
+#if defined(HAVE_PRCTL)
+        prctl(PR_GET_NAME, (unsigned long) ring->mComm, 0, 0, 0);
+#endif
+        ring->mOrphaned = 0;
+    }
+    pthread_setspecific(gTLSKey, ring);
+    return ring;
+}
+
+static inline void record(const char* name) {
+    TraceRing* const ring = getRingForThread();
+    if (CC_UNLIKELY(ring == NULL)) {
+        return;
+    }
+    const uint32_t head = uint32_t(ring->mHead);
+    TraceRecord& r = ring->mRecords[head & (TraceBuffer::RING_CAPACITY - 1)];
+    r.when = systemTime(SYSTEM_TIME_MONOTONIC);
+    size_t i = 0;
+    if (name != NULL) {
+        for (; i < TraceBuffer::MAX_NAME_LENGTH - 1 && name[i]; i++) {
+            r.name[i] = name[i];
+        }
+    }
+    r.name[i] = '\0';
+    android_atomic_release_store(int32_t(head + 1), &ring->mHead);
+}
+
+void TraceBuffer::setEnabled(bool enabled) {
+    if (enabled) {
+        // Forget whatever was left from an earlier session.
+        Mutex::Autolock _l(gRingsLock);
+        for (TraceRing* r = gRings; r != NULL; r = r->mNext) {
+            r->mDrained = uint32_t(android_atomic_acquire_load(&r->mHead));
+        }
+    }
+    android_atomic_release_store(enabled ? 1 : 0, &sEnabled);
+}
+
+void TraceBuffer::begin(const char* name) {
+    // An empty name would read back as an end event.
+    record(name != NULL && name[0] ? name : "?");
+}
+
+void TraceBuffer::end() {
+    record(NULL);
+}
+
+// Writes out buf once less than 'reserve' bytes are left in it.
+static status_t flushIfFull(int fd, char* buf, size_t* len, size_t size,
+        size_t reserve) {
+    if (*len + reserve <= size) {
+        return NO_ERROR;
+    }
+    size_t written = 0;
+    while (written < *len) {
+        ssize_t n = write(fd, buf + written, *len - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        written += size_t(n);
+    }
+    *len = 0;
+    return NO_ERROR;
+}
+
+status_t TraceBuffer::drain(int fd) {
+    Mutex::Autolock _l(gRingsLock);
+
+    const pid_t pid = getpid();
+    TraceRecord* copy = static_cast<TraceRecord*>(
+            malloc(RING_CAPACITY * sizeof(TraceRecord)));
+    if (copy == NULL) {
+        return NO_MEMORY;
+    }
+
+    const size_t bufSize = 16 * 1024;
+    const size_t maxLine = 128 + MAX_NAME_LENGTH;
+    char buf[bufSize];
+    size_t len = 0;
+    status_t err = NO_ERROR;
+
+    for (TraceRing* ring = gRings; ring != NULL && err == NO_ERROR;
+            ring = ring->mNext) {
+        const uint32_t head = uint32_t(android_atomic_acquire_load(&ring->mHead));
+        uint32_t start = ring->mDrained;
+        if (head - start > uint32_t(RING_CAPACITY)) {
+            start = head - RING_CAPACITY;
+        }
+        for (uint32_t i = start; i != head; i++) {
+            copy[i & (RING_CAPACITY - 1)] = ring->mRecords[i & (RING_CAPACITY - 1)];
+        }
+
+        // The owning thread may have kept writing while we copied, and
+        // overwritten the oldest records; skip those.
+        const uint32_t after = uint32_t(android_atomic_acquire_load(&ring->mHead));
+        if (after - start > uint32_t(RING_CAPACITY)) {
+            start = after - RING_CAPACITY;
+            if (head - start > uint32_t(RING_CAPACITY)) {
+                start = head;
+            }
+        }
+
+        for (uint32_t i = start; i != head && err == NO_ERROR; i++) {
+            const TraceRecord& r = copy[i & (RING_CAPACITY - 1)];
+            const unsigned long secs = (unsigned long)(r.when / 1000000000LL);
+            const unsigned long usecs =
+                    (unsigned long)((r.when % 1000000000LL) / 1000);
+            int n = snprintf(buf + len, bufSize - len,
+                    "%16s-%-5d (%5d) [000] ...1 %5lu.%06lu: tracing_mark_write: ",
+                    ring->mComm, ring->mTid, pid, secs, usecs);
+            if (n > 0) {
+                len += size_t(n);
+            }
+            if (r.name[0]) {
+                n = snprintf(buf + len, bufSize - len, "B|%d|%s\n", pid, r.name);
+            } else {
+                n = snprintf(buf + len, bufSize - len, "E\n");
+            }
+            if (n > 0) {
+                len += size_t(n);
+            }
+            err = flushIfFull(fd, buf, &len, bufSize, maxLine);
+        }
+        ring->mDrained = head;
+    }
+
+    if (err == NO_ERROR) {
+        err = flushIfFull(fd, buf, &len, bufSize, bufSize);
+    }
+    free(copy);
+    return err;
+}
+
+status_t TraceBuffer::drainToFile() {
+    {
+        Mutex::Autolock _l(gRingsLock);
+        bool pending = false;
+        for (TraceRing* r = gRings; r != NULL && !pending; r = r->mNext) {
+            pending = r->mDrained != uint32_t(android_atomic_acquire_load(&r->mHead));
+        }
+        if (!pending) {
+            return NO_ERROR;
+        }
+    }
+
+    String8 path(String8::format("%s/%d.trace", DRAIN_DIR, getpid()));
+    int fd = open(path.string(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        ALOGE("could not open %s: %s (%d)", path.string(), strerror(errno), errno);
+        return -errno;
+    }
+    status_t err = drain(fd);
+    if (err != NO_ERROR) {
+        ALOGE("error writing %s: %s (%d)", path.string(), strerror(-err), -err);
+    }
+    close(fd);
+    return err;
+}
+
+void TraceBuffer::updateFromProperty() {
+    char value[PROPERTY_VALUE_MAX];
+    property_get(kRingBufferProperty, value, "0");
+    const bool enabled = atoi(value) != 0;
+    if (enabled == isEnabled()) {
+        return;
+    }
+    setEnabled(enabled);
+    if (!enabled) {
+        drainToFile();
+    }
+}
+
+}; // namespace android
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TraceTagMap"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cutils/atomic.h>
+#include <utils/Compat.h>
+#include <utils/Log.h>
+#include <utils/Mutex.h>
+#include <utils/TraceTagMap.h>
+
+namespace android {
+
+static const uint32_t kMagic = 0x61746167;  // 'atag'
+
+// Serializes attach(), detach(), getTags() and the callback; sync() takes
+// no lock.
+static Mutex gMapLock;
+static void (*gChangeCallback)() = NULL;
+// what getTags() last read, for when a publish() never completes
+static uint64_t gLastTags = 0;
+
+// how many times getTags() yields to a publish() in progress
+static const int kMaxPublishWaits = 100;
+
+const char* const TraceTagMap::PATH = "/data/misc/atrace/tags";
+
+const TraceTagMap::Header* volatile TraceTagMap::sMap = NULL;
+volatile int32_t TraceTagMap::sGeneration = 0;
+
+status_t TraceTagMap::attach(const char* path) {
+    Mutex::Autolock _l(gMapLock);
+    if (sMap != NULL) {
+        return NO_ERROR;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -errno;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < off_t(sizeof(Header))) {
+        close(fd);
+        return BAD_VALUE;
+    }
+    void* addr = mmap(NULL, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return -errno;
+    }
+    const Header* map = static_cast<const Header*>(addr);
+    if (map->magic != kMagic) {
+        munmap(addr, sizeof(Header));
+        return BAD_VALUE;
+    }
+    // whatever was published so far has been read from the properties
+    sGeneration = android_atomic_acquire_load(&map->generation);
+    sMap = map;
+    return NO_ERROR;
+}
+
+void TraceTagMap::detach() {
+    Mutex::Autolock _l(gMapLock);
+    // The page stays mapped: sync() may still be reading it on another
+    // thread, and taking a lock there would cost every trace call.
+    // Processes detach once, if at all, so this leaks a page at most.
+    sMap = NULL;
+}
+
+void TraceTagMap::setChangeCallback(void (*callback)()) {
+    Mutex::Autolock _l(gMapLock);
+    gChangeCallback = callback;
+}
+
+void TraceTagMap::refresh() {
+    Mutex::Autolock _l(gMapLock);
+    const Header* map = sMap;
+    if (map == NULL) {
+        return;
+    }
+    const int32_t generation = android_atomic_acquire_load(&map->generation);
+    if (generation == sGeneration) {
+        // another thread got here first
+        return;
+    }
+    sGeneration = generation;
+    if (gChangeCallback != NULL) {
+        gChangeCallback();
+    }
+}
+
+uint64_t TraceTagMap::getTags() {
+    Mutex::Autolock _l(gMapLock);
+    const Header* map = sMap;
+    if (map == NULL) {
+        return 0;
+    }
+    for (int i=0 ; i<kMaxPublishWaits ; i++) {
+        const int32_t generation = android_atomic_acquire_load(&map->generation);
+        if (generation & 1) {
+            // a publish() is in progress
+            sched_yield();
+            continue;
+        }
+        const uint64_t tags = (uint64_t(map->tagsHigh) << 32) | map->tagsLow;
+        if (android_atomic_acquire_load(&map->generation) == generation) {
+            gLastTags = tags;
+            return tags;
+        }
+    }
+    // the publisher probably died halfway, the next publish() fixes it
+    ALOGW("tags still being published, using the last ones read");
+    return gLastTags;
+}
+
+status_t TraceTagMap::publish(uint64_t tags, const char* path) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return -errno;
+    }
+    // publishers in different processes take turns, the lock goes away
+    // with the fd, even if this process dies while holding it
+    if (TEMP_FAILURE_RETRY(flock(fd, LOCK_EX)) < 0) {
+        status_t err = -errno;
+        close(fd);
+        return err;
+    }
+    // readable by every process, whatever the umask
+    fchmod(fd, 0644);
+    struct stat st;
+    if (fstat(fd, &st) < 0 ||
+            (st.st_size < off_t(sizeof(Header)) &&
+             ftruncate(fd, sizeof(Header)) < 0)) {
+        status_t err = -errno;
+        close(fd);
+        return err;
+    }
+    void* addr = mmap(NULL, sizeof(Header), PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        status_t err = -errno;
+        close(fd);
+        return err;
+    }
+    Header* map = static_cast<Header*>(addr);
+    if (map->magic != kMagic) {
+        map->generation = 0;
+        map->magic = kMagic;
+    }
+    // an odd generation tells readers the tags are being written
+    if (!(map->generation & 1)) {
+        android_atomic_inc(&map->generation);
+    }
+    map->tagsLow = uint32_t(tags);
+    map->tagsHigh = uint32_t(tags >> 32);
+    android_atomic_inc(&map->generation);
+    munmap(addr, sizeof(Header));
+    close(fd);
+    return NO_ERROR;
+}
+
+}; // namespace android
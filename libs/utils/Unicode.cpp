@@ -17,6 +17,8 @@
 #include <utils/Unicode.h>
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 #ifdef HAVE_WINSOCK
 # undef  nhtol
@@ -68,6 +70,79 @@ static const char32_t kFirstByteMark[] = {
     0x00000000, 0x00000000, 0x000000C0, 0x000000E0, 0x000000F0
 };
 
+// --------------------------------------------------------------------------
+// ASCII runs
+// --------------------------------------------------------------------------
+
+// The strings going through these conversions (interface descriptors, service
+// names, paths) are nearly always ASCII, so the conversions skip over runs of
+// ASCII a machine word at a time, and only decode the rest one code point at
+// a time.
+
+// The bits of a word of UTF-8 or UTF-16 that are only set in non-ASCII code
+// units.
+static const size_t kNonAsciiBits8  = ((size_t) -1 / 0xFF) * 0x80;
+static const size_t kNonAsciiBits16 = ((size_t) -1 / 0xFFFF) * 0xFF80;
+
+static inline bool is_word_aligned(const void* p)
+{
+    return ((uintptr_t) p & (sizeof(size_t) - 1)) == 0;
+}
+
+/**
+ * Return the number of ASCII bytes at the start of <src>.
+ */
+static inline size_t utf8_ascii_run_length(const uint8_t* src, size_t src_len)
+{
+    const uint8_t* cur = src;
+    const uint8_t* const end = src + src_len;
+    while (cur < end && !is_word_aligned(cur)) {
+        if (*cur & 0x80) {
+            return cur - src;
+        }
+        cur++;
+    }
+    while ((size_t) (end - cur) >= sizeof(size_t)) {
+        size_t word;
+        memcpy(&word, cur, sizeof(word));
+        if (word & kNonAsciiBits8) {
+            break;
+        }
+        cur += sizeof(word);
+    }
+    while (cur < end && !(*cur & 0x80)) {
+        cur++;
+    }
+    return cur - src;
+}
+
+/**
+ * Return the number of ASCII code units at the start of <src>.
+ */
+static inline size_t utf16_ascii_run_length(const char16_t* src, size_t src_len)
+{
+    const char16_t* cur = src;
+    const char16_t* const end = src + src_len;
+    while (cur < end && !is_word_aligned(cur)) {
+        if (*cur & 0xFF80) {
+            return cur - src;
+        }
+        cur++;
+    }
+    while ((size_t) (end - cur) >= sizeof(size_t) / sizeof(char16_t)) {
+        size_t word;
+        memcpy(&word, cur, sizeof(word));
+        if (word & kNonAsciiBits16) {
+            break;
+        }
+        cur += sizeof(word) / sizeof(char16_t);
+    }
+    while (cur < end && !(*cur & 0xFF80)) {
+        cur++;
+    }
+    return cur - src;
+}
+
 // --------------------------------------------------------------------------
 // UTF-32
 // --------------------------------------------------------------------------
@@ -340,6 +415,16 @@ void utf16_to_utf8(const char16_t* src, size_t src_len, char* dst)
     const char16_t* const end_utf16 = src + src_len;
     char *cur = dst;
     while (cur_utf16 < end_utf16) {
+        if (*cur_utf16 < 0x80) {
+            const size_t ascii = utf16_ascii_run_length(cur_utf16, end_utf16 - cur_utf16);
+            for (size_t i = 0; i < ascii; i++) {
+                cur[i] = (char) cur_utf16[i];
+            }
+            cur += ascii;
+            cur_utf16 += ascii;
+            continue;
+        }
+
         char32_t utf32;
         // surrogate pairs
         if ((*cur_utf16 & 0xFC00) == 0xD800) {
@@ -362,14 +447,18 @@ void utf16_to_utf8(const char16_t* src, size_t src_len, char* dst)
 
 ssize_t utf8_length(const char *src)
 {
+    // strlen() is already word-at-a-time, and gives the ASCII runs a bound.
     const char *cur = src;
+    const char *const end = src + strlen(src);
     size_t ret = 0;
     while (*cur != '\0') {
-        const char first_char = *cur++;
-        if ((first_char & 0x80) == 0) { // ASCII
-            ret += 1;
+        if ((*cur & 0x80) == 0) { // ASCII
+            const size_t ascii = utf8_ascii_run_length((const uint8_t*) cur, end - cur);
+            ret += ascii;
+            cur += ascii;
             continue;
         }
+        const uint8_t first_char = *cur++;
         // (UTF-8's character must not be like 10xxxxxx,
         //  but 110xxxxx, 1110xxxx, ... or 1111110x)
         if ((first_char & 0x40) == 0) {
@@ -412,6 +501,12 @@ ssize_t utf16_to_utf8_length(const char16_t *src, size_t src_len)
     size_t ret = 0;
     const char16_t* const end = src + src_len;
     while (src < end) {
+        if (*src < 0x80) {
+            const size_t ascii = utf16_ascii_run_length(src, end - src);
+            ret += ascii;
+            src += ascii;
+            continue;
+        }
         if ((*src & 0xFC00) == 0xD800 && (src + 1) < end
                 && (*++src & 0xFC00) == 0xDC00) {
             // surrogate pairs are always 4 bytes.
@@ -524,6 +619,12 @@ ssize_t utf8_to_utf16_length(const uint8_t* u8str, size_t u8len)
     /* Validate that the UTF-8 is the correct len */
     size_t u16measuredLen = 0;
     while (u8cur < u8end) {
+        if (*u8cur < 0x80) {
+            const size_t ascii = utf8_ascii_run_length(u8cur, u8end - u8cur);
+            u16measuredLen += ascii;
+            u8cur += ascii;
+            continue;
+        }
         u16measuredLen++;
         int u8charLen = utf8_codepoint_len(*u8cur);
         uint32_t codepoint = utf8_to_utf32_codepoint(u8cur, u8charLen);
@@ -549,6 +650,16 @@ char16_t* utf8_to_utf16_no_null_terminator(const uint8_t* u8str, size_t u8len, c
     char16_t* u16cur = u16str;
 
     while (u8cur < u8end) {
+        if (*u8cur < 0x80) {
+            const size_t ascii = utf8_ascii_run_length(u8cur, u8end - u8cur);
+            for (size_t i = 0; i < ascii; i++) {
+                u16cur[i] = (char16_t) u8cur[i];
+            }
+            u16cur += ascii;
+            u8cur += ascii;
+            continue;
+        }
+
         size_t u8len = utf8_codepoint_len(*u8cur);
         uint32_t codepoint = utf8_to_utf32_codepoint(u8cur, u8len);
 
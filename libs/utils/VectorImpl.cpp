@@ -331,11 +331,21 @@ ssize_t VectorImpl::setCapacity(size_t new_capacity)
         // we can't reduce the capacity
         return current_capacity;
     } 
+    const bool relocate = _can_relocate();
+    if (relocate && (mFlags & HAS_TRIVIAL_MOVE)) {
+        const SharedBuffer* cur_sb = SharedBuffer::bufferFromData(mStorage);
+        SharedBuffer* sb = cur_sb->editResize(new_capacity * mItemSize);
+        if (sb == 0) {
+            return NO_MEMORY;
+        }
+        mStorage = sb->data();
+        return new_capacity;
+    }
     SharedBuffer* sb = SharedBuffer::alloc(new_capacity * mItemSize);
     if (sb) {
         void* array = sb->data();
-        _do_copy(array, mStorage, size());
-        release_storage();
+        _do_transfer(array, mStorage, size(), relocate);
+        _release_storage(relocate);
         mStorage = const_cast<void*>(array);
     } else {
         return NO_MEMORY;
@@ -364,6 +374,34 @@ void VectorImpl::release_storage()
     }
 }
 
+bool VectorImpl::_can_relocate() const
+{
+    // items can only be moved out of a buffer no other vector sees
+    return mStorage && SharedBuffer::bufferFromData(mStorage)->onlyOwner();
+}
+
+void VectorImpl::_do_transfer(void* dest, const void* from, size_t num,
+        bool relocate) const
+{
+    if (relocate) {
+        // move_forward_type() works between distinct buffers too, and it
+        // is a memmove for sp<>, wp<> and the types with a trivial move
+        _do_move_forward(dest, from, num);
+    } else {
+        _do_copy(dest, from, num);
+    }
+}
+
+void VectorImpl::_release_storage(bool relocated)
+{
+    if (relocated) {
+        // the items have been moved out already, only free the buffer
+        SharedBuffer::bufferFromData(mStorage)->release();
+    } else {
+        release_storage();
+    }
+}
+
 void* VectorImpl::_grow(size_t where, size_t amount)
 {
 //    ALOGV("_grow(this=%p, where=%d, amount=%d) count=%d, capacity=%d",
@@ -377,6 +415,7 @@ void* VectorImpl::_grow(size_t where, size_t amount)
     if (capacity() < new_size) {
         const size_t new_capacity = max(kMinVectorCapacity, ((new_size*3)+1)/2);
 //        ALOGV("grow vector %p, new_capacity=%d", this, (int)new_capacity);
+        const bool relocate = _can_relocate();
         if ((mStorage) &&
             (mCount==where) &&
             (mFlags & HAS_TRIVIAL_COPY) &&
@@ -385,19 +424,32 @@ void* VectorImpl::_grow(size_t where, size_t amount)
             const SharedBuffer* cur_sb = SharedBuffer::bufferFromData(mStorage);
             SharedBuffer* sb = cur_sb->editResize(new_capacity * mItemSize);
             mStorage = sb->data();
+        } else if (relocate && (mFlags & HAS_TRIVIAL_MOVE)) {
+            // realloc() the buffer, then open the gap
+            const SharedBuffer* cur_sb = SharedBuffer::bufferFromData(mStorage);
+            SharedBuffer* sb = cur_sb->editResize(new_capacity * mItemSize);
+            if (sb == 0) {
+                return 0;
+            }
+            mStorage = sb->data();
+            if (where != mCount) {
+                uint8_t* array = reinterpret_cast<uint8_t *>(mStorage);
+                memmove(array + (where+amount)*mItemSize, array + where*mItemSize,
+                        (mCount-where)*mItemSize);
+            }
         } else {
             SharedBuffer* sb = SharedBuffer::alloc(new_capacity * mItemSize);
             if (sb) {
                 void* array = sb->data();
                 if (where != 0) {
-                    _do_copy(array, mStorage, where);
+                    _do_transfer(array, mStorage, where, relocate);
                 }
                 if (where != mCount) {
                     const void* from = reinterpret_cast<const uint8_t *>(mStorage) + where*mItemSize;
                     void* dest = reinterpret_cast<uint8_t *>(array) + (where+amount)*mItemSize;
-                    _do_copy(dest, from, mCount-where);
+                    _do_transfer(dest, from, mCount-where, relocate);
                 }
-                release_storage();
+                _release_storage(relocate);
                 mStorage = const_cast<void*>(array);
             }
         }
@@ -430,6 +482,7 @@ void VectorImpl::_shrink(size_t where, size_t amount)
     if (new_size*3 < capacity()) {
         const size_t new_capacity = max(kMinVectorCapacity, new_size*2);
 //        ALOGV("shrink vector %p, new_capacity=%d", this, (int)new_capacity);
+        const bool relocate = _can_relocate();
         if ((where == new_size) &&
             (mFlags & HAS_TRIVIAL_COPY) &&
             (mFlags & HAS_TRIVIAL_DTOR))
@@ -437,19 +490,36 @@ void VectorImpl::_shrink(size_t where, size_t amount)
             const SharedBuffer* cur_sb = SharedBuffer::bufferFromData(mStorage);
             SharedBuffer* sb = cur_sb->editResize(new_capacity * mItemSize);
             mStorage = sb->data();
+        } else if (relocate && (mFlags & HAS_TRIVIAL_MOVE)) {
+            // close the gap, then realloc() the buffer
+            uint8_t* array = reinterpret_cast<uint8_t *>(mStorage);
+            _do_destroy(array + where*mItemSize, amount);
+            if (where != new_size) {
+                memmove(array + where*mItemSize, array + (where+amount)*mItemSize,
+                        (new_size-where)*mItemSize);
+            }
+            const SharedBuffer* cur_sb = SharedBuffer::bufferFromData(mStorage);
+            SharedBuffer* sb = cur_sb->editResize(new_capacity * mItemSize);
+            if (sb) {
+                mStorage = sb->data();
+            }
         } else {
             SharedBuffer* sb = SharedBuffer::alloc(new_capacity * mItemSize);
             if (sb) {
                 void* array = sb->data();
                 if (where != 0) {
-                    _do_copy(array, mStorage, where);
+                    _do_transfer(array, mStorage, where, relocate);
                 }
                 if (where != new_size) {
                     const void* from = reinterpret_cast<const uint8_t *>(mStorage) + (where+amount)*mItemSize;
                     void* dest = reinterpret_cast<uint8_t *>(array) + where*mItemSize;
-                    _do_copy(dest, from, new_size - where);
+                    _do_transfer(dest, from, new_size - where, relocate);
                 }
-                release_storage();
+                if (relocate) {
+                    // the removed items stay behind
+                    _do_destroy(reinterpret_cast<uint8_t *>(mStorage) + where*mItemSize, amount);
+                }
+                _release_storage(relocate);
                 mStorage = const_cast<void*>(array);
             }
         }
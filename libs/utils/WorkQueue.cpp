@@ -20,47 +20,106 @@
 #include <utils/Log.h>
 #include <utils/WorkQueue.h>
 
+#include <cutils/atomic.h>
+
 namespace android {
 
 // --- WorkQueue ---
 
 WorkQueue::WorkQueue(size_t maxThreads, bool canCallJava) :
         mMaxThreads(maxThreads), mCanCallJava(canCallJava),
-        mCanceled(false), mFinished(false), mIdleThreads(0) {
+        mCanceled(false), mFinished(false), mNextDeque(0),
+        mNumWorkDeques(maxThreads ? maxThreads : 1),
+        mWorkDeques(new WorkDeque[mNumWorkDeques]), mIdleThreads(0),
+        mPendingWorkUnits(0), mWaitingProducers(0) {
 }
 
 WorkQueue::~WorkQueue() {
     if (!cancel()) {
         finish();
     }
+    delete[] mWorkDeques;
+}
+
+status_t WorkQueue::schedule(WorkUnit* workUnit, size_t backlog, WorkPriority priority) {
+    return schedule(workUnit, backlog, priority, true);
 }
 
-status_t WorkQueue::schedule(WorkUnit* workUnit, size_t backlog) {
+status_t WorkQueue::trySchedule(WorkUnit* workUnit, size_t backlog, WorkPriority priority) {
+    return schedule(workUnit, backlog, priority, false);
+}
+
+status_t WorkQueue::schedule(WorkUnit* workUnit, size_t backlog, WorkPriority priority,
+        bool canBlock) {
     AutoMutex _l(mLock);
 
     if (mFinished || mCanceled) {
         return INVALID_OPERATION;
     }
 
+    size_t idle = android_atomic_acquire_load(&mIdleThreads);
+    size_t pending = android_atomic_acquire_load(&mPendingWorkUnits);
     if (mWorkThreads.size() < mMaxThreads
-            && mIdleThreads < mWorkUnits.size() + 1) {
-        sp<WorkThread> workThread = new WorkThread(this, mCanCallJava);
+            && idle < pending + 1) {
+        sp<WorkThread> workThread = new WorkThread(this, mWorkThreads.size(),
+                mCanCallJava);
         status_t status = workThread->run("WorkQueue::WorkThread");
         if (status) {
             return status;
         }
         mWorkThreads.add(workThread);
-        mIdleThreads += 1;
+        android_atomic_inc(&mIdleThreads);
     } else if (backlog) {
-        while (mWorkUnits.size() >= mMaxThreads * backlog) {
-            mWorkDequeuedCondition.wait(mLock);
+        while (size_t(android_atomic_acquire_load(&mPendingWorkUnits))
+                >= mMaxThreads * backlog) {
+            if (!canBlock) {
+                return WOULD_BLOCK;
+            }
+            // The work threads take work units without mLock, so they check
+            // for waiting producers before signaling.
+            android_atomic_inc(&mWaitingProducers);
+            if (size_t(android_atomic_acquire_load(&mPendingWorkUnits))
+                    >= mMaxThreads * backlog) {
+                mWorkDequeuedCondition.wait(mLock);
+            }
+            android_atomic_dec(&mWaitingProducers);
             if (mFinished || mCanceled) {
                 return INVALID_OPERATION;
             }
         }
     }
 
-    mWorkUnits.add(workUnit);
+    // Count the work unit before it can be taken, so that the count never
+    // goes negative.
+    android_atomic_inc(&mPendingWorkUnits);
+
+    // A work unit scheduling more work runs it next on the same thread, while
+    // what it touched is still in the cache.  Other work is spread out.
+    thread_id_t self = getThreadId();
+    size_t index = 0;
+    bool front = false;
+    for (size_t i = 0; i < mWorkThreads.size(); i++) {
+        if (mWorkDeques[i].threadId == self) {
+            index = i;
+            front = true;
+            break;
+        }
+    }
+    if (!front && !mWorkThreads.isEmpty()) {
+        index = mNextDeque++ % mWorkThreads.size();
+    }
+
+    WorkDeque& deque = mWorkDeques[index];
+    { // acquire deque lock
+        AutoMutex _dl(deque.lock);
+        if (front) {
+            deque.workUnits[priority].insertAt(workUnit, 0);
+        } else {
+            deque.workUnits[priority].add(workUnit);
+        }
+        android_atomic_inc(&deque.size);
+    } // release deque lock
+
     mWorkChangedCondition.broadcast();
     return OK;
 }
@@ -77,13 +136,22 @@ status_t WorkQueue::cancelLocked() {
     }
 
     if (!mCanceled) {
-        mCanceled = true;
-
-        size_t count = mWorkUnits.size();
-        for (size_t i = 0; i < count; i++) {
-            delete mWorkUnits.itemAt(i);
+        android_atomic_release_store(true, &mCanceled);
+
+        for (size_t i = 0; i < mNumWorkDeques; i++) {
+            WorkDeque& deque = mWorkDeques[i];
+            AutoMutex _dl(deque.lock);
+            for (size_t p = 0; p < NUM_WORK_PRIORITIES; p++) {
+                Vector<WorkUnit*>& workUnits = deque.workUnits[p];
+                size_t count = workUnits.size();
+                for (size_t j = 0; j < count; j++) {
+                    delete workUnits.itemAt(j);
+                }
+                android_atomic_add(-int32_t(count), &mPendingWorkUnits);
+                workUnits.clear();
+            }
+            android_atomic_release_store(0, &deque.size);
         }
-        mWorkUnits.clear();
         mWorkChangedCondition.broadcast();
         mWorkDequeuedCondition.broadcast();
     }
@@ -112,60 +180,147 @@ status_t WorkQueue::finish() {
     return OK;
 }
 
-bool WorkQueue::threadLoop() {
-    WorkUnit* workUnit;
-    { // acquire lock
-        AutoMutex _l(mLock);
+void WorkQueue::getThreadStats(Vector<ThreadStats>* outStats) const {
+    AutoMutex _l(mLock);
+
+    // The work threads are gone once the queue is finished, but their stats
+    // stay with their queues.
+    outStats->clear();
+    nsecs_t now = systemTime();
+    for (size_t i = 0; i < mMaxThreads && mWorkDeques[i].startTime; i++) {
+        WorkDeque& deque = mWorkDeques[i];
+        AutoMutex _dl(deque.lock);
+        ThreadStats stats = deque.stats;
+        stats.lifetime = (deque.endTime ? deque.endTime : now) - deque.startTime;
+        outStats->add(stats);
+    }
+}
+
+void WorkQueue::threadStarted(size_t index) {
+    AutoMutex _l(mLock);
+
+    mWorkDeques[index].threadId = getThreadId();
+    mWorkDeques[index].startTime = systemTime();
+}
+
+void WorkQueue::threadExiting(size_t index) {
+    AutoMutex _l(mLock);
 
-        for (;;) {
-            if (mCanceled) {
-                return false;
+    mWorkDeques[index].endTime = systemTime();
+}
+
+WorkQueue::WorkUnit* WorkQueue::takeWorkUnit(size_t index, bool* outStolen) {
+    // Go through all the queues for each priority in turn, so that no
+    // thread runs a less urgent work unit while a more urgent one waits.
+    for (size_t p = 0; p < NUM_WORK_PRIORITIES; p++) {
+        for (size_t i = 0; i < mNumWorkDeques; i++) {
+            WorkDeque& deque = mWorkDeques[(index + i) % mNumWorkDeques];
+            if (!android_atomic_acquire_load(&deque.size)) {
+                continue;
             }
 
-            if (!mWorkUnits.isEmpty()) {
-                workUnit = mWorkUnits.itemAt(0);
-                mWorkUnits.removeAt(0);
-                mIdleThreads -= 1;
-                mWorkDequeuedCondition.broadcast();
-                break;
+            AutoMutex _dl(deque.lock);
+            Vector<WorkUnit*>& workUnits = deque.workUnits[p];
+            if (workUnits.isEmpty()) {
+                continue;
             }
 
-            if (mFinished) {
-                return false;
+            WorkUnit* workUnit;
+            if (i == 0) {
+                workUnit = workUnits.itemAt(0);
+                workUnits.removeAt(0);
+            } else {
+                size_t last = workUnits.size() - 1;
+                workUnit = workUnits.itemAt(last);
+                workUnits.removeAt(last);
             }
+            android_atomic_dec(&deque.size);
+            *outStolen = i != 0;
+            return workUnit;
+        }
+    }
+    return NULL;
+}
+
+bool WorkQueue::threadLoop(size_t index) {
+    WorkUnit* workUnit;
+    bool stolen;
+    for (;;) {
+        if (android_atomic_acquire_load(&mCanceled)) {
+            return false;
+        }
 
-            mWorkChangedCondition.wait(mLock);
+        workUnit = takeWorkUnit(index, &stolen);
+        if (workUnit) {
+            break;
         }
-    } // release lock
 
-    bool shouldContinue = workUnit->run();
-    delete workUnit;
+        { // acquire lock
+            AutoMutex _l(mLock);
 
-    { // acquire lock
+            // A work unit is counted before it is queued, so if there is one
+            // pending we just try again.
+            if (!mCanceled && !android_atomic_acquire_load(&mPendingWorkUnits)) {
+                if (mFinished) {
+                    return false;
+                }
+                mWorkChangedCondition.wait(mLock);
+            }
+        } // release lock
+    }
+
+    android_atomic_dec(&mPendingWorkUnits);
+    if (android_atomic_acquire_load(&mWaitingProducers)) {
         AutoMutex _l(mLock);
+        mWorkDequeuedCondition.broadcast();
+    }
 
-        mIdleThreads += 1;
+    android_atomic_dec(&mIdleThreads);
 
-        if (!shouldContinue) {
-            cancelLocked();
-            return false;
+    nsecs_t startTime = systemTime();
+    bool shouldContinue = workUnit->run();
+    delete workUnit;
+    nsecs_t busyTime = systemTime() - startTime;
+
+    WorkDeque& deque = mWorkDeques[index];
+    { // acquire deque lock
+        AutoMutex _dl(deque.lock);
+        deque.stats.workUnitsRun += 1;
+        if (stolen) {
+            deque.stats.workUnitsStolen += 1;
         }
-    } // release lock
+        deque.stats.busyTime += busyTime;
+    } // release deque lock
+
+    android_atomic_inc(&mIdleThreads);
 
+    if (!shouldContinue) {
+        cancel();
+        return false;
+    }
     return true;
 }
 
 // --- WorkQueue::WorkThread ---
 
-WorkQueue::WorkThread::WorkThread(WorkQueue* workQueue, bool canCallJava) :
-        Thread(canCallJava), mWorkQueue(workQueue) {
+WorkQueue::WorkThread::WorkThread(WorkQueue* workQueue, size_t index, bool canCallJava) :
+        Thread(canCallJava), mWorkQueue(workQueue), mIndex(index) {
 }
 
 WorkQueue::WorkThread::~WorkThread() {
 }
 
+status_t WorkQueue::WorkThread::readyToRun() {
+    mWorkQueue->threadStarted(mIndex);
+    return OK;
+}
+
 bool WorkQueue::WorkThread::threadLoop() {
-    return mWorkQueue->threadLoop();
+    if (mWorkQueue->threadLoop(mIndex)) {
+        return true;
+    }
+    mWorkQueue->threadExiting(mIndex);
+    return false;
 }
 
 };  // namespace android
@@ -21,11 +21,13 @@
 //#define LOG_NDEBUG 0
 #include <utils/Log.h>
 #include <utils/Compat.h>
+#include <utils/FastHash.h>
 #include <utils/ZipFileRO.h>
 #include <utils/misc.h>
 #include <utils/threads.h>
+#include <utils/Vector.h>
 
-#include <zlib.h>
+#include <cutils/atomic.h>
 
 #include <string.h>
 #include <fcntl.h>
@@ -72,6 +74,12 @@ using namespace android;
 #define kCDECommentLen      32              // offset to comment length
 #define kCDELocalOffset     42              // offset to local hdr
 
+/*
+ * Entries with more compressed data than this are read ahead of time
+ * with FileMap::prefetch() before being uncompressed.
+ */
+#define kPrefetchMin        32768
+
 /*
  * The values we return for ZipEntryRO use 0 as an invalid value, so we
  * want to adjust the hash table index by a fixed amount.  Using a large
@@ -216,35 +224,44 @@ bool ZipFileRO::mapCentralDirectory(void)
      * it to find the magic number, parse some values out, and use those
      * to determine the extent of the CD.
      *
-     * We start by pulling in the last part of the file.
+     * Archives almost never have a trailing comment, so we start by
+     * pulling in just the EOCD-sized tail of the file, and only read and
+     * scan the last part of the file if the magic isn't there.
      */
-    off64_t searchStart = mFileLength - readAmount;
+    off64_t searchStart = mFileLength - kEOCDLen;
+    ssize_t searchLen = kEOCDLen;
+    int i;
 
-    if (lseek64(mFd, searchStart, SEEK_SET) != searchStart) {
-        ALOGW("seek %ld failed: %s\n",  (long) searchStart, strerror(errno));
-        free(scanBuf);
-        return false;
-    }
-    actual = TEMP_FAILURE_RETRY(read(mFd, scanBuf, readAmount));
-    if (actual != (ssize_t) readAmount) {
-        ALOGW("Zip: read " ZD ", expected " ZD ". Failed: %s\n",
-            (ZD_TYPE) actual, (ZD_TYPE) readAmount, strerror(errno));
-        free(scanBuf);
-        return false;
-    }
+    while (true) {
+        if (lseek64(mFd, searchStart, SEEK_SET) != searchStart) {
+            ALOGW("seek %ld failed: %s\n",  (long) searchStart, strerror(errno));
+            free(scanBuf);
+            return false;
+        }
+        actual = TEMP_FAILURE_RETRY(read(mFd, scanBuf, searchLen));
+        if (actual != searchLen) {
+            ALOGW("Zip: read " ZD ", expected " ZD ". Failed: %s\n",
+                (ZD_TYPE) actual, (ZD_TYPE) searchLen, strerror(errno));
+            free(scanBuf);
+            return false;
+        }
 
-    /*
-     * Scan backward for the EOCD magic.  In an archive without a trailing
-     * comment, we'll find it on the first try.  (We may want to consider
-     * doing an initial minimal read; if we don't find it, retry with a
-     * second read as above.)
-     */
-    int i;
-    for (i = readAmount - kEOCDLen; i >= 0; i--) {
-        if (scanBuf[i] == 0x50 && get4LE(&scanBuf[i]) == kEOCDSignature) {
-            ALOGV("+++ Found EOCD at buf+%d\n", i);
+        /*
+         * Scan backward for the EOCD magic.  In an archive without a
+         * trailing comment, we'll find it on the first try.
+         */
+        for (i = searchLen - kEOCDLen; i >= 0; i--) {
+            if (scanBuf[i] == 0x50 && get4LE(&scanBuf[i]) == kEOCDSignature) {
+                ALOGV("+++ Found EOCD at buf+%d\n", i);
+                break;
+            }
+        }
+        if (i >= 0 || searchLen == readAmount) {
             break;
         }
+
+        searchStart = mFileLength - readAmount;
+        searchLen = readAmount;
     }
     if (i < 0) {
         ALOGD("Zip: EOCD not found, %s is not zip\n", mFileName);
@@ -292,6 +309,9 @@ bool ZipFileRO::mapCentralDirectory(void)
         return false;
     }
 
+    /* the whole directory is read as soon as it has been mapped */
+    mDirectoryMap->prefetch(0, dirSize);
+
     mNumEntries = numEntries;
     mDirectoryOffset = dirOffset;
 
@@ -377,16 +397,11 @@ bail:
 }
 
 /*
- * Simple string hash function for non-null-terminated strings.
+ * String hash function for non-null-terminated strings.
  */
 /*static*/ unsigned int ZipFileRO::computeHash(const char* str, int len)
 {
-    unsigned int hash = 0;
-
-    while (len--)
-        hash = hash * 31 + *str++;
-
-    return hash;
+    return FastHash(str, len);
 }
 
 /*
@@ -404,6 +419,7 @@ void ZipFileRO::addToHash(const char* str, int strLen, unsigned int hash)
 
     mHashTable[ent].name = str;
     mHashTable[ent].nameLen = strLen;
+    mHashTable[ent].hash = hash;
 }
 
 /*
@@ -425,8 +441,13 @@ ZipEntryRO ZipFileRO::findEntryByName(const char* fileName) const
     unsigned int hash = computeHash(fileName, nameLen);
     int ent = hash & (mHashTableSize-1);
 
+    /*
+     * Compare the stored hash first, so that probing past other entries
+     * doesn't touch their names in the mapped central directory.
+     */
     while (mHashTable[ent].name != NULL) {
-        if (mHashTable[ent].nameLen == nameLen &&
+        if (mHashTable[ent].hash == hash &&
+            mHashTable[ent].nameLen == nameLen &&
             memcmp(mHashTable[ent].name, fileName, nameLen) == 0)
         {
             /* match */
@@ -636,6 +657,21 @@ int ZipFileRO::getEntryFileName(ZipEntryRO entry, char* buffer, int bufLen)
  * Create a new FileMap object that spans the data in "entry".
  */
 FileMap* ZipFileRO::createEntryFileMap(ZipEntryRO entry) const
+{
+    size_t compLen;
+    off64_t offset;
+
+    if (!getEntryInfo(entry, NULL, NULL, &compLen, &offset, NULL, NULL))
+        return NULL;
+
+    return createFileMap(offset, compLen);
+}
+
+/*
+ * Create a new FileMap object that spans "length" bytes of the archive
+ * from "offset".
+ */
+FileMap* ZipFileRO::createFileMap(off64_t offset, size_t length) const
 {
     /*
      * TODO: the efficient way to do this is to modify FileMap to allow
@@ -644,15 +680,8 @@ FileMap* ZipFileRO::createEntryFileMap(ZipEntryRO entry) const
      * new mapping off of the Zip archive file descriptor.
      */
 
-    FileMap* newMap;
-    size_t compLen;
-    off64_t offset;
-
-    if (!getEntryInfo(entry, NULL, NULL, &compLen, &offset, NULL, NULL))
-        return NULL;
-
-    newMap = new FileMap();
-    if (!newMap->create(mFileName, mFd, offset, compLen, true)) {
+    FileMap* newMap = new FileMap();
+    if (!newMap->create(mFileName, mFd, offset, length, true)) {
         newMap->release();
         return NULL;
     }
@@ -668,20 +697,26 @@ FileMap* ZipFileRO::createEntryFileMap(ZipEntryRO entry) const
  */
 bool ZipFileRO::uncompressEntry(ZipEntryRO entry, void* buffer) const
 {
-    const size_t kSequentialMin = 32768;
     bool result = false;
     int ent = entryToIndex(entry);
     if (ent < 0)
-        return -1;
+        return false;
 
     int method;
     size_t uncompLen, compLen;
     off64_t offset;
     const unsigned char* ptr;
+    FileMap* file;
 
-    getEntryInfo(entry, &method, &uncompLen, &compLen, &offset, NULL, NULL);
+    /*
+     * Map the data with the offset we just looked up, rather than through
+     * createEntryFileMap(), so the local file header is only read once.
+     */
+    if (!getEntryInfo(entry, &method, &uncompLen, &compLen, &offset, NULL, NULL)) {
+        goto bail;
+    }
 
-    FileMap* file = createEntryFileMap(entry);
+    file = createFileMap(offset, compLen);
     if (file == NULL) {
         goto bail;
     }
@@ -689,20 +724,14 @@ bool ZipFileRO::uncompressEntry(ZipEntryRO entry, void* buffer) const
     ptr = (const unsigned char*) file->getDataPtr();
 
     /*
-     * Experiment with madvise hint.  When we want to uncompress a file,
-     * we pull some stuff out of the central dir entry and then hit a
-     * bunch of compressed or uncompressed data sequentially.  The CDE
-     * visit will cause a limited amount of read-ahead because it's at
-     * the end of the file.  We could end up doing lots of extra disk
-     * access if the file we're prying open is small.  Bottom line is we
-     * probably don't want to turn MADV_SEQUENTIAL on and leave it on.
-     *
-     * So, if the compressed size of the file is above a certain minimum
-     * size, temporarily boost the read-ahead in the hope that the extra
-     * pair of system calls are negated by a reduction in page faults.
+     * We're about to read all of the entry's data, front to back.  The
+     * CDE visit will only have caused a limited amount of read-ahead,
+     * because it's at the end of the file, so a large entry would
+     * otherwise be faulted in a few pages at a time.  Ask for the whole
+     * range up front instead; small entries aren't worth the system call.
      */
-    if (compLen > kSequentialMin)
-        file->advise(FileMap::SEQUENTIAL);
+    if (compLen > kPrefetchMin)
+        file->prefetch(0, compLen);
 
     if (method == kCompressStored) {
         memcpy(buffer, ptr, uncompLen);
@@ -711,9 +740,6 @@ bool ZipFileRO::uncompressEntry(ZipEntryRO entry, void* buffer) const
             goto unmap;
     }
 
-    if (compLen > kSequentialMin)
-        file->advise(FileMap::NORMAL);
-
     result = true;
 
 unmap:
@@ -722,46 +748,70 @@ bail:
     return result;
 }
 
+/* an InflateCallback writing to the fd "cookie" points to */
+static bool writeChunk(const void* data, size_t size, void* cookie)
+{
+    const int fd = *static_cast<const int*>(cookie);
+    ssize_t actual = TEMP_FAILURE_RETRY(write(fd, data, size));
+    if (actual < 0) {
+        ALOGW("write failed in inflate: %s", strerror(errno));
+        return false;
+    } else if ((size_t) actual != size) {
+        ALOGW("Partial write during uncompress (" ZD " of " ZD ")\n",
+            (ZD_TYPE) actual, (ZD_TYPE) size);
+        return false;
+    }
+    return true;
+}
+
 /*
  * Uncompress an entry, in its entirety, to an open file descriptor.
  *
  * This doesn't verify the data's CRC, but probably should.
  */
 bool ZipFileRO::uncompressEntry(ZipEntryRO entry, int fd) const
+{
+    return uncompressEntry(entry, writeChunk, &fd);
+}
+
+/*
+ * Uncompress an entry a chunk at a time, handing each to "callback".  A
+ * stored entry is handed over straight from the map.
+ */
+bool ZipFileRO::uncompressEntry(ZipEntryRO entry,
+    ZipUtils::InflateCallback callback, void* cookie) const
 {
     bool result = false;
     int ent = entryToIndex(entry);
     if (ent < 0)
-        return -1;
+        return false;
 
     int method;
     size_t uncompLen, compLen;
     off64_t offset;
     const unsigned char* ptr;
+    FileMap* file;
 
-    getEntryInfo(entry, &method, &uncompLen, &compLen, &offset, NULL, NULL);
+    if (!getEntryInfo(entry, &method, &uncompLen, &compLen, &offset, NULL, NULL)) {
+        goto bail;
+    }
 
-    FileMap* file = createEntryFileMap(entry);
+    file = createFileMap(offset, compLen);
     if (file == NULL) {
         goto bail;
     }
 
     ptr = (const unsigned char*) file->getDataPtr();
 
+    if (compLen > kPrefetchMin)
+        file->prefetch(0, compLen);
+
     if (method == kCompressStored) {
-        ssize_t actual = TEMP_FAILURE_RETRY(write(fd, ptr, uncompLen));
-        if (actual < 0) {
-            ALOGE("Write failed: %s\n", strerror(errno));
-            goto unmap;
-        } else if ((size_t) actual != uncompLen) {
-            ALOGE("Partial write during uncompress (" ZD " of " ZD ")\n",
-                (ZD_TYPE) actual, (ZD_TYPE) uncompLen);
+        if (!callback(ptr, uncompLen, cookie))
             goto unmap;
-        } else {
-            ALOGI("+++ successful write\n");
-        }
     } else {
-        if (!inflateBuffer(fd, ptr, uncompLen, compLen))
+        if (!ZipUtils::inflateToCallback(ptr, compLen, uncompLen,
+                callback, cookie))
             goto unmap;
     }
 
@@ -774,158 +824,126 @@ bail:
 }
 
 /*
- * Uncompress "deflate" data from one buffer to another.
+ * The entries passed to uncompressEntries(), shared by the threads
+ * uncompressing them.  Each thread takes the next entry nobody has started
+ * yet until there are none left, so a few large entries don't hold up one
+ * thread while the others wait.
  */
-/*static*/ bool ZipFileRO::inflateBuffer(void* outBuf, const void* inBuf,
-    size_t uncompLen, size_t compLen)
-{
-    bool result = false;
-    z_stream zstream;
-    int zerr;
-
-    /*
-     * Initialize the zlib stream struct.
-     */
-    memset(&zstream, 0, sizeof(zstream));
-    zstream.zalloc = Z_NULL;
-    zstream.zfree = Z_NULL;
-    zstream.opaque = Z_NULL;
-    zstream.next_in = (Bytef*)inBuf;
-    zstream.avail_in = compLen;
-    zstream.next_out = (Bytef*) outBuf;
-    zstream.avail_out = uncompLen;
-    zstream.data_type = Z_UNKNOWN;
-
-    /*
-     * Use the undocumented "negative window bits" feature to tell zlib
-     * that there's no zlib header waiting for it.
-     */
-    zerr = inflateInit2(&zstream, -MAX_WBITS);
-    if (zerr != Z_OK) {
-        if (zerr == Z_VERSION_ERROR) {
-            ALOGE("Installed zlib is not compatible with linked version (%s)\n",
-                ZLIB_VERSION);
-        } else {
-            ALOGE("Call to inflateInit2 failed (zerr=%d)\n", zerr);
+namespace {
+
+struct UncompressJob {
+    const ZipFileRO* zip;
+    const ZipEntryRO* entries;
+    void* const* buffers;
+    const int* fds;
+    size_t count;
+    volatile int32_t next;
+    volatile int32_t failed;
+
+    void uncompressAll() {
+        while (true) {
+            size_t i = android_atomic_inc(&next);
+            if (i >= count) {
+                break;
+            }
+            bool ok = buffers != NULL ?
+                    zip->uncompressEntry(entries[i], buffers[i]) :
+                    zip->uncompressEntry(entries[i], fds[i]);
+            if (!ok) {
+                ALOGW("Failed uncompressing entry %d of %d\n", (int) i,
+                    (int) count);
+                android_atomic_release_store(1, &failed);
+            }
         }
-        goto bail;
     }
+};
 
-    /*
-     * Expand data.
-     */
-    zerr = inflate(&zstream, Z_FINISH);
-    if (zerr != Z_STREAM_END) {
-        ALOGW("Zip inflate failed, zerr=%d (nIn=%p aIn=%u nOut=%p aOut=%u)\n",
-            zerr, zstream.next_in, zstream.avail_in,
-            zstream.next_out, zstream.avail_out);
-        goto z_bail;
-    }
+class UncompressThread : public Thread {
+public:
+    UncompressThread(UncompressJob* job) : Thread(false), mJob(job) {}
 
-    /* paranoia */
-    if (zstream.total_out != uncompLen) {
-        ALOGW("Size mismatch on inflated file (%ld vs " ZD ")\n",
-            zstream.total_out, (ZD_TYPE) uncompLen);
-        goto z_bail;
+private:
+    virtual bool threadLoop() {
+        mJob->uncompressAll();
+        return false;
     }
 
-    result = true;
+    UncompressJob* mJob;
+};
 
-z_bail:
-    inflateEnd(&zstream);        /* free up any allocated structures */
+}; // namespace
 
-bail:
-    return result;
+bool ZipFileRO::uncompressEntries(const ZipEntryRO* entries,
+    void* const* buffers, size_t count, int numThreads) const
+{
+    return uncompressEntries(entries, buffers, NULL, count, numThreads);
+}
+
+bool ZipFileRO::uncompressEntries(const ZipEntryRO* entries,
+    const int* fds, size_t count, int numThreads) const
+{
+    return uncompressEntries(entries, NULL, fds, count, numThreads);
 }
 
 /*
- * Uncompress "deflate" data from one buffer to an open file descriptor.
+ * Uncompress entries into buffers or fds on up to "numThreads" threads,
+ * counting the calling thread, which does its share of the work rather
+ * than just waiting.
+ *
+ * Each entry is mapped on its own and the local file headers are read
+ * with pread64() (or under mFdLock), so the threads don't need to
+ * coordinate beyond picking entries.
  */
-/*static*/ bool ZipFileRO::inflateBuffer(int fd, const void* inBuf,
-    size_t uncompLen, size_t compLen)
+bool ZipFileRO::uncompressEntries(const ZipEntryRO* entries,
+    void* const* buffers, const int* fds, size_t count, int numThreads) const
 {
-    bool result = false;
-    const size_t kWriteBufSize = 32768;
-    unsigned char writeBuf[kWriteBufSize];
-    z_stream zstream;
-    int zerr;
-
-    /*
-     * Initialize the zlib stream struct.
-     */
-    memset(&zstream, 0, sizeof(zstream));
-    zstream.zalloc = Z_NULL;
-    zstream.zfree = Z_NULL;
-    zstream.opaque = Z_NULL;
-    zstream.next_in = (Bytef*)inBuf;
-    zstream.avail_in = compLen;
-    zstream.next_out = (Bytef*) writeBuf;
-    zstream.avail_out = sizeof(writeBuf);
-    zstream.data_type = Z_UNKNOWN;
-
-    /*
-     * Use the undocumented "negative window bits" feature to tell zlib
-     * that there's no zlib header waiting for it.
-     */
-    zerr = inflateInit2(&zstream, -MAX_WBITS);
-    if (zerr != Z_OK) {
-        if (zerr == Z_VERSION_ERROR) {
-            ALOGE("Installed zlib is not compatible with linked version (%s)\n",
-                ZLIB_VERSION);
-        } else {
-            ALOGE("Call to inflateInit2 failed (zerr=%d)\n", zerr);
+    UncompressJob job;
+    job.zip = this;
+    job.entries = entries;
+    job.buffers = buffers;
+    job.fds = fds;
+    job.count = count;
+    job.next = 0;
+    job.failed = 0;
+
+    if (numThreads > (int) count)
+        numThreads = count;
+
+    Vector<sp<Thread> > threads;
+    for (int i = 1; i < numThreads; i++) {
+        sp<Thread> thread = new UncompressThread(&job);
+        if (thread->run("ZipFileRO", PRIORITY_NORMAL) != NO_ERROR) {
+            /* the threads we have will still get through all the entries */
+            ALOGW("Unable to start uncompress thread %d\n", i);
+            break;
         }
-        goto bail;
+        threads.add(thread);
     }
 
-    /*
-     * Loop while we have more to do.
-     */
-    do {
-        /*
-         * Expand data.
-         */
-        zerr = inflate(&zstream, Z_NO_FLUSH);
-        if (zerr != Z_OK && zerr != Z_STREAM_END) {
-            ALOGW("zlib inflate: zerr=%d (nIn=%p aIn=%u nOut=%p aOut=%u)\n",
-                zerr, zstream.next_in, zstream.avail_in,
-                zstream.next_out, zstream.avail_out);
-            goto z_bail;
-        }
-
-        /* write when we're full or when we're done */
-        if (zstream.avail_out == 0 ||
-            (zerr == Z_STREAM_END && zstream.avail_out != sizeof(writeBuf)))
-        {
-            long writeSize = zstream.next_out - writeBuf;
-            int cc = TEMP_FAILURE_RETRY(write(fd, writeBuf, writeSize));
-            if (cc < 0) {
-                ALOGW("write failed in inflate: %s", strerror(errno));
-                goto z_bail;
-            } else if (cc != (int) writeSize) {
-                ALOGW("write failed in inflate (%d vs %ld)", cc, writeSize);
-                goto z_bail;
-            }
-
-            zstream.next_out = writeBuf;
-            zstream.avail_out = sizeof(writeBuf);
-        }
-    } while (zerr == Z_OK);
-
-    assert(zerr == Z_STREAM_END);       /* other errors should've been caught */
+    job.uncompressAll();
 
-    /* paranoia */
-    if (zstream.total_out != uncompLen) {
-        ALOGW("Size mismatch on inflated file (%ld vs " ZD ")\n",
-            zstream.total_out, (ZD_TYPE) uncompLen);
-        goto z_bail;
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i]->join();
     }
 
-    result = true;
+    return android_atomic_acquire_load(&job.failed) == 0;
+}
 
-z_bail:
-    inflateEnd(&zstream);        /* free up any allocated structures */
+/*
+ * Uncompress "deflate" data from one buffer to another.
+ */
+/*static*/ bool ZipFileRO::inflateBuffer(void* outBuf, const void* inBuf,
+    size_t uncompLen, size_t compLen)
+{
+    return ZipUtils::inflateMemory(outBuf, uncompLen, inBuf, compLen);
+}
 
-bail:
-    return result;
+/*
+ * Uncompress "deflate" data from one buffer to an open file descriptor.
+ */
+/*static*/ bool ZipFileRO::inflateBuffer(int fd, const void* inBuf,
+    size_t uncompLen, size_t compLen)
+{
+    return ZipUtils::inflateToCallback(inBuf, compLen, uncompLen,
+            writeChunk, &fd);
 }
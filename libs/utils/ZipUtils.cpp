@@ -22,17 +22,187 @@
 
 #include <utils/Log.h>
 #include <utils/Compat.h>
+#include <utils/FileMap.h>
 #include <utils/ZipUtils.h>
 #include <utils/ZipFileRO.h>
 
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <unistd.h>
 
 #include <zlib.h>
 
+#ifdef HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
 using namespace android;
 
+/*
+ * Compressed data shorter than this is read rather than mapped, the
+ * mapping costs more than the copy.
+ */
+#define kMapMin             16384
+
+/* default size of the chunks handed to an InflateCallback */
+#define kInflateChunk       65536
+
+/*
+ * Map "compressedLen" bytes at "offset" of "fd", or return NULL.
+ */
+static FileMap* mapCompressed(int fd, off64_t offset, long compressedLen)
+{
+    if (offset < 0 || compressedLen < kMapMin)
+        return NULL;
+
+    FileMap* map = new FileMap();
+    if (!map->create(NULL, fd, offset, compressedLen, true)) {
+        map->release();
+        return NULL;
+    }
+    map->advise(FileMap::SEQUENTIAL);
+    return map;
+}
+
+/*static*/ bool ZipUtils::inflateMemory(void* outBuf, size_t uncompressedLen,
+    const void* inBuf, size_t compressedLen)
+{
+#ifdef HAVE_LIBDEFLATE
+    struct libdeflate_decompressor* decompressor =
+            libdeflate_alloc_decompressor();
+    if (decompressor != NULL) {
+        size_t actual = 0;
+        enum libdeflate_result res = libdeflate_deflate_decompress(
+                decompressor, inBuf, compressedLen, outBuf, uncompressedLen,
+                &actual);
+        libdeflate_free_decompressor(decompressor);
+        if (res != LIBDEFLATE_SUCCESS || actual != uncompressedLen) {
+            ALOGW("libdeflate inflate failed (res=%d, " ZD " vs " ZD ")\n",
+                res, (ZD_TYPE) actual, (ZD_TYPE) uncompressedLen);
+            return false;
+        }
+        return true;
+    }
+    /* out of memory, try zlib */
+#endif
+
+    bool result = false;
+    z_stream zstream;
+    int zerr;
+
+    memset(&zstream, 0, sizeof(zstream));
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+    zstream.next_in = (Bytef*) inBuf;
+    zstream.avail_in = compressedLen;
+    zstream.next_out = (Bytef*) outBuf;
+    zstream.avail_out = uncompressedLen;
+    zstream.data_type = Z_UNKNOWN;
+
+    /*
+     * Use the undocumented "negative window bits" feature to tell zlib
+     * that there's no zlib header waiting for it.
+     */
+    zerr = inflateInit2(&zstream, -MAX_WBITS);
+    if (zerr != Z_OK) {
+        if (zerr == Z_VERSION_ERROR) {
+            ALOGE("Installed zlib is not compatible with linked version (%s)\n",
+                ZLIB_VERSION);
+        } else {
+            ALOGE("Call to inflateInit2 failed (zerr=%d)\n", zerr);
+        }
+        return false;
+    }
+
+    zerr = inflate(&zstream, Z_FINISH);
+    if (zerr != Z_STREAM_END) {
+        ALOGW("Zip inflate failed, zerr=%d (nIn=%p aIn=%u nOut=%p aOut=%u)\n",
+            zerr, zstream.next_in, zstream.avail_in,
+            zstream.next_out, zstream.avail_out);
+        goto z_bail;
+    }
+
+    /* paranoia */
+    if (zstream.total_out != uncompressedLen) {
+        ALOGW("Size mismatch on inflated file (%ld vs " ZD ")\n",
+            zstream.total_out, (ZD_TYPE) uncompressedLen);
+        goto z_bail;
+    }
+
+    result = true;
+
+z_bail:
+    inflateEnd(&zstream);
+    return result;
+}
+
+/*static*/ bool ZipUtils::inflateToCallback(const void* inBuf,
+    size_t compressedLen, size_t uncompressedLen, InflateCallback callback,
+    void* cookie, size_t chunkSize)
+{
+    bool result = false;
+    unsigned char* chunk;
+    z_stream zstream;
+    int zerr;
+
+    if (chunkSize == 0)
+        chunkSize = kInflateChunk;
+    chunk = new unsigned char[chunkSize];
+
+    memset(&zstream, 0, sizeof(zstream));
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+    zstream.next_in = (Bytef*) inBuf;
+    zstream.avail_in = compressedLen;
+    zstream.next_out = chunk;
+    zstream.avail_out = chunkSize;
+    zstream.data_type = Z_UNKNOWN;
+
+    zerr = inflateInit2(&zstream, -MAX_WBITS);
+    if (zerr != Z_OK) {
+        ALOGE("Call to inflateInit2 failed (zerr=%d)\n", zerr);
+        goto bail;
+    }
+
+    do {
+        zerr = inflate(&zstream, Z_NO_FLUSH);
+        if (zerr != Z_OK && zerr != Z_STREAM_END) {
+            ALOGW("zlib inflate: zerr=%d (nIn=%p aIn=%u nOut=%p aOut=%u)\n",
+                zerr, zstream.next_in, zstream.avail_in,
+                zstream.next_out, zstream.avail_out);
+            goto z_bail;
+        }
+
+        /* hand the chunk over when it's full or when we're done */
+        if (zstream.avail_out == 0 ||
+            (zerr == Z_STREAM_END && zstream.avail_out != chunkSize))
+        {
+            if (!callback(chunk, zstream.next_out - chunk, cookie))
+                goto z_bail;
+            zstream.next_out = chunk;
+            zstream.avail_out = chunkSize;
+        }
+    } while (zerr == Z_OK);
+
+    /* paranoia */
+    if (zstream.total_out != uncompressedLen) {
+        ALOGW("Size mismatch on inflated file (%ld vs " ZD ")\n",
+            zstream.total_out, (ZD_TYPE) uncompressedLen);
+        goto z_bail;
+    }
+
+    result = true;
+
+z_bail:
+    inflateEnd(&zstream);
+bail:
+    delete[] chunk;
+    return result;
+}
+
 /*
  * Utility function that expands zip/gzip "deflate" compressed data
  * into a buffer.
@@ -43,6 +213,16 @@ using namespace android;
 /*static*/ bool ZipUtils::inflateToBuffer(int fd, void* buf,
     long uncompressedLen, long compressedLen)
 {
+    const off64_t start = lseek64(fd, 0, SEEK_CUR);
+    FileMap* map = mapCompressed(fd, start, compressedLen);
+    if (map != NULL) {
+        bool ok = inflateMemory(buf, uncompressedLen, map->getDataPtr(),
+                compressedLen);
+        map->release();
+        lseek64(fd, start + compressedLen, SEEK_SET);
+        return ok;
+    }
+
     bool result = false;
 	const unsigned long kReadBufSize = 32768;
 	unsigned char* readBuf = NULL;
@@ -156,6 +336,17 @@ bail:
 /*static*/ bool ZipUtils::inflateToBuffer(FILE* fp, void* buf,
     long uncompressedLen, long compressedLen)
 {
+    /* ftell() accounts for what stdio buffered, unlike the fd's position */
+    const long start = ftell(fp);
+    FileMap* map = mapCompressed(fileno(fp), start, compressedLen);
+    if (map != NULL) {
+        bool ok = inflateMemory(buf, uncompressedLen, map->getDataPtr(),
+                compressedLen);
+        map->release();
+        fseek(fp, start + compressedLen, SEEK_SET);
+        return ok;
+    }
+
     bool result = false;
 	const unsigned long kReadBufSize = 32768;
 	unsigned char* readBuf = NULL;
@@ -6,11 +6,31 @@ include $(CLEAR_VARS)
 test_src_files := \
     BasicHashtable_test.cpp \
     BlobCache_test.cpp \
+    CallStack_test.cpp \
+    FastHash_benchmark.cpp \
+    FastHash_test.cpp \
+    FileMap_test.cpp \
+    LinearAllocator_test.cpp \
+    LinearHashMap_benchmark.cpp \
+    LinearHashMap_test.cpp \
+    Looper_benchmark.cpp \
     Looper_test.cpp \
+    LruCache_benchmark.cpp \
     LruCache_test.cpp \
+    Profiler_test.cpp \
+    PropertyMap_test.cpp \
+    RefBase_test.cpp \
+    SharedBuffer_test.cpp \
     String8_test.cpp \
+    String8Builder_test.cpp \
+    Thread_test.cpp \
+    Timers_test.cpp \
+    TraceBuffer_test.cpp \
+    TraceTagMap_test.cpp \
+    Unicode_benchmark.cpp \
     Unicode_test.cpp \
     Vector_test.cpp \
+    WorkQueue_test.cpp \
     ZipFileRO_test.cpp
 
 shared_libraries := \
@@ -116,6 +116,11 @@ public:
     static const void* getBuckets(const BasicHashtable<TKey, TEntry>& h) {
         return h.mBuckets;
     }
+
+    template <typename TKey, typename TEntry>
+    static const void* getOldBuckets(const BasicHashtable<TKey, TEntry>& h) {
+        return h.mOldBuckets;
+    }
 };
 
 template <typename TKey, typename TValue>
@@ -427,6 +432,34 @@ TEST_F(BasicHashtableTest, Add_RehashesOnDemand) {
     EXPECT_GT(h.bucketCount(), h.capacity());
 }
 
+TEST_F(BasicHashtableTest, Add_WhenEmptyButFullOfCollisionMarkers_Succeeds) {
+    SimpleHashtable h;
+    ASSERT_EQ(5U, h.bucketCount());
+    ASSERT_EQ(3U, h.capacity());
+
+    // 5 and 10 collide with 0 and mark buckets 0 and 1, then 257 collides
+    // with 2 in bucket 2 and probes on to bucket 0
+    add(h, 0, 0);
+    add(h, 5, 5);
+    add(h, 10, 10);
+    remove(h, 0);
+    remove(h, 5);
+    remove(h, 10);
+    add(h, 2, 2);
+    add(h, 257, 257);
+    remove(h, 2);
+    remove(h, 257);
+    EXPECT_EQ(0U, h.size());
+
+    // the three buckets left are only collision markers, so this rehashes an
+    // empty table
+    add(h, 3, 3);
+    EXPECT_EQ(1U, h.size());
+    ssize_t index = find(h, -1, 3);
+    ASSERT_NE(-1, index);
+    EXPECT_EQ(3, h.entryAt(index).value);
+}
+
 TEST_F(BasicHashtableTest, Rehash_WhenCapacityAndBucketCountUnchanged_DoesNothing) {
     ComplexHashtable h;
     add(h, ComplexKey(0), ComplexValue(0));
@@ -574,4 +607,122 @@ TEST_F(BasicHashtableTest, CopyOnWrite) {
     EXPECT_EQ(2U, h3.size());
 }
 
+TEST_F(BasicHashtableTest, Reserve_GrowsButNeverShrinks) {
+    SimpleHashtable h;
+    h.reserve(100);
+    EXPECT_GE(h.capacity(), 100U);
+    const size_t capacity = h.capacity();
+
+    for (int i = 0; i < 100; i++) {
+        add(h, i, i);
+    }
+    EXPECT_EQ(capacity, h.capacity());
+
+    h.reserve(10);
+    EXPECT_EQ(capacity, h.capacity());
+    EXPECT_EQ(100U, h.size());
+}
+
+TEST_F(BasicHashtableTest, Entries_AreAlignedForTheirType) {
+    typedef key_value_pair_t<int64_t, double> WideEntry;
+    BasicHashtable<int64_t, WideEntry> h;
+    h.setIncrementalRehash(true);
+    for (int64_t i = 0; i < 100; i++) {
+        h.add(hash_type(i), WideEntry(i, i * 0.5));
+        for (ssize_t index = h.next(-1); index >= 0; index = h.next(index)) {
+            ASSERT_EQ(0U, uintptr_t(&h.entryAt(index)) % __alignof__(WideEntry));
+        }
+    }
+}
+
+TEST_F(BasicHashtableTest, IncrementalRehash_KeepsEntriesReachableWhileMigrating) {
+    ComplexHashtable h;
+    h.setIncrementalRehash(true);
+    const size_t initialCapacity = h.capacity();
+    for (size_t i = 0; i < initialCapacity; i++) {
+        add(h, ComplexKey(i), ComplexValue(i));
+    }
+    ASSERT_EQ((void*)NULL, getOldBuckets(h));
+
+    // the add that finds the table full starts the migration
+    add(h, ComplexKey(-1), ComplexValue(-1));
+    ASSERT_NE((void*)NULL, getOldBuckets(h));
+    ASSERT_NO_FATAL_FAILURE(assertInstanceCount(initialCapacity + 1, initialCapacity + 1));
+
+    // lookups, iteration and removal see both arrays
+    for (size_t i = 0; i < initialCapacity; i++) {
+        ssize_t index = find(h, -1, ComplexKey(i));
+        ASSERT_GE(index, 0);
+        EXPECT_EQ(int(i), h.entryAt(index).value.v);
+    }
+    size_t iterated = 0;
+    for (ssize_t index = h.next(-1); index >= 0; index = h.next(index)) {
+        iterated++;
+    }
+    EXPECT_EQ(h.size(), iterated);
+    ASSERT_TRUE(remove(h, ComplexKey(0)));
+    EXPECT_EQ(-1, find(h, -1, ComplexKey(0)));
+
+    // further adds finish it
+    int key = 1000;
+    while (getOldBuckets(h)) {
+        add(h, ComplexKey(key), ComplexValue(key));
+        key++;
+    }
+    for (size_t i = 1; i < initialCapacity; i++) {
+        EXPECT_GE(find(h, -1, ComplexKey(i)), 0);
+    }
+    for (int k = 1000; k < key; k++) {
+        EXPECT_GE(find(h, -1, ComplexKey(k)), 0);
+    }
+    EXPECT_EQ(initialCapacity + key - 1000, h.size());
+    ASSERT_NO_FATAL_FAILURE(assertInstanceCount(h.size(), h.size()));
+}
+
+TEST_F(BasicHashtableTest, IncrementalRehash_ManyEntries) {
+    SimpleHashtable h;
+    h.setIncrementalRehash(true);
+    for (int i = 0; i < 10000; i++) {
+        add(h, i, i * 2);
+        // check an entry added long ago and the newest one
+        ssize_t index = find(h, -1, i / 2);
+        ASSERT_GE(index, 0);
+        ASSERT_EQ(i / 2 * 2, h.entryAt(index).value);
+        index = find(h, -1, i);
+        ASSERT_GE(index, 0);
+        ASSERT_EQ(i * 2, h.entryAt(index).value);
+    }
+    EXPECT_EQ(10000U, h.size());
+}
+
+TEST_F(BasicHashtableTest, IncrementalRehash_CopyAndClearWhileMigrating) {
+    ComplexHashtable h1;
+    h1.setIncrementalRehash(true);
+    const size_t initialCapacity = h1.capacity();
+    for (size_t i = 0; i <= initialCapacity; i++) {
+        add(h1, ComplexKey(i), ComplexValue(i));
+    }
+    ASSERT_NE((void*)NULL, getOldBuckets(h1));
+
+    // the copy shares both arrays, until it's edited
+    ComplexHashtable h2(h1);
+    ASSERT_EQ(getOldBuckets(h1), getOldBuckets(h2));
+    add(h2, ComplexKey(-1), ComplexValue(-1));
+    EXPECT_EQ(h1.size() + 1, h2.size());
+    for (size_t i = 0; i <= initialCapacity; i++) {
+        EXPECT_GE(find(h1, -1, ComplexKey(i)), 0);
+        EXPECT_GE(find(h2, -1, ComplexKey(i)), 0);
+    }
+
+    // an explicit rehash completes the migration
+    h1.rehash(0, h1.loadFactor());
+    EXPECT_EQ((void*)NULL, getOldBuckets(h1));
+    EXPECT_EQ(initialCapacity + 1, h1.size());
+
+    h2.clear();
+    EXPECT_EQ((void*)NULL, getOldBuckets(h2));
+    EXPECT_EQ(-1, h2.next(-1));
+    ASSERT_NO_FATAL_FAILURE(assertInstanceCount(h1.size(), h1.size()));
+}
+
 } // namespace android
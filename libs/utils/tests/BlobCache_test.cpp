@@ -16,11 +16,14 @@
 
 #include <fcntl.h>
 #include <stdio.h>
+#include <unistd.h>
 
 #include <gtest/gtest.h>
 
 #include <utils/BlobCache.h>
 #include <utils/Errors.h>
+#include <utils/FileMap.h>
+#include <utils/threads.h>
 
 namespace android {
 
@@ -258,6 +261,104 @@ TEST_F(BlobCacheTest, ExceedingTotalLimitHalvesCacheSize) {
     ASSERT_EQ(maxEntries/2 + 1, numCached);
 }
 
+TEST_F(BlobCacheTest, ExceedingTotalLimitEvictsLeastRecentlyUsed) {
+    // Fill up the entire cache with 1 char key/value pairs.
+    const int maxEntries = MAX_TOTAL_SIZE / 2;
+    for (int i = 0; i < maxEntries; i++) {
+        uint8_t k = i;
+        mBC->set(&k, 1, "x", 1);
+    }
+    // Use the first half of the entries again.
+    for (int i = 0; i < maxEntries / 2; i++) {
+        uint8_t k = i;
+        ASSERT_EQ(size_t(1), mBC->get(&k, 1, NULL, 0));
+    }
+    // Insert one more entry, causing a cache overflow.
+    {
+        uint8_t k = maxEntries;
+        mBC->set(&k, 1, "x", 1);
+    }
+    // Only the second half should have been evicted.
+    for (int i = 0; i < maxEntries + 1; i++) {
+        uint8_t k = i;
+        bool evicted = i >= maxEntries / 2 && i < maxEntries;
+        EXPECT_EQ(size_t(evicted ? 0 : 1), mBC->get(&k, 1, NULL, 0)) << i;
+    }
+    EXPECT_EQ(uint32_t(maxEntries - maxEntries / 2), mBC->getEvictionCount());
+}
+
+TEST_F(BlobCacheTest, GetCountsHitsAndMisses) {
+    char buf[4];
+    mBC->set("abcd", 4, "efgh", 4);
+    mBC->get("abcd", 4, buf, 4);
+    mBC->get("abcd", 4, NULL, 0);
+    mBC->get("efgh", 4, buf, 4);
+    mBC->get("abcdefgh", 8, buf, 4);
+    EXPECT_EQ(uint32_t(2), mBC->getHitCount());
+    EXPECT_EQ(uint32_t(2), mBC->getMissCount());
+    EXPECT_EQ(uint32_t(0), mBC->getEvictionCount());
+}
+
+class BlobCacheThread : public Thread {
+public:
+    BlobCacheThread(const sp<BlobCache>& bc, uint8_t id) :
+            Thread(false), mBC(bc), mId(id), mErrors(0) { }
+
+    int getErrors() const {
+        return mErrors;
+    }
+
+private:
+    virtual bool threadLoop() {
+        for (int i = 0; i < 10000; i++) {
+            // the value of each key is the key backwards
+            uint8_t key[2] = { mId, uint8_t(i) };
+            uint8_t value[2] = { uint8_t(i), mId };
+            mBC->set(key, 2, value, 2);
+
+            uint8_t other[2] = { mId, uint8_t(i * 7) };
+            uint8_t buf[2] = { 0, 0 };
+            size_t size = mBC->get(other, 2, buf, 2);
+            if (size != 0 && (size != 2 || buf[0] != other[1] ||
+                    buf[1] != other[0])) {
+                mErrors++;
+            }
+        }
+        return false;
+    }
+
+    sp<BlobCache> mBC;
+    uint8_t mId;
+    int mErrors;
+};
+
+TEST_F(BlobCacheTest, ConcurrentSetsAndGetsKeepEntriesIntact) {
+    const int N = 4;
+    mBC = new BlobCache(2, 2, 256);
+    sp<BlobCacheThread> threads[N];
+    for (int i = 0; i < N; i++) {
+        threads[i] = new BlobCacheThread(mBC, i);
+        threads[i]->run("BlobCacheThread");
+    }
+    for (int i = 0; i < N; i++) {
+        threads[i]->join();
+        EXPECT_EQ(0, threads[i]->getErrors());
+    }
+
+    // The total size limit must have held.
+    int numCached = 0;
+    for (int id = 0; id < N; id++) {
+        for (int i = 0; i < 256; i++) {
+            uint8_t key[2] = { uint8_t(id), uint8_t(i) };
+            if (mBC->get(key, 2, NULL, 0) == 2) {
+                numCached++;
+            }
+        }
+    }
+    EXPECT_GE(256 / 4, numCached);
+    EXPECT_LT(0, numCached);
+}
+
 class BlobCacheFlattenTest : public BlobCacheTest {
 protected:
     virtual void SetUp() {
@@ -333,6 +434,34 @@ TEST_F(BlobCacheFlattenTest, FlattenDoesntChangeCache) {
     }
 }
 
+TEST_F(BlobCacheFlattenTest, FlattenKeepsEntriesRecency) {
+    // Fill up the entire cache with 1 char key/value pairs, and use the first
+    // one again.
+    const int maxEntries = MAX_TOTAL_SIZE / 2;
+    for (int i = 0; i < maxEntries; i++) {
+        uint8_t k = i;
+        mBC->set(&k, 1, &k, 1);
+    }
+    {
+        uint8_t k = 0;
+        ASSERT_EQ(size_t(1), mBC->get(&k, 1, NULL, 0));
+    }
+
+    roundTrip();
+
+    // Overflowing the new cache evicts the least recently used entries, which
+    // are the ones after the first.
+    {
+        uint8_t k = maxEntries;
+        mBC2->set(&k, 1, &k, 1);
+    }
+    for (int i = 0; i < maxEntries + 1; i++) {
+        uint8_t k = i;
+        bool evicted = i >= 1 && i < 1 + maxEntries / 2;
+        EXPECT_EQ(size_t(evicted ? 0 : 1), mBC2->get(&k, 1, NULL, 0)) << i;
+    }
+}
+
 TEST_F(BlobCacheFlattenTest, FlattenCatchesBufferTooSmall) {
     // Fill up the entire cache with 1 char key/value pairs.
     const int maxEntries = MAX_TOTAL_SIZE / 2;
@@ -418,4 +547,152 @@ TEST_F(BlobCacheFlattenTest, UnflattenCatchesBufferTooSmall) {
     ASSERT_EQ(size_t(0), mBC2->get("abcd", 4, buf, 4));
 }
 
+class BlobCacheAttachTest : public BlobCacheFlattenTest {
+protected:
+    enum {
+        // where the cache contents start in the file, as in the EGL cache
+        OFFSET = 8,
+    };
+
+    virtual void SetUp() {
+        BlobCacheFlattenTest::SetUp();
+        mFile = tmpfile();
+    }
+
+    virtual void TearDown() {
+        fclose(mFile);
+        BlobCacheFlattenTest::TearDown();
+    }
+
+    // save writes the flattened contents of mBC to the file.
+    void save() {
+        size_t size = mBC->getFlattenedSize();
+        uint8_t* flat = new uint8_t[OFFSET + size];
+        memset(flat, 0, OFFSET);
+        ASSERT_EQ(OK, mBC->flatten(flat + OFFSET, size, NULL, 0));
+        ASSERT_EQ(ssize_t(OFFSET + size),
+                pwrite(fileno(mFile), flat, OFFSET + size, 0));
+        ASSERT_EQ(0, ftruncate(fileno(mFile), OFFSET + size));
+        delete[] flat;
+    }
+
+    // append writes what mBC appends to the contents it was attached to.
+    void append() {
+        size_t offset = mBC->getAppendOffset();
+        ASSERT_NE(size_t(0), offset);
+        size_t size = mBC->getAppendSize();
+        uint8_t* flat = new uint8_t[size];
+        ASSERT_EQ(OK, mBC->flattenAppend(flat, size));
+        ASSERT_EQ(ssize_t(size),
+                pwrite(fileno(mFile), flat, size, OFFSET + offset));
+        ASSERT_EQ(0, ftruncate(fileno(mFile), OFFSET + offset + size));
+        delete[] flat;
+    }
+
+    // corrupt flips a byte of the file, counted from its end if negative.
+    void corrupt(off_t offset) {
+        if (offset < 0) {
+            offset += lseek(fileno(mFile), 0, SEEK_END);
+        }
+        uint8_t byte;
+        ASSERT_EQ(1, pread(fileno(mFile), &byte, 1, offset));
+        byte = ~byte;
+        ASSERT_EQ(1, pwrite(fileno(mFile), &byte, 1, offset));
+    }
+
+    status_t attach(const sp<BlobCache>& bc) {
+        FileMap* map = new FileMap();
+        size_t size = lseek(fileno(mFile), 0, SEEK_END);
+        if (!map->create(NULL, fileno(mFile), 0, size, true)) {
+            map->release();
+            return UNKNOWN_ERROR;
+        }
+        return bc->attach(map, OFFSET);
+    }
+
+    FILE* mFile;
+};
+
+TEST_F(BlobCacheAttachTest, AttachFindsTheEntries) {
+    char buf[4] = { 0xee, 0xee, 0xee, 0xee };
+    mBC->set("abcd", 4, "efgh", 4);
+    mBC->set("ij", 2, "kl", 2);
+    save();
+
+    ASSERT_EQ(OK, attach(mBC2));
+    ASSERT_EQ(size_t(4), mBC2->get("abcd", 4, buf, 4));
+    ASSERT_EQ('e', buf[0]);
+    ASSERT_EQ('f', buf[1]);
+    ASSERT_EQ('g', buf[2]);
+    ASSERT_EQ('h', buf[3]);
+    ASSERT_EQ(size_t(2), mBC2->get("ij", 2, buf, 2));
+    ASSERT_EQ('k', buf[0]);
+    ASSERT_EQ('l', buf[1]);
+}
+
+TEST_F(BlobCacheAttachTest, AttachEvictsCorruptedEntriesWhenUsed) {
+    mBC->set("abcd", 4, "efgh", 4);
+    mBC->set("ij", 2, "kl", 2);
+    save();
+    // Flip a byte of the value of the first, least recently used, entry,
+    // which follows the 12 byte header, its sizes and its key.
+    corrupt(OFFSET + 12 + 2 * sizeof(size_t) + 4 + 1);
+
+    ASSERT_EQ(OK, attach(mBC2));
+    ASSERT_EQ(size_t(0), mBC2->get("abcd", 4, NULL, 0));
+    ASSERT_EQ(size_t(2), mBC2->get("ij", 2, NULL, 0));
+    ASSERT_EQ(size_t(0), mBC2->get("abcd", 4, NULL, 0));
+}
+
+TEST_F(BlobCacheAttachTest, AttachCatchesCorruptedIndex) {
+    mBC->set("abcd", 4, "efgh", 4);
+    save();
+    mBC2->set("ij", 2, "kl", 2);
+    // The last byte of the index is just before the trailer.
+    corrupt(-1 - 4 * int(sizeof(size_t)));
+
+    ASSERT_EQ(BAD_VALUE, attach(mBC2));
+    ASSERT_EQ(size_t(0), mBC2->get("abcd", 4, NULL, 0));
+    ASSERT_EQ(size_t(2), mBC2->get("ij", 2, NULL, 0));
+    ASSERT_EQ(size_t(0), mBC2->getAppendOffset());
+}
+
+TEST_F(BlobCacheAttachTest, AppendOnlyWritesNewEntries) {
+    char buf[2] = { 0xee, 0xee };
+    mBC->set("ab", 2, "cd", 2);
+    save();
+    ASSERT_EQ(OK, attach(mBC));
+
+    // The attached entry replaced the one in memory and isn't written again.
+    size_t indexSize = mBC->getAppendSize();
+    mBC->set("ef", 2, "gh", 2);
+    mBC->set("ij", 2, "kl", 2);
+    append();
+    ASSERT_LT(indexSize, mBC->getAppendSize());
+    ASSERT_GT(mBC->getFlattenedSize(), mBC->getAppendSize());
+
+    ASSERT_EQ(OK, attach(mBC2));
+    ASSERT_EQ(size_t(2), mBC2->get("ab", 2, buf, 2));
+    ASSERT_EQ('c', buf[0]);
+    ASSERT_EQ('d', buf[1]);
+    ASSERT_EQ(size_t(2), mBC2->get("ef", 2, buf, 2));
+    ASSERT_EQ('g', buf[0]);
+    ASSERT_EQ('h', buf[1]);
+    ASSERT_EQ(size_t(2), mBC2->get("ij", 2, buf, 2));
+    ASSERT_EQ('k', buf[0]);
+    ASSERT_EQ('l', buf[1]);
+}
+
+TEST_F(BlobCacheAttachTest, AttachKeepsEntriesChangedInMemory) {
+    char buf[2] = { 0xee, 0xee };
+    mBC->set("ab", 2, "cd", 2);
+    save();
+    mBC->set("ab", 2, "xy", 2);
+
+    ASSERT_EQ(OK, attach(mBC));
+    ASSERT_EQ(size_t(2), mBC->get("ab", 2, buf, 2));
+    ASSERT_EQ('x', buf[0]);
+    ASSERT_EQ('y', buf[1]);
+}
+
 } // namespace android
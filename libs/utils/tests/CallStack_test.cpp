@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CallStack_test"
+
+#include <utils/CallStack.h>
+
+#include <gtest/gtest.h>
+
+namespace android {
+
+static void __attribute__((noinline)) captureFast(CallStack* stack) {
+    stack->updateFast();
+}
+
+class CallStackTest : public testing::Test {
+};
+
+TEST_F(CallStackTest, UpdateFast_RecordsFrames) {
+    CallStack stack;
+    captureFast(&stack);
+    EXPECT_GT(stack.size(), 1U);
+    EXPECT_TRUE(stack[0] != NULL);
+}
+
+TEST_F(CallStackTest, UpdateFast_RespectsMaxDepth) {
+    CallStack stack;
+    stack.updateFast(1, 2);
+    EXPECT_EQ(2U, stack.size());
+    stack.updateFast(1, 0);
+    EXPECT_EQ(0U, stack.size());
+}
+
+TEST_F(CallStackTest, UpdateFast_SameCallSite_GivesEqualStacks) {
+    CallStack stacks[2];
+    for (int i = 0; i < 2; i++) {
+        captureFast(&stacks[i]);
+    }
+    EXPECT_TRUE(stacks[0] == stacks[1]);
+}
+
+TEST_F(CallStackTest, ToString_FormatsEveryFrame) {
+    CallStack stack;
+    captureFast(&stack);
+    // twice, the second time from the symbol cache
+    for (int i = 0; i < 2; i++) {
+        String8 str = stack.toString("> ");
+        size_t lines = 0;
+        for (const char* p = str.string(); *p; p++) {
+            if (*p == '\n') {
+                lines++;
+            }
+        }
+        EXPECT_EQ(stack.size(), lines);
+        EXPECT_EQ(0, strncmp("> #00", str.string(), 5));
+    }
+}
+
+} // namespace android
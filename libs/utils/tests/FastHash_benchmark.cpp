@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "FastHashBenchmark"
+
+#include <utils/FastHash.h>
+#include <utils/JenkinsHash.h>
+#include <utils/Timers.h>
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace android {
+
+// Not a correctness test: reports the throughput of the hash and CRC
+// functions for short keys, shader-sized blobs and zip-entry-sized data.
+class FastHashBenchmark : public testing::Test {
+protected:
+    enum { TOTAL_BYTES = 64 << 20 };
+
+    virtual void SetUp() {
+        mData = new uint8_t[MAX_SIZE];
+        for (size_t i = 0; i < MAX_SIZE; i++) {
+            mData[i] = uint8_t(rand());
+        }
+    }
+
+    virtual void TearDown() {
+        delete [] mData;
+    }
+
+    static void report(const char* name, size_t size, nsecs_t duration) {
+        const double seconds = duration / 1e9;
+        printf("%-22s %7u bytes %10.1f MB/s\n", name, uint32_t(size),
+                seconds > 0 ? TOTAL_BYTES / seconds / (1 << 20) : 0.0);
+    }
+
+    void benchmark(size_t size) {
+        const size_t iterations = TOTAL_BYTES / size;
+        uint32_t sink = 0;
+
+        nsecs_t start = systemTime();
+        for (size_t i = 0; i < iterations; i++) {
+            sink += JenkinsHashWhiten(JenkinsHashMixBytes(i, mData, size));
+        }
+        report("JenkinsHashMixBytes", size, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < iterations; i++) {
+            sink += uint32_t(FastHash64(mData, size, i));
+        }
+        report("FastHash64", size, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < iterations; i++) {
+            sink += crc32(i, mData, size);
+        }
+        report("zlib crc32", size, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < iterations; i++) {
+            sink += FastCrc32(i, mData, size);
+        }
+        report("FastCrc32", size, systemTime() - start);
+
+        // keeps the loops from being optimized away
+        EXPECT_NE(0xdeadbeef, sink);
+    }
+
+    enum { MAX_SIZE = 64 * 1024 };
+    uint8_t* mData;
+};
+
+TEST_F(FastHashBenchmark, Short) {
+    benchmark(24);
+}
+
+TEST_F(FastHashBenchmark, Medium) {
+    benchmark(1024);
+}
+
+TEST_F(FastHashBenchmark, Large) {
+    benchmark(64 * 1024);
+}
+
+} // namespace android
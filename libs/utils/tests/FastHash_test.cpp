@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "FastHash_test"
+
+#include <utils/FastHash.h>
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include <string.h>
+
+namespace android {
+
+TEST(FastHashTest, KnownValues) {
+    // xxHash64 reference values
+    EXPECT_EQ(0xEF46DB3751D8E999ULL, FastHash64("", 0));
+    EXPECT_EQ(0x44BC2CF5AD770999ULL, FastHash64("abc", 3));
+}
+
+TEST(FastHashTest, IndependentOfAlignment) {
+    uint8_t buffer[256 + 8];
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = uint8_t(i * 7);
+    }
+    uint8_t copy[256 + 8];
+    for (size_t size = 0; size <= 256; size++) {
+        for (size_t offset = 1; offset < 8; offset++) {
+            memcpy(copy + offset, buffer, size);
+            ASSERT_EQ(FastHash64(buffer, size), FastHash64(copy + offset, size))
+                    << "size " << size << " offset " << offset;
+        }
+    }
+}
+
+TEST(FastHashTest, EveryByteMatters) {
+    // covers each of the lanes and the tails
+    uint8_t buffer[100];
+    memset(buffer, 0, sizeof(buffer));
+    const uint64_t base = FastHash64(buffer, sizeof(buffer));
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = 1;
+        EXPECT_NE(base, FastHash64(buffer, sizeof(buffer))) << "byte " << i;
+        buffer[i] = 0;
+    }
+    EXPECT_NE(base, FastHash64(buffer, sizeof(buffer) - 1));
+    EXPECT_NE(base, FastHash64(buffer, sizeof(buffer), 1));
+}
+
+TEST(FastHashTest, Crc32MatchesZlib) {
+    uint8_t buffer[1000 + 8];
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = uint8_t(i * 13 + 5);
+    }
+    for (size_t size = 0; size <= 1000; size += 37) {
+        for (size_t offset = 0; offset < 8; offset += 3) {
+            const uint32_t expected = crc32(0, buffer + offset, size);
+            EXPECT_EQ(expected, FastCrc32(0, buffer + offset, size))
+                    << "size " << size << " offset " << offset;
+        }
+    }
+    // incremental updates chain like zlib's
+    const uint32_t first = FastCrc32(0, buffer, 100);
+    EXPECT_EQ(uint32_t(crc32(0, buffer, 300)), FastCrc32(first, buffer + 100, 200));
+}
+
+} // namespace android
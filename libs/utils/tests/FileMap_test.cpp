@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "FileMap_test"
+
+#include <utils/FileMap.h>
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace android {
+
+class FileMapTest : public testing::Test {
+protected:
+    enum { FILE_SIZE = 256 * 1024 };
+
+    virtual void SetUp() {
+        strcpy(mPath, "/tmp/FileMap_test_XXXXXX");
+        mFd = mkstemp(mPath);
+        ASSERT_NE(-1, mFd);
+        char buf[4096];
+        for (size_t i = 0; i < FILE_SIZE; i += sizeof(buf)) {
+            memset(buf, int(i / sizeof(buf)), sizeof(buf));
+            ASSERT_EQ(ssize_t(sizeof(buf)), write(mFd, buf, sizeof(buf)));
+        }
+    }
+
+    virtual void TearDown() {
+        close(mFd);
+        unlink(mPath);
+    }
+
+    char mPath[64];
+    int mFd;
+};
+
+TEST_F(FileMapTest, UnalignedOffset) {
+    FileMap* map = new FileMap();
+    ASSERT_TRUE(map->create(mPath, mFd, 4096 * 3 + 100, 10000, true));
+    const unsigned char* data = (const unsigned char*) map->getDataPtr();
+    EXPECT_EQ(3, data[0]);
+    EXPECT_EQ(5, data[9999]);
+    map->release();
+}
+
+TEST_F(FileMapTest, AdviseRange) {
+    FileMap* map = new FileMap();
+    ASSERT_TRUE(map->create(mPath, mFd, 100, FILE_SIZE - 100, true));
+    const unsigned char* data = (const unsigned char*) map->getDataPtr();
+
+    EXPECT_EQ(0, map->prefetch(5000, 100000));
+    EXPECT_EQ(0, map->advise(FileMap::SEQUENTIAL, 0, FILE_SIZE - 100));
+    EXPECT_EQ(0, map->discard(0, 50000));
+
+    // discarded pages of a read-only map are read back from the file
+    EXPECT_EQ(1, data[4096]);
+    EXPECT_EQ(12, data[50000]);
+    map->release();
+}
+
+TEST_F(FileMapTest, AdviseRangeOutsideMap) {
+    FileMap* map = new FileMap();
+    ASSERT_TRUE(map->create(mPath, mFd, 0, 8192, true));
+    EXPECT_EQ(-1, map->prefetch(8000, 1000));
+    EXPECT_EQ(-1, map->prefetch(9000, 0));
+    EXPECT_EQ(0, map->prefetch(8192, 0));
+    map->release();
+}
+
+} // namespace android
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LinearAllocator_test"
+
+#include <pthread.h>
+#include <string.h>
+
+#include <utils/LinearAllocator.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+// Counts how many instances have been destroyed, and in which order.
+class Tracked {
+public:
+    Tracked() : mId(sNextId++) { }
+    Tracked(const Tracked& other) : mId(other.mId) { }
+    ~Tracked() {
+        sLastDestroyed = mId;
+        sDestroyed++;
+    }
+
+    int id() const { return mId; }
+
+    static int sNextId;
+    static int sDestroyed;
+    static int sLastDestroyed;
+
+private:
+    int mId;
+};
+
+int Tracked::sNextId = 0;
+int Tracked::sDestroyed = 0;
+int Tracked::sLastDestroyed = -1;
+
+class LinearAllocatorTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        Tracked::sNextId = 0;
+        Tracked::sDestroyed = 0;
+        Tracked::sLastDestroyed = -1;
+    }
+};
+
+TEST_F(LinearAllocatorTest, AllocationsDoNotOverlap) {
+    LinearAllocator la;
+    char* a = static_cast<char*>(la.alloc(100));
+    char* b = static_cast<char*>(la.alloc(100));
+    memset(a, 'a', 100);
+    memset(b, 'b', 100);
+    EXPECT_TRUE(a + 100 <= b || b + 100 <= a);
+    EXPECT_EQ('a', a[99]);
+}
+
+TEST_F(LinearAllocatorTest, LargeAllocationIsUsable) {
+    LinearAllocator la;
+    const size_t size = 256 * 1024;
+    char* big = static_cast<char*>(la.alloc(size));
+    memset(big, 0x5a, size);
+    EXPECT_EQ(0x5a, big[size - 1]);
+}
+
+TEST_F(LinearAllocatorTest, ResetDestroysNewestFirst) {
+    LinearAllocator la;
+    la.create<Tracked>();
+    Tracked* last = la.create<Tracked>();
+    EXPECT_EQ(1, last->id());
+
+    la.reset();
+    EXPECT_EQ(2, Tracked::sDestroyed);
+    EXPECT_EQ(0, Tracked::sLastDestroyed);
+
+    la.reset();
+    EXPECT_EQ(2, Tracked::sDestroyed);
+}
+
+TEST_F(LinearAllocatorTest, DestructorRunsRegisteredDestructors) {
+    {
+        LinearAllocator la;
+        Tracked original;
+        EXPECT_EQ(original.id(), la.create(original)->id());
+    }
+    EXPECT_EQ(2, Tracked::sDestroyed);
+}
+
+TEST_F(LinearAllocatorTest, ResetReusesPages) {
+    LinearAllocator la;
+    void* first = la.alloc(64);
+    for (int i = 0; i < 1000; i++) {
+        la.alloc(64);
+    }
+    const size_t used = la.usedSize();
+
+    la.reset();
+    EXPECT_EQ(first, la.alloc(64));
+    for (int i = 0; i < 1000; i++) {
+        la.alloc(64);
+    }
+    EXPECT_EQ(used, la.usedSize());
+}
+
+TEST_F(LinearAllocatorTest, ResetFreesDedicatedPages) {
+    LinearAllocator la;
+    la.alloc(64);
+    const size_t used = la.usedSize();
+    la.alloc(64 * 1024);
+    EXPECT_LT(used, la.usedSize());
+
+    la.reset();
+    la.alloc(64);
+    EXPECT_EQ(used, la.usedSize());
+}
+
+static void* getForThread(void* result) {
+    *static_cast<LinearAllocator**>(result) = &LinearAllocator::getForThread();
+    return NULL;
+}
+
+TEST_F(LinearAllocatorTest, EachThreadHasItsOwnAllocator) {
+    LinearAllocator* mine = &LinearAllocator::getForThread();
+    EXPECT_EQ(mine, &LinearAllocator::getForThread());
+
+    LinearAllocator* other = NULL;
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, NULL, getForThread, &other));
+    pthread_join(thread, NULL);
+    EXPECT_TRUE(other != NULL);
+    EXPECT_NE(mine, other);
+}
+
+} // namespace android
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LinearHashMapBenchmark"
+
+#include <utils/BasicHashtable.h>
+#include <utils/KeyedVector.h>
+#include <utils/LinearHashMap.h>
+#include <utils/Timers.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace android {
+
+// Not a correctness test: these compare how many lookups, and additions
+// followed by removals, per second KeyedVector, BasicHashtable and
+// LinearHashMap do, with small tables (the fds of a Looper, the active
+// sensors) and larger ones.
+class LinearHashMapBenchmark : public testing::Test {
+protected:
+    enum { OPERATIONS = 1 << 18 };
+
+    typedef key_value_pair_t<int, int> Entry;
+
+    static void report(const char* name, size_t entries, size_t ops,
+            nsecs_t duration) {
+        const double seconds = duration / 1e9;
+        printf("%-26s %5u entries %12.0f ops/s\n", name, uint32_t(entries),
+                seconds > 0 ? ops / seconds : 0.0);
+    }
+
+    // sparse keys, like fds or handles
+    static int keyAt(size_t i) {
+        return int(i * 13 + 3);
+    }
+
+    void benchmarkLookups(size_t entries) {
+        KeyedVector<int, int> keyedVector;
+        BasicHashtable<int, Entry> hashtable;
+        LinearHashMap<int, int> map;
+        for (size_t i = 0; i < entries; i++) {
+            keyedVector.add(keyAt(i), i);
+            hashtable.add(hash_type(keyAt(i)), Entry(keyAt(i), i));
+            map.add(keyAt(i), i);
+        }
+
+        int found = 0;
+        nsecs_t start = systemTime();
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            found += keyedVector.indexOfKey(keyAt(i % (entries * 2))) >= 0;
+        }
+        report("KeyedVector lookup", entries, OPERATIONS, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            const int key = keyAt(i % (entries * 2));
+            found += hashtable.find(-1, hash_type(key), key) >= 0;
+        }
+        report("BasicHashtable lookup", entries, OPERATIONS, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            found += map.indexOfKey(keyAt(i % (entries * 2))) >= 0;
+        }
+        report("LinearHashMap lookup", entries, OPERATIONS, systemTime() - start);
+
+        // half of the keys looked up are in the tables
+        EXPECT_EQ(3 * OPERATIONS / 2, found);
+    }
+
+    void benchmarkAddRemove(size_t entries) {
+        srand(0);
+        Vector<int> keys;
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            keys.add(keyAt(rand() % entries));
+        }
+
+        KeyedVector<int, int> keyedVector;
+        nsecs_t start = systemTime();
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            if (keyedVector.removeItem(keys[i]) < 0) {
+                keyedVector.add(keys[i], i);
+            }
+        }
+        report("KeyedVector add/remove", entries, OPERATIONS, systemTime() - start);
+
+        BasicHashtable<int, Entry> hashtable;
+        start = systemTime();
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            const hash_t hash = hash_type(keys[i]);
+            ssize_t index = hashtable.find(-1, hash, keys[i]);
+            if (index >= 0) {
+                hashtable.removeAt(index);
+            } else {
+                hashtable.add(hash, Entry(keys[i], i));
+            }
+        }
+        report("BasicHashtable add/remove", entries, OPERATIONS, systemTime() - start);
+
+        LinearHashMap<int, int> map;
+        start = systemTime();
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            if (map.removeItem(keys[i]) < 0) {
+                map.add(keys[i], i);
+            }
+        }
+        report("LinearHashMap add/remove", entries, OPERATIONS, systemTime() - start);
+
+        EXPECT_EQ(keyedVector.size(), map.size());
+        EXPECT_EQ(keyedVector.size(), hashtable.size());
+    }
+};
+
+TEST_F(LinearHashMapBenchmark, SmallTables) {
+    benchmarkLookups(16);
+    benchmarkAddRemove(16);
+}
+
+TEST_F(LinearHashMapBenchmark, LargeTables) {
+    benchmarkLookups(1024);
+    benchmarkAddRemove(1024);
+}
+
+}; // namespace android
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LinearHashMap_test"
+
+#include <utils/LinearHashMap.h>
+#include <utils/KeyedVector.h>
+#include <cutils/log.h>
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+namespace android {
+
+struct ComplexKey {
+    int k;
+
+    explicit ComplexKey(int k) : k(k) {
+        instanceCount += 1;
+    }
+
+    ComplexKey(const ComplexKey& other) : k(other.k) {
+        instanceCount += 1;
+    }
+
+    ~ComplexKey() {
+        instanceCount -= 1;
+    }
+
+    bool operator ==(const ComplexKey& other) const {
+        return k == other.k;
+    }
+
+    static ssize_t instanceCount;
+};
+
+ssize_t ComplexKey::instanceCount = 0;
+
+template<> inline hash_t hash_type(const ComplexKey& value) {
+    return hash_type(value.k);
+}
+
+// all the keys have the same hash code
+struct CollidingKey {
+    int k;
+
+    CollidingKey(int k) : k(k) { }
+
+    bool operator ==(const CollidingKey& other) const {
+        return k == other.k;
+    }
+};
+
+template<> inline hash_t hash_type(const CollidingKey&) {
+    return 42;
+}
+
+typedef LinearHashMap<int, int> SimpleMap;
+
+TEST(LinearHashMapTest, DefaultConstructor_IsEmpty) {
+    SimpleMap map(-1);
+
+    EXPECT_EQ(0U, map.size());
+    EXPECT_TRUE(map.isEmpty());
+    EXPECT_EQ(NAME_NOT_FOUND, map.indexOfKey(0));
+    EXPECT_EQ(-1, map.valueFor(0));
+    EXPECT_EQ(-1, map.next(-1));
+}
+
+TEST(LinearHashMapTest, Add_ThenFind_ReturnsTheValues) {
+    SimpleMap map(-1);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_GE(map.add(i * 7, i), 0);
+    }
+
+    EXPECT_EQ(100U, map.size());
+    for (int i = 0; i < 100; i++) {
+        ssize_t index = map.indexOfKey(i * 7);
+        ASSERT_GE(index, 0);
+        EXPECT_EQ(i * 7, map.keyAt(index));
+        EXPECT_EQ(i, map.valueAt(index));
+        EXPECT_EQ(i, map.valueFor(i * 7));
+    }
+    EXPECT_EQ(-1, map.valueFor(1));
+}
+
+TEST(LinearHashMapTest, Add_ExistingKey_ReplacesTheValue) {
+    SimpleMap map;
+    map.add(1, 10);
+    map.add(1, 11);
+
+    EXPECT_EQ(1U, map.size());
+    EXPECT_EQ(11, map.valueFor(1));
+}
+
+TEST(LinearHashMapTest, RemoveItem_LeavesTheOtherEntries) {
+    SimpleMap map(-1);
+    for (int i = 0; i < 100; i++) {
+        map.add(i, i);
+    }
+    for (int i = 0; i < 100; i += 2) {
+        EXPECT_EQ(NO_ERROR, map.removeItem(i));
+    }
+    EXPECT_EQ(NAME_NOT_FOUND, map.removeItem(0));
+
+    EXPECT_EQ(50U, map.size());
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(i % 2 ? i : -1, map.valueFor(i));
+    }
+}
+
+TEST(LinearHashMapTest, CollidingKeys_AreAllFound) {
+    LinearHashMap<CollidingKey, int> map(-1);
+    for (int i = 0; i < 20; i++) {
+        map.add(CollidingKey(i), i);
+    }
+    map.removeItem(CollidingKey(5));
+    map.removeItem(CollidingKey(0));
+
+    EXPECT_EQ(18U, map.size());
+    for (int i = 0; i < 20; i++) {
+        EXPECT_EQ(i == 0 || i == 5 ? -1 : i, map.valueFor(CollidingKey(i)));
+    }
+}
+
+TEST(LinearHashMapTest, Next_VisitsEveryEntryOnce) {
+    SimpleMap map;
+    for (int i = 0; i < 50; i++) {
+        map.add(i, i);
+    }
+
+    int sum = 0;
+    size_t count = 0;
+    for (ssize_t index = map.next(-1); index >= 0; index = map.next(index)) {
+        sum += map.keyAt(index);
+        count++;
+    }
+    EXPECT_EQ(50U, count);
+    EXPECT_EQ(49 * 50 / 2, sum);
+}
+
+TEST(LinearHashMapTest, Copy_IsIndependent) {
+    SimpleMap map(-1);
+    map.add(1, 1);
+    map.add(2, 2);
+
+    SimpleMap copy(map);
+    copy.add(3, 3);
+    copy.removeItem(1);
+    map = copy;
+    copy.clear();
+
+    EXPECT_EQ(2U, map.size());
+    EXPECT_EQ(-1, map.valueFor(1));
+    EXPECT_EQ(2, map.valueFor(2));
+    EXPECT_EQ(3, map.valueFor(3));
+    EXPECT_TRUE(copy.isEmpty());
+}
+
+TEST(LinearHashMapTest, ComplexKeys_AreAllDestroyed) {
+    {
+        LinearHashMap<ComplexKey, int> map;
+        map.setCapacity(10);
+        for (int i = 0; i < 100; i++) {
+            map.add(ComplexKey(i), i);
+        }
+        for (int i = 0; i < 100; i += 3) {
+            map.removeItem(ComplexKey(i));
+        }
+        EXPECT_EQ(ssize_t(map.size()), ComplexKey::instanceCount);
+    }
+    EXPECT_EQ(0, ComplexKey::instanceCount);
+}
+
+TEST(LinearHashMapTest, RandomOperations_MatchKeyedVector) {
+    LinearHashMap<int, int> map(-1);
+    DefaultKeyedVector<int, int> expected(-1);
+    srand(0);
+    for (int i = 0; i < 10000; i++) {
+        const int key = rand() % 500;
+        if (rand() % 3) {
+            map.add(key, i);
+            expected.add(key, i);
+        } else {
+            map.removeItem(key);
+            expected.removeItem(key);
+        }
+    }
+
+    ASSERT_EQ(expected.size(), map.size());
+    for (int key = 0; key < 500; key++) {
+        EXPECT_EQ(expected.valueFor(key), map.valueFor(key));
+    }
+}
+
+}; // namespace android
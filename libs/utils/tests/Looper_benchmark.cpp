@@ -0,0 +1,103 @@
+//
+// Copyright 2013 The Android Open Source Project
+//
+
+#include <utils/Looper.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace android {
+
+// Not a correctness test: these measure how many messages per second a
+// Looper queues, removes and delivers with a large backlog of delayed
+// messages (timeouts, retries).
+class LooperBenchmark : public testing::Test {
+protected:
+    enum { MESSAGES = 10000, HANDLERS = 100 };
+
+    class CountingMessageHandler : public MessageHandler {
+    public:
+        CountingMessageHandler() : count(0) { }
+        virtual void handleMessage(const Message&) {
+            count++;
+        }
+        size_t count;
+    };
+
+    sp<Looper> mLooper;
+    Vector<sp<CountingMessageHandler> > mHandlers;
+
+    virtual void SetUp() {
+        mLooper = new Looper(true);
+        for (int i = 0; i < HANDLERS; i++) {
+            mHandlers.add(new CountingMessageHandler());
+        }
+        srand(0);
+    }
+
+    virtual void TearDown() {
+        mHandlers.clear();
+        mLooper.clear();
+    }
+
+    static void report(const char* name, size_t ops, nsecs_t duration) {
+        const double seconds = duration / 1e9;
+        printf("%-32s %10.0f ops/s\n", name,
+                seconds > 0 ? ops / seconds : 0.0);
+    }
+
+    // queues MESSAGES messages due at random times in the next 10s, or
+    // already due if past is true
+    void sendMessages(bool past) {
+        const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+        for (int i = 0; i < MESSAGES; i++) {
+            const nsecs_t delay = ms2ns(rand() % 10000);
+            mLooper->sendMessageAtTime(past ? now - delay : now + delay,
+                    mHandlers[i % HANDLERS], Message(i % 4));
+        }
+    }
+
+    size_t delivered() const {
+        size_t count = 0;
+        for (size_t i = 0; i < mHandlers.size(); i++) {
+            count += mHandlers[i]->count;
+        }
+        return count;
+    }
+};
+
+TEST_F(LooperBenchmark, SendDelayedMessages) {
+    const nsecs_t start = systemTime();
+    sendMessages(false);
+    report("send delayed messages", MESSAGES, systemTime() - start);
+}
+
+TEST_F(LooperBenchmark, RemoveMessages) {
+    sendMessages(false);
+    const nsecs_t start = systemTime();
+    for (int i = 0; i < HANDLERS; i++) {
+        mLooper->removeMessages(mHandlers[i], i % 4);
+    }
+    for (int i = 0; i < HANDLERS; i++) {
+        mLooper->removeMessages(mHandlers[i]);
+    }
+    report("remove messages", HANDLERS * 2, systemTime() - start);
+
+    EXPECT_NE(ALOOPER_POLL_CALLBACK, mLooper->pollOnce(0));
+    EXPECT_EQ(0U, delivered());
+}
+
+TEST_F(LooperBenchmark, DeliverMessages) {
+    sendMessages(true);
+    const nsecs_t start = systemTime();
+    while (mLooper->pollOnce(0) == ALOOPER_POLL_CALLBACK) {
+    }
+    report("deliver messages", MESSAGES, systemTime() - start);
+
+    EXPECT_EQ(size_t(MESSAGES), delivered());
+}
+
+} // namespace android
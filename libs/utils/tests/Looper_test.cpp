@@ -437,6 +437,87 @@ TEST_F(LooperTest, PollOnce_WhenCallbackAddedTwice_OnlySecondCallbackShouldBeInv
             << "replacement handler callback should be invoked";
 }
 
+TEST_F(LooperTest, PollOnce_WhenMoreFDsAreSignalledThanTheEventBatchSize_InvokesTheRestNextPoll) {
+    const int N = 8;
+    Pipe pipes[N];
+    StubCallbackHandler* handlers[N];
+    for (int i = 0; i < N; i++) {
+        handlers[i] = new StubCallbackHandler(true);
+        handlers[i]->setCallback(mLooper, pipes[i].receiveFd, ALOOPER_EVENT_INPUT);
+        pipes[i].writeSignal();
+    }
+
+    mLooper->setEventBatchSize(N / 2);
+    int result1 = mLooper->pollOnce(0);
+    int count1 = 0;
+    for (int i = 0; i < N; i++) {
+        count1 += handlers[i]->callbackCount;
+    }
+    for (int i = 0; i < N; i++) {
+        if (handlers[i]->callbackCount) {
+            pipes[i].readSignal();
+        }
+    }
+    int result2 = mLooper->pollOnce(0);
+    int count2 = 0;
+    for (int i = 0; i < N; i++) {
+        count2 += handlers[i]->callbackCount;
+        delete handlers[i];
+    }
+
+    EXPECT_EQ(ALOOPER_POLL_CALLBACK, result1)
+            << "pollOnce result should be ALOOPER_POLL_CALLBACK";
+    EXPECT_EQ(N / 2, count1)
+            << "only a batch of callbacks should be invoked by the first poll";
+    EXPECT_EQ(ALOOPER_POLL_CALLBACK, result2)
+            << "pollOnce result should be ALOOPER_POLL_CALLBACK";
+    EXPECT_EQ(N, count2)
+            << "the other callbacks should be invoked by the second poll";
+}
+
+TEST_F(LooperTest, PollOnce_WhenEdgeTriggeredFdIsNotDrained_DoesNotInvokeCallbackAgain) {
+    Pipe pipe;
+    StubCallbackHandler handler(true);
+
+    handler.setCallback(mLooper, pipe.receiveFd,
+            ALOOPER_EVENT_INPUT | Looper::EVENT_EDGE_TRIGGERED);
+    pipe.writeSignal();
+
+    int result1 = mLooper->pollOnce(0);
+    int count1 = handler.callbackCount;
+    int result2 = mLooper->pollOnce(0);
+    int count2 = handler.callbackCount;
+    pipe.writeSignal();
+    int result3 = mLooper->pollOnce(0);
+
+    EXPECT_EQ(ALOOPER_POLL_CALLBACK, result1)
+            << "pollOnce result should be ALOOPER_POLL_CALLBACK";
+    EXPECT_EQ(1, count1)
+            << "callback should be invoked for the new data";
+    EXPECT_EQ(ALOOPER_POLL_TIMEOUT, result2)
+            << "pollOnce result should be ALOOPER_POLL_TIMEOUT because the undrained data is old";
+    EXPECT_EQ(1, count2)
+            << "callback should not be invoked again for the same data";
+    EXPECT_EQ(ALOOPER_POLL_CALLBACK, result3)
+            << "pollOnce result should be ALOOPER_POLL_CALLBACK";
+    EXPECT_EQ(2, handler.callbackCount)
+            << "callback should be invoked again when more data arrives";
+}
+
+TEST_F(LooperTest, PollOnce_WhenWokenManyTimes_ReturnsWakeOnceThenTimesOut) {
+    for (int i = 0; i < 100; i++) {
+        mLooper->wake();
+    }
+
+    int result1 = mLooper->pollOnce(0);
+    int result2 = mLooper->pollOnce(0);
+
+    EXPECT_EQ(ALOOPER_POLL_WAKE, result1)
+            << "pollOnce result should be ALOOPER_POLL_WAKE";
+    EXPECT_EQ(ALOOPER_POLL_TIMEOUT, result2)
+            << "pollOnce result should be ALOOPER_POLL_TIMEOUT because all wakes were consumed";
+}
+
 TEST_F(LooperTest, SendMessage_WhenOneMessageIsEnqueue_ShouldInvokeHandlerDuringNextPoll) {
     sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessage(handler, Message(MSG_TEST1));
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LruCacheBenchmark"
+
+#include <utils/JenkinsHash.h>
+#include <utils/LruCache.h>
+#include <utils/Timers.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace android {
+
+// Not a correctness test: reports how many get()s, and put()s that evict
+// the oldest entry, per second LruCache does for a few cache sizes.
+class LruCacheBenchmark : public testing::Test {
+protected:
+    enum { OPERATIONS = 1 << 20 };
+
+    static void report(const char* name, size_t entries, size_t ops,
+            nsecs_t duration) {
+        const double seconds = duration / 1e9;
+        printf("%-26s %5u entries %12.0f ops/s\n", name, uint32_t(entries),
+                seconds > 0 ? ops / seconds : 0.0);
+    }
+
+    static uint32_t keyAt(size_t i) {
+        return JenkinsHashWhiten(JenkinsHashMix(0, i));
+    }
+
+    void benchmark(size_t entries) {
+        LruCache<uint32_t, size_t> cache(entries);
+        for (size_t i = 0; i < entries; i++) {
+            cache.put(keyAt(i), i + 1);
+        }
+
+        // all hits, each moving its entry to the young end
+        size_t found = 0;
+        nsecs_t start = systemTime();
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            found += cache.get(keyAt(i % entries)) != 0;
+        }
+        report("LruCache get (hit)", entries, OPERATIONS, systemTime() - start);
+        EXPECT_EQ(size_t(OPERATIONS), found);
+
+        start = systemTime();
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            found += cache.get(keyAt(entries + i)) != 0;
+        }
+        report("LruCache get (miss)", entries, OPERATIONS, systemTime() - start);
+
+        // every put evicts the oldest entry
+        start = systemTime();
+        for (size_t i = 0; i < OPERATIONS; i++) {
+            cache.put(keyAt(entries + i), i + 1);
+        }
+        report("LruCache put (evicting)", entries, OPERATIONS, systemTime() - start);
+        EXPECT_EQ(entries, cache.size());
+    }
+};
+
+TEST_F(LruCacheBenchmark, Small) {
+    benchmark(16);
+}
+
+TEST_F(LruCacheBenchmark, Medium) {
+    benchmark(512);
+}
+
+TEST_F(LruCacheBenchmark, Large) {
+    benchmark(16 * 1024);
+}
+
+} // namespace android
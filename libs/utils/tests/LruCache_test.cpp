@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include <utils/GenerationCache.h>
 #include <utils/JenkinsHash.h>
 #include <utils/LruCache.h>
 #include <cutils/log.h>
@@ -288,4 +289,102 @@ TEST_F(LruCacheTest, CallbackOnClear) {
     EXPECT_EQ(3, callback.callbackCount);
 }
 
+TEST_F(LruCacheTest, RemoveKeepsOtherEntries) {
+    LruCache<SimpleKey, StringValue> cache(100);
+
+    cache.put(1, "one");
+    cache.put(2, "two");
+    cache.put(3, "three");
+    cache.put(4, "four");
+    EXPECT_TRUE(cache.remove(2));
+    EXPECT_FALSE(cache.remove(2));
+    EXPECT_EQ(3u, cache.size());
+    EXPECT_EQ(NULL, cache.get(2));
+    EXPECT_STREQ("four", cache.get(4));
+    EXPECT_STREQ("one", cache.get(1));
+
+    // the recency order survives the removal: 3, 4, 1
+    cache.removeOldest();
+    EXPECT_EQ(NULL, cache.get(3));
+    cache.removeOldest();
+    EXPECT_EQ(NULL, cache.get(4));
+    EXPECT_STREQ("one", cache.get(1));
+}
+
+TEST_F(LruCacheTest, IteratorVisitsEveryEntry) {
+    LruCache<SimpleKey, StringValue> cache(100);
+
+    cache.put(1, "one");
+    cache.put(2, "two");
+    cache.put(3, "three");
+    cache.remove(1);
+
+    int keySum = 0;
+    size_t count = 0;
+    LruCache<SimpleKey, StringValue>::Iterator it(cache);
+    while (it.next()) {
+        keySum += it.key();
+        EXPECT_EQ(it.key(), cache.keyAt(it.index()));
+        count++;
+    }
+    EXPECT_EQ(2u, count);
+    EXPECT_EQ(5, keySum);
+}
+
+TEST_F(LruCacheTest, UnlimitedCapacityGrows) {
+    LruCache<ComplexKey, ComplexValue> cache(ComplexCache::kUnlimitedCapacity);
+
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(cache.put(ComplexKey(i), ComplexValue(i)));
+    }
+    EXPECT_EQ(1000u, cache.size());
+    assertInstanceCount(1000, 1001);
+    for (int i = 0; i < 1000; i += 7) {
+        EXPECT_EQ(i, cache.get(ComplexKey(i)).v);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        EXPECT_TRUE(cache.remove(ComplexKey(i)));
+    }
+    EXPECT_EQ(500u, cache.size());
+    assertInstanceCount(500, 501);
+    for (int i = 1; i < 1000; i += 2) {
+        EXPECT_EQ(i, cache.get(ComplexKey(i)).v);
+    }
+    cache.clear();
+    assertInstanceCount(0, 1);
+}
+
+TEST_F(LruCacheTest, GenerationCacheByIndex) {
+    GenerationCache<SimpleKey, StringValue> cache(2);
+
+    cache.put(1, "one");
+    cache.put(2, "two");
+    EXPECT_TRUE(cache.contains(1));
+    EXPECT_STREQ("one", cache.get(1));
+    cache.put(3, "three");
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_EQ(2u, cache.size());
+
+    int keySum = 0;
+    for (size_t i = 0; i < cache.size(); i++) {
+        keySum += cache.getKeyAt(i);
+        EXPECT_EQ(cache.get(cache.getKeyAt(i)), cache.getValueAt(i));
+    }
+    EXPECT_EQ(4, keySum);
+
+    cache.removeAt(0);
+    EXPECT_EQ(1u, cache.size());
+}
+
+TEST_F(LruCacheTest, GenerationCacheCallbackOnDestruction) {
+    EntryRemovedCallback callback;
+    {
+        GenerationCache<SimpleKey, StringValue> cache(100);
+        cache.setOnEntryRemovedListener(&callback);
+        cache.put(1, "one");
+        cache.put(2, "two");
+    }
+    EXPECT_EQ(2, callback.callbackCount);
+}
+
 }
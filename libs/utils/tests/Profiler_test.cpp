@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "Profiler_test"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <utils/Profiler.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+class ProfilerTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        Profiler::reset();
+        Profiler::setEnabled(true);
+    }
+
+    virtual void TearDown() {
+        Profiler::setEnabled(false);
+    }
+
+    // the dump line of scope, or an empty string
+    static String8 lineOf(const char* scope) {
+        String8 result;
+        Profiler::dump(result);
+        const char* line = strstr(result.string(), scope);
+        if (line == NULL) {
+            return String8();
+        }
+        return String8(line, strcspn(line, "\n"));
+    }
+
+    // count, total and self ms of scope
+    static void stats(const char* scope, unsigned* count, double* total,
+            double* self) {
+        String8 line(lineOf(scope));
+        ASSERT_FALSE(line.isEmpty());
+        ASSERT_EQ(3, sscanf(line.string() + strlen(scope), "%u %lf %lf",
+                count, total, self));
+    }
+};
+
+static void child() {
+    PROFILE_SCOPE("ProfilerTest_child");
+    usleep(2000);
+}
+
+static void parent() {
+    PROFILE_SCOPE("ProfilerTest_parent");
+    usleep(2000);
+    child();
+    child();
+}
+
+TEST_F(ProfilerTest, NestedScopes) {
+    for (int i=0 ; i<3 ; i++) {
+        parent();
+    }
+    unsigned count;
+    double total, self;
+    stats("ProfilerTest_parent", &count, &total, &self);
+    EXPECT_EQ(3U, count);
+    EXPECT_GE(total, 18.0);
+    EXPECT_GE(self, 6.0);
+    EXPECT_LT(self, total - 12.0 + 1.0);
+
+    stats("ProfilerTest_child", &count, &total, &self);
+    EXPECT_EQ(6U, count);
+    EXPECT_GE(total, 12.0);
+    EXPECT_EQ(total, self);
+}
+
+TEST_F(ProfilerTest, SameScopeUnderDifferentParents) {
+    {
+        PROFILE_SCOPE("ProfilerTest_a");
+        PROFILE_SCOPE("ProfilerTest_leaf");
+    }
+    {
+        PROFILE_SCOPE("ProfilerTest_b");
+        PROFILE_SCOPE("ProfilerTest_leaf");
+        PROFILE_SCOPE("ProfilerTest_leaf");
+    }
+    String8 result;
+    Profiler::dump(result);
+    const char* a = strstr(result.string(), "ProfilerTest_a");
+    const char* b = strstr(result.string(), "ProfilerTest_b");
+    ASSERT_TRUE(a != NULL && b != NULL);
+    // one node under a, and two nested ones under b
+    const char* leaf = strstr(a, "ProfilerTest_leaf");
+    ASSERT_TRUE(leaf != NULL);
+    EXPECT_TRUE(leaf < b || b < a);
+    int leaves = 0;
+    for (const char* p = result.string() ;
+            (p = strstr(p, "ProfilerTest_leaf")) != NULL ; p++) {
+        leaves++;
+    }
+    EXPECT_EQ(3, leaves);
+}
+
+TEST_F(ProfilerTest, DisabledRecordsNothing) {
+    Profiler::setEnabled(false);
+    {
+        PROFILE_SCOPE("ProfilerTest_disabled");
+    }
+    EXPECT_TRUE(lineOf("ProfilerTest_disabled").isEmpty());
+}
+
+TEST_F(ProfilerTest, DisabledWhileInScope) {
+    {
+        PROFILE_SCOPE("ProfilerTest_outer");
+        Profiler::setEnabled(false);
+        PROFILE_SCOPE("ProfilerTest_inner");
+    }
+    unsigned count;
+    double total, self;
+    stats("ProfilerTest_outer", &count, &total, &self);
+    EXPECT_EQ(1U, count);
+    EXPECT_TRUE(lineOf("ProfilerTest_inner").isEmpty());
+}
+
+static void* profileOnce(void*) {
+    PROFILE_SCOPE("ProfilerTest_exited");
+    return NULL;
+}
+
+TEST_F(ProfilerTest, ExitedThreadsAreForgotten) {
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, NULL, profileOnce, NULL));
+    ASSERT_EQ(0, pthread_join(thread, NULL));
+    EXPECT_TRUE(lineOf("ProfilerTest_exited").isEmpty());
+}
+
+TEST_F(ProfilerTest, Reset) {
+    child();
+    Profiler::reset();
+    unsigned count;
+    double total, self;
+    stats("ProfilerTest_child", &count, &total, &self);
+    EXPECT_EQ(0U, count);
+    EXPECT_EQ(0.0, total);
+}
+
+}; // namespace android
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PropertyMap_test"
+
+#include <utils/PropertyMap.h>
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace android {
+
+class PropertyMapTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        strcpy(mPath, "/tmp/PropertyMap_test_XXXXXX");
+        mFd = mkstemp(mPath);
+        ASSERT_NE(-1, mFd);
+        mMap = NULL;
+    }
+
+    virtual void TearDown() {
+        delete mMap;
+        close(mFd);
+        unlink(mPath);
+    }
+
+    status_t load(const char* contents) {
+        size_t length = strlen(contents);
+        if (write(mFd, contents, length) != ssize_t(length)) {
+            return UNKNOWN_ERROR;
+        }
+        return PropertyMap::load(String8(mPath), &mMap);
+    }
+
+    char mPath[64];
+    int mFd;
+    PropertyMap* mMap;
+};
+
+TEST_F(PropertyMapTest, Load_ParsesKeysAndValues) {
+    ASSERT_EQ(NO_ERROR, load(
+            "# comment\n"
+            "\n"
+            "touch.deviceType = touchScreen\n"
+            "  cursor.mode=pointer  \n"
+            "touch.size.scale = 1.5\n"
+            "device.internal = 1\n"));
+
+    EXPECT_EQ(4U, mMap->getProperties().size());
+
+    String8 string;
+    EXPECT_TRUE(mMap->tryGetProperty(String8("touch.deviceType"), string));
+    EXPECT_STREQ("touchScreen", string.string());
+    EXPECT_TRUE(mMap->tryGetProperty(String8("cursor.mode"), string));
+    EXPECT_STREQ("pointer", string.string());
+
+    float scale = 0;
+    EXPECT_TRUE(mMap->tryGetProperty(String8("touch.size.scale"), scale));
+    EXPECT_FLOAT_EQ(1.5f, scale);
+
+    bool internal = false;
+    EXPECT_TRUE(mMap->tryGetProperty(String8("device.internal"), internal));
+    EXPECT_TRUE(internal);
+
+    int32_t missing = 42;
+    EXPECT_FALSE(mMap->tryGetProperty(String8("device.missing"), missing));
+    EXPECT_EQ(42, missing);
+}
+
+TEST_F(PropertyMapTest, Load_RejectsDuplicateKey) {
+    EXPECT_EQ(BAD_VALUE, load("a = 1\nb = 2\na = 3\n"));
+    EXPECT_TRUE(mMap == NULL);
+}
+
+TEST_F(PropertyMapTest, Load_RejectsReservedCharacters) {
+    EXPECT_EQ(BAD_VALUE, load("a = \"1\"\n"));
+    EXPECT_TRUE(mMap == NULL);
+}
+
+TEST_F(PropertyMapTest, Load_RejectsTrailingToken) {
+    EXPECT_EQ(BAD_VALUE, load("a = 1 2\n"));
+    EXPECT_TRUE(mMap == NULL);
+}
+
+TEST_F(PropertyMapTest, TryGetInteger_RejectsInvalidValue) {
+    PropertyMap map;
+    map.addProperty(String8("a"), String8("12x"));
+    int32_t value = 7;
+    EXPECT_FALSE(map.tryGetProperty(String8("a"), value));
+    EXPECT_EQ(7, value);
+}
+
+TEST_F(PropertyMapTest, AddAll_ReplacesExistingKeys) {
+    PropertyMap base;
+    base.addProperty(String8("a"), String8("1"));
+    base.addProperty(String8("b"), String8("2"));
+    PropertyMap overlay;
+    overlay.addProperty(String8("b"), String8("3"));
+    overlay.addProperty(String8("c"), String8("4"));
+
+    base.addAll(&overlay);
+    EXPECT_EQ(3U, base.getProperties().size());
+    int32_t value = 0;
+    EXPECT_TRUE(base.tryGetProperty(String8("b"), value));
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(base.tryGetProperty(String8("c"), value));
+    EXPECT_EQ(4, value);
+}
+
+} // namespace android
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RefBase_test"
+
+#include <utils/RefBase.h>
+#include <utils/threads.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+class Foo : public RefBase {
+public:
+    Foo(bool* deleted) : mDeleted(deleted) {
+        *mDeleted = false;
+    }
+
+    ~Foo() {
+        *mDeleted = true;
+    }
+
+    void extendLifetime() {
+        extendObjectLifetime(OBJECT_LIFETIME_WEAK);
+    }
+
+private:
+    bool* mDeleted;
+};
+
+class LightFoo : public VirtualLightRefBase {
+public:
+    LightFoo(bool* deleted) : mDeleted(deleted) {
+        *mDeleted = false;
+    }
+
+    virtual ~LightFoo() {
+        *mDeleted = true;
+    }
+
+private:
+    bool* mDeleted;
+};
+
+class LightBar : public LightFoo {
+public:
+    LightBar(bool* deleted, bool* barDeleted) : LightFoo(deleted),
+            mBarDeleted(barDeleted) {
+        *mBarDeleted = false;
+    }
+
+    virtual ~LightBar() {
+        *mBarDeleted = true;
+    }
+
+private:
+    bool* mBarDeleted;
+};
+
+TEST(RefBaseTest, StrongReferences_HoldASingleWeakReference) {
+    bool deleted;
+    Foo* foo = new Foo(&deleted);
+    {
+        sp<Foo> sp1(foo);
+        sp<Foo> sp2(sp1);
+        sp<Foo> sp3 = sp2;
+        EXPECT_EQ(3, foo->getStrongCount());
+        EXPECT_EQ(1, foo->getWeakRefs()->getWeakCount());
+
+        wp<Foo> wp1(sp1);
+        EXPECT_EQ(2, foo->getWeakRefs()->getWeakCount());
+    }
+    EXPECT_TRUE(deleted);
+}
+
+TEST(RefBaseTest, Promote_WhileStrongReferencesRemain_Succeeds) {
+    bool deleted;
+    sp<Foo> sp1 = new Foo(&deleted);
+    wp<Foo> wp1(sp1);
+
+    sp<Foo> sp2 = wp1.promote();
+    EXPECT_EQ(sp1, sp2);
+    EXPECT_EQ(2, sp1->getStrongCount());
+    EXPECT_EQ(2, sp1->getWeakRefs()->getWeakCount());
+
+    sp2.clear();
+    sp1.clear();
+    EXPECT_TRUE(deleted);
+    EXPECT_TRUE(wp1.promote() == NULL);
+}
+
+TEST(RefBaseTest, Promote_BeforeAnyStrongReference_TakesTheFirstOne) {
+    bool deleted;
+    Foo* foo = new Foo(&deleted);
+    wp<Foo> wp1(foo);
+
+    sp<Foo> sp1 = wp1.promote();
+    ASSERT_TRUE(sp1 != NULL);
+    EXPECT_EQ(1, foo->getStrongCount());
+    EXPECT_EQ(2, foo->getWeakRefs()->getWeakCount());
+
+    sp1.clear();
+    EXPECT_TRUE(deleted);
+}
+
+TEST(RefBaseTest, ExtendedLifetime_IsRevivedFromAWeakReference) {
+    bool deleted;
+    Foo* foo = new Foo(&deleted);
+    foo->extendLifetime();
+    wp<Foo> wp1(foo);
+
+    sp<Foo> sp1(foo);
+    sp1.clear();
+    EXPECT_FALSE(deleted);
+    EXPECT_EQ(1, foo->getWeakRefs()->getWeakCount());
+
+    sp1 = wp1.promote();
+    ASSERT_TRUE(sp1 != NULL);
+    EXPECT_EQ(2, foo->getWeakRefs()->getWeakCount());
+    sp1.clear();
+
+    wp1.clear();
+    EXPECT_TRUE(deleted);
+}
+
+TEST(RefBaseTest, VirtualLightRefBase_DeletesThroughTheBaseClass) {
+    bool fooDeleted, barDeleted;
+    {
+        sp<LightFoo> foo = new LightBar(&fooDeleted, &barDeleted);
+        sp<LightFoo> foo2(foo);
+        EXPECT_EQ(2, foo->getStrongCount());
+    }
+    EXPECT_TRUE(fooDeleted);
+    EXPECT_TRUE(barDeleted);
+}
+
+class PromoteThread : public Thread {
+public:
+    PromoteThread(const wp<Foo>& foo) : Thread(false), mFoo(foo) { }
+
+private:
+    virtual bool threadLoop() {
+        for (int i = 0; i < 100000; i++) {
+            sp<Foo> foo = mFoo.promote();
+            if (foo == NULL) {
+                break;
+            }
+            sp<Foo> copy(foo);
+        }
+        return false;
+    }
+
+    wp<Foo> mFoo;
+};
+
+TEST(RefBaseTest, Concurrent_PromoteAndCopy_DeletesOnce) {
+    const int N = 4;
+    bool deleted;
+    sp<Foo> foo = new Foo(&deleted);
+    sp<Thread> threads[N];
+    for (int i = 0; i < N; i++) {
+        threads[i] = new PromoteThread(foo);
+        threads[i]->run("PromoteThread");
+    }
+    for (int i = 0; i < N; i++) {
+        threads[i]->join();
+    }
+
+    EXPECT_EQ(1, foo->getStrongCount());
+    foo.clear();
+    EXPECT_TRUE(deleted);
+}
+
+} // namespace android
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SharedBuffer_test"
+
+#include <pthread.h>
+#include <string.h>
+
+#include <utils/SharedBuffer.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+static SharedBuffer* allocFilled(size_t size, char c) {
+    SharedBuffer* sb = SharedBuffer::alloc(size);
+    memset(sb->data(), c, size);
+    return sb;
+}
+
+static bool isFilled(const SharedBuffer* sb, size_t size, char c) {
+    const char* data = static_cast<const char*>(sb->data());
+    for (size_t i=0 ; i<size ; i++) {
+        if (data[i] != c) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(SharedBufferTest, ResizeKeepsContents) {
+    // grows through and past the small sizes, then shrinks back
+    SharedBuffer* sb = allocFilled(1, 'a');
+    size_t size = 1;
+    for (size_t newSize = 2 ; newSize <= 4096 ; newSize *= 2) {
+        sb = sb->editResize(newSize);
+        ASSERT_TRUE(sb != NULL);
+        EXPECT_EQ(newSize, sb->size());
+        EXPECT_TRUE(isFilled(sb, size, 'a'));
+        memset(sb->data(), 'a', newSize);
+        size = newSize;
+    }
+    for (size_t newSize = 2048 ; newSize >= 1 ; newSize /= 2) {
+        sb = sb->editResize(newSize);
+        ASSERT_TRUE(sb != NULL);
+        EXPECT_EQ(newSize, sb->size());
+        EXPECT_TRUE(isFilled(sb, newSize, 'a'));
+    }
+    sb->release();
+}
+
+TEST(SharedBufferTest, EditCopiesSharedBuffers) {
+    SharedBuffer* sb = allocFilled(24, 'b');
+    sb->acquire();
+    SharedBuffer* copy = sb->editResize(40);
+    ASSERT_TRUE(copy != NULL);
+    EXPECT_NE(sb, copy);
+    EXPECT_TRUE(isFilled(copy, 24, 'b'));
+    EXPECT_TRUE(sb->onlyOwner());
+    EXPECT_TRUE(isFilled(sb, 24, 'b'));
+    copy->release();
+    sb->release();
+}
+
+TEST(SharedBufferTest, KeepStorage) {
+    SharedBuffer* sb = allocFilled(8, 'c');
+    EXPECT_EQ(1, sb->release(SharedBuffer::eKeepStorage));
+    EXPECT_EQ(0, SharedBuffer::dealloc(sb));
+}
+
+TEST(SharedBufferTest, StatsCountPooledBuffers) {
+    SharedBuffer::Stats before;
+    if (!SharedBuffer::getStats(&before)) {
+        // built without SHARED_BUFFER_POOL
+        EXPECT_EQ(0U, before.allocs);
+        return;
+    }
+    // the second round reuses the buffers the first one released
+    for (int round=0 ; round<2 ; round++) {
+        SharedBuffer* buffers[8];
+        for (int i=0 ; i<8 ; i++) {
+            buffers[i] = allocFilled(SharedBuffer::MAX_POOLED_SIZE, 'd');
+        }
+        for (int i=0 ; i<8 ; i++) {
+            buffers[i]->release();
+        }
+    }
+    SharedBuffer::Stats after;
+    ASSERT_TRUE(SharedBuffer::getStats(&after));
+    EXPECT_EQ(16U, after.allocs - before.allocs);
+    EXPECT_LE(8U, after.pooledAllocs - before.pooledAllocs);
+    EXPECT_EQ(16U, after.frees - before.frees);
+    EXPECT_EQ(16U, after.pooledFrees - before.pooledFrees);
+    EXPECT_GE(8U, after.heapCalls() - before.heapCalls());
+
+    // too large for the pool
+    SharedBuffer::alloc(SharedBuffer::MAX_POOLED_SIZE + 1)->release();
+    SharedBuffer::getStats(&before);
+    EXPECT_EQ(after.pooledFrees, before.pooledFrees);
+    EXPECT_EQ(after.heapCalls() + 2, before.heapCalls());
+}
+
+static void* releaseBuffer(void* arg) {
+    static_cast<SharedBuffer*>(arg)->release();
+    // and reuse it, or another one, from this thread's cache
+    SharedBuffer* sb = allocFilled(16, 'f');
+    sb->release();
+    return NULL;
+}
+
+TEST(SharedBufferTest, ReleaseOnAnotherThread) {
+    SharedBuffer* sb = allocFilled(16, 'e');
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, NULL, releaseBuffer, sb));
+    pthread_join(thread, NULL);
+
+    SharedBuffer::Stats stats;
+    if (SharedBuffer::getStats(&stats)) {
+        // the thread's counts outlive it
+        EXPECT_LE(2U, stats.frees);
+    }
+}
+
+} // namespace android
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "String8Builder_test"
+#include <utils/Log.h>
+#include <utils/String8Builder.h>
+
+#include <gtest/gtest.h>
+
+namespace android {
+
+TEST(String8BuilderTest, StartsEmpty) {
+    String8Builder builder;
+    EXPECT_TRUE(builder.isEmpty());
+    EXPECT_STREQ("", builder.string());
+    EXPECT_STREQ("", builder.release().string());
+}
+
+TEST(String8BuilderTest, Append) {
+    String8Builder builder;
+    builder.append("Hello");
+    builder.append(',');
+    builder.append(String8(" world"));
+    builder.append("!!!", 1);
+    EXPECT_STREQ("Hello, world!", builder.string());
+    EXPECT_EQ(13U, builder.size());
+}
+
+TEST(String8BuilderTest, GrowsGeometrically) {
+    String8Builder builder;
+    size_t reallocations = 0;
+    const char* data = builder.string();
+    for (int i=0 ; i<10000 ; i++) {
+        builder.append("x");
+        if (builder.string() != data) {
+            data = builder.string();
+            reallocations++;
+        }
+    }
+    EXPECT_EQ(10000U, builder.size());
+    EXPECT_LE(reallocations, 10U);
+}
+
+TEST(String8BuilderTest, Reserve) {
+    String8Builder builder;
+    ASSERT_EQ(NO_ERROR, builder.reserve(1000));
+    EXPECT_GE(builder.capacity(), 1000U);
+    const char* data = builder.string();
+    for (int i=0 ; i<100 ; i++) {
+        builder.appendFormat("%d:%s;", i, "abcdef");
+    }
+    EXPECT_EQ(data, builder.string());
+}
+
+TEST(String8BuilderTest, AppendFormat) {
+    String8Builder builder;
+    builder.appendFormat("%s=%d", "answer", 42);
+    builder.appendFormat(" %s", "");
+    builder.appendFormat("[%5.2f]", 3.14159);
+    EXPECT_STREQ("answer=42 [ 3.14]", builder.string());
+
+    // longer than the spare capacity
+    String8 longArg;
+    for (int i=0 ; i<1000 ; i++) {
+        longArg.append("y");
+    }
+    builder.appendFormat("<%s>", longArg.string());
+    EXPECT_EQ(17U + 1002U, builder.size());
+    EXPECT_EQ('>', builder.string()[builder.size() - 1]);
+    EXPECT_EQ('<', builder.string()[17]);
+}
+
+TEST(String8BuilderTest, StackStorage) {
+    StackString8Builder<16> builder;
+    const char* stack = builder.string();
+    builder.append("0123456789");
+    builder.appendFormat("%05d", 42);
+    EXPECT_STREQ("012345678900042", builder.string());
+    EXPECT_EQ(stack, builder.string());
+
+    // spills to the heap
+    builder.appendFormat("%s", "abc");
+    EXPECT_STREQ("012345678900042abc", builder.string());
+    EXPECT_NE(stack, builder.string());
+
+    String8 result(builder.release());
+    EXPECT_STREQ("012345678900042abc", result.string());
+    EXPECT_EQ(18U, result.length());
+
+    // back on the stack
+    EXPECT_TRUE(builder.isEmpty());
+    EXPECT_EQ(stack, builder.string());
+    builder.append("again");
+    EXPECT_STREQ("again", builder.toString8().string());
+}
+
+TEST(String8BuilderTest, ReleaseAdoptsBuffer) {
+    String8Builder builder;
+    builder.append("some text that lives on the heap");
+    String8 result(builder.release());
+    EXPECT_STREQ("some text that lives on the heap", result.string());
+    EXPECT_EQ(32U, result.length());
+    EXPECT_TRUE(builder.isEmpty());
+
+    // the String8 is an ordinary one
+    result.append("!");
+    EXPECT_STREQ("some text that lives on the heap!", result.string());
+}
+
+TEST(String8BuilderTest, Clear) {
+    String8Builder builder;
+    builder.append("abc");
+    const size_t capacity = builder.capacity();
+    builder.clear();
+    EXPECT_STREQ("", builder.string());
+    EXPECT_EQ(capacity, builder.capacity());
+}
+
+TEST(String8BuilderTest, String8AppendFormat) {
+    String8 s("a");
+    s.appendFormat("%d%s", 1, "b");
+    EXPECT_STREQ("a1b", s.string());
+
+    // past the stack buffer
+    String8 longArg;
+    for (int i=0 ; i<300 ; i++) {
+        longArg.append("z");
+    }
+    s.appendFormat("%s.", longArg.string());
+    EXPECT_EQ(304U, s.length());
+    EXPECT_EQ('.', s.string()[303]);
+}
+
+}; // namespace android
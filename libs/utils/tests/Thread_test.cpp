@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "Thread_test"
+
+#include <sched.h>
+
+#include <utils/threads.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+// Records the CPUs it is allowed on by the time readyToRun() is called.
+class AffinityThread : public Thread {
+public:
+    AffinityThread() : Thread(false), mCpuCount(-1), mOnCpu0(false), mReady(false) { }
+
+    void waitUntilReady() {
+        Mutex::Autolock _l(mReadyLock);
+        while (!mReady) {
+            mReadyCondition.wait(mReadyLock);
+        }
+    }
+
+    int mCpuCount;
+    bool mOnCpu0;
+
+private:
+    virtual status_t readyToRun() {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+            mCpuCount = CPU_COUNT(&cpus);
+            mOnCpu0 = CPU_ISSET(0, &cpus);
+        }
+        Mutex::Autolock _l(mReadyLock);
+        mReady = true;
+        mReadyCondition.broadcast();
+        return NO_ERROR;
+    }
+
+    virtual bool threadLoop() {
+        return false;
+    }
+
+    Mutex mReadyLock;
+    Condition mReadyCondition;
+    bool mReady;
+};
+
+class ThreadTest : public testing::Test {
+};
+
+TEST_F(ThreadTest, RunWithCpuMask_PinsThreadBeforeReadyToRun) {
+    sp<AffinityThread> thread = new AffinityThread();
+    android_thread_sched_t sched = ANDROID_THREAD_SCHED_INITIALIZER;
+    sched.cpuMask = 0x1;
+
+    EXPECT_EQ(NO_ERROR, thread->run("AffinityThread", PRIORITY_DEFAULT, 0, sched));
+    thread->waitUntilReady();
+    EXPECT_EQ(1, thread->mCpuCount);
+    EXPECT_TRUE(thread->mOnCpu0);
+    thread->join();
+}
+
+TEST_F(ThreadTest, RunWithDefaultSched_InheritsAffinity) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof(cpus), &cpus));
+
+    sp<AffinityThread> thread = new AffinityThread();
+    android_thread_sched_t sched = ANDROID_THREAD_SCHED_INITIALIZER;
+
+    EXPECT_EQ(NO_ERROR, thread->run("AffinityThread", PRIORITY_DEFAULT, 0, sched));
+    thread->waitUntilReady();
+    EXPECT_EQ(CPU_COUNT(&cpus), thread->mCpuCount);
+    thread->join();
+}
+
+TEST_F(ThreadTest, SetThreadScheduling_WithDefaults_DoesNothing) {
+    android_thread_sched_t sched = ANDROID_THREAD_SCHED_INITIALIZER;
+    EXPECT_EQ(0, androidSetThreadScheduling(0, &sched));
+}
+
+} // namespace android
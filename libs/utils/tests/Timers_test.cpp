@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "Timers_test"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <utils/Timers.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+TEST(TimersTest, MonotonicMatchesClockGettime) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    const nsecs_t before = nsecs_t(t.tv_sec) * 1000000000LL + t.tv_nsec;
+    const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    const nsecs_t after = nsecs_t(t.tv_sec) * 1000000000LL + t.tv_nsec;
+    EXPECT_LE(before, now);
+    EXPECT_GE(after, now);
+}
+
+TEST(TimersTest, MonotonicNeverGoesBack) {
+    nsecs_t last = systemTime(SYSTEM_TIME_MONOTONIC);
+    for (int i=0 ; i<100000 ; i++) {
+        const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+        ASSERT_LE(last, now);
+        last = now;
+    }
+}
+
+TEST(TimersTest, CoarseIsCloseToMonotonic) {
+    const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    const nsecs_t coarse = systemTime(SYSTEM_TIME_MONOTONIC_COARSE);
+    // within a few ticks, whatever HZ is
+    EXPECT_LT(llabs(now - coarse), ms2ns(50));
+}
+
+TEST(TimersTest, ProfilingTimeFollowsMonotonic) {
+    const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    const nsecs_t profilingStart = profilingTime();
+    usleep(50000);
+    const nsecs_t elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+    const nsecs_t profilingElapsed = profilingTime() - profilingStart;
+    EXPECT_GT(profilingElapsed, elapsed * 9 / 10);
+    EXPECT_LT(profilingElapsed, elapsed * 11 / 10);
+}
+
+} // namespace android
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TraceBuffer_test"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <utils/String8.h>
+#include <utils/TraceBuffer.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+class TraceBufferTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        TraceBuffer::setEnabled(true);
+    }
+
+    virtual void TearDown() {
+        TraceBuffer::setEnabled(false);
+    }
+
+    // Drains the trace buffer and returns what it wrote.
+    String8 drain() {
+        FILE* f = tmpfile();
+        EXPECT_TRUE(f != NULL);
+        EXPECT_EQ(NO_ERROR, TraceBuffer::drain(fileno(f)));
+        String8 result;
+        char buf[1024];
+        rewind(f);
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            result.append(buf, n);
+        }
+        fclose(f);
+        return result;
+    }
+
+    static size_t countOf(const String8& s, const char* needle) {
+        size_t count = 0;
+        for (const char* p = strstr(s.string(), needle); p != NULL;
+                p = strstr(p + 1, needle)) {
+            count++;
+        }
+        return count;
+    }
+};
+
+TEST_F(TraceBufferTest, DrainWritesBeginAndEndMarkers) {
+    TraceBuffer::begin("outer");
+    TraceBuffer::begin("inner");
+    TraceBuffer::end();
+    TraceBuffer::end();
+
+    String8 trace(drain());
+    String8 outer(String8::format("tracing_mark_write: B|%d|outer\n", getpid()));
+    String8 inner(String8::format("tracing_mark_write: B|%d|inner\n", getpid()));
+    const char* o = strstr(trace.string(), outer.string());
+    const char* i = strstr(trace.string(), inner.string());
+    ASSERT_TRUE(o != NULL);
+    ASSERT_TRUE(i != NULL);
+    EXPECT_LT(o, i);
+    EXPECT_EQ(2U, countOf(trace, "tracing_mark_write: E\n"));
+}
+
+TEST_F(TraceBufferTest, DrainForgetsDrainedEvents) {
+    TraceBuffer::begin("once");
+    TraceBuffer::end();
+
+    EXPECT_EQ(1U, countOf(drain(), "|once\n"));
+    EXPECT_EQ(0U, countOf(drain(), "|once\n"));
+}
+
+TEST_F(TraceBufferTest, EnablingForgetsEarlierEvents) {
+    TraceBuffer::begin("stale");
+    TraceBuffer::end();
+    TraceBuffer::setEnabled(true);
+
+    EXPECT_EQ(0U, countOf(drain(), "|stale\n"));
+}
+
+TEST_F(TraceBufferTest, FullRingKeepsNewestEvents) {
+    TraceBuffer::begin("oldest");
+    for (size_t i = 0; i < TraceBuffer::RING_CAPACITY; i++) {
+        TraceBuffer::begin("newer");
+    }
+
+    String8 trace(drain());
+    EXPECT_EQ(0U, countOf(trace, "|oldest\n"));
+    EXPECT_EQ(size_t(TraceBuffer::RING_CAPACITY), countOf(trace, "|newer\n"));
+}
+
+TEST_F(TraceBufferTest, LongNamesAreTruncated) {
+    char name[TraceBuffer::MAX_NAME_LENGTH * 2];
+    memset(name, 'x', sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    TraceBuffer::begin(name);
+
+    String8 expected("|");
+    expected.append(name, TraceBuffer::MAX_NAME_LENGTH - 1);
+    expected.append("\n");
+    EXPECT_EQ(1U, countOf(drain(), expected.string()));
+}
+
+} // namespace android
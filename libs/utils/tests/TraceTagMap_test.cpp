@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TraceTagMap_test"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <utils/String8.h>
+#include <utils/TraceTagMap.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+static int sChanges;
+
+static void countChange() {
+    sChanges++;
+}
+
+class TraceTagMapTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        const char* tmpdir = getenv("TMPDIR");
+        mPath = String8::format("%s/TraceTagMap_test.%d",
+                tmpdir ? tmpdir : "/data/local/tmp", getpid());
+        unlink(mPath.string());
+        sChanges = 0;
+        TraceTagMap::detach();
+        TraceTagMap::setChangeCallback(countChange);
+    }
+
+    virtual void TearDown() {
+        TraceTagMap::setChangeCallback(NULL);
+        TraceTagMap::detach();
+        unlink(mPath.string());
+    }
+
+    String8 mPath;
+};
+
+TEST_F(TraceTagMapTest, AttachFailsUntilPublished) {
+    EXPECT_NE(NO_ERROR, TraceTagMap::attach(mPath.string()));
+    EXPECT_FALSE(TraceTagMap::isAttached());
+    EXPECT_EQ(0ULL, TraceTagMap::getTags());
+
+    ASSERT_EQ(NO_ERROR, TraceTagMap::publish(0x1234, mPath.string()));
+    ASSERT_EQ(NO_ERROR, TraceTagMap::attach(mPath.string()));
+    EXPECT_TRUE(TraceTagMap::isAttached());
+    EXPECT_EQ(0x1234ULL, TraceTagMap::getTags());
+}
+
+TEST_F(TraceTagMapTest, SyncCallsBackOncePerPublish) {
+    ASSERT_EQ(NO_ERROR, TraceTagMap::publish(0, mPath.string()));
+    ASSERT_EQ(NO_ERROR, TraceTagMap::attach(mPath.string()));
+
+    // what was published before attaching isn't a change
+    TraceTagMap::sync();
+    EXPECT_EQ(0, sChanges);
+
+    ASSERT_EQ(NO_ERROR, TraceTagMap::publish(0x8000000000000002ULL,
+            mPath.string()));
+    TraceTagMap::sync();
+    EXPECT_EQ(1, sChanges);
+    TraceTagMap::sync();
+    EXPECT_EQ(1, sChanges);
+    EXPECT_EQ(0x8000000000000002ULL, TraceTagMap::getTags());
+
+    ASSERT_EQ(NO_ERROR, TraceTagMap::publish(0, mPath.string()));
+    TraceTagMap::sync();
+    EXPECT_EQ(2, sChanges);
+    EXPECT_EQ(0ULL, TraceTagMap::getTags());
+}
+
+TEST_F(TraceTagMapTest, SyncIgnoresPublishesAfterDetach) {
+    ASSERT_EQ(NO_ERROR, TraceTagMap::publish(1, mPath.string()));
+    ASSERT_EQ(NO_ERROR, TraceTagMap::attach(mPath.string()));
+    TraceTagMap::detach();
+
+    ASSERT_EQ(NO_ERROR, TraceTagMap::publish(2, mPath.string()));
+    TraceTagMap::sync();
+    EXPECT_EQ(0, sChanges);
+}
+
+TEST_F(TraceTagMapTest, GetTagsSurvivesAnUnfinishedPublish) {
+    ASSERT_EQ(NO_ERROR, TraceTagMap::publish(0x42, mPath.string()));
+    ASSERT_EQ(NO_ERROR, TraceTagMap::attach(mPath.string()));
+    EXPECT_EQ(0x42ULL, TraceTagMap::getTags());
+
+    // a publisher that died after making the generation odd
+    int fd = open(mPath.string(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    int32_t* header = static_cast<int32_t*>(mmap(NULL, 4 * sizeof(int32_t),
+            PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    close(fd);
+    ASSERT_NE(MAP_FAILED, header);
+    header[1]++;
+    header[2] = 0x43;
+    EXPECT_EQ(0x42ULL, TraceTagMap::getTags());
+    munmap(header, 4 * sizeof(int32_t));
+
+    // the next publish completes
+    ASSERT_EQ(NO_ERROR, TraceTagMap::publish(0x44, mPath.string()));
+    EXPECT_EQ(0x44ULL, TraceTagMap::getTags());
+}
+
+} // namespace android
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "UnicodeBenchmark"
+
+#include <utils/String8.h>
+#include <utils/String16.h>
+#include <utils/Timers.h>
+#include <utils/Unicode.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+namespace android {
+
+// Not a correctness test: these report how many UTF-8 bytes per second go
+// through each conversion, for ASCII like interface descriptors and paths,
+// and for text with some or only multi-byte characters.
+class UnicodeBenchmark : public testing::Test {
+protected:
+    enum { ITERATIONS = 1 << 16 };
+
+    static void report(const char* name, const char* text, size_t bytes,
+            nsecs_t duration) {
+        const double seconds = duration / 1e9;
+        printf("%-24s %-8s %10.1f MB/s\n", name, text,
+                seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+    }
+
+    void benchmark(const char* text, const char* u8str) {
+        const size_t u8len = strlen(u8str);
+        const ssize_t u16len = utf8_to_utf16_length((const uint8_t*) u8str, u8len);
+        ASSERT_GT(u16len, 0);
+        char16_t* u16str = new char16_t[u16len + 1];
+        char* back = new char[u8len + 1];
+        size_t total = 0;
+
+        nsecs_t start = systemTime();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            total += utf8_to_utf16_length((const uint8_t*) u8str, u8len);
+        }
+        report("utf8_to_utf16_length", text, u8len * ITERATIONS, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            utf8_to_utf16((const uint8_t*) u8str, u8len, u16str);
+        }
+        report("utf8_to_utf16", text, u8len * ITERATIONS, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            total += utf16_to_utf8_length(u16str, u16len);
+        }
+        report("utf16_to_utf8_length", text, u8len * ITERATIONS, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            utf16_to_utf8(u16str, u16len, back);
+        }
+        report("utf16_to_utf8", text, u8len * ITERATIONS, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            total += utf8_length(u8str);
+        }
+        report("utf8_length", text, u8len * ITERATIONS, systemTime() - start);
+
+        start = systemTime();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            total += String8(String16(u8str)).size();
+        }
+        report("String8(String16())", text, u8len * ITERATIONS, systemTime() - start);
+
+        EXPECT_STREQ(u8str, back);
+        EXPECT_GT(total, 0U);
+        delete[] u16str;
+        delete[] back;
+    }
+};
+
+TEST_F(UnicodeBenchmark, ASCII) {
+    benchmark("ascii", "android.content.pm.IPackageManager");
+    benchmark("ascii", "/data/app/com.example.android.apis-1/base.apk");
+}
+
+TEST_F(UnicodeBenchmark, MultiByte) {
+    benchmark("latin", "Caf\xC3\xA9 cr\xC3\xA8me br\xC3\xBBl\xC3\xA9\x65 \xC3\xA0 la carte");
+    benchmark("cjk", "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE3\x83\x86"
+            "\xE3\x82\xAD\xE3\x82\xB9\xE3\x83\x88");
+}
+
+}; // namespace android
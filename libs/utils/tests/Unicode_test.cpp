@@ -112,4 +112,68 @@ TEST_F(UnicodeTest, UTF8toUTF16Normal) {
             << "should be NULL terminated";
 }
 
+
+// Builds "<prefix ASCII bytes>U+00E9<suffix ASCII bytes>" at an offset into
+// a buffer, so the ASCII runs start and end at every word alignment.
+static size_t buildMixedUTF8(uint8_t* buf, size_t prefix, size_t suffix) {
+    size_t len = 0;
+    for (size_t i = 0; i < prefix; i++) {
+        buf[len++] = 'a' + i % 26;
+    }
+    buf[len++] = 0xC3;
+    buf[len++] = 0xA9;
+    for (size_t i = 0; i < suffix; i++) {
+        buf[len++] = 'A' + i % 26;
+    }
+    buf[len] = 0;
+    return len;
+}
+
+TEST_F(UnicodeTest, ASCIIRunsAroundNonASCII_ConvertAtAnyAlignment) {
+    uint8_t u8buf[64];
+    char16_t u16buf[64];
+    char back[64];
+
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t prefix = 0; prefix < 20; prefix++) {
+            const size_t suffix = 23 - prefix;
+            uint8_t* u8str = u8buf + offset;
+            const size_t u8len = buildMixedUTF8(u8str, prefix, suffix);
+            const size_t u16len = prefix + 1 + suffix;
+
+            ASSERT_EQ(ssize_t(u16len), utf8_to_utf16_length(u8str, u8len))
+                    << "offset " << offset << " prefix " << prefix;
+            ASSERT_EQ(ssize_t(u8len), utf8_length((const char*) u8str))
+                    << "offset " << offset << " prefix " << prefix;
+
+            char16_t* u16str = u16buf + offset % 4;
+            utf8_to_utf16(u8str, u8len, u16str);
+            for (size_t i = 0; i < u16len; i++) {
+                char16_t expected = i < prefix ? 'a' + i % 26 :
+                        i == prefix ? 0xE9 : 'A' + (i - prefix - 1) % 26;
+                ASSERT_EQ(expected, u16str[i])
+                        << "offset " << offset << " prefix " << prefix << " at " << i;
+            }
+            EXPECT_EQ(0, u16str[u16len]);
+
+            ASSERT_EQ(ssize_t(u8len), utf16_to_utf8_length(u16str, u16len))
+                    << "offset " << offset << " prefix " << prefix;
+            utf16_to_utf8(u16str, u16len, back);
+            EXPECT_STREQ((const char*) u8str, back)
+                    << "offset " << offset << " prefix " << prefix;
+        }
+    }
+}
+
+TEST_F(UnicodeTest, UTF16toUTF8SurrogatePairAfterASCII) {
+    const char16_t str[] = { 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i',
+            0xD800, 0xDC00, 'j' };
+    const size_t len = sizeof(str) / sizeof(str[0]);
+    char out[16];
+
+    EXPECT_EQ(9 + 4 + 1, utf16_to_utf8_length(str, len));
+    utf16_to_utf8(str, len, out);
+    EXPECT_STREQ("abcdefghi\xF0\x90\x80\x80j", out);
+}
+
 }
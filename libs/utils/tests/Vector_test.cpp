@@ -16,6 +16,8 @@
 
 #define LOG_TAG "Vector_test"
 
+#include <utils/RefBase.h>
+#include <utils/String8.h>
 #include <utils/Vector.h>
 #include <cutils/log.h>
 #include <gtest/gtest.h>
@@ -23,6 +25,25 @@
 
 namespace android {
 
+// counts its instances and how often it was copied
+struct Counted {
+    static int instances;
+    static int copies;
+
+    int value;
+
+    Counted() : value(0) { instances++; }
+    Counted(int v) : value(v) { instances++; }
+    Counted(const Counted& o) : value(o.value) { instances++; copies++; }
+    ~Counted() { instances--; }
+};
+
+int Counted::instances = 0;
+int Counted::copies = 0;
+
+class Thing : public RefBase {
+};
+
 class VectorTest : public testing::Test {
 protected:
     virtual void SetUp() {
@@ -71,5 +92,65 @@ TEST_F(VectorTest, CopyOnWrite_CopyAndAddElements) {
     EXPECT_EQ(other[3], 5);
 }
 
+TEST_F(VectorTest, Grow_WhenStorageIsNotShared_KeepsTheStrongCounts) {
+    sp<Thing> thing = new Thing();
+    Vector< sp<Thing> > vector;
+    for (int i = 0; i < 100; i++) {
+        vector.insertAt(thing, 0);
+        EXPECT_EQ(i + 2, thing->getStrongCount());
+    }
+    vector.setCapacity(1000);
+    EXPECT_EQ(101, thing->getStrongCount());
+    vector.removeItemsAt(10, 80);
+    EXPECT_EQ(21, thing->getStrongCount());
+    vector.clear();
+    EXPECT_EQ(1, thing->getStrongCount());
+}
+
+TEST_F(VectorTest, Grow_WhenStorageIsShared_LeavesTheOtherVectorIntact) {
+    Vector<String8> vector;
+    vector.add(String8("a"));
+    vector.add(String8("b"));
+    Vector<String8> other(vector);
+
+    for (int i = 0; i < 20; i++) {
+        vector.insertAt(String8("c"), 1);
+    }
+    vector.removeItemsAt(0, 21);
+
+    ASSERT_EQ(2U, other.size());
+    EXPECT_STREQ("a", other[0].string());
+    EXPECT_STREQ("b", other[1].string());
+    ASSERT_EQ(1U, vector.size());
+    EXPECT_STREQ("b", vector[0].string());
+}
+
+TEST_F(VectorTest, GrowAndShrink_DestroyEveryItemOnce) {
+    {
+        Vector<Counted> vector;
+        for (int i = 0; i < 50; i++) {
+            vector.insertAt(Counted(i), i / 2);
+        }
+        EXPECT_EQ(50, Counted::instances);
+        vector.removeItemsAt(5, 40);
+        EXPECT_EQ(10, Counted::instances);
+        vector.setCapacity(100);
+        EXPECT_EQ(10, Counted::instances);
+    }
+    EXPECT_EQ(0, Counted::instances);
+}
+
+TEST_F(VectorTest, Emplace_ConstructsTheItemInPlace) {
+    Vector<Counted> vector;
+    vector.setCapacity(2);
+    Counted::copies = 0;
+    vector.emplace().value = 1;
+    vector.emplaceAt(1).value = 2;
+
+    ASSERT_EQ(2U, vector.size());
+    EXPECT_EQ(1, vector[0].value);
+    EXPECT_EQ(2, vector[1].value);
+    EXPECT_EQ(0, Counted::copies);
+}
 
 } // namespace android
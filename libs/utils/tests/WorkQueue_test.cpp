@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "WorkQueue_test"
+
+#include <utils/WorkQueue.h>
+#include <cutils/atomic.h>
+#include <gtest/gtest.h>
+
+namespace android {
+
+// Blocks the work units waiting on it until it is opened.
+class Gate {
+public:
+    Gate() : mOpen(false), mWaiting(0) { }
+
+    void wait() {
+        AutoMutex _l(mLock);
+        mWaiting += 1;
+        mCondition.broadcast();
+        while (!mOpen) {
+            mCondition.wait(mLock);
+        }
+    }
+
+    void waitForWaiters(int count) {
+        AutoMutex _l(mLock);
+        while (mWaiting < count) {
+            mCondition.wait(mLock);
+        }
+    }
+
+    void open() {
+        AutoMutex _l(mLock);
+        mOpen = true;
+        mCondition.broadcast();
+    }
+
+private:
+    Mutex mLock;
+    Condition mCondition;
+    bool mOpen;
+    int mWaiting;
+};
+
+class GateWorkUnit : public WorkQueue::WorkUnit {
+public:
+    GateWorkUnit(Gate* gate) : mGate(gate) { }
+
+    virtual bool run() {
+        mGate->wait();
+        return true;
+    }
+
+private:
+    Gate* mGate;
+};
+
+class CountingWorkUnit : public WorkQueue::WorkUnit {
+public:
+    CountingWorkUnit(volatile int32_t* count) : mCount(count) { }
+
+    virtual bool run() {
+        android_atomic_inc(mCount);
+        return true;
+    }
+
+private:
+    volatile int32_t* mCount;
+};
+
+// Records the order the work units ran in.
+class RecordingWorkUnit : public WorkQueue::WorkUnit {
+public:
+    RecordingWorkUnit(Vector<int>* order, int id) : mOrder(order), mId(id) { }
+
+    virtual bool run() {
+        mOrder->add(mId);
+        return true;
+    }
+
+private:
+    Vector<int>* mOrder;
+    int mId;
+};
+
+// Schedules children from its own thread, then waits until they have run.
+class ParentWorkUnit : public WorkQueue::WorkUnit {
+public:
+    ParentWorkUnit(WorkQueue* queue, int children, volatile int32_t* count) :
+            mQueue(queue), mChildren(children), mCount(count) { }
+
+    virtual bool run() {
+        for (int i = 0; i < mChildren; i++) {
+            EXPECT_EQ(OK, mQueue->schedule(new CountingWorkUnit(mCount), 0));
+        }
+        while (android_atomic_acquire_load(mCount) < mChildren) {
+            usleep(1000);
+        }
+        return true;
+    }
+
+private:
+    WorkQueue* mQueue;
+    int mChildren;
+    volatile int32_t* mCount;
+};
+
+TEST(WorkQueueTest, Finish_RunsAllTheWorkUnits) {
+    volatile int32_t count = 0;
+    WorkQueue queue(4, false);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(OK, queue.schedule(new CountingWorkUnit(&count)));
+    }
+    ASSERT_EQ(OK, queue.finish());
+
+    EXPECT_EQ(1000, count);
+    CountingWorkUnit* workUnit = new CountingWorkUnit(&count);
+    EXPECT_EQ(INVALID_OPERATION, queue.schedule(workUnit));
+    delete workUnit;
+}
+
+TEST(WorkQueueTest, HigherPriorityWorkUnitsRunFirst) {
+    Gate gate;
+    Vector<int> order;
+    WorkQueue queue(1, false);
+    ASSERT_EQ(OK, queue.schedule(new GateWorkUnit(&gate), 0));
+    gate.waitForWaiters(1);
+
+    queue.schedule(new RecordingWorkUnit(&order, 3), 0, WorkQueue::WORK_PRIORITY_LOW);
+    queue.schedule(new RecordingWorkUnit(&order, 2), 0, WorkQueue::WORK_PRIORITY_NORMAL);
+    queue.schedule(new RecordingWorkUnit(&order, 1), 0, WorkQueue::WORK_PRIORITY_HIGH);
+    queue.schedule(new RecordingWorkUnit(&order, 4), 0, WorkQueue::WORK_PRIORITY_LOW);
+    gate.open();
+    ASSERT_EQ(OK, queue.finish());
+
+    ASSERT_EQ(4U, order.size());
+    EXPECT_EQ(1, order[0]);
+    EXPECT_EQ(2, order[1]);
+    EXPECT_EQ(3, order[2]);
+    EXPECT_EQ(4, order[3]);
+}
+
+TEST(WorkQueueTest, TrySchedule_WhenBacklogIsFull_WouldBlock) {
+    Gate gate;
+    volatile int32_t count = 0;
+    WorkQueue queue(1, false);
+    ASSERT_EQ(OK, queue.schedule(new GateWorkUnit(&gate), 1));
+    gate.waitForWaiters(1);
+
+    EXPECT_EQ(OK, queue.trySchedule(new CountingWorkUnit(&count), 1));
+    CountingWorkUnit* workUnit = new CountingWorkUnit(&count);
+    EXPECT_EQ(WOULD_BLOCK, queue.trySchedule(workUnit, 1));
+    delete workUnit;
+    EXPECT_EQ(OK, queue.trySchedule(new CountingWorkUnit(&count), 0));
+
+    gate.open();
+    ASSERT_EQ(OK, queue.finish());
+    EXPECT_EQ(2, count);
+}
+
+TEST(WorkQueueTest, IdleThreadStealsWorkFromBusyThread) {
+    volatile int32_t count = 0;
+    WorkQueue queue(2, false);
+    ASSERT_EQ(OK, queue.schedule(new ParentWorkUnit(&queue, 5, &count)));
+    // the parent can't schedule its children once the queue is finished
+    while (android_atomic_acquire_load(&count) < 5) {
+        usleep(1000);
+    }
+    ASSERT_EQ(OK, queue.finish());
+
+    EXPECT_EQ(5, count);
+    Vector<WorkQueue::ThreadStats> stats;
+    queue.getThreadStats(&stats);
+    ASSERT_EQ(2U, stats.size());
+    EXPECT_EQ(1U, stats[0].workUnitsRun);
+    EXPECT_EQ(0U, stats[0].workUnitsStolen);
+    EXPECT_EQ(5U, stats[1].workUnitsRun);
+    EXPECT_EQ(5U, stats[1].workUnitsStolen);
+    EXPECT_GT(stats[0].busyTime, 0);
+    EXPECT_GE(stats[0].lifetime, stats[0].busyTime);
+}
+
+TEST(WorkQueueTest, Cancel_DiscardsPendingWorkUnits) {
+    Gate gate;
+    volatile int32_t count = 0;
+    WorkQueue queue(1, false);
+    ASSERT_EQ(OK, queue.schedule(new GateWorkUnit(&gate), 0));
+    gate.waitForWaiters(1);
+    for (int i = 0; i < 10; i++) {
+        queue.schedule(new CountingWorkUnit(&count), 0);
+    }
+
+    ASSERT_EQ(OK, queue.cancel());
+    gate.open();
+    ASSERT_EQ(OK, queue.finish());
+    EXPECT_EQ(0, count);
+}
+
+} // namespace android
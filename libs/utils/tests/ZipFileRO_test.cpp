@@ -17,10 +17,15 @@
 #define LOG_TAG "ZipFileRO_test"
 #include <utils/Log.h>
 #include <utils/ZipFileRO.h>
+#include <utils/ZipUtils.h>
+
+#include <utils/Vector.h>
 
 #include <gtest/gtest.h>
+#include <zlib.h>
 
 #include <fcntl.h>
+#include <stdio.h>
 #include <string.h>
 
 namespace android {
@@ -28,12 +33,302 @@ namespace android {
 class ZipFileROTest : public testing::Test {
 protected:
     virtual void SetUp() {
+        strcpy(mPath, "/tmp/ZipFileRO_test_XXXXXX");
+        mFd = mkstemp(mPath);
+        ASSERT_NE(-1, mFd);
     }
 
     virtual void TearDown() {
+        close(mFd);
+        unlink(mPath);
+    }
+
+    static void put2LE(Vector<uint8_t>* buf, unsigned int val) {
+        buf->add(val & 0xff);
+        buf->add((val >> 8) & 0xff);
+    }
+
+    static void put4LE(Vector<uint8_t>* buf, unsigned long val) {
+        put2LE(buf, val & 0xffff);
+        put2LE(buf, (val >> 16) & 0xffff);
+    }
+
+    static void putBytes(Vector<uint8_t>* buf, const void* data, size_t len) {
+        buf->appendArray((const uint8_t*) data, len);
+    }
+
+    // Contents of entry "i" of an archive, which repeat enough to compress.
+    static Vector<uint8_t> contents(int i) {
+        Vector<uint8_t> data;
+        for (int j = 0; j < 1000 + i * 100; j++) {
+            data.add('a' + (j * i) % 7);
+        }
+        return data;
+    }
+
+    static Vector<uint8_t> deflateData(const Vector<uint8_t>& data) {
+        uLongf len = compressBound(data.size());
+        Vector<uint8_t> out;
+        out.insertAt(0, 0, len);
+
+        z_stream zstream;
+        memset(&zstream, 0, sizeof(zstream));
+        deflateInit2(&zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS,
+                8, Z_DEFAULT_STRATEGY);
+        zstream.next_in = (Bytef*) data.array();
+        zstream.avail_in = data.size();
+        zstream.next_out = out.editArray();
+        zstream.avail_out = len;
+        deflate(&zstream, Z_FINISH);
+        out.removeItemsAt(zstream.total_out, len - zstream.total_out);
+        deflateEnd(&zstream);
+        return out;
     }
+
+    // Writes an archive with "numEntries" entries named "entry<i>" to mFd,
+    // deflating the odd ones, and with the given trailing comment.
+    void writeArchive(int numEntries, const char* comment) {
+        Vector<uint8_t> file, dir;
+        for (int i = 0; i < numEntries; i++) {
+            char name[16];
+            snprintf(name, sizeof(name), "entry%d", i);
+            const int method = i % 2 ? ZipFileRO::kCompressDeflated :
+                    ZipFileRO::kCompressStored;
+            Vector<uint8_t> data = contents(i);
+            Vector<uint8_t> stored = method == ZipFileRO::kCompressStored ?
+                    data : deflateData(data);
+            const unsigned long crc = crc32(0, data.array(), data.size());
+            const size_t localOffset = file.size();
+
+            put4LE(&file, 0x04034b50);
+            put2LE(&file, 20);
+            put2LE(&file, 0);
+            put2LE(&file, method);
+            put4LE(&file, 0);
+            put4LE(&file, crc);
+            put4LE(&file, stored.size());
+            put4LE(&file, data.size());
+            put2LE(&file, strlen(name));
+            put2LE(&file, 0);
+            putBytes(&file, name, strlen(name));
+            putBytes(&file, stored.array(), stored.size());
+
+            put4LE(&dir, 0x02014b50);
+            put2LE(&dir, 20);
+            put2LE(&dir, 20);
+            put2LE(&dir, 0);
+            put2LE(&dir, method);
+            put4LE(&dir, 0);
+            put4LE(&dir, crc);
+            put4LE(&dir, stored.size());
+            put4LE(&dir, data.size());
+            put2LE(&dir, strlen(name));
+            put2LE(&dir, 0);
+            put2LE(&dir, 0);
+            put2LE(&dir, 0);
+            put2LE(&dir, 0);
+            put4LE(&dir, 0);
+            put4LE(&dir, localOffset);
+            putBytes(&dir, name, strlen(name));
+        }
+        const size_t dirOffset = file.size();
+        putBytes(&file, dir.array(), dir.size());
+
+        put4LE(&file, 0x06054b50);
+        put2LE(&file, 0);
+        put2LE(&file, 0);
+        put2LE(&file, numEntries);
+        put2LE(&file, numEntries);
+        put4LE(&file, dir.size());
+        put4LE(&file, dirOffset);
+        put2LE(&file, strlen(comment));
+        putBytes(&file, comment, strlen(comment));
+
+        ASSERT_EQ(ssize_t(file.size()), write(mFd, file.array(), file.size()));
+    }
+
+    void expectEntries(const ZipFileRO& zip, int numEntries) {
+        for (int i = 0; i < numEntries; i++) {
+            char name[16];
+            snprintf(name, sizeof(name), "entry%d", i);
+            ZipEntryRO entry = zip.findEntryByName(name);
+            ASSERT_TRUE(entry != NULL) << name;
+
+            size_t uncompLen;
+            ASSERT_TRUE(zip.getEntryInfo(entry, NULL, &uncompLen, NULL, NULL,
+                    NULL, NULL));
+            Vector<uint8_t> data = contents(i);
+            ASSERT_EQ(data.size(), uncompLen);
+
+            Vector<uint8_t> buf;
+            buf.insertAt(0, 0, uncompLen);
+            ASSERT_TRUE(zip.uncompressEntry(entry, buf.editArray()));
+            EXPECT_EQ(0, memcmp(data.array(), buf.array(), uncompLen)) << name;
+        }
+    }
+
+    // an InflateCallback appending to the Vector<uint8_t> "cookie" points to
+    static bool appendChunk(const void* data, size_t size, void* cookie) {
+        Vector<uint8_t>* out = static_cast<Vector<uint8_t>*>(cookie);
+        out->appendArray(static_cast<const uint8_t*>(data), size);
+        return true;
+    }
+
+    static bool failChunk(const void*, size_t, void*) {
+        return false;
+    }
+
+    char mPath[32];
+    int mFd;
 };
 
+TEST_F(ZipFileROTest, OpenFindsEveryEntry) {
+    writeArchive(20, "");
+    ZipFileRO zip;
+    ASSERT_EQ(OK, zip.open(mPath));
+
+    EXPECT_EQ(20, zip.getNumEntries());
+    expectEntries(zip, 20);
+    EXPECT_TRUE(zip.findEntryByName("entry20") == NULL);
+    EXPECT_TRUE(zip.findEntryByName("entry") == NULL);
+}
+
+TEST_F(ZipFileROTest, OpenFindsTheDirectoryBeforeAComment) {
+    writeArchive(3, "a trailing archive comment");
+    ZipFileRO zip;
+    ASSERT_EQ(OK, zip.open(mPath));
+
+    EXPECT_EQ(3, zip.getNumEntries());
+    expectEntries(zip, 3);
+}
+
+TEST_F(ZipFileROTest, CreateEntryFileMapOfStoredEntryIsTheData) {
+    writeArchive(1, "");
+    ZipFileRO zip;
+    ASSERT_EQ(OK, zip.open(mPath));
+
+    FileMap* map = zip.createEntryFileMap(zip.findEntryByName("entry0"));
+    ASSERT_TRUE(map != NULL);
+    Vector<uint8_t> data = contents(0);
+    ASSERT_EQ(data.size(), map->getDataLength());
+    EXPECT_EQ(0, memcmp(data.array(), map->getDataPtr(), data.size()));
+    map->release();
+}
+
+TEST_F(ZipFileROTest, UncompressEntriesOnSeveralThreads) {
+    const int numEntries = 30;
+    writeArchive(numEntries, "");
+    ZipFileRO zip;
+    ASSERT_EQ(OK, zip.open(mPath));
+
+    ZipEntryRO entries[numEntries];
+    void* buffers[numEntries];
+    for (int i = 0; i < numEntries; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "entry%d", i);
+        entries[i] = zip.findEntryByName(name);
+        buffers[i] = malloc(contents(i).size());
+    }
+
+    ASSERT_TRUE(zip.uncompressEntries(entries, buffers, numEntries, 4));
+    for (int i = 0; i < numEntries; i++) {
+        Vector<uint8_t> data = contents(i);
+        EXPECT_EQ(0, memcmp(data.array(), buffers[i], data.size())) << i;
+        free(buffers[i]);
+    }
+}
+
+TEST_F(ZipFileROTest, UncompressEntriesReportsBadEntries) {
+    writeArchive(4, "");
+    ZipFileRO zip;
+    ASSERT_EQ(OK, zip.open(mPath));
+
+    char buf[4][2000];
+    void* buffers[4] = { buf[0], buf[1], buf[2], buf[3] };
+    ZipEntryRO entries[4] = {
+        zip.findEntryByName("entry0"), zip.findEntryByName("entry1"),
+        (ZipEntryRO) 1, zip.findEntryByName("entry3"),
+    };
+
+    EXPECT_FALSE(zip.uncompressEntries(entries, buffers, 4, 2));
+    EXPECT_EQ(0, memcmp(contents(3).array(), buf[3], contents(3).size()));
+}
+
+TEST_F(ZipFileROTest, UncompressEntryToCallback) {
+    writeArchive(4, "");
+    ZipFileRO zip;
+    ASSERT_EQ(OK, zip.open(mPath));
+
+    for (int i = 0; i < 4; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "entry%d", i);
+        ZipEntryRO entry = zip.findEntryByName(name);
+        Vector<uint8_t> out;
+        ASSERT_TRUE(zip.uncompressEntry(entry, appendChunk, &out)) << name;
+        Vector<uint8_t> data = contents(i);
+        ASSERT_EQ(data.size(), out.size()) << name;
+        EXPECT_EQ(0, memcmp(data.array(), out.array(), data.size())) << name;
+
+        EXPECT_FALSE(zip.uncompressEntry(entry, failChunk, NULL)) << name;
+    }
+}
+
+TEST_F(ZipFileROTest, InflateToCallbackInChunks) {
+    Vector<uint8_t> data;
+    for (int i = 0; i < 100000; i++) {
+        data.add('a' + (i * i) % 13);
+    }
+    Vector<uint8_t> compressed = deflateData(data);
+
+    Vector<uint8_t> out;
+    ASSERT_TRUE(ZipUtils::inflateToCallback(compressed.array(),
+            compressed.size(), data.size(), appendChunk, &out, 4096));
+    ASSERT_EQ(data.size(), out.size());
+    EXPECT_EQ(0, memcmp(data.array(), out.array(), data.size()));
+
+    // the size is checked
+    out.clear();
+    EXPECT_FALSE(ZipUtils::inflateToCallback(compressed.array(),
+            compressed.size(), data.size() + 1, appendChunk, &out));
+}
+
+// large enough to be mapped rather than read, and not compressible much
+TEST_F(ZipFileROTest, InflateToBufferFromFile) {
+    Vector<uint8_t> data;
+    srand(1);
+    for (int i = 0; i < 200000; i++) {
+        data.add(rand() % 64);
+    }
+    Vector<uint8_t> compressed = deflateData(data);
+    ASSERT_LT(65536U, compressed.size());
+
+    const char prefix[] = "header";
+    ASSERT_EQ(ssize_t(sizeof(prefix)), write(mFd, prefix, sizeof(prefix)));
+    ASSERT_EQ(ssize_t(compressed.size()),
+            write(mFd, compressed.array(), compressed.size()));
+    ASSERT_EQ(1, write(mFd, "!", 1));
+
+    Vector<uint8_t> out;
+    out.insertAt(0, 0, data.size());
+    ASSERT_EQ(off_t(sizeof(prefix)), lseek(mFd, sizeof(prefix), SEEK_SET));
+    ASSERT_TRUE(ZipUtils::inflateToBuffer(mFd, out.editArray(), data.size(),
+            compressed.size()));
+    EXPECT_EQ(0, memcmp(data.array(), out.array(), data.size()));
+    char next;
+    ASSERT_EQ(1, read(mFd, &next, 1));
+    EXPECT_EQ('!', next);
+
+    FILE* fp = fdopen(dup(mFd), "r");
+    ASSERT_TRUE(fp != NULL);
+    ASSERT_EQ(0, fseek(fp, sizeof(prefix), SEEK_SET));
+    memset(out.editArray(), 0, out.size());
+    ASSERT_TRUE(ZipUtils::inflateToBuffer(fp, out.editArray(), data.size(),
+            compressed.size()));
+    EXPECT_EQ(0, memcmp(data.array(), out.array(), data.size()));
+    EXPECT_EQ('!', getc(fp));
+    fclose(fp);
+}
+
 TEST_F(ZipFileROTest, ZipTimeConvertSuccess) {
     struct tm t;
 
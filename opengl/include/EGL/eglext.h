@@ -568,6 +568,18 @@ typedef EGLBoolean (EGLAPIENTRYP PFNEGLPRESENTATIONTIMEANDROID) (EGLDisplay dpy,
 #endif
 #endif
 
+#ifndef EGL_ANDROID_frame_completion_times
+#define EGL_ANDROID_frame_completion_times 1
+#define EGL_FRAME_COMPLETION_TIMES_ANDROID	0x3150
+#define EGL_FRAME_PENDING_ANDROID		((EGLnsecsANDROID)-2)
+#define EGL_FRAME_INVALID_ANDROID		((EGLnsecsANDROID)-1)
+#ifdef EGL_EGLEXT_PROTOTYPES
+EGLAPI EGLint EGLAPIENTRY eglGetFrameCompletionTimesANDROID(EGLDisplay dpy, EGLSurface surface, EGLint count, EGLnsecsANDROID *queueTimes, EGLnsecsANDROID *completeTimes);
+#else
+typedef EGLint (EGLAPIENTRYP PFNEGLGETFRAMECOMPLETIONTIMESANDROIDPROC) (EGLDisplay dpy, EGLSurface surface, EGLint count, EGLnsecsANDROID *queueTimes, EGLnsecsANDROID *completeTimes);
+#endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -67,12 +67,34 @@ etc1_uint32 etc1_get_encoded_data_size(etc1_uint32 width, etc1_uint32 height);
 int etc1_encode_image(const etc1_byte* pIn, etc1_uint32 width, etc1_uint32 height,
         etc1_uint32 pixelSize, etc1_uint32 stride, etc1_byte* pOut);
 
+// Encoding effort for etc1_encode_image_ex().
+// ETC1_ENCODE_EXHAUSTIVE tries all 8 modifier tables for each sub-block, which is
+// what etc1_encode_image() does. ETC1_ENCODE_FAST only tries the 3 tables that
+// best match the spread of the sub-block's colors; it is about twice as fast, at a
+// small cost in quality.
+
+#define ETC1_ENCODE_EXHAUSTIVE 0
+#define ETC1_ENCODE_FAST 1
+
+// Encode an entire image, like etc1_encode_image().
+// effort - ETC1_ENCODE_EXHAUSTIVE or ETC1_ENCODE_FAST.
+// threadCount - number of threads to encode on, counting the calling thread.
+//       0 uses one per CPU, or fewer for small images. The output doesn't
+//       depend on the number of threads.
+// returns non-zero if there is an error.
+
+int etc1_encode_image_ex(const etc1_byte* pIn, etc1_uint32 width, etc1_uint32 height,
+        etc1_uint32 pixelSize, etc1_uint32 stride, etc1_byte* pOut,
+        etc1_uint32 effort, etc1_uint32 threadCount);
+
 // Decode an entire image.
 // pIn - pointer to encoded data.
 // pOut - pointer to the image data. Will be written such that
 //        pixel (x,y) is at pIn + pixelSize * x + stride * y. Must be
-//        large enough to store entire image.
-// pixelSize can be 2 or 3. 2 is an GL_UNSIGNED_SHORT_5_6_5 image, 3 is a GL_BYTE RGB image.
+//        large enough to store entire image. Only the pixels of the image are
+//        written, so pOut can be a locked buffer with any stride.
+// pixelSize can be 2, 3 or 4. 2 is an GL_UNSIGNED_SHORT_5_6_5 image, 3 is a GL_BYTE RGB image,
+// 4 is a GL_BYTE RGBA image with an alpha of 255.
 // returns non-zero if there is an error.
 
 int etc1_decode_image(const etc1_byte* pIn, etc1_byte* pOut,
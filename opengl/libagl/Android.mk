@@ -10,6 +10,7 @@ LOCAL_SRC_FILES:= \
 	egl.cpp                     \
 	state.cpp		            \
 	texture.cpp		            \
+	tiler.cpp		            \
     Tokenizer.cpp               \
     TokenManager.cpp            \
     TextureObjectManager.cpp    \
@@ -62,6 +62,8 @@ buffer_t const* EGLBufferObjectManager::bind(GLuint buffer)
     bo->usage = GL_STATIC_DRAW;
     bo->size = 0;
     bo->name = buffer;
+    bo->generation = 0;
+    bo->xform = 0;
     mBuffers.add(buffer, bo);
     return bo;
 }
@@ -92,6 +94,7 @@ void EGLBufferObjectManager::deleteBuffers(GLsizei n, const GLuint* buffers)
             if (index >= 0) {
                 buffer_t* bo = mBuffers.valueAt(index);
                 free(bo->data);
+                free(bo->xform);
                 mBuffers.removeItemsAt(index);
                 delete bo;
             }
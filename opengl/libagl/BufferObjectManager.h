@@ -39,11 +39,15 @@ namespace android {
 
 namespace gl {
 
+struct xform_cache_t;
+
 struct buffer_t {
     GLsizeiptr      size;
     GLenum          usage;
     uint8_t*        data;
     uint32_t        name;
+    uint32_t        generation;     // bumped each time data is written
+    xform_cache_t*  xform;          // transformed vertices, see array.cpp
 };
 
 };
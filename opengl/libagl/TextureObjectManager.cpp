@@ -44,6 +44,8 @@ void EGLTextureObject::init()
     surface.version = sizeof(surface);
     mMipmaps = 0;
     mNumExtraLod = 0;
+    mMipChain = 0;
+    mMipChainSize = 0;
     mIsComplete = false;
     wraps = GL_REPEAT;
     wrapt = GL_REPEAT;
@@ -89,18 +91,86 @@ status_t EGLTextureObject::allocateMipmaps()
     return NO_ERROR;
 }
 
+void EGLTextureObject::freeMip(GGLSurface& mip)
+{
+    // levels in the chain are freed with it
+    if (mip.data && (mip.data < mMipChain ||
+            mip.data >= mMipChain + mMipChainSize)) {
+        free(mip.data);
+    }
+    mip.data = 0;
+}
+
 void EGLTextureObject::freeMipmaps()
 {
     if (mMipmaps) {
         for (int i=0 ; i<mNumExtraLod ; i++) {
-            if (mMipmaps[i].data) {
-                free(mMipmaps[i].data);
-            }
+            freeMip(mMipmaps[i]);
         }
         free(mMipmaps);
         mMipmaps = 0;
         mNumExtraLod = 0;
     }
+    free(mMipChain);
+    mMipChain = 0;
+    mMipChainSize = 0;
+}
+
+status_t EGLTextureObject::reallocateMipChain(int pixelSize)
+{
+    // Sets up all the levels below the base one, in one allocation instead
+    // of one per level. The levels are left for the caller to fill.
+    if (!mMipmaps) {
+        status_t err = allocateMipmaps();
+        if (err != NO_ERROR)
+            return err;
+    }
+    if (!mNumExtraLod)
+        return NO_ERROR;
+
+    size_t size = 0;
+    int w = surface.width;
+    int h = surface.height;
+    for (int i=0 ; i<mNumExtraLod ; i++) {
+        w = (w>>1) ? : 1;
+        h = (h>>1) ? : 1;
+        // keep each level 4-byte aligned
+        size += (w * h * pixelSize + 3) & ~3;
+    }
+
+    for (int i=0 ; i<mNumExtraLod ; i++) {
+        freeMip(mMipmaps[i]);
+    }
+    if (size != mMipChainSize) {
+        free(mMipChain);
+        mMipChainSize = 0;
+        mMipChain = (GGLubyte*)malloc(size);
+        if (!mMipChain) {
+            memset(mMipmaps, 0, mNumExtraLod * sizeof(GGLSurface));
+            mIsComplete = false;
+            return NO_MEMORY;
+        }
+        mMipChainSize = size;
+    }
+
+    GGLubyte* data = mMipChain;
+    w = surface.width;
+    h = surface.height;
+    for (int i=0 ; i<mNumExtraLod ; i++) {
+        w = (w>>1) ? : 1;
+        h = (h>>1) ? : 1;
+        GGLSurface& mipmap = mMipmaps[i];
+        mipmap.version = sizeof(GGLSurface);
+        mipmap.width  = w;
+        mipmap.height = h;
+        mipmap.stride = w;
+        mipmap.format = surface.format;
+        mipmap.compressedFormat = surface.compressedFormat;
+        mipmap.data = data;
+        data += (w * h * pixelSize + 3) & ~3;
+    }
+    mIsComplete = true;
+    return NO_ERROR;
 }
 
 const GGLSurface& EGLTextureObject::mip(int lod) const
@@ -198,8 +268,7 @@ status_t EGLTextureObject::reallocate(
                 level, mNumExtraLod+1);
 
         GGLSurface& mipmap = editMip(level);
-        if (mipmap.data)
-            free(mipmap.data);
+        freeMip(mipmap);
 
         mipmap.data = (GGLubyte*)malloc(size);
         if (!mipmap.data) {
@@ -249,52 +318,73 @@ EGLSurfaceManager::~EGLSurfaceManager()
     // everything gets freed automatically here...
 }
 
+sp<EGLTextureObject> EGLSurfaceManager::get(GLuint name) const
+{
+    if (name < DENSE_NAMES) {
+        if (name < mDenseTextures.size())
+            return mDenseTextures[name];
+        return 0;
+    }
+    const ssize_t index = mTextures.indexOfKey(name);
+    if (index >= 0)
+        return mTextures.valueAt(index);
+    return 0;
+}
+
+void EGLSurfaceManager::set(GLuint name, const sp<EGLTextureObject>& tex)
+{
+    if (name < DENSE_NAMES) {
+        const size_t size = mDenseTextures.size();
+        if (name >= size) {
+            if (tex == 0)
+                return;
+            mDenseTextures.insertAt(size, name + 1 - size);
+        }
+        mDenseTextures.editItemAt(name) = tex;
+        return;
+    }
+    if (tex != 0) {
+        mTextures.add(name, tex);
+    } else {
+        mTextures.removeItem(name);
+    }
+}
+
 sp<EGLTextureObject> EGLSurfaceManager::createTexture(GLuint name)
 {
     sp<EGLTextureObject> result;
 
     Mutex::Autolock _l(mLock);
-    if (mTextures.indexOfKey(name) >= 0)
+    if (get(name) != 0)
         return result; // already exists!
 
     result = new EGLTextureObject();
-
-    status_t err = mTextures.add(name, result);
-    if (err < 0)
-        result.clear();
-
+    set(name, result);
     return result;
 }
 
 sp<EGLTextureObject> EGLSurfaceManager::removeTexture(GLuint name)
 {
     Mutex::Autolock _l(mLock);
-    const ssize_t index = mTextures.indexOfKey(name);
-    if (index >= 0) {
-        sp<EGLTextureObject> result(mTextures.valueAt(index));
-        mTextures.removeItemsAt(index);
-        return result;
-    }
-    return 0;
+    sp<EGLTextureObject> result(get(name));
+    if (result != 0)
+        set(name, 0);
+    return result;
 }
 
 sp<EGLTextureObject> EGLSurfaceManager::replaceTexture(GLuint name)
 {
-    sp<EGLTextureObject> tex;
     Mutex::Autolock _l(mLock);
-    const ssize_t index = mTextures.indexOfKey(name);
-    if (index >= 0) {
-        const sp<EGLTextureObject>& old = mTextures.valueAt(index);
-        const uint32_t refs = old->getStrongCount();
-        if (ggl_likely(refs == 1)) {
-            // we're the only owner
-            tex = old;
-        } else {
+    sp<EGLTextureObject> tex(get(name));
+    if (tex != 0) {
+        // our reference plus the one in the table
+        const uint32_t refs = tex->getStrongCount();
+        if (ggl_unlikely(refs != 2)) {
             // keep the texture's parameters
+            sp<EGLTextureObject> old(tex);
             tex = new EGLTextureObject();
             tex->copyParameters(old);
-            mTextures.removeItemsAt(index);
-            mTextures.add(name, tex);
+            set(name, tex);
         }
     }
     return tex;
@@ -307,7 +397,7 @@ void EGLSurfaceManager::deleteTextures(GLsizei n, const GLuint *tokens)
     for (GLsizei i=0 ; i<n ; i++) {
         const GLuint t(*tokens++);
         if (t) {
-            mTextures.removeItem(t);
+            set(t, 0);
         }
     }
 }
@@ -315,10 +405,7 @@ void EGLSurfaceManager::deleteTextures(GLsizei n, const GLuint *tokens)
 sp<EGLTextureObject> EGLSurfaceManager::texture(GLuint name)
 {
     Mutex::Autolock _l(mLock);
-    const ssize_t index = mTextures.indexOfKey(name);
-    if (index >= 0)
-        return mTextures.valueAt(index);
-    return 0;
+    return get(name);
 }
 
 // ----------------------------------------------------------------------------
@@ -25,6 +25,7 @@
 #include <utils/threads.h>
 #include <utils/RefBase.h>
 #include <utils/KeyedVector.h>
+#include <utils/Vector.h>
 #include <utils/Errors.h>
 
 #include <private/pixelflinger/ggl_context.h>
@@ -54,6 +55,7 @@ public:
     status_t            reallocate(GLint level,
                             int w, int h, int s,
                             int format, int compressedFormat, int bpr);
+    status_t            reallocateMipChain(int pixelSize);
     inline  size_t      size() const { return mSize; }
     const GGLSurface&   mip(int lod) const;
     GGLSurface&         editMip(int lod);
@@ -64,10 +66,14 @@ public:
 private:
         status_t        allocateMipmaps();
             void        freeMipmaps();
+            void        freeMip(GGLSurface& mip);
             void        init();
     size_t              mSize;
     GGLSurface          *mMipmaps;
     int                 mNumExtraLod;
+    // all the extra levels in one block, when built by reallocateMipChain()
+    GGLubyte            *mMipChain;
+    size_t              mMipChainSize;
     bool                mIsComplete;
 
 public:
@@ -100,7 +106,15 @@ public:
     sp<EGLTextureObject>    texture(GLuint name);
 
 private:
+    // names below this are looked up directly, which is all of them
+    // unless the application picks its own
+    enum { DENSE_NAMES = 1024 };
+
+    sp<EGLTextureObject>    get(GLuint name) const;
+    void                    set(GLuint name, const sp<EGLTextureObject>& tex);
+
     mutable Mutex                               mLock;
+    Vector< sp<EGLTextureObject> >              mDenseTextures;
     KeyedVector< GLuint, sp<EGLTextureObject> > mTextures;
 };
 
@@ -35,6 +35,14 @@
 #define VC_CACHE_TYPE_LRU       2
 #define VC_CACHE_TYPE           VC_CACHE_TYPE_INDEXED
 
+// Transform float vertex arrays in floating point instead of converting
+// them to fixed-point first, except where floats are emulated.
+#if defined(__arm__) && defined(__SOFTFP__)
+#define FLOAT_TRANSFORM         0
+#else
+#define FLOAT_TRANSFORM         1
+#endif
+
 #if VC_CACHE_STATISTICS
 #include <utils/Timers.h>
 #endif
@@ -49,6 +57,17 @@ static void compileElements__generic(ogles_context_t*,
         vertex_t*, GLint, GLsizei);
 static void compileElement__generic(ogles_context_t*,
         vertex_t*, GLint);
+#if FLOAT_TRANSFORM
+static void compileElements__float(ogles_context_t*,
+        vertex_t*, GLint, GLsizei);
+static void compileElement__float(ogles_context_t*,
+        vertex_t*, GLint);
+#endif
+static void compileElements__cached(ogles_context_t*,
+        vertex_t*, GLint, GLsizei);
+static void compileElement__cached(ogles_context_t*,
+        vertex_t*, GLint);
+static bool validate_xform_cache(ogles_context_t* c);
 
 static void drawPrimitivesPoints(ogles_context_t*, GLint, GLsizei);
 static void drawPrimitivesLineStrip(ogles_context_t*, GLint, GLsizei);
@@ -654,6 +673,20 @@ static void drawPrimitivesTriangleFanOrStrip(ogles_context_t* c,
 
     vertex_t *v, *v0, *v1, *v2;
     c->arrays.cull = vertex_t::CLIP_ALL;
+
+    if (count == 4) {
+        // a single quad, which is how most 2D content is drawn
+        v = c->vc.vBuffer;
+        c->arrays.compileElements(c, v, first, 4);
+        if (!c->arrays.cull) {
+            if (winding == 2)
+                ogles_render_quad(c, v, v+1, v+2, v, v+2, v+3);
+            else
+                ogles_render_quad(c, v, v+1, v+2, v+2, v+1, v+3);
+        }
+        return;
+    }
+
     c->arrays.compileElements(c, c->vc.vBuffer, first, 2);
     first += 2;
     count -= 2;
@@ -964,20 +997,215 @@ void compileElements__generic(ogles_context_t* c,
     const GLubyte* vp = c->arrays.vertex.element(
             first & vertex_cache_t::INDEX_MASK);
     const size_t stride = c->arrays.vertex.stride;
-    transform_t const* const mvp = &c->transforms.mvp;
+    vertex_t* const base = v;
+    GLsizei n = count;
     do {
         v->flags = 0;
         v->index = first++;
         v->obj.z = 0;
         v->obj.w = 0x10000;
         c->arrays.vertex.fetch(c, v->obj.v, vp);
-        c->arrays.mvp_transform(mvp, &v->clip, &v->obj);
+        vp += stride;
+        v++;
+    } while (--n);
+
+    // transform the whole batch in one go
+    c->arrays.mvp_transforms(&c->transforms.mvp,
+            &base->clip, &base->obj, count, sizeof(vertex_t));
+
+    v = base;
+    do {
+        c->arrays.perspective(c, v);
+        v++;
+    } while (--count);
+}
+
+#if FLOAT_TRANSFORM
+
+static inline
+void transform_float(const GLfloat* m, GLint size, vec4_t* clip,
+        const GLfloat* p)
+{
+    const GLfloat x = p[0];
+    const GLfloat y = p[1];
+    const GLfloat z = (size > 2) ? p[2] : 0.0f;
+    const GLfloat w = (size > 3) ? p[3] : 1.0f;
+    clip->x = gglFloatToFixed(x*m[0] + y*m[4] + z*m[ 8] + w*m[12]);
+    clip->y = gglFloatToFixed(x*m[1] + y*m[5] + z*m[ 9] + w*m[13]);
+    clip->z = gglFloatToFixed(x*m[2] + y*m[6] + z*m[10] + w*m[14]);
+    clip->w = gglFloatToFixed(x*m[3] + y*m[7] + z*m[11] + w*m[15]);
+}
+
+void compileElement__float(ogles_context_t* c,
+        vertex_t* v, GLint first)
+{
+    v->flags = 0;
+    v->index = first;
+    first &= vertex_cache_t::INDEX_MASK;
+    const GLubyte* vp = c->arrays.vertex.element(first);
+    v->obj.z = 0;
+    v->obj.w = 0x10000;
+    c->arrays.vertex.fetch(c, v->obj.v, vp);
+    transform_float(c->transforms.mvpf.elements(), c->arrays.vertex.size,
+            &v->clip, (const GLfloat*)vp);
+    c->arrays.perspective(c, v);
+}
+
+void compileElements__float(ogles_context_t* c,
+        vertex_t* v, GLint first, GLsizei count)
+{
+    // the object coordinates are still needed in fixed-point, for eye
+    // coordinates, but clip coordinates come straight from the floats.
+    const GLubyte* vp = c->arrays.vertex.element(
+            first & vertex_cache_t::INDEX_MASK);
+    const size_t stride = c->arrays.vertex.stride;
+    const GLint size = c->arrays.vertex.size;
+    GLfloat m[16];
+    memcpy(m, c->transforms.mvpf.elements(), sizeof(m));
+    do {
+        v->flags = 0;
+        v->index = first++;
+        v->obj.z = 0;
+        v->obj.w = 0x10000;
+        c->arrays.vertex.fetch(c, v->obj.v, vp);
+        transform_float(m, size, &v->clip, (const GLfloat*)vp);
         c->arrays.perspective(c, v);
         vp += stride;
         v++;
     } while (--count);
 }
 
+#endif // FLOAT_TRANSFORM
+
+// ----------------------------------------------------------------------------
+#if 0
+#pragma mark -
+#pragma mark Post-transform cache
+#endif
+
+/*
+ * Vertex arrays in GL_STATIC_DRAW buffer objects keep their transformed
+ * vertices, so drawing the same geometry again skips the fetch, transform
+ * and perspective divide. The entries are good as long as the buffer's
+ * data, the vertex array layout and the transformations don't change,
+ * which validate_xform_cache() checks once per draw. User clip planes
+ * aren't cached.
+ */
+
+struct xform_entry_t {
+    uint32_t        stamp;
+    uint32_t        flags;
+    vec4_t          obj;    // or eye, like in vertex_t
+    vec4_t          clip;
+    vec4_t          window;
+};
+
+struct xform_cache_t {
+    uint32_t        stamp;          // entries with another stamp are stale
+    uint32_t        generation;     // of the buffer's data
+    uint32_t        transforms;     // generation of the transformations
+    GLvoid const*   pointer;
+    GLint           size;
+    GLenum          type;
+    GLsizei         stride;
+    size_t          count;
+
+    enum {
+        // don't cache large buffers, which are unlikely to be static
+        // geometry, 1 MB worth of entries
+        MAX_VERTICES = 16384
+    };
+
+    inline xform_entry_t* entries() {
+        return reinterpret_cast<xform_entry_t*>(this + 1);
+    }
+};
+
+bool validate_xform_cache(ogles_context_t* c)
+{
+    array_t const& vertex = c->arrays.vertex;
+    buffer_t* const bo = const_cast<buffer_t*>(vertex.bo);
+    const size_t offset = uintptr_t(vertex.pointer);
+    if (offset >= size_t(bo->size))
+        return false;
+    const size_t count =
+            (bo->size - offset + vertex.stride - 1) / vertex.stride;
+    if (count > xform_cache_t::MAX_VERTICES)
+        return false;
+
+    xform_cache_t* cache = bo->xform;
+    if (!cache || cache->count != count) {
+        free(cache);
+        cache = (xform_cache_t*)calloc(1,
+                sizeof(xform_cache_t) + count*sizeof(xform_entry_t));
+        bo->xform = cache;
+        if (!cache)
+            return false;
+        cache->count = count;
+    }
+
+    if (cache->stamp == 0 ||
+        cache->generation != bo->generation ||
+        cache->transforms != c->transforms.generation ||
+        cache->pointer != vertex.pointer ||
+        cache->size != vertex.size ||
+        cache->type != vertex.type ||
+        cache->stride != vertex.stride)
+    {
+        // throw away all the entries
+        if (++cache->stamp == 0) {
+            memset(cache->entries(), 0, count*sizeof(xform_entry_t));
+            cache->stamp = 1;
+        }
+        cache->generation = bo->generation;
+        cache->transforms = c->transforms.generation;
+        cache->pointer = vertex.pointer;
+        cache->size = vertex.size;
+        cache->type = vertex.type;
+        cache->stride = vertex.stride;
+    }
+    return true;
+}
+
+void compileElement__cached(ogles_context_t* c,
+        vertex_t* v, GLint first)
+{
+    xform_cache_t* const cache = c->arrays.vertex.bo->xform;
+    const size_t i = first & vertex_cache_t::INDEX_MASK;
+    if (ggl_unlikely(i >= cache->count)) {
+        c->arrays.compileElementUncached(c, v, first);
+        return;
+    }
+
+    xform_entry_t* const e = cache->entries() + i;
+    if (ggl_likely(e->stamp == cache->stamp)) {
+        v->flags = e->flags;
+        v->index = first;
+        v->obj = e->obj;
+        v->clip = e->clip;
+        v->window = e->window;
+        // that's what the perspective divide does
+        c->arrays.cull &= e->flags & vertex_t::CLIP_ALL;
+        return;
+    }
+
+    c->arrays.compileElementUncached(c, v, first);
+    e->stamp = cache->stamp;
+    e->flags = v->flags;
+    e->obj = v->obj;
+    e->clip = v->clip;
+    e->window = v->window;
+}
+
+void compileElements__cached(ogles_context_t* c,
+        vertex_t* v, GLint first, GLsizei count)
+{
+    do {
+        compileElement__cached(c, v, first++);
+        v++;
+    } while (--count);
+}
+
 /*
 void compileElements__3x_full(ogles_context_t* c,
         vertex_t* v, GLint first, GLsizei count)
@@ -1136,6 +1364,8 @@ void validate_arrays(ogles_context_t* c, GLenum mode)
     // vertex transform
     c->arrays.mvp_transform =
         c->transforms.mvp.pointv[c->arrays.vertex.size - 2];
+    c->arrays.mvp_transforms =
+        c->transforms.mvp.pointsv[c->arrays.vertex.size - 2];
 
     c->arrays.mv_transform =
         c->transforms.modelview.transform.pointv[c->arrays.vertex.size - 2];
@@ -1155,6 +1385,18 @@ void validate_arrays(ogles_context_t* c, GLenum mode)
         am.vertex.resolve();
         if (am.vertex.bo || am.vertex.pointer) {
             am.vertex.fetch = vertex_fct[am.vertex.size-2][am.vertex.type & 0xF];
+#if FLOAT_TRANSFORM
+            if (am.vertex.type == GL_FLOAT) {
+                am.compileElement = compileElement__float;
+                am.compileElements = compileElements__float;
+            }
+#endif
+            if (am.vertex.bo && am.vertex.bo->usage == GL_STATIC_DRAW &&
+                    !c->clipPlanes.enable && validate_xform_cache(c)) {
+                am.compileElementUncached = am.compileElement;
+                am.compileElement = compileElement__cached;
+                am.compileElements = compileElements__cached;
+            }
         }
     }
 
@@ -1499,6 +1741,7 @@ void glBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usa
     if (data) {
         memcpy(bo->data, data, size);
     }
+    edit_bo->generation++;
 }
 
 void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
@@ -1525,6 +1768,7 @@ void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvo
         return;
     }
     memcpy(bo->data + offset, data, size);
+    const_cast<buffer_t*>(bo)->generation++;
 }
 
 void glDeleteBuffers(GLsizei n, const GLuint* buffers)
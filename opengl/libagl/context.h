@@ -43,6 +43,7 @@ const unsigned int OGLES_NUM_COMPRESSED_TEXTURE_FORMATS = 10
 class EGLTextureObject;
 class EGLSurfaceManager;
 class EGLBufferObjectManager;
+struct tiler_t;
 
 namespace gl {
 
@@ -208,8 +209,12 @@ struct array_machine_t {
 
     void (*compileElements)(ogles_context_t*, vertex_t*, GLint, GLsizei);
     void (*compileElement)(ogles_context_t*, vertex_t*, GLint);
+    // what compileElement does when the post-transform cache is on
+    void (*compileElementUncached)(ogles_context_t*, vertex_t*, GLint);
 
     void (*mvp_transform)(transform_t const*, vec4_t*, vec4_t const*);
+    void (*mvp_transforms)(transform_t const*, vec4_t*, vec4_t const*,
+            size_t, size_t);
     void (*mv_transform)(transform_t const*, vec4_t*, vec4_t const*);
     void (*tex_transform[2])(transform_t const*, vec4_t*, vec4_t const*);
     void (*perspective)(ogles_context_t*c, vertex_t* v);
@@ -427,6 +432,20 @@ struct transform_t {
         void (*pointv[3])(transform_t const* t, vec4_t*, vec4_t const*);
     };
 
+    // same as above, for count vectors that are stride bytes apart
+    union {
+        struct {
+            void (*points2)(transform_t const* t, vec4_t*, vec4_t const*,
+                    size_t count, size_t stride);
+            void (*points3)(transform_t const* t, vec4_t*, vec4_t const*,
+                    size_t count, size_t stride);
+            void (*points4)(transform_t const* t, vec4_t*, vec4_t const*,
+                    size_t count, size_t stride);
+        };
+        void (*pointsv[3])(transform_t const* t, vec4_t*, vec4_t const*,
+                size_t count, size_t stride);
+    };
+
     void loadIdentity();
     void picker();
     void dump(const char* what);
@@ -494,6 +513,8 @@ struct transform_state_t {
 
     // modelview * projection
     transform_t         mvp     __attribute__((aligned(32)));
+    // same as mvp, in floating point, for float vertex arrays
+    matrixf_t           mvpf;
     // viewport transformation
     vp_transform_t      vpt     __attribute__((aligned(32)));
     // same for 4-D vertices
@@ -506,6 +527,8 @@ struct transform_state_t {
     GLenum              matrixMode;
     GLenum              rescaleNormals;
     uint32_t            dirty;
+    // bumped when the vertex transformations change
+    uint32_t            generation;
     void invalidate();
     void update_mvp();
     void update_mvit();
@@ -624,6 +647,7 @@ struct ogles_context_t {
     uint32_t                transformTextures : 1;
     EGLSurfaceManager*      surfaceManager;
     EGLBufferObjectManager* bufferObjectManager;
+    tiler_t*                tiler;
 
     GLenum                  error;
 
@@ -250,52 +250,54 @@ decodeDXT1(const GLvoid *data, int width, int height,
                 
                 int r2, g2, b2, r3, g3, b3, a3;
                 
-                int bbits = bits >> 1;
-                bool has2 = ((bbits & ~bits) & 0x55555555) != 0;
-                bool has3 = ((bbits &  bits) & 0x55555555) != 0;
-                
-                if (has2 || has3) {
-                    if (color0 > color1) {
-                        r2 = avg23(r0, r1);
-                        g2 = avg23(g0, g1);
-                        b2 = avg23(b0, b1);
-                        
-                        r3 = avg23(r1, r0);
-                        g3 = avg23(g1, g0);
-                        b3 = avg23(b1, b0);
-                        a3 = 1;
-                    } else {
-                        r2 = (r0 + r1) >> 1;
-                        g2 = (g0 + g1) >> 1;
-                        b2 = (b0 + b1) >> 1;
-                        
-                        r3 = g3 = b3 = a3 = 0;
-                    }
-                    if (hasAlpha) {
-                        c[2] = (r2 << 11) | ((g2 >> 1) << 6) |
-                            (b2 << 1) | 0x1;
-                        c[3] = (r3 << 11) | ((g3 >> 1) << 6) |
-                            (b3 << 1) | a3;
-                    } else {
-                        c[2] = (r2 << 11) | (g2 << 5) | b2;
-                        c[3] = (r3 << 11) | (g3 << 5) | b3;
-                    }
+                // The whole table is needed: the next block may reuse it
+                // and have codes that this one doesn't.
+                if (color0 > color1) {
+                    r2 = avg23(r0, r1);
+                    g2 = avg23(g0, g1);
+                    b2 = avg23(b0, b1);
+
+                    r3 = avg23(r1, r0);
+                    g3 = avg23(g1, g0);
+                    b3 = avg23(b1, b0);
+                    a3 = 1;
+                } else {
+                    r2 = (r0 + r1) >> 1;
+                    g2 = (g0 + g1) >> 1;
+                    b2 = (b0 + b1) >> 1;
+
+                    r3 = g3 = b3 = a3 = 0;
+                }
+                if (hasAlpha) {
+                    c[2] = (r2 << 11) | ((g2 >> 1) << 6) |
+                        (b2 << 1) | 0x1;
+                    c[3] = (r3 << 11) | ((g3 >> 1) << 6) |
+                        (b3 << 1) | a3;
+                } else {
+                    c[2] = (r2 << 11) | (g2 << 5) | b2;
+                    c[3] = (r3 << 11) | (g3 << 5) | b3;
                 }
             }
             
             uint16_t* blockRowPtr = blockPtr;
-            for (int y = 0; y < 4; y++, blockRowPtr += stride) {
-                // Don't process rows past the botom
-                if (base_y + y >= height) {
-                    break;
+            const int w = min(width - base_x, 4);
+            const int h = min(height - base_y, 4);
+            if (ggl_likely(w == 4 && h == 4)) {
+                for (int y = 0; y < 4; y++, blockRowPtr += stride) {
+                    blockRowPtr[0] = c[ bits       & 0x3];
+                    blockRowPtr[1] = c[(bits >> 2) & 0x3];
+                    blockRowPtr[2] = c[(bits >> 4) & 0x3];
+                    blockRowPtr[3] = c[(bits >> 6) & 0x3];
+                    bits >>= 8;
                 }
-                
-                int w = min(width - base_x, 4);
-                for (int x = 0; x < w; x++) {
-                    int code = bits & 0x3;
-                    bits >>= 2;
-                    
-                    blockRowPtr[x] = c[code];
+            } else {
+                // Don't process pixels past the right or bottom edge,
+                // but each row of the block still has 4 codes
+                for (int y = 0; y < h; y++, blockRowPtr += stride) {
+                    for (int x = 0; x < w; x++) {
+                        blockRowPtr[x] = c[(bits >> (2*x)) & 0x3];
+                    }
+                    bits >>= 8;
                 }
             }
         }
@@ -357,54 +359,54 @@ decodeDXT3(const GLvoid *data, int width, int height,
                 prev_color0 = color0;
                 prev_color1 = color1;
                 
-                int bbits = bits >> 1;
-                bool has2 = ((bbits & ~bits) & 0x55555555) != 0;
-                bool has3 = ((bbits &  bits) & 0x55555555) != 0;
-                
-                if (has2 || has3) {
-                    int r0 =   red(color0);
-                    int g0 = green(color0);
-                    int b0 =  blue(color0);
-                    
-                    int r1 =   red(color1);
-                    int g1 = green(color1);
-                    int b1 =  blue(color1);
-                    
-                    int r2 = avg23(r0, r1);
-                    int g2 = avg23(g0, g1);
-                    int b2 = avg23(b0, b1);
-                    
-                    int r3 = avg23(r1, r0);
-                    int g3 = avg23(g1, g0);
-                    int b3 = avg23(b1, b0);
-
-                    c[0] = rgb565SepTo888(r0, g0, b0);
-                    c[1] = rgb565SepTo888(r1, g1, b1);
-                    c[2] = rgb565SepTo888(r2, g2, b2);
-                    c[3] = rgb565SepTo888(r3, g3, b3);
-                } else {
-                    // Convert to 8 bits
-                    c[0] = rgb565To888(color0);
-                    c[1] = rgb565To888(color1);
-                }
+                // The whole table is needed: the next block may reuse it
+                // and have codes that this one doesn't.
+                int r0 =   red(color0);
+                int g0 = green(color0);
+                int b0 =  blue(color0);
+
+                int r1 =   red(color1);
+                int g1 = green(color1);
+                int b1 =  blue(color1);
+
+                int r2 = avg23(r0, r1);
+                int g2 = avg23(g0, g1);
+                int b2 = avg23(b0, b1);
+
+                int r3 = avg23(r1, r0);
+                int g3 = avg23(g1, g0);
+                int b3 = avg23(b1, b0);
+
+                c[0] = rgb565SepTo888(r0, g0, b0);
+                c[1] = rgb565SepTo888(r1, g1, b1);
+                c[2] = rgb565SepTo888(r2, g2, b2);
+                c[3] = rgb565SepTo888(r3, g3, b3);
             }
 
             uint32_t* blockRowPtr = blockPtr;
-            for (int y = 0; y < 4; y++, blockRowPtr += stride) {
-                // Don't process rows past the botom
-                if (base_y + y >= height) {
-                    break;
+            const int w = min(width - base_x, 4);
+            const int h = min(height - base_y, 4);
+            if (ggl_likely(w == 4 && h == 4)) {
+                for (int y = 0; y < 4; y++, blockRowPtr += stride) {
+                    const uint32_t a = uint32_t(alpha) & 0xffff;
+                    blockRowPtr[0] = c[ bits       & 0x3] | ((a & 0x000f) * 0x11000000);
+                    blockRowPtr[1] = c[(bits >> 2) & 0x3] | ((a & 0x00f0) * 0x01100000);
+                    blockRowPtr[2] = c[(bits >> 4) & 0x3] | ((a & 0x0f00) * 0x00110000);
+                    blockRowPtr[3] = c[(bits >> 6) & 0x3] | ((a & 0xf000) * 0x00011000);
+                    alpha >>= 16;
+                    bits >>= 8;
                 }
-                
-                int w = min(width - base_x, 4);
-                for (int x = 0; x < w; x++) {
-                    int a = alpha & 0xf;
-                    alpha >>= 4;
-
-                    int code = bits & 0x3;
-                    bits >>= 2;
-
-                    blockRowPtr[x] = c[code] | (a << 28) | (a << 24);
+            } else {
+                // Don't process pixels past the right or bottom edge,
+                // but each row of the block still has 4 codes
+                for (int y = 0; y < h; y++, blockRowPtr += stride) {
+                    for (int x = 0; x < w; x++) {
+                        int a = (alpha >> (4*x)) & 0xf;
+                        int code = (bits >> (2*x)) & 0x3;
+                        blockRowPtr[x] = c[code] | (a << 28) | (a << 24);
+                    }
+                    alpha >>= 16;
+                    bits >>= 8;
                 }
             }
         }
@@ -514,54 +516,54 @@ decodeDXT5(const GLvoid *data, int width, int height,
                 prev_color0 = color0;
                 prev_color1 = color1;
                 
-                int bbits = bits >> 1;
-                bool has2 = ((bbits & ~bits) & 0x55555555) != 0;
-                bool has3 = ((bbits &  bits) & 0x55555555) != 0;
-                
-                if (has2 || has3) {
-                    int r0 =   red(color0);
-                    int g0 = green(color0);
-                    int b0 =  blue(color0);
-                    
-                    int r1 =   red(color1);
-                    int g1 = green(color1);
-                    int b1 =  blue(color1);
-                
-                    int r2 = avg23(r0, r1);
-                    int g2 = avg23(g0, g1);
-                    int b2 = avg23(b0, b1);
-                    
-                    int r3 = avg23(r1, r0);
-                    int g3 = avg23(g1, g0);
-                    int b3 = avg23(b1, b0);
-
-                    c[0] = rgb565SepTo888(r0, g0, b0);
-                    c[1] = rgb565SepTo888(r1, g1, b1);
-                    c[2] = rgb565SepTo888(r2, g2, b2);
-                    c[3] = rgb565SepTo888(r3, g3, b3);
-                } else {
-                    // Convert to 8 bits
-                    c[0] = rgb565To888(color0);
-                    c[1] = rgb565To888(color1);
-                }                
+                // The whole table is needed: the next block may reuse it
+                // and have codes that this one doesn't.
+                int r0 =   red(color0);
+                int g0 = green(color0);
+                int b0 =  blue(color0);
+
+                int r1 =   red(color1);
+                int g1 = green(color1);
+                int b1 =  blue(color1);
+
+                int r2 = avg23(r0, r1);
+                int g2 = avg23(g0, g1);
+                int b2 = avg23(b0, b1);
+
+                int r3 = avg23(r1, r0);
+                int g3 = avg23(g1, g0);
+                int b3 = avg23(b1, b0);
+
+                c[0] = rgb565SepTo888(r0, g0, b0);
+                c[1] = rgb565SepTo888(r1, g1, b1);
+                c[2] = rgb565SepTo888(r2, g2, b2);
+                c[3] = rgb565SepTo888(r3, g3, b3);
             }
 
             uint32_t* blockRowPtr = blockPtr;
-            for (int y = 0; y < 4; y++, blockRowPtr += stride) {
-                // Don't process rows past the botom
-                if (base_y + y >= height) {
-                    break;
+            const int w = min(width - base_x, 4);
+            const int h = min(height - base_y, 4);
+            if (ggl_likely(w == 4 && h == 4)) {
+                for (int y = 0; y < 4; y++, blockRowPtr += stride) {
+                    const uint32_t ac = uint32_t(alpha) & 0xfff;
+                    blockRowPtr[0] = c[ bits       & 0x3] | (a[ ac       & 0x7] << 24);
+                    blockRowPtr[1] = c[(bits >> 2) & 0x3] | (a[(ac >> 3) & 0x7] << 24);
+                    blockRowPtr[2] = c[(bits >> 4) & 0x3] | (a[(ac >> 6) & 0x7] << 24);
+                    blockRowPtr[3] = c[(bits >> 6) & 0x3] | (a[(ac >> 9) & 0x7] << 24);
+                    alpha >>= 12;
+                    bits >>= 8;
                 }
-                
-                int w = min(width - base_x, 4);
-                for (int x = 0; x < w; x++) {
-                    int acode = alpha & 0x7;
-                    alpha >>= 3;
-
-                    int code = bits & 0x3;
-                    bits >>= 2;
-
-                    blockRowPtr[x] = c[code] | (a[acode] << 24);
+            } else {
+                // Don't process pixels past the right or bottom edge,
+                // but each row of the block still has 4 codes
+                for (int y = 0; y < h; y++, blockRowPtr += stride) {
+                    for (int x = 0; x < w; x++) {
+                        int acode = (alpha >> (3*x)) & 0x7;
+                        int code = (bits >> (2*x)) & 0x3;
+                        blockRowPtr[x] = c[code] | (a[acode] << 24);
+                    }
+                    alpha >>= 12;
+                    bits >>= 8;
                 }
             }
         }
@@ -44,6 +44,7 @@
 #include "context.h"
 #include "state.h"
 #include "texture.h"
+#include "tiler.h"
 #include "matrix.h"
 
 #undef NELEM
@@ -165,6 +166,7 @@ struct egl_surface_t
     virtual     EGLint      getVerticalResolution() const;
     virtual     EGLint      getRefreshRate() const;
     virtual     EGLint      getSwapBehavior() const;
+    virtual     EGLint      getBufferAge() const;
     virtual     EGLBoolean  swapBuffers();
     virtual     EGLBoolean  setSwapRectangle(EGLint l, EGLint t, EGLint w, EGLint h);
 protected:
@@ -205,6 +207,9 @@ EGLint egl_surface_t::getRefreshRate() const {
 EGLint egl_surface_t::getSwapBehavior() const {
     return EGL_BUFFER_PRESERVED;
 }
+EGLint egl_surface_t::getBufferAge() const {
+    return 0;
+}
 EGLBoolean egl_surface_t::setSwapRectangle(
         EGLint l, EGLint t, EGLint w, EGLint h)
 {
@@ -234,6 +239,7 @@ struct egl_window_surface_v2_t : public egl_surface_t
     virtual     EGLint      getVerticalResolution() const;
     virtual     EGLint      getRefreshRate() const;
     virtual     EGLint      getSwapBehavior() const;
+    virtual     EGLint      getBufferAge() const;
     virtual     EGLBoolean  setSwapRectangle(EGLint l, EGLint t, EGLint w, EGLint h);
     
 private:
@@ -261,6 +267,15 @@ private:
             bottom = min(bottom, r.bottom);
             return *this;
         }
+        Rect& orSelf(const Rect& r) {
+            if (r.isEmpty()) return *this;
+            if (isEmpty()) return (*this = r);
+            left   = min(left, r.left);
+            top    = min(top, r.top);
+            right  = max(right, r.right);
+            bottom = max(bottom, r.bottom);
+            return *this;
+        }
         bool isEmpty() const {
             return (left>=right || top>=bottom);
         }
@@ -333,8 +348,27 @@ private:
             ANativeWindowBuffer* src, void const* src_vaddr,
             const Region& clip);
 
+    /*
+     * Buffer age tracking (EGL_EXT_buffer_age).
+     * We remember which frame each buffer last held and the dirty rect of
+     * the last few frames, so that on swap only what changed since the
+     * current buffer was last queued needs to be copied back.
+     */
+    enum { MAX_BUFFERS = 4, HISTORY = 4 };
+    struct BufferFrame {
+        ANativeWindowBuffer* buffer;
+        uint32_t frame;
+    };
+    void trackQueuedBuffer(ANativeWindowBuffer* buf);
+    void updateBufferAge();
+    void clearBufferAges();
+
     Rect dirtyRegion;
-    Rect oldDirtyRegion;
+    Rect dirtyHistory[HISTORY];
+    BufferFrame bufferFrames[MAX_BUFFERS];
+    uint32_t frameCount;
+    EGLint bufferAge;
+    mutable bool bufferAgeQueried;
 };
 
 egl_window_surface_v2_t::egl_window_surface_v2_t(EGLDisplay dpy,
@@ -343,8 +377,10 @@ egl_window_surface_v2_t::egl_window_surface_v2_t(EGLDisplay dpy,
         ANativeWindow* window)
     : egl_surface_t(dpy, config, depthFormat), 
     nativeWindow(window), buffer(0), previousBuffer(0), module(0),
-    bits(NULL)
+    bits(NULL), frameCount(0), bufferAge(0), bufferAgeQueried(false)
 {
+    memset(bufferFrames, 0, sizeof(bufferFrames));
+
     hw_module_t const* pModule;
     hw_get_module(GRALLOC_HARDWARE_MODULE_ID, &pModule);
     module = reinterpret_cast<gralloc_module_t const*>(pModule);
@@ -364,6 +400,7 @@ egl_window_surface_v2_t::~egl_window_surface_v2_t() {
     if (previousBuffer) {
         previousBuffer->common.decRef(&previousBuffer->common); 
     }
+    clearBufferAges();
     nativeWindow->common.decRef(&nativeWindow->common);
 }
 
@@ -402,6 +439,7 @@ EGLBoolean egl_window_surface_v2_t::connect()
 
     // keep a reference on the buffer
     buffer->common.incRef(&buffer->common);
+    updateBufferAge();
 
     // pin the buffer down
     if (lock(buffer, GRALLOC_USAGE_SW_READ_OFTEN | 
@@ -429,6 +467,57 @@ void egl_window_surface_v2_t::disconnect()
         previousBuffer->common.decRef(&previousBuffer->common); 
         previousBuffer = 0;
     }
+    clearBufferAges();
+}
+
+void egl_window_surface_v2_t::trackQueuedBuffer(ANativeWindowBuffer* buf)
+{
+    // the slot holding this buffer, or else the one holding the oldest
+    BufferFrame* slot = bufferFrames;
+    for (size_t i=0 ; i<MAX_BUFFERS ; i++) {
+        BufferFrame& bf(bufferFrames[i]);
+        if (bf.buffer == buf) {
+            slot = &bf;
+            break;
+        }
+        if (!bf.buffer || (slot->buffer && bf.frame < slot->frame)) {
+            slot = &bf;
+        }
+    }
+    if (slot->buffer != buf) {
+        // hold a reference so the pointer can't be recycled for
+        // another buffer while we still remember its age
+        if (slot->buffer) {
+            slot->buffer->common.decRef(&slot->buffer->common);
+        }
+        buf->common.incRef(&buf->common);
+        slot->buffer = buf;
+    }
+    slot->frame = frameCount;
+}
+
+void egl_window_surface_v2_t::updateBufferAge()
+{
+    bufferAge = 0;
+    for (size_t i=0 ; i<MAX_BUFFERS ; i++) {
+        if (bufferFrames[i].buffer == buffer) {
+            bufferAge = frameCount + 1 - bufferFrames[i].frame;
+            break;
+        }
+    }
+    bufferAgeQueried = false;
+}
+
+void egl_window_surface_v2_t::clearBufferAges()
+{
+    for (size_t i=0 ; i<MAX_BUFFERS ; i++) {
+        BufferFrame& bf(bufferFrames[i]);
+        if (bf.buffer) {
+            bf.buffer->common.decRef(&bf.buffer->common);
+            bf.buffer = 0;
+        }
+    }
+    bufferAge = 0;
 }
 
 status_t egl_window_surface_v2_t::lock(
@@ -497,14 +586,29 @@ EGLBoolean egl_window_surface_v2_t::swapBuffers()
     
     /*
      * Handle eglSetSwapRectangleANDROID()
-     * We copyback from the front buffer 
+     * We copyback from the front buffer everything that changed since
+     * this buffer was last queued. If the client queried the buffer age
+     * it took care of that itself.
      */
+    const Rect bounds(buffer->width, buffer->height);
+    Rect damage(bounds);
     if (!dirtyRegion.isEmpty()) {
-        dirtyRegion.andSelf(Rect(buffer->width, buffer->height));
-        if (previousBuffer) {
+        dirtyRegion.andSelf(bounds);
+        damage = dirtyRegion;
+        if (previousBuffer && !bufferAgeQueried) {
+            Rect stale;
+            if (bufferAge <= 0 || bufferAge > HISTORY+1) {
+                stale = bounds;
+            } else {
+                stale = Rect(0, 0);
+                for (uint32_t f=frameCount+2-bufferAge ; f<=frameCount ; f++) {
+                    stale.orSelf(dirtyHistory[f % HISTORY]);
+                }
+                stale.andSelf(bounds);
+            }
             // This was const Region copyBack, but that causes an
             // internal compile error on simulator builds
-            /*const*/ Region copyBack(Region::subtract(oldDirtyRegion, dirtyRegion));
+            /*const*/ Region copyBack(Region::subtract(stale, dirtyRegion));
             if (!copyBack.isEmpty()) {
                 void* prevBits;
                 if (lock(previousBuffer, 
@@ -515,8 +619,9 @@ EGLBoolean egl_window_surface_v2_t::swapBuffers()
                 }
             }
         }
-        oldDirtyRegion = dirtyRegion;
     }
+    frameCount++;
+    dirtyHistory[frameCount % HISTORY] = damage;
 
     if (previousBuffer) {
         previousBuffer->common.decRef(&previousBuffer->common); 
@@ -525,6 +630,7 @@ EGLBoolean egl_window_surface_v2_t::swapBuffers()
     
     unlock(buffer);
     previousBuffer = buffer;
+    trackQueuedBuffer(buffer);
     nativeWindow->queueBuffer(nativeWindow, buffer, -1);
     buffer = 0;
 
@@ -541,6 +647,8 @@ EGLBoolean egl_window_surface_v2_t::swapBuffers()
         if ((width != buffer->width) || (height != buffer->height)) {
             // TODO: we probably should reset the swap rect here
             // if the window size has changed
+            // the contents of the buffers we've seen are stale now
+            clearBufferAges();
             width = buffer->width;
             height = buffer->height;
             if (depth.data) {
@@ -558,6 +666,7 @@ EGLBoolean egl_window_surface_v2_t::swapBuffers()
 
         // keep a reference on the buffer
         buffer->common.incRef(&buffer->common);
+        updateBufferAge();
 
         // finally pin the buffer down
         if (lock(buffer, GRALLOC_USAGE_SW_READ_OFTEN |
@@ -635,6 +744,13 @@ EGLint egl_window_surface_v2_t::getSwapBehavior() const
 
     return EGL_BUFFER_DESTROYED;
 }
+EGLint egl_window_surface_v2_t::getBufferAge() const
+{
+    // once the client knows the age it repairs the buffer itself,
+    // so swapBuffers() no longer needs to copy anything back
+    bufferAgeQueried = true;
+    return bufferAge;
+}
 
 // ----------------------------------------------------------------------------
 
@@ -811,6 +927,7 @@ static char const * const gExtensionsString =
         // "KHR_image_pixmap "
         "EGL_ANDROID_image_native_buffer "
         "EGL_ANDROID_swap_rectangle "
+        "EGL_EXT_buffer_age "
         ;
 
 // ----------------------------------------------------------------------------
@@ -1648,6 +1765,9 @@ EGLBoolean eglQuerySurface( EGLDisplay dpy, EGLSurface eglSurface,
         case EGL_SWAP_BEHAVIOR:
             *value = surface->getSwapBehavior();
             break;
+        case EGL_BUFFER_AGE_EXT:
+            *value = surface->getBufferAge();
+            break;
         default:
             ret = setError(EGL_BAD_ATTRIBUTE, EGL_FALSE);
     }
@@ -1736,6 +1856,7 @@ EGLBoolean eglMakeCurrent(  EGLDisplay dpy, EGLSurface draw,
             
             if (c->draw) {
                 egl_surface_t* s = reinterpret_cast<egl_surface_t*>(c->draw);
+                ogles_flush_tiles(gl);
                 s->disconnect();
                 s->ctx = EGL_NO_CONTEXT;
                 if (s->zombie)
@@ -1869,7 +1990,10 @@ EGLBoolean eglSwapBuffers(EGLDisplay dpy, EGLSurface draw)
     if (d->dpy != dpy)
         return setError(EGL_BAD_DISPLAY, EGL_FALSE);
 
-    // post the surface
+    // finish drawing into the back buffer, then post it
+    if (d->ctx != EGL_NO_CONTEXT) {
+        ogles_flush_tiles((ogles_context_t*)d->ctx);
+    }
     d->swapBuffers();
 
     // if it's bound to a context, update the buffer
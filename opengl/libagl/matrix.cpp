@@ -18,6 +18,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include "context.h"
 #include "fp.h"
 #include "state.h"
@@ -57,6 +61,18 @@ static void point3__generic(transform_t const*, vec4_t* c, vec4_t const* o);
 static void point4__generic(transform_t const*, vec4_t* c, vec4_t const* o);
 static void point3__mvui(transform_t const*, vec4_t* c, vec4_t const* o);
 static void point4__mvui(transform_t const*, vec4_t* c, vec4_t const* o);
+static void points2__nop(transform_t const*, vec4_t* c, vec4_t const* o,
+        size_t count, size_t stride);
+static void points3__nop(transform_t const*, vec4_t* c, vec4_t const* o,
+        size_t count, size_t stride);
+static void points4__nop(transform_t const*, vec4_t* c, vec4_t const* o,
+        size_t count, size_t stride);
+static void points2__generic(transform_t const*, vec4_t* c, vec4_t const* o,
+        size_t count, size_t stride);
+static void points3__generic(transform_t const*, vec4_t* c, vec4_t const* o,
+        size_t count, size_t stride);
+static void points4__generic(transform_t const*, vec4_t* c, vec4_t const* o,
+        size_t count, size_t stride);
 
 // ----------------------------------------------------------------------------
 #if 0
@@ -77,6 +93,7 @@ void ogles_init_matrix(ogles_context_t* c)
                             transform_state_t::MVIT |
                             transform_state_t::MVP;
     c->transforms.mvp.loadIdentity();
+    c->transforms.mvpf.loadIdentity();
     c->transforms.mvp4.loadIdentity();
     c->transforms.mvit4.loadIdentity();
     c->transforms.mvui.loadIdentity();
@@ -113,12 +130,19 @@ static void validate_perspective(ogles_context_t* c, vertex_t* v)
 void ogles_invalidate_perspective(ogles_context_t* c)
 {
     c->arrays.perspective = validate_perspective;
+    c->transforms.generation++;
 }
 
 void ogles_validate_transform_impl(ogles_context_t* c, uint32_t want)
 {
     int dirty = c->transforms.dirty & want;
 
+    if (dirty & (   transform_state_t::MODELVIEW |
+                    transform_state_t::VIEWPORT |
+                    transform_state_t::MVP)) {
+        c->transforms.generation++;
+    }
+
     // Validate the modelview
     if (dirty & transform_state_t::MODELVIEW) {
         c->transforms.modelview.validate();
@@ -176,6 +200,9 @@ void transform_t::loadIdentity() {
     point2 = point2__nop;
     point3 = point3__nop;
     point4 = point4__nop;
+    points2 = points2__nop;
+    points3 = points3__nop;
+    points4 = points4__nop;
 }
 
 
@@ -199,6 +226,9 @@ void transform_t::picker()
     point2 = point2__generic;
     point3 = point3__generic;
     point4 = point4__generic;
+    points2 = points2__generic;
+    points3 = points3__generic;
+    points4 = points4__generic;
     
     // find out if this is a 2D projection
     if (!(notZero(m[3]) | notZero(m[7]) | notZero(m[11]) | notOne(m[15]))) {
@@ -212,6 +242,10 @@ void mvui_transform_t::picker()
     ops = OP_ALL;
     point3 = point3__mvui;
     point4 = point4__mvui;
+    // normals and lights are only ever transformed one at a time
+    points2 = 0;
+    points3 = 0;
+    points4 = 0;
 }
 
 void transform_t::dump(const char* what)
@@ -519,8 +553,10 @@ void transform_state_t::update_mvp()
         matrixf_t::multiply(mvpv, vpt.matrix, temp_mvp);
         mvp.matrix.load(mvpv);
         mvp.picker();
+        mvpf.load(mvpv);
     } else {
         mvp = mvp4;
+        mvpf.load(temp_mvp);
     }
 }
 
@@ -806,6 +842,149 @@ void point4__nop(transform_t const*, vec4_t* lhs, vec4_t const* rhs) {
         *lhs = *rhs;
 }
 
+// ----------------------------------------------------------------------------
+#if 0
+#pragma mark -
+#pragma mark matrix * vertices
+#endif
+
+/*
+ * These transform a batch of vertices, typically the obj -> clip step of
+ * a whole vertex buffer in compileElements. They give the same results as
+ * the pointN functions, but take the matrix out of the loop, and on NEON
+ * do the 4 multiply-accumulates of a vertex in 2 64-bit lanes at a time.
+ */
+
+static inline vec4_t* nextVec4(vec4_t* v, size_t stride) {
+    return reinterpret_cast<vec4_t*>(reinterpret_cast<uint8_t*>(v) + stride);
+}
+
+static inline vec4_t const* nextVec4(vec4_t const* v, size_t stride) {
+    return reinterpret_cast<vec4_t const*>(
+            reinterpret_cast<uint8_t const*>(v) + stride);
+}
+
+#if defined(__ARM_NEON__)
+
+// lhs = (m * rhs) for 'size' components of rhs, with the last column of
+// m added as is (scaled by 1.0) when 'translate' is set, like mlaNa() does.
+template <int SIZE, bool TRANSLATE>
+static inline void points__neon(const GLfixed* m,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride)
+{
+    const int32x4_t c0 = vld1q_s32(m);
+    const int32x4_t c1 = vld1q_s32(m + 4);
+    const int32x4_t c2 = vld1q_s32(m + 8);
+    const int32x4_t c3 = vld1q_s32(m + 12);
+    // adding t<<16 before the shift is the same as adding t after it
+    const int64x2_t t01 = vshll_n_s32(vget_low_s32(c3), 16);
+    const int64x2_t t23 = vshll_n_s32(vget_high_s32(c3), 16);
+    do {
+        const GLfixed* const r = rhs->v;
+        int64x2_t xy, zw;
+        if (TRANSLATE) {
+            xy = vmlal_n_s32(t01, vget_low_s32(c0),  r[0]);
+            zw = vmlal_n_s32(t23, vget_high_s32(c0), r[0]);
+        } else {
+            xy = vmull_n_s32(vget_low_s32(c0),  r[0]);
+            zw = vmull_n_s32(vget_high_s32(c0), r[0]);
+        }
+        xy = vmlal_n_s32(xy, vget_low_s32(c1),  r[1]);
+        zw = vmlal_n_s32(zw, vget_high_s32(c1), r[1]);
+        if (SIZE >= 3) {
+            xy = vmlal_n_s32(xy, vget_low_s32(c2),  r[2]);
+            zw = vmlal_n_s32(zw, vget_high_s32(c2), r[2]);
+        }
+        if (SIZE >= 4) {
+            xy = vmlal_n_s32(xy, vget_low_s32(c3),  r[3]);
+            zw = vmlal_n_s32(zw, vget_high_s32(c3), r[3]);
+        }
+        vst1q_s32(lhs->v, vcombine_s32(vshrn_n_s64(xy, 16), vshrn_n_s64(zw, 16)));
+        lhs = nextVec4(lhs, stride);
+        rhs = nextVec4(rhs, stride);
+    } while (--count);
+}
+
+void points2__generic(transform_t const* mx,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride) {
+    points__neon<2, true>(mx->matrix.m, lhs, rhs, count, stride);
+}
+
+void points3__generic(transform_t const* mx,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride) {
+    points__neon<3, true>(mx->matrix.m, lhs, rhs, count, stride);
+}
+
+void points4__generic(transform_t const* mx,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride) {
+    points__neon<4, false>(mx->matrix.m, lhs, rhs, count, stride);
+}
+
+#else
+
+void points2__generic(transform_t const* mx,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride) {
+    // a local copy, so the compiler knows lhs doesn't alias it
+    transform_t t;
+    t.matrix = mx->matrix;
+    do {
+        point2__generic(&t, lhs, rhs);
+        lhs = nextVec4(lhs, stride);
+        rhs = nextVec4(rhs, stride);
+    } while (--count);
+}
+
+void points3__generic(transform_t const* mx,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride) {
+    transform_t t;
+    t.matrix = mx->matrix;
+    do {
+        point3__generic(&t, lhs, rhs);
+        lhs = nextVec4(lhs, stride);
+        rhs = nextVec4(rhs, stride);
+    } while (--count);
+}
+
+void points4__generic(transform_t const* mx,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride) {
+    transform_t t;
+    t.matrix = mx->matrix;
+    do {
+        point4__generic(&t, lhs, rhs);
+        lhs = nextVec4(lhs, stride);
+        rhs = nextVec4(rhs, stride);
+    } while (--count);
+}
+
+#endif
+
+void points2__nop(transform_t const*,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride) {
+    do {
+        point2__nop(0, lhs, rhs);
+        lhs = nextVec4(lhs, stride);
+        rhs = nextVec4(rhs, stride);
+    } while (--count);
+}
+
+void points3__nop(transform_t const*,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride) {
+    do {
+        point3__nop(0, lhs, rhs);
+        lhs = nextVec4(lhs, stride);
+        rhs = nextVec4(rhs, stride);
+    } while (--count);
+}
+
+void points4__nop(transform_t const*,
+        vec4_t* lhs, vec4_t const* rhs, size_t count, size_t stride) {
+    do {
+        point4__nop(0, lhs, rhs);
+        lhs = nextVec4(lhs, stride);
+        rhs = nextVec4(rhs, stride);
+    } while (--count);
+}
+
 
 static void frustumf(
             GLfloat left, GLfloat right, 
@@ -18,6 +18,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "context.h"
 #include "state.h"
 #include "texture.h"
@@ -27,6 +33,162 @@ namespace android {
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Box filters for the common formats. Each one averages the 2x2 blocks of
+ * rows r0 and r1 into w pixels of dst, rounding down like the generic code
+ * below, and gives exactly the same results.
+ */
+
+static void downsample_565(uint16_t* dst,
+        uint16_t const* r0, uint16_t const* r1, int w)
+{
+    int x = 0;
+#if defined(__ARM_NEON__)
+    const uint16x8_t m5 = vdupq_n_u16(0x1F);
+    const uint16x8_t m6 = vdupq_n_u16(0x3F);
+    for ( ; x+4 <= w ; x+=4) {
+        const uint16x8_t a = vld1q_u16(r0 + 2*x);
+        const uint16x8_t b = vld1q_u16(r1 + 2*x);
+        uint16x8_t r = vaddq_u16(vshrq_n_u16(a, 11), vshrq_n_u16(b, 11));
+        uint16x8_t g = vaddq_u16(vandq_u16(vshrq_n_u16(a, 5), m6),
+                                 vandq_u16(vshrq_n_u16(b, 5), m6));
+        uint16x8_t l = vaddq_u16(vandq_u16(a, m5), vandq_u16(b, m5));
+        uint16x4_t R = vshrn_n_u32(vpaddlq_u16(r), 2);
+        uint16x4_t G = vshrn_n_u32(vpaddlq_u16(g), 2);
+        uint16x4_t B = vshrn_n_u32(vpaddlq_u16(l), 2);
+        vst1_u16(dst + x, vorr_u16(vorr_u16(vshl_n_u16(R, 11),
+                vshl_n_u16(G, 5)), B));
+    }
+#elif defined(__SSE2__)
+    const __m128i m5 = _mm_set1_epi16(0x1F);
+    const __m128i m6 = _mm_set1_epi16(0x3F);
+    const __m128i lo = _mm_set1_epi32(0xFFFF);
+    for ( ; x+8 <= w ; x+=8) {
+        __m128i p[2];
+        for (int i=0 ; i<2 ; i++) {
+            const __m128i a = _mm_loadu_si128((__m128i const*)(r0 + 2*x + 8*i));
+            const __m128i b = _mm_loadu_si128((__m128i const*)(r1 + 2*x + 8*i));
+            __m128i r = _mm_add_epi16(_mm_srli_epi16(a, 11), _mm_srli_epi16(b, 11));
+            __m128i g = _mm_add_epi16(_mm_and_si128(_mm_srli_epi16(a, 5), m6),
+                                      _mm_and_si128(_mm_srli_epi16(b, 5), m6));
+            __m128i l = _mm_add_epi16(_mm_and_si128(a, m5), _mm_and_si128(b, m5));
+            // add horizontal neighbours into 32-bit lanes
+            r = _mm_srli_epi32(_mm_add_epi32(_mm_and_si128(r, lo), _mm_srli_epi32(r, 16)), 2);
+            g = _mm_srli_epi32(_mm_add_epi32(_mm_and_si128(g, lo), _mm_srli_epi32(g, 16)), 2);
+            l = _mm_srli_epi32(_mm_add_epi32(_mm_and_si128(l, lo), _mm_srli_epi32(l, 16)), 2);
+            __m128i v = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 11),
+                    _mm_slli_epi32(g, 5)), l);
+            // sign extend, so that the signed pack below doesn't saturate
+            p[i] = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+        }
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi32(p[0], p[1]));
+    }
+#endif
+    const uint32_t mask = 0x07E0F81F;
+    for ( ; x<w ; x++) {
+        uint32_t p00 = r0[2*x];
+        uint32_t p10 = r0[2*x+1];
+        uint32_t p01 = r1[2*x];
+        uint32_t p11 = r1[2*x+1];
+        p00 = (p00 | (p00 << 16)) & mask;
+        p01 = (p01 | (p01 << 16)) & mask;
+        p10 = (p10 | (p10 << 16)) & mask;
+        p11 = (p11 | (p11 << 16)) & mask;
+        uint32_t grb = ((p00 + p10 + p01 + p11) >> 2) & mask;
+        uint32_t rgb = (grb & 0xFFFF) | (grb >> 16);
+        dst[x] = rgb;
+    }
+}
+
+static void downsample_8888(uint32_t* dst,
+        uint32_t const* r0, uint32_t const* r1, int w)
+{
+    int x = 0;
+#if defined(__ARM_NEON__)
+    for ( ; x+8 <= w ; x+=8) {
+        const uint8x16x4_t a = vld4q_u8((uint8_t const*)(r0 + 2*x));
+        const uint8x16x4_t b = vld4q_u8((uint8_t const*)(r1 + 2*x));
+        uint8x8x4_t d;
+        for (int i=0 ; i<4 ; i++) {
+            d.val[i] = vshrn_n_u16(
+                    vpadalq_u8(vpaddlq_u8(a.val[i]), b.val[i]), 2);
+        }
+        vst4_u8((uint8_t*)(dst + x), d);
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; x+4 <= w ; x+=4) {
+        __m128i h[2];
+        for (int i=0 ; i<2 ; i++) {
+            const __m128i a = _mm_loadu_si128((__m128i const*)(r0 + 2*x + 4*i));
+            const __m128i b = _mm_loadu_si128((__m128i const*)(r1 + 2*x + 4*i));
+            // 16 bits per component: pixels 0,1 and 2,3 of both rows
+            const __m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                                              _mm_unpacklo_epi8(b, zero));
+            const __m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                                              _mm_unpackhi_epi8(b, zero));
+            h[i] = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s01, s23),
+                                                _mm_unpackhi_epi64(s01, s23)), 2);
+        }
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(h[0], h[1]));
+    }
+#endif
+    for ( ; x<w ; x++) {
+        uint32_t p00 = r0[2*x];
+        uint32_t p10 = r0[2*x+1];
+        uint32_t p01 = r1[2*x];
+        uint32_t p11 = r1[2*x+1];
+        uint32_t rb00 = p00 & 0x00FF00FF;
+        uint32_t rb01 = p01 & 0x00FF00FF;
+        uint32_t rb10 = p10 & 0x00FF00FF;
+        uint32_t rb11 = p11 & 0x00FF00FF;
+        uint32_t ga00 = (p00 >> 8) & 0x00FF00FF;
+        uint32_t ga01 = (p01 >> 8) & 0x00FF00FF;
+        uint32_t ga10 = (p10 >> 8) & 0x00FF00FF;
+        uint32_t ga11 = (p11 >> 8) & 0x00FF00FF;
+        uint32_t rb = (rb00 + rb01 + rb10 + rb11)>>2;
+        uint32_t ga = (ga00 + ga01 + ga10 + ga11)>>2;
+        uint32_t rgba = (rb & 0x00FF00FF) | ((ga & 0x00FF00FF)<<8);
+        dst[x] = rgba;
+    }
+}
+
+static void downsample_8(uint8_t* dst,
+        uint8_t const* r0, uint8_t const* r1, int w)
+{
+    int x = 0;
+#if defined(__ARM_NEON__)
+    for ( ; x+8 <= w ; x+=8) {
+        uint16x8_t s = vpaddlq_u8(vld1q_u8(r0 + 2*x));
+        s = vpadalq_u8(s, vld1q_u8(r1 + 2*x));
+        vst1_u8(dst + x, vshrn_n_u16(s, 2));
+    }
+#elif defined(__SSE2__)
+    const __m128i lo = _mm_set1_epi16(0xFF);
+    for ( ; x+16 <= w ; x+=16) {
+        __m128i s[2];
+        for (int i=0 ; i<2 ; i++) {
+            const __m128i a = _mm_loadu_si128((__m128i const*)(r0 + 2*x + 16*i));
+            const __m128i b = _mm_loadu_si128((__m128i const*)(r1 + 2*x + 16*i));
+            s[i] = _mm_add_epi16(
+                    _mm_add_epi16(_mm_and_si128(a, lo), _mm_srli_epi16(a, 8)),
+                    _mm_add_epi16(_mm_and_si128(b, lo), _mm_srli_epi16(b, 8)));
+            s[i] = _mm_srli_epi16(s[i], 2);
+        }
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(s[0], s[1]));
+    }
+#endif
+    for ( ; x<w ; x++) {
+        uint32_t p00 = r0[2*x];
+        uint32_t p10 = r0[2*x+1];
+        uint32_t p01 = r1[2*x];
+        uint32_t p11 = r1[2*x+1];
+        dst[x] = (p00 + p10 + p01 + p11) >> 2;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
 status_t buildAPyramid(ogles_context_t* c, EGLTextureObject* tex)
 {
     int level = 0;
@@ -38,17 +200,16 @@ status_t buildAPyramid(ogles_context_t* c, EGLTextureObject* tex)
     if ((w&h) == 1)
         return NO_ERROR;
 
+    // all the levels go in a single allocation
+    if (tex->reallocateMipChain(pixelFormat.size) != NO_ERROR) {
+        return NO_MEMORY;
+    }
+
     w = (w>>1) ? : 1;
     h = (h>>1) ? : 1;
 
     while(true) {
         ++level;
-        const int bpr = w * pixelFormat.size;
-        if (tex->reallocate(level, w, h, w,
-                base->format, base->compressedFormat, bpr) != NO_ERROR) {
-            return NO_MEMORY;
-        }
-    
         int stride = w;
         int bs = base->stride;
         GGLSurface& cur = tex->editMip(level);
@@ -57,23 +218,9 @@ status_t buildAPyramid(ogles_context_t* c, EGLTextureObject* tex)
         {
             uint16_t const * src = (uint16_t const *)base->data;
             uint16_t* dst = (uint16_t*)cur.data;
-            const uint32_t mask = 0x07E0F81F;
             for (int y=0 ; y<h ; y++) {
-                size_t offset = (y*2) * bs;
-                for (int x=0 ; x<w ; x++) {
-                    uint32_t p00 = src[offset];
-                    uint32_t p10 = src[offset+1];
-                    uint32_t p01 = src[offset+bs];
-                    uint32_t p11 = src[offset+bs+1];
-                    p00 = (p00 | (p00 << 16)) & mask;
-                    p01 = (p01 | (p01 << 16)) & mask;
-                    p10 = (p10 | (p10 << 16)) & mask;
-                    p11 = (p11 | (p11 << 16)) & mask;
-                    uint32_t grb = ((p00 + p10 + p01 + p11) >> 2) & mask;
-                    uint32_t rgb = (grb & 0xFFFF) | (grb >> 16);
-                    dst[x + y*stride] = rgb;
-                    offset += 2;
-                }
+                uint16_t const * row = src + (y*2) * bs;
+                downsample_565(dst + y*stride, row, row + bs, w);
             }
         }
         else if (base->format == GGL_PIXEL_FORMAT_RGBA_5551)
@@ -101,39 +248,25 @@ status_t buildAPyramid(ogles_context_t* c, EGLTextureObject* tex)
             uint32_t const * src = (uint32_t const *)base->data;
             uint32_t* dst = (uint32_t*)cur.data;
             for (int y=0 ; y<h ; y++) {
-                size_t offset = (y*2) * bs;
-                for (int x=0 ; x<w ; x++) {
-                    uint32_t p00 = src[offset];
-                    uint32_t p10 = src[offset+1];
-                    uint32_t p01 = src[offset+bs];
-                    uint32_t p11 = src[offset+bs+1];
-                    uint32_t rb00 = p00 & 0x00FF00FF;
-                    uint32_t rb01 = p01 & 0x00FF00FF;
-                    uint32_t rb10 = p10 & 0x00FF00FF;
-                    uint32_t rb11 = p11 & 0x00FF00FF;
-                    uint32_t ga00 = (p00 >> 8) & 0x00FF00FF;
-                    uint32_t ga01 = (p01 >> 8) & 0x00FF00FF;
-                    uint32_t ga10 = (p10 >> 8) & 0x00FF00FF;
-                    uint32_t ga11 = (p11 >> 8) & 0x00FF00FF;
-                    uint32_t rb = (rb00 + rb01 + rb10 + rb11)>>2;
-                    uint32_t ga = (ga00 + ga01 + ga10 + ga11)>>2;
-                    uint32_t rgba = (rb & 0x00FF00FF) | ((ga & 0x00FF00FF)<<8);
-                    dst[x + y*stride] = rgba;
-                    offset += 2;
-                }
+                uint32_t const * row = src + (y*2) * bs;
+                downsample_8888(dst + y*stride, row, row + bs, w);
             }
         }
-        else if ((base->format == GGL_PIXEL_FORMAT_RGB_888) ||
-                 (base->format == GGL_PIXEL_FORMAT_LA_88) ||
-                 (base->format == GGL_PIXEL_FORMAT_A_8) ||
+        else if ((base->format == GGL_PIXEL_FORMAT_A_8) ||
                  (base->format == GGL_PIXEL_FORMAT_L_8))
         {
-            int skip;
-            switch (base->format) {
-            case GGL_PIXEL_FORMAT_RGB_888:  skip = 3;   break;
-            case GGL_PIXEL_FORMAT_LA_88:    skip = 2;   break;
-            default:                        skip = 1;   break;
+            uint8_t const * src = (uint8_t const *)base->data;
+            uint8_t* dst = (uint8_t*)cur.data;
+            for (int y=0 ; y<h ; y++) {
+                uint8_t const * row = src + (y*2) * bs;
+                downsample_8(dst + y*stride, row, row + bs, w);
             }
+        }
+        else if ((base->format == GGL_PIXEL_FORMAT_RGB_888) ||
+                 (base->format == GGL_PIXEL_FORMAT_LA_88))
+        {
+            const int skip =
+                    (base->format == GGL_PIXEL_FORMAT_RGB_888) ? 3 : 2;
             uint8_t const * src = (uint8_t const *)base->data;
             uint8_t* dst = (uint8_t*)cur.data;            
             bs *= skip;
@@ -17,6 +17,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include "context.h"
@@ -25,6 +26,7 @@
 #include "matrix.h"
 #include "vertex.h"
 #include "fp.h"
+#include "tiler.h"
 #include "TextureObjectManager.h"
 
 extern "C" void iterators0032(const void* that,
@@ -34,6 +36,10 @@ namespace android {
 
 // ----------------------------------------------------------------------------
 
+#define PRIMITIVE_STATISTICS    0
+
+// ----------------------------------------------------------------------------
+
 static void primitive_point(ogles_context_t* c, vertex_t* v);
 static void primitive_line(ogles_context_t* c, vertex_t* v0, vertex_t* v1);
 static void primitive_clip_triangle(ogles_context_t* c,
@@ -65,6 +71,29 @@ static void clip_triangle(ogles_context_t* c,
 static unsigned int clip_line(ogles_context_t* c,
         vertex_t* s, vertex_t* p);
 
+#if PRIMITIVE_STATISTICS
+static struct {
+    uint32_t triangles;     // triangles handed to primitive_clip_triangle
+    uint32_t clipped;       // ... that needed clipping
+    uint32_t culled;        // ... that were culled without clipping
+    uint32_t quads;         // quads handed to ogles_render_quad
+    uint32_t rects;         // ... that were drawn as a rectangle
+} gPrimitiveStats;
+
+static void dump_primitive_stats()
+{
+    const uint32_t triangles = gPrimitiveStats.triangles;
+    const uint32_t quads = gPrimitiveStats.quads;
+    printf( "triangles=%7u, clipped=%3u%%, culled=%3u%%,"
+            " quads=%7u, rects=%3u%%\n",
+            triangles,
+            triangles ? (gPrimitiveStats.clipped*100)/triangles : 0,
+            triangles ? (gPrimitiveStats.culled*100)/triangles : 0,
+            quads,
+            quads ? (gPrimitiveStats.rects*100)/quads : 0);
+}
+#endif
+
 // ----------------------------------------------------------------------------
 #if 0
 #pragma mark -
@@ -517,7 +546,7 @@ void primitive_point(ogles_context_t* c, vertex_t* v)
     }
 
     // Render our point...
-    c->rasterizer.procs.pointx(c, v->window.v, c->point.size);
+    ogles_pointx(c, v->window.v, c->point.size);
 }
 
 // ----------------------------------------------------------------------------
@@ -558,7 +587,7 @@ void primitive_line(ogles_context_t* c, vertex_t* v0, vertex_t* v1)
     }
 
     // render our line
-    c->rasterizer.procs.linex(c, v0->window.v, v1->window.v, c->line.width);
+    ogles_linex(c, v0->window.v, v1->window.v, c->line.width);
 }
 
 // ----------------------------------------------------------------------------
@@ -574,6 +603,11 @@ void primitive_nop_triangle(ogles_context_t* c,
 void primitive_clip_triangle(ogles_context_t* c,
         vertex_t* v0, vertex_t* v1, vertex_t* v2)
 {
+#if PRIMITIVE_STATISTICS
+    if (!(++gPrimitiveStats.triangles & 0xFFF))
+        dump_primitive_stats();
+#endif
+
     uint32_t cc = (v0->flags | v1->flags | v2->flags) & vertex_t::CLIP_ALL;
     if (ggl_likely(!cc)) {
         // code below must be as optimized as possible, this is the
@@ -582,8 +616,12 @@ void primitive_clip_triangle(ogles_context_t* c,
         // This triangle is not clipped, test if it's culled
         // unclipped triangle...
         c->lerp.initTriangle(v0, v1, v2);
-        if (cull_triangle(c, v0, v1, v2))
+        if (cull_triangle(c, v0, v1, v2)) {
+#if PRIMITIVE_STATISTICS
+            gPrimitiveStats.culled++;
+#endif
             return; // culled!
+        }
 
         // Fetch all texture coordinates if needed
         fetch_texcoord(c, v0, v1, v2);
@@ -595,6 +633,10 @@ void primitive_clip_triangle(ogles_context_t* c,
         return;
     }
 
+#if PRIMITIVE_STATISTICS
+    gPrimitiveStats.clipped++;
+#endif
+
     // The assumption here is that we're not going to clip very often,
     // and even more rarely will we clip a triangle that ends up
     // being culled out. So it's okay to light the vertices here, even though
@@ -609,6 +651,163 @@ void primitive_clip_triangle(ogles_context_t* c,
     clip_triangle(c, v0, v1, v2);
 }
 
+// ----------------------------------------------------------------------------
+#if 0
+#pragma mark -
+#pragma mark Quad
+#endif
+
+static inline
+bool linear(GLfixed tl, GLfixed tr, GLfixed bl, GLfixed br)
+{
+    // an attribute interpolates the same way over both halves of a
+    // rectangle if it's linear, that is if both diagonals sum the same.
+    return int64_t(tl) + br == int64_t(tr) + bl;
+}
+
+static inline
+vertex_t* other_vertex(vertex_t* w0, vertex_t* w1, vertex_t* w2,
+        vertex_t* v0, vertex_t* v1, vertex_t* v2)
+{
+    // the vertex of (w0, w1, w2) that's not in (v0, v1, v2)
+    if (w0 != v0 && w0 != v1 && w0 != v2)  return w0;
+    if (w1 != v0 && w1 != v1 && w1 != v2)  return w1;
+    return w2;
+}
+
+static bool render_rect(ogles_context_t* c,
+        vertex_t* v0, vertex_t* v1, vertex_t* v2,
+        vertex_t* w0, vertex_t* w1, vertex_t* w2)
+{
+    const uint32_t enables = c->rasterizer.state.enables;
+    if (ggl_unlikely(c->prims.renderTriangle != primitive_clip_triangle))
+        return false;
+    if (enables & (GGL_ENABLE_W | GGL_ENABLE_AA))
+        return false;
+
+    vertex_t* const a = other_vertex(v0, v1, v2, w0, w1, w2);
+    vertex_t* const d = other_vertex(w0, w1, w2, v0, v1, v2);
+    if ((v0->flags | v1->flags | v2->flags | d->flags) & vertex_t::CLIP_ALL)
+        return false;
+
+    // the four vertices must be the corners of a pixel aligned rectangle
+    vertex_t* const q[4] = { v0, v1, v2, d };
+    GGLcoord l = v0->window.x, r = l;
+    GGLcoord t = v0->window.y, b = t;
+    for (int i=1 ; i<4 ; i++) {
+        l = min(l, q[i]->window.x);
+        r = max(r, q[i]->window.x);
+        t = min(t, q[i]->window.y);
+        b = max(b, q[i]->window.y);
+    }
+    if (((l|t|r|b) & (TRI_ONE-1)) || l==r || t==b)
+        return false;
+
+    // corner[] is top-left, top-right, bottom-left, bottom-right
+    vertex_t* corner[4];
+    uint32_t corners = 0;
+    int ka = 0, kd = 0;
+    for (int i=0 ; i<4 ; i++) {
+        const GGLcoord x = q[i]->window.x;
+        const GGLcoord y = q[i]->window.y;
+        if ((x!=l && x!=r) || (y!=t && y!=b))
+            return false;
+        const int k = (x==r) | ((y==b)<<1);
+        if (corners & (1<<k))
+            return false;
+        corners |= 1<<k;
+        corner[k] = q[i];
+        if (q[i] == a)  ka = k;
+        if (q[i] == d)  kd = k;
+    }
+
+    // the vertices the triangles don't share must be opposite corners,
+    // otherwise the triangles overlap instead of covering the rectangle.
+    if ((ka ^ kd) != 3)
+        return false;
+
+    // culling looks at the first triangle only, so both must wind the same
+    c->lerp.initTriangle(w0, w1, w2);
+    const bool cw = c->lerp.area() > 0;
+    c->lerp.initTriangle(v0, v1, v2);
+    if (cw != (c->lerp.area() > 0))
+        return false;
+    if (cull_triangle(c, v0, v1, v2))
+        return true; // culled!
+
+    fetch_texcoord(c, v0, v1, v2);
+    fetch_texcoord(c, w0, w1, w2);
+    c->lighting.lightTriangle(c, v0, v1, v2);
+    c->lighting.lightTriangle(c, w0, w1, w2);
+
+    vertex_t const * const tl = corner[0];
+    vertex_t const * const tr = corner[1];
+    vertex_t const * const bl = corner[2];
+    vertex_t const * const br = corner[3];
+    if (enables & GGL_ENABLE_SMOOTH) {
+        for (int i=0 ; i<4 ; i++) {
+            if (!linear(tl->color.v[i], tr->color.v[i],
+                        bl->color.v[i], br->color.v[i]))
+                return false;
+        }
+    } else {
+        // flat shading uses the last vertex of each triangle
+        if (memcmp(v2->color.v, w2->color.v, sizeof(v2->color.v)))
+            return false;
+    }
+    if (enables & GGL_ENABLE_TMUS) {
+        for (int i=0 ; i<GGL_TEXTURE_UNIT_COUNT ; i++) {
+            if (!c->rasterizer.state.texture[i].enable)
+                continue;
+            if (!linear(tl->texture[i].S, tr->texture[i].S,
+                        bl->texture[i].S, br->texture[i].S) ||
+                !linear(tl->texture[i].T, tr->texture[i].T,
+                        bl->texture[i].T, br->texture[i].T))
+                return false;
+        }
+    }
+    if (enables & GGL_ENABLE_DEPTH_TEST) {
+        if (!linear(tl->window.z, tr->window.z, bl->window.z, br->window.z))
+            return false;
+    }
+    if (enables & GGL_ENABLE_FOG) {
+        if (!linear(tl->fog, tr->fog, bl->fog, br->fog))
+            return false;
+    }
+
+    // the first triangle's iterators are good for the whole rectangle
+    const uint32_t mask =   GGL_ENABLE_TMUS |
+                            GGL_ENABLE_SMOOTH |
+                            GGL_ENABLE_FOG |
+                            GGL_ENABLE_DEPTH_TEST;
+    if (enables & mask)
+        lerp_triangle(c, v0, v1, v2);
+
+    ogles_recti(c,
+            l >> TRI_FRACTION_BITS, t >> TRI_FRACTION_BITS,
+            r >> TRI_FRACTION_BITS, b >> TRI_FRACTION_BITS);
+    return true;
+}
+
+void ogles_render_quad(ogles_context_t* c,
+        vertex_t* v0, vertex_t* v1, vertex_t* v2,
+        vertex_t* w0, vertex_t* w1, vertex_t* w2)
+{
+#if PRIMITIVE_STATISTICS
+    gPrimitiveStats.quads++;
+#endif
+    if (render_rect(c, v0, v1, v2, w0, w1, w2)) {
+#if PRIMITIVE_STATISTICS
+        gPrimitiveStats.rects++;
+#endif
+        return;
+    }
+    if (!(v0->flags & v1->flags & v2->flags & vertex_t::CLIP_ALL))
+        c->prims.renderTriangle(c, v0, v1, v2);
+    if (!(w0->flags & w1->flags & w2->flags & vertex_t::CLIP_ALL))
+        c->prims.renderTriangle(c, w0, w1, w2);
+}
+
 // -----------------------------------------------------------------------
 
 void triangle(ogles_context_t* c,
@@ -625,7 +824,7 @@ void triangle(ogles_context_t* c,
     if (ggl_likely(enables & mask))
         lerp_triangle(c, v0, v1, v2);
 
-    c->rasterizer.procs.trianglex(c, v0->window.v, v1->window.v, v2->window.v);
+    ogles_trianglex(c, v0->window.v, v1->window.v, v2->window.v);
 }
 
 void lerp_triangle(ogles_context_t* c,
@@ -27,10 +27,18 @@ namespace android {
 
 namespace gl {
 struct ogles_context_t;
+struct vertex_t;
 };
 
 void ogles_validate_primitives(ogles_context_t* c);
 
+// Renders the triangles (v0, v1, v2) and (w0, w1, w2), which share an edge.
+// When they make up a screen aligned rectangle it's drawn as one, with
+// spans instead of two triangle setups.
+void ogles_render_quad(ogles_context_t* c,
+        vertex_t* v0, vertex_t* v1, vertex_t* v2,
+        vertex_t* w0, vertex_t* w1, vertex_t* w2);
+
 }; // namespace android
 
 #endif // ANDROID_OPENGLES_PRIMITIVES_H
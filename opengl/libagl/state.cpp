@@ -25,6 +25,7 @@
 #include "vertex.h"
 #include "light.h"
 #include "texture.h"
+#include "tiler.h"
 #include "BufferObjectManager.h"
 #include "TextureObjectManager.h"
 
@@ -72,6 +73,7 @@ ogles_context_t *ogles_init(size_t extra)
             (ogles_context_t *)((ptrdiff_t(base) + extra + 31) & ~0x1FL);
     memset(c, 0, sizeof(ogles_context_t));
     ggl_init_context(&(c->rasterizer));
+    ogles_init_tiler(c);
 
     // XXX: this should be passed as an argument
     sp<EGLSurfaceManager> smgr(new EGLSurfaceManager());
@@ -103,6 +105,7 @@ ogles_context_t *ogles_init(size_t extra)
 
 void ogles_uninit(ogles_context_t* c)
 {
+    ogles_uninit_tiler(c);
     ogles_uninit_array(c);
     ogles_uninit_matrix(c);
     ogles_uninit_vertex(c);
@@ -309,11 +312,13 @@ void glDisable(GLenum cap) {
 }
 
 void glFinish()
-{ // nothing to do for our software implementation
+{
+    ogles_flush_tiles(ogles_context_t::get());
 }
 
 void glFlush()
-{ // nothing to do for our software implementation
+{
+    ogles_flush_tiles(ogles_context_t::get());
 }
 
 GLenum glGetError()
@@ -563,7 +568,7 @@ void glBlendFunc(GLenum sfactor, GLenum dfactor) {
 
 void glClear(GLbitfield mask) {
     ogles_context_t* c = ogles_context_t::get();
-    c->rasterizer.procs.clear(c, mask);
+    ogles_clear(c, mask);
 }
 
 void glClearColorx(GLclampx red, GLclampx green, GLclampx blue, GLclampx alpha) {
@@ -21,10 +21,13 @@
 #include "fp.h"
 #include "state.h"
 #include "texture.h"
+#include "tiler.h"
 #include "TextureObjectManager.h"
 
 #include <ETC1/etc1.h>
 
+#include <ui/PixelConverter.h>
+
 namespace android {
 
 // ----------------------------------------------------------------------------
@@ -163,6 +166,8 @@ void ogles_unlock_textures(ogles_context_t* c)
                 gralloc_module_t const* module =
                     reinterpret_cast<gralloc_module_t const*>(pModule);
 
+                // the recorded drawing still reads from the buffer
+                ogles_flush_tiles(c);
                 module->unlock(module, native_buffer->handle);
                 u.texture->setImageBits(NULL);
                 c->rasterizer.procs.bindTexture(c, &(u.texture->surface));
@@ -288,6 +293,46 @@ int copyPixels(
         return 0;
     }
 
+    if ((dst.format == src.format) &&
+        (dst.stride > 0) && (src.stride > 0))
+    {
+        // no conversion needed, a sub-image or a different row alignment
+        const size_t size = c->rasterizer.formats[src.format].size;
+        const size_t dbpr = dst.stride * size;
+        const size_t sbpr = src.stride * size;
+        const size_t bytes = w * size;
+        uint8_t* d = (uint8_t*)dst.data + yoffset * dbpr + xoffset * size;
+        uint8_t const* s = (uint8_t const*)src.data + y * sbpr + x * size;
+        for (GLsizei i=0 ; i<h ; i++) {
+            memcpy(d, s, bytes);
+            d += dbpr;
+            s += sbpr;
+        }
+        return 0;
+    }
+
+    // the usual RGB conversions (ggl formats have the same values as
+    // PixelFormat) are done a row at a time by libui's SIMD kernels, the
+    // formats of less than 2 bytes per pixel are left to pixel-flinger
+    const PixelConverter converter(src.format, dst.format);
+    if ((converter.initCheck() == NO_ERROR) &&
+        (c->rasterizer.formats[src.format].size >= 2) &&
+        (dst.stride > 0) && (src.stride > 0))
+    {
+        const size_t dsize = c->rasterizer.formats[dst.format].size;
+        const size_t ssize = c->rasterizer.formats[src.format].size;
+        const size_t dbpr = dst.stride * dsize;
+        const size_t sbpr = src.stride * ssize;
+        uint8_t* d = (uint8_t*)dst.data + yoffset * dbpr + xoffset * dsize;
+        uint8_t const* s = (uint8_t const*)src.data + y * sbpr + x * ssize;
+        for (GLsizei i=0 ; i<h ; i++) {
+            converter.convertRow(d, s, w);
+            d += dbpr;
+            s += sbpr;
+        }
+        return 0;
+    }
+
     // use pixel-flinger to handle all the conversions
     GGLContext* ggl = getRasterizer(c);
     if (!ggl) {
@@ -746,7 +791,7 @@ static void drawTexxOESImp(GLfixed x, GLfixed y, GLfixed z, GLfixed w, GLfixed h
     c->rasterizer.procs.disable(c, GGL_W_LERP);
     c->rasterizer.procs.disable(c, GGL_AA);
     c->rasterizer.procs.shadeModel(c, GL_FLAT);
-    c->rasterizer.procs.recti(c,
+    ogles_recti(c,
             gglFixedToIntRound(x),
             gglFixedToIntRound(y),
             gglFixedToIntRound(x)+w,
@@ -824,7 +869,7 @@ static void drawTexiOES(GLint x, GLint y, GLint z, GLint w, GLint h, ogles_conte
             c->rasterizer.procs.disable(c, GGL_W_LERP);
             c->rasterizer.procs.disable(c, GGL_AA);
             c->rasterizer.procs.shadeModel(c, GL_FLAT);
-            c->rasterizer.procs.recti(c, x, y, x+w, y+h);
+            ogles_recti(c, x, y, x+w, y+h);
 
             ogles_unlock_textures(c);
 
@@ -902,6 +947,7 @@ void glGenTextures(GLsizei n, GLuint *textures)
 void glDeleteTextures(GLsizei n, const GLuint *textures)
 {
     ogles_context_t* c = ogles_context_t::get();
+    ogles_flush_tiles(c);
     if (n<0) {
         ogles_error(c, GL_INVALID_VALUE);
         return;
@@ -1059,6 +1105,7 @@ void glCompressedTexImage2D(
         GLsizei imageSize, const GLvoid *data)
 {
     ogles_context_t* c = ogles_context_t::get();
+    ogles_flush_tiles(c);
     if (target != GL_TEXTURE_2D) {
         ogles_error(c, GL_INVALID_ENUM);
         return;
@@ -1169,6 +1216,7 @@ void glTexImage2D(
         GLenum format, GLenum type, const GLvoid *pixels)
 {
     ogles_context_t* c = ogles_context_t::get();
+    ogles_flush_tiles(c);
     if (target != GL_TEXTURE_2D) {
         ogles_error(c, GL_INVALID_ENUM);
         return;
@@ -1238,6 +1286,7 @@ void glTexSubImage2D(
         GLenum format, GLenum type, const GLvoid *pixels)
 {
     ogles_context_t* c = ogles_context_t::get();
+    ogles_flush_tiles(c);
     if (target != GL_TEXTURE_2D) {
         ogles_error(c, GL_INVALID_ENUM);
         return;
@@ -1316,6 +1365,7 @@ void glCopyTexImage2D(
         GLint border)
 {
     ogles_context_t* c = ogles_context_t::get();
+    ogles_flush_tiles(c);
     if (target != GL_TEXTURE_2D) {
         ogles_error(c, GL_INVALID_ENUM);
         return;
@@ -1422,6 +1472,7 @@ void glCopyTexSubImage2D(
         GLint x, GLint y, GLsizei width, GLsizei height)
 {
     ogles_context_t* c = ogles_context_t::get();
+    ogles_flush_tiles(c);
     if (target != GL_TEXTURE_2D) {
         ogles_error(c, GL_INVALID_ENUM);
         return;
@@ -1484,6 +1535,7 @@ void glReadPixels(
         GLenum format, GLenum type, GLvoid *pixels)
 {
     ogles_context_t* c = ogles_context_t::get();
+    ogles_flush_tiles(c);
     if ((format != GL_RGBA) && (format != GL_RGB)) {
         ogles_error(c, GL_INVALID_ENUM);
         return;
@@ -1604,6 +1656,7 @@ void glDrawTexxOES(GLfixed x, GLfixed y, GLfixed z, GLfixed w, GLfixed h) {
 void glEGLImageTargetTexture2DOES(GLenum target, GLeglImageOES image)
 {
     ogles_context_t* c = ogles_context_t::get();
+    ogles_flush_tiles(c);
     if (target != GL_TEXTURE_2D && target != GL_TEXTURE_EXTERNAL_OES) {
         ogles_error(c, GL_INVALID_ENUM);
         return;
@@ -0,0 +1,796 @@
+/* libs/opengles/tiler.cpp
+**
+** Copyright 2013, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <malloc.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cutils/atomic.h>
+#include <cutils/properties.h>
+
+#include <utils/Condition.h>
+#include <utils/Log.h>
+#include <utils/Mutex.h>
+
+#include "context.h"
+#include "tiler.h"
+
+namespace android {
+
+// ----------------------------------------------------------------------------
+
+// Most bands the color buffer is split into, and most threads.
+static const int32_t MAX_TILES = 16;
+
+// The recording is flushed when it gets this long, which bounds its memory
+// and how long the GL thread can run ahead of the rasterizers.
+static const size_t MAX_COMMANDS = 8192;
+static const size_t MIN_COMMANDS = 512;
+
+enum {
+    // state
+    CMD_ACTIVE_TEXTURE,
+    CMD_BIND_TEXTURE,
+    CMD_BIND_TEXTURE_LOD,
+    CMD_COLOR_BUFFER,
+    CMD_DEPTH_BUFFER,
+    CMD_ENABLE_DISABLE,
+    CMD_SHADE_MODEL,
+    CMD_COLOR4,
+    CMD_COLOR_GRAD,
+    CMD_Z_GRAD,
+    CMD_W_GRAD,
+    CMD_FOG_GRAD,
+    CMD_FOG_COLOR,
+    CMD_BLEND_FUNC,
+    CMD_TEX_ENVI,
+    CMD_TEX_ENVXV,
+    CMD_TEX_PARAMETERI,
+    CMD_TEX_GENI,
+    CMD_TEX_COORD2I,
+    CMD_TEX_COORD_GRAD,
+    CMD_COLOR_MASK,
+    CMD_DEPTH_MASK,
+    CMD_STENCIL_MASK,
+    CMD_ALPHA_FUNC,
+    CMD_DEPTH_FUNC,
+    CMD_LOGIC_OP,
+    CMD_CLEAR_COLOR,
+    CMD_CLEAR_DEPTH,
+    CMD_CLEAR_STENCIL,
+    CMD_SCISSOR,
+    // drawing, only replayed on tiles firstTile to lastTile
+    CMD_CLEAR,
+    CMD_POINT,
+    CMD_LINE,
+    CMD_RECT,
+    CMD_TRIANGLE
+};
+
+struct command_t {
+    uint8_t     op;
+    uint8_t     firstTile;
+    uint8_t     lastTile;
+    union {
+        // vertices are stored as 4 coordinates each
+        GGLint  v[12];
+        struct {
+            GGLint      tmu;
+            GGLSurface  s;
+        } surface;
+    };
+};
+
+struct tile_t {
+    context_t*  rasterizer;
+    // the rows of the color buffer this tile draws, top to bottom - 1
+    GGLint      top;
+    GGLint      bottom;
+    GGLint      width;
+    // the GL scissor, which is combined with the band
+    GGLint      scissor[4];
+    bool        scissorEnabled;
+};
+
+struct tiler_t {
+    // the context's own procs, which state changes are forwarded to
+    GGLContext          procs;
+
+    command_t*          commands;
+    size_t              count;
+    size_t              capacity;
+    // height of the color buffer the recorded draws were binned for
+    GGLint              height;
+
+    tile_t              tiles[MAX_TILES];
+    int32_t             tileCount;
+
+    Mutex               lock;
+    Condition           workCondition;
+    Condition           doneCondition;
+    pthread_t           threads[MAX_TILES];
+    int32_t             threadCount;    // not counting the GL thread
+    uint32_t            generation;
+    int32_t             busy;
+    volatile int32_t    nextTile;
+    bool                exiting;
+};
+
+// ----------------------------------------------------------------------------
+#if 0
+#pragma mark -
+#pragma mark Replay
+#endif
+
+static void apply_scissor(tile_t& tile)
+{
+    GGLint l = 0;
+    GGLint t = tile.top;
+    GGLint r = tile.width;
+    GGLint b = tile.bottom;
+    if (tile.scissorEnabled) {
+        l = max(l, tile.scissor[0]);
+        t = max(t, tile.scissor[1]);
+        r = min(r, tile.scissor[0] + tile.scissor[2]);
+        b = min(b, tile.scissor[1] + tile.scissor[3]);
+    }
+    if (r < l) r = l;
+    if (b < t) b = t;
+    context_t* const c = tile.rasterizer;
+    c->procs.scissor(c, l, t, r - l, b - t);
+}
+
+static void replay(tiler_t* t, int32_t index)
+{
+    tile_t& tile = t->tiles[index];
+    context_t* const c = tile.rasterizer;
+    // the drawing procs change as the state does, so they're looked up
+    // every time
+    const GGLContext& p = c->procs;
+    const command_t* cmd = t->commands;
+    const command_t* const end = cmd + t->count;
+    for ( ; cmd != end ; cmd++) {
+        const GGLint* v = cmd->v;
+        if (cmd->op >= CMD_CLEAR &&
+                (index < cmd->firstTile || index > cmd->lastTile))
+            continue;
+        switch (cmd->op) {
+        case CMD_ACTIVE_TEXTURE:
+            p.activeTexture(c, v[0]);
+            break;
+        case CMD_BIND_TEXTURE:
+            p.bindTexture(c, &cmd->surface.s);
+            break;
+        case CMD_BIND_TEXTURE_LOD:
+            p.bindTextureLod(c, cmd->surface.tmu, &cmd->surface.s);
+            break;
+        case CMD_COLOR_BUFFER: {
+            const GGLint height = cmd->surface.s.height;
+            p.colorBuffer(c, &cmd->surface.s);
+            tile.top    = (index * height + t->tileCount - 1) / t->tileCount;
+            tile.bottom = ((index+1) * height + t->tileCount - 1) / t->tileCount;
+            tile.width  = cmd->surface.s.width;
+            apply_scissor(tile);
+            break;
+        }
+        case CMD_DEPTH_BUFFER:
+            p.depthBuffer(c, &cmd->surface.s);
+            break;
+        case CMD_ENABLE_DISABLE:
+            if (v[0] == GGL_SCISSOR_TEST) {
+                // always on for the tile, which must stay in its band
+                tile.scissorEnabled = v[1];
+                apply_scissor(tile);
+            } else {
+                p.enableDisable(c, v[0], v[1]);
+            }
+            break;
+        case CMD_SHADE_MODEL:
+            p.shadeModel(c, v[0]);
+            break;
+        case CMD_COLOR4:
+            p.color4xv(c, v);
+            break;
+        case CMD_COLOR_GRAD:
+            p.colorGrad12xv(c, v);
+            break;
+        case CMD_Z_GRAD:
+            p.zGrad3xv(c, v);
+            break;
+        case CMD_W_GRAD:
+            p.wGrad3xv(c, v);
+            break;
+        case CMD_FOG_GRAD:
+            p.fogGrad3xv(c, v);
+            break;
+        case CMD_FOG_COLOR:
+            p.fogColor3xv(c, v);
+            break;
+        case CMD_BLEND_FUNC:
+            p.blendFunc(c, v[0], v[1]);
+            break;
+        case CMD_TEX_ENVI:
+            p.texEnvi(c, v[0], v[1], v[2]);
+            break;
+        case CMD_TEX_ENVXV:
+            p.texEnvxv(c, v[0], v[1], v + 2);
+            break;
+        case CMD_TEX_PARAMETERI:
+            p.texParameteri(c, v[0], v[1], v[2]);
+            break;
+        case CMD_TEX_GENI:
+            p.texGeni(c, v[0], v[1], v[2]);
+            break;
+        case CMD_TEX_COORD2I:
+            p.texCoord2i(c, v[0], v[1]);
+            break;
+        case CMD_TEX_COORD_GRAD:
+            p.texCoordGradScale8xv(c, v[8], v);
+            break;
+        case CMD_COLOR_MASK:
+            p.colorMask(c, v[0], v[1], v[2], v[3]);
+            break;
+        case CMD_DEPTH_MASK:
+            p.depthMask(c, v[0]);
+            break;
+        case CMD_STENCIL_MASK:
+            p.stencilMask(c, v[0]);
+            break;
+        case CMD_ALPHA_FUNC:
+            p.alphaFuncx(c, v[0], v[1]);
+            break;
+        case CMD_DEPTH_FUNC:
+            p.depthFunc(c, v[0]);
+            break;
+        case CMD_LOGIC_OP:
+            p.logicOp(c, v[0]);
+            break;
+        case CMD_CLEAR_COLOR:
+            p.clearColorx(c, v[0], v[1], v[2], v[3]);
+            break;
+        case CMD_CLEAR_DEPTH:
+            p.clearDepthx(c, v[0]);
+            break;
+        case CMD_CLEAR_STENCIL:
+            p.clearStencil(c, v[0]);
+            break;
+        case CMD_SCISSOR:
+            memcpy(tile.scissor, v, sizeof(tile.scissor));
+            apply_scissor(tile);
+            break;
+        case CMD_CLEAR:
+            p.clear(c, v[0]);
+            break;
+        case CMD_POINT:
+            p.pointx(c, v, v[4]);
+            break;
+        case CMD_LINE:
+            p.linex(c, v, v + 4, v[8]);
+            break;
+        case CMD_RECT:
+            p.recti(c, v[0], v[1], v[2], v[3]);
+            break;
+        case CMD_TRIANGLE:
+            p.trianglex(c, v, v + 4, v + 8);
+            break;
+        }
+    }
+}
+
+static void render_tiles(tiler_t* t)
+{
+    int32_t index;
+    while ((index = android_atomic_inc(&t->nextTile)) < t->tileCount) {
+        replay(t, index);
+    }
+}
+
+static void* tiler_thread(void* arg)
+{
+    tiler_t* t = static_cast<tiler_t*>(arg);
+    uint32_t generation = 0;
+    Mutex::Autolock _l(t->lock);
+    while (true) {
+        while (t->generation == generation && !t->exiting) {
+            t->workCondition.wait(t->lock);
+        }
+        if (t->exiting)
+            break;
+        generation = t->generation;
+        t->lock.unlock();
+        render_tiles(t);
+        t->lock.lock();
+        if (--t->busy == 0) {
+            t->doneCondition.signal();
+        }
+    }
+    return 0;
+}
+
+void ogles_flush_tiles_impl(ogles_context_t* c)
+{
+    tiler_t* t = c->tiler;
+    if (!t->count)
+        return;
+    {
+        Mutex::Autolock _l(t->lock);
+        t->nextTile = 0;
+        t->busy = t->threadCount;
+        t->generation++;
+        t->workCondition.broadcast();
+    }
+    render_tiles(t);
+    Mutex::Autolock _l(t->lock);
+    while (t->busy) {
+        t->doneCondition.wait(t->lock);
+    }
+    t->count = 0;
+}
+
+// ----------------------------------------------------------------------------
+#if 0
+#pragma mark -
+#pragma mark Recording
+#endif
+
+static inline ogles_context_t* ogl(void* con) {
+    return static_cast<ogles_context_t*>(con);
+}
+
+static command_t* record(ogles_context_t* c, uint8_t op)
+{
+    tiler_t* t = c->tiler;
+    if (ggl_unlikely(t->count == t->capacity)) {
+        command_t* commands = 0;
+        if (t->capacity < MAX_COMMANDS) {
+            commands = (command_t*)realloc(t->commands,
+                    t->capacity * 2 * sizeof(command_t));
+        }
+        if (commands) {
+            t->commands = commands;
+            t->capacity *= 2;
+        } else {
+            ogles_flush_tiles_impl(c);
+        }
+    }
+    command_t* cmd = t->commands + t->count++;
+    cmd->op = op;
+    return cmd;
+}
+
+// Records a drawing command covering rows top to bottom (inclusive).
+// Returns 0 if those are all outside the color buffer.
+static command_t* record_draw(ogles_context_t* c, uint8_t op,
+        GGLint top, GGLint bottom)
+{
+    tiler_t* t = c->tiler;
+    const GGLint height = t->height;
+    if (bottom < 0 || top >= height || bottom < top)
+        return 0;
+    top = max(top, 0);
+    bottom = min(bottom, height - 1);
+    command_t* cmd = record(c, op);
+    cmd->firstTile = (top * t->tileCount) / height;
+    cmd->lastTile  = (bottom * t->tileCount) / height;
+    return cmd;
+}
+
+static inline GGLint row_of(GGLcoord y) {
+    return y >> TRI_FRACTION_BITS;
+}
+
+static void record_surface(void* con, uint8_t op, GGLint tmu,
+        const GGLSurface* surface)
+{
+    // The surface may be on the caller's stack; its pixels must stay put
+    // until the next flush.
+    command_t* cmd = record(ogl(con), op);
+    cmd->surface.tmu = tmu;
+    cmd->surface.s = *surface;
+}
+
+static void record_ints(void* con, uint8_t op, const GGLint* v, size_t n)
+{
+    command_t* cmd = record(ogl(con), op);
+    memcpy(cmd->v, v, n * sizeof(GGLint));
+}
+
+static void record_ints(void* con, uint8_t op,
+        GGLint a, GGLint b = 0, GGLint c = 0, GGLint d = 0)
+{
+    const GGLint v[4] = { a, b, c, d };
+    record_ints(con, op, v, 4);
+}
+
+// ----------------------------------------------------------------------------
+// The procs the context uses while tiling. They record the call, then pass
+// it on to the context's own rasterizer so that its state stays current.
+
+static void tiler_activeTexture(void* con, GGLuint tmu) {
+    record_ints(con, CMD_ACTIVE_TEXTURE, tmu);
+    ogl(con)->tiler->procs.activeTexture(con, tmu);
+}
+
+static void tiler_bindTexture(void* con, const GGLSurface* surface) {
+    record_surface(con, CMD_BIND_TEXTURE, 0, surface);
+    ogl(con)->tiler->procs.bindTexture(con, surface);
+}
+
+static void tiler_bindTextureLod(void* con, GGLuint tmu,
+        const GGLSurface* surface) {
+    record_surface(con, CMD_BIND_TEXTURE_LOD, tmu, surface);
+    ogl(con)->tiler->procs.bindTextureLod(con, tmu, surface);
+}
+
+static void tiler_colorBuffer(void* con, const GGLSurface* surface) {
+    // what was drawn so far goes to the old buffer, binned for its size
+    ogles_flush_tiles_impl(ogl(con));
+    tiler_t* t = ogl(con)->tiler;
+    t->height = surface->height;
+    record_surface(con, CMD_COLOR_BUFFER, 0, surface);
+    t->procs.colorBuffer(con, surface);
+}
+
+static void tiler_depthBuffer(void* con, const GGLSurface* surface) {
+    ogles_flush_tiles_impl(ogl(con));
+    record_surface(con, CMD_DEPTH_BUFFER, 0, surface);
+    ogl(con)->tiler->procs.depthBuffer(con, surface);
+}
+
+static void tiler_readBuffer(void* con, const GGLSurface* surface) {
+    // only read by glCopyTexImage2D and glReadPixels, which flush first
+    ogl(con)->tiler->procs.readBuffer(con, surface);
+}
+
+static void tiler_enable(void* con, GGLenum name) {
+    record_ints(con, CMD_ENABLE_DISABLE, name, 1);
+    ogl(con)->tiler->procs.enable(con, name);
+}
+
+static void tiler_disable(void* con, GGLenum name) {
+    record_ints(con, CMD_ENABLE_DISABLE, name, 0);
+    ogl(con)->tiler->procs.disable(con, name);
+}
+
+static void tiler_enableDisable(void* con, GGLenum name, GGLboolean en) {
+    record_ints(con, CMD_ENABLE_DISABLE, name, en);
+    ogl(con)->tiler->procs.enableDisable(con, name, en);
+}
+
+static void tiler_shadeModel(void* con, GGLenum mode) {
+    record_ints(con, CMD_SHADE_MODEL, mode);
+    ogl(con)->tiler->procs.shadeModel(con, mode);
+}
+
+static void tiler_color4xv(void* con, const GGLclampx* color) {
+    record_ints(con, CMD_COLOR4, color, 4);
+    ogl(con)->tiler->procs.color4xv(con, color);
+}
+
+static void tiler_colorGrad12xv(void* con, const GGLcolor* grad) {
+    record_ints(con, CMD_COLOR_GRAD, grad, 12);
+    ogl(con)->tiler->procs.colorGrad12xv(con, grad);
+}
+
+static void tiler_zGrad3xv(void* con, const GGLfixed32* grad) {
+    record_ints(con, CMD_Z_GRAD, grad, 3);
+    ogl(con)->tiler->procs.zGrad3xv(con, grad);
+}
+
+static void tiler_wGrad3xv(void* con, const GGLfixed* grad) {
+    record_ints(con, CMD_W_GRAD, grad, 3);
+    ogl(con)->tiler->procs.wGrad3xv(con, grad);
+}
+
+static void tiler_fogGrad3xv(void* con, const GGLfixed* grad) {
+    record_ints(con, CMD_FOG_GRAD, grad, 3);
+    ogl(con)->tiler->procs.fogGrad3xv(con, grad);
+}
+
+static void tiler_fogColor3xv(void* con, const GGLclampx* color) {
+    record_ints(con, CMD_FOG_COLOR, color, 3);
+    ogl(con)->tiler->procs.fogColor3xv(con, color);
+}
+
+static void tiler_blendFunc(void* con, GGLenum src, GGLenum dst) {
+    record_ints(con, CMD_BLEND_FUNC, src, dst);
+    ogl(con)->tiler->procs.blendFunc(con, src, dst);
+}
+
+static void tiler_texEnvi(void* con,
+        GGLenum target, GGLenum pname, GGLint param) {
+    record_ints(con, CMD_TEX_ENVI, target, pname, param);
+    ogl(con)->tiler->procs.texEnvi(con, target, pname, param);
+}
+
+static void tiler_texEnvxv(void* con,
+        GGLenum target, GGLenum pname, const GGLfixed* params) {
+    command_t* cmd = record(ogl(con), CMD_TEX_ENVXV);
+    cmd->v[0] = target;
+    cmd->v[1] = pname;
+    // only the environment color has more than one value
+    memcpy(cmd->v + 2, params,
+            (pname == GGL_TEXTURE_ENV_COLOR ? 4 : 1) * sizeof(GGLfixed));
+    ogl(con)->tiler->procs.texEnvxv(con, target, pname, params);
+}
+
+static void tiler_texParameteri(void* con,
+        GGLenum target, GGLenum pname, GGLint param) {
+    record_ints(con, CMD_TEX_PARAMETERI, target, pname, param);
+    ogl(con)->tiler->procs.texParameteri(con, target, pname, param);
+}
+
+static void tiler_texGeni(void* con,
+        GGLenum coord, GGLenum pname, GGLint param) {
+    record_ints(con, CMD_TEX_GENI, coord, pname, param);
+    ogl(con)->tiler->procs.texGeni(con, coord, pname, param);
+}
+
+static void tiler_texCoord2i(void* con, GGLint s, GGLint t) {
+    record_ints(con, CMD_TEX_COORD2I, s, t);
+    ogl(con)->tiler->procs.texCoord2i(con, s, t);
+}
+
+static void tiler_texCoordGradScale8xv(void* con,
+        GGLint tmu, const int32_t* grad8) {
+    command_t* cmd = record(ogl(con), CMD_TEX_COORD_GRAD);
+    memcpy(cmd->v, grad8, 8 * sizeof(int32_t));
+    cmd->v[8] = tmu;
+    ogl(con)->tiler->procs.texCoordGradScale8xv(con, tmu, grad8);
+}
+
+static void tiler_colorMask(void* con,
+        GGLboolean r, GGLboolean g, GGLboolean b, GGLboolean a) {
+    record_ints(con, CMD_COLOR_MASK, r, g, b, a);
+    ogl(con)->tiler->procs.colorMask(con, r, g, b, a);
+}
+
+static void tiler_depthMask(void* con, GGLboolean flag) {
+    record_ints(con, CMD_DEPTH_MASK, flag);
+    ogl(con)->tiler->procs.depthMask(con, flag);
+}
+
+static void tiler_stencilMask(void* con, GGLuint mask) {
+    record_ints(con, CMD_STENCIL_MASK, mask);
+    ogl(con)->tiler->procs.stencilMask(con, mask);
+}
+
+static void tiler_alphaFuncx(void* con, GGLenum func, GGLclampx ref) {
+    record_ints(con, CMD_ALPHA_FUNC, func, ref);
+    ogl(con)->tiler->procs.alphaFuncx(con, func, ref);
+}
+
+static void tiler_depthFunc(void* con, GGLenum func) {
+    record_ints(con, CMD_DEPTH_FUNC, func);
+    ogl(con)->tiler->procs.depthFunc(con, func);
+}
+
+static void tiler_logicOp(void* con, GGLenum opcode) {
+    record_ints(con, CMD_LOGIC_OP, opcode);
+    ogl(con)->tiler->procs.logicOp(con, opcode);
+}
+
+static void tiler_clearColorx(void* con,
+        GGLclampx r, GGLclampx g, GGLclampx b, GGLclampx a) {
+    record_ints(con, CMD_CLEAR_COLOR, r, g, b, a);
+    ogl(con)->tiler->procs.clearColorx(con, r, g, b, a);
+}
+
+static void tiler_clearDepthx(void* con, GGLclampx depth) {
+    record_ints(con, CMD_CLEAR_DEPTH, depth);
+    ogl(con)->tiler->procs.clearDepthx(con, depth);
+}
+
+static void tiler_clearStencil(void* con, GGLint s) {
+    record_ints(con, CMD_CLEAR_STENCIL, s);
+    ogl(con)->tiler->procs.clearStencil(con, s);
+}
+
+static void tiler_scissor(void* con,
+        GGLint x, GGLint y, GGLsizei width, GGLsizei height) {
+    record_ints(con, CMD_SCISSOR, x, y, width, height);
+    ogl(con)->tiler->procs.scissor(con, x, y, width, height);
+}
+
+// ----------------------------------------------------------------------------
+
+void ogles_tiler_pointx(ogles_context_t* c, const GGLcoord* v, GGLcoord size)
+{
+    command_t* cmd = record_draw(c, CMD_POINT,
+            row_of(v[1] - size) - 1, row_of(v[1] + size) + 1);
+    if (cmd) {
+        memcpy(cmd->v, v, 4 * sizeof(GGLcoord));
+        cmd->v[4] = size;
+    }
+}
+
+void ogles_tiler_linex(ogles_context_t* c,
+        const GGLcoord* v0, const GGLcoord* v1, GGLcoord width)
+{
+    command_t* cmd = record_draw(c, CMD_LINE,
+            row_of(min(v0[1], v1[1]) - width) - 1,
+            row_of(max(v0[1], v1[1]) + width) + 1);
+    if (cmd) {
+        memcpy(cmd->v,     v0, 4 * sizeof(GGLcoord));
+        memcpy(cmd->v + 4, v1, 4 * sizeof(GGLcoord));
+        cmd->v[8] = width;
+    }
+}
+
+void ogles_tiler_recti(ogles_context_t* c,
+        GGLint l, GGLint t, GGLint r, GGLint b)
+{
+    command_t* cmd = record_draw(c, CMD_RECT, t, b - 1);
+    if (cmd) {
+        cmd->v[0] = l;
+        cmd->v[1] = t;
+        cmd->v[2] = r;
+        cmd->v[3] = b;
+    }
+}
+
+void ogles_tiler_trianglex(ogles_context_t* c,
+        const GGLcoord* v0, const GGLcoord* v1, const GGLcoord* v2)
+{
+    command_t* cmd = record_draw(c, CMD_TRIANGLE,
+            row_of(min(v0[1], min(v1[1], v2[1]))) - 1,
+            row_of(max(v0[1], max(v1[1], v2[1]))) + 1);
+    if (cmd) {
+        memcpy(cmd->v,     v0, 4 * sizeof(GGLcoord));
+        memcpy(cmd->v + 4, v1, 4 * sizeof(GGLcoord));
+        memcpy(cmd->v + 8, v2, 4 * sizeof(GGLcoord));
+    }
+}
+
+void ogles_tiler_clear(ogles_context_t* c, GGLbitfield mask)
+{
+    // the scissor is applied by each tile
+    command_t* cmd = record_draw(c, CMD_CLEAR, 0, c->tiler->height - 1);
+    if (cmd) {
+        cmd->v[0] = mask;
+    }
+}
+
+// ----------------------------------------------------------------------------
+#if 0
+#pragma mark -
+#pragma mark Init
+#endif
+
+static void free_tiler(tiler_t* t)
+{
+    for (int32_t i=0 ; i<t->tileCount ; i++) {
+        ggl_uninit_context(t->tiles[i].rasterizer);
+        free(t->tiles[i].rasterizer);
+    }
+    free(t->commands);
+    delete t;
+}
+
+void ogles_init_tiler(ogles_context_t* c)
+{
+    char value[PROPERTY_VALUE_MAX];
+    property_get("debug.agl.tiler", value, "0");
+    int32_t threads = atoi(value);
+    if (threads <= 0)
+        return;
+    if (threads > MAX_TILES)
+        threads = MAX_TILES;
+
+    tiler_t* t = new tiler_t;
+    t->commands = (command_t*)malloc(MIN_COMMANDS * sizeof(command_t));
+    t->count = 0;
+    t->capacity = MIN_COMMANDS;
+    t->height = 0;
+    t->threadCount = 0;
+    t->generation = 0;
+    t->busy = 0;
+    t->nextTile = 0;
+    t->exiting = false;
+
+    // a couple of bands per thread evens out their load
+    t->tileCount = 0;
+    const int32_t tileCount = min(threads * 2, MAX_TILES);
+    for (int32_t i=0 ; i<tileCount ; i++) {
+        context_t* r = (context_t*)memalign(32, sizeof(context_t));
+        if (!r)
+            break;
+        memset(r, 0, sizeof(context_t));
+        ggl_init_context(r);
+        r->procs.enableDisable(r, GGL_SCISSOR_TEST, 1);
+        tile_t& tile = t->tiles[t->tileCount++];
+        tile.rasterizer = r;
+        tile.top = tile.bottom = tile.width = 0;
+        memset(tile.scissor, 0, sizeof(tile.scissor));
+        tile.scissorEnabled = false;
+    }
+    if (!t->commands || t->tileCount < tileCount) {
+        ALOGE("not enough memory for tiled rasterization");
+        free_tiler(t);
+        return;
+    }
+
+    for (int32_t i=1 ; i<threads ; i++) {
+        if (pthread_create(&t->threads[t->threadCount], NULL,
+                tiler_thread, t) == 0) {
+            t->threadCount++;
+        }
+    }
+
+    // From now on the context's rasterizer calls are recorded. This has to
+    // happen before any state is set, so that the tiles start out the same.
+    t->procs = c->rasterizer.procs;
+    GGLContext& p = c->rasterizer.procs;
+    p.activeTexture         = tiler_activeTexture;
+    p.bindTexture           = tiler_bindTexture;
+    p.bindTextureLod        = tiler_bindTextureLod;
+    p.colorBuffer           = tiler_colorBuffer;
+    p.depthBuffer           = tiler_depthBuffer;
+    p.readBuffer            = tiler_readBuffer;
+    p.enable                = tiler_enable;
+    p.disable               = tiler_disable;
+    p.enableDisable         = tiler_enableDisable;
+    p.shadeModel            = tiler_shadeModel;
+    p.color4xv              = tiler_color4xv;
+    p.colorGrad12xv         = tiler_colorGrad12xv;
+    p.zGrad3xv              = tiler_zGrad3xv;
+    p.wGrad3xv              = tiler_wGrad3xv;
+    p.fogGrad3xv            = tiler_fogGrad3xv;
+    p.fogColor3xv           = tiler_fogColor3xv;
+    p.blendFunc             = tiler_blendFunc;
+    p.texEnvi               = tiler_texEnvi;
+    p.texEnvxv              = tiler_texEnvxv;
+    p.texParameteri         = tiler_texParameteri;
+    p.texGeni               = tiler_texGeni;
+    p.texCoord2i            = tiler_texCoord2i;
+    p.texCoordGradScale8xv  = tiler_texCoordGradScale8xv;
+    p.colorMask             = tiler_colorMask;
+    p.depthMask             = tiler_depthMask;
+    p.stencilMask           = tiler_stencilMask;
+    p.alphaFuncx            = tiler_alphaFuncx;
+    p.depthFunc             = tiler_depthFunc;
+    p.logicOp               = tiler_logicOp;
+    p.clearColorx           = tiler_clearColorx;
+    p.clearDepthx           = tiler_clearDepthx;
+    p.clearStencil          = tiler_clearStencil;
+    p.scissor               = tiler_scissor;
+    c->tiler = t;
+}
+
+void ogles_uninit_tiler(ogles_context_t* c)
+{
+    tiler_t* t = c->tiler;
+    if (!t)
+        return;
+    // Whatever is still recorded can't be drawn anymore: the surfaces are
+    // gone by the time the context is destroyed.
+    c->rasterizer.procs = t->procs;
+    c->tiler = 0;
+    {
+        Mutex::Autolock _l(t->lock);
+        t->exiting = true;
+        t->workCondition.broadcast();
+    }
+    for (int32_t i=0 ; i<t->threadCount ; i++) {
+        pthread_join(t->threads[i], NULL);
+    }
+    free_tiler(t);
+}
+
+// ----------------------------------------------------------------------------
+}; // namespace android
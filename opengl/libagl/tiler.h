@@ -0,0 +1,114 @@
+/* libs/opengles/tiler.h
+**
+** Copyright 2013, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef ANDROID_OPENGLES_TILER_H
+#define ANDROID_OPENGLES_TILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <private/pixelflinger/ggl_context.h>
+
+namespace android {
+
+/*
+ * Tiled rasterization, turned on by setting debug.agl.tiler to the number
+ * of threads to rasterize with, counting the GL thread.
+ *
+ * When it's on, the rasterizer calls are recorded instead of executed.
+ * State changes are also applied to the context's own rasterizer, which the
+ * GL code reads back. Drawing commands are binned by the horizontal bands
+ * of the color buffer they touch. ogles_flush_tiles() replays the recording
+ * on one rasterizer per band, scissored to its band, with the bands shared
+ * out to a pool of threads. A band sees every command that touches it in
+ * order, so the result is the same as rasterizing right away.
+ *
+ * The recording points to texture images, locked EGLImage buffers and the
+ * color and depth buffers. Anything that reads the buffers, or changes or
+ * frees that memory, must call ogles_flush_tiles() first.
+ */
+
+void ogles_init_tiler(ogles_context_t* c);
+void ogles_uninit_tiler(ogles_context_t* c);
+void ogles_flush_tiles_impl(ogles_context_t* c);
+
+void ogles_tiler_pointx(ogles_context_t* c, const GGLcoord* v, GGLcoord size);
+void ogles_tiler_linex(ogles_context_t* c,
+        const GGLcoord* v0, const GGLcoord* v1, GGLcoord width);
+void ogles_tiler_recti(ogles_context_t* c,
+        GGLint l, GGLint t, GGLint r, GGLint b);
+void ogles_tiler_trianglex(ogles_context_t* c,
+        const GGLcoord* v0, const GGLcoord* v1, const GGLcoord* v2);
+void ogles_tiler_clear(ogles_context_t* c, GGLbitfield mask);
+
+inline void ogles_flush_tiles(ogles_context_t* c)
+{
+    if (ggl_unlikely(c->tiler))
+        ogles_flush_tiles_impl(c);
+}
+
+// ----------------------------------------------------------------------------
+// Drawing goes through these rather than the rasterizer's procs, which
+// pixelflinger switches around as its state changes.
+
+inline void ogles_pointx(ogles_context_t* c, const GGLcoord* v, GGLcoord size)
+{
+    if (ggl_unlikely(c->tiler))
+        ogles_tiler_pointx(c, v, size);
+    else
+        c->rasterizer.procs.pointx(c, v, size);
+}
+
+inline void ogles_linex(ogles_context_t* c,
+        const GGLcoord* v0, const GGLcoord* v1, GGLcoord width)
+{
+    if (ggl_unlikely(c->tiler))
+        ogles_tiler_linex(c, v0, v1, width);
+    else
+        c->rasterizer.procs.linex(c, v0, v1, width);
+}
+
+inline void ogles_recti(ogles_context_t* c,
+        GGLint l, GGLint t, GGLint r, GGLint b)
+{
+    if (ggl_unlikely(c->tiler))
+        ogles_tiler_recti(c, l, t, r, b);
+    else
+        c->rasterizer.procs.recti(c, l, t, r, b);
+}
+
+inline void ogles_trianglex(ogles_context_t* c,
+        const GGLcoord* v0, const GGLcoord* v1, const GGLcoord* v2)
+{
+    if (ggl_unlikely(c->tiler))
+        ogles_tiler_trianglex(c, v0, v1, v2);
+    else
+        c->rasterizer.procs.trianglex(c, v0, v1, v2);
+}
+
+inline void ogles_clear(ogles_context_t* c, GGLbitfield mask)
+{
+    if (ggl_unlikely(c->tiler))
+        ogles_tiler_clear(c, mask);
+    else
+        c->rasterizer.procs.clear(c, mask);
+}
+
+}; // namespace android
+
+#endif // ANDROID_OPENGLES_TILER_H
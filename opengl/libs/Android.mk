@@ -25,6 +25,8 @@ LOCAL_SRC_FILES:= 	       \
 	EGL/egl_cache.cpp      \
 	EGL/egl_display.cpp    \
 	EGL/egl_object.cpp     \
+	EGL/egl_gpu_timer.cpp  \
+	EGL/egl_frame_timestamps.cpp \
 	EGL/egl.cpp 	       \
 	EGL/eglApi.cpp 	       \
 	EGL/trace.cpp              \
@@ -32,7 +34,7 @@ LOCAL_SRC_FILES:= 	       \
 	EGL/Loader.cpp 	       \
 #
 
-LOCAL_SHARED_LIBRARIES += libcutils libutils liblog libGLES_trace
+LOCAL_SHARED_LIBRARIES += libcutils libutils liblog libsync libGLES_trace
 LOCAL_LDLIBS := -lpthread -ldl
 LOCAL_MODULE:= libEGL
 LOCAL_LDFLAGS += -Wl,--exclude-libs=ALL
@@ -49,6 +51,11 @@ ifeq ($(BOARD_ALLOW_EGL_HIBERNATION),true)
   LOCAL_CFLAGS += -DBOARD_ALLOW_EGL_HIBERNATION
 endif
 
+ifeq ($(TARGET_ARCH),x86)
+  # the fast TLS entry points jump into the driver and can't have a frame
+  LOCAL_CFLAGS += -fomit-frame-pointer
+endif
+
 ifeq ($(TARGET_BOARD_PLATFORM),msm7k)
   LOCAL_CFLAGS += -DADRENO130=1
 endif
@@ -97,6 +104,11 @@ LOCAL_CFLAGS += -DLOG_TAG=\"libGLESv1\"
 LOCAL_CFLAGS += -DGL_GLEXT_PROTOTYPES -DEGL_EGLEXT_PROTOTYPES
 LOCAL_CFLAGS += -fvisibility=hidden
 
+ifeq ($(TARGET_ARCH),x86)
+  # the fast TLS entry points jump into the driver and can't have a frame
+  LOCAL_CFLAGS += -fomit-frame-pointer
+endif
+
 include $(BUILD_SHARED_LIBRARY)
 
 
@@ -122,6 +134,11 @@ LOCAL_CFLAGS += -DLOG_TAG=\"libGLESv2\"
 LOCAL_CFLAGS += -DGL_GLEXT_PROTOTYPES -DEGL_EGLEXT_PROTOTYPES
 LOCAL_CFLAGS += -fvisibility=hidden
 
+ifeq ($(TARGET_ARCH),x86)
+  # the fast TLS entry points jump into the driver and can't have a frame
+  LOCAL_CFLAGS += -fomit-frame-pointer
+endif
+
 include $(BUILD_SHARED_LIBRARY)
 
 # Symlink libGLESv3.so -> libGLESv2.so
@@ -99,7 +99,8 @@ static char const * getProcessCmdline() {
 
 // ----------------------------------------------------------------------------
 
-Loader::driver_t::driver_t(void* gles) 
+Loader::driver_t::driver_t(void* gles, bool monolithic) :
+    monolithic(monolithic), pending(GLESv1_CM | GLESv2)
 {
     dso[0] = gles;
     for (size_t i=1 ; i<NELEM(dso) ; i++)
@@ -141,6 +142,9 @@ Loader::Loader()
     char line[256];
     char tag[256];
 
+    property_get("debug.egl.lazy_gles", line, "1");
+    mLazyApis = atoi(line) != 0;
+
     /* Special case for GLES emulation */
     if (checkGlesEmulationStatus() == 0) {
         ALOGD("Emulator without GPU support detected. "
@@ -188,19 +192,22 @@ void* Loader::open(egl_connection_t* cnx)
     
     char const* tag = mDriverTag.string();
     if (tag) {
-        dso = load_driver("GLES", tag, cnx, EGL | GLESv1_CM | GLESv2);
+        // Only EGL is loaded here, most processes only ever use one of
+        // the GLES APIs; see load_api().
+        dso = load_driver("GLES", tag, cnx, EGL);
         if (dso) {
-            hnd = new driver_t(dso);
+            hnd = new driver_t(dso, true);
         } else {
             // Always load EGL first
             dso = load_driver("EGL", tag, cnx, EGL);
             if (dso) {
-                hnd = new driver_t(dso);
-                // TODO: make this more automated
-                hnd->set( load_driver("GLESv1_CM", tag, cnx, GLESv1_CM), GLESv1_CM );
-                hnd->set( load_driver("GLESv2",    tag, cnx, GLESv2),    GLESv2 );
+                hnd = new driver_t(dso, false);
             }
         }
+        if (hnd && !mLazyApis) {
+            load_api(hnd, cnx, egl_connection_t::GLESv1_INDEX);
+            load_api(hnd, cnx, egl_connection_t::GLESv2_INDEX);
+        }
     }
 
     LOG_FATAL_IF(!index && !hnd,
@@ -222,6 +229,29 @@ status_t Loader::close(void* driver)
     return NO_ERROR;
 }
 
+status_t Loader::load_api(void* driver, egl_connection_t* cnx, int index)
+{
+    driver_t* hnd = (driver_t*)driver;
+    const uint32_t api = (index == egl_connection_t::GLESv1_INDEX) ?
+            GLESv1_CM : GLESv2;
+
+    Mutex::Autolock _l(mLock);
+    if (!(hnd->pending & api)) {
+        return NO_ERROR;
+    }
+    // we only try once, like when everything was loaded up-front
+    hnd->pending &= ~api;
+
+    if (hnd->monolithic) {
+        init_gl_apis(hnd->dso[0], cnx, api);
+        return NO_ERROR;
+    }
+    const char* kind = (api == GLESv1_CM) ? "GLESv1_CM" : "GLESv2";
+    void* dso = load_driver(kind, mDriverTag.string(), cnx, api);
+    hnd->set(dso, api);
+    return dso ? NO_ERROR : NAME_NOT_FOUND;
+}
+
 void Loader::init_api(void* dso, 
         char const * const * api, 
         __eglMustCastToProperFunctionPointerType* curr, 
@@ -357,7 +387,14 @@ void *Loader::load_driver(const char* kind, const char *tag,
             api++;
         }
     }
+
+    init_gl_apis(dso, cnx, mask);
     
+    return dso;
+}
+
+void Loader::init_gl_apis(void* dso, egl_connection_t* cnx, uint32_t mask)
+{
     if (mask & GLESv1_CM) {
         init_api(dso, gl_names,
             (__eglMustCastToProperFunctionPointerType*)
@@ -371,8 +408,6 @@ void *Loader::load_driver(const char* kind, const char *tag,
                 &cnx->hooks[egl_connection_t::GLESv2_INDEX]->gl,
             getProcAddress);
     }
-    
-    return dso;
 }
 
 // ----------------------------------------------------------------------------
@@ -22,6 +22,7 @@
 #include <errno.h>
 
 #include <utils/Errors.h>
+#include <utils/Mutex.h>
 #include <utils/Singleton.h>
 #include <utils/String8.h>
 
@@ -46,24 +47,37 @@ class Loader : public Singleton<Loader>
         GLESv2      = 0x04
     };
     struct driver_t {
-        driver_t(void* gles);
+        driver_t(void* gles, bool monolithic);
         ~driver_t();
         status_t set(void* hnd, int32_t api);
         void* dso[3];
+        // dso[0] also implements the GLES APIs
+        bool monolithic;
+        // the GLES APIs whose hooks haven't been loaded yet
+        uint32_t pending;
     };
     
     String8 mDriverTag;
     getProcAddressType getProcAddress;
+    // the GLES APIs are loaded when the first context needs them
+    bool mLazyApis;
+    // protects driver_t::pending and the loading of the GLES APIs
+    Mutex mLock;
     
 public:
     ~Loader();
     
     void* open(egl_connection_t* cnx);
     status_t close(void* driver);
+
+    // loads the GLES library and the hooks of cnx for the API of
+    // cnx->hooks[index], unless that was done already
+    status_t load_api(void* driver, egl_connection_t* cnx, int index);
     
 private:
     Loader();
     void *load_driver(const char* kind, const char *tag, egl_connection_t* cnx, uint32_t mask);
+    void init_gl_apis(void* dso, egl_connection_t* cnx, uint32_t mask);
 
     static __attribute__((noinline))
     void init_api(void* dso, 
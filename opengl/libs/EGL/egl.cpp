@@ -71,7 +71,10 @@ EGLAPI pthread_key_t gGLTraceKey = -1;
  *    To enable:
  *      - set system property "debug.egl.trace" to 1 to trace all apps.
  *      - or call setGLTraceLevel(1) from an app to enable tracing for that app.
- * 4. libs/GLES_trace: Traces all functions via protobuf to host.
+ * 4. libs/EGL/trace.cpp: Times draw calls on the GPU, see egl_gpu_timer.h.
+ *    To enable:
+ *      - set system property "debug.egl.trace" to "gputime" to time all apps.
+ * 5. libs/GLES_trace: Traces all functions via protobuf to host.
  *    To enable:
  *        - set system property "debug.egl.debug_proc" to the application name.
  *      - or call setGLDebugLevel(1) from the app.
@@ -81,12 +84,15 @@ static int sEGLApplicationTraceLevel;
 
 static bool sEGLSystraceEnabled;
 static bool sEGLGetErrorEnabled;
+static bool sEGLGpuTimerEnabled;
 
 static volatile int sEGLDebugLevel;
 
 extern gl_hooks_t gHooksTrace;
 extern gl_hooks_t gHooksSystrace;
 extern gl_hooks_t gHooksErrorTrace;
+extern gl_hooks_t gHooksGpuTimer;
+extern void initGpuTimerHooks();
 
 int getEGLDebugLevel() {
     return sEGLDebugLevel;
@@ -104,6 +110,10 @@ gl_hooks_t const* getGLTraceThreadSpecific() {
     return static_cast<gl_hooks_t*>(pthread_getspecific(gGLTraceKey));
 }
 
+bool isEGLGpuTimerEnabled() {
+    return sEGLGpuTimerEnabled;
+}
+
 void initEglTraceLevel() {
     char value[PROPERTY_VALUE_MAX];
     property_get("debug.egl.trace", value, "0");
@@ -111,12 +121,21 @@ void initEglTraceLevel() {
     sEGLGetErrorEnabled = !strcasecmp(value, "error");
     if (sEGLGetErrorEnabled) {
         sEGLSystraceEnabled = false;
+        sEGLGpuTimerEnabled = false;
         sEGLTraceLevel = 0;
         return;
     }
 
     sEGLSystraceEnabled = !strcasecmp(value, "systrace");
     if (sEGLSystraceEnabled) {
+        sEGLGpuTimerEnabled = false;
+        sEGLTraceLevel = 0;
+        return;
+    }
+
+    sEGLGpuTimerEnabled = !strcasecmp(value, "gputime");
+    if (sEGLGpuTimerEnabled) {
+        initGpuTimerHooks();
         sEGLTraceLevel = 0;
         return;
     }
@@ -167,6 +186,9 @@ void setGLHooksThreadSpecific(gl_hooks_t const *value) {
     } else if (sEGLSystraceEnabled) {
         setGlTraceThreadSpecific(value);
         setGlThreadSpecific(&gHooksSystrace);
+    } else if (sEGLGpuTimerEnabled) {
+        setGlTraceThreadSpecific(value);
+        setGlThreadSpecific(&gHooksGpuTimer);
     } else if (sEGLTraceLevel > 0) {
         setGlTraceThreadSpecific(value);
         setGlThreadSpecific(&gHooksTrace);
@@ -33,7 +33,7 @@
 #include <cutils/properties.h>
 #include <cutils/memory.h>
 
-#include <utils/KeyedVector.h>
+#include <utils/JenkinsHash.h>
 #include <utils/SortedVector.h>
 #include <utils/String8.h>
 #include <utils/Trace.h>
@@ -43,9 +43,12 @@
 #include "../hooks.h"
 
 #include "egl_display.h"
+#include "egl_frame_timestamps.h"
+#include "egl_gpu_timer.h"
 #include "egl_object.h"
 #include "egl_tls.h"
 #include "egldefs.h"
+#include "Loader.h"
 
 using namespace android;
 
@@ -85,6 +88,7 @@ extern char const * const gExtensionString  =
         "EGL_ANDROID_image_native_buffer "      // mandatory
         "EGL_KHR_wait_sync "                    // strongly recommended
         "EGL_ANDROID_presentation_time "
+        "EGL_EXT_buffer_age "
         ;
 
 // extensions not exposed to applications but used by the ANDROID system
@@ -138,6 +142,10 @@ static const extention_map_t sExtensionMap[] = {
     // EGL_ANDROID_presentation_time
     { "eglPresentationTimeANDROID",
             (__eglMustCastToProperFunctionPointerType)&eglPresentationTimeANDROID },
+
+    // EGL_ANDROID_frame_completion_times
+    { "eglGetFrameCompletionTimesANDROID",
+            (__eglMustCastToProperFunctionPointerType)&eglGetFrameCompletionTimesANDROID },
 };
 
 /*
@@ -152,11 +160,78 @@ static const extention_map_t sExtensionMap[] = {
 
 
 
+/*
+ * Names eglGetProcAddress() has resolved before, whatever they resolved
+ * to, so that looking them up again takes no lock and no String8.
+ *
+ * Entries are only ever added, with sExtensionMapMutex held: an entry is
+ * written first and then published by storing its index + 1 in a bucket,
+ * so readers probing the buckets never see a partially written entry.
+ * At most half the buckets are used, which keeps the probes short and
+ * always ends them on an empty bucket.
+ */
+struct resolved_proc_t {
+    uint32_t hash;
+    const char* name;
+    __eglMustCastToProperFunctionPointerType address;
+};
+
+enum {
+    MAX_RESOLVED_PROCS = 1024,
+    RESOLVED_PROC_BUCKETS = 2 * MAX_RESOLVED_PROCS // must be a power of 2
+};
+
+static resolved_proc_t sResolvedProcs[MAX_RESOLVED_PROCS];
+static volatile int32_t sResolvedProcBuckets[RESOLVED_PROC_BUCKETS];
+
 // accesses protected by sExtensionMapMutex
-static DefaultKeyedVector<String8, __eglMustCastToProperFunctionPointerType> sGLExtentionMap;
+static int32_t sResolvedProcCount = 0;
 static int sGLExtentionSlot = 0;
 static pthread_mutex_t sExtensionMapMutex = PTHREAD_MUTEX_INITIALIZER;
 
+static uint32_t hashProcName(const char* name) {
+    return JenkinsHashWhiten(JenkinsHashMixBytes(0,
+            reinterpret_cast<const uint8_t*>(name), strlen(name)));
+}
+
+static __eglMustCastToProperFunctionPointerType findResolvedProc(
+        const char* name, uint32_t hash) {
+    for (uint32_t i = hash ; ; i++) {
+        const int32_t index = android_atomic_acquire_load(
+                &sResolvedProcBuckets[i & (RESOLVED_PROC_BUCKETS - 1)]);
+        if (index == 0) {
+            return NULL;
+        }
+        const resolved_proc_t& proc = sResolvedProcs[index - 1];
+        if (proc.hash == hash && !strcmp(proc.name, name)) {
+            return proc.address;
+        }
+    }
+}
+
+// must be called with sExtensionMapMutex held
+static void addResolvedProc(const char* name, uint32_t hash,
+        __eglMustCastToProperFunctionPointerType address) {
+    if (sResolvedProcCount >= MAX_RESOLVED_PROCS) {
+        // it still works, it's just looked up the slow way every time
+        return;
+    }
+    resolved_proc_t& proc = sResolvedProcs[sResolvedProcCount];
+    proc.name = strdup(name);
+    if (proc.name == NULL) {
+        return;
+    }
+    proc.hash = hash;
+    proc.address = address;
+    uint32_t i = hash;
+    while (sResolvedProcBuckets[i & (RESOLVED_PROC_BUCKETS - 1)]) {
+        i++;
+    }
+    sResolvedProcCount++;
+    android_atomic_release_store(sResolvedProcCount,
+            &sResolvedProcBuckets[i & (RESOLVED_PROC_BUCKETS - 1)]);
+}
+
 static void(*findProcAddress(const char* name,
         const extention_map_t* map, size_t n))() {
     for (uint32_t i=0 ; i<n ; i++) {
@@ -174,6 +249,7 @@ extern EGLBoolean egl_init_drivers();
 extern const __eglMustCastToProperFunctionPointerType gExtensionForwarders[MAX_NUMBER_OF_GL_EXTENSIONS];
 extern int getEGLDebugLevel();
 extern void setEGLDebugLevel(int level);
+extern bool isEGLGpuTimerEnabled();
 extern gl_hooks_t gHooksTrace;
 
 } // namespace android;
@@ -184,6 +260,14 @@ extern gl_hooks_t gHooksTrace;
 static inline void clearError() { egl_tls_t::clearError(); }
 static inline EGLContext getContext() { return egl_tls_t::getContext(); }
 
+// protects egl_surface_t::frameTimestamps
+static Mutex sFrameTimestampsLock;
+
+static sp<egl_frame_timestamps_t> getFrameTimestamps(egl_surface_t const* s) {
+    Mutex::Autolock _l(sFrameTimestampsLock);
+    return s->frameTimestamps;
+}
+
 // ----------------------------------------------------------------------------
 
 EGLDisplay eglGetDisplay(EGLNativeDisplayType display)
@@ -481,6 +565,10 @@ EGLBoolean eglQuerySurface( EGLDisplay dpy, EGLSurface surface,
         return setError(EGL_BAD_SURFACE, EGL_FALSE);
 
     egl_surface_t const * const s = get_surface(surface);
+    if (attribute == EGL_FRAME_COMPLETION_TIMES_ANDROID) {
+        *value = getFrameTimestamps(s) != NULL ? EGL_TRUE : EGL_FALSE;
+        return EGL_TRUE;
+    }
     return s->cnx->egl.eglQuerySurface(
             dp->disp.dpy, s->surface, attribute, value);
 }
@@ -522,24 +610,24 @@ EGLContext eglCreateContext(EGLDisplay dpy, EGLConfig config,
             egl_context_t* const c = get_context(share_list);
             share_list = c->context;
         }
+        // figure out if it's a GLESv1 or GLESv2
+        int version = 0;
+        if (attrib_list) {
+            for (const EGLint* attr = attrib_list; *attr != EGL_NONE; attr += 2) {
+                if (attr[0] == EGL_CONTEXT_CLIENT_VERSION) {
+                    if (attr[1] == 1) {
+                        version = egl_connection_t::GLESv1_INDEX;
+                    } else if (attr[1] == 2 || attr[1] == 3) {
+                        version = egl_connection_t::GLESv2_INDEX;
+                    }
+                }
+            }
+        }
+        // the GLES library of that version may not be loaded yet
+        Loader::getInstance().load_api(cnx->dso, cnx, version);
         EGLContext context = cnx->egl.eglCreateContext(
                 dp->disp.dpy, config, share_list, attrib_list);
         if (context != EGL_NO_CONTEXT) {
-            // figure out if it's a GLESv1 or GLESv2
-            int version = 0;
-            if (attrib_list) {
-                while (*attrib_list != EGL_NONE) {
-                    GLint attr = *attrib_list++;
-                    GLint value = *attrib_list++;
-                    if (attr == EGL_CONTEXT_CLIENT_VERSION) {
-                        if (value == 1) {
-                            version = egl_connection_t::GLESv1_INDEX;
-                        } else if (value == 2 || value == 3) {
-                            version = egl_connection_t::GLESv2_INDEX;
-                        }
-                    }
-                };
-            }
             egl_context_t* c = new egl_context_t(dpy, context, config, cnx,
                     version);
 #if EGL_TRACE
@@ -658,6 +746,9 @@ EGLBoolean eglMakeCurrent(  EGLDisplay dpy, EGLSurface draw,
 #if EGL_TRACE
             if (getEGLDebugLevel() > 0)
                 GLTrace_eglMakeCurrent(c->version, c->cnx->hooks[c->version], ctx);
+            if (CC_UNLIKELY(isEGLGpuTimerEnabled()) && c->gpuTimer == NULL)
+                c->gpuTimer = egl_gpu_timer_t::create(c->cnx->hooks[c->version],
+                        c->version, c->gl_extensions);
 #endif
             _c.acquire();
             _r.acquire();
@@ -787,14 +878,78 @@ static __eglMustCastToProperFunctionPointerType findBuiltinGLWrapper(
     return NULL;
 }
 
+// must be called with sExtensionMapMutex held
+static __eglMustCastToProperFunctionPointerType resolveGLExtension(
+        const char* procname) {
+    /*
+     * Since eglGetProcAddress() is not associated to anything, it needs
+     * to return a function pointer that "works" regardless of what
+     * the current context is.
+     *
+     * For this reason, we return a "forwarder", a small stub that takes
+     * care of calling the function associated with the context
+     * currently bound.
+     *
+     * If we're seeing this extension for the first time, we go through
+     * all our implementations and call eglGetProcAddress() and record the
+     * result in the appropriate implementation hooks and return the
+     * address of the forwarder corresponding to that hook set.
+     *
+     */
+
+    __eglMustCastToProperFunctionPointerType addr = NULL;
+    const int slot = sGLExtentionSlot;
+
+    ALOGE_IF(slot >= MAX_NUMBER_OF_GL_EXTENSIONS,
+            "no more slots for eglGetProcAddress(\"%s\")",
+            procname);
+
+#if EGL_TRACE
+    gl_hooks_t *debugHooks = GLTrace_getGLHooks();
+#endif
+
+    if (slot < MAX_NUMBER_OF_GL_EXTENSIONS) {
+        bool found = false;
+
+        egl_connection_t* const cnx = &gEGLImpl;
+        if (cnx->dso && cnx->egl.eglGetProcAddress) {
+            // Extensions are independent of the bound context
+            addr =
+            cnx->hooks[egl_connection_t::GLESv1_INDEX]->ext.extensions[slot] =
+            cnx->hooks[egl_connection_t::GLESv2_INDEX]->ext.extensions[slot] =
+#if EGL_TRACE
+            debugHooks->ext.extensions[slot] =
+            gHooksTrace.ext.extensions[slot] =
+#endif
+                    cnx->egl.eglGetProcAddress(procname);
+            if (addr) found = true;
+        }
+
+        if (found) {
+#if USE_FAST_TLS_KEY
+            addr = gExtensionForwarders[slot];
+#endif
+            sGLExtentionSlot++;
+        }
+    }
+    return addr;
+}
+
 __eglMustCastToProperFunctionPointerType eglGetProcAddress(const char *procname)
 {
+    clearError();
+
+    // Names we've resolved before don't need any lock. The drivers are
+    // necessarily loaded if we find one.
+    const uint32_t hash = hashProcName(procname);
+    __eglMustCastToProperFunctionPointerType addr;
+    addr = findResolvedProc(procname, hash);
+    if (addr) return addr;
+
     // eglGetProcAddress() could be the very first function called
     // in which case we must make sure we've initialized ourselves, this
     // happens the first time egl_get_display() is called.
 
-    clearError();
-
     if (egl_init_drivers() == EGL_FALSE) {
         setError(EGL_BAD_PARAMETER, NULL);
         return  NULL;
@@ -804,70 +959,17 @@ __eglMustCastToProperFunctionPointerType eglGetProcAddress(const char *procname)
         return NULL;
     }
 
-    __eglMustCastToProperFunctionPointerType addr;
-    addr = findProcAddress(procname, sExtensionMap, NELEM(sExtensionMap));
-    if (addr) return addr;
-
-    addr = findBuiltinGLWrapper(procname);
-    if (addr) return addr;
-
-    // this protects accesses to sGLExtentionMap and sGLExtentionSlot
+    // this protects accesses to the resolved names and sGLExtentionSlot
     pthread_mutex_lock(&sExtensionMapMutex);
 
-        /*
-         * Since eglGetProcAddress() is not associated to anything, it needs
-         * to return a function pointer that "works" regardless of what
-         * the current context is.
-         *
-         * For this reason, we return a "forwarder", a small stub that takes
-         * care of calling the function associated with the context
-         * currently bound.
-         *
-         * We first look for extensions we've already resolved, if we're seeing
-         * this extension for the first time, we go through all our
-         * implementations and call eglGetProcAddress() and record the
-         * result in the appropriate implementation hooks and return the
-         * address of the forwarder corresponding to that hook set.
-         *
-         */
-
-        const String8 name(procname);
-        addr = sGLExtentionMap.valueFor(name);
-        const int slot = sGLExtentionSlot;
-
-        ALOGE_IF(slot >= MAX_NUMBER_OF_GL_EXTENSIONS,
-                "no more slots for eglGetProcAddress(\"%s\")",
-                procname);
-
-#if EGL_TRACE
-        gl_hooks_t *debugHooks = GLTrace_getGLHooks();
-#endif
-
-        if (!addr && (slot < MAX_NUMBER_OF_GL_EXTENSIONS)) {
-            bool found = false;
-
-            egl_connection_t* const cnx = &gEGLImpl;
-            if (cnx->dso && cnx->egl.eglGetProcAddress) {
-                // Extensions are independent of the bound context
-                addr =
-                cnx->hooks[egl_connection_t::GLESv1_INDEX]->ext.extensions[slot] =
-                cnx->hooks[egl_connection_t::GLESv2_INDEX]->ext.extensions[slot] =
-#if EGL_TRACE
-                debugHooks->ext.extensions[slot] =
-                gHooksTrace.ext.extensions[slot] =
-#endif
-                        cnx->egl.eglGetProcAddress(procname);
-                if (addr) found = true;
-            }
-
-            if (found) {
-#if USE_FAST_TLS_KEY
-                addr = gExtensionForwarders[slot];
-#endif
-                sGLExtentionMap.add(name, addr);
-                sGLExtentionSlot++;
-            }
-        }
+    // another thread may have resolved it while we were waiting
+    addr = findResolvedProc(procname, hash);
+    if (!addr) {
+        addr = findProcAddress(procname, sExtensionMap, NELEM(sExtensionMap));
+        if (!addr) addr = findBuiltinGLWrapper(procname);
+        if (!addr) addr = resolveGLExtension(procname);
+        if (addr) addResolvedProc(procname, hash, addr);
+    }
 
     pthread_mutex_unlock(&sExtensionMapMutex);
     return addr;
@@ -974,10 +1076,23 @@ EGLBoolean eglSwapBuffers(EGLDisplay dpy, EGLSurface draw)
         if (c) setGLHooksThreadSpecific(c->cnx->hooks[c->version]);
         GLTrace_stop();
     }
+
+    if (CC_UNLIKELY(isEGLGpuTimerEnabled())) {
+        egl_context_t * const c = get_context( egl_tls_t::getContext() );
+        if (c && c->gpuTimer) {
+            c->gpuTimer->onSwapBuffers();
+        }
+    }
 #endif
 
     egl_surface_t const * const s = get_surface(draw);
 
+    const sp<egl_frame_timestamps_t> timestamps(getFrameTimestamps(s));
+    EGLSyncKHR frameSync = EGL_NO_SYNC_KHR;
+    if (CC_UNLIKELY(timestamps != NULL)) {
+        frameSync = timestamps->createFrameSync();
+    }
+
     if (CC_UNLIKELY(dp->traceGpuCompletion)) {
         EGLSyncKHR sync = eglCreateSyncKHR(dpy, EGL_SYNC_FENCE_KHR, NULL);
         if (sync != EGL_NO_SYNC_KHR) {
@@ -995,6 +1110,13 @@ EGLBoolean eglSwapBuffers(EGLDisplay dpy, EGLSurface draw)
         }
     }
 
+    if (CC_UNLIKELY(timestamps != NULL)) {
+        const nsecs_t queueTime = systemTime(SYSTEM_TIME_MONOTONIC);
+        EGLBoolean result = s->cnx->egl.eglSwapBuffers(dp->disp.dpy, s->surface);
+        timestamps->onSwapBuffers(frameSync, queueTime);
+        return result;
+    }
+
     return s->cnx->egl.eglSwapBuffers(dp->disp.dpy, s->surface);
 }
 
@@ -1054,6 +1176,29 @@ EGLAPI const char* eglQueryStringImplementationANDROID(EGLDisplay dpy, EGLint na
     return setError(EGL_BAD_PARAMETER, (const char *)0);
 }
 
+/*
+ * Writes the GPU time measured while debug.egl.trace is "gputime" to buffer,
+ * as a NUL-terminated string truncated to size bytes. Returns the length of
+ * the whole string, or 0 if there is nothing to report.
+ */
+EGLAPI EGLint eglDumpGpuTimesANDROID(char* buffer, EGLint size)
+{
+#if EGL_TRACE
+    if (isEGLGpuTimerEnabled()) {
+        String8 result;
+        egl_gpu_timer_t::dump(result);
+        if (buffer && size > 0) {
+            strlcpy(buffer, result.string(), size);
+        }
+        return result.length();
+    }
+#endif
+    if (buffer && size > 0) {
+        buffer[0] = '\0';
+    }
+    return 0;
+}
+
 // ----------------------------------------------------------------------------
 // EGL 1.1
 // ----------------------------------------------------------------------------
@@ -1070,7 +1215,24 @@ EGLBoolean eglSurfaceAttrib(
     if (!_s.get())
         return setError(EGL_BAD_SURFACE, EGL_FALSE);
 
-    egl_surface_t const * const s = get_surface(surface);
+    egl_surface_t * const s = get_surface(surface);
+    if (attribute == EGL_FRAME_COMPLETION_TIMES_ANDROID) {
+        if (s->win == NULL || !strstr(dp->getExtensionString(),
+                "EGL_ANDROID_frame_completion_times")) {
+            return setError(EGL_BAD_MATCH, EGL_FALSE);
+        }
+        Mutex::Autolock _l(sFrameTimestampsLock);
+        if (!value) {
+            s->frameTimestamps.clear();
+        } else if (s->frameTimestamps == NULL) {
+            const char* exts = dp->disp.queryString.extensions;
+            const bool nativeFenceSync = exts &&
+                    strstr(exts, "EGL_ANDROID_native_fence_sync");
+            s->frameTimestamps = new egl_frame_timestamps_t(dpy,
+                    nativeFenceSync);
+        }
+        return EGL_TRUE;
+    }
     if (s->cnx->egl.eglSurfaceAttrib) {
         return s->cnx->egl.eglSurfaceAttrib(
                 dp->disp.dpy, s->surface, attribute, value);
@@ -1446,6 +1608,40 @@ EGLBoolean eglPresentationTimeANDROID(EGLDisplay dpy, EGLSurface surface,
     return EGL_TRUE;
 }
 
+/*
+ * Copies the queue and GPU completion times of the last count frames swapped
+ * on surface, oldest first, once EGL_FRAME_COMPLETION_TIMES_ANDROID has been
+ * set on it. Returns the number of frames copied. Frames whose GPU work isn't
+ * complete yet report EGL_FRAME_PENDING_ANDROID.
+ */
+EGLint eglGetFrameCompletionTimesANDROID(EGLDisplay dpy, EGLSurface surface,
+        EGLint count, EGLnsecsANDROID* queueTimes,
+        EGLnsecsANDROID* completeTimes)
+{
+    clearError();
+
+    const egl_display_ptr dp = validate_display(dpy);
+    if (!dp) {
+        return 0;
+    }
+
+    SurfaceRef _s(dp.get(), surface);
+    if (!_s.get()) {
+        return setError(EGL_BAD_SURFACE, 0);
+    }
+
+    if (count < 0) {
+        return setError(EGL_BAD_PARAMETER, 0);
+    }
+
+    egl_surface_t const * const s = get_surface(surface);
+    const sp<egl_frame_timestamps_t> timestamps(getFrameTimestamps(s));
+    if (timestamps == NULL) {
+        return setError(EGL_BAD_ACCESS, 0);
+    }
+    return timestamps->getTimestamps(count, queueTimes, completeTimes);
+}
+
 // ----------------------------------------------------------------------------
 // NVIDIA extensions
 // ----------------------------------------------------------------------------
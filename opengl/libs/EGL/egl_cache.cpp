@@ -20,8 +20,11 @@
 #include "egl_display.h"
 #include "egldefs.h"
 
+#include <cutils/properties.h>
+#include <utils/FileMap.h>
+
 #include <fcntl.h>
-#include <sys/mman.h>
+#include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -38,24 +41,41 @@
 #define MAX_EGL_CACHE_SIZE (64 * 1024);
 #endif
 
+#ifndef MAX_EGL_SHARED_CACHE_SIZE
+#define MAX_EGL_SHARED_CACHE_SIZE (512 * 1024);
+#endif
+
 // Cache size limits.
 static const size_t maxKeySize = MAX_EGL_CACHE_KEY_SIZE;
 static const size_t maxValueSize = MAX_EGL_CACHE_ENTRY_SIZE;
 static const size_t maxTotalSize = MAX_EGL_CACHE_SIZE;
+static const size_t maxSharedTotalSize = MAX_EGL_SHARED_CACHE_SIZE;
 
-// Cache file header
+// Cache file header: the magic, then padding that keeps the BlobCache contents
+// 8-byte aligned.
 static const char* cacheFileMagic = "EGL$";
 static const size_t cacheFileHeaderSize = 8;
 
 // The time in seconds to wait before saving newly inserted cache entries.
 static const unsigned int deferredSaveDelay = 4;
 
+// The number of times to try flattening the cache when it keeps growing while
+// being saved.
+static const int maxSaveAttempts = 3;
+
 // ----------------------------------------------------------------------------
 namespace android {
 // ----------------------------------------------------------------------------
 
 #define BC_EXT_STR "EGL_ANDROID_blob_cache"
 
+//
+// Entry point for processes to name their cache file, before eglInitialize.
+//
+extern "C" void egl_set_cache_filename(const char* filename) {
+    egl_cache_t::get()->setCacheFilename(filename);
+}
+
 //
 // Callback functions passed to EGL.
 //
@@ -74,7 +94,14 @@ static EGLsizeiANDROID getBlob(const void* key, EGLsizeiANDROID keySize,
 //
 egl_cache_t::egl_cache_t() :
         mInitialized(false),
-        mBlobCache(NULL) {
+        mBlobCache(NULL),
+        mSharedCache(NULL),
+        mSharedCacheTried(false),
+        mPrewarm(false),
+        mSavePending(false),
+        mDirty(false),
+        mCacheFileIno(0),
+        mCacheFileSize(0) {
 }
 
 egl_cache_t::~egl_cache_t() {
@@ -121,31 +148,74 @@ void egl_cache_t::initialize(egl_display_t *display) {
         }
     }
 
+    if (mSharedFilename.length() == 0) {
+        char value[PROPERTY_VALUE_MAX];
+        property_get("ro.egl.shared_cache", value, "");
+        mSharedFilename = value;
+    }
+
     mInitialized = true;
+
+    if (mBlobCache == NULL &&
+            (mFilename.length() > 0 || mSharedFilename.length() > 0)) {
+        class PrewarmThread : public Thread {
+        public:
+            PrewarmThread() : Thread(false) {}
+
+            virtual bool threadLoop() {
+                egl_cache_t::get()->prewarm();
+                return false;
+            }
+        };
+
+        // The thread holds a strong ref to itself until it has finished
+        // running.
+        sp<Thread> prewarmThread(new PrewarmThread());
+        prewarmThread->run("EGLCachePrewarm", PRIORITY_BACKGROUND);
+    }
 }
 
 void egl_cache_t::terminate() {
+    // This waits for a save in progress, and then saves what it missed.
+    saveBlobCache();
+
     Mutex::Autolock lock(mMutex);
-    if (mBlobCache != NULL) {
-        saveBlobCacheLocked();
-        mBlobCache = NULL;
-    }
+    mBlobCache = NULL;
+    mDirty = false;
+    mSharedCache = NULL;
+    mSharedCacheTried = false;
     mInitialized = false;
 }
 
-void egl_cache_t::setBlob(const void* key, EGLsizeiANDROID keySize,
-        const void* value, EGLsizeiANDROID valueSize) {
+void egl_cache_t::prewarm() {
     Mutex::Autolock lock(mMutex);
+    if (!mInitialized) {
+        return;
+    }
+    mPrewarm = true;
+    getBlobCacheLocked();
+    getSharedCacheLocked();
+    mPrewarm = false;
+}
 
+void egl_cache_t::setBlob(const void* key, EGLsizeiANDROID keySize,
+        const void* value, EGLsizeiANDROID valueSize) {
     if (keySize < 0 || valueSize < 0) {
         ALOGW("EGL_ANDROID_blob_cache set: negative sizes are not allowed");
         return;
     }
 
-    if (mInitialized) {
-        sp<BlobCache> bc = getBlobCacheLocked();
-        bc->set(key, keySize, value, valueSize);
+    // The BlobCache is thread-safe, so only hold mMutex to get at it; this
+    // lets shaders compiled on several threads use the cache in parallel.
+    sp<BlobCache> bc = getBlobCache();
+    if (bc == NULL) {
+        return;
+    }
+    bc->set(key, keySize, value, valueSize);
 
+    Mutex::Autolock lock(mMutex);
+    if (mInitialized) {
+        mDirty = true;
         if (!mSavePending) {
             class DeferredSaveThread : public Thread {
             public:
@@ -154,11 +224,12 @@ void egl_cache_t::setBlob(const void* key, EGLsizeiANDROID keySize,
                 virtual bool threadLoop() {
                     sleep(deferredSaveDelay);
                     egl_cache_t* c = egl_cache_t::get();
-                    Mutex::Autolock lock(c->mMutex);
-                    if (c->mInitialized) {
-                        c->saveBlobCacheLocked();
+                    {
+                        // Entries set from now on need another save.
+                        Mutex::Autolock lock(c->mMutex);
+                        c->mSavePending = false;
                     }
-                    c->mSavePending = false;
+                    c->saveBlobCache();
                     return false;
                 }
             };
@@ -174,16 +245,19 @@ void egl_cache_t::setBlob(const void* key, EGLsizeiANDROID keySize,
 
 EGLsizeiANDROID egl_cache_t::getBlob(const void* key, EGLsizeiANDROID keySize,
         void* value, EGLsizeiANDROID valueSize) {
-    Mutex::Autolock lock(mMutex);
-
     if (keySize < 0 || valueSize < 0) {
         ALOGW("EGL_ANDROID_blob_cache set: negative sizes are not allowed");
         return 0;
     }
 
-    if (mInitialized) {
-        sp<BlobCache> bc = getBlobCacheLocked();
-        return bc->get(key, keySize, value, valueSize);
+    sp<BlobCache> shared;
+    sp<BlobCache> bc = getBlobCache(&shared);
+    if (bc != NULL) {
+        EGLsizeiANDROID size = bc->get(key, keySize, value, valueSize);
+        if (size == 0 && shared != NULL) {
+            size = shared->get(key, keySize, value, valueSize);
+        }
+        return size;
     }
     return 0;
 }
@@ -193,6 +267,56 @@ void egl_cache_t::setCacheFilename(const char* filename) {
     mFilename = filename;
 }
 
+void egl_cache_t::setSharedCacheFilename(const char* filename) {
+    Mutex::Autolock lock(mMutex);
+    mSharedFilename = filename;
+    mSharedCache = NULL;
+    mSharedCacheTried = false;
+}
+
+sp<BlobCache> egl_cache_t::getBlobCache(sp<BlobCache>* shared) {
+    Mutex::Autolock lock(mMutex);
+    if (!mInitialized) {
+        return NULL;
+    }
+    if (shared != NULL) {
+        *shared = getSharedCacheLocked();
+    }
+    return getBlobCacheLocked();
+}
+
+sp<BlobCache> egl_cache_t::getSharedCacheLocked() {
+    if (mSharedCacheTried) {
+        return mSharedCache;
+    }
+    mSharedCacheTried = true;
+
+    // The per-process cache file may be the shared one, in the process that
+    // produces it; it would then only be looked up twice.
+    if (mSharedFilename.length() == 0 || mSharedFilename == mFilename) {
+        return NULL;
+    }
+    int fd = open(mSharedFilename.string(), O_RDONLY, 0);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            ALOGE("error opening shared cache file %s: %s (%d)",
+                    mSharedFilename.string(), strerror(errno), errno);
+        }
+        return NULL;
+    }
+    // Nothing is ever set in it, so its maximum size only bounds what
+    // attach keeps of the file.
+    sp<BlobCache> bc = new BlobCache(maxKeySize, maxValueSize,
+            maxSharedTotalSize);
+    struct stat statBuf;
+    if (attachCacheFile(bc.get(), mSharedFilename.string(), fd,
+            maxSharedTotalSize * 2, mPrewarm, &statBuf)) {
+        mSharedCache = bc;
+    }
+    close(fd);
+    return mSharedCache;
+}
+
 sp<BlobCache> egl_cache_t::getBlobCacheLocked() {
     if (mBlobCache == NULL) {
         mBlobCache = new BlobCache(maxKeySize, maxValueSize, maxTotalSize);
@@ -201,154 +325,287 @@ sp<BlobCache> egl_cache_t::getBlobCacheLocked() {
     return mBlobCache;
 }
 
-static uint32_t crc32c(const uint8_t* buf, size_t len) {
-    const uint32_t polyBits = 0x82F63B78;
-    uint32_t r = 0;
-    for (size_t i = 0; i < len; i++) {
-        r ^= buf[i];
-        for (int j = 0; j < 8; j++) {
-            if (r & 1) {
-                r = (r >> 1) ^ polyBits;
-            } else {
-                r >>= 1;
-            }
+void egl_cache_t::saveBlobCache() {
+    Mutex::Autolock saveLock(mSaveLock);
+
+    // Only take what the save needs with mMutex held, so that the cache
+    // remains usable while it is written out.
+    sp<BlobCache> bc;
+    String8 filename;
+    ino_t cacheFileIno;
+    size_t cacheFileSize;
+    {
+        Mutex::Autolock lock(mMutex);
+        if (!mInitialized || !mDirty || mBlobCache == NULL ||
+                mFilename.length() == 0) {
+            // Nothing was set since the last save, only looked up.
+            return;
         }
+        mDirty = false;
+        bc = mBlobCache;
+        filename = mFilename;
+        cacheFileIno = mCacheFileIno;
+        cacheFileSize = mCacheFileSize;
     }
-    return r;
-}
 
-void egl_cache_t::saveBlobCacheLocked() {
-    if (mFilename.length() > 0) {
-        size_t cacheSize = mBlobCache->getFlattenedSize();
-        size_t headerSize = cacheFileHeaderSize;
-        const char* fname = mFilename.string();
+    struct stat statBuf;
+    bool saved = false;
+    size_t appendOffset = bc->getAppendOffset();
+    if (appendOffset != 0) {
+        saved = appendCacheFile(bc.get(), filename.string(), appendOffset,
+                cacheFileIno, cacheFileSize, &statBuf);
+    }
+    if (!saved) {
+        saved = writeCacheFile(bc.get(), filename.string(), &statBuf);
+    }
 
-        // Try to create the file with no permissions so we can write it
-        // without anyone trying to read it.
-        int fd = open(fname, O_CREAT | O_EXCL | O_RDWR, 0);
-        if (fd == -1) {
-            if (errno == EEXIST) {
-                // The file exists, delete it and try again.
-                if (unlink(fname) == -1) {
-                    // No point in retrying if the unlink failed.
-                    ALOGE("error unlinking cache file %s: %s (%d)", fname,
-                            strerror(errno), errno);
-                    return;
-                }
-                // Retry now that we've unlinked the file.
-                fd = open(fname, O_CREAT | O_EXCL | O_RDWR, 0);
-            }
-            if (fd == -1) {
-                ALOGE("error creating cache file %s: %s (%d)", fname,
+    Mutex::Autolock lock(mMutex);
+    if (mBlobCache == bc) {
+        if (saved) {
+            mCacheFileIno = statBuf.st_ino;
+            mCacheFileSize = statBuf.st_size;
+        } else {
+            mDirty = true;
+        }
+    }
+}
+
+bool egl_cache_t::writeCacheFile(BlobCache* bc, const char* fname,
+        struct stat* statBuf) {
+    size_t cacheSize = bc->getFlattenedSize();
+    size_t headerSize = cacheFileHeaderSize;
+
+    // The contents are written to a temporary file which then replaces the
+    // cache file, so that the cache file is complete whenever it is read.
+    // It is created with no permissions so that nobody reads it before that.
+    String8 tmpName(fname);
+    tmpName.append(".tmp");
+    const char* tname = tmpName.string();
+    int fd = open(tname, O_CREAT | O_EXCL | O_RDWR, 0);
+    if (fd == -1) {
+        if (errno == EEXIST) {
+            // Left over from a save that failed, delete it and try again.
+            if (unlink(tname) == -1) {
+                // No point in retrying if the unlink failed.
+                ALOGE("error unlinking cache file %s: %s (%d)", tname,
                         strerror(errno), errno);
-                return;
+                return false;
             }
+            // Retry now that we've unlinked the file.
+            fd = open(tname, O_CREAT | O_EXCL | O_RDWR, 0);
         }
+        if (fd == -1) {
+            ALOGE("error creating cache file %s: %s (%d)", tname,
+                    strerror(errno), errno);
+            return false;
+        }
+    }
 
-        size_t fileSize = headerSize + cacheSize;
-
-        uint8_t* buf = new uint8_t [fileSize];
+    size_t fileSize;
+    uint8_t* buf;
+    status_t err;
+    for (int attempt = 0; ; attempt++) {
+        fileSize = headerSize + cacheSize;
+        buf = new uint8_t [fileSize];
         if (!buf) {
             ALOGE("error allocating buffer for cache contents: %s (%d)",
                     strerror(errno), errno);
             close(fd);
-            unlink(fname);
-            return;
+            unlink(tname);
+            return false;
         }
 
-        status_t err = mBlobCache->flatten(buf + headerSize, cacheSize, NULL,
-                0);
-        if (err != OK) {
-            ALOGE("error writing cache contents: %s (%d)", strerror(-err),
-                    -err);
-            delete [] buf;
-            close(fd);
-            unlink(fname);
-            return;
+        err = bc->flatten(buf + headerSize, cacheSize, NULL, 0);
+        // setBlob doesn't hold mMutex while it updates the cache, so it
+        // may have grown since its size was taken; try again.
+        if (err != BAD_VALUE || attempt == maxSaveAttempts - 1) {
+            break;
         }
+        delete [] buf;
+        cacheSize = bc->getFlattenedSize();
+    }
+    if (err != OK) {
+        ALOGE("error writing cache contents: %s (%d)", strerror(-err),
+                -err);
+        delete [] buf;
+        close(fd);
+        unlink(tname);
+        return false;
+    }
 
-        // Write the file magic and CRC
-        memcpy(buf, cacheFileMagic, 4);
-        uint32_t* crc = reinterpret_cast<uint32_t*>(buf + 4);
-        *crc = crc32c(buf + headerSize, cacheSize);
-
-        if (write(fd, buf, fileSize) == -1) {
-            ALOGE("error writing cache file: %s (%d)", strerror(errno),
-                    errno);
-            delete [] buf;
-            close(fd);
-            unlink(fname);
-            return;
-        }
+    // Write the file magic.  The BlobCache contents check themselves.
+    memcpy(buf, cacheFileMagic, 4);
+    memset(buf + 4, 0, headerSize - 4);
 
+    if (write(fd, buf, fileSize) == -1) {
+        ALOGE("error writing cache file: %s (%d)", strerror(errno),
+                errno);
         delete [] buf;
-        fchmod(fd, S_IRUSR);
         close(fd);
+        unlink(tname);
+        return false;
+    }
+
+    delete [] buf;
+    // The file stays writable so that later saves can append to it.
+    fchmod(fd, S_IRUSR | S_IWUSR);
+
+    if (rename(tname, fname) == -1) {
+        ALOGE("error renaming cache file %s: %s (%d)", tname,
+                strerror(errno), errno);
+        close(fd);
+        unlink(tname);
+        return false;
     }
+
+    // Use the file instead of the copies of the entries that were written.
+    bool attached = attachCacheFile(bc, fname, fd, maxTotalSize * 2, false,
+            statBuf);
+    close(fd);
+    return attached;
 }
 
-void egl_cache_t::loadBlobCacheLocked() {
-    if (mFilename.length() > 0) {
-        size_t headerSize = cacheFileHeaderSize;
+bool egl_cache_t::appendCacheFile(BlobCache* bc, const char* fname,
+        size_t appendOffset, ino_t cacheFileIno, size_t cacheFileSize,
+        struct stat* statBuf) {
+    size_t headerSize = cacheFileHeaderSize;
 
-        int fd = open(mFilename.string(), O_RDONLY, 0);
-        if (fd == -1) {
-            if (errno != ENOENT) {
-                ALOGE("error opening cache file %s: %s (%d)", mFilename.string(),
-                        strerror(errno), errno);
-            }
-            return;
-        }
+    // Only append to the file the cache is attached to, as it was left.
+    int fd = open(fname, O_RDWR, 0);
+    if (fd == -1) {
+        return false;
+    }
+    if (fstat(fd, statBuf) == -1 || statBuf->st_ino != cacheFileIno ||
+            size_t(statBuf->st_size) != cacheFileSize) {
+        close(fd);
+        return false;
+    }
 
-        struct stat statBuf;
-        if (fstat(fd, &statBuf) == -1) {
-            ALOGE("error stat'ing cache file: %s (%d)", strerror(errno), errno);
+    size_t appendSize;
+    uint8_t* buf;
+    status_t err;
+    for (int attempt = 0; ; attempt++) {
+        appendSize = bc->getAppendSize();
+        if (headerSize + appendOffset + appendSize > maxTotalSize * 2) {
+            // Too much of the file is taken by evicted entries, so it must be
+            // rewritten.
             close(fd);
-            return;
+            return false;
         }
 
-        // Sanity check the size before trying to mmap it.
-        size_t fileSize = statBuf.st_size;
-        if (fileSize > maxTotalSize * 2) {
-            ALOGE("cache file is too large: %#llx", statBuf.st_size);
+        buf = new uint8_t [appendSize];
+        if (!buf) {
+            ALOGE("error allocating buffer for cache contents: %s (%d)",
+                    strerror(errno), errno);
             close(fd);
-            return;
+            return false;
         }
 
-        uint8_t* buf = reinterpret_cast<uint8_t*>(mmap(NULL, fileSize,
-                PROT_READ, MAP_PRIVATE, fd, 0));
-        if (buf == MAP_FAILED) {
-            ALOGE("error mmaping cache file: %s (%d)", strerror(errno),
-                    errno);
-            close(fd);
-            return;
+        err = bc->flattenAppend(buf, appendSize);
+        if (err != BAD_VALUE || attempt == maxSaveAttempts - 1) {
+            break;
         }
+        delete [] buf;
+    }
+    if (err != OK) {
+        ALOGE("error writing cache contents: %s (%d)", strerror(-err),
+                -err);
+        delete [] buf;
+        close(fd);
+        return false;
+    }
 
-        // Check the file magic and CRC
-        size_t cacheSize = fileSize - headerSize;
-        if (memcmp(buf, cacheFileMagic, 4) != 0) {
-            ALOGE("cache file has bad mojo");
-            close(fd);
-            return;
-        }
-        uint32_t* crc = reinterpret_cast<uint32_t*>(buf + 4);
-        if (crc32c(buf + headerSize, cacheSize) != *crc) {
-            ALOGE("cache file failed CRC check");
-            close(fd);
-            return;
-        }
+    // The new entries and index replace the old index, so if this fails
+    // half-way the index check will reject the file when it is next loaded.
+    off_t fileSize = headerSize + appendOffset + appendSize;
+    if (pwrite(fd, buf, appendSize, headerSize + appendOffset) !=
+            ssize_t(appendSize) || ftruncate(fd, fileSize) == -1) {
+        ALOGE("error appending to cache file: %s (%d)", strerror(errno),
+                errno);
+        delete [] buf;
+        close(fd);
+        unlink(fname);
+        return false;
+    }
 
-        status_t err = mBlobCache->unflatten(buf + headerSize, cacheSize, NULL,
-                0);
-        if (err != OK) {
-            ALOGE("error reading cache contents: %s (%d)", strerror(-err),
-                    -err);
-            munmap(buf, fileSize);
-            close(fd);
+    delete [] buf;
+    bool attached = attachCacheFile(bc, fname, fd, maxTotalSize * 2, false,
+            statBuf);
+    close(fd);
+    return attached;
+}
+
+void egl_cache_t::attachBlobCacheLocked(int fd) {
+    struct stat statBuf;
+    if (attachCacheFile(mBlobCache.get(), mFilename.string(), fd,
+            maxTotalSize * 2, mPrewarm, &statBuf)) {
+        mCacheFileIno = statBuf.st_ino;
+        mCacheFileSize = statBuf.st_size;
+    }
+}
+
+bool egl_cache_t::attachCacheFile(BlobCache* bc, const char* fname, int fd,
+        size_t maxFileSize, bool prefetch, struct stat* statBuf) {
+    size_t headerSize = cacheFileHeaderSize;
+
+    if (fstat(fd, statBuf) == -1) {
+        ALOGE("error stat'ing cache file: %s (%d)", strerror(errno), errno);
+        return false;
+    }
+
+    // Sanity check the size before trying to mmap it.
+    size_t fileSize = statBuf->st_size;
+    if (fileSize > maxFileSize) {
+        ALOGE("cache file is too large: %#llx", statBuf->st_size);
+        return false;
+    }
+    if (fileSize < headerSize) {
+        ALOGE("cache file is too small: %#llx", statBuf->st_size);
+        return false;
+    }
+
+    FileMap* map = new FileMap();
+    if (!map->create(fname, fd, 0, fileSize, true)) {
+        ALOGE("error mmaping cache file: %s (%d)", strerror(errno),
+                errno);
+        map->release();
+        return false;
+    }
+
+    // Check the file magic
+    if (memcmp(map->getDataPtr(), cacheFileMagic, 4) != 0) {
+        ALOGE("cache file has bad mojo");
+        map->release();
+        return false;
+    }
+
+    if (prefetch) {
+        map->advise(FileMap::WILLNEED);
+    }
+
+    // The BlobCache takes over the map, and only reads the index of the
+    // entries until they are looked up.
+    status_t err = bc->attach(map, headerSize);
+    if (err != OK) {
+        ALOGE("error reading cache contents: %s (%d)", strerror(-err),
+                -err);
+        return false;
+    }
+    return true;
+}
+
+void egl_cache_t::loadBlobCacheLocked() {
+    if (mFilename.length() > 0) {
+        int fd = open(mFilename.string(), O_RDONLY, 0);
+        if (fd == -1) {
+            if (errno != ENOENT) {
+                ALOGE("error opening cache file %s: %s (%d)", mFilename.string(),
+                        strerror(errno), errno);
+            }
             return;
         }
 
-        munmap(buf, fileSize);
+        attachBlobCacheLocked(fd);
         close(fd);
     }
 }
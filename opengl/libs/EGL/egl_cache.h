@@ -20,6 +20,9 @@
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 
+#include <sys/stat.h>
+#include <sys/types.h>
+
 #include <utils/BlobCache.h>
 #include <utils/String8.h>
 #include <utils/StrongPointer.h>
@@ -65,6 +68,19 @@ public:
     // cache contents from one program invocation to another.
     void setCacheFilename(const char* filename);
 
+    // setSharedCacheFilename sets the name of a cache file shared by all
+    // processes, in the same format as the per-process cache files, which
+    // getBlob looks into when the per-process cache misses.  It is only ever
+    // read, through a read-only mapping, so its pages are shared by every
+    // process that uses it.  An empty string, the default, means the file
+    // named by the ro.egl.shared_cache property.
+    void setSharedCacheFilename(const char* filename);
+
+    // prewarm loads both cache tiers now, rather than when the first shader
+    // is compiled, and asks the kernel to read their files ahead.
+    // initialize runs it on a background thread when there is a cache file.
+    void prewarm();
+
 private:
     // Creation and (the lack of) destruction is handled internally.
     egl_cache_t();
@@ -74,15 +90,58 @@ private:
     egl_cache_t(const egl_cache_t&); // not implemented
     void operator=(const egl_cache_t&); // not implemented
 
+    // getBlobCache returns the BlobCache object being used to store the
+    // key/value blob pairs, creating it as getBlobCacheLocked does, or NULL
+    // when the egl_cache_t is not in the initialized state.  The BlobCache
+    // may then be used without holding mMutex.  If shared isn't NULL it is
+    // set to the shared cache as getSharedCacheLocked returns it.
+    sp<BlobCache> getBlobCache(sp<BlobCache>* shared = NULL);
+
+    // getSharedCacheLocked returns the BlobCache attached to the shared cache
+    // file, attaching it the first time, or NULL if there is no usable
+    // shared cache file.
+    sp<BlobCache> getSharedCacheLocked();
+
     // getBlobCacheLocked returns the BlobCache object being used to store the
     // key/value blob pairs.  If the BlobCache object has not yet been created,
     // this will do so, loading the serialized cache contents from disk if
     // possible.
     sp<BlobCache> getBlobCacheLocked();
 
-    // saveBlobCache attempts to save the current contents of mBlobCache to
-    // disk.
-    void saveBlobCacheLocked();
+    // saveBlobCache attempts to save the contents of mBlobCache to disk if
+    // anything was set in it since the last save, appending the entries added
+    // since the cache file was attached if it can, and rewriting the whole
+    // file otherwise.  It must be called without holding mMutex, which it
+    // only holds to take a reference to mBlobCache, so that the cache can be
+    // used while the file is written.  Saves are serialized by mSaveLock.
+    void saveBlobCache();
+
+    // writeCacheFile writes the contents of bc to a temporary file which then
+    // replaces the cache file fname, and attaches bc to the new file.  On
+    // success it returns true, and the new file's status in statBuf.
+    static bool writeCacheFile(BlobCache* bc, const char* fname,
+            struct stat* statBuf);
+
+    // appendCacheFile writes the entries added to bc since it was attached
+    // at the end of the cache file fname, in place of its index which starts
+    // at appendOffset, and attaches bc to the longer file.  It returns false,
+    // leaving the rewrite to the caller, if the file isn't the one identified
+    // by cacheFileIno and cacheFileSize anymore or would grow too large.
+    static bool appendCacheFile(BlobCache* bc, const char* fname,
+            size_t appendOffset, ino_t cacheFileIno, size_t cacheFileSize,
+            struct stat* statBuf);
+
+    // attachBlobCacheLocked checks the header of the open cache file fd and
+    // attaches mBlobCache to a read-only mapping of it.  The entries are only
+    // read and checked when they are first looked up.
+    void attachBlobCacheLocked(int fd);
+
+    // attachCacheFile checks the header of the open cache file fd, named
+    // fname, and attaches bc to a read-only mapping of it, which is read
+    // ahead if prefetch is set.  On success it returns true, and the file's
+    // status in statBuf.
+    static bool attachCacheFile(BlobCache* bc, const char* fname, int fd,
+            size_t maxFileSize, bool prefetch, struct stat* statBuf);
 
     // loadBlobCache attempts to load the saved cache contents from disk into
     // mBlobCache.
@@ -101,6 +160,20 @@ private:
     // first time it's needed.
     sp<BlobCache> mBlobCache;
 
+    // mSharedCache is the read-only cache attached to mSharedFilename.  It is
+    // created by getSharedCacheLocked the first time it's needed, and
+    // mSharedCacheTried keeps it from trying again when that fails.
+    sp<BlobCache> mSharedCache;
+    bool mSharedCacheTried;
+
+    // mSharedFilename is the name of the shared cache file, set with
+    // setSharedCacheFilename or from the ro.egl.shared_cache property.
+    String8 mSharedFilename;
+
+    // mPrewarm is set while prewarm runs, so that the cache files it
+    // attaches are read ahead.
+    bool mPrewarm;
+
     // mFilename is the name of the file for storing cache contents in between
     // program invocations.  It is initialized to an empty string at
     // construction time, and can be set with the setCacheFilename method.  An
@@ -115,10 +188,25 @@ private:
     // contents to disk.
     bool mSavePending;
 
+    // mDirty indicates whether entries were set since the last save, which
+    // is skipped otherwise.
+    bool mDirty;
+
+    // mCacheFileIno and mCacheFileSize identify the cache file as it was when
+    // mBlobCache was last attached to it, so that saves only append to that
+    // file.
+    ino_t mCacheFileIno;
+    size_t mCacheFileSize;
+
     // mMutex is the mutex used to prevent concurrent access to the member
-    // variables. It must be locked whenever the member variables are accessed.
+    // variables. It must be locked whenever the member variables are accessed,
+    // but not while using the BlobCache they point to, which is thread-safe.
     mutable Mutex mMutex;
 
+    // mSaveLock serializes saves, and is held for the whole of a save.  It
+    // must be locked before mMutex when both are held.
+    Mutex mSaveLock;
+
     // sCache is the singleton egl_cache_t object.
     static egl_cache_t sCache;
 };
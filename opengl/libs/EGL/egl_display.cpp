@@ -25,6 +25,8 @@
 #include "egl_object.h"
 #include "egl_tls.h"
 #include "Loader.h"
+#include <cutils/atomic.h>
+#include <cutils/atomic-inline.h>
 #include <cutils/properties.h>
 
 // ----------------------------------------------------------------------------
@@ -70,14 +72,150 @@ void egl_display_t::removeObject(egl_object_t* object) {
 }
 
 bool egl_display_t::getObject(egl_object_t* object) const {
-    Mutex::Autolock _l(lock);
-    if (objects.indexOf(object) >= 0) {
-        if (object->getDisplay() == this) {
-            object->incRef();
-            return true;
+    // only objects of this display are in the set
+    return objects.acquire(object);
+}
+
+void egl_display_t::retireObject(egl_object_t* object) {
+    objects.retire(object);
+}
+
+// ----------------------------------------------------------------------------
+
+egl_display_t::ObjectSet::ObjectSet() :
+    mTable(allocTable(MIN_SLOTS)), mSize(0), mUsed(0), mReaders(0) {
+}
+
+egl_display_t::ObjectSet::~ObjectSet() {
+    ::operator delete(mTable);
+    for (size_t i = 0; i < mRetired.size(); i++) {
+        ::operator delete(mRetired[i]);
+    }
+}
+
+egl_display_t::ObjectSet::Table* egl_display_t::ObjectSet::allocTable(size_t slots) {
+    Table* table = static_cast<Table*>(::operator new(
+            sizeof(Table) + (slots - 1) * sizeof(uintptr_t)));
+    table->mask = slots - 1;
+    for (size_t i = 0; i < slots; i++) {
+        table->slots[i] = EMPTY;
+    }
+    return table;
+}
+
+void egl_display_t::ObjectSet::add(egl_object_t* object) {
+    if ((mUsed + 1) * 4 > (mTable->mask + 1) * 3) {
+        // grow, or just drop the REMOVED slots if there are enough
+        size_t slots = MIN_SLOTS;
+        while (slots * 3 < (mSize + 1) * 8) {
+            slots *= 2;
         }
+        rebuild(slots);
     }
-    return false;
+    Table* const table = mTable;
+    const uintptr_t value = uintptr_t(object);
+    size_t i = slotFor(table, value);
+    while (table->slots[i] != EMPTY && table->slots[i] != REMOVED) {
+        i = (i + 1) & table->mask;
+    }
+    if (table->slots[i] == EMPTY) {
+        mUsed++;
+    }
+    // the object must be constructed before readers can see it
+    android_memory_barrier();
+    table->slots[i] = value;
+    mSize++;
+}
+
+void egl_display_t::ObjectSet::remove(egl_object_t* object) {
+    Table* const table = mTable;
+    const uintptr_t value = uintptr_t(object);
+    for (size_t i = slotFor(table, value); table->slots[i] != EMPTY;
+            i = (i + 1) & table->mask) {
+        if (table->slots[i] == value) {
+            table->slots[i] = REMOVED;
+            mSize--;
+            return;
+        }
+    }
+}
+
+void egl_display_t::ObjectSet::takeAll(Vector<egl_object_t*>* outObjects) {
+    Table* const table = mTable;
+    for (size_t i = 0; i <= table->mask; i++) {
+        const uintptr_t value = table->slots[i];
+        if (value != EMPTY && value != REMOVED) {
+            outObjects->add(reinterpret_cast<egl_object_t*>(value));
+        }
+    }
+    rebuild(MIN_SLOTS);
+}
+
+void egl_display_t::ObjectSet::rebuild(size_t slots) {
+    Table* const old = mTable;
+    Table* const table = allocTable(slots);
+    if (mSize) {
+        for (size_t i = 0; i <= old->mask; i++) {
+            const uintptr_t value = old->slots[i];
+            if (value != EMPTY && value != REMOVED) {
+                size_t j = slotFor(table, value);
+                while (table->slots[j] != EMPTY) {
+                    j = (j + 1) & table->mask;
+                }
+                table->slots[j] = value;
+            }
+        }
+    }
+    mUsed = mSize;
+    // publish the filled table
+    android_memory_barrier();
+    mTable = table;
+    retire(old);
+}
+
+bool egl_display_t::ObjectSet::acquire(egl_object_t* object) const {
+    bool found = false;
+    android_atomic_inc(&mReaders);
+    // our count must be visible before we load anything from the table,
+    // see reclaim()
+    android_memory_barrier();
+    const Table* const table = mTable;
+    const uintptr_t value = uintptr_t(object);
+    for (size_t i = slotFor(table, value); ; i = (i + 1) & table->mask) {
+        const uintptr_t slot = table->slots[i];
+        if (slot == EMPTY) {
+            break;
+        }
+        if (slot == value) {
+            // fails if the object was destroyed since we loaded the slot
+            found = object->tryIncRef();
+            break;
+        }
+    }
+    android_atomic_dec(&mReaders);
+    return found;
+}
+
+void egl_display_t::ObjectSet::retire(void* memory) {
+    Mutex::Autolock _l(mRetiredLock);
+    mRetired.add(memory);
+    reclaim();
+}
+
+void egl_display_t::ObjectSet::reclaim() {
+    // Memory is retired after it was unlinked from the table.  A reader
+    // which still sees it must have counted itself in mReaders before
+    // loading it; one which counts itself after the barrier below can't
+    // find it anymore.
+    android_memory_barrier();
+    if (android_atomic_acquire_load(&mReaders) != 0) {
+        // try again with the next retirement
+        return;
+    }
+    for (size_t i = 0; i < mRetired.size(); i++) {
+        ::operator delete(mRetired[i]);
+    }
+    mRetired.clear();
 }
 
 EGLDisplay egl_display_t::getFromNativeDisplay(EGLNativeDisplayType disp) {
@@ -210,6 +348,12 @@ EGLBoolean egl_display_t::initialize(EGLint *major, EGLint *minor) {
         }
     } while (end);
 
+    // EGL_ANDROID_frame_completion_times is implemented here on top of
+    // the implementation's fences
+    if (strstr(mExtensionString.string(), "EGL_KHR_fence_sync ")) {
+        mExtensionString.append("EGL_ANDROID_frame_completion_times ");
+    }
+
     egl_cache_t::get()->initialize(this);
 
     char value[PROPERTY_VALUE_MAX];
@@ -274,17 +418,17 @@ EGLBoolean egl_display_t::terminate() {
 
     // Mark all objects remaining in the list as terminated, unless
     // there are no reference to them, it which case, we're free to
-    // delete them.
-    size_t count = objects.size();
+    // delete them.  They leave the list first, so that no other thread
+    // can take a reference to a deleted object.
+    Vector<egl_object_t*> remaining;
+    objects.takeAll(&remaining);
+    size_t count = remaining.size();
     ALOGW_IF(count, "eglTerminate() called w/ %d objects remaining", count);
     for (size_t i=0 ; i<count ; i++) {
-        egl_object_t* o = objects.itemAt(i);
+        egl_object_t* o = remaining.itemAt(i);
         o->destroy();
     }
 
-    // this marks all object handles are "terminated"
-    objects.clear();
-
     refs--;
     return res;
 }
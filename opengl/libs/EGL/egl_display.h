@@ -27,6 +27,7 @@
 
 #include <cutils/compiler.h>
 #include <utils/SortedVector.h>
+#include <utils/Vector.h>
 #include <utils/threads.h>
 #include <utils/String8.h>
 
@@ -66,7 +67,11 @@ public:
     // remove object from this display's list
     void removeObject(egl_object_t* object);
     // add reference to this object. returns true if this is a valid object.
+    // this doesn't take the display's lock.
     bool getObject(egl_object_t* object) const;
+    // free the memory of an object of this display once its destructor has
+    // run, as soon as no thread can be validating it in getObject().
+    void retireObject(egl_object_t* object);
 
     // These notifications allow the display to keep track of how many window
     // surfaces exist, which it uses to decide whether to hibernate the
@@ -128,9 +133,51 @@ private:
     bool enter() { return mHibernation.incWakeCount(HibernationMachine::WEAK); }
     void leave() { return mHibernation.decWakeCount(HibernationMachine::WEAK); }
 
+    // A set of object pointers that can be looked up without a lock.
+    // add(), remove() and takeAll() must be called with the display's lock
+    // held.  The memory of the objects removed from the set, and of the
+    // set's own outgrown tables, is handed to retire(), which frees it once
+    // no thread is in the middle of acquire().
+    class ObjectSet {
+    public:
+        ObjectSet();
+        ~ObjectSet();
+
+        void add(egl_object_t* object);
+        void remove(egl_object_t* object);
+        // removes all the objects from the set and returns them
+        void takeAll(Vector<egl_object_t*>* outObjects);
+        // adds a reference to object if it is in the set
+        bool acquire(egl_object_t* object) const;
+        void retire(void* memory);
+        size_t size() const { return mSize; }
+
+    private:
+        struct Table {
+            size_t mask;            // number of slots - 1
+            volatile uintptr_t slots[1];
+        };
+
+        enum { EMPTY = 0, REMOVED = 1, MIN_SLOTS = 16 };
+
+        static inline size_t slotFor(const Table* table, uintptr_t object) {
+            return ((object >> 3) * 0x9E3779B9U) & table->mask;
+        }
+        static Table* allocTable(size_t slots);
+        void rebuild(size_t slots);
+        void reclaim();
+
+        Table* volatile mTable;
+        size_t mSize;               // objects in the table
+        size_t mUsed;               // slots not EMPTY, including REMOVED ones
+        mutable volatile int32_t mReaders;  // threads in acquire()
+        Mutex mRetiredLock;
+        Vector<void*> mRetired;     // memory waiting for mReaders to be 0
+    };
+
             uint32_t                    refs;
     mutable Mutex                       lock;
-            SortedVector<egl_object_t*> objects;
+            ObjectSet                   objects;
             String8 mVendorString;
             String8 mVersionString;
             String8 mClientApiString;
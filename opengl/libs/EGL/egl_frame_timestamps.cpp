@@ -0,0 +1,207 @@
+/*
+ ** Copyright 2013, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cutils/log.h>
+#include <sync/sync.h>
+
+#include <utils/Condition.h>
+#include <utils/Thread.h>
+#include <utils/Vector.h>
+
+#include "egl_frame_timestamps.h"
+
+// ----------------------------------------------------------------------------
+namespace android {
+// ----------------------------------------------------------------------------
+
+/*
+ * Waits for the fences of the frames swapped on every surface that has
+ * EGL_FRAME_COMPLETION_TIMES_ANDROID set, in the order they were queued.
+ */
+class FrameTimestampThread : public Thread {
+public:
+    struct pending_t {
+        sp<egl_frame_timestamps_t> owner;
+        uint32_t frame;
+        EGLSyncKHR sync;        // EGL_SYNC_FENCE_KHR, or
+        int fenceFd;            // the fd of an EGL_SYNC_NATIVE_FENCE_ANDROID
+    };
+
+    static void queue(const pending_t& pending) {
+        static sp<FrameTimestampThread> thread(new FrameTimestampThread);
+        static bool running = false;
+        Mutex::Autolock lock(thread->mMutex);
+        if (!running) {
+            thread->run("GPUFrameTimestamps");
+            running = true;
+        }
+        thread->mQueue.push_back(pending);
+        thread->mCondition.signal();
+    }
+
+private:
+    virtual bool threadLoop() {
+        pending_t pending;
+        {
+            Mutex::Autolock lock(mMutex);
+            while (mQueue.isEmpty()) {
+                mCondition.wait(mMutex);
+            }
+            pending = mQueue[0];
+            mQueue.removeAt(0);
+        }
+        nsecs_t time = -1;
+        if (pending.fenceFd >= 0) {
+            time = waitForNativeFence(pending.fenceFd);
+            close(pending.fenceFd);
+        } else {
+            EGLDisplay dpy = pending.owner->mDisplay;
+            EGLint result = eglClientWaitSyncKHR(dpy, pending.sync, 0,
+                    EGL_FOREVER_KHR);
+            if (result == EGL_CONDITION_SATISFIED_KHR) {
+                time = systemTime(SYSTEM_TIME_MONOTONIC);
+            } else {
+                ALOGE("FrameTimestamps: error waiting for fence: %#x",
+                        eglGetError());
+            }
+            eglDestroySyncKHR(dpy, pending.sync);
+        }
+        pending.owner->setCompleteTime(pending.frame, time);
+        return true;
+    }
+
+    // Returns the time at which the fence signaled, according to the sync
+    // driver, or -1 on error.
+    static nsecs_t waitForNativeFence(int fd) {
+        if (sync_wait(fd, -1) < 0) {
+            ALOGE("FrameTimestamps: error waiting for fence fd %d: %s",
+                    fd, strerror(errno));
+            return -1;
+        }
+        struct sync_fence_info_data* finfo = sync_fence_info(fd);
+        if (finfo == NULL) {
+            return systemTime(SYSTEM_TIME_MONOTONIC);
+        }
+        struct sync_pt_info* pinfo = NULL;
+        uint64_t timestamp = 0;
+        while ((pinfo = sync_pt_info(finfo, pinfo)) != NULL) {
+            if (pinfo->timestamp_ns > timestamp) {
+                timestamp = pinfo->timestamp_ns;
+            }
+        }
+        sync_fence_info_free(finfo);
+        return nsecs_t(timestamp);
+    }
+
+    Vector<pending_t> mQueue;
+    Condition mCondition;
+    Mutex mMutex;
+};
+
+// ----------------------------------------------------------------------------
+
+egl_frame_timestamps_t::egl_frame_timestamps_t(EGLDisplay dpy,
+        bool nativeFenceSync)
+    : mDisplay(dpy), mNativeFenceSync(nativeFenceSync), mFrameCount(0) {
+}
+
+egl_frame_timestamps_t::~egl_frame_timestamps_t() {
+}
+
+EGLSyncKHR egl_frame_timestamps_t::createFrameSync() {
+    if (mNativeFenceSync) {
+        EGLSyncKHR sync = eglCreateSyncKHR(mDisplay,
+                EGL_SYNC_NATIVE_FENCE_ANDROID, NULL);
+        if (sync != EGL_NO_SYNC_KHR) {
+            return sync;
+        }
+    }
+    return eglCreateSyncKHR(mDisplay, EGL_SYNC_FENCE_KHR, NULL);
+}
+
+void egl_frame_timestamps_t::onSwapBuffers(EGLSyncKHR sync,
+        nsecs_t queueTime) {
+    uint32_t frame;
+    {
+        Mutex::Autolock _l(mLock);
+        frame = mFrameCount++;
+        frame_t& f(mFrames[frame % MAX_FRAMES]);
+        f.queueTime = queueTime;
+        f.completeTime = EGL_FRAME_PENDING_ANDROID;
+    }
+    if (sync == EGL_NO_SYNC_KHR) {
+        setCompleteTime(frame, -1);
+        return;
+    }
+
+    FrameTimestampThread::pending_t pending;
+    pending.owner = this;
+    pending.frame = frame;
+    pending.sync = sync;
+    pending.fenceFd = -1;
+
+    EGLint type = 0;
+    eglGetSyncAttribKHR(mDisplay, sync, EGL_SYNC_TYPE_KHR, &type);
+    if (type == EGL_SYNC_NATIVE_FENCE_ANDROID) {
+        // the native fence has been flushed by eglSwapBuffers, its fd is
+        // all the waiter needs
+        pending.fenceFd = eglDupNativeFenceFDANDROID(mDisplay, sync);
+        pending.sync = EGL_NO_SYNC_KHR;
+        eglDestroySyncKHR(mDisplay, sync);
+        if (pending.fenceFd == EGL_NO_NATIVE_FENCE_FD_ANDROID) {
+            setCompleteTime(frame, -1);
+            return;
+        }
+    }
+    FrameTimestampThread::queue(pending);
+}
+
+void egl_frame_timestamps_t::setCompleteTime(uint32_t frame, nsecs_t time) {
+    Mutex::Autolock _l(mLock);
+    if (mFrameCount - frame <= MAX_FRAMES) {
+        mFrames[frame % MAX_FRAMES].completeTime =
+                time < 0 ? EGL_FRAME_INVALID_ANDROID : time;
+    }
+}
+
+size_t egl_frame_timestamps_t::getTimestamps(size_t count,
+        EGLnsecsANDROID* queueTimes, EGLnsecsANDROID* completeTimes) const {
+    Mutex::Autolock _l(mLock);
+    const size_t available = mFrameCount < MAX_FRAMES ?
+            mFrameCount : size_t(MAX_FRAMES);
+    if (count > available) {
+        count = available;
+    }
+    const uint32_t first = mFrameCount - count;
+    for (size_t i=0 ; i<count ; i++) {
+        const frame_t& f(mFrames[(first + i) % MAX_FRAMES]);
+        if (queueTimes) {
+            queueTimes[i] = f.queueTime;
+        }
+        if (completeTimes) {
+            completeTimes[i] = f.completeTime;
+        }
+    }
+    return count;
+}
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+// ----------------------------------------------------------------------------
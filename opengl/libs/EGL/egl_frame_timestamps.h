@@ -0,0 +1,94 @@
+/*
+ ** Copyright 2013, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#ifndef ANDROID_EGL_FRAME_TIMESTAMPS_H
+#define ANDROID_EGL_FRAME_TIMESTAMPS_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <utils/Mutex.h>
+#include <utils/RefBase.h>
+#include <utils/Timers.h>
+
+// ----------------------------------------------------------------------------
+namespace android {
+// ----------------------------------------------------------------------------
+
+/*
+ * The queue and GPU completion times of the last frames swapped on one
+ * surface, for EGL_ANDROID_frame_completion_times.
+ *
+ * eglSwapBuffers calls onSwapBuffers with a fence sync object created just
+ * before the frame is handed to the driver. A single process-wide thread
+ * waits for these fences in order and records when each one signaled: the
+ * sync driver's timestamp for native fences, and the time the wait returned
+ * otherwise.
+ *
+ * The waiter thread holds a reference to the frames it waits for, so a
+ * surface can be destroyed with frames in flight.
+ */
+class egl_frame_timestamps_t : public LightRefBase<egl_frame_timestamps_t> {
+public:
+    enum {
+        // Frames getTimestamps can report.
+        MAX_FRAMES = 64,
+    };
+
+    egl_frame_timestamps_t(EGLDisplay dpy, bool nativeFenceSync);
+    ~egl_frame_timestamps_t();
+
+    // Creates the fence of the frame about to be swapped. Must be called
+    // with the frame's context current, before the driver's eglSwapBuffers.
+    EGLSyncKHR createFrameSync();
+
+    // Records a frame queued at queueTime. sync may be EGL_NO_SYNC_KHR, in
+    // which case the frame never completes. Must be called after the
+    // driver's eglSwapBuffers so that native fences are flushed.
+    void onSwapBuffers(EGLSyncKHR sync, nsecs_t queueTime);
+
+    // Copies the times of the last count frames at most, oldest first, and
+    // returns how many frames were copied. Frames still on the GPU have a
+    // completion time of EGL_FRAME_PENDING_ANDROID.
+    size_t getTimestamps(size_t count, EGLnsecsANDROID* queueTimes,
+            EGLnsecsANDROID* completeTimes) const;
+
+private:
+    friend class FrameTimestampThread;
+
+    struct frame_t {
+        nsecs_t queueTime;
+        nsecs_t completeTime;
+    };
+
+    void setCompleteTime(uint32_t frame, nsecs_t time);
+
+    const EGLDisplay mDisplay;
+    const bool mNativeFenceSync;
+
+    mutable Mutex mLock;
+    frame_t mFrames[MAX_FRAMES];
+    uint32_t mFrameCount;
+};
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+// ----------------------------------------------------------------------------
+
+#endif // ANDROID_EGL_FRAME_TIMESTAMPS_H
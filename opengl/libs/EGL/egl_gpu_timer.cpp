@@ -0,0 +1,194 @@
+/*
+ ** Copyright 2013, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#include <cutils/log.h>
+
+#include <utils/KeyedVector.h>
+#include <utils/Mutex.h>
+
+#include "egl_gpu_timer.h"
+#include "egldefs.h"
+
+// ----------------------------------------------------------------------------
+namespace android {
+// ----------------------------------------------------------------------------
+
+// Number of frames whose GPU time dump() lists.
+static const size_t FRAME_HISTORY = 128;
+
+struct program_stats_t {
+    uint32_t draws;
+    nsecs_t time;
+};
+
+static Mutex gStatsLock;
+static KeyedVector<GLuint, program_stats_t> gProgramStats;
+static nsecs_t gFrameTimes[FRAME_HISTORY];
+static uint32_t gFrameCount;
+static nsecs_t gFrameTotal;
+static nsecs_t gFrameMax;
+static uint32_t gDroppedDraws;
+
+// ----------------------------------------------------------------------------
+
+egl_gpu_timer_t* egl_gpu_timer_t::create(gl_hooks_t const* hooks,
+        int version, const String8& extensions) {
+    if (version == egl_connection_t::GLESv1_INDEX ||
+            extensions.find("GL_EXT_disjoint_timer_query") < 0) {
+        return NULL;
+    }
+    return new egl_gpu_timer_t(hooks);
+}
+
+egl_gpu_timer_t::egl_gpu_timer_t(gl_hooks_t const* hooks)
+    : mGl(&hooks->gl), mProgram(0), mAppQueryActive(false),
+      mHead(0), mTail(0), mFreeCount(MAX_PENDING_QUERIES),
+      mFrame(0), mCollectingFrame(0), mCollectingTime(0), mDropped(0) {
+    mGl->glGenQueriesEXT(MAX_PENDING_QUERIES, mFree);
+}
+
+egl_gpu_timer_t::~egl_gpu_timer_t() {
+    // The queries belong to the context, which is gone or about to be by the
+    // time its egl_context_t is destroyed.
+}
+
+bool egl_gpu_timer_t::beginDraw() {
+    if (mAppQueryActive) {
+        return false;
+    }
+    if (mFreeCount == 0) {
+        mDropped++;
+        return false;
+    }
+    const GLuint query = mFree[--mFreeCount];
+    pending_t& p = mPending[mTail % MAX_PENDING_QUERIES];
+    p.query = query;
+    p.program = mProgram;
+    p.frame = mFrame;
+    mTail++;
+    mGl->glBeginQueryEXT(GL_TIME_ELAPSED_EXT, query);
+    return true;
+}
+
+void egl_gpu_timer_t::endDraw() {
+    mGl->glEndQueryEXT(GL_TIME_ELAPSED_EXT);
+}
+
+void egl_gpu_timer_t::onSwapBuffers() {
+    GLint disjoint = 0;
+    mGl->glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    mFrame++;
+    if (disjoint) {
+        // None of the results in flight can be trusted; recycle their
+        // queries without reading them.
+        for (; mHead != mTail; mHead++) {
+            mFree[mFreeCount++] = mPending[mHead % MAX_PENDING_QUERIES].query;
+        }
+        mCollectingFrame = mFrame;
+        mCollectingTime = 0;
+        return;
+    }
+    collect();
+}
+
+void egl_gpu_timer_t::collect() {
+    Mutex::Autolock _l(gStatsLock);
+    while (mHead != mTail) {
+        const pending_t& p = mPending[mHead % MAX_PENDING_QUERIES];
+        GLuint available = 0;
+        mGl->glGetQueryObjectuivEXT(p.query, GL_QUERY_RESULT_AVAILABLE_EXT,
+                &available);
+        if (!available) {
+            // queries complete in order, so nothing after this one is
+            // ready either
+            break;
+        }
+        GLuint elapsed = 0;
+        mGl->glGetQueryObjectuivEXT(p.query, GL_QUERY_RESULT_EXT, &elapsed);
+        if (p.frame != mCollectingFrame) {
+            endFrame();
+            mCollectingFrame = p.frame;
+        }
+        mCollectingTime += elapsed;
+
+        ssize_t index = gProgramStats.indexOfKey(p.program);
+        if (index < 0) {
+            program_stats_t stats = { 0, 0 };
+            index = gProgramStats.add(p.program, stats);
+        }
+        program_stats_t& stats = gProgramStats.editValueAt(index);
+        stats.draws++;
+        stats.time += elapsed;
+
+        mFree[mFreeCount++] = p.query;
+        mHead++;
+    }
+    if (mHead == mTail && mCollectingFrame != mFrame) {
+        // every draw of the frame has been collected
+        endFrame();
+        mCollectingFrame = mFrame;
+    }
+    gDroppedDraws += mDropped;
+    mDropped = 0;
+}
+
+void egl_gpu_timer_t::endFrame() {
+    // gStatsLock is held
+    if (mCollectingTime == 0) {
+        return;
+    }
+    gFrameTimes[gFrameCount % FRAME_HISTORY] = mCollectingTime;
+    gFrameCount++;
+    gFrameTotal += mCollectingTime;
+    if (mCollectingTime > gFrameMax) {
+        gFrameMax = mCollectingTime;
+    }
+    mCollectingTime = 0;
+}
+
+void egl_gpu_timer_t::dump(String8& result) {
+    Mutex::Autolock _l(gStatsLock);
+    result.appendFormat("GPU time (GL_EXT_disjoint_timer_query): %u frames",
+            gFrameCount);
+    if (gFrameCount) {
+        result.appendFormat(", avg %.3f ms, max %.3f ms",
+                gFrameTotal / (gFrameCount * 1e6), gFrameMax / 1e6);
+    }
+    result.appendFormat(", %u draws not timed\n", gDroppedDraws);
+
+    const size_t frames = gFrameCount < FRAME_HISTORY ? gFrameCount : FRAME_HISTORY;
+    if (frames) {
+        result.append("  last frames (ms):");
+        for (size_t i = 0; i < frames; i++) {
+            const uint32_t frame = gFrameCount - frames + i;
+            result.appendFormat("%s %.3f", (i % 16) ? "" : "\n   ",
+                    gFrameTimes[frame % FRAME_HISTORY] / 1e6);
+        }
+        result.append("\n");
+    }
+
+    result.append("  program     draws    total ms     avg us\n");
+    for (size_t i = 0; i < gProgramStats.size(); i++) {
+        const program_stats_t& stats = gProgramStats.valueAt(i);
+        result.appendFormat("  %7u %9u %11.3f %10.2f\n",
+                gProgramStats.keyAt(i), stats.draws, stats.time / 1e6,
+                stats.time / (stats.draws * 1e3));
+    }
+}
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+// ----------------------------------------------------------------------------
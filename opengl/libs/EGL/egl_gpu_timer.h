@@ -0,0 +1,124 @@
+/*
+ ** Copyright 2013, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#ifndef ANDROID_EGL_GPU_TIMER_H
+#define ANDROID_EGL_GPU_TIMER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <GLES2/gl2.h>
+
+#include <utils/String8.h>
+#include <utils/Timers.h>
+
+#include "hooks.h"
+
+// GL_EXT_disjoint_timer_query
+#ifndef GL_QUERY_RESULT_EXT
+#define GL_QUERY_RESULT_EXT             0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE_EXT
+#define GL_QUERY_RESULT_AVAILABLE_EXT   0x8867
+#endif
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT             0x88BF
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT             0x8FBB
+#endif
+
+// ----------------------------------------------------------------------------
+namespace android {
+// ----------------------------------------------------------------------------
+
+/*
+ * Measures the GPU time of the draw calls of one context with
+ * GL_EXT_disjoint_timer_query.
+ *
+ * Enabled by setting debug.egl.trace to "gputime", which installs
+ * gHooksGpuTimer. Every glDraw* is bracketed by a GL_TIME_ELAPSED_EXT query;
+ * the results are collected without stalling at each eglSwapBuffers, and added
+ * up per frame and per shader program. Results spanning a disjoint event are
+ * thrown away.
+ *
+ * An egl_gpu_timer_t is only used by the thread its context is current on.
+ * The totals of all contexts are kept in the process-wide tables that dump()
+ * prints.
+ */
+class egl_gpu_timer_t {
+public:
+    // create returns NULL if the context can't do timer queries.
+    static egl_gpu_timer_t* create(gl_hooks_t const* hooks,
+            int version, const String8& extensions);
+    ~egl_gpu_timer_t();
+
+    void onUseProgram(GLuint program) { mProgram = program; }
+
+    // The application's own GL_TIME_ELAPSED_EXT queries can't overlap ours,
+    // so draws aren't timed while one is active.
+    void onBeginTimeElapsedQuery() { mAppQueryActive = true; }
+    void onEndTimeElapsedQuery() { mAppQueryActive = false; }
+
+    // beginDraw returns true if the draw is being timed, in which case
+    // endDraw must be called right after it.
+    bool beginDraw();
+    void endDraw();
+
+    // Ends the current frame and collects whatever results are ready.
+    void onSwapBuffers();
+
+    // Appends the process-wide totals to result.
+    static void dump(String8& result);
+
+private:
+    enum {
+        // Queries in flight; draws beyond this aren't timed.
+        MAX_PENDING_QUERIES = 512,
+    };
+
+    struct pending_t {
+        GLuint query;
+        GLuint program;
+        uint32_t frame;
+    };
+
+    egl_gpu_timer_t(gl_hooks_t const* hooks);
+
+    void collect();
+    void endFrame();
+
+    gl_hooks_t::gl_t const* mGl;
+    GLuint mProgram;
+    bool mAppQueryActive;
+
+    pending_t mPending[MAX_PENDING_QUERIES];
+    uint32_t mHead;             // next pending slot to collect
+    uint32_t mTail;             // next pending slot to fill
+    GLuint mFree[MAX_PENDING_QUERIES];
+    size_t mFreeCount;
+
+    uint32_t mFrame;            // frame the draws are currently issued for
+    uint32_t mCollectingFrame;  // frame the collected results belong to
+    nsecs_t mCollectingTime;
+    uint32_t mDropped;
+};
+
+// ----------------------------------------------------------------------------
+}; // namespace android
+// ----------------------------------------------------------------------------
+
+#endif // ANDROID_EGL_GPU_TIMER_H
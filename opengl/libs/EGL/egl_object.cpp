@@ -23,6 +23,7 @@
 
 #include <utils/threads.h>
 
+#include "egl_gpu_timer.h"
 #include "egl_object.h"
 
 // ----------------------------------------------------------------------------
@@ -49,10 +50,25 @@ void egl_object_t::terminate() {
 
 void egl_object_t::destroy() {
     if (decRef() == 1) {
-        delete this;
+        // getObject() may still be looking at our count, so the display
+        // frees the memory once it's done
+        egl_display_t* const disp = display;
+        this->~egl_object_t();
+        disp->retireObject(this);
     }
 }
 
+bool egl_object_t::tryIncRef() {
+    int32_t c;
+    do {
+        c = count;
+        if (c <= 0) {
+            return false;
+        }
+    } while (android_atomic_cmpxchg(c, c + 1, &count));
+    return true;
+}
+
 bool egl_object_t::get(egl_display_t const* display, egl_object_t* object) {
     // used by LocalRef, this does an incRef() atomically with
     // checking that the object is valid.
@@ -87,7 +103,12 @@ egl_surface_t::~egl_surface_t() {
 egl_context_t::egl_context_t(EGLDisplay dpy, EGLContext context, EGLConfig config,
         egl_connection_t const* cnx, int version) :
     egl_object_t(get_display_nowake(dpy)), dpy(dpy), context(context),
-            config(config), read(0), draw(0), cnx(cnx), version(version) {
+            config(config), read(0), draw(0), cnx(cnx), version(version),
+            gpuTimer(NULL) {
+}
+
+egl_context_t::~egl_context_t() {
+    delete gpuTimer;
 }
 
 void egl_context_t::onLooseCurrent() {
@@ -31,12 +31,14 @@
 #include <system/window.h>
 
 #include "egl_display.h"
+#include "egl_frame_timestamps.h"
 
 // ----------------------------------------------------------------------------
 namespace android {
 // ----------------------------------------------------------------------------
 
 struct egl_display_t;
+class egl_gpu_timer_t;
 
 class egl_object_t {
     egl_display_t *display;
@@ -51,6 +53,8 @@ public:
 
     inline int32_t incRef() { return android_atomic_inc(&count); }
     inline int32_t decRef() { return android_atomic_dec(&count); }
+    // adds a reference unless the last one is gone already
+    bool tryIncRef();
     inline egl_display_t* getDisplay() const { return display; }
 
 private:
@@ -137,11 +141,14 @@ public:
     EGLConfig config;
     sp<ANativeWindow> win;
     egl_connection_t const* cnx;
+    // set while EGL_FRAME_COMPLETION_TIMES_ANDROID is enabled, accessed
+    // with sFrameTimestampsLock held, see eglApi.cpp
+    sp<egl_frame_timestamps_t> frameTimestamps;
 };
 
 class egl_context_t: public egl_object_t {
 protected:
-    ~egl_context_t() {}
+    ~egl_context_t();
 public:
     typedef egl_object_t::LocalRef<egl_context_t, EGLContext> Ref;
 
@@ -159,6 +166,8 @@ public:
     egl_connection_t const* cnx;
     int version;
     String8 gl_extensions;
+    // set while debug.egl.trace is "gputime", see egl_gpu_timer.h
+    egl_gpu_timer_t* gpuTimer;
 };
 
 // ----------------------------------------------------------------------------
@@ -89,6 +89,29 @@ namespace android {
                 :                                                   \
             );
 
+    #elif defined(__i386__)
+
+        #define API_ENTRY(_api) __attribute__((noinline)) _api
+
+        #define CALL_GL_EXTENSION_API(_api, ...)                    \
+            register void** _fn asm("eax");                         \
+            asm volatile(                                           \
+                "mov   %%gs:0, %[fn]            \n"                 \
+                "mov   %P[tls](%[fn]), %[fn]    \n"                 \
+                "test  %[fn], %[fn]             \n"                 \
+                "je    1f                       \n"                 \
+                "mov   %P[api](%[fn]), %[fn]    \n"                 \
+                "test  %[fn], %[fn]             \n"                 \
+                "je    1f                       \n"                 \
+                "jmp   *%[fn]                   \n"                 \
+                "1:                             \n"                 \
+                : [fn] "=a"(_fn)                                    \
+                : [tls] "i"(TLS_SLOT_OPENGL_API*sizeof(void*)),     \
+                  [api] "i"(__builtin_offsetof(gl_hooks_t,          \
+                                          ext.extensions[_api]))    \
+                : "cc"                                              \
+            );
+
     #else
         #error Unsupported architecture
     #endif
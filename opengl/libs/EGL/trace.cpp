@@ -29,6 +29,8 @@
 
 #include <utils/CallStack.h>
 
+#include "egl_gpu_timer.h"
+#include "egl_object.h"
 #include "egl_tls.h"
 #include "hooks.h"
 
@@ -475,6 +477,115 @@ EGLAPI gl_hooks_t gHooksErrorTrace = {
 #undef TRACE_GL_VOID
 #undef TRACE_GL
 
+///////////////////////////////////////////////////////////////////////////
+// GPU timer
+///////////////////////////////////////////////////////////////////////////
+
+static inline egl_gpu_timer_t* getGpuTimer() {
+    egl_context_t* const c = get_context(egl_tls_t::getContext());
+    return c ? c->gpuTimer : NULL;
+}
+
+#define TRACE_GL_VOID(_api, _args, _argList, ...)                         \
+static void GpuTimer_ ## _api _args {                                     \
+    gl_hooks_t::gl_t const * const _c = &getGLTraceThreadSpecific()->gl;  \
+    _c->_api _argList;                                                    \
+}
+
+#define TRACE_GL(_type, _api, _args, _argList, ...)                       \
+static _type GpuTimer_ ## _api _args {                                    \
+    gl_hooks_t::gl_t const * const _c = &getGLTraceThreadSpecific()->gl;  \
+    return _c->_api _argList;                                             \
+}
+
+extern "C" {
+#include "../trace.in"
+}
+
+#undef TRACE_GL_VOID
+#undef TRACE_GL
+
+#define GL_ENTRY(_r, _api, ...) GpuTimer_ ## _api,
+EGLAPI gl_hooks_t gHooksGpuTimer = {
+    {
+        #include "entries.in"
+    },
+    {
+        {0}
+    }
+};
+#undef GL_ENTRY
+
+// initGpuTimerHooks() replaces the pass-through entries of the draw calls with
+// ones bracketed by a timer query, and those of the calls the timer keeps
+// track of with ones that tell it about them.
+#define TIMED_DRAW(_api, _args, _argList)                                 \
+static void TimedDraw_ ## _api _args {                                    \
+    gl_hooks_t::gl_t const * const _c = &getGLTraceThreadSpecific()->gl;  \
+    egl_gpu_timer_t* const timer = getGpuTimer();                         \
+    const bool timed = timer && timer->beginDraw();                       \
+    _c->_api _argList;                                                    \
+    if (timed) {                                                          \
+        timer->endDraw();                                                 \
+    }                                                                     \
+}
+
+TIMED_DRAW(glDrawArrays,
+        (GLenum mode, GLint first, GLsizei count),
+        (mode, first, count))
+TIMED_DRAW(glDrawArraysInstanced,
+        (GLenum mode, GLint first, GLsizei count, GLsizei instanceCount),
+        (mode, first, count, instanceCount))
+TIMED_DRAW(glDrawElements,
+        (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices),
+        (mode, count, type, indices))
+TIMED_DRAW(glDrawElementsInstanced,
+        (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices,
+                GLsizei instanceCount),
+        (mode, count, type, indices, instanceCount))
+TIMED_DRAW(glDrawRangeElements,
+        (GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type,
+                const GLvoid* indices),
+        (mode, start, end, count, type, indices))
+
+#undef TIMED_DRAW
+
+static void TimedDraw_glUseProgram(GLuint program) {
+    getGLTraceThreadSpecific()->gl.glUseProgram(program);
+    egl_gpu_timer_t* const timer = getGpuTimer();
+    if (timer) {
+        timer->onUseProgram(program);
+    }
+}
+
+static void TimedDraw_glBeginQueryEXT(GLenum target, GLuint id) {
+    getGLTraceThreadSpecific()->gl.glBeginQueryEXT(target, id);
+    egl_gpu_timer_t* const timer = getGpuTimer();
+    if (timer && target == GL_TIME_ELAPSED_EXT) {
+        timer->onBeginTimeElapsedQuery();
+    }
+}
+
+static void TimedDraw_glEndQueryEXT(GLenum target) {
+    getGLTraceThreadSpecific()->gl.glEndQueryEXT(target);
+    egl_gpu_timer_t* const timer = getGpuTimer();
+    if (timer && target == GL_TIME_ELAPSED_EXT) {
+        timer->onEndTimeElapsedQuery();
+    }
+}
+
+void initGpuTimerHooks() {
+    gl_hooks_t::gl_t& gl = gHooksGpuTimer.gl;
+    gl.glDrawArrays = TimedDraw_glDrawArrays;
+    gl.glDrawArraysInstanced = TimedDraw_glDrawArraysInstanced;
+    gl.glDrawElements = TimedDraw_glDrawElements;
+    gl.glDrawElementsInstanced = TimedDraw_glDrawElementsInstanced;
+    gl.glDrawRangeElements = TimedDraw_glDrawRangeElements;
+    gl.glUseProgram = TimedDraw_glUseProgram;
+    gl.glBeginQueryEXT = TimedDraw_glBeginQueryEXT;
+    gl.glEndQueryEXT = TimedDraw_glEndQueryEXT;
+}
+
 // ----------------------------------------------------------------------------
 }; // namespace android
 // ----------------------------------------------------------------------------
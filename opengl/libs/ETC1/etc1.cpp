@@ -16,6 +16,17 @@
 
 #include <string.h>
 
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 /* From http://www.khronos.org/registry/gles/extensions/OES/OES_compressed_ETC1_RGB8_texture.txt
 
  The number of bits that represent a 4x4 texel block is 64 bits if
@@ -119,6 +130,9 @@ static const int kModifierTable[] = {
 
 static const int kLookup[8] = { 0, 1, 2, 3, -4, -3, -2, -1 };
 
+// Number of modifier tables tried per sub-block with ETC1_ENCODE_FAST.
+static const int kFastTableCount = 3;
+
 static inline etc1_byte clamp(int x) {
     return (etc1_byte) (x >= 0 ? (x < 255 ? x : 255) : 0);
 }
@@ -163,41 +177,39 @@ inline int convertDiff(int base, int diff) {
     return convert5To8((0x1f & base) + kLookup[0x7 & diff]);
 }
 
-static
-void decode_subblock(etc1_byte* pOut, int r, int g, int b, const int* table,
-        etc1_uint32 low, bool second, bool flipped) {
-    int baseX = 0;
-    int baseY = 0;
-    if (second) {
-        if (flipped) {
-            baseY = 2;
-        } else {
-            baseX = 2;
-        }
+// Packs a decoded color the way pixels of the given size are stored:
+// 2 is RGB565, 3 is R, G, B and 4 is R, G, B, A bytes, little endian.
+template<int PixelSize>
+static inline etc1_uint32 packColor(int r, int g, int b) {
+    switch (PixelSize) {
+    case 2:
+        return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    case 3:
+        return r | (g << 8) | (b << 16);
+    default:
+        return r | (g << 8) | (b << 16) | 0xff000000;
     }
-    for (int i = 0; i < 8; i++) {
-        int x, y;
-        if (flipped) {
-            x = baseX + (i >> 1);
-            y = baseY + (i & 1);
-        } else {
-            x = baseX + (i >> 2);
-            y = baseY + (i & 3);
-        }
-        int k = y + (x * 4);
-        int offset = ((low >> k) & 1) | ((low >> (k + 15)) & 2);
-        int delta = table[offset];
-        etc1_byte* q = pOut + 3 * (x + 4 * y);
-        *q++ = clamp(r + delta);
-        *q++ = clamp(g + delta);
-        *q++ = clamp(b + delta);
+}
+
+template<int PixelSize>
+static inline void storeColor(etc1_byte* p, etc1_uint32 color) {
+    p[0] = (etc1_byte) color;
+    p[1] = (etc1_byte) (color >> 8);
+    if (PixelSize > 2) {
+        p[2] = (etc1_byte) (color >> 16);
+    }
+    if (PixelSize > 3) {
+        p[3] = (etc1_byte) (color >> 24);
     }
 }
 
-// Input is an ETC1 compressed version of the data.
-// Output is a 4 x 4 square of 3-byte pixels in form R, G, B
+// Decodes a block into the top-left xEnd x yEnd pixels at pOut. Each
+// sub-block can only decode to four colors, so those are computed and
+// packed once and every pixel just picks one with its index bits.
 
-void etc1_decode_block(const etc1_byte* pIn, etc1_byte* pOut) {
+template<int PixelSize>
+static void decode_block(const etc1_byte* pIn, etc1_byte* pOut,
+        etc1_uint32 stride, etc1_uint32 xEnd, etc1_uint32 yEnd) {
     etc1_uint32 high = (pIn[0] << 24) | (pIn[1] << 16) | (pIn[2] << 8) | pIn[3];
     etc1_uint32 low = (pIn[4] << 24) | (pIn[5] << 16) | (pIn[6] << 8) | pIn[7];
     int r1, r2, g1, g2, b1, b2;
@@ -225,9 +237,31 @@ void etc1_decode_block(const etc1_byte* pIn, etc1_byte* pOut) {
     int tableIndexB = 7 & (high >> 2);
     const int* tableA = kModifierTable + tableIndexA * 4;
     const int* tableB = kModifierTable + tableIndexB * 4;
+    etc1_uint32 colors[2][4];
+    for (int i = 0; i < 4; i++) {
+        colors[0][i] = packColor<PixelSize>(clamp(r1 + tableA[i]),
+                clamp(g1 + tableA[i]), clamp(b1 + tableA[i]));
+        colors[1][i] = packColor<PixelSize>(clamp(r2 + tableB[i]),
+                clamp(g2 + tableB[i]), clamp(b2 + tableB[i]));
+    }
     bool flipped = (high & 1) != 0;
-    decode_subblock(pOut, r1, g1, b1, tableA, low, false, flipped);
-    decode_subblock(pOut, r2, g2, b2, tableB, low, true, flipped);
+    for (etc1_uint32 y = 0; y < yEnd; y++) {
+        etc1_byte* q = pOut + stride * y;
+        for (etc1_uint32 x = 0; x < xEnd; x++) {
+            int k = y + (x * 4);
+            int offset = ((low >> k) & 1) | ((low >> (k + 15)) & 2);
+            int second = flipped ? (y >> 1) : (x >> 1);
+            storeColor<PixelSize>(q, colors[second][offset]);
+            q += PixelSize;
+        }
+    }
+}
+
+// Input is an ETC1 compressed version of the data.
+// Output is a 4 x 4 square of 3-byte pixels in form R, G, B
+
+void etc1_decode_block(const etc1_byte* pIn, etc1_byte* pOut) {
+    decode_block<3>(pIn, pOut, 4 * 3, 4, 4);
 }
 
 typedef struct {
@@ -295,79 +329,188 @@ inline int square(int x) {
     return x * x;
 }
 
-static etc1_uint32 chooseModifier(const etc1_byte* pBaseColors,
-        const etc1_byte* pIn, etc1_uint32 *pLow, int bitIndex,
-        const int* pModifierTable) {
-    etc1_uint32 bestScore = ~0;
-    int bestIndex = 0;
-    int pixelR = pIn[0];
-    int pixelG = pIn[1];
-    int pixelB = pIn[2];
+// The pixels of one sub-block, one array per channel so that a modifier can
+// be scored against all of them at once.
+typedef struct {
+    short r[8];
+    short g[8];
+    short b[8];
+    int valid[8]; // ~0 if the pixel is in inMask, 0 if it is to be ignored
+    int bitIndex[8];
+} etc_subblock;
+
+static
+void etc_gather_subblock(const etc1_byte* pIn, etc1_uint32 inMask,
+        etc_subblock* pSubblock, bool flipped, bool second) {
+    for (int p = 0; p < 8; p++) {
+        int x, y;
+        if (flipped) {
+            x = p & 3;
+            y = (second ? 2 : 0) + (p >> 2);
+        } else {
+            x = (second ? 2 : 0) + (p & 1);
+            y = p >> 1;
+        }
+        int i = x + 4 * y;
+        const etc1_byte* q = pIn + i * 3;
+        pSubblock->r[p] = q[0];
+        pSubblock->g[p] = q[1];
+        pSubblock->b[p] = q[2];
+        pSubblock->valid[p] = (inMask & (1 << i)) ? ~0 : 0;
+        pSubblock->bitIndex[p] = y + x * 4;
+    }
+}
+
+// Picks the modifier whose decoded color is closest to each pixel, adds the
+// pixel indices to *pLow and returns the sum of the errors. Ties go to the
+// lower modifier index. The four modifiers are scored for all eight pixels
+// at once; the error of a pixel is at most 10 * 255 * 255, so it fits in
+// 32 bits, and each channel difference fits in 16.
+static etc1_uint32 etc_score_subblock(const etc_subblock* pSubblock,
+        const etc1_byte* pBaseColors, const int* pModifierTable,
+        etc1_uint32* pLow) {
     int r = pBaseColors[0];
     int g = pBaseColors[1];
     int b = pBaseColors[2];
+    int best[8];
+    int index[8];
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i pixelR = _mm_loadu_si128((const __m128i*) pSubblock->r);
+    const __m128i pixelG = _mm_loadu_si128((const __m128i*) pSubblock->g);
+    const __m128i pixelB = _mm_loadu_si128((const __m128i*) pSubblock->b);
+    const __m128i valid0 = _mm_loadu_si128((const __m128i*) pSubblock->valid);
+    const __m128i valid1 = _mm_loadu_si128((const __m128i*) (pSubblock->valid + 4));
+    __m128i best0 = zero, best1 = zero, index0 = zero, index1 = zero;
     for (int i = 0; i < 4; i++) {
         int modifier = pModifierTable[i];
-        int decodedG = clamp(g + modifier);
-        etc1_uint32 score = (etc1_uint32) (6 * square(decodedG - pixelG));
-        if (score >= bestScore) {
+        __m128i dr = _mm_sub_epi16(_mm_set1_epi16(clamp(r + modifier)), pixelR);
+        __m128i dg = _mm_sub_epi16(_mm_set1_epi16(clamp(g + modifier)), pixelG);
+        __m128i db = _mm_sub_epi16(_mm_set1_epi16(clamp(b + modifier)), pixelB);
+        __m128i dr3 = _mm_mullo_epi16(dr, _mm_set1_epi16(3));
+        __m128i dg6 = _mm_mullo_epi16(dg, _mm_set1_epi16(6));
+        // madd sums the products of neighboring 16-bit lanes into 32 bits:
+        // interleaving (dr, dg) with (3 dr, 6 dg) gives 3 dr^2 + 6 dg^2.
+        __m128i e0 = _mm_add_epi32(
+                _mm_madd_epi16(_mm_unpacklo_epi16(dr, dg), _mm_unpacklo_epi16(dr3, dg6)),
+                _mm_madd_epi16(_mm_unpacklo_epi16(db, zero), _mm_unpacklo_epi16(db, zero)));
+        __m128i e1 = _mm_add_epi32(
+                _mm_madd_epi16(_mm_unpackhi_epi16(dr, dg), _mm_unpackhi_epi16(dr3, dg6)),
+                _mm_madd_epi16(_mm_unpackhi_epi16(db, zero), _mm_unpackhi_epi16(db, zero)));
+        e0 = _mm_and_si128(e0, valid0);
+        e1 = _mm_and_si128(e1, valid1);
+        if (i == 0) {
+            best0 = e0;
+            best1 = e1;
             continue;
         }
-        int decodedR = clamp(r + modifier);
-        score += (etc1_uint32) (3 * square(decodedR - pixelR));
-        if (score >= bestScore) {
+        const __m128i n = _mm_set1_epi32(i);
+        __m128i lt0 = _mm_cmplt_epi32(e0, best0);
+        __m128i lt1 = _mm_cmplt_epi32(e1, best1);
+        best0 = _mm_or_si128(_mm_and_si128(lt0, e0), _mm_andnot_si128(lt0, best0));
+        best1 = _mm_or_si128(_mm_and_si128(lt1, e1), _mm_andnot_si128(lt1, best1));
+        index0 = _mm_or_si128(_mm_and_si128(lt0, n), _mm_andnot_si128(lt0, index0));
+        index1 = _mm_or_si128(_mm_and_si128(lt1, n), _mm_andnot_si128(lt1, index1));
+    }
+    _mm_storeu_si128((__m128i*) best, best0);
+    _mm_storeu_si128((__m128i*) (best + 4), best1);
+    _mm_storeu_si128((__m128i*) index, index0);
+    _mm_storeu_si128((__m128i*) (index + 4), index1);
+#elif defined(__ARM_NEON__)
+    const int16x8_t pixelR = vld1q_s16(pSubblock->r);
+    const int16x8_t pixelG = vld1q_s16(pSubblock->g);
+    const int16x8_t pixelB = vld1q_s16(pSubblock->b);
+    const int32x4_t valid0 = vld1q_s32(pSubblock->valid);
+    const int32x4_t valid1 = vld1q_s32(pSubblock->valid + 4);
+    int32x4_t best0 = vdupq_n_s32(0), best1 = best0, index0 = best0, index1 = best0;
+    for (int i = 0; i < 4; i++) {
+        int modifier = pModifierTable[i];
+        int16x8_t dr = vsubq_s16(vdupq_n_s16(clamp(r + modifier)), pixelR);
+        int16x8_t dg = vsubq_s16(vdupq_n_s16(clamp(g + modifier)), pixelG);
+        int16x8_t db = vsubq_s16(vdupq_n_s16(clamp(b + modifier)), pixelB);
+        int16x8_t dr3 = vmulq_n_s16(dr, 3);
+        int16x8_t dg6 = vmulq_n_s16(dg, 6);
+        int32x4_t e0 = vmull_s16(vget_low_s16(dr), vget_low_s16(dr3));
+        e0 = vmlal_s16(e0, vget_low_s16(dg), vget_low_s16(dg6));
+        e0 = vmlal_s16(e0, vget_low_s16(db), vget_low_s16(db));
+        int32x4_t e1 = vmull_s16(vget_high_s16(dr), vget_high_s16(dr3));
+        e1 = vmlal_s16(e1, vget_high_s16(dg), vget_high_s16(dg6));
+        e1 = vmlal_s16(e1, vget_high_s16(db), vget_high_s16(db));
+        e0 = vandq_s32(e0, valid0);
+        e1 = vandq_s32(e1, valid1);
+        if (i == 0) {
+            best0 = e0;
+            best1 = e1;
             continue;
         }
+        const int32x4_t n = vdupq_n_s32(i);
+        uint32x4_t lt0 = vcltq_s32(e0, best0);
+        uint32x4_t lt1 = vcltq_s32(e1, best1);
+        best0 = vbslq_s32(lt0, e0, best0);
+        best1 = vbslq_s32(lt1, e1, best1);
+        index0 = vbslq_s32(lt0, n, index0);
+        index1 = vbslq_s32(lt1, n, index1);
+    }
+    vst1q_s32(best, best0);
+    vst1q_s32(best + 4, best1);
+    vst1q_s32(index, index0);
+    vst1q_s32(index + 4, index1);
+#else
+    for (int i = 0; i < 4; i++) {
+        int modifier = pModifierTable[i];
+        int decodedR = clamp(r + modifier);
+        int decodedG = clamp(g + modifier);
         int decodedB = clamp(b + modifier);
-        score += (etc1_uint32) square(decodedB - pixelB);
-        if (score < bestScore) {
-            bestScore = score;
-            bestIndex = i;
+        for (int p = 0; p < 8; p++) {
+            int e = (3 * square(decodedR - pSubblock->r[p])
+                    + 6 * square(decodedG - pSubblock->g[p])
+                    + square(decodedB - pSubblock->b[p])) & pSubblock->valid[p];
+            if (i == 0 || e < best[p]) {
+                best[p] = e;
+                index[p] = i;
+            }
         }
     }
-    etc1_uint32 lowMask = (((bestIndex >> 1) << 16) | (bestIndex & 1))
-            << bitIndex;
-    *pLow |= lowMask;
-    return bestScore;
+#endif
+    etc1_uint32 score = 0;
+    etc1_uint32 low = 0;
+    for (int p = 0; p < 8; p++) {
+        // ignored pixels score 0 with index 0, so they add nothing
+        score += best[p];
+        low |= (((index[p] >> 1) << 16) | (index[p] & 1)) << pSubblock->bitIndex[p];
+    }
+    *pLow |= low;
+    return score;
 }
 
-static
-void etc_encode_subblock_helper(const etc1_byte* pIn, etc1_uint32 inMask,
-        etc_compressed* pCompressed, bool flipped, bool second,
-        const etc1_byte* pBaseColors, const int* pModifierTable) {
-    int score = pCompressed->score;
-    if (flipped) {
-        int by = 0;
-        if (second) {
-            by = 2;
-        }
-        for (int y = 0; y < 2; y++) {
-            int yy = by + y;
-            for (int x = 0; x < 4; x++) {
-                int i = x + 4 * yy;
-                if (inMask & (1 << i)) {
-                    score += chooseModifier(pBaseColors, pIn + i * 3,
-                            &pCompressed->low, yy + x * 4, pModifierTable);
-                }
-            }
-        }
-    } else {
-        int bx = 0;
-        if (second) {
-            bx = 2;
-        }
-        for (int y = 0; y < 4; y++) {
-            for (int x = 0; x < 2; x++) {
-                int xx = bx + x;
-                int i = xx + 4 * y;
-                if (inMask & (1 << i)) {
-                    score += chooseModifier(pBaseColors, pIn + i * 3,
-                            &pCompressed->low, y + xx * 4, pModifierTable);
-                }
-            }
+// Returns the first modifier table to try for a sub-block with
+// ETC1_ENCODE_FAST. The tables that fit best are the ones whose large
+// modifier is about as big as the largest deviation of a pixel's
+// brightness from the base color, so only those are tried.
+static int etc_fast_first_table(const etc_subblock* pSubblock,
+        const etc1_byte* pBaseColors) {
+    int spread = 0;
+    for (int p = 0; p < 8; p++) {
+        int d = 3 * (pSubblock->r[p] - pBaseColors[0])
+                + 6 * (pSubblock->g[p] - pBaseColors[1])
+                + (pSubblock->b[p] - pBaseColors[2]);
+        d = (d < 0 ? -d : d) & pSubblock->valid[p];
+        if (d > spread) {
+            spread = d;
         }
     }
-    pCompressed->score = score;
+    spread = (spread + 5) / 10;
+    int table = 0;
+    while (table < 7 && kModifierTable[table * 4 + 1] < spread) {
+        table++;
+    }
+    table -= kFastTableCount / 2;
+    if (table < 0) {
+        table = 0;
+    } else if (table > 8 - kFastTableCount) {
+        table = 8 - kFastTableCount;
+    }
+    return table;
 }
 
 static bool inRange4bitSigned(int color) {
@@ -431,7 +574,8 @@ static void etc_encodeBaseColors(etc1_byte* pBaseColors,
 
 static
 void etc_encode_block_helper(const etc1_byte* pIn, etc1_uint32 inMask,
-        const etc1_byte* pColors, etc_compressed* pCompressed, bool flipped) {
+        const etc1_byte* pColors, etc_compressed* pCompressed, bool flipped,
+        etc1_uint32 effort) {
     pCompressed->score = ~0;
     pCompressed->high = (flipped ? 1 : 0);
     pCompressed->low = 0;
@@ -442,26 +586,36 @@ void etc_encode_block_helper(const etc1_byte* pIn, etc1_uint32 inMask,
 
     int originalHigh = pCompressed->high;
 
-    const int* pModifierTable = kModifierTable;
-    for (int i = 0; i < 8; i++, pModifierTable += 4) {
+    etc_subblock subblock;
+    etc_gather_subblock(pIn, inMask, &subblock, flipped, false);
+    int first = 0;
+    int end = 8;
+    if (effort == ETC1_ENCODE_FAST) {
+        first = etc_fast_first_table(&subblock, pBaseColors);
+        end = first + kFastTableCount;
+    }
+    for (int i = first; i < end; i++) {
         etc_compressed temp;
-        temp.score = 0;
         temp.high = originalHigh | (i << 5);
         temp.low = 0;
-        etc_encode_subblock_helper(pIn, inMask, &temp, flipped, false,
-                pBaseColors, pModifierTable);
+        temp.score = etc_score_subblock(&subblock, pBaseColors,
+                kModifierTable + i * 4, &temp.low);
         take_best(pCompressed, &temp);
     }
-    pModifierTable = kModifierTable;
     etc_compressed firstHalf = *pCompressed;
-    for (int i = 0; i < 8; i++, pModifierTable += 4) {
+    etc_gather_subblock(pIn, inMask, &subblock, flipped, true);
+    if (effort == ETC1_ENCODE_FAST) {
+        first = etc_fast_first_table(&subblock, pBaseColors + 3);
+        end = first + kFastTableCount;
+    }
+    for (int i = first; i < end; i++) {
         etc_compressed temp;
         temp.score = firstHalf.score;
         temp.high = firstHalf.high | (i << 2);
         temp.low = firstHalf.low;
-        etc_encode_subblock_helper(pIn, inMask, &temp, flipped, true,
-                pBaseColors + 3, pModifierTable);
-        if (i == 0) {
+        temp.score += etc_score_subblock(&subblock, pBaseColors + 3,
+                kModifierTable + i * 4, &temp.low);
+        if (i == first) {
             *pCompressed = temp;
         } else {
             take_best(pCompressed, &temp);
@@ -476,13 +630,9 @@ static void writeBigEndian(etc1_byte* pOut, etc1_uint32 d) {
     pOut[3] = (etc1_byte) d;
 }
 
-// Input is a 4 x 4 square of 3-byte pixels in form R, G, B
-// inmask is a 16-bit mask where bit (1 << (x + y * 4)) tells whether the corresponding (x,y)
-// pixel is valid or not. Invalid pixel color values are ignored when compressing.
-// Output is an ETC1 compressed version of the data.
-
-void etc1_encode_block(const etc1_byte* pIn, etc1_uint32 inMask,
-        etc1_byte* pOut) {
+static
+void etc_encode_block(const etc1_byte* pIn, etc1_uint32 inMask,
+        etc1_byte* pOut, etc1_uint32 effort) {
     etc1_byte colors[6];
     etc1_byte flippedColors[6];
     etc_average_colors_subblock(pIn, inMask, colors, false, false);
@@ -491,39 +641,72 @@ void etc1_encode_block(const etc1_byte* pIn, etc1_uint32 inMask,
     etc_average_colors_subblock(pIn, inMask, flippedColors + 3, true, true);
 
     etc_compressed a, b;
-    etc_encode_block_helper(pIn, inMask, colors, &a, false);
-    etc_encode_block_helper(pIn, inMask, flippedColors, &b, true);
+    etc_encode_block_helper(pIn, inMask, colors, &a, false, effort);
+    etc_encode_block_helper(pIn, inMask, flippedColors, &b, true, effort);
     take_best(&a, &b);
     writeBigEndian(pOut, a.high);
     writeBigEndian(pOut + 4, a.low);
 }
 
+// Input is a 4 x 4 square of 3-byte pixels in form R, G, B
+// inmask is a 16-bit mask where bit (1 << (x + y * 4)) tells whether the corresponding (x,y)
+// pixel is valid or not. Invalid pixel color values are ignored when compressing.
+// Output is an ETC1 compressed version of the data.
+
+void etc1_encode_block(const etc1_byte* pIn, etc1_uint32 inMask,
+        etc1_byte* pOut) {
+    etc_encode_block(pIn, inMask, pOut, ETC1_ENCODE_EXHAUSTIVE);
+}
+
 // Return the size of the encoded image data (does not include size of PKM header).
 
 etc1_uint32 etc1_get_encoded_data_size(etc1_uint32 width, etc1_uint32 height) {
     return (((width + 3) & ~3) * ((height + 3) & ~3)) >> 1;
 }
 
-// Encode an entire image.
-// pIn - pointer to the image data. Formatted such that the Red component of
-//       pixel (x,y) is at pIn + pixelSize * x + stride * y + redOffset;
-// pOut - pointer to encoded data. Must be large enough to store entire encoded image.
+// An image being encoded. Rows of blocks are independent of each other, so
+// the image is handed out to the encoding threads in bands of
+// kRowsPerBand block rows.
+typedef struct {
+    const etc1_byte* pIn;
+    etc1_uint32 width;
+    etc1_uint32 height;
+    etc1_uint32 pixelSize;
+    etc1_uint32 stride;
+    etc1_byte* pOut;
+    etc1_uint32 effort;
+    etc1_uint32 bandCount;
+    volatile etc1_uint32 nextBand;
+} etc_image_job;
 
-int etc1_encode_image(const etc1_byte* pIn, etc1_uint32 width, etc1_uint32 height,
-        etc1_uint32 pixelSize, etc1_uint32 stride, etc1_byte* pOut) {
-    if (pixelSize < 2 || pixelSize > 3) {
-        return -1;
-    }
+static const etc1_uint32 kRowsPerBand = 4;
+
+// Don't start threads for images smaller than this many pixels.
+static const etc1_uint32 kMinPixelsPerThread = 64 * 64;
+
+static const etc1_uint32 kMaxThreads = 16;
+
+static
+void etc_encode_rows(const etc_image_job* job, etc1_uint32 firstRow,
+        etc1_uint32 endRow) {
     static const unsigned short kYMask[] = { 0x0, 0xf, 0xff, 0xfff, 0xffff };
     static const unsigned short kXMask[] = { 0x0, 0x1111, 0x3333, 0x7777,
             0xffff };
     etc1_byte block[ETC1_DECODED_BLOCK_SIZE];
     etc1_byte encoded[ETC1_ENCODED_BLOCK_SIZE];
 
+    const etc1_uint32 width = job->width;
+    const etc1_uint32 height = job->height;
+    const etc1_uint32 pixelSize = job->pixelSize;
+    const etc1_uint32 stride = job->stride;
     etc1_uint32 encodedWidth = (width + 3) & ~3;
     etc1_uint32 encodedHeight = (height + 3) & ~3;
+    if (endRow * 4 > encodedHeight) {
+        endRow = encodedHeight / 4;
+    }
+    etc1_byte* pOut = job->pOut + firstRow * (encodedWidth / 4) * sizeof(encoded);
 
-    for (etc1_uint32 y = 0; y < encodedHeight; y += 4) {
+    for (etc1_uint32 y = firstRow * 4; y < endRow * 4; y += 4) {
         etc1_uint32 yEnd = height - y;
         if (yEnd > 4) {
             yEnd = 4;
@@ -537,7 +720,7 @@ int etc1_encode_image(const etc1_byte* pIn, etc1_uint32 width, etc1_uint32 heigh
             int mask = ymask & kXMask[xEnd];
             for (etc1_uint32 cy = 0; cy < yEnd; cy++) {
                 etc1_byte* q = block + (cy * 4) * 3;
-                const etc1_byte* p = pIn + pixelSize * x + stride * (y + cy);
+                const etc1_byte* p = job->pIn + pixelSize * x + stride * (y + cy);
                 if (pixelSize == 3) {
                     memcpy(q, p, xEnd * 3);
                 } else {
@@ -550,29 +733,97 @@ int etc1_encode_image(const etc1_byte* pIn, etc1_uint32 width, etc1_uint32 heigh
                     }
                 }
             }
-            etc1_encode_block(block, mask, encoded);
+            etc_encode_block(block, mask, encoded, job->effort);
             memcpy(pOut, encoded, sizeof(encoded));
             pOut += sizeof(encoded);
         }
     }
-    return 0;
 }
 
-// Decode an entire image.
-// pIn - pointer to encoded data.
-// pOut - pointer to the image data. Will be written such that the Red component of
-//       pixel (x,y) is at pIn + pixelSize * x + stride * y + redOffset. Must be
-//        large enough to store entire image.
+// Encodes bands until there are none left.
+static void* etc_encode_bands(void* arg) {
+    etc_image_job* job = (etc_image_job*) arg;
+    for (;;) {
+        etc1_uint32 band = __sync_fetch_and_add(&job->nextBand, 1);
+        if (band >= job->bandCount) {
+            break;
+        }
+        etc_encode_rows(job, band * kRowsPerBand, (band + 1) * kRowsPerBand);
+    }
+    return NULL;
+}
+
+// Encode an entire image.
+// pIn - pointer to the image data. Formatted such that the Red component of
+//       pixel (x,y) is at pIn + pixelSize * x + stride * y + redOffset;
+// pOut - pointer to encoded data. Must be large enough to store entire encoded image.
 
+int etc1_encode_image(const etc1_byte* pIn, etc1_uint32 width, etc1_uint32 height,
+        etc1_uint32 pixelSize, etc1_uint32 stride, etc1_byte* pOut) {
+    return etc1_encode_image_ex(pIn, width, height, pixelSize, stride, pOut,
+            ETC1_ENCODE_EXHAUSTIVE, 0);
+}
 
-int etc1_decode_image(const etc1_byte* pIn, etc1_byte* pOut,
-        etc1_uint32 width, etc1_uint32 height,
-        etc1_uint32 pixelSize, etc1_uint32 stride) {
+// Encode an entire image with the given effort, on up to threadCount threads
+// (0 picks one per CPU).
+
+int etc1_encode_image_ex(const etc1_byte* pIn, etc1_uint32 width, etc1_uint32 height,
+        etc1_uint32 pixelSize, etc1_uint32 stride, etc1_byte* pOut,
+        etc1_uint32 effort, etc1_uint32 threadCount) {
     if (pixelSize < 2 || pixelSize > 3) {
         return -1;
     }
-    etc1_byte block[ETC1_DECODED_BLOCK_SIZE];
+    if (effort != ETC1_ENCODE_EXHAUSTIVE && effort != ETC1_ENCODE_FAST) {
+        return -1;
+    }
+    etc_image_job job;
+    job.pIn = pIn;
+    job.width = width;
+    job.height = height;
+    job.pixelSize = pixelSize;
+    job.stride = stride;
+    job.pOut = pOut;
+    job.effort = effort;
+    job.bandCount = (((height + 3) / 4) + kRowsPerBand - 1) / kRowsPerBand;
+    job.nextBand = 0;
+
+#ifdef HAVE_PTHREADS
+    if (threadCount == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = cpus > 0 ? (etc1_uint32) cpus : 1;
+        etc1_uint32 maxThreads = (width * height) / kMinPixelsPerThread;
+        if (threadCount > maxThreads) {
+            threadCount = maxThreads;
+        }
+    }
+    if (threadCount > job.bandCount) {
+        threadCount = job.bandCount;
+    }
+    if (threadCount > kMaxThreads) {
+        threadCount = kMaxThreads;
+    }
+    // The calling thread is one of the encoding threads. If a thread can't be
+    // started the others just encode more bands.
+    pthread_t threads[kMaxThreads];
+    etc1_uint32 started = 0;
+    for (etc1_uint32 i = 1; i < threadCount; i++) {
+        if (pthread_create(&threads[started], NULL, etc_encode_bands, &job) == 0) {
+            started++;
+        }
+    }
+    etc_encode_bands(&job);
+    for (etc1_uint32 i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+#else
+    etc_encode_bands(&job);
+#endif
+    return 0;
+}
 
+template<int PixelSize>
+static void decode_image(const etc1_byte* pIn, etc1_byte* pOut,
+        etc1_uint32 width, etc1_uint32 height, etc1_uint32 stride) {
     etc1_uint32 encodedWidth = (width + 3) & ~3;
     etc1_uint32 encodedHeight = (height + 3) & ~3;
 
@@ -581,31 +832,41 @@ int etc1_decode_image(const etc1_byte* pIn, etc1_byte* pOut,
         if (yEnd > 4) {
             yEnd = 4;
         }
+        etc1_byte* p = pOut + stride * y;
         for (etc1_uint32 x = 0; x < encodedWidth; x += 4) {
             etc1_uint32 xEnd = width - x;
             if (xEnd > 4) {
                 xEnd = 4;
             }
-            etc1_decode_block(pIn, block);
+            decode_block<PixelSize>(pIn, p, stride, xEnd, yEnd);
             pIn += ETC1_ENCODED_BLOCK_SIZE;
-            for (etc1_uint32 cy = 0; cy < yEnd; cy++) {
-                const etc1_byte* q = block + (cy * 4) * 3;
-                etc1_byte* p = pOut + pixelSize * x + stride * (y + cy);
-                if (pixelSize == 3) {
-                    memcpy(p, q, xEnd * 3);
-                } else {
-                    for (etc1_uint32 cx = 0; cx < xEnd; cx++) {
-                        etc1_byte r = *q++;
-                        etc1_byte g = *q++;
-                        etc1_byte b = *q++;
-                        etc1_uint32 pixel = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
-                        *p++ = (etc1_byte) pixel;
-                        *p++ = (etc1_byte) (pixel >> 8);
-                    }
-                }
-            }
+            p += 4 * PixelSize;
         }
     }
+}
+
+// Decode an entire image.
+// pIn - pointer to encoded data.
+// pOut - pointer to the image data. Will be written such that the Red component of
+//       pixel (x,y) is at pIn + pixelSize * x + stride * y + redOffset. Must be
+//        large enough to store entire image.
+
+int etc1_decode_image(const etc1_byte* pIn, etc1_byte* pOut,
+        etc1_uint32 width, etc1_uint32 height,
+        etc1_uint32 pixelSize, etc1_uint32 stride) {
+    switch (pixelSize) {
+    case 2:
+        decode_image<2>(pIn, pOut, width, height, stride);
+        break;
+    case 3:
+        decode_image<3>(pIn, pOut, width, height, stride);
+        break;
+    case 4:
+        decode_image<4>(pIn, pOut, width, height, stride);
+        break;
+    default:
+        return -1;
+    }
     return 0;
 }
 
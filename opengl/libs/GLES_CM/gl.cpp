@@ -149,6 +149,28 @@ GL_API void GL_APIENTRY glWeightPointerOESBounds(GLint size, GLenum type,
             :                                                    \
             );
 
+  #elif defined(__i386__)
+
+    // bionic keeps the TLS area at %gs:0; with no frame set up (see
+    // Android.mk) the entry point can jump straight into the driver with the
+    // caller's arguments still in place on the stack.
+    #define API_ENTRY(_api) __attribute__((noinline)) _api
+
+    #define CALL_GL_API(_api, ...)                                  \
+        register void** _fn asm("eax");                             \
+        asm volatile(                                               \
+            "mov   %%gs:0, %[fn]            \n"                     \
+            "mov   %P[tls](%[fn]), %[fn]    \n"                     \
+            "test  %[fn], %[fn]             \n"                     \
+            "je    1f                       \n"                     \
+            "jmp   *%P[api](%[fn])          \n"                     \
+            "1:                             \n"                     \
+            : [fn] "=a"(_fn)                                        \
+            : [tls] "i"(TLS_SLOT_OPENGL_API*sizeof(void*)),         \
+              [api] "i"(__builtin_offsetof(gl_hooks_t, gl._api))    \
+            : "cc"                                                  \
+            );
+
   #else
     #error Unsupported architecture
   #endif
@@ -31,9 +31,15 @@ namespace gltrace {
 // Definitions for GL3 APIs
 
 void GLTrace_glActiveTexture(GLenum texture) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glActiveTexture, "glActiveTexture")) {
+        GLCallCounter counter(glContext, GLMessage::glActiveTexture, "glActiveTexture");
+        glContext->hooks->gl.glActiveTexture(texture);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glActiveTexture);
 
     // copy argument texture
@@ -59,9 +65,15 @@ void GLTrace_glActiveTexture(GLenum texture) {
 }
 
 void GLTrace_glAttachShader(GLuint program, GLuint shader) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glAttachShader, "glAttachShader")) {
+        GLCallCounter counter(glContext, GLMessage::glAttachShader, "glAttachShader");
+        glContext->hooks->gl.glAttachShader(program, shader);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glAttachShader);
 
     // copy argument program
@@ -93,9 +105,15 @@ void GLTrace_glAttachShader(GLuint program, GLuint shader) {
 }
 
 void GLTrace_glBindAttribLocation(GLuint program, GLuint index, const GLchar* name) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindAttribLocation, "glBindAttribLocation")) {
+        GLCallCounter counter(glContext, GLMessage::glBindAttribLocation, "glBindAttribLocation");
+        glContext->hooks->gl.glBindAttribLocation(program, index, name);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindAttribLocation);
 
     // copy argument program
@@ -134,9 +152,15 @@ void GLTrace_glBindAttribLocation(GLuint program, GLuint index, const GLchar* na
 }
 
 void GLTrace_glBindBuffer(GLenum target, GLuint buffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindBuffer, "glBindBuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glBindBuffer, "glBindBuffer");
+        glContext->hooks->gl.glBindBuffer(target, buffer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindBuffer);
 
     // copy argument target
@@ -168,9 +192,15 @@ void GLTrace_glBindBuffer(GLenum target, GLuint buffer) {
 }
 
 void GLTrace_glBindFramebuffer(GLenum target, GLuint framebuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindFramebuffer, "glBindFramebuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glBindFramebuffer, "glBindFramebuffer");
+        glContext->hooks->gl.glBindFramebuffer(target, framebuffer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindFramebuffer);
 
     // copy argument target
@@ -202,9 +232,15 @@ void GLTrace_glBindFramebuffer(GLenum target, GLuint framebuffer) {
 }
 
 void GLTrace_glBindRenderbuffer(GLenum target, GLuint renderbuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindRenderbuffer, "glBindRenderbuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glBindRenderbuffer, "glBindRenderbuffer");
+        glContext->hooks->gl.glBindRenderbuffer(target, renderbuffer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindRenderbuffer);
 
     // copy argument target
@@ -236,9 +272,15 @@ void GLTrace_glBindRenderbuffer(GLenum target, GLuint renderbuffer) {
 }
 
 void GLTrace_glBindTexture(GLenum target, GLuint texture) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindTexture, "glBindTexture")) {
+        GLCallCounter counter(glContext, GLMessage::glBindTexture, "glBindTexture");
+        glContext->hooks->gl.glBindTexture(target, texture);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindTexture);
 
     // copy argument target
@@ -270,9 +312,15 @@ void GLTrace_glBindTexture(GLenum target, GLuint texture) {
 }
 
 void GLTrace_glBlendColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlendColor, "glBlendColor")) {
+        GLCallCounter counter(glContext, GLMessage::glBlendColor, "glBlendColor");
+        glContext->hooks->gl.glBlendColor(red, green, blue, alpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlendColor);
 
     // copy argument red
@@ -316,9 +364,15 @@ void GLTrace_glBlendColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alph
 }
 
 void GLTrace_glBlendEquation(GLenum mode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlendEquation, "glBlendEquation")) {
+        GLCallCounter counter(glContext, GLMessage::glBlendEquation, "glBlendEquation");
+        glContext->hooks->gl.glBlendEquation(mode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlendEquation);
 
     // copy argument mode
@@ -344,9 +398,15 @@ void GLTrace_glBlendEquation(GLenum mode) {
 }
 
 void GLTrace_glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlendEquationSeparate, "glBlendEquationSeparate")) {
+        GLCallCounter counter(glContext, GLMessage::glBlendEquationSeparate, "glBlendEquationSeparate");
+        glContext->hooks->gl.glBlendEquationSeparate(modeRGB, modeAlpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlendEquationSeparate);
 
     // copy argument modeRGB
@@ -378,9 +438,15 @@ void GLTrace_glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha) {
 }
 
 void GLTrace_glBlendFunc(GLenum sfactor, GLenum dfactor) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlendFunc, "glBlendFunc")) {
+        GLCallCounter counter(glContext, GLMessage::glBlendFunc, "glBlendFunc");
+        glContext->hooks->gl.glBlendFunc(sfactor, dfactor);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlendFunc);
 
     // copy argument sfactor
@@ -412,9 +478,15 @@ void GLTrace_glBlendFunc(GLenum sfactor, GLenum dfactor) {
 }
 
 void GLTrace_glBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlendFuncSeparate, "glBlendFuncSeparate")) {
+        GLCallCounter counter(glContext, GLMessage::glBlendFuncSeparate, "glBlendFuncSeparate");
+        glContext->hooks->gl.glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlendFuncSeparate);
 
     // copy argument srcRGB
@@ -458,9 +530,16 @@ void GLTrace_glBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha,
 }
 
 void GLTrace_glBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
+    track_glBufferData(glContext, target, size, data);
+
+    if (!glContext->shouldTrace(GLMessage::glBufferData, "glBufferData")) {
+        GLCallCounter counter(glContext, GLMessage::glBufferData, "glBufferData");
+        glContext->hooks->gl.glBufferData(target, size, data, usage);
+        return;
+    }
 
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBufferData);
 
     // copy argument target
@@ -505,9 +584,16 @@ void GLTrace_glBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GL
 }
 
 void GLTrace_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
+    track_glBufferSubData(glContext, target, offset, size, data);
 
+    if (!glContext->shouldTrace(GLMessage::glBufferSubData, "glBufferSubData")) {
+        GLCallCounter counter(glContext, GLMessage::glBufferSubData, "glBufferSubData");
+        glContext->hooks->gl.glBufferSubData(target, offset, size, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBufferSubData);
 
     // copy argument target
@@ -552,9 +638,14 @@ void GLTrace_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, co
 }
 
 GLenum GLTrace_glCheckFramebufferStatus(GLenum target) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCheckFramebufferStatus, "glCheckFramebufferStatus")) {
+        GLCallCounter counter(glContext, GLMessage::glCheckFramebufferStatus, "glCheckFramebufferStatus");
+        return glContext->hooks->gl.glCheckFramebufferStatus(target);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCheckFramebufferStatus);
 
     // copy argument target
@@ -588,9 +679,15 @@ GLenum GLTrace_glCheckFramebufferStatus(GLenum target) {
 }
 
 void GLTrace_glClear(GLbitfield mask) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClear, "glClear")) {
+        GLCallCounter counter(glContext, GLMessage::glClear, "glClear");
+        glContext->hooks->gl.glClear(mask);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClear);
 
     // copy argument mask
@@ -616,9 +713,15 @@ void GLTrace_glClear(GLbitfield mask) {
 }
 
 void GLTrace_glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearColor, "glClearColor")) {
+        GLCallCounter counter(glContext, GLMessage::glClearColor, "glClearColor");
+        glContext->hooks->gl.glClearColor(red, green, blue, alpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearColor);
 
     // copy argument red
@@ -662,9 +765,15 @@ void GLTrace_glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alph
 }
 
 void GLTrace_glClearDepthf(GLfloat depth) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearDepthf, "glClearDepthf")) {
+        GLCallCounter counter(glContext, GLMessage::glClearDepthf, "glClearDepthf");
+        glContext->hooks->gl.glClearDepthf(depth);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearDepthf);
 
     // copy argument depth
@@ -690,9 +799,15 @@ void GLTrace_glClearDepthf(GLfloat depth) {
 }
 
 void GLTrace_glClearStencil(GLint s) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearStencil, "glClearStencil")) {
+        GLCallCounter counter(glContext, GLMessage::glClearStencil, "glClearStencil");
+        glContext->hooks->gl.glClearStencil(s);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearStencil);
 
     // copy argument s
@@ -718,9 +833,15 @@ void GLTrace_glClearStencil(GLint s) {
 }
 
 void GLTrace_glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glColorMask, "glColorMask")) {
+        GLCallCounter counter(glContext, GLMessage::glColorMask, "glColorMask");
+        glContext->hooks->gl.glColorMask(red, green, blue, alpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glColorMask);
 
     // copy argument red
@@ -764,9 +885,15 @@ void GLTrace_glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboole
 }
 
 void GLTrace_glCompileShader(GLuint shader) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCompileShader, "glCompileShader")) {
+        GLCallCounter counter(glContext, GLMessage::glCompileShader, "glCompileShader");
+        glContext->hooks->gl.glCompileShader(shader);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCompileShader);
 
     // copy argument shader
@@ -792,9 +919,15 @@ void GLTrace_glCompileShader(GLuint shader) {
 }
 
 void GLTrace_glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid* data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCompressedTexImage2D, "glCompressedTexImage2D")) {
+        GLCallCounter counter(glContext, GLMessage::glCompressedTexImage2D, "glCompressedTexImage2D");
+        glContext->hooks->gl.glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCompressedTexImage2D);
 
     // copy argument target
@@ -863,9 +996,15 @@ void GLTrace_glCompressedTexImage2D(GLenum target, GLint level, GLenum internalf
 }
 
 void GLTrace_glCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const GLvoid* data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCompressedTexSubImage2D, "glCompressedTexSubImage2D")) {
+        GLCallCounter counter(glContext, GLMessage::glCompressedTexSubImage2D, "glCompressedTexSubImage2D");
+        glContext->hooks->gl.glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCompressedTexSubImage2D);
 
     // copy argument target
@@ -940,9 +1079,15 @@ void GLTrace_glCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset
 }
 
 void GLTrace_glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCopyTexImage2D, "glCopyTexImage2D")) {
+        GLCallCounter counter(glContext, GLMessage::glCopyTexImage2D, "glCopyTexImage2D");
+        glContext->hooks->gl.glCopyTexImage2D(target, level, internalformat, x, y, width, height, border);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCopyTexImage2D);
 
     // copy argument target
@@ -1010,9 +1155,15 @@ void GLTrace_glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat,
 }
 
 void GLTrace_glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCopyTexSubImage2D, "glCopyTexSubImage2D")) {
+        GLCallCounter counter(glContext, GLMessage::glCopyTexSubImage2D, "glCopyTexSubImage2D");
+        glContext->hooks->gl.glCopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCopyTexSubImage2D);
 
     // copy argument target
@@ -1080,9 +1231,14 @@ void GLTrace_glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLin
 }
 
 GLuint GLTrace_glCreateProgram(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCreateProgram, "glCreateProgram")) {
+        GLCallCounter counter(glContext, GLMessage::glCreateProgram, "glCreateProgram");
+        return glContext->hooks->gl.glCreateProgram();
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCreateProgram);
 
     // call function
@@ -1110,9 +1266,14 @@ GLuint GLTrace_glCreateProgram(void) {
 }
 
 GLuint GLTrace_glCreateShader(GLenum type) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCreateShader, "glCreateShader")) {
+        GLCallCounter counter(glContext, GLMessage::glCreateShader, "glCreateShader");
+        return glContext->hooks->gl.glCreateShader(type);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCreateShader);
 
     // copy argument type
@@ -1146,9 +1307,15 @@ GLuint GLTrace_glCreateShader(GLenum type) {
 }
 
 void GLTrace_glCullFace(GLenum mode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCullFace, "glCullFace")) {
+        GLCallCounter counter(glContext, GLMessage::glCullFace, "glCullFace");
+        glContext->hooks->gl.glCullFace(mode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCullFace);
 
     // copy argument mode
@@ -1174,9 +1341,16 @@ void GLTrace_glCullFace(GLenum mode) {
 }
 
 void GLTrace_glDeleteBuffers(GLsizei n, const GLuint* buffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
+    track_glDeleteBuffers(glContext, n, buffers);
+
+    if (!glContext->shouldTrace(GLMessage::glDeleteBuffers, "glDeleteBuffers")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteBuffers, "glDeleteBuffers");
+        glContext->hooks->gl.glDeleteBuffers(n, buffers);
+        return;
+    }
 
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteBuffers);
 
     // copy argument n
@@ -1209,9 +1383,15 @@ void GLTrace_glDeleteBuffers(GLsizei n, const GLuint* buffers) {
 }
 
 void GLTrace_glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteFramebuffers, "glDeleteFramebuffers")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteFramebuffers, "glDeleteFramebuffers");
+        glContext->hooks->gl.glDeleteFramebuffers(n, framebuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteFramebuffers);
 
     // copy argument n
@@ -1244,9 +1424,15 @@ void GLTrace_glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
 }
 
 void GLTrace_glDeleteProgram(GLuint program) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteProgram, "glDeleteProgram")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteProgram, "glDeleteProgram");
+        glContext->hooks->gl.glDeleteProgram(program);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteProgram);
 
     // copy argument program
@@ -1272,9 +1458,15 @@ void GLTrace_glDeleteProgram(GLuint program) {
 }
 
 void GLTrace_glDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteRenderbuffers, "glDeleteRenderbuffers")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteRenderbuffers, "glDeleteRenderbuffers");
+        glContext->hooks->gl.glDeleteRenderbuffers(n, renderbuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteRenderbuffers);
 
     // copy argument n
@@ -1307,9 +1499,15 @@ void GLTrace_glDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
 }
 
 void GLTrace_glDeleteShader(GLuint shader) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteShader, "glDeleteShader")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteShader, "glDeleteShader");
+        glContext->hooks->gl.glDeleteShader(shader);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteShader);
 
     // copy argument shader
@@ -1335,9 +1533,15 @@ void GLTrace_glDeleteShader(GLuint shader) {
 }
 
 void GLTrace_glDeleteTextures(GLsizei n, const GLuint* textures) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteTextures, "glDeleteTextures")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteTextures, "glDeleteTextures");
+        glContext->hooks->gl.glDeleteTextures(n, textures);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteTextures);
 
     // copy argument n
@@ -1370,9 +1574,15 @@ void GLTrace_glDeleteTextures(GLsizei n, const GLuint* textures) {
 }
 
 void GLTrace_glDepthFunc(GLenum func) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDepthFunc, "glDepthFunc")) {
+        GLCallCounter counter(glContext, GLMessage::glDepthFunc, "glDepthFunc");
+        glContext->hooks->gl.glDepthFunc(func);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDepthFunc);
 
     // copy argument func
@@ -1398,9 +1608,15 @@ void GLTrace_glDepthFunc(GLenum func) {
 }
 
 void GLTrace_glDepthMask(GLboolean flag) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDepthMask, "glDepthMask")) {
+        GLCallCounter counter(glContext, GLMessage::glDepthMask, "glDepthMask");
+        glContext->hooks->gl.glDepthMask(flag);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDepthMask);
 
     // copy argument flag
@@ -1426,9 +1642,15 @@ void GLTrace_glDepthMask(GLboolean flag) {
 }
 
 void GLTrace_glDepthRangef(GLfloat n, GLfloat f) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDepthRangef, "glDepthRangef")) {
+        GLCallCounter counter(glContext, GLMessage::glDepthRangef, "glDepthRangef");
+        glContext->hooks->gl.glDepthRangef(n, f);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDepthRangef);
 
     // copy argument n
@@ -1460,9 +1682,15 @@ void GLTrace_glDepthRangef(GLfloat n, GLfloat f) {
 }
 
 void GLTrace_glDetachShader(GLuint program, GLuint shader) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDetachShader, "glDetachShader")) {
+        GLCallCounter counter(glContext, GLMessage::glDetachShader, "glDetachShader");
+        glContext->hooks->gl.glDetachShader(program, shader);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDetachShader);
 
     // copy argument program
@@ -1494,9 +1722,15 @@ void GLTrace_glDetachShader(GLuint program, GLuint shader) {
 }
 
 void GLTrace_glDisable(GLenum cap) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDisable, "glDisable")) {
+        GLCallCounter counter(glContext, GLMessage::glDisable, "glDisable");
+        glContext->hooks->gl.glDisable(cap);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDisable);
 
     // copy argument cap
@@ -1522,9 +1756,15 @@ void GLTrace_glDisable(GLenum cap) {
 }
 
 void GLTrace_glDisableVertexAttribArray(GLuint index) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDisableVertexAttribArray, "glDisableVertexAttribArray")) {
+        GLCallCounter counter(glContext, GLMessage::glDisableVertexAttribArray, "glDisableVertexAttribArray");
+        glContext->hooks->gl.glDisableVertexAttribArray(index);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDisableVertexAttribArray);
 
     // copy argument index
@@ -1550,9 +1790,15 @@ void GLTrace_glDisableVertexAttribArray(GLuint index) {
 }
 
 void GLTrace_glDrawArrays(GLenum mode, GLint first, GLsizei count) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawArrays, "glDrawArrays")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawArrays, "glDrawArrays");
+        glContext->hooks->gl.glDrawArrays(mode, first, count);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawArrays);
 
     // copy argument mode
@@ -1590,9 +1836,15 @@ void GLTrace_glDrawArrays(GLenum mode, GLint first, GLsizei count) {
 }
 
 void GLTrace_glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawElements, "glDrawElements")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawElements, "glDrawElements");
+        glContext->hooks->gl.glDrawElements(mode, count, type, indices);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawElements);
 
     // copy argument mode
@@ -1637,9 +1889,15 @@ void GLTrace_glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoi
 }
 
 void GLTrace_glEnable(GLenum cap) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEnable, "glEnable")) {
+        GLCallCounter counter(glContext, GLMessage::glEnable, "glEnable");
+        glContext->hooks->gl.glEnable(cap);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEnable);
 
     // copy argument cap
@@ -1665,9 +1923,15 @@ void GLTrace_glEnable(GLenum cap) {
 }
 
 void GLTrace_glEnableVertexAttribArray(GLuint index) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEnableVertexAttribArray, "glEnableVertexAttribArray")) {
+        GLCallCounter counter(glContext, GLMessage::glEnableVertexAttribArray, "glEnableVertexAttribArray");
+        glContext->hooks->gl.glEnableVertexAttribArray(index);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEnableVertexAttribArray);
 
     // copy argument index
@@ -1693,9 +1957,15 @@ void GLTrace_glEnableVertexAttribArray(GLuint index) {
 }
 
 void GLTrace_glFinish(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFinish, "glFinish")) {
+        GLCallCounter counter(glContext, GLMessage::glFinish, "glFinish");
+        glContext->hooks->gl.glFinish();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFinish);
 
     // call function
@@ -1715,9 +1985,15 @@ void GLTrace_glFinish(void) {
 }
 
 void GLTrace_glFlush(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFlush, "glFlush")) {
+        GLCallCounter counter(glContext, GLMessage::glFlush, "glFlush");
+        glContext->hooks->gl.glFlush();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFlush);
 
     // call function
@@ -1737,9 +2013,15 @@ void GLTrace_glFlush(void) {
 }
 
 void GLTrace_glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFramebufferRenderbuffer, "glFramebufferRenderbuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glFramebufferRenderbuffer, "glFramebufferRenderbuffer");
+        glContext->hooks->gl.glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFramebufferRenderbuffer);
 
     // copy argument target
@@ -1783,9 +2065,15 @@ void GLTrace_glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum
 }
 
 void GLTrace_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFramebufferTexture2D, "glFramebufferTexture2D")) {
+        GLCallCounter counter(glContext, GLMessage::glFramebufferTexture2D, "glFramebufferTexture2D");
+        glContext->hooks->gl.glFramebufferTexture2D(target, attachment, textarget, texture, level);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFramebufferTexture2D);
 
     // copy argument target
@@ -1835,9 +2123,15 @@ void GLTrace_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum tex
 }
 
 void GLTrace_glFrontFace(GLenum mode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFrontFace, "glFrontFace")) {
+        GLCallCounter counter(glContext, GLMessage::glFrontFace, "glFrontFace");
+        glContext->hooks->gl.glFrontFace(mode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFrontFace);
 
     // copy argument mode
@@ -1863,9 +2157,15 @@ void GLTrace_glFrontFace(GLenum mode) {
 }
 
 void GLTrace_glGenBuffers(GLsizei n, GLuint* buffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenBuffers, "glGenBuffers")) {
+        GLCallCounter counter(glContext, GLMessage::glGenBuffers, "glGenBuffers");
+        glContext->hooks->gl.glGenBuffers(n, buffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenBuffers);
 
     // copy argument n
@@ -1898,9 +2198,15 @@ void GLTrace_glGenBuffers(GLsizei n, GLuint* buffers) {
 }
 
 void GLTrace_glGenerateMipmap(GLenum target) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenerateMipmap, "glGenerateMipmap")) {
+        GLCallCounter counter(glContext, GLMessage::glGenerateMipmap, "glGenerateMipmap");
+        glContext->hooks->gl.glGenerateMipmap(target);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenerateMipmap);
 
     // copy argument target
@@ -1926,9 +2232,15 @@ void GLTrace_glGenerateMipmap(GLenum target) {
 }
 
 void GLTrace_glGenFramebuffers(GLsizei n, GLuint* framebuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenFramebuffers, "glGenFramebuffers")) {
+        GLCallCounter counter(glContext, GLMessage::glGenFramebuffers, "glGenFramebuffers");
+        glContext->hooks->gl.glGenFramebuffers(n, framebuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenFramebuffers);
 
     // copy argument n
@@ -1961,9 +2273,15 @@ void GLTrace_glGenFramebuffers(GLsizei n, GLuint* framebuffers) {
 }
 
 void GLTrace_glGenRenderbuffers(GLsizei n, GLuint* renderbuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenRenderbuffers, "glGenRenderbuffers")) {
+        GLCallCounter counter(glContext, GLMessage::glGenRenderbuffers, "glGenRenderbuffers");
+        glContext->hooks->gl.glGenRenderbuffers(n, renderbuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenRenderbuffers);
 
     // copy argument n
@@ -1996,9 +2314,15 @@ void GLTrace_glGenRenderbuffers(GLsizei n, GLuint* renderbuffers) {
 }
 
 void GLTrace_glGenTextures(GLsizei n, GLuint* textures) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenTextures, "glGenTextures")) {
+        GLCallCounter counter(glContext, GLMessage::glGenTextures, "glGenTextures");
+        glContext->hooks->gl.glGenTextures(n, textures);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenTextures);
 
     // copy argument n
@@ -2031,9 +2355,15 @@ void GLTrace_glGenTextures(GLsizei n, GLuint* textures) {
 }
 
 void GLTrace_glGetActiveAttrib(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetActiveAttrib, "glGetActiveAttrib")) {
+        GLCallCounter counter(glContext, GLMessage::glGetActiveAttrib, "glGetActiveAttrib");
+        glContext->hooks->gl.glGetActiveAttrib(program, index, bufsize, length, size, type, name);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetActiveAttrib);
 
     // copy argument program
@@ -2099,9 +2429,15 @@ void GLTrace_glGetActiveAttrib(GLuint program, GLuint index, GLsizei bufsize, GL
 }
 
 void GLTrace_glGetActiveUniform(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetActiveUniform, "glGetActiveUniform")) {
+        GLCallCounter counter(glContext, GLMessage::glGetActiveUniform, "glGetActiveUniform");
+        glContext->hooks->gl.glGetActiveUniform(program, index, bufsize, length, size, type, name);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetActiveUniform);
 
     // copy argument program
@@ -2167,9 +2503,15 @@ void GLTrace_glGetActiveUniform(GLuint program, GLuint index, GLsizei bufsize, G
 }
 
 void GLTrace_glGetAttachedShaders(GLuint program, GLsizei maxcount, GLsizei* count, GLuint* shaders) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetAttachedShaders, "glGetAttachedShaders")) {
+        GLCallCounter counter(glContext, GLMessage::glGetAttachedShaders, "glGetAttachedShaders");
+        glContext->hooks->gl.glGetAttachedShaders(program, maxcount, count, shaders);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetAttachedShaders);
 
     // copy argument program
@@ -2215,9 +2557,14 @@ void GLTrace_glGetAttachedShaders(GLuint program, GLsizei maxcount, GLsizei* cou
 }
 
 GLint GLTrace_glGetAttribLocation(GLuint program, const GLchar* name) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetAttribLocation, "glGetAttribLocation")) {
+        GLCallCounter counter(glContext, GLMessage::glGetAttribLocation, "glGetAttribLocation");
+        return glContext->hooks->gl.glGetAttribLocation(program, name);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetAttribLocation);
 
     // copy argument program
@@ -2258,9 +2605,15 @@ GLint GLTrace_glGetAttribLocation(GLuint program, const GLchar* name) {
 }
 
 void GLTrace_glGetBooleanv(GLenum pname, GLboolean* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetBooleanv, "glGetBooleanv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetBooleanv, "glGetBooleanv");
+        glContext->hooks->gl.glGetBooleanv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetBooleanv);
 
     // copy argument pname
@@ -2293,9 +2646,15 @@ void GLTrace_glGetBooleanv(GLenum pname, GLboolean* params) {
 }
 
 void GLTrace_glGetBufferParameteriv(GLenum target, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetBufferParameteriv, "glGetBufferParameteriv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetBufferParameteriv, "glGetBufferParameteriv");
+        glContext->hooks->gl.glGetBufferParameteriv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetBufferParameteriv);
 
     // copy argument target
@@ -2334,9 +2693,14 @@ void GLTrace_glGetBufferParameteriv(GLenum target, GLenum pname, GLint* params)
 }
 
 GLenum GLTrace_glGetError(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetError, "glGetError")) {
+        GLCallCounter counter(glContext, GLMessage::glGetError, "glGetError");
+        return glContext->hooks->gl.glGetError();
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetError);
 
     // call function
@@ -2364,9 +2728,15 @@ GLenum GLTrace_glGetError(void) {
 }
 
 void GLTrace_glGetFloatv(GLenum pname, GLfloat* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetFloatv, "glGetFloatv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetFloatv, "glGetFloatv");
+        glContext->hooks->gl.glGetFloatv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetFloatv);
 
     // copy argument pname
@@ -2399,9 +2769,15 @@ void GLTrace_glGetFloatv(GLenum pname, GLfloat* params) {
 }
 
 void GLTrace_glGetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetFramebufferAttachmentParameteriv, "glGetFramebufferAttachmentParameteriv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetFramebufferAttachmentParameteriv, "glGetFramebufferAttachmentParameteriv");
+        glContext->hooks->gl.glGetFramebufferAttachmentParameteriv(target, attachment, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetFramebufferAttachmentParameteriv);
 
     // copy argument target
@@ -2446,9 +2822,15 @@ void GLTrace_glGetFramebufferAttachmentParameteriv(GLenum target, GLenum attachm
 }
 
 void GLTrace_glGetIntegerv(GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetIntegerv, "glGetIntegerv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetIntegerv, "glGetIntegerv");
+        glContext->hooks->gl.glGetIntegerv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetIntegerv);
 
     // copy argument pname
@@ -2481,9 +2863,15 @@ void GLTrace_glGetIntegerv(GLenum pname, GLint* params) {
 }
 
 void GLTrace_glGetProgramiv(GLuint program, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetProgramiv, "glGetProgramiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetProgramiv, "glGetProgramiv");
+        glContext->hooks->gl.glGetProgramiv(program, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetProgramiv);
 
     // copy argument program
@@ -2522,9 +2910,15 @@ void GLTrace_glGetProgramiv(GLuint program, GLenum pname, GLint* params) {
 }
 
 void GLTrace_glGetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetProgramInfoLog, "glGetProgramInfoLog")) {
+        GLCallCounter counter(glContext, GLMessage::glGetProgramInfoLog, "glGetProgramInfoLog");
+        glContext->hooks->gl.glGetProgramInfoLog(program, bufsize, length, infolog);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetProgramInfoLog);
 
     // copy argument program
@@ -2570,9 +2964,15 @@ void GLTrace_glGetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* lengt
 }
 
 void GLTrace_glGetRenderbufferParameteriv(GLenum target, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetRenderbufferParameteriv, "glGetRenderbufferParameteriv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetRenderbufferParameteriv, "glGetRenderbufferParameteriv");
+        glContext->hooks->gl.glGetRenderbufferParameteriv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetRenderbufferParameteriv);
 
     // copy argument target
@@ -2611,9 +3011,15 @@ void GLTrace_glGetRenderbufferParameteriv(GLenum target, GLenum pname, GLint* pa
 }
 
 void GLTrace_glGetShaderiv(GLuint shader, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetShaderiv, "glGetShaderiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetShaderiv, "glGetShaderiv");
+        glContext->hooks->gl.glGetShaderiv(shader, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetShaderiv);
 
     // copy argument shader
@@ -2652,9 +3058,15 @@ void GLTrace_glGetShaderiv(GLuint shader, GLenum pname, GLint* params) {
 }
 
 void GLTrace_glGetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetShaderInfoLog, "glGetShaderInfoLog")) {
+        GLCallCounter counter(glContext, GLMessage::glGetShaderInfoLog, "glGetShaderInfoLog");
+        glContext->hooks->gl.glGetShaderInfoLog(shader, bufsize, length, infolog);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetShaderInfoLog);
 
     // copy argument shader
@@ -2700,9 +3112,15 @@ void GLTrace_glGetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length,
 }
 
 void GLTrace_glGetShaderPrecisionFormat(GLenum shadertype, GLenum precisiontype, GLint* range, GLint* precision) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetShaderPrecisionFormat, "glGetShaderPrecisionFormat")) {
+        GLCallCounter counter(glContext, GLMessage::glGetShaderPrecisionFormat, "glGetShaderPrecisionFormat");
+        glContext->hooks->gl.glGetShaderPrecisionFormat(shadertype, precisiontype, range, precision);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetShaderPrecisionFormat);
 
     // copy argument shadertype
@@ -2748,9 +3166,15 @@ void GLTrace_glGetShaderPrecisionFormat(GLenum shadertype, GLenum precisiontype,
 }
 
 void GLTrace_glGetShaderSource(GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* source) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetShaderSource, "glGetShaderSource")) {
+        GLCallCounter counter(glContext, GLMessage::glGetShaderSource, "glGetShaderSource");
+        glContext->hooks->gl.glGetShaderSource(shader, bufsize, length, source);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetShaderSource);
 
     // copy argument shader
@@ -2796,9 +3220,14 @@ void GLTrace_glGetShaderSource(GLuint shader, GLsizei bufsize, GLsizei* length,
 }
 
 const GLubyte* GLTrace_glGetString(GLenum name) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetString, "glGetString")) {
+        GLCallCounter counter(glContext, GLMessage::glGetString, "glGetString");
+        return glContext->hooks->gl.glGetString(name);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetString);
 
     // copy argument name
@@ -2833,9 +3262,15 @@ const GLubyte* GLTrace_glGetString(GLenum name) {
 }
 
 void GLTrace_glGetTexParameterfv(GLenum target, GLenum pname, GLfloat* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexParameterfv, "glGetTexParameterfv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexParameterfv, "glGetTexParameterfv");
+        glContext->hooks->gl.glGetTexParameterfv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexParameterfv);
 
     // copy argument target
@@ -2874,9 +3309,15 @@ void GLTrace_glGetTexParameterfv(GLenum target, GLenum pname, GLfloat* params) {
 }
 
 void GLTrace_glGetTexParameteriv(GLenum target, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexParameteriv, "glGetTexParameteriv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexParameteriv, "glGetTexParameteriv");
+        glContext->hooks->gl.glGetTexParameteriv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexParameteriv);
 
     // copy argument target
@@ -2915,9 +3356,15 @@ void GLTrace_glGetTexParameteriv(GLenum target, GLenum pname, GLint* params) {
 }
 
 void GLTrace_glGetUniformfv(GLuint program, GLint location, GLfloat* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetUniformfv, "glGetUniformfv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetUniformfv, "glGetUniformfv");
+        glContext->hooks->gl.glGetUniformfv(program, location, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetUniformfv);
 
     // copy argument program
@@ -2956,9 +3403,15 @@ void GLTrace_glGetUniformfv(GLuint program, GLint location, GLfloat* params) {
 }
 
 void GLTrace_glGetUniformiv(GLuint program, GLint location, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetUniformiv, "glGetUniformiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetUniformiv, "glGetUniformiv");
+        glContext->hooks->gl.glGetUniformiv(program, location, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetUniformiv);
 
     // copy argument program
@@ -2997,9 +3450,14 @@ void GLTrace_glGetUniformiv(GLuint program, GLint location, GLint* params) {
 }
 
 GLint GLTrace_glGetUniformLocation(GLuint program, const GLchar* name) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetUniformLocation, "glGetUniformLocation")) {
+        GLCallCounter counter(glContext, GLMessage::glGetUniformLocation, "glGetUniformLocation");
+        return glContext->hooks->gl.glGetUniformLocation(program, name);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetUniformLocation);
 
     // copy argument program
@@ -3040,9 +3498,15 @@ GLint GLTrace_glGetUniformLocation(GLuint program, const GLchar* name) {
 }
 
 void GLTrace_glGetVertexAttribfv(GLuint index, GLenum pname, GLfloat* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetVertexAttribfv, "glGetVertexAttribfv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetVertexAttribfv, "glGetVertexAttribfv");
+        glContext->hooks->gl.glGetVertexAttribfv(index, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetVertexAttribfv);
 
     // copy argument index
@@ -3081,9 +3545,15 @@ void GLTrace_glGetVertexAttribfv(GLuint index, GLenum pname, GLfloat* params) {
 }
 
 void GLTrace_glGetVertexAttribiv(GLuint index, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetVertexAttribiv, "glGetVertexAttribiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetVertexAttribiv, "glGetVertexAttribiv");
+        glContext->hooks->gl.glGetVertexAttribiv(index, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetVertexAttribiv);
 
     // copy argument index
@@ -3122,9 +3592,15 @@ void GLTrace_glGetVertexAttribiv(GLuint index, GLenum pname, GLint* params) {
 }
 
 void GLTrace_glGetVertexAttribPointerv(GLuint index, GLenum pname, GLvoid** pointer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetVertexAttribPointerv, "glGetVertexAttribPointerv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetVertexAttribPointerv, "glGetVertexAttribPointerv");
+        glContext->hooks->gl.glGetVertexAttribPointerv(index, pname, pointer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetVertexAttribPointerv);
 
     // copy argument index
@@ -3163,9 +3639,15 @@ void GLTrace_glGetVertexAttribPointerv(GLuint index, GLenum pname, GLvoid** poin
 }
 
 void GLTrace_glHint(GLenum target, GLenum mode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glHint, "glHint")) {
+        GLCallCounter counter(glContext, GLMessage::glHint, "glHint");
+        glContext->hooks->gl.glHint(target, mode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glHint);
 
     // copy argument target
@@ -3197,9 +3679,14 @@ void GLTrace_glHint(GLenum target, GLenum mode) {
 }
 
 GLboolean GLTrace_glIsBuffer(GLuint buffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsBuffer, "glIsBuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glIsBuffer, "glIsBuffer");
+        return glContext->hooks->gl.glIsBuffer(buffer);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsBuffer);
 
     // copy argument buffer
@@ -3233,9 +3720,14 @@ GLboolean GLTrace_glIsBuffer(GLuint buffer) {
 }
 
 GLboolean GLTrace_glIsEnabled(GLenum cap) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsEnabled, "glIsEnabled")) {
+        GLCallCounter counter(glContext, GLMessage::glIsEnabled, "glIsEnabled");
+        return glContext->hooks->gl.glIsEnabled(cap);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsEnabled);
 
     // copy argument cap
@@ -3269,9 +3761,14 @@ GLboolean GLTrace_glIsEnabled(GLenum cap) {
 }
 
 GLboolean GLTrace_glIsFramebuffer(GLuint framebuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsFramebuffer, "glIsFramebuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glIsFramebuffer, "glIsFramebuffer");
+        return glContext->hooks->gl.glIsFramebuffer(framebuffer);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsFramebuffer);
 
     // copy argument framebuffer
@@ -3305,9 +3802,14 @@ GLboolean GLTrace_glIsFramebuffer(GLuint framebuffer) {
 }
 
 GLboolean GLTrace_glIsProgram(GLuint program) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsProgram, "glIsProgram")) {
+        GLCallCounter counter(glContext, GLMessage::glIsProgram, "glIsProgram");
+        return glContext->hooks->gl.glIsProgram(program);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsProgram);
 
     // copy argument program
@@ -3341,9 +3843,14 @@ GLboolean GLTrace_glIsProgram(GLuint program) {
 }
 
 GLboolean GLTrace_glIsRenderbuffer(GLuint renderbuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsRenderbuffer, "glIsRenderbuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glIsRenderbuffer, "glIsRenderbuffer");
+        return glContext->hooks->gl.glIsRenderbuffer(renderbuffer);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsRenderbuffer);
 
     // copy argument renderbuffer
@@ -3377,9 +3884,14 @@ GLboolean GLTrace_glIsRenderbuffer(GLuint renderbuffer) {
 }
 
 GLboolean GLTrace_glIsShader(GLuint shader) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsShader, "glIsShader")) {
+        GLCallCounter counter(glContext, GLMessage::glIsShader, "glIsShader");
+        return glContext->hooks->gl.glIsShader(shader);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsShader);
 
     // copy argument shader
@@ -3413,9 +3925,14 @@ GLboolean GLTrace_glIsShader(GLuint shader) {
 }
 
 GLboolean GLTrace_glIsTexture(GLuint texture) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsTexture, "glIsTexture")) {
+        GLCallCounter counter(glContext, GLMessage::glIsTexture, "glIsTexture");
+        return glContext->hooks->gl.glIsTexture(texture);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsTexture);
 
     // copy argument texture
@@ -3449,9 +3966,15 @@ GLboolean GLTrace_glIsTexture(GLuint texture) {
 }
 
 void GLTrace_glLineWidth(GLfloat width) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLineWidth, "glLineWidth")) {
+        GLCallCounter counter(glContext, GLMessage::glLineWidth, "glLineWidth");
+        glContext->hooks->gl.glLineWidth(width);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLineWidth);
 
     // copy argument width
@@ -3477,9 +4000,15 @@ void GLTrace_glLineWidth(GLfloat width) {
 }
 
 void GLTrace_glLinkProgram(GLuint program) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLinkProgram, "glLinkProgram")) {
+        GLCallCounter counter(glContext, GLMessage::glLinkProgram, "glLinkProgram");
+        glContext->hooks->gl.glLinkProgram(program);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLinkProgram);
 
     // copy argument program
@@ -3505,9 +4034,15 @@ void GLTrace_glLinkProgram(GLuint program) {
 }
 
 void GLTrace_glPixelStorei(GLenum pname, GLint param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPixelStorei, "glPixelStorei")) {
+        GLCallCounter counter(glContext, GLMessage::glPixelStorei, "glPixelStorei");
+        glContext->hooks->gl.glPixelStorei(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPixelStorei);
 
     // copy argument pname
@@ -3539,9 +4074,15 @@ void GLTrace_glPixelStorei(GLenum pname, GLint param) {
 }
 
 void GLTrace_glPolygonOffset(GLfloat factor, GLfloat units) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPolygonOffset, "glPolygonOffset")) {
+        GLCallCounter counter(glContext, GLMessage::glPolygonOffset, "glPolygonOffset");
+        glContext->hooks->gl.glPolygonOffset(factor, units);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPolygonOffset);
 
     // copy argument factor
@@ -3573,9 +4114,15 @@ void GLTrace_glPolygonOffset(GLfloat factor, GLfloat units) {
 }
 
 void GLTrace_glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glReadPixels, "glReadPixels")) {
+        GLCallCounter counter(glContext, GLMessage::glReadPixels, "glReadPixels");
+        glContext->hooks->gl.glReadPixels(x, y, width, height, format, type, pixels);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glReadPixels);
 
     // copy argument x
@@ -3638,9 +4185,15 @@ void GLTrace_glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenu
 }
 
 void GLTrace_glReleaseShaderCompiler(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glReleaseShaderCompiler, "glReleaseShaderCompiler")) {
+        GLCallCounter counter(glContext, GLMessage::glReleaseShaderCompiler, "glReleaseShaderCompiler");
+        glContext->hooks->gl.glReleaseShaderCompiler();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glReleaseShaderCompiler);
 
     // call function
@@ -3660,9 +4213,15 @@ void GLTrace_glReleaseShaderCompiler(void) {
 }
 
 void GLTrace_glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRenderbufferStorage, "glRenderbufferStorage")) {
+        GLCallCounter counter(glContext, GLMessage::glRenderbufferStorage, "glRenderbufferStorage");
+        glContext->hooks->gl.glRenderbufferStorage(target, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRenderbufferStorage);
 
     // copy argument target
@@ -3706,9 +4265,15 @@ void GLTrace_glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei
 }
 
 void GLTrace_glSampleCoverage(GLfloat value, GLboolean invert) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glSampleCoverage, "glSampleCoverage")) {
+        GLCallCounter counter(glContext, GLMessage::glSampleCoverage, "glSampleCoverage");
+        glContext->hooks->gl.glSampleCoverage(value, invert);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glSampleCoverage);
 
     // copy argument value
@@ -3740,9 +4305,15 @@ void GLTrace_glSampleCoverage(GLfloat value, GLboolean invert) {
 }
 
 void GLTrace_glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glScissor, "glScissor")) {
+        GLCallCounter counter(glContext, GLMessage::glScissor, "glScissor");
+        glContext->hooks->gl.glScissor(x, y, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glScissor);
 
     // copy argument x
@@ -3786,9 +4357,15 @@ void GLTrace_glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
 }
 
 void GLTrace_glShaderBinary(GLsizei n, const GLuint* shaders, GLenum binaryformat, const GLvoid* binary, GLsizei length) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glShaderBinary, "glShaderBinary")) {
+        GLCallCounter counter(glContext, GLMessage::glShaderBinary, "glShaderBinary");
+        glContext->hooks->gl.glShaderBinary(n, shaders, binaryformat, binary, length);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glShaderBinary);
 
     // copy argument n
@@ -3840,9 +4417,15 @@ void GLTrace_glShaderBinary(GLsizei n, const GLuint* shaders, GLenum binaryforma
 }
 
 void GLTrace_glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glShaderSource, "glShaderSource")) {
+        GLCallCounter counter(glContext, GLMessage::glShaderSource, "glShaderSource");
+        glContext->hooks->gl.glShaderSource(shader, count, string, length);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glShaderSource);
 
     // copy argument shader
@@ -3888,9 +4471,15 @@ void GLTrace_glShaderSource(GLuint shader, GLsizei count, const GLchar* const* s
 }
 
 void GLTrace_glStencilFunc(GLenum func, GLint ref, GLuint mask) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glStencilFunc, "glStencilFunc")) {
+        GLCallCounter counter(glContext, GLMessage::glStencilFunc, "glStencilFunc");
+        glContext->hooks->gl.glStencilFunc(func, ref, mask);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glStencilFunc);
 
     // copy argument func
@@ -3928,9 +4517,15 @@ void GLTrace_glStencilFunc(GLenum func, GLint ref, GLuint mask) {
 }
 
 void GLTrace_glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glStencilFuncSeparate, "glStencilFuncSeparate")) {
+        GLCallCounter counter(glContext, GLMessage::glStencilFuncSeparate, "glStencilFuncSeparate");
+        glContext->hooks->gl.glStencilFuncSeparate(face, func, ref, mask);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glStencilFuncSeparate);
 
     // copy argument face
@@ -3974,9 +4569,15 @@ void GLTrace_glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint m
 }
 
 void GLTrace_glStencilMask(GLuint mask) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glStencilMask, "glStencilMask")) {
+        GLCallCounter counter(glContext, GLMessage::glStencilMask, "glStencilMask");
+        glContext->hooks->gl.glStencilMask(mask);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glStencilMask);
 
     // copy argument mask
@@ -4002,9 +4603,15 @@ void GLTrace_glStencilMask(GLuint mask) {
 }
 
 void GLTrace_glStencilMaskSeparate(GLenum face, GLuint mask) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glStencilMaskSeparate, "glStencilMaskSeparate")) {
+        GLCallCounter counter(glContext, GLMessage::glStencilMaskSeparate, "glStencilMaskSeparate");
+        glContext->hooks->gl.glStencilMaskSeparate(face, mask);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glStencilMaskSeparate);
 
     // copy argument face
@@ -4036,9 +4643,15 @@ void GLTrace_glStencilMaskSeparate(GLenum face, GLuint mask) {
 }
 
 void GLTrace_glStencilOp(GLenum fail, GLenum zfail, GLenum zpass) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glStencilOp, "glStencilOp")) {
+        GLCallCounter counter(glContext, GLMessage::glStencilOp, "glStencilOp");
+        glContext->hooks->gl.glStencilOp(fail, zfail, zpass);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glStencilOp);
 
     // copy argument fail
@@ -4076,9 +4689,15 @@ void GLTrace_glStencilOp(GLenum fail, GLenum zfail, GLenum zpass) {
 }
 
 void GLTrace_glStencilOpSeparate(GLenum face, GLenum fail, GLenum zfail, GLenum zpass) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glStencilOpSeparate, "glStencilOpSeparate")) {
+        GLCallCounter counter(glContext, GLMessage::glStencilOpSeparate, "glStencilOpSeparate");
+        glContext->hooks->gl.glStencilOpSeparate(face, fail, zfail, zpass);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glStencilOpSeparate);
 
     // copy argument face
@@ -4122,9 +4741,15 @@ void GLTrace_glStencilOpSeparate(GLenum face, GLenum fail, GLenum zfail, GLenum
 }
 
 void GLTrace_glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexImage2D, "glTexImage2D")) {
+        GLCallCounter counter(glContext, GLMessage::glTexImage2D, "glTexImage2D");
+        glContext->hooks->gl.glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexImage2D);
 
     // copy argument target
@@ -4199,9 +4824,15 @@ void GLTrace_glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsi
 }
 
 void GLTrace_glTexParameterf(GLenum target, GLenum pname, GLfloat param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexParameterf, "glTexParameterf")) {
+        GLCallCounter counter(glContext, GLMessage::glTexParameterf, "glTexParameterf");
+        glContext->hooks->gl.glTexParameterf(target, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexParameterf);
 
     // copy argument target
@@ -4239,9 +4870,15 @@ void GLTrace_glTexParameterf(GLenum target, GLenum pname, GLfloat param) {
 }
 
 void GLTrace_glTexParameterfv(GLenum target, GLenum pname, const GLfloat* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexParameterfv, "glTexParameterfv")) {
+        GLCallCounter counter(glContext, GLMessage::glTexParameterfv, "glTexParameterfv");
+        glContext->hooks->gl.glTexParameterfv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexParameterfv);
 
     // copy argument target
@@ -4280,9 +4917,15 @@ void GLTrace_glTexParameterfv(GLenum target, GLenum pname, const GLfloat* params
 }
 
 void GLTrace_glTexParameteri(GLenum target, GLenum pname, GLint param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexParameteri, "glTexParameteri")) {
+        GLCallCounter counter(glContext, GLMessage::glTexParameteri, "glTexParameteri");
+        glContext->hooks->gl.glTexParameteri(target, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexParameteri);
 
     // copy argument target
@@ -4320,9 +4963,15 @@ void GLTrace_glTexParameteri(GLenum target, GLenum pname, GLint param) {
 }
 
 void GLTrace_glTexParameteriv(GLenum target, GLenum pname, const GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexParameteriv, "glTexParameteriv")) {
+        GLCallCounter counter(glContext, GLMessage::glTexParameteriv, "glTexParameteriv");
+        glContext->hooks->gl.glTexParameteriv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexParameteriv);
 
     // copy argument target
@@ -4361,9 +5010,15 @@ void GLTrace_glTexParameteriv(GLenum target, GLenum pname, const GLint* params)
 }
 
 void GLTrace_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexSubImage2D, "glTexSubImage2D")) {
+        GLCallCounter counter(glContext, GLMessage::glTexSubImage2D, "glTexSubImage2D");
+        glContext->hooks->gl.glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexSubImage2D);
 
     // copy argument target
@@ -4438,9 +5093,15 @@ void GLTrace_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yo
 }
 
 void GLTrace_glUniform1f(GLint location, GLfloat x) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform1f, "glUniform1f")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform1f, "glUniform1f");
+        glContext->hooks->gl.glUniform1f(location, x);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform1f);
 
     // copy argument location
@@ -4472,9 +5133,15 @@ void GLTrace_glUniform1f(GLint location, GLfloat x) {
 }
 
 void GLTrace_glUniform1fv(GLint location, GLsizei count, const GLfloat* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform1fv, "glUniform1fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform1fv, "glUniform1fv");
+        glContext->hooks->gl.glUniform1fv(location, count, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform1fv);
 
     // copy argument location
@@ -4513,9 +5180,15 @@ void GLTrace_glUniform1fv(GLint location, GLsizei count, const GLfloat* v) {
 }
 
 void GLTrace_glUniform1i(GLint location, GLint x) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform1i, "glUniform1i")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform1i, "glUniform1i");
+        glContext->hooks->gl.glUniform1i(location, x);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform1i);
 
     // copy argument location
@@ -4547,9 +5220,15 @@ void GLTrace_glUniform1i(GLint location, GLint x) {
 }
 
 void GLTrace_glUniform1iv(GLint location, GLsizei count, const GLint* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform1iv, "glUniform1iv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform1iv, "glUniform1iv");
+        glContext->hooks->gl.glUniform1iv(location, count, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform1iv);
 
     // copy argument location
@@ -4588,9 +5267,15 @@ void GLTrace_glUniform1iv(GLint location, GLsizei count, const GLint* v) {
 }
 
 void GLTrace_glUniform2f(GLint location, GLfloat x, GLfloat y) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform2f, "glUniform2f")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform2f, "glUniform2f");
+        glContext->hooks->gl.glUniform2f(location, x, y);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform2f);
 
     // copy argument location
@@ -4628,9 +5313,15 @@ void GLTrace_glUniform2f(GLint location, GLfloat x, GLfloat y) {
 }
 
 void GLTrace_glUniform2fv(GLint location, GLsizei count, const GLfloat* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform2fv, "glUniform2fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform2fv, "glUniform2fv");
+        glContext->hooks->gl.glUniform2fv(location, count, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform2fv);
 
     // copy argument location
@@ -4669,9 +5360,15 @@ void GLTrace_glUniform2fv(GLint location, GLsizei count, const GLfloat* v) {
 }
 
 void GLTrace_glUniform2i(GLint location, GLint x, GLint y) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform2i, "glUniform2i")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform2i, "glUniform2i");
+        glContext->hooks->gl.glUniform2i(location, x, y);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform2i);
 
     // copy argument location
@@ -4709,9 +5406,15 @@ void GLTrace_glUniform2i(GLint location, GLint x, GLint y) {
 }
 
 void GLTrace_glUniform2iv(GLint location, GLsizei count, const GLint* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform2iv, "glUniform2iv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform2iv, "glUniform2iv");
+        glContext->hooks->gl.glUniform2iv(location, count, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform2iv);
 
     // copy argument location
@@ -4750,9 +5453,15 @@ void GLTrace_glUniform2iv(GLint location, GLsizei count, const GLint* v) {
 }
 
 void GLTrace_glUniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform3f, "glUniform3f")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform3f, "glUniform3f");
+        glContext->hooks->gl.glUniform3f(location, x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform3f);
 
     // copy argument location
@@ -4796,9 +5505,15 @@ void GLTrace_glUniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z) {
 }
 
 void GLTrace_glUniform3fv(GLint location, GLsizei count, const GLfloat* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform3fv, "glUniform3fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform3fv, "glUniform3fv");
+        glContext->hooks->gl.glUniform3fv(location, count, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform3fv);
 
     // copy argument location
@@ -4837,9 +5552,15 @@ void GLTrace_glUniform3fv(GLint location, GLsizei count, const GLfloat* v) {
 }
 
 void GLTrace_glUniform3i(GLint location, GLint x, GLint y, GLint z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform3i, "glUniform3i")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform3i, "glUniform3i");
+        glContext->hooks->gl.glUniform3i(location, x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform3i);
 
     // copy argument location
@@ -4883,9 +5604,15 @@ void GLTrace_glUniform3i(GLint location, GLint x, GLint y, GLint z) {
 }
 
 void GLTrace_glUniform3iv(GLint location, GLsizei count, const GLint* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform3iv, "glUniform3iv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform3iv, "glUniform3iv");
+        glContext->hooks->gl.glUniform3iv(location, count, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform3iv);
 
     // copy argument location
@@ -4924,9 +5651,15 @@ void GLTrace_glUniform3iv(GLint location, GLsizei count, const GLint* v) {
 }
 
 void GLTrace_glUniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform4f, "glUniform4f")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform4f, "glUniform4f");
+        glContext->hooks->gl.glUniform4f(location, x, y, z, w);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform4f);
 
     // copy argument location
@@ -4976,9 +5709,15 @@ void GLTrace_glUniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloa
 }
 
 void GLTrace_glUniform4fv(GLint location, GLsizei count, const GLfloat* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform4fv, "glUniform4fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform4fv, "glUniform4fv");
+        glContext->hooks->gl.glUniform4fv(location, count, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform4fv);
 
     // copy argument location
@@ -5017,9 +5756,15 @@ void GLTrace_glUniform4fv(GLint location, GLsizei count, const GLfloat* v) {
 }
 
 void GLTrace_glUniform4i(GLint location, GLint x, GLint y, GLint z, GLint w) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform4i, "glUniform4i")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform4i, "glUniform4i");
+        glContext->hooks->gl.glUniform4i(location, x, y, z, w);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform4i);
 
     // copy argument location
@@ -5069,9 +5814,15 @@ void GLTrace_glUniform4i(GLint location, GLint x, GLint y, GLint z, GLint w) {
 }
 
 void GLTrace_glUniform4iv(GLint location, GLsizei count, const GLint* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform4iv, "glUniform4iv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform4iv, "glUniform4iv");
+        glContext->hooks->gl.glUniform4iv(location, count, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform4iv);
 
     // copy argument location
@@ -5110,9 +5861,15 @@ void GLTrace_glUniform4iv(GLint location, GLsizei count, const GLint* v) {
 }
 
 void GLTrace_glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformMatrix2fv, "glUniformMatrix2fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformMatrix2fv, "glUniformMatrix2fv");
+        glContext->hooks->gl.glUniformMatrix2fv(location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformMatrix2fv);
 
     // copy argument location
@@ -5157,9 +5914,15 @@ void GLTrace_glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpo
 }
 
 void GLTrace_glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformMatrix3fv, "glUniformMatrix3fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformMatrix3fv, "glUniformMatrix3fv");
+        glContext->hooks->gl.glUniformMatrix3fv(location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformMatrix3fv);
 
     // copy argument location
@@ -5204,9 +5967,15 @@ void GLTrace_glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpo
 }
 
 void GLTrace_glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformMatrix4fv, "glUniformMatrix4fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformMatrix4fv, "glUniformMatrix4fv");
+        glContext->hooks->gl.glUniformMatrix4fv(location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformMatrix4fv);
 
     // copy argument location
@@ -5251,9 +6020,15 @@ void GLTrace_glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpo
 }
 
 void GLTrace_glUseProgram(GLuint program) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUseProgram, "glUseProgram")) {
+        GLCallCounter counter(glContext, GLMessage::glUseProgram, "glUseProgram");
+        glContext->hooks->gl.glUseProgram(program);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUseProgram);
 
     // copy argument program
@@ -5279,9 +6054,15 @@ void GLTrace_glUseProgram(GLuint program) {
 }
 
 void GLTrace_glValidateProgram(GLuint program) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glValidateProgram, "glValidateProgram")) {
+        GLCallCounter counter(glContext, GLMessage::glValidateProgram, "glValidateProgram");
+        glContext->hooks->gl.glValidateProgram(program);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glValidateProgram);
 
     // copy argument program
@@ -5307,9 +6088,15 @@ void GLTrace_glValidateProgram(GLuint program) {
 }
 
 void GLTrace_glVertexAttrib1f(GLuint indx, GLfloat x) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttrib1f, "glVertexAttrib1f")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttrib1f, "glVertexAttrib1f");
+        glContext->hooks->gl.glVertexAttrib1f(indx, x);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttrib1f);
 
     // copy argument indx
@@ -5341,9 +6128,15 @@ void GLTrace_glVertexAttrib1f(GLuint indx, GLfloat x) {
 }
 
 void GLTrace_glVertexAttrib1fv(GLuint indx, const GLfloat* values) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttrib1fv, "glVertexAttrib1fv")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttrib1fv, "glVertexAttrib1fv");
+        glContext->hooks->gl.glVertexAttrib1fv(indx, values);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttrib1fv);
 
     // copy argument indx
@@ -5376,9 +6169,15 @@ void GLTrace_glVertexAttrib1fv(GLuint indx, const GLfloat* values) {
 }
 
 void GLTrace_glVertexAttrib2f(GLuint indx, GLfloat x, GLfloat y) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttrib2f, "glVertexAttrib2f")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttrib2f, "glVertexAttrib2f");
+        glContext->hooks->gl.glVertexAttrib2f(indx, x, y);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttrib2f);
 
     // copy argument indx
@@ -5416,9 +6215,15 @@ void GLTrace_glVertexAttrib2f(GLuint indx, GLfloat x, GLfloat y) {
 }
 
 void GLTrace_glVertexAttrib2fv(GLuint indx, const GLfloat* values) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttrib2fv, "glVertexAttrib2fv")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttrib2fv, "glVertexAttrib2fv");
+        glContext->hooks->gl.glVertexAttrib2fv(indx, values);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttrib2fv);
 
     // copy argument indx
@@ -5451,9 +6256,15 @@ void GLTrace_glVertexAttrib2fv(GLuint indx, const GLfloat* values) {
 }
 
 void GLTrace_glVertexAttrib3f(GLuint indx, GLfloat x, GLfloat y, GLfloat z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttrib3f, "glVertexAttrib3f")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttrib3f, "glVertexAttrib3f");
+        glContext->hooks->gl.glVertexAttrib3f(indx, x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttrib3f);
 
     // copy argument indx
@@ -5497,9 +6308,15 @@ void GLTrace_glVertexAttrib3f(GLuint indx, GLfloat x, GLfloat y, GLfloat z) {
 }
 
 void GLTrace_glVertexAttrib3fv(GLuint indx, const GLfloat* values) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttrib3fv, "glVertexAttrib3fv")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttrib3fv, "glVertexAttrib3fv");
+        glContext->hooks->gl.glVertexAttrib3fv(indx, values);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttrib3fv);
 
     // copy argument indx
@@ -5532,9 +6349,15 @@ void GLTrace_glVertexAttrib3fv(GLuint indx, const GLfloat* values) {
 }
 
 void GLTrace_glVertexAttrib4f(GLuint indx, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttrib4f, "glVertexAttrib4f")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttrib4f, "glVertexAttrib4f");
+        glContext->hooks->gl.glVertexAttrib4f(indx, x, y, z, w);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttrib4f);
 
     // copy argument indx
@@ -5584,9 +6407,15 @@ void GLTrace_glVertexAttrib4f(GLuint indx, GLfloat x, GLfloat y, GLfloat z, GLfl
 }
 
 void GLTrace_glVertexAttrib4fv(GLuint indx, const GLfloat* values) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttrib4fv, "glVertexAttrib4fv")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttrib4fv, "glVertexAttrib4fv");
+        glContext->hooks->gl.glVertexAttrib4fv(indx, values);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttrib4fv);
 
     // copy argument indx
@@ -5619,9 +6448,15 @@ void GLTrace_glVertexAttrib4fv(GLuint indx, const GLfloat* values) {
 }
 
 void GLTrace_glVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* ptr) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttribPointer, "glVertexAttribPointer")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttribPointer, "glVertexAttribPointer");
+        glContext->hooks->gl.glVertexAttribPointer(indx, size, type, normalized, stride, ptr);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttribPointer);
 
     // copy argument indx
@@ -5678,9 +6513,15 @@ void GLTrace_glVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboole
 }
 
 void GLTrace_glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glViewport, "glViewport")) {
+        GLCallCounter counter(glContext, GLMessage::glViewport, "glViewport");
+        glContext->hooks->gl.glViewport(x, y, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glViewport);
 
     // copy argument x
@@ -5724,9 +6565,15 @@ void GLTrace_glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
 }
 
 void GLTrace_glReadBuffer(GLenum mode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glReadBuffer, "glReadBuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glReadBuffer, "glReadBuffer");
+        glContext->hooks->gl.glReadBuffer(mode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glReadBuffer);
 
     // copy argument mode
@@ -5752,9 +6599,15 @@ void GLTrace_glReadBuffer(GLenum mode) {
 }
 
 void GLTrace_glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const GLvoid* indices) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawRangeElements, "glDrawRangeElements")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawRangeElements, "glDrawRangeElements");
+        glContext->hooks->gl.glDrawRangeElements(mode, start, end, count, type, indices);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawRangeElements);
 
     // copy argument mode
@@ -5811,9 +6664,15 @@ void GLTrace_glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei
 }
 
 void GLTrace_glTexImage3D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexImage3D, "glTexImage3D")) {
+        GLCallCounter counter(glContext, GLMessage::glTexImage3D, "glTexImage3D");
+        glContext->hooks->gl.glTexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexImage3D);
 
     // copy argument target
@@ -5894,9 +6753,15 @@ void GLTrace_glTexImage3D(GLenum target, GLint level, GLint internalformat, GLsi
 }
 
 void GLTrace_glTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const GLvoid* pixels) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexSubImage3D, "glTexSubImage3D")) {
+        GLCallCounter counter(glContext, GLMessage::glTexSubImage3D, "glTexSubImage3D");
+        glContext->hooks->gl.glTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexSubImage3D);
 
     // copy argument target
@@ -5983,9 +6848,15 @@ void GLTrace_glTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yo
 }
 
 void GLTrace_glCopyTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLint x, GLint y, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCopyTexSubImage3D, "glCopyTexSubImage3D")) {
+        GLCallCounter counter(glContext, GLMessage::glCopyTexSubImage3D, "glCopyTexSubImage3D");
+        glContext->hooks->gl.glCopyTexSubImage3D(target, level, xoffset, yoffset, zoffset, x, y, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCopyTexSubImage3D);
 
     // copy argument target
@@ -6059,9 +6930,15 @@ void GLTrace_glCopyTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLin
 }
 
 void GLTrace_glCompressedTexImage3D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const GLvoid* data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCompressedTexImage3D, "glCompressedTexImage3D")) {
+        GLCallCounter counter(glContext, GLMessage::glCompressedTexImage3D, "glCompressedTexImage3D");
+        glContext->hooks->gl.glCompressedTexImage3D(target, level, internalformat, width, height, depth, border, imageSize, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCompressedTexImage3D);
 
     // copy argument target
@@ -6136,9 +7013,15 @@ void GLTrace_glCompressedTexImage3D(GLenum target, GLint level, GLenum internalf
 }
 
 void GLTrace_glCompressedTexSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const GLvoid* data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCompressedTexSubImage3D, "glCompressedTexSubImage3D")) {
+        GLCallCounter counter(glContext, GLMessage::glCompressedTexSubImage3D, "glCompressedTexSubImage3D");
+        glContext->hooks->gl.glCompressedTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, imageSize, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCompressedTexSubImage3D);
 
     // copy argument target
@@ -6225,9 +7108,15 @@ void GLTrace_glCompressedTexSubImage3D(GLenum target, GLint level, GLint xoffset
 }
 
 void GLTrace_glGenQueries(GLsizei n, GLuint* ids) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenQueries, "glGenQueries")) {
+        GLCallCounter counter(glContext, GLMessage::glGenQueries, "glGenQueries");
+        glContext->hooks->gl.glGenQueries(n, ids);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenQueries);
 
     // copy argument n
@@ -6260,9 +7149,15 @@ void GLTrace_glGenQueries(GLsizei n, GLuint* ids) {
 }
 
 void GLTrace_glDeleteQueries(GLsizei n, const GLuint* ids) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteQueries, "glDeleteQueries")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteQueries, "glDeleteQueries");
+        glContext->hooks->gl.glDeleteQueries(n, ids);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteQueries);
 
     // copy argument n
@@ -6295,9 +7190,14 @@ void GLTrace_glDeleteQueries(GLsizei n, const GLuint* ids) {
 }
 
 GLboolean GLTrace_glIsQuery(GLuint id) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsQuery, "glIsQuery")) {
+        GLCallCounter counter(glContext, GLMessage::glIsQuery, "glIsQuery");
+        return glContext->hooks->gl.glIsQuery(id);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsQuery);
 
     // copy argument id
@@ -6331,9 +7231,15 @@ GLboolean GLTrace_glIsQuery(GLuint id) {
 }
 
 void GLTrace_glBeginQuery(GLenum target, GLuint id) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBeginQuery, "glBeginQuery")) {
+        GLCallCounter counter(glContext, GLMessage::glBeginQuery, "glBeginQuery");
+        glContext->hooks->gl.glBeginQuery(target, id);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBeginQuery);
 
     // copy argument target
@@ -6365,9 +7271,15 @@ void GLTrace_glBeginQuery(GLenum target, GLuint id) {
 }
 
 void GLTrace_glEndQuery(GLenum target) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEndQuery, "glEndQuery")) {
+        GLCallCounter counter(glContext, GLMessage::glEndQuery, "glEndQuery");
+        glContext->hooks->gl.glEndQuery(target);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEndQuery);
 
     // copy argument target
@@ -6393,9 +7305,15 @@ void GLTrace_glEndQuery(GLenum target) {
 }
 
 void GLTrace_glGetQueryiv(GLenum target, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetQueryiv, "glGetQueryiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetQueryiv, "glGetQueryiv");
+        glContext->hooks->gl.glGetQueryiv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetQueryiv);
 
     // copy argument target
@@ -6434,9 +7352,15 @@ void GLTrace_glGetQueryiv(GLenum target, GLenum pname, GLint* params) {
 }
 
 void GLTrace_glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetQueryObjectuiv, "glGetQueryObjectuiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetQueryObjectuiv, "glGetQueryObjectuiv");
+        glContext->hooks->gl.glGetQueryObjectuiv(id, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetQueryObjectuiv);
 
     // copy argument id
@@ -6475,9 +7399,14 @@ void GLTrace_glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params) {
 }
 
 GLboolean GLTrace_glUnmapBuffer(GLenum target) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUnmapBuffer, "glUnmapBuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glUnmapBuffer, "glUnmapBuffer");
+        return glContext->hooks->gl.glUnmapBuffer(target);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUnmapBuffer);
 
     // copy argument target
@@ -6511,9 +7440,15 @@ GLboolean GLTrace_glUnmapBuffer(GLenum target) {
 }
 
 void GLTrace_glGetBufferPointerv(GLenum target, GLenum pname, GLvoid** params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetBufferPointerv, "glGetBufferPointerv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetBufferPointerv, "glGetBufferPointerv");
+        glContext->hooks->gl.glGetBufferPointerv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetBufferPointerv);
 
     // copy argument target
@@ -6552,9 +7487,15 @@ void GLTrace_glGetBufferPointerv(GLenum target, GLenum pname, GLvoid** params) {
 }
 
 void GLTrace_glDrawBuffers(GLsizei n, const GLenum* bufs) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawBuffers, "glDrawBuffers")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawBuffers, "glDrawBuffers");
+        glContext->hooks->gl.glDrawBuffers(n, bufs);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawBuffers);
 
     // copy argument n
@@ -6587,9 +7528,15 @@ void GLTrace_glDrawBuffers(GLsizei n, const GLenum* bufs) {
 }
 
 void GLTrace_glUniformMatrix2x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformMatrix2x3fv, "glUniformMatrix2x3fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformMatrix2x3fv, "glUniformMatrix2x3fv");
+        glContext->hooks->gl.glUniformMatrix2x3fv(location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformMatrix2x3fv);
 
     // copy argument location
@@ -6634,9 +7581,15 @@ void GLTrace_glUniformMatrix2x3fv(GLint location, GLsizei count, GLboolean trans
 }
 
 void GLTrace_glUniformMatrix3x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformMatrix3x2fv, "glUniformMatrix3x2fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformMatrix3x2fv, "glUniformMatrix3x2fv");
+        glContext->hooks->gl.glUniformMatrix3x2fv(location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformMatrix3x2fv);
 
     // copy argument location
@@ -6681,9 +7634,15 @@ void GLTrace_glUniformMatrix3x2fv(GLint location, GLsizei count, GLboolean trans
 }
 
 void GLTrace_glUniformMatrix2x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformMatrix2x4fv, "glUniformMatrix2x4fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformMatrix2x4fv, "glUniformMatrix2x4fv");
+        glContext->hooks->gl.glUniformMatrix2x4fv(location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformMatrix2x4fv);
 
     // copy argument location
@@ -6728,9 +7687,15 @@ void GLTrace_glUniformMatrix2x4fv(GLint location, GLsizei count, GLboolean trans
 }
 
 void GLTrace_glUniformMatrix4x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformMatrix4x2fv, "glUniformMatrix4x2fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformMatrix4x2fv, "glUniformMatrix4x2fv");
+        glContext->hooks->gl.glUniformMatrix4x2fv(location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformMatrix4x2fv);
 
     // copy argument location
@@ -6775,9 +7740,15 @@ void GLTrace_glUniformMatrix4x2fv(GLint location, GLsizei count, GLboolean trans
 }
 
 void GLTrace_glUniformMatrix3x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformMatrix3x4fv, "glUniformMatrix3x4fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformMatrix3x4fv, "glUniformMatrix3x4fv");
+        glContext->hooks->gl.glUniformMatrix3x4fv(location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformMatrix3x4fv);
 
     // copy argument location
@@ -6822,9 +7793,15 @@ void GLTrace_glUniformMatrix3x4fv(GLint location, GLsizei count, GLboolean trans
 }
 
 void GLTrace_glUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformMatrix4x3fv, "glUniformMatrix4x3fv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformMatrix4x3fv, "glUniformMatrix4x3fv");
+        glContext->hooks->gl.glUniformMatrix4x3fv(location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformMatrix4x3fv);
 
     // copy argument location
@@ -6869,9 +7846,15 @@ void GLTrace_glUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean trans
 }
 
 void GLTrace_glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlitFramebuffer, "glBlitFramebuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glBlitFramebuffer, "glBlitFramebuffer");
+        glContext->hooks->gl.glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlitFramebuffer);
 
     // copy argument srcX0
@@ -6951,9 +7934,15 @@ void GLTrace_glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY
 }
 
 void GLTrace_glRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRenderbufferStorageMultisample, "glRenderbufferStorageMultisample")) {
+        GLCallCounter counter(glContext, GLMessage::glRenderbufferStorageMultisample, "glRenderbufferStorageMultisample");
+        glContext->hooks->gl.glRenderbufferStorageMultisample(target, samples, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRenderbufferStorageMultisample);
 
     // copy argument target
@@ -7003,9 +7992,15 @@ void GLTrace_glRenderbufferStorageMultisample(GLenum target, GLsizei samples, GL
 }
 
 void GLTrace_glFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFramebufferTextureLayer, "glFramebufferTextureLayer")) {
+        GLCallCounter counter(glContext, GLMessage::glFramebufferTextureLayer, "glFramebufferTextureLayer");
+        glContext->hooks->gl.glFramebufferTextureLayer(target, attachment, texture, level, layer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFramebufferTextureLayer);
 
     // copy argument target
@@ -7055,9 +8050,14 @@ void GLTrace_glFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint
 }
 
 GLvoid* GLTrace_glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMapBufferRange, "glMapBufferRange")) {
+        GLCallCounter counter(glContext, GLMessage::glMapBufferRange, "glMapBufferRange");
+        return glContext->hooks->gl.glMapBufferRange(target, offset, length, access);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMapBufferRange);
 
     // copy argument target
@@ -7110,9 +8110,15 @@ GLvoid* GLTrace_glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr leng
 }
 
 void GLTrace_glFlushMappedBufferRange(GLenum target, GLintptr offset, GLsizeiptr length) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFlushMappedBufferRange, "glFlushMappedBufferRange")) {
+        GLCallCounter counter(glContext, GLMessage::glFlushMappedBufferRange, "glFlushMappedBufferRange");
+        glContext->hooks->gl.glFlushMappedBufferRange(target, offset, length);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFlushMappedBufferRange);
 
     // copy argument target
@@ -7150,10 +8156,16 @@ void GLTrace_glFlushMappedBufferRange(GLenum target, GLintptr offset, GLsizeiptr
 }
 
 void GLTrace_glBindVertexArray(GLuint array) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
-    glmsg.set_function(GLMessage::glBindVertexArray);
+    if (!glContext->shouldTrace(GLMessage::glBindVertexArray, "glBindVertexArray")) {
+        GLCallCounter counter(glContext, GLMessage::glBindVertexArray, "glBindVertexArray");
+        glContext->hooks->gl.glBindVertexArray(array);
+        return;
+    }
+
+    GLMessage glmsg;
+    glmsg.set_function(GLMessage::glBindVertexArray);
 
     // copy argument array
     GLMessage_DataType *arg_array = glmsg.add_args();
@@ -7178,9 +8190,15 @@ void GLTrace_glBindVertexArray(GLuint array) {
 }
 
 void GLTrace_glDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteVertexArrays, "glDeleteVertexArrays")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteVertexArrays, "glDeleteVertexArrays");
+        glContext->hooks->gl.glDeleteVertexArrays(n, arrays);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteVertexArrays);
 
     // copy argument n
@@ -7213,9 +8231,15 @@ void GLTrace_glDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
 }
 
 void GLTrace_glGenVertexArrays(GLsizei n, GLuint* arrays) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenVertexArrays, "glGenVertexArrays")) {
+        GLCallCounter counter(glContext, GLMessage::glGenVertexArrays, "glGenVertexArrays");
+        glContext->hooks->gl.glGenVertexArrays(n, arrays);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenVertexArrays);
 
     // copy argument n
@@ -7248,9 +8272,14 @@ void GLTrace_glGenVertexArrays(GLsizei n, GLuint* arrays) {
 }
 
 GLboolean GLTrace_glIsVertexArray(GLuint array) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsVertexArray, "glIsVertexArray")) {
+        GLCallCounter counter(glContext, GLMessage::glIsVertexArray, "glIsVertexArray");
+        return glContext->hooks->gl.glIsVertexArray(array);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsVertexArray);
 
     // copy argument array
@@ -7284,9 +8313,15 @@ GLboolean GLTrace_glIsVertexArray(GLuint array) {
 }
 
 void GLTrace_glGetIntegeri_v(GLenum target, GLuint index, GLint* data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetIntegeri_v, "glGetIntegeri_v")) {
+        GLCallCounter counter(glContext, GLMessage::glGetIntegeri_v, "glGetIntegeri_v");
+        glContext->hooks->gl.glGetIntegeri_v(target, index, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetIntegeri_v);
 
     // copy argument target
@@ -7325,9 +8360,15 @@ void GLTrace_glGetIntegeri_v(GLenum target, GLuint index, GLint* data) {
 }
 
 void GLTrace_glBeginTransformFeedback(GLenum primitiveMode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBeginTransformFeedback, "glBeginTransformFeedback")) {
+        GLCallCounter counter(glContext, GLMessage::glBeginTransformFeedback, "glBeginTransformFeedback");
+        glContext->hooks->gl.glBeginTransformFeedback(primitiveMode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBeginTransformFeedback);
 
     // copy argument primitiveMode
@@ -7353,9 +8394,15 @@ void GLTrace_glBeginTransformFeedback(GLenum primitiveMode) {
 }
 
 void GLTrace_glEndTransformFeedback(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEndTransformFeedback, "glEndTransformFeedback")) {
+        GLCallCounter counter(glContext, GLMessage::glEndTransformFeedback, "glEndTransformFeedback");
+        glContext->hooks->gl.glEndTransformFeedback();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEndTransformFeedback);
 
     // call function
@@ -7375,9 +8422,15 @@ void GLTrace_glEndTransformFeedback(void) {
 }
 
 void GLTrace_glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindBufferRange, "glBindBufferRange")) {
+        GLCallCounter counter(glContext, GLMessage::glBindBufferRange, "glBindBufferRange");
+        glContext->hooks->gl.glBindBufferRange(target, index, buffer, offset, size);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindBufferRange);
 
     // copy argument target
@@ -7427,9 +8480,15 @@ void GLTrace_glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLint
 }
 
 void GLTrace_glBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindBufferBase, "glBindBufferBase")) {
+        GLCallCounter counter(glContext, GLMessage::glBindBufferBase, "glBindBufferBase");
+        glContext->hooks->gl.glBindBufferBase(target, index, buffer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindBufferBase);
 
     // copy argument target
@@ -7467,9 +8526,15 @@ void GLTrace_glBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
 }
 
 void GLTrace_glTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTransformFeedbackVaryings, "glTransformFeedbackVaryings")) {
+        GLCallCounter counter(glContext, GLMessage::glTransformFeedbackVaryings, "glTransformFeedbackVaryings");
+        glContext->hooks->gl.glTransformFeedbackVaryings(program, count, varyings, bufferMode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTransformFeedbackVaryings);
 
     // copy argument program
@@ -7514,9 +8579,15 @@ void GLTrace_glTransformFeedbackVaryings(GLuint program, GLsizei count, const GL
 }
 
 void GLTrace_glGetTransformFeedbackVarying(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLsizei* size, GLenum* type, GLchar* name) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTransformFeedbackVarying, "glGetTransformFeedbackVarying")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTransformFeedbackVarying, "glGetTransformFeedbackVarying");
+        glContext->hooks->gl.glGetTransformFeedbackVarying(program, index, bufSize, length, size, type, name);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTransformFeedbackVarying);
 
     // copy argument program
@@ -7582,9 +8653,15 @@ void GLTrace_glGetTransformFeedbackVarying(GLuint program, GLuint index, GLsizei
 }
 
 void GLTrace_glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttribIPointer, "glVertexAttribIPointer")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttribIPointer, "glVertexAttribIPointer");
+        glContext->hooks->gl.glVertexAttribIPointer(index, size, type, stride, pointer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttribIPointer);
 
     // copy argument index
@@ -7635,9 +8712,15 @@ void GLTrace_glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsiz
 }
 
 void GLTrace_glGetVertexAttribIiv(GLuint index, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetVertexAttribIiv, "glGetVertexAttribIiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetVertexAttribIiv, "glGetVertexAttribIiv");
+        glContext->hooks->gl.glGetVertexAttribIiv(index, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetVertexAttribIiv);
 
     // copy argument index
@@ -7676,9 +8759,15 @@ void GLTrace_glGetVertexAttribIiv(GLuint index, GLenum pname, GLint* params) {
 }
 
 void GLTrace_glGetVertexAttribIuiv(GLuint index, GLenum pname, GLuint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetVertexAttribIuiv, "glGetVertexAttribIuiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetVertexAttribIuiv, "glGetVertexAttribIuiv");
+        glContext->hooks->gl.glGetVertexAttribIuiv(index, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetVertexAttribIuiv);
 
     // copy argument index
@@ -7717,9 +8806,15 @@ void GLTrace_glGetVertexAttribIuiv(GLuint index, GLenum pname, GLuint* params) {
 }
 
 void GLTrace_glVertexAttribI4i(GLuint index, GLint x, GLint y, GLint z, GLint w) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttribI4i, "glVertexAttribI4i")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttribI4i, "glVertexAttribI4i");
+        glContext->hooks->gl.glVertexAttribI4i(index, x, y, z, w);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttribI4i);
 
     // copy argument index
@@ -7769,9 +8864,15 @@ void GLTrace_glVertexAttribI4i(GLuint index, GLint x, GLint y, GLint z, GLint w)
 }
 
 void GLTrace_glVertexAttribI4ui(GLuint index, GLuint x, GLuint y, GLuint z, GLuint w) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttribI4ui, "glVertexAttribI4ui")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttribI4ui, "glVertexAttribI4ui");
+        glContext->hooks->gl.glVertexAttribI4ui(index, x, y, z, w);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttribI4ui);
 
     // copy argument index
@@ -7821,9 +8922,15 @@ void GLTrace_glVertexAttribI4ui(GLuint index, GLuint x, GLuint y, GLuint z, GLui
 }
 
 void GLTrace_glVertexAttribI4iv(GLuint index, const GLint* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttribI4iv, "glVertexAttribI4iv")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttribI4iv, "glVertexAttribI4iv");
+        glContext->hooks->gl.glVertexAttribI4iv(index, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttribI4iv);
 
     // copy argument index
@@ -7856,9 +8963,15 @@ void GLTrace_glVertexAttribI4iv(GLuint index, const GLint* v) {
 }
 
 void GLTrace_glVertexAttribI4uiv(GLuint index, const GLuint* v) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttribI4uiv, "glVertexAttribI4uiv")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttribI4uiv, "glVertexAttribI4uiv");
+        glContext->hooks->gl.glVertexAttribI4uiv(index, v);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttribI4uiv);
 
     // copy argument index
@@ -7891,9 +9004,15 @@ void GLTrace_glVertexAttribI4uiv(GLuint index, const GLuint* v) {
 }
 
 void GLTrace_glGetUniformuiv(GLuint program, GLint location, GLuint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetUniformuiv, "glGetUniformuiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetUniformuiv, "glGetUniformuiv");
+        glContext->hooks->gl.glGetUniformuiv(program, location, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetUniformuiv);
 
     // copy argument program
@@ -7932,9 +9051,14 @@ void GLTrace_glGetUniformuiv(GLuint program, GLint location, GLuint* params) {
 }
 
 GLint GLTrace_glGetFragDataLocation(GLuint program, const GLchar *name) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetFragDataLocation, "glGetFragDataLocation")) {
+        GLCallCounter counter(glContext, GLMessage::glGetFragDataLocation, "glGetFragDataLocation");
+        return glContext->hooks->gl.glGetFragDataLocation(program, name);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetFragDataLocation);
 
     // copy argument program
@@ -7975,9 +9099,15 @@ GLint GLTrace_glGetFragDataLocation(GLuint program, const GLchar *name) {
 }
 
 void GLTrace_glUniform1ui(GLint location, GLuint v0) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform1ui, "glUniform1ui")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform1ui, "glUniform1ui");
+        glContext->hooks->gl.glUniform1ui(location, v0);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform1ui);
 
     // copy argument location
@@ -8009,9 +9139,15 @@ void GLTrace_glUniform1ui(GLint location, GLuint v0) {
 }
 
 void GLTrace_glUniform2ui(GLint location, GLuint v0, GLuint v1) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform2ui, "glUniform2ui")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform2ui, "glUniform2ui");
+        glContext->hooks->gl.glUniform2ui(location, v0, v1);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform2ui);
 
     // copy argument location
@@ -8049,9 +9185,15 @@ void GLTrace_glUniform2ui(GLint location, GLuint v0, GLuint v1) {
 }
 
 void GLTrace_glUniform3ui(GLint location, GLuint v0, GLuint v1, GLuint v2) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform3ui, "glUniform3ui")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform3ui, "glUniform3ui");
+        glContext->hooks->gl.glUniform3ui(location, v0, v1, v2);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform3ui);
 
     // copy argument location
@@ -8095,9 +9237,15 @@ void GLTrace_glUniform3ui(GLint location, GLuint v0, GLuint v1, GLuint v2) {
 }
 
 void GLTrace_glUniform4ui(GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform4ui, "glUniform4ui")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform4ui, "glUniform4ui");
+        glContext->hooks->gl.glUniform4ui(location, v0, v1, v2, v3);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform4ui);
 
     // copy argument location
@@ -8147,9 +9295,15 @@ void GLTrace_glUniform4ui(GLint location, GLuint v0, GLuint v1, GLuint v2, GLuin
 }
 
 void GLTrace_glUniform1uiv(GLint location, GLsizei count, const GLuint* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform1uiv, "glUniform1uiv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform1uiv, "glUniform1uiv");
+        glContext->hooks->gl.glUniform1uiv(location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform1uiv);
 
     // copy argument location
@@ -8188,9 +9342,15 @@ void GLTrace_glUniform1uiv(GLint location, GLsizei count, const GLuint* value) {
 }
 
 void GLTrace_glUniform2uiv(GLint location, GLsizei count, const GLuint* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform2uiv, "glUniform2uiv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform2uiv, "glUniform2uiv");
+        glContext->hooks->gl.glUniform2uiv(location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform2uiv);
 
     // copy argument location
@@ -8229,9 +9389,15 @@ void GLTrace_glUniform2uiv(GLint location, GLsizei count, const GLuint* value) {
 }
 
 void GLTrace_glUniform3uiv(GLint location, GLsizei count, const GLuint* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform3uiv, "glUniform3uiv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform3uiv, "glUniform3uiv");
+        glContext->hooks->gl.glUniform3uiv(location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform3uiv);
 
     // copy argument location
@@ -8270,9 +9436,15 @@ void GLTrace_glUniform3uiv(GLint location, GLsizei count, const GLuint* value) {
 }
 
 void GLTrace_glUniform4uiv(GLint location, GLsizei count, const GLuint* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniform4uiv, "glUniform4uiv")) {
+        GLCallCounter counter(glContext, GLMessage::glUniform4uiv, "glUniform4uiv");
+        glContext->hooks->gl.glUniform4uiv(location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniform4uiv);
 
     // copy argument location
@@ -8311,9 +9483,15 @@ void GLTrace_glUniform4uiv(GLint location, GLsizei count, const GLuint* value) {
 }
 
 void GLTrace_glClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearBufferiv, "glClearBufferiv")) {
+        GLCallCounter counter(glContext, GLMessage::glClearBufferiv, "glClearBufferiv");
+        glContext->hooks->gl.glClearBufferiv(buffer, drawbuffer, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearBufferiv);
 
     // copy argument buffer
@@ -8352,9 +9530,15 @@ void GLTrace_glClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint* value
 }
 
 void GLTrace_glClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearBufferuiv, "glClearBufferuiv")) {
+        GLCallCounter counter(glContext, GLMessage::glClearBufferuiv, "glClearBufferuiv");
+        glContext->hooks->gl.glClearBufferuiv(buffer, drawbuffer, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearBufferuiv);
 
     // copy argument buffer
@@ -8393,9 +9577,15 @@ void GLTrace_glClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint* val
 }
 
 void GLTrace_glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat* value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearBufferfv, "glClearBufferfv")) {
+        GLCallCounter counter(glContext, GLMessage::glClearBufferfv, "glClearBufferfv");
+        glContext->hooks->gl.glClearBufferfv(buffer, drawbuffer, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearBufferfv);
 
     // copy argument buffer
@@ -8434,9 +9624,15 @@ void GLTrace_glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat* val
 }
 
 void GLTrace_glClearBufferfi(GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearBufferfi, "glClearBufferfi")) {
+        GLCallCounter counter(glContext, GLMessage::glClearBufferfi, "glClearBufferfi");
+        glContext->hooks->gl.glClearBufferfi(buffer, drawbuffer, depth, stencil);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearBufferfi);
 
     // copy argument buffer
@@ -8480,9 +9676,14 @@ void GLTrace_glClearBufferfi(GLenum buffer, GLint drawbuffer, GLfloat depth, GLi
 }
 
 const GLubyte* GLTrace_glGetStringi(GLenum name, GLuint index) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetStringi, "glGetStringi")) {
+        GLCallCounter counter(glContext, GLMessage::glGetStringi, "glGetStringi");
+        return glContext->hooks->gl.glGetStringi(name, index);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetStringi);
 
     // copy argument name
@@ -8523,9 +9724,15 @@ const GLubyte* GLTrace_glGetStringi(GLenum name, GLuint index) {
 }
 
 void GLTrace_glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCopyBufferSubData, "glCopyBufferSubData")) {
+        GLCallCounter counter(glContext, GLMessage::glCopyBufferSubData, "glCopyBufferSubData");
+        glContext->hooks->gl.glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCopyBufferSubData);
 
     // copy argument readTarget
@@ -8575,9 +9782,15 @@ void GLTrace_glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr
 }
 
 void GLTrace_glGetUniformIndices(GLuint program, GLsizei uniformCount, const GLchar* const* uniformNames, GLuint* uniformIndices) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetUniformIndices, "glGetUniformIndices")) {
+        GLCallCounter counter(glContext, GLMessage::glGetUniformIndices, "glGetUniformIndices");
+        glContext->hooks->gl.glGetUniformIndices(program, uniformCount, uniformNames, uniformIndices);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetUniformIndices);
 
     // copy argument program
@@ -8623,9 +9836,15 @@ void GLTrace_glGetUniformIndices(GLuint program, GLsizei uniformCount, const GLc
 }
 
 void GLTrace_glGetActiveUniformsiv(GLuint program, GLsizei uniformCount, const GLuint* uniformIndices, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetActiveUniformsiv, "glGetActiveUniformsiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetActiveUniformsiv, "glGetActiveUniformsiv");
+        glContext->hooks->gl.glGetActiveUniformsiv(program, uniformCount, uniformIndices, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetActiveUniformsiv);
 
     // copy argument program
@@ -8677,9 +9896,14 @@ void GLTrace_glGetActiveUniformsiv(GLuint program, GLsizei uniformCount, const G
 }
 
 GLuint GLTrace_glGetUniformBlockIndex(GLuint program, const GLchar* uniformBlockName) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetUniformBlockIndex, "glGetUniformBlockIndex")) {
+        GLCallCounter counter(glContext, GLMessage::glGetUniformBlockIndex, "glGetUniformBlockIndex");
+        return glContext->hooks->gl.glGetUniformBlockIndex(program, uniformBlockName);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetUniformBlockIndex);
 
     // copy argument program
@@ -8720,9 +9944,15 @@ GLuint GLTrace_glGetUniformBlockIndex(GLuint program, const GLchar* uniformBlock
 }
 
 void GLTrace_glGetActiveUniformBlockiv(GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetActiveUniformBlockiv, "glGetActiveUniformBlockiv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetActiveUniformBlockiv, "glGetActiveUniformBlockiv");
+        glContext->hooks->gl.glGetActiveUniformBlockiv(program, uniformBlockIndex, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetActiveUniformBlockiv);
 
     // copy argument program
@@ -8767,9 +9997,15 @@ void GLTrace_glGetActiveUniformBlockiv(GLuint program, GLuint uniformBlockIndex,
 }
 
 void GLTrace_glGetActiveUniformBlockName(GLuint program, GLuint uniformBlockIndex, GLsizei bufSize, GLsizei* length, GLchar* uniformBlockName) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetActiveUniformBlockName, "glGetActiveUniformBlockName")) {
+        GLCallCounter counter(glContext, GLMessage::glGetActiveUniformBlockName, "glGetActiveUniformBlockName");
+        glContext->hooks->gl.glGetActiveUniformBlockName(program, uniformBlockIndex, bufSize, length, uniformBlockName);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetActiveUniformBlockName);
 
     // copy argument program
@@ -8821,9 +10057,15 @@ void GLTrace_glGetActiveUniformBlockName(GLuint program, GLuint uniformBlockInde
 }
 
 void GLTrace_glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUniformBlockBinding, "glUniformBlockBinding")) {
+        GLCallCounter counter(glContext, GLMessage::glUniformBlockBinding, "glUniformBlockBinding");
+        glContext->hooks->gl.glUniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUniformBlockBinding);
 
     // copy argument program
@@ -8861,9 +10103,15 @@ void GLTrace_glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLu
 }
 
 void GLTrace_glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawArraysInstanced, "glDrawArraysInstanced")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawArraysInstanced, "glDrawArraysInstanced");
+        glContext->hooks->gl.glDrawArraysInstanced(mode, first, count, instanceCount);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawArraysInstanced);
 
     // copy argument mode
@@ -8907,9 +10155,15 @@ void GLTrace_glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsi
 }
 
 void GLTrace_glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei instanceCount) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawElementsInstanced, "glDrawElementsInstanced")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawElementsInstanced, "glDrawElementsInstanced");
+        glContext->hooks->gl.glDrawElementsInstanced(mode, count, type, indices, instanceCount);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawElementsInstanced);
 
     // copy argument mode
@@ -8960,9 +10214,14 @@ void GLTrace_glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, co
 }
 
 GLsync GLTrace_glFenceSync(GLenum condition, GLbitfield flags) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFenceSync, "glFenceSync")) {
+        GLCallCounter counter(glContext, GLMessage::glFenceSync, "glFenceSync");
+        return glContext->hooks->gl.glFenceSync(condition, flags);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFenceSync);
 
     // copy argument condition
@@ -9003,9 +10262,14 @@ GLsync GLTrace_glFenceSync(GLenum condition, GLbitfield flags) {
 }
 
 GLboolean GLTrace_glIsSync(GLsync sync) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsSync, "glIsSync")) {
+        GLCallCounter counter(glContext, GLMessage::glIsSync, "glIsSync");
+        return glContext->hooks->gl.glIsSync(sync);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsSync);
 
     // copy argument sync
@@ -9040,9 +10304,15 @@ GLboolean GLTrace_glIsSync(GLsync sync) {
 }
 
 void GLTrace_glDeleteSync(GLsync sync) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteSync, "glDeleteSync")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteSync, "glDeleteSync");
+        glContext->hooks->gl.glDeleteSync(sync);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteSync);
 
     // copy argument sync
@@ -9069,9 +10339,14 @@ void GLTrace_glDeleteSync(GLsync sync) {
 }
 
 GLenum GLTrace_glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClientWaitSync, "glClientWaitSync")) {
+        GLCallCounter counter(glContext, GLMessage::glClientWaitSync, "glClientWaitSync");
+        return glContext->hooks->gl.glClientWaitSync(sync, flags, timeout);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClientWaitSync);
 
     // copy argument sync
@@ -9118,9 +10393,15 @@ GLenum GLTrace_glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
 }
 
 void GLTrace_glWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glWaitSync, "glWaitSync")) {
+        GLCallCounter counter(glContext, GLMessage::glWaitSync, "glWaitSync");
+        glContext->hooks->gl.glWaitSync(sync, flags, timeout);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glWaitSync);
 
     // copy argument sync
@@ -9159,9 +10440,15 @@ void GLTrace_glWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
 }
 
 void GLTrace_glGetInteger64v(GLenum pname, GLint64* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetInteger64v, "glGetInteger64v")) {
+        GLCallCounter counter(glContext, GLMessage::glGetInteger64v, "glGetInteger64v");
+        glContext->hooks->gl.glGetInteger64v(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetInteger64v);
 
     // copy argument pname
@@ -9194,9 +10481,15 @@ void GLTrace_glGetInteger64v(GLenum pname, GLint64* params) {
 }
 
 void GLTrace_glGetSynciv(GLsync sync, GLenum pname, GLsizei bufSize, GLsizei* length, GLint* values) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetSynciv, "glGetSynciv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetSynciv, "glGetSynciv");
+        glContext->hooks->gl.glGetSynciv(sync, pname, bufSize, length, values);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetSynciv);
 
     // copy argument sync
@@ -9249,9 +10542,15 @@ void GLTrace_glGetSynciv(GLsync sync, GLenum pname, GLsizei bufSize, GLsizei* le
 }
 
 void GLTrace_glGetInteger64i_v(GLenum target, GLuint index, GLint64* data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetInteger64i_v, "glGetInteger64i_v")) {
+        GLCallCounter counter(glContext, GLMessage::glGetInteger64i_v, "glGetInteger64i_v");
+        glContext->hooks->gl.glGetInteger64i_v(target, index, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetInteger64i_v);
 
     // copy argument target
@@ -9290,9 +10589,15 @@ void GLTrace_glGetInteger64i_v(GLenum target, GLuint index, GLint64* data) {
 }
 
 void GLTrace_glGetBufferParameteri64v(GLenum target, GLenum pname, GLint64* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetBufferParameteri64v, "glGetBufferParameteri64v")) {
+        GLCallCounter counter(glContext, GLMessage::glGetBufferParameteri64v, "glGetBufferParameteri64v");
+        glContext->hooks->gl.glGetBufferParameteri64v(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetBufferParameteri64v);
 
     // copy argument target
@@ -9331,9 +10636,15 @@ void GLTrace_glGetBufferParameteri64v(GLenum target, GLenum pname, GLint64* para
 }
 
 void GLTrace_glGenSamplers(GLsizei count, GLuint* samplers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenSamplers, "glGenSamplers")) {
+        GLCallCounter counter(glContext, GLMessage::glGenSamplers, "glGenSamplers");
+        glContext->hooks->gl.glGenSamplers(count, samplers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenSamplers);
 
     // copy argument count
@@ -9366,9 +10677,15 @@ void GLTrace_glGenSamplers(GLsizei count, GLuint* samplers) {
 }
 
 void GLTrace_glDeleteSamplers(GLsizei count, const GLuint* samplers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteSamplers, "glDeleteSamplers")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteSamplers, "glDeleteSamplers");
+        glContext->hooks->gl.glDeleteSamplers(count, samplers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteSamplers);
 
     // copy argument count
@@ -9401,9 +10718,14 @@ void GLTrace_glDeleteSamplers(GLsizei count, const GLuint* samplers) {
 }
 
 GLboolean GLTrace_glIsSampler(GLuint sampler) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsSampler, "glIsSampler")) {
+        GLCallCounter counter(glContext, GLMessage::glIsSampler, "glIsSampler");
+        return glContext->hooks->gl.glIsSampler(sampler);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsSampler);
 
     // copy argument sampler
@@ -9437,9 +10759,15 @@ GLboolean GLTrace_glIsSampler(GLuint sampler) {
 }
 
 void GLTrace_glBindSampler(GLuint unit, GLuint sampler) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindSampler, "glBindSampler")) {
+        GLCallCounter counter(glContext, GLMessage::glBindSampler, "glBindSampler");
+        glContext->hooks->gl.glBindSampler(unit, sampler);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindSampler);
 
     // copy argument unit
@@ -9471,9 +10799,15 @@ void GLTrace_glBindSampler(GLuint unit, GLuint sampler) {
 }
 
 void GLTrace_glSamplerParameteri(GLuint sampler, GLenum pname, GLint param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glSamplerParameteri, "glSamplerParameteri")) {
+        GLCallCounter counter(glContext, GLMessage::glSamplerParameteri, "glSamplerParameteri");
+        glContext->hooks->gl.glSamplerParameteri(sampler, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glSamplerParameteri);
 
     // copy argument sampler
@@ -9511,9 +10845,15 @@ void GLTrace_glSamplerParameteri(GLuint sampler, GLenum pname, GLint param) {
 }
 
 void GLTrace_glSamplerParameteriv(GLuint sampler, GLenum pname, const GLint* param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glSamplerParameteriv, "glSamplerParameteriv")) {
+        GLCallCounter counter(glContext, GLMessage::glSamplerParameteriv, "glSamplerParameteriv");
+        glContext->hooks->gl.glSamplerParameteriv(sampler, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glSamplerParameteriv);
 
     // copy argument sampler
@@ -9552,9 +10892,15 @@ void GLTrace_glSamplerParameteriv(GLuint sampler, GLenum pname, const GLint* par
 }
 
 void GLTrace_glSamplerParameterf(GLuint sampler, GLenum pname, GLfloat param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glSamplerParameterf, "glSamplerParameterf")) {
+        GLCallCounter counter(glContext, GLMessage::glSamplerParameterf, "glSamplerParameterf");
+        glContext->hooks->gl.glSamplerParameterf(sampler, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glSamplerParameterf);
 
     // copy argument sampler
@@ -9592,9 +10938,15 @@ void GLTrace_glSamplerParameterf(GLuint sampler, GLenum pname, GLfloat param) {
 }
 
 void GLTrace_glSamplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glSamplerParameterfv, "glSamplerParameterfv")) {
+        GLCallCounter counter(glContext, GLMessage::glSamplerParameterfv, "glSamplerParameterfv");
+        glContext->hooks->gl.glSamplerParameterfv(sampler, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glSamplerParameterfv);
 
     // copy argument sampler
@@ -9633,9 +10985,15 @@ void GLTrace_glSamplerParameterfv(GLuint sampler, GLenum pname, const GLfloat* p
 }
 
 void GLTrace_glGetSamplerParameteriv(GLuint sampler, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetSamplerParameteriv, "glGetSamplerParameteriv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetSamplerParameteriv, "glGetSamplerParameteriv");
+        glContext->hooks->gl.glGetSamplerParameteriv(sampler, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetSamplerParameteriv);
 
     // copy argument sampler
@@ -9674,9 +11032,15 @@ void GLTrace_glGetSamplerParameteriv(GLuint sampler, GLenum pname, GLint* params
 }
 
 void GLTrace_glGetSamplerParameterfv(GLuint sampler, GLenum pname, GLfloat* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetSamplerParameterfv, "glGetSamplerParameterfv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetSamplerParameterfv, "glGetSamplerParameterfv");
+        glContext->hooks->gl.glGetSamplerParameterfv(sampler, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetSamplerParameterfv);
 
     // copy argument sampler
@@ -9715,9 +11079,15 @@ void GLTrace_glGetSamplerParameterfv(GLuint sampler, GLenum pname, GLfloat* para
 }
 
 void GLTrace_glVertexAttribDivisor(GLuint index, GLuint divisor) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexAttribDivisor, "glVertexAttribDivisor")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexAttribDivisor, "glVertexAttribDivisor");
+        glContext->hooks->gl.glVertexAttribDivisor(index, divisor);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexAttribDivisor);
 
     // copy argument index
@@ -9749,9 +11119,15 @@ void GLTrace_glVertexAttribDivisor(GLuint index, GLuint divisor) {
 }
 
 void GLTrace_glBindTransformFeedback(GLenum target, GLuint id) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindTransformFeedback, "glBindTransformFeedback")) {
+        GLCallCounter counter(glContext, GLMessage::glBindTransformFeedback, "glBindTransformFeedback");
+        glContext->hooks->gl.glBindTransformFeedback(target, id);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindTransformFeedback);
 
     // copy argument target
@@ -9783,9 +11159,15 @@ void GLTrace_glBindTransformFeedback(GLenum target, GLuint id) {
 }
 
 void GLTrace_glDeleteTransformFeedbacks(GLsizei n, const GLuint* ids) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteTransformFeedbacks, "glDeleteTransformFeedbacks")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteTransformFeedbacks, "glDeleteTransformFeedbacks");
+        glContext->hooks->gl.glDeleteTransformFeedbacks(n, ids);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteTransformFeedbacks);
 
     // copy argument n
@@ -9818,9 +11200,15 @@ void GLTrace_glDeleteTransformFeedbacks(GLsizei n, const GLuint* ids) {
 }
 
 void GLTrace_glGenTransformFeedbacks(GLsizei n, GLuint* ids) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenTransformFeedbacks, "glGenTransformFeedbacks")) {
+        GLCallCounter counter(glContext, GLMessage::glGenTransformFeedbacks, "glGenTransformFeedbacks");
+        glContext->hooks->gl.glGenTransformFeedbacks(n, ids);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenTransformFeedbacks);
 
     // copy argument n
@@ -9853,9 +11241,14 @@ void GLTrace_glGenTransformFeedbacks(GLsizei n, GLuint* ids) {
 }
 
 GLboolean GLTrace_glIsTransformFeedback(GLuint id) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsTransformFeedback, "glIsTransformFeedback")) {
+        GLCallCounter counter(glContext, GLMessage::glIsTransformFeedback, "glIsTransformFeedback");
+        return glContext->hooks->gl.glIsTransformFeedback(id);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsTransformFeedback);
 
     // copy argument id
@@ -9889,9 +11282,15 @@ GLboolean GLTrace_glIsTransformFeedback(GLuint id) {
 }
 
 void GLTrace_glPauseTransformFeedback(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPauseTransformFeedback, "glPauseTransformFeedback")) {
+        GLCallCounter counter(glContext, GLMessage::glPauseTransformFeedback, "glPauseTransformFeedback");
+        glContext->hooks->gl.glPauseTransformFeedback();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPauseTransformFeedback);
 
     // call function
@@ -9911,9 +11310,15 @@ void GLTrace_glPauseTransformFeedback(void) {
 }
 
 void GLTrace_glResumeTransformFeedback(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glResumeTransformFeedback, "glResumeTransformFeedback")) {
+        GLCallCounter counter(glContext, GLMessage::glResumeTransformFeedback, "glResumeTransformFeedback");
+        glContext->hooks->gl.glResumeTransformFeedback();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glResumeTransformFeedback);
 
     // call function
@@ -9933,9 +11338,15 @@ void GLTrace_glResumeTransformFeedback(void) {
 }
 
 void GLTrace_glGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, GLvoid* binary) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetProgramBinary, "glGetProgramBinary")) {
+        GLCallCounter counter(glContext, GLMessage::glGetProgramBinary, "glGetProgramBinary");
+        glContext->hooks->gl.glGetProgramBinary(program, bufSize, length, binaryFormat, binary);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetProgramBinary);
 
     // copy argument program
@@ -9988,9 +11399,15 @@ void GLTrace_glGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length
 }
 
 void GLTrace_glProgramBinary(GLuint program, GLenum binaryFormat, const GLvoid* binary, GLsizei length) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramBinary, "glProgramBinary")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramBinary, "glProgramBinary");
+        glContext->hooks->gl.glProgramBinary(program, binaryFormat, binary, length);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramBinary);
 
     // copy argument program
@@ -10035,9 +11452,15 @@ void GLTrace_glProgramBinary(GLuint program, GLenum binaryFormat, const GLvoid*
 }
 
 void GLTrace_glProgramParameteri(GLuint program, GLenum pname, GLint value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramParameteri, "glProgramParameteri")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramParameteri, "glProgramParameteri");
+        glContext->hooks->gl.glProgramParameteri(program, pname, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramParameteri);
 
     // copy argument program
@@ -10075,9 +11498,15 @@ void GLTrace_glProgramParameteri(GLuint program, GLenum pname, GLint value) {
 }
 
 void GLTrace_glInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum* attachments) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glInvalidateFramebuffer, "glInvalidateFramebuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glInvalidateFramebuffer, "glInvalidateFramebuffer");
+        glContext->hooks->gl.glInvalidateFramebuffer(target, numAttachments, attachments);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glInvalidateFramebuffer);
 
     // copy argument target
@@ -10116,9 +11545,15 @@ void GLTrace_glInvalidateFramebuffer(GLenum target, GLsizei numAttachments, cons
 }
 
 void GLTrace_glInvalidateSubFramebuffer(GLenum target, GLsizei numAttachments, const GLenum* attachments, GLint x, GLint y, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glInvalidateSubFramebuffer, "glInvalidateSubFramebuffer")) {
+        GLCallCounter counter(glContext, GLMessage::glInvalidateSubFramebuffer, "glInvalidateSubFramebuffer");
+        glContext->hooks->gl.glInvalidateSubFramebuffer(target, numAttachments, attachments, x, y, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glInvalidateSubFramebuffer);
 
     // copy argument target
@@ -10181,9 +11616,15 @@ void GLTrace_glInvalidateSubFramebuffer(GLenum target, GLsizei numAttachments, c
 }
 
 void GLTrace_glTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexStorage2D, "glTexStorage2D")) {
+        GLCallCounter counter(glContext, GLMessage::glTexStorage2D, "glTexStorage2D");
+        glContext->hooks->gl.glTexStorage2D(target, levels, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexStorage2D);
 
     // copy argument target
@@ -10233,9 +11674,15 @@ void GLTrace_glTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat
 }
 
 void GLTrace_glTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexStorage3D, "glTexStorage3D")) {
+        GLCallCounter counter(glContext, GLMessage::glTexStorage3D, "glTexStorage3D");
+        glContext->hooks->gl.glTexStorage3D(target, levels, internalformat, width, height, depth);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexStorage3D);
 
     // copy argument target
@@ -10291,9 +11738,15 @@ void GLTrace_glTexStorage3D(GLenum target, GLsizei levels, GLenum internalformat
 }
 
 void GLTrace_glGetInternalformativ(GLenum target, GLenum internalformat, GLenum pname, GLsizei bufSize, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetInternalformativ, "glGetInternalformativ")) {
+        GLCallCounter counter(glContext, GLMessage::glGetInternalformativ, "glGetInternalformativ");
+        glContext->hooks->gl.glGetInternalformativ(target, internalformat, pname, bufSize, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetInternalformativ);
 
     // copy argument target
@@ -10347,9 +11800,15 @@ void GLTrace_glGetInternalformativ(GLenum target, GLenum internalformat, GLenum
 // Definitions for GL2Ext APIs
 
 void GLTrace_glEGLImageTargetTexture2DOES(GLenum target, GLeglImageOES image) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEGLImageTargetTexture2DOES, "glEGLImageTargetTexture2DOES")) {
+        GLCallCounter counter(glContext, GLMessage::glEGLImageTargetTexture2DOES, "glEGLImageTargetTexture2DOES");
+        glContext->hooks->gl.glEGLImageTargetTexture2DOES(target, image);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEGLImageTargetTexture2DOES);
 
     // copy argument target
@@ -10382,9 +11841,15 @@ void GLTrace_glEGLImageTargetTexture2DOES(GLenum target, GLeglImageOES image) {
 }
 
 void GLTrace_glEGLImageTargetRenderbufferStorageOES(GLenum target, GLeglImageOES image) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEGLImageTargetRenderbufferStorageOES, "glEGLImageTargetRenderbufferStorageOES")) {
+        GLCallCounter counter(glContext, GLMessage::glEGLImageTargetRenderbufferStorageOES, "glEGLImageTargetRenderbufferStorageOES");
+        glContext->hooks->gl.glEGLImageTargetRenderbufferStorageOES(target, image);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEGLImageTargetRenderbufferStorageOES);
 
     // copy argument target
@@ -10417,9 +11882,15 @@ void GLTrace_glEGLImageTargetRenderbufferStorageOES(GLenum target, GLeglImageOES
 }
 
 void GLTrace_glGetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetProgramBinaryOES, "glGetProgramBinaryOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetProgramBinaryOES, "glGetProgramBinaryOES");
+        glContext->hooks->gl.glGetProgramBinaryOES(program, bufSize, length, binaryFormat, binary);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetProgramBinaryOES);
 
     // copy argument program
@@ -10472,9 +11943,15 @@ void GLTrace_glGetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei *len
 }
 
 void GLTrace_glProgramBinaryOES(GLuint program, GLenum binaryFormat, const GLvoid *binary, GLint length) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramBinaryOES, "glProgramBinaryOES")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramBinaryOES, "glProgramBinaryOES");
+        glContext->hooks->gl.glProgramBinaryOES(program, binaryFormat, binary, length);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramBinaryOES);
 
     // copy argument program
@@ -10519,9 +11996,14 @@ void GLTrace_glProgramBinaryOES(GLuint program, GLenum binaryFormat, const GLvoi
 }
 
 void* GLTrace_glMapBufferOES(GLenum target, GLenum access) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMapBufferOES, "glMapBufferOES")) {
+        GLCallCounter counter(glContext, GLMessage::glMapBufferOES, "glMapBufferOES");
+        return glContext->hooks->gl.glMapBufferOES(target, access);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMapBufferOES);
 
     // copy argument target
@@ -10562,9 +12044,14 @@ void* GLTrace_glMapBufferOES(GLenum target, GLenum access) {
 }
 
 GLboolean GLTrace_glUnmapBufferOES(GLenum target) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUnmapBufferOES, "glUnmapBufferOES")) {
+        GLCallCounter counter(glContext, GLMessage::glUnmapBufferOES, "glUnmapBufferOES");
+        return glContext->hooks->gl.glUnmapBufferOES(target);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUnmapBufferOES);
 
     // copy argument target
@@ -10598,9 +12085,15 @@ GLboolean GLTrace_glUnmapBufferOES(GLenum target) {
 }
 
 void GLTrace_glGetBufferPointervOES(GLenum target, GLenum pname, GLvoid** params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetBufferPointervOES, "glGetBufferPointervOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetBufferPointervOES, "glGetBufferPointervOES");
+        glContext->hooks->gl.glGetBufferPointervOES(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetBufferPointervOES);
 
     // copy argument target
@@ -10639,9 +12132,15 @@ void GLTrace_glGetBufferPointervOES(GLenum target, GLenum pname, GLvoid** params
 }
 
 void GLTrace_glTexImage3DOES(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexImage3DOES, "glTexImage3DOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexImage3DOES, "glTexImage3DOES");
+        glContext->hooks->gl.glTexImage3DOES(target, level, internalformat, width, height, depth, border, format, type, pixels);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexImage3DOES);
 
     // copy argument target
@@ -10722,9 +12221,15 @@ void GLTrace_glTexImage3DOES(GLenum target, GLint level, GLenum internalformat,
 }
 
 void GLTrace_glTexSubImage3DOES(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const GLvoid* pixels) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexSubImage3DOES, "glTexSubImage3DOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexSubImage3DOES, "glTexSubImage3DOES");
+        glContext->hooks->gl.glTexSubImage3DOES(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexSubImage3DOES);
 
     // copy argument target
@@ -10811,9 +12316,15 @@ void GLTrace_glTexSubImage3DOES(GLenum target, GLint level, GLint xoffset, GLint
 }
 
 void GLTrace_glCopyTexSubImage3DOES(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLint x, GLint y, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCopyTexSubImage3DOES, "glCopyTexSubImage3DOES")) {
+        GLCallCounter counter(glContext, GLMessage::glCopyTexSubImage3DOES, "glCopyTexSubImage3DOES");
+        glContext->hooks->gl.glCopyTexSubImage3DOES(target, level, xoffset, yoffset, zoffset, x, y, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCopyTexSubImage3DOES);
 
     // copy argument target
@@ -10887,9 +12398,15 @@ void GLTrace_glCopyTexSubImage3DOES(GLenum target, GLint level, GLint xoffset, G
 }
 
 void GLTrace_glCompressedTexImage3DOES(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const GLvoid* data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCompressedTexImage3DOES, "glCompressedTexImage3DOES")) {
+        GLCallCounter counter(glContext, GLMessage::glCompressedTexImage3DOES, "glCompressedTexImage3DOES");
+        glContext->hooks->gl.glCompressedTexImage3DOES(target, level, internalformat, width, height, depth, border, imageSize, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCompressedTexImage3DOES);
 
     // copy argument target
@@ -10964,9 +12481,15 @@ void GLTrace_glCompressedTexImage3DOES(GLenum target, GLint level, GLenum intern
 }
 
 void GLTrace_glCompressedTexSubImage3DOES(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const GLvoid* data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCompressedTexSubImage3DOES, "glCompressedTexSubImage3DOES")) {
+        GLCallCounter counter(glContext, GLMessage::glCompressedTexSubImage3DOES, "glCompressedTexSubImage3DOES");
+        glContext->hooks->gl.glCompressedTexSubImage3DOES(target, level, xoffset, yoffset, zoffset, width, height, depth, format, imageSize, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCompressedTexSubImage3DOES);
 
     // copy argument target
@@ -11053,9 +12576,15 @@ void GLTrace_glCompressedTexSubImage3DOES(GLenum target, GLint level, GLint xoff
 }
 
 void GLTrace_glFramebufferTexture3DOES(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLint zoffset) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFramebufferTexture3DOES, "glFramebufferTexture3DOES")) {
+        GLCallCounter counter(glContext, GLMessage::glFramebufferTexture3DOES, "glFramebufferTexture3DOES");
+        glContext->hooks->gl.glFramebufferTexture3DOES(target, attachment, textarget, texture, level, zoffset);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFramebufferTexture3DOES);
 
     // copy argument target
@@ -11111,9 +12640,15 @@ void GLTrace_glFramebufferTexture3DOES(GLenum target, GLenum attachment, GLenum
 }
 
 void GLTrace_glBindVertexArrayOES(GLuint array) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindVertexArrayOES, "glBindVertexArrayOES")) {
+        GLCallCounter counter(glContext, GLMessage::glBindVertexArrayOES, "glBindVertexArrayOES");
+        glContext->hooks->gl.glBindVertexArrayOES(array);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindVertexArrayOES);
 
     // copy argument array
@@ -11139,9 +12674,15 @@ void GLTrace_glBindVertexArrayOES(GLuint array) {
 }
 
 void GLTrace_glDeleteVertexArraysOES(GLsizei n, const GLuint *arrays) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteVertexArraysOES, "glDeleteVertexArraysOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteVertexArraysOES, "glDeleteVertexArraysOES");
+        glContext->hooks->gl.glDeleteVertexArraysOES(n, arrays);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteVertexArraysOES);
 
     // copy argument n
@@ -11174,9 +12715,15 @@ void GLTrace_glDeleteVertexArraysOES(GLsizei n, const GLuint *arrays) {
 }
 
 void GLTrace_glGenVertexArraysOES(GLsizei n, GLuint *arrays) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenVertexArraysOES, "glGenVertexArraysOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGenVertexArraysOES, "glGenVertexArraysOES");
+        glContext->hooks->gl.glGenVertexArraysOES(n, arrays);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenVertexArraysOES);
 
     // copy argument n
@@ -11209,9 +12756,14 @@ void GLTrace_glGenVertexArraysOES(GLsizei n, GLuint *arrays) {
 }
 
 GLboolean GLTrace_glIsVertexArrayOES(GLuint array) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsVertexArrayOES, "glIsVertexArrayOES")) {
+        GLCallCounter counter(glContext, GLMessage::glIsVertexArrayOES, "glIsVertexArrayOES");
+        return glContext->hooks->gl.glIsVertexArrayOES(array);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsVertexArrayOES);
 
     // copy argument array
@@ -11245,9 +12797,15 @@ GLboolean GLTrace_glIsVertexArrayOES(GLuint array) {
 }
 
 void GLTrace_glGetPerfMonitorGroupsAMD(GLint *numGroups, GLsizei groupsSize, GLuint *groups) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetPerfMonitorGroupsAMD, "glGetPerfMonitorGroupsAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glGetPerfMonitorGroupsAMD, "glGetPerfMonitorGroupsAMD");
+        glContext->hooks->gl.glGetPerfMonitorGroupsAMD(numGroups, groupsSize, groups);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetPerfMonitorGroupsAMD);
 
     // copy argument numGroups
@@ -11287,9 +12845,15 @@ void GLTrace_glGetPerfMonitorGroupsAMD(GLint *numGroups, GLsizei groupsSize, GLu
 }
 
 void GLTrace_glGetPerfMonitorCountersAMD(GLuint group, GLint *numCounters, GLint *maxActiveCounters, GLsizei counterSize, GLuint *counters) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetPerfMonitorCountersAMD, "glGetPerfMonitorCountersAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glGetPerfMonitorCountersAMD, "glGetPerfMonitorCountersAMD");
+        glContext->hooks->gl.glGetPerfMonitorCountersAMD(group, numCounters, maxActiveCounters, counterSize, counters);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetPerfMonitorCountersAMD);
 
     // copy argument group
@@ -11342,9 +12906,15 @@ void GLTrace_glGetPerfMonitorCountersAMD(GLuint group, GLint *numCounters, GLint
 }
 
 void GLTrace_glGetPerfMonitorGroupStringAMD(GLuint group, GLsizei bufSize, GLsizei *length, GLchar *groupString) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetPerfMonitorGroupStringAMD, "glGetPerfMonitorGroupStringAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glGetPerfMonitorGroupStringAMD, "glGetPerfMonitorGroupStringAMD");
+        glContext->hooks->gl.glGetPerfMonitorGroupStringAMD(group, bufSize, length, groupString);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetPerfMonitorGroupStringAMD);
 
     // copy argument group
@@ -11390,9 +12960,15 @@ void GLTrace_glGetPerfMonitorGroupStringAMD(GLuint group, GLsizei bufSize, GLsiz
 }
 
 void GLTrace_glGetPerfMonitorCounterStringAMD(GLuint group, GLuint counter, GLsizei bufSize, GLsizei *length, GLchar *counterString) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetPerfMonitorCounterStringAMD, "glGetPerfMonitorCounterStringAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glGetPerfMonitorCounterStringAMD, "glGetPerfMonitorCounterStringAMD");
+        glContext->hooks->gl.glGetPerfMonitorCounterStringAMD(group, counter, bufSize, length, counterString);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetPerfMonitorCounterStringAMD);
 
     // copy argument group
@@ -11444,9 +13020,15 @@ void GLTrace_glGetPerfMonitorCounterStringAMD(GLuint group, GLuint counter, GLsi
 }
 
 void GLTrace_glGetPerfMonitorCounterInfoAMD(GLuint group, GLuint counter, GLenum pname, GLvoid *data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetPerfMonitorCounterInfoAMD, "glGetPerfMonitorCounterInfoAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glGetPerfMonitorCounterInfoAMD, "glGetPerfMonitorCounterInfoAMD");
+        glContext->hooks->gl.glGetPerfMonitorCounterInfoAMD(group, counter, pname, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetPerfMonitorCounterInfoAMD);
 
     // copy argument group
@@ -11491,9 +13073,15 @@ void GLTrace_glGetPerfMonitorCounterInfoAMD(GLuint group, GLuint counter, GLenum
 }
 
 void GLTrace_glGenPerfMonitorsAMD(GLsizei n, GLuint *monitors) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenPerfMonitorsAMD, "glGenPerfMonitorsAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glGenPerfMonitorsAMD, "glGenPerfMonitorsAMD");
+        glContext->hooks->gl.glGenPerfMonitorsAMD(n, monitors);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenPerfMonitorsAMD);
 
     // copy argument n
@@ -11526,9 +13114,15 @@ void GLTrace_glGenPerfMonitorsAMD(GLsizei n, GLuint *monitors) {
 }
 
 void GLTrace_glDeletePerfMonitorsAMD(GLsizei n, GLuint *monitors) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeletePerfMonitorsAMD, "glDeletePerfMonitorsAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glDeletePerfMonitorsAMD, "glDeletePerfMonitorsAMD");
+        glContext->hooks->gl.glDeletePerfMonitorsAMD(n, monitors);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeletePerfMonitorsAMD);
 
     // copy argument n
@@ -11561,9 +13155,15 @@ void GLTrace_glDeletePerfMonitorsAMD(GLsizei n, GLuint *monitors) {
 }
 
 void GLTrace_glSelectPerfMonitorCountersAMD(GLuint monitor, GLboolean enable, GLuint group, GLint numCounters, GLuint *countersList) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glSelectPerfMonitorCountersAMD, "glSelectPerfMonitorCountersAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glSelectPerfMonitorCountersAMD, "glSelectPerfMonitorCountersAMD");
+        glContext->hooks->gl.glSelectPerfMonitorCountersAMD(monitor, enable, group, numCounters, countersList);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glSelectPerfMonitorCountersAMD);
 
     // copy argument monitor
@@ -11614,9 +13214,15 @@ void GLTrace_glSelectPerfMonitorCountersAMD(GLuint monitor, GLboolean enable, GL
 }
 
 void GLTrace_glBeginPerfMonitorAMD(GLuint monitor) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBeginPerfMonitorAMD, "glBeginPerfMonitorAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glBeginPerfMonitorAMD, "glBeginPerfMonitorAMD");
+        glContext->hooks->gl.glBeginPerfMonitorAMD(monitor);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBeginPerfMonitorAMD);
 
     // copy argument monitor
@@ -11642,9 +13248,15 @@ void GLTrace_glBeginPerfMonitorAMD(GLuint monitor) {
 }
 
 void GLTrace_glEndPerfMonitorAMD(GLuint monitor) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEndPerfMonitorAMD, "glEndPerfMonitorAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glEndPerfMonitorAMD, "glEndPerfMonitorAMD");
+        glContext->hooks->gl.glEndPerfMonitorAMD(monitor);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEndPerfMonitorAMD);
 
     // copy argument monitor
@@ -11670,9 +13282,15 @@ void GLTrace_glEndPerfMonitorAMD(GLuint monitor) {
 }
 
 void GLTrace_glGetPerfMonitorCounterDataAMD(GLuint monitor, GLenum pname, GLsizei dataSize, GLuint *data, GLint *bytesWritten) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetPerfMonitorCounterDataAMD, "glGetPerfMonitorCounterDataAMD")) {
+        GLCallCounter counter(glContext, GLMessage::glGetPerfMonitorCounterDataAMD, "glGetPerfMonitorCounterDataAMD");
+        glContext->hooks->gl.glGetPerfMonitorCounterDataAMD(monitor, pname, dataSize, data, bytesWritten);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetPerfMonitorCounterDataAMD);
 
     // copy argument monitor
@@ -11724,9 +13342,15 @@ void GLTrace_glGetPerfMonitorCounterDataAMD(GLuint monitor, GLenum pname, GLsize
 }
 
 void GLTrace_glBlitFramebufferANGLE(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlitFramebufferANGLE, "glBlitFramebufferANGLE")) {
+        GLCallCounter counter(glContext, GLMessage::glBlitFramebufferANGLE, "glBlitFramebufferANGLE");
+        glContext->hooks->gl.glBlitFramebufferANGLE(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlitFramebufferANGLE);
 
     // copy argument srcX0
@@ -11806,9 +13430,15 @@ void GLTrace_glBlitFramebufferANGLE(GLint srcX0, GLint srcY0, GLint srcX1, GLint
 }
 
 void GLTrace_glRenderbufferStorageMultisampleANGLE(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRenderbufferStorageMultisampleANGLE, "glRenderbufferStorageMultisampleANGLE")) {
+        GLCallCounter counter(glContext, GLMessage::glRenderbufferStorageMultisampleANGLE, "glRenderbufferStorageMultisampleANGLE");
+        glContext->hooks->gl.glRenderbufferStorageMultisampleANGLE(target, samples, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRenderbufferStorageMultisampleANGLE);
 
     // copy argument target
@@ -11858,9 +13488,15 @@ void GLTrace_glRenderbufferStorageMultisampleANGLE(GLenum target, GLsizei sample
 }
 
 void GLTrace_glRenderbufferStorageMultisampleAPPLE(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRenderbufferStorageMultisampleAPPLE, "glRenderbufferStorageMultisampleAPPLE")) {
+        GLCallCounter counter(glContext, GLMessage::glRenderbufferStorageMultisampleAPPLE, "glRenderbufferStorageMultisampleAPPLE");
+        glContext->hooks->gl.glRenderbufferStorageMultisampleAPPLE(target, samples, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRenderbufferStorageMultisampleAPPLE);
 
     // copy argument target
@@ -11910,9 +13546,15 @@ void GLTrace_glRenderbufferStorageMultisampleAPPLE(GLenum target, GLsizei sample
 }
 
 void GLTrace_glResolveMultisampleFramebufferAPPLE(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glResolveMultisampleFramebufferAPPLE, "glResolveMultisampleFramebufferAPPLE")) {
+        GLCallCounter counter(glContext, GLMessage::glResolveMultisampleFramebufferAPPLE, "glResolveMultisampleFramebufferAPPLE");
+        glContext->hooks->gl.glResolveMultisampleFramebufferAPPLE();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glResolveMultisampleFramebufferAPPLE);
 
     // call function
@@ -11932,9 +13574,15 @@ void GLTrace_glResolveMultisampleFramebufferAPPLE(void) {
 }
 
 void GLTrace_glLabelObjectEXT(GLenum type, GLuint object, GLsizei length, const GLchar *label) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLabelObjectEXT, "glLabelObjectEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glLabelObjectEXT, "glLabelObjectEXT");
+        glContext->hooks->gl.glLabelObjectEXT(type, object, length, label);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLabelObjectEXT);
 
     // copy argument type
@@ -11979,9 +13627,15 @@ void GLTrace_glLabelObjectEXT(GLenum type, GLuint object, GLsizei length, const
 }
 
 void GLTrace_glGetObjectLabelEXT(GLenum type, GLuint object, GLsizei bufSize, GLsizei *length, GLchar *label) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetObjectLabelEXT, "glGetObjectLabelEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGetObjectLabelEXT, "glGetObjectLabelEXT");
+        glContext->hooks->gl.glGetObjectLabelEXT(type, object, bufSize, length, label);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetObjectLabelEXT);
 
     // copy argument type
@@ -12033,9 +13687,15 @@ void GLTrace_glGetObjectLabelEXT(GLenum type, GLuint object, GLsizei bufSize, GL
 }
 
 void GLTrace_glInsertEventMarkerEXT(GLsizei length, const GLchar *marker) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glInsertEventMarkerEXT, "glInsertEventMarkerEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glInsertEventMarkerEXT, "glInsertEventMarkerEXT");
+        glContext->hooks->gl.glInsertEventMarkerEXT(length, marker);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glInsertEventMarkerEXT);
 
     // copy argument length
@@ -12068,9 +13728,15 @@ void GLTrace_glInsertEventMarkerEXT(GLsizei length, const GLchar *marker) {
 }
 
 void GLTrace_glPushGroupMarkerEXT(GLsizei length, const GLchar *marker) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPushGroupMarkerEXT, "glPushGroupMarkerEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glPushGroupMarkerEXT, "glPushGroupMarkerEXT");
+        glContext->hooks->gl.glPushGroupMarkerEXT(length, marker);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPushGroupMarkerEXT);
 
     // copy argument length
@@ -12103,9 +13769,15 @@ void GLTrace_glPushGroupMarkerEXT(GLsizei length, const GLchar *marker) {
 }
 
 void GLTrace_glPopGroupMarkerEXT(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPopGroupMarkerEXT, "glPopGroupMarkerEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glPopGroupMarkerEXT, "glPopGroupMarkerEXT");
+        glContext->hooks->gl.glPopGroupMarkerEXT();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPopGroupMarkerEXT);
 
     // call function
@@ -12125,9 +13797,15 @@ void GLTrace_glPopGroupMarkerEXT(void) {
 }
 
 void GLTrace_glDiscardFramebufferEXT(GLenum target, GLsizei numAttachments, const GLenum *attachments) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDiscardFramebufferEXT, "glDiscardFramebufferEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glDiscardFramebufferEXT, "glDiscardFramebufferEXT");
+        glContext->hooks->gl.glDiscardFramebufferEXT(target, numAttachments, attachments);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDiscardFramebufferEXT);
 
     // copy argument target
@@ -12166,9 +13844,15 @@ void GLTrace_glDiscardFramebufferEXT(GLenum target, GLsizei numAttachments, cons
 }
 
 void GLTrace_glRenderbufferStorageMultisampleEXT(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRenderbufferStorageMultisampleEXT, "glRenderbufferStorageMultisampleEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glRenderbufferStorageMultisampleEXT, "glRenderbufferStorageMultisampleEXT");
+        glContext->hooks->gl.glRenderbufferStorageMultisampleEXT(target, samples, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRenderbufferStorageMultisampleEXT);
 
     // copy argument target
@@ -12218,9 +13902,15 @@ void GLTrace_glRenderbufferStorageMultisampleEXT(GLenum target, GLsizei samples,
 }
 
 void GLTrace_glFramebufferTexture2DMultisampleEXT(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFramebufferTexture2DMultisampleEXT, "glFramebufferTexture2DMultisampleEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glFramebufferTexture2DMultisampleEXT, "glFramebufferTexture2DMultisampleEXT");
+        glContext->hooks->gl.glFramebufferTexture2DMultisampleEXT(target, attachment, textarget, texture, level, samples);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFramebufferTexture2DMultisampleEXT);
 
     // copy argument target
@@ -12276,9 +13966,15 @@ void GLTrace_glFramebufferTexture2DMultisampleEXT(GLenum target, GLenum attachme
 }
 
 void GLTrace_glMultiDrawArraysEXT(GLenum mode, GLint *first, GLsizei *count, GLsizei primcount) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMultiDrawArraysEXT, "glMultiDrawArraysEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glMultiDrawArraysEXT, "glMultiDrawArraysEXT");
+        glContext->hooks->gl.glMultiDrawArraysEXT(mode, first, count, primcount);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMultiDrawArraysEXT);
 
     // copy argument mode
@@ -12324,9 +14020,15 @@ void GLTrace_glMultiDrawArraysEXT(GLenum mode, GLint *first, GLsizei *count, GLs
 }
 
 void GLTrace_glMultiDrawElementsEXT(GLenum mode, const GLsizei *count, GLenum type, const GLvoid* *indices, GLsizei primcount) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMultiDrawElementsEXT, "glMultiDrawElementsEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glMultiDrawElementsEXT, "glMultiDrawElementsEXT");
+        glContext->hooks->gl.glMultiDrawElementsEXT(mode, count, type, indices, primcount);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMultiDrawElementsEXT);
 
     // copy argument mode
@@ -12378,9 +14080,15 @@ void GLTrace_glMultiDrawElementsEXT(GLenum mode, const GLsizei *count, GLenum ty
 }
 
 void GLTrace_glGenQueriesEXT(GLsizei n, GLuint *ids) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenQueriesEXT, "glGenQueriesEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGenQueriesEXT, "glGenQueriesEXT");
+        glContext->hooks->gl.glGenQueriesEXT(n, ids);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenQueriesEXT);
 
     // copy argument n
@@ -12413,9 +14121,15 @@ void GLTrace_glGenQueriesEXT(GLsizei n, GLuint *ids) {
 }
 
 void GLTrace_glDeleteQueriesEXT(GLsizei n, const GLuint *ids) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteQueriesEXT, "glDeleteQueriesEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteQueriesEXT, "glDeleteQueriesEXT");
+        glContext->hooks->gl.glDeleteQueriesEXT(n, ids);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteQueriesEXT);
 
     // copy argument n
@@ -12448,9 +14162,14 @@ void GLTrace_glDeleteQueriesEXT(GLsizei n, const GLuint *ids) {
 }
 
 GLboolean GLTrace_glIsQueryEXT(GLuint id) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsQueryEXT, "glIsQueryEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glIsQueryEXT, "glIsQueryEXT");
+        return glContext->hooks->gl.glIsQueryEXT(id);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsQueryEXT);
 
     // copy argument id
@@ -12484,9 +14203,15 @@ GLboolean GLTrace_glIsQueryEXT(GLuint id) {
 }
 
 void GLTrace_glBeginQueryEXT(GLenum target, GLuint id) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBeginQueryEXT, "glBeginQueryEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glBeginQueryEXT, "glBeginQueryEXT");
+        glContext->hooks->gl.glBeginQueryEXT(target, id);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBeginQueryEXT);
 
     // copy argument target
@@ -12518,9 +14243,15 @@ void GLTrace_glBeginQueryEXT(GLenum target, GLuint id) {
 }
 
 void GLTrace_glEndQueryEXT(GLenum target) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEndQueryEXT, "glEndQueryEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glEndQueryEXT, "glEndQueryEXT");
+        glContext->hooks->gl.glEndQueryEXT(target);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEndQueryEXT);
 
     // copy argument target
@@ -12546,9 +14277,15 @@ void GLTrace_glEndQueryEXT(GLenum target) {
 }
 
 void GLTrace_glGetQueryivEXT(GLenum target, GLenum pname, GLint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetQueryivEXT, "glGetQueryivEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGetQueryivEXT, "glGetQueryivEXT");
+        glContext->hooks->gl.glGetQueryivEXT(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetQueryivEXT);
 
     // copy argument target
@@ -12587,9 +14324,15 @@ void GLTrace_glGetQueryivEXT(GLenum target, GLenum pname, GLint *params) {
 }
 
 void GLTrace_glGetQueryObjectuivEXT(GLuint id, GLenum pname, GLuint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetQueryObjectuivEXT, "glGetQueryObjectuivEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGetQueryObjectuivEXT, "glGetQueryObjectuivEXT");
+        glContext->hooks->gl.glGetQueryObjectuivEXT(id, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetQueryObjectuivEXT);
 
     // copy argument id
@@ -12628,9 +14371,14 @@ void GLTrace_glGetQueryObjectuivEXT(GLuint id, GLenum pname, GLuint *params) {
 }
 
 GLenum GLTrace_glGetGraphicsResetStatusEXT(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetGraphicsResetStatusEXT, "glGetGraphicsResetStatusEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGetGraphicsResetStatusEXT, "glGetGraphicsResetStatusEXT");
+        return glContext->hooks->gl.glGetGraphicsResetStatusEXT();
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetGraphicsResetStatusEXT);
 
     // call function
@@ -12658,9 +14406,15 @@ GLenum GLTrace_glGetGraphicsResetStatusEXT(void) {
 }
 
 void GLTrace_glReadnPixelsEXT(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLsizei bufSize, void *data) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glReadnPixelsEXT, "glReadnPixelsEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glReadnPixelsEXT, "glReadnPixelsEXT");
+        glContext->hooks->gl.glReadnPixelsEXT(x, y, width, height, format, type, bufSize, data);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glReadnPixelsEXT);
 
     // copy argument x
@@ -12729,9 +14483,15 @@ void GLTrace_glReadnPixelsEXT(GLint x, GLint y, GLsizei width, GLsizei height, G
 }
 
 void GLTrace_glGetnUniformfvEXT(GLuint program, GLint location, GLsizei bufSize, float *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetnUniformfvEXT, "glGetnUniformfvEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGetnUniformfvEXT, "glGetnUniformfvEXT");
+        glContext->hooks->gl.glGetnUniformfvEXT(program, location, bufSize, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetnUniformfvEXT);
 
     // copy argument program
@@ -12776,9 +14536,15 @@ void GLTrace_glGetnUniformfvEXT(GLuint program, GLint location, GLsizei bufSize,
 }
 
 void GLTrace_glGetnUniformivEXT(GLuint program, GLint location, GLsizei bufSize, GLint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetnUniformivEXT, "glGetnUniformivEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGetnUniformivEXT, "glGetnUniformivEXT");
+        glContext->hooks->gl.glGetnUniformivEXT(program, location, bufSize, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetnUniformivEXT);
 
     // copy argument program
@@ -12823,9 +14589,15 @@ void GLTrace_glGetnUniformivEXT(GLuint program, GLint location, GLsizei bufSize,
 }
 
 void GLTrace_glUseProgramStagesEXT(GLuint pipeline, GLbitfield stages, GLuint program) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glUseProgramStagesEXT, "glUseProgramStagesEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glUseProgramStagesEXT, "glUseProgramStagesEXT");
+        glContext->hooks->gl.glUseProgramStagesEXT(pipeline, stages, program);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glUseProgramStagesEXT);
 
     // copy argument pipeline
@@ -12863,9 +14635,15 @@ void GLTrace_glUseProgramStagesEXT(GLuint pipeline, GLbitfield stages, GLuint pr
 }
 
 void GLTrace_glActiveShaderProgramEXT(GLuint pipeline, GLuint program) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glActiveShaderProgramEXT, "glActiveShaderProgramEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glActiveShaderProgramEXT, "glActiveShaderProgramEXT");
+        glContext->hooks->gl.glActiveShaderProgramEXT(pipeline, program);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glActiveShaderProgramEXT);
 
     // copy argument pipeline
@@ -12897,9 +14675,14 @@ void GLTrace_glActiveShaderProgramEXT(GLuint pipeline, GLuint program) {
 }
 
 GLuint GLTrace_glCreateShaderProgramvEXT(GLenum type, GLsizei count, const GLchar **strings) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCreateShaderProgramvEXT, "glCreateShaderProgramvEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glCreateShaderProgramvEXT, "glCreateShaderProgramvEXT");
+        return glContext->hooks->gl.glCreateShaderProgramvEXT(type, count, strings);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCreateShaderProgramvEXT);
 
     // copy argument type
@@ -12946,9 +14729,15 @@ GLuint GLTrace_glCreateShaderProgramvEXT(GLenum type, GLsizei count, const GLcha
 }
 
 void GLTrace_glBindProgramPipelineEXT(GLuint pipeline) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindProgramPipelineEXT, "glBindProgramPipelineEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glBindProgramPipelineEXT, "glBindProgramPipelineEXT");
+        glContext->hooks->gl.glBindProgramPipelineEXT(pipeline);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindProgramPipelineEXT);
 
     // copy argument pipeline
@@ -12974,9 +14763,15 @@ void GLTrace_glBindProgramPipelineEXT(GLuint pipeline) {
 }
 
 void GLTrace_glDeleteProgramPipelinesEXT(GLsizei n, const GLuint *pipelines) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteProgramPipelinesEXT, "glDeleteProgramPipelinesEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteProgramPipelinesEXT, "glDeleteProgramPipelinesEXT");
+        glContext->hooks->gl.glDeleteProgramPipelinesEXT(n, pipelines);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteProgramPipelinesEXT);
 
     // copy argument n
@@ -13009,9 +14804,15 @@ void GLTrace_glDeleteProgramPipelinesEXT(GLsizei n, const GLuint *pipelines) {
 }
 
 void GLTrace_glGenProgramPipelinesEXT(GLsizei n, GLuint *pipelines) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenProgramPipelinesEXT, "glGenProgramPipelinesEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGenProgramPipelinesEXT, "glGenProgramPipelinesEXT");
+        glContext->hooks->gl.glGenProgramPipelinesEXT(n, pipelines);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenProgramPipelinesEXT);
 
     // copy argument n
@@ -13044,9 +14845,14 @@ void GLTrace_glGenProgramPipelinesEXT(GLsizei n, GLuint *pipelines) {
 }
 
 GLboolean GLTrace_glIsProgramPipelineEXT(GLuint pipeline) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsProgramPipelineEXT, "glIsProgramPipelineEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glIsProgramPipelineEXT, "glIsProgramPipelineEXT");
+        return glContext->hooks->gl.glIsProgramPipelineEXT(pipeline);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsProgramPipelineEXT);
 
     // copy argument pipeline
@@ -13080,9 +14886,15 @@ GLboolean GLTrace_glIsProgramPipelineEXT(GLuint pipeline) {
 }
 
 void GLTrace_glProgramParameteriEXT(GLuint program, GLenum pname, GLint value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramParameteriEXT, "glProgramParameteriEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramParameteriEXT, "glProgramParameteriEXT");
+        glContext->hooks->gl.glProgramParameteriEXT(program, pname, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramParameteriEXT);
 
     // copy argument program
@@ -13120,9 +14932,15 @@ void GLTrace_glProgramParameteriEXT(GLuint program, GLenum pname, GLint value) {
 }
 
 void GLTrace_glGetProgramPipelineivEXT(GLuint pipeline, GLenum pname, GLint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetProgramPipelineivEXT, "glGetProgramPipelineivEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGetProgramPipelineivEXT, "glGetProgramPipelineivEXT");
+        glContext->hooks->gl.glGetProgramPipelineivEXT(pipeline, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetProgramPipelineivEXT);
 
     // copy argument pipeline
@@ -13161,9 +14979,15 @@ void GLTrace_glGetProgramPipelineivEXT(GLuint pipeline, GLenum pname, GLint *par
 }
 
 void GLTrace_glProgramUniform1iEXT(GLuint program, GLint location, GLint x) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform1iEXT, "glProgramUniform1iEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform1iEXT, "glProgramUniform1iEXT");
+        glContext->hooks->gl.glProgramUniform1iEXT(program, location, x);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform1iEXT);
 
     // copy argument program
@@ -13201,9 +15025,15 @@ void GLTrace_glProgramUniform1iEXT(GLuint program, GLint location, GLint x) {
 }
 
 void GLTrace_glProgramUniform2iEXT(GLuint program, GLint location, GLint x, GLint y) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform2iEXT, "glProgramUniform2iEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform2iEXT, "glProgramUniform2iEXT");
+        glContext->hooks->gl.glProgramUniform2iEXT(program, location, x, y);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform2iEXT);
 
     // copy argument program
@@ -13247,9 +15077,15 @@ void GLTrace_glProgramUniform2iEXT(GLuint program, GLint location, GLint x, GLin
 }
 
 void GLTrace_glProgramUniform3iEXT(GLuint program, GLint location, GLint x, GLint y, GLint z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform3iEXT, "glProgramUniform3iEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform3iEXT, "glProgramUniform3iEXT");
+        glContext->hooks->gl.glProgramUniform3iEXT(program, location, x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform3iEXT);
 
     // copy argument program
@@ -13299,9 +15135,15 @@ void GLTrace_glProgramUniform3iEXT(GLuint program, GLint location, GLint x, GLin
 }
 
 void GLTrace_glProgramUniform4iEXT(GLuint program, GLint location, GLint x, GLint y, GLint z, GLint w) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform4iEXT, "glProgramUniform4iEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform4iEXT, "glProgramUniform4iEXT");
+        glContext->hooks->gl.glProgramUniform4iEXT(program, location, x, y, z, w);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform4iEXT);
 
     // copy argument program
@@ -13357,9 +15199,15 @@ void GLTrace_glProgramUniform4iEXT(GLuint program, GLint location, GLint x, GLin
 }
 
 void GLTrace_glProgramUniform1fEXT(GLuint program, GLint location, GLfloat x) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform1fEXT, "glProgramUniform1fEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform1fEXT, "glProgramUniform1fEXT");
+        glContext->hooks->gl.glProgramUniform1fEXT(program, location, x);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform1fEXT);
 
     // copy argument program
@@ -13397,9 +15245,15 @@ void GLTrace_glProgramUniform1fEXT(GLuint program, GLint location, GLfloat x) {
 }
 
 void GLTrace_glProgramUniform2fEXT(GLuint program, GLint location, GLfloat x, GLfloat y) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform2fEXT, "glProgramUniform2fEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform2fEXT, "glProgramUniform2fEXT");
+        glContext->hooks->gl.glProgramUniform2fEXT(program, location, x, y);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform2fEXT);
 
     // copy argument program
@@ -13443,9 +15297,15 @@ void GLTrace_glProgramUniform2fEXT(GLuint program, GLint location, GLfloat x, GL
 }
 
 void GLTrace_glProgramUniform3fEXT(GLuint program, GLint location, GLfloat x, GLfloat y, GLfloat z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform3fEXT, "glProgramUniform3fEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform3fEXT, "glProgramUniform3fEXT");
+        glContext->hooks->gl.glProgramUniform3fEXT(program, location, x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform3fEXT);
 
     // copy argument program
@@ -13495,9 +15355,15 @@ void GLTrace_glProgramUniform3fEXT(GLuint program, GLint location, GLfloat x, GL
 }
 
 void GLTrace_glProgramUniform4fEXT(GLuint program, GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform4fEXT, "glProgramUniform4fEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform4fEXT, "glProgramUniform4fEXT");
+        glContext->hooks->gl.glProgramUniform4fEXT(program, location, x, y, z, w);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform4fEXT);
 
     // copy argument program
@@ -13553,9 +15419,15 @@ void GLTrace_glProgramUniform4fEXT(GLuint program, GLint location, GLfloat x, GL
 }
 
 void GLTrace_glProgramUniform1ivEXT(GLuint program, GLint location, GLsizei count, const GLint *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform1ivEXT, "glProgramUniform1ivEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform1ivEXT, "glProgramUniform1ivEXT");
+        glContext->hooks->gl.glProgramUniform1ivEXT(program, location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform1ivEXT);
 
     // copy argument program
@@ -13600,9 +15472,15 @@ void GLTrace_glProgramUniform1ivEXT(GLuint program, GLint location, GLsizei coun
 }
 
 void GLTrace_glProgramUniform2ivEXT(GLuint program, GLint location, GLsizei count, const GLint *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform2ivEXT, "glProgramUniform2ivEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform2ivEXT, "glProgramUniform2ivEXT");
+        glContext->hooks->gl.glProgramUniform2ivEXT(program, location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform2ivEXT);
 
     // copy argument program
@@ -13647,9 +15525,15 @@ void GLTrace_glProgramUniform2ivEXT(GLuint program, GLint location, GLsizei coun
 }
 
 void GLTrace_glProgramUniform3ivEXT(GLuint program, GLint location, GLsizei count, const GLint *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform3ivEXT, "glProgramUniform3ivEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform3ivEXT, "glProgramUniform3ivEXT");
+        glContext->hooks->gl.glProgramUniform3ivEXT(program, location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform3ivEXT);
 
     // copy argument program
@@ -13694,9 +15578,15 @@ void GLTrace_glProgramUniform3ivEXT(GLuint program, GLint location, GLsizei coun
 }
 
 void GLTrace_glProgramUniform4ivEXT(GLuint program, GLint location, GLsizei count, const GLint *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform4ivEXT, "glProgramUniform4ivEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform4ivEXT, "glProgramUniform4ivEXT");
+        glContext->hooks->gl.glProgramUniform4ivEXT(program, location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform4ivEXT);
 
     // copy argument program
@@ -13741,9 +15631,15 @@ void GLTrace_glProgramUniform4ivEXT(GLuint program, GLint location, GLsizei coun
 }
 
 void GLTrace_glProgramUniform1fvEXT(GLuint program, GLint location, GLsizei count, const GLfloat *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform1fvEXT, "glProgramUniform1fvEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform1fvEXT, "glProgramUniform1fvEXT");
+        glContext->hooks->gl.glProgramUniform1fvEXT(program, location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform1fvEXT);
 
     // copy argument program
@@ -13788,9 +15684,15 @@ void GLTrace_glProgramUniform1fvEXT(GLuint program, GLint location, GLsizei coun
 }
 
 void GLTrace_glProgramUniform2fvEXT(GLuint program, GLint location, GLsizei count, const GLfloat *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform2fvEXT, "glProgramUniform2fvEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform2fvEXT, "glProgramUniform2fvEXT");
+        glContext->hooks->gl.glProgramUniform2fvEXT(program, location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform2fvEXT);
 
     // copy argument program
@@ -13835,9 +15737,15 @@ void GLTrace_glProgramUniform2fvEXT(GLuint program, GLint location, GLsizei coun
 }
 
 void GLTrace_glProgramUniform3fvEXT(GLuint program, GLint location, GLsizei count, const GLfloat *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform3fvEXT, "glProgramUniform3fvEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform3fvEXT, "glProgramUniform3fvEXT");
+        glContext->hooks->gl.glProgramUniform3fvEXT(program, location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform3fvEXT);
 
     // copy argument program
@@ -13882,9 +15790,15 @@ void GLTrace_glProgramUniform3fvEXT(GLuint program, GLint location, GLsizei coun
 }
 
 void GLTrace_glProgramUniform4fvEXT(GLuint program, GLint location, GLsizei count, const GLfloat *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniform4fvEXT, "glProgramUniform4fvEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniform4fvEXT, "glProgramUniform4fvEXT");
+        glContext->hooks->gl.glProgramUniform4fvEXT(program, location, count, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniform4fvEXT);
 
     // copy argument program
@@ -13929,9 +15843,15 @@ void GLTrace_glProgramUniform4fvEXT(GLuint program, GLint location, GLsizei coun
 }
 
 void GLTrace_glProgramUniformMatrix2fvEXT(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniformMatrix2fvEXT, "glProgramUniformMatrix2fvEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniformMatrix2fvEXT, "glProgramUniformMatrix2fvEXT");
+        glContext->hooks->gl.glProgramUniformMatrix2fvEXT(program, location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniformMatrix2fvEXT);
 
     // copy argument program
@@ -13982,9 +15902,15 @@ void GLTrace_glProgramUniformMatrix2fvEXT(GLuint program, GLint location, GLsize
 }
 
 void GLTrace_glProgramUniformMatrix3fvEXT(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniformMatrix3fvEXT, "glProgramUniformMatrix3fvEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniformMatrix3fvEXT, "glProgramUniformMatrix3fvEXT");
+        glContext->hooks->gl.glProgramUniformMatrix3fvEXT(program, location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniformMatrix3fvEXT);
 
     // copy argument program
@@ -14035,9 +15961,15 @@ void GLTrace_glProgramUniformMatrix3fvEXT(GLuint program, GLint location, GLsize
 }
 
 void GLTrace_glProgramUniformMatrix4fvEXT(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glProgramUniformMatrix4fvEXT, "glProgramUniformMatrix4fvEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glProgramUniformMatrix4fvEXT, "glProgramUniformMatrix4fvEXT");
+        glContext->hooks->gl.glProgramUniformMatrix4fvEXT(program, location, count, transpose, value);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glProgramUniformMatrix4fvEXT);
 
     // copy argument program
@@ -14088,9 +16020,15 @@ void GLTrace_glProgramUniformMatrix4fvEXT(GLuint program, GLint location, GLsize
 }
 
 void GLTrace_glValidateProgramPipelineEXT(GLuint pipeline) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glValidateProgramPipelineEXT, "glValidateProgramPipelineEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glValidateProgramPipelineEXT, "glValidateProgramPipelineEXT");
+        glContext->hooks->gl.glValidateProgramPipelineEXT(pipeline);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glValidateProgramPipelineEXT);
 
     // copy argument pipeline
@@ -14116,9 +16054,15 @@ void GLTrace_glValidateProgramPipelineEXT(GLuint pipeline) {
 }
 
 void GLTrace_glGetProgramPipelineInfoLogEXT(GLuint pipeline, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetProgramPipelineInfoLogEXT, "glGetProgramPipelineInfoLogEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glGetProgramPipelineInfoLogEXT, "glGetProgramPipelineInfoLogEXT");
+        glContext->hooks->gl.glGetProgramPipelineInfoLogEXT(pipeline, bufSize, length, infoLog);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetProgramPipelineInfoLogEXT);
 
     // copy argument pipeline
@@ -14164,9 +16108,15 @@ void GLTrace_glGetProgramPipelineInfoLogEXT(GLuint pipeline, GLsizei bufSize, GL
 }
 
 void GLTrace_glTexStorage1DEXT(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexStorage1DEXT, "glTexStorage1DEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glTexStorage1DEXT, "glTexStorage1DEXT");
+        glContext->hooks->gl.glTexStorage1DEXT(target, levels, internalformat, width);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexStorage1DEXT);
 
     // copy argument target
@@ -14210,9 +16160,15 @@ void GLTrace_glTexStorage1DEXT(GLenum target, GLsizei levels, GLenum internalfor
 }
 
 void GLTrace_glTexStorage2DEXT(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexStorage2DEXT, "glTexStorage2DEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glTexStorage2DEXT, "glTexStorage2DEXT");
+        glContext->hooks->gl.glTexStorage2DEXT(target, levels, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexStorage2DEXT);
 
     // copy argument target
@@ -14262,9 +16218,15 @@ void GLTrace_glTexStorage2DEXT(GLenum target, GLsizei levels, GLenum internalfor
 }
 
 void GLTrace_glTexStorage3DEXT(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexStorage3DEXT, "glTexStorage3DEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glTexStorage3DEXT, "glTexStorage3DEXT");
+        glContext->hooks->gl.glTexStorage3DEXT(target, levels, internalformat, width, height, depth);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexStorage3DEXT);
 
     // copy argument target
@@ -14320,9 +16282,15 @@ void GLTrace_glTexStorage3DEXT(GLenum target, GLsizei levels, GLenum internalfor
 }
 
 void GLTrace_glTextureStorage1DEXT(GLuint texture, GLenum target, GLsizei levels, GLenum internalformat, GLsizei width) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTextureStorage1DEXT, "glTextureStorage1DEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glTextureStorage1DEXT, "glTextureStorage1DEXT");
+        glContext->hooks->gl.glTextureStorage1DEXT(texture, target, levels, internalformat, width);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTextureStorage1DEXT);
 
     // copy argument texture
@@ -14372,9 +16340,15 @@ void GLTrace_glTextureStorage1DEXT(GLuint texture, GLenum target, GLsizei levels
 }
 
 void GLTrace_glTextureStorage2DEXT(GLuint texture, GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTextureStorage2DEXT, "glTextureStorage2DEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glTextureStorage2DEXT, "glTextureStorage2DEXT");
+        glContext->hooks->gl.glTextureStorage2DEXT(texture, target, levels, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTextureStorage2DEXT);
 
     // copy argument texture
@@ -14430,9 +16404,15 @@ void GLTrace_glTextureStorage2DEXT(GLuint texture, GLenum target, GLsizei levels
 }
 
 void GLTrace_glTextureStorage3DEXT(GLuint texture, GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTextureStorage3DEXT, "glTextureStorage3DEXT")) {
+        GLCallCounter counter(glContext, GLMessage::glTextureStorage3DEXT, "glTextureStorage3DEXT");
+        glContext->hooks->gl.glTextureStorage3DEXT(texture, target, levels, internalformat, width, height, depth);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTextureStorage3DEXT);
 
     // copy argument texture
@@ -14494,9 +16474,15 @@ void GLTrace_glTextureStorage3DEXT(GLuint texture, GLenum target, GLsizei levels
 }
 
 void GLTrace_glRenderbufferStorageMultisampleIMG(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRenderbufferStorageMultisampleIMG, "glRenderbufferStorageMultisampleIMG")) {
+        GLCallCounter counter(glContext, GLMessage::glRenderbufferStorageMultisampleIMG, "glRenderbufferStorageMultisampleIMG");
+        glContext->hooks->gl.glRenderbufferStorageMultisampleIMG(target, samples, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRenderbufferStorageMultisampleIMG);
 
     // copy argument target
@@ -14546,9 +16532,15 @@ void GLTrace_glRenderbufferStorageMultisampleIMG(GLenum target, GLsizei samples,
 }
 
 void GLTrace_glFramebufferTexture2DMultisampleIMG(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFramebufferTexture2DMultisampleIMG, "glFramebufferTexture2DMultisampleIMG")) {
+        GLCallCounter counter(glContext, GLMessage::glFramebufferTexture2DMultisampleIMG, "glFramebufferTexture2DMultisampleIMG");
+        glContext->hooks->gl.glFramebufferTexture2DMultisampleIMG(target, attachment, textarget, texture, level, samples);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFramebufferTexture2DMultisampleIMG);
 
     // copy argument target
@@ -14604,9 +16596,15 @@ void GLTrace_glFramebufferTexture2DMultisampleIMG(GLenum target, GLenum attachme
 }
 
 void GLTrace_glCoverageMaskNV(GLboolean mask) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCoverageMaskNV, "glCoverageMaskNV")) {
+        GLCallCounter counter(glContext, GLMessage::glCoverageMaskNV, "glCoverageMaskNV");
+        glContext->hooks->gl.glCoverageMaskNV(mask);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCoverageMaskNV);
 
     // copy argument mask
@@ -14632,9 +16630,15 @@ void GLTrace_glCoverageMaskNV(GLboolean mask) {
 }
 
 void GLTrace_glCoverageOperationNV(GLenum operation) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCoverageOperationNV, "glCoverageOperationNV")) {
+        GLCallCounter counter(glContext, GLMessage::glCoverageOperationNV, "glCoverageOperationNV");
+        glContext->hooks->gl.glCoverageOperationNV(operation);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCoverageOperationNV);
 
     // copy argument operation
@@ -14660,9 +16664,15 @@ void GLTrace_glCoverageOperationNV(GLenum operation) {
 }
 
 void GLTrace_glDrawBuffersNV(GLsizei n, const GLenum *bufs) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawBuffersNV, "glDrawBuffersNV")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawBuffersNV, "glDrawBuffersNV");
+        glContext->hooks->gl.glDrawBuffersNV(n, bufs);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawBuffersNV);
 
     // copy argument n
@@ -14695,10 +16705,16 @@ void GLTrace_glDrawBuffersNV(GLsizei n, const GLenum *bufs) {
 }
 
 void GLTrace_glDeleteFencesNV(GLsizei n, const GLuint *fences) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
-    glmsg.set_function(GLMessage::glDeleteFencesNV);
+    if (!glContext->shouldTrace(GLMessage::glDeleteFencesNV, "glDeleteFencesNV")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteFencesNV, "glDeleteFencesNV");
+        glContext->hooks->gl.glDeleteFencesNV(n, fences);
+        return;
+    }
+
+    GLMessage glmsg;
+    glmsg.set_function(GLMessage::glDeleteFencesNV);
 
     // copy argument n
     GLMessage_DataType *arg_n = glmsg.add_args();
@@ -14730,9 +16746,15 @@ void GLTrace_glDeleteFencesNV(GLsizei n, const GLuint *fences) {
 }
 
 void GLTrace_glGenFencesNV(GLsizei n, GLuint *fences) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenFencesNV, "glGenFencesNV")) {
+        GLCallCounter counter(glContext, GLMessage::glGenFencesNV, "glGenFencesNV");
+        glContext->hooks->gl.glGenFencesNV(n, fences);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenFencesNV);
 
     // copy argument n
@@ -14765,9 +16787,14 @@ void GLTrace_glGenFencesNV(GLsizei n, GLuint *fences) {
 }
 
 GLboolean GLTrace_glIsFenceNV(GLuint fence) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsFenceNV, "glIsFenceNV")) {
+        GLCallCounter counter(glContext, GLMessage::glIsFenceNV, "glIsFenceNV");
+        return glContext->hooks->gl.glIsFenceNV(fence);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsFenceNV);
 
     // copy argument fence
@@ -14801,9 +16828,14 @@ GLboolean GLTrace_glIsFenceNV(GLuint fence) {
 }
 
 GLboolean GLTrace_glTestFenceNV(GLuint fence) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTestFenceNV, "glTestFenceNV")) {
+        GLCallCounter counter(glContext, GLMessage::glTestFenceNV, "glTestFenceNV");
+        return glContext->hooks->gl.glTestFenceNV(fence);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTestFenceNV);
 
     // copy argument fence
@@ -14837,9 +16869,15 @@ GLboolean GLTrace_glTestFenceNV(GLuint fence) {
 }
 
 void GLTrace_glGetFenceivNV(GLuint fence, GLenum pname, GLint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetFenceivNV, "glGetFenceivNV")) {
+        GLCallCounter counter(glContext, GLMessage::glGetFenceivNV, "glGetFenceivNV");
+        glContext->hooks->gl.glGetFenceivNV(fence, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetFenceivNV);
 
     // copy argument fence
@@ -14878,9 +16916,15 @@ void GLTrace_glGetFenceivNV(GLuint fence, GLenum pname, GLint *params) {
 }
 
 void GLTrace_glFinishFenceNV(GLuint fence) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFinishFenceNV, "glFinishFenceNV")) {
+        GLCallCounter counter(glContext, GLMessage::glFinishFenceNV, "glFinishFenceNV");
+        glContext->hooks->gl.glFinishFenceNV(fence);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFinishFenceNV);
 
     // copy argument fence
@@ -14906,9 +16950,15 @@ void GLTrace_glFinishFenceNV(GLuint fence) {
 }
 
 void GLTrace_glSetFenceNV(GLuint fence, GLenum condition) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glSetFenceNV, "glSetFenceNV")) {
+        GLCallCounter counter(glContext, GLMessage::glSetFenceNV, "glSetFenceNV");
+        glContext->hooks->gl.glSetFenceNV(fence, condition);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glSetFenceNV);
 
     // copy argument fence
@@ -14940,9 +16990,15 @@ void GLTrace_glSetFenceNV(GLuint fence, GLenum condition) {
 }
 
 void GLTrace_glReadBufferNV(GLenum mode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glReadBufferNV, "glReadBufferNV")) {
+        GLCallCounter counter(glContext, GLMessage::glReadBufferNV, "glReadBufferNV");
+        glContext->hooks->gl.glReadBufferNV(mode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glReadBufferNV);
 
     // copy argument mode
@@ -14968,9 +17024,15 @@ void GLTrace_glReadBufferNV(GLenum mode) {
 }
 
 void GLTrace_glAlphaFuncQCOM(GLenum func, GLclampf ref) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glAlphaFuncQCOM, "glAlphaFuncQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glAlphaFuncQCOM, "glAlphaFuncQCOM");
+        glContext->hooks->gl.glAlphaFuncQCOM(func, ref);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glAlphaFuncQCOM);
 
     // copy argument func
@@ -15002,9 +17064,15 @@ void GLTrace_glAlphaFuncQCOM(GLenum func, GLclampf ref) {
 }
 
 void GLTrace_glGetDriverControlsQCOM(GLint *num, GLsizei size, GLuint *driverControls) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetDriverControlsQCOM, "glGetDriverControlsQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glGetDriverControlsQCOM, "glGetDriverControlsQCOM");
+        glContext->hooks->gl.glGetDriverControlsQCOM(num, size, driverControls);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetDriverControlsQCOM);
 
     // copy argument num
@@ -15044,9 +17112,15 @@ void GLTrace_glGetDriverControlsQCOM(GLint *num, GLsizei size, GLuint *driverCon
 }
 
 void GLTrace_glGetDriverControlStringQCOM(GLuint driverControl, GLsizei bufSize, GLsizei *length, GLchar *driverControlString) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetDriverControlStringQCOM, "glGetDriverControlStringQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glGetDriverControlStringQCOM, "glGetDriverControlStringQCOM");
+        glContext->hooks->gl.glGetDriverControlStringQCOM(driverControl, bufSize, length, driverControlString);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetDriverControlStringQCOM);
 
     // copy argument driverControl
@@ -15092,9 +17166,15 @@ void GLTrace_glGetDriverControlStringQCOM(GLuint driverControl, GLsizei bufSize,
 }
 
 void GLTrace_glEnableDriverControlQCOM(GLuint driverControl) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEnableDriverControlQCOM, "glEnableDriverControlQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glEnableDriverControlQCOM, "glEnableDriverControlQCOM");
+        glContext->hooks->gl.glEnableDriverControlQCOM(driverControl);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEnableDriverControlQCOM);
 
     // copy argument driverControl
@@ -15120,9 +17200,15 @@ void GLTrace_glEnableDriverControlQCOM(GLuint driverControl) {
 }
 
 void GLTrace_glDisableDriverControlQCOM(GLuint driverControl) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDisableDriverControlQCOM, "glDisableDriverControlQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glDisableDriverControlQCOM, "glDisableDriverControlQCOM");
+        glContext->hooks->gl.glDisableDriverControlQCOM(driverControl);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDisableDriverControlQCOM);
 
     // copy argument driverControl
@@ -15148,9 +17234,15 @@ void GLTrace_glDisableDriverControlQCOM(GLuint driverControl) {
 }
 
 void GLTrace_glExtGetTexturesQCOM(GLuint *textures, GLint maxTextures, GLint *numTextures) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetTexturesQCOM, "glExtGetTexturesQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetTexturesQCOM, "glExtGetTexturesQCOM");
+        glContext->hooks->gl.glExtGetTexturesQCOM(textures, maxTextures, numTextures);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetTexturesQCOM);
 
     // copy argument textures
@@ -15190,9 +17282,15 @@ void GLTrace_glExtGetTexturesQCOM(GLuint *textures, GLint maxTextures, GLint *nu
 }
 
 void GLTrace_glExtGetBuffersQCOM(GLuint *buffers, GLint maxBuffers, GLint *numBuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetBuffersQCOM, "glExtGetBuffersQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetBuffersQCOM, "glExtGetBuffersQCOM");
+        glContext->hooks->gl.glExtGetBuffersQCOM(buffers, maxBuffers, numBuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetBuffersQCOM);
 
     // copy argument buffers
@@ -15232,9 +17330,15 @@ void GLTrace_glExtGetBuffersQCOM(GLuint *buffers, GLint maxBuffers, GLint *numBu
 }
 
 void GLTrace_glExtGetRenderbuffersQCOM(GLuint *renderbuffers, GLint maxRenderbuffers, GLint *numRenderbuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetRenderbuffersQCOM, "glExtGetRenderbuffersQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetRenderbuffersQCOM, "glExtGetRenderbuffersQCOM");
+        glContext->hooks->gl.glExtGetRenderbuffersQCOM(renderbuffers, maxRenderbuffers, numRenderbuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetRenderbuffersQCOM);
 
     // copy argument renderbuffers
@@ -15274,9 +17378,15 @@ void GLTrace_glExtGetRenderbuffersQCOM(GLuint *renderbuffers, GLint maxRenderbuf
 }
 
 void GLTrace_glExtGetFramebuffersQCOM(GLuint *framebuffers, GLint maxFramebuffers, GLint *numFramebuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetFramebuffersQCOM, "glExtGetFramebuffersQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetFramebuffersQCOM, "glExtGetFramebuffersQCOM");
+        glContext->hooks->gl.glExtGetFramebuffersQCOM(framebuffers, maxFramebuffers, numFramebuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetFramebuffersQCOM);
 
     // copy argument framebuffers
@@ -15316,9 +17426,15 @@ void GLTrace_glExtGetFramebuffersQCOM(GLuint *framebuffers, GLint maxFramebuffer
 }
 
 void GLTrace_glExtGetTexLevelParameterivQCOM(GLuint texture, GLenum face, GLint level, GLenum pname, GLint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetTexLevelParameterivQCOM, "glExtGetTexLevelParameterivQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetTexLevelParameterivQCOM, "glExtGetTexLevelParameterivQCOM");
+        glContext->hooks->gl.glExtGetTexLevelParameterivQCOM(texture, face, level, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetTexLevelParameterivQCOM);
 
     // copy argument texture
@@ -15369,9 +17485,15 @@ void GLTrace_glExtGetTexLevelParameterivQCOM(GLuint texture, GLenum face, GLint
 }
 
 void GLTrace_glExtTexObjectStateOverrideiQCOM(GLenum target, GLenum pname, GLint param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtTexObjectStateOverrideiQCOM, "glExtTexObjectStateOverrideiQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtTexObjectStateOverrideiQCOM, "glExtTexObjectStateOverrideiQCOM");
+        glContext->hooks->gl.glExtTexObjectStateOverrideiQCOM(target, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtTexObjectStateOverrideiQCOM);
 
     // copy argument target
@@ -15409,9 +17531,15 @@ void GLTrace_glExtTexObjectStateOverrideiQCOM(GLenum target, GLenum pname, GLint
 }
 
 void GLTrace_glExtGetTexSubImageQCOM(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, GLvoid *texels) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetTexSubImageQCOM, "glExtGetTexSubImageQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetTexSubImageQCOM, "glExtGetTexSubImageQCOM");
+        glContext->hooks->gl.glExtGetTexSubImageQCOM(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, texels);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetTexSubImageQCOM);
 
     // copy argument target
@@ -15498,9 +17626,15 @@ void GLTrace_glExtGetTexSubImageQCOM(GLenum target, GLint level, GLint xoffset,
 }
 
 void GLTrace_glExtGetBufferPointervQCOM(GLenum target, GLvoid **params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetBufferPointervQCOM, "glExtGetBufferPointervQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetBufferPointervQCOM, "glExtGetBufferPointervQCOM");
+        glContext->hooks->gl.glExtGetBufferPointervQCOM(target, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetBufferPointervQCOM);
 
     // copy argument target
@@ -15533,9 +17667,15 @@ void GLTrace_glExtGetBufferPointervQCOM(GLenum target, GLvoid **params) {
 }
 
 void GLTrace_glExtGetShadersQCOM(GLuint *shaders, GLint maxShaders, GLint *numShaders) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetShadersQCOM, "glExtGetShadersQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetShadersQCOM, "glExtGetShadersQCOM");
+        glContext->hooks->gl.glExtGetShadersQCOM(shaders, maxShaders, numShaders);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetShadersQCOM);
 
     // copy argument shaders
@@ -15575,9 +17715,15 @@ void GLTrace_glExtGetShadersQCOM(GLuint *shaders, GLint maxShaders, GLint *numSh
 }
 
 void GLTrace_glExtGetProgramsQCOM(GLuint *programs, GLint maxPrograms, GLint *numPrograms) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetProgramsQCOM, "glExtGetProgramsQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetProgramsQCOM, "glExtGetProgramsQCOM");
+        glContext->hooks->gl.glExtGetProgramsQCOM(programs, maxPrograms, numPrograms);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetProgramsQCOM);
 
     // copy argument programs
@@ -15617,9 +17763,14 @@ void GLTrace_glExtGetProgramsQCOM(GLuint *programs, GLint maxPrograms, GLint *nu
 }
 
 GLboolean GLTrace_glExtIsProgramBinaryQCOM(GLuint program) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtIsProgramBinaryQCOM, "glExtIsProgramBinaryQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtIsProgramBinaryQCOM, "glExtIsProgramBinaryQCOM");
+        return glContext->hooks->gl.glExtIsProgramBinaryQCOM(program);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtIsProgramBinaryQCOM);
 
     // copy argument program
@@ -15653,9 +17804,15 @@ GLboolean GLTrace_glExtIsProgramBinaryQCOM(GLuint program) {
 }
 
 void GLTrace_glExtGetProgramBinarySourceQCOM(GLuint program, GLenum shadertype, GLchar *source, GLint *length) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glExtGetProgramBinarySourceQCOM, "glExtGetProgramBinarySourceQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glExtGetProgramBinarySourceQCOM, "glExtGetProgramBinarySourceQCOM");
+        glContext->hooks->gl.glExtGetProgramBinarySourceQCOM(program, shadertype, source, length);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glExtGetProgramBinarySourceQCOM);
 
     // copy argument program
@@ -15701,9 +17858,15 @@ void GLTrace_glExtGetProgramBinarySourceQCOM(GLuint program, GLenum shadertype,
 }
 
 void GLTrace_glStartTilingQCOM(GLuint x, GLuint y, GLuint width, GLuint height, GLbitfield preserveMask) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glStartTilingQCOM, "glStartTilingQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glStartTilingQCOM, "glStartTilingQCOM");
+        glContext->hooks->gl.glStartTilingQCOM(x, y, width, height, preserveMask);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glStartTilingQCOM);
 
     // copy argument x
@@ -15753,9 +17916,15 @@ void GLTrace_glStartTilingQCOM(GLuint x, GLuint y, GLuint width, GLuint height,
 }
 
 void GLTrace_glEndTilingQCOM(GLbitfield preserveMask) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEndTilingQCOM, "glEndTilingQCOM")) {
+        GLCallCounter counter(glContext, GLMessage::glEndTilingQCOM, "glEndTilingQCOM");
+        glContext->hooks->gl.glEndTilingQCOM(preserveMask);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEndTilingQCOM);
 
     // copy argument preserveMask
@@ -15784,9 +17953,15 @@ void GLTrace_glEndTilingQCOM(GLbitfield preserveMask) {
 // Definitions for GL1 APIs
 
 void GLTrace_glAlphaFunc(GLenum func, GLclampf ref) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glAlphaFunc, "glAlphaFunc")) {
+        GLCallCounter counter(glContext, GLMessage::glAlphaFunc, "glAlphaFunc");
+        glContext->hooks->gl.glAlphaFunc(func, ref);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glAlphaFunc);
 
     // copy argument func
@@ -15818,9 +17993,15 @@ void GLTrace_glAlphaFunc(GLenum func, GLclampf ref) {
 }
 
 void GLTrace_glClipPlanef(GLenum plane, const GLfloat *equation) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClipPlanef, "glClipPlanef")) {
+        GLCallCounter counter(glContext, GLMessage::glClipPlanef, "glClipPlanef");
+        glContext->hooks->gl.glClipPlanef(plane, equation);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClipPlanef);
 
     // copy argument plane
@@ -15853,9 +18034,15 @@ void GLTrace_glClipPlanef(GLenum plane, const GLfloat *equation) {
 }
 
 void GLTrace_glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glColor4f, "glColor4f")) {
+        GLCallCounter counter(glContext, GLMessage::glColor4f, "glColor4f");
+        glContext->hooks->gl.glColor4f(red, green, blue, alpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glColor4f);
 
     // copy argument red
@@ -15899,9 +18086,15 @@ void GLTrace_glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
 }
 
 void GLTrace_glFogf(GLenum pname, GLfloat param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFogf, "glFogf")) {
+        GLCallCounter counter(glContext, GLMessage::glFogf, "glFogf");
+        glContext->hooks->gl.glFogf(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFogf);
 
     // copy argument pname
@@ -15933,9 +18126,15 @@ void GLTrace_glFogf(GLenum pname, GLfloat param) {
 }
 
 void GLTrace_glFogfv(GLenum pname, const GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFogfv, "glFogfv")) {
+        GLCallCounter counter(glContext, GLMessage::glFogfv, "glFogfv");
+        glContext->hooks->gl.glFogfv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFogfv);
 
     // copy argument pname
@@ -15968,9 +18167,15 @@ void GLTrace_glFogfv(GLenum pname, const GLfloat *params) {
 }
 
 void GLTrace_glFrustumf(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFrustumf, "glFrustumf")) {
+        GLCallCounter counter(glContext, GLMessage::glFrustumf, "glFrustumf");
+        glContext->hooks->gl.glFrustumf(left, right, bottom, top, zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFrustumf);
 
     // copy argument left
@@ -16026,9 +18231,15 @@ void GLTrace_glFrustumf(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top
 }
 
 void GLTrace_glGetClipPlanef(GLenum pname, GLfloat eqn[4]) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetClipPlanef, "glGetClipPlanef")) {
+        GLCallCounter counter(glContext, GLMessage::glGetClipPlanef, "glGetClipPlanef");
+        glContext->hooks->gl.glGetClipPlanef(pname, eqn);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetClipPlanef);
 
     // copy argument pname
@@ -16061,9 +18272,15 @@ void GLTrace_glGetClipPlanef(GLenum pname, GLfloat eqn[4]) {
 }
 
 void GLTrace_glGetLightfv(GLenum light, GLenum pname, GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetLightfv, "glGetLightfv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetLightfv, "glGetLightfv");
+        glContext->hooks->gl.glGetLightfv(light, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetLightfv);
 
     // copy argument light
@@ -16102,9 +18319,15 @@ void GLTrace_glGetLightfv(GLenum light, GLenum pname, GLfloat *params) {
 }
 
 void GLTrace_glGetMaterialfv(GLenum face, GLenum pname, GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetMaterialfv, "glGetMaterialfv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetMaterialfv, "glGetMaterialfv");
+        glContext->hooks->gl.glGetMaterialfv(face, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetMaterialfv);
 
     // copy argument face
@@ -16143,9 +18366,15 @@ void GLTrace_glGetMaterialfv(GLenum face, GLenum pname, GLfloat *params) {
 }
 
 void GLTrace_glGetTexEnvfv(GLenum env, GLenum pname, GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexEnvfv, "glGetTexEnvfv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexEnvfv, "glGetTexEnvfv");
+        glContext->hooks->gl.glGetTexEnvfv(env, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexEnvfv);
 
     // copy argument env
@@ -16184,9 +18413,15 @@ void GLTrace_glGetTexEnvfv(GLenum env, GLenum pname, GLfloat *params) {
 }
 
 void GLTrace_glLightModelf(GLenum pname, GLfloat param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightModelf, "glLightModelf")) {
+        GLCallCounter counter(glContext, GLMessage::glLightModelf, "glLightModelf");
+        glContext->hooks->gl.glLightModelf(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightModelf);
 
     // copy argument pname
@@ -16218,9 +18453,15 @@ void GLTrace_glLightModelf(GLenum pname, GLfloat param) {
 }
 
 void GLTrace_glLightModelfv(GLenum pname, const GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightModelfv, "glLightModelfv")) {
+        GLCallCounter counter(glContext, GLMessage::glLightModelfv, "glLightModelfv");
+        glContext->hooks->gl.glLightModelfv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightModelfv);
 
     // copy argument pname
@@ -16253,9 +18494,15 @@ void GLTrace_glLightModelfv(GLenum pname, const GLfloat *params) {
 }
 
 void GLTrace_glLightf(GLenum light, GLenum pname, GLfloat param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightf, "glLightf")) {
+        GLCallCounter counter(glContext, GLMessage::glLightf, "glLightf");
+        glContext->hooks->gl.glLightf(light, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightf);
 
     // copy argument light
@@ -16293,9 +18540,15 @@ void GLTrace_glLightf(GLenum light, GLenum pname, GLfloat param) {
 }
 
 void GLTrace_glLightfv(GLenum light, GLenum pname, const GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightfv, "glLightfv")) {
+        GLCallCounter counter(glContext, GLMessage::glLightfv, "glLightfv");
+        glContext->hooks->gl.glLightfv(light, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightfv);
 
     // copy argument light
@@ -16334,9 +18587,15 @@ void GLTrace_glLightfv(GLenum light, GLenum pname, const GLfloat *params) {
 }
 
 void GLTrace_glLoadMatrixf(const GLfloat *m) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLoadMatrixf, "glLoadMatrixf")) {
+        GLCallCounter counter(glContext, GLMessage::glLoadMatrixf, "glLoadMatrixf");
+        glContext->hooks->gl.glLoadMatrixf(m);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLoadMatrixf);
 
     // copy argument m
@@ -16363,9 +18622,15 @@ void GLTrace_glLoadMatrixf(const GLfloat *m) {
 }
 
 void GLTrace_glMaterialf(GLenum face, GLenum pname, GLfloat param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMaterialf, "glMaterialf")) {
+        GLCallCounter counter(glContext, GLMessage::glMaterialf, "glMaterialf");
+        glContext->hooks->gl.glMaterialf(face, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMaterialf);
 
     // copy argument face
@@ -16403,9 +18668,15 @@ void GLTrace_glMaterialf(GLenum face, GLenum pname, GLfloat param) {
 }
 
 void GLTrace_glMaterialfv(GLenum face, GLenum pname, const GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMaterialfv, "glMaterialfv")) {
+        GLCallCounter counter(glContext, GLMessage::glMaterialfv, "glMaterialfv");
+        glContext->hooks->gl.glMaterialfv(face, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMaterialfv);
 
     // copy argument face
@@ -16444,9 +18715,15 @@ void GLTrace_glMaterialfv(GLenum face, GLenum pname, const GLfloat *params) {
 }
 
 void GLTrace_glMultMatrixf(const GLfloat *m) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMultMatrixf, "glMultMatrixf")) {
+        GLCallCounter counter(glContext, GLMessage::glMultMatrixf, "glMultMatrixf");
+        glContext->hooks->gl.glMultMatrixf(m);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMultMatrixf);
 
     // copy argument m
@@ -16473,9 +18750,15 @@ void GLTrace_glMultMatrixf(const GLfloat *m) {
 }
 
 void GLTrace_glMultiTexCoord4f(GLenum target, GLfloat s, GLfloat t, GLfloat r, GLfloat q) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMultiTexCoord4f, "glMultiTexCoord4f")) {
+        GLCallCounter counter(glContext, GLMessage::glMultiTexCoord4f, "glMultiTexCoord4f");
+        glContext->hooks->gl.glMultiTexCoord4f(target, s, t, r, q);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMultiTexCoord4f);
 
     // copy argument target
@@ -16525,9 +18808,15 @@ void GLTrace_glMultiTexCoord4f(GLenum target, GLfloat s, GLfloat t, GLfloat r, G
 }
 
 void GLTrace_glNormal3f(GLfloat nx, GLfloat ny, GLfloat nz) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glNormal3f, "glNormal3f")) {
+        GLCallCounter counter(glContext, GLMessage::glNormal3f, "glNormal3f");
+        glContext->hooks->gl.glNormal3f(nx, ny, nz);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glNormal3f);
 
     // copy argument nx
@@ -16565,9 +18854,15 @@ void GLTrace_glNormal3f(GLfloat nx, GLfloat ny, GLfloat nz) {
 }
 
 void GLTrace_glOrthof(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glOrthof, "glOrthof")) {
+        GLCallCounter counter(glContext, GLMessage::glOrthof, "glOrthof");
+        glContext->hooks->gl.glOrthof(left, right, bottom, top, zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glOrthof);
 
     // copy argument left
@@ -16623,9 +18918,15 @@ void GLTrace_glOrthof(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top,
 }
 
 void GLTrace_glPointParameterf(GLenum pname, GLfloat param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointParameterf, "glPointParameterf")) {
+        GLCallCounter counter(glContext, GLMessage::glPointParameterf, "glPointParameterf");
+        glContext->hooks->gl.glPointParameterf(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointParameterf);
 
     // copy argument pname
@@ -16657,9 +18958,15 @@ void GLTrace_glPointParameterf(GLenum pname, GLfloat param) {
 }
 
 void GLTrace_glPointParameterfv(GLenum pname, const GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointParameterfv, "glPointParameterfv")) {
+        GLCallCounter counter(glContext, GLMessage::glPointParameterfv, "glPointParameterfv");
+        glContext->hooks->gl.glPointParameterfv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointParameterfv);
 
     // copy argument pname
@@ -16692,9 +18999,15 @@ void GLTrace_glPointParameterfv(GLenum pname, const GLfloat *params) {
 }
 
 void GLTrace_glPointSize(GLfloat size) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointSize, "glPointSize")) {
+        GLCallCounter counter(glContext, GLMessage::glPointSize, "glPointSize");
+        glContext->hooks->gl.glPointSize(size);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointSize);
 
     // copy argument size
@@ -16720,9 +19033,15 @@ void GLTrace_glPointSize(GLfloat size) {
 }
 
 void GLTrace_glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRotatef, "glRotatef")) {
+        GLCallCounter counter(glContext, GLMessage::glRotatef, "glRotatef");
+        glContext->hooks->gl.glRotatef(angle, x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRotatef);
 
     // copy argument angle
@@ -16766,9 +19085,15 @@ void GLTrace_glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z) {
 }
 
 void GLTrace_glScalef(GLfloat x, GLfloat y, GLfloat z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glScalef, "glScalef")) {
+        GLCallCounter counter(glContext, GLMessage::glScalef, "glScalef");
+        glContext->hooks->gl.glScalef(x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glScalef);
 
     // copy argument x
@@ -16806,9 +19131,15 @@ void GLTrace_glScalef(GLfloat x, GLfloat y, GLfloat z) {
 }
 
 void GLTrace_glTexEnvf(GLenum target, GLenum pname, GLfloat param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexEnvf, "glTexEnvf")) {
+        GLCallCounter counter(glContext, GLMessage::glTexEnvf, "glTexEnvf");
+        glContext->hooks->gl.glTexEnvf(target, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexEnvf);
 
     // copy argument target
@@ -16846,9 +19177,15 @@ void GLTrace_glTexEnvf(GLenum target, GLenum pname, GLfloat param) {
 }
 
 void GLTrace_glTexEnvfv(GLenum target, GLenum pname, const GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexEnvfv, "glTexEnvfv")) {
+        GLCallCounter counter(glContext, GLMessage::glTexEnvfv, "glTexEnvfv");
+        glContext->hooks->gl.glTexEnvfv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexEnvfv);
 
     // copy argument target
@@ -16887,9 +19224,15 @@ void GLTrace_glTexEnvfv(GLenum target, GLenum pname, const GLfloat *params) {
 }
 
 void GLTrace_glTranslatef(GLfloat x, GLfloat y, GLfloat z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTranslatef, "glTranslatef")) {
+        GLCallCounter counter(glContext, GLMessage::glTranslatef, "glTranslatef");
+        glContext->hooks->gl.glTranslatef(x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTranslatef);
 
     // copy argument x
@@ -16927,9 +19270,15 @@ void GLTrace_glTranslatef(GLfloat x, GLfloat y, GLfloat z) {
 }
 
 void GLTrace_glAlphaFuncx(GLenum func, GLclampx ref) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glAlphaFuncx, "glAlphaFuncx")) {
+        GLCallCounter counter(glContext, GLMessage::glAlphaFuncx, "glAlphaFuncx");
+        glContext->hooks->gl.glAlphaFuncx(func, ref);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glAlphaFuncx);
 
     // copy argument func
@@ -16961,9 +19310,15 @@ void GLTrace_glAlphaFuncx(GLenum func, GLclampx ref) {
 }
 
 void GLTrace_glClearColorx(GLclampx red, GLclampx green, GLclampx blue, GLclampx alpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearColorx, "glClearColorx")) {
+        GLCallCounter counter(glContext, GLMessage::glClearColorx, "glClearColorx");
+        glContext->hooks->gl.glClearColorx(red, green, blue, alpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearColorx);
 
     // copy argument red
@@ -17007,9 +19362,15 @@ void GLTrace_glClearColorx(GLclampx red, GLclampx green, GLclampx blue, GLclampx
 }
 
 void GLTrace_glClearDepthx(GLclampx depth) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearDepthx, "glClearDepthx")) {
+        GLCallCounter counter(glContext, GLMessage::glClearDepthx, "glClearDepthx");
+        glContext->hooks->gl.glClearDepthx(depth);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearDepthx);
 
     // copy argument depth
@@ -17035,9 +19396,15 @@ void GLTrace_glClearDepthx(GLclampx depth) {
 }
 
 void GLTrace_glClientActiveTexture(GLenum texture) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClientActiveTexture, "glClientActiveTexture")) {
+        GLCallCounter counter(glContext, GLMessage::glClientActiveTexture, "glClientActiveTexture");
+        glContext->hooks->gl.glClientActiveTexture(texture);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClientActiveTexture);
 
     // copy argument texture
@@ -17063,9 +19430,15 @@ void GLTrace_glClientActiveTexture(GLenum texture) {
 }
 
 void GLTrace_glClipPlanex(GLenum plane, const GLfixed *equation) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClipPlanex, "glClipPlanex")) {
+        GLCallCounter counter(glContext, GLMessage::glClipPlanex, "glClipPlanex");
+        glContext->hooks->gl.glClipPlanex(plane, equation);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClipPlanex);
 
     // copy argument plane
@@ -17098,9 +19471,15 @@ void GLTrace_glClipPlanex(GLenum plane, const GLfixed *equation) {
 }
 
 void GLTrace_glColor4ub(GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glColor4ub, "glColor4ub")) {
+        GLCallCounter counter(glContext, GLMessage::glColor4ub, "glColor4ub");
+        glContext->hooks->gl.glColor4ub(red, green, blue, alpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glColor4ub);
 
     // copy argument red
@@ -17144,9 +19523,15 @@ void GLTrace_glColor4ub(GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha)
 }
 
 void GLTrace_glColor4x(GLfixed red, GLfixed green, GLfixed blue, GLfixed alpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glColor4x, "glColor4x")) {
+        GLCallCounter counter(glContext, GLMessage::glColor4x, "glColor4x");
+        glContext->hooks->gl.glColor4x(red, green, blue, alpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glColor4x);
 
     // copy argument red
@@ -17190,9 +19575,15 @@ void GLTrace_glColor4x(GLfixed red, GLfixed green, GLfixed blue, GLfixed alpha)
 }
 
 void GLTrace_glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glColorPointer, "glColorPointer")) {
+        GLCallCounter counter(glContext, GLMessage::glColorPointer, "glColorPointer");
+        glContext->hooks->gl.glColorPointer(size, type, stride, pointer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glColorPointer);
 
     // copy argument size
@@ -17237,9 +19628,15 @@ void GLTrace_glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoi
 }
 
 void GLTrace_glDepthRangex(GLclampx zNear, GLclampx zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDepthRangex, "glDepthRangex")) {
+        GLCallCounter counter(glContext, GLMessage::glDepthRangex, "glDepthRangex");
+        glContext->hooks->gl.glDepthRangex(zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDepthRangex);
 
     // copy argument zNear
@@ -17271,9 +19668,15 @@ void GLTrace_glDepthRangex(GLclampx zNear, GLclampx zFar) {
 }
 
 void GLTrace_glDisableClientState(GLenum array) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDisableClientState, "glDisableClientState")) {
+        GLCallCounter counter(glContext, GLMessage::glDisableClientState, "glDisableClientState");
+        glContext->hooks->gl.glDisableClientState(array);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDisableClientState);
 
     // copy argument array
@@ -17299,9 +19702,15 @@ void GLTrace_glDisableClientState(GLenum array) {
 }
 
 void GLTrace_glEnableClientState(GLenum array) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glEnableClientState, "glEnableClientState")) {
+        GLCallCounter counter(glContext, GLMessage::glEnableClientState, "glEnableClientState");
+        glContext->hooks->gl.glEnableClientState(array);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glEnableClientState);
 
     // copy argument array
@@ -17327,9 +19736,15 @@ void GLTrace_glEnableClientState(GLenum array) {
 }
 
 void GLTrace_glFogx(GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFogx, "glFogx")) {
+        GLCallCounter counter(glContext, GLMessage::glFogx, "glFogx");
+        glContext->hooks->gl.glFogx(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFogx);
 
     // copy argument pname
@@ -17361,9 +19776,15 @@ void GLTrace_glFogx(GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glFogxv(GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFogxv, "glFogxv")) {
+        GLCallCounter counter(glContext, GLMessage::glFogxv, "glFogxv");
+        glContext->hooks->gl.glFogxv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFogxv);
 
     // copy argument pname
@@ -17396,9 +19817,15 @@ void GLTrace_glFogxv(GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glFrustumx(GLfixed left, GLfixed right, GLfixed bottom, GLfixed top, GLfixed zNear, GLfixed zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFrustumx, "glFrustumx")) {
+        GLCallCounter counter(glContext, GLMessage::glFrustumx, "glFrustumx");
+        glContext->hooks->gl.glFrustumx(left, right, bottom, top, zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFrustumx);
 
     // copy argument left
@@ -17454,9 +19881,15 @@ void GLTrace_glFrustumx(GLfixed left, GLfixed right, GLfixed bottom, GLfixed top
 }
 
 void GLTrace_glGetClipPlanex(GLenum pname, GLfixed eqn[4]) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetClipPlanex, "glGetClipPlanex")) {
+        GLCallCounter counter(glContext, GLMessage::glGetClipPlanex, "glGetClipPlanex");
+        glContext->hooks->gl.glGetClipPlanex(pname, eqn);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetClipPlanex);
 
     // copy argument pname
@@ -17489,9 +19922,15 @@ void GLTrace_glGetClipPlanex(GLenum pname, GLfixed eqn[4]) {
 }
 
 void GLTrace_glGetFixedv(GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetFixedv, "glGetFixedv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetFixedv, "glGetFixedv");
+        glContext->hooks->gl.glGetFixedv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetFixedv);
 
     // copy argument pname
@@ -17524,9 +19963,15 @@ void GLTrace_glGetFixedv(GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glGetLightxv(GLenum light, GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetLightxv, "glGetLightxv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetLightxv, "glGetLightxv");
+        glContext->hooks->gl.glGetLightxv(light, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetLightxv);
 
     // copy argument light
@@ -17565,9 +20010,15 @@ void GLTrace_glGetLightxv(GLenum light, GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glGetMaterialxv(GLenum face, GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetMaterialxv, "glGetMaterialxv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetMaterialxv, "glGetMaterialxv");
+        glContext->hooks->gl.glGetMaterialxv(face, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetMaterialxv);
 
     // copy argument face
@@ -17606,9 +20057,15 @@ void GLTrace_glGetMaterialxv(GLenum face, GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glGetPointerv(GLenum pname, GLvoid **params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetPointerv, "glGetPointerv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetPointerv, "glGetPointerv");
+        glContext->hooks->gl.glGetPointerv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetPointerv);
 
     // copy argument pname
@@ -17641,9 +20098,15 @@ void GLTrace_glGetPointerv(GLenum pname, GLvoid **params) {
 }
 
 void GLTrace_glGetTexEnviv(GLenum env, GLenum pname, GLint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexEnviv, "glGetTexEnviv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexEnviv, "glGetTexEnviv");
+        glContext->hooks->gl.glGetTexEnviv(env, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexEnviv);
 
     // copy argument env
@@ -17682,9 +20145,15 @@ void GLTrace_glGetTexEnviv(GLenum env, GLenum pname, GLint *params) {
 }
 
 void GLTrace_glGetTexEnvxv(GLenum env, GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexEnvxv, "glGetTexEnvxv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexEnvxv, "glGetTexEnvxv");
+        glContext->hooks->gl.glGetTexEnvxv(env, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexEnvxv);
 
     // copy argument env
@@ -17723,9 +20192,15 @@ void GLTrace_glGetTexEnvxv(GLenum env, GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glGetTexParameterxv(GLenum target, GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexParameterxv, "glGetTexParameterxv")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexParameterxv, "glGetTexParameterxv");
+        glContext->hooks->gl.glGetTexParameterxv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexParameterxv);
 
     // copy argument target
@@ -17764,9 +20239,15 @@ void GLTrace_glGetTexParameterxv(GLenum target, GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glLightModelx(GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightModelx, "glLightModelx")) {
+        GLCallCounter counter(glContext, GLMessage::glLightModelx, "glLightModelx");
+        glContext->hooks->gl.glLightModelx(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightModelx);
 
     // copy argument pname
@@ -17798,9 +20279,15 @@ void GLTrace_glLightModelx(GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glLightModelxv(GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightModelxv, "glLightModelxv")) {
+        GLCallCounter counter(glContext, GLMessage::glLightModelxv, "glLightModelxv");
+        glContext->hooks->gl.glLightModelxv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightModelxv);
 
     // copy argument pname
@@ -17833,9 +20320,15 @@ void GLTrace_glLightModelxv(GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glLightx(GLenum light, GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightx, "glLightx")) {
+        GLCallCounter counter(glContext, GLMessage::glLightx, "glLightx");
+        glContext->hooks->gl.glLightx(light, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightx);
 
     // copy argument light
@@ -17873,9 +20366,15 @@ void GLTrace_glLightx(GLenum light, GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glLightxv(GLenum light, GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightxv, "glLightxv")) {
+        GLCallCounter counter(glContext, GLMessage::glLightxv, "glLightxv");
+        glContext->hooks->gl.glLightxv(light, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightxv);
 
     // copy argument light
@@ -17914,9 +20413,15 @@ void GLTrace_glLightxv(GLenum light, GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glLineWidthx(GLfixed width) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLineWidthx, "glLineWidthx")) {
+        GLCallCounter counter(glContext, GLMessage::glLineWidthx, "glLineWidthx");
+        glContext->hooks->gl.glLineWidthx(width);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLineWidthx);
 
     // copy argument width
@@ -17942,9 +20447,15 @@ void GLTrace_glLineWidthx(GLfixed width) {
 }
 
 void GLTrace_glLoadIdentity(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLoadIdentity, "glLoadIdentity")) {
+        GLCallCounter counter(glContext, GLMessage::glLoadIdentity, "glLoadIdentity");
+        glContext->hooks->gl.glLoadIdentity();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLoadIdentity);
 
     // call function
@@ -17964,9 +20475,15 @@ void GLTrace_glLoadIdentity(void) {
 }
 
 void GLTrace_glLoadMatrixx(const GLfixed *m) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLoadMatrixx, "glLoadMatrixx")) {
+        GLCallCounter counter(glContext, GLMessage::glLoadMatrixx, "glLoadMatrixx");
+        glContext->hooks->gl.glLoadMatrixx(m);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLoadMatrixx);
 
     // copy argument m
@@ -17993,9 +20510,15 @@ void GLTrace_glLoadMatrixx(const GLfixed *m) {
 }
 
 void GLTrace_glLogicOp(GLenum opcode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLogicOp, "glLogicOp")) {
+        GLCallCounter counter(glContext, GLMessage::glLogicOp, "glLogicOp");
+        glContext->hooks->gl.glLogicOp(opcode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLogicOp);
 
     // copy argument opcode
@@ -18021,9 +20544,15 @@ void GLTrace_glLogicOp(GLenum opcode) {
 }
 
 void GLTrace_glMaterialx(GLenum face, GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMaterialx, "glMaterialx")) {
+        GLCallCounter counter(glContext, GLMessage::glMaterialx, "glMaterialx");
+        glContext->hooks->gl.glMaterialx(face, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMaterialx);
 
     // copy argument face
@@ -18061,9 +20590,15 @@ void GLTrace_glMaterialx(GLenum face, GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glMaterialxv(GLenum face, GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMaterialxv, "glMaterialxv")) {
+        GLCallCounter counter(glContext, GLMessage::glMaterialxv, "glMaterialxv");
+        glContext->hooks->gl.glMaterialxv(face, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMaterialxv);
 
     // copy argument face
@@ -18102,9 +20637,15 @@ void GLTrace_glMaterialxv(GLenum face, GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glMatrixMode(GLenum mode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMatrixMode, "glMatrixMode")) {
+        GLCallCounter counter(glContext, GLMessage::glMatrixMode, "glMatrixMode");
+        glContext->hooks->gl.glMatrixMode(mode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMatrixMode);
 
     // copy argument mode
@@ -18130,9 +20671,15 @@ void GLTrace_glMatrixMode(GLenum mode) {
 }
 
 void GLTrace_glMultMatrixx(const GLfixed *m) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMultMatrixx, "glMultMatrixx")) {
+        GLCallCounter counter(glContext, GLMessage::glMultMatrixx, "glMultMatrixx");
+        glContext->hooks->gl.glMultMatrixx(m);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMultMatrixx);
 
     // copy argument m
@@ -18159,9 +20706,15 @@ void GLTrace_glMultMatrixx(const GLfixed *m) {
 }
 
 void GLTrace_glMultiTexCoord4x(GLenum target, GLfixed s, GLfixed t, GLfixed r, GLfixed q) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMultiTexCoord4x, "glMultiTexCoord4x")) {
+        GLCallCounter counter(glContext, GLMessage::glMultiTexCoord4x, "glMultiTexCoord4x");
+        glContext->hooks->gl.glMultiTexCoord4x(target, s, t, r, q);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMultiTexCoord4x);
 
     // copy argument target
@@ -18211,9 +20764,15 @@ void GLTrace_glMultiTexCoord4x(GLenum target, GLfixed s, GLfixed t, GLfixed r, G
 }
 
 void GLTrace_glNormal3x(GLfixed nx, GLfixed ny, GLfixed nz) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glNormal3x, "glNormal3x")) {
+        GLCallCounter counter(glContext, GLMessage::glNormal3x, "glNormal3x");
+        glContext->hooks->gl.glNormal3x(nx, ny, nz);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glNormal3x);
 
     // copy argument nx
@@ -18251,9 +20810,15 @@ void GLTrace_glNormal3x(GLfixed nx, GLfixed ny, GLfixed nz) {
 }
 
 void GLTrace_glNormalPointer(GLenum type, GLsizei stride, const GLvoid *pointer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glNormalPointer, "glNormalPointer")) {
+        GLCallCounter counter(glContext, GLMessage::glNormalPointer, "glNormalPointer");
+        glContext->hooks->gl.glNormalPointer(type, stride, pointer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glNormalPointer);
 
     // copy argument type
@@ -18292,9 +20857,15 @@ void GLTrace_glNormalPointer(GLenum type, GLsizei stride, const GLvoid *pointer)
 }
 
 void GLTrace_glOrthox(GLfixed left, GLfixed right, GLfixed bottom, GLfixed top, GLfixed zNear, GLfixed zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glOrthox, "glOrthox")) {
+        GLCallCounter counter(glContext, GLMessage::glOrthox, "glOrthox");
+        glContext->hooks->gl.glOrthox(left, right, bottom, top, zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glOrthox);
 
     // copy argument left
@@ -18350,9 +20921,15 @@ void GLTrace_glOrthox(GLfixed left, GLfixed right, GLfixed bottom, GLfixed top,
 }
 
 void GLTrace_glPointParameterx(GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointParameterx, "glPointParameterx")) {
+        GLCallCounter counter(glContext, GLMessage::glPointParameterx, "glPointParameterx");
+        glContext->hooks->gl.glPointParameterx(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointParameterx);
 
     // copy argument pname
@@ -18384,9 +20961,15 @@ void GLTrace_glPointParameterx(GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glPointParameterxv(GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointParameterxv, "glPointParameterxv")) {
+        GLCallCounter counter(glContext, GLMessage::glPointParameterxv, "glPointParameterxv");
+        glContext->hooks->gl.glPointParameterxv(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointParameterxv);
 
     // copy argument pname
@@ -18419,9 +21002,15 @@ void GLTrace_glPointParameterxv(GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glPointSizex(GLfixed size) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointSizex, "glPointSizex")) {
+        GLCallCounter counter(glContext, GLMessage::glPointSizex, "glPointSizex");
+        glContext->hooks->gl.glPointSizex(size);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointSizex);
 
     // copy argument size
@@ -18447,9 +21036,15 @@ void GLTrace_glPointSizex(GLfixed size) {
 }
 
 void GLTrace_glPolygonOffsetx(GLfixed factor, GLfixed units) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPolygonOffsetx, "glPolygonOffsetx")) {
+        GLCallCounter counter(glContext, GLMessage::glPolygonOffsetx, "glPolygonOffsetx");
+        glContext->hooks->gl.glPolygonOffsetx(factor, units);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPolygonOffsetx);
 
     // copy argument factor
@@ -18481,9 +21076,15 @@ void GLTrace_glPolygonOffsetx(GLfixed factor, GLfixed units) {
 }
 
 void GLTrace_glPopMatrix(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPopMatrix, "glPopMatrix")) {
+        GLCallCounter counter(glContext, GLMessage::glPopMatrix, "glPopMatrix");
+        glContext->hooks->gl.glPopMatrix();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPopMatrix);
 
     // call function
@@ -18503,9 +21104,15 @@ void GLTrace_glPopMatrix(void) {
 }
 
 void GLTrace_glPushMatrix(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPushMatrix, "glPushMatrix")) {
+        GLCallCounter counter(glContext, GLMessage::glPushMatrix, "glPushMatrix");
+        glContext->hooks->gl.glPushMatrix();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPushMatrix);
 
     // call function
@@ -18525,9 +21132,15 @@ void GLTrace_glPushMatrix(void) {
 }
 
 void GLTrace_glRotatex(GLfixed angle, GLfixed x, GLfixed y, GLfixed z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRotatex, "glRotatex")) {
+        GLCallCounter counter(glContext, GLMessage::glRotatex, "glRotatex");
+        glContext->hooks->gl.glRotatex(angle, x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRotatex);
 
     // copy argument angle
@@ -18571,9 +21184,15 @@ void GLTrace_glRotatex(GLfixed angle, GLfixed x, GLfixed y, GLfixed z) {
 }
 
 void GLTrace_glSampleCoveragex(GLclampx value, GLboolean invert) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glSampleCoveragex, "glSampleCoveragex")) {
+        GLCallCounter counter(glContext, GLMessage::glSampleCoveragex, "glSampleCoveragex");
+        glContext->hooks->gl.glSampleCoveragex(value, invert);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glSampleCoveragex);
 
     // copy argument value
@@ -18605,9 +21224,15 @@ void GLTrace_glSampleCoveragex(GLclampx value, GLboolean invert) {
 }
 
 void GLTrace_glScalex(GLfixed x, GLfixed y, GLfixed z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glScalex, "glScalex")) {
+        GLCallCounter counter(glContext, GLMessage::glScalex, "glScalex");
+        glContext->hooks->gl.glScalex(x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glScalex);
 
     // copy argument x
@@ -18645,9 +21270,15 @@ void GLTrace_glScalex(GLfixed x, GLfixed y, GLfixed z) {
 }
 
 void GLTrace_glShadeModel(GLenum mode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glShadeModel, "glShadeModel")) {
+        GLCallCounter counter(glContext, GLMessage::glShadeModel, "glShadeModel");
+        glContext->hooks->gl.glShadeModel(mode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glShadeModel);
 
     // copy argument mode
@@ -18673,9 +21304,15 @@ void GLTrace_glShadeModel(GLenum mode) {
 }
 
 void GLTrace_glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexCoordPointer, "glTexCoordPointer")) {
+        GLCallCounter counter(glContext, GLMessage::glTexCoordPointer, "glTexCoordPointer");
+        glContext->hooks->gl.glTexCoordPointer(size, type, stride, pointer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexCoordPointer);
 
     // copy argument size
@@ -18720,9 +21357,15 @@ void GLTrace_glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GL
 }
 
 void GLTrace_glTexEnvi(GLenum target, GLenum pname, GLint param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexEnvi, "glTexEnvi")) {
+        GLCallCounter counter(glContext, GLMessage::glTexEnvi, "glTexEnvi");
+        glContext->hooks->gl.glTexEnvi(target, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexEnvi);
 
     // copy argument target
@@ -18760,9 +21403,15 @@ void GLTrace_glTexEnvi(GLenum target, GLenum pname, GLint param) {
 }
 
 void GLTrace_glTexEnvx(GLenum target, GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexEnvx, "glTexEnvx")) {
+        GLCallCounter counter(glContext, GLMessage::glTexEnvx, "glTexEnvx");
+        glContext->hooks->gl.glTexEnvx(target, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexEnvx);
 
     // copy argument target
@@ -18800,9 +21449,15 @@ void GLTrace_glTexEnvx(GLenum target, GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glTexEnviv(GLenum target, GLenum pname, const GLint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexEnviv, "glTexEnviv")) {
+        GLCallCounter counter(glContext, GLMessage::glTexEnviv, "glTexEnviv");
+        glContext->hooks->gl.glTexEnviv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexEnviv);
 
     // copy argument target
@@ -18841,9 +21496,15 @@ void GLTrace_glTexEnviv(GLenum target, GLenum pname, const GLint *params) {
 }
 
 void GLTrace_glTexEnvxv(GLenum target, GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexEnvxv, "glTexEnvxv")) {
+        GLCallCounter counter(glContext, GLMessage::glTexEnvxv, "glTexEnvxv");
+        glContext->hooks->gl.glTexEnvxv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexEnvxv);
 
     // copy argument target
@@ -18882,9 +21543,15 @@ void GLTrace_glTexEnvxv(GLenum target, GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glTexParameterx(GLenum target, GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexParameterx, "glTexParameterx")) {
+        GLCallCounter counter(glContext, GLMessage::glTexParameterx, "glTexParameterx");
+        glContext->hooks->gl.glTexParameterx(target, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexParameterx);
 
     // copy argument target
@@ -18922,9 +21589,15 @@ void GLTrace_glTexParameterx(GLenum target, GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glTexParameterxv(GLenum target, GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexParameterxv, "glTexParameterxv")) {
+        GLCallCounter counter(glContext, GLMessage::glTexParameterxv, "glTexParameterxv");
+        glContext->hooks->gl.glTexParameterxv(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexParameterxv);
 
     // copy argument target
@@ -18963,9 +21636,15 @@ void GLTrace_glTexParameterxv(GLenum target, GLenum pname, const GLfixed *params
 }
 
 void GLTrace_glTranslatex(GLfixed x, GLfixed y, GLfixed z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTranslatex, "glTranslatex")) {
+        GLCallCounter counter(glContext, GLMessage::glTranslatex, "glTranslatex");
+        glContext->hooks->gl.glTranslatex(x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTranslatex);
 
     // copy argument x
@@ -19003,9 +21682,15 @@ void GLTrace_glTranslatex(GLfixed x, GLfixed y, GLfixed z) {
 }
 
 void GLTrace_glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glVertexPointer, "glVertexPointer")) {
+        GLCallCounter counter(glContext, GLMessage::glVertexPointer, "glVertexPointer");
+        glContext->hooks->gl.glVertexPointer(size, type, stride, pointer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glVertexPointer);
 
     // copy argument size
@@ -19050,9 +21735,15 @@ void GLTrace_glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvo
 }
 
 void GLTrace_glPointSizePointerOES(GLenum type, GLsizei stride, const GLvoid *pointer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointSizePointerOES, "glPointSizePointerOES")) {
+        GLCallCounter counter(glContext, GLMessage::glPointSizePointerOES, "glPointSizePointerOES");
+        glContext->hooks->gl.glPointSizePointerOES(type, stride, pointer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointSizePointerOES);
 
     // copy argument type
@@ -19094,9 +21785,15 @@ void GLTrace_glPointSizePointerOES(GLenum type, GLsizei stride, const GLvoid *po
 // Definitions for GL1Ext APIs
 
 void GLTrace_glBlendEquationSeparateOES(GLenum modeRGB, GLenum modeAlpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlendEquationSeparateOES, "glBlendEquationSeparateOES")) {
+        GLCallCounter counter(glContext, GLMessage::glBlendEquationSeparateOES, "glBlendEquationSeparateOES");
+        glContext->hooks->gl.glBlendEquationSeparateOES(modeRGB, modeAlpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlendEquationSeparateOES);
 
     // copy argument modeRGB
@@ -19128,9 +21825,15 @@ void GLTrace_glBlendEquationSeparateOES(GLenum modeRGB, GLenum modeAlpha) {
 }
 
 void GLTrace_glBlendFuncSeparateOES(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlendFuncSeparateOES, "glBlendFuncSeparateOES")) {
+        GLCallCounter counter(glContext, GLMessage::glBlendFuncSeparateOES, "glBlendFuncSeparateOES");
+        glContext->hooks->gl.glBlendFuncSeparateOES(srcRGB, dstRGB, srcAlpha, dstAlpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlendFuncSeparateOES);
 
     // copy argument srcRGB
@@ -19174,9 +21877,15 @@ void GLTrace_glBlendFuncSeparateOES(GLenum srcRGB, GLenum dstRGB, GLenum srcAlph
 }
 
 void GLTrace_glBlendEquationOES(GLenum mode) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBlendEquationOES, "glBlendEquationOES")) {
+        GLCallCounter counter(glContext, GLMessage::glBlendEquationOES, "glBlendEquationOES");
+        glContext->hooks->gl.glBlendEquationOES(mode);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBlendEquationOES);
 
     // copy argument mode
@@ -19202,9 +21911,15 @@ void GLTrace_glBlendEquationOES(GLenum mode) {
 }
 
 void GLTrace_glDrawTexsOES(GLshort x, GLshort y, GLshort z, GLshort width, GLshort height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawTexsOES, "glDrawTexsOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawTexsOES, "glDrawTexsOES");
+        glContext->hooks->gl.glDrawTexsOES(x, y, z, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawTexsOES);
 
     // copy argument x
@@ -19254,9 +21969,15 @@ void GLTrace_glDrawTexsOES(GLshort x, GLshort y, GLshort z, GLshort width, GLsho
 }
 
 void GLTrace_glDrawTexiOES(GLint x, GLint y, GLint z, GLint width, GLint height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawTexiOES, "glDrawTexiOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawTexiOES, "glDrawTexiOES");
+        glContext->hooks->gl.glDrawTexiOES(x, y, z, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawTexiOES);
 
     // copy argument x
@@ -19306,9 +22027,15 @@ void GLTrace_glDrawTexiOES(GLint x, GLint y, GLint z, GLint width, GLint height)
 }
 
 void GLTrace_glDrawTexxOES(GLfixed x, GLfixed y, GLfixed z, GLfixed width, GLfixed height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawTexxOES, "glDrawTexxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawTexxOES, "glDrawTexxOES");
+        glContext->hooks->gl.glDrawTexxOES(x, y, z, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawTexxOES);
 
     // copy argument x
@@ -19358,9 +22085,15 @@ void GLTrace_glDrawTexxOES(GLfixed x, GLfixed y, GLfixed z, GLfixed width, GLfix
 }
 
 void GLTrace_glDrawTexsvOES(const GLshort *coords) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawTexsvOES, "glDrawTexsvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawTexsvOES, "glDrawTexsvOES");
+        glContext->hooks->gl.glDrawTexsvOES(coords);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawTexsvOES);
 
     // copy argument coords
@@ -19387,9 +22120,15 @@ void GLTrace_glDrawTexsvOES(const GLshort *coords) {
 }
 
 void GLTrace_glDrawTexivOES(const GLint *coords) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawTexivOES, "glDrawTexivOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawTexivOES, "glDrawTexivOES");
+        glContext->hooks->gl.glDrawTexivOES(coords);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawTexivOES);
 
     // copy argument coords
@@ -19416,9 +22155,15 @@ void GLTrace_glDrawTexivOES(const GLint *coords) {
 }
 
 void GLTrace_glDrawTexxvOES(const GLfixed *coords) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawTexxvOES, "glDrawTexxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawTexxvOES, "glDrawTexxvOES");
+        glContext->hooks->gl.glDrawTexxvOES(coords);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawTexxvOES);
 
     // copy argument coords
@@ -19445,9 +22190,15 @@ void GLTrace_glDrawTexxvOES(const GLfixed *coords) {
 }
 
 void GLTrace_glDrawTexfOES(GLfloat x, GLfloat y, GLfloat z, GLfloat width, GLfloat height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawTexfOES, "glDrawTexfOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawTexfOES, "glDrawTexfOES");
+        glContext->hooks->gl.glDrawTexfOES(x, y, z, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawTexfOES);
 
     // copy argument x
@@ -19497,9 +22248,15 @@ void GLTrace_glDrawTexfOES(GLfloat x, GLfloat y, GLfloat z, GLfloat width, GLflo
 }
 
 void GLTrace_glDrawTexfvOES(const GLfloat *coords) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDrawTexfvOES, "glDrawTexfvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDrawTexfvOES, "glDrawTexfvOES");
+        glContext->hooks->gl.glDrawTexfvOES(coords);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDrawTexfvOES);
 
     // copy argument coords
@@ -19526,9 +22283,15 @@ void GLTrace_glDrawTexfvOES(const GLfloat *coords) {
 }
 
 void GLTrace_glAlphaFuncxOES(GLenum func, GLclampx ref) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glAlphaFuncxOES, "glAlphaFuncxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glAlphaFuncxOES, "glAlphaFuncxOES");
+        glContext->hooks->gl.glAlphaFuncxOES(func, ref);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glAlphaFuncxOES);
 
     // copy argument func
@@ -19560,9 +22323,15 @@ void GLTrace_glAlphaFuncxOES(GLenum func, GLclampx ref) {
 }
 
 void GLTrace_glClearColorxOES(GLclampx red, GLclampx green, GLclampx blue, GLclampx alpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearColorxOES, "glClearColorxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glClearColorxOES, "glClearColorxOES");
+        glContext->hooks->gl.glClearColorxOES(red, green, blue, alpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearColorxOES);
 
     // copy argument red
@@ -19606,9 +22375,15 @@ void GLTrace_glClearColorxOES(GLclampx red, GLclampx green, GLclampx blue, GLcla
 }
 
 void GLTrace_glClearDepthxOES(GLclampx depth) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearDepthxOES, "glClearDepthxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glClearDepthxOES, "glClearDepthxOES");
+        glContext->hooks->gl.glClearDepthxOES(depth);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearDepthxOES);
 
     // copy argument depth
@@ -19634,9 +22409,15 @@ void GLTrace_glClearDepthxOES(GLclampx depth) {
 }
 
 void GLTrace_glClipPlanexOES(GLenum plane, const GLfixed *equation) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClipPlanexOES, "glClipPlanexOES")) {
+        GLCallCounter counter(glContext, GLMessage::glClipPlanexOES, "glClipPlanexOES");
+        glContext->hooks->gl.glClipPlanexOES(plane, equation);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClipPlanexOES);
 
     // copy argument plane
@@ -19669,9 +22450,15 @@ void GLTrace_glClipPlanexOES(GLenum plane, const GLfixed *equation) {
 }
 
 void GLTrace_glColor4xOES(GLfixed red, GLfixed green, GLfixed blue, GLfixed alpha) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glColor4xOES, "glColor4xOES")) {
+        GLCallCounter counter(glContext, GLMessage::glColor4xOES, "glColor4xOES");
+        glContext->hooks->gl.glColor4xOES(red, green, blue, alpha);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glColor4xOES);
 
     // copy argument red
@@ -19715,9 +22502,15 @@ void GLTrace_glColor4xOES(GLfixed red, GLfixed green, GLfixed blue, GLfixed alph
 }
 
 void GLTrace_glDepthRangexOES(GLclampx zNear, GLclampx zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDepthRangexOES, "glDepthRangexOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDepthRangexOES, "glDepthRangexOES");
+        glContext->hooks->gl.glDepthRangexOES(zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDepthRangexOES);
 
     // copy argument zNear
@@ -19749,9 +22542,15 @@ void GLTrace_glDepthRangexOES(GLclampx zNear, GLclampx zFar) {
 }
 
 void GLTrace_glFogxOES(GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFogxOES, "glFogxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glFogxOES, "glFogxOES");
+        glContext->hooks->gl.glFogxOES(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFogxOES);
 
     // copy argument pname
@@ -19783,9 +22582,15 @@ void GLTrace_glFogxOES(GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glFogxvOES(GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFogxvOES, "glFogxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glFogxvOES, "glFogxvOES");
+        glContext->hooks->gl.glFogxvOES(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFogxvOES);
 
     // copy argument pname
@@ -19818,9 +22623,15 @@ void GLTrace_glFogxvOES(GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glFrustumxOES(GLfixed left, GLfixed right, GLfixed bottom, GLfixed top, GLfixed zNear, GLfixed zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFrustumxOES, "glFrustumxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glFrustumxOES, "glFrustumxOES");
+        glContext->hooks->gl.glFrustumxOES(left, right, bottom, top, zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFrustumxOES);
 
     // copy argument left
@@ -19876,9 +22687,15 @@ void GLTrace_glFrustumxOES(GLfixed left, GLfixed right, GLfixed bottom, GLfixed
 }
 
 void GLTrace_glGetClipPlanexOES(GLenum pname, GLfixed eqn[4]) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetClipPlanexOES, "glGetClipPlanexOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetClipPlanexOES, "glGetClipPlanexOES");
+        glContext->hooks->gl.glGetClipPlanexOES(pname, eqn);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetClipPlanexOES);
 
     // copy argument pname
@@ -19911,9 +22728,15 @@ void GLTrace_glGetClipPlanexOES(GLenum pname, GLfixed eqn[4]) {
 }
 
 void GLTrace_glGetFixedvOES(GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetFixedvOES, "glGetFixedvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetFixedvOES, "glGetFixedvOES");
+        glContext->hooks->gl.glGetFixedvOES(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetFixedvOES);
 
     // copy argument pname
@@ -19946,9 +22769,15 @@ void GLTrace_glGetFixedvOES(GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glGetLightxvOES(GLenum light, GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetLightxvOES, "glGetLightxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetLightxvOES, "glGetLightxvOES");
+        glContext->hooks->gl.glGetLightxvOES(light, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetLightxvOES);
 
     // copy argument light
@@ -19987,9 +22816,15 @@ void GLTrace_glGetLightxvOES(GLenum light, GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glGetMaterialxvOES(GLenum face, GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetMaterialxvOES, "glGetMaterialxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetMaterialxvOES, "glGetMaterialxvOES");
+        glContext->hooks->gl.glGetMaterialxvOES(face, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetMaterialxvOES);
 
     // copy argument face
@@ -20028,9 +22863,15 @@ void GLTrace_glGetMaterialxvOES(GLenum face, GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glGetTexEnvxvOES(GLenum env, GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexEnvxvOES, "glGetTexEnvxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexEnvxvOES, "glGetTexEnvxvOES");
+        glContext->hooks->gl.glGetTexEnvxvOES(env, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexEnvxvOES);
 
     // copy argument env
@@ -20069,9 +22910,15 @@ void GLTrace_glGetTexEnvxvOES(GLenum env, GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glGetTexParameterxvOES(GLenum target, GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexParameterxvOES, "glGetTexParameterxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexParameterxvOES, "glGetTexParameterxvOES");
+        glContext->hooks->gl.glGetTexParameterxvOES(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexParameterxvOES);
 
     // copy argument target
@@ -20110,9 +22957,15 @@ void GLTrace_glGetTexParameterxvOES(GLenum target, GLenum pname, GLfixed *params
 }
 
 void GLTrace_glLightModelxOES(GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightModelxOES, "glLightModelxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glLightModelxOES, "glLightModelxOES");
+        glContext->hooks->gl.glLightModelxOES(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightModelxOES);
 
     // copy argument pname
@@ -20144,9 +22997,15 @@ void GLTrace_glLightModelxOES(GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glLightModelxvOES(GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightModelxvOES, "glLightModelxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glLightModelxvOES, "glLightModelxvOES");
+        glContext->hooks->gl.glLightModelxvOES(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightModelxvOES);
 
     // copy argument pname
@@ -20179,9 +23038,15 @@ void GLTrace_glLightModelxvOES(GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glLightxOES(GLenum light, GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightxOES, "glLightxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glLightxOES, "glLightxOES");
+        glContext->hooks->gl.glLightxOES(light, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightxOES);
 
     // copy argument light
@@ -20219,9 +23084,15 @@ void GLTrace_glLightxOES(GLenum light, GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glLightxvOES(GLenum light, GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLightxvOES, "glLightxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glLightxvOES, "glLightxvOES");
+        glContext->hooks->gl.glLightxvOES(light, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLightxvOES);
 
     // copy argument light
@@ -20260,9 +23131,15 @@ void GLTrace_glLightxvOES(GLenum light, GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glLineWidthxOES(GLfixed width) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLineWidthxOES, "glLineWidthxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glLineWidthxOES, "glLineWidthxOES");
+        glContext->hooks->gl.glLineWidthxOES(width);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLineWidthxOES);
 
     // copy argument width
@@ -20288,9 +23165,15 @@ void GLTrace_glLineWidthxOES(GLfixed width) {
 }
 
 void GLTrace_glLoadMatrixxOES(const GLfixed *m) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLoadMatrixxOES, "glLoadMatrixxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glLoadMatrixxOES, "glLoadMatrixxOES");
+        glContext->hooks->gl.glLoadMatrixxOES(m);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLoadMatrixxOES);
 
     // copy argument m
@@ -20317,9 +23200,15 @@ void GLTrace_glLoadMatrixxOES(const GLfixed *m) {
 }
 
 void GLTrace_glMaterialxOES(GLenum face, GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMaterialxOES, "glMaterialxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glMaterialxOES, "glMaterialxOES");
+        glContext->hooks->gl.glMaterialxOES(face, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMaterialxOES);
 
     // copy argument face
@@ -20357,9 +23246,15 @@ void GLTrace_glMaterialxOES(GLenum face, GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glMaterialxvOES(GLenum face, GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMaterialxvOES, "glMaterialxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glMaterialxvOES, "glMaterialxvOES");
+        glContext->hooks->gl.glMaterialxvOES(face, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMaterialxvOES);
 
     // copy argument face
@@ -20398,9 +23293,15 @@ void GLTrace_glMaterialxvOES(GLenum face, GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glMultMatrixxOES(const GLfixed *m) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMultMatrixxOES, "glMultMatrixxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glMultMatrixxOES, "glMultMatrixxOES");
+        glContext->hooks->gl.glMultMatrixxOES(m);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMultMatrixxOES);
 
     // copy argument m
@@ -20427,9 +23328,15 @@ void GLTrace_glMultMatrixxOES(const GLfixed *m) {
 }
 
 void GLTrace_glMultiTexCoord4xOES(GLenum target, GLfixed s, GLfixed t, GLfixed r, GLfixed q) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMultiTexCoord4xOES, "glMultiTexCoord4xOES")) {
+        GLCallCounter counter(glContext, GLMessage::glMultiTexCoord4xOES, "glMultiTexCoord4xOES");
+        glContext->hooks->gl.glMultiTexCoord4xOES(target, s, t, r, q);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMultiTexCoord4xOES);
 
     // copy argument target
@@ -20479,9 +23386,15 @@ void GLTrace_glMultiTexCoord4xOES(GLenum target, GLfixed s, GLfixed t, GLfixed r
 }
 
 void GLTrace_glNormal3xOES(GLfixed nx, GLfixed ny, GLfixed nz) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glNormal3xOES, "glNormal3xOES")) {
+        GLCallCounter counter(glContext, GLMessage::glNormal3xOES, "glNormal3xOES");
+        glContext->hooks->gl.glNormal3xOES(nx, ny, nz);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glNormal3xOES);
 
     // copy argument nx
@@ -20519,9 +23432,15 @@ void GLTrace_glNormal3xOES(GLfixed nx, GLfixed ny, GLfixed nz) {
 }
 
 void GLTrace_glOrthoxOES(GLfixed left, GLfixed right, GLfixed bottom, GLfixed top, GLfixed zNear, GLfixed zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glOrthoxOES, "glOrthoxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glOrthoxOES, "glOrthoxOES");
+        glContext->hooks->gl.glOrthoxOES(left, right, bottom, top, zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glOrthoxOES);
 
     // copy argument left
@@ -20577,9 +23496,15 @@ void GLTrace_glOrthoxOES(GLfixed left, GLfixed right, GLfixed bottom, GLfixed to
 }
 
 void GLTrace_glPointParameterxOES(GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointParameterxOES, "glPointParameterxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glPointParameterxOES, "glPointParameterxOES");
+        glContext->hooks->gl.glPointParameterxOES(pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointParameterxOES);
 
     // copy argument pname
@@ -20611,9 +23536,15 @@ void GLTrace_glPointParameterxOES(GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glPointParameterxvOES(GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointParameterxvOES, "glPointParameterxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glPointParameterxvOES, "glPointParameterxvOES");
+        glContext->hooks->gl.glPointParameterxvOES(pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointParameterxvOES);
 
     // copy argument pname
@@ -20646,9 +23577,15 @@ void GLTrace_glPointParameterxvOES(GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glPointSizexOES(GLfixed size) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPointSizexOES, "glPointSizexOES")) {
+        GLCallCounter counter(glContext, GLMessage::glPointSizexOES, "glPointSizexOES");
+        glContext->hooks->gl.glPointSizexOES(size);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPointSizexOES);
 
     // copy argument size
@@ -20674,9 +23611,15 @@ void GLTrace_glPointSizexOES(GLfixed size) {
 }
 
 void GLTrace_glPolygonOffsetxOES(GLfixed factor, GLfixed units) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glPolygonOffsetxOES, "glPolygonOffsetxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glPolygonOffsetxOES, "glPolygonOffsetxOES");
+        glContext->hooks->gl.glPolygonOffsetxOES(factor, units);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glPolygonOffsetxOES);
 
     // copy argument factor
@@ -20708,9 +23651,15 @@ void GLTrace_glPolygonOffsetxOES(GLfixed factor, GLfixed units) {
 }
 
 void GLTrace_glRotatexOES(GLfixed angle, GLfixed x, GLfixed y, GLfixed z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRotatexOES, "glRotatexOES")) {
+        GLCallCounter counter(glContext, GLMessage::glRotatexOES, "glRotatexOES");
+        glContext->hooks->gl.glRotatexOES(angle, x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRotatexOES);
 
     // copy argument angle
@@ -20754,9 +23703,15 @@ void GLTrace_glRotatexOES(GLfixed angle, GLfixed x, GLfixed y, GLfixed z) {
 }
 
 void GLTrace_glSampleCoveragexOES(GLclampx value, GLboolean invert) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glSampleCoveragexOES, "glSampleCoveragexOES")) {
+        GLCallCounter counter(glContext, GLMessage::glSampleCoveragexOES, "glSampleCoveragexOES");
+        glContext->hooks->gl.glSampleCoveragexOES(value, invert);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glSampleCoveragexOES);
 
     // copy argument value
@@ -20788,9 +23743,15 @@ void GLTrace_glSampleCoveragexOES(GLclampx value, GLboolean invert) {
 }
 
 void GLTrace_glScalexOES(GLfixed x, GLfixed y, GLfixed z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glScalexOES, "glScalexOES")) {
+        GLCallCounter counter(glContext, GLMessage::glScalexOES, "glScalexOES");
+        glContext->hooks->gl.glScalexOES(x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glScalexOES);
 
     // copy argument x
@@ -20828,9 +23789,15 @@ void GLTrace_glScalexOES(GLfixed x, GLfixed y, GLfixed z) {
 }
 
 void GLTrace_glTexEnvxOES(GLenum target, GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexEnvxOES, "glTexEnvxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexEnvxOES, "glTexEnvxOES");
+        glContext->hooks->gl.glTexEnvxOES(target, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexEnvxOES);
 
     // copy argument target
@@ -20868,9 +23835,15 @@ void GLTrace_glTexEnvxOES(GLenum target, GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glTexEnvxvOES(GLenum target, GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexEnvxvOES, "glTexEnvxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexEnvxvOES, "glTexEnvxvOES");
+        glContext->hooks->gl.glTexEnvxvOES(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexEnvxvOES);
 
     // copy argument target
@@ -20909,9 +23882,15 @@ void GLTrace_glTexEnvxvOES(GLenum target, GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glTexParameterxOES(GLenum target, GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexParameterxOES, "glTexParameterxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexParameterxOES, "glTexParameterxOES");
+        glContext->hooks->gl.glTexParameterxOES(target, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexParameterxOES);
 
     // copy argument target
@@ -20949,9 +23928,15 @@ void GLTrace_glTexParameterxOES(GLenum target, GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glTexParameterxvOES(GLenum target, GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexParameterxvOES, "glTexParameterxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexParameterxvOES, "glTexParameterxvOES");
+        glContext->hooks->gl.glTexParameterxvOES(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexParameterxvOES);
 
     // copy argument target
@@ -20990,9 +23975,15 @@ void GLTrace_glTexParameterxvOES(GLenum target, GLenum pname, const GLfixed *par
 }
 
 void GLTrace_glTranslatexOES(GLfixed x, GLfixed y, GLfixed z) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTranslatexOES, "glTranslatexOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTranslatexOES, "glTranslatexOES");
+        glContext->hooks->gl.glTranslatexOES(x, y, z);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTranslatexOES);
 
     // copy argument x
@@ -21030,9 +24021,14 @@ void GLTrace_glTranslatexOES(GLfixed x, GLfixed y, GLfixed z) {
 }
 
 GLboolean GLTrace_glIsRenderbufferOES(GLuint renderbuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsRenderbufferOES, "glIsRenderbufferOES")) {
+        GLCallCounter counter(glContext, GLMessage::glIsRenderbufferOES, "glIsRenderbufferOES");
+        return glContext->hooks->gl.glIsRenderbufferOES(renderbuffer);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsRenderbufferOES);
 
     // copy argument renderbuffer
@@ -21066,9 +24062,15 @@ GLboolean GLTrace_glIsRenderbufferOES(GLuint renderbuffer) {
 }
 
 void GLTrace_glBindRenderbufferOES(GLenum target, GLuint renderbuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindRenderbufferOES, "glBindRenderbufferOES")) {
+        GLCallCounter counter(glContext, GLMessage::glBindRenderbufferOES, "glBindRenderbufferOES");
+        glContext->hooks->gl.glBindRenderbufferOES(target, renderbuffer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindRenderbufferOES);
 
     // copy argument target
@@ -21100,9 +24102,15 @@ void GLTrace_glBindRenderbufferOES(GLenum target, GLuint renderbuffer) {
 }
 
 void GLTrace_glDeleteRenderbuffersOES(GLsizei n, const GLuint* renderbuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteRenderbuffersOES, "glDeleteRenderbuffersOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteRenderbuffersOES, "glDeleteRenderbuffersOES");
+        glContext->hooks->gl.glDeleteRenderbuffersOES(n, renderbuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteRenderbuffersOES);
 
     // copy argument n
@@ -21135,9 +24143,15 @@ void GLTrace_glDeleteRenderbuffersOES(GLsizei n, const GLuint* renderbuffers) {
 }
 
 void GLTrace_glGenRenderbuffersOES(GLsizei n, GLuint* renderbuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenRenderbuffersOES, "glGenRenderbuffersOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGenRenderbuffersOES, "glGenRenderbuffersOES");
+        glContext->hooks->gl.glGenRenderbuffersOES(n, renderbuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenRenderbuffersOES);
 
     // copy argument n
@@ -21170,9 +24184,15 @@ void GLTrace_glGenRenderbuffersOES(GLsizei n, GLuint* renderbuffers) {
 }
 
 void GLTrace_glRenderbufferStorageOES(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glRenderbufferStorageOES, "glRenderbufferStorageOES")) {
+        GLCallCounter counter(glContext, GLMessage::glRenderbufferStorageOES, "glRenderbufferStorageOES");
+        glContext->hooks->gl.glRenderbufferStorageOES(target, internalformat, width, height);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glRenderbufferStorageOES);
 
     // copy argument target
@@ -21216,9 +24236,15 @@ void GLTrace_glRenderbufferStorageOES(GLenum target, GLenum internalformat, GLsi
 }
 
 void GLTrace_glGetRenderbufferParameterivOES(GLenum target, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetRenderbufferParameterivOES, "glGetRenderbufferParameterivOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetRenderbufferParameterivOES, "glGetRenderbufferParameterivOES");
+        glContext->hooks->gl.glGetRenderbufferParameterivOES(target, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetRenderbufferParameterivOES);
 
     // copy argument target
@@ -21257,9 +24283,14 @@ void GLTrace_glGetRenderbufferParameterivOES(GLenum target, GLenum pname, GLint*
 }
 
 GLboolean GLTrace_glIsFramebufferOES(GLuint framebuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glIsFramebufferOES, "glIsFramebufferOES")) {
+        GLCallCounter counter(glContext, GLMessage::glIsFramebufferOES, "glIsFramebufferOES");
+        return glContext->hooks->gl.glIsFramebufferOES(framebuffer);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glIsFramebufferOES);
 
     // copy argument framebuffer
@@ -21293,9 +24324,15 @@ GLboolean GLTrace_glIsFramebufferOES(GLuint framebuffer) {
 }
 
 void GLTrace_glBindFramebufferOES(GLenum target, GLuint framebuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glBindFramebufferOES, "glBindFramebufferOES")) {
+        GLCallCounter counter(glContext, GLMessage::glBindFramebufferOES, "glBindFramebufferOES");
+        glContext->hooks->gl.glBindFramebufferOES(target, framebuffer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glBindFramebufferOES);
 
     // copy argument target
@@ -21327,9 +24364,15 @@ void GLTrace_glBindFramebufferOES(GLenum target, GLuint framebuffer) {
 }
 
 void GLTrace_glDeleteFramebuffersOES(GLsizei n, const GLuint* framebuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDeleteFramebuffersOES, "glDeleteFramebuffersOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDeleteFramebuffersOES, "glDeleteFramebuffersOES");
+        glContext->hooks->gl.glDeleteFramebuffersOES(n, framebuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDeleteFramebuffersOES);
 
     // copy argument n
@@ -21362,9 +24405,15 @@ void GLTrace_glDeleteFramebuffersOES(GLsizei n, const GLuint* framebuffers) {
 }
 
 void GLTrace_glGenFramebuffersOES(GLsizei n, GLuint* framebuffers) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenFramebuffersOES, "glGenFramebuffersOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGenFramebuffersOES, "glGenFramebuffersOES");
+        glContext->hooks->gl.glGenFramebuffersOES(n, framebuffers);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenFramebuffersOES);
 
     // copy argument n
@@ -21397,9 +24446,14 @@ void GLTrace_glGenFramebuffersOES(GLsizei n, GLuint* framebuffers) {
 }
 
 GLenum GLTrace_glCheckFramebufferStatusOES(GLenum target) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCheckFramebufferStatusOES, "glCheckFramebufferStatusOES")) {
+        GLCallCounter counter(glContext, GLMessage::glCheckFramebufferStatusOES, "glCheckFramebufferStatusOES");
+        return glContext->hooks->gl.glCheckFramebufferStatusOES(target);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCheckFramebufferStatusOES);
 
     // copy argument target
@@ -21433,9 +24487,15 @@ GLenum GLTrace_glCheckFramebufferStatusOES(GLenum target) {
 }
 
 void GLTrace_glFramebufferRenderbufferOES(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFramebufferRenderbufferOES, "glFramebufferRenderbufferOES")) {
+        GLCallCounter counter(glContext, GLMessage::glFramebufferRenderbufferOES, "glFramebufferRenderbufferOES");
+        glContext->hooks->gl.glFramebufferRenderbufferOES(target, attachment, renderbuffertarget, renderbuffer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFramebufferRenderbufferOES);
 
     // copy argument target
@@ -21479,9 +24539,15 @@ void GLTrace_glFramebufferRenderbufferOES(GLenum target, GLenum attachment, GLen
 }
 
 void GLTrace_glFramebufferTexture2DOES(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFramebufferTexture2DOES, "glFramebufferTexture2DOES")) {
+        GLCallCounter counter(glContext, GLMessage::glFramebufferTexture2DOES, "glFramebufferTexture2DOES");
+        glContext->hooks->gl.glFramebufferTexture2DOES(target, attachment, textarget, texture, level);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFramebufferTexture2DOES);
 
     // copy argument target
@@ -21531,9 +24597,15 @@ void GLTrace_glFramebufferTexture2DOES(GLenum target, GLenum attachment, GLenum
 }
 
 void GLTrace_glGetFramebufferAttachmentParameterivOES(GLenum target, GLenum attachment, GLenum pname, GLint* params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetFramebufferAttachmentParameterivOES, "glGetFramebufferAttachmentParameterivOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetFramebufferAttachmentParameterivOES, "glGetFramebufferAttachmentParameterivOES");
+        glContext->hooks->gl.glGetFramebufferAttachmentParameterivOES(target, attachment, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetFramebufferAttachmentParameterivOES);
 
     // copy argument target
@@ -21578,9 +24650,15 @@ void GLTrace_glGetFramebufferAttachmentParameterivOES(GLenum target, GLenum atta
 }
 
 void GLTrace_glGenerateMipmapOES(GLenum target) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGenerateMipmapOES, "glGenerateMipmapOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGenerateMipmapOES, "glGenerateMipmapOES");
+        glContext->hooks->gl.glGenerateMipmapOES(target);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGenerateMipmapOES);
 
     // copy argument target
@@ -21606,9 +24684,15 @@ void GLTrace_glGenerateMipmapOES(GLenum target) {
 }
 
 void GLTrace_glCurrentPaletteMatrixOES(GLuint matrixpaletteindex) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glCurrentPaletteMatrixOES, "glCurrentPaletteMatrixOES")) {
+        GLCallCounter counter(glContext, GLMessage::glCurrentPaletteMatrixOES, "glCurrentPaletteMatrixOES");
+        glContext->hooks->gl.glCurrentPaletteMatrixOES(matrixpaletteindex);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glCurrentPaletteMatrixOES);
 
     // copy argument matrixpaletteindex
@@ -21634,9 +24718,15 @@ void GLTrace_glCurrentPaletteMatrixOES(GLuint matrixpaletteindex) {
 }
 
 void GLTrace_glLoadPaletteFromModelViewMatrixOES(void) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glLoadPaletteFromModelViewMatrixOES, "glLoadPaletteFromModelViewMatrixOES")) {
+        GLCallCounter counter(glContext, GLMessage::glLoadPaletteFromModelViewMatrixOES, "glLoadPaletteFromModelViewMatrixOES");
+        glContext->hooks->gl.glLoadPaletteFromModelViewMatrixOES();
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glLoadPaletteFromModelViewMatrixOES);
 
     // call function
@@ -21656,9 +24746,15 @@ void GLTrace_glLoadPaletteFromModelViewMatrixOES(void) {
 }
 
 void GLTrace_glMatrixIndexPointerOES(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glMatrixIndexPointerOES, "glMatrixIndexPointerOES")) {
+        GLCallCounter counter(glContext, GLMessage::glMatrixIndexPointerOES, "glMatrixIndexPointerOES");
+        glContext->hooks->gl.glMatrixIndexPointerOES(size, type, stride, pointer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glMatrixIndexPointerOES);
 
     // copy argument size
@@ -21703,9 +24799,15 @@ void GLTrace_glMatrixIndexPointerOES(GLint size, GLenum type, GLsizei stride, co
 }
 
 void GLTrace_glWeightPointerOES(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glWeightPointerOES, "glWeightPointerOES")) {
+        GLCallCounter counter(glContext, GLMessage::glWeightPointerOES, "glWeightPointerOES");
+        glContext->hooks->gl.glWeightPointerOES(size, type, stride, pointer);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glWeightPointerOES);
 
     // copy argument size
@@ -21750,9 +24852,14 @@ void GLTrace_glWeightPointerOES(GLint size, GLenum type, GLsizei stride, const G
 }
 
 GLbitfield GLTrace_glQueryMatrixxOES(GLfixed mantissa[16], GLint exponent[16]) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glQueryMatrixxOES, "glQueryMatrixxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glQueryMatrixxOES, "glQueryMatrixxOES");
+        return glContext->hooks->gl.glQueryMatrixxOES(mantissa, exponent);
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glQueryMatrixxOES);
 
     // copy argument mantissa
@@ -21794,9 +24901,15 @@ GLbitfield GLTrace_glQueryMatrixxOES(GLfixed mantissa[16], GLint exponent[16]) {
 }
 
 void GLTrace_glDepthRangefOES(GLclampf zNear, GLclampf zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glDepthRangefOES, "glDepthRangefOES")) {
+        GLCallCounter counter(glContext, GLMessage::glDepthRangefOES, "glDepthRangefOES");
+        glContext->hooks->gl.glDepthRangefOES(zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glDepthRangefOES);
 
     // copy argument zNear
@@ -21828,9 +24941,15 @@ void GLTrace_glDepthRangefOES(GLclampf zNear, GLclampf zFar) {
 }
 
 void GLTrace_glFrustumfOES(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glFrustumfOES, "glFrustumfOES")) {
+        GLCallCounter counter(glContext, GLMessage::glFrustumfOES, "glFrustumfOES");
+        glContext->hooks->gl.glFrustumfOES(left, right, bottom, top, zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glFrustumfOES);
 
     // copy argument left
@@ -21886,9 +25005,15 @@ void GLTrace_glFrustumfOES(GLfloat left, GLfloat right, GLfloat bottom, GLfloat
 }
 
 void GLTrace_glOrthofOES(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glOrthofOES, "glOrthofOES")) {
+        GLCallCounter counter(glContext, GLMessage::glOrthofOES, "glOrthofOES");
+        glContext->hooks->gl.glOrthofOES(left, right, bottom, top, zNear, zFar);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glOrthofOES);
 
     // copy argument left
@@ -21944,9 +25069,15 @@ void GLTrace_glOrthofOES(GLfloat left, GLfloat right, GLfloat bottom, GLfloat to
 }
 
 void GLTrace_glClipPlanefOES(GLenum plane, const GLfloat *equation) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClipPlanefOES, "glClipPlanefOES")) {
+        GLCallCounter counter(glContext, GLMessage::glClipPlanefOES, "glClipPlanefOES");
+        glContext->hooks->gl.glClipPlanefOES(plane, equation);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClipPlanefOES);
 
     // copy argument plane
@@ -21979,9 +25110,15 @@ void GLTrace_glClipPlanefOES(GLenum plane, const GLfloat *equation) {
 }
 
 void GLTrace_glGetClipPlanefOES(GLenum pname, GLfloat eqn[4]) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetClipPlanefOES, "glGetClipPlanefOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetClipPlanefOES, "glGetClipPlanefOES");
+        glContext->hooks->gl.glGetClipPlanefOES(pname, eqn);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetClipPlanefOES);
 
     // copy argument pname
@@ -22014,9 +25151,15 @@ void GLTrace_glGetClipPlanefOES(GLenum pname, GLfloat eqn[4]) {
 }
 
 void GLTrace_glClearDepthfOES(GLclampf depth) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClearDepthfOES, "glClearDepthfOES")) {
+        GLCallCounter counter(glContext, GLMessage::glClearDepthfOES, "glClearDepthfOES");
+        glContext->hooks->gl.glClearDepthfOES(depth);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClearDepthfOES);
 
     // copy argument depth
@@ -22042,9 +25185,15 @@ void GLTrace_glClearDepthfOES(GLclampf depth) {
 }
 
 void GLTrace_glTexGenfOES(GLenum coord, GLenum pname, GLfloat param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexGenfOES, "glTexGenfOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexGenfOES, "glTexGenfOES");
+        glContext->hooks->gl.glTexGenfOES(coord, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexGenfOES);
 
     // copy argument coord
@@ -22082,9 +25231,15 @@ void GLTrace_glTexGenfOES(GLenum coord, GLenum pname, GLfloat param) {
 }
 
 void GLTrace_glTexGenfvOES(GLenum coord, GLenum pname, const GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexGenfvOES, "glTexGenfvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexGenfvOES, "glTexGenfvOES");
+        glContext->hooks->gl.glTexGenfvOES(coord, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexGenfvOES);
 
     // copy argument coord
@@ -22123,9 +25278,15 @@ void GLTrace_glTexGenfvOES(GLenum coord, GLenum pname, const GLfloat *params) {
 }
 
 void GLTrace_glTexGeniOES(GLenum coord, GLenum pname, GLint param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexGeniOES, "glTexGeniOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexGeniOES, "glTexGeniOES");
+        glContext->hooks->gl.glTexGeniOES(coord, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexGeniOES);
 
     // copy argument coord
@@ -22163,9 +25324,15 @@ void GLTrace_glTexGeniOES(GLenum coord, GLenum pname, GLint param) {
 }
 
 void GLTrace_glTexGenivOES(GLenum coord, GLenum pname, const GLint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexGenivOES, "glTexGenivOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexGenivOES, "glTexGenivOES");
+        glContext->hooks->gl.glTexGenivOES(coord, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexGenivOES);
 
     // copy argument coord
@@ -22204,9 +25371,15 @@ void GLTrace_glTexGenivOES(GLenum coord, GLenum pname, const GLint *params) {
 }
 
 void GLTrace_glTexGenxOES(GLenum coord, GLenum pname, GLfixed param) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexGenxOES, "glTexGenxOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexGenxOES, "glTexGenxOES");
+        glContext->hooks->gl.glTexGenxOES(coord, pname, param);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexGenxOES);
 
     // copy argument coord
@@ -22244,9 +25417,15 @@ void GLTrace_glTexGenxOES(GLenum coord, GLenum pname, GLfixed param) {
 }
 
 void GLTrace_glTexGenxvOES(GLenum coord, GLenum pname, const GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glTexGenxvOES, "glTexGenxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glTexGenxvOES, "glTexGenxvOES");
+        glContext->hooks->gl.glTexGenxvOES(coord, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glTexGenxvOES);
 
     // copy argument coord
@@ -22285,9 +25464,15 @@ void GLTrace_glTexGenxvOES(GLenum coord, GLenum pname, const GLfixed *params) {
 }
 
 void GLTrace_glGetTexGenfvOES(GLenum coord, GLenum pname, GLfloat *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexGenfvOES, "glGetTexGenfvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexGenfvOES, "glGetTexGenfvOES");
+        glContext->hooks->gl.glGetTexGenfvOES(coord, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexGenfvOES);
 
     // copy argument coord
@@ -22326,9 +25511,15 @@ void GLTrace_glGetTexGenfvOES(GLenum coord, GLenum pname, GLfloat *params) {
 }
 
 void GLTrace_glGetTexGenivOES(GLenum coord, GLenum pname, GLint *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexGenivOES, "glGetTexGenivOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexGenivOES, "glGetTexGenivOES");
+        glContext->hooks->gl.glGetTexGenivOES(coord, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexGenivOES);
 
     // copy argument coord
@@ -22367,9 +25558,15 @@ void GLTrace_glGetTexGenivOES(GLenum coord, GLenum pname, GLint *params) {
 }
 
 void GLTrace_glGetTexGenxvOES(GLenum coord, GLenum pname, GLfixed *params) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glGetTexGenxvOES, "glGetTexGenxvOES")) {
+        GLCallCounter counter(glContext, GLMessage::glGetTexGenxvOES, "glGetTexGenxvOES");
+        glContext->hooks->gl.glGetTexGenxvOES(coord, pname, params);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glGetTexGenxvOES);
 
     // copy argument coord
@@ -22408,9 +25605,15 @@ void GLTrace_glGetTexGenxvOES(GLenum coord, GLenum pname, GLfixed *params) {
 }
 
 void GLTrace_glClipPlanefIMG(GLenum p, const GLfloat *eqn) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClipPlanefIMG, "glClipPlanefIMG")) {
+        GLCallCounter counter(glContext, GLMessage::glClipPlanefIMG, "glClipPlanefIMG");
+        glContext->hooks->gl.glClipPlanefIMG(p, eqn);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClipPlanefIMG);
 
     // copy argument p
@@ -22443,9 +25646,15 @@ void GLTrace_glClipPlanefIMG(GLenum p, const GLfloat *eqn) {
 }
 
 void GLTrace_glClipPlanexIMG(GLenum p, const GLfixed *eqn) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
 
+    if (!glContext->shouldTrace(GLMessage::glClipPlanexIMG, "glClipPlanexIMG")) {
+        GLCallCounter counter(glContext, GLMessage::glClipPlanexIMG, "glClipPlanexIMG");
+        glContext->hooks->gl.glClipPlanexIMG(p, eqn);
+        return;
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::glClipPlanexIMG);
 
     // copy argument p
@@ -15,7 +15,10 @@
  */
 
 #include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
 #include <cutils/log.h>
+#include <cutils/properties.h>
 
 extern "C" {
 #include "liblzf/lzf.h"
@@ -28,6 +31,9 @@ namespace gltrace {
 
 using ::android::gl_hooks_t;
 
+/* In counters mode, the counters are logged every so many frames. */
+static const unsigned COUNTER_DUMP_FRAMES = 600;
+
 static pthread_key_t sTLSKey = -1;
 static pthread_once_t sPthreadOnceKey = PTHREAD_ONCE_INIT;
 
@@ -64,6 +70,71 @@ GLTraceState::GLTraceState(TCPStream *stream) {
     mCollectFbOnGlDraw = false;
     mCollectTextureDataOnGlTexImage = false;
     pthread_rwlock_init(&mTraceOptionsRwLock, NULL);
+
+    char value[PROPERTY_VALUE_MAX];
+    property_get("debug.egl.trace.filter", value, "");
+    mTracedCallClasses = parseCallClasses(value);
+
+    property_get("debug.egl.trace.sample_frames", value, "1");
+    int interval = atoi(value);
+    mSampleFrameInterval = interval > 1 ? interval : 1;
+
+    property_get("debug.egl.trace.counters", value, "0");
+    mCountersOnly = atoi(value) != 0;
+
+    property_get("debug.egl.trace.fb_async", value, "0");
+    mAsyncFbCapture = atoi(value) != 0;
+
+    property_get("debug.egl.trace.fb_scale", value, "1");
+    int scale = atoi(value);
+    mFbCaptureScale = scale > 1 ? scale : 1;
+
+    memset(mCallClasses, 0, sizeof(mCallClasses));
+
+    ALOGD("trace filter: %#x, sampling every %u frames%s%s", mTracedCallClasses,
+            mSampleFrameInterval, mCountersOnly ? ", counters only" : "",
+            mAsyncFbCapture ? ", asynchronous fb capture" : "");
+}
+
+/** Parses a comma separated list of call classes, empty meaning all of them. */
+uint32_t GLTraceState::parseCallClasses(const char *list) {
+    if (list[0] == '\0') {
+        return CALL_CLASS_ALL;
+    }
+
+    char buf[PROPERTY_VALUE_MAX];
+    strlcpy(buf, list, sizeof(buf));
+    uint32_t classes = 0;
+    char *saveptr = NULL;
+    for (char *name = strtok_r(buf, ",", &saveptr); name != NULL;
+            name = strtok_r(NULL, ",", &saveptr)) {
+        if (!strcmp(name, "state")) {
+            classes |= CALL_CLASS_STATE;
+        } else if (!strcmp(name, "draw")) {
+            classes |= CALL_CLASS_DRAW;
+        } else if (!strcmp(name, "texture")) {
+            classes |= CALL_CLASS_TEXTURE;
+        } else {
+            ALOGW("unknown trace call class '%s'", name);
+        }
+    }
+    return classes ? classes : uint32_t(CALL_CLASS_ALL);
+}
+
+uint32_t GLTraceState::getCallClass(GLMessage_Function func, const char *name) {
+    uint8_t callClass = mCallClasses[func];
+    if (callClass == 0) {
+        if (!strncmp(name, "glDraw", 6) || !strcmp(name, "glClear")) {
+            callClass = CALL_CLASS_DRAW;
+        } else if (strstr(name, "TexImage") || strstr(name, "TexSubImage")) {
+            callClass = CALL_CLASS_TEXTURE;
+        } else {
+            callClass = CALL_CLASS_STATE;
+        }
+        // threads racing here all store the same value
+        mCallClasses[func] = callClass;
+    }
+    return callClass;
 }
 
 GLTraceState::~GLTraceState() {
@@ -139,6 +210,36 @@ GLTraceContext::GLTraceContext(int id, int version, GLTraceState *state,
 {
     fbcontents = fbcompressed = NULL;
     fbcontentsSize = 0;
+
+    mFrame = 0;
+    mFrameTraced = !state->isCountersOnly();
+    mTraceAll = mFrameTraced && state->getSampleFrameInterval() == 1 &&
+            state->getTracedCallClasses() == GLTraceState::CALL_CLASS_ALL;
+    mCallCounters = NULL;
+    if (state->isCountersOnly()) {
+        mCallCounters = new CallCounter[GLMessage::Function_ARRAYSIZE];
+        memset(mCallCounters, 0, GLMessage::Function_ARRAYSIZE * sizeof(CallCounter));
+    }
+
+    memset(mFBCaptures, 0, sizeof(mFBCaptures));
+    mFBCaptureHead = 0;
+    mFBCapturesPending = 0;
+    mAsyncFBCapture = state->isAsyncFbCapture() ? -1 : 0;
+    mFBScaleFramebuffer = mFBScaleRenderbuffer = 0;
+    mFBScaleWidth = mFBScaleHeight = 0;
+}
+
+GLTraceContext::~GLTraceContext() {
+    if (mCallCounters != NULL) {
+        dumpCounters();
+        delete[] mCallCounters;
+    }
+
+    // The GL context may not be current anymore: the captures still in
+    // flight are dropped, and their GL objects go away with the context.
+    for (unsigned i = 0; i < mFBCapturesPending; i++) {
+        delete mFBCaptures[(mFBCaptureHead + i) % FB_CAPTURE_SLOTS].msg;
+    }
 }
 
 int GLTraceContext::getId() {
@@ -204,7 +305,164 @@ void GLTraceContext::getCompressedFB(void **fb, unsigned *fbsize, unsigned *fbwi
     *fbheight = viewport[3];
 }
 
+bool GLTraceContext::captureFBAsync(const GLMessage &msg) {
+    if (mAsyncFBCapture < 0) {
+        // pixel pack buffers and fence syncs are core in GLES 3
+        const char *version = (const char *) hooks->gl.glGetString(GL_VERSION);
+        mAsyncFBCapture = version != NULL &&
+                strncmp(version, "OpenGL ES ", 10) == 0 && atoi(version + 10) >= 3;
+        if (!mAsyncFBCapture) {
+            ALOGW("asynchronous fb capture needs GLES 3, reading synchronously");
+        }
+    }
+    if (!mAsyncFBCapture) {
+        return false;
+    }
+
+    if (mFBCapturesPending == FB_CAPTURE_SLOTS) {
+        flushFBCaptures(true);
+    }
+    FBCapture *capture = &mFBCaptures[(mFBCaptureHead + mFBCapturesPending) % FB_CAPTURE_SLOTS];
+    readFBIntoPackBuffer(capture);
+    capture->fence = hooks->gl.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    capture->msg = new GLMessage(msg);
+    mFBCapturesPending++;
+    return true;
+}
+
+/** Reads the viewport of FB0, downscaled if requested, into the capture's
+    pixel pack buffer, leaving the application's GL state as it was. */
+void GLTraceContext::readFBIntoPackBuffer(FBCapture *capture) {
+    const gl_hooks_t::gl_t &gl = hooks->gl;
+
+    GLint viewport[4] = {};
+    gl.glGetIntegerv(GL_VIEWPORT, viewport);
+    const unsigned scale = mState->getFbCaptureScale();
+    const unsigned width = viewport[2] / scale > 0 ? viewport[2] / scale : 1;
+    const unsigned height = viewport[3] / scale > 0 ? viewport[3] / scale : 1;
+
+    GLint readFb = 0, drawFb = 0, packBuffer = 0, renderbuffer = 0;
+    GLint packAlignment = 4, packRowLength = 0, packSkipRows = 0, packSkipPixels = 0;
+    gl.glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFb);
+    gl.glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+    gl.glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+    gl.glGetIntegerv(GL_PACK_ROW_LENGTH, &packRowLength);
+    gl.glGetIntegerv(GL_PACK_SKIP_ROWS, &packSkipRows);
+    gl.glGetIntegerv(GL_PACK_SKIP_PIXELS, &packSkipPixels);
+
+    GLint readX = viewport[0], readY = viewport[1];
+    if (scale > 1) {
+        gl.glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFb);
+        gl.glGetIntegerv(GL_RENDERBUFFER_BINDING, &renderbuffer);
+        if (mFBScaleFramebuffer == 0) {
+            gl.glGenFramebuffers(1, &mFBScaleFramebuffer);
+            gl.glGenRenderbuffers(1, &mFBScaleRenderbuffer);
+        }
+        gl.glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mFBScaleFramebuffer);
+        if (mFBScaleWidth != width || mFBScaleHeight != height) {
+            gl.glBindRenderbuffer(GL_RENDERBUFFER, mFBScaleRenderbuffer);
+            gl.glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+            gl.glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                    GL_RENDERBUFFER, mFBScaleRenderbuffer);
+            gl.glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+            mFBScaleWidth = width;
+            mFBScaleHeight = height;
+        }
+
+        // the scissor test applies to blits
+        const GLboolean scissor = gl.glIsEnabled(GL_SCISSOR_TEST);
+        if (scissor) {
+            gl.glDisable(GL_SCISSOR_TEST);
+        }
+        gl.glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        gl.glBlitFramebuffer(viewport[0], viewport[1],
+                viewport[0] + viewport[2], viewport[1] + viewport[3],
+                0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        if (scissor) {
+            gl.glEnable(GL_SCISSOR_TEST);
+        }
+        gl.glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFb);
+        gl.glBindFramebuffer(GL_READ_FRAMEBUFFER, mFBScaleFramebuffer);
+        readX = readY = 0;
+    } else {
+        gl.glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    }
+
+    const GLsizeiptr size = width * height * 4;
+    if (capture->pbo == 0) {
+        gl.glGenBuffers(1, &capture->pbo);
+    }
+    gl.glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->pbo);
+    if (capture->pboSize < size) {
+        gl.glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        capture->pboSize = size;
+    }
+    gl.glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    gl.glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    gl.glPixelStorei(GL_PACK_SKIP_ROWS, 0);
+    gl.glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+    gl.glReadPixels(readX, readY, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    capture->width = width;
+    capture->height = height;
+
+    gl.glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+    gl.glPixelStorei(GL_PACK_ROW_LENGTH, packRowLength);
+    gl.glPixelStorei(GL_PACK_SKIP_ROWS, packSkipRows);
+    gl.glPixelStorei(GL_PACK_SKIP_PIXELS, packSkipPixels);
+    gl.glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+    gl.glBindFramebuffer(GL_READ_FRAMEBUFFER, readFb);
+}
+
+void GLTraceContext::flushFBCaptures(bool waitForOldest) {
+    const gl_hooks_t::gl_t &gl = hooks->gl;
+
+    while (mFBCapturesPending > 0) {
+        FBCapture *capture = &mFBCaptures[mFBCaptureHead];
+        GLenum status = gl.glClientWaitSync(capture->fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                waitForOldest ? GL_TIMEOUT_IGNORED : 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            // the later captures aren't done either
+            break;
+        }
+        waitForOldest = false;
+        gl.glDeleteSync(capture->fence);
+        capture->fence = 0;
+
+        GLMessage *msg = capture->msg;
+        capture->msg = NULL;
+        const unsigned size = capture->width * capture->height * 4;
+        resizeFBMemory(size);
+        unsigned compressedSize = 0;
+
+        GLint packBuffer = 0;
+        gl.glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+        gl.glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->pbo);
+        void *pixels = gl.glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+        if (pixels != NULL) {
+            compressedSize = lzf_compress(pixels, size, fbcompressed, size);
+            gl.glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else {
+            ALOGE("couldn't map the framebuffer capture");
+        }
+        gl.glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+
+        GLMessage_FrameBuffer *fb = msg->mutable_fb();
+        fb->set_width(capture->width);
+        fb->set_height(capture->height);
+        fb->add_contents(fbcompressed, compressedSize);
+        traceGLMessage(msg);
+        delete msg;
+
+        mFBCaptureHead = (mFBCaptureHead + 1) % FB_CAPTURE_SLOTS;
+        mFBCapturesPending--;
+    }
+}
+
 void GLTraceContext::traceGLMessage(GLMessage *msg) {
+    if (mState->isCountersOnly()) {
+        return;
+    }
+
     mBufferedOutputStream->send(msg);
 
     GLMessage_Function func = msg->function();
@@ -217,6 +475,40 @@ void GLTraceContext::traceGLMessage(GLMessage *msg) {
     }
 }
 
+void GLTraceContext::countGLCall(GLMessage_Function func, const char *name,
+        nsecs_t threadTime) {
+    CallCounter &counter = mCallCounters[func];
+    counter.name = name;
+    counter.count++;
+    counter.threadTime += threadTime;
+}
+
+void GLTraceContext::onSwapBuffers() {
+    if (mFBCapturesPending > 0) {
+        flushFBCaptures(false);
+    }
+    mFrame++;
+    if (!mState->isCountersOnly()) {
+        mFrameTraced = (mFrame % mState->getSampleFrameInterval()) == 0;
+    }
+    if (mCallCounters != NULL && (mFrame % COUNTER_DUMP_FRAMES) == 0) {
+        dumpCounters();
+    }
+}
+
+void GLTraceContext::dumpCounters() {
+    ALOGD("context %d: GL calls in the last %u frames", mId,
+            mFrame % COUNTER_DUMP_FRAMES ? mFrame % COUNTER_DUMP_FRAMES : COUNTER_DUMP_FRAMES);
+    for (int i = 0; i < GLMessage::Function_ARRAYSIZE; i++) {
+        const CallCounter &counter = mCallCounters[i];
+        if (counter.count != 0) {
+            ALOGD("  %-32s %8u calls %10lld us", counter.name, counter.count,
+                    (long long) ns2us(counter.threadTime));
+        }
+    }
+    memset(mCallCounters, 0, GLMessage::Function_ARRAYSIZE * sizeof(CallCounter));
+}
+
 void GLTraceContext::bindBuffer(GLuint bufferId, GLvoid *data, GLsizeiptr size) {
     // free previously bound buffer if any
     ElementArrayBuffer *oldBuffer = mElementArrayBuffers.valueFor(bufferId);
@@ -20,6 +20,7 @@
 #include <map>
 #include <pthread.h>
 #include <utils/KeyedVector.h>
+#include <utils/Timers.h>
 
 #include "hooks.h"
 #include "gltrace_transport.h"
@@ -62,11 +63,44 @@ class GLTraceContext {
     /* list of element array buffers in use. */
     DefaultKeyedVector<GLuint, ElementArrayBuffer*> mElementArrayBuffers;
 
+    bool mTraceAll;             /* every call is traced, the default */
+    bool mFrameTraced;          /* the calls of the current frame are sampled */
+    unsigned mFrame;            /* number of eglSwapBuffers so far */
+
+    /* calls that were not traced, per GLMessage::Function, in counters mode */
+    struct CallCounter {
+        const char *name;
+        uint32_t count;
+        nsecs_t threadTime;
+    };
+    CallCounter *mCallCounters;
+
+    /* asynchronous framebuffer captures: a ring of pixel pack buffers that
+       eglSwapBuffers reads FB0 into, and whose messages are sent once the
+       fence following the read has signaled */
+    enum { FB_CAPTURE_SLOTS = 3 };
+    struct FBCapture {
+        GLuint pbo;
+        GLsizeiptr pboSize;
+        GLsync fence;
+        unsigned width, height;
+        GLMessage *msg;         /* waiting for the framebuffer contents */
+    };
+    FBCapture mFBCaptures[FB_CAPTURE_SLOTS];
+    unsigned mFBCaptureHead;    /* oldest capture in flight */
+    unsigned mFBCapturesPending;
+    int mAsyncFBCapture;        /* -1 until the GL version is known */
+    GLuint mFBScaleFramebuffer; /* destination of the downscaling blit */
+    GLuint mFBScaleRenderbuffer;
+    unsigned mFBScaleWidth, mFBScaleHeight;
+
     void resizeFBMemory(unsigned minSize);
+    void readFBIntoPackBuffer(FBCapture *capture);
 public:
     gl_hooks_t *hooks;
 
     GLTraceContext(int id, int version, GLTraceState *state, BufferedOutputStream *stream);
+    ~GLTraceContext();
     int getId();
     int getVersion();
     GLTraceState *getGlobalTraceState();
@@ -74,6 +108,20 @@ public:
                             unsigned *fbwidth, unsigned *fbheight,
                             FBBinding fbToRead);
 
+    /**
+     * Starts reading FB0 into a pixel pack buffer for a copy of @msg, which
+     * is sent with the contents once the read completed. Returns false,
+     * without doing anything, if asynchronous captures are disabled or
+     * need GLES 3.
+     */
+    bool captureFBAsync(const GLMessage &msg);
+
+    /**
+     * Sends the messages of the asynchronous captures that completed, in
+     * order. If @waitForOldest, the oldest capture is waited for.
+     */
+    void flushFBCaptures(bool waitForOldest);
+
     // Methods to work with element array buffers
     void bindBuffer(GLuint bufferId, GLvoid *data, GLsizeiptr size);
     void getBuffer(GLuint bufferId, GLvoid **data, GLsizeiptr *size);
@@ -81,6 +129,50 @@ public:
     void deleteBuffer(GLuint bufferId);
 
     void traceGLMessage(GLMessage *msg);
+
+    /**
+     * Returns whether the call to @func, named @name, is to be traced
+     * according to the call class filter and frame sampling. Calls that are
+     * not traced skip building a GLMessage, and are only counted.
+     */
+    inline bool shouldTrace(GLMessage_Function func, const char *name);
+
+    /* Returns whether the calls of the current frame are traced. */
+    bool isFrameTraced() { return mFrameTraced; }
+
+    /* Returns whether untraced calls are counted. */
+    bool isCounting() { return mCallCounters != NULL; }
+
+    /* Counts a call that was not traced, which took @threadTime. */
+    void countGLCall(GLMessage_Function func, const char *name, nsecs_t threadTime);
+
+    /* Called on eglSwapBuffers, once its message was traced. */
+    void onSwapBuffers();
+
+    /* Logs and resets the call counters. */
+    void dumpCounters();
+};
+
+/**
+ * Counts a call that is not traced, with the thread time it takes, for as
+ * long as it is in scope.
+ */
+class GLCallCounter {
+    GLTraceContext *mContext;
+    GLMessage_Function mFunc;
+    const char *mName;
+    nsecs_t mStartTime;
+public:
+    GLCallCounter(GLTraceContext *context, GLMessage_Function func, const char *name) :
+        mContext(context), mFunc(func), mName(name),
+        mStartTime(context->isCounting() ? systemTime(SYSTEM_TIME_THREAD) : 0) {
+    }
+    ~GLCallCounter() {
+        if (mContext->isCounting()) {
+            mContext->countGLCall(mFunc, mName,
+                    systemTime(SYSTEM_TIME_THREAD) - mStartTime);
+        }
+    }
 };
 
 /** Per process trace state. */
@@ -96,10 +188,34 @@ class GLTraceState {
     bool mCollectTextureDataOnGlTexImage;
     pthread_rwlock_t mTraceOptionsRwLock;
 
+    /* Asynchronous capture of the framebuffer on eglSwapBuffers, and its
+       downscaling factor, set from debug.egl.trace.fb_async and
+       debug.egl.trace.fb_scale when tracing starts. */
+    bool mAsyncFbCapture;
+    unsigned mFbCaptureScale;
+
+    /* Filtering and sampling options, set from the debug.egl.trace.*
+       properties when tracing starts. */
+    uint32_t mTracedCallClasses;    /* mask of CallClass */
+    unsigned mSampleFrameInterval;  /* only every Nth frame is traced */
+    bool mCountersOnly;             /* nothing is traced, calls are counted */
+
+    /* CallClass of each GLMessage::Function, 0 until first needed */
+    uint8_t mCallClasses[GLMessage::Function_ARRAYSIZE];
+
     /* helper methods to get/set values using provided lock for mutual exclusion. */
     void safeSetValue(bool *ptr, bool value, pthread_rwlock_t *lock);
     bool safeGetValue(bool *ptr, pthread_rwlock_t *lock);
+
+    static uint32_t parseCallClasses(const char *list);
 public:
+    enum CallClass {
+        CALL_CLASS_STATE = 1 << 0,      /* everything else */
+        CALL_CLASS_DRAW = 1 << 1,       /* glDraw*, glClear */
+        CALL_CLASS_TEXTURE = 1 << 2,    /* texture uploads and copies */
+        CALL_CLASS_ALL = CALL_CLASS_STATE | CALL_CLASS_DRAW | CALL_CLASS_TEXTURE,
+    };
+
     GLTraceState(TCPStream *stream);
     ~GLTraceState();
 
@@ -117,8 +233,23 @@ public:
     bool shouldCollectFbOnEglSwap();
     bool shouldCollectFbOnGlDraw();
     bool shouldCollectTextureDataOnGlTexImage();
+
+    /* Methods to retrieve the filtering and sampling options. */
+    uint32_t getTracedCallClasses() { return mTracedCallClasses; }
+    unsigned getSampleFrameInterval() { return mSampleFrameInterval; }
+    bool isCountersOnly() { return mCountersOnly; }
+    bool isAsyncFbCapture() { return mAsyncFbCapture; }
+    unsigned getFbCaptureScale() { return mFbCaptureScale; }
+
+    /* Returns the CallClass of @func, named @name. */
+    uint32_t getCallClass(GLMessage_Function func, const char *name);
 };
 
+inline bool GLTraceContext::shouldTrace(GLMessage_Function func, const char *name) {
+    return mTraceAll || (mFrameTraced &&
+            (mState->getCallClass(func, name) & mState->getTracedCallClasses()));
+}
+
 void setupTraceContextThreadSpecific(GLTraceContext *context);
 GLTraceContext *getGLTraceContext();
 void releaseContext();
@@ -72,22 +72,31 @@ void GLTrace_eglMakeCurrent(int contextId) {
 }
 
 void GLTrace_eglSwapBuffers(void *dpy, void *draw) {
-    GLMessage glmessage;
     GLTraceContext *glContext = getGLTraceContext();
 
-    glmessage.set_context_id(glContext->getId());
-    glmessage.set_function(GLMessage::eglSwapBuffers);
-
-    if (glContext->getGlobalTraceState()->shouldCollectFbOnEglSwap()) {
-        // read FB0 since that is what is displayed on the screen
-        fixup_addFBContents(glContext, &glmessage, FB0);
+    // frames that are not sampled end without a message
+    if (glContext->isFrameTraced()) {
+        GLMessage glmessage;
+
+        glmessage.set_context_id(glContext->getId());
+        glmessage.set_function(GLMessage::eglSwapBuffers);
+
+        // set start time and duration
+        glmessage.set_start_time(systemTime());
+        glmessage.set_duration(0);
+
+        // read FB0 since that is what is displayed on the screen; the
+        // message of an asynchronous capture is sent once the read completed
+        bool collectFb = glContext->getGlobalTraceState()->shouldCollectFbOnEglSwap();
+        if (!collectFb || !glContext->captureFBAsync(glmessage)) {
+            if (collectFb) {
+                fixup_addFBContents(glContext, &glmessage, FB0);
+            }
+            glContext->traceGLMessage(&glmessage);
+        }
     }
 
-    // set start time and duration
-    glmessage.set_start_time(systemTime());
-    glmessage.set_duration(0);
-
-    glContext->traceGLMessage(&glmessage);
+    glContext->onSwapBuffers();
 }
 
 };
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <stdint.h>
 #include <cutils/log.h>
 #include <EGL/egldefs.h>
 #include <GLES/gl.h>
@@ -408,18 +409,40 @@ void addGlBufferData(GLMessage *glmsg, int dataIndex, GLvoid *src, GLsizeiptr le
     arg_datap->add_rawbytes(src, len);
 }
 
-void fixup_glBufferData(GLTraceContext *context, GLMessage *glmsg, void *pointersToFixup[]) {
-    /* void glBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) */
-    GLsizeiptr size = glmsg->args(1).intvalue(0);
-    GLvoid *datap = (GLvoid *) pointersToFixup[0];
-
+void track_glBufferData(GLTraceContext *context, GLenum target, GLsizeiptr size,
+                                                            const GLvoid *data) {
     // Save element array buffers for future use to fixup glVertexAttribPointers
     // when a glDrawElements() call is performed.
-    GLenum target = glmsg->args(0).intvalue(0);
     if (target == GL_ELEMENT_ARRAY_BUFFER) {
         GLint bufferId = glGetInteger(context, GL_ELEMENT_ARRAY_BUFFER_BINDING);
-        context->bindBuffer(bufferId, datap, size);
+        context->bindBuffer(bufferId, (GLvoid *) data, size);
     }
+}
+
+void track_glBufferSubData(GLTraceContext *context, GLenum target, GLintptr offset,
+                                                            GLsizeiptr size, const GLvoid *data) {
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        GLint bufferId = glGetInteger(context, GL_ELEMENT_ARRAY_BUFFER_BINDING);
+        context->updateBufferSubData(bufferId, offset, (GLvoid *) data, size);
+    }
+}
+
+void track_glDeleteBuffers(GLTraceContext *context, GLsizei n, const GLuint *buffers) {
+    if (buffers == NULL) {
+        return;
+    }
+
+    for (GLsizei i = 0; i < n; i++) {
+        context->deleteBuffer(buffers[i]);
+    }
+}
+
+void fixup_glBufferData(GLTraceContext *context, GLMessage *glmsg, void *pointersToFixup[]) {
+    /* void glBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) */
+    GLsizeiptr size = glmsg->args(1).intvalue(0);
+    GLvoid *datap = (GLvoid *) pointersToFixup[0];
+
+    // The element array buffer shadow was already updated by track_glBufferData().
 
     // add buffer data to the protobuf message
     if (datap != NULL) {
@@ -429,14 +452,10 @@ void fixup_glBufferData(GLTraceContext *context, GLMessage *glmsg, void *pointer
 
 void fixup_glBufferSubData(GLTraceContext *context, GLMessage *glmsg, void *pointersToFixup[]) {
     /* void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) */
-    GLenum target = glmsg->args(0).intvalue(0);
-    GLintptr offset = glmsg->args(1).intvalue(0);
     GLsizeiptr size = glmsg->args(2).intvalue(0);
     GLvoid *datap = (GLvoid *) pointersToFixup[0];
-    if (target == GL_ELEMENT_ARRAY_BUFFER) {
-        GLint bufferId = glGetInteger(context, GL_ELEMENT_ARRAY_BUFFER_BINDING);
-        context->updateBufferSubData(bufferId, offset, datap, size);
-    }
+
+    // The element array buffer shadow was already updated by track_glBufferSubData().
 
     // add buffer data to the protobuf message
     addGlBufferData(glmsg, 3, datap, size);
@@ -541,16 +560,26 @@ void trace_glVertexAttribPointerData(GLTraceContext *context,
     context->traceGLMessage(&glmsg);
 }
 
-void findMinAndMaxIndices(GLvoid *indices, GLsizei count, GLenum type,
+/**
+ * Find the range of indices used by a glDrawElements() call. At most @maxBytes of
+ * @indices are read, so that a stale or short element array buffer shadow can't
+ * be read past its end.
+ */
+void findMinAndMaxIndices(GLvoid *indices, GLsizei count, GLenum type, size_t maxBytes,
                             GLuint *minIndex, GLuint *maxIndex) {
     GLuint index;
     *minIndex = UINT_MAX;
     *maxIndex = 0;
 
-    if (indices == NULL) {
+    if (indices == NULL || count <= 0) {
         return;
     }
 
+    size_t indexSize = type == GL_UNSIGNED_BYTE ? sizeof(GLubyte) : sizeof(GLushort);
+    if ((size_t) count > maxBytes / indexSize) {
+        count = maxBytes / indexSize;
+    }
+
     for (GLsizei i = 0; i < count; i++) {
         if (type == GL_UNSIGNED_BYTE) {
             index = *((GLubyte*) indices + i);
@@ -622,20 +651,32 @@ void trace_VertexAttribPointerDataForGlDrawElements(GLTraceContext *context, GLM
 
     // The index buffer is either passed in as an argument to the glDrawElements() call,
     // or it is stored in the current GL_ELEMENT_ARRAY_BUFFER.
+    // When it is stored in a buffer, @indices is an offset into that buffer.
     GLvoid *indexBuffer;
+    size_t indexBufferSize;
     if (isUsingElementArrayBuffers(context)) {
         GLsizeiptr eaBufferSize;
         GLuint bufferId = glGetInteger(context, GL_ELEMENT_ARRAY_BUFFER_BINDING);
         context->getBuffer(bufferId, &indexBuffer, &eaBufferSize);
+
+        uintptr_t offset = (uintptr_t) indices;
+        if (indexBuffer == NULL || eaBufferSize < 0 || offset >= (uintptr_t) eaBufferSize) {
+            indexBuffer = NULL;
+            indexBufferSize = 0;
+        } else {
+            indexBuffer = (GLubyte *) indexBuffer + offset;
+            indexBufferSize = eaBufferSize - offset;
+        }
     } else {
         indexBuffer = indices;
+        indexBufferSize = SIZE_MAX;
     }
 
     // Rather than sending vertex attribute data that corresponds to the indices
     // being drawn, we send the vertex attribute data for the entire range of
     // indices being drawn, including the ones not drawn. The min & max indices
     // provide the range of indices being drawn.
-    findMinAndMaxIndices(indexBuffer, count, type, &minIndex, &maxIndex);
+    findMinAndMaxIndices(indexBuffer, count, type, indexBufferSize, &minIndex, &maxIndex);
 
     // Vertex attrib pointer data patchup calls should appear as if
     // they occurred right before the draw call.
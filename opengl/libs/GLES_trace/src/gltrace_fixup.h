@@ -30,6 +30,13 @@ void fixupGLMessage(GLTraceContext *curContext, nsecs_t wallStart, nsecs_t wallE
                                                 GLMessage *message, void *pointersToFixup[]);
 void fixup_addFBContents(GLTraceContext *curContext, GLMessage *message, FBBinding fbToRead);
 
+/* Keep the element array buffer shadows current. These run on every call, traced or not. */
+void track_glBufferData(GLTraceContext *context, GLenum target, GLsizeiptr size,
+                                                            const GLvoid *data);
+void track_glBufferSubData(GLTraceContext *context, GLenum target, GLintptr offset,
+                                                            GLsizeiptr size, const GLvoid *data);
+void track_glDeleteBuffers(GLTraceContext *context, GLsizei n, const GLuint *buffers);
+
 };
 };
 
@@ -16,6 +16,7 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <unistd.h>
@@ -94,31 +95,156 @@ int acceptClientConnection(char *sockname) {
 TCPStream::TCPStream(int socket) {
     mSocket = socket;
     pthread_mutex_init(&mSocketWriteMutex, NULL);
+
+    pthread_mutex_init(&mQueueMutex, NULL);
+    pthread_cond_init(&mQueueNotEmpty, NULL);
+    pthread_cond_init(&mQueueNotFull, NULL);
+    mQueuedBytes = 0;
+    mClosing = false;
+    mSenderStarted = pthread_create(&mSenderThread, NULL, senderTask, this) == 0;
+    ALOGE_IF(!mSenderStarted, "Error starting trace sender thread, "
+            "trace data will be sent synchronously");
 }
 
 TCPStream::~TCPStream() {
+    stopSender();
+
+    while (!mFreeBuffers.empty()) {
+        delete mFreeBuffers.back();
+        mFreeBuffers.pop_back();
+    }
+    pthread_cond_destroy(&mQueueNotFull);
+    pthread_cond_destroy(&mQueueNotEmpty);
+    pthread_mutex_destroy(&mQueueMutex);
     pthread_mutex_destroy(&mSocketWriteMutex);
 }
 
 void TCPStream::closeStream() {
+    stopSender();
+
     if (mSocket > 0) {
         close(mSocket);
         mSocket = 0;
     }
 }
 
+void TCPStream::stopSender() {
+    pthread_mutex_lock(&mQueueMutex);
+    bool wasStarted = mSenderStarted;
+    mSenderStarted = false;
+    mClosing = true;
+    pthread_cond_broadcast(&mQueueNotEmpty);
+    pthread_cond_broadcast(&mQueueNotFull);
+    pthread_mutex_unlock(&mQueueMutex);
+
+    if (wasStarted) {
+        // the sender drains the queue before it exits
+        pthread_join(mSenderThread, NULL);
+    }
+}
+
+int TCPStream::writeFully(const void *data, size_t len) {
+    size_t written = 0;
+    while (written < len) {
+        ssize_t n = write(mSocket, (const uint8_t *)data + written, len - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        written += n;
+    }
+    return len;
+}
+
 int TCPStream::send(void *buf, size_t len) {
     if (mSocket <= 0) {
         return -1;
     }
 
     pthread_mutex_lock(&mSocketWriteMutex);
-    int n = write(mSocket, buf, len);
+    int n = writeFully(buf, len);
     pthread_mutex_unlock(&mSocketWriteMutex);
 
     return n;
 }
 
+int TCPStream::sendBuffer(std::string *buf) {
+    if (mSocket <= 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&mQueueMutex);
+    if (!mSenderStarted) {
+        pthread_mutex_unlock(&mQueueMutex);
+        int n = send((void *)buf->data(), buf->size());
+        buf->clear();
+        return n < 0 ? -1 : 0;
+    }
+
+    // Let the host catch up if we're too far ahead of it.
+    while (mQueuedBytes > MAX_QUEUED_BYTES && !mClosing) {
+        pthread_cond_wait(&mQueueNotFull, &mQueueMutex);
+    }
+    if (mClosing) {
+        pthread_mutex_unlock(&mQueueMutex);
+        buf->clear();
+        return -1;
+    }
+
+    std::string *queued;
+    if (!mFreeBuffers.empty()) {
+        queued = mFreeBuffers.back();
+        mFreeBuffers.pop_back();
+    } else {
+        queued = new std::string();
+    }
+    // the caller gets the spare buffer's memory, nothing is copied
+    queued->swap(*buf);
+    mQueue.push_back(queued);
+    mQueuedBytes += queued->size();
+    pthread_cond_signal(&mQueueNotEmpty);
+    pthread_mutex_unlock(&mQueueMutex);
+
+    return 0;
+}
+
+void *TCPStream::senderTask(void *arg) {
+    TCPStream *stream = (TCPStream *)arg;
+
+    pthread_mutex_lock(&stream->mQueueMutex);
+    while (true) {
+        while (stream->mQueue.empty() && !stream->mClosing) {
+            pthread_cond_wait(&stream->mQueueNotEmpty, &stream->mQueueMutex);
+        }
+        if (stream->mQueue.empty()) {
+            // closing, and everything was sent
+            break;
+        }
+
+        std::string *buf = stream->mQueue.front();
+        stream->mQueue.pop_front();
+        pthread_mutex_unlock(&stream->mQueueMutex);
+
+        int n = stream->send((void *)buf->data(), buf->size());
+        ALOGE_IF(n < 0, "Error sending trace data: %d", errno);
+
+        pthread_mutex_lock(&stream->mQueueMutex);
+        stream->mQueuedBytes -= buf->size();
+        if (stream->mFreeBuffers.size() < MAX_FREE_BUFFERS) {
+            buf->clear();
+            stream->mFreeBuffers.push_back(buf);
+        } else {
+            delete buf;
+        }
+        pthread_cond_broadcast(&stream->mQueueNotFull);
+    }
+    pthread_mutex_unlock(&stream->mQueueMutex);
+
+    return NULL;
+}
+
 int TCPStream::receive(void *data, size_t len) {
     if (mSocket <= 0) {
         return -1;
@@ -151,16 +277,24 @@ int BufferedOutputStream::flush() {
         return 0;
     }
 
-    int n = mStream->send((void *)mStringBuffer.data(), mStringBuffer.size());
-    mStringBuffer.clear();
+    // hands the buffer over to the sender thread, and gets an empty one back
+    int n = mStream->sendBuffer(&mStringBuffer);
+    if (mStringBuffer.capacity() < mBufferSize) {
+        mStringBuffer.reserve(mBufferSize);
+    }
     return n;
 }
 
 void BufferedOutputStream::enqueueMessage(GLMessage *msg) {
+    // ByteSize() caches the sizes, so the message is only walked once more,
+    // to serialize it straight into the buffer.
     const uint32_t len = msg->ByteSize();
+    const size_t offset = mStringBuffer.size();
 
-    mStringBuffer.append((const char *)&len, sizeof(len));    // append header
-    msg->AppendToString(&mStringBuffer);                      // append message
+    mStringBuffer.resize(offset + sizeof(len) + len);
+    uint8_t *dst = (uint8_t *)&mStringBuffer[offset];
+    memcpy(dst, &len, sizeof(len));                           // header
+    msg->SerializeWithCachedSizesToArray(dst + sizeof(len));  // message
 }
 
 int BufferedOutputStream::send(GLMessage *msg) {
@@ -19,6 +19,9 @@
 
 #include <pthread.h>
 
+#include <deque>
+#include <vector>
+
 #include "gltrace.pb.h"
 
 namespace android {
@@ -27,21 +30,53 @@ namespace gltrace {
 /**
  * TCPStream provides a TCP based communication channel from the device to
  * the host for transferring GLMessages.
+ *
+ * Buffers handed to sendBuffer() are written to the socket by a sender
+ * thread, so that the GL threads producing them don't wait for the host.
+ * The GL threads only block when more than MAX_QUEUED_BYTES are waiting
+ * to be sent.
  */
 class TCPStream {
     int mSocket;
     pthread_mutex_t mSocketWriteMutex;
+
+    /* The sender thread and its queue, protected by mQueueMutex. */
+    pthread_t mSenderThread;
+    pthread_mutex_t mQueueMutex;
+    pthread_cond_t mQueueNotEmpty;
+    pthread_cond_t mQueueNotFull;
+    std::deque<std::string *> mQueue;
+    std::vector<std::string *> mFreeBuffers;    /* sent buffers, for reuse */
+    size_t mQueuedBytes;
+    bool mSenderStarted;
+    bool mClosing;
+
+    static void *senderTask(void *arg);
+    void stopSender();
+    int writeFully(const void *data, size_t len);
 public:
+    enum {
+        MAX_QUEUED_BYTES = 16 * 1024 * 1024,
+        MAX_FREE_BUFFERS = 16,
+    };
+
     /** Create a TCP based communication channel over @socket */
     TCPStream(int socket);
     ~TCPStream();
 
-    /** Close the channel. */
+    /** Close the channel, once the queued buffers have been sent. */
     void closeStream();
 
     /** Send @data of size @len to host. . Returns -1 on error, 0 on success. */
     int send(void *data, size_t len);
 
+    /**
+     * Queue the contents of @buf to be sent by the sender thread, in the
+     * order the buffers are queued in, and swap @buf with an empty buffer.
+     * Returns -1 if the channel is closed, 0 otherwise.
+     */
+    int sendBuffer(std::string *buf);
+
     /**
      * Receive @len bytes of data into @buf from the remote end. This is a blocking call.
      * Returns -1 on failure, 0 on success.
@@ -152,11 +152,33 @@ FOOTER_TEXT = """
 }; // namespace android
 """
 
+# Calls that update the element array buffer shadows kept by the trace context.
+# Their bookkeeping must run on every call, even when the message is not sampled,
+# otherwise a later traced glDrawElements() reads a stale shadow.
+BUFFER_TRACKING_ARGS = {
+    "glBufferData":     "target, size, data",
+    "glBufferSubData":  "target, offset, size, data",
+    "glDeleteBuffers":  "n, buffers",
+}
+
 TRACE_CALL_TEMPLATE = pyratemp.Template(
 """$!retType!$ GLTrace_$!func!$($!inputArgList!$) {
-    GLMessage glmsg;
     GLTraceContext *glContext = getGLTraceContext();
+<!--(if trackArgs)-->
+    track_$!func!$(glContext, $!trackArgs!$);
+<!--(end)-->
 
+    if (!glContext->shouldTrace(GLMessage::$!func!$, "$!func!$")) {
+        GLCallCounter counter(glContext, GLMessage::$!func!$, "$!func!$");
+<!--(if retType != "void")-->
+        return glContext->hooks->gl.$!callsite!$;
+<!--(else)-->
+        glContext->hooks->gl.$!callsite!$;
+        return;
+<!--(end)-->
+    }
+
+    GLMessage glmsg;
     glmsg.set_function(GLMessage::$!func!$);
 <!--(if len(parsedArgs) > 0)-->
     <!--(for argname, argtype in parsedArgs)-->
@@ -340,6 +362,7 @@ class ApiCall(object):
                                    retDataType = getDataTypeFromKw(self.ret),
                                    inputArgList = self.arglist,
                                    callsite = self.callsite,
+                                   trackArgs = BUFFER_TRACKING_ARGS.get(self.func),
                                    parsedArgs = parseArgs(self.arglist),
                                    DataType=DataType)
 
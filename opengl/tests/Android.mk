@@ -2,6 +2,7 @@ dirs := \
 	angeles \
 	configdump \
 	EGLTest \
+	etc1_perf \
 	fillrate \
 	filter \
 	finish \
@@ -9,6 +10,8 @@ dirs := \
 	gl2_copyTexImage \
 	gl2_yuvtex \
 	gl_basic \
+	gl_bench \
+	gl_dispatch \
 	gl_perf \
 	gl_yuvtex \
 	gralloc \
@@ -18,6 +21,7 @@ dirs := \
 	linetex \
 	swapinterval \
 	textures \
+	transform_perf \
 	tritex \
 
 ifneq (,$(TARGET_BUILD_JAVA_SUPPORT_LEVEL))
@@ -0,0 +1,16 @@
+LOCAL_PATH:= $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	etc1_perf.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	libutils \
+	libETC1
+
+LOCAL_MODULE:= test-opengl-etc1_perf
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
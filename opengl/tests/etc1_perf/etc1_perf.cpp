@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures how fast libETC1 encodes an RGB image with each effort setting,
+ * on one thread and on one per CPU, and how close the result is to the
+ * source image; then how fast it decodes to each pixel format.
+ *
+ * usage: test-opengl-etc1_perf [width] [height] [iterations]
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <ETC1/etc1.h>
+
+#include <utils/Timers.h>
+
+using namespace android;
+
+// Smooth gradients with some noise and a few hard edges, which exercises
+// every modifier table.
+static void fillImage(etc1_byte* p, int width, int height) {
+    srand(1);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int edge = ((x / 37) + (y / 23)) & 1 ? 96 : 0;
+            int noise = rand() % 24;
+            *p++ = (x * 255 / width + edge + noise) & 0xff;
+            *p++ = (y * 255 / height + noise) & 0xff;
+            *p++ = ((x + y) * 127 / (width + height) + edge) & 0xff;
+        }
+    }
+}
+
+static double psnr(const etc1_byte* a, const etc1_byte* b, size_t size) {
+    double sum = 0;
+    for (size_t i = 0; i < size; i++) {
+        double d = double(a[i]) - double(b[i]);
+        sum += d * d;
+    }
+    if (sum == 0) {
+        return INFINITY;
+    }
+    return 10 * log10(255.0 * 255.0 * size / sum);
+}
+
+int main(int argc, char** argv)
+{
+    const int width = argc > 1 ? atoi(argv[1]) : 1024;
+    const int height = argc > 2 ? atoi(argv[2]) : 1024;
+    const int iterations = argc > 3 ? atoi(argv[3]) : 4;
+    if (width <= 0 || height <= 0 || iterations <= 0) {
+        fprintf(stderr, "usage: %s [width] [height] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    const size_t imageSize = width * height * 3;
+    etc1_byte* image = new etc1_byte[imageSize];
+    etc1_byte* decoded = new etc1_byte[width * height * 4];
+    etc1_byte* encoded = new etc1_byte[etc1_get_encoded_data_size(width, height)];
+    fillImage(image, width, height);
+
+    static const struct {
+        const char* name;
+        etc1_uint32 effort;
+        etc1_uint32 threads;
+    } kRuns[] = {
+        { "exhaustive, 1 thread", ETC1_ENCODE_EXHAUSTIVE, 1 },
+        { "exhaustive, all CPUs", ETC1_ENCODE_EXHAUSTIVE, 0 },
+        { "fast, 1 thread",       ETC1_ENCODE_FAST,       1 },
+        { "fast, all CPUs",       ETC1_ENCODE_FAST,       0 },
+    };
+
+    printf("%dx%d RGB, %d iterations\n", width, height, iterations);
+    for (size_t r = 0; r < sizeof(kRuns) / sizeof(kRuns[0]); r++) {
+        nsecs_t t = systemTime();
+        for (int i = 0; i < iterations; i++) {
+            etc1_encode_image_ex(image, width, height, 3, width * 3, encoded,
+                    kRuns[r].effort, kRuns[r].threads);
+        }
+        t = systemTime() - t;
+        etc1_decode_image(encoded, decoded, width, height, 3, width * 3);
+        printf("%-22s %8.2f MPix/s  PSNR %6.2f dB\n", kRuns[r].name,
+                double(width) * height * iterations * 1e3 / t,
+                psnr(image, decoded, imageSize));
+    }
+
+    static const struct {
+        const char* name;
+        etc1_uint32 pixelSize;
+    } kFormats[] = {
+        { "decode to RGB565",   2 },
+        { "decode to RGB888",   3 },
+        { "decode to RGBA8888", 4 },
+    };
+
+    for (size_t f = 0; f < sizeof(kFormats) / sizeof(kFormats[0]); f++) {
+        const etc1_uint32 pixelSize = kFormats[f].pixelSize;
+        nsecs_t t = systemTime();
+        for (int i = 0; i < iterations; i++) {
+            etc1_decode_image(encoded, decoded, width, height, pixelSize,
+                    width * pixelSize);
+        }
+        t = systemTime() - t;
+        printf("%-22s %8.2f MPix/s\n", kFormats[f].name,
+                double(width) * height * iterations * 1e3 / t);
+    }
+
+    delete[] image;
+    delete[] decoded;
+    delete[] encoded;
+    return 0;
+}
@@ -0,0 +1,25 @@
+LOCAL_PATH:= $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	gl_bench.cpp \
+	scenarios.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	libutils \
+	libbinder \
+	libEGL \
+	libGLESv2 \
+	libui \
+	libgui
+
+LOCAL_C_INCLUDES += $(call include-path-for, opengl-tests-includes)
+
+LOCAL_MODULE:= test-opengl-gl_bench
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_CFLAGS := -DGL_GLEXT_PROTOTYPES -DEGL_EGLEXT_PROTOTYPES
+
+include $(BUILD_EXECUTABLE)
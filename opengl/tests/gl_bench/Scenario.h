@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GL_BENCH_SCENARIO_H
+#define GL_BENCH_SCENARIO_H
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#include <utils/Vector.h>
+
+namespace android {
+
+// What the scenarios draw to: a window surface covering the display, with
+// a GLES 2 context current.
+struct Target {
+    EGLDisplay dpy;
+    EGLSurface surface;
+    GLint width;
+    GLint height;
+};
+
+// One measurement of gl_bench. The harness calls run() for the warmup
+// runs, then for the measured runs, and times each one from the first GL
+// call until a fence inserted after the last one has signaled.
+class Scenario {
+public:
+    virtual ~Scenario() { }
+
+    virtual const char* name() const = 0;
+
+    // Creates the GL objects of the scenario, returns false if the GL
+    // implementation can't run it.
+    virtual bool setup(const Target& target) = 0;
+
+    // Issues the GL commands of one run.
+    virtual void run(const Target& target) = 0;
+
+    virtual void teardown() { }
+
+    // Whether run() swaps the buffers itself. Otherwise the harness swaps
+    // them after each run, outside of the measurement.
+    virtual bool swaps() const { return false; }
+
+    // The amount of work done by one run, in units(), to report the
+    // throughput; 0 when only the latency is meaningful.
+    virtual double workPerRun(const Target& target) const { return 0; }
+    virtual const char* units() const { return ""; }
+};
+
+// Fills scenarios with every scenario gl_bench knows of, in the order they
+// run by default.
+void createScenarios(Vector<Scenario*>* scenarios);
+
+}; // namespace android
+
+#endif // GL_BENCH_SCENARIO_H
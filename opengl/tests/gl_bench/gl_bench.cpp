@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs the GPU microbenchmarks of scenarios.cpp one after the other, on
+ * the same full screen surface and with the same methodology:
+ *
+ *  - the buffers are swapped with a swap interval of 0, so that the
+ *    display doesn't pace the runs;
+ *  - each scenario does warmup runs that aren't measured, to let the
+ *    driver compile shaders, upload textures and settle its clocks;
+ *  - each measured run is timed from its first GL call until a fence
+ *    inserted after its last one has signaled (glFinish() when
+ *    EGL_KHR_fence_sync isn't supported).
+ *
+ * A first line describes the GL implementation and the surface, then each
+ * scenario is reported on its own line as a JSON object with the median,
+ * 95th percentile and minimum of its runs, so that results can be compared
+ * from one build, or one SoC, to the next.
+ *
+ * usage: test-opengl-gl_bench [-w warmup] [-r runs] [scenario...]
+ */
+
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES2/gl2.h>
+
+#include <binder/ProcessState.h>
+
+#include <gui/Surface.h>
+#include <gui/SurfaceComposerClient.h>
+#include <gui/ISurfaceComposer.h>
+
+#include <ui/DisplayInfo.h>
+
+#include <utils/String8.h>
+#include <utils/Timers.h>
+
+#include "EGLUtils.h"
+#include "Scenario.h"
+
+using namespace android;
+
+static bool sHasFenceSync = false;
+
+// Waits for the GPU to complete the commands issued so far.
+static void waitForGpu(EGLDisplay dpy) {
+    if (sHasFenceSync) {
+        EGLSyncKHR sync = eglCreateSyncKHR(dpy, EGL_SYNC_FENCE_KHR, NULL);
+        if (sync != EGL_NO_SYNC_KHR) {
+            eglClientWaitSyncKHR(dpy, sync,
+                    EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, EGL_FOREVER_KHR);
+            eglDestroySyncKHR(dpy, sync);
+            return;
+        }
+    }
+    glFinish();
+}
+
+static int compareTimes(const void* lhs, const void* rhs) {
+    const nsecs_t l = *static_cast<const nsecs_t*>(lhs);
+    const nsecs_t r = *static_cast<const nsecs_t*>(rhs);
+    return l < r ? -1 : (l > r ? 1 : 0);
+}
+
+static void runScenario(Scenario* scenario, const Target& target,
+        size_t warmup, size_t runs) {
+    if (!scenario->setup(target)) {
+        printf("{\"scenario\":\"%s\",\"supported\":false}\n", scenario->name());
+        return;
+    }
+
+    Vector<nsecs_t> times;
+    times.setCapacity(runs);
+    for (size_t i=0 ; i<warmup+runs ; i++) {
+        const nsecs_t start = systemTime();
+        scenario->run(target);
+        waitForGpu(target.dpy);
+        const nsecs_t time = systemTime() - start;
+        if (i >= warmup) {
+            times.add(time);
+        }
+        if (!scenario->swaps()) {
+            eglSwapBuffers(target.dpy, target.surface);
+        }
+    }
+    scenario->teardown();
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        fprintf(stderr, "%s: glError 0x%x\n", scenario->name(), error);
+        while (glGetError() != GL_NO_ERROR) {
+        }
+    }
+    if (runs == 0) {
+        return;
+    }
+
+    qsort(times.editArray(), runs, sizeof(nsecs_t), compareTimes);
+    const nsecs_t median = times[runs / 2];
+    const nsecs_t p95 = times[(95 * (runs - 1) + 50) / 100];
+    printf("{\"scenario\":\"%s\",\"runs\":%u,"
+            "\"median_us\":%.1f,\"p95_us\":%.1f,\"min_us\":%.1f",
+            scenario->name(), unsigned(runs),
+            median / 1000.0, p95 / 1000.0, times[0] / 1000.0);
+    const double work = scenario->workPerRun(target);
+    if (work > 0) {
+        // at the median, in millions of units per second
+        printf(",\"throughput\":%.1f,\"units\":\"M%s/s\"",
+                work * 1000.0 / median, scenario->units());
+    }
+    printf("}\n");
+    fflush(stdout);
+}
+
+static void usage(const char* pname, const Vector<Scenario*>& scenarios) {
+    fprintf(stderr,
+            "usage: %s [-w warmup] [-r runs] [scenario...]\n"
+            "   -w: unmeasured runs before the measured ones, 10 by default\n"
+            "   -r: measured runs of each scenario, 100 by default\n"
+            "scenarios:",
+            pname);
+    for (size_t i=0 ; i<scenarios.size() ; i++) {
+        fprintf(stderr, " %s", scenarios[i]->name());
+    }
+    fprintf(stderr, ", all of them by default\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* pname = argv[0];
+    size_t warmup = 10;
+    size_t runs = 100;
+
+    Vector<Scenario*> scenarios;
+    createScenarios(&scenarios);
+
+    int c;
+    while ((c = getopt(argc, argv, "w:r:h")) != -1) {
+        switch (c) {
+            case 'w':
+                warmup = atoi(optarg);
+                break;
+            case 'r':
+                runs = atoi(optarg);
+                break;
+            default:
+                usage(pname, scenarios);
+                return c == 'h' ? 0 : 1;
+        }
+    }
+
+    ProcessState::self()->startThreadPool();
+
+    // a full screen surface above everything else
+    sp<SurfaceComposerClient> client = new SurfaceComposerClient;
+    if (client->initCheck() != NO_ERROR) {
+        fprintf(stderr, "couldn't connect to SurfaceFlinger\n");
+        return 1;
+    }
+    DisplayInfo info;
+    sp<IBinder> display(SurfaceComposerClient::getBuiltInDisplay(
+            ISurfaceComposer::eDisplayIdMain));
+    SurfaceComposerClient::getDisplayInfo(display, &info);
+    sp<SurfaceControl> control = client->createSurface(String8("gl_bench"),
+            info.w, info.h, PIXEL_FORMAT_RGBX_8888, 0);
+    if (!SurfaceControl::isValid(control)) {
+        fprintf(stderr, "couldn't create the surface\n");
+        return 1;
+    }
+    SurfaceComposerClient::openGlobalTransaction();
+    control->setLayer(INT_MAX);
+    control->show();
+    SurfaceComposerClient::closeGlobalTransaction();
+    sp<ANativeWindow> window = control->getSurface();
+
+    EGLDisplay dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    eglInitialize(dpy, NULL, NULL);
+    const EGLint configAttribs[] = {
+            EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+            EGL_DEPTH_SIZE, 0,
+            EGL_NONE };
+    EGLConfig config;
+    if (EGLUtils::selectConfigForNativeWindow(dpy, configAttribs,
+            window.get(), &config)) {
+        fprintf(stderr, "couldn't find an EGLConfig matching the surface\n");
+        return 1;
+    }
+    const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+    EGLContext context = eglCreateContext(dpy, config, EGL_NO_CONTEXT,
+            contextAttribs);
+    EGLSurface surface = eglCreateWindowSurface(dpy, config, window.get(),
+            NULL);
+    if (context == EGL_NO_CONTEXT || surface == EGL_NO_SURFACE ||
+            !eglMakeCurrent(dpy, surface, surface, context)) {
+        fprintf(stderr, "couldn't set up EGL: %s\n",
+                EGLUtils::strerror(eglGetError()));
+        return 1;
+    }
+    eglSwapInterval(dpy, 0);
+    const char* extensions = eglQueryString(dpy, EGL_EXTENSIONS);
+    sHasFenceSync = extensions && strstr(extensions, "EGL_KHR_fence_sync");
+
+    Target target;
+    target.dpy = dpy;
+    target.surface = surface;
+    eglQuerySurface(dpy, surface, EGL_WIDTH, &target.width);
+    eglQuerySurface(dpy, surface, EGL_HEIGHT, &target.height);
+
+    printf("{\"vendor\":\"%s\",\"renderer\":\"%s\",\"version\":\"%s\","
+            "\"width\":%d,\"height\":%d,\"timing\":\"%s\","
+            "\"warmup\":%u,\"runs\":%u}\n",
+            glGetString(GL_VENDOR), glGetString(GL_RENDERER),
+            glGetString(GL_VERSION), target.width, target.height,
+            sHasFenceSync ? "fence" : "finish",
+            unsigned(warmup), unsigned(runs));
+
+    for (size_t i=0 ; i<scenarios.size() ; i++) {
+        bool selected = optind >= argc;
+        for (int j=optind ; j<argc && !selected ; j++) {
+            selected = !strcmp(argv[j], scenarios[i]->name());
+        }
+        if (selected) {
+            runScenario(scenarios[i], target, warmup, runs);
+        }
+        delete scenarios[i];
+    }
+
+    eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(dpy, surface);
+    eglDestroyContext(dpy, context);
+    eglTerminate(dpy);
+    control->clear();
+    client->dispose();
+    return 0;
+}
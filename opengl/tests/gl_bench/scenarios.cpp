@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The scenarios of gl_bench, taken from the standalone programs of
+ * opengl/tests: fillrate (fill_blend), gl_perf (fill_shader), textures and
+ * finish (texture_upload, finish), testFramerate (swap).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#include "Scenario.h"
+
+namespace android {
+
+// ----------------------------------------------------------------------------
+
+enum {
+    A_POS,
+    A_TEX
+};
+
+static const char gVertexShader[] =
+    "attribute vec4 a_pos;\n"
+    "attribute vec2 a_tex;\n"
+    "varying vec2 v_tex;\n"
+    "void main() {\n"
+    "    v_tex = a_tex;\n"
+    "    gl_Position = a_pos;\n"
+    "}\n";
+
+static GLuint loadShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint compiled = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "couldn't compile shader:\n%s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// Returns the program drawing quads with fragmentSource, in use, or 0.
+static GLuint createProgram(const char* fragmentSource) {
+    GLuint vs = loadShader(GL_VERTEX_SHADER, gVertexShader);
+    GLuint fs = loadShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vs || !fs) {
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glBindAttribLocation(program, A_POS, "a_pos");
+    glBindAttribLocation(program, A_TEX, "a_tex");
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "couldn't link program:\n%s\n", log);
+        glDeleteProgram(program);
+        return 0;
+    }
+    glUseProgram(program);
+    return program;
+}
+
+// Sets the vertex attributes up for a quad covering the surface.
+static void setupQuad() {
+    static const GLfloat pos[] = {
+        -1, -1,   1, -1,   -1,  1,   1,  1 };
+    static const GLfloat tex[] = {
+         0,  0,   1,  0,    0,  1,   1,  1 };
+    glEnableVertexAttribArray(A_POS);
+    glEnableVertexAttribArray(A_TEX);
+    glVertexAttribPointer(A_POS, 2, GL_FLOAT, GL_FALSE, 0, pos);
+    glVertexAttribPointer(A_TEX, 2, GL_FLOAT, GL_FALSE, 0, tex);
+}
+
+// Creates a size x size RGBA texture, transparent outside of a disc.
+static GLuint createTexture(GLsizei size) {
+    uint32_t* texels = (uint32_t*)malloc(size * size * 4);
+    const int r = size / 2;
+    for (int y=0 ; y<size ; y++) {
+        for (int x=0 ; x<size ; x++) {
+            const int u = x - r;
+            const int v = y - r;
+            texels[x + y*size] = (u*u + v*v < r*r) ? 0x80FFFFFF : 0x200000FF;
+        }
+    }
+    GLuint name;
+    glGenTextures(1, &name);
+    glBindTexture(GL_TEXTURE_2D, name);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA,
+            GL_UNSIGNED_BYTE, texels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    free(texels);
+    return name;
+}
+
+// A scenario drawing textured quads covering the surface with one program.
+class QuadScenario : public Scenario {
+public:
+    QuadScenario(const char* fragmentSource)
+        : mFragmentSource(fragmentSource), mProgram(0), mTexture(0) { }
+
+    virtual bool setup(const Target& target) {
+        glViewport(0, 0, target.width, target.height);
+        mProgram = createProgram(mFragmentSource);
+        if (!mProgram) {
+            return false;
+        }
+        setupQuad();
+        mTexture = createTexture(512);
+        return true;
+    }
+
+    virtual void teardown() {
+        glDeleteTextures(1, &mTexture);
+        glUseProgram(0);
+        glDeleteProgram(mProgram);
+        glDisable(GL_BLEND);
+    }
+
+    virtual double workPerRun(const Target& target) const {
+        return double(target.width) * target.height;
+    }
+
+    virtual const char* units() const {
+        return "pixels";
+    }
+
+protected:
+    const char* const mFragmentSource;
+    GLuint mProgram;
+    GLuint mTexture;
+};
+
+static const char gTextureShader[] =
+    "precision mediump float;\n"
+    "uniform sampler2D u_tex;\n"
+    "varying vec2 v_tex;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(u_tex, v_tex);\n"
+    "}\n";
+
+// ----------------------------------------------------------------------------
+
+// Clears the color buffer.
+class ClearScenario : public Scenario {
+public:
+    ClearScenario() : mFrame(0) { }
+
+    virtual const char* name() const { return "clear"; }
+
+    virtual bool setup(const Target& target) {
+        glViewport(0, 0, target.width, target.height);
+        return true;
+    }
+
+    virtual void run(const Target& target) {
+        const float c = (mFrame++ & 1) ? 1.0f : 0.0f;
+        glClearColor(c, 0, 1.0f - c, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    virtual double workPerRun(const Target& target) const {
+        return double(target.width) * target.height;
+    }
+
+    virtual const char* units() const { return "pixels"; }
+
+private:
+    uint32_t mFrame;
+};
+
+// Blends the same texture over the surface several times, like fillrate.
+class FillBlendScenario : public QuadScenario {
+public:
+    enum { LAYERS = 4 };
+
+    FillBlendScenario() : QuadScenario(gTextureShader) { }
+
+    virtual const char* name() const { return "fill_blend"; }
+
+    virtual bool setup(const Target& target) {
+        if (!QuadScenario::setup(target)) {
+            return false;
+        }
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_BLEND);
+        return true;
+    }
+
+    virtual void run(const Target& target) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (int i=0 ; i<LAYERS ; i++) {
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+    }
+
+    virtual double workPerRun(const Target& target) const {
+        return LAYERS * QuadScenario::workPerRun(target);
+    }
+};
+
+// Fills the surface with a fragment shader heavy on texture fetches and
+// arithmetic, like the shaders of gl_perf.
+class FillShaderScenario : public QuadScenario {
+public:
+    FillShaderScenario() : QuadScenario(sShader) { }
+
+    virtual const char* name() const { return "fill_shader"; }
+
+    virtual void run(const Target& target) {
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+private:
+    static const char sShader[];
+};
+
+const char FillShaderScenario::sShader[] =
+    "precision mediump float;\n"
+    "uniform sampler2D u_tex;\n"
+    "varying vec2 v_tex;\n"
+    "void main() {\n"
+    "    vec4 c = texture2D(u_tex, v_tex);\n"
+    "    c += texture2D(u_tex, v_tex * 2.0);\n"
+    "    c += texture2D(u_tex, v_tex.yx);\n"
+    "    c += texture2D(u_tex, v_tex + vec2(0.5));\n"
+    "    c = c * 0.25;\n"
+    "    c.rgb = pow(c.rgb, vec3(2.2)) * c.a + sin(c.gbr * 3.14);\n"
+    "    gl_FragColor = c;\n"
+    "}\n";
+
+// Replaces the whole texture before drawing with it, like textures and the
+// modified texture cases of finish. The throughput is the upload's.
+class TextureUploadScenario : public QuadScenario {
+public:
+    enum { SIZE = 512 };
+
+    TextureUploadScenario() : QuadScenario(gTextureShader), mTexels(NULL),
+            mFrame(0) { }
+
+    virtual const char* name() const { return "texture_upload"; }
+
+    virtual bool setup(const Target& target) {
+        if (!QuadScenario::setup(target)) {
+            return false;
+        }
+        mTexels = (uint32_t*)malloc(SIZE * SIZE * 4);
+        return true;
+    }
+
+    virtual void run(const Target& target) {
+        // new contents each run, so that nothing can be cached
+        const uint32_t color = 0xFF000000 | (mFrame++ * 0x010203);
+        for (size_t i=0 ; i<SIZE*SIZE ; i++) {
+            mTexels[i] = color;
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SIZE, SIZE, GL_RGBA,
+                GL_UNSIGNED_BYTE, mTexels);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+    virtual void teardown() {
+        free(mTexels);
+        mTexels = NULL;
+        QuadScenario::teardown();
+    }
+
+    virtual double workPerRun(const Target& target) const {
+        return SIZE * SIZE;
+    }
+
+    virtual const char* units() const { return "texels"; }
+
+private:
+    uint32_t* mTexels;
+    uint32_t mFrame;
+};
+
+// Draws a single pixel: the time is the round trip to the GPU and back,
+// like finish measures.
+class FinishScenario : public QuadScenario {
+public:
+    FinishScenario() : QuadScenario(gTextureShader) { }
+
+    virtual const char* name() const { return "finish"; }
+
+    virtual bool setup(const Target& target) {
+        if (!QuadScenario::setup(target)) {
+            return false;
+        }
+        glViewport(0, 0, 1, 1);
+        return true;
+    }
+
+    virtual void run(const Target& target) {
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+    virtual double workPerRun(const Target& target) const {
+        return 0;
+    }
+};
+
+// Clears and swaps the buffers, like testFramerate: the time includes
+// queueing the frame and dequeueing the next buffer.
+class SwapScenario : public ClearScenario {
+public:
+    virtual const char* name() const { return "swap"; }
+
+    virtual void run(const Target& target) {
+        ClearScenario::run(target);
+        eglSwapBuffers(target.dpy, target.surface);
+    }
+
+    virtual bool swaps() const { return true; }
+
+    virtual double workPerRun(const Target& target) const {
+        return 0;
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+void createScenarios(Vector<Scenario*>* scenarios) {
+    scenarios->add(new ClearScenario);
+    scenarios->add(new FillBlendScenario);
+    scenarios->add(new FillShaderScenario);
+    scenarios->add(new TextureUploadScenario);
+    scenarios->add(new FinishScenario);
+    scenarios->add(new SwapScenario);
+}
+
+}; // namespace android
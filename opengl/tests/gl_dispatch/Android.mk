@@ -0,0 +1,18 @@
+LOCAL_PATH:= $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	gl_dispatch.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	libutils \
+	libdl \
+	libEGL \
+	libGLESv2
+
+LOCAL_MODULE:= test-opengl-gl_dispatch
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,20 @@
+LOCAL_PATH:= $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	transform_perf.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	libutils \
+    libEGL \
+    libGLESv1_CM \
+    libui
+
+LOCAL_C_INCLUDES += $(call include-path-for, opengl-tests-includes)
+
+LOCAL_MODULE:= test-opengl-transform_perf
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
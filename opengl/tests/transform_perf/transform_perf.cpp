@@ -0,0 +1,138 @@
+/*
+**
+** Copyright 2013, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#define LOG_TAG "transform_perf"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <EGL/egl.h>
+#include <GLES/gl.h>
+#include <GLES/glext.h>
+
+#include <utils/Timers.h>
+#include <ui/FramebufferNativeWindow.h>
+#include "EGLUtils.h"
+
+using namespace android;
+
+// Measures the vertex transform cost of GL_FLOAT and GL_FIXED vertex
+// arrays. The triangles all face away and get culled, so almost no time
+// is spent rasterizing.
+
+static const int GRID = 64;
+static const int VERTEX_COUNT = GRID*GRID*6;
+static const int ITERATIONS = 50;
+
+static void draw(GLenum type, const GLvoid* vertices, const char* name)
+{
+    glVertexPointer(3, type, 0, vertices);
+    glDrawArrays(GL_TRIANGLES, 0, VERTEX_COUNT);
+    glFinish();
+
+    nsecs_t now = systemTime();
+    for (int i=0 ; i<ITERATIONS ; i++) {
+        glRotatef(1, 0, 0, 1);
+        glDrawArrays(GL_TRIANGLES, 0, VERTEX_COUNT);
+    }
+    glFinish();
+    nsecs_t t = systemTime() - now;
+
+    const double vertices_per_s =
+            double(VERTEX_COUNT) * ITERATIONS * 1000000000.0 / t;
+    printf("%-6s %8.3f ms/frame, %6.2f Mvertices/s\n",
+            name, (t / 1000000.0) / ITERATIONS, vertices_per_s / 1000000.0);
+}
+
+int main(int argc, char** argv)
+{
+    EGLint configAttribs[] = {
+         EGL_DEPTH_SIZE, 0,
+         EGL_NONE
+    };
+
+    EGLint majorVersion;
+    EGLint minorVersion;
+    EGLContext context;
+    EGLConfig config;
+    EGLSurface surface;
+    EGLint w, h;
+    EGLDisplay dpy;
+
+    EGLNativeWindowType window = android_createDisplaySurface();
+
+    dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    eglInitialize(dpy, &majorVersion, &minorVersion);
+
+    status_t err = EGLUtils::selectConfigForNativeWindow(
+            dpy, configAttribs, window, &config);
+    if (err) {
+        fprintf(stderr, "couldn't find an EGLConfig matching the screen format\n");
+        return 0;
+    }
+
+    surface = eglCreateWindowSurface(dpy, config, window, NULL);
+    context = eglCreateContext(dpy, config, NULL, NULL);
+    eglMakeCurrent(dpy, surface, surface, context);
+    eglQuerySurface(dpy, surface, EGL_WIDTH, &w);
+    eglQuerySurface(dpy, surface, EGL_HEIGHT, &h);
+
+    // a grid of clockwise (back facing) triangles in [-1, 1]
+    GLfloat* vf = new GLfloat[VERTEX_COUNT*3];
+    GLfixed* vx = new GLfixed[VERTEX_COUNT*3];
+    GLfloat* p = vf;
+    for (int y=0 ; y<GRID ; y++) {
+        for (int x=0 ; x<GRID ; x++) {
+            const GLfloat x0 = (2.0f * x) / GRID - 1.0f;
+            const GLfloat y0 = (2.0f * y) / GRID - 1.0f;
+            const GLfloat x1 = x0 + 2.0f / GRID;
+            const GLfloat y1 = y0 + 2.0f / GRID;
+            const GLfloat quad[6][2] = {
+                { x0, y0 }, { x0, y1 }, { x1, y1 },
+                { x0, y0 }, { x1, y1 }, { x1, y0 } };
+            for (int i=0 ; i<6 ; i++) {
+                *p++ = quad[i][0];
+                *p++ = quad[i][1];
+                *p++ = -2.0f;
+            }
+        }
+    }
+    for (int i=0 ; i<VERTEX_COUNT*3 ; i++) {
+        vx[i] = GLfixed(vf[i] * 65536.0f);
+    }
+
+    glViewport(0, 0, w, h);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glFrustumf(-1, 1, -1, 1, 1, 4);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glDisable(GL_DITHER);
+    glEnableClientState(GL_VERTEX_ARRAY);
+
+    printf("%d vertices, %d frames\n", VERTEX_COUNT, ITERATIONS);
+    draw(GL_FIXED, vx, "fixed");
+    draw(GL_FLOAT, vf, "float");
+
+    delete [] vf;
+    delete [] vx;
+    eglTerminate(dpy);
+    return 0;
+}
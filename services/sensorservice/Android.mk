@@ -2,6 +2,7 @@ LOCAL_PATH:= $(call my-dir)
 include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES:= \
+	BatchQueue.cpp \
 	BatteryService.cpp \
 	CorrectedGyroSensor.cpp \
     Fusion.cpp \
@@ -11,9 +12,11 @@ LOCAL_SRC_FILES:= \
     RotationVectorSensor.cpp \
     RotationVectorSensor2.cpp \
     SensorDevice.cpp \
+    SensorEventLog.cpp \
     SensorFusion.cpp \
     SensorInterface.cpp \
     SensorService.cpp \
+    SensorStats.cpp \
 
 # Legacy virtual sensors used in combination from accelerometer & magnetometer.
 LOCAL_SRC_FILES += \
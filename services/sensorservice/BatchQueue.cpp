@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <cutils/atomic.h>
+
+#include "BatchQueue.h"
+
+namespace android {
+// ---------------------------------------------------------------------------
+
+BatchQueue::BatchQueue(size_t numBatches, size_t batchSize)
+    : mNumBatches(numBatches), mBatchSize(batchSize),
+      mWriteCount(0), mReadCount(0), mWaiting(0)
+{
+    mBatches = new Batch[numBatches];
+    mEvents = new sensors_event_t[numBatches * batchSize];
+    for (size_t i=0 ; i<numBatches ; i++) {
+        mBatches[i].events = mEvents + i * batchSize;
+        mBatches[i].count = 0;
+        mBatches[i].wakeLock = false;
+        mBatches[i].polled = 0;
+    }
+}
+
+BatchQueue::~BatchQueue()
+{
+    delete [] mBatches;
+    delete [] mEvents;
+}
+
+bool BatchQueue::canWrite() const
+{
+    const uint32_t read = android_atomic_acquire_load(&mReadCount);
+    return uint32_t(mWriteCount) - read < mNumBatches;
+}
+
+bool BatchQueue::canRead() const
+{
+    const uint32_t written = android_atomic_acquire_load(&mWriteCount);
+    return written != uint32_t(mReadCount);
+}
+
+BatchQueue::Batch& BatchQueue::beginWrite()
+{
+    if (!canWrite()) {
+        wait(&BatchQueue::canWrite);
+    }
+    return mBatches[uint32_t(mWriteCount) % mNumBatches];
+}
+
+void BatchQueue::endWrite()
+{
+    android_atomic_release_store(mWriteCount + 1, &mWriteCount);
+    wake();
+}
+
+BatchQueue::Batch& BatchQueue::beginRead()
+{
+    if (!canRead()) {
+        wait(&BatchQueue::canRead);
+    }
+    return mBatches[uint32_t(mReadCount) % mNumBatches];
+}
+
+void BatchQueue::endRead()
+{
+    android_atomic_release_store(mReadCount + 1, &mReadCount);
+    wake();
+}
+
+void BatchQueue::wait(bool (BatchQueue::*ready)() const)
+{
+    // the barriers here and in wake() make sure that either we see the
+    // other side's update, or it sees that we're waiting.
+    Mutex::Autolock _l(mLock);
+    android_atomic_inc(&mWaiting);
+    android_memory_barrier();
+    while (!(this->*ready)()) {
+        mCondition.wait(mLock);
+    }
+    android_atomic_dec(&mWaiting);
+}
+
+void BatchQueue::wake()
+{
+    android_memory_barrier();
+    if (android_atomic_acquire_load(&mWaiting)) {
+        Mutex::Autolock _l(mLock);
+        mCondition.broadcast();
+    }
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_BATCH_QUEUE_H
+#define ANDROID_BATCH_QUEUE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/threads.h>
+#include <utils/Timers.h>
+
+#include <hardware/sensors.h>
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+/*
+ * A fixed-size ring of event batches handed from one thread to one other
+ * thread. The batches are filled and read in place. Neither side takes a
+ * lock unless it has to wait, for the ring to have a free batch or a full
+ * one.
+ */
+class BatchQueue {
+public:
+    struct Batch {
+        sensors_event_t* events;
+        size_t count;
+        // set when a wake lock was taken for the events of this batch
+        bool wakeLock;
+        // when the h/w returned the events
+        nsecs_t polled;
+    };
+
+    BatchQueue(size_t numBatches, size_t batchSize);
+    ~BatchQueue();
+
+    size_t getBatchSize() const { return mBatchSize; }
+
+    // producer side: get the next batch to fill, waiting for one to be
+    // free, then hand it to the consumer.
+    Batch& beginWrite();
+    void endWrite();
+
+    // consumer side: get the next full batch, waiting for one, then give
+    // it back.
+    Batch& beginRead();
+    void endRead();
+
+private:
+    bool canWrite() const;
+    bool canRead() const;
+    void wait(bool (BatchQueue::*ready)() const);
+    void wake();
+
+    const size_t mNumBatches;
+    const size_t mBatchSize;
+    Batch* mBatches;
+    sensors_event_t* mEvents;
+
+    // only the producer writes mWriteCount, and only the consumer
+    // mReadCount.
+    volatile int32_t mWriteCount;
+    volatile int32_t mReadCount;
+    volatile int32_t mWaiting;
+
+    Mutex mLock;
+    Condition mCondition;
+};
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+
+#endif // ANDROID_BATCH_QUEUE_H
@@ -127,6 +127,28 @@ static mat<TYPE, 3, 3> crossMatrix(const vec<TYPE, 3>& p, OTHER_TYPE diag) {
 }
 
 
+void propagateCovariance(mat<mat33_t, 2, 2>& P,
+        const mat<mat33_t, 2, 2>& Phi, const mat<mat33_t, 2, 2>& GQGt) {
+    // With A = Phi00, B = Phi10 and X = P10:
+    //
+    //  | A B | * | P00  X  | * | At 0 | = | A*P00*At + B*Xt*At + Y*Bt  Y   |
+    //  | 0 1 |   | Xt  P11 |   | Bt 1 |   |             Yt             P11 |
+    //
+    // with Y = A*X + B*P11.
+    const mat33_t& A(Phi[0][0]);
+    const mat33_t& B(Phi[1][0]);
+    const mat33_t At(transpose(A));
+    const mat33_t Bt(transpose(B));
+    const mat33_t X(P[1][0]);
+    const mat33_t Y(A*X + B*P[1][1]);
+    P[0][0] = (A*P[0][0] + B*transpose(X))*At + Y*Bt + GQGt[0][0];
+    P[1][0] = Y + GQGt[1][0];
+    P[0][1] = transpose(Y) + GQGt[0][1];
+    P[1][1] += GQGt[1][1];
+}
+
+// -----------------------------------------------------------------------
+
 template<typename TYPE, size_t SIZE>
 class Covariance {
     mat<TYPE, SIZE, SIZE> mSumXX;
@@ -441,7 +463,7 @@ void Fusion::predict(const vec3_t& w, float dT) {
     if (x0.w < 0)
         x0 = -x0;
 
-    P = Phi*P*transpose(Phi) + GQGt;
+    propagateCovariance(P, Phi, GQGt);
 
     checkState();
 }
@@ -27,6 +27,19 @@ namespace android {
 
 typedef mat<float, 3, 4> mat34_t;
 
+/*
+ * P = Phi*P*transpose(Phi) + GQGt, for the Phi of the fusion's prediction
+ * step, which has the form
+ *
+ *  Phi = | Phi00 Phi10 |
+ *        |   0     1   |
+ *
+ * and the block-diagonal GQGt it uses. This only does a third of the work
+ * of the full product.
+ */
+void propagateCovariance(mat<mat33_t, 2, 2>& P,
+        const mat<mat33_t, 2, 2>& Phi, const mat<mat33_t, 2, 2>& GQGt);
+
 class Fusion {
     /*
      * the state vector is made of two sub-vector containing respectively:
@@ -16,8 +16,11 @@
 
 #include <stdint.h>
 #include <math.h>
+#include <stdlib.h>
 #include <sys/types.h>
 
+#include <cutils/properties.h>
+
 #include <utils/Atomic.h>
 #include <utils/Errors.h>
 #include <utils/Singleton.h>
@@ -90,6 +93,15 @@ SensorDevice::SensorDevice()
                 mActivationCount.add(list[i].handle, model);
                 mSensorDevice->activate(mSensorDevice, list[i].handle, 0);
             }
+
+            char path[PROPERTY_VALUE_MAX];
+            if (property_get("debug.sensors.replay", path, NULL) > 0) {
+                char speed[PROPERTY_VALUE_MAX];
+                property_get("debug.sensors.replay_speed", speed, "1");
+                mPlayer.open(path, atof(speed));
+            } else if (property_get("debug.sensors.record", path, NULL) > 0) {
+                mRecorder.open(path);
+            }
         }
     }
 }
@@ -116,7 +128,8 @@ void SensorDevice::dump(String8& result, char* buffer, size_t SIZE)
                     j<info.rates.size()-1 ? ", " : "");
             result.append(buffer);
         }
-        snprintf(buffer, SIZE, " }, selected=%4.1f ms\n",  info.delay / 1e6f);
+        snprintf(buffer, SIZE, " }, selected=%4.1f ms, latency=%4.1f ms\n",
+                info.delay / 1e6f, info.latency / 1e6f);
         result.append(buffer);
     }
 }
@@ -137,10 +150,16 @@ status_t SensorDevice::initCheck() const {
 
 ssize_t SensorDevice::poll(sensors_event_t* buffer, size_t count) {
     if (!mSensorDevice) return NO_INIT;
+    if (mPlayer.isPlaying()) {
+        return mPlayer.poll(buffer, count);
+    }
     ssize_t c;
     do {
         c = mSensorDevice->poll(mSensorDevice, buffer, count);
     } while (c == -EINTR);
+    if (c > 0 && mRecorder.isRecording()) {
+        mRecorder.record(buffer, c);
+    }
     return c;
 }
 
@@ -148,6 +167,7 @@ void SensorDevice::autoDisable(void *ident, int handle) {
     Info& info( mActivationCount.editValueFor(handle) );
     Mutex::Autolock _l(mLock);
     info.rates.removeItem(ident);
+    info.latencies.removeItem(ident);
 }
 
 status_t SensorDevice::activate(void* ident, int handle, int enabled)
@@ -198,6 +218,7 @@ status_t SensorDevice::activate(void* ident, int handle, int enabled)
                 info.rates.indexOfKey(ident));
 
         ssize_t idx = info.rates.removeItem(ident);
+        info.latencies.removeItem(ident);
         if (idx >= 0) {
             if (info.rates.size() == 0) {
                 actuateHardware = true;
@@ -227,8 +248,9 @@ status_t SensorDevice::activate(void* ident, int handle, int enabled)
 
     { // scope for the lock
         Mutex::Autolock _l(mLock);
-        nsecs_t ns = info.selectDelay();
-        mSensorDevice->setDelay(mSensorDevice, handle, ns);
+        info.selectDelay();
+        info.selectLatency();
+        setDelayLocked(handle, info);
     }
 
     return err;
@@ -241,8 +263,39 @@ status_t SensorDevice::setDelay(void* ident, int handle, int64_t ns)
     Info& info( mActivationCount.editValueFor(handle) );
     status_t err = info.setDelayForIdent(ident, ns);
     if (err < 0) return err;
-    ns = info.selectDelay();
-    return mSensorDevice->setDelay(mSensorDevice, handle, ns);
+    info.selectDelay();
+    return setDelayLocked(handle, info);
+}
+
+status_t SensorDevice::setMaxReportLatency(void* ident, int handle, int64_t ns)
+{
+    if (!mSensorDevice) return NO_INIT;
+    Mutex::Autolock _l(mLock);
+    Info& info( mActivationCount.editValueFor(handle) );
+    if (info.rates.indexOfKey(ident) < 0) {
+        return BAD_INDEX;
+    }
+    if (ns > 0) {
+        info.latencies.add(ident, ns);
+    } else {
+        info.latencies.removeItem(ident);
+    }
+    info.selectLatency();
+    return setDelayLocked(handle, info);
+}
+
+status_t SensorDevice::setDelayLocked(int handle, const Info& info)
+{
+    // from version 1.0, the h/w can hold the events in a FIFO and report
+    // them in batches, which lets the AP sleep in between.
+    if (getHalDeviceVersion() >= SENSORS_DEVICE_API_VERSION_1_0) {
+        sensors_poll_device_1_t* dev =
+                reinterpret_cast<sensors_poll_device_1_t*>(mSensorDevice);
+        if (dev->batch) {
+            return dev->batch(dev, handle, 0, info.delay, info.latency);
+        }
+    }
+    return mSensorDevice->setDelay(mSensorDevice, handle, info.delay);
 }
 
 int SensorDevice::getHalDeviceVersion() const {
@@ -278,6 +331,21 @@ nsecs_t SensorDevice::Info::selectDelay()
     return ns;
 }
 
+nsecs_t SensorDevice::Info::selectLatency()
+{
+    // the sensor can only batch as long as the most demanding of its
+    // clients allows, and not at all if any of them didn't ask for it.
+    nsecs_t ns = 0;
+    for (size_t i=0 ; i<rates.size() ; i++) {
+        nsecs_t cur = latencies.valueFor(rates.keyAt(i));
+        if (i == 0 || cur < ns) {
+            ns = cur;
+        }
+    }
+    latency = ns;
+    return ns;
+}
+
 // ---------------------------------------------------------------------------
 }; // namespace android
 
@@ -26,6 +26,8 @@
 
 #include <gui/Sensor.h>
 
+#include "SensorEventLog.h"
+
 // ---------------------------------------------------------------------------
 
 namespace android {
@@ -40,15 +42,22 @@ class SensorDevice : public Singleton<SensorDevice> {
     mutable Mutex mLock; // protect mActivationCount[].rates
     // fixed-size array after construction
     struct Info {
-        Info() : delay(0) { }
+        Info() : delay(0), latency(0) { }
         KeyedVector<void*, nsecs_t> rates;
+        DefaultKeyedVector<void*, nsecs_t> latencies;
         nsecs_t delay;
+        nsecs_t latency;
         status_t setDelayForIdent(void* ident, int64_t ns);
         nsecs_t selectDelay();
+        nsecs_t selectLatency();
     };
     DefaultKeyedVector<int, Info> mActivationCount;
+    // only used by poll()
+    SensorEventRecorder mRecorder;
+    SensorEventPlayer mPlayer;
 
     SensorDevice();
+    status_t setDelayLocked(int handle, const Info& info);
 public:
     ssize_t getSensorList(sensor_t const** list);
     status_t initCheck() const;
@@ -56,6 +65,7 @@ public:
     ssize_t poll(sensors_event_t* buffer, size_t count);
     status_t activate(void* ident, int handle, int enabled);
     status_t setDelay(void* ident, int handle, int64_t ns);
+    status_t setMaxReportLatency(void* ident, int handle, int64_t ns);
     void autoDisable(void *ident, int handle);
     void dump(String8& result, char* buffer, size_t SIZE);
 };
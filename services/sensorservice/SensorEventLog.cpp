@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+
+#include "SensorEventLog.h"
+
+namespace android {
+// ---------------------------------------------------------------------------
+
+SensorEventRecorder::SensorEventRecorder()
+    : mFd(-1)
+{
+}
+
+SensorEventRecorder::~SensorEventRecorder()
+{
+    if (mFd >= 0)
+        close(mFd);
+}
+
+status_t SensorEventRecorder::open(const char* path)
+{
+    mFd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (mFd < 0) {
+        ALOGE("can't create sensor event log %s (%s)", path, strerror(errno));
+        return -errno;
+    }
+    SensorEventLogHeader header;
+    header.magic = SensorEventLogHeader::MAGIC;
+    header.version = SensorEventLogHeader::VERSION;
+    if (write(mFd, &header, sizeof(header)) != sizeof(header)) {
+        close(mFd);
+        mFd = -1;
+        return UNKNOWN_ERROR;
+    }
+    ALOGI("recording sensor events to %s", path);
+    return NO_ERROR;
+}
+
+void SensorEventRecorder::record(sensors_event_t const* events, size_t count)
+{
+    if (mFd < 0 || count == 0)
+        return;
+
+    SensorEventLogEntry entries[count];
+    for (size_t i=0 ; i<count ; i++) {
+        entries[i].sensor = events[i].sensor;
+        entries[i].type = events[i].type;
+        entries[i].timestamp = events[i].timestamp;
+        memcpy(entries[i].data, events[i].data, sizeof(entries[i].data));
+    }
+    const ssize_t size = count * sizeof(SensorEventLogEntry);
+    if (write(mFd, entries, size) != size) {
+        ALOGE("error writing sensor event log (%s), stopping", strerror(errno));
+        close(mFd);
+        mFd = -1;
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+SensorEventPlayer::SensorEventPlayer()
+    : mFd(-1), mSpeed(1), mLogStart(0), mPlayStart(0), mHasNext(false)
+{
+}
+
+SensorEventPlayer::~SensorEventPlayer()
+{
+    if (mFd >= 0)
+        close(mFd);
+}
+
+status_t SensorEventPlayer::open(const char* path, float speed)
+{
+    mFd = ::open(path, O_RDONLY);
+    if (mFd < 0) {
+        ALOGE("can't open sensor event log %s (%s)", path, strerror(errno));
+        return -errno;
+    }
+    SensorEventLogHeader header;
+    if (read(mFd, &header, sizeof(header)) != sizeof(header) ||
+            header.magic != SensorEventLogHeader::MAGIC ||
+            header.version != SensorEventLogHeader::VERSION) {
+        ALOGE("%s is not a sensor event log", path);
+        close(mFd);
+        mFd = -1;
+        return BAD_VALUE;
+    }
+    mSpeed = speed > 0 ? speed : 1;
+    rewind();
+    if (!mHasNext) {
+        ALOGE("sensor event log %s is empty", path);
+        close(mFd);
+        mFd = -1;
+        return BAD_VALUE;
+    }
+    ALOGI("playing sensor events from %s at %.2fx", path, mSpeed);
+    return NO_ERROR;
+}
+
+bool SensorEventPlayer::readNext()
+{
+    mHasNext = read(mFd, &mNext, sizeof(mNext)) == sizeof(mNext);
+    return mHasNext;
+}
+
+void SensorEventPlayer::rewind()
+{
+    lseek(mFd, sizeof(SensorEventLogHeader), SEEK_SET);
+    if (readNext()) {
+        mLogStart = mNext.timestamp;
+        mPlayStart = systemTime(SYSTEM_TIME_MONOTONIC);
+    }
+}
+
+ssize_t SensorEventPlayer::poll(sensors_event_t* buffer, size_t count)
+{
+    if (mFd < 0)
+        return NO_INIT;
+
+    // wait for the next event to be due, then return it with all those
+    // that are due as well
+    const nsecs_t due = mPlayStart +
+            nsecs_t((mNext.timestamp - mLogStart) / mSpeed);
+    const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    if (due > now) {
+        const nsecs_t wait = due - now;
+        struct timespec ts;
+        ts.tv_sec = wait / 1000000000;
+        ts.tv_nsec = wait % 1000000000;
+        while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+        }
+    }
+
+    const nsecs_t timestamp = systemTime(SYSTEM_TIME_MONOTONIC);
+    const nsecs_t end = timestamp - mPlayStart;
+    size_t n = 0;
+    while (n < count) {
+        sensors_event_t& event(buffer[n++]);
+        memset(&event, 0, sizeof(event));
+        event.version = sizeof(sensors_event_t);
+        event.sensor = mNext.sensor;
+        event.type = mNext.type;
+        event.timestamp = timestamp;
+        memcpy(event.data, mNext.data, sizeof(mNext.data));
+        if (!readNext()) {
+            rewind();
+            break;
+        }
+        if (nsecs_t((mNext.timestamp - mLogStart) / mSpeed) > end) {
+            break;
+        }
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
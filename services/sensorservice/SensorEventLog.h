@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_EVENT_LOG_H
+#define ANDROID_SENSOR_EVENT_LOG_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/Timers.h>
+
+#include <hardware/sensors.h>
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+/*
+ * Event logs hold what SensorDevice::poll() returned, so that a session can
+ * be played back to benchmark the service reproducibly.
+ *
+ * The file is a SensorEventLogHeader followed by SensorEventLogEntry
+ * records, in the byte order of the device that wrote it.
+ */
+
+struct SensorEventLogHeader {
+    enum { MAGIC = 0x47564553, VERSION = 1 }; // 'SEVG'
+    uint32_t magic;
+    uint32_t version;
+};
+
+struct SensorEventLogEntry {
+    int32_t sensor;
+    int32_t type;
+    int64_t timestamp;
+    float data[16];
+};
+
+// Records the events given to it. Turned on by setting debug.sensors.record
+// to the path of the file to write.
+class SensorEventRecorder {
+    int mFd;
+public:
+    SensorEventRecorder();
+    ~SensorEventRecorder();
+    status_t open(const char* path);
+    bool isRecording() const { return mFd >= 0; }
+    void record(sensors_event_t const* events, size_t count);
+};
+
+// Plays a log back in place of the h/w. The events keep their spacing,
+// divided by the speed, and are time-stamped when they're returned so the
+// clients see a normal event stream. The log is played in a loop.
+// Turned on by setting debug.sensors.replay to the path of the log, and
+// optionally debug.sensors.replay_speed.
+class SensorEventPlayer {
+    int mFd;
+    float mSpeed;
+    nsecs_t mLogStart;      // time-stamp of the first event of the log
+    nsecs_t mPlayStart;     // when we played it
+    SensorEventLogEntry mNext;
+    bool mHasNext;
+    bool readNext();
+    void rewind();
+public:
+    SensorEventPlayer();
+    ~SensorEventPlayer();
+    status_t open(const char* path, float speed);
+    bool isPlaying() const { return mFd >= 0; }
+    ssize_t poll(sensors_event_t* buffer, size_t count);
+};
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+
+#endif // ANDROID_SENSOR_EVENT_LOG_H
@@ -54,6 +54,10 @@ status_t HardwareSensor::setDelay(void* ident, int handle, int64_t ns) {
     return mSensorDevice.setDelay(ident, handle, ns);
 }
 
+status_t HardwareSensor::setMaxReportLatency(void* ident, int handle, int64_t ns) {
+    return mSensorDevice.setMaxReportLatency(ident, handle, ns);
+}
+
 void HardwareSensor::autoDisable(void *ident, int handle) {
     mSensorDevice.autoDisable(ident, handle);
 }
@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 #include <math.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include <cutils/properties.h>
@@ -25,6 +26,7 @@
 #include <utils/threads.h>
 #include <utils/Atomic.h>
 #include <utils/Errors.h>
+#include <utils/Profiler.h>
 #include <utils/RefBase.h>
 #include <utils/Singleton.h>
 #include <utils/String16.h>
@@ -40,6 +42,7 @@
 #include <hardware/sensors.h>
 #include <hardware_legacy/power.h>
 
+#include "BatchQueue.h"
 #include "BatteryService.h"
 #include "CorrectedGyroSensor.h"
 #include "GravitySensor.h"
@@ -71,7 +74,9 @@ namespace android {
 const char* SensorService::WAKE_LOCK_NAME = "SensorService";
 
 SensorService::SensorService()
-    : mInitCheck(NO_INIT)
+    : mUserSensorTypes(-1), mInitCheck(NO_INIT),
+      mActiveState(new ActiveState()),
+      mPolledEvents(0), mProcessedEvents(0), mWakeLockCount(0)
 {
 }
 
@@ -178,6 +183,31 @@ void SensorService::onFirstRef()
                 }
             }
 
+            mUserSensorTypes.setCapacity(mUserSensorList.size());
+            for (size_t i=0 ; i<mUserSensorList.size() ; i++) {
+                mUserSensorTypes.add(mUserSensorList[i].getHandle(),
+                        mUserSensorList[i].getType());
+            }
+
+            // both lists are constant from now on, publish them once
+            mUserSensorListMemory = writeSensorList(mUserSensorList);
+            mUserSensorListDebugMemory = writeSensorList(mUserSensorListDebug);
+
+            // the batches of the second stage have room for the events
+            // of the virtual sensors.
+            const size_t numEventMax = 16;
+            mPolledEvents = new BatchQueue(NUM_BATCHES, numEventMax);
+            mProcessedEvents = new BatchQueue(NUM_BATCHES,
+                    numEventMax + numEventMax * mVirtualSensorList.size());
+
+            // time the stages of the pipeline, see dumpsys sensorservice
+            char value[PROPERTY_VALUE_MAX];
+            property_get("debug.sensors.profile", value, "0");
+            Profiler::setEnabled(atoi(value));
+            mDispatchThread = new LoopThread(this, &SensorService::dispatchLoop);
+            mDispatchThread->run("SensorService dispatch", PRIORITY_URGENT_DISPLAY);
+            mProcessThread = new LoopThread(this, &SensorService::processLoop);
+            mProcessThread->run("SensorService process", PRIORITY_URGENT_DISPLAY);
             run("SensorService", PRIORITY_URGENT_DISPLAY);
             mInitCheck = NO_ERROR;
         }
@@ -196,6 +226,7 @@ void SensorService::registerSensor(SensorInterface* s)
     mSensorMap.add(sensor.getHandle(), s);
     // create an entry in the mLastEventSeen array
     mLastEventSeen.add(sensor.getHandle(), event);
+    mStats.add(sensor.getHandle(), SensorStats());
 }
 
 void SensorService::registerVirtualSensor(SensorInterface* s)
@@ -208,6 +239,8 @@ SensorService::~SensorService()
 {
     for (size_t i=0 ; i<mSensorMap.size() ; i++)
         delete mSensorMap.valueAt(i);
+    delete mPolledEvents;
+    delete mProcessedEvents;
 }
 
 static const String16 sDump("android.permission.DUMP");
@@ -256,6 +289,27 @@ status_t SensorService::dump(int fd, const Vector<String16>& args)
                     mActiveSensors.valueAt(i)->getNumConnections());
             result.append(buffer);
         }
+
+        Mutex::Autolock _s(mStatsLock);
+        snprintf(buffer, SIZE, "Event latencies:\n");
+        result.append(buffer);
+        for (size_t i=0 ; i<mStats.size() ; i++) {
+            const SensorStats& stats(mStats.valueAt(i));
+            if (stats.processing.getCount() == 0 && stats.dropped == 0) {
+                continue;
+            }
+            snprintf(buffer, SIZE, "%s (handle=0x%08x, dropped=%llu)\n",
+                    getSensorName(mStats.keyAt(i)).string(),
+                    mStats.keyAt(i),
+                    stats.dropped);
+            result.append(buffer);
+            stats.halToService.dump("h/w to poll", result, buffer, SIZE);
+            stats.processing.dump("processing", result, buffer, SIZE);
+            stats.delivery.dump("delivery", result, buffer, SIZE);
+        }
+        if (Profiler::isEnabled()) {
+            Profiler::dump(result);
+        }
     }
     write(fd, result.string(), result.size());
     return NO_ERROR;
@@ -283,115 +337,190 @@ bool SensorService::threadLoop()
 {
     ALOGD("nuSensorService thread starting...");
 
+    // this thread only polls the h/w, the events go through the rest of
+    // the pipeline on mProcessThread and mDispatchThread. That way neither
+    // the virtual sensors nor slow clients delay the next poll().
     const size_t numEventMax = 16;
-    const size_t minBufferSize = numEventMax + numEventMax * mVirtualSensorList.size();
-    sensors_event_t buffer[minBufferSize];
-    sensors_event_t scratch[minBufferSize];
     SensorDevice& device(SensorDevice::getInstance());
-    const size_t vcount = mVirtualSensorList.size();
 
     ssize_t count;
-    bool wakeLockAcquired = false;
-    const int halVersion = device.getHalDeviceVersion();
     do {
-        count = device.poll(buffer, numEventMax);
+        BatchQueue::Batch& batch(mPolledEvents->beginWrite());
+        {
+            PROFILE_SCOPE("poll");
+            count = device.poll(batch.events, numEventMax);
+        }
         if (count<0) {
             ALOGE("sensor poll failed (%s)", strerror(-count));
             break;
         }
 
-        // Poll has returned. Hold a wakelock.
+        // Poll has returned. Hold a wakelock until the events are sent.
         // Todo(): add a flag to the sensors definitions to indicate
         // the sensors which can wake up the AP
+        batch.count = count;
+        batch.wakeLock = false;
+        batch.polled = systemTime();
+        recordHalLatency(batch.events, count, batch.polled);
         for (int i = 0; i < count; i++) {
-            if (getSensorType(buffer[i].sensor) == SENSOR_TYPE_SIGNIFICANT_MOTION) {
-                 acquire_wake_lock(PARTIAL_WAKE_LOCK, WAKE_LOCK_NAME);
-                 wakeLockAcquired = true;
+            if (getSensorType(batch.events[i].sensor) == SENSOR_TYPE_SIGNIFICANT_MOTION) {
+                 acquireWakeLock();
+                 batch.wakeLock = true;
                  break;
             }
         }
+        mPolledEvents->endWrite();
+    } while (count >= 0 || Thread::exitPending());
 
+    ALOGW("Exiting SensorService::threadLoop => aborting...");
+    abort();
+    return false;
+}
+
+bool SensorService::processLoop()
+{
+    const size_t vcount = mVirtualSensorList.size();
+    const int halVersion = SensorDevice::getInstance().getHalDeviceVersion();
+
+    BatchQueue::Batch& polled(mPolledEvents->beginRead());
+    BatchQueue::Batch& processed(mProcessedEvents->beginWrite());
+    // not counting the waits for the other stages
+    PROFILE_SCOPE("process");
+    const size_t minBufferSize = mProcessedEvents->getBatchSize();
+    sensors_event_t* const buffer = processed.events;
+    size_t count = polled.count;
+    memcpy(buffer, polled.events, count * sizeof(sensors_event_t));
+    processed.wakeLock = polled.wakeLock;
+    processed.polled = polled.polled;
+    mPolledEvents->endRead();
+
+    if (count) {
         recordLastValue(buffer, count);
+    }
 
-        // handle virtual sensors
-        if (count && vcount) {
-            sensors_event_t const * const event = buffer;
-            const DefaultKeyedVector<int, SensorInterface*> virtualSensors(
-                    getActiveVirtualSensors());
-            const size_t activeVirtualSensorCount = virtualSensors.size();
-            if (activeVirtualSensorCount) {
-                size_t k = 0;
-                SensorFusion& fusion(SensorFusion::getInstance());
-                if (fusion.isEnabled()) {
-                    for (size_t i=0 ; i<size_t(count) ; i++) {
-                        fusion.process(event[i]);
-                    }
+    // handle virtual sensors
+    if (count && vcount) {
+        sensors_event_t const * const event = buffer;
+        const sp<const ActiveState> state(getActiveState());
+        const Vector<SensorInterface*>& virtualSensors(state->virtualSensors);
+        const size_t activeVirtualSensorCount = virtualSensors.size();
+        if (activeVirtualSensorCount) {
+            PROFILE_SCOPE("virtualSensors");
+            size_t k = 0;
+            SensorFusion& fusion(SensorFusion::getInstance());
+            if (fusion.isEnabled()) {
+                for (size_t i=0 ; i<size_t(count) ; i++) {
+                    fusion.process(event[i]);
                 }
-                RotationVectorSensor2& rv2(RotationVectorSensor2::getInstance());
-                if (rv2.isEnabled()) {
-                    for (size_t i=0 ; i<size_t(count) ; i++) {
-                        rv2.process(event[i]);
-                    }
+            }
+            RotationVectorSensor2& rv2(RotationVectorSensor2::getInstance());
+            if (rv2.isEnabled()) {
+                for (size_t i=0 ; i<size_t(count) ; i++) {
+                    rv2.process(event[i]);
                 }
-                for (size_t i=0 ; i<size_t(count) && k<minBufferSize ; i++) {
-                    for (size_t j=0 ; j<activeVirtualSensorCount ; j++) {
-                        if (count + k >= minBufferSize) {
-                            ALOGE("buffer too small to hold all events: "
-                                    "count=%u, k=%u, size=%u",
-                                    count, k, minBufferSize);
-                            break;
-                        }
-                        sensors_event_t out;
-                        SensorInterface* si = virtualSensors.valueAt(j);
-                        if (si->process(&out, event[i])) {
-                            buffer[count + k] = out;
-                            k++;
-                        }
+            }
+            for (size_t i=0 ; i<size_t(count) && k<minBufferSize ; i++) {
+                for (size_t j=0 ; j<activeVirtualSensorCount ; j++) {
+                    if (count + k >= minBufferSize) {
+                        ALOGE("buffer too small to hold all events: "
+                                "count=%u, k=%u, size=%u",
+                                count, k, minBufferSize);
+                        break;
+                    }
+                    sensors_event_t out;
+                    SensorInterface* si = virtualSensors[j];
+                    if (si->process(&out, event[i])) {
+                        buffer[count + k] = out;
+                        k++;
                     }
-                }
-                if (k) {
-                    // record the last synthesized values
-                    recordLastValue(&buffer[count], k);
-                    count += k;
-                    // sort the buffer by time-stamps
-                    sortEventBuffer(buffer, count);
                 }
             }
+            if (k) {
+                // record the last synthesized values
+                recordLastValue(&buffer[count], k);
+                count += k;
+                // sort the buffer by time-stamps
+                sortEventBuffer(buffer, count);
+            }
         }
+    }
 
-        // handle backward compatibility for RotationVector sensor
-        if (halVersion < SENSORS_DEVICE_API_VERSION_1_0) {
-            for (int i = 0; i < count; i++) {
-                if (getSensorType(buffer[i].sensor) == SENSOR_TYPE_ROTATION_VECTOR) {
-                    // All the 4 components of the quaternion should be available
-                    // No heading accuracy. Set it to -1
-                    buffer[i].data[4] = -1;
-                }
+    // handle backward compatibility for RotationVector sensor
+    if (halVersion < SENSORS_DEVICE_API_VERSION_1_0) {
+        for (size_t i = 0; i < count; i++) {
+            if (getSensorType(buffer[i].sensor) == SENSOR_TYPE_ROTATION_VECTOR) {
+                // All the 4 components of the quaternion should be available
+                // No heading accuracy. Set it to -1
+                buffer[i].data[4] = -1;
             }
         }
+    }
 
-        // send our events to clients...
-        const SortedVector< wp<SensorEventConnection> > activeConnections(
-                getActiveConnections());
-        size_t numConnections = activeConnections.size();
-        for (size_t i=0 ; i<numConnections ; i++) {
-            sp<SensorEventConnection> connection(
-                    activeConnections[i].promote());
-            if (connection != 0) {
-                connection->sendEvents(buffer, count, scratch);
-                // Some sensors need to be auto disabled after the trigger
-                cleanupAutoDisabledSensor(connection, buffer, count);
-            }
+    processed.count = count;
+    mProcessedEvents->endWrite();
+    return true;
+}
+
+bool SensorService::dispatchLoop()
+{
+    BatchQueue::Batch& batch(mProcessedEvents->beginRead());
+    PROFILE_SCOPE("dispatch");
+
+    // send our events to clients...
+    if (batch.count) {
+        sensors_event_t scratch[batch.count];
+        sendEventsToSubscribers(batch.events, batch.count, scratch,
+                batch.polled);
+    }
+
+    // We have sent the data, upper layers should hold the wakelock.
+    if (batch.wakeLock) {
+        releaseWakeLock();
+    }
+
+    mProcessedEvents->endRead();
+    return true;
+}
+
+void SensorService::recordHalLatency(sensors_event_t const* events,
+        size_t count, nsecs_t polled)
+{
+    Mutex::Autolock _l(mStatsLock);
+    for (size_t i=0 ; i<count ; i++) {
+        ssize_t index = mStats.indexOfKey(events[i].sensor);
+        if (index >= 0) {
+            mStats.editValueAt(index).halToService.add(
+                    polled - events[i].timestamp);
         }
+    }
+}
 
-        // We have read the data, upper layers should hold the wakelock.
-        if (wakeLockAcquired) release_wake_lock(WAKE_LOCK_NAME);
+void SensorService::recordDroppedEvents(sensors_event_t const* events,
+        size_t count)
+{
+    Mutex::Autolock _l(mStatsLock);
+    for (size_t i=0 ; i<count ; i++) {
+        ssize_t index = mStats.indexOfKey(events[i].sensor);
+        if (index >= 0) {
+            mStats.editValueAt(index).dropped++;
+        }
+    }
+}
 
-    } while (count >= 0 || Thread::exitPending());
+void SensorService::acquireWakeLock()
+{
+    Mutex::Autolock _l(mWakeLockLock);
+    if (mWakeLockCount++ == 0) {
+        acquire_wake_lock(PARTIAL_WAKE_LOCK, WAKE_LOCK_NAME);
+    }
+}
 
-    ALOGW("Exiting SensorService::threadLoop => aborting...");
-    abort();
-    return false;
+void SensorService::releaseWakeLock()
+{
+    Mutex::Autolock _l(mWakeLockLock);
+    if (--mWakeLockCount == 0) {
+        release_wake_lock(WAKE_LOCK_NAME);
+    }
 }
 
 void SensorService::recordLastValue(
@@ -424,18 +553,166 @@ void SensorService::sortEventBuffer(sensors_event_t* buffer, size_t count)
     qsort(buffer, count, sizeof(sensors_event_t), compar::cmp);
 }
 
-SortedVector< wp<SensorService::SensorEventConnection> >
-SensorService::getActiveConnections() const
+void SensorService::sendEventsToSubscribers(
+        sensors_event_t const* buffer, size_t count, sensors_event_t* scratch,
+        nsecs_t polled)
 {
-    Mutex::Autolock _l(mLock);
-    return mActiveConnections;
+    const nsecs_t dispatched = systemTime();
+
+    // group the events by sensor, in time order within each group. The
+    // buffer usually holds a handful of sensors, so a linear search for
+    // the group is fine.
+    size_t groupOf[count];
+    int32_t groupHandle[count];
+    size_t groupFirst[count];
+    size_t groupCount[count];
+    size_t numGroups = 0;
+    for (size_t i=0 ; i<count ; i++) {
+        const int32_t handle = buffer[i].sensor;
+        size_t g = (i > 0 && buffer[i-1].sensor == handle) ? groupOf[i-1] : 0;
+        while (g<numGroups && groupHandle[g] != handle) {
+            g++;
+        }
+        if (g == numGroups) {
+            groupHandle[g] = handle;
+            groupCount[g] = 0;
+            numGroups++;
+        }
+        groupOf[i] = g;
+        groupCount[g]++;
+    }
+    size_t first = 0;
+    for (size_t g=0 ; g<numGroups ; g++) {
+        groupFirst[g] = first;
+        first += groupCount[g];
+        groupCount[g] = 0;
+    }
+    sensors_event_t grouped[count];
+    for (size_t i=0 ; i<count ; i++) {
+        const size_t g = groupOf[i];
+        grouped[groupFirst[g] + groupCount[g]++] = buffer[i];
+    }
+    ssize_t stats[numGroups];
+    {
+        Mutex::Autolock _l(mStatsLock);
+        for (size_t g=0 ; g<numGroups ; g++) {
+            stats[g] = mStats.indexOfKey(groupHandle[g]);
+            if (stats[g] >= 0) {
+                mStats.editValueAt(stats[g]).processing.add(
+                        dispatched - polled, groupCount[g]);
+            }
+        }
+    }
+
+    // then chain the groups each connection listens to, in order, using
+    // the subscribers of the current state. It only changes when sensors
+    // are enabled or disabled, so this allocates nothing.
+    const sp<const ActiveState> state(getActiveState());
+    const size_t numConnections = state->connections.size();
+    size_t numLinks = 0;
+    ssize_t subscribers[numGroups];
+    for (size_t g=0 ; g<numGroups ; g++) {
+        subscribers[g] = state->subscribers.indexOfKey(groupHandle[g]);
+        if (subscribers[g] >= 0) {
+            numLinks += state->subscribers.valueAt(subscribers[g]).size();
+        }
+    }
+    if (numLinks == 0) {
+        return;
+    }
+    ssize_t head[numConnections];
+    ssize_t tail[numConnections];
+    for (size_t c=0 ; c<numConnections ; c++) {
+        head[c] = -1;
+        tail[c] = -1;
+    }
+    size_t linkGroup[numLinks];
+    ssize_t linkNext[numLinks];
+    size_t link = 0;
+    for (size_t g=0 ; g<numGroups ; g++) {
+        if (subscribers[g] < 0) {
+            continue;
+        }
+        const Vector<size_t>& connections(state->subscribers.valueAt(subscribers[g]));
+        for (size_t j=0 ; j<connections.size() ; j++) {
+            const size_t c = connections[j];
+            linkGroup[link] = g;
+            linkNext[link] = -1;
+            if (tail[c] < 0) {
+                head[c] = link;
+            } else {
+                linkNext[tail[c]] = link;
+            }
+            tail[c] = link;
+            link++;
+        }
+    }
+
+    // finally, hand each connection its events in one go
+    sensors_event_t events[count];
+    for (size_t c=0 ; c<numConnections ; c++) {
+        if (head[c] < 0) {
+            continue;
+        }
+        sp<SensorEventConnection> connection(state->connections[c].promote());
+        if (connection == 0) {
+            continue;
+        }
+        size_t n = 0;
+        for (ssize_t l=head[c] ; l>=0 ; l=linkNext[l]) {
+            const size_t g = linkGroup[l];
+            memcpy(&events[n], &grouped[groupFirst[g]],
+                    groupCount[g] * sizeof(sensors_event_t));
+            n += groupCount[g];
+        }
+        connection->sendEvents(events, n, scratch);
+        const nsecs_t delivered = systemTime();
+        {
+            Mutex::Autolock _l(mStatsLock);
+            for (ssize_t l=head[c] ; l>=0 ; l=linkNext[l]) {
+                const size_t g = linkGroup[l];
+                if (stats[g] >= 0) {
+                    mStats.editValueAt(stats[g]).delivery.add(
+                            delivered - dispatched, groupCount[g]);
+                }
+            }
+        }
+        // Some sensors need to be auto disabled after the trigger
+        cleanupAutoDisabledSensor(connection, events, n);
+    }
 }
 
-DefaultKeyedVector<int, SensorInterface*>
-SensorService::getActiveVirtualSensors() const
+sp<const SensorService::ActiveState> SensorService::getActiveState() const
 {
     Mutex::Autolock _l(mLock);
-    return mActiveVirtualSensors;
+    return mActiveState;
+}
+
+void SensorService::updateActiveStateLocked()
+{
+    sp<ActiveState> state(new ActiveState());
+    for (size_t i=0 ; i<mActiveVirtualSensors.size() ; i++) {
+        state->virtualSensors.add(mActiveVirtualSensors.valueAt(i));
+    }
+    KeyedVector<SensorEventConnection*, size_t> index;
+    for (size_t i=0 ; i<mActiveSensors.size() ; i++) {
+        const SortedVector< wp<SensorEventConnection> >& connections(
+                mActiveSensors.valueAt(i)->getConnections());
+        Vector<size_t> subscribers;
+        for (size_t j=0 ; j<connections.size() ; j++) {
+            SensorEventConnection* const key = connections[j].unsafe_get();
+            ssize_t c = index.indexOfKey(key);
+            if (c >= 0) {
+                c = index.valueAt(c);
+            } else {
+                c = state->connections.add(connections[j]);
+                index.add(key, c);
+            }
+            subscribers.add(c);
+        }
+        state->subscribers.add(mActiveSensors.keyAt(i), subscribers);
+    }
+    mActiveState = state;
 }
 
 String8 SensorService::getSensorName(int handle) const {
@@ -451,14 +728,7 @@ String8 SensorService::getSensorName(int handle) const {
 }
 
 int SensorService::getSensorType(int handle) const {
-    size_t count = mUserSensorList.size();
-    for (size_t i=0 ; i<count ; i++) {
-        const Sensor& sensor(mUserSensorList[i]);
-        if (sensor.getHandle() == handle) {
-            return sensor.getType();
-        }
-    }
-    return -1;
+    return mUserSensorTypes.valueFor(handle);
 }
 
 
@@ -472,6 +742,16 @@ Vector<Sensor> SensorService::getSensorList()
     return mUserSensorList;
 }
 
+sp<IMemoryHeap> SensorService::getSensorListMemory()
+{
+    char value[PROPERTY_VALUE_MAX];
+    property_get("debug.sensors", value, "0");
+    if (atoi(value)) {
+        return mUserSensorListDebugMemory;
+    }
+    return mUserSensorListMemory;
+}
+
 sp<ISensorEventConnection> SensorService::createSensorEventConnection()
 {
     uid_t uid = IPCThreadState::self()->getCallingUid();
@@ -512,6 +792,7 @@ void SensorService::cleanupConnection(SensorEventConnection* c)
         }
     }
     mActiveConnections.remove(connection);
+    updateActiveStateLocked();
     BatteryService::cleanup(c->getUid());
 }
 
@@ -561,6 +842,7 @@ status_t SensorService::enable(const sp<SensorEventConnection>& connection,
         ALOGW("sensor %08x already enabled in connection %p (ignoring)",
             handle, connection.get());
     }
+    updateActiveStateLocked();
 
     // we are setup, now enable the sensor.
     status_t err = sensor->activate(connection.get(), true);
@@ -609,6 +891,7 @@ status_t SensorService::cleanupWithoutDisableLocked(
             mActiveVirtualSensors.removeItem(handle);
             delete rec;
         }
+        updateActiveStateLocked();
         return NO_ERROR;
     }
     return BAD_VALUE;
@@ -635,7 +918,35 @@ status_t SensorService::setEventRate(const sp<SensorEventConnection>& connection
     if (ns < MINIMUM_EVENTS_PERIOD)
         ns = MINIMUM_EVENTS_PERIOD;
 
-    return sensor->setDelay(connection.get(), handle, ns);
+    status_t err = sensor->setDelay(connection.get(), handle, ns);
+    if (err == NO_ERROR && sensor->getSensor().getMinDelay() > 0) {
+        // the h/w runs at the fastest rate anyone asked for, the
+        // connection only lets its own rate through.
+        connection->setEventPeriod(handle, ns);
+    }
+    return err;
+}
+
+status_t SensorService::setMaxReportLatency(
+        const sp<SensorEventConnection>& connection, int handle, nsecs_t ns)
+{
+    if (mInitCheck != NO_ERROR)
+        return mInitCheck;
+
+    SensorInterface* sensor = mSensorMap.valueFor(handle);
+    if (!sensor)
+        return BAD_VALUE;
+
+    if (ns < 0)
+        return BAD_VALUE;
+
+    if (!connection->hasSensor(handle))
+        return BAD_VALUE;
+
+    // h/w that can't batch still reports each event, but the connection
+    // holds them back so its client is only woken up once per batch.
+    connection->setReportLatency(handle, ns);
+    return sensor->setMaxReportLatency(connection.get(), handle, ns);
 }
 
 // ---------------------------------------------------------------------------
@@ -670,7 +981,12 @@ bool SensorService::SensorRecord::removeConnection(
 
 SensorService::SensorEventConnection::SensorEventConnection(
         const sp<SensorService>& service, uid_t uid)
-    : mService(service), mChannel(new BitTube()), mUid(uid)
+    : mService(service),
+      // room for as many events as the client reads from the socket at once
+      mChannel(new BitTube(SensorEventQueue::MAX_RECEIVE_BUFFER_EVENT_COUNT *
+              sizeof(ASensorEvent))),
+      mUid(uid),
+      mPendingDeadline(0)
 {
 }
 
@@ -696,11 +1012,94 @@ bool SensorService::SensorEventConnection::addSensor(int32_t handle) {
 bool SensorService::SensorEventConnection::removeSensor(int32_t handle) {
     Mutex::Autolock _l(mConnectionLock);
     if (mSensorInfo.remove(handle) >= 0) {
+        mEventPeriod.removeItem(handle);
+        mNextEventTime.removeItem(handle);
+        if (mMaxReportLatency.removeItem(handle) >= 0) {
+            sendPendingEventsLocked();
+        }
         return true;
     }
     return false;
 }
 
+void SensorService::SensorEventConnection::setReportLatency(
+        int32_t handle, nsecs_t ns) {
+    Mutex::Autolock _l(mConnectionLock);
+    if (ns > 0) {
+        mMaxReportLatency.add(handle, ns);
+    } else if (mMaxReportLatency.removeItem(handle) >= 0) {
+        sendPendingEventsLocked();
+    }
+}
+
+void SensorService::SensorEventConnection::setEventPeriod(
+        int32_t handle, nsecs_t ns) {
+    Mutex::Autolock _l(mConnectionLock);
+    mEventPeriod.add(handle, ns);
+    mNextEventTime.removeItem(handle);
+}
+
+bool SensorService::SensorEventConnection::isEventDueLocked(
+        sensors_event_t const& event, nsecs_t period) {
+    // events are let through on a schedule rather than with a minimum
+    // interval, so that the average rate is right even when the h/w rate
+    // isn't a multiple of it. A quarter period of slack absorbs the jitter
+    // of h/w running at the same rate.
+    ssize_t index = mNextEventTime.indexOfKey(event.sensor);
+    if (index < 0) {
+        mNextEventTime.add(event.sensor, event.timestamp + period);
+        return true;
+    }
+    int64_t& due(mNextEventTime.editValueAt(index));
+    if (event.timestamp < due - period/4) {
+        return false;
+    }
+    due += period;
+    if (due <= event.timestamp) {
+        // we've fallen behind (e.g. the sensor was paused), start over
+        due = event.timestamp + period;
+    }
+    return true;
+}
+
+void SensorService::SensorEventConnection::holdEventLocked(
+        sensors_event_t const& event, nsecs_t latency) {
+    const nsecs_t deadline = event.timestamp + latency;
+    if (mPendingEvents.isEmpty() || deadline < mPendingDeadline) {
+        mPendingDeadline = deadline;
+    }
+    mPendingEvents.add(event);
+}
+
+void SensorService::SensorEventConnection::sendPendingEventsLocked() {
+    if (mPendingEvents.isEmpty())
+        return;
+    writeEvents(mDirectChannel, mPendingEvents.array(), mPendingEvents.size());
+    mPendingEvents.clear();
+}
+
+ssize_t SensorService::SensorEventConnection::writeEvents(
+        const sp<SensorDirectChannel>& direct,
+        sensors_event_t const* events, size_t count) {
+    // NOTE: ASensorEvent and sensors_event_t are the same type
+    ASensorEvent const* const buffer =
+            reinterpret_cast<ASensorEvent const*>(events);
+    if (direct != 0) {
+        if (direct->write(buffer, count)) {
+            const char wakeup = 1;
+            mChannel->write(&wakeup, sizeof(wakeup));
+        }
+        return count;
+    }
+    ssize_t size = SensorEventQueue::write(mChannel, buffer, count);
+    if (size == -EAGAIN || (size >= 0 && size_t(size) < count)) {
+        // whatever didn't fit is lost
+        const size_t sent = size < 0 ? 0 : size;
+        mService->recordDroppedEvents(events + sent, count - sent);
+    }
+    return size;
+}
+
 bool SensorService::SensorEventConnection::hasSensor(int32_t handle) const {
     Mutex::Autolock _l(mConnectionLock);
     return mSensorInfo.indexOf(handle) >= 0;
@@ -715,29 +1114,54 @@ status_t SensorService::SensorEventConnection::sendEvents(
         sensors_event_t const* buffer, size_t numEvents,
         sensors_event_t* scratch)
 {
-    // filter out events not for this connection
+    // drop the events that come faster than this connection asked for,
+    // and hold back those that can wait
     size_t count = 0;
+    sp<SensorDirectChannel> direct;
     if (scratch) {
         Mutex::Autolock _l(mConnectionLock);
+        direct = mDirectChannel;
+        nsecs_t latest = 0;
         size_t i=0;
         while (i<numEvents) {
             const int32_t curr = buffer[i].sensor;
-            if (mSensorInfo.indexOf(curr) >= 0) {
-                do {
-                    scratch[count++] = buffer[i++];
-                } while ((i<numEvents) && (buffer[i].sensor == curr));
-            } else {
-                i++;
-            }
+            const nsecs_t period = mEventPeriod.valueFor(curr);
+            const nsecs_t latency = mMaxReportLatency.valueFor(curr);
+            do {
+                sensors_event_t const& event(buffer[i++]);
+                if (event.timestamp > latest) {
+                    latest = event.timestamp;
+                }
+                if (period > 0 && !isEventDueLocked(event, period)) {
+                    continue;
+                }
+                if (latency > 0) {
+                    holdEventLocked(event, latency);
+                } else {
+                    scratch[count++] = event;
+                }
+            } while ((i<numEvents) && (buffer[i].sensor == curr));
+        }
+
+        // the held events go out when the client is woken up anyway,
+        // when the earliest deadline has passed, or when too many of them
+        // are waiting.
+        if (!mPendingEvents.isEmpty() && (count ||
+                latest >= mPendingDeadline ||
+                mPendingEvents.size() >= MAX_PENDING_EVENTS)) {
+            sendPendingEventsLocked();
+        }
+        if (count == 0) {
+            return NO_ERROR;
         }
     } else {
+        Mutex::Autolock _l(mConnectionLock);
+        direct = mDirectChannel;
         scratch = const_cast<sensors_event_t *>(buffer);
         count = numEvents;
     }
 
-    // NOTE: ASensorEvent and sensors_event_t are the same type
-    ssize_t size = SensorEventQueue::write(mChannel,
-            reinterpret_cast<ASensorEvent const*>(scratch), count);
+    ssize_t size = writeEvents(direct, scratch, count);
     if (size == -EAGAIN) {
         // the destination doesn't accept events anymore, it's probably
         // full. For now, we just drop the events on the floor.
@@ -771,6 +1195,24 @@ status_t SensorService::SensorEventConnection::setEventRate(
     return mService->setEventRate(this, handle, ns);
 }
 
+status_t SensorService::SensorEventConnection::setMaxReportLatency(
+        int handle, nsecs_t ns)
+{
+    return mService->setMaxReportLatency(this, handle, ns);
+}
+
+sp<SensorDirectChannel> SensorService::SensorEventConnection::createDirectChannel(
+        size_t capacity)
+{
+    sp<SensorDirectChannel> channel(new SensorDirectChannel(capacity));
+    if (channel->initCheck() != NO_ERROR) {
+        return NULL;
+    }
+    Mutex::Autolock _l(mConnectionLock);
+    mDirectChannel = channel;
+    return channel;
+}
+
 // ---------------------------------------------------------------------------
 }; // namespace android
 
@@ -27,13 +27,16 @@
 #include <utils/RefBase.h>
 
 #include <binder/BinderService.h>
+#include <binder/IMemory.h>
 
 #include <gui/Sensor.h>
 #include <gui/BitTube.h>
 #include <gui/ISensorServer.h>
 #include <gui/ISensorEventConnection.h>
+#include <gui/SensorDirectChannel.h>
 
 #include "SensorInterface.h"
+#include "SensorStats.h"
 
 // ---------------------------------------------------------------------------
 
@@ -45,6 +48,8 @@ struct sensors_module_t;
 namespace android {
 // ---------------------------------------------------------------------------
 
+class BatchQueue;
+
 class SensorService :
         public BinderService<SensorService>,
         public BnSensorServer,
@@ -54,6 +59,8 @@ class SensorService :
 
    static const nsecs_t MINIMUM_EVENTS_PERIOD =   1000000; // 1000 Hz
    static const char* WAKE_LOCK_NAME;
+   // how many polls each stage of the pipeline can get ahead of the next
+   static const size_t NUM_BATCHES = 32;
 
             SensorService();
     virtual ~SensorService();
@@ -66,6 +73,7 @@ class SensorService :
     // ISensorServer interface
     virtual Vector<Sensor> getSensorList();
     virtual sp<ISensorEventConnection> createSensorEventConnection();
+    virtual sp<IMemoryHeap> getSensorListMemory();
     virtual status_t dump(int fd, const Vector<String16>& args);
 
 
@@ -75,6 +83,17 @@ class SensorService :
         virtual sp<BitTube> getSensorChannel() const;
         virtual status_t enableDisable(int handle, bool enabled);
         virtual status_t setEventRate(int handle, nsecs_t ns);
+        virtual status_t setMaxReportLatency(int handle, nsecs_t ns);
+        virtual sp<SensorDirectChannel> createDirectChannel(size_t capacity);
+
+        // don't hold back more events than this, whatever the latency
+        static const size_t MAX_PENDING_EVENTS = 256;
+
+        bool isEventDueLocked(sensors_event_t const& event, nsecs_t period);
+        void holdEventLocked(sensors_event_t const& event, nsecs_t latency);
+        void sendPendingEventsLocked();
+        ssize_t writeEvents(const sp<SensorDirectChannel>& direct,
+                sensors_event_t const* events, size_t count);
 
         sp<SensorService> const mService;
         sp<BitTube> const mChannel;
@@ -84,15 +103,36 @@ class SensorService :
         // protected by SensorService::mLock
         SortedVector<int> mSensorInfo;
 
+        // protected by mConnectionLock
+        // the event period each sensor was asked for, and when the next
+        // event of each is due
+        DefaultKeyedVector<int32_t, nsecs_t> mEventPeriod;
+        KeyedVector<int32_t, int64_t> mNextEventTime;
+        // the events of sensors that have a max report latency are held
+        // here until the earliest of their deadlines, so that the client
+        // is woken up once per batch rather than once per event.
+        DefaultKeyedVector<int32_t, nsecs_t> mMaxReportLatency;
+        Vector<sensors_event_t> mPendingEvents;
+        nsecs_t mPendingDeadline;
+        // when set, events go through this ring and mChannel only carries
+        // wake-ups
+        sp<SensorDirectChannel> mDirectChannel;
+
     public:
         SensorEventConnection(const sp<SensorService>& service, uid_t uid);
 
+        // with a scratch buffer, the events must all be for sensors this
+        // connection has enabled. They're decimated to the rate it asked
+        // for, and those with a max report latency are held back. Without
+        // one, they're all sent right away.
         status_t sendEvents(sensors_event_t const* buffer, size_t count,
                 sensors_event_t* scratch = NULL);
         bool hasSensor(int32_t handle) const;
         bool hasAnySensor() const;
         bool addSensor(int32_t handle);
         bool removeSensor(int32_t handle);
+        void setEventPeriod(int32_t handle, nsecs_t ns);
+        void setReportLatency(int32_t handle, nsecs_t ns);
 
         uid_t getUid() const { return mUid; }
     };
@@ -104,10 +144,46 @@ class SensorService :
         bool addConnection(const sp<SensorEventConnection>& connection);
         bool removeConnection(const wp<SensorEventConnection>& connection);
         size_t getNumConnections() const { return mConnections.size(); }
+        const SortedVector< wp<SensorEventConnection> >& getConnections() const {
+            return mConnections;
+        }
+    };
+
+    // what the event loop needs to know about the active sensors and
+    // connections. A new one is made under mLock whenever they change, the
+    // loop only takes a reference to the current one.
+    class ActiveState : public LightRefBase<ActiveState> {
+    public:
+        Vector<SensorInterface*> virtualSensors;
+        Vector< wp<SensorEventConnection> > connections;
+        // the indices in connections of each active sensor's subscribers
+        KeyedVector<int, Vector<size_t> > subscribers;
+    };
+    sp<const ActiveState> getActiveState() const;
+    void updateActiveStateLocked();
+
+    void sendEventsToSubscribers(sensors_event_t const* buffer, size_t count,
+            sensors_event_t* scratch, nsecs_t polled);
+    void recordHalLatency(sensors_event_t const* events, size_t count,
+            nsecs_t polled);
+    void recordDroppedEvents(sensors_event_t const* events, size_t count);
+
+    // the events go from threadLoop(), which polls the h/w, through
+    // processLoop(), which runs the virtual sensors, to dispatchLoop(),
+    // which sends them to the clients, each on its own thread.
+    class LoopThread : public Thread {
+        SensorService* const mService;
+        bool (SensorService::*mLoop)();
+        virtual bool threadLoop() { return (mService->*mLoop)(); }
+    public:
+        LoopThread(SensorService* service, bool (SensorService::*loop)())
+            : Thread(false), mService(service), mLoop(loop) { }
     };
+    bool processLoop();
+    bool dispatchLoop();
+    void acquireWakeLock();
+    void releaseWakeLock();
 
-    SortedVector< wp<SensorEventConnection> > getActiveConnections() const;
-    DefaultKeyedVector<int, SensorInterface*> getActiveVirtualSensors() const;
 
     String8 getSensorName(int handle) const;
     int getSensorType(int handle) const;
@@ -126,7 +202,10 @@ class SensorService :
     Vector<Sensor> mSensorList;
     Vector<Sensor> mUserSensorListDebug;
     Vector<Sensor> mUserSensorList;
+    sp<IMemoryHeap> mUserSensorListMemory;
+    sp<IMemoryHeap> mUserSensorListDebugMemory;
     DefaultKeyedVector<int, SensorInterface*> mSensorMap;
+    DefaultKeyedVector<int, int> mUserSensorTypes;
     Vector<SensorInterface *> mVirtualSensorList;
     status_t mInitCheck;
 
@@ -135,10 +214,27 @@ class SensorService :
     DefaultKeyedVector<int, SensorRecord*> mActiveSensors;
     DefaultKeyedVector<int, SensorInterface*> mActiveVirtualSensors;
     SortedVector< wp<SensorEventConnection> > mActiveConnections;
+    sp<const ActiveState> mActiveState;
 
     // The size of this vector is constant, only the items are mutable
     KeyedVector<int32_t, sensors_event_t> mLastEventSeen;
 
+    // the pipeline, set up before the threads start
+    BatchQueue* mPolledEvents;
+    BatchQueue* mProcessedEvents;
+    sp<LoopThread> mProcessThread;
+    sp<LoopThread> mDispatchThread;
+
+    // the batches that took the wake lock and haven't been sent yet,
+    // protected by mWakeLockLock
+    Mutex mWakeLockLock;
+    size_t mWakeLockCount;
+
+    // per sensor latencies and drops, the set of sensors never changes,
+    // protected by mStatsLock
+    Mutex mStatsLock;
+    KeyedVector<int, SensorStats> mStats;
+
 public:
     static char const* getServiceName() { return "sensorservice"; }
 
@@ -146,6 +242,8 @@ public:
     status_t enable(const sp<SensorEventConnection>& connection, int handle);
     status_t disable(const sp<SensorEventConnection>& connection, int handle);
     status_t setEventRate(const sp<SensorEventConnection>& connection, int handle, nsecs_t ns);
+    status_t setMaxReportLatency(const sp<SensorEventConnection>& connection,
+            int handle, nsecs_t ns);
 };
 
 // ---------------------------------------------------------------------------
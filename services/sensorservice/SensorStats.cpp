@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "SensorStats.h"
+
+namespace android {
+// ---------------------------------------------------------------------------
+
+LatencyHistogram::LatencyHistogram()
+    : mCount(0), mSum(0), mMax(0)
+{
+    memset(mBuckets, 0, sizeof(mBuckets));
+}
+
+void LatencyHistogram::add(nsecs_t duration, uint32_t count)
+{
+    if (duration < 0) {
+        // the h/w clock can be a little ahead of ours
+        duration = 0;
+    }
+    uint32_t us = uint32_t(duration / 1000 < 0xFFFFFFFF ? duration / 1000 : 0xFFFFFFFF);
+    size_t bucket = us ? 32 - __builtin_clz(us) : 0;
+    if (bucket >= NUM_BUCKETS) {
+        bucket = NUM_BUCKETS - 1;
+    }
+    mBuckets[bucket] += count;
+    mCount += count;
+    mSum += duration * count;
+    if (duration > mMax) {
+        mMax = duration;
+    }
+}
+
+nsecs_t LatencyHistogram::percentile(uint32_t percent) const
+{
+    const uint64_t wanted = (mCount * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i=0 ; i<NUM_BUCKETS ; i++) {
+        seen += mBuckets[i];
+        if (seen >= wanted) {
+            return nsecs_t(1000) << i;
+        }
+    }
+    return mMax;
+}
+
+void LatencyHistogram::dump(const char* what,
+        String8& result, char* buffer, size_t SIZE) const
+{
+    if (mCount == 0) {
+        snprintf(buffer, SIZE, "    %-14s no events\n", what);
+        result.append(buffer);
+        return;
+    }
+    snprintf(buffer, SIZE,
+            "    %-14s avg=%7.2f ms, 50%%<%7.2f ms, 99%%<%7.2f ms, max=%7.2f ms\n",
+            what,
+            (mSum / mCount) / 1e6f,
+            percentile(50) / 1e6f,
+            percentile(99) / 1e6f,
+            mMax / 1e6f);
+    result.append(buffer);
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
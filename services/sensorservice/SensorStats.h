@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SENSOR_STATS_H
+#define ANDROID_SENSOR_STATS_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/String8.h>
+#include <utils/Timers.h>
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+/*
+ * Histogram of durations in power-of-two buckets of microseconds, the last
+ * one taking everything from about half a second.
+ */
+class LatencyHistogram {
+public:
+    enum { NUM_BUCKETS = 21 };
+
+    LatencyHistogram();
+    void add(nsecs_t duration, uint32_t count = 1);
+    uint64_t getCount() const { return mCount; }
+    // the upper bound of the bucket holding the given percentile
+    nsecs_t percentile(uint32_t percent) const;
+    void dump(const char* what, String8& result, char* buffer, size_t SIZE) const;
+
+private:
+    uint32_t mBuckets[NUM_BUCKETS];
+    uint64_t mCount;
+    nsecs_t mSum;
+    nsecs_t mMax;
+};
+
+/*
+ * Where the events of one sensor spend their time:
+ * - halToService: from the h/w time-stamp to SensorDevice::poll() returning
+ * - processing:   from there to the dispatch thread picking them up
+ * - delivery:     from there to being written to a client
+ * and how many events the clients' sockets had no room for.
+ */
+struct SensorStats {
+    SensorStats() : dropped(0) { }
+    LatencyHistogram halToService;
+    LatencyHistogram processing;
+    LatencyHistogram delivery;
+    uint64_t dropped;
+};
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+
+#endif // ANDROID_SENSOR_STATS_H
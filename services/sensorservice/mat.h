@@ -115,6 +115,17 @@ mat<TYPE, C, R> PURE doMul(
     return res;
 }
 
+// 3x3 float products are most of the work of the sensor fusion, these
+// overloads are picked over the loops above and spell them out, which
+// compilers don't do on their own when optimizing for size. They add in
+// the same order, so the results are the same.
+inline mat<float, 3, 3> PURE doMul(
+        const mat<float, 3, 3>& lhs,
+        const mat<float, 3, 3>& rhs);
+
+inline vec<float, 3> PURE doMul(
+        const mat<float, 3, 3>& lhs,
+        const vec<float, 3>& rhs);
 
 }; // namespace helpers
 
@@ -277,6 +288,40 @@ public:
     void operator << (const vec<TYPE, R>& rhs) { base::operator[](0) = rhs; }
 };
 
+// -----------------------------------------------------------------------
+
+namespace helpers {
+
+inline mat<float, 3, 3> PURE doMul(
+        const mat<float, 3, 3>& lhs,
+        const mat<float, 3, 3>& rhs)
+{
+    const vec<float, 3>& l0(lhs[0]);
+    const vec<float, 3>& l1(lhs[1]);
+    const vec<float, 3>& l2(lhs[2]);
+    mat<float, 3, 3> res;
+    for (size_t c=0 ; c<3 ; c++) {
+        const vec<float, 3>& r(rhs[c]);
+        res[c][0] = l0[0]*r[0] + l1[0]*r[1] + l2[0]*r[2];
+        res[c][1] = l0[1]*r[0] + l1[1]*r[1] + l2[1]*r[2];
+        res[c][2] = l0[2]*r[0] + l1[2]*r[1] + l2[2]*r[2];
+    }
+    return res;
+}
+
+inline vec<float, 3> PURE doMul(
+        const mat<float, 3, 3>& lhs,
+        const vec<float, 3>& rhs)
+{
+    vec<float, 3> res;
+    res[0] = lhs[0][0]*rhs[0] + lhs[1][0]*rhs[1] + lhs[2][0]*rhs[2];
+    res[1] = lhs[0][1]*rhs[0] + lhs[1][1]*rhs[1] + lhs[2][1]*rhs[2];
+    res[2] = lhs[0][2]*rhs[0] + lhs[1][2]*rhs[1] + lhs[2][2]*rhs[2];
+    return res;
+}
+
+}; // namespace helpers
+
 // -----------------------------------------------------------------------
 // matrix functions
 
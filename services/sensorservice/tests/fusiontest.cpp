@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../Fusion.h"
+
+using namespace android;
+
+// checks the fusion's specialized matrix code against the generic one
+
+static float randomFloat(float range) {
+    return range * (2.0f * rand() / RAND_MAX - 1.0f);
+}
+
+static mat33_t randomMatrix(float range) {
+    mat33_t m;
+    for (size_t c=0 ; c<3 ; c++)
+        for (size_t r=0 ; r<3 ; r++)
+            m[c][r] = randomFloat(range);
+    return m;
+}
+
+static mat33_t diagonal(float v) {
+    return mat33_t(v);
+}
+
+// the generic product, what mat.h did before it had specializations
+static mat33_t genericMul(const mat33_t& lhs, const mat33_t& rhs) {
+    mat33_t res;
+    for (size_t c=0 ; c<3 ; c++) {
+        for (size_t r=0 ; r<3 ; r++) {
+            float v(0);
+            for (size_t k=0 ; k<3 ; k++) {
+                v += lhs[k][r] * rhs[c][k];
+            }
+            res[c][r] = v;
+        }
+    }
+    return res;
+}
+
+static float maxError(const mat33_t& a, const mat33_t& b) {
+    float e = 0;
+    for (size_t c=0 ; c<3 ; c++) {
+        for (size_t r=0 ; r<3 ; r++) {
+            const float d = fabsf(a[c][r] - b[c][r]);
+            const float scale = fabsf(b[c][r]) > 1 ? fabsf(b[c][r]) : 1;
+            if (d / scale > e)
+                e = d / scale;
+        }
+    }
+    return e;
+}
+
+static bool testMul() {
+    for (int i=0 ; i<1000 ; i++) {
+        const mat33_t a(randomMatrix(10));
+        const mat33_t b(randomMatrix(10));
+        if (maxError(a*b, genericMul(a, b)) != 0) {
+            printf("mat33 * mat33 doesn't match the generic product\n");
+            return false;
+        }
+        const vec3_t v(a*b[0]);
+        const mat33_t u(genericMul(a, b));
+        if (v[0] != u[0][0] || v[1] != u[0][1] || v[2] != u[0][2]) {
+            printf("mat33 * vec3 doesn't match the generic product\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool testPropagateCovariance() {
+    float worst = 0;
+    for (int i=0 ; i<1000 ; i++) {
+        // P and GQGt like the fusion keeps them: symmetric, and GQGt
+        // made of diagonal blocks
+        const mat33_t M(randomMatrix(1));
+        const mat33_t N(randomMatrix(1));
+        mat<mat33_t, 2, 2> P;
+        P[0][0] = M*transpose(M);
+        P[1][1] = N*transpose(N);
+        P[1][0] = randomMatrix(0.1f);
+        P[0][1] = transpose(P[1][0]);
+
+        mat<mat33_t, 2, 2> GQGt;
+        const float q10 = randomFloat(1e-6f);
+        GQGt[0][0] = diagonal(fabsf(randomFloat(1e-5f)));
+        GQGt[1][0] = diagonal(-q10);
+        GQGt[0][1] = diagonal(-q10);
+        GQGt[1][1] = diagonal(fabsf(randomFloat(1e-6f)));
+
+        mat<mat33_t, 2, 2> Phi;
+        Phi[0][0] = diagonal(1) + randomMatrix(0.1f);
+        Phi[1][0] = randomMatrix(0.01f);
+        Phi[0][1] = 0;
+        Phi[1][1] = 1;
+
+        const mat<mat33_t, 2, 2> expected(Phi*P*transpose(Phi) + GQGt);
+        propagateCovariance(P, Phi, GQGt);
+
+        for (size_t c=0 ; c<2 ; c++) {
+            for (size_t r=0 ; r<2 ; r++) {
+                const float e = maxError(P[c][r], expected[c][r]);
+                if (e > worst)
+                    worst = e;
+            }
+        }
+    }
+    printf("propagateCovariance: max relative error %g\n", worst);
+    return worst < 1e-5f;
+}
+
+int main(int argc, char** argv)
+{
+    bool ok = testMul();
+    ok = testPropagateCovariance() && ok;
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures how long events take from their h/w time-stamp to the client's
+ * SensorEventQueue::read(), and the CPU time spent per event by this
+ * process and, given its pid, by the process hosting the sensor service.
+ *
+ * For reproducible runs, record a session with
+ *      setprop debug.sensors.record /data/sensors.log
+ * and play it back with
+ *      setprop debug.sensors.replay /data/sensors.log
+ *      setprop debug.sensors.replay_speed 4
+ * both taking effect when the sensor service restarts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <android/sensor.h>
+#include <gui/Sensor.h>
+#include <gui/SensorManager.h>
+#include <gui/SensorEventQueue.h>
+#include <utils/Looper.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+using namespace android;
+
+static nsecs_t processCpuTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return nsecs_t(ts.tv_sec)*1000000000 + ts.tv_nsec;
+}
+
+// utime+stime of another process, from /proc/<pid>/stat
+static nsecs_t otherCpuTime(pid_t pid)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE* f = fopen(path, "r");
+    if (!f)
+        return 0;
+    unsigned long utime = 0, stime = 0;
+    // skip pid, comm and the 11 fields that follow
+    fscanf(f, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+            &utime, &stime);
+    fclose(f);
+    return nsecs_t(utime + stime) * (1000000000 / sysconf(_SC_CLK_TCK));
+}
+
+static int compare(const void* lhs, const void* rhs)
+{
+    const nsecs_t l = *static_cast<const nsecs_t*>(lhs);
+    const nsecs_t r = *static_cast<const nsecs_t*>(rhs);
+    return l < r ? -1 : (l > r ? 1 : 0);
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-t type] [-r period-us] [-n events] [-p service-pid]\n",
+            name);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    int type = Sensor::TYPE_ACCELEROMETER;
+    nsecs_t period = ms2ns(5);
+    size_t wanted = 2000;
+    pid_t service = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "t:r:n:p:")) != -1) {
+        switch (opt) {
+            case 't': type = atoi(optarg); break;
+            case 'r': period = us2ns(atoi(optarg)); break;
+            case 'n': wanted = atoi(optarg); break;
+            case 'p': service = atoi(optarg); break;
+            default: usage(argv[0]);
+        }
+    }
+    if (wanted == 0)
+        usage(argv[0]);
+
+    SensorManager& mgr(SensorManager::getInstance());
+    Sensor const* sensor = mgr.getDefaultSensor(type);
+    if (sensor == NULL) {
+        fprintf(stderr, "no sensor of type %d\n", type);
+        return 1;
+    }
+    printf("%s, %lld us period, %u events\n",
+            sensor->getName().string(), period / 1000, wanted);
+
+    sp<SensorEventQueue> q = mgr.createEventQueue();
+    Vector<nsecs_t> latencies;
+    latencies.setCapacity(wanted);
+
+    q->enableSensor(sensor);
+    q->setEventRate(sensor, period);
+
+    sp<Looper> loop = new Looper(false);
+    loop->addFd(q->getFd(), 0, ALOOPER_EVENT_INPUT, NULL, NULL);
+
+    // skip the first events, the h/w may still be starting up
+    size_t skip = wanted / 10;
+    nsecs_t cpuStart = 0;
+    nsecs_t serviceStart = 0;
+    ASensorEvent buffer[16];
+    while (latencies.size() < wanted) {
+        if (loop->pollOnce(1000) == ALOOPER_POLL_TIMEOUT) {
+            fprintf(stderr, "no events for 1s, giving up\n");
+            return 1;
+        }
+        ssize_t n;
+        while ((n = q->read(buffer, 16)) > 0) {
+            const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+            for (ssize_t i=0 ; i<n ; i++) {
+                if (buffer[i].type != type)
+                    continue;
+                if (skip) {
+                    if (--skip == 0) {
+                        cpuStart = processCpuTime();
+                        serviceStart = service ? otherCpuTime(service) : 0;
+                    }
+                    continue;
+                }
+                if (latencies.size() < wanted)
+                    latencies.add(now - buffer[i].timestamp);
+            }
+        }
+    }
+    const nsecs_t cpu = processCpuTime() - cpuStart;
+    const nsecs_t serviceCpu = service ? otherCpuTime(service) - serviceStart : 0;
+
+    q->disableSensor(sensor);
+
+    Vector<nsecs_t> sorted(latencies);
+    qsort(sorted.editArray(), sorted.size(), sizeof(nsecs_t), compare);
+    nsecs_t sum = 0;
+    for (size_t i=0 ; i<sorted.size() ; i++)
+        sum += sorted[i];
+
+    const size_t count = sorted.size();
+    printf("latency (us): min %lld, avg %lld, 50%% %lld, 99%% %lld, max %lld\n",
+            sorted[0] / 1000,
+            sum / count / 1000,
+            sorted[count / 2] / 1000,
+            sorted[(count * 99) / 100] / 1000,
+            sorted[count - 1] / 1000);
+    printf("client cpu: %lld ns/event\n", cpu / count);
+    if (service) {
+        printf("service cpu: %lld ns/event (whole process, includes other work)\n",
+                serviceCpu / count);
+    }
+    return 0;
+}
@@ -3,7 +3,10 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES:= \
     Client.cpp \
+    CompositionCache.cpp \
+    CpuCompositor.cpp \
     DisplayDevice.cpp \
+    DispSync.cpp \
     EventThread.cpp \
     FrameTracker.cpp \
     GLExtensions.cpp \
@@ -14,6 +17,8 @@ LOCAL_SRC_FILES:= \
     SurfaceFlingerConsumer.cpp \
     SurfaceTextureLayer.cpp \
     Transform.cpp \
+    TransactionQueue.cpp \
+    WorkerPool.cpp \
     DisplayHardware/FramebufferSurface.cpp \
     DisplayHardware/HWComposer.cpp \
     DisplayHardware/PowerHAL.cpp \
@@ -48,6 +53,20 @@ ifneq ($(NUM_FRAMEBUFFER_SURFACE_BUFFERS),)
   LOCAL_CFLAGS += -DNUM_FRAMEBUFFER_SURFACE_BUFFERS=$(NUM_FRAMEBUFFER_SURFACE_BUFFERS)
 endif
 
+# offsets of the app and SurfaceFlinger vsync events from the h/w vsync
+ifneq ($(VSYNC_EVENT_PHASE_OFFSET_NS),)
+  LOCAL_CFLAGS += -DVSYNC_EVENT_PHASE_OFFSET_NS=$(VSYNC_EVENT_PHASE_OFFSET_NS)
+endif
+
+ifneq ($(SF_VSYNC_EVENT_PHASE_OFFSET_NS),)
+  LOCAL_CFLAGS += -DSF_VSYNC_EVENT_PHASE_OFFSET_NS=$(SF_VSYNC_EVENT_PHASE_OFFSET_NS)
+endif
+
+# delay between the h/w vsync and the present fences signaling
+ifneq ($(PRESENT_TIME_OFFSET_FROM_VSYNC_NS),)
+  LOCAL_CFLAGS += -DPRESENT_TIME_OFFSET_FROM_VSYNC_NS=$(PRESENT_TIME_OFFSET_FROM_VSYNC_NS)
+endif
+
 # HWComposer.cpp contains 2 pretty bad aliasing violations
 LOCAL_CFLAGS += -Wno-error=strict-aliasing
 
@@ -64,6 +83,9 @@ LOCAL_SHARED_LIBRARIES := \
 	libui \
 	libgui
 
+LOCAL_STATIC_LIBRARIES := \
+	libcpustats
+
 ifeq ($(TARGET_USES_QCOM_BSP), true)
 ifneq ($(TARGET_QCOM_DISPLAY_VARIANT),)
     LOCAL_C_INCLUDES += hardware/qcom/display-$(TARGET_QCOM_DISPLAY_VARIANT)/libgralloc
@@ -154,5 +154,58 @@ status_t Client::destroySurface(const sp<IBinder>& handle) {
     return mFlinger->onLayerRemoved(this, handle);
 }
 
+status_t Client::createSurfaces(const Vector<SurfaceSpec>& specs,
+        Vector<CreatedSurface>* surfaces)
+{
+    /*
+     * The layers still need the GL context, but the whole batch is
+     * created in a single trip to the main thread.
+     */
+
+    class MessageCreateLayers : public MessageBase {
+        SurfaceFlinger* flinger;
+        Client* client;
+        const Vector<SurfaceSpec>& specs;
+        Vector<CreatedSurface>* surfaces;
+    public:
+        MessageCreateLayers(SurfaceFlinger* flinger, Client* client,
+                const Vector<SurfaceSpec>& specs,
+                Vector<CreatedSurface>* surfaces)
+            : flinger(flinger), client(client),
+              specs(specs), surfaces(surfaces) {
+        }
+        virtual bool handler() {
+            for (size_t i=0 ; i<specs.size() ; i++) {
+                const SurfaceSpec& spec(specs[i]);
+                CreatedSurface& s(surfaces->editItemAt(i));
+                s.result = flinger->createLayer(spec.name, client,
+                        spec.w, spec.h, spec.format, spec.flags,
+                        &s.handle, &s.gbp);
+            }
+            return true;
+        }
+    };
+
+    surfaces->clear();
+    surfaces->insertAt(0, specs.size());
+    if (specs.isEmpty()) {
+        return NO_ERROR;
+    }
+    sp<MessageBase> msg = new MessageCreateLayers(mFlinger.get(),
+            this, specs, surfaces);
+    return mFlinger->postMessageSync(msg);
+}
+
+status_t Client::destroySurfaces(const Vector< sp<IBinder> >& handles) {
+    status_t err = NO_ERROR;
+    for (size_t i=0 ; i<handles.size() ; i++) {
+        status_t result = mFlinger->onLayerRemoved(this, handles[i]);
+        if (err == NO_ERROR) {
+            err = result;
+        }
+    }
+    return err;
+}
+
 // ---------------------------------------------------------------------------
 }; // namespace android
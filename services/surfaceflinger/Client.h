@@ -60,6 +60,11 @@ private:
 
     virtual status_t destroySurface(const sp<IBinder>& handle);
 
+    virtual status_t createSurfaces(const Vector<SurfaceSpec>& specs,
+            Vector<CreatedSurface>* surfaces);
+
+    virtual status_t destroySurfaces(const Vector< sp<IBinder> >& handles);
+
     virtual status_t onTransact(
         uint32_t code, const Parcel& data, Parcel* reply, uint32_t flags);
 
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include <GLES/gl.h>
+#include <GLES/glext.h>
+
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+#include "CompositionCache.h"
+#include "Layer.h"
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+CompositionCache::Key::Key()
+    : sequence(0), bufferGeneration(0) {
+}
+
+bool CompositionCache::Key::operator == (const Key& rhs) const {
+    if (layer != rhs.layer ||
+            sequence != rhs.sequence ||
+            bufferGeneration != rhs.bufferGeneration) {
+        return false;
+    }
+    // regions are usually shared when they didn't change
+    if (visibleRegion.isTriviallyEqual(rhs.visibleRegion)) {
+        return true;
+    }
+    return (visibleRegion ^ rhs.visibleRegion).isEmpty();
+}
+
+// ---------------------------------------------------------------------------
+
+CompositionCache::CompositionCache()
+    : mTexture(0), mFramebuffer(0), mWidth(0), mHeight(0),
+      mCachedCount(0), mCandidateCount(0),
+      mHits(0), mMisses(0), mCaptures(0) {
+}
+
+CompositionCache::~CompositionCache() {
+    releaseGLObjects();
+}
+
+void CompositionCache::releaseGLObjects() {
+    if (mFramebuffer) {
+        glDeleteFramebuffersOES(1, &mFramebuffer);
+        mFramebuffer = 0;
+    }
+    if (mTexture) {
+        glDeleteTextures(1, &mTexture);
+        mTexture = 0;
+    }
+    mWidth = mHeight = 0;
+    mCachedCount = 0;
+}
+
+void CompositionCache::invalidate() {
+    mCachedCount = 0;
+    mCandidateCount = 0;
+    mLastKeys.clear();
+}
+
+size_t CompositionCache::update(const Vector<Key>& keys) {
+    const size_t count = keys.size();
+
+    // how many layers, from the bottom, didn't change since last frame
+    size_t stable = 0;
+    while (stable < count && stable < mLastKeys.size() &&
+            keys[stable] == mLastKeys[stable]) {
+        stable++;
+    }
+    mLastKeys = keys;
+
+    // the cached image is valid as long as the layers it was made of are
+    // still the bottom-most ones and haven't changed
+    if (mCachedCount && stable >= mCachedCount) {
+        mHits++;
+        mCandidateCount = 0;
+        return mCachedCount;
+    }
+
+    mMisses++;
+    mCachedCount = 0;
+    // caching a single layer would only add a blit
+    mCandidateCount = (stable >= 2) ? stable : 0;
+    return 0;
+}
+
+bool CompositionCache::beginCapture(uint32_t width, uint32_t height) {
+    ATRACE_CALL();
+    if (mTexture == 0 || width != mWidth || height != mHeight) {
+        releaseGLObjects();
+
+        glGenTextures(1, &mTexture);
+        glBindTexture(GL_TEXTURE_2D, mTexture);
+        glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+                GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+        glGenFramebuffersOES(1, &mFramebuffer);
+        glBindFramebufferOES(GL_FRAMEBUFFER_OES, mFramebuffer);
+        glFramebufferTexture2DOES(GL_FRAMEBUFFER_OES,
+                GL_COLOR_ATTACHMENT0_OES, GL_TEXTURE_2D, mTexture, 0);
+        GLenum status = glCheckFramebufferStatusOES(GL_FRAMEBUFFER_OES);
+        if (status != GL_FRAMEBUFFER_COMPLETE_OES) {
+            ALOGE("composition cache: incomplete framebuffer (0x%04x)", status);
+            glBindFramebufferOES(GL_FRAMEBUFFER_OES, 0);
+            releaseGLObjects();
+            return false;
+        }
+        mWidth = width;
+        mHeight = height;
+    } else {
+        glBindFramebufferOES(GL_FRAMEBUFFER_OES, mFramebuffer);
+    }
+
+    // the cached image must be complete, regardless of the scissor
+    const GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+    glDisable(GL_SCISSOR_TEST);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (scissor) {
+        glEnable(GL_SCISSOR_TEST);
+    }
+    return true;
+}
+
+void CompositionCache::endCapture(size_t count) {
+    glBindFramebufferOES(GL_FRAMEBUFFER_OES, 0);
+    mCachedCount = count;
+    mCandidateCount = 0;
+    mCaptures++;
+}
+
+void CompositionCache::draw(const Region& clip, uint32_t width,
+        uint32_t height) const {
+    ATRACE_CALL();
+    if (!mTexture || !mWidth || !mHeight) {
+        return;
+    }
+
+    glDisable(GL_BLEND);
+    glDisable(GL_DITHER);
+    glDisable(GL_TEXTURE_EXTERNAL_OES);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, mTexture);
+    glTexEnvx(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glMatrixMode(GL_TEXTURE);
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glColor4f(1, 1, 1, 1);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    // the texture may be smaller than the display when it's rendered scaled
+    const GLfloat w = GLfloat(width);
+    const GLfloat h = GLfloat(height);
+    Region::const_iterator it = clip.begin();
+    Region::const_iterator const end = clip.end();
+    while (it != end) {
+        const Rect& r = *it++;
+        // the cache is in GL orientation, like the framebuffer
+        const GLfloat b = GLfloat(height - r.bottom);
+        const GLfloat t = GLfloat(height - r.top);
+        GLfloat vertices[][2] = {
+                { (GLfloat) r.left,  t },
+                { (GLfloat) r.left,  b },
+                { (GLfloat) r.right, b },
+                { (GLfloat) r.right, t }
+        };
+        GLfloat texCoords[][2] = {
+                { r.left  / w, t / h },
+                { r.left  / w, b / h },
+                { r.right / w, b / h },
+                { r.right / w, t / h }
+        };
+        glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
+        glVertexPointer(2, GL_FLOAT, 0, vertices);
+        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    }
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+}
+
+void CompositionCache::dump(String8& result, char* buffer, size_t SIZE) const {
+    snprintf(buffer, SIZE,
+            "   composition cache: %u layers (%ux%u), "
+            "hits=%u, misses=%u, captures=%u\n",
+            uint32_t(mCachedCount), mWidth, mHeight, mHits, mMisses, mCaptures);
+    result.append(buffer);
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
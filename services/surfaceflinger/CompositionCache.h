@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SURFACE_FLINGER_COMPOSITION_CACHE_H
+#define ANDROID_SURFACE_FLINGER_COMPOSITION_CACHE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <GLES/gl.h>
+
+#include <ui/Region.h>
+
+#include <utils/RefBase.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+class Layer;
+
+/*
+ * CompositionCache keeps the GLES composition of the bottom-most run of
+ * unchanged framebuffer layers of a display in an offscreen texture, so
+ * that it can be blitted instead of redrawing each of these layers.
+ *
+ * SurfaceFlinger describes the cacheable layers of each frame with a list
+ * of Keys; a layer is considered unchanged when its Key is identical to the
+ * one of the previous frame. All methods must be called with the
+ * SurfaceFlinger GL context current.
+ */
+class CompositionCache {
+public:
+    struct Key {
+        Key();
+        bool operator == (const Key& rhs) const;
+        bool operator != (const Key& rhs) const { return !operator == (rhs); }
+
+        wp<Layer> layer;
+        // Layer::State::sequence, changes with the transform, alpha, etc...
+        int32_t sequence;
+        // changes each time a new buffer is latched
+        uint32_t bufferGeneration;
+        // in layer-stack space
+        Region visibleRegion;
+    };
+
+    CompositionCache();
+    ~CompositionCache();
+
+    // drop the cached image, e.g. when the display's projection changes
+    void invalidate();
+
+    // Record this frame's cacheable layers, bottom-most first. Returns how
+    // many of them are covered by the cached image, or 0 on a miss.
+    size_t update(const Vector<Key>& keys);
+
+    // Number of bottom-most layers that didn't change since the previous
+    // frame and that are worth caching after a miss.
+    size_t getCandidateCount() const { return mCandidateCount; }
+
+    // Redirect rendering to the cache texture, of the size of the current
+    // viewport. On success, the caller draws the first 'count' layers then
+    // calls endCapture().
+    bool beginCapture(uint32_t width, uint32_t height);
+    void endCapture(size_t count);
+
+    // draw the cached image in the current framebuffer, clipped to 'clip',
+    // in the coordinates of a width x height display
+    void draw(const Region& clip, uint32_t width, uint32_t height) const;
+
+    void dump(String8& result, char* buffer, size_t SIZE) const;
+
+private:
+    void releaseGLObjects();
+
+    GLuint mTexture;
+    GLuint mFramebuffer;
+    uint32_t mWidth;
+    uint32_t mHeight;
+
+    // keys of the previous frame
+    Vector<Key> mLastKeys;
+    // number of layers currently in the cached image, 0 if invalid
+    size_t mCachedCount;
+    size_t mCandidateCount;
+
+    // statistics
+    uint32_t mHits;
+    uint32_t mMisses;
+    uint32_t mCaptures;
+};
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
+
+#endif // ANDROID_SURFACE_FLINGER_COMPOSITION_CACHE_H
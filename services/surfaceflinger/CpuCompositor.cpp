@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Trace.h>
+
+#include <hardware/hardware.h>
+
+#include <ui/PixelConverter.h>
+
+#include "CpuCompositor.h"
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+// a*b/255, rounded
+static inline uint32_t mul255(uint32_t a, uint32_t b) {
+    const uint32_t v = a*b + 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+// returns the index of the first sample >= value
+static size_t lowerBound(const Vector<uint32_t>& samples, int32_t value) {
+    const size_t count = samples.size();
+    if (value <= 0) {
+        return 0;
+    }
+    size_t i = 0;
+    while (i < count && samples[i] < uint32_t(value)) {
+        i++;
+    }
+    return i;
+}
+
+static void computeSamples(Vector<uint32_t>& samples,
+        uint32_t count, uint32_t displaySize) {
+    samples.setCapacity(count);
+    for (uint32_t i=0 ; i<count ; i++) {
+        // center of the image pixel in display space
+        samples.add(uint32_t((uint64_t(i)*2 + 1) * displaySize / (uint64_t(count)*2)));
+    }
+}
+
+CpuCompositor::CpuCompositor(void* dst, uint32_t stride,
+        uint32_t width, uint32_t height,
+        uint32_t displayWidth, uint32_t displayHeight)
+    : mDst(reinterpret_cast<uint32_t*>(dst)), mStride(stride),
+      mWidth(width), mHeight(height)
+{
+    computeSamples(mColumns, width, displayWidth);
+    computeSamples(mRows, height, displayHeight);
+}
+
+bool CpuCompositor::isFormatSupported(int format) {
+    switch (format) {
+        case HAL_PIXEL_FORMAT_RGBA_8888:
+        case HAL_PIXEL_FORMAT_RGBX_8888:
+        case HAL_PIXEL_FORMAT_BGRA_8888:
+        case HAL_PIXEL_FORMAT_RGB_565:
+            return true;
+    }
+    return false;
+}
+
+void CpuCompositor::clear() {
+    // RGBA_8888 is R,G,B,A in memory
+    const uint32_t black = 0xFF000000;
+    for (uint32_t y=0 ; y<mHeight ; y++) {
+        uint32_t* row = mDst + y*mStride;
+        for (uint32_t x=0 ; x<mWidth ; x++) {
+            row[x] = black;
+        }
+    }
+}
+
+void CpuCompositor::compose(const void* src, uint32_t srcStride, int srcFormat,
+        const Rect& crop, const Rect& frame,
+        uint8_t alpha, bool premultiplied, bool blend)
+{
+    ATRACE_CALL();
+
+    const size_t x0 = lowerBound(mColumns, frame.left);
+    const size_t x1 = lowerBound(mColumns, frame.right);
+    const size_t y0 = lowerBound(mRows, frame.top);
+    const size_t y1 = lowerBound(mRows, frame.bottom);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    // the source rows are brought to RGBA_8888 first
+    const PixelConverter converter(srcFormat, PIXEL_FORMAT_RGBA_8888);
+    if (converter.initCheck() != NO_ERROR) {
+        return;
+    }
+    const size_t bpp = (srcFormat == HAL_PIXEL_FORMAT_RGB_565) ? 2 : 4;
+    // when the image isn't scaled horizontally, the samples of a row are
+    // contiguous and can be converted in place
+    const size_t count = x1 - x0;
+    const bool contiguous = (mColumns[x1-1] - mColumns[x0] == count-1);
+    // when the plane alpha is not opaque, GL always blends
+    const bool replace = !blend && alpha == 0xFF;
+
+    Vector<uint32_t> samples;
+    Vector<uint32_t> line;
+    if (!contiguous) {
+        samples.insertAt(0, 0, count);
+    }
+    if (!replace) {
+        line.insertAt(0, 0, count);
+    }
+
+    const uint8_t* const bits = reinterpret_cast<const uint8_t*>(src);
+    for (size_t y=y0 ; y<y1 ; y++) {
+        const uint8_t* const srow = bits + bpp *
+                ((crop.top + int32_t(mRows[y]) - frame.top) * srcStride +
+                 (crop.left - frame.left));
+        uint32_t* const drow = mDst + y*mStride;
+        uint32_t* const rgba = replace ? drow + x0 : line.editArray();
+
+        if (contiguous) {
+            converter.convertRow(rgba, srow + bpp * mColumns[x0], count);
+        } else {
+            // gather the samples, still in the source format
+            if (bpp == 4) {
+                const uint32_t* const s = reinterpret_cast<const uint32_t*>(srow);
+                uint32_t* const g = samples.editArray();
+                for (size_t i=0 ; i<count ; i++) {
+                    g[i] = s[mColumns[x0 + i]];
+                }
+            } else {
+                const uint16_t* const s = reinterpret_cast<const uint16_t*>(srow);
+                uint16_t* const g = reinterpret_cast<uint16_t*>(samples.editArray());
+                for (size_t i=0 ; i<count ; i++) {
+                    g[i] = s[mColumns[x0 + i]];
+                }
+            }
+            converter.convertRow(rgba, samples.array(), count);
+        }
+        if (replace) {
+            continue;
+        }
+
+        for (size_t x=x0 ; x<x1 ; x++) {
+            const uint32_t s = rgba[x - x0];
+            uint32_t r =  s        & 0xFF;
+            uint32_t g = (s >>  8) & 0xFF;
+            uint32_t b = (s >> 16) & 0xFF;
+            uint32_t a =  s >> 24;
+
+            // the texture is modulated by the plane alpha, then
+            // blended with (ONE or SRC_ALPHA, ONE_MINUS_SRC_ALPHA)
+            if (alpha != 0xFF) {
+                if (premultiplied) {
+                    r = mul255(r, alpha);
+                    g = mul255(g, alpha);
+                    b = mul255(b, alpha);
+                }
+                a = mul255(a, alpha);
+            }
+            const uint32_t f = premultiplied ? 0xFF : a;
+            const uint32_t inv = 0xFF - a;
+            const uint32_t d = drow[x];
+            r = mul255(r, f) + mul255( d        & 0xFF, inv);
+            g = mul255(g, f) + mul255((d >>  8) & 0xFF, inv);
+            b = mul255(b, f) + mul255((d >> 16) & 0xFF, inv);
+            a = mul255(a, f) + mul255( d >> 24        , inv);
+            if (r > 0xFF) r = 0xFF;
+            if (g > 0xFF) g = 0xFF;
+            if (b > 0xFF) b = 0xFF;
+            if (a > 0xFF) a = 0xFF;
+            drow[x] = r | (g << 8) | (b << 16) | (a << 24);
+        }
+    }
+}
+
+void CpuCompositor::dim(const Rect& frame, uint8_t alpha)
+{
+    const size_t x0 = lowerBound(mColumns, frame.left);
+    const size_t x1 = lowerBound(mColumns, frame.right);
+    const size_t y0 = lowerBound(mRows, frame.top);
+    const size_t y1 = lowerBound(mRows, frame.bottom);
+    const uint32_t inv = 0xFF - alpha;
+    for (size_t y=y0 ; y<y1 ; y++) {
+        uint32_t* const drow = mDst + y*mStride;
+        for (size_t x=x0 ; x<x1 ; x++) {
+            // (0,0,0,alpha) blended with (ONE, ONE_MINUS_SRC_ALPHA)
+            const uint32_t d = drow[x];
+            const uint32_t r = mul255( d        & 0xFF, inv);
+            const uint32_t g = mul255((d >>  8) & 0xFF, inv);
+            const uint32_t b = mul255((d >> 16) & 0xFF, inv);
+            const uint32_t a = alpha + mul255(d >> 24, inv);
+            drow[x] = r | (g << 8) | (b << 16) | (a << 24);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SF_CPU_COMPOSITOR_H
+#define ANDROID_SF_CPU_COMPOSITOR_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <ui/Rect.h>
+#include <utils/Vector.h>
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+/*
+ * CpuCompositor blends layer buffers into an RGBA_8888 image of a display
+ * with the CPU only, following the same blending equations as the GL
+ * composition in Layer::drawWithOpenGL().
+ *
+ * The image can be smaller than the display, in which case every pixel
+ * of the image is point-sampled from the display pixel under its center
+ * while composing, so nothing is ever composed at full resolution.
+ */
+class CpuCompositor {
+public:
+    // dst is width x height pixels with a stride in pixels, and covers a
+    // display of displayWidth x displayHeight
+    CpuCompositor(void* dst, uint32_t stride,
+            uint32_t width, uint32_t height,
+            uint32_t displayWidth, uint32_t displayHeight);
+
+    // only these are handled by compose()
+    static bool isFormatSupported(int format);
+
+    // fills the image with opaque black, like the GL path does first
+    void clear();
+
+    // blends the crop of src over the display rectangle frame, the crop
+    // and the frame must have the same size.
+    // alpha is the plane alpha of the layer, premultiplied tells how the
+    // content of src is to be interpreted and blend is false for opaque
+    // layers, for which the source simply replaces the destination.
+    void compose(const void* src, uint32_t srcStride, int srcFormat,
+            const Rect& crop, const Rect& frame,
+            uint8_t alpha, bool premultiplied, bool blend);
+
+    // blends black with the given alpha over the display rectangle frame,
+    // like LayerDim does with GL
+    void dim(const Rect& frame, uint8_t alpha);
+
+private:
+    uint32_t* const mDst;
+    const uint32_t mStride;
+    const uint32_t mWidth;
+    const uint32_t mHeight;
+    // display coordinate sampled by each column / row of the image
+    Vector<uint32_t> mColumns;
+    Vector<uint32_t> mRows;
+};
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
+
+#endif /* ANDROID_SF_CPU_COMPOSITOR_H */
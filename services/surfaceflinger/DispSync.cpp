@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+// This is needed for stdint.h to define INT64_MAX in C++
+#define __STDC_LIMIT_MACROS
+
+#include <math.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+#include <utils/String8.h>
+#include <utils/Thread.h>
+#include <utils/Trace.h>
+#include <utils/Vector.h>
+
+#include "DispSync.h"
+
+// Time between the display's vsync and the moment its present fences
+// signal, it is subtracted from the present times before they are
+// compared to the model.
+#ifndef PRESENT_TIME_OFFSET_FROM_VSYNC_NS
+#define PRESENT_TIME_OFFSET_FROM_VSYNC_NS 0
+#endif
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+// the model is considered locked below this error (400us rms)
+static const nsecs_t kErrorThreshold = 400000LL * 400000LL;
+
+class DispSyncThread : public Thread {
+public:
+    DispSyncThread()
+        : mStop(false), mPeriod(0), mPhase(0) {
+    }
+
+    void updateModel(nsecs_t period, nsecs_t phase) {
+        Mutex::Autolock lock(mMutex);
+        mPeriod = period;
+        mPhase = phase;
+        mCond.signal();
+    }
+
+    void stop() {
+        Mutex::Autolock lock(mMutex);
+        mStop = true;
+        mCond.signal();
+    }
+
+    status_t addEventListener(nsecs_t phase, const sp<DispSync::Callback>& callback) {
+        Mutex::Autolock lock(mMutex);
+        for (size_t i=0 ; i<mEventListeners.size() ; i++) {
+            if (mEventListeners[i].mCallback == callback) {
+                return BAD_VALUE;
+            }
+        }
+
+        EventListener listener;
+        listener.mPhase = phase;
+        listener.mCallback = callback;
+        // don't fire for a vsync that already went by
+        listener.mLastEventTime = systemTime(SYSTEM_TIME_MONOTONIC);
+        mEventListeners.push(listener);
+        mCond.signal();
+        return NO_ERROR;
+    }
+
+    status_t removeEventListener(const sp<DispSync::Callback>& callback) {
+        Mutex::Autolock lock(mMutex);
+        for (size_t i=0 ; i<mEventListeners.size() ; i++) {
+            if (mEventListeners[i].mCallback == callback) {
+                mEventListeners.removeAt(i);
+                mCond.signal();
+                return NO_ERROR;
+            }
+        }
+        return BAD_VALUE;
+    }
+
+    size_t getEventListenerCount() const {
+        Mutex::Autolock lock(mMutex);
+        return mEventListeners.size();
+    }
+
+private:
+    struct EventListener {
+        nsecs_t mPhase;
+        nsecs_t mLastEventTime;
+        sp<DispSync::Callback> mCallback;
+    };
+
+    struct CallbackInvocation {
+        sp<DispSync::Callback> mCallback;
+        nsecs_t mEventTime;
+    };
+
+    virtual bool threadLoop() {
+        Vector<CallbackInvocation> callbackInvocations;
+        {
+            Mutex::Autolock lock(mMutex);
+            if (mStop) {
+                return false;
+            }
+
+            if (mPeriod == 0 || mEventListeners.isEmpty()) {
+                // nothing to do until we have a model and someone to tell
+                mCond.wait(mMutex);
+                return true;
+            }
+
+            nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+            const nsecs_t targetTime = computeNextEventTimeLocked(now);
+            if (now < targetTime) {
+                // the model or the listeners may change while we sleep,
+                // in which case we start over
+                if (mCond.waitRelative(mMutex, targetTime - now) != TIMED_OUT) {
+                    return true;
+                }
+                now = systemTime(SYSTEM_TIME_MONOTONIC);
+            }
+
+            gatherCallbackInvocationsLocked(now, &callbackInvocations);
+        }
+
+        // call the listeners without holding our lock, they're likely
+        // to come back into DispSync
+        for (size_t i=0 ; i<callbackInvocations.size() ; i++) {
+            callbackInvocations[i].mCallback->onDispSyncEvent(
+                    callbackInvocations[i].mEventTime);
+        }
+        return true;
+    }
+
+    nsecs_t computeNextEventTimeLocked(nsecs_t now) const {
+        nsecs_t nextEventTime = INT64_MAX;
+        for (size_t i=0 ; i<mEventListeners.size() ; i++) {
+            nsecs_t t = computeListenerNextEventTimeLocked(mEventListeners[i], now);
+            if (t < nextEventTime) {
+                nextEventTime = t;
+            }
+        }
+        return nextEventTime;
+    }
+
+    void gatherCallbackInvocationsLocked(nsecs_t now,
+            Vector<CallbackInvocation>* outInvocations) {
+        // look one period back so that an event whose time has just
+        // passed is still reported
+        const nsecs_t ref = now - mPeriod;
+        for (size_t i=0 ; i<mEventListeners.size() ; i++) {
+            EventListener& listener(mEventListeners.editItemAt(i));
+            nsecs_t t = computeListenerNextEventTimeLocked(listener, ref);
+            if (t <= now) {
+                CallbackInvocation ci;
+                ci.mCallback = listener.mCallback;
+                ci.mEventTime = t;
+                outInvocations->push(ci);
+                listener.mLastEventTime = t;
+            }
+        }
+    }
+
+    nsecs_t computeListenerNextEventTimeLocked(const EventListener& listener,
+            nsecs_t ref) const {
+        if (ref < listener.mLastEventTime) {
+            ref = listener.mLastEventTime;
+        }
+        const nsecs_t phase = mPhase + listener.mPhase;
+        nsecs_t t = (((ref - phase) / mPeriod) + 1) * mPeriod + phase;
+
+        // when the model moves, the next event can land too close to the
+        // last one; skip it rather than firing twice in the same period
+        if (t - listener.mLastEventTime < mPeriod / 2) {
+            t += mPeriod;
+        }
+        return t;
+    }
+
+    mutable Mutex mMutex;
+    Condition mCond;
+
+    bool mStop;
+    nsecs_t mPeriod;
+    nsecs_t mPhase;
+    Vector<EventListener> mEventListeners;
+};
+
+// ---------------------------------------------------------------------------
+
+DispSync::DispSync()
+    : mThread(new DispSyncThread()) {
+    mThread->run("DispSync", PRIORITY_URGENT_DISPLAY + PRIORITY_MORE_FAVORABLE);
+    reset();
+}
+
+DispSync::~DispSync() {
+    mThread->stop();
+    mThread->requestExitAndWait();
+}
+
+void DispSync::reset() {
+    Mutex::Autolock lock(mMutex);
+    mPeriod = 0;
+    mPhase = 0;
+    mError = 0;
+    mFirstResyncSample = 0;
+    mNumResyncSamples = 0;
+    mTotalResyncSamples = 0;
+    mResyncCount = 0;
+    mModelLocked = false;
+    for (size_t i=0 ; i<NUM_PRESENT_SAMPLES ; i++) {
+        mPresentFences[i].clear();
+        mPresentTimes[i] = 0;
+    }
+    mPresentSampleOffset = 0;
+    mThread->updateModel(mPeriod, mPhase);
+}
+
+void DispSync::setPeriod(nsecs_t period) {
+    Mutex::Autolock lock(mMutex);
+    mPeriod = period;
+    mThread->updateModel(mPeriod, mPhase);
+}
+
+nsecs_t DispSync::getPeriod() const {
+    Mutex::Autolock lock(mMutex);
+    return mPeriod;
+}
+
+void DispSync::beginResync() {
+    Mutex::Autolock lock(mMutex);
+    mNumResyncSamples = 0;
+    mModelLocked = false;
+    mResyncCount++;
+
+    // present times gathered with the old model would make us resync again
+    for (size_t i=0 ; i<NUM_PRESENT_SAMPLES ; i++) {
+        mPresentFences[i].clear();
+        mPresentTimes[i] = 0;
+    }
+}
+
+bool DispSync::isLocked() const {
+    Mutex::Autolock lock(mMutex);
+    return mModelLocked;
+}
+
+nsecs_t DispSync::computeNextRefresh(nsecs_t now) const {
+    Mutex::Autolock lock(mMutex);
+    if (mPeriod == 0) {
+        return 0;
+    }
+    return (((now - mPhase) / mPeriod) + 1) * mPeriod + mPhase;
+}
+
+bool DispSync::addResyncSample(nsecs_t timestamp) {
+    Mutex::Autolock lock(mMutex);
+
+    size_t idx = (mFirstResyncSample + mNumResyncSamples) % MAX_RESYNC_SAMPLES;
+    mResyncSamples[idx] = timestamp;
+
+    if (mNumResyncSamples < MAX_RESYNC_SAMPLES) {
+        mNumResyncSamples++;
+    } else {
+        mFirstResyncSample = (mFirstResyncSample + 1) % MAX_RESYNC_SAMPLES;
+    }
+    mTotalResyncSamples++;
+
+    updateModelLocked();
+
+    if (!mModelLocked && mNumResyncSamples >= MIN_RESYNC_SAMPLES_FOR_LOCK &&
+            mError < kErrorThreshold) {
+        mModelLocked = true;
+    }
+    return !mModelLocked;
+}
+
+bool DispSync::addPresentFence(const sp<Fence>& fence) {
+    Mutex::Autolock lock(mMutex);
+
+    mPresentFences[mPresentSampleOffset] = fence;
+    mPresentTimes[mPresentSampleOffset] = 0;
+    mPresentSampleOffset = (mPresentSampleOffset + 1) % NUM_PRESENT_SAMPLES;
+
+    // collect the fences that signaled since the last frame
+    size_t numPresentTimes = 0;
+    for (size_t i=0 ; i<NUM_PRESENT_SAMPLES ; i++) {
+        const sp<Fence>& f(mPresentFences[i]);
+        if (f != NULL) {
+            nsecs_t t = f->getSignalTime();
+            if (t < INT64_MAX) {
+                mPresentFences[i].clear();
+                mPresentTimes[i] = (t < 0) ? 0 :
+                        t - PRESENT_TIME_OFFSET_FROM_VSYNC_NS;
+            }
+        }
+        if (mPresentTimes[i]) {
+            numPresentTimes++;
+        }
+    }
+
+    if (mPeriod == 0 || !mModelLocked ||
+            numPresentTimes < MIN_PRESENT_SAMPLES_FOR_ERROR) {
+        // either h/w vsync is already on, or we can't tell yet
+        return false;
+    }
+
+    updateErrorLocked(mPresentTimes, 0, NUM_PRESENT_SAMPLES, NUM_PRESENT_SAMPLES);
+    if (mError > kErrorThreshold) {
+        ALOGD("DispSync: display drifted from the model (%.3f us rms), "
+                "resyncing", sqrt(double(mError)) / 1e3);
+        mModelLocked = false;
+        return true;
+    }
+    return false;
+}
+
+void DispSync::updateModelLocked() {
+    if (mNumResyncSamples < MIN_RESYNC_SAMPLES_FOR_UPDATE) {
+        return;
+    }
+
+    // the period is the average distance between two samples. If the
+    // h/w skipped a vsync, the interval spans several periods and is
+    // scaled back using the previous estimate.
+    nsecs_t durationSum = 0;
+    size_t numIntervals = 0;
+    for (size_t i=1 ; i<mNumResyncSamples ; i++) {
+        size_t idx = (mFirstResyncSample + i) % MAX_RESYNC_SAMPLES;
+        size_t prev = (idx + MAX_RESYNC_SAMPLES - 1) % MAX_RESYNC_SAMPLES;
+        nsecs_t duration = mResyncSamples[idx] - mResyncSamples[prev];
+        size_t periods = 1;
+        if (mPeriod > 0) {
+            periods = size_t((duration + mPeriod / 2) / mPeriod);
+            if (periods == 0) {
+                // spurious sample, ignore this interval
+                continue;
+            }
+        }
+        durationSum += duration;
+        numIntervals += periods;
+    }
+    if (numIntervals == 0) {
+        return;
+    }
+    mPeriod = durationSum / numIntervals;
+
+    // the phase is averaged on the unit circle so that samples on either
+    // side of the period boundary don't cancel each other out
+    double sampleAvgX = 0;
+    double sampleAvgY = 0;
+    const double scale = 2.0 * M_PI / double(mPeriod);
+    for (size_t i=0 ; i<mNumResyncSamples ; i++) {
+        size_t idx = (mFirstResyncSample + i) % MAX_RESYNC_SAMPLES;
+        nsecs_t sample = mResyncSamples[idx];
+        double samplePhase = double(sample % mPeriod) * scale;
+        sampleAvgX += cos(samplePhase);
+        sampleAvgY += sin(samplePhase);
+    }
+    sampleAvgX /= double(mNumResyncSamples);
+    sampleAvgY /= double(mNumResyncSamples);
+
+    mPhase = nsecs_t(atan2(sampleAvgY, sampleAvgX) / scale);
+    if (mPhase < 0) {
+        mPhase += mPeriod;
+    }
+
+    updateErrorLocked(mResyncSamples, mFirstResyncSample, mNumResyncSamples,
+            MAX_RESYNC_SAMPLES);
+    mThread->updateModel(mPeriod, mPhase);
+}
+
+// computes the mean squared distance between the samples of a ring buffer
+// and the closest modeled vsync, zero samples are ignored
+void DispSync::updateErrorLocked(const nsecs_t* samples, size_t first,
+        size_t count, size_t size) {
+    nsecs_t sqErrSum = 0;
+    size_t numErrSamples = 0;
+    for (size_t i=0 ; i<count ; i++) {
+        nsecs_t sample = samples[(first + i) % size];
+        if (sample == 0) {
+            continue;
+        }
+        nsecs_t err = (sample - mPhase) % mPeriod;
+        if (err < 0) {
+            err += mPeriod;
+        }
+        if (err > mPeriod / 2) {
+            err -= mPeriod;
+        }
+        sqErrSum += err * err;
+        numErrSamples++;
+    }
+    if (numErrSamples == 0) {
+        return;
+    }
+    mError = sqErrSum / nsecs_t(numErrSamples);
+    ATRACE_INT("DispSync:Error(us)", int32_t(sqrt(double(mError)) / 1e3));
+}
+
+status_t DispSync::addEventListener(nsecs_t phase,
+        const sp<Callback>& callback) {
+    return mThread->addEventListener(phase, callback);
+}
+
+status_t DispSync::removeEventListener(const sp<Callback>& callback) {
+    return mThread->removeEventListener(callback);
+}
+
+bool DispSync::hasEventListeners() const {
+    return mThread->getEventListenerCount() > 0;
+}
+
+void DispSync::dump(String8& result, char* buffer, size_t SIZE) const {
+    Mutex::Autolock lock(mMutex);
+    snprintf(buffer, SIZE, "DispSync model: %s\n"
+            "  period=%.3f ms (%.2f Hz), phase=%.3f ms, error=%.3f us (rms)\n"
+            "  samples: %u in model, %u total, resyncs=%u, listeners=%u\n",
+            mModelLocked ? "locked" : "not locked",
+            mPeriod / 1e6, mPeriod ? 1e9 / mPeriod : 0.0,
+            mPhase / 1e6, sqrt(double(mError)) / 1e3,
+            mNumResyncSamples, mTotalResyncSamples, mResyncCount,
+            mThread->getEventListenerCount());
+    result.append(buffer);
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SURFACE_FLINGER_DISP_SYNC_H
+#define ANDROID_SURFACE_FLINGER_DISP_SYNC_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Errors.h>
+#include <utils/RefBase.h>
+#include <utils/Timers.h>
+#include <utils/threads.h>
+
+#include <ui/Fence.h>
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+class String8;
+class DispSyncThread;
+
+/*
+ * DispSync maintains a software model of the display's vsync, a period and
+ * a phase estimated from the hardware vsync timestamps fed by
+ * addResyncSample().
+ *
+ * Listeners register with a phase offset relative to the modeled vsync and
+ * are called back on a dedicated thread at (vsync + offset) on every
+ * period. This lets apps and SurfaceFlinger wake up at different points
+ * of the same frame instead of racing on the hardware vsync.
+ *
+ * Once the model is locked the hardware vsync isn't needed anymore, the
+ * present fences of the composed frames are used instead to check that
+ * the model doesn't drift away from the display.
+ */
+class DispSync {
+public:
+    class Callback : public virtual RefBase {
+    public:
+        virtual ~Callback() { }
+        virtual void onDispSyncEvent(nsecs_t when) = 0;
+    };
+
+    DispSync();
+    ~DispSync();
+
+    // forget all the samples and the current model
+    void reset();
+
+    // seeds the model with the nominal refresh period of the display,
+    // used until enough hardware samples have been received
+    void setPeriod(nsecs_t period);
+    nsecs_t getPeriod() const;
+
+    // called when hardware vsync is turned (back) on, the samples
+    // collected before that are discarded since they are not contiguous
+    void beginResync();
+
+    // adds a hardware vsync timestamp and updates the model, returns true
+    // as long as more samples are needed for the model to lock
+    bool addResyncSample(nsecs_t timestamp);
+
+    // adds the present fence of the last composed frame, returns true if
+    // the display has drifted away from the model, in which case hardware
+    // vsync should be turned back on
+    bool addPresentFence(const sp<Fence>& fence);
+
+    // true when the model can be used without hardware vsync
+    bool isLocked() const;
+
+    // the first modeled vsync after now, 0 when there is no model yet
+    nsecs_t computeNextRefresh(nsecs_t now) const;
+
+    // callback is invoked at every modeled vsync shifted by phase,
+    // phase must be within (-period, period)
+    status_t addEventListener(nsecs_t phase, const sp<Callback>& callback);
+    status_t removeEventListener(const sp<Callback>& callback);
+    bool hasEventListeners() const;
+
+    void dump(String8& result, char* buffer, size_t SIZE) const;
+
+private:
+    enum { MAX_RESYNC_SAMPLES = 32 };
+    enum { MIN_RESYNC_SAMPLES_FOR_UPDATE = 3 };
+    enum { MIN_RESYNC_SAMPLES_FOR_LOCK = 6 };
+    enum { NUM_PRESENT_SAMPLES = 8 };
+    enum { MIN_PRESENT_SAMPLES_FOR_ERROR = 3 };
+
+    void updateModelLocked();
+    void updateErrorLocked(const nsecs_t* samples, size_t first,
+            size_t count, size_t size);
+
+    mutable Mutex mMutex;
+
+    // the model, protected by mMutex
+    nsecs_t mPeriod;
+    nsecs_t mPhase;
+    // mean squared distance (ns^2) between the samples and the model
+    nsecs_t mError;
+
+    // ring buffer of the most recent hardware vsync timestamps
+    nsecs_t mResyncSamples[MAX_RESYNC_SAMPLES];
+    size_t mFirstResyncSample;
+    size_t mNumResyncSamples;
+    size_t mTotalResyncSamples;
+    size_t mResyncCount;
+    bool mModelLocked;
+
+    // ring buffer of the most recent present fences and the times they
+    // signaled at, 0 for fences not signaled yet
+    sp<Fence> mPresentFences[NUM_PRESENT_SAMPLES];
+    nsecs_t mPresentTimes[NUM_PRESENT_SAMPLES];
+    size_t mPresentSampleOffset;
+
+    sp<DispSyncThread> mThread;
+};
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
+
+#endif /* ANDROID_SURFACE_FLINGER_DISP_SYNC_H */
@@ -92,6 +92,13 @@ DisplayDevice::DisplayDevice(
       mIsSecure(isSecure),
       mSecureLayerVisible(false),
       mScreenAcquired(false),
+      mDamageHistorySize(0),
+      mHasFrameDamage(false),
+      mLastBufferAge(0),
+      mRenderScale(1.0f),
+      mRenderWidth(0),
+      mRenderHeight(0),
+      mViewportDirty(false),
       mLayerStack(NO_LAYER_STACK),
       mOrientation()
 {
@@ -116,6 +123,9 @@ DisplayDevice::DisplayDevice(
     eglQuerySurface(display, surface, EGL_WIDTH,  &mDisplayWidth);
     eglQuerySurface(display, surface, EGL_HEIGHT, &mDisplayHeight);
 
+    mRenderWidth = mDisplayWidth;
+    mRenderHeight = mDisplayHeight;
+
     mDisplay = display;
     mSurface = surface;
     mFormat  = format;
@@ -206,14 +216,43 @@ void DisplayDevice::flip(const Region& dirty) const
     if (mFlags & SWAP_RECTANGLE) {
         const Region newDirty(dirty.intersect(bounds()));
         const Rect b(newDirty.getBounds());
-        eglSetSwapRectangleANDROID(dpy, surface,
-                b.left, b.top, b.width(), b.height());
+        // the surface is mRenderWidth x mRenderHeight, round outwards
+        // like setScissor() does
+        const float sx = float(mRenderWidth) / mDisplayWidth;
+        const float sy = float(mRenderHeight) / mDisplayHeight;
+        const EGLint l = EGLint(floorf(b.left * sx));
+        const EGLint t = EGLint(floorf(b.top * sy));
+        const EGLint r = EGLint(ceilf(b.right * sx));
+        const EGLint bottom = EGLint(ceilf(b.bottom * sy));
+        eglSetSwapRectangleANDROID(dpy, surface, l, t, r - l, bottom - t);
     }
 #endif
 
     mPageFlipCount++;
 }
 
+Region DisplayDevice::getBufferAgeRepaintRegion(const Region& dirty) const {
+    mFrameDamage = dirty;
+    mHasFrameDamage = true;
+
+    EGLint age = 0;
+    if (!eglQuerySurface(mDisplay, mSurface, EGL_BUFFER_AGE_EXT, &age)) {
+        age = 0;
+    }
+    mLastBufferAge = age;
+
+    // age 0 means the content of the buffer is undefined, age 1 means it
+    // holds the previous frame, and so on.
+    if (age <= 0 || size_t(age - 1) > mDamageHistorySize) {
+        return Region(bounds());
+    }
+    Region repaint(dirty);
+    for (EGLint i=0 ; i<age-1 ; i++) {
+        repaint.orSelf(mDamageHistory[i]);
+    }
+    return repaint.intersect(bounds());
+}
+
 void DisplayDevice::swapBuffers(HWComposer& hwc) const {
     // We need to call eglSwapBuffers() unless:
     // (a) there was no GLES composition this frame, or
@@ -222,6 +261,23 @@ void DisplayDevice::swapBuffers(HWComposer& hwc) const {
     if (hwc.initCheck() != NO_ERROR ||
             (hwc.hasGlesComposition(mHwcDisplayId) &&
              hwc.supportsFramebufferTarget())) {
+        // remember what changed in this buffer, for the next frames. Frames
+        // drawn without getBufferAgeRepaintRegion(), e.g. the debug region
+        // flashes, may have changed anything.
+        for (size_t i=MAX_BUFFER_AGE-1 ; i>0 ; i--) {
+            mDamageHistory[i] = mDamageHistory[i-1];
+        }
+        if (mHasFrameDamage) {
+            mDamageHistory[0] = mFrameDamage;
+        } else {
+            mDamageHistory[0].set(bounds());
+        }
+        if (mDamageHistorySize < MAX_BUFFER_AGE) {
+            mDamageHistorySize++;
+        }
+        mFrameDamage.clear();
+        mHasFrameDamage = false;
+
         EGLBoolean success = eglSwapBuffers(mDisplay, mSurface);
         if (!success) {
             EGLint error = eglGetError();
@@ -233,7 +289,13 @@ void DisplayDevice::swapBuffers(HWComposer& hwc) const {
                 ALOGE("eglSwapBuffers(%p, %p) failed with 0x%08x",
                         mDisplay, mSurface, error);
             }
+            mDamageHistorySize = 0;
         }
+    } else {
+        // the screen content changed without our buffers knowing about it
+        mDamageHistorySize = 0;
+        mFrameDamage.clear();
+        mHasFrameDamage = false;
     }
 
     status_t result = mDisplaySurface->advanceFrame();
@@ -263,6 +325,8 @@ EGLBoolean DisplayDevice::makeCurrent(EGLDisplay dpy,
         if (result == EGL_TRUE) {
             setViewportAndProjection(hw);
         }
+    } else if (hw->mViewportDirty) {
+        setViewportAndProjection(hw);
     }
     return result;
 }
@@ -270,7 +334,8 @@ EGLBoolean DisplayDevice::makeCurrent(EGLDisplay dpy,
 void DisplayDevice::setViewportAndProjection(const sp<const DisplayDevice>& hw) {
     GLsizei w = hw->mDisplayWidth;
     GLsizei h = hw->mDisplayHeight;
-    glViewport(0, 0, w, h);
+    glViewport(0, 0, hw->mRenderWidth, hw->mRenderHeight);
+    hw->mViewportDirty = false;
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     // put the origin in the left-bottom corner
@@ -278,6 +343,53 @@ void DisplayDevice::setViewportAndProjection(const sp<const DisplayDevice>& hw)
     glMatrixMode(GL_MODELVIEW);
 }
 
+bool DisplayDevice::setRenderScale(float scale) {
+#ifdef EGL_NEEDS_FNW
+    // EGL renders into a FramebufferNativeWindow of a fixed size
+    return scale == 1.0f;
+#else
+    if (mHwcDisplayId < 0 || mType >= DISPLAY_VIRTUAL ||
+            !(scale > 0.0f && scale <= 1.0f)) {
+        return scale == 1.0f;
+    }
+    if (scale == mRenderScale) {
+        return true;
+    }
+
+    int w = int(mDisplayWidth * scale + 0.5f);
+    int h = int(mDisplayHeight * scale + 0.5f);
+    if (w < 1) w = 1;
+    if (h < 1) h = 1;
+    if (scale == 1.0f) {
+        w = mDisplayWidth;
+        h = mDisplayHeight;
+        // back to the default size of the buffers
+        native_window_set_buffers_dimensions(mNativeWindow.get(), 0, 0);
+    } else {
+        native_window_set_buffers_dimensions(mNativeWindow.get(), w, h);
+    }
+    mRenderScale = scale;
+    mRenderWidth = w;
+    mRenderHeight = h;
+    mViewportDirty = true;
+    // the back buffers are reallocated, their content is gone
+    mDamageHistorySize = 0;
+    return true;
+#endif
+}
+
+void DisplayDevice::setScissor(const Rect& scissor) const {
+    // round outwards, in GL's bottom-up coordinates
+    const float sx = float(mRenderWidth) / mDisplayWidth;
+    const float sy = float(mRenderHeight) / mDisplayHeight;
+    const GLint l = GLint(floorf(scissor.left * sx));
+    const GLint r = GLint(ceilf(scissor.right * sx));
+    const GLint b = GLint(floorf((mDisplayHeight - scissor.bottom) * sy));
+    const GLint t = GLint(ceilf((mDisplayHeight - scissor.top) * sy));
+    glScissor(l, b, r - l, t - b);
+    glEnable(GL_SCISSOR_TEST);
+}
+
 // ----------------------------------------------------------------------------
 
 void DisplayDevice::setVisibleLayersSortedByZ(const Vector< sp<Layer> >& layers) {
@@ -332,9 +444,23 @@ bool DisplayDevice::isScreenAcquired() const {
 
 // ----------------------------------------------------------------------------
 
+DisplayDevice::VisibleRegionCache::VisibleRegionCache()
+    : valid(false), layerStack(NO_LAYER_STACK),
+      ignoreLayers(false), extOnlyLayerIndex(-1),
+      lastSkipped(0), lastCount(0), totalSkipped(0), totalCount(0) {
+}
+
+void DisplayDevice::VisibleRegionCache::clear() {
+    valid = false;
+    entries.clear();
+}
+
+// ----------------------------------------------------------------------------
+
 void DisplayDevice::setLayerStack(uint32_t stack) {
     mLayerStack = stack;
     dirtyRegion.set(bounds());
+    compositionCache.invalidate();
 }
 
 // ----------------------------------------------------------------------------
@@ -409,6 +535,8 @@ void DisplayDevice::setProjection(int orientation,
     }
 
     dirtyRegion.set(getBounds());
+    compositionCache.invalidate();
+    mDamageHistorySize = 0;
 
     Transform TL, TP, S;
     float src_width  = viewport.width();
@@ -468,6 +596,23 @@ void DisplayDevice::dump(String8& result, char* buffer, size_t SIZE) const {
 
     result.append(buffer);
 
+    const VisibleRegionCache& vrc(visibleRegionCache);
+    snprintf(buffer, SIZE,
+        "   visible-region cache: valid=%d, skipped %u/%u layers last pass, "
+        "%llu/%llu total\n",
+        vrc.valid, vrc.lastSkipped, vrc.lastCount,
+        vrc.totalSkipped, vrc.totalCount);
+    result.append(buffer);
+    compositionCache.dump(result, buffer, SIZE);
+    if (mRenderScale != 1.0f) {
+        snprintf(buffer, SIZE, "   render scale: %.3f (%dx%d)\n",
+                mRenderScale, mRenderWidth, mRenderHeight);
+        result.append(buffer);
+    }
+    snprintf(buffer, SIZE, "   buffer age: last=%d, damage history=%u\n",
+            mLastBufferAge, mDamageHistorySize);
+    result.append(buffer);
+
     String8 surfaceDump;
     mDisplaySurface->dump(surfaceDump);
     result.append(surfaceDump);
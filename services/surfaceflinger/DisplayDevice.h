@@ -26,10 +26,13 @@
 #include <EGL/eglext.h>
 
 #include <utils/Mutex.h>
+#include <utils/RefBase.h>
 #include <utils/Timers.h>
+#include <utils/Vector.h>
 
 #include <hardware/hwcomposer_defs.h>
 
+#include "CompositionCache.h"
 #include "Transform.h"
 
 struct ANativeWindow;
@@ -52,6 +55,46 @@ public:
     // region in screen space
     Region undefinedRegion;
 
+    /*
+     * Result of the last SurfaceFlinger::computeVisibleRegions() pass on
+     * this display, used to skip the unchanged top of the layer stack on
+     * the next pass. Entries are stored top-most layer first.
+     * Can only be accessed from the main thread.
+     */
+    struct VisibleRegionCache {
+        struct Entry {
+            enum {
+                UNTOUCHED,  // not on this display's layer stack
+                HIDDEN,     // visibleNonTransparentRegion cleared
+                COMPUTED    // all regions below written by this display
+            };
+            wp<Layer> layer;
+            int state;
+            Region visibleRegion;
+            Region coveredRegion;
+            Region visibleNonTransparentRegion;
+            // aboveOpaqueLayers / aboveCoveredLayers after this layer
+            Region belowOpaqueLayers;
+            Region belowCoveredLayers;
+        };
+        VisibleRegionCache();
+        void clear();
+        bool valid;
+        uint32_t layerStack;
+        bool ignoreLayers;
+        int extOnlyLayerIndex;
+        Vector<Entry> entries;
+        // statistics, for dumpsys
+        size_t lastSkipped;
+        size_t lastCount;
+        uint64_t totalSkipped;
+        uint64_t totalCount;
+    };
+    VisibleRegionCache visibleRegionCache;
+
+    // GLES composition of the static bottom of the layer stack
+    mutable CompositionCache compositionCache;
+
     enum DisplayType {
         DISPLAY_ID_INVALID = -1,
         DISPLAY_PRIMARY     = HWC_DISPLAY_PRIMARY,
@@ -117,13 +160,21 @@ public:
     const Rect              getViewport() const { return mViewport; }
     const Rect              getFrame() const { return mFrame; }
     const Rect&             getScissor() const { return mScissor; }
-    bool                    needsFiltering() const { return mNeedsFiltering; }
+    bool                    needsFiltering() const {
+        return mNeedsFiltering || mRenderScale != 1.0f;
+    }
 
     uint32_t                getLayerStack() const { return mLayerStack; }
     int32_t                 getDisplayType() const { return mType; }
     int32_t                 getHwcDisplayId() const { return mHwcDisplayId; }
     const wp<IBinder>&      getDisplayToken() const { return mDisplayToken; }
 
+    // Returns the part of the current back buffer that must be redrawn to
+    // bring it up to date, given the region that changed this frame. This
+    // relies on EGL_EXT_buffer_age and falls back to the whole display when
+    // the age of the buffer is unknown. The EGL surface must be current.
+    Region getBufferAgeRepaintRegion(const Region& dirty) const;
+
     void swapBuffers(HWComposer& hwc) const;
     status_t compositionComplete() const;
 
@@ -143,6 +194,19 @@ public:
 
     static void setViewportAndProjection(const sp<const DisplayDevice>& hw);
 
+    // GLES composition renders into buffers of this fraction of the display
+    // size, and the HWC scales the framebuffer target back up. The
+    // projection is unchanged, everything is still drawn in display
+    // coordinates. Returns false if the display can't do it, i.e. it has no
+    // HWC framebuffer target.
+    bool setRenderScale(float scale);
+    float getRenderScale() const { return mRenderScale; }
+    int getRenderWidth() const { return mRenderWidth; }
+    int getRenderHeight() const { return mRenderHeight; }
+
+    // enables the GL scissor on a rectangle in display coordinates
+    void setScissor(const Rect& scissor) const;
+
     /* ------------------------------------------------------------------------
      * blank / unblank management
      */
@@ -198,6 +262,25 @@ private:
     // Whether the screen is blanked;
     mutable int mScreenAcquired;
 
+    // screen-space damage of the last frames, most recent first, used
+    // with EGL_EXT_buffer_age
+    enum { MAX_BUFFER_AGE = 4 };
+    mutable Region mDamageHistory[MAX_BUFFER_AGE];
+    // number of valid entries in mDamageHistory
+    mutable size_t mDamageHistorySize;
+    // damage of the frame being composed, if getBufferAgeRepaintRegion()
+    // was told about it
+    mutable Region mFrameDamage;
+    mutable bool mHasFrameDamage;
+    mutable EGLint mLastBufferAge;
+
+    // see setRenderScale(), the viewport is set again on the next
+    // makeCurrent() when it changed
+    float mRenderScale;
+    int mRenderWidth;
+    int mRenderHeight;
+    mutable bool mViewportDirty;
+
 
     /*
      * Transaction state
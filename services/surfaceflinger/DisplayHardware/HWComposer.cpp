@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <utils/CallStack.h>
 #include <utils/Errors.h>
@@ -47,6 +48,7 @@
 
 #include "../Layer.h"           // needed only for debugging
 #include "../SurfaceFlinger.h"
+#include "../WorkerPool.h"
 
 namespace android {
 
@@ -209,6 +211,17 @@ struct HWComposer::cb_context {
     HWComposer* hwc;
 };
 
+// runs the HAL's prepare() on mPrepareWorker, see beginPrepare()
+class HWComposer::PrepareJob : public WorkerPool::Job {
+public:
+    PrepareJob(HWComposer& hwc) : mHwc(hwc) { }
+    virtual void run() {
+        mHwc.runPrepareJob();
+    }
+private:
+    HWComposer& mHwc;
+};
+
 // ---------------------------------------------------------------------------
 
 HWComposer::HWComposer(
@@ -218,7 +231,10 @@ HWComposer::HWComposer(
       mFbDev(0), mHwc(0), mNumDisplays(1),
       mCBContext(new cb_context),
       mEventHandler(handler),
-      mVSyncCount(0), mDebugForceFakeVSync(false)
+      mVSyncCount(0), mDebugForceFakeVSync(false),
+      mRetainWorkList(false), mPrepareCount(0), mPrepareSkipCount(0),
+      mPrepareJob(NULL), mPreparePending(false), mPrepareError(NO_ERROR),
+      mPredictionHits(0), mPredictionMisses(0), mPredictionUnavailable(0)
 {
     for (size_t i =0 ; i<MAX_DISPLAYS ; i++) {
         mLists[i] = 0;
@@ -228,6 +244,15 @@ HWComposer::HWComposer(
     property_get("debug.sf.no_hw_vsync", value, "0");
     mDebugForceFakeVSync = atoi(value);
 
+    // reuse the composition types of the previous frame instead of calling
+    // prepare() when nothing changed. this is outside of what the HWC 1.x
+    // contract guarantees, so it must be enabled explicitly.
+    property_get("debug.sf.hwc_retain_worklist", value, "0");
+    mRetainWorkList = atoi(value);
+
+    property_get("debug.sf.hwc_predict", value, "0");
+    const bool predictComposition = atoi(value);
+
     bool needVSyncThread = true;
 
     // Note: some devices may insist that the FB HAL be opened before HWC.
@@ -336,6 +361,15 @@ HWComposer::HWComposer(
         }
     }
 
+    if (predictComposition) {
+        if (mHwc && hwcHasApiVersion(mHwc, HWC_DEVICE_API_VERSION_1_1)) {
+            mPrepareWorker = new WorkerPool("HwcPrepare", 1);
+            mPrepareJob = new PrepareJob(*this);
+        } else {
+            ALOGW("composition prediction requires HWC 1.1, disabled");
+        }
+    }
+
     if (needVSyncThread) {
         // we don't have VSYNC support, we need to fake it
         mVSyncThread = new VSyncThread(*this);
@@ -343,6 +377,11 @@ HWComposer::HWComposer(
 }
 
 HWComposer::~HWComposer() {
+    if (mPrepareWorker != NULL) {
+        mPrepareWorker->wait();
+        mPrepareWorker.clear();
+        delete mPrepareJob;
+    }
     if (mHwc) {
         eventControl(HWC_DISPLAY_PRIMARY, HWC_EVENT_VSYNC, 0);
     }
@@ -558,6 +597,7 @@ status_t HWComposer::freeDisplayId(int32_t id) {
     }
     mAllocatedDisplayIDs.clearBit(id);
     mDisplayData[id].connected = false;
+    invalidatePreparedState(id);
     return NO_ERROR;
 }
 
@@ -578,6 +618,24 @@ sp<Fence> HWComposer::getDisplayFence(int disp) const {
     return mDisplayData[disp].lastDisplayFence;
 }
 
+nsecs_t HWComposer::takeFramebufferTargetLatency(int disp) {
+    DisplayData& dd(mDisplayData[disp]);
+    if (dd.fbTargetFence == NULL || !dd.fbTargetFence->isValid()) {
+        // without a fence the GPU work can't be timed
+        dd.fbTargetFence = NULL;
+        return 0;
+    }
+    const nsecs_t signalTime = dd.fbTargetFence->getSignalTime();
+    if (signalTime == INT64_MAX) {
+        return 0;   // not done yet
+    }
+    dd.fbTargetFence = NULL;
+    if (signalTime <= dd.fbTargetPostTime) {
+        return 1;   // done before it was posted, or an error
+    }
+    return signalTime - dd.fbTargetPostTime;
+}
+
 uint32_t HWComposer::getWidth(int disp) const {
     return mDisplayData[disp].width;
 }
@@ -696,6 +754,7 @@ status_t HWComposer::createWorkList(int32_t id, size_t numLayers) {
         }
         hwcFlags(mHwc, disp.list) = HWC_GEOMETRY_CHANGED;
         hwcNumHwLayers(mHwc, disp.list) = numLayers;
+        invalidatePreparedState(id);
     }
     return NO_ERROR;
 }
@@ -726,10 +785,73 @@ status_t HWComposer::setFramebufferTarget(int32_t id,
     disp.fbTargetHandle = buf->handle;
     disp.framebufferTarget->handle = disp.fbTargetHandle;
     disp.framebufferTarget->acquireFenceFd = acquireFenceFd;
+    // the buffer is smaller than the display when GLES composition is
+    // scaled, the HAL scales it up to displayFrame
+    disp.framebufferTarget->sourceCrop.left = 0;
+    disp.framebufferTarget->sourceCrop.top = 0;
+    disp.framebufferTarget->sourceCrop.right = buf->getWidth();
+    disp.framebufferTarget->sourceCrop.bottom = buf->getHeight();
+    disp.fbTargetFence = acquireFence;
+    disp.fbTargetPostTime = systemTime();
     return NO_ERROR;
 }
 
-status_t HWComposer::prepare() {
+// hash of everything prepare() takes into account for a display, except
+// the buffer handles which change every frame without affecting the
+// HAL's decisions much.
+static uint32_t getCompositionSignature(const hwc_display_contents_1_t* list) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    struct {
+        uint32_t hasBuffer;
+        uint32_t flags;
+        uint32_t transform;
+        uint32_t blending;
+        hwc_rect_t sourceCrop;
+        hwc_rect_t displayFrame;
+        uint32_t numRects;
+        uint32_t planeAlpha;
+    } key;
+    for (size_t i=0 ; i<list->numHwLayers ; i++) {
+        const hwc_layer_1_t& l = list->hwLayers[i];
+        memset(&key, 0, sizeof(key));
+        key.hasBuffer = (l.handle != NULL);
+        key.flags = l.flags;
+        key.transform = l.transform;
+        key.blending = l.blending;
+        key.sourceCrop = l.sourceCrop;
+        key.displayFrame = l.displayFrame;
+        key.numRects = l.visibleRegionScreen.numRects;
+        key.planeAlpha = l.planeAlpha;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&key);
+        for (size_t j=0 ; j<sizeof(key) ; j++) {
+            hash = (hash ^ p[j]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+// counts the type of each layer and forces "skip" layers to be composed
+// with GLES, once the HAL is done with list
+static void resolveCompositionTypes(hwc_display_contents_1_t* list,
+        bool primary, bool* hasFbComp, bool* hasOvComp) {
+    *hasFbComp = false;
+    *hasOvComp = false;
+    for (size_t j=0 ; j<list->numHwLayers ; j++) {
+        hwc_layer_1_t& l = list->hwLayers[j];
+        if (primary && (l.flags & HWC_SKIP_LAYER)) {
+            l.compositionType = HWC_FRAMEBUFFER;
+        }
+        if (l.compositionType == HWC_FRAMEBUFFER) {
+            *hasFbComp = true;
+        }
+        if (l.compositionType == HWC_OVERLAY) {
+            *hasOvComp = true;
+        }
+    }
+}
+
+void HWComposer::setUpListsForPrepare() {
     for (size_t i=0 ; i<mNumDisplays ; i++) {
         DisplayData& disp(mDisplayData[i]);
         if (disp.framebufferTarget) {
@@ -759,6 +881,19 @@ status_t HWComposer::prepare() {
             }
         }
     }
+}
+
+status_t HWComposer::prepare() {
+    setUpListsForPrepare();
+
+    mPrepareCount++;
+    if (mRetainWorkList && canSkipPrepare()) {
+        // the HAL already saw exactly this work-list, the composition
+        // types it picked and hasFbComp/hasOvComp are still valid.
+        mPrepareSkipCount++;
+        return NO_ERROR;
+    }
+
     int err = hwcPrepare(mHwc, mNumDisplays, mLists);
     ALOGE_IF(err, "HWComposer: prepare failed (%s)", strerror(-err));
 
@@ -772,23 +907,9 @@ status_t HWComposer::prepare() {
                 disp.hasFbComp = false;
                 disp.hasOvComp = false;
                 if (disp.list) {
-                    for (size_t j=0 ; j<disp.list->numHwLayers ; j++) {
-                        hwc_layer_1_t& l = disp.list->hwLayers[j];
-
-                        //ALOGD("prepare: %d, type=%d, handle=%p",
-                        //        i, l.compositionType, l.handle);
-
-                        if ((i == DisplayDevice::DISPLAY_PRIMARY) &&
-                                    l.flags & HWC_SKIP_LAYER) {
-                            l.compositionType = HWC_FRAMEBUFFER;
-                        }
-                        if (l.compositionType == HWC_FRAMEBUFFER) {
-                            disp.hasFbComp = true;
-                        }
-                        if (l.compositionType == HWC_OVERLAY) {
-                            disp.hasOvComp = true;
-                        }
-                    }
+                    resolveCompositionTypes(disp.list,
+                            i == DisplayDevice::DISPLAY_PRIMARY,
+                            &disp.hasFbComp, &disp.hasOvComp);
                 }
             }
         } else {
@@ -818,9 +939,267 @@ status_t HWComposer::prepare() {
         }
 
     }
+
+    if (mPrepareWorker != NULL && err == NO_ERROR) {
+        for (size_t i=0 ; i<mNumDisplays ; i++) {
+            recordCompositionStrategy(mDisplayData[i]);
+        }
+    }
+
+    if (mRetainWorkList) {
+        if (err == NO_ERROR) {
+            savePreparedState();
+        } else {
+            for (size_t i=0 ; i<mNumDisplays ; i++) {
+                invalidatePreparedState(i);
+            }
+        }
+    }
     return (status_t)err;
 }
 
+status_t HWComposer::beginPrepare() {
+    if (mPrepareWorker == NULL) {
+        return prepare();
+    }
+
+    setUpListsForPrepare();
+    if ((mRetainWorkList && canSkipPrepare()) || !predictComposition()) {
+        // nothing to win, or nothing known about these layers yet
+        return prepare();
+    }
+
+    mPrepareCount++;
+    mPreparePending = true;
+    mPrepareWorker->post(mPrepareJob);
+    return NO_ERROR;
+}
+
+bool HWComposer::predictComposition() {
+    const CompositionStrategy* predicted[MAX_DISPLAYS];
+    for (size_t i=0 ; i<mNumDisplays ; i++) {
+        DisplayData& disp(mDisplayData[i]);
+        predicted[i] = NULL;
+        if (!disp.list) {
+            continue;
+        }
+        if (disp.outbufHandle) {
+            // the output buffer is only set after prepare()
+            return false;
+        }
+        const uint32_t signature = getCompositionSignature(disp.list);
+        for (size_t j=0 ; j<disp.strategies.size() ; j++) {
+            const CompositionStrategy& st(disp.strategies[j]);
+            if (st.signature == signature &&
+                    st.numHwLayers == disp.list->numHwLayers) {
+                predicted[i] = &st;
+                break;
+            }
+        }
+        if (predicted[i] == NULL) {
+            mPredictionUnavailable++;
+            return false;
+        }
+    }
+
+    for (size_t i=0 ; i<mNumDisplays ; i++) {
+        DisplayData& disp(mDisplayData[i]);
+        if (!disp.list) {
+            continue;
+        }
+        // the HAL works on its own copy of the work-list, so that
+        // composition can go on with the predicted one in the meantime
+        const size_t numLayers = disp.list->numHwLayers;
+        if (disp.prepareCapacity < numLayers || disp.prepareList == NULL) {
+            free(disp.prepareList);
+            disp.prepareList = (hwc_display_contents_1_t*)malloc(
+                    sizeofHwcLayerList(mHwc, numLayers));
+            disp.prepareCapacity = numLayers;
+        }
+        memcpy(disp.prepareList, disp.list, sizeofHwcLayerList(mHwc, numLayers));
+        mLists[i] = disp.prepareList;
+
+        const CompositionStrategy& st(*predicted[i]);
+        for (size_t j=0 ; j<numLayers ; j++) {
+            hwc_layer_1_t& l = disp.list->hwLayers[j];
+            l.compositionType = st.types[j];
+            l.hints = st.hints[j];
+        }
+        disp.hasFbComp = st.hasFbComp;
+        disp.hasOvComp = st.hasOvComp;
+    }
+    return true;
+}
+
+void HWComposer::runPrepareJob() {
+    ATRACE_CALL();
+    mPrepareError = hwcPrepare(mHwc, mNumDisplays, mLists);
+    if (mPrepareError == NO_ERROR) {
+        for (size_t i=0 ; i<mNumDisplays ; i++) {
+            DisplayData& disp(mDisplayData[i]);
+            if (disp.list) {
+                resolveCompositionTypes(disp.prepareList,
+                        i == DisplayDevice::DISPLAY_PRIMARY,
+                        &disp.prepareHasFbComp, &disp.prepareHasOvComp);
+            }
+        }
+    }
+}
+
+bool HWComposer::finishPrepare(int32_t id) {
+    if (!mPreparePending) {
+        return false;
+    }
+    mPreparePending = false;
+    mPrepareWorker->wait();
+
+    const int err = mPrepareError;
+    ALOGE_IF(err, "HWComposer: prepare failed (%s)", strerror(-err));
+
+    bool mismatch = false;
+    for (size_t i=0 ; i<mNumDisplays ; i++) {
+        DisplayData& disp(mDisplayData[i]);
+        mLists[i] = disp.list;
+        if (!disp.list || err != NO_ERROR) {
+            // on error keep going with the prediction, like prepare()
+            // keeps going with whatever was in the work-list
+            continue;
+        }
+        bool displayMismatch = (disp.hasFbComp != disp.prepareHasFbComp) ||
+                (disp.hasOvComp != disp.prepareHasOvComp);
+        for (size_t j=0 ; j<disp.list->numHwLayers ; j++) {
+            hwc_layer_1_t& l = disp.list->hwLayers[j];
+            const hwc_layer_1_t& r = disp.prepareList->hwLayers[j];
+            if (l.compositionType != r.compositionType || l.hints != r.hints) {
+                if (int32_t(i) == id && l.acquireFenceFd >= 0) {
+                    // this display has been composed already, the layer
+                    // will get a new fence (or none) when it's redone
+                    close(l.acquireFenceFd);
+                    l.acquireFenceFd = -1;
+                }
+                l.compositionType = r.compositionType;
+                l.hints = r.hints;
+                displayMismatch = true;
+            }
+        }
+        disp.hasFbComp = disp.prepareHasFbComp;
+        disp.hasOvComp = disp.prepareHasOvComp;
+        recordCompositionStrategy(disp);
+
+        if (displayMismatch) {
+            mPredictionMisses++;
+            if (int32_t(i) == id) {
+                mismatch = true;
+            }
+        } else {
+            mPredictionHits++;
+        }
+    }
+
+    if (mRetainWorkList) {
+        if (err == NO_ERROR) {
+            savePreparedState();
+        } else {
+            for (size_t i=0 ; i<mNumDisplays ; i++) {
+                invalidatePreparedState(i);
+            }
+        }
+    }
+    return mismatch;
+}
+
+void HWComposer::recordCompositionStrategy(DisplayData& disp) {
+    if (!disp.list) {
+        return;
+    }
+    const uint32_t signature = getCompositionSignature(disp.list);
+    const size_t numLayers = disp.list->numHwLayers;
+    CompositionStrategy st;
+    for (size_t j=0 ; j<disp.strategies.size() ; j++) {
+        if (disp.strategies[j].signature == signature) {
+            disp.strategies.removeAt(j);
+            break;
+        }
+    }
+    st.signature = signature;
+    st.numHwLayers = numLayers;
+    st.types.setCapacity(numLayers);
+    st.hints.setCapacity(numLayers);
+    for (size_t j=0 ; j<numLayers ; j++) {
+        const hwc_layer_1_t& l = disp.list->hwLayers[j];
+        st.types.add(l.compositionType);
+        st.hints.add(l.hints);
+    }
+    st.hasFbComp = disp.hasFbComp;
+    st.hasOvComp = disp.hasOvComp;
+    disp.strategies.insertAt(st, 0);
+    if (disp.strategies.size() > MAX_COMPOSITION_STRATEGIES) {
+        disp.strategies.removeAt(MAX_COMPOSITION_STRATEGIES);
+    }
+}
+
+bool HWComposer::canSkipPrepare() const {
+    if (!hwcHasApiVersion(mHwc, HWC_DEVICE_API_VERSION_1_0)) {
+        return false;
+    }
+    for (size_t i=0 ; i<mNumDisplays ; i++) {
+        const DisplayData& disp(mDisplayData[i]);
+        if (!disp.list) {
+            if (disp.preparedValid) {
+                // the display went away since the last prepare
+                return false;
+            }
+            continue;
+        }
+        if (!disp.preparedValid || disp.outbufHandle ||
+                (disp.list->flags & HWC_GEOMETRY_CHANGED) ||
+                disp.prepared.size() != disp.list->numHwLayers) {
+            return false;
+        }
+        for (size_t j=0 ; j<disp.list->numHwLayers ; j++) {
+            const hwc_layer_1_t& l = disp.list->hwLayers[j];
+            if (&l == disp.framebufferTarget) {
+                // its handle changes every time GLES composes, which
+                // doesn't affect the decisions taken in prepare()
+                continue;
+            }
+            const PreparedLayer& p(disp.prepared[j]);
+            if (l.handle != p.handle || l.flags != p.flags ||
+                    l.compositionType != p.compositionType) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void HWComposer::savePreparedState() {
+    if (!hwcHasApiVersion(mHwc, HWC_DEVICE_API_VERSION_1_0)) {
+        return;
+    }
+    for (size_t i=0 ; i<mNumDisplays ; i++) {
+        DisplayData& disp(mDisplayData[i]);
+        disp.prepared.clear();
+        disp.preparedValid = (disp.list != NULL);
+        if (disp.list) {
+            disp.prepared.setCapacity(disp.list->numHwLayers);
+            for (size_t j=0 ; j<disp.list->numHwLayers ; j++) {
+                const hwc_layer_1_t& l = disp.list->hwLayers[j];
+                PreparedLayer p;
+                p.handle = l.handle;
+                p.flags = l.flags;
+                p.compositionType = l.compositionType;
+                disp.prepared.add(p);
+            }
+        }
+    }
+}
+
+void HWComposer::invalidatePreparedState(int disp) {
+    mDisplayData[disp].preparedValid = false;
+    mDisplayData[disp].prepared.clear();
+}
+
 bool HWComposer::hasHwcComposition(int32_t id) const {
     if (!mHwc || uint32_t(id)>31 || !mAllocatedDisplayIDs.hasBit(id))
         return false;
@@ -852,6 +1231,21 @@ sp<Fence> HWComposer::getAndResetReleaseFence(int32_t id) {
 status_t HWComposer::commit() {
     int err = NO_ERROR;
     if (mHwc) {
+        if (hwcHasApiVersion(mHwc, HWC_DEVICE_API_VERSION_1_EXP)) {
+            // the output buffers must be in the work-list when set() is
+            // called, and they are only valid for this frame
+            for (size_t i=VIRTUAL_DISPLAY_ID_BASE; i<mNumDisplays; i++) {
+                DisplayData& disp(mDisplayData[i]);
+                if (disp.outbufHandle && mLists[i]) {
+                    mLists[i]->outbuf = disp.outbufHandle;
+                    mLists[i]->outbufAcquireFenceFd =
+                            disp.outbufAcquireFence->dup();
+                }
+                disp.outbufHandle = NULL;
+                disp.outbufAcquireFence = Fence::NO_FENCE;
+            }
+        }
+
         if (hwcHasApiVersion(mHwc, HWC_DEVICE_API_VERSION_1_0)) {
             if (!hwcHasApiVersion(mHwc, HWC_DEVICE_API_VERSION_1_1)) {
                 // On version 1.0, the OpenGL ES target surface is communicated
@@ -867,12 +1261,11 @@ status_t HWComposer::commit() {
                     const_cast<hwc_display_contents_1_t**>(mLists));
         }
 
-        for (size_t i=VIRTUAL_DISPLAY_ID_BASE; i<mNumDisplays; i++) {
-            DisplayData& disp(mDisplayData[i]);
-            if (disp.outbufHandle) {
-                mLists[i]->outbuf = disp.outbufHandle;
-                mLists[i]->outbufAcquireFenceFd =
-                        disp.outbufAcquireFence->dup();
+        if (err != NO_ERROR) {
+            // don't trust the composition types of a frame the HAL
+            // failed to take
+            for (size_t i=0 ; i<mNumDisplays ; i++) {
+                invalidatePreparedState(i);
             }
         }
 
@@ -900,6 +1293,7 @@ status_t HWComposer::release(int disp) {
         if (hwcHasVsyncEvent(mHwc)) {
             eventControl(disp, HWC_EVENT_VSYNC, 0);
         }
+        invalidatePreparedState(disp);
         return (status_t)hwcBlank(mHwc, disp, 1);
     }
     return NO_ERROR;
@@ -908,6 +1302,7 @@ status_t HWComposer::release(int disp) {
 status_t HWComposer::acquire(int disp) {
     LOG_FATAL_IF(disp >= VIRTUAL_DISPLAY_ID_BASE);
     if (mHwc) {
+        invalidatePreparedState(disp);
         return (status_t)hwcBlank(mHwc, disp, 0);
     }
     return NO_ERROR;
@@ -924,6 +1319,7 @@ void HWComposer::disconnectDisplay(int disp) {
     dd.lastRetireFence = Fence::NO_FENCE;
     dd.lastDisplayFence = Fence::NO_FENCE;
     dd.outbufAcquireFence = Fence::NO_FENCE;
+    invalidatePreparedState(disp);
 }
 
 int HWComposer::getVisualID() const {
@@ -942,6 +1338,10 @@ bool HWComposer::supportsFramebufferTarget() const {
     return (mHwc && hwcHasApiVersion(mHwc, HWC_DEVICE_API_VERSION_1_1));
 }
 
+bool HWComposer::supportsOutputBuffer() const {
+    return (mHwc && hwcHasApiVersion(mHwc, HWC_DEVICE_API_VERSION_1_EXP));
+}
+
 int HWComposer::fbPost(int32_t id,
         const sp<Fence>& acquireFence, const sp<GraphicBuffer>& buffer) {
     if (mHwc && hwcHasApiVersion(mHwc, HWC_DEVICE_API_VERSION_1_1)) {
@@ -1273,6 +1673,11 @@ void HWComposer::dump(String8& result, char* buffer, size_t SIZE) const {
     if (mHwc) {
         result.appendFormat("Hardware Composer state (version %8x):\n", hwcApiVersion(mHwc));
         result.appendFormat("  mDebugForceFakeVSync=%d\n", mDebugForceFakeVSync);
+        result.appendFormat("  mRetainWorkList=%d, prepare skipped %u/%u frames\n",
+                mRetainWorkList, mPrepareSkipCount, mPrepareCount);
+        result.appendFormat("  composition prediction %s: %u hits, %u misses, "
+                "%u unpredicted\n", mPrepareWorker != NULL ? "on" : "off",
+                mPredictionHits, mPredictionMisses, mPredictionUnavailable);
         for (size_t i=0 ; i<mNumDisplays ; i++) {
             const DisplayData& disp(mDisplayData[i]);
             if (!disp.connected)
@@ -1405,13 +1810,18 @@ HWComposer::DisplayData::DisplayData()
     hasFbComp(false), hasOvComp(false),
     capacity(0), list(NULL),
     framebufferTarget(NULL), fbTargetHandle(0),
+    fbTargetPostTime(0),
     lastRetireFence(Fence::NO_FENCE), lastDisplayFence(Fence::NO_FENCE),
     outbufHandle(NULL), outbufAcquireFence(Fence::NO_FENCE),
+    preparedValid(false),
+    prepareList(NULL), prepareCapacity(0),
+    prepareHasFbComp(false), prepareHasOvComp(false),
     events(0)
 {}
 
 HWComposer::DisplayData::~DisplayData() {
     free(list);
+    free(prepareList);
 }
 
 // ---------------------------------------------------------------------------
@@ -48,6 +48,7 @@ namespace android {
 class GraphicBuffer;
 class Fence;
 class Region;
+class WorkerPool;
 class String8;
 class SurfaceFlinger;
 
@@ -90,9 +91,26 @@ public:
     status_t freeDisplayId(int32_t id);
 
 
-    // Asks the HAL what it can do
+    // Asks the HAL what it can do. In retained work-list mode this is a
+    // no-op when no display changed since the last prepare, the composition
+    // types decided then are reused as is.
     status_t prepare();
 
+    // Same as prepare(), except that when the layers of every display were
+    // already seen recently, the composition types the HAL picked back then
+    // are applied right away and the HAL runs on the prepare thread, so
+    // that GLES composition can start without waiting for it.
+    // finishPrepare() must be called before the composition types are
+    // relied upon for good, and before commit().
+    status_t beginPrepare();
+
+    // waits for a prepare started by beginPrepare() and validates the
+    // predicted composition types. returns true if they were wrong for
+    // display id, in which case they have been corrected and whatever was
+    // composed with them must be redone. other displays are corrected
+    // silently. no-op when nothing is pending.
+    bool finishPrepare(int32_t id);
+
     // commits the list
     status_t commit();
 
@@ -110,6 +128,9 @@ public:
 
     bool supportsFramebufferTarget() const;
 
+    // can the HAL compose virtual displays into an output buffer
+    bool supportsOutputBuffer() const;
+
     // does this display have layers handled by HWC
     bool hasHwcComposition(int32_t id) const;
 
@@ -134,6 +155,7 @@ public:
 
     // Set the output buffer and acquire fence for a virtual display.
     // Returns INVALID_OPERATION if id is not a virtual display.
+    // The output buffer is only used for the next commit().
     status_t setOutputBuffer(int32_t id, const sp<Fence>& acquireFence,
             const sp<GraphicBuffer>& buf);
 
@@ -252,6 +274,9 @@ public:
     nsecs_t getRefreshPeriod(int disp) const;
     nsecs_t getRefreshTimestamp(int disp) const;
     sp<Fence> getDisplayFence(int disp) const;
+    // How long the GLES composition of the last framebuffer target took to
+    // finish after it was posted. Returns it once, 0 while it isn't known.
+    nsecs_t takeFramebufferTargetLatency(int disp);
     uint32_t getWidth(int disp) const;
     uint32_t getHeight(int disp) const;
     uint32_t getFormat(int disp) const;
@@ -303,10 +328,47 @@ private:
 
     status_t queryDisplayProperties(int disp);
 
+    // resets what prepare() expects in the work-lists and points mLists
+    // at them
+    void setUpListsForPrepare();
+
+    // composition strategy prediction helpers
+    bool predictComposition();
+    void runPrepareJob();
+    void recordCompositionStrategy(DisplayData& disp);
+
+    // retained work-list mode helpers
+    bool canSkipPrepare() const;
+    void savePreparedState();
+    void invalidatePreparedState(int disp);
+
     status_t setFramebufferTarget(int32_t id,
             const sp<Fence>& acquireFence, const sp<GraphicBuffer>& buf);
 
 
+    // what prepare() decided for a given set of layers, identified by a
+    // hash of the prepare() inputs except the buffer handles
+    struct CompositionStrategy {
+        uint32_t signature;
+        size_t numHwLayers;
+        Vector<int32_t> types;
+        Vector<uint32_t> hints;
+        bool hasFbComp;
+        bool hasOvComp;
+    };
+    enum { MAX_COMPOSITION_STRATEGIES = 4 };
+
+    class PrepareJob;
+    friend class PrepareJob;
+
+    // what prepare() depends on for a given layer of the work-list,
+    // as it was when the HAL last saw it
+    struct PreparedLayer {
+        buffer_handle_t handle;
+        uint32_t flags;
+        int32_t compositionType;
+    };
+
     struct DisplayData {
         DisplayData();
         ~DisplayData();
@@ -323,11 +385,25 @@ private:
         hwc_display_contents_1* list;
         hwc_layer_1* framebufferTarget;
         buffer_handle_t fbTargetHandle;
+        sp<Fence> fbTargetFence;    // acquire fence of the last one
+        nsecs_t fbTargetPostTime;
         sp<Fence> lastRetireFence;  // signals when the last set op retires
         sp<Fence> lastDisplayFence; // signals when the last set op takes
                                     // effect on screen
         buffer_handle_t outbufHandle;
         sp<Fence> outbufAcquireFence;
+        // snapshot of the work-list taken after the last successful prepare,
+        // only meaningful if preparedValid is set
+        Vector<PreparedLayer> prepared;
+        bool preparedValid;
+        // most recently used first
+        Vector<CompositionStrategy> strategies;
+        // copy of list handed to the HAL by beginPrepare(), and the
+        // results of that prepare() once finished
+        hwc_display_contents_1* prepareList;
+        size_t prepareCapacity;
+        bool prepareHasFbComp;
+        bool prepareHasOvComp;
 
         // protected by mEventControlLock
         int32_t events;
@@ -347,6 +423,16 @@ private:
     size_t                          mVSyncCount;
     sp<VSyncThread>                 mVSyncThread;
     bool                            mDebugForceFakeVSync;
+    bool                            mRetainWorkList;
+    size_t                          mPrepareCount;
+    size_t                          mPrepareSkipCount;
+    sp<WorkerPool>                  mPrepareWorker;
+    PrepareJob*                     mPrepareJob;
+    bool                            mPreparePending;
+    int                             mPrepareError;
+    size_t                          mPredictionHits;
+    size_t                          mPredictionMisses;
+    size_t                          mPredictionUnavailable;
     BitSet32                        mAllocatedDisplayIDs;
 
     // protected by mLock
@@ -25,7 +25,11 @@
 namespace android {
 // ---------------------------------------------------------------------------
 
-PowerHAL::PowerHAL() : mPowerModule(0), mVSyncHintEnabled(false) {
+// refresh periods a boost lasts, per level
+static const int FRAME_BOOST_PERIODS = 4;
+
+PowerHAL::PowerHAL() : mPowerModule(0), mVSyncHintEnabled(false),
+        mFrameBoostLevel(0), mFrameBoostEnd(0) {
     int err = hw_get_module(POWER_HARDWARE_MODULE_ID,
             (const hw_module_t **)&mPowerModule);
     ALOGW_IF(err, "%s module not found", POWER_HARDWARE_MODULE_ID);
@@ -54,6 +58,35 @@ status_t PowerHAL::vsyncHint(bool enabled) {
     return NO_ERROR;
 }
 
+status_t PowerHAL::frameBoostHint(int level, nsecs_t refreshPeriod) {
+    if (!mPowerModule) {
+        return NO_INIT;
+    }
+    if (mPowerModule->common.module_api_version < POWER_MODULE_API_VERSION_0_2 ||
+            !mPowerModule->powerHint) {
+        return INVALID_OPERATION;
+    }
+    if (level > MAX_FRAME_BOOST) {
+        level = MAX_FRAME_BOOST;
+    }
+    const nsecs_t now = systemTime();
+    if (level <= 0) {
+        mFrameBoostLevel = 0;
+        return NO_ERROR;
+    }
+    // don't flood the HAL, only ask again for a stronger boost or when
+    // the current one is about to end
+    if (level > mFrameBoostLevel || now + refreshPeriod >= mFrameBoostEnd) {
+        const nsecs_t duration = refreshPeriod * FRAME_BOOST_PERIODS * level;
+        int durationMs = int(ns2ms(duration));
+        mPowerModule->powerHint(mPowerModule,
+                POWER_HINT_INTERACTION, &durationMs);
+        mFrameBoostEnd = now + duration;
+    }
+    mFrameBoostLevel = level;
+    return NO_ERROR;
+}
+
 // ---------------------------------------------------------------------------
 }; // namespace android
 
@@ -20,6 +20,8 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <utils/Timers.h>
+
 #include <hardware/power.h>
 
 namespace android {
@@ -34,9 +36,19 @@ public:
     status_t initCheck() const;
     status_t vsyncHint(bool enabled);
 
+    // Tells how close frames are to missing their deadline, from 0 (not
+    // at all) to MAX_FRAME_BOOST (they are missing it). Levels above 0
+    // are sent as POWER_HINT_INTERACTION boosts lasting a few refresh
+    // periods per level, renewed while the level stays up; level 0 lets
+    // the current boost run out.
+    enum { MAX_FRAME_BOOST = 3 };
+    status_t frameBoostHint(int level, nsecs_t refreshPeriod);
+
 private:
     power_module_t*   mPowerModule;
     bool mVSyncHintEnabled;
+    int mFrameBoostLevel;
+    nsecs_t mFrameBoostEnd;
 };
 
 // ---------------------------------------------------------------------------
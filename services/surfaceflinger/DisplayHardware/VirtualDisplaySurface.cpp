@@ -15,9 +15,19 @@
  */
 
 #include "VirtualDisplaySurface.h"
+#include "HWComposer.h"
 
 #include <cutils/log.h>
+
+#include <hardware/hardware.h>
+#include <gui/GraphicBufferAlloc.h>
 #include <gui/IGraphicBufferProducer.h>
+#include <gui/Surface.h>
+#include <ui/GraphicBuffer.h>
+
+#ifndef NUM_VIRTUAL_DISPLAY_SURFACE_BUFFERS
+#define NUM_VIRTUAL_DISPLAY_SURFACE_BUFFERS (2)
+#endif
 
 // ---------------------------------------------------------------------------
 namespace android {
@@ -25,13 +35,73 @@ namespace android {
 
 VirtualDisplaySurface::VirtualDisplaySurface(HWComposer& hwc, int32_t dispId,
         const sp<IGraphicBufferProducer>& sink, const String8& name)
-:   mSink(sink){
+:   ConsumerBase(new BufferQueue(true, new GraphicBufferAlloc())),
+    mHwc(hwc),
+    mDisplayId(dispId),
+    mDisplayName(name),
+    mSink(sink),
+    mCurrentBufferSlot(BufferQueue::INVALID_BUFFER_SLOT),
+    mCurrentFence(Fence::NO_FENCE),
+    mOutputBuffer(NULL),
+    mFramesComposed(0),
+    mFramesDropped(0)
+{
+    mName = "VirtualDisplaySurface";
+    mBufferQueue->setConsumerName(mName);
+
+    if (mDisplayId < 0 || !mHwc.supportsOutputBuffer()) {
+        // GLES renders to the sink directly
+        return;
+    }
+
+    int sinkWidth, sinkHeight, sinkFormat;
+    mSink->query(NATIVE_WINDOW_WIDTH, &sinkWidth);
+    mSink->query(NATIVE_WINDOW_HEIGHT, &sinkHeight);
+    mSink->query(NATIVE_WINDOW_FORMAT, &sinkFormat);
+
+    // the sink sees the same producer API it saw when GLES rendered
+    // into it directly
+    sp<Surface> sinkWindow(new Surface(mSink));
+    ANativeWindow* const window = sinkWindow.get();
+    status_t err = native_window_api_connect(window, NATIVE_WINDOW_API_EGL);
+    if (err != NO_ERROR) {
+        ALOGE("[%s] couldn't connect to the sink: %s (%d), "
+                "falling back to GLES", mDisplayName.string(),
+                strerror(-err), err);
+        return;
+    }
+    native_window_set_usage(window, GRALLOC_USAGE_HW_COMPOSER);
+    window->setSwapInterval(window, 1);
+    mSinkWindow = sinkWindow;
+
+    mHwc.setVirtualDisplayProperties(mDisplayId,
+            sinkWidth, sinkHeight, sinkFormat);
+
+    // GLES composes the layers the HWC rejects into the scratch buffers,
+    // which are used as the framebuffer target
+    mBufferQueue->setConsumerUsageBits(GRALLOC_USAGE_HW_RENDER |
+                                       GRALLOC_USAGE_HW_COMPOSER);
+    mBufferQueue->setDefaultBufferFormat(sinkFormat);
+    mBufferQueue->setDefaultBufferSize(sinkWidth, sinkHeight);
+    mBufferQueue->setSynchronousMode(true);
+    mBufferQueue->setDefaultMaxBufferCount(NUM_VIRTUAL_DISPLAY_SURFACE_BUFFERS);
 }
 
 VirtualDisplaySurface::~VirtualDisplaySurface() {
+    if (mSinkWindow != NULL) {
+        ANativeWindow* const window = mSinkWindow.get();
+        if (mOutputBuffer) {
+            window->cancelBuffer(window, mOutputBuffer, -1);
+            mOutputBuffer = NULL;
+        }
+        native_window_api_disconnect(window, NATIVE_WINDOW_API_EGL);
+    }
 }
 
 sp<IGraphicBufferProducer> VirtualDisplaySurface::getIGraphicBufferProducer() const {
+    if (mSinkWindow != NULL) {
+        return getBufferQueue();
+    }
     return mSink;
 }
 
@@ -39,14 +109,127 @@ status_t VirtualDisplaySurface::compositionComplete() {
     return NO_ERROR;
 }
 
+status_t VirtualDisplaySurface::nextFramebufferLocked() {
+    BufferQueue::BufferItem item;
+    status_t err = acquireBufferLocked(&item, 0);
+    if (err == BufferQueue::NO_BUFFER_AVAILABLE) {
+        // GLES didn't compose this frame
+        return NO_ERROR;
+    } else if (err != NO_ERROR) {
+        ALOGE("error acquiring buffer: %s (%d)", strerror(-err), err);
+        return err;
+    }
+
+    // see FramebufferSurface::nextBuffer()
+    if (mCurrentBufferSlot != BufferQueue::INVALID_BUFFER_SLOT &&
+        item.mBuf != mCurrentBufferSlot) {
+        // Release the previous buffer.
+        err = releaseBufferLocked(mCurrentBufferSlot, EGL_NO_DISPLAY,
+                EGL_NO_SYNC_KHR);
+        if (err != NO_ERROR && err != BufferQueue::STALE_BUFFER_SLOT) {
+            ALOGE("error releasing buffer: %s (%d)", strerror(-err), err);
+            return err;
+        }
+    }
+    mCurrentBufferSlot = item.mBuf;
+    mCurrentBuffer = mSlots[mCurrentBufferSlot].mGraphicBuffer;
+    mCurrentFence = item.mFence;
+    return mHwc.fbPost(mDisplayId, mCurrentFence, mCurrentBuffer);
+}
+
 status_t VirtualDisplaySurface::advanceFrame() {
-    return NO_ERROR;
+    if (mSinkWindow == NULL) {
+        return NO_ERROR;
+    }
+
+    Mutex::Autolock lock(mMutex);
+    status_t err = nextFramebufferLocked();
+    if (err != NO_ERROR) {
+        return err;
+    }
+
+    ANativeWindow* const window = mSinkWindow.get();
+    if (mOutputBuffer) {
+        // the previous frame was never committed, reuse its buffer
+        return NO_ERROR;
+    }
+
+    int fenceFd = -1;
+    err = window->dequeueBuffer(window, &mOutputBuffer, &fenceFd);
+    if (err != NO_ERROR) {
+        ALOGE("[%s] error dequeuing a sink buffer: %s (%d)",
+                mDisplayName.string(), strerror(-err), err);
+        mOutputBuffer = NULL;
+        mFramesDropped++;
+        return err;
+    }
+
+    sp<GraphicBuffer> buf(static_cast<GraphicBuffer*>(mOutputBuffer));
+    sp<Fence> fence(new Fence(fenceFd));
+    err = mHwc.setOutputBuffer(mDisplayId, fence, buf);
+    if (err != NO_ERROR) {
+        window->cancelBuffer(window, mOutputBuffer, fence->dup());
+        mOutputBuffer = NULL;
+        mFramesDropped++;
+    }
+    return err;
 }
 
 void VirtualDisplaySurface::onFrameCommitted() {
+    if (mSinkWindow == NULL) {
+        return;
+    }
+
+    Mutex::Autolock lock(mMutex);
+    sp<Fence> fence = mHwc.getAndResetReleaseFence(mDisplayId);
+    if (fence->isValid() &&
+            mCurrentBufferSlot != BufferQueue::INVALID_BUFFER_SLOT) {
+        status_t err = addReleaseFenceLocked(mCurrentBufferSlot, fence);
+        ALOGE_IF(err, "setReleaseFenceFd: failed to add the fence: %s (%d)",
+                strerror(-err), err);
+    }
+
+    if (mOutputBuffer) {
+        // the retire fence signals when the HWC is done writing the
+        // output buffer
+        sp<Fence> retireFence = mHwc.getLastRetireFence(mDisplayId);
+        ANativeWindow* const window = mSinkWindow.get();
+        status_t err = window->queueBuffer(window, mOutputBuffer,
+                retireFence->dup());
+        if (err != NO_ERROR) {
+            ALOGE("[%s] error queuing a sink buffer: %s (%d)",
+                    mDisplayName.string(), strerror(-err), err);
+            mFramesDropped++;
+        } else {
+            mFramesComposed++;
+        }
+        mOutputBuffer = NULL;
+    }
+}
+
+void VirtualDisplaySurface::freeBufferLocked(int slotIndex) {
+    ConsumerBase::freeBufferLocked(slotIndex);
+    if (slotIndex == mCurrentBufferSlot) {
+        mCurrentBufferSlot = BufferQueue::INVALID_BUFFER_SLOT;
+    }
 }
 
+// see FramebufferSurface::dump()
 void VirtualDisplaySurface::dump(String8& result) const {
+    ConsumerBase::dump(result);
+}
+
+void VirtualDisplaySurface::dumpLocked(String8& result, const char* prefix,
+            char* buffer, size_t SIZE) const
+{
+    snprintf(buffer, SIZE, "%s[%s] HWC output %s, frames composed=%u, "
+            "dropped=%u\n", prefix, mDisplayName.string(),
+            mSinkWindow != NULL ? "on" : "off",
+            mFramesComposed, mFramesDropped);
+    result.append(buffer);
+    if (mSinkWindow != NULL) {
+        ConsumerBase::dumpLocked(result, prefix, buffer, SIZE);
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -17,6 +17,8 @@
 #ifndef ANDROID_SF_VIRTUAL_DISPLAY_SURFACE_H
 #define ANDROID_SF_VIRTUAL_DISPLAY_SURFACE_H
 
+#include <gui/ConsumerBase.h>
+
 #include "DisplaySurface.h"
 
 // ---------------------------------------------------------------------------
@@ -24,11 +26,23 @@ namespace android {
 // ---------------------------------------------------------------------------
 
 class HWComposer;
+class Surface;
 
-/* This DisplaySurface implementation is a stub used for developing HWC
- * virtual display support. It is currently just a passthrough.
+/* VirtualDisplaySurface lets the hardware composer write the frames of a
+ * virtual display straight into the buffers of the sink.
+ *
+ * When the HWC supports output buffers, GLES renders into a scratch
+ * BufferQueue owned by this class, which is used as the framebuffer target,
+ * and a buffer is dequeued from the sink every frame and given to the HWC
+ * as the output buffer. Layers the HWC composes never go through GLES, and
+ * GLES only renders the layers the HWC rejects. Once the frame is
+ * committed, the output buffer is queued to the sink with the retire fence.
+ *
+ * Otherwise (or if no HWC display could be allocated) GLES renders to the
+ * sink directly, this class is then just a passthrough.
  */
-class VirtualDisplaySurface : public DisplaySurface {
+class VirtualDisplaySurface : public ConsumerBase,
+                              public DisplaySurface {
 public:
     VirtualDisplaySurface(HWComposer& hwc, int32_t dispId,
             const sp<IGraphicBufferProducer>& sink,
@@ -39,12 +53,44 @@ public:
     virtual status_t compositionComplete();
     virtual status_t advanceFrame();
     virtual void onFrameCommitted();
+
+    // Implementation of DisplaySurface::dump(). Note that ConsumerBase also
+    // has a non-virtual dump() with the same signature.
     virtual void dump(String8& result) const;
 
 private:
     virtual ~VirtualDisplaySurface();
 
+    virtual void freeBufferLocked(int slotIndex);
+
+    virtual void dumpLocked(String8& result, const char* prefix,
+            char* buffer, size_t SIZE) const;
+
+    // latches the last frame GLES queued to the scratch BufferQueue, if
+    // any, and releases the previous one
+    status_t nextFramebufferLocked();
+
+    // Hardware composer, owned by SurfaceFlinger.
+    HWComposer& mHwc;
+    const int32_t mDisplayId;
+    const String8 mDisplayName;
+
     sp<IGraphicBufferProducer> mSink;
+
+    // the sink as seen by the HWC, NULL when GLES renders to the sink
+    sp<Surface> mSinkWindow;
+
+    // current framebuffer target, from the scratch BufferQueue
+    int mCurrentBufferSlot;
+    sp<GraphicBuffer> mCurrentBuffer;
+    sp<Fence> mCurrentFence;
+
+    // sink buffer the HWC composes the current frame into, NULL if none
+    // was dequeued for this frame
+    ANativeWindowBuffer* mOutputBuffer;
+
+    uint32_t mFramesComposed;
+    uint32_t mFramesDropped;
 };
 
 // ---------------------------------------------------------------------------
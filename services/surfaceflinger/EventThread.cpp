@@ -24,6 +24,7 @@
 #include <gui/BitTube.h>
 #include <gui/IDisplayEventConnection.h>
 #include <gui/DisplayEventReceiver.h>
+#include <gui/SharedVSync.h>
 
 #include <utils/Errors.h>
 #include <utils/String8.h>
@@ -36,9 +37,11 @@
 namespace android {
 // ---------------------------------------------------------------------------
 
-EventThread::EventThread(const sp<SurfaceFlinger>& flinger)
-    : mFlinger(flinger),
+EventThread::EventThread(const sp<VSyncSource>& src)
+    : mVSyncSource(src),
+      mSharedVSync(new SharedVSync()),
       mUseSoftwareVSync(false),
+      mVsyncEnabled(false),
       mDebugVsyncEnabled(false) {
 
     for (int32_t i=0 ; i<HWC_NUM_DISPLAY_TYPES ; i++) {
@@ -75,6 +78,9 @@ void EventThread::setVsyncRate(uint32_t count,
         const sp<EventThread::Connection>& connection) {
     if (int32_t(count) >= 0) { // server must protect against bad params
         Mutex::Autolock _l(mLock);
+        if (connection->schedulePeriod) {
+            unscheduleLocked(connection);
+        }
         const int32_t new_count = (count == 0) ? -1 : count;
         if (connection->count != new_count) {
             connection->count = new_count;
@@ -92,11 +98,50 @@ void EventThread::requestNextVsync(
     }
 }
 
+status_t EventThread::setVsyncSchedule(nsecs_t period, nsecs_t phase,
+        const sp<EventThread::Connection>& connection) {
+    // server must protect against bad params
+    if (period < 0 || (period && (phase < 0 || phase >= period))) {
+        return BAD_VALUE;
+    }
+    Mutex::Autolock _l(mLock);
+    if (connection->schedulePeriod) {
+        unscheduleLocked(connection);
+    }
+    if (period) {
+        connection->count = -1;
+        connection->schedulePeriod = period;
+        connection->schedulePhase = phase;
+        connection->scheduledVSync = 0;
+        scheduleLocked(connection, systemTime(SYSTEM_TIME_MONOTONIC));
+    }
+    mCondition.broadcast();
+    return NO_ERROR;
+}
+
+sp<SharedVSync> EventThread::useSharedVSync(
+        const sp<EventThread::Connection>& connection) {
+    if (mSharedVSync->initCheck() != NO_ERROR) {
+        return NULL;
+    }
+    Mutex::Autolock _l(mLock);
+    if (connection->sharedVSync == NULL) {
+        connection->sharedVSync = mSharedVSync->acquireSlot();
+    }
+    return connection->sharedVSync;
+}
+
 void EventThread::onScreenReleased() {
     Mutex::Autolock _l(mLock);
     if (!mUseSoftwareVSync) {
         // disable reliance on h/w vsync
         mUseSoftwareVSync = true;
+        if (mVsyncEnabled) {
+            // the vsync model can't be trusted while the screen is off
+            mVsyncEnabled = false;
+            mVSyncSource->setVSyncEnabled(false);
+            mPowerHAL.vsyncHint(false);
+        }
         mCondition.broadcast();
     }
 }
@@ -111,18 +156,14 @@ void EventThread::onScreenAcquired() {
 }
 
 
-void EventThread::onVSyncReceived(int type, nsecs_t timestamp) {
-    ALOGE_IF(type >= HWC_NUM_DISPLAY_TYPES,
-            "received vsync event for an invalid display (id=%d)", type);
-
+void EventThread::onVSyncEvent(nsecs_t timestamp) {
     Mutex::Autolock _l(mLock);
-    if (type < HWC_NUM_DISPLAY_TYPES) {
-        mVSyncEvent[type].header.type = DisplayEventReceiver::DISPLAY_EVENT_VSYNC;
-        mVSyncEvent[type].header.id = type;
-        mVSyncEvent[type].header.timestamp = timestamp;
-        mVSyncEvent[type].vsync.count++;
-        mCondition.broadcast();
-    }
+    // the vsync sources only track the main display
+    mVSyncEvent[0].header.type = DisplayEventReceiver::DISPLAY_EVENT_VSYNC;
+    mVSyncEvent[0].header.id = HWC_DISPLAY_PRIMARY;
+    mVSyncEvent[0].header.timestamp = timestamp;
+    mVSyncEvent[0].vsync.count++;
+    mCondition.broadcast();
 }
 
 void EventThread::onHotplugReceived(int type, bool connected) {
@@ -144,7 +185,14 @@ void EventThread::onHotplugReceived(int type, bool connected) {
 bool EventThread::threadLoop() {
     DisplayEventReceiver::Event event;
     Vector< sp<EventThread::Connection> > signalConnections;
-    signalConnections = waitForEvent(&event);
+    Vector<int32_t> sharedSlots;
+    Vector< sp<EventThread::Connection> > sharedConnections;
+    signalConnections = waitForEvent(&event, &sharedSlots, &sharedConnections);
+
+    // a single write and wake-up for all the connections on the shared
+    // page. sharedConnections keeps their slots from being reused until
+    // then.
+    mSharedVSync->publish(event, sharedSlots);
 
     // dispatch events to listeners...
     const size_t count = signalConnections.size();
@@ -173,7 +221,8 @@ bool EventThread::threadLoop() {
 // This will return when (1) a vsync event has been received, and (2) there was
 // at least one connection interested in receiving it when we started waiting.
 Vector< sp<EventThread::Connection> > EventThread::waitForEvent(
-        DisplayEventReceiver::Event* event)
+        DisplayEventReceiver::Event* event, Vector<int32_t>* sharedSlots,
+        Vector< sp<EventThread::Connection> >* sharedConnections)
 {
     Mutex::Autolock _l(mLock);
     Vector< sp<EventThread::Connection> > signalConnections;
@@ -205,6 +254,14 @@ Vector< sp<EventThread::Connection> > EventThread::waitForEvent(
             }
         }
 
+        bool scheduledDue = false;
+        if (!timestamp && !eventPending) {
+            // the connections on a schedule don't depend on vsync being
+            // enabled, see if some are due
+            scheduledDue = gatherScheduledLocked(
+                    systemTime(SYSTEM_TIME_MONOTONIC), event, &signalConnections);
+        }
+
         // find out connections waiting for events
         size_t count = mDisplayEventConnections.size();
         for (size_t i=0 ; i<count ; i++) {
@@ -262,9 +319,19 @@ Vector< sp<EventThread::Connection> > EventThread::waitForEvent(
         }
 
         // note: !timestamp implies signalConnections.isEmpty(), because we
-        // don't populate signalConnections if there's no vsync pending
-        if (!timestamp && !eventPending) {
-            // wait for something to happen
+        // don't populate signalConnections if there's no vsync pending,
+        // unless some scheduled connections are due
+        if (!timestamp && !eventPending && !scheduledDue) {
+            // wait for something to happen, but not past the first
+            // scheduled connection's deadline
+            nsecs_t scheduleTimeout = -1;
+            if (!mScheduledConnections.isEmpty()) {
+                scheduleTimeout = mScheduledConnections[0].deadline -
+                        systemTime(SYSTEM_TIME_MONOTONIC);
+                if (scheduleTimeout < 0) {
+                    scheduleTimeout = 0;
+                }
+            }
             if (waitForVSync) {
                 // This is where we spend most of our time, waiting
                 // for vsync events and new client registrations.
@@ -278,7 +345,10 @@ Vector< sp<EventThread::Connection> > EventThread::waitForEvent(
                 // generate fake events when necessary.
                 bool softwareSync = mUseSoftwareVSync;
                 nsecs_t timeout = softwareSync ? ms2ns(16) : ms2ns(1000);
-                if (mCondition.waitRelative(mLock, timeout) == TIMED_OUT) {
+                if (scheduleTimeout >= 0 && scheduleTimeout < timeout) {
+                    // a scheduled connection is due before that
+                    mCondition.waitRelative(mLock, scheduleTimeout);
+                } else if (mCondition.waitRelative(mLock, timeout) == TIMED_OUT) {
                     if (!softwareSync) {
                         ALOGW("Timed out waiting for hw vsync; faking it");
                     }
@@ -289,6 +359,10 @@ Vector< sp<EventThread::Connection> > EventThread::waitForEvent(
                     mVSyncEvent[0].header.timestamp = systemTime(SYSTEM_TIME_MONOTONIC);
                     mVSyncEvent[0].vsync.count++;
                 }
+            } else if (scheduleTimeout >= 0) {
+                // Only connections on a schedule, vsync stays off and we
+                // sleep until the first one is due.
+                mCondition.waitRelative(mLock, scheduleTimeout);
             } else {
                 // Nobody is interested in vsync, so we just want to sleep.
                 // h/w vsync should be disabled, so this will wait until we
@@ -299,6 +373,20 @@ Vector< sp<EventThread::Connection> > EventThread::waitForEvent(
         }
     } while (signalConnections.isEmpty());
 
+    // the connections on the shared page get the vsync from there
+    if (event->header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC) {
+        for (size_t i=0 ; i<signalConnections.size() ; ) {
+            const sp<Connection>& connection(signalConnections[i]);
+            if (connection->sharedVSync != NULL) {
+                sharedSlots->add(connection->sharedVSync->getSlot());
+                sharedConnections->add(connection);
+                signalConnections.removeAt(i);
+            } else {
+                i++;
+            }
+        }
+    }
+
     // here we're guaranteed to have a timestamp and some connections to signal
     // (The connections might have dropped out of mDisplayEventConnections
     // while we were asleep, but we'll still have strong references to them.)
@@ -308,18 +396,103 @@ Vector< sp<EventThread::Connection> > EventThread::waitForEvent(
 void EventThread::enableVSyncLocked() {
     if (!mUseSoftwareVSync) {
         // never enable h/w VSYNC when screen is off
-        mFlinger->eventControl(HWC_DISPLAY_PRIMARY, SurfaceFlinger::EVENT_VSYNC, true);
-        mPowerHAL.vsyncHint(true);
+        if (!mVsyncEnabled) {
+            mVsyncEnabled = true;
+            mVSyncSource->setCallback(static_cast<VSyncSource::Callback*>(this));
+            mVSyncSource->setVSyncEnabled(true);
+            mPowerHAL.vsyncHint(true);
+        }
     }
     mDebugVsyncEnabled = true;
 }
 
 void EventThread::disableVSyncLocked() {
-    mFlinger->eventControl(HWC_DISPLAY_PRIMARY, SurfaceFlinger::EVENT_VSYNC, false);
-    mPowerHAL.vsyncHint(false);
+    if (mVsyncEnabled) {
+        mVsyncEnabled = false;
+        mVSyncSource->setVSyncEnabled(false);
+        mPowerHAL.vsyncHint(false);
+    }
     mDebugVsyncEnabled = false;
 }
 
+// Queues a connection on its schedule: its next event is aligned on the
+// vsync closest to one period after the last one, shifted by its phase.
+void EventThread::scheduleLocked(const sp<EventThread::Connection>& connection,
+        nsecs_t now) {
+    nsecs_t target = connection->scheduledVSync ?
+            connection->scheduledVSync + connection->schedulePeriod : now;
+    if (target < now) {
+        // we're late, don't try to catch up
+        target = now;
+    }
+
+    nsecs_t vsync = 0;
+    const nsecs_t refresh = mVSyncSource->getPeriod();
+    if (refresh > 0) {
+        vsync = mVSyncSource->computeNextEventTime(target - refresh / 2);
+    }
+    if (vsync == 0) {
+        // no vsync model yet, just use a timer
+        vsync = target;
+    } else {
+        while (vsync + connection->schedulePhase < now) {
+            vsync += refresh;
+        }
+    }
+    connection->scheduledVSync = vsync;
+
+    ScheduledConnection sc;
+    sc.deadline = vsync + connection->schedulePhase;
+    sc.connection = connection;
+    size_t i = mScheduledConnections.size();
+    while (i > 0 && mScheduledConnections[i-1].deadline > sc.deadline) {
+        i--;
+    }
+    mScheduledConnections.insertAt(sc, i);
+}
+
+void EventThread::unscheduleLocked(const sp<EventThread::Connection>& connection) {
+    const wp<Connection> weak(connection);
+    for (size_t i=0 ; i<mScheduledConnections.size() ; i++) {
+        if (mScheduledConnections[i].connection == weak) {
+            mScheduledConnections.removeAt(i);
+            break;
+        }
+    }
+    connection->schedulePeriod = 0;
+}
+
+// Moves the scheduled connections due by now to signalConnections and
+// queues them again for their next event. Returns true if there were any.
+bool EventThread::gatherScheduledLocked(nsecs_t now,
+        DisplayEventReceiver::Event* event,
+        Vector< sp<EventThread::Connection> >* signalConnections) {
+    while (!mScheduledConnections.isEmpty() &&
+            mScheduledConnections[0].deadline <= now) {
+        sp<Connection> connection(mScheduledConnections[0].connection.promote());
+        mScheduledConnections.removeAt(0);
+        if (connection == NULL) {
+            // the connection died, it's already gone from
+            // mDisplayEventConnections or will be soon
+            continue;
+        }
+        if (signalConnections->isEmpty()) {
+            event->header.type = DisplayEventReceiver::DISPLAY_EVENT_VSYNC;
+            event->header.id = HWC_DISPLAY_PRIMARY;
+            event->header.timestamp = connection->scheduledVSync;
+            event->vsync.count = mVSyncEvent[0].vsync.count;
+        }
+        signalConnections->add(connection);
+    }
+
+    // only now, so that a connection can't be due twice in a row
+    const size_t count = signalConnections->size();
+    for (size_t i=0 ; i<count ; i++) {
+        scheduleLocked(signalConnections->itemAt(i), now);
+    }
+    return count > 0;
+}
+
 void EventThread::dump(String8& result, char* buffer, size_t SIZE) const {
     Mutex::Autolock _l(mLock);
     result.appendFormat("VSYNC state: %s\n",
@@ -332,8 +505,15 @@ void EventThread::dump(String8& result, char* buffer, size_t SIZE) const {
     for (size_t i=0 ; i<mDisplayEventConnections.size() ; i++) {
         sp<Connection> connection =
                 mDisplayEventConnections.itemAt(i).promote();
-        result.appendFormat("    %p: count=%d\n",
-                connection.get(), connection!=NULL ? connection->count : 0);
+        result.appendFormat("    %p: count=%d%s",
+                connection.get(), connection!=NULL ? connection->count : 0,
+                connection!=NULL && connection->sharedVSync!=NULL ? " (shared)" : "");
+        if (connection != NULL && connection->schedulePeriod) {
+            result.appendFormat(" schedule=%.2f Hz +%.3f ms",
+                    1e9 / connection->schedulePeriod,
+                    connection->schedulePhase / 1e6);
+        }
+        result.append("\n");
     }
 }
 
@@ -341,7 +521,9 @@ void EventThread::dump(String8& result, char* buffer, size_t SIZE) const {
 
 EventThread::Connection::Connection(
         const sp<EventThread>& eventThread)
-    : count(-1), mEventThread(eventThread), mChannel(new BitTube())
+    : count(-1),
+      schedulePeriod(0), schedulePhase(0), scheduledVSync(0),
+      mEventThread(eventThread), mChannel(new BitTube())
 {
 }
 
@@ -359,6 +541,10 @@ sp<BitTube> EventThread::Connection::getDataChannel() const {
     return mChannel;
 }
 
+sp<SharedVSync> EventThread::Connection::getSharedVSync() {
+    return mEventThread->useSharedVSync(this);
+}
+
 void EventThread::Connection::setVsyncRate(uint32_t count) {
     mEventThread->setVsyncRate(count, this);
 }
@@ -367,6 +553,10 @@ void EventThread::Connection::requestNextVsync() {
     mEventThread->requestNextVsync(this);
 }
 
+status_t EventThread::Connection::setVsyncSchedule(nsecs_t period, nsecs_t phase) {
+    return mEventThread->setVsyncSchedule(period, phase, this);
+}
+
 status_t EventThread::Connection::postEvent(
         const DisplayEventReceiver::Event& event) {
     ssize_t size = DisplayEventReceiver::sendEvents(mChannel, &event, 1);
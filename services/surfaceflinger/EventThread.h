@@ -22,6 +22,7 @@
 
 #include <gui/DisplayEventReceiver.h>
 #include <gui/IDisplayEventConnection.h>
+#include <gui/SharedVSync.h>
 
 #include <hardware/hwcomposer_defs.h>
 
@@ -40,7 +41,29 @@ class String8;
 
 // ---------------------------------------------------------------------------
 
-class EventThread : public Thread {
+/*
+ * Where an EventThread gets its vsync events from. The source is only
+ * enabled while the EventThread has clients waiting for vsync.
+ */
+class VSyncSource : public virtual RefBase {
+public:
+    class Callback : public virtual RefBase {
+    public:
+        virtual ~Callback() { }
+        virtual void onVSyncEvent(nsecs_t when) = 0;
+    };
+
+    virtual ~VSyncSource() { }
+    virtual void setVSyncEnabled(bool enable) = 0;
+    virtual void setCallback(const sp<Callback>& callback) = 0;
+
+    // the refresh period, and the time of the first event after now the
+    // source would fire if it was enabled; 0 when they aren't known
+    virtual nsecs_t getPeriod() const = 0;
+    virtual nsecs_t computeNextEventTime(nsecs_t now) const = 0;
+};
+
+class EventThread : public Thread, private VSyncSource::Callback {
     class Connection : public BnDisplayEventConnection {
     public:
         Connection(const sp<EventThread>& eventThread);
@@ -51,25 +74,41 @@ class EventThread : public Thread {
         // count ==-1 : one-shot event that fired this round / disabled
         int32_t count;
 
+        // the client's slot on the shared page, once it reads vsync events
+        // from there. They're not sent to its BitTube anymore then.
+        sp<SharedVSync> sharedVSync;
+
+        // schedulePeriod > 0 : on a schedule, see setVsyncSchedule(),
+        // count is -1 then. scheduledVSync is the vsync the next (or
+        // last) scheduled event is aligned on.
+        nsecs_t schedulePeriod;
+        nsecs_t schedulePhase;
+        nsecs_t scheduledVSync;
+
     private:
         virtual ~Connection();
         virtual void onFirstRef();
         virtual sp<BitTube> getDataChannel() const;
+        virtual sp<SharedVSync> getSharedVSync();
         virtual void setVsyncRate(uint32_t count);
         virtual void requestNextVsync();    // asynchronous
+        virtual status_t setVsyncSchedule(nsecs_t period, nsecs_t phase);
         sp<EventThread> const mEventThread;
         sp<BitTube> const mChannel;
     };
 
 public:
 
-    EventThread(const sp<SurfaceFlinger>& flinger);
+    EventThread(const sp<VSyncSource>& src);
 
     sp<Connection> createEventConnection() const;
     status_t registerDisplayEventConnection(const sp<Connection>& connection);
 
     void setVsyncRate(uint32_t count, const sp<Connection>& connection);
     void requestNextVsync(const sp<Connection>& connection);
+    sp<SharedVSync> useSharedVSync(const sp<Connection>& connection);
+    status_t setVsyncSchedule(nsecs_t period, nsecs_t phase,
+            const sp<Connection>& connection);
 
     // called before the screen is turned off from main thread
     void onScreenReleased();
@@ -77,26 +116,38 @@ public:
     // called after the screen is turned on from main thread
     void onScreenAcquired();
 
-    // called when receiving a vsync event
-    void onVSyncReceived(int type, nsecs_t timestamp);
     void onHotplugReceived(int type, bool connected);
 
     Vector< sp<EventThread::Connection> > waitForEvent(
-            DisplayEventReceiver::Event* event);
+            DisplayEventReceiver::Event* event, Vector<int32_t>* sharedSlots,
+            Vector< sp<EventThread::Connection> >* sharedConnections);
 
     void dump(String8& result, char* buffer, size_t SIZE) const;
 
 private:
+    struct ScheduledConnection {
+        nsecs_t deadline;
+        wp<Connection> connection;
+    };
+
     virtual bool        threadLoop();
     virtual void        onFirstRef();
 
     void removeDisplayEventConnection(const wp<Connection>& connection);
     void enableVSyncLocked();
     void disableVSyncLocked();
+    void scheduleLocked(const sp<Connection>& connection, nsecs_t now);
+    void unscheduleLocked(const sp<Connection>& connection);
+    bool gatherScheduledLocked(nsecs_t now, DisplayEventReceiver::Event* event,
+            Vector< sp<EventThread::Connection> >* signalConnections);
+
+    // called from the VSyncSource's thread
+    virtual void onVSyncEvent(nsecs_t timestamp);
 
     // constants
-    sp<SurfaceFlinger> mFlinger;
+    sp<VSyncSource> mVSyncSource;
     PowerHAL mPowerHAL;
+    sp<SharedVSync> const mSharedVSync;
 
     mutable Mutex mLock;
     mutable Condition mCondition;
@@ -104,12 +155,15 @@ private:
     // protected by mLock
     SortedVector< wp<Connection> > mDisplayEventConnections;
     Vector< DisplayEventReceiver::Event > mPendingEvents;
+    // the connections on a schedule, the first one due first
+    Vector< ScheduledConnection > mScheduledConnections;
 #ifdef QCOM_HARDWARE
     DisplayEventReceiver::Event mVSyncEvent[HWC_NUM_DISPLAY_TYPES];
 #else
     DisplayEventReceiver::Event mVSyncEvent[HWC_DISPLAY_TYPES_SUPPORTED];
 #endif
     bool mUseSoftwareVSync;
+    bool mVsyncEnabled;
 
     // for debugging
     bool mDebugVsyncEnabled;
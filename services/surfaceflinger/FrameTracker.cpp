@@ -17,6 +17,12 @@
 // This is needed for stdint.h to define INT64_MAX in C++
 #define __STDC_LIMIT_MACROS
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cutils/properties.h>
+
 #include <ui/Fence.h>
 
 #include <utils/String8.h>
@@ -25,9 +31,43 @@
 
 namespace android {
 
+// Setting debug.sf.jank_trigger to N makes the frames that miss N vsyncs or
+// more set debug.atrace.trigger, for "atrace --daemon" to save the trace.
+// This happens when the frame's record is recycled, which is well within
+// the time a circular trace buffer covers, and at most once a second.
+static const char* kJankTriggerProperty = "debug.sf.jank_trigger";
+static const char* kTraceTriggerProperty = "debug.atrace.trigger";
+static const nsecs_t kMinJankTriggerInterval = s2ns(1);
+
+static Mutex sJankTriggerLock;
+static nsecs_t sLastJankTrigger = 0;
+static uint32_t sNumJankTriggers = 0;
+
+static void fireJankTrigger() {
+    nsecs_t now = systemTime();
+    uint32_t count;
+    {
+        Mutex::Autolock lock(sJankTriggerLock);
+        if (sLastJankTrigger != 0 &&
+                now - sLastJankTrigger < kMinJankTriggerInterval) {
+            return;
+        }
+        sLastJankTrigger = now;
+        count = ++sNumJankTriggers;
+    }
+    char value[PROPERTY_VALUE_MAX];
+    snprintf(value, sizeof(value), "jank:%u", count);
+    property_set(kTraceTriggerProperty, value);
+}
+
 FrameTracker::FrameTracker() :
         mOffset(0),
-        mNumFences(0) {
+        mNumFences(0),
+        mDisplayPeriod(0),
+        mJankTriggerVsyncs(0) {
+    char value[PROPERTY_VALUE_MAX];
+    property_get(kJankTriggerProperty, value, "0");
+    mJankTriggerVsyncs = uint32_t(atoi(value));
 }
 
 void FrameTracker::setDesiredPresentTime(nsecs_t presentTime) {
@@ -46,6 +86,11 @@ void FrameTracker::setFrameReadyFence(const sp<Fence>& readyFence) {
     mNumFences++;
 }
 
+void FrameTracker::setFrameLatchTime(nsecs_t latchTime) {
+    Mutex::Autolock lock(mMutex);
+    mFrameRecords[mOffset].frameLatchTime = latchTime;
+}
+
 void FrameTracker::setActualPresentTime(nsecs_t presentTime) {
     Mutex::Autolock lock(mMutex);
     mFrameRecords[mOffset].actualPresentTime = presentTime;
@@ -57,11 +102,33 @@ void FrameTracker::setActualPresentFence(const sp<Fence>& readyFence) {
     mNumFences++;
 }
 
+void FrameTracker::setDisplayRefreshPeriod(nsecs_t displayPeriod) {
+    Mutex::Autolock lock(mMutex);
+    mDisplayPeriod = displayPeriod;
+}
+
 void FrameTracker::advanceFrame() {
+    if (recycleFrame()) {
+        fireJankTrigger();
+    }
+}
+
+bool FrameTracker::recycleFrame() {
     Mutex::Autolock lock(mMutex);
     mOffset = (mOffset+1) % NUM_FRAME_RECORDS;
+
+    // The record we're about to reuse holds the oldest frame, add it to the
+    // histograms before it's lost.  Its fences have most likely signaled a
+    // long time ago.
+    resolveFencesLocked(mFrameRecords[mOffset]);
+    const uint32_t missedVsyncs = mStats.numMissedVsyncs;
+    mStats.addFrame(mFrameRecords[mOffset], mDisplayPeriod);
+    const bool jank = mJankTriggerVsyncs > 0 &&
+            mStats.numMissedVsyncs - missedVsyncs >= mJankTriggerVsyncs;
+
     mFrameRecords[mOffset].desiredPresentTime = INT64_MAX;
     mFrameRecords[mOffset].frameReadyTime = INT64_MAX;
+    mFrameRecords[mOffset].frameLatchTime = 0;
     mFrameRecords[mOffset].actualPresentTime = INT64_MAX;
 
     if (mFrameRecords[mOffset].frameReadyFence != NULL) {
@@ -81,6 +148,7 @@ void FrameTracker::advanceFrame() {
     // Clean up the signaled fences to keep the number of open fence FDs in
     // this process reasonable.
     processFencesLocked();
+    return jank;
 }
 
 void FrameTracker::clear() {
@@ -88,11 +156,13 @@ void FrameTracker::clear() {
     for (size_t i = 0; i < NUM_FRAME_RECORDS; i++) {
         mFrameRecords[i].desiredPresentTime = 0;
         mFrameRecords[i].frameReadyTime = 0;
+        mFrameRecords[i].frameLatchTime = 0;
         mFrameRecords[i].actualPresentTime = 0;
         mFrameRecords[i].frameReadyFence.clear();
         mFrameRecords[i].actualPresentFence.clear();
     }
     mNumFences = 0;
+    mStats.clear();
     mFrameRecords[mOffset].desiredPresentTime = INT64_MAX;
     mFrameRecords[mOffset].frameReadyTime = INT64_MAX;
     mFrameRecords[mOffset].actualPresentTime = INT64_MAX;
@@ -102,25 +172,67 @@ void FrameTracker::processFencesLocked() const {
     FrameRecord* records = const_cast<FrameRecord*>(mFrameRecords);
     int& numFences = const_cast<int&>(mNumFences);
 
-    for (int i = 1; i < NUM_FRAME_RECORDS && numFences > 0; i++) {
+    if (numFences <= 0) {
+        return;
+    }
+
+    // Gather the fences first so that the ones that haven't signaled yet
+    // are found with a single poll.  Each slot is a record index times two,
+    // plus one for the present fence.
+    const Fence* fences[2 * NUM_FRAME_RECORDS];
+    nsecs_t times[2 * NUM_FRAME_RECORDS];
+    uint16_t slots[2 * NUM_FRAME_RECORDS];
+    size_t count = 0;
+
+    for (int i = 1; i < NUM_FRAME_RECORDS && int(count) < numFences; i++) {
         size_t idx = (mOffset+NUM_FRAME_RECORDS-i) % NUM_FRAME_RECORDS;
 
-        const sp<Fence>& rfence = records[idx].frameReadyFence;
-        if (rfence != NULL) {
-            records[idx].frameReadyTime = rfence->getSignalTime();
-            if (records[idx].frameReadyTime < INT64_MAX) {
-                records[idx].frameReadyFence = NULL;
-                numFences--;
-            }
+        if (records[idx].frameReadyFence != NULL) {
+            fences[count] = records[idx].frameReadyFence.get();
+            slots[count++] = uint16_t(idx * 2);
+        }
+        if (records[idx].actualPresentFence != NULL) {
+            fences[count] = records[idx].actualPresentFence.get();
+            slots[count++] = uint16_t(idx * 2 + 1);
         }
+    }
+
+    Fence::getSignalTimes(fences, count, times);
 
-        const sp<Fence>& pfence = records[idx].actualPresentFence;
-        if (pfence != NULL) {
-            records[idx].actualPresentTime = pfence->getSignalTime();
-            if (records[idx].actualPresentTime < INT64_MAX) {
-                records[idx].actualPresentFence = NULL;
+    for (size_t i = 0; i < count; i++) {
+        FrameRecord& record = records[slots[i] / 2];
+        if (slots[i] & 1) {
+            record.actualPresentTime = times[i];
+            if (times[i] < INT64_MAX) {
+                record.actualPresentFence = NULL;
                 numFences--;
             }
+        } else {
+            record.frameReadyTime = times[i];
+            if (times[i] < INT64_MAX) {
+                record.frameReadyFence = NULL;
+                numFences--;
+            }
+        }
+    }
+}
+
+void FrameTracker::resolveFencesLocked(FrameRecord& record) {
+    if (record.frameReadyFence != NULL) {
+        nsecs_t t = record.frameReadyFence->getSignalTime();
+        if (t < INT64_MAX) {
+            record.frameReadyTime = t;
+            record.frameReadyFence = NULL;
+            mNumFences--;
+        }
+    }
+
+    if (record.actualPresentFence != NULL) {
+        nsecs_t t = record.actualPresentFence->getSignalTime();
+        if (t < INT64_MAX) {
+            record.actualPresentTime = t;
+            record.actualPresentFence = NULL;
+            mNumFences--;
         }
     }
 }
@@ -140,4 +252,120 @@ void FrameTracker::dump(String8& result) const {
     result.append("\n");
 }
 
+static void appendHistogram(String8& result, const char* name,
+        const uint32_t* buckets, size_t numBuckets) {
+    result.append(name);
+    for (size_t i = 0; i < numBuckets; i++) {
+        result.appendFormat(",%u", buckets[i]);
+    }
+    result.append("\n");
+}
+
+void FrameTracker::dumpHistograms(String8& result) const {
+    Mutex::Autolock lock(mMutex);
+    processFencesLocked();
+
+    // add the frames that are still in the circular buffer, oldest first,
+    // leaving out the current one which isn't complete yet
+    FrameStats stats(mStats);
+    const size_t o = mOffset;
+    for (size_t i = 1; i < NUM_FRAME_RECORDS; i++) {
+        const size_t index = (o+i) % NUM_FRAME_RECORDS;
+        stats.addFrame(mFrameRecords[index], mDisplayPeriod);
+    }
+
+    result.appendFormat("frames,%u\n", stats.numFrames);
+    result.appendFormat("missed-vsyncs,%u\n", stats.numMissedVsyncs);
+    result.appendFormat("longest-jank-streak,%u\n", stats.longestJankStreak);
+    result.appendFormat("current-jank-streak,%u\n", stats.currentJankStreak);
+    appendHistogram(result, "queue-to-latch-ms",
+            stats.queueToLatch, NUM_LATENCY_BUCKETS);
+    appendHistogram(result, "latch-to-present-ms",
+            stats.latchToPresent, NUM_LATENCY_BUCKETS);
+    appendHistogram(result, "vsync-intervals",
+            stats.vsyncIntervals, NUM_VSYNC_BUCKETS);
+    appendHistogram(result, "jank-streaks",
+            stats.jankStreaks, NUM_VSYNC_BUCKETS);
+}
+
+// ---------------------------------------------------------------------------
+
+FrameTracker::FrameStats::FrameStats() {
+    clear();
+}
+
+void FrameTracker::FrameStats::clear() {
+    memset(queueToLatch, 0, sizeof(queueToLatch));
+    memset(latchToPresent, 0, sizeof(latchToPresent));
+    memset(vsyncIntervals, 0, sizeof(vsyncIntervals));
+    memset(jankStreaks, 0, sizeof(jankStreaks));
+    numFrames = 0;
+    numMissedVsyncs = 0;
+    longestJankStreak = 0;
+    currentJankStreak = 0;
+    lastPresentTime = 0;
+}
+
+static inline bool isValidTime(nsecs_t t) {
+    // 0 is an unused record, INT64_MAX an unsignaled fence and -1 an error
+    return t > 0 && t < INT64_MAX;
+}
+
+static inline size_t latencyBucket(nsecs_t latency, size_t numBuckets) {
+    if (latency < 0) {
+        return 0;
+    }
+    nsecs_t ms = ns2ms(latency);
+    return ms < nsecs_t(numBuckets) ? size_t(ms) : numBuckets - 1;
+}
+
+void FrameTracker::FrameStats::addFrame(const FrameRecord& record,
+        nsecs_t displayPeriod) {
+    const nsecs_t present = record.actualPresentTime;
+    if (!isValidTime(present)) {
+        return;
+    }
+    numFrames++;
+
+    const bool haveDesired = isValidTime(record.desiredPresentTime);
+    const bool haveLatch = isValidTime(record.frameLatchTime);
+    if (haveDesired && haveLatch) {
+        queueToLatch[latencyBucket(
+                record.frameLatchTime - record.desiredPresentTime,
+                NUM_LATENCY_BUCKETS)]++;
+    }
+    if (haveLatch) {
+        latchToPresent[latencyBucket(present - record.frameLatchTime,
+                NUM_LATENCY_BUCKETS)]++;
+    }
+
+    if (displayPeriod > 0 && lastPresentTime > 0 && present > lastPresentTime) {
+        nsecs_t intervals = (present - lastPresentTime + displayPeriod/2) /
+                displayPeriod;
+        if (intervals < 1) {
+            intervals = 1;
+        }
+        vsyncIntervals[intervals < NUM_VSYNC_BUCKETS ?
+                intervals - 1 : NUM_VSYNC_BUCKETS - 1]++;
+
+        // A gap between two frames is only jank if the second one was queued
+        // in time to be shown right after the first, otherwise there was
+        // simply nothing new to show.
+        const bool continuous = !haveDesired ||
+                record.desiredPresentTime < lastPresentTime + displayPeriod;
+        if (continuous && intervals > 1) {
+            numMissedVsyncs += uint32_t(intervals - 1);
+            currentJankStreak++;
+            if (currentJankStreak > longestJankStreak) {
+                longestJankStreak = currentJankStreak;
+            }
+        } else if (currentJankStreak > 0) {
+            jankStreaks[currentJankStreak < NUM_VSYNC_BUCKETS ?
+                    currentJankStreak - 1 : NUM_VSYNC_BUCKETS - 1]++;
+            currentJankStreak = 0;
+        }
+    }
+    lastPresentTime = present;
+}
+
 } // namespace android
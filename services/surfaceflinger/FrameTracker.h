@@ -36,6 +36,10 @@ class Fence;
 // Some of the time values tracked may be set either as a specific timestamp
 // or a fence.  When a non-NULL fence is set for a given time value, the
 // signal time of that fence is used instead of the timestamp.
+//
+// In addition to the frame records, FrameTracker keeps latency histograms of
+// all the frames seen since the last clear().  A frame is added to them when
+// its record gets recycled, so this costs O(1) per frame.
 class FrameTracker {
 
 public:
@@ -43,6 +47,14 @@ public:
     // frame time history.
     enum { NUM_FRAME_RECORDS = 128 };
 
+    // NUM_LATENCY_BUCKETS is the number of 1ms buckets of the latency
+    // histograms, the last bucket also counts all the longer latencies.
+    enum { NUM_LATENCY_BUCKETS = 64 };
+
+    // NUM_VSYNC_BUCKETS is the number of buckets of the vsync interval and
+    // jank streak histograms, the last bucket also counts the larger values.
+    enum { NUM_VSYNC_BUCKETS = 8 };
+
     FrameTracker();
 
     // setDesiredPresentTime sets the time at which the current frame
@@ -60,6 +72,10 @@ public:
     // the current frame became ready to be presented to the user.
     void setFrameReadyFence(const sp<Fence>& readyFence);
 
+    // setFrameLatchTime sets the time at which SurfaceFlinger latched the
+    // current frame from its buffer queue.
+    void setFrameLatchTime(nsecs_t latchTime);
+
     // setActualPresentTime sets the timestamp at which the current frame became
     // visible to the user.
     void setActualPresentTime(nsecs_t displayTime);
@@ -68,28 +84,63 @@ public:
     // at which the current frame became visible to the user.
     void setActualPresentFence(const sp<Fence>& fence);
 
+    // setDisplayRefreshPeriod sets the refresh period of the display the
+    // frames are presented on, it is needed to count the missed vsyncs.
+    void setDisplayRefreshPeriod(nsecs_t displayPeriod);
+
     // advanceFrame advances the frame tracker to the next frame.
     void advanceFrame();
 
-    // clear resets all the tracked frame data to zero.
+    // clear resets all the tracked frame data and histograms to zero.
     void clear();
 
     // dump appends the current frame display time history to the result string.
     void dump(String8& result) const;
 
+    // dumpHistograms appends the latency histograms to the result string, as
+    // comma separated values, one histogram per line.
+    void dumpHistograms(String8& result) const;
+
 private:
     struct FrameRecord {
         FrameRecord() :
             desiredPresentTime(0),
             frameReadyTime(0),
+            frameLatchTime(0),
             actualPresentTime(0) {}
         nsecs_t desiredPresentTime;
         nsecs_t frameReadyTime;
+        nsecs_t frameLatchTime;
         nsecs_t actualPresentTime;
         sp<Fence> frameReadyFence;
         sp<Fence> actualPresentFence;
     };
 
+    // FrameStats accumulates the histograms of a sequence of frames.
+    struct FrameStats {
+        FrameStats();
+        void clear();
+
+        // addFrame accounts a frame whose times are all known.  Frames must
+        // be added in presentation order.
+        void addFrame(const FrameRecord& record, nsecs_t displayPeriod);
+
+        // time from queueing a buffer to SurfaceFlinger latching it
+        uint32_t queueToLatch[NUM_LATENCY_BUCKETS];
+        // time from latching a buffer to the display showing it
+        uint32_t latchToPresent[NUM_LATENCY_BUCKETS];
+        // number of vsync periods between two consecutive frames
+        uint32_t vsyncIntervals[NUM_VSYNC_BUCKETS];
+        // length of the runs of consecutive frames that missed a vsync
+        uint32_t jankStreaks[NUM_VSYNC_BUCKETS];
+
+        uint32_t numFrames;
+        uint32_t numMissedVsyncs;
+        uint32_t longestJankStreak;
+        uint32_t currentJankStreak;
+        nsecs_t lastPresentTime;
+    };
+
     // processFences iterates over all the frame records that have a fence set
     // and replaces that fence with a timestamp if the fence has signaled.  If
     // the fence is not signaled the record's displayTime is set to INT64_MAX.
@@ -99,6 +150,15 @@ private:
     // change.  This allows it to be called from the dump method.
     void processFencesLocked() const;
 
+    // recycleFrame does the work of advanceFrame under mMutex, and returns
+    // whether the frame whose record was recycled should set off the atrace
+    // trigger, which is done once the mutex is released.
+    bool recycleFrame();
+
+    // resolveFencesLocked replaces the signaled fences of a single record
+    // with their signal time.
+    void resolveFencesLocked(FrameRecord& record);
+
     // mFrameRecords is the circular buffer storing the tracked data for each
     // frame.
     FrameRecord mFrameRecords[NUM_FRAME_RECORDS];
@@ -115,6 +175,19 @@ private:
     // doesn't grow with NUM_FRAME_RECORDS.
     int mNumFences;
 
+    // mStats holds the histograms of all the frames whose record has been
+    // recycled since the last clear.  The frames still in mFrameRecords are
+    // only added to a copy of it when dumping.
+    FrameStats mStats;
+
+    // mDisplayPeriod is the refresh period last set with
+    // setDisplayRefreshPeriod.
+    nsecs_t mDisplayPeriod;
+
+    // mJankTriggerVsyncs is the number of vsyncs a frame has to miss to set
+    // the atrace trigger property, or 0 when it's never set.
+    uint32_t mJankTriggerVsyncs;
+
     // mMutex is used to protect access to all member variables.
     mutable Mutex mMutex;
 };
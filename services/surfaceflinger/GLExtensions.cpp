@@ -29,7 +29,8 @@ GLExtensions::GLExtensions()
     : mHaveTextureExternal(false),
       mHaveNpot(false),
       mHaveDirectTexture(false),
-      mHaveFramebufferObject(false)
+      mHaveFramebufferObject(false),
+      mHaveBufferAge(false)
 {
 }
 
@@ -83,7 +84,12 @@ void GLExtensions::initWithGLStrings(
 #error "EGL_ANDROID_image_native_buffer not supported"
 #endif
 
-    if (hasExtension("GL_ARB_texture_non_power_of_two")) {
+    // the IMG and APPLE extensions only allow NPOT textures without
+    // mipmaps and with GL_CLAMP_TO_EDGE wrapping, which is all we use
+    if (hasExtension("GL_ARB_texture_non_power_of_two") ||
+            hasExtension("GL_OES_texture_npot") ||
+            hasExtension("GL_IMG_texture_npot") ||
+            hasExtension("GL_APPLE_texture_2D_limited_npot")) {
         mHaveNpot = true;
     }
 
@@ -97,6 +103,10 @@ void GLExtensions::initWithGLStrings(
     if (hasExtension("GL_OES_framebuffer_object")) {
         mHaveFramebufferObject = true;
     }
+
+    if (hasExtension("EGL_EXT_buffer_age")) {
+        mHaveBufferAge = true;
+    }
 }
 
 bool GLExtensions::hasExtension(char const* extension) const
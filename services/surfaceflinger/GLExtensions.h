@@ -40,6 +40,7 @@ class GLExtensions : public Singleton<GLExtensions>
     bool mHaveNpot              : 1;
     bool mHaveDirectTexture     : 1;
     bool mHaveFramebufferObject : 1;
+    bool mHaveBufferAge         : 1;
 
     String8 mVendor;
     String8 mRenderer;
@@ -71,6 +72,10 @@ public:
         return mHaveFramebufferObject;
     }
 
+    inline bool haveBufferAge() const {
+        return mHaveBufferAge;
+    }
+
     void initWithGLStrings(
             GLubyte const* vendor,
             GLubyte const* renderer,
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SF_GL_STATE_CACHE_H
+#define ANDROID_SF_GL_STATE_CACHE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <GLES/gl.h>
+#include <GLES/glext.h>
+
+namespace android {
+
+/*
+ * GLStateCache tracks the fixed-function state used to draw layers so that
+ * redundant state changes between consecutive layers can be skipped.
+ *
+ * Outside of a batch, every call goes straight to GL and
+ * releaseDrawState() puts back the default state each draw expects.
+ * Between begin() and end(), all changes to the tracked state must go
+ * through this object; end() puts back the default state once. Within a
+ * batch the texture coordinate array stays enabled from one draw to the
+ * next, still pointing at the previous layer's coordinates, so draws that
+ * don't set their own must call setTexCoordArray(false).
+ */
+class GLStateCache
+{
+public:
+    inline GLStateCache() : mBatching(false), mSkipped(0) { invalidate(); }
+
+    inline void begin() {
+        mBatching = true;
+        invalidate();
+    }
+
+    inline void end() {
+        mBatching = false;
+        setDefaults();
+    }
+
+    inline bool isBatching() const { return mBatching; }
+
+    // number of state changes skipped, for debugging
+    inline uint32_t getSkippedCount() const { return mSkipped; }
+
+    inline void setBlend(bool enabled,
+            GLenum src = GL_ONE, GLenum dst = GL_ONE_MINUS_SRC_ALPHA) {
+        if (update(mBlend, enabled)) {
+            if (enabled) glEnable(GL_BLEND);
+            else         glDisable(GL_BLEND);
+        }
+        if (enabled && (update(mBlendSrc, GLint(src)) |
+                        update(mBlendDst, GLint(dst)))) {
+            glBlendFunc(src, dst);
+        }
+    }
+
+    // 0 to disable texturing, GL_TEXTURE_2D or GL_TEXTURE_EXTERNAL_OES
+    inline void setTexture(GLenum target) {
+        if (update(mTexture2D, target == GL_TEXTURE_2D)) {
+            if (target == GL_TEXTURE_2D) glEnable(GL_TEXTURE_2D);
+            else                         glDisable(GL_TEXTURE_2D);
+        }
+        if (update(mTextureExternal, target == GL_TEXTURE_EXTERNAL_OES)) {
+            if (target == GL_TEXTURE_EXTERNAL_OES) glEnable(GL_TEXTURE_EXTERNAL_OES);
+            else                                   glDisable(GL_TEXTURE_EXTERNAL_OES);
+        }
+    }
+
+    inline void setTexEnvMode(GLint mode) {
+        if (update(mTexEnvMode, mode)) {
+            glTexEnvx(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, mode);
+        }
+    }
+
+    inline void setDither(bool enabled) {
+        if (update(mDither, enabled)) {
+            if (enabled) glEnable(GL_DITHER);
+            else         glDisable(GL_DITHER);
+        }
+    }
+
+    inline void setTexCoordArray(bool enabled) {
+        if (update(mTexCoordArray, enabled)) {
+            if (enabled) glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+            else         glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        }
+    }
+
+    inline void setColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+        if (!mBatching || !mColorValid ||
+                mColor[0] != r || mColor[1] != g ||
+                mColor[2] != b || mColor[3] != a) {
+            mColor[0] = r; mColor[1] = g; mColor[2] = b; mColor[3] = a;
+            mColorValid = true;
+            glColor4f(r, g, b, a);
+        } else {
+            mSkipped++;
+        }
+    }
+
+    // called after each draw
+    inline void releaseDrawState() {
+        if (!mBatching) {
+            setDefaults();
+        }
+    }
+
+private:
+    enum { UNKNOWN = -1 };
+
+    inline void invalidate() {
+        mBlend = mBlendSrc = mBlendDst = UNKNOWN;
+        mTexture2D = mTextureExternal = UNKNOWN;
+        mTexEnvMode = mDither = mTexCoordArray = UNKNOWN;
+        mColorValid = false;
+    }
+
+    // the state layers expect when they start drawing
+    inline void setDefaults() {
+        invalidate();
+        glDisable(GL_BLEND);
+        glDisable(GL_TEXTURE_2D);
+        glDisable(GL_TEXTURE_EXTERNAL_OES);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    }
+
+    // returns true if GL must be called
+    inline bool update(GLint& cached, GLint value) {
+        if (mBatching && cached == value) {
+            mSkipped++;
+            return false;
+        }
+        cached = value;
+        return true;
+    }
+
+    bool mBatching;
+    uint32_t mSkipped;
+    GLint mBlend;
+    GLint mBlendSrc;
+    GLint mBlendDst;
+    GLint mTexture2D;
+    GLint mTextureExternal;
+    GLint mTexEnvMode;
+    GLint mDither;
+    GLint mTexCoordArray;
+    bool mColorValid;
+    GLfloat mColor[4];
+};
+
+}; // namespace android
+
+#endif // ANDROID_SF_GL_STATE_CACHE_H
@@ -36,6 +36,7 @@
 #include <gui/Surface.h>
 
 #include "clz.h"
+#include "CpuCompositor.h"
 #include "DisplayDevice.h"
 #include "GLExtensions.h"
 #include "Layer.h"
@@ -59,6 +60,7 @@ int32_t Layer::sSequence = 1;
 Layer::Layer(SurfaceFlinger* flinger, const sp<Client>& client,
         const String8& name, uint32_t w, uint32_t h, uint32_t flags)
     :   contentDirty(false),
+        geometryDirty(true),
         sequence(uint32_t(android_atomic_inc(&sSequence))),
         mFlinger(flinger),
         mTextureName(-1U),
@@ -71,6 +73,7 @@ Layer::Layer(SurfaceFlinger* flinger, const sp<Client>& client,
         mNeedsDithering(false),
         mTransactionFlags(0),
         mQueuedFrames(0),
+        mBufferGeneration(0),
         mCurrentTransform(0),
         mCurrentScalingMode(NATIVE_WINDOW_SCALING_MODE_FREEZE),
         mCurrentOpacity(true),
@@ -78,6 +81,9 @@ Layer::Layer(SurfaceFlinger* flinger, const sp<Client>& client,
         mFrameLatencyNeeded(false),
         mFiltering(false),
         mNeedsFiltering(false),
+        mOffScreenSince(0),
+        mLastBufferReclaim(0),
+        mReclaimedBytes(0),
         mSecure(false),
         mProtectedByApp(false),
         mHasSurface(false),
@@ -127,6 +133,10 @@ void Layer::onFirstRef()
     mSurfaceFlingerConsumer->setDefaultMaxBufferCount(2);
 #else
     mSurfaceFlingerConsumer->setDefaultMaxBufferCount(3);
+    if (mFlinger->mAdaptiveBuffering) {
+        // drop to double buffering while the producer keeps up
+        bq->setAdaptiveBufferCount(2, 3);
+    }
 #endif
 
     const sp<const DisplayDevice> hw(mFlinger->getDefaultDisplayDevice());
@@ -155,9 +165,15 @@ void Layer::onLayerDisplayed(const sp<const DisplayDevice>& hw,
 
 void Layer::onFrameAvailable() {
     android_atomic_inc(&mQueuedFrames);
+    mFlinger->preLatchBufferAsync(this);
     mFlinger->signalLayerUpdate();
 }
 
+void Layer::onFrameDropped() {
+    // the frame won't be latched
+    android_atomic_dec(&mQueuedFrames);
+}
+
 // called with SurfaceFlinger::mStateLock from the drawing thread after
 // the layer has been remove from the current state list (and just before
 // it's removed from the drawing state list)
@@ -423,15 +439,60 @@ void Layer::setPerFrameData(const sp<const DisplayDevice>& hw,
     // after HWComposer::commit() -- every frame.
     // Apply this display's projection's viewport to the visible region
     // before giving it to the HWC HAL.
-    const Transform& tr = hw->getTransform();
-    Region visible = tr.transform(visibleRegion.intersect(hw->getViewport()));
-    layer.setVisibleRegionScreen(visible);
+    // the region is the same from frame to frame unless the layer moved,
+    // and its storage is then shared with the HWC instead of copied.
+    layer.setVisibleRegionScreen(getVisibleRegionScreen(hw, true));
 
     // NOTE: buffer can be NULL if the client never drew into this
     // layer yet, or if we ran out of memory
     layer.setBuffer(mActiveBuffer);
 }
 
+const Region& Layer::getVisibleRegionScreen(const sp<const DisplayDevice>& hw,
+        bool clipToViewport) const
+{
+    const Transform& tr(hw->getTransform());
+    const Rect viewport(hw->getViewport());
+    const size_t count = mScreenRegions.size();
+    ssize_t index = -1;
+    for (size_t i=0 ; i<count ; i++) {
+        if (mScreenRegions[i].display == hw.get()) {
+            index = i;
+            break;
+        }
+    }
+    if (index >= 0) {
+        const ScreenRegion& r(mScreenRegions[index]);
+        // r holds a reference to the storage, so any change copies it
+        if (r.visibleRegion.isTriviallyEqual(visibleRegion) &&
+                r.viewport == viewport && r.transform == tr) {
+            return clipToViewport ? r.clippedScreenRegion : r.screenRegion;
+        }
+    } else {
+        // drop the display least recently added, it's likely gone
+        if (count >= MAX_SCREEN_REGIONS) {
+            mScreenRegions.removeAt(0);
+        }
+        index = mScreenRegions.add();
+    }
+
+    ScreenRegion& r(mScreenRegions.editItemAt(index));
+    r.display = hw.get();
+    r.transform = tr;
+    r.viewport = viewport;
+    r.visibleRegion = visibleRegion;
+    r.screenRegion = tr.transform(visibleRegion);
+    const Rect bounds(visibleRegion.getBounds());
+    Rect clipped;
+    if (viewport.intersect(bounds, &clipped) && clipped == bounds) {
+        // usually, the viewport doesn't clip anything
+        r.clippedScreenRegion = r.screenRegion;
+    } else {
+        r.clippedScreenRegion = tr.transform(visibleRegion.intersect(viewport));
+    }
+    return clipToViewport ? r.clippedScreenRegion : r.screenRegion;
+}
+
 void Layer::setAcquireFence(const sp<const DisplayDevice>& hw,
         HWComposer::HWCLayerInterface& layer) {
     int fenceFd = -1;
@@ -505,6 +566,7 @@ void Layer::onDraw(const sp<const DisplayDevice>& hw, const Region& clip) const
     }
 
     bool blackOutLayer = isProtected() || (isSecure() && !hw->isSecure());
+    GLStateCache& gl(mFlinger->getGLState());
 
     if (!blackOutLayer) {
         // TODO: we could be more subtle with isFixedSize()
@@ -526,40 +588,117 @@ void Layer::onDraw(const sp<const DisplayDevice>& hw, const Region& clip) const
         glMatrixMode(GL_TEXTURE);
         glLoadMatrixf(textureMatrix);
         glMatrixMode(GL_MODELVIEW);
-        glDisable(GL_TEXTURE_2D);
-        glEnable(GL_TEXTURE_EXTERNAL_OES);
+        gl.setTexture(GL_TEXTURE_EXTERNAL_OES);
     } else {
         glBindTexture(GL_TEXTURE_2D, mFlinger->getProtectedTexName());
         glMatrixMode(GL_TEXTURE);
         glLoadIdentity();
         glMatrixMode(GL_MODELVIEW);
-        glDisable(GL_TEXTURE_EXTERNAL_OES);
-        glEnable(GL_TEXTURE_2D);
+        gl.setTexture(GL_TEXTURE_2D);
     }
 
     drawWithOpenGL(hw, clip);
 
-    glDisable(GL_TEXTURE_EXTERNAL_OES);
-    glDisable(GL_TEXTURE_2D);
+    gl.releaseDrawState();
+}
+
+
+void Layer::computeCpuGeometry(const sp<const DisplayDevice>& hw,
+        Rect* frame, Rect* crop) const
+{
+    // same as what setGeometry() gives to the HWC
+    const State& s(drawingState());
+    Rect f(s.transform.transform(computeBounds()));
+    f.intersect(hw->getViewport(), &f);
+    *frame = hw->getTransform().transform(f);
+    *crop = computeCrop(hw);
 }
 
+bool Layer::canDrawWithCpu(const sp<const DisplayDevice>& hw) const
+{
+    if (mActiveBuffer == 0) {
+        // nothing to draw, see onDraw(), the screenshot starts black
+        return true;
+    }
+    if (isProtected() || (isSecure() && !hw->isSecure())) {
+        return false;
+    }
+    if (!CpuCompositor::isFormatSupported(mActiveBuffer->getPixelFormat())) {
+        return false;
+    }
+
+    const State& s(drawingState());
+    const Transform transform(hw->getTransform() * s.transform *
+            Transform(mCurrentTransform));
+    if (transform.getType() & ~Transform::TRANSLATE) {
+        return false;
+    }
+    if (transform.tx() != floorf(transform.tx()) ||
+            transform.ty() != floorf(transform.ty())) {
+        return false;
+    }
+
+    const Rect contentCrop(getContentCrop());
+    if (contentCrop.getWidth() != int32_t(s.active.w) ||
+            contentCrop.getHeight() != int32_t(s.active.h)) {
+        // the content is scaled to the window
+        return false;
+    }
+
+    Rect frame, crop;
+    computeCpuGeometry(hw, &frame, &crop);
+    return crop.getWidth() == frame.getWidth() &&
+            crop.getHeight() == frame.getHeight();
+}
+
+bool Layer::drawWithCpu(const sp<const DisplayDevice>& hw,
+        CpuCompositor& compositor) const
+{
+    ATRACE_CALL();
+
+    if (mActiveBuffer == 0) {
+        return true;
+    }
+
+    // like bindTextureImage(), wait for the producer to be done
+    sp<Fence> fence(mSurfaceFlingerConsumer->getCurrentFence());
+    if (fence->isValid()) {
+        fence->waitForever("Layer::drawWithCpu");
+    }
+
+    void* vaddr;
+    if (mActiveBuffer->lock(GRALLOC_USAGE_SW_READ_OFTEN, &vaddr) != NO_ERROR) {
+        return false;
+    }
+
+    Rect frame, crop;
+    computeCpuGeometry(hw, &frame, &crop);
+    const State& s(drawingState());
+    compositor.compose(vaddr, mActiveBuffer->getStride(),
+            mActiveBuffer->getPixelFormat(), crop, frame,
+            s.alpha, mPremultipliedAlpha, !isOpaque());
+
+    mActiveBuffer->unlock();
+    return true;
+}
 
 void Layer::clearWithOpenGL(const sp<const DisplayDevice>& hw, const Region& clip,
         GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) const
 {
     const uint32_t fbHeight = hw->getHeight();
-    glColor4f(red,green,blue,alpha);
-
-    glDisable(GL_TEXTURE_EXTERNAL_OES);
-    glDisable(GL_TEXTURE_2D);
-    glDisable(GL_BLEND);
-    glDisable(GL_DITHER);
+    GLStateCache& gl(mFlinger->getGLState());
+    gl.setColor(red,green,blue,alpha);
+    gl.setTexture(0);
+    gl.setTexCoordArray(false);
+    gl.setBlend(false);
+    gl.setDither(false);
 
     LayerMesh mesh;
     computeGeometry(hw, &mesh);
 
     glVertexPointer(2, GL_FLOAT, 0, mesh.getVertices());
     glDrawArrays(GL_TRIANGLE_FAN, 0, mesh.getVertexCount());
+    gl.releaseDrawState();
 }
 
 void Layer::clearWithOpenGL(
@@ -571,27 +710,22 @@ void Layer::drawWithOpenGL(
         const sp<const DisplayDevice>& hw, const Region& clip) const {
     const uint32_t fbHeight = hw->getHeight();
     const State& s(drawingState());
+    GLStateCache& gl(mFlinger->getGLState());
 
     GLenum src = mPremultipliedAlpha ? GL_ONE : GL_SRC_ALPHA;
     if (CC_UNLIKELY(s.alpha < 0xFF)) {
         const GLfloat alpha = s.alpha * (1.0f/255.0f);
         if (mPremultipliedAlpha) {
-            glColor4f(alpha, alpha, alpha, alpha);
+            gl.setColor(alpha, alpha, alpha, alpha);
         } else {
-            glColor4f(1, 1, 1, alpha);
+            gl.setColor(1, 1, 1, alpha);
         }
-        glEnable(GL_BLEND);
-        glBlendFunc(src, GL_ONE_MINUS_SRC_ALPHA);
-        glTexEnvx(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        gl.setBlend(true, src, GL_ONE_MINUS_SRC_ALPHA);
+        gl.setTexEnvMode(GL_MODULATE);
     } else {
-        glColor4f(1, 1, 1, 1);
-        glTexEnvx(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-        if (!isOpaque()) {
-            glEnable(GL_BLEND);
-            glBlendFunc(src, GL_ONE_MINUS_SRC_ALPHA);
-        } else {
-            glDisable(GL_BLEND);
-        }
+        gl.setColor(1, 1, 1, 1);
+        gl.setTexEnvMode(GL_REPLACE);
+        gl.setBlend(!isOpaque(), src, GL_ONE_MINUS_SRC_ALPHA);
     }
 
     LayerMesh mesh;
@@ -640,19 +774,11 @@ void Layer::drawWithOpenGL(
         texCoords[i].v = 1.0f - texCoords[i].v;
     }
 
-    if (needsDithering()) {
-        glEnable(GL_DITHER);
-    } else {
-        glDisable(GL_DITHER);
-    }
-
-    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    gl.setDither(needsDithering());
+    gl.setTexCoordArray(true);
     glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
     glVertexPointer(2, GL_FLOAT, 0, mesh.getVertices());
     glDrawArrays(GL_TRIANGLE_FAN, 0, mesh.getVertexCount());
-
-    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-    glDisable(GL_BLEND);
 }
 
 void Layer::setFiltering(bool filtering) {
@@ -738,18 +864,42 @@ bool Layer::needsFiltering(const sp<const DisplayDevice>& hw) const {
 }
 
 void Layer::setVisibleRegion(const Region& visibleRegion) {
-    // always called from main thread
+    // always called from main thread, or from a visible region worker
+    // while the main thread waits
     this->visibleRegion = visibleRegion;
 }
 
+void Layer::setOnScreen(bool onScreen, nsecs_t now) {
+    if (onScreen) {
+        mOffScreenSince = 0;
+    } else if (!mOffScreenSince) {
+        mOffScreenSince = now;
+    }
+}
+
+size_t Layer::reclaimIdleBuffers(nsecs_t now, nsecs_t timeout) {
+    if (!mOffScreenSince || now - mOffScreenSince < timeout ||
+            now - mLastBufferReclaim < timeout) {
+        return 0;
+    }
+    mLastBufferReclaim = now;
+    // the acquired buffer stays, a layer coming back shows its last frame
+    const size_t size =
+            mSurfaceFlingerConsumer->getBufferQueue()->discardFreeBuffers();
+    mReclaimedBytes += size;
+    return size;
+}
+
 void Layer::setCoveredRegion(const Region& coveredRegion) {
-    // always called from main thread
+    // always called from main thread, or from a visible region worker
+    // while the main thread waits
     this->coveredRegion = coveredRegion;
 }
 
 void Layer::setVisibleNonTransparentRegion(const Region&
         setVisibleNonTransparentRegion) {
-    // always called from main thread
+    // always called from main thread, or from a visible region worker
+    // while the main thread waits
     this->visibleNonTransparentRegion = setVisibleNonTransparentRegion;
 }
 
@@ -853,6 +1003,10 @@ uint32_t Layer::doTransaction(uint32_t flags) {
                 (type >= Transform::SCALE));
     }
 
+    if (flags & eVisibleRegion) {
+        geometryDirty = true;
+    }
+
     // Commit the transaction
     commitTransaction();
     return flags;
@@ -965,6 +1119,8 @@ void Layer::onPostComposition() {
         }
 
         const HWComposer& hwc = mFlinger->getHwComposer();
+        mFrameTracker.setDisplayRefreshPeriod(
+                hwc.getRefreshPeriod(HWC_DISPLAY_PRIMARY));
         sp<Fence> presentFence = hwc.getDisplayFence(HWC_DISPLAY_PRIMARY);
         if (presentFence->isValid()) {
             mFrameTracker.setActualPresentFence(presentFence);
@@ -975,6 +1131,11 @@ void Layer::onPostComposition() {
             mFrameTracker.setActualPresentTime(presentTime);
         }
 
+        // let the producer know when its frame was shown
+        mSurfaceFlingerConsumer->getBufferQueue()->setFramePresented(
+                mSurfaceFlingerConsumer->getFrameNumber(), presentFence,
+                hwc.getRefreshTimestamp(HWC_DISPLAY_PRIMARY));
+
         mFrameTracker.advanceFrame();
         mFrameLatencyNeeded = false;
     }
@@ -986,7 +1147,8 @@ bool Layer::isVisible() const {
             && (mActiveBuffer != NULL);
 }
 
-Region Layer::latchBuffer(bool& recomputeVisibleRegions)
+Region Layer::latchBuffer(bool& recomputeVisibleRegions,
+        nsecs_t expectedPresent)
 {
     ATRACE_CALL();
 
@@ -1006,11 +1168,6 @@ Region Layer::latchBuffer(bool& recomputeVisibleRegions)
         const bool oldOpacity = isOpaque();
         sp<GraphicBuffer> oldActiveBuffer = mActiveBuffer;
 
-        // signal another event if we have more frames pending
-        if (android_atomic_dec(&mQueuedFrames) > 1) {
-            mFlinger->signalLayerUpdate();
-        }
-
         struct Reject : public SurfaceFlingerConsumer::BufferRejecter {
             Layer::State& front;
             Layer::State& current;
@@ -1116,7 +1273,23 @@ Region Layer::latchBuffer(bool& recomputeVisibleRegions)
 
         Reject r(mDrawingState, currentState(), recomputeVisibleRegions);
 
-        if (mSurfaceFlingerConsumer->updateTexImage(&r) != NO_ERROR) {
+        uint32_t skipped = 0;
+        status_t err = mSurfaceFlingerConsumer->updateTexImage(&r,
+                expectedPresent, &skipped);
+        if (err == BufferQueue::PRESENT_LATER) {
+            // the next frame is for a later vsync, keep it queued
+            mFlinger->signalLayerUpdate();
+            return outDirtyRegion;
+        }
+
+        // signal another event if we have more frames pending, the
+        // skipped frames will never be latched
+        const int32_t latched = 1 + int32_t(skipped);
+        if (android_atomic_add(-latched, &mQueuedFrames) > latched) {
+            mFlinger->signalLayerUpdate();
+        }
+
+        if (err != NO_ERROR) {
             // something happened!
             recomputeVisibleRegions = true;
             return outDirtyRegion;
@@ -1129,34 +1302,40 @@ Region Layer::latchBuffer(bool& recomputeVisibleRegions)
             return outDirtyRegion;
         }
 
+        mBufferGeneration++;
         mRefreshPending = true;
         mFrameLatencyNeeded = true;
+        mFrameTracker.setFrameLatchTime(systemTime());
         if (oldActiveBuffer == NULL) {
              // the first time we receive a buffer, we need to trigger a
              // geometry invalidation.
             recomputeVisibleRegions = true;
          }
 
-        Rect crop(mSurfaceFlingerConsumer->getCurrentCrop());
-        const uint32_t transform(mSurfaceFlingerConsumer->getCurrentTransform());
-        const uint32_t scalingMode(mSurfaceFlingerConsumer->getCurrentScalingMode());
-        if ((crop != mCurrentCrop) ||
-            (transform != mCurrentTransform) ||
-            (scalingMode != mCurrentScalingMode))
-        {
-            mCurrentCrop = crop;
-            mCurrentTransform = transform;
-            mCurrentScalingMode = scalingMode;
-            recomputeVisibleRegions = true;
-        }
-
-        if (oldActiveBuffer != NULL) {
-            uint32_t bufWidth  = mActiveBuffer->getWidth();
-            uint32_t bufHeight = mActiveBuffer->getHeight();
-            if (bufWidth != uint32_t(oldActiveBuffer->width) ||
-                bufHeight != uint32_t(oldActiveBuffer->height)) {
+        // crop, transform, scaling mode and size are usually the same as
+        // the previous buffer's, which the consumer already checked
+        if (mSurfaceFlingerConsumer->hasGeometryChanged()) {
+            Rect crop(mSurfaceFlingerConsumer->getCurrentCrop());
+            const uint32_t transform(mSurfaceFlingerConsumer->getCurrentTransform());
+            const uint32_t scalingMode(mSurfaceFlingerConsumer->getCurrentScalingMode());
+            if ((crop != mCurrentCrop) ||
+                (transform != mCurrentTransform) ||
+                (scalingMode != mCurrentScalingMode))
+            {
+                mCurrentCrop = crop;
+                mCurrentTransform = transform;
+                mCurrentScalingMode = scalingMode;
                 recomputeVisibleRegions = true;
             }
+
+            if (oldActiveBuffer != NULL) {
+                uint32_t bufWidth  = mActiveBuffer->getWidth();
+                uint32_t bufHeight = mActiveBuffer->getHeight();
+                if (bufWidth != uint32_t(oldActiveBuffer->width) ||
+                    bufHeight != uint32_t(oldActiveBuffer->height)) {
+                    recomputeVisibleRegions = true;
+                }
+            }
         }
 
         mCurrentOpacity = getOpacityForFormat(mActiveBuffer->format);
@@ -1177,6 +1356,14 @@ Region Layer::latchBuffer(bool& recomputeVisibleRegions)
     return outDirtyRegion;
 }
 
+void Layer::preLatchBuffer()
+{
+    ATRACE_CALL();
+    status_t err = mSurfaceFlingerConsumer->preLatch();
+    ALOGE_IF(err, "[%s] preLatch failed: %s (%d)",
+            mName.string(), strerror(-err), err);
+}
+
 uint32_t Layer::getEffectiveUsage(uint32_t usage) const
 {
     // TODO: should we do something special if mSecure is set?
@@ -1236,6 +1423,12 @@ void Layer::dump(String8& result, char* buffer, size_t SIZE) const
             client.get());
     result.append(buffer);
 
+    if (mOffScreenSince) {
+        result.appendFormat("      off-screen for %lld ms, reclaimed %u KB\n",
+                (long long)ns2ms(systemTime() - mOffScreenSince),
+                uint32_t(mReclaimedBytes / 1024));
+    }
+
     sp<const GraphicBuffer> buf0(mActiveBuffer);
     uint32_t w0=0, h0=0, s0=0, f0=0;
     if (buf0 != 0) {
@@ -1267,6 +1460,10 @@ void Layer::dumpStats(String8& result, char* buffer, size_t SIZE) const {
     mFrameTracker.dump(result);
 }
 
+void Layer::dumpLatencyHistograms(String8& result) const {
+    mFrameTracker.dumpHistograms(result);
+}
+
 void Layer::clearStats() {
     mFrameTracker.clear();
 }
@@ -28,6 +28,7 @@
 #include <utils/RefBase.h>
 #include <utils/String8.h>
 #include <utils/Timers.h>
+#include <utils/Vector.h>
 
 #include <ui/GraphicBuffer.h>
 #include <ui/PixelFormat.h>
@@ -51,6 +52,7 @@ namespace android {
 // ---------------------------------------------------------------------------
 
 class Client;
+class CpuCompositor;
 class DisplayDevice;
 class GraphicBuffer;
 class SurfaceFlinger;
@@ -70,6 +72,10 @@ class Layer : public SurfaceFlingerConsumer::FrameAvailableListener {
 
 public:
     mutable bool contentDirty;
+    // set when this layer's visible region may have changed since the last
+    // SurfaceFlinger::rebuildLayerStacks(); cleared once all displays have
+    // recomputed their visible regions.
+    bool geometryDirty;
     // regions below are in window-manager space
     Region visibleRegion;
     Region coveredRegion;
@@ -200,6 +206,16 @@ public:
      */
     virtual void onDraw(const sp<const DisplayDevice>& hw, const Region& clip) const;
 
+    /*
+     * canDrawWithCpu - true if drawWithCpu() can draw this layer as it is,
+     * which requires a supported pixel format and no rotation or scaling.
+     * drawWithCpu - draws the surface into a screenshot without GL, returns
+     * false if the buffer couldn't be read.
+     */
+    virtual bool canDrawWithCpu(const sp<const DisplayDevice>& hw) const;
+    virtual bool drawWithCpu(const sp<const DisplayDevice>& hw,
+            CpuCompositor& compositor) const;
+
     /*
      * needsLinearFiltering - true if this surface's state requires filtering
      */
@@ -236,8 +252,31 @@ public:
      * the visible regions need to be recomputed (this is a fairly heavy
      * operation, so this should be set only if needed). Typically this is used
      * to figure out if the content or size of a surface has changed.
+     * expectedPresent is when the frame will be on screen, buffers that
+     * are timestamped for later are kept until then.
+     */
+    virtual Region latchBuffer(bool& recomputeVisibleRegions,
+            nsecs_t expectedPresent);
+
+    /*
+     * preLatchBuffer - does the expensive part of the next latchBuffer()
+     * (acquiring the buffer and creating its EGLImage) ahead of time. This
+     * is called from a worker thread.
+     */
+    void preLatchBuffer();
+
+    /*
+     * setOnScreen - called once the visible layers of every display are
+     * known, with whether this layer is drawn on any of them.
      */
-    virtual Region latchBuffer(bool& recomputeVisibleRegions);
+    void setOnScreen(bool onScreen, nsecs_t now);
+
+    /*
+     * reclaimIdleBuffers - frees the buffers of the BufferQueue that aren't
+     * held by the consumer once the layer has been off-screen for timeout,
+     * then at most once per timeout. Returns how many bytes were freed.
+     */
+    size_t reclaimIdleBuffers(nsecs_t now, nsecs_t timeout);
 
     /*
      * isOpaque - true if this surface is opaque
@@ -307,6 +346,17 @@ public:
     // only for debugging
     inline const sp<GraphicBuffer>& getActiveBuffer() const { return mActiveBuffer; }
 
+    // incremented each time a new buffer is latched
+    inline uint32_t getBufferGeneration() const { return mBufferGeneration; }
+
+    /*
+     * visibleRegion in hw's screen space, clipped to hw's viewport or not.
+     * Reused from frame to frame until visibleRegion or hw's projection
+     * changes; valid until the next call.  Main thread only.
+     */
+    const Region& getVisibleRegionScreen(const sp<const DisplayDevice>& hw,
+            bool clipToViewport) const;
+
     inline  const State&    drawingState() const    { return mDrawingState; }
     inline  const State&    currentState() const    { return mCurrentState; }
     inline  State&          currentState()          { return mCurrentState; }
@@ -316,6 +366,7 @@ public:
     virtual void dump(String8& result, char* scratch, size_t size) const;
     virtual void shortDump(String8& result, char* scratch, size_t size) const;
     virtual void dumpStats(String8& result, char* buffer, size_t SIZE) const;
+    void dumpLatencyHistograms(String8& result) const;
     virtual void clearStats();
 
 protected:
@@ -341,6 +392,7 @@ protected:
 private:
     // Interface implementation for SurfaceFlingerConsumer::FrameAvailableListener
     virtual void onFrameAvailable();
+    virtual void onFrameDropped();
 
 
     uint32_t getEffectiveUsage(uint32_t usage) const;
@@ -352,6 +404,25 @@ private:
     void clearWithOpenGL(const sp<const DisplayDevice>& hw, const Region& clip,
             GLclampf r, GLclampf g, GLclampf b, GLclampf alpha) const;
     void drawWithOpenGL(const sp<const DisplayDevice>& hw, const Region& clip) const;
+    // where the buffer lands on the display, and which part of it,
+    // when there is no scaling or rotation involved
+    void computeCpuGeometry(const sp<const DisplayDevice>& hw,
+            Rect* frame, Rect* crop) const;
+
+    // visibleRegion on one display, see getVisibleRegionScreen()
+    struct ScreenRegion {
+        // only compared, a display recreated at the same address has to
+        // match the transform and viewport too
+        const DisplayDevice* display;
+        Transform transform;
+        Rect viewport;
+        // what the regions below were computed from; holding a reference
+        // keeps its storage from being reused by a different region
+        Region visibleRegion;
+        Region screenRegion;
+        Region clippedScreenRegion;
+    };
+    enum { MAX_SCREEN_REGIONS = 4 };
 
 
     // -----------------------------------------------------------------------
@@ -377,7 +448,9 @@ private:
     FrameTracker mFrameTracker;
 
     // main thread
+    mutable Vector<ScreenRegion> mScreenRegions;
     sp<GraphicBuffer> mActiveBuffer;
+    uint32_t mBufferGeneration;
     Rect mCurrentCrop;
     uint32_t mCurrentTransform;
     uint32_t mCurrentScalingMode;
@@ -388,6 +461,10 @@ private:
     bool mFiltering;
     // Whether filtering is needed b/c of the drawingstate
     bool mNeedsFiltering;
+    // 0 while the layer is on screen
+    nsecs_t mOffScreenSince;
+    nsecs_t mLastBufferReclaim;
+    uint64_t mReclaimedBytes;
 
     // page-flip thread (currently main thread)
     bool mSecure; // no screenshots
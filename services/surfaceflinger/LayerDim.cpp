@@ -26,6 +26,7 @@
 
 #include <ui/GraphicBuffer.h>
 
+#include "CpuCompositor.h"
 #include "LayerDim.h"
 #include "SurfaceFlinger.h"
 #include "DisplayDevice.h"
@@ -41,23 +42,42 @@ LayerDim::LayerDim(SurfaceFlinger* flinger, const sp<Client>& client,
 LayerDim::~LayerDim() {
 }
 
+void LayerDim::setGeometry(const sp<const DisplayDevice>& hw,
+        HWComposer::HWCLayerInterface& layer)
+{
+    Layer::setGeometry(hw, layer);
+
+    // the HWC scales the solid color buffer to the frame and fades it with
+    // the plane alpha, it has no content to crop or rotate. HALs without
+    // plane alpha skip the layer unless it's opaque, and we draw it.
+    const sp<GraphicBuffer>& buffer(mFlinger->getSolidColorBuffer());
+    if (buffer != NULL) {
+        layer.setBlending(HWC_BLENDING_PREMULT);
+        layer.setCrop(Rect(buffer->getWidth(), buffer->getHeight()));
+        layer.setTransform(0);
+    } else {
+        layer.setSkip(true);
+    }
+}
+
+void LayerDim::setPerFrameData(const sp<const DisplayDevice>& hw,
+        HWComposer::HWCLayerInterface& layer)
+{
+    Layer::setPerFrameData(hw, layer);
+    layer.setBuffer(mFlinger->getSolidColorBuffer());
+}
+
 void LayerDim::onDraw(const sp<const DisplayDevice>& hw, const Region& clip) const
 {
     const State& s(drawingState());
     if (s.alpha>0) {
         const GLfloat alpha = s.alpha/255.0f;
         const uint32_t fbHeight = hw->getHeight();
-        glDisable(GL_TEXTURE_EXTERNAL_OES);
-        glDisable(GL_TEXTURE_2D);
-
-        if (s.alpha == 0xFF) {
-            glDisable(GL_BLEND);
-        } else {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-        }
-
-        glColor4f(0, 0, 0, alpha);
+        GLStateCache& gl(mFlinger->getGLState());
+        gl.setTexture(0);
+        gl.setTexCoordArray(false);
+        gl.setBlend(s.alpha != 0xFF, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        gl.setColor(0, 0, 0, alpha);
 
         LayerMesh mesh;
         computeGeometry(hw, &mesh);
@@ -65,9 +85,28 @@ void LayerDim::onDraw(const sp<const DisplayDevice>& hw, const Region& clip) con
         glVertexPointer(2, GL_FLOAT, 0, mesh.getVertices());
         glDrawArrays(GL_TRIANGLE_FAN, 0, mesh.getVertexCount());
 
-        glDisable(GL_BLEND);
-        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        gl.releaseDrawState();
+    }
+}
+
+bool LayerDim::canDrawWithCpu(const sp<const DisplayDevice>& hw) const
+{
+    // there is no buffer, the layer only has to stay a rectangle
+    const State& s(drawingState());
+    const Transform transform(hw->getTransform() * s.transform);
+    return transform.preserveRects();
+}
+
+bool LayerDim::drawWithCpu(const sp<const DisplayDevice>& hw,
+        CpuCompositor& compositor) const
+{
+    const State& s(drawingState());
+    if (s.alpha>0) {
+        Rect frame(s.transform.transform(computeBounds()));
+        frame.intersect(hw->getViewport(), &frame);
+        compositor.dim(hw->getTransform().transform(frame), s.alpha);
     }
+    return true;
 }
 
 bool LayerDim::isVisible() const {
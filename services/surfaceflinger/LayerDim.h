@@ -36,7 +36,14 @@ public:
                         const String8& name, uint32_t w, uint32_t h, uint32_t flags);
         virtual ~LayerDim();
 
+    virtual void setGeometry(const sp<const DisplayDevice>& hw,
+            HWComposer::HWCLayerInterface& layer);
+    virtual void setPerFrameData(const sp<const DisplayDevice>& hw,
+            HWComposer::HWCLayerInterface& layer);
     virtual void onDraw(const sp<const DisplayDevice>& hw, const Region& clip) const;
+    virtual bool canDrawWithCpu(const sp<const DisplayDevice>& hw) const;
+    virtual bool drawWithCpu(const sp<const DisplayDevice>& hw,
+            CpuCompositor& compositor) const;
     virtual bool isOpaque() const         { return false; }
     virtual bool isSecure() const         { return false; }
     virtual bool isProtectedByApp() const { return false; }
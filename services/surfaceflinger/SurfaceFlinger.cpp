@@ -47,23 +47,28 @@
 #include <ui/UiConfig.h>
 
 #include <utils/misc.h>
+#include <utils/Profiler.h>
+#include <utils/SharedBuffer.h>
 #include <utils/String8.h>
 #include <utils/String16.h>
 #include <utils/StopWatch.h>
 #include <utils/Trace.h>
 
 #include <private/android_filesystem_config.h>
+#include <private/gui/EGLImageCache.h>
 #include <private/gui/SyncFeatures.h>
 
 #include "clz.h"
 #include "DdmConnection.h"
 #include "DisplayDevice.h"
 #include "Client.h"
+#include "CpuCompositor.h"
 #include "EventThread.h"
 #include "GLExtensions.h"
 #include "Layer.h"
 #include "LayerDim.h"
 #include "SurfaceFlinger.h"
+#include "WorkerPool.h"
 
 #include "DisplayHardware/FramebufferSurface.h"
 #include "DisplayHardware/HWComposer.h"
@@ -75,7 +80,20 @@
 
 #define DISPLAY_COUNT       1
 
+// Offsets of the app and SurfaceFlinger vsync events relative to the
+// modeled h/w vsync. A positive app offset together with a larger SF
+// offset lets the apps start rendering a frame early enough for
+// SurfaceFlinger to pick it up within the same refresh period.
+#ifndef VSYNC_EVENT_PHASE_OFFSET_NS
+#define VSYNC_EVENT_PHASE_OFFSET_NS 0
+#endif
+#ifndef SF_VSYNC_EVENT_PHASE_OFFSET_NS
+#define SF_VSYNC_EVENT_PHASE_OFFSET_NS 0
+#endif
+
 EGLAPI const char* eglQueryStringImplementationANDROID(EGLDisplay dpy, EGLint name);
+EGLAPI EGLint eglDumpGpuTimesANDROID(char* buffer, EGLint size);
+extern "C" void egl_set_cache_filename(const char* filename);
 
 namespace android {
 // ---------------------------------------------------------------------------
@@ -85,6 +103,10 @@ const String16 sAccessSurfaceFlinger("android.permission.ACCESS_SURFACE_FLINGER"
 const String16 sReadFramebuffer("android.permission.READ_FRAME_BUFFER");
 const String16 sDump("android.permission.DUMP");
 
+// consecutive frames without a present fence after which the vsync model
+// is checked against h/w vsync again
+static const int MAX_MISSING_PRESENT_FENCES = 60;
+
 // ---------------------------------------------------------------------------
 
 SurfaceFlinger::SurfaceFlinger()
@@ -98,6 +120,18 @@ SurfaceFlinger::SurfaceFlinger()
         mVisibleRegionsDirty(false),
         mHwWorkListDirty(false),
         mAnimCompositionPending(false),
+        mIncrementalVisibleRegions(false),
+        mParallelVisibleRegions(false),
+        mUseCompositionCache(false),
+        mUseBufferAge(false),
+        mQueueTransactions(false),
+        mAsyncPresent(false),
+        mPresentCommitJob(NULL),
+        mPostCompositionJob(NULL),
+        mCpuScreenshots(false),
+        mPreLatchBuffers(false),
+        mParallelInit(false),
+        mPrewarmGL(false),
         mDebugRegion(0),
         mDebugDDMS(0),
         mDebugDisableHWC(0),
@@ -107,7 +141,24 @@ SurfaceFlinger::SurfaceFlinger()
         mDebugInTransaction(0),
         mLastTransactionTime(0),
         mBootFinished(false),
-        mUseDithering(0)
+        mUseDithering(0),
+        mPrimaryHWVsyncEnabled(false),
+        mPrimaryVsyncListening(false),
+        mVsyncPrediction(false),
+        mMissingPresentFences(0),
+        mFrameBoost(false),
+        mFrameDeadline(0),
+        mAvgFrameSlack(0),
+        mFrameBoostLevel(0),
+        mAdaptiveBuffering(false),
+        mHwcDimLayers(false),
+        mMainThreadCpus(0),
+        mCpuProfilePeriod(0),
+        mLastCpuProfileSample(0),
+        mIdleReclaimTimeout(0),
+        mReclaimedBufferKb(0),
+        mReclaimedBufferCount(0),
+        mFencePipeline(String8("SurfaceFlinger"))
 {
     ALOGI("SurfaceFlinger is starting");
 
@@ -120,6 +171,92 @@ SurfaceFlinger::SurfaceFlinger()
     property_get("debug.sf.showupdates", value, "0");
     mDebugRegion = atoi(value);
 
+    property_get("debug.sf.incremental_vr", value, "0");
+    mIncrementalVisibleRegions = atoi(value);
+
+    property_get("debug.sf.parallel_vr", value, "0");
+    mParallelVisibleRegions = atoi(value);
+
+    property_get("debug.sf.layer_cache", value, "0");
+    mUseCompositionCache = atoi(value);
+
+    property_get("debug.sf.buffer_age", value, "0");
+    mUseBufferAge = atoi(value);
+
+    property_get("debug.sf.queue_transactions", value, "0");
+    mQueueTransactions = atoi(value);
+
+    property_get("debug.sf.async_present", value, "0");
+    mAsyncPresent = atoi(value);
+
+    property_get("debug.sf.cpu_screenshot", value, "0");
+    mCpuScreenshots = atoi(value);
+
+    property_get("debug.sf.prelatch", value, "0");
+    mPreLatchBuffers = atoi(value);
+
+    // overlap the independent parts of readyToRun()
+    property_get("debug.sf.parallel_init", value, "0");
+    mParallelInit = atoi(value);
+
+    // compile the drivers' shaders for our GL states at boot
+    property_get("debug.sf.prewarm_gl", value, "0");
+    mPrewarmGL = atoi(value);
+
+    property_get("debug.sf.vsync_prediction", value, "0");
+    mVsyncPrediction = atoi(value);
+
+    // hint the power HAL when frames get close to missing their vsync
+    property_get("debug.sf.frame_boost", value, "0");
+    mFrameBoost = atoi(value);
+
+    // let the BufferQueues of layers go down to two buffers when possible
+    property_get("debug.sf.adaptive_buffers", value, "0");
+    mAdaptiveBuffering = atoi(value);
+
+    // let the HWC compose dim layers, instead of always GLES
+    property_get("debug.sf.hwc_dim", value, "0");
+    mHwcDimLayers = atoi(value);
+
+    // GLES composition resolution of each built-in display, e.g. "0.5" to
+    // render at half the size, or "1,0.5" to go down to half the size when
+    // the GPU can't keep up
+    for (int type=0 ; type<DisplayDevice::NUM_DISPLAY_TYPES ; type++) {
+        char name[PROPERTY_KEY_MAX];
+        snprintf(name, sizeof(name), "debug.sf.render_scale.%d", type);
+        float maxScale = 1.0f, minScale = 0.0f;
+        if (property_get(name, value, NULL) > 0 &&
+                sscanf(value, "%f,%f", &maxScale, &minScale) >= 1) {
+            if (setRenderScale(type, maxScale, minScale) == NO_ERROR) {
+                ALOGI("display %d renders at %.3f (min %.3f)",
+                        type, maxScale, minScale);
+            } else {
+                ALOGE("invalid %s: %s", name, value);
+            }
+        }
+    }
+
+    property_get("debug.sf.buffer_pool_kb", value, "0");
+    const size_t bufferPoolKb = atoi(value);
+    GraphicBufferAllocator::get().setPoolLimit(bufferPoolKb * 1024);
+
+    // a mask of CPUs to keep the main thread on, e.g. 0xf0 for the big cores
+    property_get("debug.sf.main_cpus", value, "0");
+    mMainThreadCpus = uint32_t(strtoul(value, NULL, 0));
+
+    // sample the CPU usage of our threads at most this often, in ms; the
+    // samples are taken after compositions, so an idle screen stretches them
+    property_get("debug.sf.cpu_profile_ms", value, "0");
+    mCpuProfilePeriod = ms2ns(atoi(value));
+
+    // free the spare buffers of layers that stayed off-screen that long, in ms
+    property_get("debug.sf.idle_reclaim_ms", value, "0");
+    mIdleReclaimTimeout = ms2ns(atoi(value));
+
+    // time the phases of each composition, see dumpsys SurfaceFlinger --profile
+    property_get("debug.sf.profile", value, "0");
+    Profiler::setEnabled(atoi(value));
+
     property_get("debug.sf.ddms", value, "0");
     mDebugDDMS = atoi(value);
     if (mDebugDDMS) {
@@ -131,6 +268,26 @@ SurfaceFlinger::SurfaceFlinger()
 
     ALOGI_IF(mDebugRegion, "showupdates enabled");
     ALOGI_IF(mDebugDDMS, "DDMS debugging enabled");
+    ALOGI_IF(mIncrementalVisibleRegions, "incremental visible regions enabled");
+    ALOGI_IF(mParallelVisibleRegions, "parallel visible regions enabled");
+    ALOGI_IF(mUseCompositionCache, "composition cache enabled");
+    ALOGI_IF(mUseBufferAge, "buffer age partial updates enabled");
+    ALOGI_IF(mQueueTransactions, "transaction queue enabled");
+    ALOGI_IF(mVsyncPrediction, "vsync prediction enabled");
+    ALOGI_IF(mFrameBoost, "frame boost hints enabled");
+    ALOGI_IF(mAdaptiveBuffering, "adaptive buffer counts enabled");
+    ALOGI_IF(mHwcDimLayers, "HWC dim layers enabled");
+    ALOGI_IF(mAsyncPresent, "asynchronous present enabled");
+    ALOGI_IF(mCpuScreenshots, "CPU screenshots enabled");
+    ALOGI_IF(mPreLatchBuffers, "buffer pre-latching enabled");
+    ALOGI_IF(mParallelInit, "parallel initialization enabled");
+    ALOGI_IF(mPrewarmGL, "GL state prewarm enabled");
+    ALOGI_IF(bufferPoolKb, "buffer pool enabled (%u KB)", uint32_t(bufferPoolKb));
+    ALOGI_IF(mMainThreadCpus, "main thread pinned to CPUs 0x%x", mMainThreadCpus);
+    ALOGI_IF(mCpuProfilePeriod, "CPU profiling enabled (%lld ms)",
+            (long long)ns2ms(mCpuProfilePeriod));
+    ALOGI_IF(mIdleReclaimTimeout, "idle layer buffer reclaim enabled (%lld ms)",
+            (long long)ns2ms(mIdleReclaimTimeout));
 
 #ifdef SAMSUNG_HDMI_SUPPORT
     ALOGD(">>> Run service");
@@ -147,14 +304,70 @@ void SurfaceFlinger::onFirstRef()
 {
     mEventQueue.init(this);
 
-    run("SurfaceFlinger", PRIORITY_URGENT_DISPLAY);
+    if (mMainThreadCpus) {
+        android_thread_sched_t sched = ANDROID_THREAD_SCHED_INITIALIZER;
+        sched.cpuMask = mMainThreadCpus;
+        run("SurfaceFlinger", PRIORITY_URGENT_DISPLAY, 0, sched);
+    } else {
+        run("SurfaceFlinger", PRIORITY_URGENT_DISPLAY);
+    }
     // Wait for the main thread to be done with its initialization
     mReadyToRunBarrier.wait();
 }
 
 
+// jobs run on mPresentWorker, see postFramebuffer()
+class SurfaceFlinger::PresentCommitJob : public WorkerPool::Job {
+public:
+    PresentCommitJob(SurfaceFlinger* flinger) : mFlinger(flinger) { }
+    virtual void run() {
+        mFlinger->commitFramebuffer(displays);
+    }
+    Vector<PresentedDisplay> displays;
+private:
+    SurfaceFlinger* const mFlinger;
+};
+
+class SurfaceFlinger::PostCompositionJob : public WorkerPool::Job {
+public:
+    PostCompositionJob(SurfaceFlinger* flinger)
+        : animCompositionPending(false), frameDeadline(0), mFlinger(flinger) { }
+    virtual void run() {
+        mFlinger->postComposition(layers, animCompositionPending,
+                frameDeadline);
+    }
+    LayerVector layers;
+    bool animCompositionPending;
+    nsecs_t frameDeadline;
+private:
+    SurfaceFlinger* const mFlinger;
+};
+
+// posted to mPreLatchWorker for each buffer queued to a layer, it only
+// holds a weak reference so that the layer can go away in the meantime
+class SurfaceFlinger::PreLatchJob : public WorkerPool::Job {
+public:
+    PreLatchJob(const wp<Layer>& layer) : mLayer(layer) { }
+    virtual void run() {
+        sp<Layer> layer(mLayer.promote());
+        if (layer != 0) {
+            layer->preLatchBuffer();
+        }
+        delete this;
+    }
+private:
+    const wp<Layer> mLayer;
+};
+
 SurfaceFlinger::~SurfaceFlinger()
 {
+    // stop the present thread before the jobs it runs go away
+    waitForPresent();
+    mPresentWorker.clear();
+    delete mPresentCommitJob;
+    delete mPostCompositionJob;
+    mPreLatchWorker.clear();
+
     EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
     eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
     eglTerminate(display);
@@ -254,19 +467,76 @@ void SurfaceFlinger::bootFinished()
     property_set("service.bootanim.exit", "1");
 }
 
+void SurfaceFlinger::preLatchBufferAsync(const wp<Layer>& layer) {
+    if (mPreLatchWorker != NULL) {
+        mPreLatchWorker->post(new PreLatchJob(layer));
+    }
+}
+
 void SurfaceFlinger::deleteTextureAsync(GLuint texture) {
-    class MessageDestroyGLTexture : public MessageBase {
-        GLuint texture;
+    class MessageDeleteTextures : public MessageBase {
+        SurfaceFlinger* flinger;
     public:
-        MessageDestroyGLTexture(GLuint texture)
-            : texture(texture) {
+        MessageDeleteTextures(SurfaceFlinger* flinger)
+            : flinger(flinger) {
         }
         virtual bool handler() {
-            glDeleteTextures(1, &texture);
+            flinger->deletePendingTextures();
             return true;
         }
     };
-    postMessageAsync(new MessageDestroyGLTexture(texture));
+
+    // the textures are deleted together after the next composition, the
+    // message only makes sure it happens if no frame comes
+    bool first;
+    {
+        Mutex::Autolock _l(mTextureDeleteLock);
+        first = mTexturesToDelete.isEmpty();
+        mTexturesToDelete.add(texture);
+    }
+    if (first) {
+        postMessageAsync(new MessageDeleteTextures(this), ms2ns(100));
+    }
+}
+
+void SurfaceFlinger::deletePendingTextures() {
+    Vector<GLuint> textures;
+    {
+        Mutex::Autolock _l(mTextureDeleteLock);
+        if (mTexturesToDelete.isEmpty()) {
+            return;
+        }
+        textures = mTexturesToDelete;
+        mTexturesToDelete.clear();
+    }
+
+    // Deleting a texture the GPU is still reading from can make the driver
+    // wait for the GPU right there. Instead, fence the commands issued so far
+    // and delete the textures once the fence has signalled.
+    if (SyncFeatures::getInstance().useNativeFenceSync() &&
+            mFencePipeline.insertFence(mEGLDisplay, NULL) == NO_ERROR) {
+        PendingTextureDelete pending;
+        pending.textures = textures;
+        pending.serial = mFencePipeline.getLastSerial();
+        mPendingTextureDeletes.add(pending);
+        return;
+    }
+    glDeleteTextures(textures.size(), textures.array());
+}
+
+void SurfaceFlinger::retirePendingTextureDeletes() {
+    // the stages retire in order, so do the pending deletes
+    size_t retired = 0;
+    Vector<GLuint> textures;
+    while (retired < mPendingTextureDeletes.size() &&
+            mFencePipeline.isRetired(mPendingTextureDeletes[retired].serial)) {
+        textures.appendVector(mPendingTextureDeletes[retired].textures);
+        retired++;
+    }
+    if (retired) {
+        glDeleteTextures(textures.size(), textures.array());
+        mPendingTextureDeletes.removeItemsAt(0, retired);
+    }
 }
 
 status_t SurfaceFlinger::selectConfigForAttribute(
@@ -442,6 +712,17 @@ void SurfaceFlinger::initializeGL(EGLDisplay display) {
     glGetIntegerv(GL_MAX_TEXTURE_SIZE, &mMaxTextureSize);
     glGetIntegerv(GL_MAX_VIEWPORT_DIMS, mMaxViewportDims);
 
+    if (mUseBufferAge && !extensions.haveBufferAge()) {
+        ALOGW("buffer age partial updates disabled, EGL_EXT_buffer_age unsupported");
+        mUseBufferAge = false;
+    }
+
+    if (mUseCompositionCache &&
+            !(extensions.haveFramebufferObject() && extensions.haveNpot())) {
+        ALOGW("composition cache disabled, FBOs or NPOT textures unsupported");
+        mUseCompositionCache = false;
+    }
+
     glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glPixelStorei(GL_PACK_ALIGNMENT, 4);
     glEnableClientState(GL_VERTEX_ARRAY);
@@ -488,21 +769,203 @@ void SurfaceFlinger::initializeGL(EGLDisplay display) {
     mMinColorDepth = r;
 }
 
+void SurfaceFlinger::prewarmGLStates() {
+    // Drivers generate a shader for each fixed-function state combination
+    // the first time it is drawn with, which can take several frames on the
+    // first rotation or the first dim. Draw a pixel with each combination
+    // Layer and LayerDim use now, where it doesn't show: the first frame
+    // repaints the whole screen.
+    ATRACE_CALL();
+    GLuint externalTex;
+    glGenTextures(1, &externalTex);
+    glBindTexture(GL_TEXTURE_EXTERNAL_OES, externalTex);
+    glBindTexture(GL_TEXTURE_2D, mProtectedTexName);
+
+    static const GLfloat quad[4][2] = { {0, 0}, {0, 1}, {1, 1}, {1, 0} };
+    glVertexPointer(2, GL_FLOAT, 0, quad);
+    glTexCoordPointer(2, GL_FLOAT, 0, quad);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, 0, 1, 1);
+
+    static const GLenum targets[] = {
+            0, GL_TEXTURE_2D, GL_TEXTURE_EXTERNAL_OES };
+    static const GLint envModes[] = { GL_REPLACE, GL_MODULATE };
+    // opaque, premultiplied and non-premultiplied
+    static const GLenum blendSrcs[] = { 0, GL_ONE, GL_SRC_ALPHA };
+    GLStateCache& gl(mGLState);
+    size_t count = 0;
+    for (int t=0 ; t<NELEM(targets) ; t++) {
+        for (int e=0 ; e<NELEM(envModes) ; e++) {
+            for (int b=0 ; b<NELEM(blendSrcs) ; b++) {
+                for (int dither=0 ; dither<2 ; dither++) {
+                    const GLfloat alpha = envModes[e] == GL_MODULATE ? 0.5f : 1;
+                    gl.setTexture(targets[t]);
+                    gl.setTexCoordArray(targets[t] != 0);
+                    gl.setTexEnvMode(envModes[e]);
+                    gl.setBlend(blendSrcs[b] != 0, blendSrcs[b]);
+                    gl.setDither(dither);
+                    gl.setColor(alpha, alpha, alpha, alpha);
+                    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+                    gl.releaseDrawState();
+                    count++;
+                }
+            }
+        }
+    }
+
+    glDisable(GL_SCISSOR_TEST);
+    // the compilations happen now rather than in the first frame
+    glFinish();
+    glDeleteTextures(1, &externalTex);
+    ALOGI("prewarmed %u GL state combinations", uint32_t(count));
+}
+
+// ----------------------------------------------------------------------------
+
+// A VSyncSource firing at a fixed offset from the main display's vsync,
+// as modeled by DispSync.
+class DispSyncSource : public VSyncSource, private DispSync::Callback {
+public:
+    DispSyncSource(const sp<SurfaceFlinger>& flinger, DispSync* dispSync,
+            nsecs_t phaseOffset, const char* label) :
+            mFlinger(flinger),
+            mDispSync(dispSync),
+            mPhaseOffset(phaseOffset),
+            mVsyncEventLabel(String8::format("VSYNC-%s", label)),
+            mValue(0) {
+    }
+
+    virtual ~DispSyncSource() { }
+
+    virtual void setVSyncEnabled(bool enable) {
+        status_t err;
+        if (enable) {
+            err = mDispSync->addEventListener(mPhaseOffset,
+                    static_cast<DispSync::Callback*>(this));
+        } else {
+            err = mDispSync->removeEventListener(
+                    static_cast<DispSync::Callback*>(this));
+        }
+        ALOGE_IF(err != NO_ERROR, "%s: error %s vsync listener (%d)",
+                mVsyncEventLabel.string(), enable ? "adding" : "removing", err);
+        mFlinger->updatePrimaryHardwareVsync();
+    }
+
+    virtual void setCallback(const sp<VSyncSource::Callback>& callback) {
+        Mutex::Autolock lock(mMutex);
+        mCallback = callback;
+    }
+
+    virtual nsecs_t getPeriod() const {
+        return mDispSync->getPeriod();
+    }
+
+    virtual nsecs_t computeNextEventTime(nsecs_t now) const {
+        nsecs_t t = mDispSync->computeNextRefresh(now - mPhaseOffset);
+        return t ? t + mPhaseOffset : 0;
+    }
+
+private:
+    virtual void onDispSyncEvent(nsecs_t when) {
+        sp<VSyncSource::Callback> callback;
+        {
+            Mutex::Autolock lock(mMutex);
+            callback = mCallback;
+            mValue = (mValue + 1) % 2;
+            ATRACE_INT(mVsyncEventLabel.string(), mValue);
+        }
+
+        if (callback != NULL) {
+            callback->onVSyncEvent(when);
+        }
+    }
+
+    const sp<SurfaceFlinger> mFlinger;
+    DispSync* const mDispSync;
+    const nsecs_t mPhaseOffset;
+    const String8 mVsyncEventLabel;
+
+    Mutex mMutex;
+    sp<VSyncSource::Callback> mCallback;
+    int mValue;
+};
+
 status_t SurfaceFlinger::readyToRun()
 {
     ALOGI(  "SurfaceFlinger's main thread ready to run. "
             "Initializing graphics H/W...");
 
+    // logs how long each stage of the initialization takes
+    class BootTimer {
+        const nsecs_t start;
+        nsecs_t last;
+    public:
+        BootTimer() : start(systemTime()), last(start) { }
+        void mark(const char* stage) {
+            const nsecs_t now = systemTime();
+            ALOGI("boot: %s took %.1f ms (%.1f ms total)", stage,
+                    (now - last) / 1e6, (now - start) / 1e6);
+            last = now;
+        }
+    };
+
+    // loading the HWC module doesn't depend on EGL
+    class CreateHwcJob : public WorkerPool::Job {
+        const sp<SurfaceFlinger> flinger;
+        HWComposer** const hwc;
+        virtual void run() {
+            *hwc = new HWComposer(flinger,
+                    *static_cast<HWComposer::EventHandler *>(flinger.get()));
+        }
+    public:
+        CreateHwcJob(const sp<SurfaceFlinger>& flinger, HWComposer** hwc)
+            : flinger(flinger), hwc(hwc) { }
+    };
+
+    // neither does allocating the framebuffers
+    class AllocateBuffersJob : public WorkerPool::Job {
+        const sp<IGraphicBufferProducer> producer;
+        virtual void run() {
+            producer->allocateBuffers(0, 0, 0, GRALLOC_USAGE_HW_RENDER);
+        }
+    public:
+        AllocateBuffersJob(const sp<IGraphicBufferProducer>& producer)
+            : producer(producer) { }
+    };
+
     Mutex::Autolock _l(mStateLock);
+    BootTimer timer;
+
+    sp<WorkerPool> initWorker;
+    Vector<WorkerPool::Job*> initJobs;
+    if (mParallelInit) {
+        initWorker = new WorkerPool("Init", 1);
+        initJobs.add(new CreateHwcJob(this, &mHwc));
+        initWorker->post(initJobs.top());
+    }
+
+    // the driver's compiled shaders outlive us in this file, it must be
+    // named before EGL is initialized
+    char cacheFile[PROPERTY_VALUE_MAX];
+    if (property_get("debug.sf.egl_cache", cacheFile, NULL) > 0) {
+        egl_set_cache_filename(cacheFile);
+        ALOGI("EGL blob cache in %s", cacheFile);
+    }
 
     // initialize EGL for the default display
     mEGLDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
     eglInitialize(mEGLDisplay, NULL, NULL);
+    timer.mark("EGL initialization");
 
-    // Initialize the H/W composer object.  There may or may not be an
-    // actual hardware composer underneath.
-    mHwc = new HWComposer(this,
-            *static_cast<HWComposer::EventHandler *>(this));
+    if (initWorker != NULL) {
+        initWorker->wait();
+    } else {
+        // Initialize the H/W composer object.  There may or may not be an
+        // actual hardware composer underneath.
+        mHwc = new HWComposer(this,
+                *static_cast<HWComposer::EventHandler *>(this));
+    }
+    timer.mark("HWComposer");
 
     // initialize the config and context
     EGLint format = mHwc->getVisualID();
@@ -515,6 +978,7 @@ status_t SurfaceFlinger::readyToRun()
 
     LOG_ALWAYS_FATAL_IF(mEGLContext == EGL_NO_CONTEXT,
             "couldn't create EGLContext");
+    timer.mark("EGL config and context");
 
     // initialize our non-virtual displays
     for (size_t i=0 ; i<DisplayDevice::NUM_DISPLAY_TYPES ; i++) {
@@ -526,10 +990,16 @@ status_t SurfaceFlinger::readyToRun()
             createBuiltinDisplayLocked(type);
             wp<IBinder> token = mBuiltinDisplays[i];
 
+            sp<FramebufferSurface> fbs = new FramebufferSurface(*mHwc, i);
+            if (initWorker != NULL) {
+                // the first frame would otherwise wait for them
+                initJobs.add(new AllocateBuffersJob(
+                        fbs->getIGraphicBufferProducer()));
+                initWorker->post(initJobs.top());
+            }
             sp<DisplayDevice> hw = new DisplayDevice(this,
                     type, allocateHwcDisplayId(type), isSecure, token,
-                    new FramebufferSurface(*mHwc, i),
-                    mEGLConfig);
+                    fbs, mEGLConfig);
             if (i > DisplayDevice::DISPLAY_PRIMARY) {
                 // FIXME: currently we don't get blank/unblank requests
                 // for displays other than the main display, so we always
@@ -556,10 +1026,65 @@ status_t SurfaceFlinger::readyToRun()
     //  initialize OpenGL ES
     DisplayDevice::makeCurrent(mEGLDisplay, hw, mEGLContext);
     initializeGL(mEGLDisplay);
+    timer.mark("displays and GL");
+    if (mPrewarmGL) {
+        prewarmGLStates();
+        timer.mark("GL state prewarm");
+    }
+
+    // start with the nominal refresh period, the model locks onto the
+    // real h/w vsync as soon as it's enabled
+    mPrimaryDispSync.setPeriod(
+            getHwComposer().getRefreshPeriod(HWC_DISPLAY_PRIMARY));
+
+    // start the EventThreads, one for the apps and one for SurfaceFlinger
+    // itself, each at its own offset from vsync
+    sp<VSyncSource> vsyncSrc = new DispSyncSource(this, &mPrimaryDispSync,
+            VSYNC_EVENT_PHASE_OFFSET_NS, "app");
+    mEventThread = new EventThread(vsyncSrc);
+    sp<VSyncSource> sfVsyncSrc = new DispSyncSource(this, &mPrimaryDispSync,
+            SF_VSYNC_EVENT_PHASE_OFFSET_NS, "sf");
+    mSFEventThread = new EventThread(sfVsyncSrc);
+    mEventQueue.setEventThread(mSFEventThread);
+    timer.mark("event threads");
+
+    if (mAsyncPresent) {
+        if (mHwc->initCheck() == NO_ERROR && mHwc->supportsFramebufferTarget()) {
+            // commit() doesn't need our EGL context with HWC 1.1 and up,
+            // so it can be called from another thread
+            mPresentWorker = new WorkerPool("Present", 1);
+            mPresentCommitJob = new PresentCommitJob(this);
+            mPostCompositionJob = new PostCompositionJob(this);
+        } else {
+            ALOGW("asynchronous present requires HWC 1.1, disabled");
+            mAsyncPresent = false;
+        }
+    }
+
+    if (mPreLatchBuffers) {
+        mPreLatchWorker = new WorkerPool("PreLatch", 1);
+    }
+
+    // idle EGLImages get destroyed after composition, see
+    // handleMessageRefresh()
+    EGLImageCache::getInstance().setDeferredTrim(true);
+
+    if (mHwcDimLayers) {
+        if (mHwc->initCheck() == NO_ERROR && mHwc->supportsFramebufferTarget()) {
+            mSolidColorBuffer = createSolidColorBuffer(hw);
+        }
+        ALOGW_IF(mSolidColorBuffer == NULL,
+                "HWC dim layers require HWC 1.1, disabled");
+        mHwcDimLayers = (mSolidColorBuffer != NULL);
+    }
 
-    // start the EventThread
-    mEventThread = new EventThread(this);
-    mEventQueue.setEventThread(mEventThread);
+    if (initWorker != NULL) {
+        initWorker->wait();
+        for (size_t i=0 ; i<initJobs.size() ; i++) {
+            delete initJobs[i];
+        }
+        timer.mark("framebuffer allocation");
+    }
 
     // initialize our drawing state
     mDrawingState = mCurrentState;
@@ -570,6 +1095,7 @@ status_t SurfaceFlinger::readyToRun()
 
     // set initial conditions (e.g. unblank default device)
     initializeDisplays();
+    timer.mark("display initialization");
 
     // start boot animation
     startBootAnim();
@@ -745,9 +1271,14 @@ void SurfaceFlinger::onVSyncReceived(int type, nsecs_t timestamp) {
         ALOGW("WARNING: EventThread not started, ignoring vsync");
         return;
     }
-    if (uint32_t(type) < DisplayDevice::NUM_DISPLAY_TYPES) {
-        // we should only receive DisplayDevice::DisplayType from the vsync callback
-        mEventThread->onVSyncReceived(type, timestamp);
+    if (type == DisplayDevice::DISPLAY_PRIMARY) {
+        // h/w vsync only feeds the model, the EventThreads are driven
+        // by mPrimaryDispSync
+        Mutex::Autolock _l(mHWVsyncLock);
+        bool needsHwVsync = mPrimaryDispSync.addResyncSample(timestamp);
+        if (mVsyncPrediction && !needsHwVsync) {
+            disableHardwareVsyncLocked();
+        }
     }
 }
 
@@ -778,6 +1309,40 @@ void SurfaceFlinger::eventControl(int disp, int event, int enabled) {
     getHwComposer().eventControl(disp, event, enabled);
 }
 
+void SurfaceFlinger::updatePrimaryHardwareVsync() {
+    Mutex::Autolock _l(mHWVsyncLock);
+    const bool listening = mPrimaryDispSync.hasEventListeners();
+    if (listening == mPrimaryVsyncListening) {
+        return;
+    }
+    mPrimaryVsyncListening = listening;
+    if (listening) {
+        // a locked model keeps running while nobody listens, we don't
+        // need the h/w to pick it up again
+        if (!mVsyncPrediction || !mPrimaryDispSync.isLocked()) {
+            resyncToHardwareVsyncLocked();
+        }
+    } else {
+        disableHardwareVsyncLocked();
+    }
+}
+
+void SurfaceFlinger::resyncToHardwareVsyncLocked() {
+    if (!mPrimaryHWVsyncEnabled) {
+        // samples taken before we turned vsync off are stale
+        mPrimaryDispSync.beginResync();
+        eventControl(HWC_DISPLAY_PRIMARY, SurfaceFlinger::EVENT_VSYNC, true);
+        mPrimaryHWVsyncEnabled = true;
+    }
+}
+
+void SurfaceFlinger::disableHardwareVsyncLocked() {
+    if (mPrimaryHWVsyncEnabled) {
+        eventControl(HWC_DISPLAY_PRIMARY, SurfaceFlinger::EVENT_VSYNC, false);
+        mPrimaryHWVsyncEnabled = false;
+    }
+}
+
 void SurfaceFlinger::onMessageReceived(int32_t what) {
     ATRACE_CALL();
     switch (what) {
@@ -796,6 +1361,14 @@ void SurfaceFlinger::onMessageReceived(int32_t what) {
 }
 
 void SurfaceFlinger::handleMessageTransaction() {
+    PROFILE_CALL();
+    if (!mPendingTransactions.isEmpty()) {
+        Mutex::Autolock _l(mStateLock);
+        // we're about to handle the transaction, no need to wake
+        // ourselves up again
+        android_atomic_or(applyPendingTransactionsLocked(), &mTransactionFlags);
+    }
+
     uint32_t transactionFlags = peekTransactionFlags(eTransactionMask);
     if (transactionFlags) {
         handleTransaction(transactionFlags);
@@ -804,17 +1377,138 @@ void SurfaceFlinger::handleMessageTransaction() {
 
 void SurfaceFlinger::handleMessageInvalidate() {
     ATRACE_CALL();
+    PROFILE_CALL();
     handlePageFlip();
 }
 
 void SurfaceFlinger::handleMessageRefresh() {
     ATRACE_CALL();
+    PROFILE_CALL();
+    // the previous frame must be out before its work-list is refilled
+    waitForPresent();
+    updateRenderScales();
+    if (mFrameBoost) {
+        // the frame is due at the vsync after the one that started it
+        const HWComposer& hwc(getHwComposer());
+        mFrameDeadline = hwc.getRefreshTimestamp(HWC_DISPLAY_PRIMARY) +
+                hwc.getRefreshPeriod(HWC_DISPLAY_PRIMARY);
+    }
     preComposition();
     rebuildLayerStacks();
     setUpHWComposer();
     doDebugFlashRegions();
     doComposition();
+    retirePendingTextureDeletes();
     postComposition();
+    deletePendingTextures();
+    EGLImageCache::getInstance().trim();
+    reclaimIdleBuffers();
+    sampleCpuProfile();
+}
+
+void SurfaceFlinger::reclaimIdleBuffers()
+{
+    if (CC_LIKELY(!mIdleReclaimTimeout))
+        return;
+
+    const nsecs_t now = systemTime();
+    const LayerVector& layers(mDrawingState.layersSortedByZ);
+    const size_t count = layers.size();
+    for (size_t i=0 ; i<count ; i++) {
+        const size_t size = layers[i]->reclaimIdleBuffers(now, mIdleReclaimTimeout);
+        if (size) {
+            android_atomic_add(int32_t(size / 1024), &mReclaimedBufferKb);
+            android_atomic_inc(&mReclaimedBufferCount);
+        }
+    }
+}
+
+status_t SurfaceFlinger::setRenderScale(int type, float maxScale,
+        float minScale)
+{
+    if (type < 0 || type >= DisplayDevice::NUM_DISPLAY_TYPES ||
+            !(maxScale > 0.0f && maxScale <= 1.0f) ||
+            !(minScale == 0.0f || (minScale > 0.0f && minScale <= maxScale))) {
+        return BAD_VALUE;
+    }
+    Mutex::Autolock _l(mRenderScaleLock);
+    RenderScale& rs(mRenderScales[type]);
+    rs.maxScale = maxScale;
+    rs.minScale = minScale;
+    rs.scale = maxScale;
+    rs.slowFrames = 0;
+    rs.fastFrames = 0;
+    return NO_ERROR;
+}
+
+void SurfaceFlinger::updateRenderScales()
+{
+    HWComposer& hwc(getHwComposer());
+    if (hwc.initCheck() != NO_ERROR || !hwc.supportsFramebufferTarget())
+        return;
+
+    // steps of the scale under load, and how many frames it takes to
+    // change it
+    const float STEP = 0.125f;
+    const uint32_t SLOW_FRAMES = 3;
+    const uint32_t FAST_FRAMES = 60;
+
+    Mutex::Autolock _l(mRenderScaleLock);
+    for (size_t dpy=0 ; dpy<mDisplays.size() ; dpy++) {
+        const sp<DisplayDevice>& hw(mDisplays[dpy]);
+        const int32_t type = hw->getDisplayType();
+        const int32_t id = hw->getHwcDisplayId();
+        if (type < 0 || type >= DisplayDevice::NUM_DISPLAY_TYPES || id < 0)
+            continue;
+
+        RenderScale& rs(mRenderScales[type]);
+        const nsecs_t latency = rs.minScale ?
+                hwc.takeFramebufferTargetLatency(id) : 0;
+        if (latency) {
+            // the GPU is the bottleneck when the composition of a frame
+            // finishes late in the next one
+            const nsecs_t period = hwc.getRefreshPeriod(id);
+            if (latency > period * 3 / 4) {
+                rs.fastFrames = 0;
+                if (++rs.slowFrames >= SLOW_FRAMES) {
+                    rs.slowFrames = 0;
+                    rs.scale = max(rs.scale - STEP, rs.minScale);
+                }
+            } else if (latency < period / 3) {
+                rs.slowFrames = 0;
+                if (++rs.fastFrames >= FAST_FRAMES) {
+                    rs.fastFrames = 0;
+                    rs.scale = min(rs.scale + STEP, rs.maxScale);
+                }
+            } else {
+                rs.slowFrames = 0;
+                rs.fastFrames = 0;
+            }
+        }
+
+        if (hw->getRenderScale() != rs.scale && hw->setRenderScale(rs.scale)) {
+            ATRACE_INT("RenderScale", int(rs.scale * 100));
+            // the framebuffer target's source crop changes
+            invalidateHwcGeometry();
+        }
+    }
+}
+
+void SurfaceFlinger::sampleCpuProfile()
+{
+    if (CC_LIKELY(!mCpuProfilePeriod))
+        return;
+
+    const nsecs_t now = systemTime();
+    if (now - mLastCpuProfileSample < mCpuProfilePeriod)
+        return;
+    mLastCpuProfileSample = now;
+
+    ATRACE_CALL();
+    Mutex::Autolock _l(mCpuProfilerLock);
+    // binder threads come and go, look for new ones every time
+    mCpuProfiler.addAllThreads();
+    mCpuProfiler.sample();
 }
 
 void SurfaceFlinger::doDebugFlashRegions()
@@ -859,6 +1553,7 @@ void SurfaceFlinger::doDebugFlashRegions()
     }
 
     postFramebuffer();
+    waitForPresent();
 
     if (mDebugRegion > 1) {
         usleep(mDebugRegion * 1000);
@@ -873,6 +1568,7 @@ void SurfaceFlinger::doDebugFlashRegions()
 
 void SurfaceFlinger::preComposition()
 {
+    PROFILE_CALL();
     bool needExtraInvalidate = false;
     const LayerVector& currentLayers(mDrawingState.layersSortedByZ);
     const size_t count = currentLayers.size();
@@ -888,16 +1584,67 @@ void SurfaceFlinger::preComposition()
 
 void SurfaceFlinger::postComposition()
 {
-    const LayerVector& currentLayers(mDrawingState.layersSortedByZ);
+    PROFILE_CALL();
+    const bool animCompositionPending = mAnimCompositionPending;
+    mAnimCompositionPending = false;
+
+    if (mPresentWorker != NULL) {
+        // the present fences aren't known until the present thread is
+        // done with commit(), finish the frame from there
+        mPostCompositionJob->layers = mDrawingState.layersSortedByZ;
+        mPostCompositionJob->animCompositionPending = animCompositionPending;
+        mPostCompositionJob->frameDeadline = mFrameDeadline;
+        mPresentWorker->post(mPostCompositionJob);
+        return;
+    }
+    postComposition(mDrawingState.layersSortedByZ, animCompositionPending,
+            mFrameDeadline);
+}
+
+void SurfaceFlinger::postComposition(const LayerVector& currentLayers,
+        bool animCompositionPending, nsecs_t frameDeadline)
+{
+    if (mFrameBoost && frameDeadline) {
+        // the frame is out once commit() returned, which it has by now
+        updateFrameBoost(frameDeadline - systemTime(),
+                getHwComposer().getRefreshPeriod(HWC_DISPLAY_PRIMARY));
+    }
+
     const size_t count = currentLayers.size();
     for (size_t i=0 ; i<count ; i++) {
         currentLayers[i]->onPostComposition();
     }
 
-    if (mAnimCompositionPending) {
-        mAnimCompositionPending = false;
+    if (mVsyncPrediction) {
+        const HWComposer& hwc = getHwComposer();
+        sp<Fence> presentFence = hwc.getDisplayFence(HWC_DISPLAY_PRIMARY);
+        Mutex::Autolock _l(mHWVsyncLock);
+        if (!presentFence->isValid()) {
+            // skip the frame. Without present fences there is no way to
+            // tell that the model drifted, so after a while of none check
+            // it against h/w vsync again.
+            if (++mMissingPresentFences >= MAX_MISSING_PRESENT_FENCES) {
+                ALOGW("no present fences for %d frames, resyncing",
+                        mMissingPresentFences);
+                mMissingPresentFences = 0;
+                if (mPrimaryVsyncListening) {
+                    resyncToHardwareVsyncLocked();
+                }
+            }
+        } else {
+            mMissingPresentFences = 0;
+            if (mPrimaryDispSync.addPresentFence(presentFence)) {
+                if (mPrimaryVsyncListening) {
+                    resyncToHardwareVsyncLocked();
+                }
+            }
+        }
+    }
 
+    if (animCompositionPending) {
         const HWComposer& hwc = getHwComposer();
+        mAnimFrameTracker.setDisplayRefreshPeriod(
+                hwc.getRefreshPeriod(HWC_DISPLAY_PRIMARY));
         sp<Fence> presentFence = hwc.getDisplayFence(HWC_DISPLAY_PRIMARY);
         if (presentFence->isValid()) {
             mAnimFrameTracker.setActualPresentFence(presentFence);
@@ -911,7 +1658,81 @@ void SurfaceFlinger::postComposition()
     }
 }
 
+void SurfaceFlinger::updateFrameBoost(nsecs_t slack, nsecs_t refreshPeriod)
+{
+    // slack averaged over the last few frames
+    const nsecs_t prevAvg = mAvgFrameSlack;
+    mAvgFrameSlack += (slack - mAvgFrameSlack) / 4;
+
+    int level;
+    if (slack < 0) {
+        level = PowerHAL::MAX_FRAME_BOOST;      // missed
+    } else if (mAvgFrameSlack < refreshPeriod / 8) {
+        level = 2;
+    } else if (mAvgFrameSlack < refreshPeriod / 4) {
+        level = 1;
+    } else {
+        level = 0;
+    }
+
+    // only boost while the slack shrinks, a steady small slack means the
+    // clocks are right; dropping a level is always fine
+    if (level > mFrameBoostLevel && slack >= prevAvg && slack >= 0) {
+        level = mFrameBoostLevel;
+    }
+    if (level || mFrameBoostLevel) {
+        ATRACE_INT("FrameBoost", level);
+        mPowerHAL.frameBoostHint(level, refreshPeriod);
+    }
+    mFrameBoostLevel = level;
+}
+
+class SurfaceFlinger::ComputeVisibleRegionsJob : public WorkerPool::Job {
+public:
+    ComputeVisibleRegionsJob() : layers(NULL), cache(NULL),
+            dpyId(-1), layerStack(DisplayDevice::NO_LAYER_STACK) { }
+    virtual void run() {
+        SurfaceFlinger::computeVisibleRegions(dpyId, *layers, layerStack,
+                dirtyRegion, opaqueRegion, cache);
+    }
+    const LayerVector* layers;
+    DisplayDevice::VisibleRegionCache* cache;
+    int dpyId;
+    uint32_t layerStack;
+    Region dirtyRegion;
+    Region opaqueRegion;
+};
+
+bool SurfaceFlinger::canComputeVisibleRegionsConcurrently() const {
+#if defined(QCOM_HARDWARE) || defined(QCOM_BSP)
+    // computeVisibleRegions() writes the regions of layers that are not
+    // on the display's layer stack, so displays can't be processed in
+    // parallel.
+    return false;
+#else
+    // the visible regions are stored in the layers, so this is only safe
+    // when no two displays present the same layer stack.
+    size_t drawable = 0;
+    for (size_t dpy=0 ; dpy<mDisplays.size() ; dpy++) {
+        const sp<DisplayDevice>& hw(mDisplays[dpy]);
+        if (!hw->canDraw()) {
+            continue;
+        }
+        for (size_t j=0 ; j<dpy ; j++) {
+            const sp<DisplayDevice>& other(mDisplays[j]);
+            if (other->canDraw() &&
+                    other->getLayerStack() == hw->getLayerStack()) {
+                return false;
+            }
+        }
+        drawable++;
+    }
+    return drawable > 1;
+#endif
+}
+
 void SurfaceFlinger::rebuildLayerStacks() {
+    PROFILE_CALL();
     // rebuild the visible layer list per screen
     if (CC_UNLIKELY(mVisibleRegionsDirty)) {
         ATRACE_CALL();
@@ -919,18 +1740,63 @@ void SurfaceFlinger::rebuildLayerStacks() {
         invalidateHwcGeometry();
 
         const LayerVector& currentLayers(mDrawingState.layersSortedByZ);
-        for (size_t dpy=0 ; dpy<mDisplays.size() ; dpy++) {
-            Region opaqueRegion;
-            Region dirtyRegion;
+        const size_t numDisplays = mDisplays.size();
+
+        // compute the visible regions of each screen. Once the layers have
+        // latched, displays are independent and can be processed
+        // concurrently.
+        Vector<ComputeVisibleRegionsJob> jobs;
+        jobs.insertAt(0, numDisplays);
+        for (size_t dpy=0 ; dpy<numDisplays ; dpy++) {
+            const sp<DisplayDevice>& hw(mDisplays[dpy]);
+            ComputeVisibleRegionsJob& job(jobs.editItemAt(dpy));
+            if (hw->canDraw()) {
+                job.layers = &currentLayers;
+                job.cache = mIncrementalVisibleRegions ?
+                        &hw->visibleRegionCache : NULL;
+                job.dpyId = hw->getHwcDisplayId();
+                job.layerStack = hw->getLayerStack();
+            } else {
+                hw->visibleRegionCache.clear();
+            }
+        }
+
+        if (mParallelVisibleRegions && canComputeVisibleRegionsConcurrently()) {
+            if (mVisibleRegionWorkers == NULL) {
+                mVisibleRegionWorkers = new WorkerPool("VisibleRegions",
+                        DisplayDevice::NUM_DISPLAY_TYPES);
+            }
+            // keep one display for the main thread
+            ComputeVisibleRegionsJob* mainThreadJob = NULL;
+            for (size_t dpy=0 ; dpy<numDisplays ; dpy++) {
+                ComputeVisibleRegionsJob& job(jobs.editItemAt(dpy));
+                if (job.layers) {
+                    if (mainThreadJob == NULL) {
+                        mainThreadJob = &job;
+                    } else {
+                        mVisibleRegionWorkers->post(&job);
+                    }
+                }
+            }
+            mainThreadJob->run();
+            mVisibleRegionWorkers->wait();
+        } else {
+            for (size_t dpy=0 ; dpy<numDisplays ; dpy++) {
+                ComputeVisibleRegionsJob& job(jobs.editItemAt(dpy));
+                if (job.layers) {
+                    job.run();
+                }
+            }
+        }
+
+        SortedVector<const Layer*> onScreenLayers;
+        for (size_t dpy=0 ; dpy<numDisplays ; dpy++) {
+            const ComputeVisibleRegionsJob& job(jobs[dpy]);
             Vector< sp<Layer> > layersSortedByZ;
             const sp<DisplayDevice>& hw(mDisplays[dpy]);
             const Transform& tr(hw->getTransform());
             const Rect bounds(hw->getBounds());
-            int dpyId = hw->getHwcDisplayId();
-            if (hw->canDraw()) {
-                SurfaceFlinger::computeVisibleRegions(dpyId, currentLayers,
-                        hw->getLayerStack(), dirtyRegion, opaqueRegion);
-
+            if (job.layers) {
                 const size_t count = currentLayers.size();
                 for (size_t i=0 ; i<count ; i++) {
                     const sp<Layer>& layer(currentLayers[i]);
@@ -938,11 +1804,21 @@ void SurfaceFlinger::rebuildLayerStacks() {
 #ifndef QCOM_HARDWARE
                     if (s.layerStack == hw->getLayerStack()) {
 #endif
-                        Region drawRegion(tr.transform(
-                                layer->visibleNonTransparentRegion));
+                        // cull off-screen and occluded layers before
+                        // transforming their region
+                        const Region& visible(
+                                layer->visibleNonTransparentRegion);
+                        Rect drawBounds;
+                        if (visible.isEmpty() ||
+                                !tr.transform(visible.getBounds()).intersect(
+                                        bounds, &drawBounds)) {
+                            continue;
+                        }
+                        Region drawRegion(tr.transform(visible));
                         drawRegion.andSelf(bounds);
                         if (!drawRegion.isEmpty()) {
                             layersSortedByZ.add(layer);
+                            onScreenLayers.add(layer.get());
                         }
 #ifndef QCOM_HARDWARE
                     }
@@ -951,13 +1827,23 @@ void SurfaceFlinger::rebuildLayerStacks() {
             }
             hw->setVisibleLayersSortedByZ(layersSortedByZ);
             hw->undefinedRegion.set(bounds);
-            hw->undefinedRegion.subtractSelf(tr.transform(opaqueRegion));
-            hw->dirtyRegion.orSelf(dirtyRegion);
+            hw->undefinedRegion.subtractSelf(tr.transform(job.opaqueRegion));
+            hw->dirtyRegion.orSelf(job.dirtyRegion);
+        }
+
+        // all displays are now up-to-date
+        const nsecs_t now = systemTime();
+        const size_t count = currentLayers.size();
+        for (size_t i=0 ; i<count ; i++) {
+            const sp<Layer>& layer(currentLayers[i]);
+            layer->geometryDirty = false;
+            layer->setOnScreen(onScreenLayers.indexOf(layer.get()) >= 0, now);
         }
     }
 }
 
 void SurfaceFlinger::setUpHWComposer() {
+    PROFILE_CALL();
     HWComposer& hwc(getHwComposer());
     if (hwc.initCheck() == NO_ERROR) {
         // build the h/w work list
@@ -985,31 +1871,34 @@ void SurfaceFlinger::setUpHWComposer() {
             }
         }
 
+        // the screenshot layer freezes all the displays alike, there is no
+        // need to look for it (or to read the property) for each of them.
+        bool freezeSurfacePresent = false;
+        char value[PROPERTY_VALUE_MAX];
+        property_get("sys.disable_ext_animation", value, "0");
+        if (atoi(value)) {
+            // Get the layers in the current drawying state
+            const LayerVector& layers(mDrawingState.layersSortedByZ);
+            const size_t layerCount = layers.size();
+            for (size_t i = 0 ; i < layerCount ; ++i) {
+                static int screenShotLen = strlen("ScreenshotSurface");
+                const sp<Layer>& layer(layers[i]);
+                if (!strncmp(layer->getName(), "ScreenshotSurface",
+                            screenShotLen)) {
+                    // Screenshot layer is present, and animation in
+                    // progress
+                    freezeSurfacePresent = true;
+                    break;
+                }
+            }
+        }
+
         // set the per-frame data
+        bool hasHwcLayers = false;
         for (size_t dpy=0 ; dpy<mDisplays.size() ; dpy++) {
             sp<const DisplayDevice> hw(mDisplays[dpy]);
             const int32_t id = hw->getHwcDisplayId();
             if (id >= 0) {
-                // Get the layers in the current drawying state
-                const LayerVector& layers(mDrawingState.layersSortedByZ);
-                bool freezeSurfacePresent = false;
-                const size_t layerCount = layers.size();
-                char value[PROPERTY_VALUE_MAX];
-                property_get("sys.disable_ext_animation", value, "0");
-                if(atoi(value)) {
-                    for (size_t i = 0 ; i < layerCount ; ++i) {
-                        static int screenShotLen = strlen("ScreenshotSurface");
-                        const sp<Layer>& layer(layers[i]);
-                        if(!strncmp(layer->getName(), "ScreenshotSurface",
-                                    screenShotLen)) {
-                            // Screenshot layer is present, and animation in
-                            // progress
-                            freezeSurfacePresent = true;
-                            break;
-                        }
-                    }
-                }
-
                 const Vector< sp<Layer> >& currentLayers(
                     hw->getVisibleLayersSortedByZ());
                 const size_t count = currentLayers.size();
@@ -1022,37 +1911,41 @@ void SurfaceFlinger::setUpHWComposer() {
                      */
                     const sp<Layer>& layer(currentLayers[i]);
                     layer->setPerFrameData(hw, *cur);
-                    if(freezeSurfacePresent) {
+                    if (freezeSurfacePresent) {
                         // if freezeSurfacePresent, set ANIMATING flag
                         cur->setAnimating(true);
-                    } else {
-                        const KeyedVector<wp<IBinder>, DisplayDeviceState>&
-                                                draw(mDrawingState.displays);
-                        size_t dc = draw.size();
-                        for (size_t i=0 ; i<dc ; i++) {
-                            if (draw[i].isMainDisplay()) {
-                                HWComposer& hwc(getHwComposer());
-                                if (hwc.initCheck() == NO_ERROR)
-                                    // Pass the current orientation to HWC
-                                    // which will be used to block animation
-                                    // on external
-                                    hwc.eventControl(HWC_DISPLAY_PRIMARY,
-                                            SurfaceFlinger::EVENT_ORIENTATION,
-                                            uint32_t(draw[i].orientation));
-                            }
-                        }
                     }
+                    hasHwcLayers = true;
                 }
             }
         }
 
-        status_t err = hwc.prepare();
+        if (!freezeSurfacePresent && hasHwcLayers) {
+            // Pass the current orientation to HWC which will be used to
+            // block animation on external. It is the same for all the
+            // layers, so it's sent once per frame rather than per layer.
+            const KeyedVector<wp<IBinder>, DisplayDeviceState>&
+                                    draw(mDrawingState.displays);
+            size_t dc = draw.size();
+            for (size_t i=0 ; i<dc ; i++) {
+                if (draw[i].isMainDisplay()) {
+                    hwc.eventControl(HWC_DISPLAY_PRIMARY,
+                            SurfaceFlinger::EVENT_ORIENTATION,
+                            uint32_t(draw[i].orientation));
+                }
+            }
+        }
+
+        // with composition prediction the HAL may still be deciding when
+        // this returns, see doDisplayComposition()
+        status_t err = mDebugRegion ? hwc.prepare() : hwc.beginPrepare();
         ALOGE_IF(err, "HWComposer::prepare failed (%s)", strerror(-err));
     }
 }
 
 void SurfaceFlinger::doComposition() {
     ATRACE_CALL();
+    PROFILE_CALL();
     const bool repaintEverything = android_atomic_and(0, &mRepaintEverything);
     for (size_t dpy=0 ; dpy<mDisplays.size() ; dpy++) {
         const sp<DisplayDevice>& hw(mDisplays[dpy]);
@@ -1070,6 +1963,11 @@ void SurfaceFlinger::doComposition() {
         // inform the h/w that we're done compositing
         hw->compositionComplete();
     }
+    HWComposer& hwc(getHwComposer());
+    if (hwc.initCheck() == NO_ERROR) {
+        // in case no display could be drawn
+        hwc.finishPrepare(-1);
+    }
     postFramebuffer();
 }
 
@@ -1077,6 +1975,36 @@ void SurfaceFlinger::postFramebuffer()
 {
     ATRACE_CALL();
 
+    if (mPresentWorker != NULL) {
+        // doDebugFlashRegions() posts twice per refresh
+        waitForPresent();
+        getPresentedDisplays(mPresentCommitJob->displays);
+        mPresentWorker->post(mPresentCommitJob);
+        return;
+    }
+
+    Vector<PresentedDisplay> displays;
+    getPresentedDisplays(displays);
+    commitFramebuffer(displays);
+}
+
+void SurfaceFlinger::getPresentedDisplays(
+        Vector<PresentedDisplay>& displays) const
+{
+    displays.clear();
+    displays.setCapacity(mDisplays.size());
+    for (size_t dpy=0 ; dpy<mDisplays.size() ; dpy++) {
+        PresentedDisplay d;
+        d.hw = mDisplays[dpy];
+        d.layers = d.hw->getVisibleLayersSortedByZ();
+        displays.add(d);
+    }
+}
+
+void SurfaceFlinger::commitFramebuffer(const Vector<PresentedDisplay>& displays)
+{
+    ATRACE_CALL();
+
     const nsecs_t now = systemTime();
     mDebugInSwapBuffers = now;
 
@@ -1092,9 +2020,9 @@ void SurfaceFlinger::postFramebuffer()
         hwc.commit();
     }
 
-    for (size_t dpy=0 ; dpy<mDisplays.size() ; dpy++) {
-        sp<const DisplayDevice> hw(mDisplays[dpy]);
-        const Vector< sp<Layer> >& currentLayers(hw->getVisibleLayersSortedByZ());
+    for (size_t dpy=0 ; dpy<displays.size() ; dpy++) {
+        const sp<const DisplayDevice>& hw(displays[dpy].hw);
+        const Vector< sp<Layer> >& currentLayers(displays[dpy].layers);
         hw->onSwapBuffersCompleted(hwc);
         const size_t count = currentLayers.size();
         int32_t id = hw->getHwcDisplayId();
@@ -1115,6 +2043,18 @@ void SurfaceFlinger::postFramebuffer()
     mDebugInSwapBuffers = 0;
 }
 
+void SurfaceFlinger::waitForPresent()
+{
+    PROFILE_CALL();
+    if (mPresentWorker != NULL) {
+        mPresentWorker->wait();
+        // drop the references held for the present thread from here, so
+        // that the last one to a layer is never released over there
+        mPresentCommitJob->displays.clear();
+        mPostCompositionJob->layers.clear();
+    }
+}
+
 void SurfaceFlinger::handleTransaction(uint32_t transactionFlags)
 {
     ATRACE_CALL();
@@ -1193,6 +2133,9 @@ void SurfaceFlinger::handleTransactionLocked(uint32_t transactionFlags)
      */
 
     if (transactionFlags & eDisplayTransactionNeeded) {
+        // displays may be disconnected and their work-list freed below
+        waitForPresent();
+
         // here we take advantage of Vector's copy-on-write semantics to
         // improve performance by skipping the transaction entirely when
         // know that the lists are identical
@@ -1447,7 +2390,8 @@ void SurfaceFlinger::commitTransaction()
 
 void SurfaceFlinger::computeVisibleRegions(size_t dpy,
         const LayerVector& currentLayers, uint32_t layerStack,
-        Region& outDirtyRegion, Region& outOpaqueRegion)
+        Region& outDirtyRegion, Region& outOpaqueRegion,
+        DisplayDevice::VisibleRegionCache* cache)
 {
     ATRACE_CALL();
 
@@ -1455,6 +2399,10 @@ void SurfaceFlinger::computeVisibleRegions(size_t dpy,
     Region aboveCoveredLayers;
     Region dirty;
 
+    // largest opaque rectangle above the current layer, layers that fit
+    // in it are culled with a rect test instead of region operations
+    Rect occluder(0, 0);
+
     outDirtyRegion.clear();
     bool bIgnoreLayers = false;
     int extOnlyLayerIndex = -1;
@@ -1472,9 +2420,74 @@ void SurfaceFlinger::computeVisibleRegions(size_t dpy,
     }
     i = currentLayers.size();
 #endif
+
+    typedef DisplayDevice::VisibleRegionCache::Entry CacheEntry;
+    if (cache) {
+        /*
+         * The regions of a layer only depend on the layer itself and on
+         * the layers above it. Starting from the top of the stack, we can
+         * reuse the results of the previous pass until we reach the first
+         * layer whose geometry changed (or the first layer that differs
+         * from the cached list, e.g. when a layer was added or removed).
+         */
+        size_t skip = 0;
+        if (cache->valid && cache->layerStack == layerStack &&
+                cache->ignoreLayers == bIgnoreLayers &&
+                cache->extOnlyLayerIndex == extOnlyLayerIndex) {
+            const size_t cached = cache->entries.size();
+            while (skip < i && skip < cached) {
+                const sp<Layer>& layer = currentLayers[i - 1 - skip];
+                if (layer->geometryDirty ||
+                        cache->entries[skip].layer != layer) {
+                    break;
+                }
+                skip++;
+            }
+        }
+
+        // restore the regions of the skipped layers, another display
+        // may have overwritten them since.
+        for (size_t k=0 ; k<skip ; k++) {
+            const CacheEntry& e(cache->entries[k]);
+            const sp<Layer>& layer = currentLayers[i - 1 - k];
+            if (e.state == CacheEntry::COMPUTED) {
+                layer->setVisibleRegion(e.visibleRegion);
+                layer->setCoveredRegion(e.coveredRegion);
+                layer->setVisibleNonTransparentRegion(
+                        e.visibleNonTransparentRegion);
+            } else if (e.state == CacheEntry::HIDDEN) {
+                layer->setVisibleNonTransparentRegion(Region());
+            }
+        }
+        if (skip) {
+            aboveOpaqueLayers = cache->entries[skip-1].belowOpaqueLayers;
+            aboveCoveredLayers = cache->entries[skip-1].belowCoveredLayers;
+        }
+        cache->entries.removeItemsAt(skip, cache->entries.size() - skip);
+        cache->valid = true;
+        cache->layerStack = layerStack;
+        cache->ignoreLayers = bIgnoreLayers;
+        cache->extOnlyLayerIndex = extOnlyLayerIndex;
+        cache->lastSkipped = skip;
+        cache->lastCount = i;
+        cache->totalSkipped += skip;
+        cache->totalCount += i;
+        i -= skip;
+    }
+
     while (i--) {
         const sp<Layer>& layer = currentLayers[i];
 
+        // remember the state of the layers above, in case we bail out early
+        CacheEntry* entry = NULL;
+        if (cache) {
+            entry = &cache->entries.editItemAt(cache->entries.add());
+            entry->layer = layer;
+            entry->state = CacheEntry::UNTOUCHED;
+            entry->belowOpaqueLayers = aboveOpaqueLayers;
+            entry->belowCoveredLayers = aboveCoveredLayers;
+        }
+
         // start with the whole surface at its current location
         const Layer::State& s(layer->drawingState());
 #ifdef QCOM_BSP
@@ -1489,6 +2502,9 @@ void SurfaceFlinger::computeVisibleRegions(size_t dpy,
             Region visibleNonTransRegion;
             visibleNonTransRegion.set(Rect(0,0));
             layer->setVisibleNonTransparentRegion(visibleNonTransRegion);
+            if (entry) {
+                entry->state = CacheEntry::HIDDEN;
+            }
             continue;
         }
 #endif
@@ -1502,6 +2518,9 @@ void SurfaceFlinger::computeVisibleRegions(size_t dpy,
             Region visibleNonTransRegion;
             visibleNonTransRegion.set(Rect(0,0));
             layer->setVisibleNonTransparentRegion(visibleNonTransRegion);
+            if (entry) {
+                entry->state = CacheEntry::HIDDEN;
+            }
 #endif
             continue;
         }
@@ -1539,6 +2558,23 @@ void SurfaceFlinger::computeVisibleRegions(size_t dpy,
         if (CC_LIKELY(layer->isVisible())) {
             const bool translucent = !layer->isOpaque();
             Rect bounds(s.transform.transform(layer->computeBounds()));
+            if (!layer->contentDirty && layer->visibleRegion.isEmpty() &&
+                    !bounds.isEmpty() && occluder.contains(bounds)) {
+                // the layer was and still is fully occluded: it's covered
+                // by the layers above, nothing is exposed, and it doesn't
+                // change what the layers below see.
+                layer->setVisibleRegion(visibleRegion);
+                layer->setCoveredRegion(Region(bounds));
+                layer->setVisibleNonTransparentRegion(visibleRegion);
+                if (entry) {
+                    entry->state = CacheEntry::COMPUTED;
+                    entry->visibleRegion = layer->visibleRegion;
+                    entry->coveredRegion = layer->coveredRegion;
+                    entry->visibleNonTransparentRegion =
+                            layer->visibleNonTransparentRegion;
+                }
+                continue;
+            }
             visibleRegion.set(bounds);
             if (!visibleRegion.isEmpty()) {
                 // Remove the transparent area from the visible region
@@ -1610,12 +2646,29 @@ void SurfaceFlinger::computeVisibleRegions(size_t dpy,
 
         // Update aboveOpaqueLayers for next (lower) layer
         aboveOpaqueLayers.orSelf(opaqueRegion);
+        if (opaqueRegion.isRect()) {
+            const Rect opaque(opaqueRegion.getBounds());
+            if (int64_t(opaque.width()) * opaque.height() >
+                    int64_t(occluder.width()) * occluder.height()) {
+                occluder = opaque;
+            }
+        }
 
         // Store the visible region in screen space
         layer->setVisibleRegion(visibleRegion);
         layer->setCoveredRegion(coveredRegion);
         layer->setVisibleNonTransparentRegion(
                 visibleRegion.subtract(transparentRegion));
+
+        if (entry) {
+            entry->state = CacheEntry::COMPUTED;
+            entry->visibleRegion = layer->visibleRegion;
+            entry->coveredRegion = layer->coveredRegion;
+            entry->visibleNonTransparentRegion =
+                    layer->visibleNonTransparentRegion;
+            entry->belowOpaqueLayers = aboveOpaqueLayers;
+            entry->belowCoveredLayers = aboveCoveredLayers;
+        }
     }
 
     outOpaqueRegion = aboveOpaqueLayers;
@@ -1633,14 +2686,29 @@ void SurfaceFlinger::invalidateLayerStack(uint32_t layerStack,
 
 void SurfaceFlinger::handlePageFlip()
 {
+    // the post-composition of the last frame still reads the latched
+    // buffers of the layers
+    waitForPresent();
+
     Region dirtyRegion;
 
+    // this frame is presented on the next refresh of the primary display
+    const HWComposer& hwc(getHwComposer());
+    const nsecs_t expectedPresent = hwc.getRefreshTimestamp(HWC_DISPLAY_PRIMARY)
+            + hwc.getRefreshPeriod(HWC_DISPLAY_PRIMARY);
+
     bool visibleRegions = false;
     const LayerVector& currentLayers(mDrawingState.layersSortedByZ);
     const size_t count = currentLayers.size();
     for (size_t i=0 ; i<count ; i++) {
         const sp<Layer>& layer(currentLayers[i]);
-        const Region dirty(layer->latchBuffer(visibleRegions));
+        bool layerVisibleRegions = false;
+        const Region dirty(layer->latchBuffer(layerVisibleRegions,
+                expectedPresent));
+        if (layerVisibleRegions) {
+            layer->geometryDirty = true;
+            visibleRegions = true;
+        }
         const Layer::State& s(layer->drawingState());
         invalidateLayerStack(s.layerStack, dirty);
     }
@@ -1675,6 +2743,13 @@ void SurfaceFlinger::doDisplayComposition(const sp<const DisplayDevice>& hw,
             // This is needed because PARTIAL_UPDATES only takes one
             // rectangle instead of a region (see DisplayDevice::flip())
             dirtyRegion.set(hw->swapRegion.bounds());
+        } else if (mUseBufferAge && !mDebugRegion &&
+                DisplayDevice::makeCurrent(mEGLDisplay, hw, mEGLContext)) {
+            // we only need to redraw what changed since the back buffer
+            // was last drawn. doComposeSurfaces() scissors to that
+            // rectangle, so make sure to redraw all of it.
+            dirtyRegion.set(hw->getBufferAgeRepaintRegion(dirtyRegion).bounds());
+            hw->swapRegion = dirtyRegion;
         } else {
             // we need to redraw everything (the whole screen)
             dirtyRegion.set(hw->bounds());
@@ -1684,6 +2759,16 @@ void SurfaceFlinger::doDisplayComposition(const sp<const DisplayDevice>& hw,
 
     doComposeSurfaces(hw, dirtyRegion);
 
+    HWComposer& hwc(getHwComposer());
+    if (hwc.initCheck() == NO_ERROR && hwc.finishPrepare(hw->getHwcDisplayId())) {
+        // this was composed with mispredicted composition types, clear
+        // what was drawn and start over with the ones the HAL picked
+        if (DisplayDevice::makeCurrent(mEGLDisplay, hw, mEGLContext)) {
+            drawWormhole(hw, dirtyRegion);
+        }
+        doComposeSurfaces(hw, dirtyRegion);
+    }
+
     // update the swap region and clear the dirty region
     hw->swapRegion.orSelf(dirtyRegion);
 
@@ -1710,6 +2795,16 @@ void SurfaceFlinger::doComposeSurfaces(const sp<const DisplayDevice>& hw, const
         glMatrixMode(GL_MODELVIEW);
         glLoadIdentity();
 
+        // when redrawing only part of the back buffer, make sure not
+        // to touch anything outside of it, including when clearing.
+        Rect scissor(hw->getBounds());
+        if (mUseBufferAge) {
+            dirty.getBounds().intersect(scissor, &scissor);
+            if (scissor != hw->getBounds()) {
+                hw->setScissor(scissor);
+            }
+        }
+
         // Never touch the framebuffer if we don't have any framebuffer layers
         const bool hasHwcComposition = hwc.hasHwcComposition(id);
         if (hasHwcComposition) {
@@ -1747,16 +2842,12 @@ void SurfaceFlinger::doComposeSurfaces(const sp<const DisplayDevice>& hw, const
             // scissor on the main display. It should never be needed
             // anyways (though in theory it could since the API allows it).
             const Rect& bounds(hw->getBounds());
-            const Rect& scissor(hw->getScissor());
+            hw->getScissor().intersect(scissor, &scissor);
             if (scissor != bounds) {
                 // scissor doesn't match the screen's dimensions, so we
                 // need to clear everything outside of it and enable
                 // the GL scissor so we don't draw anything where we shouldn't
-                const GLint height = hw->getHeight();
-                glScissor(scissor.left, height - scissor.bottom,
-                        scissor.getWidth(), scissor.getHeight());
-                // enable scissor for this frame
-                glEnable(GL_SCISSOR_TEST);
+                hw->setScissor(scissor);
             }
         }
     }
@@ -1767,12 +2858,28 @@ void SurfaceFlinger::doComposeSurfaces(const sp<const DisplayDevice>& hw, const
 
     const Vector< sp<Layer> >& layers(hw->getVisibleLayersSortedByZ());
     const size_t count = layers.size();
-    const Transform& tr = hw->getTransform();
+
+    // number of bottom-most layers already drawn from the composition cache
+    size_t cachedLayers = 0;
+    if (mUseCompositionCache && hasGlesComposition) {
+        cachedLayers = drawCompositionCache(hw, dirty);
+    }
+
+    // skip redundant GL state changes between consecutive layers
+    if (hasGlesComposition) {
+        mGLState.begin();
+    }
+
     if (cur != end) {
         // we're using h/w composer
         for (size_t i=0 ; i<count && cur!=end ; ++i, ++cur) {
             const sp<Layer>& layer(layers[i]);
-            const Region clip(dirty.intersect(tr.transform(layer->visibleRegion)));
+            if (i < cachedLayers) {
+                layer->setAcquireFence(hw, *cur);
+                continue;
+            }
+            const Region clip(dirty.intersect(
+                    layer->getVisibleRegionScreen(hw, false)));
             if (!clip.isEmpty()) {
                 switch (cur->getCompositionType()) {
                     case HWC_OVERLAY: {
@@ -1800,20 +2907,107 @@ void SurfaceFlinger::doComposeSurfaces(const sp<const DisplayDevice>& hw, const
             }
             layer->setAcquireFence(hw, *cur);
         }
-    } else {
-        // we're not using h/w composer
-        for (size_t i=0 ; i<count ; ++i) {
+    } else {
+        // we're not using h/w composer
+        for (size_t i=cachedLayers ; i<count ; ++i) {
+            const sp<Layer>& layer(layers[i]);
+            const Region clip(dirty.intersect(
+                    layer->getVisibleRegionScreen(hw, false)));
+            if (!clip.isEmpty()) {
+                layer->draw(hw, clip);
+            }
+        }
+    }
+
+    if (hasGlesComposition) {
+        mGLState.end();
+    }
+
+    // disable scissor at the end of the frame
+    glDisable(GL_SCISSOR_TEST);
+}
+
+size_t SurfaceFlinger::drawCompositionCache(const sp<const DisplayDevice>& hw,
+        const Region& dirty)
+{
+    const int32_t id = hw->getHwcDisplayId();
+    HWComposer& hwc(getHwComposer());
+    HWComposer::LayerListIterator cur = hwc.begin(id);
+    const HWComposer::LayerListIterator end = hwc.end(id);
+    const bool hasHwcList = (cur != end);
+
+    // only the bottom-most run of GLES composited layers can be cached,
+    // since the cached image replaces whatever is below it.
+    const Vector< sp<Layer> >& layers(hw->getVisibleLayersSortedByZ());
+    const size_t count = layers.size();
+    Vector<CompositionCache::Key> keys;
+    for (size_t i=0 ; i<count ; ++i) {
+        if (hasHwcList) {
+            if (cur == end || cur->getCompositionType() != HWC_FRAMEBUFFER) {
+                break;
+            }
+            ++cur;
+        }
+        const sp<Layer>& layer(layers[i]);
+        if (layer->isProtected()) {
+            // we can't render protected buffers into a texture
+            break;
+        }
+        CompositionCache::Key key;
+        key.layer = layer;
+        key.sequence = layer->drawingState().sequence;
+        key.bufferGeneration = layer->getBufferGeneration();
+        key.visibleRegion = layer->visibleRegion;
+        keys.add(key);
+    }
+
+    CompositionCache& cache(hw->compositionCache);
+    size_t cachedLayers = cache.update(keys);
+    if (!cachedLayers) {
+        const size_t candidates = cache.getCandidateCount();
+        if (!candidates ||
+                !cache.beginCapture(hw->getRenderWidth(), hw->getRenderHeight())) {
+            return 0;
+        }
+        // render the whole footprint of these layers, not only what's dirty
+        const Region bounds(hw->bounds());
+        for (size_t i=0 ; i<candidates ; ++i) {
             const sp<Layer>& layer(layers[i]);
-            const Region clip(dirty.intersect(
-                    tr.transform(layer->visibleRegion)));
+            const Region clip(bounds.intersect(
+                    layer->getVisibleRegionScreen(hw, false)));
             if (!clip.isEmpty()) {
                 layer->draw(hw, clip);
             }
         }
+        cache.endCapture(candidates);
+        cachedLayers = candidates;
     }
 
-    // disable scissor at the end of the frame
-    glDisable(GL_SCISSOR_TEST);
+    cache.draw(dirty, hw->getWidth(), hw->getHeight());
+    return cachedLayers;
+}
+
+sp<GraphicBuffer> SurfaceFlinger::createSolidColorBuffer(
+        const sp<const DisplayDevice>& hw)
+{
+    // a quarter of the display keeps the upscaling within what overlays
+    // usually handle, for a fraction of the memory
+    const uint32_t w = max(hw->getWidth() / 4, 1);
+    const uint32_t h = max(hw->getHeight() / 4, 1);
+    sp<GraphicBuffer> buffer = new GraphicBuffer(w, h, PIXEL_FORMAT_RGBX_8888,
+            GRALLOC_USAGE_HW_COMPOSER | GRALLOC_USAGE_HW_TEXTURE |
+            GRALLOC_USAGE_SW_WRITE_RARELY);
+    if (buffer->initCheck() != NO_ERROR) {
+        return NULL;
+    }
+    uint8_t* vaddr;
+    if (buffer->lock(GRALLOC_USAGE_SW_WRITE_RARELY,
+            reinterpret_cast<void**>(&vaddr)) != NO_ERROR) {
+        return NULL;
+    }
+    memset(vaddr, 0, buffer->getStride() * h * 4);
+    buffer->unlock();
+    return buffer;
 }
 
 void SurfaceFlinger::drawWormhole(const sp<const DisplayDevice>& hw,
@@ -1892,6 +3086,19 @@ void SurfaceFlinger::setTransactionState(
         uint32_t flags)
 {
     ATRACE_CALL();
+
+    if (mQueueTransactions && !(flags & (eSynchronous | eAnimation))) {
+        // nobody waits for this transaction, hand it over to the main
+        // thread without contending for mStateLock
+        TransactionQueue::Transaction* t = new TransactionQueue::Transaction();
+        t->state = state;
+        t->displays = displays;
+        if (mPendingTransactions.push(t)) {
+            signalTransaction();
+        }
+        return;
+    }
+
     Mutex::Autolock _l(mStateLock);
     uint32_t transactionFlags = 0;
 
@@ -1911,6 +3118,41 @@ void SurfaceFlinger::setTransactionState(
         }
     }
 
+    // transactions queued before this one must be applied first
+    transactionFlags |= applyPendingTransactionsLocked();
+    transactionFlags |= applyTransactionStateLocked(state, displays);
+
+    if (transactionFlags) {
+        // this triggers the transaction
+        setTransactionFlags(transactionFlags);
+
+        // if this is a synchronous transaction, wait for it to take effect
+        // before returning.
+        if (flags & eSynchronous) {
+            mTransactionPending = true;
+        }
+        if (flags & eAnimation) {
+            mAnimTransactionPending = true;
+        }
+        while (mTransactionPending) {
+            status_t err = mTransactionCV.waitRelative(mStateLock, s2ns(5));
+            if (CC_UNLIKELY(err != NO_ERROR)) {
+                // just in case something goes wrong in SF, return to the
+                // called after a few seconds.
+                ALOGW_IF(err == TIMED_OUT, "setTransactionState timed out!");
+                mTransactionPending = false;
+                break;
+            }
+        }
+    }
+}
+
+uint32_t SurfaceFlinger::applyTransactionStateLocked(
+        const Vector<ComposerState>& state,
+        const Vector<DisplayState>& displays)
+{
+    uint32_t transactionFlags = 0;
+
     size_t count = displays.size();
     for (size_t i=0 ; i<count ; i++) {
         const DisplayState& s(displays[i]);
@@ -1939,29 +3181,21 @@ void SurfaceFlinger::setTransactionState(
         }
     }
 
-    if (transactionFlags) {
-        // this triggers the transaction
-        setTransactionFlags(transactionFlags);
+    return transactionFlags;
+}
 
-        // if this is a synchronous transaction, wait for it to take effect
-        // before returning.
-        if (flags & eSynchronous) {
-            mTransactionPending = true;
-        }
-        if (flags & eAnimation) {
-            mAnimTransactionPending = true;
-        }
-        while (mTransactionPending) {
-            status_t err = mTransactionCV.waitRelative(mStateLock, s2ns(5));
-            if (CC_UNLIKELY(err != NO_ERROR)) {
-                // just in case something goes wrong in SF, return to the
-                // called after a few seconds.
-                ALOGW_IF(err == TIMED_OUT, "setTransactionState timed out!");
-                mTransactionPending = false;
-                break;
-            }
-        }
+uint32_t SurfaceFlinger::applyPendingTransactionsLocked()
+{
+    uint32_t transactionFlags = 0;
+    TransactionQueue::Transaction* t = mPendingTransactions.popAll();
+    while (t) {
+        ATRACE_NAME("applyPendingTransaction");
+        transactionFlags |= applyTransactionStateLocked(t->state, t->displays);
+        TransactionQueue::Transaction* next = t->next;
+        delete t;
+        t = next;
     }
+    return transactionFlags;
 }
 
 uint32_t SurfaceFlinger::setDisplayStateLocked(const DisplayState& s)
@@ -2019,9 +3253,8 @@ uint32_t SurfaceFlinger::setClientStateLocked(
         if (what & layer_state_t::eLayerChanged) {
             // NOTE: index needs to be calculated before we update the state
             ssize_t idx = mCurrentState.layersSortedByZ.indexOf(layer);
-            if (layer->setLayer(s.z)) {
-                mCurrentState.layersSortedByZ.removeAt(idx);
-                mCurrentState.layersSortedByZ.add(layer);
+            if (layer->setLayer(s.z) && idx >= 0) {
+                mCurrentState.layersSortedByZ.reorder(idx);
                 // we need traversal (state changed)
                 // AND transaction (list changed)
                 flags |= eTransactionNeeded|eTraversalNeeded;
@@ -2224,12 +3457,18 @@ void SurfaceFlinger::onScreenAcquired(const sp<const DisplayDevice>& hw) {
     hw->acquireScreen();
     int32_t type = hw->getDisplayType();
     if (type < DisplayDevice::NUM_DISPLAY_TYPES) {
+        waitForPresent();
         // built-in display, tell the HWC
         getHwComposer().acquire(type);
 
         if (type == DisplayDevice::DISPLAY_PRIMARY) {
+            // the display may not come back with the same phase, make sure
+            // the model is resynchronized before we rely on it again
+            mPrimaryDispSync.beginResync();
+
             // FIXME: eventthread only knows about the main display right now
             mEventThread->onScreenAcquired();
+            mSFEventThread->onScreenAcquired();
         }
     }
     mVisibleRegionsDirty = true;
@@ -2249,9 +3488,14 @@ void SurfaceFlinger::onScreenReleased(const sp<const DisplayDevice>& hw) {
         if (type == DisplayDevice::DISPLAY_PRIMARY) {
             // FIXME: eventthread only knows about the main display right now
             mEventThread->onScreenReleased();
+            mSFEventThread->onScreenReleased();
+
+            // nothing is going to be created for a while
+            GraphicBufferAllocator::get().trimPool(0);
         }
 
         // built-in display, tell the HWC
+        waitForPresent();
         getHwComposer().release(type);
     }
     mVisibleRegionsDirty = true;
@@ -2321,6 +3565,14 @@ status_t SurfaceFlinger::dump(int fd, const Vector<String16>& args)
         snprintf(buffer, SIZE, "Permission Denial: "
                 "can't dump SurfaceFlinger from pid=%d, uid=%d\n", pid, uid);
         result.append(buffer);
+    } else if (args.size() && args[0] == String16("--stats")) {
+        dumpCounters(result);
+    } else if (args.size() && args[0] == String16("--profile")) {
+        // --profile [reset]: the profiler has its own locks
+        Profiler::dump(result);
+        if (args.size() > 1 && args[1] == String16("reset")) {
+            Profiler::reset();
+        }
     } else {
         // Try to get the main lock, but don't insist if we can't
         // (this would indicate SF is stuck, but we want to be able to
@@ -2337,7 +3589,7 @@ status_t SurfaceFlinger::dump(int fd, const Vector<String16>& args)
             result.append(buffer);
         }
 
-        bool dumpAll = true;
+        bool dumpAllState = true;
         size_t index = 0;
         size_t numArgs = args.size();
         if (numArgs) {
@@ -2345,31 +3597,45 @@ status_t SurfaceFlinger::dump(int fd, const Vector<String16>& args)
                     (args[index] == String16("--list"))) {
                 index++;
                 listLayersLocked(args, index, result, buffer, SIZE);
-                dumpAll = false;
+                dumpAllState = false;
             }
 
             if ((index < numArgs) &&
                     (args[index] == String16("--latency"))) {
                 index++;
                 dumpStatsLocked(args, index, result, buffer, SIZE);
-                dumpAll = false;
+                dumpAllState = false;
+            }
+
+            if ((index < numArgs) &&
+                    (args[index] == String16("--latency-histogram"))) {
+                index++;
+                dumpLatencyHistogramsLocked(args, index, result);
+                dumpAllState = false;
             }
 
             if ((index < numArgs) &&
                     (args[index] == String16("--latency-clear"))) {
                 index++;
                 clearStatsLocked(args, index, result, buffer, SIZE);
-                dumpAll = false;
+                dumpAllState = false;
             }
         }
 
-        if (dumpAll) {
-            dumpAllLocked(result, buffer, SIZE);
+        // only format the state guarded by the lock while holding it, the
+        // rest of the dump would hold up transactions meanwhile.
+        DumpSnapshot snapshot;
+        if (dumpAllState) {
+            takeDumpSnapshotLocked(&snapshot, buffer, SIZE);
         }
 
         if (locked) {
             mStateLock.unlock();
         }
+
+        if (dumpAllState) {
+            dumpAll(snapshot, result, buffer, SIZE);
+        }
     }
     write(fd, result.string(), result.size());
     return NO_ERROR;
@@ -2414,6 +3680,33 @@ void SurfaceFlinger::dumpStatsLocked(const Vector<String16>& args, size_t& index
     }
 }
 
+void SurfaceFlinger::dumpLatencyHistogramsLocked(const Vector<String16>& args,
+        size_t& index, String8& result) const
+{
+    String8 name;
+    if (index < args.size()) {
+        name = String8(args[index]);
+        index++;
+    }
+
+    const nsecs_t period =
+            getHwComposer().getRefreshPeriod(HWC_DISPLAY_PRIMARY);
+    result.appendFormat("%lld\n", period);
+
+    if (name.isEmpty()) {
+        mAnimFrameTracker.dumpHistograms(result);
+    } else {
+        const LayerVector& currentLayers = mCurrentState.layersSortedByZ;
+        const size_t count = currentLayers.size();
+        for (size_t i=0 ; i<count ; i++) {
+            const sp<Layer>& layer(currentLayers[i]);
+            if (name == layer->getName()) {
+                layer->dumpLatencyHistograms(result);
+            }
+        }
+    }
+}
+
 void SurfaceFlinger::clearStatsLocked(const Vector<String16>& args, size_t& index,
         String8& result, char* buffer, size_t SIZE)
 {
@@ -2455,7 +3748,84 @@ void SurfaceFlinger::clearStatsLocked(const Vector<String16>& args, size_t& inde
     result.append(config);
 }
 
-void SurfaceFlinger::dumpAllLocked(
+void SurfaceFlinger::dumpCounters(String8& result) const
+{
+    HWComposer& hwc(getHwComposer());
+    result.appendFormat("refresh-period-ns,%lld\n",
+            (long long)hwc.getRefreshPeriod(HWC_DISPLAY_PRIMARY));
+    result.appendFormat("last-swap-buffers-us,%lld\n",
+            (long long)ns2us(mLastSwapBufferTime));
+    result.appendFormat("last-transaction-us,%lld\n",
+            (long long)ns2us(mLastTransactionTime));
+    if (mFrameBoost) {
+        result.appendFormat("frame-boost-level,%d\n", mFrameBoostLevel);
+        result.appendFormat("avg-frame-slack-us,%lld\n",
+                (long long)ns2us(mAvgFrameSlack));
+    }
+    if (mIdleReclaimTimeout) {
+        result.appendFormat("reclaimed-buffers,%d\n", mReclaimedBufferCount);
+        result.appendFormat("reclaimed-kb,%d\n", mReclaimedBufferKb);
+    }
+    // process-wide totals: per frame, divide the difference between two
+    // dumps by the page flips in between
+    SharedBuffer::Stats sbStats;
+    if (SharedBuffer::getStats(&sbStats)) {
+        result.appendFormat("shared-buffer-allocs,%u\n", sbStats.allocs);
+        result.appendFormat("shared-buffer-pooled-allocs,%u\n",
+                sbStats.pooledAllocs);
+        result.appendFormat("shared-buffer-heap-calls,%u\n",
+                sbStats.heapCalls());
+    }
+    // FrameTracker has its own lock
+    mAnimFrameTracker.dumpHistograms(result);
+}
+
+void SurfaceFlinger::takeDumpSnapshotLocked(DumpSnapshot* snapshot,
+        char* buffer, size_t SIZE) const
+{
+    /*
+     * Dump the visible layer list
+     */
+    const LayerVector& currentLayers = mCurrentState.layersSortedByZ;
+    const size_t count = currentLayers.size();
+    snprintf(buffer, SIZE, "Visible layers (count = %d)\n", count);
+    snapshot->layers.append(buffer);
+    for (size_t i=0 ; i<count ; i++) {
+        const sp<Layer>& layer(currentLayers[i]);
+        layer->dump(snapshot->layers, buffer, SIZE);
+    }
+
+    /*
+     * Dump Display state
+     */
+    snprintf(buffer, SIZE, "Displays (%d entries)\n", mDisplays.size());
+    snapshot->displays.append(buffer);
+    for (size_t dpy=0 ; dpy<mDisplays.size() ; dpy++) {
+        const sp<const DisplayDevice>& hw(mDisplays[dpy]);
+        hw->dump(snapshot->displays, buffer, SIZE);
+    }
+
+    const sp<const DisplayDevice> hw(getDefaultDisplayDevice());
+    hw->undefinedRegion.dump(snapshot->defaultDisplay, "undefinedRegion");
+    snprintf(buffer, SIZE,
+            "  orientation=%d, canDraw=%d\n",
+            hw->getOrientation(), hw->canDraw());
+    snapshot->defaultDisplay.append(buffer);
+
+    /*
+     * Dump HWComposer state, which looks up the layers of each display
+     */
+    HWComposer& hwc(getHwComposer());
+    snprintf(buffer, SIZE, "h/w composer state:\n");
+    snapshot->hwc.append(buffer);
+    snprintf(buffer, SIZE, "  h/w composer %s and %s\n",
+            hwc.initCheck()==NO_ERROR ? "present" : "not present",
+                    (mDebugDisableHWC || mDebugRegion) ? "disabled" : "enabled");
+    snapshot->hwc.append(buffer);
+    hwc.dump(snapshot->hwc, buffer, SIZE);
+}
+
+void SurfaceFlinger::dumpAll(const DumpSnapshot& snapshot,
         String8& result, char* buffer, size_t SIZE) const
 {
     // figure out if we're stuck somewhere
@@ -2478,28 +3848,8 @@ void SurfaceFlinger::dumpAllLocked(
     result.append(SyncFeatures::getInstance().toString());
     result.append("\n");
 
-    /*
-     * Dump the visible layer list
-     */
-    const LayerVector& currentLayers = mCurrentState.layersSortedByZ;
-    const size_t count = currentLayers.size();
-    snprintf(buffer, SIZE, "Visible layers (count = %d)\n", count);
-    result.append(buffer);
-    for (size_t i=0 ; i<count ; i++) {
-        const sp<Layer>& layer(currentLayers[i]);
-        layer->dump(result, buffer, SIZE);
-    }
-
-    /*
-     * Dump Display state
-     */
-
-    snprintf(buffer, SIZE, "Displays (%d entries)\n", mDisplays.size());
-    result.append(buffer);
-    for (size_t dpy=0 ; dpy<mDisplays.size() ; dpy++) {
-        const sp<const DisplayDevice>& hw(mDisplays[dpy]);
-        hw->dump(result, buffer, SIZE);
-    }
+    result.append(snapshot.layers);
+    result.append(snapshot.displays);
 
     /*
      * Dump SurfaceFlinger global state
@@ -2509,7 +3859,6 @@ void SurfaceFlinger::dumpAllLocked(
     result.append(buffer);
 
     HWComposer& hwc(getHwComposer());
-    sp<const DisplayDevice> hw(getDefaultDisplayDevice());
     const GLExtensions& extensions(GLExtensions::getInstance());
 
     snprintf(buffer, SIZE, "EGL implementation : %s\n",
@@ -2527,11 +3876,17 @@ void SurfaceFlinger::dumpAllLocked(
     snprintf(buffer, SIZE, "%s\n", extensions.getExtension());
     result.append(buffer);
 
-    hw->undefinedRegion.dump(result, "undefinedRegion");
-    snprintf(buffer, SIZE,
-            "  orientation=%d, canDraw=%d\n",
-            hw->getOrientation(), hw->canDraw());
-    result.append(buffer);
+    // GPU time of composition, only measured while debug.egl.trace is "gputime"
+    const EGLint gpuTimesLength = eglDumpGpuTimesANDROID(NULL, 0);
+    if (gpuTimesLength > 0) {
+        char* const gpuTimes = new char[gpuTimesLength + 1];
+        eglDumpGpuTimesANDROID(gpuTimes, gpuTimesLength + 1);
+        result.append(gpuTimes);
+        delete [] gpuTimes;
+    }
+    EGLImageCache::getInstance().dump(result);
+
+    result.append(snapshot.defaultDisplay);
     snprintf(buffer, SIZE,
             "  last eglSwapBuffers() time: %f us\n"
             "  last transaction time     : %f us\n"
@@ -2564,23 +3919,64 @@ void SurfaceFlinger::dumpAllLocked(
      * VSYNC state
      */
     mEventThread->dump(result, buffer, SIZE);
+    mPrimaryDispSync.dump(result, buffer, SIZE);
+    {
+        Mutex::Autolock _l(mHWVsyncLock);
+        snprintf(buffer, SIZE, "  h/w vsync: %s, prediction: %s\n",
+                mPrimaryHWVsyncEnabled ? "enabled" : "disabled",
+                mVsyncPrediction ? "enabled" : "disabled");
+        result.append(buffer);
+    }
+    if (mFrameBoost) {
+        result.appendFormat("  frame boost: level %d, average slack %.2f ms\n",
+                mFrameBoostLevel, mAvgFrameSlack / 1e6);
+    }
+    if (mSolidColorBuffer != NULL) {
+        result.appendFormat("  HWC dim layers: %ux%u solid color buffer\n",
+                mSolidColorBuffer->getWidth(), mSolidColorBuffer->getHeight());
+    }
+    snprintf(buffer, SIZE, "  app phase offset: %lld ns, sf phase offset: %lld ns\n",
+            (long long)VSYNC_EVENT_PHASE_OFFSET_NS,
+            (long long)SF_VSYNC_EVENT_PHASE_OFFSET_NS);
+    result.append(buffer);
+
+    {
+        Mutex::Autolock _l(mRenderScaleLock);
+        for (int type=0 ; type<DisplayDevice::NUM_DISPLAY_TYPES ; type++) {
+            const RenderScale& rs(mRenderScales[type]);
+            if (rs.maxScale != 1.0f || rs.minScale) {
+                result.appendFormat("  render scale of display %d: %.3f "
+                        "(max %.3f, min %.3f)\n", type, rs.scale,
+                        rs.maxScale, rs.minScale);
+            }
+        }
+    }
+    if (mIdleReclaimTimeout) {
+        result.appendFormat("  idle layer buffers: %d reclaims, %d KB freed "
+                "(after %lld ms off-screen)\n",
+                mReclaimedBufferCount, mReclaimedBufferKb,
+                (long long)ns2ms(mIdleReclaimTimeout));
+    }
 
     /*
-     * Dump HWComposer state
+     * Dump the CPU usage of our threads
      */
-    snprintf(buffer, SIZE, "h/w composer state:\n");
-    result.append(buffer);
-    snprintf(buffer, SIZE, "  h/w composer %s and %s\n",
-            hwc.initCheck()==NO_ERROR ? "present" : "not present",
-                    (mDebugDisableHWC || mDebugRegion) ? "disabled" : "enabled");
-    result.append(buffer);
-    hwc.dump(result, buffer, SIZE);
+    if (mCpuProfilePeriod) {
+        result.appendFormat("CPU profile (sampled every %lld ms):\n",
+                (long long)ns2ms(mCpuProfilePeriod));
+        Mutex::Autolock _l(mCpuProfilerLock);
+        mCpuProfiler.dump(result, "  ");
+    }
+
+    result.append(snapshot.hwc);
 
     /*
      * Dump gralloc state
      */
     const GraphicBufferAllocator& alloc(GraphicBufferAllocator::get());
     alloc.dump(result);
+
+    PermissionCache::dump(result);
 }
 
 const Vector< sp<Layer> >&
@@ -2720,6 +4116,16 @@ status_t SurfaceFlinger::onTransact(
                 reply->writeInt32(0);
                 reply->writeInt32(mDebugDisableHWC);
                 return NO_ERROR;
+            case 1011: { // set the render scale of a built-in display
+                const int type = data.readInt32();
+                const float maxScale = data.readFloat();
+                const float minScale = data.readFloat();
+                status_t err = setRenderScale(type, maxScale, minScale);
+                if (err == NO_ERROR) {
+                    repaintEverything();
+                }
+                return err;
+            }
             case 1013: {
                 Mutex::Autolock _l(mStateLock);
                 sp<const DisplayDevice> hw(getDefaultDisplayDevice());
@@ -2840,17 +4246,19 @@ status_t SurfaceFlinger::captureScreen(const sp<IBinder>& display,
         uint32_t reqWidth, reqHeight;
         uint32_t minLayerZ,maxLayerZ;
         bool useReadPixels;
+        bool isCpuConsumer;
         status_t result;
     public:
         MessageCaptureScreen(SurfaceFlinger* flinger,
                 const sp<IBinder>& display,
                 const sp<IGraphicBufferProducer>& producer,
                 uint32_t reqWidth, uint32_t reqHeight,
-                uint32_t minLayerZ, uint32_t maxLayerZ, bool useReadPixels)
+                uint32_t minLayerZ, uint32_t maxLayerZ, bool useReadPixels,
+                bool isCpuConsumer)
             : flinger(flinger), display(display), producer(producer),
               reqWidth(reqWidth), reqHeight(reqHeight),
               minLayerZ(minLayerZ), maxLayerZ(maxLayerZ),
-              useReadPixels(useReadPixels),
+              useReadPixels(useReadPixels), isCpuConsumer(isCpuConsumer),
               result(PERMISSION_DENIED)
         {
         }
@@ -2860,6 +4268,17 @@ status_t SurfaceFlinger::captureScreen(const sp<IBinder>& display,
         virtual bool handler() {
             Mutex::Autolock _l(flinger->mStateLock);
             sp<const DisplayDevice> hw(flinger->getDisplayDevice(display));
+#ifndef BOARD_EGL_NEEDS_LEGACY_FB
+            if (isCpuConsumer && flinger->mCpuScreenshots) {
+                result = flinger->captureScreenImplCpuLocked(hw,
+                        producer, reqWidth, reqHeight, minLayerZ, maxLayerZ);
+                if (result != INVALID_OPERATION) {
+                    static_cast<GraphicProducerWrapper*>(producer->asBinder().get())->exit(result);
+                    return true;
+                }
+                // not doable without GL, take the usual path
+            }
+#endif
             if (!useReadPixels) {
                 result = flinger->captureScreenImplLocked(hw,
                         producer, reqWidth, reqHeight, minLayerZ, maxLayerZ);
@@ -2913,7 +4332,7 @@ status_t SurfaceFlinger::captureScreen(const sp<IBinder>& display,
     sp<MessageBase> msg = new MessageCaptureScreen(this,
             display, IGraphicBufferProducer::asInterface( wrapper ),
             reqWidth, reqHeight, minLayerZ, maxLayerZ,
-            useReadPixels);
+            useReadPixels, isCpuConsumer);
 
     status_t res = postMessageAsync(msg);
     if (res == NO_ERROR) {
@@ -2958,6 +4377,7 @@ void SurfaceFlinger::renderScreenImplLocked(
 
     const LayerVector& layers( mDrawingState.layersSortedByZ );
     const size_t count = layers.size();
+    mGLState.begin();
     for (size_t i=0 ; i<count ; ++i) {
         const sp<Layer>& layer(layers[i]);
         const Layer::State& state(layer->drawingState());
@@ -2971,6 +4391,7 @@ void SurfaceFlinger::renderScreenImplLocked(
             }
         }
     }
+    mGLState.end();
 
     // compositionComplete is needed for older driver
     hw->compositionComplete();
@@ -3163,6 +4584,103 @@ status_t SurfaceFlinger::captureScreenImplCpuConsumerLocked(
     return result;
 }
 
+#ifndef BOARD_EGL_NEEDS_LEGACY_FB
+status_t SurfaceFlinger::captureScreenImplCpuLocked(
+        const sp<const DisplayDevice>& hw,
+        const sp<IGraphicBufferProducer>& producer,
+        uint32_t reqWidth, uint32_t reqHeight,
+        uint32_t minLayerZ, uint32_t maxLayerZ)
+{
+    ATRACE_CALL();
+
+    // get screen geometry
+    const uint32_t hw_w = hw->getWidth();
+    const uint32_t hw_h = hw->getHeight();
+
+    // if we have secure windows on this display, never allow the screen capture
+    if (hw->getSecureLayerVisible()) {
+        ALOGW("FB is protected: PERMISSION_DENIED");
+        return PERMISSION_DENIED;
+    }
+
+    if ((reqWidth > hw_w) || (reqHeight > hw_h)) {
+        ALOGE("size mismatch (%d, %d) > (%d, %d)",
+                reqWidth, reqHeight, hw_w, hw_h);
+        return BAD_VALUE;
+    }
+
+    reqWidth  = (!reqWidth)  ? hw_w : reqWidth;
+    reqHeight = (!reqHeight) ? hw_h : reqHeight;
+
+    // this is meant for when the HWC composes everything, the GPU would
+    // otherwise have to wake up just for the screenshot.
+    HWComposer& hwc(getHwComposer());
+    const int32_t id = hw->getHwcDisplayId();
+    if (id < 0 || hwc.initCheck() != NO_ERROR || hwc.hasGlesComposition(id)) {
+        return INVALID_OPERATION;
+    }
+
+    // same selection as renderScreenImplLocked()
+    Vector< sp<Layer> > layers;
+    const LayerVector& drawingLayers(mDrawingState.layersSortedByZ);
+    const size_t count = drawingLayers.size();
+    for (size_t i=0 ; i<count ; ++i) {
+        const sp<Layer>& layer(drawingLayers[i]);
+        const Layer::State& state(layer->drawingState());
+        if (state.layerStack == hw->getLayerStack() &&
+                state.z >= minLayerZ && state.z <= maxLayerZ &&
+                layer->isVisible()) {
+            if (!layer->canDrawWithCpu(hw)) {
+                return INVALID_OPERATION;
+            }
+            layers.add(layer);
+        }
+    }
+
+    sp<Surface> sur = new Surface(producer);
+    ANativeWindow* window = sur.get();
+
+    status_t result = INVALID_OPERATION;
+    if (native_window_api_connect(window, NATIVE_WINDOW_API_CPU) == NO_ERROR) {
+        int err = 0;
+        err = native_window_set_buffers_dimensions(window, reqWidth, reqHeight);
+        err |= native_window_set_buffers_format(window, HAL_PIXEL_FORMAT_RGBA_8888);
+        err |= native_window_set_usage(window,
+                GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
+
+        if (err == NO_ERROR) {
+            ANativeWindowBuffer* buffer;
+            if (native_window_dequeue_buffer_and_wait(window,  &buffer) == NO_ERROR) {
+                sp<GraphicBuffer> buf = static_cast<GraphicBuffer*>(buffer);
+                void* vaddr;
+                bool drawn = false;
+                if (buf->lock(GRALLOC_USAGE_SW_WRITE_OFTEN, &vaddr) == NO_ERROR) {
+                    // downscaling happens while composing, each pixel of
+                    // the screenshot is sampled from the layers right away
+                    CpuCompositor compositor(vaddr, buf->getStride(),
+                            reqWidth, reqHeight, hw_w, hw_h);
+                    compositor.clear();
+                    drawn = true;
+                    for (size_t i=0 ; i<layers.size() && drawn ; i++) {
+                        drawn = layers[i]->drawWithCpu(hw, compositor);
+                    }
+                    buf->unlock();
+                }
+                if (drawn) {
+                    window->queueBuffer(window, buffer, -1);
+                    result = NO_ERROR;
+                } else {
+                    // a layer's buffer can't be mapped, let GL do it
+                    window->cancelBuffer(window, buffer, -1);
+                }
+            }
+        }
+        native_window_api_disconnect(window, NATIVE_WINDOW_API_CPU);
+    }
+    return result;
+}
+#endif
+
 #ifdef BOARD_EGL_NEEDS_LEGACY_FB
 status_t SurfaceFlinger::captureScreen(const sp<IBinder>& display,
         sp<IMemoryHeap>* heap,
@@ -3251,6 +4769,46 @@ int SurfaceFlinger::LayerVector::do_compare(const void* lhs,
     return l->sequence - r->sequence;
 }
 
+size_t SurfaceFlinger::LayerVector::reorder(size_t index)
+{
+    // Unlike removeAt() followed by add(), which shift the whole tail of
+    // the list twice, only the layers between the old and new positions
+    // are moved, and without touching any reference count.
+    const size_t count = size();
+    sp<Layer>* const layers = editArray();
+    const sp<Layer>* const layer = &layers[index];
+
+    // binary search among the other layers, which are still sorted
+    size_t l = 0;
+    size_t h = count - 1;
+    while (l < h) {
+        const size_t mid = l + (h - l) / 2;
+        const size_t i = mid < index ? mid : mid + 1;
+        if (do_compare(layer, &layers[i]) < 0) {
+            h = mid;
+        } else {
+            l = mid + 1;
+        }
+    }
+    const size_t pos = l;
+    if (pos == index) {
+        return index;
+    }
+
+    void* storage[(sizeof(sp<Layer>) + sizeof(void*) - 1) / sizeof(void*)];
+    sp<Layer>* const tmp = reinterpret_cast<sp<Layer>*>(storage);
+    ReferenceMover::move_references(tmp, &layers[index], 1);
+    if (pos < index) {
+        ReferenceMover::move_references(&layers[pos + 1], &layers[pos],
+                index - pos);
+    } else {
+        ReferenceMover::move_references(&layers[index], &layers[index + 1],
+                pos - index);
+    }
+    ReferenceMover::move_references(&layers[pos], tmp, 1);
+    return pos;
+}
+
 // ---------------------------------------------------------------------------
 
 SurfaceFlinger::DisplayDeviceState::DisplayDeviceState()
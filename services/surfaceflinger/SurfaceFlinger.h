@@ -37,19 +37,27 @@
 
 #include <ui/PixelFormat.h>
 
+#include <gui/FencePipeline.h>
 #include <gui/ISurfaceComposer.h>
 #include <gui/ISurfaceComposerClient.h>
 
 #include <hardware/hwcomposer_defs.h>
 
+#include <cpustats/ThreadCpuProfiler.h>
+
 #include <private/gui/LayerState.h>
 
 #include "Barrier.h"
 #include "DisplayDevice.h"
+#include "DispSync.h"
 #include "FrameTracker.h"
+#include "GLStateCache.h"
 #include "MessageQueue.h"
+#include "TransactionQueue.h"
+#include "WorkerPool.h"
 
 #include "DisplayHardware/HWComposer.h"
+#include "DisplayHardware/PowerHAL.h"
 
 #ifdef SAMSUNG_HDMI_SUPPORT
 #include "SecHdmiClient.h"
@@ -113,10 +121,18 @@ public:
     // utility function to delete a texture on the main thread
     void deleteTextureAsync(GLuint texture);
 
+    // acquire the layer's next buffer and create its EGLImage on a worker
+    // thread, ahead of latchBuffer(). may be called from any thread.
+    void preLatchBufferAsync(const wp<Layer>& layer);
+
     // enable/disable h/w composer event
     // TODO: this should be made accessible only to EventThread
     void eventControl(int disp, int event, int enabled);
 
+    // turn the main display's h/w vsync on while the vsync model has
+    // listeners and needs samples, and off otherwise
+    void updatePrimaryHardwareVsync();
+
     // called on the main thread by MessageQueue when an internal message
     // is received
     // TODO: this should be made accessible only to MessageQueue
@@ -130,6 +146,7 @@ private:
     friend class Client;
     friend class DisplayEventConnection;
     friend class Layer;
+    friend class LayerDim;
     friend class SurfaceTextureLayer;
 
     // We're reference counted, never destroy SurfaceFlinger directly
@@ -144,6 +161,9 @@ private:
         LayerVector();
         LayerVector(const LayerVector& rhs);
         virtual int do_compare(const void* lhs, const void* rhs) const;
+        // moves the layer at index, whose z-order just changed, to its new
+        // position; returns the new index
+        size_t reorder(size_t index);
     };
 
     struct DisplayDeviceState {
@@ -262,6 +282,10 @@ private:
     uint32_t setClientStateLocked(const sp<Client>& client,
         const layer_state_t& s);
     uint32_t setDisplayStateLocked(const DisplayState& s);
+    uint32_t applyTransactionStateLocked(const Vector<ComposerState>& state,
+            const Vector<DisplayState>& displays);
+    // applies the transactions queued in mPendingTransactions
+    uint32_t applyPendingTransactionsLocked();
 
     /* ------------------------------------------------------------------------
      * Layer management
@@ -325,6 +349,16 @@ private:
             uint32_t reqWidth, uint32_t reqHeight,
             uint32_t minLayerZ, uint32_t maxLayerZ);
 
+#ifndef BOARD_EGL_NEEDS_LEGACY_FB
+    // composes the screenshot with the CPU, returns INVALID_OPERATION
+    // (without touching producer) when GL is needed instead
+    status_t captureScreenImplCpuLocked(
+            const sp<const DisplayDevice>& hw,
+            const sp<IGraphicBufferProducer>& producer,
+            uint32_t reqWidth, uint32_t reqHeight,
+            uint32_t minLayerZ, uint32_t maxLayerZ);
+#endif
+
 
     /* ------------------------------------------------------------------------
      * EGL
@@ -334,6 +368,7 @@ private:
     static EGLConfig selectEGLConfig(EGLDisplay disp, EGLint visualId);
     static EGLContext createGLContext(EGLDisplay disp, EGLConfig config);
     void initializeGL(EGLDisplay display);
+    void prewarmGLStates();
     uint32_t getMaxTextureSize() const;
     uint32_t getMinColorDepth() const;
     uint32_t getMaxViewportDims() const;
@@ -377,12 +412,36 @@ private:
      * Compositing
      */
     void invalidateHwcGeometry();
+    // if cache is not NULL, the unchanged top of the layer stack is
+    // taken from it instead of being recomputed, and the cache is updated.
     static void computeVisibleRegions(size_t dpy,
             const LayerVector& currentLayers, uint32_t layerStack,
-            Region& dirtyRegion, Region& opaqueRegion);
+            Region& dirtyRegion, Region& opaqueRegion,
+            DisplayDevice::VisibleRegionCache* cache = NULL);
+
+    // true when the visible regions of all drawable displays can be
+    // computed at the same time
+    bool canComputeVisibleRegionsConcurrently() const;
+    class ComputeVisibleRegionsJob;
+    friend class ComputeVisibleRegionsJob;
 
     void preComposition();
     void postComposition();
+    void postComposition(const LayerVector& layers,
+            bool animCompositionPending, nsecs_t frameDeadline);
+    // called once a frame is out, with the time left until the vsync it
+    // was meant for
+    void updateFrameBoost(nsecs_t slack, nsecs_t refreshPeriod);
+    void sampleCpuProfile();
+    void reclaimIdleBuffers();
+    void updateRenderScales();
+    status_t setRenderScale(int type, float maxScale, float minScale);
+    void deletePendingTextures();
+    void retirePendingTextureDeletes();
+
+    // must be called with mHWVsyncLock held
+    void resyncToHardwareVsyncLocked();
+    void disableHardwareVsyncLocked();
     void rebuildLayerStacks();
     void setUpHWComposer();
     void doComposition();
@@ -391,13 +450,47 @@ private:
             const Region& dirtyRegion);
     void doComposeSurfaces(const sp<const DisplayDevice>& hw,
             const Region& dirty);
+    // draws the unchanged bottom-most GLES layers from the display's
+    // composition cache, returns how many layers were drawn
+    size_t drawCompositionCache(const sp<const DisplayDevice>& hw,
+            const Region& dirty);
 
     void postFramebuffer();
+
+    // a display and the layers that were composed on it, as they were
+    // when the frame was handed to HWComposer::commit()
+    struct PresentedDisplay {
+        sp<const DisplayDevice> hw;
+        Vector< sp<Layer> > layers;
+    };
+    void getPresentedDisplays(Vector<PresentedDisplay>& displays) const;
+    // commits the frame and hands the release fences back to the layers
+    void commitFramebuffer(const Vector<PresentedDisplay>& displays);
+    // blocks until the present thread is done with the previous frame,
+    // must be called before the work-list or the layers' latched state
+    // is touched again. no-op without a present thread.
+    void waitForPresent();
+    class PresentCommitJob;
+    class PostCompositionJob;
+    friend class PresentCommitJob;
+    friend class PostCompositionJob;
+    class PreLatchJob;
+
     void drawWormhole(const sp<const DisplayDevice>& hw,
             const Region& region) const;
+    static sp<GraphicBuffer> createSolidColorBuffer(
+            const sp<const DisplayDevice>& hw);
     GLuint getProtectedTexName() const {
         return mProtectedTexName;
     }
+    // GL state used by layers to draw, main thread only
+    GLStateCache& getGLState() const {
+        return mGLState;
+    }
+    // see mSolidColorBuffer, NULL if dim layers are drawn with GLES only
+    const sp<GraphicBuffer>& getSolidColorBuffer() const {
+        return mSolidColorBuffer;
+    }
 
     /* ------------------------------------------------------------------------
      * Display management
@@ -411,9 +504,25 @@ private:
         String8& result, char* buffer, size_t SIZE) const;
     void dumpStatsLocked(const Vector<String16>& args, size_t& index,
         String8& result, char* buffer, size_t SIZE) const;
+    void dumpLatencyHistogramsLocked(const Vector<String16>& args, size_t& index,
+            String8& result) const;
     void clearStatsLocked(const Vector<String16>& args, size_t& index,
         String8& result, char* buffer, size_t SIZE);
-    void dumpAllLocked(String8& result, char* buffer, size_t SIZE) const;
+    // the parts of dumpAll() that read state guarded by mStateLock,
+    // formatted while holding it; the rest is formatted without
+    struct DumpSnapshot {
+        String8 layers;
+        String8 displays;
+        String8 defaultDisplay;
+        String8 hwc;
+    };
+    void takeDumpSnapshotLocked(DumpSnapshot* snapshot,
+            char* buffer, size_t SIZE) const;
+    void dumpAll(const DumpSnapshot& snapshot,
+            String8& result, char* buffer, size_t SIZE) const;
+    // counters and latencies only, as "name,value" lines; doesn't need
+    // mStateLock so it's safe to poll
+    void dumpCounters(String8& result) const;
     bool startDdmConnection();
     static void appendSfConfigString(String8& result);
 
@@ -443,6 +552,7 @@ private:
     nsecs_t mBootTime;
     bool mGpuToCpuSupported;
     sp<EventThread> mEventThread;
+    sp<EventThread> mSFEventThread;
     GLint mMaxViewportDims[2];
     GLint mMaxTextureSize;
     GLint mMinColorDepth;
@@ -458,6 +568,35 @@ private:
     bool mVisibleRegionsDirty;
     bool mHwWorkListDirty;
     bool mAnimCompositionPending;
+    // reuse the previous visible region pass for unchanged layers
+    bool mIncrementalVisibleRegions;
+    // compute the visible regions of each display on mVisibleRegionWorkers
+    bool mParallelVisibleRegions;
+    sp<WorkerPool> mVisibleRegionWorkers;
+    // cache the GLES composition of static layers, see CompositionCache
+    bool mUseCompositionCache;
+    // only redraw what changed in each back buffer (EGL_EXT_buffer_age)
+    bool mUseBufferAge;
+    // queue asynchronous transactions instead of applying them right away
+    bool mQueueTransactions;
+    // run HWComposer::commit() and the post-composition work on
+    // mPresentWorker instead of the main thread
+    bool mAsyncPresent;
+    sp<WorkerPool> mPresentWorker;
+    PresentCommitJob* mPresentCommitJob;
+    PostCompositionJob* mPostCompositionJob;
+    // compose screenshots for CpuConsumers with the CPU when the HWC
+    // composes everything
+    bool mCpuScreenshots;
+    // run the acquire and EGLImage creation of new buffers on
+    // mPreLatchWorker as soon as they are queued
+    bool mPreLatchBuffers;
+    // create the HWComposer while EGL initializes, and allocate the
+    // framebuffers while GL is set up, see readyToRun()
+    bool mParallelInit;
+    bool mPrewarmGL;
+    sp<WorkerPool> mPreLatchWorker;
+    mutable GLStateCache mGLState;
 
     // this may only be written from the main thread with mStateLock held
     // it may be read from other threads with mStateLock held
@@ -477,8 +616,81 @@ private:
 
     // these are thread safe
     mutable MessageQueue mEventQueue;
+    // transactions queued by the binder threads without taking mStateLock,
+    // only drained with mStateLock held
+    TransactionQueue mPendingTransactions;
     mutable Barrier mReadyToRunBarrier;
     FrameTracker mAnimFrameTracker;
+    DispSync mPrimaryDispSync;
+
+    // protected by mHWVsyncLock
+    mutable Mutex mHWVsyncLock;
+    bool mPrimaryHWVsyncEnabled;
+    bool mPrimaryVsyncListening;
+    // turn h/w vsync off once mPrimaryDispSync is locked, and only
+    // resync when the present fences show that the model drifted
+    bool mVsyncPrediction;
+    // frames in a row composed without a present fence
+    int mMissingPresentFences;
+
+    // frame slack based power hints, touched by postComposition() only
+    bool mFrameBoost;
+    nsecs_t mFrameDeadline;     // of the frame being composed
+    nsecs_t mAvgFrameSlack;
+    int mFrameBoostLevel;
+    PowerHAL mPowerHAL;
+
+    // layers use BufferQueue::setAdaptiveBufferCount
+    bool mAdaptiveBuffering;
+
+    // opaque black buffer that LayerDim hands to the HWC, scaled to the
+    // layer's frame and faded with its plane alpha. NULL when disabled.
+    bool mHwcDimLayers;
+    sp<GraphicBuffer> mSolidColorBuffer;
+
+    // GLES composition resolution of the built-in displays, see
+    // DisplayDevice::setRenderScale(). With a minScale, the scale follows
+    // the GPU load between minScale and maxScale. Set from the binder
+    // threads under mRenderScaleLock, applied by the main thread.
+    struct RenderScale {
+        RenderScale() : maxScale(1.0f), minScale(0.0f), scale(1.0f),
+                slowFrames(0), fastFrames(0) { }
+        float maxScale;
+        float minScale;     // 0 for a fixed scale
+        float scale;        // current one
+        uint32_t slowFrames;
+        uint32_t fastFrames;
+    };
+    mutable Mutex mRenderScaleLock;
+    RenderScale mRenderScales[DisplayDevice::NUM_DISPLAY_TYPES];
+
+    // CPUs the main thread is restricted to, 0 for any
+    uint32_t mMainThreadCpus;
+
+    // CPU usage of our threads, sampled from the main thread
+    nsecs_t mCpuProfilePeriod;      // 0 when disabled
+    nsecs_t mLastCpuProfileSample;
+    mutable Mutex mCpuProfilerLock;
+    ThreadCpuProfiler mCpuProfiler;
+
+    // off-screen layers give up their spare buffers after that long
+    nsecs_t mIdleReclaimTimeout;    // 0 when disabled
+    volatile int32_t mReclaimedBufferKb;
+    volatile int32_t mReclaimedBufferCount;
+
+    // textures deleteTextureAsync() was asked for, collected from any
+    // thread and handed to deletePendingTextures() once per frame
+    mutable Mutex mTextureDeleteLock;
+    Vector<GLuint> mTexturesToDelete;
+
+    // then each batch waits for the mFencePipeline stage that fenced the
+    // commands still using it
+    struct PendingTextureDelete {
+        Vector<GLuint> textures;
+        uint32_t serial;
+    };
+    Vector<PendingTextureDelete> mPendingTextureDeletes;
+    FencePipeline mFencePipeline;
 
     // protected by mDestroyedLayerLock;
     mutable Mutex mDestroyedLayerLock;
@@ -28,11 +28,13 @@ namespace android {
 
 // ---------------------------------------------------------------------------
 
-status_t SurfaceFlingerConsumer::updateTexImage(BufferRejecter* rejecter)
+status_t SurfaceFlingerConsumer::updateTexImage(BufferRejecter* rejecter,
+        nsecs_t expectedPresent, uint32_t* skipped)
 {
     ATRACE_CALL();
     ALOGV("updateTexImage");
     Mutex::Autolock lock(mMutex);
+    *skipped = 0;
 
     if (mAbandoned) {
         ALOGE("updateTexImage: GLConsumer is abandoned!");
@@ -47,16 +49,22 @@ status_t SurfaceFlingerConsumer::updateTexImage(BufferRejecter* rejecter)
 
     BufferQueue::BufferItem item;
 
-    // Acquire the next buffer.
-    // In asynchronous mode the list is guaranteed to be one buffer
-    // deep, while in synchronous mode we use the oldest buffer.
-    err = acquireBufferLocked(&item);
+    if (mPreLatched) {
+        // preLatch() did the acquire already
+        item = mPreLatchedItem;
+        mPreLatched = false;
+    } else {
+        // Acquire the next buffer.
+        // In asynchronous mode the list is guaranteed to be one buffer
+        // deep, while in synchronous mode we use the oldest buffer.
+        err = acquireBufferLocked(&item, expectedPresent);
+    }
     if (err != NO_ERROR) {
         if (err == BufferQueue::NO_BUFFER_AVAILABLE) {
             // This variant of updateTexImage does not guarantee that the
             // texture is bound, so no need to call glBindTexture.
             err = NO_ERROR;
-        } else {
+        } else if (err != BufferQueue::PRESENT_LATER) {
             ALOGE("updateTexImage: acquire failed: %s (%d)",
                 strerror(-err), err);
         }
@@ -64,6 +72,8 @@ status_t SurfaceFlingerConsumer::updateTexImage(BufferRejecter* rejecter)
     }
 
 
+    *skipped = item.mSkipped;
+
     // We call the rejecter here, in case the caller has a reason to
     // not accept this buffer.  This is used by SurfaceFlinger to
     // reject buffers which have the wrong size
@@ -99,6 +109,53 @@ status_t SurfaceFlingerConsumer::bindTextureImage()
     return bindTextureImageLocked();
 }
 
+status_t SurfaceFlingerConsumer::preLatch()
+{
+    ATRACE_CALL();
+    Mutex::Autolock lock(mMutex);
+
+    if (mAbandoned || mPreLatched) {
+        return NO_ERROR;
+    }
+
+    // In asynchronous mode the buffer could still be replaced by a newer
+    // one before the next updateTexImage(), which must get the newest.
+    if (!mBufferQueue->isSynchronousMode()) {
+        return NO_ERROR;
+    }
+
+    // buffers scheduled for later are left for updateTexImage()
+    BufferQueue::BufferItem item;
+    status_t err = acquireBufferLocked(&item,
+            systemTime(SYSTEM_TIME_MONOTONIC));
+    if (err != NO_ERROR) {
+        if (err == BufferQueue::NO_BUFFER_AVAILABLE ||
+                err == BufferQueue::PRESENT_LATER) {
+            err = NO_ERROR;
+        } else {
+            ALOGE("preLatch: acquire failed: %s (%d)", strerror(-err), err);
+        }
+        return err;
+    }
+
+    mPreLatchedItem = item;
+    mPreLatched = true;
+
+    // if this fails releaseAndUpdateLocked() will simply try again, on
+    // the main thread
+    createImageLocked(item.mBuf);
+    return NO_ERROR;
+}
+
+void SurfaceFlingerConsumer::freeBufferLocked(int slotIndex)
+{
+    if (mPreLatched && slotIndex == mPreLatchedItem.mBuf) {
+        // the BufferQueue took the buffer back
+        mPreLatched = false;
+    }
+    GLConsumer::freeBufferLocked(slotIndex);
+}
+
 // ---------------------------------------------------------------------------
 }; // namespace android
 
@@ -31,7 +31,8 @@ public:
             GLenum texTarget = GL_TEXTURE_EXTERNAL_OES, bool useFenceSync = true,
             const sp<BufferQueue> &bufferQueue = 0)
         : GLConsumer(tex, allowSynchronousMode, texTarget, useFenceSync,
-            bufferQueue)
+            bufferQueue),
+          mPreLatched(false)
     {}
 
     class BufferRejecter {
@@ -47,10 +48,32 @@ public:
     // reject the newly acquired buffer.  Unlike the GLConsumer version,
     // this does not guarantee that the buffer has been bound to the GL
     // texture.
-    status_t updateTexImage(BufferRejecter* rejecter);
+    //
+    // expectedPresent is when the frame being composed will be on screen,
+    // see BufferQueue::acquireBuffer(). If the next buffer is due later,
+    // nothing is latched and BufferQueue::PRESENT_LATER is returned.
+    // skipped is set to the number of queued buffers dropped because a
+    // newer one was due.
+    status_t updateTexImage(BufferRejecter* rejecter, nsecs_t expectedPresent,
+            uint32_t* skipped);
 
     // See GLConsumer::bindTextureImageLocked().
     status_t bindTextureImage();
+
+    // Acquires the next buffer ahead of updateTexImage() and creates its
+    // EGLImage, so that updateTexImage() only has to commit it. This may be
+    // called from any thread. At most one buffer is pre-latched, and only
+    // in synchronous mode, where it is the one updateTexImage() would have
+    // acquired anyway, and only if it is due now.
+    status_t preLatch();
+
+protected:
+    virtual void freeBufferLocked(int slotIndex);
+
+private:
+    // buffer acquired by preLatch(), not given to updateTexImage() yet
+    bool mPreLatched;
+    BufferQueue::BufferItem mPreLatchedItem;
 };
 
 // ----------------------------------------------------------------------------
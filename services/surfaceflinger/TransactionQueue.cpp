@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <cutils/atomic.h>
+
+#include "TransactionQueue.h"
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+TransactionQueue::TransactionQueue()
+    : mHead(0) {
+}
+
+TransactionQueue::~TransactionQueue() {
+    Transaction* t = popAll();
+    while (t) {
+        Transaction* next = t->next;
+        delete t;
+        t = next;
+    }
+}
+
+bool TransactionQueue::push(Transaction* t) {
+    // release semantics so the consumer sees the transaction's content
+    Transaction* head;
+    do {
+        head = mHead;
+        t->next = head;
+    } while (android_atomic_release_cas(reinterpret_cast<int32_t>(head),
+            reinterpret_cast<int32_t>(t),
+            reinterpret_cast<volatile int32_t*>(&mHead)) != 0);
+    return head == 0;
+}
+
+TransactionQueue::Transaction* TransactionQueue::popAll() {
+    // we take the whole list at once, so there is no ABA problem even
+    // though transactions are freed and reallocated
+    Transaction* head;
+    do {
+        head = mHead;
+        if (head == 0) {
+            return 0;
+        }
+    } while (android_atomic_acquire_cas(reinterpret_cast<int32_t>(head), 0,
+            reinterpret_cast<volatile int32_t*>(&mHead)) != 0);
+
+    // the list is in reverse order of arrival
+    Transaction* first = 0;
+    while (head) {
+        Transaction* next = head->next;
+        head->next = first;
+        first = head;
+        head = next;
+    }
+    return first;
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
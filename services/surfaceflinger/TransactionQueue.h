@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SURFACE_FLINGER_TRANSACTION_QUEUE_H
+#define ANDROID_SURFACE_FLINGER_TRANSACTION_QUEUE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Vector.h>
+
+#include <private/gui/LayerState.h>
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+/*
+ * A multiple-producer, single-consumer queue of transactions.
+ *
+ * Binder threads push the transactions that don't need to wait for the
+ * composition without taking any lock. The consumer takes them all at once
+ * with popAll(); there must only be one consumer at a time, SurfaceFlinger
+ * guarantees this by only calling popAll() with mStateLock held.
+ */
+class TransactionQueue {
+public:
+    struct Transaction {
+        Transaction() : next(0) { }
+        Vector<ComposerState> state;
+        Vector<DisplayState> displays;
+        // next transaction in the list returned by popAll()
+        Transaction* next;
+    };
+
+    TransactionQueue();
+    ~TransactionQueue();
+
+    // queue takes ownership of t, returns true if the queue was empty
+    bool push(Transaction* t);
+
+    // returns the queued transactions in the order they were pushed,
+    // the caller must delete them
+    Transaction* popAll();
+
+    bool isEmpty() const { return mHead == 0; }
+
+private:
+    // most recently pushed transaction, the list is linked backward
+    Transaction* volatile mHead;
+};
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
+
+#endif /* ANDROID_SURFACE_FLINGER_TRANSACTION_QUEUE_H */
@@ -54,6 +54,16 @@ bool Transform::absIsOne(float f) {
     return isZero(fabs(f) - 1.0f);
 }
 
+bool Transform::operator == (const Transform& rhs) const
+{
+    // the last rows are always < 0 , 0 , 1 >
+    const mat33& A(mMatrix);
+    const mat33& B(rhs.mMatrix);
+    return A[0][0] == B[0][0] && A[0][1] == B[0][1] &&
+           A[1][0] == B[1][0] && A[1][1] == B[1][1] &&
+           A[2][0] == B[2][0] && A[2][1] == B[2][1];
+}
+
 Transform Transform::operator * (const Transform& rhs) const
 {
     if (CC_LIKELY(mType == IDENTITY))
@@ -63,7 +73,26 @@ Transform Transform::operator * (const Transform& rhs) const
     if (rhs.mType == IDENTITY)
         return r;
 
-    // TODO: we could use mType to optimize the matrix multiply
+    // Most products involve a pure translation, whose type is known, and
+    // the type of the result follows without reclassifying its matrix.
+    // Our matrices always have < 0 , 0 , 1 > as their last row.
+    if (rhs.mType == TRANSLATE) {
+        // A * T: the translation goes through A
+        const mat33& A(mMatrix);
+        const float x = rhs.mMatrix[2][0];
+        const float y = rhs.mMatrix[2][1];
+        r.set(A[0][0]*x + A[1][0]*y + A[2][0],
+              A[0][1]*x + A[1][1]*y + A[2][1]);
+        return r;
+    }
+    if (mType == TRANSLATE) {
+        // T * B: the translations add up
+        r = rhs;
+        r.set(rhs.mMatrix[2][0] + mMatrix[2][0],
+              rhs.mMatrix[2][1] + mMatrix[2][1]);
+        return r;
+    }
+
     const mat33& A(mMatrix);
     const mat33& B(rhs.mMatrix);
           mat33& D(r.mMatrix);
@@ -203,8 +232,54 @@ Rect Transform::makeBounds(int w, int h) const
     return transform( Rect(w, h) );
 }
 
+bool Transform::isUnitRotation() const
+{
+    const mat33& M(mMatrix);
+    if (isZero(M[1][0]) && isZero(M[0][1])) {
+        return absIsOne(M[0][0]) && absIsOne(M[1][1]);
+    }
+    if (isZero(M[0][0]) && isZero(M[1][1])) {
+        return absIsOne(M[1][0]) && absIsOne(M[0][1]);
+    }
+    return false;
+}
+
+Rect Transform::transformUnit(const Rect& bounds, int x, int y) const
+{
+    // the matrix only has 0, 1 and -1 in it, and the corners map to
+    // integers before the translation, so this matches the float code
+    const mat33& M(mMatrix);
+    const int a = int(M[0][0]);
+    const int b = int(M[1][0]);
+    const int c = int(M[0][1]);
+    const int d = int(M[1][1]);
+
+    // two opposite corners are enough when the edges stay axis aligned
+    const int x0 = a*bounds.left  + b*bounds.top;
+    const int y0 = c*bounds.left  + d*bounds.top;
+    const int x1 = a*bounds.right + b*bounds.bottom;
+    const int y1 = c*bounds.right + d*bounds.bottom;
+
+    return Rect(min(x0, x1) + x, min(y0, y1) + y,
+                max(x0, x1) + x, max(y0, y1) + y);
+}
+
 Rect Transform::transform(const Rect& bounds) const
 {
+    const uint32_t type = this->type();
+    if (CC_LIKELY(type <= TRANSLATE)) {
+        const int x = floorf(tx() + 0.5f);
+        const int y = floorf(ty() + 0.5f);
+        return Rect(min(bounds.left, bounds.right) + x,
+                    min(bounds.top, bounds.bottom) + y,
+                    max(bounds.left, bounds.right) + x,
+                    max(bounds.top, bounds.bottom) + y);
+    }
+    if (CC_LIKELY(!(type & UNKNOWN) && isUnitRotation())) {
+        return transformUnit(bounds,
+                floorf(tx() + 0.5f), floorf(ty() + 0.5f));
+    }
+
     Rect r;
     vec2 lt( bounds.left,  bounds.top    );
     vec2 rt( bounds.right, bounds.top    );
@@ -226,21 +301,35 @@ Rect Transform::transform(const Rect& bounds) const
 
 Region Transform::transform(const Region& reg) const
 {
+    const uint32_t type = this->type();
+    const int x = floorf(tx() + 0.5f);
+    const int y = floorf(ty() + 0.5f);
+
+    if (CC_LIKELY(type <= TRANSLATE)) {
+        return reg.translate(x, y);
+    }
+
     Region out;
-    if (CC_UNLIKELY(transformed())) {
-        if (CC_LIKELY(preserveRects())) {
-            Region::const_iterator it = reg.begin();
-            Region::const_iterator const end = reg.end();
-            while (it != end) {
-                out.orSelf(transform(*it++));
-            }
-        } else {
-            out.set(transform(reg.bounds()));
+    if (CC_LIKELY(!(type & UNKNOWN) && isUnitRotation())) {
+        const uint32_t orientation = type >> 8;
+        if (!(orientation & ROT_90)) {
+            // flips keep the rects in bands, only their order changes
+            return reg.flip(orientation & FLIP_H, orientation & FLIP_V, x, y);
+        }
+        // rows become columns, the bands have to be rebuilt
+        Region::const_iterator it = reg.begin();
+        Region::const_iterator const end = reg.end();
+        while (it != end) {
+            out.orSelf(transformUnit(*it++, x, y));
+        }
+    } else if (CC_LIKELY(preserveRects())) {
+        Region::const_iterator it = reg.begin();
+        Region::const_iterator const end = reg.end();
+        while (it != end) {
+            out.orSelf(transform(*it++));
         }
     } else {
-        int xpos = floorf(tx() + 0.5f);
-        int ypos = floorf(ty() + 0.5f);
-        out = reg.translate(xpos, ypos);
+        out.set(transform(reg.bounds()));
     }
     return out;
 }
@@ -79,6 +79,10 @@ public:
             Region  transform(const Region& reg) const;
             Rect    transform(const Rect& bounds) const;
             Transform operator * (const Transform& rhs) const;
+            bool operator == (const Transform& rhs) const;
+            inline bool operator != (const Transform& rhs) const {
+                return !operator == (rhs);
+            }
 
             Transform inverse() const;
 
@@ -116,6 +120,10 @@ private:
     vec2 transform(const vec2& v) const;
     vec3 transform(const vec3& v) const;
     uint32_t type() const;
+    // whether the 2x2 part only rotates by multiples of 90 degrees and
+    // flips, which maps integer rects to integer rects
+    bool isUnitRotation() const;
+    Rect transformUnit(const Rect& bounds, int x, int y) const;
     static bool absIsOne(float f);
     static bool isZero(float f);
 
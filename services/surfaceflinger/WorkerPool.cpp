@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/Log.h>
+#include <utils/String8.h>
+#include <utils/Trace.h>
+
+#include "WorkerPool.h"
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+WorkerPool::WorkerPool(const char* name, size_t numThreads)
+    : mPendingJobs(0), mExiting(false) {
+    for (size_t i=0 ; i<numThreads ; i++) {
+        sp<WorkerThread> thread(new WorkerThread(this));
+        String8 threadName(String8::format("%s-%u", name, unsigned(i)));
+        if (thread->run(threadName.string(), PRIORITY_URGENT_DISPLAY) == NO_ERROR) {
+            mThreads.add(thread);
+        } else {
+            ALOGE("couldn't start %s", threadName.string());
+        }
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        Mutex::Autolock _l(mLock);
+        mExiting = true;
+        mJobCondition.broadcast();
+    }
+    for (size_t i=0 ; i<mThreads.size() ; i++) {
+        mThreads[i]->requestExitAndWait();
+    }
+}
+
+void WorkerPool::post(Job* job) {
+    if (mThreads.isEmpty()) {
+        // no worker, run the job right away on the caller's thread
+        job->run();
+        return;
+    }
+    Mutex::Autolock _l(mLock);
+    mJobs.add(job);
+    mPendingJobs++;
+    mJobCondition.signal();
+}
+
+void WorkerPool::wait() {
+    ATRACE_CALL();
+    Mutex::Autolock _l(mLock);
+    while (mPendingJobs) {
+        mDoneCondition.wait(mLock);
+    }
+}
+
+bool WorkerPool::runOneJob() {
+    Job* job;
+    { // scope for the lock
+        Mutex::Autolock _l(mLock);
+        while (mJobs.isEmpty() && !mExiting) {
+            mJobCondition.wait(mLock);
+        }
+        if (mExiting) {
+            return false;
+        }
+        job = mJobs[0];
+        mJobs.removeAt(0);
+    }
+
+    job->run();
+
+    Mutex::Autolock _l(mLock);
+    if (--mPendingJobs == 0) {
+        mDoneCondition.broadcast();
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+
+WorkerPool::WorkerThread::WorkerThread(WorkerPool* pool)
+    : Thread(false), mPool(pool) {
+}
+
+bool WorkerPool::WorkerThread::threadLoop() {
+    return mPool->runOneJob();
+}
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
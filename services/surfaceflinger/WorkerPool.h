@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SURFACE_FLINGER_WORKER_POOL_H
+#define ANDROID_SURFACE_FLINGER_WORKER_POOL_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <utils/RefBase.h>
+#include <utils/Vector.h>
+#include <utils/threads.h>
+
+// ---------------------------------------------------------------------------
+namespace android {
+// ---------------------------------------------------------------------------
+
+/*
+ * A small pool of long-lived threads used by the main thread to run
+ * independent pieces of per-frame work concurrently.
+ *
+ * Unlike utils/WorkQueue, the threads are kept around between frames and
+ * the jobs are not owned by the pool: the caller posts its jobs, then
+ * runs wait() which returns once all of them have completed.
+ */
+class WorkerPool : public LightRefBase<WorkerPool> {
+public:
+    class Job {
+    public:
+        virtual ~Job() { }
+        virtual void run() = 0;
+    };
+
+    WorkerPool(const char* name, size_t numThreads);
+    ~WorkerPool();
+
+    size_t getThreadCount() const { return mThreads.size(); }
+
+    // queue a job, it must stay valid until wait() returns
+    void post(Job* job);
+
+    // block until all posted jobs have run
+    void wait();
+
+private:
+    class WorkerThread : public Thread {
+    public:
+        WorkerThread(WorkerPool* pool);
+    private:
+        virtual bool threadLoop();
+        WorkerPool* const mPool;
+    };
+
+    // called from the worker threads, returns false when exiting
+    bool runOneJob();
+
+    mutable Mutex mLock;
+    Condition mJobCondition;
+    Condition mDoneCondition;
+    Vector<Job*> mJobs;
+    size_t mPendingJobs;
+    bool mExiting;
+    Vector< sp<WorkerThread> > mThreads;
+};
+
+// ---------------------------------------------------------------------------
+}; // namespace android
+// ---------------------------------------------------------------------------
+
+#endif /* ANDROID_SURFACE_FLINGER_WORKER_POOL_H */
@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the latency of the SurfaceFlinger paths applications go through
+ * every frame, over many iterations:
+ *
+ *   transaction   closing a transaction moving a surface, synchronously
+ *                 (until SurfaceFlinger committed it) and asynchronously
+ *   surface       creating and destroying a surface
+ *   producer      queue-to-latch and queue-to-present of frames posted by
+ *                 several producers at once
+ *   screenshot    capturing the main display
+ *
+ * Each metric is printed on its own line as a JSON object, with the number
+ * of samples, their percentiles in microseconds and the rate at which they
+ * were taken, so that runs can be compared from one build to the next.
+ *
+ * usage: test-surfaceflinger-bench [-i iterations] [-p producers] [benchmark...]
+ */
+
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <binder/ProcessState.h>
+
+#include <gui/ISurfaceComposer.h>
+#include <gui/Surface.h>
+#include <gui/SurfaceComposerClient.h>
+
+#include <utils/Mutex.h>
+#include <utils/String8.h>
+#include <utils/Thread.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+using namespace android;
+
+// ----------------------------------------------------------------------------
+
+class Samples {
+public:
+    Samples(const char* name) : mName(name), mStart(systemTime()) { }
+
+    void add(nsecs_t duration) {
+        Mutex::Autolock _l(mLock);
+        mValues.add(duration);
+    }
+
+    void report() {
+        Mutex::Autolock _l(mLock);
+        const nsecs_t elapsed = systemTime() - mStart;
+        const size_t count = mValues.size();
+        if (count == 0) {
+            printf("{\"metric\":\"%s\",\"count\":0}\n", mName);
+            return;
+        }
+        qsort(mValues.editArray(), count, sizeof(nsecs_t), compare);
+        printf("{\"metric\":\"%s\",\"count\":%u,"
+                "\"min_us\":%.1f,\"p50_us\":%.1f,\"p90_us\":%.1f,"
+                "\"p99_us\":%.1f,\"max_us\":%.1f,\"rate_hz\":%.1f}\n",
+                mName, unsigned(count),
+                us(mValues[0]), us(percentile(50)), us(percentile(90)),
+                us(percentile(99)), us(mValues[count - 1]),
+                count * double(s2ns(1)) / elapsed);
+        fflush(stdout);
+    }
+
+private:
+    // nearest-rank percentile of the sorted samples
+    nsecs_t percentile(size_t p) const {
+        return mValues[(p * (mValues.size() - 1) + 50) / 100];
+    }
+
+    static double us(nsecs_t t) {
+        return t / 1000.0;
+    }
+
+    static int compare(const void* lhs, const void* rhs) {
+        const nsecs_t l = *static_cast<const nsecs_t*>(lhs);
+        const nsecs_t r = *static_cast<const nsecs_t*>(rhs);
+        return l < r ? -1 : (l > r ? 1 : 0);
+    }
+
+    const char* const mName;
+    const nsecs_t mStart;
+    Mutex mLock;
+    Vector<nsecs_t> mValues;
+};
+
+// ----------------------------------------------------------------------------
+
+static sp<SurfaceControl> createShownSurface(
+        const sp<SurfaceComposerClient>& client, const char* name,
+        int32_t layer, float x, float y) {
+    sp<SurfaceControl> sc = client->createSurface(String8(name), 64, 64,
+            PIXEL_FORMAT_RGBA_8888, 0);
+    if (!SurfaceControl::isValid(sc)) {
+        fprintf(stderr, "couldn't create surface %s\n", name);
+        return NULL;
+    }
+    SurfaceComposerClient::openGlobalTransaction();
+    sc->setLayer(layer);
+    sc->setPosition(x, y);
+    sc->show();
+    SurfaceComposerClient::closeGlobalTransaction(true);
+    return sc;
+}
+
+static void benchTransaction(const sp<SurfaceComposerClient>& client,
+        size_t iterations) {
+    sp<SurfaceControl> sc = createShownSurface(client, "bench transaction",
+            INT_MAX - 1, 0, 0);
+    if (sc == NULL) {
+        return;
+    }
+    Samples sync("transaction_sync");
+    for (size_t i=0 ; i<iterations ; i++) {
+        const nsecs_t start = systemTime();
+        SurfaceComposerClient::openGlobalTransaction();
+        sc->setPosition(i & 1, 0);
+        SurfaceComposerClient::closeGlobalTransaction(true);
+        sync.add(systemTime() - start);
+    }
+    sync.report();
+
+    Samples async("transaction_async");
+    for (size_t i=0 ; i<iterations ; i++) {
+        const nsecs_t start = systemTime();
+        SurfaceComposerClient::openGlobalTransaction();
+        sc->setPosition(i & 1, 0);
+        SurfaceComposerClient::closeGlobalTransaction(false);
+        async.add(systemTime() - start);
+    }
+    async.report();
+    sc->clear();
+}
+
+static void benchSurface(const sp<SurfaceComposerClient>& client,
+        size_t iterations) {
+    Samples create("surface_create");
+    Samples destroy("surface_destroy");
+    for (size_t i=0 ; i<iterations ; i++) {
+        nsecs_t start = systemTime();
+        sp<SurfaceControl> sc = client->createSurface(
+                String8("bench surface"), 64, 64, PIXEL_FORMAT_RGBA_8888, 0);
+        create.add(systemTime() - start);
+        if (!SurfaceControl::isValid(sc)) {
+            fprintf(stderr, "couldn't create surface\n");
+            break;
+        }
+        start = systemTime();
+        sc->clear();
+        destroy.add(systemTime() - start);
+    }
+    create.report();
+    destroy.report();
+}
+
+// ----------------------------------------------------------------------------
+
+// Posts frames on its own surface, as fast as the BufferQueue lets it, and
+// records when SurfaceFlinger latched and presented each of them.
+class ProducerThread : public Thread {
+public:
+    ProducerThread(const sp<SurfaceControl>& sc, size_t iterations,
+            Samples* latch, Samples* present)
+        : Thread(false), mSurfaceControl(sc), mIterations(iterations),
+          mLatch(latch), mPresent(present) {
+    }
+
+private:
+    struct pending_t {
+        uint64_t frameNumber;
+        bool latched;
+    };
+
+    virtual bool threadLoop() {
+        sp<Surface> s = mSurfaceControl->getSurface();
+        for (size_t i=0 ; i<mIterations ; i++) {
+            ANativeWindow_Buffer buffer;
+            if (s->lock(&buffer, NULL) != NO_ERROR) {
+                fprintf(stderr, "couldn't lock surface\n");
+                break;
+            }
+            s->unlockAndPost();
+            pending_t pending;
+            pending.frameNumber = s->getLastQueuedFrameNumber();
+            pending.latched = false;
+            if (pending.frameNumber) {
+                mPending.add(pending);
+            }
+            collect(s);
+        }
+        // give the last frames time to reach the display
+        const nsecs_t timeout = systemTime() + ms2ns(500);
+        while (!mPending.isEmpty() && systemTime() < timeout) {
+            usleep(1000);
+            collect(s);
+        }
+        return false;
+    }
+
+    void collect(const sp<Surface>& s) {
+        size_t i = 0;
+        while (i < mPending.size()) {
+            pending_t& pending(mPending.editItemAt(i));
+            IGraphicBufferProducer::FrameTimestamps t;
+            if (s->getFrameTimestamps(pending.frameNumber, &t) != NO_ERROR) {
+                // too old, or the frame was dropped
+                mPending.removeAt(i);
+                continue;
+            }
+            if (!pending.latched && t.acquireTime) {
+                mLatch->add(t.acquireTime - t.queueTime);
+                pending.latched = true;
+            }
+            if (t.presentTime) {
+                mPresent->add(t.presentTime - t.queueTime);
+                mPending.removeAt(i);
+                continue;
+            }
+            i++;
+        }
+    }
+
+    const sp<SurfaceControl> mSurfaceControl;
+    const size_t mIterations;
+    Samples* const mLatch;
+    Samples* const mPresent;
+    Vector<pending_t> mPending;
+};
+
+static void benchProducer(const sp<SurfaceComposerClient>& client,
+        size_t iterations, size_t producers) {
+    Vector< sp<SurfaceControl> > surfaces;
+    for (size_t i=0 ; i<producers ; i++) {
+        sp<SurfaceControl> sc = createShownSurface(client, "bench producer",
+                INT_MAX - 2 - i, 64 * i, 64);
+        if (sc == NULL) {
+            break;
+        }
+        surfaces.add(sc);
+    }
+
+    Samples latch("queue_to_latch");
+    Samples present("queue_to_present");
+    Vector< sp<ProducerThread> > threads;
+    for (size_t i=0 ; i<surfaces.size() ; i++) {
+        sp<ProducerThread> thread = new ProducerThread(surfaces[i],
+                iterations, &latch, &present);
+        thread->run("bench producer");
+        threads.add(thread);
+    }
+    for (size_t i=0 ; i<threads.size() ; i++) {
+        threads[i]->join();
+    }
+    latch.report();
+    present.report();
+
+    for (size_t i=0 ; i<surfaces.size() ; i++) {
+        surfaces[i]->clear();
+    }
+}
+
+static void benchScreenshot(size_t iterations) {
+    sp<IBinder> display(SurfaceComposerClient::getBuiltInDisplay(
+            ISurfaceComposer::eDisplayIdMain));
+    ScreenshotClient screenshot;
+    Samples capture("screenshot");
+    for (size_t i=0 ; i<iterations ; i++) {
+        const nsecs_t start = systemTime();
+        if (screenshot.update(display) != NO_ERROR) {
+            fprintf(stderr, "couldn't capture the screen\n");
+            break;
+        }
+        capture.add(systemTime() - start);
+        screenshot.release();
+    }
+    capture.report();
+}
+
+// ----------------------------------------------------------------------------
+
+static void usage(const char* pname) {
+    fprintf(stderr,
+            "usage: %s [-i iterations] [-p producers] [benchmark...]\n"
+            "   -i: iterations of each benchmark, 1000 by default\n"
+            "   -p: concurrent producers of the producer benchmark, 4 by default\n"
+            "benchmarks: transaction surface producer screenshot, "
+            "all of them by default\n",
+            pname);
+}
+
+static bool selected(int argc, char** argv, const char* name) {
+    if (optind >= argc) {
+        return true;
+    }
+    for (int i=optind ; i<argc ; i++) {
+        if (!strcmp(argv[i], name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    const char* pname = argv[0];
+    size_t iterations = 1000;
+    size_t producers = 4;
+    int c;
+    while ((c = getopt(argc, argv, "i:p:h")) != -1) {
+        switch (c) {
+            case 'i':
+                iterations = atoi(optarg);
+                break;
+            case 'p':
+                producers = atoi(optarg);
+                break;
+            default:
+                usage(pname);
+                return c == 'h' ? 0 : 1;
+        }
+    }
+
+    // screenshots and frame timestamps come back over binder
+    ProcessState::self()->startThreadPool();
+
+    sp<SurfaceComposerClient> client = new SurfaceComposerClient;
+    if (client->initCheck() != NO_ERROR) {
+        fprintf(stderr, "couldn't connect to SurfaceFlinger\n");
+        return 1;
+    }
+
+    if (selected(argc, argv, "transaction")) {
+        benchTransaction(client, iterations);
+    }
+    if (selected(argc, argv, "surface")) {
+        benchSurface(client, iterations);
+    }
+    if (selected(argc, argv, "producer")) {
+        benchProducer(client, iterations, producers);
+    }
+    if (selected(argc, argv, "screenshot")) {
+        benchScreenshot(iterations);
+    }
+
+    client->dispose();
+    return 0;
+}